@@ -57,6 +57,7 @@ limitations under the License.
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/platform.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/stream_executor_no_cuda.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
 #include "tensorflow/core/public/version.h"
@@ -361,7 +362,12 @@ TF_Tensor* TFE_TensorHandleResolve(TFE_TensorHandle* h, TF_Status* status) {
   return new TF_Tensor{t};
 }
 
-void* TFE_TensorHandleDevicePointer(TFE_TensorHandle* h, TF_Status* status) {
+namespace {
+
+// Returns the device memory of `h`. If `sync_device`, first waits for the
+// device to finish all computations enqueued on it.
+void* TensorHandleDevicePointer(TFE_TensorHandle* h, bool sync_device,
+                                TF_Status* status) {
   if (h == nullptr) {
     status->status = tensorflow::errors::InvalidArgument("Invalid handle");
     return nullptr;
@@ -389,7 +395,7 @@ void* TFE_TensorHandleDevicePointer(TFE_TensorHandle* h, TF_Status* status) {
     return nullptr;
   }
   tensorflow::Device* device(handle->device());
-  if (device != nullptr) {
+  if (device != nullptr && sync_device) {
     status->status = device->Sync();
     if (!status->status.ok()) {
       return nullptr;
@@ -404,6 +410,17 @@ void* TFE_TensorHandleDevicePointer(TFE_TensorHandle* h, TF_Status* status) {
       static_cast<const void*>(tensor->tensor_data().data()));
 }
 
+}  // namespace
+
+void* TFE_TensorHandleDevicePointer(TFE_TensorHandle* h, TF_Status* status) {
+  return TensorHandleDevicePointer(h, /*sync_device=*/true, status);
+}
+
+void* TFE_TensorHandleDevicePointerUnsynchronized(TFE_TensorHandle* h,
+                                                  TF_Status* status) {
+  return TensorHandleDevicePointer(h, /*sync_device=*/false, status);
+}
+
 namespace tensorflow {
 namespace {
 class CustomDeviceAPI : public tensorflow::CustomDevice {
@@ -584,6 +601,25 @@ TFE_TensorHandle* TFE_NewTensorHandleFromDeviceMemory(
       std::move(t), device, device, context));
 }
 
+void* TFE_ContextDeviceStream(TFE_Context* ctx, const char* device_name,
+                              TF_Status* status) {
+  tensorflow::Device* device = nullptr;
+  tensorflow::EagerContext* context =
+      tensorflow::ContextFromInterface(tensorflow::unwrap(ctx));
+  status->status = context->FindDeviceFromName(device_name, &device);
+  if (!status->status.ok()) {
+    status->status =
+        tensorflow::errors::InvalidArgument(device_name, " unknown device.");
+    return nullptr;
+  }
+  const tensorflow::DeviceBase::GpuDeviceInfo* gpu_device_info =
+      device->tensorflow_gpu_device_info();
+  if (gpu_device_info == nullptr || gpu_device_info->stream == nullptr) {
+    return nullptr;
+  }
+  return gpu_device_info->stream->implementation()->GpuStreamHack();
+}
+
 // This function will block till the operation that produces `h` has
 // completed. This is only valid on local TFE_TensorHandles. Returns the size in
 // bytes of the memory pointed to by the device pointer returned above.
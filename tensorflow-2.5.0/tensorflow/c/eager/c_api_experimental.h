@@ -395,6 +395,27 @@ TF_CAPI_EXPORT extern TFE_TensorHandle* TFE_NewTensorHandleFromDeviceMemory(
     void (*deallocator)(void* data, size_t len, void* arg),
     void* deallocator_arg, TF_Status* status);
 
+// Returns the platform stream (e.g. a cudaStream_t) on which TF enqueues the
+// computations of the physical device `device_name`, or nullptr for devices
+// without streams such as CPUs.
+//
+// External runtimes can enqueue work on this stream to order it after the
+// computations producing the tensors they read (see
+// TFE_TensorHandleDevicePointerUnsynchronized), and to have TF computations
+// ordered after the work producing buffers they pass to
+// TFE_NewTensorHandleFromDeviceMemory, without synchronizing the host with the
+// device.
+TF_CAPI_EXPORT extern void* TFE_ContextDeviceStream(TFE_Context* ctx,
+                                                    const char* device_name,
+                                                    TF_Status* status);
+
+// Like TFE_TensorHandleDevicePointer, but does not wait for the device to
+// finish the computations producing `h`: the returned memory is only valid for
+// work enqueued on the stream returned by TFE_ContextDeviceStream. Still blocks
+// until the operation producing `h` has been enqueued.
+TF_CAPI_EXPORT extern void* TFE_TensorHandleDevicePointerUnsynchronized(
+    TFE_TensorHandle* h, TF_Status* status);
+
 // Retrieves the address space (i.e. job, replia, task) of the local host and
 // saves it in the buffer.
 TF_CAPI_EXPORT extern void TFE_HostAddressSpace(TFE_Context* ctx,
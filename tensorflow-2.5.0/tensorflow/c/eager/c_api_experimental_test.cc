@@ -385,6 +385,15 @@ TEST(CAPI, TensorHandleOnDeviceMemory) {
     CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
     void* data = TFE_TensorHandleDevicePointer(copy, status);
     CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    EXPECT_EQ(data, TFE_TensorHandleDevicePointerUnsynchronized(copy, status));
+    CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    void* stream = TFE_ContextDeviceStream(ctx, name, status);
+    CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    const char* device_type = TF_DeviceListType(devices, d, status);
+    CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    if (strcmp(device_type, "CPU") == 0) {
+      EXPECT_EQ(stream, nullptr);
+    }
     size_t size = TFE_TensorHandleDeviceMemorySize(copy, status);
     CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
     int64_t dims[] = {2, 2};
@@ -586,10 +586,13 @@ Status BuildXlaOpsPass::Run(const GraphOptimizationPassOptions& options) {
                     return IsXlaCompiledKernel(*n);
                   });
 
+  // Asynchronous compilation runs the fallback path while the cluster compiles
+  // in the background, so it needs the fallback path to be built.
   bool lazy_compilation_enabled =
       enable_lazy_compilation_
           ? *enable_lazy_compilation_
-          : GetBuildXlaOpsPassFlags()->tf_xla_enable_lazy_compilation;
+          : GetBuildXlaOpsPassFlags()->tf_xla_enable_lazy_compilation ||
+                GetXlaOpsCommonFlags().tf_xla_async_compilation;
 
   jit::DeviceInfoCache device_info_cache;
   const BuildXlaOpsPassFlags& flags = *GetBuildXlaOpsPassFlags();
@@ -30,4 +30,6 @@ const char* const kXlaInternalScopeAttr = "_XlaInternalScope";
 
 const char* const kXlaClusterIdAttr = "_xla_compile_id";
 
+const char* const kXlaShapeBucketingAttr = "_XlaShapeBucketing";
+
 }  // namespace tensorflow
@@ -38,6 +38,10 @@ extern const char* const kXlaInternalScopeAttr;  // "_XlaInternalScope"
 // The id of the compiled cluster.
 extern const char* const kXlaClusterIdAttr;  // "_xla_compile_id"
 
+// Set on the function of a cluster whose rows are computed independently of
+// each other; only such clusters have their inputs padded up to a shape bucket.
+extern const char* const kXlaShapeBucketingAttr;  // "_XlaShapeBucketing"
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_COMPILER_JIT_DEFS_H_
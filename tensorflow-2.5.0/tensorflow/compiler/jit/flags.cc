@@ -93,6 +93,21 @@ void AppendMarkForCompilationPassFlagsInternal(std::vector<Flag>* flag_list) {
       Flag("tf_xla_max_cluster_size",
            &mark_for_compilation_flags->tf_xla_max_cluster_size,
            "Maximum number of operators in an XLA compilation."),
+      Flag("tf_xla_cost_model_clustering",
+           &mark_for_compilation_flags->tf_xla_cost_model_clustering,
+           "(experimental) If true, auto-clusters are scored with an "
+           "analytical FLOP and memory traffic model and discarded if their "
+           "predicted benefit is below tf_xla_cluster_min_benefit_us."),
+      Flag("tf_xla_cluster_min_benefit_us",
+           &mark_for_compilation_flags->tf_xla_cluster_min_benefit_us,
+           "Minimum predicted time saved by compiling an auto-cluster, in "
+           "microseconds, when tf_xla_cost_model_clustering is set."),
+      Flag("tf_xla_cluster_size_penalty_us",
+           &mark_for_compilation_flags->tf_xla_cluster_size_penalty_us,
+           "Penalty per operator subtracted from the predicted benefit of an "
+           "auto-cluster, in microseconds, when tf_xla_cost_model_clustering "
+           "is set. Accounts for compile time and the risk of poor codegen "
+           "in very large clusters."),
       Flag(
           "tf_xla_ops_to_cluster",
           &mark_for_compilation_flags->tf_xla_ops_to_cluster,
@@ -148,6 +163,9 @@ void AllocateAndParseFlags() {
   mark_for_compilation_flags->tf_xla_min_cluster_size = 4;
   mark_for_compilation_flags->tf_xla_max_cluster_size =
       std::numeric_limits<int32>::max();
+  mark_for_compilation_flags->tf_xla_cost_model_clustering = false;
+  mark_for_compilation_flags->tf_xla_cluster_min_benefit_us = 0;
+  mark_for_compilation_flags->tf_xla_cluster_size_penalty_us = 0.1;
   mark_for_compilation_flags->tf_xla_clustering_debug = false;
   mark_for_compilation_flags->tf_xla_cpu_global_jit = false;
   mark_for_compilation_flags->tf_xla_clustering_fuel =
@@ -164,6 +182,9 @@ void AllocateAndParseFlags() {
   ops_flags = new XlaOpsCommonFlags;
   ops_flags->tf_xla_always_defer_compilation = false;
   ops_flags->tf_xla_async_compilation = false;
+  ops_flags->tf_xla_persistent_cache_directory = "";
+  ops_flags->tf_xla_persistent_cache_max_size_mb = 10 * 1024;
+  ops_flags->tf_xla_shape_buckets = "";
 
   jitter_flags = new IntroduceFloatingPointJitterPassFlags;
   jitter_flags->jitter_amount = 1e-5;
@@ -218,9 +239,27 @@ void AllocateAndParseFlags() {
        Flag("tf_xla_always_defer_compilation",
             &ops_flags->tf_xla_always_defer_compilation, ""),
        Flag("tf_xla_async_compilation", &ops_flags->tf_xla_async_compilation,
-            "When lazy compilation is enabled, asynchronous compilation starts "
-            "the cluster compilation in the background, and the fallback path "
-            "is executed until the compilation has finished."),
+            "Asynchronous compilation starts the compilation of a cluster for "
+            "a new signature in the background, and the fallback path is "
+            "executed until the compilation has finished. Implies "
+            "tf_xla_enable_lazy_compilation."),
+       Flag("tf_xla_persistent_cache_directory",
+            &ops_flags->tf_xla_persistent_cache_directory,
+            "If non-empty, compiled XLA clusters are persisted in this "
+            "directory and reused by later processes, which then only need to "
+            "run the XLA compiler backend."),
+       Flag("tf_xla_persistent_cache_max_size_mb",
+            &ops_flags->tf_xla_persistent_cache_max_size_mb,
+            "Maximum size of tf_xla_persistent_cache_directory in MB. The "
+            "least recently written entries are evicted beyond it. "
+            "Non-positive values mean unbounded."),
+       Flag("tf_xla_shape_buckets", &ops_flags->tf_xla_shape_buckets,
+            "Either \"powers_of_two\" or a comma-separated, increasing "
+            "list of bucket sizes. If non-empty, clusters whose function has "
+            "the _XlaShapeBucketing attribute set, and whose inputs share a "
+            "leading dimension, are launched with their inputs zero-padded "
+            "up to a bucket along that dimension; the outputs that follow "
+            "the leading dimension of the inputs are sliced back."),
 
        Flag("tf_introduce_floating_point_jitter_to_tensors",
             setter_for_jitter_tensor_names, "",
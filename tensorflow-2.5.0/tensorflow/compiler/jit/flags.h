@@ -57,6 +57,14 @@ struct MarkForCompilationPassFlags {
   // Maximum number of operators in an XLA compilation.
   int32 tf_xla_max_cluster_size;
 
+  // If true, auto-clusters are scored by an analytical cost model and only
+  // compiled if their predicted benefit over the TF executor, minus
+  // tf_xla_cluster_size_penalty_us per operator, is at least
+  // tf_xla_cluster_min_benefit_us.
+  bool tf_xla_cost_model_clustering;
+  float tf_xla_cluster_min_benefit_us;
+  float tf_xla_cluster_size_penalty_us;
+
   // If non-empty, limit XLA clustering to the following TF operations.
   string tf_xla_ops_to_cluster;
 
@@ -102,6 +110,18 @@ struct XlaOpsCommonFlags {
   // If true, _XlaCompile compiles the cluster asynchronously with respect to
   // the main execution. The fallback path is taken while compilation happens.
   bool tf_xla_async_compilation;
+  // If non-empty, compiled clusters are also stored in this directory and
+  // reused across processes. Defaults to empty.
+  string tf_xla_persistent_cache_directory;
+  // Maximum size of `tf_xla_persistent_cache_directory` in MB before the least
+  // recently written entries are evicted. Non-positive means unbounded.
+  int64 tf_xla_persistent_cache_max_size_mb;
+  // If non-empty, the leading dimension of clusters that opt in through the
+  // _XlaShapeBucketing function attribute is padded up to a shape bucket
+  // before compilation, bounding the number of executables built for a
+  // cluster. Either "powers_of_two" or a comma-separated, increasing list of
+  // bucket sizes. Defaults to empty.
+  string tf_xla_shape_buckets;
 };
 
 // Flags for the build_xla_ops pass.
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/compiler/jit/xla_activity_listener.h"
 #include "tensorflow/compiler/jit/xla_cluster_util.h"
 #include "tensorflow/compiler/jit/xla_platform_info.h"
+#include "tensorflow/compiler/jit/xla_shape_bucketing.h"
 #include "tensorflow/compiler/tf2xla/shape_util.h"
 #include "tensorflow/compiler/tf2xla/tf2xla_util.h"
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
@@ -38,6 +39,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -151,6 +153,23 @@ class XlaExecutableClosureStore {
 
 }  // namespace
 
+// Returns true if the function of the cluster has the kXlaShapeBucketingAttr
+// attribute set, i.e. it computes the rows of its inputs independently.
+static bool HasShapeBucketingAttr(OpKernelConstruction* ctx,
+                                  const NameAttrList& function) {
+  const FunctionLibraryRuntime* flr = ctx->function_library();
+  if (flr == nullptr) {
+    return false;
+  }
+  const FunctionDef* fdef =
+      flr->GetFunctionLibraryDefinition()->Find(function.name());
+  if (fdef == nullptr) {
+    return false;
+  }
+  auto it = fdef->attr().find(kXlaShapeBucketingAttr);
+  return it != fdef->attr().end() && it->second.b();
+}
+
 XlaLocalLaunchBase::XlaLocalLaunchBase(OpKernelConstruction* ctx,
                                        const std::vector<int>& constants,
                                        const std::vector<int>& resources,
@@ -161,7 +180,49 @@ XlaLocalLaunchBase::XlaLocalLaunchBase(OpKernelConstruction* ctx,
       resources_(resources),
       function_(function),
       platform_info_(XlaPlatformInfoFromDevice(ctx->device())),
-      has_ref_vars_(has_ref_vars) {}
+      has_ref_vars_(has_ref_vars),
+      shape_bucketing_(HasShapeBucketingAttr(ctx, function)) {}
+
+absl::optional<std::vector<bool>> XlaLocalLaunchBase::GetBucketedOutputs(
+    OpKernelContext* ctx, absl::Span<const Tensor* const> inputs) {
+  string signature;
+  for (const Tensor* input : inputs) {
+    absl::StrAppend(&signature, DataTypeString(input->dtype()));
+    for (int d = 1; d < input->dims(); ++d) {
+      absl::StrAppend(&signature, ",", input->dim_size(d));
+    }
+    absl::StrAppend(&signature, ";");
+  }
+  {
+    mutex_lock lock(bucketing_mu_);
+    auto it = bucketed_outputs_.find(signature);
+    if (it != bucketed_outputs_.end()) {
+      return it->second;
+    }
+  }
+
+  // Shape inference runs outside of the lock; concurrent launches may repeat
+  // it, but they all reach the same result.
+  absl::optional<std::vector<bool>> outputs;
+  const FunctionLibraryDefinition* flib_def =
+      ctx->function_library()->GetFunctionLibraryDefinition();
+  const FunctionDef* fdef = flib_def->Find(function_.name());
+  xla::StatusOr<std::vector<bool>> follows_leading_dim =
+      errors::NotFound("Function ", function_.name(), " not found");
+  if (fdef != nullptr) {
+    follows_leading_dim = GetOutputsFollowingLeadingDimension(
+        *fdef, AttrSlice(&function_.attr()), *flib_def, inputs);
+  }
+  if (follows_leading_dim.ok()) {
+    outputs = follows_leading_dim.ConsumeValueOrDie();
+  } else {
+    VLOG(1) << "Not bucketing the shapes of " << function_.name() << ": "
+            << follows_leading_dim.status();
+  }
+  mutex_lock lock(bucketing_mu_);
+  return bucketed_outputs_.emplace(signature, std::move(outputs))
+      .first->second;
+}
 
 static Status CompileToLocalExecutable(
     OpKernelContext* ctx, const NameAttrList& function, bool has_ref_vars,
@@ -287,6 +348,42 @@ void XlaLocalLaunchBase::Compute(OpKernelContext* ctx) {
   const XlaCompiler::CompilationResult* compilation_result;
   xla::LocalExecutable* executable;
 
+  // With shape bucketing, the leading dimension shared by all inputs is padded
+  // up to a bucket so that every size within the bucket reuses the executable
+  // compiled for it. Only clusters that opted in, and so compute their rows
+  // independently, are bucketed; the outputs that follow the leading dimension
+  // of the inputs are sliced back.
+  absl::optional<int64> unpadded_size;
+  int64 padded_size = 0;
+  std::vector<Tensor> padded_inputs;
+  std::vector<bool> sliced_outputs;
+  const XlaShapeBucketingPolicy& bucketing = XlaShapeBucketingPolicy::Get();
+  if (shape_bucketing_ && bucketing.enabled() &&
+      !platform_info_.is_on_xla_device() && !has_ref_vars_) {
+    unpadded_size =
+        GetBucketableLeadingDimension(inputs, constants_, resources_);
+  }
+  if (unpadded_size.has_value()) {
+    absl::optional<std::vector<bool>> bucketed_outputs =
+        GetBucketedOutputs(ctx, inputs);
+    if (bucketed_outputs.has_value()) {
+      sliced_outputs = std::move(*bucketed_outputs);
+    } else {
+      unpadded_size.reset();
+    }
+  }
+  if (unpadded_size.has_value()) {
+    padded_size = bucketing.BucketFor(*unpadded_size);
+    if (padded_size != *unpadded_size) {
+      padded_inputs.resize(inputs.size());
+      for (int i = 0; i < inputs.size(); ++i) {
+        OP_REQUIRES_OK(ctx, PadLeadingDimension(ctx, *inputs[i], padded_size,
+                                                &padded_inputs[i]));
+        inputs[i] = &padded_inputs[i];
+      }
+    }
+  }
+
   std::vector<VariableInfo> variable_infos;
   {
     OP_REQUIRES_OK(
@@ -301,6 +398,15 @@ void XlaLocalLaunchBase::Compute(OpKernelContext* ctx) {
     OP_REQUIRES_OK(ctx, s);
   }
 
+  if (unpadded_size.has_value()) {
+    bool hit;
+    {
+      mutex_lock lock(bucketing_mu_);
+      hit = !bucketed_results_.insert(compilation_result).second;
+    }
+    metrics::RecordXlaShapeBucketLookup(padded_size, hit);
+  }
+
   std::map<int, const Tensor*> resource_var_ptrs;
   for (int i = 0; i < resources_.size(); i++) {
     resource_var_ptrs[resources_[i]] = variable_infos[i].var()->tensor();
@@ -317,6 +423,11 @@ void XlaLocalLaunchBase::Compute(OpKernelContext* ctx) {
       client, allocator, device_ordinal,
       /*allocate_xla_tensors=*/platform_info_.is_on_xla_device(),
       platform_info_.UseMultipleStreams());
+  if (!padded_inputs.empty()) {
+    launch_context.SetLeadingDimensionPadding(std::move(padded_inputs),
+                                              std::move(sliced_outputs),
+                                              *unpadded_size, padded_size);
+  }
   const xla::HloInputOutputAliasConfig& input_output_alias =
       executable->executable()->module().input_output_alias_config();
   xla::StatusOr<std::vector<xla::ExecutionInput>> execution_inputs =
@@ -479,21 +590,31 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
         &kernel, &executable);
     OP_REQUIRES_OK(ctx, SnapshotResourceVariables(ctx, resources_,
                                                   variable_infos, &variables));
-    if (compile_mode != XlaCompilationCache::CompileMode::kLazy ||
-        status.code() != error::UNIMPLEMENTED) {
+    // Asynchronous compilation reports failures of the background compilation
+    // on a later call, at which point the fallback path is always available,
+    // so they must not fail the step either.
+    const bool can_fall_back =
+        compile_mode == XlaCompilationCache::CompileMode::kAsync ||
+        (compile_mode == XlaCompilationCache::CompileMode::kLazy &&
+         status.code() == error::UNIMPLEMENTED);
+    if (!can_fall_back) {
       OP_REQUIRES_OK(ctx, status);
     }
 
-    if (status.code() == error::UNIMPLEMENTED) {
+    if (!status.ok()) {
       LOG(WARNING) << "Compilation failed:" << status.ToString()
                    << ".  Falling back to TF function call.";
 
-      BroadcastOptimizationRemark(
-          XlaOptimizationRemark::UNIMPLEMENTED_OPERATION, status.ToString())
-          .IgnoreError();
       executable = nullptr;
-      mutex_lock guard(cannot_compile_cluster_mu_);
-      cannot_compile_cluster_ = true;
+      // Other failures of an asynchronous compilation may be specific to one
+      // signature, or transient, so they only make this call fall back.
+      if (status.code() == error::UNIMPLEMENTED) {
+        BroadcastOptimizationRemark(
+            XlaOptimizationRemark::UNIMPLEMENTED_OPERATION, status.ToString())
+            .IgnoreError();
+        mutex_lock guard(cannot_compile_cluster_mu_);
+        cannot_compile_cluster_ = true;
+      }
     }
   }
 
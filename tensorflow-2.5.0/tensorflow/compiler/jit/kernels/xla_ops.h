@@ -17,7 +17,12 @@ limitations under the License.
 #define TENSORFLOW_COMPILER_JIT_KERNELS_XLA_OPS_H_
 
 #include <atomic>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
 #include "tensorflow/compiler/jit/xla_compilation_cache.h"
 #include "tensorflow/compiler/jit/xla_device.h"
 #include "tensorflow/compiler/jit/xla_launch_util.h"
@@ -27,6 +32,8 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/util/stream_executor_util.h"
 #include "tensorflow/stream_executor/tf_allocator_adapter.h"
 
@@ -66,6 +73,26 @@ class XlaLocalLaunchBase : public OpKernel {
   const XlaPlatformInfo platform_info_;
 
   bool has_ref_vars_;
+
+  // Whether the function of the cluster opts into shape bucketing.
+  const bool shape_bucketing_;
+
+ private:
+  // Returns, for each output of the cluster, whether it follows the leading
+  // dimension of `inputs`, or nullopt if the cluster can't be bucketed for
+  // inputs of these shapes.
+  absl::optional<std::vector<bool>> GetBucketedOutputs(
+      OpKernelContext* ctx, absl::Span<const Tensor* const> inputs);
+
+  mutex bucketing_mu_;
+  // Compilation results that have already been launched with inputs padded up
+  // to a shape bucket; used to tell bucket hits from misses.
+  absl::flat_hash_set<const XlaCompiler::CompilationResult*> bucketed_results_
+      TF_GUARDED_BY(bucketing_mu_);
+  // Result of GetBucketedOutputs, keyed by the types and shapes of the inputs
+  // without their leading dimension.
+  absl::flat_hash_map<string, absl::optional<std::vector<bool>>>
+      bucketed_outputs_ TF_GUARDED_BY(bucketing_mu_);
 };
 
 // XlaLocalLaunchOp is used to replace a region of the TensorFlow graph
@@ -31,6 +31,9 @@ limitations under the License.
 #include "tensorflow/compiler/jit/device_util.h"
 #include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/resource_operation_safety_analysis.h"
+#include "tensorflow/compiler/jit/shape_inference.h"
+#include "tensorflow/compiler/jit/xla_activity_listener.h"
+#include "tensorflow/compiler/jit/xla_cluster_cost_model.h"
 #include "tensorflow/compiler/jit/xla_cluster_util.h"
 #include "tensorflow/compiler/tf2xla/const_analysis.h"
 #include "tensorflow/compiler/tf2xla/resource_operation_table.h"
@@ -95,6 +98,14 @@ class MarkForCompilationPassImpl {
     int max_cluster_size;
     int min_cluster_size;
 
+    // If true, clusters that are only compiled because of auto-clustering are
+    // dropped unless the cost model predicts them to save at least
+    // `min_cluster_benefit_us`, after subtracting `cluster_size_penalty_us` per
+    // node.
+    bool use_cost_model;
+    float min_cluster_benefit_us;
+    float cluster_size_penalty_us;
+
     // Compiler fuel for the auto-clustering algorithm.
     //
     // We decrement this value by one on every time we choose a compilation
@@ -301,6 +312,13 @@ class MarkForCompilationPassImpl {
 
   StatusOr<bool> ShouldCompileCluster(const Cluster& cluster);
 
+  // Returns false if the cost model predicts that running the nodes in
+  // `cluster_nodes` as one XLA cluster is not worth it.  Clusters that must be
+  // compiled, e.g. because they are placed on an XLA device, are always
+  // profitable.
+  StatusOr<bool> IsProfitableToCompile(const Cluster& cluster,
+                                       absl::Span<Node* const> cluster_nodes);
+
   StatusOr<bool> ClusteringWillIntroduceInterDeviceDependency(
       const Cluster& from, const Cluster& to);
 
@@ -438,6 +456,8 @@ class MarkForCompilationPassImpl {
   GraphCycles cycles_graph_;
   OrderedNodeSet compilation_candidates_;
   std::unique_ptr<DeadnessAnalysis> deadness_analysis_;
+  // Statically inferred shapes used by the cost model; computed on first use.
+  absl::optional<GraphShapeInfo> shape_info_;
   int64 iteration_count_ = 0;
   absl::flat_hash_set<std::pair<int, int>> unsafe_resource_deps_;
 };
@@ -855,17 +875,54 @@ Status MarkForCompilationPassImpl::CreateClusters() {
     DumpGraphToFile("before_mark_for_compilation", *graph_, flib_def_);
   }
 
+  auto is_auto_cluster = [&](const Cluster& cluster) {
+    return cluster.effective_cluster_size() >=
+               debug_options_.min_cluster_size &&
+           !cluster.has_functional_control_flow() &&
+           !cluster.is_xla_compile_attr_true();
+  };
+
+  // Clusters that only auto-clustering would compile and that the cost model
+  // predicts to be slower with XLA.
+  absl::flat_hash_set<const Cluster*> unprofitable_clusters;
+  if (debug_options_.use_cost_model) {
+    std::vector<Cluster*> auto_clusters;
+    absl::flat_hash_map<Cluster*, std::vector<Node*>> nodes_by_cluster;
+    for (Node* n : compilation_candidates_) {
+      Cluster* cluster = GetClusterForNode(n);
+      TF_ASSIGN_OR_RETURN(bool should_compile_cluster,
+                          ShouldCompileCluster(*cluster));
+      if (!should_compile_cluster || !is_auto_cluster(*cluster)) {
+        continue;
+      }
+      std::vector<Node*>& nodes = nodes_by_cluster[cluster];
+      if (nodes.empty()) {
+        auto_clusters.push_back(cluster);
+      }
+      nodes.push_back(n);
+    }
+    for (Cluster* cluster : auto_clusters) {
+      TF_ASSIGN_OR_RETURN(
+          bool profitable,
+          IsProfitableToCompile(*cluster, nodes_by_cluster[cluster]));
+      if (!profitable) {
+        unprofitable_clusters.insert(cluster);
+      }
+    }
+  }
+
   // Mark clusters for compilation that:
   // * are placed on a device that requires compilation (an XlaDevice),
   // * are explicitly marked for compilation (_XlaCompile=true), or
   // * have more than debug_options_.xla_min_cluster_size elements (applicable
   //   only if compilation is enabled, otherwise there will be no such
-  //   candidates).
+  //   candidates) and, if the cost model is enabled, are predicted to be
+  //   profitable.
   for (Node* n : compilation_candidates_) {
     Cluster* cluster = GetClusterForNode(n);
     TF_ASSIGN_OR_RETURN(bool should_compile_cluster,
                         ShouldCompileCluster(*cluster));
-    if (!should_compile_cluster) {
+    if (!should_compile_cluster || unprofitable_clusters.contains(cluster)) {
       continue;
     }
 
@@ -1674,6 +1731,59 @@ StatusOr<bool> MarkForCompilationPassImpl::ShouldCompileClusterImpl(
   return should_compile;
 }
 
+StatusOr<bool> MarkForCompilationPassImpl::IsProfitableToCompile(
+    const Cluster& cluster, absl::Span<Node* const> cluster_nodes) {
+  TF_ASSIGN_OR_RETURN(DeviceId chosen_device,
+                      PickDeviceForXla(device_info_cache_, cluster.devices(),
+                                       /*allow_mixing_unknown_and_cpu=*/false));
+  const XlaOpRegistry::DeviceRegistration* registration =
+      device_info_cache_.GetCompilationDevice(chosen_device);
+  if (registration && registration->autoclustering_policy ==
+                          XlaOpRegistry::AutoclusteringPolicy::kAlways) {
+    return true;
+  }
+
+  if (!shape_info_.has_value()) {
+    // Shape inference temporarily rewrites loop back edges, so run it on a
+    // copy of the graph whose node names match `graph_`.
+    shape_info_.emplace();
+    Graph graph_copy(graph_->op_registry());
+    CopyGraph(*graph_, &graph_copy);
+    Status status = InferShapes(&graph_copy, /*arg_shapes=*/{}, flib_def_,
+                                &*shape_info_);
+    if (!status.ok()) {
+      VLOG(1) << "Shape inference for the XLA cost model failed, assuming "
+                 "unknown shapes: "
+              << status;
+      shape_info_->clear();
+    }
+  }
+
+  const XlaClusterCostModelParams params =
+      XlaClusterCostModelParams::ForDeviceType(
+          device_info_cache_.GetDeviceTypeFor(chosen_device).type_string());
+  const XlaClusterCostEstimate estimate =
+      EstimateXlaClusterCost(cluster_nodes, *shape_info_, params);
+  const double score =
+      estimate.benefit_us() -
+      debug_options_.cluster_size_penalty_us * estimate.num_ops;
+  const bool profitable = score >= debug_options_.min_cluster_benefit_us;
+
+  string description = absl::StrCat(
+      cluster.DebugString(*graph_), ": ", estimate.num_ops, " ops, ",
+      estimate.flops, " flops, ", estimate.boundary_bytes,
+      " boundary bytes, ", estimate.internal_bytes,
+      " internal bytes; predicted TF time ", estimate.tf_time_us,
+      "us, XLA time ", estimate.xla_time_us, "us, score ", score, "us");
+  VLOG(2) << (profitable ? "Compiling " : "Not compiling ") << description;
+  if (!profitable) {
+    BroadcastOptimizationRemark(XlaOptimizationRemark::UNPROFITABLE_CLUSTER,
+                                std::move(description))
+        .IgnoreError();
+  }
+  return profitable;
+}
+
 StatusOr<bool> MarkForCompilationPassImpl::ShouldCompileCluster(
     const Cluster& cluster) {
   auto it = should_compile_cluster_cache_.find(&cluster);
@@ -1735,6 +1845,9 @@ Status MarkForCompilationPass::Run(
   debug_options.ignore_xla_compile_attr = false;
   debug_options.max_cluster_size = flags->tf_xla_max_cluster_size;
   debug_options.min_cluster_size = flags->tf_xla_min_cluster_size;
+  debug_options.use_cost_model = flags->tf_xla_cost_model_clustering;
+  debug_options.min_cluster_benefit_us = flags->tf_xla_cluster_min_benefit_us;
+  debug_options.cluster_size_penalty_us = flags->tf_xla_cluster_size_penalty_us;
   debug_options.fuel = GetPointerToFuel(flags->tf_xla_clustering_fuel);
   debug_options.dump_graphs = flags->tf_xla_clustering_debug;
 
@@ -1753,6 +1866,9 @@ Status MarkForCompilationPass::RunForTest(
   debug_options.ignore_xla_compile_attr = true;
   debug_options.max_cluster_size = flags->tf_xla_max_cluster_size;
   debug_options.min_cluster_size = flags->tf_xla_min_cluster_size;
+  debug_options.use_cost_model = flags->tf_xla_cost_model_clustering;
+  debug_options.min_cluster_benefit_us = flags->tf_xla_cluster_min_benefit_us;
+  debug_options.cluster_size_penalty_us = flags->tf_xla_cluster_size_penalty_us;
   debug_options.fuel = GetPointerToFuel(flags->tf_xla_clustering_fuel);
   debug_options.dump_graphs = flags->tf_xla_clustering_debug;
 
@@ -0,0 +1,197 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/xla_cluster_cost_model.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/types.h"
+
+namespace tensorflow {
+namespace {
+
+// Returns the shape of output `index` of `node`, or nullptr if it is unknown.
+const PartialTensorShape* FindOutputShape(const Node* node, int index,
+                                          const GraphShapeInfo& shape_info) {
+  auto it = shape_info.find(node->name());
+  if (it == shape_info.end() || index >= it->second.size() ||
+      it->second[index].shape.unknown_rank()) {
+    return nullptr;
+  }
+  return &it->second[index].shape;
+}
+
+double DimSize(const PartialTensorShape& shape, int dim,
+               const XlaClusterCostModelParams& params) {
+  int64 size = shape.dim_size(dim);
+  return size < 0 ? params.unknown_dim_size : size;
+}
+
+double NumElements(const PartialTensorShape* shape,
+                   const XlaClusterCostModelParams& params) {
+  if (shape == nullptr) {
+    return params.unknown_dim_size;
+  }
+  double num_elements = 1;
+  for (int d = 0; d < shape->dims(); ++d) {
+    num_elements *= DimSize(*shape, d, params);
+  }
+  return num_elements;
+}
+
+double OutputBytes(const Node* node, int index,
+                   const GraphShapeInfo& shape_info,
+                   const XlaClusterCostModelParams& params) {
+  const int element_size = DataTypeSize(BaseType(node->output_type(index)));
+  return element_size *
+         NumElements(FindOutputShape(node, index, shape_info), params);
+}
+
+// Returns the shape of input `index` of `node`, or nullptr if it is unknown.
+const PartialTensorShape* FindInputShape(const Node* node, int index,
+                                         const GraphShapeInfo& shape_info) {
+  const Edge* edge;
+  if (!node->input_edge(index, &edge).ok()) {
+    return nullptr;
+  }
+  return FindOutputShape(edge->src(), edge->src_output(), shape_info);
+}
+
+// Estimates the floating point operations executed by `node`, in the spirit of
+// xla::HloCostAnalysis: contractions count a multiply and an add per term, all
+// other ops one operation per element touched.
+double EstimateFlops(const Node* node, const GraphShapeInfo& shape_info,
+                     const XlaClusterCostModelParams& params) {
+  const string& op = node->type_string();
+  const double output_elements =
+      node->num_outputs() > 0
+          ? NumElements(FindOutputShape(node, 0, shape_info), params)
+          : 0;
+
+  if (op == "MatMul" || op == "BatchMatMul" || op == "BatchMatMulV2") {
+    const PartialTensorShape* lhs = FindInputShape(node, 0, shape_info);
+    if (lhs == nullptr || lhs->dims() < 2) {
+      return 2 * output_elements * params.unknown_dim_size;
+    }
+    bool transpose = false;
+    (void)GetNodeAttr(node->attrs(), op == "MatMul" ? "transpose_a" : "adj_x",
+                      &transpose);
+    const int contracting_dim = transpose ? lhs->dims() - 2 : lhs->dims() - 1;
+    return 2 * output_elements * DimSize(*lhs, contracting_dim, params);
+  }
+
+  if (op == "Conv2D" || op == "Conv3D" || op == "DepthwiseConv2dNative") {
+    const PartialTensorShape* filter = FindInputShape(node, 1, shape_info);
+    if (filter == nullptr || filter->dims() < 2) {
+      return 2 * output_elements * params.unknown_dim_size;
+    }
+    // Every output element is a dot product over the spatial window, and for
+    // regular convolutions the input channels too.
+    double terms = NumElements(filter, params) /
+                   DimSize(*filter, filter->dims() - 1, params);
+    if (op == "DepthwiseConv2dNative") {
+      terms /= DimSize(*filter, filter->dims() - 2, params);
+    }
+    return 2 * output_elements * terms;
+  }
+
+  double input_elements = 0;
+  for (int i = 0; i < node->num_inputs(); ++i) {
+    input_elements += NumElements(FindInputShape(node, i, shape_info), params);
+  }
+  return std::max(input_elements, output_elements);
+}
+
+double RooflineTimeUs(double flops, double bytes,
+                      const XlaClusterCostModelParams& params) {
+  return std::max(flops / params.flops_per_us, bytes / params.bytes_per_us);
+}
+
+}  // namespace
+
+/*static*/ XlaClusterCostModelParams XlaClusterCostModelParams::ForDeviceType(
+    absl::string_view device_type) {
+  XlaClusterCostModelParams params;
+  if (device_type == DEVICE_GPU) {
+    params.op_overhead_us = 5;
+    params.cluster_overhead_us = 20;
+    params.bytes_per_us = 500e3;
+    params.flops_per_us = 10e6;
+  } else {
+    params.op_overhead_us = 2;
+    params.cluster_overhead_us = 10;
+    params.bytes_per_us = 20e3;
+    params.flops_per_us = 200e3;
+  }
+  params.unknown_dim_size = 64;
+  return params;
+}
+
+XlaClusterCostEstimate EstimateXlaClusterCost(
+    absl::Span<Node* const> cluster, const GraphShapeInfo& shape_info,
+    const XlaClusterCostModelParams& params) {
+  XlaClusterCostEstimate estimate;
+  absl::flat_hash_set<const Node*> in_cluster(cluster.begin(), cluster.end());
+  // Inputs fed to several nodes of the cluster are only read once by XLA.
+  absl::flat_hash_set<std::pair<const Node*, int>> cluster_inputs;
+
+  for (const Node* node : cluster) {
+    double node_bytes = 0;
+    for (const Edge* edge : node->in_edges()) {
+      if (edge->IsControlEdge()) {
+        continue;
+      }
+      const double bytes =
+          OutputBytes(edge->src(), edge->src_output(), shape_info, params);
+      node_bytes += bytes;
+      if (in_cluster.contains(edge->src())) {
+        estimate.internal_bytes += bytes;
+      } else if (cluster_inputs.emplace(edge->src(), edge->src_output())
+                     .second) {
+        estimate.boundary_bytes += bytes;
+      }
+    }
+
+    for (int i = 0; i < node->num_outputs(); ++i) {
+      const double bytes = OutputBytes(node, i, shape_info, params);
+      node_bytes += bytes;
+      const bool consumed_outside = absl::c_any_of(
+          node->out_edges(), [&](const Edge* edge) {
+            return !edge->IsControlEdge() && edge->src_output() == i &&
+                   !in_cluster.contains(edge->dst());
+          });
+      if (consumed_outside) {
+        estimate.boundary_bytes += bytes;
+      }
+    }
+
+    const double flops = EstimateFlops(node, shape_info, params);
+    estimate.flops += flops;
+    estimate.num_ops++;
+    estimate.tf_time_us +=
+        params.op_overhead_us + RooflineTimeUs(flops, node_bytes, params);
+  }
+
+  estimate.xla_time_us =
+      params.cluster_overhead_us +
+      RooflineTimeUs(estimate.flops, estimate.boundary_bytes, params);
+  return estimate;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,87 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// An analytical cost model used by auto-clustering to decide whether compiling
+// a candidate cluster with XLA is likely to be faster than running its nodes
+// one by one in the TF executor.
+
+#ifndef TENSORFLOW_COMPILER_JIT_XLA_CLUSTER_COST_MODEL_H_
+#define TENSORFLOW_COMPILER_JIT_XLA_CLUSTER_COST_MODEL_H_
+
+#include "absl/types/span.h"
+#include "tensorflow/compiler/jit/shape_inference.h"
+#include "tensorflow/core/graph/graph.h"
+
+namespace tensorflow {
+
+// Machine parameters of the cost model.
+struct XlaClusterCostModelParams {
+  // Returns parameters suitable for clusters placed on `device_type`.
+  static XlaClusterCostModelParams ForDeviceType(absl::string_view device_type);
+
+  // Fixed cost of running a single TF op, in microseconds.
+  double op_overhead_us;
+
+  // Fixed cost of launching an XLA cluster, in microseconds. This includes the
+  // _XlaCompile and _XlaRun ops and argument marshalling.
+  double cluster_overhead_us;
+
+  // Sustained memory bandwidth, in bytes per microsecond.
+  double bytes_per_us;
+
+  // Sustained compute throughput, in floating point operations per
+  // microsecond.
+  double flops_per_us;
+
+  // Extent assumed for dimensions whose size is not known statically.
+  int64 unknown_dim_size;
+};
+
+// The estimated cost of running a cluster with and without XLA.
+struct XlaClusterCostEstimate {
+  int num_ops = 0;
+
+  // Floating point operations executed by the cluster.
+  double flops = 0;
+
+  // Bytes read and written by the cluster as a whole, i.e. its inputs and the
+  // outputs consumed outside of the cluster.
+  double boundary_bytes = 0;
+
+  // Bytes of the tensors produced and consumed within the cluster. XLA keeps
+  // most of them out of memory by fusing their producers and consumers.
+  double internal_bytes = 0;
+
+  // Predicted time of running the nodes of the cluster in the TF executor,
+  // summing a roofline estimate and the fixed overhead of every op.
+  double tf_time_us = 0;
+
+  // Predicted time of running the cluster as a single XLA launch, assuming the
+  // internal tensors are fused away.
+  double xla_time_us = 0;
+
+  double benefit_us() const { return tf_time_us - xla_time_us; }
+};
+
+// Estimates the cost of `cluster`, a set of nodes of one graph. Tensor sizes
+// are taken from `shape_info`; tensors missing from it or with unknown
+// dimensions use `params.unknown_dim_size` for those dimensions.
+XlaClusterCostEstimate EstimateXlaClusterCost(
+    absl::Span<Node* const> cluster, const GraphShapeInfo& shape_info,
+    const XlaClusterCostModelParams& params);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_XLA_CLUSTER_COST_MODEL_H_
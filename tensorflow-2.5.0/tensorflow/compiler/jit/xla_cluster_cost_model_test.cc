@@ -0,0 +1,98 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/xla_cluster_cost_model.h"
+
+#include "tensorflow/cc/framework/scope.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/compiler/jit/shape_inference.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+std::vector<Node*> FindNodes(const Graph& graph,
+                             const std::vector<string>& names) {
+  std::unordered_map<string, Node*> index = graph.BuildNodeNameIndex();
+  std::vector<Node*> nodes;
+  for (const string& name : names) {
+    nodes.push_back(index.at(name));
+  }
+  return nodes;
+}
+
+XlaClusterCostEstimate EstimateCost(const Scope& root,
+                                    const std::vector<string>& cluster) {
+  Graph graph(OpRegistry::Global());
+  TF_CHECK_OK(root.ToGraph(&graph));
+  GraphShapeInfo shape_info;
+  TF_CHECK_OK(InferShapes(&graph, /*arg_shapes=*/{}, /*fnlib_def=*/nullptr,
+                          &shape_info));
+  return EstimateXlaClusterCost(
+      FindNodes(graph, cluster), shape_info,
+      XlaClusterCostModelParams::ForDeviceType(DEVICE_GPU));
+}
+
+TEST(XlaClusterCostModelTest, ElementwiseChainIsProfitable) {
+  Scope root = Scope::NewRootScope().ExitOnError();
+  auto a = ops::Placeholder(root.WithOpName("a"), DT_FLOAT,
+                            ops::Placeholder::Shape({1024, 1024}));
+  auto b = ops::Exp(root.WithOpName("b"), a);
+  auto c = ops::Log(root.WithOpName("c"), b);
+  auto d = ops::Neg(root.WithOpName("d"), c);
+  auto e = ops::Abs(root.WithOpName("e"), d);
+  ops::Identity(root.WithOpName("out"), e);
+
+  XlaClusterCostEstimate estimate = EstimateCost(root, {"b", "c", "d", "e"});
+  const double tensor_bytes = 1024 * 1024 * sizeof(float);
+  EXPECT_EQ(estimate.num_ops, 4);
+  EXPECT_EQ(estimate.flops, 4 * 1024 * 1024);
+  EXPECT_EQ(estimate.boundary_bytes, 2 * tensor_bytes);
+  EXPECT_EQ(estimate.internal_bytes, 3 * tensor_bytes);
+  EXPECT_GT(estimate.benefit_us(), 0);
+}
+
+TEST(XlaClusterCostModelTest, TinyClusterIsNotProfitable) {
+  Scope root = Scope::NewRootScope().ExitOnError();
+  auto a = ops::Placeholder(root.WithOpName("a"), DT_FLOAT,
+                            ops::Placeholder::Shape({2, 3}));
+  auto b = ops::Placeholder(root.WithOpName("b"), DT_FLOAT,
+                            ops::Placeholder::Shape({3, 4}));
+  auto c = ops::MatMul(root.WithOpName("c"), a, b);
+  ops::Identity(root.WithOpName("out"), c);
+
+  XlaClusterCostEstimate estimate = EstimateCost(root, {"c"});
+  EXPECT_EQ(estimate.flops, 2 * 2 * 4 * 3);
+  EXPECT_LT(estimate.benefit_us(), 0);
+}
+
+TEST(XlaClusterCostModelTest, UnknownDimensionsUseDefaultSize) {
+  Scope root = Scope::NewRootScope().ExitOnError();
+  auto a = ops::Placeholder(root.WithOpName("a"), DT_FLOAT,
+                            ops::Placeholder::Shape({-1, 8}));
+  auto b = ops::Exp(root.WithOpName("b"), a);
+  ops::Identity(root.WithOpName("out"), b);
+
+  XlaClusterCostEstimate estimate = EstimateCost(root, {"b"});
+  const int64 unknown_dim_size =
+      XlaClusterCostModelParams::ForDeviceType(DEVICE_GPU).unknown_dim_size;
+  EXPECT_EQ(estimate.flops, unknown_dim_size * 8);
+}
+
+}  // namespace
+}  // namespace tensorflow
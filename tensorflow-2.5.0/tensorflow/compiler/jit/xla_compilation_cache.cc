@@ -19,7 +19,9 @@ limitations under the License.
 
 #include "tensorflow/compiler/mlir/mlir_bridge_rollout_policy.h"
 #include "absl/base/call_once.h"
+#include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/xla_activity.pb.h"
@@ -31,6 +33,7 @@ limitations under the License.
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
 #include "tensorflow/compiler/tf2xla/xla_context.h"
 #include "tensorflow/compiler/xla/client/client_library.h"
+#include "tensorflow/compiler/xla/debug_options_flags.h"
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/function.h"
@@ -43,8 +46,10 @@ limitations under the License.
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/protobuf/graph_debug_info.pb.h"
 #include "tensorflow/core/public/version.h"
@@ -59,7 +64,14 @@ constexpr int64
 
 XlaCompilationCache::XlaCompilationCache(xla::LocalClient* client,
                                          DeviceType device_type)
-    : client_(client), device_type_(std::move(device_type)) {}
+    : client_(client), device_type_(std::move(device_type)) {
+  const XlaOpsCommonFlags& flags = GetXlaOpsCommonFlags();
+  if (!flags.tf_xla_persistent_cache_directory.empty()) {
+    disk_cache_ = absl::make_unique<XlaCompilationDiskCache>(
+        Env::Default(), flags.tf_xla_persistent_cache_directory,
+        flags.tf_xla_persistent_cache_max_size_mb * 1024 * 1024);
+  }
+}
 
 XlaCompilationCache::~XlaCompilationCache() {
   // Ensure any use of our programs have completed by waiting for all stream
@@ -166,7 +178,8 @@ XlaCompilationCache::BuildSignature(
 Status XlaCompilationCache::BuildExecutable(
     const XlaCompiler::Options& options,
     const XlaCompiler::CompilationResult& result,
-    std::unique_ptr<xla::LocalExecutable>* executable) {
+    std::unique_ptr<xla::LocalExecutable>* executable,
+    const xla::HloModuleProto* optimized_module) {
   VLOG(2) << "Compiling to local executable";
 
   std::vector<const xla::Shape*> argument_layouts(
@@ -186,14 +199,132 @@ Status XlaCompilationCache::BuildExecutable(
   build_options.set_alias_passthrough_params(options.alias_passthrough_params);
   build_options.mutable_debug_options()->set_xla_detailed_logging_and_dumping(
       options.detailed_logging);
-  TF_ASSIGN_OR_RETURN(
-      auto executables,
-      client_->Compile(*result.computation, argument_layouts, build_options));
+  std::vector<std::unique_ptr<xla::LocalExecutable>> executables;
+  if (optimized_module != nullptr) {
+    build_options.set_run_backend_only(true);
+    TF_ASSIGN_OR_RETURN(
+        executables,
+        client_->Compile(xla::XlaComputation(*optimized_module),
+                         argument_layouts, build_options));
+  } else {
+    TF_ASSIGN_OR_RETURN(executables,
+                        client_->Compile(*result.computation, argument_layouts,
+                                         build_options));
+  }
   TF_RET_CHECK(executables.size() == 1);
   *executable = std::move(executables[0]);
   return Status::OK();
 }
 
+xla::StatusOr<string> XlaCompilationCache::BuildPersistentCacheKey(
+    const XlaCompiler::Options& options, const NameAttrList& function,
+    const std::vector<XlaCompiler::Argument>& args,
+    const XlaCompiler::CompileOptions& compile_options) {
+  string key = absl::StrCat(TF_VERSION_STRING, ";", tf_git_version(), ";",
+                            device_type_.type_string(), ";",
+                            client_->platform()->Name());
+
+  const int device_ordinal = options.device_ordinal != -1
+                                 ? options.device_ordinal
+                                 : client_->default_device_ordinal();
+  TF_ASSIGN_OR_RETURN(se::StreamExecutor * executor,
+                      client_->backend().stream_executor(device_ordinal));
+  const se::DeviceDescription& device = executor->GetDeviceDescription();
+  absl::StrAppend(&key, ";", device.name(), ";", device.platform_version());
+  int cc_major, cc_minor;
+  if (device.cuda_compute_capability(&cc_major, &cc_minor)) {
+    absl::StrAppend(&key, ";sm_", cc_major, cc_minor);
+  }
+
+  absl::StrAppend(
+      &key, ";", options.graph_def_version, options.allow_cpu_custom_calls,
+      options.custom_fake_quant_op_calls, options.alias_passthrough_params,
+      options.detailed_logging, compile_options.use_tuple_arg,
+      compile_options.return_updated_values_for_all_resources,
+      compile_options.always_return_tuple, compile_options.is_entry_computation,
+      compile_options.add_token_input_output,
+      compile_options.alias_resource_update);
+
+  auto append_proto = [&key](const protobuf::MessageLite& proto) -> Status {
+    string serialized;
+    if (!SerializeToStringDeterministic(proto, &serialized)) {
+      return errors::Internal("Failed to serialize ", proto.GetTypeName());
+    }
+    absl::StrAppend(&key, ";", serialized);
+    return Status::OK();
+  };
+  TF_RETURN_IF_ERROR(append_proto(xla::GetDebugOptionsFromFlags()));
+  TF_RETURN_IF_ERROR(append_proto(function));
+  const FunctionDef* fdef =
+      options.flib_def ? options.flib_def->Find(function.name()) : nullptr;
+  if (fdef != nullptr) {
+    TF_RETURN_IF_ERROR(
+        append_proto(options.flib_def->ReachableDefinitions(*fdef).ToProto()));
+  }
+  for (const XlaCompiler::Argument& arg : args) {
+    absl::StrAppend(&key, ";", arg.HumanString());
+    if (arg.kind == XlaCompiler::Argument::kConstant ||
+        arg.kind == XlaCompiler::Argument::kConstantResource) {
+      TensorProto constant;
+      arg.constant_value.AsProtoTensorContent(&constant);
+      TF_RETURN_IF_ERROR(append_proto(constant));
+    }
+  }
+
+  const Fprint128 fingerprint = Fingerprint128(key);
+  return absl::StrFormat("%016x%016x", fingerprint.high64, fingerprint.low64);
+}
+
+bool XlaCompilationCache::LoadFromPersistentCache(
+    const XlaCompiler::Options& options, const string& key, Entry* entry) {
+  XlaSerializedCompilation compilation;
+  bool found = false;
+  Status s = disk_cache_->Lookup(key, &compilation, &found);
+  if (s.ok() && !found) return false;
+
+  XlaCompiler::CompilationResult result;
+  std::unique_ptr<xla::LocalExecutable> executable;
+  if (s.ok()) s = DeserializeCompilationResult(compilation, &result);
+  if (s.ok()) {
+    s = BuildExecutable(options, result, &executable,
+                        &compilation.optimized_module());
+  }
+  if (!s.ok()) {
+    LOG(WARNING) << "Ignoring entry " << key
+                 << " of the persistent XLA compilation cache in "
+                 << disk_cache_->directory() << ": " << s;
+    return false;
+  }
+  VLOG(1) << "Loaded entry " << key
+          << " from the persistent XLA compilation cache";
+  entry->compilation_result = std::move(result);
+  entry->executable = std::move(executable);
+  entry->compilation_status = Status::OK();
+  return true;
+}
+
+void XlaCompilationCache::StoreInPersistentCache(const string& key,
+                                                 const Entry& entry) {
+  // Without the optimized module a later process would have to run the HLO
+  // passes again, so such results are not worth persisting.
+  if (entry.executable == nullptr ||
+      !entry.executable->executable()->has_module()) {
+    return;
+  }
+  XlaSerializedCompilation compilation;
+  Status s = SerializeCompilationResult(entry.compilation_result, &compilation);
+  if (s.ok()) {
+    *compilation.mutable_optimized_module() =
+        entry.executable->executable()->module().ToProto();
+    s = disk_cache_->Insert(key, compilation);
+  }
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to write entry " << key
+                 << " of the persistent XLA compilation cache in "
+                 << disk_cache_->directory() << ": " << s;
+  }
+}
+
 Status XlaCompilationCache::Compile(
     const XlaCompiler::Options& options, const NameAttrList& function,
     const std::vector<XlaCompiler::Argument>& args,
@@ -211,8 +342,8 @@ Status XlaCompilationCache::Compile(
                         XlaCompiler::CompilationResult* result) {
     return compiler->CompileFunction(compile_options, function, args, result);
   };
-  return CompileImpl(options, function, args, compile_fn, compile_mode,
-                     out_compilation_result, out_executable);
+  return CompileImpl(options, function, args, compile_options, compile_fn,
+                     compile_mode, out_compilation_result, out_executable);
 }
 
 static bool ShouldBeMegamorphic(int64 compile_count, int64 execution_count) {
@@ -322,8 +453,9 @@ Status XlaCompilationCache::CompileSingleOp(
         options.device_type.type_string(), compile_options.use_tuple_arg,
         *options.flib_def, debug_info, options.shape_representation_fn, result);
   };
-  return CompileImpl(options, name, args, compile_op, CompileMode::kStrict,
-                     out_compilation_result, out_executable);
+  return CompileImpl(options, name, args, compile_options, compile_op,
+                     CompileMode::kStrict, out_compilation_result,
+                     out_executable);
 }
 
 namespace {
@@ -343,21 +475,28 @@ void LogOnceXlaCompiledFirstCluster() {
 Status XlaCompilationCache::CompileStrict(
     Entry* entry, const XlaCompiler::Options& options,
     const std::vector<XlaCompiler::Argument>& args, const string& function_name,
+    const string& persistent_cache_key,
     const std::function<Status(XlaCompiler* compiler,
                                const std::vector<XlaCompiler::Argument>& args,
                                XlaCompiler::CompilationResult*)>& compile_fn) {
   tensorflow::Env* env = tensorflow::Env::Default();
   const uint64 compile_start_us = env->NowMicros();
 
-  XlaCompiler compiler(options);
   entry->compile_state = CompileState::kCompiled;
 
-  entry->compilation_status =
-      compile_fn(&compiler, args, &entry->compilation_result);
-  TF_RETURN_IF_ERROR(entry->compilation_status);
-  TF_RET_CHECK(entry->executable.get() == nullptr);
-  entry->compilation_status =
-      BuildExecutable(options, entry->compilation_result, &entry->executable);
+  if (persistent_cache_key.empty() ||
+      !LoadFromPersistentCache(options, persistent_cache_key, entry)) {
+    XlaCompiler compiler(options);
+    entry->compilation_status =
+        compile_fn(&compiler, args, &entry->compilation_result);
+    TF_RETURN_IF_ERROR(entry->compilation_status);
+    TF_RET_CHECK(entry->executable.get() == nullptr);
+    entry->compilation_status =
+        BuildExecutable(options, entry->compilation_result, &entry->executable);
+    if (entry->compilation_status.ok() && !persistent_cache_key.empty()) {
+      StoreInPersistentCache(persistent_cache_key, *entry);
+    }
+  }
 
   const uint64 compile_end_us = env->NowMicros();
   const uint64 compile_time_us = compile_end_us - compile_start_us;
@@ -396,6 +535,7 @@ Status XlaCompilationCache::CompileStrict(
 Status XlaCompilationCache::CompileAsynchronous(
     Entry* entry, const XlaCompiler::Options& options,
     const std::vector<XlaCompiler::Argument>& args, const string& function_name,
+    const string& persistent_cache_key,
     const std::function<Status(XlaCompiler* compiler,
                                const std::vector<XlaCompiler::Argument>& args,
                                XlaCompiler::CompilationResult*)>& compile_fn) {
@@ -421,7 +561,8 @@ Status XlaCompilationCache::CompileAsynchronous(
     // We don't need to lock local_entry.mu, but do it anyway to satisfy
     // thread safety analysis.
     mutex_lock entry_lock(local_entry.mu);
-    (void)CompileStrict(&local_entry, options, args, function_name, compile_fn);
+    (void)CompileStrict(&local_entry, options, args, function_name,
+                        persistent_cache_key, compile_fn);
 
     VLOG(2) << "Finished asynchronous compililation of cluster "
             << function_name << '.';
@@ -443,6 +584,7 @@ Status XlaCompilationCache::CompileAsynchronous(
 Status XlaCompilationCache::CompileImpl(
     const XlaCompiler::Options& options, const NameAttrList& function,
     const std::vector<XlaCompiler::Argument>& args,
+    const XlaCompiler::CompileOptions& compile_options,
     const std::function<Status(XlaCompiler* compiler,
                                const std::vector<XlaCompiler::Argument>& args,
                                XlaCompiler::CompilationResult*)>& compile_fn,
@@ -579,6 +721,18 @@ Status XlaCompilationCache::CompileImpl(
       return reached_compile_threshold;
     }();
 
+    string persistent_cache_key;
+    if (should_compile && disk_cache_ != nullptr) {
+      xla::StatusOr<string> key =
+          BuildPersistentCacheKey(options, function, args, compile_options);
+      if (key.ok()) {
+        persistent_cache_key = key.ValueOrDie();
+      } else {
+        LOG(WARNING) << "Not using the persistent XLA compilation cache for "
+                     << function.name() << ": " << key.status();
+      }
+    }
+
     if (!should_compile) {
       VLOG(2) << "Not compiling for signature: " << human_signature;
       return_null = true;
@@ -586,12 +740,13 @@ Status XlaCompilationCache::CompileImpl(
       VLOG(2) << "Queueing asynchronous compilation for signature: "
               << human_signature;
       TF_RETURN_IF_ERROR(CompileAsynchronous(entry, options, args,
-                                             function.name(), compile_fn));
+                                             function.name(),
+                                             persistent_cache_key, compile_fn));
       return_null = true;
     } else {
       VLOG(2) << "Instantly compiling for signature: " << human_signature;
-      TF_RETURN_IF_ERROR(
-          CompileStrict(entry, options, args, function.name(), compile_fn));
+      TF_RETURN_IF_ERROR(CompileStrict(entry, options, args, function.name(),
+                                       persistent_cache_key, compile_fn));
     }
   } else if (state == CompileState::kCompiling) {
     VLOG(2) << "Ongoing asynchronous compilation for signature: "
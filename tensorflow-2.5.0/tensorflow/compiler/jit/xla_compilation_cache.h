@@ -20,6 +20,7 @@ limitations under the License.
 #include "absl/container/inlined_vector.h"
 #include "absl/types/optional.h"
 #include "absl/types/span.h"
+#include "tensorflow/compiler/jit/xla_compilation_disk_cache.h"
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
 #include "tensorflow/compiler/tf2xla/xla_context.h"
 #include "tensorflow/compiler/xla/client/local_client.h"
@@ -42,6 +43,11 @@ namespace tensorflow {
 //
 // Currently no cache eviction policy is implemented and the cache grows without
 // bound.
+//
+// If --tf_xla_persistent_cache_directory is set, compiled clusters are also
+// written to an XlaCompilationDiskCache in that directory. On an in-memory miss
+// a matching entry there is reused, so only the XLA compiler backend needs to
+// run.
 class XlaCompilationCache : public ResourceBase {
  public:
   XlaCompilationCache(xla::LocalClient* client, DeviceType device_type);
@@ -71,7 +77,8 @@ class XlaCompilationCache : public ResourceBase {
   // and `out_executable`.  If `compile_mode` is `kStrict` then the compilation
   // cache always attempts the compilation on a cache miss. If compilation mode
   // is 'kAsync' compilation of the cluster happens in the background while the
-  // fallback path executes.
+  // fallback path executes. A failed background compilation is reported by
+  // the next call with the same signature.
   //
   // The result of compilation is written to `*out_compilation_result`, which
   // must be non-null. If `out_executable` is non-null, also builds an
@@ -136,6 +143,7 @@ class XlaCompilationCache : public ResourceBase {
   Status CompileImpl(
       const XlaCompiler::Options& options, const NameAttrList& function,
       const std::vector<XlaCompiler::Argument>& args,
+      const XlaCompiler::CompileOptions& compile_options,
       const std::function<Status(XlaCompiler* compiler,
                                  const std::vector<XlaCompiler::Argument>& args,
                                  XlaCompiler::CompilationResult*)>& compile_fn,
@@ -145,9 +153,22 @@ class XlaCompilationCache : public ResourceBase {
 
   // Takes `result` which has been compiled from a Tensorflow subgraph to a
   // XLA computation already, and generates an XLA LocalExecutable `executable`.
-  Status BuildExecutable(const XlaCompiler::Options& options,
-                         const XlaCompiler::CompilationResult& result,
-                         std::unique_ptr<xla::LocalExecutable>* executable);
+  // If `optimized_module` is non-null, it must be `result.computation` after
+  // the XLA compiler's HLO passes, and only the compiler backend is run on it.
+  Status BuildExecutable(
+      const XlaCompiler::Options& options,
+      const XlaCompiler::CompilationResult& result,
+      std::unique_ptr<xla::LocalExecutable>* executable,
+      const xla::HloModuleProto* optimized_module = nullptr);
+
+  // Returns the key of a compilation in the persistent cache. Besides the
+  // signature it covers everything else the compiled code depends on: the
+  // function library, compiler options, XLA flags, the target device and the
+  // TensorFlow version.
+  xla::StatusOr<string> BuildPersistentCacheKey(
+      const XlaCompiler::Options& options, const NameAttrList& function,
+      const std::vector<XlaCompiler::Argument>& args,
+      const XlaCompiler::CompileOptions& compile_options);
 
   xla::LocalClient* const client_;
   const DeviceType device_type_;
@@ -173,10 +194,11 @@ class XlaCompilationCache : public ResourceBase {
     std::unique_ptr<xla::LocalExecutable> executable TF_GUARDED_BY(mu);
   };
 
+  // `persistent_cache_key` is empty if the persistent cache is not used.
   Status CompileStrict(
       Entry* entry, const XlaCompiler::Options& options,
       const std::vector<XlaCompiler::Argument>& args,
-      const string& function_name,
+      const string& function_name, const string& persistent_cache_key,
       const std::function<Status(XlaCompiler* compiler,
                                  const std::vector<XlaCompiler::Argument>& args,
                                  XlaCompiler::CompilationResult*)>& compile_fn)
@@ -184,11 +206,22 @@ class XlaCompilationCache : public ResourceBase {
   Status CompileAsynchronous(
       Entry* entry, const XlaCompiler::Options& options,
       const std::vector<XlaCompiler::Argument>& args,
-      const string& function_name,
+      const string& function_name, const string& persistent_cache_key,
       const std::function<Status(XlaCompiler* compiler,
                                  const std::vector<XlaCompiler::Argument>& args,
                                  XlaCompiler::CompilationResult*)>& compile_fn);
 
+  // Fills `entry` from the persistent cache. Returns false, leaving `entry`
+  // untouched, if there is no usable entry for `key`.
+  bool LoadFromPersistentCache(const XlaCompiler::Options& options,
+                               const string& key, Entry* entry)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(entry->mu);
+  void StoreInPersistentCache(const string& key, const Entry& entry)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(entry.mu);
+
+  // Null unless --tf_xla_persistent_cache_directory is set.
+  std::unique_ptr<XlaCompilationDiskCache> disk_cache_;
+
   mutex compile_cache_mu_;
   absl::flat_hash_map<Signature, std::unique_ptr<Entry>, Signature::Hash> cache_
       TF_GUARDED_BY(compile_cache_mu_);
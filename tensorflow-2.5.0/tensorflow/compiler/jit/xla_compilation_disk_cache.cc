@@ -0,0 +1,216 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/xla_compilation_disk_cache.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/compiler/xla/client/xla_computation.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/path.h"
+
+namespace tensorflow {
+
+namespace {
+
+constexpr char kEntrySuffix[] = ".xla_cache";
+
+}  // namespace
+
+XlaCompilationDiskCache::XlaCompilationDiskCache(Env* env, string directory,
+                                                 int64 max_size_bytes)
+    : env_(env),
+      directory_(std::move(directory)),
+      max_size_bytes_(max_size_bytes) {}
+
+string XlaCompilationDiskCache::EntryFilename(const string& key) const {
+  return io::JoinPath(directory_, absl::StrCat(key, kEntrySuffix));
+}
+
+Status XlaCompilationDiskCache::Lookup(const string& key,
+                                       XlaSerializedCompilation* compilation,
+                                       bool* found) const {
+  const string filename = EntryFilename(key);
+  Status s = ReadBinaryProto(env_, filename, compilation);
+  if (errors::IsNotFound(s)) {
+    *found = false;
+    return Status::OK();
+  }
+  TF_RETURN_IF_ERROR(s);
+  *found = true;
+  return Status::OK();
+}
+
+Status XlaCompilationDiskCache::Insert(
+    const string& key, const XlaSerializedCompilation& compilation) {
+  TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(directory_));
+  const string filename = EntryFilename(key);
+  string temp_filename = filename;
+  if (!env_->CreateUniqueFileName(&temp_filename, ".tmp")) {
+    return errors::Internal("Could not create a temporary file name for ",
+                            filename);
+  }
+  Status s = WriteBinaryProto(env_, temp_filename, compilation);
+  if (s.ok()) s = env_->RenameFile(temp_filename, filename);
+  if (!s.ok()) {
+    env_->DeleteFile(temp_filename).IgnoreError();
+    return s;
+  }
+  return MaybeEvict();
+}
+
+Status XlaCompilationDiskCache::MaybeEvict() {
+  if (max_size_bytes_ <= 0) return Status::OK();
+  mutex_lock lock(eviction_mu_);
+
+  struct CacheFile {
+    string path;
+    int64 mtime_nsec;
+    int64 length;
+  };
+  std::vector<string> children;
+  TF_RETURN_IF_ERROR(env_->GetChildren(directory_, &children));
+  std::vector<CacheFile> files;
+  int64 total_size = 0;
+  for (const string& child : children) {
+    if (!absl::EndsWith(child, kEntrySuffix)) continue;
+    const string path = io::JoinPath(directory_, child);
+    FileStatistics stats;
+    if (!env_->Stat(path, &stats).ok()) continue;
+    files.push_back({path, stats.mtime_nsec, stats.length});
+    total_size += stats.length;
+  }
+  if (total_size <= max_size_bytes_) return Status::OK();
+
+  std::sort(files.begin(), files.end(),
+            [](const CacheFile& a, const CacheFile& b) {
+              return a.mtime_nsec < b.mtime_nsec;
+            });
+  for (const CacheFile& file : files) {
+    if (total_size <= max_size_bytes_) break;
+    VLOG(1) << "Evicting " << file.path
+            << " from the persistent XLA compilation cache";
+    Status s = env_->DeleteFile(file.path);
+    if (!s.ok() && !errors::IsNotFound(s)) return s;
+    total_size -= file.length;
+  }
+  return Status::OK();
+}
+
+Status SerializeCompilationResult(const XlaCompiler::CompilationResult& result,
+                                  XlaSerializedCompilation* compilation) {
+  for (int index : result.input_mapping) {
+    compilation->add_input_mapping(index);
+  }
+  for (const xla::Shape& shape : result.xla_input_shapes) {
+    *compilation->add_xla_input_shapes() = shape.ToProto();
+  }
+  *compilation->mutable_xla_output_shape() = result.xla_output_shape.ToProto();
+  for (const XlaOutputDescription& output : result.outputs) {
+    XlaSerializedCompilation::OutputDescription* serialized =
+        compilation->add_outputs();
+    serialized->set_type(output.type);
+    output.shape.AsProto(serialized->mutable_shape());
+    serialized->set_is_constant(output.is_constant);
+    if (output.is_constant) {
+      output.constant_value.AsProtoTensorContent(
+          serialized->mutable_constant_value());
+    }
+    serialized->set_input_index(output.input_index);
+    serialized->set_is_tensor_list(output.is_tensor_list);
+  }
+  *compilation->mutable_host_compute_metadata() = result.host_compute_metadata;
+  for (const XlaResourceUpdate& update : result.resource_updates) {
+    XlaSerializedCompilation::ResourceUpdate* serialized =
+        compilation->add_resource_updates();
+    serialized->set_input_index(update.input_index);
+    serialized->set_type(update.type);
+    update.shape.AsProto(serialized->mutable_shape());
+    serialized->set_modified(update.modified);
+    for (const string& gradient : update.tensor_array_gradients_accessed) {
+      serialized->add_tensor_array_gradients_accessed(gradient);
+    }
+  }
+  if (result.computation == nullptr) {
+    return errors::InvalidArgument("Compilation result has no computation");
+  }
+  *compilation->mutable_computation() = result.computation->proto();
+  if (result.collective_reduce_info) {
+    auto* info = compilation->mutable_collective_reduce_info();
+    info->set_group_key(result.collective_reduce_info->group_key);
+    info->set_group_size(result.collective_reduce_info->group_size);
+  }
+  return Status::OK();
+}
+
+Status DeserializeCompilationResult(
+    const XlaSerializedCompilation& compilation,
+    XlaCompiler::CompilationResult* result) {
+  result->input_mapping.assign(compilation.input_mapping().begin(),
+                               compilation.input_mapping().end());
+  result->xla_input_shapes.clear();
+  for (const xla::ShapeProto& shape : compilation.xla_input_shapes()) {
+    result->xla_input_shapes.emplace_back(shape);
+  }
+  result->xla_output_shape = xla::Shape(compilation.xla_output_shape());
+  result->outputs.clear();
+  for (const auto& serialized : compilation.outputs()) {
+    XlaOutputDescription output;
+    output.type = serialized.type();
+    TF_RETURN_IF_ERROR(TensorShape::IsValidShape(serialized.shape()));
+    output.shape = TensorShape(serialized.shape());
+    output.is_constant = serialized.is_constant();
+    if (output.is_constant &&
+        !output.constant_value.FromProto(serialized.constant_value())) {
+      return errors::DataLoss("Could not parse constant output value");
+    }
+    output.input_index = serialized.input_index();
+    output.is_tensor_list = serialized.is_tensor_list();
+    result->outputs.push_back(std::move(output));
+  }
+  result->host_compute_metadata = compilation.host_compute_metadata();
+  result->resource_updates.clear();
+  for (const auto& serialized : compilation.resource_updates()) {
+    XlaResourceUpdate update;
+    update.input_index = serialized.input_index();
+    update.type = serialized.type();
+    TF_RETURN_IF_ERROR(TensorShape::IsValidShape(serialized.shape()));
+    update.shape = TensorShape(serialized.shape());
+    update.modified = serialized.modified();
+    update.tensor_array_gradients_accessed.insert(
+        serialized.tensor_array_gradients_accessed().begin(),
+        serialized.tensor_array_gradients_accessed().end());
+    result->resource_updates.push_back(std::move(update));
+  }
+  result->computation =
+      std::make_shared<xla::XlaComputation>(compilation.computation());
+  result->collective_reduce_info.reset();
+  if (compilation.has_collective_reduce_info()) {
+    result->collective_reduce_info =
+        XlaCompiler::CompilationResult::CollectiveReduceV2OpInfo{
+            compilation.collective_reduce_info().group_key(),
+            compilation.collective_reduce_info().group_size()};
+  }
+  return Status::OK();
+}
+
+}  // namespace tensorflow
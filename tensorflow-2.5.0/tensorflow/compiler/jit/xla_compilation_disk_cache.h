@@ -0,0 +1,81 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_XLA_COMPILATION_DISK_CACHE_H_
+#define TENSORFLOW_COMPILER_JIT_XLA_COMPILATION_DISK_CACHE_H_
+
+#include <string>
+
+#include "tensorflow/compiler/jit/xla_compilation_cache.pb.h"
+#include "tensorflow/compiler/tf2xla/xla_compiler.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A cache of compiled XLA clusters on disk, shared by every process that is
+// pointed at the same directory. Each entry lives in its own file named after
+// its key, so lookups never contend with each other, and entries are written
+// to a temporary file and renamed into place so readers, including those in
+// other processes, only ever see complete entries.
+//
+// Once the files in the directory exceed `max_size_bytes`, the least recently
+// written entries are deleted.
+class XlaCompilationDiskCache {
+ public:
+  // A non-positive `max_size_bytes` means the cache is unbounded.
+  XlaCompilationDiskCache(Env* env, string directory, int64 max_size_bytes);
+
+  // Reads the entry for `key` into `*compilation`. Sets `*found` to false if
+  // there is no such entry.
+  Status Lookup(const string& key, XlaSerializedCompilation* compilation,
+                bool* found) const;
+
+  // Stores `compilation` as the entry for `key` and evicts old entries if the
+  // cache has grown too large.
+  Status Insert(const string& key, const XlaSerializedCompilation& compilation);
+
+  const string& directory() const { return directory_; }
+
+ private:
+  string EntryFilename(const string& key) const;
+
+  Status MaybeEvict();
+
+  Env* const env_;
+  const string directory_;
+  const int64 max_size_bytes_;
+
+  // Serializes eviction scans within this process. Other processes may evict
+  // concurrently, so files vanishing under a scan are tolerated.
+  mutex eviction_mu_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(XlaCompilationDiskCache);
+};
+
+// Converts between an XlaCompiler::CompilationResult and its serialized form.
+// The optimized module is not part of the CompilationResult and is left
+// untouched.
+Status SerializeCompilationResult(const XlaCompiler::CompilationResult& result,
+                                  XlaSerializedCompilation* compilation);
+Status DeserializeCompilationResult(
+    const XlaSerializedCompilation& compilation,
+    XlaCompiler::CompilationResult* result);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_XLA_COMPILATION_DISK_CACHE_H_
@@ -0,0 +1,148 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/xla_compilation_disk_cache.h"
+
+#include "tensorflow/compiler/xla/client/xla_computation.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+string TestDirectory(const string& name) {
+  return io::JoinPath(testing::TmpDir(), "xla_compilation_disk_cache", name);
+}
+
+XlaSerializedCompilation MakeCompilation(const string& module_name) {
+  XlaSerializedCompilation compilation;
+  compilation.mutable_computation()->set_name(module_name);
+  compilation.mutable_optimized_module()->set_name(module_name + ".optimized");
+  return compilation;
+}
+
+TEST(XlaCompilationDiskCacheTest, LookupMissingEntry) {
+  XlaCompilationDiskCache cache(Env::Default(), TestDirectory("missing"),
+                                /*max_size_bytes=*/0);
+  XlaSerializedCompilation compilation;
+  bool found = true;
+  TF_ASSERT_OK(cache.Lookup("0123", &compilation, &found));
+  EXPECT_FALSE(found);
+}
+
+TEST(XlaCompilationDiskCacheTest, InsertAndLookup) {
+  const string directory = TestDirectory("insert");
+  {
+    XlaCompilationDiskCache cache(Env::Default(), directory,
+                                  /*max_size_bytes=*/0);
+    TF_ASSERT_OK(cache.Insert("abcd", MakeCompilation("cluster_0")));
+  }
+  // A second cache on the same directory, as in a restarted process, sees the
+  // entry.
+  XlaCompilationDiskCache cache(Env::Default(), directory,
+                                /*max_size_bytes=*/0);
+  XlaSerializedCompilation compilation;
+  bool found = false;
+  TF_ASSERT_OK(cache.Lookup("abcd", &compilation, &found));
+  EXPECT_TRUE(found);
+  EXPECT_EQ(compilation.computation().name(), "cluster_0");
+  EXPECT_EQ(compilation.optimized_module().name(), "cluster_0.optimized");
+}
+
+TEST(XlaCompilationDiskCacheTest, EvictsOldestEntries) {
+  const string directory = TestDirectory("evict");
+  const XlaSerializedCompilation compilation = MakeCompilation("cluster");
+  const int64 entry_size = compilation.ByteSizeLong();
+  XlaCompilationDiskCache cache(Env::Default(), directory,
+                                /*max_size_bytes=*/2 * entry_size);
+  TF_ASSERT_OK(cache.Insert("first", compilation));
+  Env::Default()->SleepForMicroseconds(10 * 1000);
+  TF_ASSERT_OK(cache.Insert("second", compilation));
+  Env::Default()->SleepForMicroseconds(10 * 1000);
+  TF_ASSERT_OK(cache.Insert("third", compilation));
+
+  XlaSerializedCompilation unused;
+  bool found = true;
+  TF_ASSERT_OK(cache.Lookup("first", &unused, &found));
+  EXPECT_FALSE(found);
+  TF_ASSERT_OK(cache.Lookup("second", &unused, &found));
+  EXPECT_TRUE(found);
+  TF_ASSERT_OK(cache.Lookup("third", &unused, &found));
+  EXPECT_TRUE(found);
+}
+
+TEST(XlaCompilationDiskCacheTest, CompilationResultRoundTrip) {
+  XlaCompiler::CompilationResult result;
+  result.input_mapping = {0, 2};
+  result.xla_input_shapes = {xla::ShapeUtil::MakeShape(xla::F32, {2, 3}),
+                             xla::ShapeUtil::MakeShape(xla::S32, {})};
+  result.xla_output_shape = xla::ShapeUtil::MakeTupleShape(
+      {xla::ShapeUtil::MakeShape(xla::F32, {2, 3})});
+  result.outputs.resize(2);
+  result.outputs[0].type = DT_FLOAT;
+  result.outputs[0].shape = TensorShape({2, 3});
+  result.outputs[1].type = DT_INT32;
+  result.outputs[1].shape = TensorShape({2});
+  result.outputs[1].is_constant = true;
+  result.outputs[1].constant_value = test::AsTensor<int32>({7, 8});
+  result.resource_updates.resize(1);
+  result.resource_updates[0].input_index = 1;
+  result.resource_updates[0].type = DT_FLOAT;
+  result.resource_updates[0].shape = TensorShape({4});
+  result.resource_updates[0].modified = true;
+  result.resource_updates[0].tensor_array_gradients_accessed = {"grad"};
+  xla::HloModuleProto module;
+  module.set_name("cluster_0");
+  result.computation = std::make_shared<xla::XlaComputation>(module);
+  result.collective_reduce_info =
+      XlaCompiler::CompilationResult::CollectiveReduceV2OpInfo{3, 4};
+
+  XlaSerializedCompilation compilation;
+  TF_ASSERT_OK(SerializeCompilationResult(result, &compilation));
+  XlaCompiler::CompilationResult restored;
+  TF_ASSERT_OK(DeserializeCompilationResult(compilation, &restored));
+
+  EXPECT_EQ(restored.input_mapping, result.input_mapping);
+  ASSERT_EQ(restored.xla_input_shapes.size(), 2);
+  EXPECT_TRUE(xla::ShapeUtil::Equal(restored.xla_input_shapes[0],
+                                    result.xla_input_shapes[0]));
+  EXPECT_TRUE(xla::ShapeUtil::Equal(restored.xla_input_shapes[1],
+                                    result.xla_input_shapes[1]));
+  EXPECT_TRUE(xla::ShapeUtil::Equal(restored.xla_output_shape,
+                                    result.xla_output_shape));
+  ASSERT_EQ(restored.outputs.size(), 2);
+  EXPECT_EQ(restored.outputs[0].type, DT_FLOAT);
+  EXPECT_EQ(restored.outputs[0].shape, TensorShape({2, 3}));
+  EXPECT_FALSE(restored.outputs[0].is_constant);
+  EXPECT_TRUE(restored.outputs[1].is_constant);
+  test::ExpectTensorEqual<int32>(restored.outputs[1].constant_value,
+                                 result.outputs[1].constant_value);
+  ASSERT_EQ(restored.resource_updates.size(), 1);
+  EXPECT_EQ(restored.resource_updates[0].input_index, 1);
+  EXPECT_EQ(restored.resource_updates[0].shape, TensorShape({4}));
+  EXPECT_TRUE(restored.resource_updates[0].modified);
+  EXPECT_EQ(restored.resource_updates[0].tensor_array_gradients_accessed,
+            result.resource_updates[0].tensor_array_gradients_accessed);
+  EXPECT_EQ(restored.computation->proto().name(), "cluster_0");
+  ASSERT_TRUE(restored.collective_reduce_info.has_value());
+  EXPECT_EQ(restored.collective_reduce_info->group_key, 3);
+  EXPECT_EQ(restored.collective_reduce_info->group_size, 4);
+}
+
+}  // namespace
+}  // namespace tensorflow
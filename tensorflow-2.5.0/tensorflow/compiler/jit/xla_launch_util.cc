@@ -231,6 +231,15 @@ static void PopulateExecutionInputBuffer(xla::ExecutionInput& execution_input,
   }
 }
 
+void XlaComputationLaunchContext::SetLeadingDimensionPadding(
+    std::vector<Tensor> padded_inputs, std::vector<bool> sliced_outputs,
+    int64 unpadded_size, int64 padded_size) {
+  padded_inputs_ = std::move(padded_inputs);
+  sliced_outputs_ = std::move(sliced_outputs);
+  unpadded_size_ = unpadded_size;
+  padded_size_ = padded_size;
+}
+
 xla::StatusOr<std::vector<xla::ExecutionInput>>
 XlaComputationLaunchContext::PopulateInputs(
     OpKernelContext* ctx,
@@ -259,9 +268,12 @@ XlaComputationLaunchContext::PopulateInputs(
                          return update.input_index == i && update.modified;
                        });
 
-    const Tensor* t = is_resource_variable
-                          ? resource_vars.at(arg_num)
-                          : &(ctx->input(arg_num - missing_ctx_input_prefix));
+    const Tensor* t =
+        is_resource_variable
+            ? resource_vars.at(arg_num)
+            : !padded_inputs_.empty()
+                  ? &padded_inputs_[arg_num - missing_ctx_input_prefix]
+                  : &(ctx->input(arg_num - missing_ctx_input_prefix));
     CHECK(t);
     bool donate_buffer =
         t->RefCountIsOne() && is_updated_resource_variable &&
@@ -537,9 +549,20 @@ Status XlaComputationLaunchContext::PopulateOutputs(
           "is not implemented");
     }
 
+    const bool sliced = !padded_inputs_.empty() &&
+                        i < sliced_outputs_.size() && sliced_outputs_[i];
+    if (sliced) {
+      TF_RET_CHECK(shape.dims() > 0 && shape.dim_size(0) == padded_size_)
+          << "Output " << i << " of shape " << shape.DebugString()
+          << " does not have " << padded_size_ << " rows";
+    }
     if (compilation_result->outputs[i].is_constant) {
       TF_RETURN_IF_ERROR(
           SetOutputForConstant(ctx, stream, compilation_result, i));
+      if (sliced) {
+        const Tensor constant = *ctx->mutable_output(i);
+        ctx->set_output(i, constant.Slice(0, unpadded_size_));
+      }
     } else if (type == DT_RESOURCE) {
       int input_index =
           compilation_result->outputs[i].input_index - missing_ctx_input_prefix;
@@ -555,7 +578,13 @@ Status XlaComputationLaunchContext::PopulateOutputs(
               resource_vars, ctx->expected_output_dtype(i), shape, allocator,
               allocate_xla_tensors_, stream, use_multiple_streams_,
               definition_event));
-      ctx->set_output(i, output_tensor);
+      if (sliced) {
+        // Slicing along the leading dimension from row zero keeps the output
+        // aliased with, and as aligned as, the padded buffer.
+        ctx->set_output(i, output_tensor.Slice(0, unpadded_size_));
+      } else {
+        ctx->set_output(i, output_tensor);
+      }
       ++output_num;
     }
   }
@@ -596,6 +625,7 @@ Status XlaComputationLaunchContext::PopulateOutputs(
                                    use_multiple_streams_, definition_event));
     var->is_initialized |= write.modified;
     *var->tensor() = output_tensor;
+    var->PublishSnapshot();
     ++output_num;
   }
   return Status::OK();
@@ -146,6 +146,14 @@ class XlaComputationLaunchContext {
                             absl::Span<VariableInfo const> variable_args,
                             Device* device);
 
+  // Makes PopulateInputs use `padded_inputs` in place of the kernel inputs and
+  // PopulateOutputs slice every output `i` with `sliced_outputs[i]` set from
+  // `padded_size` back to `unpadded_size` rows. Used when the computation was
+  // compiled for inputs padded up to a shape bucket.
+  void SetLeadingDimensionPadding(std::vector<Tensor> padded_inputs,
+                                  std::vector<bool> sliced_outputs,
+                                  int64 unpadded_size, int64 padded_size);
+
   // Add all inputs within `ctx` as XLA arguments (returned by arguments()).
   // `variables` is a map from TensorFlow argument number to resource variable.
   //
@@ -184,6 +192,12 @@ class XlaComputationLaunchContext {
   bool allocate_xla_tensors_;
   bool use_multiple_streams_;
   int device_ordinal_;
+
+  // Set by SetLeadingDimensionPadding; empty if inputs are not padded.
+  std::vector<Tensor> padded_inputs_;
+  std::vector<bool> sliced_outputs_;
+  int64 unpadded_size_ = 0;
+  int64 padded_size_ = 0;
 };
 
 // A simple TensorBuffer implementation that allows us to create Tensors that
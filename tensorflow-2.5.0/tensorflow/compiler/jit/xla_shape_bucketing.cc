@@ -0,0 +1,228 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/xla_shape_bucketing.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <memory>
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
+#include "tensorflow/compiler/jit/flags.h"
+#include "tensorflow/compiler/jit/shape_inference.h"
+#include "tensorflow/compiler/xla/status_macros.h"
+#include "tensorflow/core/common_runtime/function_body.h"
+#include "tensorflow/core/common_runtime/function_def_utils.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/stream_executor_no_cuda.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Infers the shapes of the outputs of `fdef` when its arguments have the
+// shapes of `inputs`, with their leading dimension replaced by `leading_dim`.
+Status InferOutputShapes(const FunctionDef& fdef, AttrSlice attrs,
+                         const FunctionLibraryDefinition& flib_def,
+                         absl::Span<const Tensor* const> inputs,
+                         int64 leading_dim,
+                         std::vector<PartialTensorShape>* output_shapes) {
+  std::unique_ptr<FunctionBody> fbody;
+  TF_RETURN_IF_ERROR(FunctionDefToBodyHelper(fdef, attrs, &flib_def, &fbody));
+  std::map<int, InferredShape> arg_shapes;
+  for (int i = 0; i < inputs.size(); ++i) {
+    TensorShape shape = inputs[i]->shape();
+    shape.set_dim(0, leading_dim);
+    arg_shapes[i].shape = shape;
+  }
+  GraphShapeInfo shape_info;
+  TF_RETURN_IF_ERROR(
+      InferShapes(fbody->graph, arg_shapes, &flib_def, &shape_info));
+
+  output_shapes->clear();
+  for (const Node* ret : fbody->ret_nodes) {
+    const Edge* edge;
+    TF_RETURN_IF_ERROR(ret->input_edge(0, &edge));
+    auto it = shape_info.find(edge->src()->name());
+    if (it == shape_info.end() || edge->src_output() >= it->second.size()) {
+      return errors::InvalidArgument("No shape inferred for output ",
+                                     output_shapes->size(), " of ",
+                                     fdef.signature().name());
+    }
+    output_shapes->push_back(it->second[edge->src_output()].shape);
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+/*static*/ xla::StatusOr<XlaShapeBucketingPolicy>
+XlaShapeBucketingPolicy::Parse(absl::string_view spec) {
+  XlaShapeBucketingPolicy policy;
+  spec = absl::StripAsciiWhitespace(spec);
+  if (spec.empty()) {
+    return policy;
+  }
+  if (spec == "powers_of_two") {
+    policy.powers_of_two_ = true;
+    return policy;
+  }
+  for (absl::string_view piece : absl::StrSplit(spec, ',')) {
+    int64 boundary;
+    if (!absl::SimpleAtoi(absl::StripAsciiWhitespace(piece), &boundary) ||
+        boundary <= 0) {
+      return errors::InvalidArgument("Invalid XLA shape bucket '", piece,
+                                     "' in '", spec, "'");
+    }
+    if (!policy.boundaries_.empty() && boundary <= policy.boundaries_.back()) {
+      return errors::InvalidArgument(
+          "XLA shape buckets must be strictly increasing: '", spec, "'");
+    }
+    policy.boundaries_.push_back(boundary);
+  }
+  return policy;
+}
+
+/*static*/ const XlaShapeBucketingPolicy& XlaShapeBucketingPolicy::Get() {
+  static const XlaShapeBucketingPolicy* policy = [] {
+    xla::StatusOr<XlaShapeBucketingPolicy> parsed =
+        Parse(GetXlaOpsCommonFlags().tf_xla_shape_buckets);
+    if (!parsed.ok()) {
+      LOG(ERROR) << "Disabling XLA shape bucketing: " << parsed.status();
+      return new XlaShapeBucketingPolicy();
+    }
+    return new XlaShapeBucketingPolicy(parsed.ConsumeValueOrDie());
+  }();
+  return *policy;
+}
+
+int64 XlaShapeBucketingPolicy::BucketFor(int64 size) const {
+  if (powers_of_two_) {
+    if (size > (int64{1} << 62)) {
+      return size;
+    }
+    int64 bucket = 1;
+    while (bucket < size) {
+      bucket <<= 1;
+    }
+    return bucket;
+  }
+  auto it = std::lower_bound(boundaries_.begin(), boundaries_.end(), size);
+  return it == boundaries_.end() ? size : *it;
+}
+
+absl::optional<int64> GetBucketableLeadingDimension(
+    absl::Span<const Tensor* const> inputs, absl::Span<const int> constants,
+    absl::Span<const int> resources) {
+  if (inputs.empty() || !constants.empty() || !resources.empty()) {
+    return absl::nullopt;
+  }
+  absl::optional<int64> leading_dim;
+  for (const Tensor* input : inputs) {
+    if (input == nullptr || input->dims() == 0 ||
+        input->NumElements() == 0 || !DataTypeCanUseMemcpy(input->dtype())) {
+      return absl::nullopt;
+    }
+    if (leading_dim.has_value() && *leading_dim != input->dim_size(0)) {
+      return absl::nullopt;
+    }
+    leading_dim = input->dim_size(0);
+  }
+  return leading_dim;
+}
+
+xla::StatusOr<std::vector<bool>> GetOutputsFollowingLeadingDimension(
+    const FunctionDef& fdef, AttrSlice attrs,
+    const FunctionLibraryDefinition& flib_def,
+    absl::Span<const Tensor* const> inputs) {
+  TF_RET_CHECK(!inputs.empty() && inputs[0]->dims() > 0);
+  const int64 first_size = inputs[0]->dim_size(0);
+  const int64 second_size = first_size + 1;
+  std::vector<PartialTensorShape> first_shapes;
+  std::vector<PartialTensorShape> second_shapes;
+  TF_RETURN_IF_ERROR(InferOutputShapes(fdef, attrs, flib_def, inputs,
+                                       first_size, &first_shapes));
+  TF_RETURN_IF_ERROR(InferOutputShapes(fdef, attrs, flib_def, inputs,
+                                       second_size, &second_shapes));
+  TF_RET_CHECK(first_shapes.size() == second_shapes.size());
+
+  std::vector<bool> follows_leading_dim(first_shapes.size());
+  for (int i = 0; i < first_shapes.size(); ++i) {
+    const PartialTensorShape& first = first_shapes[i];
+    const PartialTensorShape& second = second_shapes[i];
+    if (!first.IsFullyDefined() || !second.IsFullyDefined()) {
+      return errors::InvalidArgument(
+          "Cannot infer the shape of output ", i, " of ",
+          fdef.signature().name(), ": ", first.DebugString());
+    }
+    if (first.IsIdenticalTo(second)) {
+      continue;
+    }
+    bool follows = first.dims() > 0 && first.dims() == second.dims() &&
+                   first.dim_size(0) == first_size &&
+                   second.dim_size(0) == second_size;
+    for (int d = 1; follows && d < first.dims(); ++d) {
+      follows = first.dim_size(d) == second.dim_size(d);
+    }
+    if (!follows) {
+      return errors::InvalidArgument(
+          "The shape of output ", i, " of ", fdef.signature().name(),
+          " depends on the leading dimension of the inputs: ",
+          first.DebugString(), " vs ", second.DebugString());
+    }
+    follows_leading_dim[i] = true;
+  }
+  return follows_leading_dim;
+}
+
+Status PadLeadingDimension(OpKernelContext* ctx, const Tensor& input,
+                           int64 padded_size, Tensor* output) {
+  TF_RET_CHECK(input.dims() > 0 && padded_size >= input.dim_size(0));
+  TensorShape padded_shape = input.shape();
+  padded_shape.set_dim(0, padded_size);
+  TF_RETURN_IF_ERROR(ctx->allocate_temp(input.dtype(), padded_shape, output));
+
+  const uint64 copy_bytes = input.TotalBytes();
+  const uint64 pad_bytes = output->TotalBytes() - copy_bytes;
+  char* dst = static_cast<char*>(output->data());
+  se::Stream* stream =
+      ctx->op_device_context() ? ctx->op_device_context()->stream() : nullptr;
+  if (stream == nullptr) {
+    std::memcpy(dst, input.data(), copy_bytes);
+    std::memset(dst + copy_bytes, 0, pad_bytes);
+    return Status::OK();
+  }
+
+  se::DeviceMemoryBase src_mem(input.data(), copy_bytes);
+  se::DeviceMemoryBase dst_mem(dst, copy_bytes);
+  se::DeviceMemoryBase pad_mem(dst + copy_bytes, pad_bytes);
+  stream->ThenMemcpy(&dst_mem, src_mem, copy_bytes);
+  if (pad_bytes > 0) {
+    stream->ThenMemZero(&pad_mem, pad_bytes);
+  }
+  if (!stream->ok()) {
+    return errors::Internal("Failed to pad XLA cluster input to ",
+                            padded_size, " rows");
+  }
+  return Status::OK();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,88 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_XLA_SHAPE_BUCKETING_H_
+#define TENSORFLOW_COMPILER_JIT_XLA_SHAPE_BUCKETING_H_
+
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
+#include "tensorflow/compiler/xla/statusor.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Rounds the leading dimension of cluster inputs up to a bucket, so that an
+// XLA cluster fed with many distinct batch sizes is only compiled once per
+// bucket instead of once per size.
+class XlaShapeBucketingPolicy {
+ public:
+  // Returns a disabled policy.
+  XlaShapeBucketingPolicy() = default;
+
+  // Parses `spec`, which is either empty (bucketing disabled),
+  // "powers_of_two", or a comma-separated, strictly increasing list of
+  // positive bucket sizes.
+  static xla::StatusOr<XlaShapeBucketingPolicy> Parse(absl::string_view spec);
+
+  // Returns the policy configured by the --tf_xla_shape_buckets flag. An
+  // invalid flag value is logged once and disables bucketing.
+  static const XlaShapeBucketingPolicy& Get();
+
+  bool enabled() const { return powers_of_two_ || !boundaries_.empty(); }
+
+  // Returns the smallest bucket that is at least `size`, or `size` itself if it
+  // exceeds every bucket.
+  int64 BucketFor(int64 size) const;
+
+ private:
+  bool powers_of_two_ = false;
+  std::vector<int64> boundaries_;
+};
+
+// Returns the leading dimension shared by all `inputs` if the cluster they
+// feed can be bucketed: it has no compile-time constant or resource inputs,
+// and every input is a non-empty, numeric tensor of rank at least one with the
+// same leading dimension. Returns nullopt otherwise.
+absl::optional<int64> GetBucketableLeadingDimension(
+    absl::Span<const Tensor* const> inputs, absl::Span<const int> constants,
+    absl::Span<const int> resources);
+
+// Returns, for each output of the cluster function `fdef` instantiated with
+// `attrs`, whether its leading dimension is the leading dimension shared by
+// the cluster `inputs`, i.e. whether the output has to be sliced back when the
+// inputs are padded. The mapping is derived by inferring the shapes of the
+// outputs for two different leading dimensions of the inputs. Returns an error
+// if an output shape is not fully inferred, or depends on the leading
+// dimension of the inputs in any other way.
+xla::StatusOr<std::vector<bool>> GetOutputsFollowingLeadingDimension(
+    const FunctionDef& fdef, AttrSlice attrs,
+    const FunctionLibraryDefinition& flib_def,
+    absl::Span<const Tensor* const> inputs);
+
+// Copies `input` into a new tensor on the device of `ctx` whose leading
+// dimension is `padded_size`, filling the extra rows with zeros.
+Status PadLeadingDimension(OpKernelContext* ctx, const Tensor& input,
+                           int64 padded_size, Tensor* output);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_XLA_SHAPE_BUCKETING_H_
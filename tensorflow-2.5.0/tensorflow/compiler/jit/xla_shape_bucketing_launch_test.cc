@@ -0,0 +1,190 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Tests of the XlaLaunch kernel with --tf_xla_shape_buckets=8. The flag is
+// parsed once per process, so these tests live in their own binary and set it
+// before running any kernel.
+
+#include <stdlib.h>
+
+#include <memory>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/cc/framework/ops.h"
+#include "tensorflow/cc/ops/array_ops.h"
+#include "tensorflow/compiler/jit/defs.h"
+#include "tensorflow/compiler/jit/xla_activity_listener.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr char kCpu[] = "/job:localhost/replica:0/task:0/device:CPU:0";
+
+class TestListener : public XlaActivityListener {
+ public:
+  Status Listen(
+      const XlaAutoClusteringActivity& auto_clustering_activity) override {
+    return Status::OK();
+  }
+
+  Status Listen(
+      const XlaJitCompilationActivity& jit_compilation_activity) override {
+    jit_compilation_activity_ = jit_compilation_activity;
+    return Status::OK();
+  }
+
+  Status Listen(const XlaOptimizationRemark& optimization_remark) override {
+    return Status::OK();
+  }
+
+  const XlaJitCompilationActivity& jit_compilation_activity() const {
+    return jit_compilation_activity_;
+  }
+
+ private:
+  XlaJitCompilationActivity jit_compilation_activity_;
+};
+
+// A cluster function whose first output follows the leading dimension of its
+// input, and whose second output has as many rows as the bucket without
+// following the leading dimension of the input.
+FunctionDef RowsFunction(const string& name, bool shape_bucketing) {
+  FunctionDef fdef = FunctionDefHelper::Define(
+      name, {"x: float"}, {"doubled: float", "tiled: float"}, {},
+      {{{"doubled"}, "Add", {"x", "x"}, {{"T", DT_FLOAT}}},
+       {{"axis"},
+        "Const",
+        {},
+        {{"value", test::AsScalar<int32>(0)}, {"dtype", DT_INT32}}},
+       {{"total"},
+        "Sum",
+        {"x", "axis"},
+        {{"T", DT_FLOAT}, {"Tidx", DT_INT32}, {"keep_dims", true}}},
+       {{"multiples"},
+        "Const",
+        {},
+        {{"value", test::AsTensor<int32>({8, 1})}, {"dtype", DT_INT32}}},
+       {{"tiled"},
+        "Tile",
+        {"total", "multiples"},
+        {{"T", DT_FLOAT}, {"Tmultiples", DT_INT32}}}});
+  if (shape_bucketing) {
+    (*fdef.mutable_attr())[kXlaShapeBucketingAttr].set_b(true);
+  }
+  return fdef;
+}
+
+GraphDef CreateGraphDef(const FunctionDef& fdef) {
+  Scope root = Scope::NewRootScope().ExitOnError().WithAssignedDevice(kCpu);
+  Output x = ops::Placeholder(root.WithOpName("x"), DT_FLOAT);
+  NameAttrList function;
+  function.set_name(fdef.signature().name());
+  Node* launch;
+  TF_CHECK_OK(NodeBuilder("launch", "XlaLaunch")
+                  .Input(std::vector<NodeBuilder::NodeOut>())
+                  .Input({NodeBuilder::NodeOut(x.node())})
+                  .Input(std::vector<NodeBuilder::NodeOut>())
+                  .Attr("Tresults", DataTypeVector({DT_FLOAT, DT_FLOAT}))
+                  .Attr("function", function)
+                  .Device(kCpu)
+                  .Finalize(root.graph(), &launch));
+
+  GraphDef graph_def;
+  root.graph()->ToGraphDef(&graph_def);
+  *graph_def.mutable_library()->add_function() = fdef;
+  return graph_def;
+}
+
+Tensor MakeInput(int num_rows) {
+  Tensor x(DT_FLOAT, TensorShape({num_rows, 2}));
+  test::FillIota<float>(&x, 1);
+  return x;
+}
+
+class XlaShapeBucketingLaunchTest : public ::testing::Test {
+ protected:
+  XlaShapeBucketingLaunchTest() {
+    auto listener = absl::make_unique<TestListener>();
+    listener_ = listener.get();
+    RegisterXlaActivityListener(std::move(listener));
+  }
+
+  // Runs the cluster of `fdef` for inputs of 3 and then 5 rows, which share
+  // the bucket of 8 rows, and checks the outputs of each launch.
+  void RunCluster(const FunctionDef& fdef) {
+    std::unique_ptr<Session> session(NewSession(SessionOptions()));
+    TF_ASSERT_OK(session->Create(CreateGraphDef(fdef)));
+    for (int num_rows : {3, 5}) {
+      const Tensor x = MakeInput(num_rows);
+      std::vector<Tensor> outputs;
+      TF_ASSERT_OK(session->Run({{"x", x}}, {"launch:0", "launch:1"},
+                                /*target_node_names=*/{}, &outputs));
+      ASSERT_EQ(outputs.size(), 2);
+
+      Tensor doubled(DT_FLOAT, x.shape());
+      test::FillFn<float>(&doubled,
+                          [&x](int i) { return 2 * x.flat<float>()(i); });
+      test::ExpectTensorEqual<float>(doubled, outputs[0]);
+
+      // Padding rows are zero, so they don't change the column sums.
+      float column_sums[2] = {0, 0};
+      for (int i = 0; i < x.NumElements(); ++i) {
+        column_sums[i % 2] += x.flat<float>()(i);
+      }
+      Tensor tiled(DT_FLOAT, TensorShape({8, 2}));
+      test::FillFn<float>(&tiled,
+                          [&column_sums](int i) { return column_sums[i % 2]; });
+      test::ExpectTensorEqual<float>(tiled, outputs[1]);
+    }
+  }
+
+  const XlaJitCompilationActivity& jit_compilation_activity() const {
+    return listener_->jit_compilation_activity();
+  }
+
+ private:
+  TestListener* listener_;
+};
+
+TEST_F(XlaShapeBucketingLaunchTest, OptedInClusterCompilesOncePerBucket) {
+  ASSERT_NO_FATAL_FAILURE(
+      RunCluster(RowsFunction("Bucketed", /*shape_bucketing=*/true)));
+  EXPECT_EQ(jit_compilation_activity().cluster_name(), "Bucketed");
+  EXPECT_EQ(jit_compilation_activity().compile_count(), 1);
+}
+
+TEST_F(XlaShapeBucketingLaunchTest, ClusterWithoutOptInIsNotPadded) {
+  ASSERT_NO_FATAL_FAILURE(
+      RunCluster(RowsFunction("NotBucketed", /*shape_bucketing=*/false)));
+  EXPECT_EQ(jit_compilation_activity().cluster_name(), "NotBucketed");
+  EXPECT_EQ(jit_compilation_activity().compile_count(), 2);
+}
+
+}  // namespace
+}  // namespace tensorflow
+
+int main(int argc, char** argv) {
+  setenv("TF_XLA_FLAGS", "--tf_xla_shape_buckets=8", /*overwrite=*/1);
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
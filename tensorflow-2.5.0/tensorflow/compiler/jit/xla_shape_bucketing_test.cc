@@ -0,0 +1,137 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/xla_shape_bucketing.h"
+
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(XlaShapeBucketingPolicyTest, EmptySpecDisablesBucketing) {
+  TF_ASSERT_OK_AND_ASSIGN(XlaShapeBucketingPolicy policy,
+                          XlaShapeBucketingPolicy::Parse(""));
+  EXPECT_FALSE(policy.enabled());
+}
+
+TEST(XlaShapeBucketingPolicyTest, PowersOfTwo) {
+  TF_ASSERT_OK_AND_ASSIGN(XlaShapeBucketingPolicy policy,
+                          XlaShapeBucketingPolicy::Parse("powers_of_two"));
+  EXPECT_TRUE(policy.enabled());
+  EXPECT_EQ(policy.BucketFor(1), 1);
+  EXPECT_EQ(policy.BucketFor(3), 4);
+  EXPECT_EQ(policy.BucketFor(64), 64);
+  EXPECT_EQ(policy.BucketFor(65), 128);
+}
+
+TEST(XlaShapeBucketingPolicyTest, ExplicitBoundaries) {
+  TF_ASSERT_OK_AND_ASSIGN(XlaShapeBucketingPolicy policy,
+                          XlaShapeBucketingPolicy::Parse("8, 32,100"));
+  EXPECT_TRUE(policy.enabled());
+  EXPECT_EQ(policy.BucketFor(1), 8);
+  EXPECT_EQ(policy.BucketFor(8), 8);
+  EXPECT_EQ(policy.BucketFor(9), 32);
+  EXPECT_EQ(policy.BucketFor(100), 100);
+  // Sizes beyond the last bucket are not padded.
+  EXPECT_EQ(policy.BucketFor(101), 101);
+}
+
+TEST(XlaShapeBucketingPolicyTest, InvalidSpecs) {
+  EXPECT_FALSE(XlaShapeBucketingPolicy::Parse("8,x").ok());
+  EXPECT_FALSE(XlaShapeBucketingPolicy::Parse("0,8").ok());
+  EXPECT_FALSE(XlaShapeBucketingPolicy::Parse("8,8").ok());
+  EXPECT_FALSE(XlaShapeBucketingPolicy::Parse("16,8").ok());
+}
+
+TEST(GetBucketableLeadingDimensionTest, SharedLeadingDimension) {
+  Tensor a(DT_FLOAT, TensorShape({5, 3}));
+  Tensor b(DT_INT32, TensorShape({5}));
+  EXPECT_EQ(GetBucketableLeadingDimension({&a, &b}, {}, {}), 5);
+}
+
+TEST(GetBucketableLeadingDimensionTest, RejectsIneligibleClusters) {
+  Tensor a(DT_FLOAT, TensorShape({5, 3}));
+  Tensor b(DT_FLOAT, TensorShape({4, 3}));
+  Tensor scalar(DT_FLOAT, TensorShape({}));
+  Tensor empty(DT_FLOAT, TensorShape({0, 3}));
+  Tensor str(DT_STRING, TensorShape({5}));
+  EXPECT_FALSE(GetBucketableLeadingDimension({&a, &b}, {}, {}).has_value());
+  EXPECT_FALSE(
+      GetBucketableLeadingDimension({&a, &scalar}, {}, {}).has_value());
+  EXPECT_FALSE(GetBucketableLeadingDimension({&empty}, {}, {}).has_value());
+  EXPECT_FALSE(GetBucketableLeadingDimension({&a, &str}, {}, {}).has_value());
+  EXPECT_FALSE(GetBucketableLeadingDimension({&a}, {0}, {}).has_value());
+  EXPECT_FALSE(GetBucketableLeadingDimension({&a}, {}, {0}).has_value());
+}
+
+// A function with an output that follows the leading dimension of its input,
+// and one that doesn't.
+FunctionDef RowsFunction() {
+  return FunctionDefHelper::Define(
+      "Rows", {"x: float"}, {"doubled: float", "total: float"}, {},
+      {{{"doubled"}, "Add", {"x", "x"}, {{"T", DT_FLOAT}}},
+       {{"axis"},
+        "Const",
+        {},
+        {{"value", test::AsScalar<int32>(0)}, {"dtype", DT_INT32}}},
+       {{"total"},
+        "Sum",
+        {"x", "axis"},
+        {{"T", DT_FLOAT}, {"Tidx", DT_INT32}}}});
+}
+
+// A function whose output depends on the leading dimension of its input
+// without following it.
+FunctionDef FlattenFunction() {
+  return FunctionDefHelper::Define(
+      "Flatten", {"x: float"}, {"flat: float"}, {},
+      {{{"shape"},
+        "Const",
+        {},
+        {{"value", test::AsTensor<int32>({-1})}, {"dtype", DT_INT32}}},
+       {{"flat"}, "Reshape", {"x", "shape"}, {{"T", DT_FLOAT}}}});
+}
+
+TEST(GetOutputsFollowingLeadingDimensionTest, MapsOutputsByShape) {
+  FunctionDefLibrary library;
+  *library.add_function() = RowsFunction();
+  FunctionLibraryDefinition flib_def(OpRegistry::Global(), library);
+  // The other output happens to have as many rows as the input, but doesn't
+  // follow its leading dimension.
+  Tensor x(DT_FLOAT, TensorShape({2, 2}));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::vector<bool> follows_leading_dim,
+      GetOutputsFollowingLeadingDimension(*flib_def.Find("Rows"), AttrSlice(),
+                                          flib_def, {&x}));
+  EXPECT_EQ(follows_leading_dim, std::vector<bool>({true, false}));
+}
+
+TEST(GetOutputsFollowingLeadingDimensionTest, RejectsOtherDependencies) {
+  FunctionDefLibrary library;
+  *library.add_function() = FlattenFunction();
+  FunctionLibraryDefinition flib_def(OpRegistry::Global(), library);
+  Tensor x(DT_FLOAT, TensorShape({3, 2}));
+  EXPECT_FALSE(GetOutputsFollowingLeadingDimension(*flib_def.Find("Flatten"),
+                                                   AttrSlice(), flib_def, {&x})
+                   .ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
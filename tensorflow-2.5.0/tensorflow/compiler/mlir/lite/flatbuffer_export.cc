@@ -670,6 +670,23 @@ Optional<BufferOffset<tflite::Buffer>> Translator::BuildBuffer(
     return empty_buffer_;
   }
 
+  // Non-splat dense int and float attributes store their elements in the same
+  // byte layout as TFLite buffers, so they can be serialized directly. This
+  // avoids materializing (potentially very large) weights as an intermediate
+  // TensorProto and Tensor.
+  if (auto dense_attr = attr.dyn_cast<mlir::DenseElementsAttr>()) {
+    mlir::Type element_type = dense_attr.getType().getElementType();
+    if (!dense_attr.isSplat() &&
+        (element_type.isa<mlir::FloatType>() ||
+         (element_type.isa<mlir::IntegerType>() &&
+          element_type.getIntOrFloatBitWidth() % 8 == 0))) {
+      llvm::ArrayRef<char> raw_data = dense_attr.getRawData();
+      auto buffer_data = builder_.CreateVector(
+          reinterpret_cast<const uint8_t*>(raw_data.data()), raw_data.size());
+      return tflite::CreateBuffer(builder_, buffer_data);
+    }
+  }
+
   tensorflow::Tensor tensor;
   auto status = tensorflow::ConvertToTensor(attr, &tensor);
   if (!status.ok()) {
@@ -88,6 +88,37 @@ class AsyncCompilationTest(test.TestCase):
                 trace_level=config_pb2.RunOptions.FULL_TRACE))
         hasXlaRunOp = MetadataHasXlaRunOp(run_metadata)
 
+  def testAsyncCompilationNewShape(self):
+
+    @function.Defun(compiled=True)
+    def CompiledFunction(x):
+      return math_ops.log(x)
+
+    with session_lib.Session() as sess:
+      x = array_ops.placeholder(dtypes.float32)
+      y = CompiledFunction(x)
+
+      def RunAndCheckXlaRun(size):
+        run_metadata = config_pb2.RunMetadata()
+        sess.run(
+            y,
+            feed_dict={x: [1.] * size},
+            run_metadata=run_metadata,
+            options=config_pb2.RunOptions(
+                trace_level=config_pb2.RunOptions.FULL_TRACE))
+        return MetadataHasXlaRunOp(run_metadata)
+
+      while not RunAndCheckXlaRun(10):
+        pass
+
+      # A new shape is compiled in the background too: the step runs the
+      # fallback path instead of waiting for the compilation.
+      self.assertFalse(RunAndCheckXlaRun(20))
+      while not RunAndCheckXlaRun(20):
+        pass
+      # The executable compiled for the first shape is still used.
+      self.assertTrue(RunAndCheckXlaRun(10))
+
 
 if __name__ == "__main__":
   os.environ["TF_XLA_FLAGS"] = ("--tf_xla_async_compilation=true " +
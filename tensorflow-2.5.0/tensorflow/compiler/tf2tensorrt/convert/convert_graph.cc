@@ -744,6 +744,15 @@ Status ConvertAfterShapes(const ConversionParams& params) {
     segment_options.maximum_batch_size = params.max_batch_size;
   segment_options.allow_dynamic_non_batch_dim =
       AllowDynamicNonBatchDimension(params);
+  segment_options.minimum_segment_speedup = params.minimum_segment_speedup;
+  if (params.cluster != nullptr) {
+    for (const auto& device : params.cluster->GetDevices()) {
+      if (device.second.type() == "GPU") {
+        segment_options.device_properties = device.second;
+        break;
+      }
+    }
+  }
 
   segment::SegmentVector initial_segments;
   TrtNodeValidator validator(static_graph_properties, params.precision_mode,
@@ -40,6 +40,9 @@ struct ConversionParams {
   GraphDef* output_graph_def = nullptr;
   TrtPrecisionMode precision_mode = TrtPrecisionMode::FP32;
   int minimum_segment_size = 3;
+  // Segments estimated to be less than this much faster with TensorRT are
+  // left to TF. 0 disables the segment cost estimates.
+  float minimum_segment_speedup = 0;
   const grappler::Cluster* cluster = nullptr;
   // Whether to create engine on conversion or execution time
   bool is_dyn_op = false;
@@ -48,6 +48,9 @@ Status TRTOptimizationPass::Init(
   if (params.count("minimum_segment_size")) {
     minimum_segment_size_ = params.at("minimum_segment_size").i();
   }
+  if (params.count("minimum_segment_speedup")) {
+    minimum_segment_speedup_ = params.at("minimum_segment_speedup").f();
+  }
   if (params.count("max_batch_size")) {
     maximum_batch_size_ = params.at("max_batch_size").i();
   }
@@ -241,6 +244,7 @@ Status TRTOptimizationPass::Optimize(grappler::Cluster* cluster,
   cp.output_graph_def = optimized_graph;
   cp.precision_mode = precision_mode_;
   cp.minimum_segment_size = minimum_segment_size_;
+  cp.minimum_segment_speedup = minimum_segment_speedup_;
   cp.cluster = cluster;
   cp.is_dyn_op = is_dynamic_op_;
   cp.max_cached_engines = max_cached_batches_;
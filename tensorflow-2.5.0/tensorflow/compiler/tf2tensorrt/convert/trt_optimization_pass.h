@@ -35,6 +35,7 @@ class TRTOptimizationPass : public grappler::CustomGraphOptimizer {
       : name_(name),
         trt_logger_name_("DefaultLogger"),
         minimum_segment_size_(3),
+        minimum_segment_speedup_(0),
         precision_mode_(TrtPrecisionMode::FP32),
         maximum_batch_size_(-1),
         is_dynamic_op_(false),
@@ -68,6 +69,7 @@ class TRTOptimizationPass : public grappler::CustomGraphOptimizer {
   const string name_;
   string trt_logger_name_;
   int minimum_segment_size_;
+  float minimum_segment_speedup_;
   TrtPrecisionMode precision_mode_;
   int maximum_batch_size_;
   bool is_dynamic_op_;
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/compiler/tf2tensorrt/convert/convert_nodes.h"
 #include "tensorflow/compiler/tf2tensorrt/convert/utils.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_allocator.h"
+#include "tensorflow/compiler/tf2tensorrt/utils/trt_engine_instance.pb.h"  // NOLINT
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_engine_utils.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_logger.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_lru_cache.h"
@@ -38,8 +39,12 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stream_executor.h"
@@ -193,6 +198,24 @@ class TRTEngineOp : public AsyncOpKernel {
       bool use_calibration, TRTInt8Calibrator* calibrator,
       TRTEngineCacheResource* cache_resource);
 
+  // Returns the path in engine_cache_dir_ of the engine for the given input
+  // shapes, or in explicit batch mode for the profiles of `cache_resource`.
+  // The name identifies the segment, the TensorRT version and the GPU
+  // architecture, as engines can't be reused across them.
+  StatusOr<string> GetPersistedEnginePath(
+      const std::vector<TensorShape>& input_concrete_shapes,
+      OpKernelContext* ctx, TRTEngineCacheResource* cache_resource);
+
+  // Loads the engine persisted at `path` by a previous run, if any.
+  // Returns nullptr if there is none or it can't be deserialized.
+  TrtUniquePtrType<nvinfer1::ICudaEngine> LoadPersistedEngine(
+      const string& path, TRTEngineCacheResource* cache_resource);
+
+  // Writes `engine` to `path` so that later runs don't need to build it.
+  Status PersistEngine(const string& path,
+                       const std::vector<TensorShape>& input_concrete_shapes,
+                       nvinfer1::ICudaEngine* engine);
+
   // Verify that the input shapes are consistent and can be handled by this op.
   Status VerifyInputShapes(const std::vector<TensorShape>& shapes);
 
@@ -238,6 +261,13 @@ class TRTEngineOp : public AsyncOpKernel {
   // Maximum number of cached engines.
   int max_cached_engines_;
 
+  // The directory, from TF_TRT_ENGINE_CACHE_DIR, where the engines built at
+  // runtime are persisted and looked up before building engines, if not empty.
+  string engine_cache_dir_;
+
+  // Fingerprint of segment_graph_def_, set if engine_cache_dir_ is.
+  uint64 segment_fingerprint_ = 0;
+
   int64 workspace_size_;
   mutex engine_mutex_;
   FunctionLibraryRuntime::Handle native_execution_func_handle_;
@@ -487,6 +517,23 @@ TRTEngineOp::TRTEngineOp(OpKernelConstruction* context)
       [](PartialTensorShape shape) { return !shape.IsFullyDefined(); });
   VLOG(2) << "TRTEngineOp has_dynamic_shape_input_: "
           << has_dynamic_shape_input_;
+
+  // Engines that are calibrated at runtime depend on the calibration data, so
+  // they aren't persisted.
+  if (!static_engine_ && !use_calibration_) {
+    OP_REQUIRES_OK(context,
+                   ReadStringFromEnvVar("TF_TRT_ENGINE_CACHE_DIR", "",
+                                        &engine_cache_dir_));
+  }
+  if (!engine_cache_dir_.empty()) {
+    string serialized_segment_graph;
+    OP_REQUIRES(context,
+                SerializeToStringDeterministic(segment_graph_def_,
+                                               &serialized_segment_graph),
+                errors::Internal("Failed to serialize the segment of ",
+                                 name()));
+    segment_fingerprint_ = Fingerprint64(serialized_segment_graph);
+  }
 }
 
 void TRTEngineOp::ExecuteNativeSegment(OpKernelContext* ctx,
@@ -919,6 +966,95 @@ StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> TRTEngineOp::BuildEngine(
   return engine;
 }
 
+StatusOr<string> TRTEngineOp::GetPersistedEnginePath(
+    const std::vector<TensorShape>& input_concrete_shapes,
+    OpKernelContext* ctx, TRTEngineCacheResource* cache_resource) {
+  const int gpu_id = ctx->device()->tensorflow_gpu_device_info()->gpu_id;
+  int sm_major = 0;
+  int sm_minor = 0;
+  if (cudaDeviceGetAttribute(&sm_major, cudaDevAttrComputeCapabilityMajor,
+                             gpu_id) != cudaSuccess ||
+      cudaDeviceGetAttribute(&sm_minor, cudaDevAttrComputeCapabilityMinor,
+                             gpu_id) != cudaSuccess) {
+    return errors::Internal("Failed to get the compute capability of GPU ",
+                            gpu_id);
+  }
+  string precision_name;
+  TF_RETURN_IF_ERROR(TrtPrecisionModeToName(precision_mode_, &precision_name));
+  // The build settings and the shapes the engine is specialized for.
+  const string config = StrCat(
+      precision_name, ",", workspace_size_, ",", use_implicit_batch_, ",",
+      use_implicit_batch_
+          ? TensorShapeUtils::ShapeListString(input_concrete_shapes)
+          : cache_resource->profiles_.ProfilesDebugString());
+  return io::JoinPath(
+      engine_cache_dir_,
+      StrCat(absl::Hex(segment_fingerprint_, absl::kZeroPad16), "_trt",
+             NV_TENSORRT_MAJOR, ".", NV_TENSORRT_MINOR, ".", NV_TENSORRT_PATCH,
+             "_sm", sm_major, sm_minor, "_",
+             absl::Hex(Fingerprint64(config), absl::kZeroPad16),
+             ".engine"));
+}
+
+TrtUniquePtrType<nvinfer1::ICudaEngine> TRTEngineOp::LoadPersistedEngine(
+    const string& path, TRTEngineCacheResource* cache_resource) {
+  Env* env = Env::Default();
+  if (!env->FileExists(path).ok()) return nullptr;
+  string data;
+  TRTEngineInstance engine_instance;
+  Status status = ReadFileToString(env, path, &data);
+  if (status.ok() && !engine_instance.ParseFromString(data)) {
+    status = errors::DataLoss("Failed to parse ", path);
+  }
+  if (!status.ok()) {
+    LOG_WARNING_WITH_PREFIX << "Failed to load the persisted engine for "
+                            << name() << ": " << status;
+    return nullptr;
+  }
+  TrtUniquePtrType<IRuntime> infer(nvinfer1::createInferRuntime(logger));
+  infer->setGpuAllocator(cache_resource->allocator_.get());
+  // Need to initialize plugins in order to deserialize engines that contain
+  // plugins.
+  MaybeInitializeTrtPlugins(&logger);
+  TrtUniquePtrType<nvinfer1::ICudaEngine> engine(infer->deserializeCudaEngine(
+      engine_instance.serialized_engine().c_str(),
+      engine_instance.serialized_engine().size(), nullptr));
+  if (!engine) {
+    LOG_WARNING_WITH_PREFIX << "Failed to deserialize the persisted engine "
+                            << path << " for " << name();
+    return nullptr;
+  }
+  VLOG(1) << "Loaded the persisted engine " << path << " for " << name();
+  return engine;
+}
+
+Status TRTEngineOp::PersistEngine(
+    const string& path, const std::vector<TensorShape>& input_concrete_shapes,
+    nvinfer1::ICudaEngine* engine) {
+  TRTEngineInstance engine_instance;
+  for (const TensorShape& shape : input_concrete_shapes) {
+    shape.AsProto(engine_instance.add_input_shapes());
+  }
+  TrtUniquePtrType<nvinfer1::IHostMemory> engine_data(engine->serialize());
+  engine_instance.set_serialized_engine(engine_data->data(),
+                                        engine_data->size());
+  // Write to a temporary file first so that other processes sharing the
+  // directory never see a partial engine.
+  Env* env = Env::Default();
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(engine_cache_dir_));
+  const string tmp_path =
+      StrCat(path, ".tmp", env->NowMicros(), "_", env->GetCurrentThreadId());
+  TF_RETURN_IF_ERROR(
+      WriteStringToFile(env, tmp_path, engine_instance.SerializeAsString()));
+  Status status = env->RenameFile(tmp_path, path);
+  if (!status.ok()) {
+    env->DeleteFile(tmp_path).IgnoreError();
+    return status;
+  }
+  VLOG(1) << "Persisted the engine for " << name() << " to " << path;
+  return Status::OK();
+}
+
 StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
     const std::vector<TensorShape>& input_concrete_shapes, OpKernelContext* ctx,
     TRTEngineCacheResource* cache_res) {
@@ -1041,15 +1177,43 @@ StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
       return std::pair<EngineContext*, int>(&empty_context, 0);
     }
 
-    // Up to this point, calibrator_ can never be empty, since otherwise it
-    // means calibration_mode_ is true and this path won't get executed.
-    auto result = BuildEngine(input_concrete_shapes, batch_size,
-                              use_calibration_, calibrator_.get(), cache_res);
-    if (!result.ok()) {
-      return std::pair<EngineContext*, int>(&empty_context, 0);
+    TrtUniquePtrType<nvinfer1::ICudaEngine> engine;
+    string engine_path;
+    if (!engine_cache_dir_.empty()) {
+      auto path_or = GetPersistedEnginePath(input_concrete_shapes, ctx,
+                                            cache_res);
+      if (path_or.ok()) {
+        engine_path = std::move(path_or.ValueOrDie());
+        engine = LoadPersistedEngine(engine_path, cache_res);
+      } else {
+        LOG_WARNING_WITH_PREFIX << "Not persisting the engines of " << name()
+                                << ": " << path_or.status();
+      }
+    }
+    if (engine) {
+      // Replaces the profiles created from the collected shapes with those of
+      // the engine, which match them, and sets up what is otherwise set up
+      // when the network is built.
+      TF_RETURN_IF_ERROR(cache_res->profiles_.RestoreProfiles(engine.get()));
+    } else {
+      // Up to this point, calibrator_ can never be empty, since otherwise it
+      // means calibration_mode_ is true and this path won't get executed.
+      auto result = BuildEngine(input_concrete_shapes, batch_size,
+                                use_calibration_, calibrator_.get(),
+                                cache_res);
+      if (!result.ok()) {
+        return std::pair<EngineContext*, int>(&empty_context, 0);
+      }
+      engine = std::move(result.ValueOrDie());
+      if (!engine_path.empty()) {
+        Status status =
+            PersistEngine(engine_path, input_concrete_shapes, engine.get());
+        if (!status.ok()) {
+          LOG_WARNING_WITH_PREFIX << "Failed to persist the engine for "
+                                  << name() << ": " << status;
+        }
+      }
     }
-    TrtUniquePtrType<nvinfer1::ICudaEngine> engine =
-        std::move(result.ValueOrDie());
     std::vector<ExecutionContext> exec_contexts;
     TF_RETURN_IF_ERROR(cache_res->profiles_.CreateExecutionContexts(
         engine.get(), &exec_contexts));
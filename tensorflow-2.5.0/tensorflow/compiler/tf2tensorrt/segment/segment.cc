@@ -27,6 +27,8 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/grappler/costs/op_context.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
@@ -677,8 +679,106 @@ void AddSegmentForNode(const grappler::GraphProperties* graph_properties,
   segments->emplace_back(node, std::move(property));
 }
 
+// The overhead of launching an op with the TF executor.
+constexpr double kNativeOpOverheadMicros = 5;
+// The overhead of launching a TensorRT engine, from TRTEngineOp.
+constexpr double kTrtEngineOverheadMicros = 20;
+
+// Returns the size of a tensor, counting unknown dimensions as 1.
+int64 GetTensorBytes(const OpInfo::TensorProperties& prop) {
+  int64 num_elements = 1;
+  if (!prop.shape().unknown_rank()) {
+    for (const auto& dim : prop.shape().dim()) {
+      if (dim.size() > 0) num_elements *= dim.size();
+    }
+  }
+  return num_elements * DataTypeSize(prop.dtype());
+}
+
+// Returns the device to use for the cost estimates. The GPU estimates need
+// the architecture, without which a V100 is assumed.
+DeviceProperties GetCostModelDevice(const DeviceProperties& device) {
+  if (device.type() == "GPU" && device.environment().count("architecture")) {
+    return device;
+  }
+  DeviceProperties gpu;
+  gpu.set_type("GPU");
+  gpu.set_num_cores(80);
+  gpu.set_frequency(1530);
+  gpu.set_bandwidth(900 * 1e6);
+  (*gpu.mutable_environment())["architecture"] = "7";
+  return gpu;
+}
+
 }  // namespace
 
+SegmentCostEstimate EstimateSegmentCost(
+    const grappler::GraphProperties& graph_properties,
+    const std::set<const Node*, NodePtrCompare>& nodes,
+    const DeviceProperties& device) {
+  static grappler::OpLevelCostEstimator* estimator =
+      new grappler::OpLevelCostEstimator();
+  const DeviceProperties cost_model_device = GetCostModelDevice(device);
+  SegmentCostEstimate estimate;
+  double compute_micros = 0;
+  for (const Node* node : nodes) {
+    grappler::OpContext op_context;
+    op_context.name = node->name();
+    OpInfo& op_info = op_context.op_info;
+    op_info.set_op(node->type_string());
+    for (const auto& attr : node->attrs()) {
+      (*op_info.mutable_attr())[attr.first] = attr.second;
+    }
+    if (graph_properties.HasInputProperties(node->name())) {
+      for (const auto& prop :
+           graph_properties.GetInputProperties(node->name())) {
+        *op_info.add_inputs() = prop;
+      }
+    }
+    if (graph_properties.HasOutputProperties(node->name())) {
+      for (const auto& prop :
+           graph_properties.GetOutputProperties(node->name())) {
+        *op_info.add_outputs() = prop;
+      }
+    }
+    *op_info.mutable_device() = cost_model_device;
+    const grappler::Costs costs = estimator->PredictCosts(op_context);
+    estimate.native_micros +=
+        costs.execution_time.count() / 1e3 + kNativeOpOverheadMicros;
+    compute_micros += costs.compute_time.count() / 1e3;
+  }
+
+  // Each tensor crossing the boundary is read or written once by the engine.
+  std::set<std::pair<const Node*, int>> boundary_tensors;
+  for (const Node* node : nodes) {
+    for (const Edge* edge : node->in_edges()) {
+      if (!edge->IsControlEdge() && !nodes.count(edge->src())) {
+        boundary_tensors.emplace(edge->src(), edge->src_output());
+      }
+    }
+    for (const Edge* edge : node->out_edges()) {
+      if (!edge->IsControlEdge() && !nodes.count(edge->dst())) {
+        boundary_tensors.emplace(node, edge->src_output());
+      }
+    }
+  }
+  for (const auto& tensor : boundary_tensors) {
+    const string& name = tensor.first->name();
+    if (!graph_properties.HasOutputProperties(name)) continue;
+    const auto& props = graph_properties.GetOutputProperties(name);
+    if (tensor.second < static_cast<int>(props.size())) {
+      estimate.boundary_bytes += GetTensorBytes(props[tensor.second]);
+    }
+  }
+  // 1 GB/s moves 1e3 bytes per microsecond.
+  const double bytes_per_micro =
+      estimator->GetDeviceInfo(cost_model_device).gb_per_sec * 1e3;
+  estimate.trt_micros = compute_micros +
+                        estimate.boundary_bytes / bytes_per_micro +
+                        kTrtEngineOverheadMicros;
+  return estimate;
+}
+
 Status SegmentGraph(const Graph* tf_graph,
                     const grappler::GraphProperties* graph_properties,
                     const std::function<Status(const Node*)>& candidate_fn,
@@ -1047,6 +1147,20 @@ Status SegmentGraph(const Graph* tf_graph,
               << num_effective_nodes << " effective nodes, dropping";
       continue;
     }
+
+    // Don't use segments that are estimated to be slower as TensorRT engines.
+    if (options.minimum_segment_speedup > 0 && graph_properties) {
+      const SegmentCostEstimate cost = EstimateSegmentCost(
+          *graph_properties, segment_nodes, options.device_properties);
+      const bool keep = cost.speedup() >= options.minimum_segment_speedup;
+      VLOG(1) << "Segment with parent=" << segment_root << ": "
+              << segment_nodes.size() << " nodes, " << cost.boundary_bytes
+              << " boundary bytes, estimated " << cost.native_micros
+              << "us native, " << cost.trt_micros
+              << "us with TensorRT, speedup " << cost.speedup()
+              << (keep ? "" : ", dropping");
+      if (!keep) continue;
+    }
     segments->emplace_back(itr.second.property, segment_nodes);
   }
 
@@ -22,6 +22,7 @@ limitations under the License.
 #include "absl/types/optional.h"
 #include "tensorflow/compiler/tf2tensorrt/segment/union_find.h"
 #include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/protobuf/device_properties.pb.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -48,6 +49,27 @@ struct SegmentOptions {
   bool allow_dynamic_non_batch_dim = false;
   // The name of the device to put the segment on.
   std::set<string> exclude_node_list;
+  // Segments whose estimated speedup over native TF execution is below this
+  // are dropped. The costs are only estimated when this is positive and the
+  // graph properties are given.
+  float minimum_segment_speedup = 0;
+  // The device to estimate the segment costs for.
+  DeviceProperties device_properties;
+};
+
+// The estimated costs of running a segment natively and as a TensorRT engine.
+struct SegmentCostEstimate {
+  // The cost of the segment ops, each launched separately.
+  double native_micros = 0;
+  // The compute cost of the segment ops, which TensorRT fuses, plus the cost
+  // of reading and writing the tensors at the segment boundary.
+  double trt_micros = 0;
+  // The size of the tensors at the segment boundary.
+  int64 boundary_bytes = 0;
+
+  double speedup() const {
+    return trt_micros > 0 ? native_micros / trt_micros : 0;
+  }
 };
 
 struct NodePtrCompare {
@@ -68,6 +90,13 @@ struct Segment {
 // Vector of segments, each entry contains a set of node pointers.
 using SegmentVector = std::vector<Segment>;
 
+// Estimates the costs of the segment made of `nodes` on `device`, from the
+// shapes in `graph_properties`.
+SegmentCostEstimate EstimateSegmentCost(
+    const grappler::GraphProperties& graph_properties,
+    const std::set<const Node*, NodePtrCompare>& nodes,
+    const DeviceProperties& device);
+
 // Get the subgraphs of a graph that can be handled by TensorRT.
 //
 // @param tf_graph Graph of the network.
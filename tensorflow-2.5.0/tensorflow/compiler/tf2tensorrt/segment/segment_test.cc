@@ -369,6 +369,40 @@ TEST_F(SegmentTest, IdentityOps) {
   RunTest(&g, all_identities, all_identities, all_identities, {});
 }
 
+// Testing that the segments estimated to be slower with TensorRT are dropped:
+// launching the engine costs more than launching a few small element-wise ops,
+// while fusing large element-wise ops saves the memory traffic between them.
+TEST_F(SegmentTest, MinimumSegmentSpeedup) {
+  for (const bool large : {false, true}) {
+    Scope s = Scope::NewRootScope();
+    auto feed_shape = ops::Placeholder::Shape(
+        large ? PartialTensorShape({1024, 1024, 16}) : PartialTensorShape({2}));
+    auto feed =
+        ops::Placeholder(s.WithOpName("feed"), DT_FLOAT, feed_shape);
+    auto add0 = ops::Add(s.WithOpName("add0"), feed, feed);
+    auto add1 = ops::Add(s.WithOpName("add1"), add0, add0);
+    auto add2 = ops::Add(s.WithOpName("add2"), add1, add1);
+    auto add3 = ops::Add(s.WithOpName("add3"), add2, add2);
+    auto output = ops::Identity(s.WithOpName("output"), add3);
+
+    grappler::GrapplerItem item;
+    item.fetch.push_back("output");
+    TF_EXPECT_OK(s.ToGraphDef(&item.graph));
+    grappler::GraphProperties static_graph_properties(item);
+    TF_EXPECT_OK(static_graph_properties.InferStatically(true));
+    Graph g(OpRegistry::Global());
+    TF_CHECK_OK(
+        ConvertGraphDefToGraph(GraphConstructorOptions(), item.graph, &g));
+
+    const std::set<string> all_adds = {"add0", "add1", "add2", "add3"};
+    DisableImplicitBatchMode();
+    segment_options_.minimum_segment_speedup = 1.5;
+    RunTest(&g, &static_graph_properties, all_adds, all_adds, all_adds,
+            large ? std::vector<std::set<string>>{all_adds}
+                  : std::vector<std::set<string>>{});
+  }
+}
+
 // Testing implicit batch mode segmentation: it excludes the add-2 operation
 // with a dynamic non-batch dimension.
 TEST_F(SegmentTest, ExcludeAddWithDynamicNonBatchDimension) {
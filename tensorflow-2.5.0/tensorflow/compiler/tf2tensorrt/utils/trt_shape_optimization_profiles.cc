@@ -455,6 +455,9 @@ nvinfer1::Dims GetDimsFromShapeVal(int prof_idx, int binding_idx,
 Status TrtShapeOptimizationProfile::RestoreProfiles(
     const nvinfer1::ICudaEngine* engine) {
   need_profiles_ = false;
+  // The profiles of the engine replace any created from collected shapes,
+  // rather than being appended to them.
+  profiles_.clear();
 #if IS_TRT_VERSION_GE(6, 0, 0, 0)
   if (!engine) {
     // We do not need to restore profiles for an empty engine.
@@ -223,10 +223,20 @@ class TrtShapeOptimizationProfile {
   // Returns number of created profiles.
   int GetNumProfiles() const;
 
+  // Returns a description of the created profiles.
+  string ProfilesDebugString() const {
+    string s;
+    for (const OptimizationProfileConfig& profile : profiles_) {
+      absl::StrAppend(&s, profile.DebugString());
+    }
+    return s;
+  }
+
   bool HasShape() const { return !input_shapes_.empty(); }
   bool NeedProfiles() const { return need_profiles_; }
 
-  // Restores profiles from the engine (used after deserialization).
+  // Restores profiles from the engine (used after deserialization), replacing
+  // the existing profiles.
   Status RestoreProfiles(const nvinfer1::ICudaEngine* engine);
 
   // Whether the network has any shape tensors.
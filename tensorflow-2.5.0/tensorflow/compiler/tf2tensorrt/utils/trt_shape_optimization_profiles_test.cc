@@ -220,6 +220,40 @@ TEST_F(TrtShapeOptimizationProfileTest, Dynamic) {
     }
   }
 }
+
+TEST_F(TrtShapeOptimizationProfileTest, RestoreReplacesProfiles) {
+  nvinfer1::Dims3 dims(-1, -1, 10);
+  DefineNetwork(network_.get(), dims);
+
+  TrtShapeOptimizationProfile profile(ProfileStrategy::kOptimal);
+  std::vector<std::vector<nvinfer1::Dims3>> input_profiles{
+      {nvinfer1::Dims3(2, 2, 10), nvinfer1::Dims3(2, 2, 10)},
+      {nvinfer1::Dims3(16, 16, 10), nvinfer1::Dims3(16, 16, 10)},
+  };
+  for (auto dim_vec : input_profiles) {
+    profile.AddShape(DimVecToShapeVec(dim_vec, true));
+  }
+  std::vector<PartialTensorShape> input_partial_shapes;
+  TF_CHECK_OK(GetNetworkInputShapes(network_.get(), &input_partial_shapes));
+  profile.InitProfiles(input_partial_shapes);
+  TF_CHECK_OK(profile.ConfigureBuilder(builder_.get(), builder_config_.get(),
+                                       network_.get()));
+  engine = TrtUniquePtrType<nvinfer1::ICudaEngine>(
+      builder_->buildEngineWithConfig(*network_.get(), *builder_config_.get()));
+  ASSERT_NE(nullptr, engine);
+  ASSERT_EQ(profile.GetNumProfiles(), input_profiles.size());
+
+  // As when an engine persisted by an earlier run is loaded into a resource
+  // whose profiles were created from the same collected shapes.
+  TF_CHECK_OK(profile.RestoreProfiles(engine.get()));
+  EXPECT_EQ(profile.GetNumProfiles(), input_profiles.size());
+  TF_CHECK_OK(profile.CreateExecutionContexts(engine.get(), &exec_contexts_));
+  EXPECT_EQ(exec_contexts_.size(), input_profiles.size());
+  for (int i = 0; i < input_profiles.size(); ++i) {
+    EXPECT_EQ(profile.GetProfileNumber(DimVecToShapeVec(input_profiles[i])),
+              i);
+  }
+}
 #endif
 
 }  // namespace tensorrt
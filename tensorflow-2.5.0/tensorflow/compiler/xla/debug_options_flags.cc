@@ -140,6 +140,15 @@ static void AllocateFlags() {
     };
   };
 
+  // Returns a lambda that calls "member_setter" on "flag_values" with the
+  // argument passed in to the lambda.
+  auto int64_setter_for = [](void (DebugOptions::*member_setter)(int64)) {
+    return [member_setter](int64 value) {
+      (flag_values->*member_setter)(value);
+      return true;
+    };
+  };
+
   auto string_setter_for =
       [](void (DebugOptions::*member_setter)(const string& value)) {
         return [member_setter](const string& value) {
@@ -624,11 +633,37 @@ static void AllocateFlags() {
       flag_values->xla_gpu_force_compilation_parallelism(),
       "Overrides normal multi-threaded compilation settting to use this many "
       "threads. Setting to 0 (the default value) means no enforcement."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_cpu_force_compilation_parallelism",
+      int32_setter_for(
+          &DebugOptions::set_xla_cpu_force_compilation_parallelism),
+      flag_values->xla_cpu_force_compilation_parallelism(),
+      "Number of threads used to optimize and generate code for the "
+      "partitions of a module on CPU. Setting to 0 (the default value) uses "
+      "the compile options' thread pool; 1 disables parallel compilation."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_cpu_memory_limit_bytes",
+      int64_setter_for(&DebugOptions::set_xla_cpu_memory_limit_bytes),
+      flag_values->xla_cpu_memory_limit_bytes(),
+      "Peak memory, in bytes, that XLA:CPU tries to keep the buffers of a "
+      "module within by rematerializing instructions. 0 means no limit."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_autotune_database_path",
+      string_setter_for(&DebugOptions::set_xla_gpu_autotune_database_path),
+      flag_values->xla_gpu_autotune_database_path(),
+      "Path of a file that GEMM and convolution autotuning results are loaded "
+      "from and appended to, so that later processes can skip autotuning."));
   flag_objects->push_back(tensorflow::Flag(
       "xla_gpu_deterministic_ops",
       bool_setter_for(&DebugOptions::set_xla_gpu_deterministic_ops),
       flag_values->xla_gpu_deterministic_ops(),
       "Guarantees run-to-run determinism on GPU."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_enable_cuda_graphs",
+      bool_setter_for(&DebugOptions::set_xla_gpu_enable_cuda_graphs),
+      flag_values->xla_gpu_enable_cuda_graphs(),
+      "Captures the kernels of XLA:GPU executables into CUDA graphs and "
+      "replays them in later runs."));
 
   ParseFlagsFromEnvAndDieIfUnknown("XLA_FLAGS", *flag_objects);
 }
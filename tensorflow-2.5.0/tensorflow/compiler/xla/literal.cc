@@ -798,6 +798,32 @@ StatusOr<Literal> LiteralBase::Broadcast(
     result.SetDynamicSize(dimensions[i], dynamic_size);
   }
 
+  // If the operand's dimensions are the most minor dimensions of the result,
+  // in the same order, the result is the operand's buffer repeated over and
+  // over, so copy whole blocks instead of single elements.
+  bool operand_is_minor = shape().is_static() && result_shape.is_static();
+  for (int64 i = 0; operand_is_minor && i < dimensions.size(); ++i) {
+    operand_is_minor =
+        GetDynamicSize(i) == shape().dimensions(i) &&
+        LayoutUtil::Minor(result.shape().layout(), i) ==
+            dimensions[LayoutUtil::Minor(shape().layout(), i)];
+  }
+  if (operand_is_minor) {
+    const int64 block_bytes = primitive_size * element_count();
+    const int64 result_bytes =
+        primitive_size * ShapeUtil::ElementsIn(result_shape);
+    if (block_bytes > 0 && result_bytes > 0) {
+      memcpy(dest_data, source_data, block_bytes);
+      // Double the filled prefix until the whole buffer is filled.
+      for (int64 filled = block_bytes; filled < result_bytes;) {
+        const int64 copy_bytes = std::min(filled, result_bytes - filled);
+        memcpy(dest_data + filled, dest_data, copy_bytes);
+        filled += copy_bytes;
+      }
+    }
+    return std::move(result);
+  }
+
   ShapeUtil::ForEachIndex(
       result_shape, [&](absl::Span<const int64> output_index) {
         for (int64 i = 0, end = dimensions.size(); i < end; ++i) {
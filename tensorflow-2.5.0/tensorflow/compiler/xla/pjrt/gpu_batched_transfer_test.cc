@@ -0,0 +1,108 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <numeric>
+#include <vector>
+
+#include "tensorflow/compiler/xla/client/executable_build_options.h"
+#include "tensorflow/compiler/xla/client/xla_builder.h"
+#include "tensorflow/compiler/xla/pjrt/gpu_device.h"
+#include "tensorflow/compiler/xla/pjrt/pjrt_client.h"
+#include "tensorflow/compiler/xla/pjrt/pjrt_stream_executor_client.h"
+#include "tensorflow/compiler/xla/test.h"
+#include "tensorflow/compiler/xla/tests/literal_test_util.h"
+#include "tensorflow/core/platform/casts.h"
+
+namespace xla {
+namespace {
+
+class GpuBatchedTransferTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    TF_ASSERT_OK_AND_ASSIGN(
+        client_, GetGpuClient(/*asynchronous=*/true, GpuAllocatorConfig(),
+                              /*distributed_client=*/nullptr, /*node_id=*/0));
+    device_ = client_->addressable_devices().at(0);
+    // Arrays of different sizes, so that none of them ends on an allocation
+    // boundary.
+    for (int64 size : {5, 1000, 3}) {
+      std::vector<int32> values(size);
+      std::iota(values.begin(), values.end(), 10 * inputs_.size());
+      inputs_.push_back(std::move(values));
+      shapes_.push_back(ShapeUtil::MakeShape(S32, {size}));
+    }
+  }
+
+  StatusOr<std::vector<std::unique_ptr<PjRtBuffer>>> TransferInputs() {
+    std::vector<const void*> data;
+    for (const std::vector<int32>& values : inputs_) {
+      data.push_back(values.data());
+    }
+    return tensorflow::down_cast<PjRtStreamExecutorClient*>(client_.get())
+        ->BuffersFromHostBuffers(data, shapes_, device_);
+  }
+
+  std::unique_ptr<PjRtClient> client_;
+  PjRtDevice* device_;
+  std::vector<std::vector<int32>> inputs_;
+  std::vector<Shape> shapes_;
+};
+
+TEST_F(GpuBatchedTransferTest, TransfersEveryArray) {
+  TF_ASSERT_OK_AND_ASSIGN(auto buffers, TransferInputs());
+  ASSERT_EQ(buffers.size(), inputs_.size());
+  for (int i = 0; i < buffers.size(); ++i) {
+    TF_ASSERT_OK_AND_ASSIGN(auto literal, buffers[i]->ToLiteral());
+    LiteralTestUtil::ExpectR1Equal<int32>(inputs_[i], *literal);
+  }
+}
+
+// Donating one buffer of a batch must leave the other buffers intact.
+TEST_F(GpuBatchedTransferTest, DonatesOneBufferOfABatch) {
+  XlaBuilder builder("add_one");
+  auto p0 = Parameter(&builder, 0, shapes_[1], "param");
+  Add(p0, ConstantR0<int32>(&builder, 1));
+  builder.SetUpAlias(/*output_index=*/{}, /*param_number=*/0,
+                     /*param_index=*/{});
+  TF_ASSERT_OK_AND_ASSIGN(XlaComputation computation, builder.Build());
+  CompileOptions compile_options;
+  DeviceAssignment device_assignment(1, 1);
+  device_assignment(0, 0) = device_->id();
+  compile_options.executable_build_options.set_device_assignment(
+      device_assignment);
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<PjRtExecutable> executable,
+      client_->Compile(computation, std::move(compile_options)));
+
+  TF_ASSERT_OK_AND_ASSIGN(auto buffers, TransferInputs());
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto results,
+      executable->Execute({{buffers[1].get()}}, ExecuteOptions()));
+  EXPECT_TRUE(buffers[1]->IsDeleted());
+  std::vector<int32> expected = inputs_[1];
+  for (int32& value : expected) ++value;
+  TF_ASSERT_OK_AND_ASSIGN(auto literal, results[0][0]->ToLiteral());
+  LiteralTestUtil::ExpectR1Equal<int32>(expected, *literal);
+  // Frees the output, which took over the donated allocation.
+  results.clear();
+
+  for (int i : {0, 2}) {
+    TF_ASSERT_OK_AND_ASSIGN(auto literal, buffers[i]->ToLiteral());
+    LiteralTestUtil::ExpectR1Equal<int32>(inputs_[i], *literal);
+  }
+}
+
+}  // namespace
+}  // namespace xla
@@ -852,6 +852,149 @@ PjRtStreamExecutorClient::BufferFromHostBuffer(
   return std::unique_ptr<PjRtBuffer>(std::move(py_buffer));
 }
 
+StatusOr<std::vector<std::unique_ptr<PjRtBuffer>>>
+PjRtStreamExecutorClient::BuffersFromHostBuffers(
+    absl::Span<const void* const> data, absl::Span<const Shape> shapes,
+    PjRtDevice* device) {
+  tensorflow::profiler::TraceMe traceme(
+      "PjRtStreamExecutorClient::BuffersFromHostBuffers");
+  VLOG(2) << "PjRtStreamExecutorClient::BuffersFromHostBuffers: "
+          << shapes.size() << " buffers, device: " << device->DebugString();
+  if (data.size() != shapes.size()) {
+    return InvalidArgument(
+        "BuffersFromHostBuffers got %d host buffers but %d shapes", data.size(),
+        shapes.size());
+  }
+  TF_ASSIGN_OR_RETURN(LocalDeviceState * local_device,
+                      tensorflow::down_cast<PjRtStreamExecutorDevice*>(device)
+                          ->GetLocalDeviceState());
+  TransferManager* transfer_manager = client()->backend().transfer_manager();
+
+  // The arrays can only be packed if the device representation of each of
+  // them is exactly its host representation. On the CPU platform
+  // BufferFromHostBuffer is already cheap, and there is no host memory
+  // allocator to stage from, so don't bother.
+  bool can_pack =
+      local_device->executor()->platform()->id() != se::host::kHostPlatformId &&
+      host_memory_allocator() != nullptr;
+  std::vector<int64> offsets;
+  std::vector<int64> sizes;
+  offsets.reserve(shapes.size());
+  sizes.reserve(shapes.size());
+  int64 total_size = 0;
+  for (const Shape& shape : shapes) {
+    if (shape.IsTuple()) {
+      return InvalidArgument("Use BufferFromHostLiteral to transfer a tuple");
+    }
+    TF_ASSIGN_OR_RETURN(Shape compact_shape,
+                        transfer_manager->ChooseCompactLayoutForShape(shape));
+    can_pack = can_pack && shape.is_static() &&
+               shape.layout() == compact_shape.layout() &&
+               ShapeUtil::Equal(
+                   transfer_manager->HostShapeToDeviceShape(compact_shape),
+                   compact_shape);
+    total_size = RoundUpToNearest<int64>(
+        total_size, tensorflow::Allocator::kAllocatorAlignment);
+    offsets.push_back(total_size);
+    sizes.push_back(ShapeUtil::ByteSizeOf(shape));
+    total_size += sizes.back();
+  }
+
+  std::vector<std::unique_ptr<PjRtBuffer>> buffers;
+  buffers.reserve(shapes.size());
+  if (!can_pack) {
+    for (int i = 0; i < shapes.size(); ++i) {
+      TF_ASSIGN_OR_RETURN(
+          std::unique_ptr<PjRtBuffer> buffer,
+          BufferFromHostBuffer(data[i], shapes[i],
+                               HostBufferSemantics::kImmutableOnlyDuringCall,
+                               /*on_done_with_host_buffer=*/nullptr, device));
+      buffers.push_back(std::move(buffer));
+    }
+    return buffers;
+  }
+
+  // Every array gets a device allocation of its own, owned by its buffer like
+  // that of any other buffer, so that a buffer can be donated or freed
+  // independently of the others.
+  std::vector<se::OwningDeviceMemory> device_memory;
+  device_memory.reserve(shapes.size());
+  for (int i = 0; i < shapes.size(); ++i) {
+    TF_ASSIGN_OR_RETURN(
+        se::OwningDeviceMemory memory,
+        allocator()->Allocate(local_device->device_ordinal(), sizes[i]));
+    device_memory.push_back(std::move(memory));
+  }
+
+  // On GPU host_memory_allocator() is a BFC allocator over pinned memory, so
+  // staging buffers are recycled rather than pinned anew for every batch.
+  void* staging_ptr = host_memory_allocator()->AllocateRaw(
+      tensorflow::Allocator::kAllocatorAlignment, total_size);
+  if (staging_ptr == nullptr && total_size > 0) {
+    return ResourceExhausted(
+        "Failed to allocate %d bytes of host memory to stage a batched "
+        "transfer",
+        total_size);
+  }
+  std::shared_ptr<void> staging_buffer(
+      staging_ptr,
+      [host_memory_allocator = host_memory_allocator()](void* ptr) {
+        host_memory_allocator->DeallocateRaw(ptr);
+      });
+  for (int i = 0; i < shapes.size(); ++i) {
+    std::memcpy(static_cast<char*>(staging_buffer.get()) + offsets[i], data[i],
+                sizes[i]);
+  }
+
+  se::Stream* h2d_stream = local_device->host_to_device_stream();
+  if (local_device->allocation_model() ==
+      LocalDeviceState::kComputeSynchronized) {
+    h2d_stream->ThenWaitFor(local_device->compute_stream());
+  }
+  // The copies are all enqueued back to back on the host-to-device stream and
+  // share one definition event.
+  for (int i = 0; i < shapes.size(); ++i) {
+    if (sizes[i] > 0) {
+      se::DeviceMemoryBase destination = *device_memory[i];
+      h2d_stream->ThenMemcpy(
+          &destination, static_cast<char*>(staging_buffer.get()) + offsets[i],
+          sizes[i]);
+    }
+  }
+  // CAUTION: From this point onwards we need to be careful about returning
+  // from error cases because we have started a transfer and must not allow
+  // the device memory to be freed too soon in the non-async allocation models.
+  auto definition_event = std::make_shared<BufferSequencingEvent>();
+  StatusOr<EventPool::Handle> event_or =
+      local_device->event_pool().ThenAllocateAndRecordEvent(h2d_stream);
+  if (!event_or.ok()) {
+    StallStreamOnError(local_device, h2d_stream);
+    return event_or.status();
+  }
+  definition_event->SetSequencingEvent(event_or.ConsumeValueOrDie(),
+                                       h2d_stream);
+  local_device->ThenExecuteCallback(
+      h2d_stream, [staging_buffer{std::move(staging_buffer)}]() {});
+
+  for (int i = 0; i < shapes.size(); ++i) {
+    auto device_buffer = std::make_shared<TrackedDeviceBuffer>(
+        allocator(), local_device->device_ordinal(),
+        std::initializer_list<se::DeviceMemoryBase>{device_memory[i].Release()},
+        std::initializer_list<std::shared_ptr<BufferSequencingEvent>>{
+            definition_event},
+        /*on_delete_callback=*/nullptr);
+    auto buffer = std::make_unique<PjRtStreamExecutorBuffer>(
+        shapes[i], std::move(device_buffer), this, device);
+    // prefer_to_retain_reference=false for the same reason as in
+    // AddDestinationBufferSynchronization.
+    RecordUsage(buffer->GetBufferWithUsageHold(), local_device, local_device,
+                definition_event, h2d_stream,
+                /*prefer_to_retain_reference=*/false);
+    buffers.push_back(std::move(buffer));
+  }
+  return buffers;
+}
+
 StatusOr<std::unique_ptr<PjRtBuffer>>
 PjRtStreamExecutorClient::CreateUninitializedBuffer(const Shape& shape,
                                                     PjRtDevice* device) {
@@ -195,6 +195,19 @@ class PjRtStreamExecutorClient : public PjRtClient {
   StatusOr<std::unique_ptr<PjRtBuffer>> BufferFromHostLiteral(
       const LiteralSlice& literal, PjRtDevice* device) override;
 
+  // Transfers a batch of arrays to `device`, with the semantics of
+  // BufferFromHostBuffer with kImmutableOnlyDuringCall. The arrays are packed
+  // into a single staging buffer from host_memory_allocator() and copied into
+  // device allocations of their own by back-to-back memcpys sharing one
+  // definition event, so each returned buffer can be donated or deleted on its
+  // own. Falls back to one BufferFromHostBuffer call per array when there is
+  // no host memory allocator or the device can't take the arrays' bytes
+  // verbatim, e.g., on the CPU platform or when a layout isn't the compact
+  // one.
+  StatusOr<std::vector<std::unique_ptr<PjRtBuffer>>> BuffersFromHostBuffers(
+      absl::Span<const void* const> data, absl::Span<const Shape> shapes,
+      PjRtDevice* device);
+
   void MakeCrossHostReceiveBuffers(
       absl::Span<const Shape> shapes, PjRtDevice* device,
       PjRtCrossHostRecvNotifier&& notifier) override;
@@ -18,6 +18,7 @@ limitations under the License.
 #include <stddef.h>
 #include <string.h>
 
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <string>
@@ -27,11 +28,15 @@ limitations under the License.
 
 // IWYU pragma: no_include "llvm/Config/Disassemblers.def.inc"
 // IWYU pragma: no_include "llvm/Config/Targets.def.inc"
+#include "absl/algorithm/container.h"
 #include "absl/base/call_once.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
+#include "absl/types/optional.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Triple.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Mangler.h"
@@ -40,10 +45,13 @@ limitations under the License.
 #include "llvm/Object/ObjectFile.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetOptions.h"
+#include "llvm/Transforms/Utils/SplitModule.h"
 #include "mlir/Dialect/Affine/IR/AffineOps.h"  // from @llvm-project
 #include "mlir/Dialect/LLVMIR/LLVMDialect.h"  // from @llvm-project
 #include "mlir/Dialect/Linalg/IR/LinalgTypes.h"  // from @llvm-project
@@ -61,6 +69,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/batch_dot_simplification.h"
 #include "tensorflow/compiler/xla/service/batchnorm_expander.h"
 #include "tensorflow/compiler/xla/service/buffer_assignment.h"
+#include "tensorflow/compiler/xla/service/call_graph.h"
 #include "tensorflow/compiler/xla/service/call_inliner.h"
 #include "tensorflow/compiler/xla/service/cholesky_expander.h"
 #include "tensorflow/compiler/xla/service/comparison_expander.h"
@@ -102,6 +111,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/hlo_pass_fix.h"
 #include "tensorflow/compiler/xla/service/hlo_pass_pipeline.h"
 #include "tensorflow/compiler/xla/service/hlo_proto_util.h"
+#include "tensorflow/compiler/xla/service/hlo_rematerialization.h"
 #include "tensorflow/compiler/xla/service/hlo_subcomputation_unification.h"
 #include "tensorflow/compiler/xla/service/hlo_verifier.h"
 #include "tensorflow/compiler/xla/service/indexed_array_analysis.h"
@@ -132,7 +142,12 @@ limitations under the License.
 #include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/compiler/xla/xla_data.pb.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/dynamic_annotations.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace {
 
@@ -152,6 +167,7 @@ void LoadMLIRDialects(mlir::MLIRContext& context) {
 namespace xla {
 namespace cpu {
 using BufferInfo = cpu_function_runtime::BufferInfo;
+using ::tensorflow::strings::HumanReadableNumBytes;
 
 CpuAotCompilationOptions::CpuAotCompilationOptions(
     string triple, string cpu_name, string features, string entry_point_name,
@@ -571,6 +587,32 @@ Status CreateHloProfilingArtifacts(
   return Status::OK();
 }
 
+// Reports the memory that `assignment` allocates for `module`, other than its
+// parameters, against xla_cpu_memory_limit_bytes, if set.
+void ReportPeakMemory(const HloModule& module,
+                      const BufferAssignment& assignment) {
+  const int64 memory_limit_bytes =
+      module.config().debug_options().xla_cpu_memory_limit_bytes();
+  if (memory_limit_bytes <= 0) {
+    return;
+  }
+  const BufferAssignment::Stats& stats = assignment.GetStats();
+  const int64 peak_bytes =
+      stats.total_allocation_bytes - stats.parameter_allocation_bytes;
+  if (peak_bytes > memory_limit_bytes) {
+    LOG(WARNING) << "Buffers of " << module.name() << " need "
+                 << HumanReadableNumBytes(peak_bytes)
+                 << " in addition to the parameters, which exceeds "
+                    "xla_cpu_memory_limit_bytes ("
+                 << HumanReadableNumBytes(memory_limit_bytes) << ")";
+  } else {
+    VLOG(1) << "Buffers of " << module.name() << " need "
+            << HumanReadableNumBytes(peak_bytes)
+            << " in addition to the parameters (limit "
+            << HumanReadableNumBytes(memory_limit_bytes) << ")";
+  }
+}
+
 }  // namespace
 
 StatusOr<std::unique_ptr<HloModule>> CpuCompiler::RunHloPasses(
@@ -600,10 +642,10 @@ CpuCompiler::RunHloPassesAndBufferAssignement(std::unique_ptr<HloModule> module,
   // Select an order for emitting the HLO instructions for each computation.
   // Using this sequence enables tighter buffer liveness analysis and reduced
   // memory usage (as compared to using DependencyHloOrdering).
-  TF_ASSIGN_OR_RETURN(HloSchedule schedule,
-                      ScheduleModule(module.get(), BufferSizeBytesFunction(),
-                                     ComputationSchedulerToModuleScheduler(
-                                         DFSMemoryScheduler)));
+  TF_ASSIGN_OR_RETURN(
+      HloSchedule schedule,
+      CreateHloSchedule(module.get(), ComputationSchedulerToModuleScheduler(
+                                          DFSMemoryScheduler)));
 
   // Run buffer allocation on the HLO graph.
   TF_ASSIGN_OR_RETURN(
@@ -612,10 +654,43 @@ CpuCompiler::RunHloPassesAndBufferAssignement(std::unique_ptr<HloModule> module,
                           absl::make_unique<SequentialHloOrdering>(schedule),
                           BufferSizeBytesFunction(), memory_alignment,
                           /*allocate_buffers_for_constants=*/true));
+  ReportPeakMemory(*module, *assignment);
 
   return std::make_tuple(std::move(module), std::move(assignment));
 }
 
+StatusOr<HloSchedule> CpuCompiler::CreateHloSchedule(
+    HloModule* module, const ModuleSchedulerAlgorithm& algorithm) {
+  TF_ASSIGN_OR_RETURN(
+      HloSchedule schedule,
+      ScheduleModule(module, BufferSizeBytesFunction(), algorithm));
+  const int64 memory_limit_bytes =
+      module->config().debug_options().xla_cpu_memory_limit_bytes();
+  if (memory_limit_bytes <= 0) {
+    return schedule;
+  }
+
+  // Rematerialization works on, and keeps up to date, the module's schedule.
+  // Fusion has already run, so only recomputation is worthwhile: compressing
+  // buffers needs a backend notion of compact layouts.
+  TF_RETURN_IF_ERROR(module->set_schedule(std::move(schedule)));
+  HloRematerialization::RematerializationSizes sizes;
+  HloRematerialization rematerialization(
+      ShapeSizeBytesFunction(), memory_limit_bytes, &sizes,
+      HloRematerialization::RematerializationPass::kPostFusion,
+      /*block_size_limit=*/1, /*block_rematerialization_factor=*/1,
+      /*compact_shape_function=*/nullptr,
+      HloRematerialization::RematerializationMode::kRecomputeOnly);
+  TF_ASSIGN_OR_RETURN(bool changed, rematerialization.Run(module));
+  VLOG(1) << "Rematerialization of " << module->name()
+          << (changed ? " reduced" : " kept")
+          << " the estimated peak memory from "
+          << HumanReadableNumBytes(sizes.before_bytes) << " to "
+          << HumanReadableNumBytes(sizes.after_bytes) << " (limit "
+          << HumanReadableNumBytes(memory_limit_bytes) << ")";
+  return module->schedule();
+}
+
 namespace {
 
 // Post-compilation callback functor for use by SimpleOrcJIT.
@@ -651,6 +726,113 @@ struct OrcJITPostCompilationHook {
   const HloModule* module;
 };
 
+// Returns true if `computation` is only invoked by kWhile and kConditional
+// instructions. The functions emitted for such computations are called
+// directly, so they can be moved into a different LLVM module than their
+// callers and resolved by the JIT's linker.
+bool IsCalledOnlyByControlFlow(const CallGraph& call_graph,
+                               const HloComputation* computation) {
+  const CallGraphNode& node = call_graph.GetNode(computation);
+  if (node.caller_callsites().empty()) {
+    return false;
+  }
+  return absl::c_all_of(node.caller_callsites(), [](const CallSite& callsite) {
+    return callsite.instruction()->opcode() == HloOpcode::kWhile ||
+           callsite.instruction()->opcode() == HloOpcode::kConditional;
+  });
+}
+
+// Splits `llvm_module` into at most `num_partitions` modules, optimizes and
+// lowers them to object code on `thread_pool` and adds the objects to `jit`.
+// Each partition gets its own LLVMContext and TargetMachine, since neither is
+// thread-safe.
+Status AddModuleToJitInParallel(
+    std::unique_ptr<llvm::Module> llvm_module, int num_partitions,
+    tensorflow::thread::ThreadPool* thread_pool,
+    const HloModuleConfig& module_config,
+    const LLVMCompiler::ModuleHook& pre_optimization_ir_hook,
+    const LLVMCompiler::ModuleHook& post_optimization_ir_hook,
+    SimpleOrcJIT* jit) {
+  // SplitModule keeps functions that share internal globals (e.g. constants)
+  // in the same partition, so the partitions only refer to each other through
+  // external function symbols.
+  std::vector<std::string> partition_bitcodes;
+  llvm::SplitModule(
+      *llvm_module, num_partitions,
+      [&](std::unique_ptr<llvm::Module> partition) {
+        partition_bitcodes.emplace_back();
+        llvm::raw_string_ostream os(partition_bitcodes.back());
+        llvm::WriteBitcodeToFile(*partition, os);
+        os.flush();
+      },
+      /*PreserveLocals=*/true);
+  llvm_module.reset();
+  VLOG(1) << "Compiling " << partition_bitcodes.size()
+          << " LLVM module partitions in parallel";
+
+  // The IR hooks are arbitrary user code, so don't run them concurrently.
+  tensorflow::mutex hook_mu;
+  auto serialize_hook = [&hook_mu](const LLVMCompiler::ModuleHook& hook) {
+    return [&hook_mu, &hook](const llvm::Module& module) {
+      tensorflow::mutex_lock lock(hook_mu);
+      hook(module);
+    };
+  };
+  LLVMCompiler::ModuleHook pre_optimization_hook =
+      serialize_hook(pre_optimization_ir_hook);
+  LLVMCompiler::ModuleHook post_optimization_hook =
+      serialize_hook(post_optimization_ir_hook);
+
+  std::vector<StatusOr<std::unique_ptr<llvm::MemoryBuffer>>> object_files(
+      partition_bitcodes.size());
+  tensorflow::BlockingCounter counter(partition_bitcodes.size());
+  for (int i = 0; i < partition_bitcodes.size(); ++i) {
+    thread_pool->Schedule([&, i] {
+      auto compile = [&]() -> StatusOr<std::unique_ptr<llvm::MemoryBuffer>> {
+        llvm::LLVMContext context;
+        llvm::Expected<std::unique_ptr<llvm::Module>> partition =
+            llvm::parseBitcodeFile(
+                llvm::MemoryBufferRef(partition_bitcodes[i], "partition"),
+                context);
+        if (!partition) {
+          return InternalError("Reading LLVM module partition failed: %s",
+                               llvm::toString(partition.takeError()));
+        }
+        std::unique_ptr<llvm::TargetMachine> target_machine =
+            SimpleOrcJIT::InferTargetMachineForJIT(
+                CompilerTargetOptions(module_config),
+                CodeGenOptLevel(module_config));
+        CompilerFunctor compiler_functor(
+            target_machine.get(), CodeGenOptLevel(module_config),
+            options::OptimizeForSizeRequested(module_config),
+            module_config.debug_options().xla_llvm_disable_expensive_passes(),
+            llvm_ir::GetCpuFastMathFlags(module_config), pre_optimization_hook,
+            post_optimization_hook);
+        llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> object_file =
+            compiler_functor(**partition);
+        if (!object_file) {
+          return InternalError("Compiling LLVM module partition failed: %s",
+                               llvm::toString(object_file.takeError()));
+        }
+        return std::move(*object_file);
+      };
+      object_files[i] = compile();
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+
+  for (auto& object_file : object_files) {
+    TF_RETURN_IF_ERROR(object_file.status());
+    if (llvm::Error error =
+            jit->AddObjectFile(std::move(object_file).ValueOrDie())) {
+      return InternalError("Adding object file to the JIT failed: %s",
+                           llvm::toString(std::move(error)));
+    }
+  }
+  return Status::OK();
+}
+
 }  // namespace
 
 StatusOr<std::unique_ptr<Executable>> CpuCompiler::RunBackend(
@@ -694,6 +876,9 @@ StatusOr<std::unique_ptr<Executable>> CpuCompiler::RunBackend(
   }
   llvm_module->setDataLayout((*jit)->data_layout());
   llvm_module->setTargetTriple((*jit)->target_triple().getTriple());
+  const bool serializable =
+      options::SerializableExecutableRequested(module->config());
+  (*jit)->set_keep_object_files(serializable);
 
   HloComputation* entry_computation = module->entry_computation();
   std::unordered_map<const HloInstruction*, int64> instruction_to_profile_idx;
@@ -716,10 +901,14 @@ StatusOr<std::unique_ptr<Executable>> CpuCompiler::RunBackend(
   // Select an order for emitting the HLO instructions for each
   // computation. Using this sequence enables tighter buffer liveness analysis
   // and reduced memory usage (as compared to using DependencyHloOrdering).
-  TF_ASSIGN_OR_RETURN(HloSchedule schedule,
-                      ScheduleModule(module.get(), BufferSizeBytesFunction(),
-                                     ComputationSchedulerToModuleScheduler(
-                                         DFSMemoryScheduler)));
+  TF_ASSIGN_OR_RETURN(
+      HloSchedule schedule,
+      CreateHloSchedule(module.get(), ComputationSchedulerToModuleScheduler(
+                                          DFSMemoryScheduler)));
+  if (serializable) {
+    // LoadExecutable recomputes the buffer assignment from this schedule.
+    TF_RETURN_IF_ERROR(module->set_schedule(schedule));
+  }
 
   // Run buffer allocation on the HLO graph.
   TF_ASSIGN_OR_RETURN(
@@ -728,6 +917,7 @@ StatusOr<std::unique_ptr<Executable>> CpuCompiler::RunBackend(
                           absl::make_unique<SequentialHloOrdering>(schedule),
                           BufferSizeBytesFunction(), memory_alignment,
                           /*allocate_buffers_for_constants=*/true));
+  ReportPeakMemory(*module, *assignment);
   DumpHloModuleIfEnabled(*module, *assignment, "after_optimizations");
 
   // Each computation is a single function.  Emit all embedded computations
@@ -749,18 +939,24 @@ StatusOr<std::unique_ptr<Executable>> CpuCompiler::RunBackend(
 
   TF_RETURN_IF_ERROR(ir_emitter.EmitConstantGlobals());
 
+  // Functions of embedded computations that may be placed in a different LLVM
+  // module than their callers when compiling in parallel.
+  std::unique_ptr<CallGraph> call_graph = CallGraph::Build(module.get());
+  std::vector<llvm::Function*> splittable_functions;
   for (auto embedded_computation :
        entry_computation->MakeEmbeddedComputationsList()) {
     if (embedded_computation->IsFusionComputation()) {
       continue;
     }
-    TF_RETURN_IF_ERROR(
-        ir_emitter
-            .EmitComputation(
-                embedded_computation, embedded_computation->name(),
-                /*is_top_level_computation=*/false,
-                schedule.sequence(embedded_computation).instructions())
-            .status());
+    TF_ASSIGN_OR_RETURN(
+        llvm::Function * function,
+        ir_emitter.EmitComputation(
+            embedded_computation, embedded_computation->name(),
+            /*is_top_level_computation=*/false,
+            schedule.sequence(embedded_computation).instructions()));
+    if (IsCalledOnlyByControlFlow(*call_graph, embedded_computation)) {
+      splittable_functions.push_back(function);
+    }
   }
   string function_name_prefix = entry_computation->name().empty()
                                     ? "__compute"
@@ -785,10 +981,44 @@ StatusOr<std::unique_ptr<Executable>> CpuCompiler::RunBackend(
 
   TF_RETURN_IF_ERROR(VerifyLlvmModule(*llvm_module));
 
+  // Choose the thread pool for parallel code generation, following the same
+  // rules as xla_gpu_force_compilation_parallelism.
+  tensorflow::thread::ThreadPool* thread_pool = options.thread_pool;
+  absl::optional<tensorflow::thread::ThreadPool> overriding_thread_pool;
+  const int parallelism = module->config()
+                              .debug_options()
+                              .xla_cpu_force_compilation_parallelism();
+  if (parallelism == 1) {
+    thread_pool = nullptr;
+  } else if (parallelism > 1) {
+    overriding_thread_pool.emplace(tensorflow::Env::Default(), "",
+                                   parallelism);
+    thread_pool = &*overriding_thread_pool;
+  }
+  // The dumped object file and optimized IR must describe the whole module, so
+  // compile on a single thread while dumping.
+  const int num_partitions =
+      thread_pool == nullptr || DumpingEnabledForHloModule(*module)
+          ? 1
+          : std::min<int>(thread_pool->NumThreads(),
+                          splittable_functions.size() + 1);
+
   // JIT compile the LLVM IR module to in-memory machine code.
-  llvm::orc::ThreadSafeModule thread_safe_module(std::move(llvm_module),
-                                                 std::move(llvm_context));
-  cantFail((*jit)->AddModule(std::move(thread_safe_module)));
+  if (num_partitions > 1) {
+    // Give the moved functions external linkage so that the partitions can
+    // refer to each other. They no longer get the inlining bonus of internal
+    // functions, but while bodies and conditional branches are rarely inlined.
+    for (llvm::Function* function : splittable_functions) {
+      function->setLinkage(llvm::GlobalValue::ExternalLinkage);
+    }
+    TF_RETURN_IF_ERROR(AddModuleToJitInParallel(
+        std::move(llvm_module), num_partitions, thread_pool, module->config(),
+        pre_optimization_ir_hook, post_optimization_ir_hook, jit->get()));
+  } else {
+    llvm::orc::ThreadSafeModule thread_safe_module(std::move(llvm_module),
+                                                   std::move(llvm_context));
+    cantFail((*jit)->AddModule(std::move(thread_safe_module)));
+  }
   cpu_executable.reset(new CpuExecutable(
       std::move(*jit), std::move(assignment), std::move(module), function_name,
       std::move(hlo_profile_printer_data), std::move(hlo_profile_index_map)));
@@ -914,7 +1144,7 @@ CpuCompiler::CompileAheadOfTime(std::unique_ptr<HloModuleGroup> module_group,
         RunHloPasses(module, /*is_aot_compile=*/true, target_machine.get()));
 
     TF_ASSIGN_OR_RETURN(HloSchedule schedule,
-                        ScheduleModule(module, BufferSizeBytesFunction()));
+                        CreateHloSchedule(module, DefaultModuleScheduler));
 
     // Run buffer analysis on the HLO graph. This analysis figures out which
     // temporary buffers are required to run the computation.
@@ -924,6 +1154,7 @@ CpuCompiler::CompileAheadOfTime(std::unique_ptr<HloModuleGroup> module_group,
                             absl::make_unique<SequentialHloOrdering>(schedule),
                             BufferSizeBytesFunction(), memory_alignment,
                             /*allocate_buffers_for_constants=*/true));
+    ReportPeakMemory(*module, *assignment);
     // BufferAssignment::ToString() includes a header, so no need for us to
     // print one ourselves.
     if (DumpingEnabledForHloModule(*module)) {
@@ -1027,6 +1258,109 @@ CpuCompiler::CompileAheadOfTime(std::unique_ptr<HloModuleGroup> module_group,
   return std::move(results);
 }
 
+StatusOr<std::unique_ptr<Executable>> CpuCompiler::LoadExecutable(
+    const CpuExecutableProto& proto, const DebugOptions& debug_options) {
+  TF_ASSIGN_OR_RETURN(HloModuleConfig config,
+                      HloModule::CreateModuleConfigFromProto(
+                          proto.hlo_module(), debug_options));
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<HloModule> module,
+                      HloModule::CreateFromProto(proto.hlo_module(), config));
+  VLOG(1) << "Loading: " << module->name();
+  XLA_SCOPED_LOGGING_TIMER(
+      absl::StrFormat("Loading [%s] for CPU", module->name()));
+  if (!module->has_schedule()) {
+    return InvalidArgument("Serialized module %s has no schedule",
+                           module->name());
+  }
+
+  absl::call_once(llvm_command_line_options_initialized,
+                  &llvm_ir::InitializeLLVMCommandLineOptions, module->config());
+  auto jit = SimpleOrcJIT::Create(
+      CompilerTargetOptions(module->config()),
+      CodeGenOptLevel(module->config()),
+      options::OptimizeForSizeRequested(module->config()),
+      module->config().debug_options().xla_llvm_disable_expensive_passes(),
+      llvm_ir::GetCpuFastMathFlags(module->config()),
+      /*pre_optimization_hook=*/nullptr, /*post_optimization_hook=*/nullptr,
+      /*post_codegen_hook=*/nullptr);
+  if (!jit) {
+    return InternalError("Creating JIT failed: %s",
+                         llvm::toString(jit.takeError()));
+  }
+
+  // The object files may use any instruction the compiling host supports.
+  const llvm::TargetMachine* target_machine = (*jit)->target_machine();
+  if (target_machine->getTargetTriple().str() != proto.target_triple() ||
+      target_machine->getTargetCPU() != proto.target_cpu() ||
+      target_machine->getTargetFeatureString() != proto.target_features()) {
+    return FailedPrecondition(
+        "Module %s was compiled for %s (CPU %s, features %s) and cannot be "
+        "loaded on %s (CPU %s, features %s)",
+        module->name(), proto.target_triple(), proto.target_cpu(),
+        proto.target_features(), target_machine->getTargetTriple().str(),
+        target_machine->getTargetCPU().str(),
+        target_machine->getTargetFeatureString().str());
+  }
+
+  // Buffer assignment is deterministic given the schedule, so this reproduces
+  // the assignment the code was generated against.  Check that it does.
+  TF_ASSIGN_OR_RETURN(
+      std::unique_ptr<BufferAssignment> assignment,
+      BufferAssigner::Run(
+          module.get(),
+          absl::make_unique<SequentialHloOrdering>(module->schedule()),
+          BufferSizeBytesFunction(), memory_alignment,
+          /*allocate_buffers_for_constants=*/true));
+  std::vector<cpu_function_runtime::BufferInfo> buffer_infos =
+      CreateBufferInfosFromBufferAssignment(*assignment);
+  bool same_buffer_infos =
+      proto.buffer_info_encodings_size() == 2 * buffer_infos.size();
+  for (int i = 0; same_buffer_infos && i < buffer_infos.size(); ++i) {
+    same_buffer_infos =
+        buffer_infos[i] == cpu_function_runtime::BufferInfo(
+                               {proto.buffer_info_encodings(2 * i),
+                                proto.buffer_info_encodings(2 * i + 1)});
+  }
+  if (!same_buffer_infos) {
+    return FailedPrecondition(
+        "Buffer assignment of module %s differs from the one its code was "
+        "generated for",
+        module->name());
+  }
+
+  for (const std::string& object_file : proto.object_files()) {
+    if (llvm::Error error =
+            (*jit)->AddObjectFile(llvm::MemoryBuffer::getMemBufferCopy(
+                object_file, module->name()))) {
+      return InternalError("Adding object file to the JIT failed: %s",
+                           llvm::toString(std::move(error)));
+    }
+  }
+  llvm::Expected<llvm::JITEvaluatedSymbol> entry_symbol =
+      (*jit)->FindCompiledSymbol(proto.entry_function_name());
+  if (!entry_symbol) {
+    return InternalError("Entry function %s not found: %s",
+                         proto.entry_function_name(),
+                         llvm::toString(entry_symbol.takeError()));
+  }
+
+  std::unordered_map<const HloInstruction*, int64> instruction_to_profile_idx;
+  std::unordered_map<const HloComputation*, int64> computation_to_profile_idx;
+  std::unique_ptr<HloProfileIndexMap> hlo_profile_index_map;
+  std::unique_ptr<HloProfilePrinterData> hlo_profile_printer_data;
+  if (module->config().hlo_profiling_enabled()) {
+    TF_RETURN_IF_ERROR(CreateHloProfilingArtifacts(
+        *module, &instruction_to_profile_idx, &computation_to_profile_idx,
+        &hlo_profile_index_map, &hlo_profile_printer_data));
+  }
+
+  VLOG(1) << "Loading finished";
+  return std::unique_ptr<Executable>(new CpuExecutable(
+      std::move(*jit), std::move(assignment), std::move(module),
+      proto.entry_function_name(), std::move(hlo_profile_printer_data),
+      std::move(hlo_profile_index_map)));
+}
+
 se::Platform::Id CpuCompiler::PlatformId() const {
   return se::host::kHostPlatformId;
 }
@@ -21,8 +21,10 @@ limitations under the License.
 #include "absl/types/span.h"
 #include "llvm/Target/TargetMachine.h"
 #include "tensorflow/compiler/xla/cpu_function_runtime.h"
+#include "tensorflow/compiler/xla/service/cpu/executable.pb.h"
 #include "tensorflow/compiler/xla/service/cpu/target_machine_features.h"
 #include "tensorflow/compiler/xla/service/executable.h"
+#include "tensorflow/compiler/xla/service/hlo_memory_scheduler.h"
 #include "tensorflow/compiler/xla/service/hlo_module.h"
 #include "tensorflow/compiler/xla/service/llvm_compiler.h"
 #include "tensorflow/compiler/xla/statusor.h"
@@ -148,6 +150,13 @@ class CpuCompiler : public LLVMCompiler {
   CompileAheadOfTime(std::unique_ptr<HloModuleGroup> module_group,
                      const AotCompilationOptions& options) override;
 
+  // Turns an executable serialized with CpuExecutable::ToProto back into an
+  // executable, linking its object files into a new JIT instead of compiling
+  // the module again.  The proto must have been produced on a host with the
+  // same target triple, CPU and CPU features.
+  StatusOr<std::unique_ptr<Executable>> LoadExecutable(
+      const CpuExecutableProto& proto, const DebugOptions& debug_options);
+
   se::Platform::Id PlatformId() const override;
 
   HloCostAnalysis::ShapeSizeFunction ShapeSizeBytesFunction() const override;
@@ -171,6 +180,13 @@ class CpuCompiler : public LLVMCompiler {
       HloModule* module, bool is_aot_compile,
       LLVMTargetMachineFeatures* target_machine_features);
 
+  // Selects an order for emitting the HLO instructions of each computation
+  // using `algorithm`. If xla_cpu_memory_limit_bytes is set, also
+  // rematerializes instructions to try to keep the peak memory of the module
+  // within that limit.
+  StatusOr<HloSchedule> CreateHloSchedule(
+      HloModule* module, const ModuleSchedulerAlgorithm& algorithm);
+
   TF_DISALLOW_COPY_AND_ASSIGN(CpuCompiler);
 };
 
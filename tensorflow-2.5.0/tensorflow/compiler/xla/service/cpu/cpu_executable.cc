@@ -29,6 +29,7 @@ limitations under the License.
 #include "llvm/ExecutionEngine/Orc/IRCompileLayer.h"
 #include "tensorflow/compiler/xla/service/buffer_assignment.h"
 #include "tensorflow/compiler/xla/service/computation_layout.h"
+#include "tensorflow/compiler/xla/service/cpu/buffer_info_util.h"
 #include "tensorflow/compiler/xla/service/hlo_computation.h"
 #include "tensorflow/compiler/xla/service/hlo_module.h"
 #include "tensorflow/compiler/xla/service/logical_buffer.h"
@@ -62,7 +63,8 @@ CpuExecutable::CpuExecutable(
                  std::move(hlo_profile_index_map)),
       jit_(std::move(jit)),
       assignment_(std::move(assignment)),
-      module_name_(entry_function_name) {
+      module_name_(entry_function_name),
+      entry_function_name_(entry_function_name) {
   if (assignment_) {
     buffer_assignment_.reset(new BufferAssignmentProto(assignment_->ToProto()));
   }
@@ -414,5 +416,32 @@ int64 CpuExecutable::SizeOfGeneratedCodeInBytes() const {
   return jit_->SizeOfGeneratedCodeInBytes();
 }
 
+StatusOr<CpuExecutableProto> CpuExecutable::ToProto() const {
+  if (jit_->object_files().empty() || !module().has_schedule()) {
+    return FailedPrecondition(
+        "Module %s was not compiled with the xla_cpu_serializable_executable "
+        "backend option",
+        module().name());
+  }
+
+  CpuExecutableProto proto;
+  *proto.mutable_hlo_module() = module().ToProto();
+  for (const std::string& object_file : jit_->object_files()) {
+    proto.add_object_files(object_file);
+  }
+  proto.set_entry_function_name(entry_function_name_);
+  const llvm::TargetMachine* target_machine = jit_->target_machine();
+  proto.set_target_triple(target_machine->getTargetTriple().str());
+  proto.set_target_cpu(target_machine->getTargetCPU().str());
+  proto.set_target_features(target_machine->getTargetFeatureString().str());
+  for (const cpu_function_runtime::BufferInfo& buffer_info :
+       CreateBufferInfosFromBufferAssignment(*assignment_)) {
+    std::pair<uint64, uint64> encoding = buffer_info.Encode();
+    proto.add_buffer_info_encodings(encoding.first);
+    proto.add_buffer_info_encodings(encoding.second);
+  }
+  return proto;
+}
+
 }  // namespace cpu
 }  // namespace xla
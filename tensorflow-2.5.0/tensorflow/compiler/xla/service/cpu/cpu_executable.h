@@ -24,6 +24,7 @@ limitations under the License.
 
 #include "absl/types/span.h"
 #include "tensorflow/compiler/xla/service/buffer_assignment.h"
+#include "tensorflow/compiler/xla/service/cpu/executable.pb.h"
 #include "tensorflow/compiler/xla/service/cpu/simple_orc_jit.h"
 #include "tensorflow/compiler/xla/service/executable.h"
 #include "tensorflow/compiler/xla/service/hlo_dataflow_analysis.h"
@@ -83,6 +84,11 @@ class CpuExecutable : public Executable {
 
   int64 SizeOfGeneratedCodeInBytes() const override;
 
+  // Returns this executable in a form CpuCompiler::LoadExecutable can turn
+  // back into an executable without generating code.  Fails unless the module
+  // was compiled with the xla_cpu_serializable_executable backend option.
+  StatusOr<CpuExecutableProto> ToProto() const;
+
  private:
   // Creates an array suitable for passing as the "buffer_table" argument to the
   // JIT compiled function pointer.
@@ -26,6 +26,9 @@ const char* const kLlvmIrDotTilingFactor = "xla_llvm_dot_tiling_factor";
 const char* const kXlaForceEnableExperimentalLlvmIrGemm =
     "xla_force_enable_experimental_llvm_ir_gemm";
 const char* const kLlvmIrGemmTileSize = "xla_llvm_ir_gemm_tile_size";
+const char* const kXlaCpuDotStrategyTable = "xla_cpu_dot_strategy_table";
+const char* const kXlaCpuSerializableExecutable =
+    "xla_cpu_serializable_executable";
 
 }  // namespace
 
@@ -99,6 +102,22 @@ absl::optional<std::tuple<int64, int64, int64>> LlvmIrGemmTileSize(
                                          tile_size_n_in_vector_width);
 }
 
+absl::optional<string> DotStrategyTablePath(const HloModuleConfig& config) {
+  const auto& extra_options_map =
+      config.debug_options().xla_backend_extra_options();
+  auto it = extra_options_map.find(kXlaCpuDotStrategyTable);
+  if (it == extra_options_map.end() || it->second.empty()) {
+    return absl::nullopt;
+  }
+  return it->second;
+}
+
+bool SerializableExecutableRequested(const HloModuleConfig& config) {
+  const auto& extra_options_map =
+      config.debug_options().xla_backend_extra_options();
+  return extra_options_map.count(kXlaCpuSerializableExecutable) > 0;
+}
+
 }  // namespace options
 }  // namespace cpu
 }  // namespace xla
@@ -18,7 +18,12 @@ limitations under the License.
 #include <memory>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
 #include "llvm/IR/BasicBlock.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/Module.h"
@@ -49,7 +54,9 @@ limitations under the License.
 #include "tensorflow/compiler/xla/status_macros.h"
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/compiler/xla/xla_data.pb.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 
 namespace xla {
 
@@ -62,6 +69,99 @@ bool ShouldUseMultiThreadedEigen(const HloModuleConfig& config) {
   return config.debug_options().xla_cpu_multi_thread_eigen();
 }
 
+// The implementation a dot strategy table selects for a dot shape.
+enum class PreferredDotImplementation {
+  kTiledLlvmIr,
+  kEigen,
+  kMkl,
+};
+
+using DotStrategyTable =
+    absl::flat_hash_map<std::tuple<PrimitiveType, int64, int64, int64>,
+                        PreferredDotImplementation>;
+
+// Parses the dot strategy table in `contents`.  Every line that is not empty
+// and does not start with '#' has the form "<type> <m> <k> <n> <impl>", for
+// instance "f32 64 256 48 tiled", where <impl> is one of "tiled", "eigen" or
+// "mkl".  These tables are meant to be generated by benchmarking the
+// implementations on the dot shapes of a model on the machine it runs on.
+DotStrategyTable ParseDotStrategyTable(absl::string_view contents,
+                                       absl::string_view path) {
+  DotStrategyTable table;
+  for (absl::string_view line : absl::StrSplit(contents, '\n')) {
+    line = absl::StripAsciiWhitespace(line);
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::vector<absl::string_view> fields =
+        absl::StrSplit(line, ' ', absl::SkipEmpty());
+    StatusOr<PrimitiveType> type =
+        fields.size() == 5 ? primitive_util::StringToPrimitiveType(fields[0])
+                           : InvalidArgument("Expected 5 fields");
+    int64 m, k, n;
+    if (!type.ok() || !absl::SimpleAtoi(fields[1], &m) ||
+        !absl::SimpleAtoi(fields[2], &k) || !absl::SimpleAtoi(fields[3], &n)) {
+      LOG(WARNING) << "Ignoring malformed line in dot strategy table " << path
+                   << ": " << line;
+      continue;
+    }
+    PreferredDotImplementation impl;
+    if (fields[4] == "tiled") {
+      impl = PreferredDotImplementation::kTiledLlvmIr;
+    } else if (fields[4] == "eigen") {
+      impl = PreferredDotImplementation::kEigen;
+    } else if (fields[4] == "mkl") {
+      impl = PreferredDotImplementation::kMkl;
+    } else {
+      LOG(WARNING) << "Ignoring unknown dot implementation in dot strategy "
+                   << "table " << path << ": " << line;
+      continue;
+    }
+    table[std::make_tuple(type.ValueOrDie(), m, k, n)] = impl;
+  }
+  return table;
+}
+
+// Returns the dot strategy table stored at `path`.  Each table is read once per
+// process; a table that cannot be read is treated as empty.
+const DotStrategyTable& GetDotStrategyTable(const string& path) {
+  static tensorflow::mutex mu(tensorflow::LINKER_INITIALIZED);
+  static auto* tables =
+      new absl::flat_hash_map<string, std::unique_ptr<DotStrategyTable>>();
+  tensorflow::mutex_lock lock(mu);
+  std::unique_ptr<DotStrategyTable>& table = (*tables)[path];
+  if (table == nullptr) {
+    string contents;
+    tensorflow::Status status = tensorflow::ReadFileToString(
+        tensorflow::Env::Default(), path, &contents);
+    if (!status.ok()) {
+      LOG(WARNING) << "Could not read dot strategy table " << path << ": "
+                   << status;
+    }
+    table = absl::make_unique<DotStrategyTable>(
+        ParseDotStrategyTable(contents, path));
+  }
+  return *table;
+}
+
+// Returns the implementation the dot strategy table configured through the
+// xla_cpu_dot_strategy_table backend option selects for an m x k x n dot of
+// `type`, if there is a table and it has an entry for that shape.
+absl::optional<PreferredDotImplementation> GetPreferredDotImplementation(
+    const HloModuleConfig& config, PrimitiveType type, int64 m, int64 k,
+    int64 n) {
+  absl::optional<string> path = options::DotStrategyTablePath(config);
+  if (!path.has_value()) {
+    return absl::nullopt;
+  }
+  const DotStrategyTable& table = GetDotStrategyTable(*path);
+  auto it = table.find(std::make_tuple(type, m, k, n));
+  if (it == table.end()) {
+    return absl::nullopt;
+  }
+  return it->second;
+}
+
 // Represents a dot operation.  We use this in lieu of an `HloInstruction`
 // because we want to be able to create this for the "inner" dot operation in a
 // batch dot, for which there is no separate HLO instruction.
@@ -739,6 +839,15 @@ Status DotOpEmitter::EmitCallToRuntime() {
   bool multi_threaded = ShouldUseMultiThreadedEigen(hlo_module_config_);
   bool use_mkl_dnn = hlo_module_config_.debug_options().xla_cpu_use_mkl_dnn();
   PrimitiveType type = target_array_.GetShape().element_type();
+  MatMultDims mat_mult_dims = GetMatMultDims();
+  if (use_mkl_dnn) {
+    // Let the strategy table send shapes MKL-DNN is slow on back to Eigen.
+    absl::optional<PreferredDotImplementation> preferred =
+        GetPreferredDotImplementation(hlo_module_config_, type,
+                                      mat_mult_dims.m, mat_mult_dims.k,
+                                      mat_mult_dims.n);
+    use_mkl_dnn = preferred != PreferredDotImplementation::kEigen;
+  }
   llvm::Function* function = b_->GetInsertBlock()->getParent();
   llvm::Module* module = function->getParent();
   llvm::Type* float_type;
@@ -820,8 +929,6 @@ Status DotOpEmitter::EmitCallToRuntime() {
   //
   // Effectively this involves swapping the 'lhs' with 'rhs' and 'm' with 'n'.
 
-  MatMultDims mat_mult_dims = GetMatMultDims();
-
   CHECK_EQ(mat_mult_dims.lhs_column_major, mat_mult_dims.rhs_column_major);
 
   const llvm_ir::IrArray* lhs = &lhs_array_;
@@ -974,22 +1081,32 @@ bool CanEmitTiledLlvmIrGemm(
     const TargetMachineFeatures& target_machine_features) {
   CHECK(IsAlignedGemm(dot_info, target_machine_features));
 
-  if (ShouldUseMultiThreadedEigen(config)) {
-    return false;
-  }
-
   int m = dot_info.result_shape.dimensions(0);
   int k = dot_info.lhs_shape.dimensions(
       dot_info.dim_nums.lhs_contracting_dimensions(0));
   int n = dot_info.result_shape.dimensions(1);
 
-  if (!options::ForceEnableExperimentalLlvmIrGemm(config)) {
-    // TODO(sanjoy):  We should make these numbers micro-arch specific.
-    bool small_gemm =
-        k <= 128 && ((m <= 32 && n <= 128) || (m <= 128 && n <= 32));
-    if (!small_gemm) {
+  // A strategy table entry for this shape overrides the heuristics below.
+  absl::optional<PreferredDotImplementation> preferred =
+      GetPreferredDotImplementation(
+          config, dot_info.result_shape.element_type(), m, k, n);
+  if (preferred.has_value()) {
+    if (*preferred != PreferredDotImplementation::kTiledLlvmIr) {
+      return false;
+    }
+  } else {
+    if (ShouldUseMultiThreadedEigen(config)) {
       return false;
     }
+
+    if (!options::ForceEnableExperimentalLlvmIrGemm(config)) {
+      // TODO(sanjoy):  We should make these numbers micro-arch specific.
+      bool small_gemm =
+          k <= 128 && ((m <= 32 && n <= 128) || (m <= 128 && n <= 32));
+      if (!small_gemm) {
+        return false;
+      }
+    }
   }
 
   bool lhs_canonical = dot_info.dim_nums.lhs_contracting_dimensions(0) == 1;
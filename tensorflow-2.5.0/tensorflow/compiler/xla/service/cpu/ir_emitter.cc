@@ -1672,13 +1672,26 @@ StatusOr<bool> IrEmitter::EmitVectorizedReduce(
       MinimumAlignmentForPrimitiveType(reduce->shape().element_type())));
 
   if (is_reduction_over_minor_dimension) {
-    // TODO(sanjoy): Implement vectorized reduction over the minor dimension.
-    *failure_reason = "reduction over minor dimension not implemented";
+    return EmitVectorizedReduceOverMinorDimensions(
+        reduce, arg, init_value, dimensions, reduction_generator,
+        vectorization_factor, element_alignment, failure_reason);
+  }
+
+  // Parallel tasks split the most major output dimensions between them; the
+  // loops below can only honor that for dimensions other than the most minor.
+  const bool emit_parallel_loop = ShouldEmitParallelLoopFor(*reduce);
+  if (emit_parallel_loop &&
+      num_dynamic_loop_bounds_ >= reduce->shape().dimensions_size()) {
+    *failure_reason = "partitioning of the most minor dimension not supported";
     return false;
   }
 
   CHECK(!reduce->shape().IsTuple());
   TF_RETURN_IF_ERROR(EmitTargetAddressForOp(reduce));
+  std::vector<std::pair<llvm::Value*, llvm::Value*>> dynamic_loop_bounds;
+  if (emit_parallel_loop) {
+    dynamic_loop_bounds = compute_function_->GetDynamicLoopBounds();
+  }
 
   // We know we're not reducing over the most minor dimension, which means we
   // can lower the reduction loop as:
@@ -1703,13 +1716,22 @@ StatusOr<bool> IrEmitter::EmitVectorizedReduce(
   llvm_ir::ForLoopNest loop_nest(IrName(reduce), &b_);
   std::vector<llvm::Value*> array_multi_index(
       reduce->shape().dimensions_size());
+  const int64 num_dims = reduce->shape().dimensions_size();
   for (int i = LayoutUtil::MinorToMajor(reduce->shape()).size() - 1; i > 0;
        --i) {
     int64 dimension = LayoutUtil::Minor(reduce->shape().layout(), i);
-    int64 start_index = 0;
-    int64 end_index = reduce->shape().dimensions(dimension);
-    std::unique_ptr<llvm_ir::ForLoop> loop = loop_nest.AddLoop(
-        start_index, end_index, absl::StrFormat("dim.%d", dimension));
+    const int bounds_index = num_dims - 1 - i;
+    std::unique_ptr<llvm_ir::ForLoop> loop;
+    if (bounds_index < dynamic_loop_bounds.size()) {
+      loop = loop_nest.AddLoop(absl::StrFormat("dim.%d", dimension),
+                               dynamic_loop_bounds[bounds_index].first,
+                               dynamic_loop_bounds[bounds_index].second);
+    } else {
+      int64 start_index = 0;
+      int64 end_index = reduce->shape().dimensions(dimension);
+      loop = loop_nest.AddLoop(start_index, end_index,
+                               absl::StrFormat("dim.%d", dimension));
+    }
     array_multi_index[dimension] = loop->GetIndVarValue();
   }
 
@@ -1792,6 +1814,164 @@ StatusOr<bool> IrEmitter::EmitVectorizedReduce(
   return true;
 }
 
+StatusOr<bool> IrEmitter::EmitVectorizedReduceOverMinorDimensions(
+    HloInstruction* reduce, HloInstruction* arg, HloInstruction* init_value,
+    absl::Span<const int64> dimensions,
+    const ReductionGenerator& reduction_generator, int vectorization_factor,
+    llvm::Align element_alignment, string* failure_reason) {
+  const Shape& arg_shape = arg->shape();
+  absl::flat_hash_set<int64> reduced_dims(dimensions.begin(),
+                                          dimensions.end());
+  int64 num_reduced_elements = 1;
+  for (int64 i = 0; i < dimensions.size(); ++i) {
+    int64 dimension = LayoutUtil::Minor(arg_shape.layout(), i);
+    if (!reduced_dims.contains(dimension)) {
+      *failure_reason = "reduced dimensions are not the most minor dimensions";
+      return false;
+    }
+    num_reduced_elements *= arg_shape.dimensions(dimension);
+  }
+  if (num_reduced_elements < vectorization_factor) {
+    *failure_reason = "too few reduced elements per output element";
+    return false;
+  }
+
+  // The R reduced elements of every output element are contiguous, so we
+  // lower the reduction as:
+  //
+  //  for (output element o) {
+  //    vector_acc = init
+  //    for (r in R with stride VS) {
+  //      vector_acc = elementwise_reduce(vector_acc, input[o, r:r+VS])
+  //    }
+  //    acc = horizontal_reduce(vector_acc)
+  //    for (r in [R - R % VS, R)) {
+  //      acc = reduce(acc, input[o, r])
+  //    }
+  //    output[o] = acc
+  //  }
+  //
+  // This combines the init value more than once, which is fine because it has
+  // to be an identity of the reduction. The loop over output elements is
+  // split between parallel tasks by EmitTargetElementLoop.
+  const int64 vectorized_end =
+      num_reduced_elements / vectorization_factor * vectorization_factor;
+  ShardedVectorType accumulator_type = CreateShardedVectorType(
+      reduce->shape().element_type(), vectorization_factor);
+  llvm::Type* element_ir_type =
+      llvm_ir::PrimitiveTypeToIrType(reduce->shape().element_type(), module_);
+  llvm_ir::IrArray arg_array(GetIrArrayFor(arg));
+
+  auto element_generator = [&](const llvm_ir::IrArray::Index& output_index)
+      -> StatusOr<llvm::Value*> {
+    std::vector<llvm::Value*> input_multi_index;
+    input_multi_index.reserve(arg_shape.dimensions_size());
+    auto it = output_index.begin();
+    for (int64 i = 0; i < arg_shape.dimensions_size(); ++i) {
+      input_multi_index.push_back(reduced_dims.contains(i) ? b_.getInt64(0)
+                                                           : *it++);
+    }
+    CHECK(output_index.end() == it);
+    llvm_ir::IrArray::Index input_index(input_multi_index, arg_shape,
+                                        b_.getInt64Ty());
+    llvm::Value* row_address =
+        arg_array.EmitArrayElementAddress(input_index, &b_);
+
+    llvm::Value* init_value_ssa = Load(GetEmittedValueFor(init_value));
+    ShardedVector accumulator;
+    accumulator.reserve(accumulator_type.size());
+    for (llvm::Type* shard_type : accumulator_type) {
+      llvm::Value* accumulator_shard = llvm_ir::EmitAllocaAtFunctionEntry(
+          shard_type, "accumulator", &b_, 0);
+      llvm::Value* initial_value = init_value_ssa;
+      if (auto vector_type = llvm::dyn_cast<llvm::VectorType>(shard_type)) {
+        initial_value =
+            VectorSplat(vector_type->getElementCount(), init_value_ssa);
+      }
+      AlignedStore(initial_value, accumulator_shard, element_alignment);
+      accumulator.push_back(accumulator_shard);
+    }
+
+    std::unique_ptr<llvm_ir::ForLoop> vectorized_loop =
+        llvm_ir::ForLoop::EmitForLoop(
+            IrName(reduce, "vectorized_minor"), b_.getInt64(0),
+            b_.getInt64(vectorized_end), b_.getInt64(vectorization_factor),
+            &b_);
+    SetToFirstInsertPoint(vectorized_loop->GetBodyBasicBlock(), &b_);
+    llvm::Value* input_address =
+        BitCast(InBoundsGEP(row_address, {vectorized_loop->GetIndVarValue()}),
+                b_.getInt8PtrTy());
+    for (int i = 0; i < accumulator.size(); i++) {
+      auto input_address_typed =
+          BitCast(input_address, accumulator[i]->getType());
+      auto current_accumulator_value =
+          AlignedLoad(accumulator[i], element_alignment);
+      auto addend = AlignedLoad(input_address_typed, element_alignment);
+      arg_array.AnnotateLoadStoreInstructionWithMetadata(addend);
+
+      auto reduced_result =
+          reduction_generator(&b_, current_accumulator_value, addend);
+      AlignedStore(reduced_result, accumulator[i], element_alignment);
+
+      if (i != (accumulator.size() - 1)) {
+        input_address = ConstInBoundsGEP1_32(reduced_result->getType(),
+                                             input_address_typed, 1);
+      }
+    }
+    SetToFirstInsertPoint(vectorized_loop->GetExitBasicBlock(), &b_);
+
+    // Combine the accumulator shards of the same vector type elementwise
+    // before reducing the remaining lanes one at a time.
+    llvm::Value* vector_partial = nullptr;
+    std::vector<llvm::Value*> partials;
+    for (llvm::Value* accumulator_shard : accumulator) {
+      llvm::Value* shard_value =
+          AlignedLoad(accumulator_shard, element_alignment);
+      if (vector_partial == nullptr) {
+        vector_partial = shard_value;
+      } else if (vector_partial->getType() == shard_value->getType()) {
+        vector_partial = reduction_generator(&b_, vector_partial, shard_value);
+      } else {
+        partials.push_back(shard_value);
+      }
+    }
+    partials.push_back(vector_partial);
+
+    llvm::Value* result = nullptr;
+    for (llvm::Value* partial : partials) {
+      auto vector_type = llvm::dyn_cast<llvm::FixedVectorType>(
+          partial->getType());
+      const int num_lanes = vector_type ? vector_type->getNumElements() : 1;
+      for (int lane = 0; lane < num_lanes; ++lane) {
+        llvm::Value* element =
+            vector_type ? ExtractElement(partial, b_.getInt32(lane)) : partial;
+        result = result ? reduction_generator(&b_, result, element) : element;
+      }
+    }
+
+    if (vectorized_end == num_reduced_elements) {
+      return result;
+    }
+    llvm::Value* result_address = llvm_ir::EmitAllocaAtFunctionEntry(
+        element_ir_type, "minor_reduce_result", &b_);
+    Store(result, result_address);
+    std::unique_ptr<llvm_ir::ForLoop> epilogue_loop =
+        llvm_ir::ForLoop::EmitForLoop(
+            IrName(reduce, "minor_epilogue"), b_.getInt64(vectorized_end),
+            b_.getInt64(num_reduced_elements), b_.getInt64(1), &b_);
+    SetToFirstInsertPoint(epilogue_loop->GetBodyBasicBlock(), &b_);
+    llvm::Value* element =
+        Load(InBoundsGEP(row_address, {epilogue_loop->GetIndVarValue()}));
+    Store(reduction_generator(&b_, Load(result_address), element),
+          result_address);
+    SetToFirstInsertPoint(epilogue_loop->GetExitBasicBlock(), &b_);
+    return Load(result_address);
+  };
+
+  TF_RETURN_IF_ERROR(EmitTargetElementLoop(reduce, element_generator));
+  return true;
+}
+
 Status IrEmitter::HandleReduce(HloInstruction* reduce) {
   auto arg = reduce->mutable_operand(0);
   auto init_value = reduce->mutable_operand(1);
@@ -392,6 +392,16 @@ class IrEmitter : public DfsHloVisitorWithDefault,
   ReductionGenerator MatchReductionGenerator(HloComputation* function,
                                              string* failure_reason) const;
 
+  // Emits a reduction over the most minor dimensions of `arg`, whose reduced
+  // elements are therefore contiguous, by accumulating `vectorization_factor`
+  // elements at a time and reducing the accumulator horizontally at the end.
+  // Helper function for EmitVectorizedReduce.
+  StatusOr<bool> EmitVectorizedReduceOverMinorDimensions(
+      HloInstruction* reduce, HloInstruction* arg, HloInstruction* init_value,
+      absl::Span<const int64> dimensions,
+      const ReductionGenerator& reduction_generator, int vectorization_factor,
+      llvm::Align element_alignment, string* failure_reason);
+
   // Emits the inner loop nest that runs the reduction.  Helper function for
   // EmitVectorizedReduce.
   StatusOr<ShardedVector> EmitInnerLoopForVectorizedReduction(
@@ -36,8 +36,12 @@ class SimpleCostModel : public ParallelCostModel {
   ~SimpleCostModel() override {}
 
   int64 GetParallelTaskCount(HloInstruction* instruction) override {
-    // Simple cost model based on hlo size and typical L2 cache size.
-    const int64 instruction_cost = shape_size_(instruction->shape());
+    // Simple cost model based on hlo size and typical L2 cache size. A
+    // reduction reads more than it writes, so it is sized by its input.
+    const int64 instruction_cost =
+        shape_size_(instruction->opcode() == HloOpcode::kReduce
+                        ? instruction->operand(0)->shape()
+                        : instruction->shape());
     const int64 min_cost_per_thread = 256LL << 10;  // 256KB L2 Cache size.
     // Return target parallel task count in [1, max_parallelism_].
     return std::min(max_parallelism_,
@@ -79,7 +83,11 @@ class DefaultCostModel : public ParallelCostModel {
           max_parallelism_,
           std::ceil(std::sqrt(tensorflow::port::MaxParallelism())));
       // Use shape size instruction cost and L2 cache size min per-thread cost.
-      instruction_cost = shape_size_(instruction->shape());
+      // A reduction reads more than it writes, so it is sized by the bytes it
+      // accesses instead.
+      instruction_cost = instruction->opcode() == HloOpcode::kReduce
+                             ? bytes_accessed
+                             : shape_size_(instruction->shape());
       min_cost_per_thread = 256LL << 10;  // 256KB L2 Cache size.
     } else {
       // Use max parallelism for compute bound instructions.
@@ -211,6 +211,9 @@ void SimpleOrcJIT::notifyObjectLoaded(
     const llvm::RuntimeDyld::LoadedObjectInfo& object_info) {
   gdb_jit_event_listener_->notifyObjectLoaded(key, object, object_info);
   size_of_generated_code_in_bytes_ += object.getData().size();
+  if (keep_object_files_) {
+    object_files_.push_back(object.getData().str());
+  }
 }
 
 void SimpleOrcJIT::notifyFreeingObject(llvm::JITEventListener::ObjectKey key) {
@@ -221,6 +224,11 @@ llvm::Error SimpleOrcJIT::AddModule(llvm::orc::ThreadSafeModule module) {
   return compile_layer_.add(*main_jit_dylib_, std::move(module));
 }
 
+llvm::Error SimpleOrcJIT::AddObjectFile(
+    std::unique_ptr<llvm::MemoryBuffer> object_file) {
+  return object_layer_.add(*main_jit_dylib_, std::move(object_file));
+}
+
 llvm::Expected<llvm::JITEvaluatedSymbol> SimpleOrcJIT::FindCompiledSymbol(
     const std::string& name) {
   return execution_session_->lookup({main_jit_dylib_}, name);
@@ -28,6 +28,7 @@ limitations under the License.
 #include "llvm/ExecutionEngine/Orc/SymbolStringPool.h"
 #include "llvm/ExecutionEngine/Orc/TargetProcessControl.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Target/TargetMachine.h"
 #include "tensorflow/compiler/xla/service/cpu/compiler_functor.h"
 #include "tensorflow/compiler/xla/types.h"
@@ -40,7 +41,8 @@ namespace cpu {
 // This class wraps Orc's functionality into a single interface that only
 // exposes what we need for XLA.
 //
-// Supports JIT-ing multiple modules but without cross-module linking.
+// Supports JIT-ing multiple modules, and object files compiled elsewhere for
+// the JIT's target; symbols are resolved across all of them at link time.
 // Implements eager compilation - the module is lowered to binary as soon as
 // it's added to the JIT.
 class SimpleOrcJIT : public llvm::JITEventListener {
@@ -81,6 +83,11 @@ class SimpleOrcJIT : public llvm::JITEventListener {
 
   llvm::Error AddModule(llvm::orc::ThreadSafeModule module);
 
+  // Adds an already compiled object file, e.g. one partition of a module that
+  // was optimized and lowered on another thread. The object must have been
+  // generated for target_machine()'s triple and data layout.
+  llvm::Error AddObjectFile(std::unique_ptr<llvm::MemoryBuffer> object_file);
+
   // Get the runtime address of the compiled symbol whose name is given. Returns
   // nullptr if the symbol cannot be found.
   llvm::Expected<llvm::JITEvaluatedSymbol> FindCompiledSymbol(
@@ -98,6 +105,15 @@ class SimpleOrcJIT : public llvm::JITEventListener {
     return size_of_generated_code_in_bytes_;
   }
 
+  // If `keep_object_files` is true, the JIT keeps a copy of every object file
+  // it loads from then on, so that the generated code can be serialized.
+  void set_keep_object_files(bool keep_object_files) {
+    keep_object_files_ = keep_object_files;
+  }
+
+  // The object files kept since set_keep_object_files(true), in load order.
+  const std::vector<std::string>& object_files() const { return object_files_; }
+
  private:
   llvm::JITEvaluatedSymbol ResolveRuntimeSymbol(llvm::StringRef name);
 
@@ -115,6 +131,8 @@ class SimpleOrcJIT : public llvm::JITEventListener {
   CompileLayerT compile_layer_;
   llvm::orc::JITDylib* main_jit_dylib_;
   int64 size_of_generated_code_in_bytes_ = 0;
+  bool keep_object_files_ = false;
+  std::vector<std::string> object_files_;
 
   // Non owning pointer to a JIT event listener that registers the JIT events
   // with an attached GDB.
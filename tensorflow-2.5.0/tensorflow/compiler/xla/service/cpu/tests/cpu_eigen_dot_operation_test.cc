@@ -24,6 +24,9 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/cpu/tests/cpu_codegen_test.h"
 #include "tensorflow/compiler/xla/service/hlo_computation.h"
 #include "tensorflow/compiler/xla/tests/test_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace xla {
@@ -108,6 +111,50 @@ INSTANTIATE_TEST_SUITE_P(CpuEigenDotOperationTestInstantiation,
                          ::testing::ValuesIn(GetDotTestCases()),
                          DotTestSpecToString);
 
+class CpuDotStrategyTableTest : public CpuCodegenTest {
+ protected:
+  DebugOptions GetDebugOptionsForTest() override {
+    DebugOptions debug_options = HloTestBase::GetDebugOptionsForTest();
+    debug_options.set_xla_cpu_multi_thread_eigen(false);
+    (*debug_options.mutable_xla_backend_extra_options())
+        ["xla_cpu_dot_strategy_table"] = table_path_;
+    return debug_options;
+  }
+
+  const string table_path_ = tensorflow::io::JoinPath(
+      tensorflow::testing::TmpDir(), "dot_strategy_table.txt");
+};
+
+TEST_F(CpuDotStrategyTableTest, TableOverridesTiledLlvmIrGemm) {
+  // Without the table this dot is small enough for the tiled LLVM IR GEMM.
+  TF_ASSERT_OK(tensorflow::WriteStringToFile(tensorflow::Env::Default(),
+                                             table_path_,
+                                             "# type m k n impl\n"
+                                             "f32 16 16 16 eigen\n"));
+
+  HloComputation::Builder builder(TestName());
+  auto param_shape = ShapeUtil::MakeShape(F32, {16, 16});
+  HloInstruction* lhs = builder.AddInstruction(
+      HloInstruction::CreateParameter(0, param_shape, "input"));
+  HloInstruction* rhs = builder.AddInstruction(
+      HloInstruction::CreateParameter(1, param_shape, "input"));
+  builder.AddInstruction(CreateCanonicalDot(param_shape, lhs, rhs));
+
+  CpuAotCompilationOptions options{
+      /*triple=*/kTargetTripleForHost, /*cpu_name=*/kTargetCpuForHost,
+      /*features=*/"",
+      /*entry_point_name=*/"entry",
+      /*relocation_model=*/CpuAotCompilationOptions::RelocationModel::Static};
+
+  auto hlo_module = CreateNewVerifiedModule();
+  hlo_module->AddEntryComputation(builder.Build());
+
+  CompileAheadOfTimeAndVerifyIr(
+      std::move(hlo_module), options,
+      R"(CHECK: call void @__xla_cpu_runtime_EigenSingleThreadedMatMulF32)",
+      /*match_optimized_ir=*/true);
+}
+
 }  // namespace
 }  // namespace cpu
 }  // namespace xla
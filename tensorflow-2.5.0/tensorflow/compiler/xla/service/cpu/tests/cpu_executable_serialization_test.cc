@@ -0,0 +1,120 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Tests that CPU executables can be serialized and loaded without compiling
+// them again.
+
+#include <memory>
+#include <utility>
+
+#include "tensorflow/compiler/xla/literal.h"
+#include "tensorflow/compiler/xla/literal_util.h"
+#include "tensorflow/compiler/xla/service/cpu/cpu_compiler.h"
+#include "tensorflow/compiler/xla/service/cpu/cpu_executable.h"
+#include "tensorflow/compiler/xla/service/cpu/executable.pb.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/compiler/xla/tests/literal_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+const char* const kHloText = R"(
+HloModule Serialize
+
+ENTRY main {
+  p0 = f32[2,2] parameter(0)
+  p1 = f32[2,2] parameter(1)
+  c = f32[2,2] constant({{1, 2}, {3, 4}})
+  dot = f32[2,2] dot(p0, p1), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  ROOT add = f32[2,2] add(dot, c)
+}
+)";
+
+class CpuExecutableSerializationTest : public HloTestBase {
+ protected:
+  DebugOptions GetDebugOptionsForTest() override {
+    DebugOptions debug_options = HloTestBase::GetDebugOptionsForTest();
+    (*debug_options.mutable_xla_backend_extra_options())
+        ["xla_cpu_serializable_executable"] = "";
+    return debug_options;
+  }
+};
+
+TEST_F(CpuExecutableSerializationTest, LoadedExecutableRuns) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(kHloText));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Executable> executable,
+      test_runner_.CreateExecutable(std::move(module),
+                                    /*run_hlo_passes=*/true));
+  TF_ASSERT_OK_AND_ASSIGN(
+      CpuExecutableProto proto,
+      static_cast<CpuExecutable*>(executable.get())->ToProto());
+  executable.reset();
+
+  CpuExecutableProto stored_proto;
+  ASSERT_TRUE(stored_proto.ParseFromString(proto.SerializeAsString()));
+  CpuCompiler compiler;
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Executable> loaded,
+      compiler.LoadExecutable(stored_proto, GetDebugOptionsForTest()));
+
+  Literal lhs = LiteralUtil::CreateR2<float>({{1, 2}, {3, 4}});
+  Literal rhs = LiteralUtil::CreateR2<float>({{5, 6}, {7, 8}});
+  TF_ASSERT_OK_AND_ASSIGN(
+      Literal result,
+      test_runner_.ExecuteWithExecutable(std::move(loaded), {&lhs, &rhs},
+                                         /*profile=*/nullptr));
+  EXPECT_TRUE(LiteralTestUtil::Equal(
+      LiteralUtil::CreateR2<float>({{20, 24}, {46, 54}}), result));
+}
+
+TEST_F(CpuExecutableSerializationTest, LoadRejectsOtherCpu) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(kHloText));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Executable> executable,
+      test_runner_.CreateExecutable(std::move(module),
+                                    /*run_hlo_passes=*/true));
+  TF_ASSERT_OK_AND_ASSIGN(
+      CpuExecutableProto proto,
+      static_cast<CpuExecutable*>(executable.get())->ToProto());
+
+  proto.set_target_features(proto.target_features() + ",+unknown-feature");
+  CpuCompiler compiler;
+  EXPECT_EQ(compiler.LoadExecutable(proto, GetDebugOptionsForTest())
+                .status()
+                .code(),
+            tensorflow::error::FAILED_PRECONDITION);
+}
+
+using CpuExecutableToProtoTest = HloTestBase;
+
+TEST_F(CpuExecutableToProtoTest, RequiresSerializableExecutableOption) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(kHloText));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Executable> executable,
+      test_runner_.CreateExecutable(std::move(module),
+                                    /*run_hlo_passes=*/true));
+  EXPECT_EQ(static_cast<CpuExecutable*>(executable.get())
+                ->ToProto()
+                .status()
+                .code(),
+            tensorflow::error::FAILED_PRECONDITION);
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
@@ -0,0 +1,109 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Tests that the CPU compiler rematerializes instructions to fit modules
+// within xla_cpu_memory_limit_bytes.
+
+#include <memory>
+#include <tuple>
+#include <utility>
+
+#include "tensorflow/compiler/xla/service/buffer_assignment.h"
+#include "tensorflow/compiler/xla/service/cpu/cpu_compiler.h"
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+// The broadcast is used both at the start and at the end of the computation,
+// so it is live while negate (4KB) and concat.1 (8KB) are computed, for a peak
+// of 16KB. Recomputing it before concat.2 brings the peak down to about 12KB.
+const char* const kHloText = R"(
+HloModule Rematerialize
+
+ENTRY main {
+  param = f32[] parameter(0)
+  bcast = f32[1024] broadcast(param), dimensions={}
+  negate = f32[1024] negate(bcast)
+  concat.1 = f32[2048] concatenate(negate, negate), dimensions={0}
+  slice.1 = f32[1] slice(concat.1), slice={[0:1]}
+  concat.2 = f32[1025] concatenate(bcast, slice.1), dimensions={0}
+  ROOT slice.2 = f32[1] slice(concat.2), slice={[0:1]}
+}
+)";
+
+constexpr int64 kMemoryLimitBytes = 14 * 1024;
+
+class CpuRematerializationTest : public HloTestBase {
+ protected:
+  // Schedules and assigns buffers to the module of kHloText, without running
+  // the HLO passes, with the given memory limit. Returns the bytes allocated
+  // other than the parameters, and the number of broadcasts in the module.
+  void Compile(int64 memory_limit_bytes, int64* peak_bytes,
+               int* num_broadcasts) {
+    HloModuleConfig config = GetModuleConfigForTest();
+    DebugOptions debug_options = config.debug_options();
+    debug_options.set_xla_cpu_memory_limit_bytes(memory_limit_bytes);
+    config.set_debug_options(debug_options);
+    TF_ASSERT_OK_AND_ASSIGN(auto module,
+                            ParseAndReturnVerifiedModule(kHloText, config));
+
+    CpuCompiler compiler;
+    std::unique_ptr<HloModule> compiled_module;
+    std::unique_ptr<BufferAssignment> assignment;
+    TF_ASSERT_OK_AND_ASSIGN(
+        std::tie(compiled_module, assignment),
+        compiler.RunHloPassesAndBufferAssignement(
+            std::move(module), backend().default_stream_executor(),
+            /*optimize=*/false, /*options=*/{}));
+
+    const BufferAssignment::Stats& stats = assignment->GetStats();
+    *peak_bytes =
+        stats.total_allocation_bytes - stats.parameter_allocation_bytes;
+    *num_broadcasts = 0;
+    for (const HloInstruction* instruction :
+         compiled_module->entry_computation()->instructions()) {
+      if (instruction->opcode() == HloOpcode::kBroadcast) {
+        ++*num_broadcasts;
+      }
+    }
+  }
+};
+
+TEST_F(CpuRematerializationTest, ExceedsLimitWithoutRematerialization) {
+  int64 peak_bytes;
+  int num_broadcasts;
+  ASSERT_NO_FATAL_FAILURE(
+      Compile(/*memory_limit_bytes=*/0, &peak_bytes, &num_broadcasts));
+  EXPECT_EQ(num_broadcasts, 1);
+  EXPECT_GT(peak_bytes, kMemoryLimitBytes);
+}
+
+TEST_F(CpuRematerializationTest, RematerializesToMeetLimit) {
+  int64 peak_bytes;
+  int num_broadcasts;
+  ASSERT_NO_FATAL_FAILURE(
+      Compile(kMemoryLimitBytes, &peak_bytes, &num_broadcasts));
+  EXPECT_EQ(num_broadcasts, 2);
+  EXPECT_LE(peak_bytes, kMemoryLimitBytes);
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
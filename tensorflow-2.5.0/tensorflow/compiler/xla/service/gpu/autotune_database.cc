@@ -0,0 +1,188 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/autotune_database.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/compiler/xla/statusor.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace xla {
+namespace gpu {
+
+/*static*/ AutotuneDatabase* AutotuneDatabase::Global() {
+  static auto* database = new AutotuneDatabase();
+  return database;
+}
+
+namespace {
+
+// Returns the versions of the DNN and BLAS libraries of `stream_exec`, which
+// change the available algorithms and their speed.
+std::string LibraryVersions(se::StreamExecutor* stream_exec) {
+  std::string dnn_version;
+  if (auto* dnn = stream_exec->AsDnn()) {
+    StatusOr<se::dnn::VersionInfo> version_or = dnn->GetVersion();
+    if (version_or.ok()) {
+      const se::dnn::VersionInfo& version = version_or.ValueOrDie();
+      dnn_version = absl::StrCat(version.major_version(), ".",
+                                 version.minor_version(), ".", version.patch());
+    }
+  }
+  std::string blas_version;
+  if (auto* blas = stream_exec->AsBlas()) {
+    blas->GetVersion(&blas_version).IgnoreError();
+  }
+  return absl::StrCat("cudnn=", dnn_version, ",blas=", blas_version);
+}
+
+}  // namespace
+
+/*static*/ AutotuneDatabase::Key AutotuneDatabase::MakeKey(
+    se::StreamExecutor* stream_exec, const DebugOptions& debug_options,
+    absl::string_view op_key) {
+  const se::DeviceDescription& desc = stream_exec->GetDeviceDescription();
+  return Key(desc.name(), desc.driver_version(), LibraryVersions(stream_exec),
+             absl::StrCat("deterministic_ops=",
+                          debug_options.xla_gpu_deterministic_ops(),
+                          ",autotune_level=",
+                          debug_options.xla_gpu_autotune_level()),
+             std::string(op_key));
+}
+
+void AutotuneDatabase::InsertEntry(const AutotuneDatabaseEntry& entry) {
+  // Later entries win, so that a file that was appended to after being
+  // re-tuned reflects the latest measurement.
+  results_[Key(entry.device_model(), entry.driver_version(),
+               entry.library_versions(), entry.autotune_options(),
+               entry.op_key())] = entry.result();
+}
+
+Status AutotuneDatabase::AttachFile(const std::string& path) {
+  tensorflow::mutex_lock lock(mu_);
+  if (path == attached_path_) {
+    return Status::OK();
+  }
+  tensorflow::Env* env = tensorflow::Env::Default();
+  if (env->FileExists(path).ok()) {
+    AutotuneDatabaseProto proto;
+    TF_RETURN_IF_ERROR(tensorflow::ReadBinaryProto(env, path, &proto));
+    for (const AutotuneDatabaseEntry& entry : proto.entries()) {
+      InsertEntry(entry);
+    }
+    VLOG(1) << "Loaded " << proto.entries_size()
+            << " autotuning results from " << path;
+  }
+  attached_path_ = path;
+  return Status::OK();
+}
+
+Status AutotuneDatabase::Load(const std::string& path) {
+  AutotuneDatabaseProto proto;
+  TF_RETURN_IF_ERROR(
+      tensorflow::ReadBinaryProto(tensorflow::Env::Default(), path, &proto));
+  tensorflow::mutex_lock lock(mu_);
+  for (const AutotuneDatabaseEntry& entry : proto.entries()) {
+    InsertEntry(entry);
+  }
+  return Status::OK();
+}
+
+Status AutotuneDatabase::Save(const std::string& path) const {
+  return tensorflow::WriteBinaryProto(tensorflow::Env::Default(), path,
+                                      ToProto());
+}
+
+absl::optional<tensorflow::AutotuneResult> AutotuneDatabase::Lookup(
+    se::StreamExecutor* stream_exec, const DebugOptions& debug_options,
+    absl::string_view op_key) const {
+  Key key = MakeKey(stream_exec, debug_options, op_key);
+  tensorflow::mutex_lock lock(mu_);
+  auto it = results_.find(key);
+  if (it == results_.end()) {
+    return absl::nullopt;
+  }
+  return it->second;
+}
+
+void AutotuneDatabase::Insert(se::StreamExecutor* stream_exec,
+                              const DebugOptions& debug_options,
+                              absl::string_view op_key,
+                              const tensorflow::AutotuneResult& result) {
+  AutotuneDatabaseProto appended;
+  AutotuneDatabaseEntry* entry = appended.add_entries();
+  std::tie(*entry->mutable_device_model(), *entry->mutable_driver_version(),
+           *entry->mutable_library_versions(),
+           *entry->mutable_autotune_options(), *entry->mutable_op_key()) =
+      MakeKey(stream_exec, debug_options, op_key);
+  *entry->mutable_result() = result;
+
+  tensorflow::mutex_lock lock(mu_);
+  InsertEntry(*entry);
+  if (attached_path_.empty()) {
+    return;
+  }
+  // Concatenating serialized protos merges their repeated fields, so appending
+  // the serialized entry keeps the file a valid AutotuneDatabaseProto.
+  std::unique_ptr<tensorflow::WritableFile> file;
+  Status status =
+      tensorflow::Env::Default()->NewAppendableFile(attached_path_, &file);
+  if (status.ok()) {
+    status = file->Append(appended.SerializeAsString());
+  }
+  if (status.ok()) {
+    status = file->Close();
+  }
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to append autotuning result to " << attached_path_
+                 << ": " << status;
+  }
+}
+
+AutotuneDatabaseProto AutotuneDatabase::ToProto() const {
+  AutotuneDatabaseProto proto;
+  tensorflow::mutex_lock lock(mu_);
+  // Sort the entries so that saved databases are deterministic.
+  std::vector<const Key*> keys;
+  keys.reserve(results_.size());
+  for (const auto& key_and_result : results_) {
+    keys.push_back(&key_and_result.first);
+  }
+  std::sort(keys.begin(), keys.end(),
+            [](const Key* a, const Key* b) { return *a < *b; });
+  for (const Key* key : keys) {
+    AutotuneDatabaseEntry* entry = proto.add_entries();
+    std::tie(*entry->mutable_device_model(), *entry->mutable_driver_version(),
+             *entry->mutable_library_versions(),
+             *entry->mutable_autotune_options(), *entry->mutable_op_key()) =
+        *key;
+    *entry->mutable_result() = results_.at(*key);
+  }
+  return proto;
+}
+
+int64 AutotuneDatabase::size() const {
+  tensorflow::mutex_lock lock(mu_);
+  return results_.size();
+}
+
+}  // namespace gpu
+}  // namespace xla
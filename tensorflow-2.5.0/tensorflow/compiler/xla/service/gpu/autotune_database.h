@@ -0,0 +1,107 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_AUTOTUNE_DATABASE_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_AUTOTUNE_DATABASE_H_
+
+#include <string>
+#include <tuple>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_autotuning.pb.h"
+#include "tensorflow/compiler/xla/status.h"
+#include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/compiler/xla/xla.pb.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/stream_executor_no_cuda.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/autotuning.pb.h"
+
+namespace xla {
+namespace gpu {
+
+// A process-wide database of autotuning results that can be persisted in the
+// AutotuneDatabaseProto format (see gpu_autotuning.proto).
+//
+// Results are keyed by the model and driver version of the device they were
+// measured on, the versions of the DNN and BLAS libraries, the debug options
+// that change which result is picked (deterministic ops and the autotune
+// level), and by an op key describing the autotuned operation.  The
+// autotuners consult the database before measuring anything, so results
+// loaded from a file written by an earlier process (or by the offline
+// populate_gpu_autotune_database tool) skip autotuning altogether.
+//
+// This class is thread-safe.
+class AutotuneDatabase {
+ public:
+  AutotuneDatabase() = default;
+
+  // Returns the database shared by all autotuners in the process.
+  static AutotuneDatabase* Global();
+
+  // Makes `path` the file of this database: loads its entries, if the file
+  // exists, and appends every result inserted from now on to it.  Does
+  // nothing if `path` is already the database's file.
+  Status AttachFile(const std::string& path);
+
+  // Merges the entries of the AutotuneDatabaseProto stored in `path`.
+  Status Load(const std::string& path);
+
+  // Writes all entries to `path`, replacing its contents.
+  Status Save(const std::string& path) const;
+
+  // Returns the result recorded for `op_key` on devices like `stream_exec`,
+  // when autotuning with `debug_options`.
+  absl::optional<tensorflow::AutotuneResult> Lookup(
+      se::StreamExecutor* stream_exec, const DebugOptions& debug_options,
+      absl::string_view op_key) const;
+
+  // Records `result` for `op_key` on devices like `stream_exec`, autotuned
+  // with `debug_options`, and appends it to the attached file, if any.
+  // Failing to append is logged but otherwise ignored, because the result is
+  // still usable within this process.
+  void Insert(se::StreamExecutor* stream_exec,
+              const DebugOptions& debug_options, absl::string_view op_key,
+              const tensorflow::AutotuneResult& result);
+
+  // Returns all entries of the database.
+  AutotuneDatabaseProto ToProto() const;
+
+  int64 size() const;
+
+ private:
+  // (device model, driver version, library versions, autotune options, op key).
+  using Key = std::tuple<std::string, std::string, std::string, std::string,
+                         std::string>;
+
+  static Key MakeKey(se::StreamExecutor* stream_exec,
+                     const DebugOptions& debug_options,
+                     absl::string_view op_key);
+
+  void InsertEntry(const AutotuneDatabaseEntry& entry)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  mutable tensorflow::mutex mu_;
+  absl::flat_hash_map<Key, tensorflow::AutotuneResult> results_
+      TF_GUARDED_BY(mu_);
+  std::string attached_path_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_AUTOTUNE_DATABASE_H_
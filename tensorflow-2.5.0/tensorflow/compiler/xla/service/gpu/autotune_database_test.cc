@@ -0,0 +1,131 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/autotune_database.h"
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/stream_executor/multi_platform_manager.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+class AutotuneDatabaseTest : public testing::Test {
+ protected:
+  AutotuneDatabaseTest() {
+    se::Platform* platform =
+        se::MultiPlatformManager::PlatformWithName("Host").ValueOrDie();
+    stream_exec_ = platform->ExecutorForDevice(0).ValueOrDie();
+  }
+
+  static tensorflow::AutotuneResult ConvResult(int64 algorithm) {
+    tensorflow::AutotuneResult result;
+    result.mutable_conv()->set_algorithm(algorithm);
+    result.mutable_conv()->set_tensor_ops_enabled(true);
+    return result;
+  }
+
+  std::string TempPath(absl::string_view name) {
+    return tensorflow::io::JoinPath(tensorflow::testing::TmpDir(), name);
+  }
+
+  se::StreamExecutor* stream_exec_;
+  DebugOptions options_;
+};
+
+TEST_F(AutotuneDatabaseTest, LookupInsertedResult) {
+  AutotuneDatabase database;
+  EXPECT_FALSE(database.Lookup(stream_exec_, options_, "conv:a").has_value());
+  database.Insert(stream_exec_, options_, "conv:a", ConvResult(3));
+  absl::optional<tensorflow::AutotuneResult> result =
+      database.Lookup(stream_exec_, options_, "conv:a");
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(result->conv().algorithm(), 3);
+  EXPECT_FALSE(database.Lookup(stream_exec_, options_, "conv:b").has_value());
+}
+
+TEST_F(AutotuneDatabaseTest, ResultsAreKeyedByAutotuneOptions) {
+  AutotuneDatabase database;
+  database.Insert(stream_exec_, options_, "conv:a", ConvResult(3));
+
+  DebugOptions deterministic = options_;
+  deterministic.set_xla_gpu_deterministic_ops(true);
+  EXPECT_FALSE(
+      database.Lookup(stream_exec_, deterministic, "conv:a").has_value());
+  DebugOptions other_level = options_;
+  other_level.set_xla_gpu_autotune_level(options_.xla_gpu_autotune_level() + 1);
+  EXPECT_FALSE(
+      database.Lookup(stream_exec_, other_level, "conv:a").has_value());
+
+  database.Insert(stream_exec_, deterministic, "conv:a", ConvResult(5));
+  EXPECT_EQ(database.size(), 2);
+  absl::optional<tensorflow::AutotuneResult> result =
+      database.Lookup(stream_exec_, options_, "conv:a");
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(result->conv().algorithm(), 3);
+  result = database.Lookup(stream_exec_, deterministic, "conv:a");
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(result->conv().algorithm(), 5);
+
+  // The versions of the libraries are recorded with the entries.
+  const AutotuneDatabaseProto proto = database.ToProto();
+  ASSERT_EQ(proto.entries_size(), 2);
+  EXPECT_NE(proto.entries(0).library_versions().find("cudnn="),
+            std::string::npos);
+  EXPECT_NE(proto.entries(0).autotune_options(),
+            proto.entries(1).autotune_options());
+}
+
+TEST_F(AutotuneDatabaseTest, SaveAndLoad) {
+  const std::string path = TempPath("autotune_save_and_load.pb");
+  AutotuneDatabase database;
+  database.Insert(stream_exec_, options_, "conv:a", ConvResult(1));
+  database.Insert(stream_exec_, options_, "conv:b", ConvResult(2));
+  TF_ASSERT_OK(database.Save(path));
+
+  AutotuneDatabase loaded;
+  TF_ASSERT_OK(loaded.Load(path));
+  EXPECT_EQ(loaded.size(), 2);
+  ASSERT_TRUE(loaded.Lookup(stream_exec_, options_, "conv:b").has_value());
+  EXPECT_EQ(
+      loaded.Lookup(stream_exec_, options_, "conv:b")->conv().algorithm(), 2);
+}
+
+TEST_F(AutotuneDatabaseTest, AttachedFileIsAppendedTo) {
+  const std::string path = TempPath("autotune_attached.pb");
+  tensorflow::Env::Default()->DeleteFile(path).IgnoreError();
+  {
+    AutotuneDatabase database;
+    TF_ASSERT_OK(database.AttachFile(path));
+    database.Insert(stream_exec_, options_, "conv:a", ConvResult(1));
+    database.Insert(stream_exec_, options_, "conv:b", ConvResult(2));
+    // A later result for the same key replaces the earlier one.
+    database.Insert(stream_exec_, options_, "conv:a", ConvResult(4));
+  }
+
+  AutotuneDatabase reloaded;
+  TF_ASSERT_OK(reloaded.AttachFile(path));
+  EXPECT_EQ(reloaded.size(), 2);
+  ASSERT_TRUE(reloaded.Lookup(stream_exec_, options_, "conv:a").has_value());
+  EXPECT_EQ(
+      reloaded.Lookup(stream_exec_, options_, "conv:a")->conv().algorithm(), 4);
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
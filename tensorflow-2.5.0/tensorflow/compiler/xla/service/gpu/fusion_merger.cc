@@ -20,7 +20,9 @@ limitations under the License.
 
 #include "absl/algorithm/container.h"
 #include "absl/strings/str_join.h"
+#include "absl/time/time.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_fusible.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_performance_model.h"
 #include "tensorflow/compiler/xla/service/gpu/instruction_fusion.h"
 #include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
 #include "tensorflow/compiler/xla/service/hlo_graph_dumper.h"
@@ -130,8 +132,11 @@ double GetMergedBytesTransferred(HloInstruction* fusion) {
 // Accumulates and reports stats on successful/failed merge attempts.
 class FusionInstructionMerger {
  public:
-  explicit FusionInstructionMerger(HloComputation* computation)
-      : computation_(computation) {}
+  // `performance_model` may be null, in which case merge decisions are made
+  // from heuristics only.
+  FusionInstructionMerger(HloComputation* computation,
+                          const GpuPerformanceModel* performance_model)
+      : computation_(computation), performance_model_(performance_model) {}
 
   Status Run();
 
@@ -141,6 +146,7 @@ class FusionInstructionMerger {
   Status HandleFusion(HloInstruction* fusion);
 
   HloComputation* computation_;
+  const GpuPerformanceModel* performance_model_;
   bool changed_ = false;
 
   // Fusion instruction merge stats.
@@ -153,6 +159,7 @@ class FusionInstructionMerger {
   int num_fail_net_bytes_transferred_ratio_ = 0;
   int num_fail_inefficient_fusion_emitter_ = 0;
   int num_fail_fusion_too_large_ = 0;
+  int num_fail_slower_if_merged_ = 0;
 
   TF_DISALLOW_COPY_AND_ASSIGN(FusionInstructionMerger);
 };
@@ -175,7 +182,8 @@ Status FusionInstructionMerger::Run() {
           << " net_bytes_transferred: " << num_fail_net_bytes_transferred_ratio_
           << " inefficient_fusion_emitter: "
           << num_fail_inefficient_fusion_emitter_
-          << " fusion_too_large: " << num_fail_fusion_too_large_ << " }";
+          << " fusion_too_large: " << num_fail_fusion_too_large_
+          << " slower_if_merged: " << num_fail_slower_if_merged_ << " }";
   return Status::OK();
 }
 
@@ -290,6 +298,31 @@ Status FusionInstructionMerger::HandleFusion(HloInstruction* fusion) {
     return Status::OK();
   }
 
+  // Skip 'fusion' instruction if the performance model estimates that merging
+  // it into its users would be slower, e.g. because the users would recompute
+  // it more than the saved memory traffic and kernel launches make up for.
+  if (performance_model_ != nullptr) {
+    StatusOr<GpuPerformanceModel::RunTimes> run_times =
+        performance_model_->EstimateRunTimes(fusion, fusion->users());
+    if (!run_times.ok()) {
+      VLOG(3) << "No run time estimate for merging " << fusion->name() << ": "
+              << run_times.status();
+    } else {
+      VLOG(2) << "Estimated run times for merging " << fusion->name()
+              << ": unmerged "
+              << absl::FormatDuration(run_times.ValueOrDie().time_unfused)
+              << ", merged "
+              << absl::FormatDuration(run_times.ValueOrDie().time_fused);
+      if (run_times.ValueOrDie().time_fused >
+          run_times.ValueOrDie().time_unfused) {
+        VLOG(3) << "Not merging " << fusion->name()
+                << ": Merging is estimated to be slower.";
+        ++num_fail_slower_if_merged_;
+        return Status::OK();
+      }
+    }
+  }
+
   // Merge fused instructions from 'fusion' into each user.
   std::vector<HloInstruction*> users = fusion->users();
   for (HloInstruction* user : users) {
@@ -329,12 +362,18 @@ Status FusionInstructionMerger::HandleFusion(HloInstruction* fusion) {
 StatusOr<bool> FusionMerger::Run(HloModule* module) {
   bool changed = false;
   VLOG(2) << "FusionMerger for module: " << module->name();
+  absl::optional<GpuPerformanceModel> performance_model;
+  if (gpu_device_info_.has_value()) {
+    performance_model.emplace(*gpu_device_info_);
+  }
   for (auto* computation : module->MakeNonfusionComputations()) {
     VLOG(1) << "Before running FusionInstructionMerger for computation: "
             << computation->name();
     XLA_VLOG_LINES(3, computation->ToString());
 
-    FusionInstructionMerger fusion_merger(computation);
+    FusionInstructionMerger fusion_merger(
+        computation,
+        performance_model.has_value() ? &*performance_model : nullptr);
     TF_RETURN_IF_ERROR(fusion_merger.Run());
     changed |= fusion_merger.changed();
 
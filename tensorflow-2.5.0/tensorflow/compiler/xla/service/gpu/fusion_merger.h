@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_FUSION_MERGER_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_FUSION_MERGER_H_
 
+#include "absl/types/optional.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_device_info.h"
 #include "tensorflow/compiler/xla/service/hlo_module.h"
 #include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
 
@@ -56,12 +58,23 @@ namespace gpu {
 //
 // None of these restrictions are necessary for correctness. In fact, lifting
 // the latter two could be beneficial.
+//
+// If constructed with the target's GpuDeviceInfo, the pass also consults a
+// GpuPerformanceModel and does not merge a fusion instruction into its users if
+// the merged kernels are estimated to run slower than the unmerged ones.
 
 class FusionMerger : public HloModulePass {
  public:
+  FusionMerger() = default;
+  explicit FusionMerger(const GpuDeviceInfo& gpu_device_info)
+      : gpu_device_info_(gpu_device_info) {}
+
   absl::string_view name() const override { return "fusion_merger"; }
 
   StatusOr<bool> Run(HloModule* module) override;
+
+ private:
+  absl::optional<GpuDeviceInfo> gpu_device_info_;
 };
 
 }  // namespace gpu
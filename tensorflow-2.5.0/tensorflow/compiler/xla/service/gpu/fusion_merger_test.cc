@@ -15,8 +15,11 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/gpu/fusion_merger.h"
 
+#include <memory>
+#include <string>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "absl/types/span.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_fusible.h"
 #include "tensorflow/compiler/xla/service/gpu/instruction_fusion.h"
@@ -31,7 +34,17 @@ namespace {
 
 namespace op = xla::testing::opcode_matchers;
 
-class FusionMergerTest : public HloTestBase {};
+class FusionMergerTest : public HloTestBase {
+ protected:
+  // Device info which makes FusionMerger consult the performance model.
+  static GpuDeviceInfo TestDeviceInfo() {
+    GpuDeviceInfo gpu_device_info{};
+    gpu_device_info.core_count = 80;
+    gpu_device_info.memory_bandwidth = 900e9;
+    gpu_device_info.clock_rate_ghz = 1.5;
+    return gpu_device_info;
+  }
+};
 
 // Tests that we can merge a fusion instruction that is below threshold.
 //
@@ -651,6 +664,77 @@ ENTRY main {
   EXPECT_FALSE(FusionMerger().Run(module.get()).ValueOrDie());
 }
 
+TEST_F(FusionMergerTest, WillNotMergeIfEstimatedSlower) {
+  // The producer does 1000 multiplies per element, none of which is considered
+  // expensive, and the consumer broadcasts each element of it 1024 times.
+  std::string producer_body = "  p0 = f32[1024] parameter(0)\n";
+  std::string previous = "p0";
+  for (int i = 0; i < 1000; ++i) {
+    std::string name = absl::StrCat("multiply.", i);
+    absl::StrAppend(&producer_body, "  ", i == 999 ? "ROOT " : "", name,
+                    " = f32[1024] multiply(", previous, ", p0)\n");
+    previous = name;
+  }
+  auto module = ParseAndReturnVerifiedModule(absl::StrCat(R"(
+HloModule m
+
+f_a {
+)",
+                                                          producer_body, R"(}
+
+f_b {
+  p0 = f32[1024] parameter(0)
+  ROOT broadcast = f32[1024,1024] broadcast(p0), dimensions={1}
+}
+
+ENTRY entry {
+  p0 = f32[1024] parameter(0)
+  f1 = f32[1024] fusion(p0), kind=kLoop, calls=f_a
+  ROOT f2 = f32[1024,1024] fusion(f1), kind=kLoop, calls=f_b
+})"))
+                    .ValueOrDie();
+  // Without device info the merge goes ahead; the performance model estimates
+  // that recomputing the producer for each broadcast element is slower.
+  std::unique_ptr<HloModule> clone = module->Clone();
+  EXPECT_TRUE(FusionMerger().Run(clone.get()).ValueOrDie());
+  EXPECT_FALSE(FusionMerger(TestDeviceInfo()).Run(module.get()).ValueOrDie());
+}
+
+TEST_F(FusionMergerTest, WillMergeWithDeviceInfo) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+    HloModule m
+
+    %f_a (p: f32[1024,1024]) -> f32[1024,1024] {
+      %p = f32[1024,1024] parameter(0)
+      ROOT %n = f32[1024,1024] negate(%p)
+    }
+
+    %f_b (p: f32[1024,1024]) -> f32[1024,1024] {
+      %p = f32[1024,1024] parameter(0)
+      ROOT %a = f32[1024,1024] add(%p, %p)
+    }
+
+    %f_c (p: f32[1024,1024]) -> f32[1024,1024] {
+      %p = f32[1024,1024] parameter(0)
+      ROOT %m = f32[1024,1024] multiply(%p, %p)
+    }
+
+    ENTRY entry {
+      p0 = f32[1024,1024] parameter(0)
+      f1 = f32[1024,1024] fusion(p0), kind=kLoop, calls=%f_a
+      f2 = f32[1024,1024] fusion(f1), kind=kLoop, calls=%f_b
+      f3 = f32[1024,1024] fusion(f1), kind=kLoop, calls=%f_c
+      ROOT t = (f32[1024,1024], f32[1024,1024]) tuple(f2, f3)
+    })")
+                    .ValueOrDie();
+  EXPECT_TRUE(FusionMerger(TestDeviceInfo()).Run(module.get()).ValueOrDie());
+
+  // The cheap producer is merged into both of its consumers.
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root, op::Tuple(op::Fusion(op::Parameter()),
+                              op::Fusion(op::Parameter())));
+}
+
 }  // namespace
 }  // namespace gpu
 }  // namespace xla
@@ -17,6 +17,9 @@ limitations under the License.
 
 #include <limits>
 
+#include "absl/strings/str_cat.h"
+
+#include "tensorflow/compiler/xla/service/gpu/autotune_database.h"
 #include "tensorflow/compiler/xla/service/gpu/backend_configs.pb.h"
 #include "tensorflow/compiler/xla/service/gpu/buffer_comparator.h"
 #include "tensorflow/compiler/xla/service/gpu/gemm_thunk.h"
@@ -259,8 +262,27 @@ static StatusOr<absl::optional<se::blas::AlgorithmType>> DoGemmAutotune(
   cache_misses++;
   VLOG(4) << "Autotuning cache miss";
 
-  int64 batch_size = gemm_config.batch_size();
+  // A persisted result without a GEMM algorithm means the generic algorithm.
+  AutotuneDatabase* database = AutotuneDatabase::Global();
+  const DebugOptions& debug_options =
+      instr->GetModule()->config().debug_options();
+  const std::string database_key = absl::StrCat(
+      "gemm:", lhs->shape().ToString(/*print_layout=*/true), ",",
+      rhs->shape().ToString(/*print_layout=*/true), "->",
+      instr->shape().ToString(/*print_layout=*/true), ",",
+      gemm_config.ShortDebugString());
   absl::optional<se::blas::AlgorithmType> result;
+  if (absl::optional<AutotuneResult> persisted =
+          database->Lookup(stream->parent(), debug_options, database_key)) {
+    VLOG(4) << "Using persisted autotuning result";
+    if (persisted->has_gemm()) {
+      result = persisted->gemm().algorithm();
+    }
+    CHECK(autotune_cache.emplace(key, result).second);
+    return result;
+  }
+
+  int64 batch_size = gemm_config.batch_size();
   if (batch_size != 1) {
     // TODO(b/112111608): Implement auto tune for batched gemm.
     VLOG(2) << "Batch size is non-singular, using generic algorithm";
@@ -271,6 +293,11 @@ static StatusOr<absl::optional<se::blas::AlgorithmType>> DoGemmAutotune(
   }
 
   CHECK(autotune_cache.emplace(key, result).second);
+  AutotuneResult persisted;
+  if (result) {
+    persisted.mutable_gemm()->set_algorithm(*result);
+  }
+  database->Insert(stream->parent(), debug_options, database_key, persisted);
   return result;
 }
 
@@ -320,6 +347,16 @@ StatusOr<bool> GemmAlgorithmPicker::Run(HloModule* module) {
     return false;
   }
 
+  const std::string& database_path =
+      module->config().debug_options().xla_gpu_autotune_database_path();
+  if (!database_path.empty()) {
+    Status status = AutotuneDatabase::Global()->AttachFile(database_path);
+    if (!status.ok()) {
+      LOG(WARNING) << "Not using autotuning results from " << database_path
+                   << ": " << status;
+    }
+  }
+
   bool changed = false;
   for (HloComputation* computation : module->MakeNonfusionComputations()) {
     TF_ASSIGN_OR_RETURN(
@@ -24,6 +24,7 @@ limitations under the License.
 #include "absl/memory/memory.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
+#include "absl/types/variant.h"
 #include "llvm/AsmParser/Parser.h"
 #include "llvm/Bitcode/BitcodeReader.h"
 #include "llvm/Bitcode/BitcodeWriter.h"
@@ -129,8 +130,10 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/regexp.h"
 #include "tensorflow/core/platform/stream_executor_no_cuda.h"
@@ -142,10 +145,17 @@ limitations under the License.
 
 namespace xla {
 namespace gpu {
+namespace {
+
+// The most PTX and binaries cached for the partitions of compiled modules.
+constexpr int64 kPartitionCacheCapacityBytes = 256LL << 20;
+
+}  // namespace
 
 GpuCompiler::GpuCompiler(se::Platform::Id platform_id,
                          const char* target_triple, const char* data_layout)
     : platform_id_(platform_id),
+      partition_cache_(kPartitionCacheCapacityBytes),
       target_triple_(target_triple),
       data_layout_(data_layout),
       pointer_size_(llvm::DataLayout(data_layout)
@@ -339,7 +349,7 @@ Status GpuCompiler::OptimizeHloModule(
         LayoutAssignment::InstructionCanChangeLayout);
     fusion.AddPass<GpuInstructionFusion>(/*may_duplicate=*/false);
     fusion.AddPass<GpuInstructionFusion>(/*may_duplicate=*/true);
-    fusion.AddPass<FusionMerger>();
+    fusion.AddPass<FusionMerger>(GetGpuDeviceInfo(stream_exec));
     fusion.AddPass<GpuMultiOutputFusion>();
     fusion.AddPass<HloCSE>(/*is_layout_sensitive=*/true,
                            /*only_fusion_computations=*/true);
@@ -803,36 +813,82 @@ GpuCompiler::CompileToTargetBinary(const HloModuleConfig& module_config,
       },
       /*PreserveLocals=*/true);
 
+  // Partitions are looked up in partition_cache_ unless something may need to
+  // observe their compilation (dumps, hooks) or replaces the compiled IR/PTX.
+  const DebugOptions& debug_options = module_config.debug_options();
+  const bool use_partition_cache =
+      !DumpingEnabledForHloModule(debug_module ? debug_module->name() : "",
+                                  debug_options) &&
+      !user_pre_optimization_hook_ && !user_post_optimization_hook_ &&
+      debug_options.xla_gpu_ptx_file().empty() &&
+      debug_options.xla_gpu_llvm_ir_file().empty();
+  std::string partition_cache_key_suffix;
+  if (use_partition_cache) {
+    GpuVersion gpu_version = GetGpuVersion(stream_exec);
+    if (auto* cc = absl::get_if<std::pair<int, int>>(&gpu_version)) {
+      absl::StrAppend(&partition_cache_key_suffix, "cc", cc->first, ".",
+                      cc->second);
+    } else {
+      absl::StrAppend(
+          &partition_cache_key_suffix, "amdgpu",
+          absl::get<std::pair<int, std::string>>(gpu_version).second);
+    }
+    std::string serialized_debug_options;
+    TF_RET_CHECK(tensorflow::SerializeToStringDeterministic(
+        debug_options, &serialized_debug_options));
+    absl::StrAppend(&partition_cache_key_suffix, serialized_debug_options);
+  }
+
   std::vector<StatusOr<BackendCompileResult>> compile_results(
       llvm_modules.size());
+  std::atomic<int> num_cached_partitions(0);
   tensorflow::BlockingCounter counter(llvm_modules.size());
   for (int i = 0; i < llvm_modules.size(); i++) {
-    thread_pool->Schedule(
-        [&compile_results, compile_single_module, i, &llvm_modules, &counter] {
-          llvm::Module* original_module = llvm_modules[i].get();
-          llvm::LLVMContext context;
-          std::string buffer;
-          llvm::raw_string_ostream error(buffer);
-
-          std::unique_ptr<llvm::Module> new_llvm_module;
-          // Switch to a new context by dumping and re-parsing LLVM IR. Each
-          // thread has its own context to avoid race conditions.
-          {
-            std::string ir;
-            {
-              llvm::raw_string_ostream os(ir);
-              original_module->print(os, nullptr);
-            }
-            llvm::SMDiagnostic err;
-            new_llvm_module = llvm::parseAssemblyString(ir, err, context);
+    thread_pool->Schedule([this, &compile_results, compile_single_module, i,
+                           &llvm_modules, &counter, use_partition_cache,
+                           &partition_cache_key_suffix,
+                           &num_cached_partitions] {
+      llvm::Module* original_module = llvm_modules[i].get();
+      llvm::LLVMContext context;
+      std::string buffer;
+      llvm::raw_string_ostream error(buffer);
+
+      std::unique_ptr<llvm::Module> new_llvm_module;
+      tensorflow::Fprint128 cache_key;
+      // Switch to a new context by dumping and re-parsing LLVM IR. Each
+      // thread has its own context to avoid race conditions.
+      {
+        std::string ir;
+        {
+          llvm::raw_string_ostream os(ir);
+          original_module->print(os, nullptr);
+        }
+        if (use_partition_cache) {
+          cache_key = tensorflow::Fingerprint128(
+              absl::StrCat(ir, partition_cache_key_suffix));
+          auto cached = partition_cache_.Lookup(cache_key);
+          if (cached.has_value()) {
+            compile_results[i] = *std::move(cached);
+            num_cached_partitions++;
+            counter.DecrementCount();
+            return;
           }
+        }
+        llvm::SMDiagnostic err;
+        new_llvm_module = llvm::parseAssemblyString(ir, err, context);
+      }
 
-          compile_results[i] = compile_single_module(
-              new_llvm_module.get(), /*relocatable=*/true, /*shard_number=*/i);
-          counter.DecrementCount();
-        });
+      compile_results[i] = compile_single_module(
+          new_llvm_module.get(), /*relocatable=*/true, /*shard_number=*/i);
+      if (use_partition_cache && compile_results[i].ok()) {
+        partition_cache_.Insert(cache_key, compile_results[i].ValueOrDie());
+      }
+      counter.DecrementCount();
+    });
   }
   counter.Wait();
+  VLOG(1) << "Reused " << num_cached_partitions << " of "
+          << llvm_modules.size() << " compiled module partitions";
 
   std::string ptx_snippets;
   std::vector<std::vector<uint8>> submodule_compile_results;
@@ -975,6 +1031,10 @@ GpuDeviceInfo GetGpuDeviceInfo(se::StreamExecutor* stream_exec) {
       stream_exec->GetDeviceDescription().block_dim_limit().y;
   gpu_device_info.block_dim_limit_z =
       stream_exec->GetDeviceDescription().block_dim_limit().z;
+  gpu_device_info.memory_bandwidth =
+      stream_exec->GetDeviceDescription().memory_bandwidth();
+  gpu_device_info.clock_rate_ghz =
+      stream_exec->GetDeviceDescription().clock_rate_ghz();
   return gpu_device_info;
 }
 
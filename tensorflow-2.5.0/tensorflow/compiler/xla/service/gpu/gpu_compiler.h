@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/gpu_device_info.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_executable.h"
 #include "tensorflow/compiler/xla/service/gpu/ir_emitter_context.h"
+#include "tensorflow/compiler/xla/service/gpu/partition_cache.h"
 #include "tensorflow/compiler/xla/service/hlo_dataflow_analysis.h"
 #include "tensorflow/compiler/xla/service/hlo_module.h"
 #include "tensorflow/compiler/xla/service/llvm_compiler.h"
@@ -134,6 +135,13 @@ class GpuCompiler : public LLVMCompiler {
 
   se::Platform::Id platform_id_;
 
+  // Cache of the partitions of modules compiled in parallel by
+  // CompileToTargetBinary. Keyed by the fingerprint of the partition's
+  // unoptimized LLVM IR, the GPU version and the debug options, so that
+  // recompiling a slightly changed module only lowers the partitions whose IR
+  // changed.
+  PartitionCache partition_cache_;
+
   // The triple that represents our target.
   const char* target_triple_;
 
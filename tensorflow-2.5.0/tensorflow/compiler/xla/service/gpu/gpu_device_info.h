@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_GPU_DEVICE_INFO_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_GPU_DEVICE_INFO_H_
 
+#include "tensorflow/compiler/xla/types.h"
+
 namespace xla {
 namespace gpu {
 
@@ -37,6 +39,9 @@ struct GpuDeviceInfo {
   int block_dim_limit_x;
   int block_dim_limit_y;
   int block_dim_limit_z;
+  // Peak device memory bandwidth, in bytes per second.
+  int64 memory_bandwidth;
+  float clock_rate_ghz;
 };
 }  // namespace gpu
 }  // namespace xla
@@ -19,14 +19,17 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
 #include "tensorflow/compiler/xla/map_util.h"
 #include "tensorflow/compiler/xla/service/gpu/buffer_allocations.h"
+#include "tensorflow/compiler/xla/service/gpu/copy_thunk.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_constants.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_executable_run_options.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_types.h"
 #include "tensorflow/compiler/xla/service/gpu/hlo_execution_profiler.h"
+#include "tensorflow/compiler/xla/service/gpu/sequential_thunk.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/buffer_assignment_util.h"
 #include "tensorflow/compiler/xla/service/logical_buffer.h"
@@ -44,12 +47,51 @@ limitations under the License.
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/stream_executor/platform.h"
 
+#if GOOGLE_CUDA
+#include "tensorflow/stream_executor/gpu/gpu_driver.h"
+#include "tensorflow/stream_executor/gpu/gpu_executor.h"
+#include "tensorflow/stream_executor/gpu/gpu_stream.h"
+#endif
+
 namespace xla {
 namespace gpu {
 namespace {
 
 using ::tensorflow::profiler::ScopedAnnotation;
 
+// Returns whether `thunk` only enqueues device work that can be captured into
+// a CUDA graph, without needing the host while it executes.
+bool CanCaptureThunk(const Thunk* thunk) {
+  switch (thunk->kind()) {
+    case Thunk::kKernel:
+    case Thunk::kGemm:
+    case Thunk::kMemset32BitValue:
+    case Thunk::kMemzero:
+      return true;
+    case Thunk::kCopy:
+      // Host to device copies read from pageable host memory.
+      return dynamic_cast<const DeviceToDeviceCopyThunk*>(thunk) != nullptr;
+    case Thunk::kSequential:
+      return absl::c_all_of(
+          static_cast<const SequentialThunk*>(thunk)->thunks(),
+          [](const std::unique_ptr<Thunk>& sub_thunk) {
+            return CanCaptureThunk(sub_thunk.get());
+          });
+    default:
+      return false;
+  }
+}
+
+bool UseCudaGraphs(const HloModule* module, const ThunkSchedule& schedule) {
+#if GOOGLE_CUDA && CUDA_VERSION >= 10020
+  return module != nullptr &&
+         module->config().debug_options().xla_gpu_enable_cuda_graphs() &&
+         absl::c_all_of(schedule.TotalOrder(), CanCaptureThunk);
+#else
+  return false;
+#endif
+}
+
 }  // namespace
 
 // Implementation note: HLO profiling is always enabled for GPU executables,
@@ -68,7 +110,9 @@ GpuExecutable::GpuExecutable(GpuExecutable::Params params)
       debug_buffer_assignment_(std::move(params.debug_buffer_assignment)),
       entry_computation_profile_index_(params.entry_computation_profile_index),
       constants_(std::move(params.constants)),
-      output_info_(std::move(params.output_info)) {
+      output_info_(std::move(params.output_info)),
+      use_cuda_graphs_(UseCudaGraphs(has_module() ? &module() : nullptr,
+                                     *thunk_schedule_)) {
   XlaDebugInfoManager::Get()->RegisterModule(module_name_, shared_module(),
                                              debug_buffer_assignment_);
 }
@@ -125,6 +169,16 @@ Status GpuExecutable::CheckCompatibilityWithServiceExecutableRunOptions(
   return Status::OK();
 }
 
+GpuExecutable::CudaGraphState::~CudaGraphState() {
+#if GOOGLE_CUDA && CUDA_VERSION >= 10020
+  if (graph_exec != nullptr) {
+    se::gpu::GpuDriver::DestroyGraphExec(
+        se::gpu::ExtractGpuExecutor(executor)->gpu_context(),
+        static_cast<se::gpu::GpuGraphExecHandle>(graph_exec));
+  }
+#endif
+}
+
 Status GpuExecutable::ExecuteThunks(
     const ServiceExecutableRunOptions* run_options,
     const BufferAllocations& buffer_allocations, bool block_host_until_done,
@@ -135,13 +189,51 @@ Status GpuExecutable::ExecuteThunks(
   auto cleanup = MakeCleanup(
       [&]() { XlaDebugInfoManager::Get()->OnModuleStop(module_name_); });
 
-  se::Stream* main_stream = run_options->stream();
-  se::StreamExecutor* executor = main_stream->parent();
-
   bool do_profile = hlo_execution_profile != nullptr;
   if (do_profile) {
     LOG(WARNING) << "PROFILING: profiling is enabled";
   }
+  uint64 start_micros = tensorflow::Env::Default()->NowMicros();
+
+  tensorflow::profiler::TraceMe hlo_module_activity(
+      [&] { return absl::StrCat(module_name_, ":XLA GPU module"); },
+      tensorflow::profiler::TraceMeLevel::kInfo);
+
+  bool executed = false;
+  if (use_cuda_graphs_ && !do_profile) {
+    TF_ASSIGN_OR_RETURN(executed,
+                        ExecuteCudaGraph(run_options, buffer_allocations,
+                                         block_host_until_done));
+  }
+  if (!executed) {
+    TF_RETURN_IF_ERROR(ExecuteThunkSchedule(run_options, buffer_allocations,
+                                            block_host_until_done,
+                                            hlo_execution_profile));
+  }
+  uint64 end_micros = tensorflow::Env::Default()->NowMicros();
+
+  if (run_options->run_options().execution_profile()) {
+    ExecutionProfile* profile = run_options->run_options().execution_profile();
+    const double nanoseconds = (end_micros - start_micros) * 1000.0;
+    profile->set_compute_time_ns(std::max(nanoseconds, 1.0));
+
+    // If hlo profiling was disabled then the cycle count is left empty.
+    if (do_profile) {
+      profile->set_compute_cycle_count(hlo_execution_profile->GetCyclesTakenBy(
+          entry_computation_profile_index_));
+    }
+  }
+
+  return Status::OK();
+}
+
+Status GpuExecutable::ExecuteThunkSchedule(
+    const ServiceExecutableRunOptions* run_options,
+    const BufferAllocations& buffer_allocations, bool block_host_until_done,
+    HloExecutionProfile* hlo_execution_profile) {
+  se::Stream* main_stream = run_options->stream();
+  se::StreamExecutor* executor = main_stream->parent();
+  bool do_profile = hlo_execution_profile != nullptr;
 
   // Stream 0 indicates `main_stream` and substreams start from stream 1.
   std::vector<StreamPool::Ptr> sub_streams;
@@ -157,11 +249,6 @@ Status GpuExecutable::ExecuteThunks(
 
   HloExecutionProfiler profiler(do_profile, hlo_execution_profile, main_stream,
                                 sub_streams, entry_computation_profile_index_);
-  uint64 start_micros = tensorflow::Env::Default()->NowMicros();
-
-  tensorflow::profiler::TraceMe hlo_module_activity(
-      [&] { return absl::StrCat(module_name_, ":XLA GPU module"); },
-      tensorflow::profiler::TraceMeLevel::kInfo);
 
   std::map<const Thunk*, std::unique_ptr<se::Event>> thunk_to_finish_event;
   std::vector<std::function<void()>> deferred_host_callbacks;
@@ -236,21 +323,81 @@ Status GpuExecutable::ExecuteThunks(
   // enabled; we therefore do not need to defer profile collection onto a
   // stream.
   profiler.FinishExecution();
-  uint64 end_micros = tensorflow::Env::Default()->NowMicros();
+  return Status::OK();
+}
 
-  if (run_options->run_options().execution_profile()) {
-    ExecutionProfile* profile = run_options->run_options().execution_profile();
-    const double nanoseconds = (end_micros - start_micros) * 1000.0;
-    profile->set_compute_time_ns(std::max(nanoseconds, 1.0));
+StatusOr<bool> GpuExecutable::ExecuteCudaGraph(
+    const ServiceExecutableRunOptions* run_options,
+    const BufferAllocations& buffer_allocations, bool block_host_until_done) {
+#if GOOGLE_CUDA && CUDA_VERSION >= 10020
+  using se::gpu::GpuDriver;
+  se::Stream* main_stream = run_options->stream();
+  se::StreamExecutor* executor = main_stream->parent();
+  se::gpu::GpuContext* context =
+      se::gpu::ExtractGpuExecutor(executor)->gpu_context();
+  se::gpu::GpuStreamHandle gpu_stream = se::gpu::AsGpuStreamValue(main_stream);
+
+  tensorflow::mutex_lock lock(cuda_graph_mutex_);
+  std::unique_ptr<CudaGraphState>& state = cuda_graphs_[executor];
+  if (state == nullptr) {
+    state = absl::make_unique<CudaGraphState>();
+    state->executor = executor;
+  }
+  if (state->disabled || state->num_runs++ == 0) {
+    return false;
+  }
 
-    // If hlo profiling was disabled then the cycle count is left empty.
-    if (do_profile) {
-      profile->set_compute_cycle_count(hlo_execution_profile->GetCyclesTakenBy(
-          entry_computation_profile_index_));
+  std::vector<void*> buffer_addresses(allocations_.size());
+  for (BufferAllocation::Index i = 0; i < allocations_.size(); ++i) {
+    buffer_addresses[i] = buffer_allocations.GetDeviceAddress(i).opaque();
+  }
+  auto graph_exec = static_cast<se::gpu::GpuGraphExecHandle>(state->graph_exec);
+  if (graph_exec == nullptr || buffer_addresses != state->buffer_addresses) {
+    // The captured work only runs when the graph is launched.
+    TF_RETURN_IF_ERROR(GpuDriver::StreamBeginCapture(context, gpu_stream));
+    Status status = ExecuteThunkSchedule(run_options, buffer_allocations,
+                                         /*block_host_until_done=*/false,
+                                         /*hlo_execution_profile=*/nullptr);
+    se::gpu::GpuGraphHandle graph = nullptr;
+    status.Update(GpuDriver::StreamEndCapture(context, gpu_stream, &graph));
+    if (!status.ok()) {
+      if (graph != nullptr) GpuDriver::DestroyGraph(context, graph);
+      LOG(WARNING) << "Not using CUDA graphs for " << module_name_
+                   << ", capturing its thunks failed: " << status;
+      state->disabled = true;
+      return false;
     }
+    // Updating the buffer addresses of the graph is cheaper than instantiating
+    // it again, and works as long as the thunks launch the same kernels.
+    if (graph_exec == nullptr ||
+        !GpuDriver::GraphExecUpdate(context, graph_exec, graph).ok()) {
+      if (graph_exec != nullptr) {
+        GpuDriver::DestroyGraphExec(context, graph_exec);
+        state->graph_exec = graph_exec = nullptr;
+      }
+      status = GpuDriver::GraphInstantiate(context, &graph_exec, graph);
+    }
+    GpuDriver::DestroyGraph(context, graph);
+    TF_RETURN_IF_ERROR(status);
+    state->graph_exec = graph_exec;
+    state->buffer_addresses = std::move(buffer_addresses);
+    VLOG(2) << "Captured the thunks of " << module_name_ << " into graph "
+            << graph_exec;
   }
 
-  return Status::OK();
+  TF_RETURN_IF_ERROR(GpuDriver::GraphLaunch(context, graph_exec, gpu_stream));
+  if (block_host_until_done) {
+    Status block_status = main_stream->BlockHostUntilDone();
+    if (!block_status.ok()) {
+      return InternalError(
+          "Failed to complete all kernels launched on stream %p: %s",
+          main_stream, block_status.error_message());
+    }
+  }
+  return true;
+#else
+  return false;
+#endif
 }
 
 StatusOr<const GpuExecutable::BufferAllocToDeviceMemoryMap*>
@@ -142,6 +142,21 @@ class GpuExecutable : public Executable {
                        bool block_host_until_done,
                        HloExecutionProfile* hlo_execution_profile);
 
+  // Enqueues the thunks of thunk_schedule_ onto the stream of `run_options`
+  // and the sub-streams they are assigned to.
+  Status ExecuteThunkSchedule(const ServiceExecutableRunOptions* run_options,
+                              const BufferAllocations& buffer_allocations,
+                              bool block_host_until_done,
+                              HloExecutionProfile* hlo_execution_profile);
+
+  // Runs the thunks by launching the CUDA graph captured from them, first
+  // capturing it or updating it to the addresses of `buffer_allocations` as
+  // needed. Returns false, without running the thunks, if they can't be
+  // captured.
+  StatusOr<bool> ExecuteCudaGraph(
+      const ServiceExecutableRunOptions* run_options,
+      const BufferAllocations& buffer_allocations, bool block_host_until_done);
+
   using BufferAllocToDeviceMemoryMap =
       absl::flat_hash_map<BufferAllocation::Index, se::DeviceMemoryBase>;
 
@@ -216,6 +231,28 @@ class GpuExecutable : public Executable {
   std::vector<ConstantInfo> constants_;
   const absl::flat_hash_map<ShapeIndex, OutputInfo> output_info_;
 
+  // Whether the thunks are run by replaying a CUDA graph captured from them,
+  // which requires that none of them need the host while executing.
+  const bool use_cuda_graphs_;
+
+  // The CUDA graph captured from the thunks for an executor.
+  struct CudaGraphState {
+    ~CudaGraphState();
+
+    se::StreamExecutor* executor = nullptr;
+    // The number of runs on the executor so far. The first run isn't
+    // captured, as it may lazily allocate resources, e.g. BLAS handles.
+    int64 num_runs = 0;
+    // Set when the capture failed, after which the thunks are run as usual.
+    bool disabled = false;
+    // The instantiated graph, if any, and the buffer addresses it uses.
+    void* graph_exec = nullptr;
+    std::vector<void*> buffer_addresses;
+  };
+  tensorflow::mutex cuda_graph_mutex_;
+  std::map<stream_executor::StreamExecutor*, std::unique_ptr<CudaGraphState>>
+      cuda_graphs_ TF_GUARDED_BY(cuda_graph_mutex_);
+
   TF_DISALLOW_COPY_AND_ASSIGN(GpuExecutable);
 };
 
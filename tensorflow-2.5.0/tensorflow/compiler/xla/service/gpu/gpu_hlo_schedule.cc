@@ -13,12 +13,15 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <deque>
+#include <functional>
 #include <memory>
 #include <unordered_map>
 
 #include "tensorflow/compiler/xla/service/gpu/gpu_hlo_schedule.h"
 
+#include "absl/algorithm/container.h"
 #include "absl/memory/memory.h"
 #include "tensorflow/compiler/xla/service/buffer_value.h"
 #include "tensorflow/compiler/xla/service/hlo_memory_scheduler.h"
@@ -184,6 +187,68 @@ void BFSLaunchOrder(const HloComputation* computation,
   }
 }
 
+bool IsAsyncStart(const HloInstruction* hlo) {
+  return hlo->opcode() == HloOpcode::kCopyStart ||
+         hlo->opcode() == HloOpcode::kCollectivePermuteStart;
+}
+
+bool IsAsyncDone(const HloInstruction* hlo) {
+  return hlo->opcode() == HloOpcode::kCopyDone ||
+         hlo->opcode() == HloOpcode::kCollectivePermuteDone;
+}
+
+// Returns whether `hlo` has to run after `dependency`.
+bool DependsOn(const HloInstruction* hlo, const HloInstruction* dependency) {
+  return absl::c_linear_search(hlo->operands(), dependency) ||
+         absl::c_linear_search(hlo->control_predecessors(), dependency);
+}
+
+// Moves the instructions matching `is_deferred` in `sequence` as late as
+// possible, i.e. right before the first instruction which depends on them.
+std::vector<HloInstruction*> Defer(
+    const std::vector<HloInstruction*>& sequence,
+    const std::function<bool(const HloInstruction*)>& is_deferred,
+    const std::function<bool(const HloInstruction*, const HloInstruction*)>&
+        depends_on) {
+  std::vector<HloInstruction*> result;
+  result.reserve(sequence.size());
+  std::vector<HloInstruction*> pending;
+  for (HloInstruction* hlo : sequence) {
+    if (is_deferred(hlo)) {
+      pending.push_back(hlo);
+      continue;
+    }
+    auto needed = std::stable_partition(
+        pending.begin(), pending.end(), [&](const HloInstruction* deferred) {
+          return !depends_on(hlo, deferred);
+        });
+    result.insert(result.end(), needed, pending.end());
+    pending.erase(needed, pending.end());
+    result.push_back(hlo);
+  }
+  result.insert(result.end(), pending.begin(), pending.end());
+  return result;
+}
+
+// Reorders the sequential `launch_order` to hide the latency of asynchronous
+// start/done pairs: each done is moved right before its first dependent, and
+// then each start right after its last dependency. The instructions left in
+// between can overlap with the asynchronous operation.
+std::vector<HloInstruction*> ScheduleForLatencyHiding(
+    const std::vector<HloInstruction*>& launch_order) {
+  std::vector<HloInstruction*> order =
+      Defer(launch_order, IsAsyncDone, DependsOn);
+  // Moving starts early is the mirror image of deferring them in the reversed
+  // order, where an instruction "depends" on the instructions using it.
+  std::reverse(order.begin(), order.end());
+  order = Defer(order, IsAsyncStart,
+                [](const HloInstruction* hlo, const HloInstruction* start) {
+                  return DependsOn(start, hlo);
+                });
+  std::reverse(order.begin(), order.end());
+  return order;
+}
+
 }  // end namespace
 
 GpuHloSchedule::GpuHloSchedule() {}
@@ -209,8 +274,9 @@ StatusOr<std::unique_ptr<GpuHloSchedule>> GpuHloSchedule::Build(
               return ShapeUtil::ByteSizeOf(buffer.shape(), pointer_size);
             },
             ComputationSchedulerToModuleScheduler(DFSMemoryScheduler)));
-    schedule->thunk_launch_order_ =
-        sequences.sequence(entry_computation).instructions();
+    schedule->thunk_launch_order_ = ScheduleForLatencyHiding(
+        sequences.sequence(entry_computation).instructions());
+    sequences.set_sequence(entry_computation, schedule->thunk_launch_order_);
     schedule->hlo_ordering_ =
         absl::make_unique<SequentialHloOrdering>(sequences);
   } else {
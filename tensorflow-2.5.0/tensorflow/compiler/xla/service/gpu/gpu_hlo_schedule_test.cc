@@ -18,6 +18,7 @@ limitations under the License.
 #include <algorithm>
 #include <unordered_set>
 
+#include "absl/algorithm/container.h"
 #include "absl/memory/memory.h"
 #include "tensorflow/compiler/xla/service/gpu/stream_assignment.h"
 #include "tensorflow/compiler/xla/service/hlo_computation.h"
@@ -141,6 +142,46 @@ TEST_F(GpuHloScheduleTest, SequentialAdd) {
   EXPECT_TRUE(order->ExecutesBefore(add2, add3));
 }
 
+// Test that independent work is scheduled between an asynchronous start and
+// its done.
+TEST_F(GpuHloScheduleTest, AsyncCopyOverlapsIndependentWork) {
+  HloComputation::Builder builder("entry_computation");
+  HloInstruction* x = builder.AddInstruction(HloInstruction::CreateParameter(
+      /*parameter_number=*/0, f32_2x2_, /*name=*/"x"));
+  HloInstruction* y = builder.AddInstruction(HloInstruction::CreateParameter(
+      /*parameter_number=*/1, f32_2x2_, /*name=*/"y"));
+  HloInstruction* dot1 =
+      builder.AddInstruction(CreateCanonicalDot(f32_2x2_, y, y));
+  HloInstruction* dot2 =
+      builder.AddInstruction(CreateCanonicalDot(f32_2x2_, dot1, y));
+  HloInstruction* copy_start =
+      builder.AddInstruction(HloInstruction::CreateCopyStart(
+          ShapeUtil::MakeTupleShape(
+              {f32_2x2_, f32_2x2_, ShapeUtil::MakeShape(U32, {})}),
+          x));
+  HloInstruction* copy_done = builder.AddInstruction(
+      HloInstruction::CreateUnary(f32_2x2_, HloOpcode::kCopyDone, copy_start));
+  HloInstruction* add = builder.AddInstruction(
+      HloInstruction::CreateBinary(f32_2x2_, HloOpcode::kAdd, copy_done, dot2));
+
+  auto module = CreateNewVerifiedModule();
+  module->AddEntryComputation(builder.Build(add));
+
+  std::unique_ptr<StreamAssignment> streams = AssignStreams(*module);
+  auto schedule = BuildGpuHloSchedule(module.get(), *streams);
+  // The start is launched right after its operand, and the done right before
+  // its user.
+  const HloVec& launch_order = schedule->ThunkLaunchOrder();
+  auto position = [&](const HloInstruction* hlo) {
+    return absl::c_find(launch_order, hlo) - launch_order.begin();
+  };
+  EXPECT_EQ(position(copy_start), position(x) + 1);
+  EXPECT_EQ(position(copy_done), position(add) - 1);
+
+  auto order = schedule->ConsumeHloOrdering();
+  EXPECT_TRUE(order->ExecutesBefore(dot2, copy_done));
+}
+
 // Test of two streams.
 TEST_F(GpuHloScheduleTest, DISABLED_ConcurrentMatMul) {
   HloComputation::Builder builder("entry_computation");
@@ -0,0 +1,115 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/gpu_performance_model.h"
+
+#include <algorithm>
+
+#include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+
+namespace xla {
+namespace gpu {
+
+namespace {
+
+int64 ShapeSizeBytes(const Shape& shape) {
+  return ShapeUtil::ByteSizeOf(shape, sizeof(void*));
+}
+
+}  // namespace
+
+GpuPerformanceModel::GpuPerformanceModel(const GpuDeviceInfo& gpu_device_info)
+    : GpuPerformanceModel(gpu_device_info, Options()) {}
+
+GpuPerformanceModel::GpuPerformanceModel(const GpuDeviceInfo& gpu_device_info,
+                                         Options options)
+    : gpu_device_info_(gpu_device_info), options_(options) {}
+
+StatusOr<GpuPerformanceModel::KernelCost> GpuPerformanceModel::Cost(
+    HloInstruction* instruction) const {
+  // Only `instruction` itself is visited; HloInstruction::Accept would also
+  // visit all of its transitive operands.
+  HloCostAnalysis analysis(ShapeSizeBytes);
+  TF_RETURN_IF_ERROR(analysis.Preprocess(instruction));
+  TF_RETURN_IF_ERROR(instruction->Visit(&analysis));
+  TF_RETURN_IF_ERROR(analysis.Postprocess(instruction));
+  KernelCost cost;
+  cost.flops = analysis.flop_count(*instruction) +
+               options_.flops_per_transcendental *
+                   analysis.transcendental_count(*instruction);
+  cost.bytes = analysis.bytes_accessed(*instruction);
+  return cost;
+}
+
+absl::Duration GpuPerformanceModel::RunTime(const KernelCost& cost) const {
+  const double flops_per_second = static_cast<double>(
+                                      gpu_device_info_.core_count) *
+                                  options_.flops_per_cycle_per_core *
+                                  gpu_device_info_.clock_rate_ghz * 1e9;
+  const double compute_seconds =
+      flops_per_second > 0 ? cost.flops / flops_per_second : 0;
+  const double memory_seconds =
+      gpu_device_info_.memory_bandwidth > 0
+          ? cost.bytes / gpu_device_info_.memory_bandwidth
+          : 0;
+  return options_.kernel_launch_overhead +
+         absl::Seconds(std::max(compute_seconds, memory_seconds));
+}
+
+StatusOr<absl::Duration> GpuPerformanceModel::EstimateRunTime(
+    HloInstruction* instruction) const {
+  TF_ASSIGN_OR_RETURN(KernelCost cost, Cost(instruction));
+  return RunTime(cost);
+}
+
+StatusOr<GpuPerformanceModel::RunTimes> GpuPerformanceModel::EstimateRunTimes(
+    HloInstruction* producer,
+    absl::Span<HloInstruction* const> consumers) const {
+  TF_ASSIGN_OR_RETURN(KernelCost producer_cost, Cost(producer));
+  // Once fused, the producer's output stays on chip, and each consumer reads
+  // the producer's inputs instead.
+  const double producer_output_bytes = ShapeSizeBytes(producer->shape());
+  const double producer_input_bytes =
+      std::max(0.0, producer_cost.bytes - producer_output_bytes);
+
+  RunTimes run_times;
+  run_times.time_unfused = RunTime(producer_cost);
+  for (HloInstruction* consumer : consumers) {
+    TF_ASSIGN_OR_RETURN(KernelCost consumer_cost, Cost(consumer));
+    run_times.time_unfused += RunTime(consumer_cost);
+
+    // A consumer which reads each producer element several times (e.g. a
+    // broadcast) recomputes the producer for every read once fused.
+    double recomputation = 1.0;
+    if (producer->shape().IsArray() && consumer->shape().IsArray() &&
+        consumer->ReusesOperandElements(consumer->operand_index(producer))) {
+      recomputation = std::max<double>(
+          1.0, static_cast<double>(ShapeUtil::ElementsIn(consumer->shape())) /
+                   std::max<int64>(1, ShapeUtil::ElementsIn(producer->shape())));
+    }
+    KernelCost fused_cost;
+    fused_cost.flops =
+        consumer_cost.flops + recomputation * producer_cost.flops;
+    fused_cost.bytes =
+        std::max(0.0, consumer_cost.bytes - producer_output_bytes) +
+        producer_input_bytes;
+    run_times.time_fused += RunTime(fused_cost);
+  }
+  return run_times;
+}
+
+}  // namespace gpu
+}  // namespace xla
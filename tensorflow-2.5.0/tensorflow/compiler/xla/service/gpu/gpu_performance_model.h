@@ -0,0 +1,84 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_GPU_PERFORMANCE_MODEL_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_GPU_PERFORMANCE_MODEL_H_
+
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_device_info.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/statusor.h"
+
+namespace xla {
+namespace gpu {
+
+// Estimates the run time of GPU kernels with a roofline model: a kernel takes
+// the longer of its flops at the device's peak flop rate and its bytes at the
+// device's peak memory bandwidth, plus a fixed launch overhead. Flop and byte
+// counts come from HloCostAnalysis.
+//
+// Fusion passes use the model to check that a fusion decision is expected to
+// pay off, e.g. that duplicating a producer into all of its consumers does not
+// recompute more than it saves in memory traffic and kernel launches.
+class GpuPerformanceModel {
+ public:
+  // Model constants. The defaults are rough figures for recent NVIDIA GPUs;
+  // they can be calibrated against measured kernel times.
+  struct Options {
+    absl::Duration kernel_launch_overhead = absl::Microseconds(5);
+    // Floating point operations per cycle of each core (SM).
+    int64 flops_per_cycle_per_core = 128;
+    // Floating point operations charged for each transcendental operation.
+    int64 flops_per_transcendental = 4;
+  };
+
+  struct RunTimes {
+    // Time to run the producer and its consumers as separate kernels.
+    absl::Duration time_unfused;
+    // Time to run the consumers with the producer fused into each of them.
+    absl::Duration time_fused;
+  };
+
+  explicit GpuPerformanceModel(const GpuDeviceInfo& gpu_device_info);
+  GpuPerformanceModel(const GpuDeviceInfo& gpu_device_info, Options options);
+
+  // Estimates the run times of `producer` and `consumers` with and without
+  // fusing `producer` into each of `consumers`. Each consumer must be a user of
+  // `producer`.
+  StatusOr<RunTimes> EstimateRunTimes(
+      HloInstruction* producer,
+      absl::Span<HloInstruction* const> consumers) const;
+
+  // Estimates the run time of `instruction` as a single kernel.
+  StatusOr<absl::Duration> EstimateRunTime(HloInstruction* instruction) const;
+
+ private:
+  struct KernelCost {
+    double flops = 0;
+    double bytes = 0;
+  };
+
+  StatusOr<KernelCost> Cost(HloInstruction* instruction) const;
+  absl::Duration RunTime(const KernelCost& cost) const;
+
+  const GpuDeviceInfo gpu_device_info_;
+  const Options options_;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_GPU_PERFORMANCE_MODEL_H_
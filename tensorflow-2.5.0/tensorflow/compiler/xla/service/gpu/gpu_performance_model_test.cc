@@ -0,0 +1,113 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/gpu_performance_model.h"
+
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/compiler/xla/test_helpers.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+class GpuPerformanceModelTest : public HloTestBase {
+ protected:
+  GpuPerformanceModelTest() : model_(TestDeviceInfo()) {}
+
+  static GpuDeviceInfo TestDeviceInfo() {
+    GpuDeviceInfo gpu_device_info{};
+    gpu_device_info.core_count = 80;
+    gpu_device_info.memory_bandwidth = 900e9;
+    gpu_device_info.clock_rate_ghz = 1.5;
+    return gpu_device_info;
+  }
+
+  GpuPerformanceModel model_;
+};
+
+TEST_F(GpuPerformanceModelTest, CheapProducerIsFasterFused) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+HloModule CheapProducer
+
+producer_computation {
+  p0 = f32[1024,1024] parameter(0)
+  ROOT negate = f32[1024,1024] negate(p0)
+}
+
+consumer_computation {
+  p0 = f32[1024,1024] parameter(0)
+  ROOT add = f32[1024,1024] add(p0, p0)
+}
+
+ENTRY entry {
+  p0 = f32[1024,1024] parameter(0)
+  producer = f32[1024,1024] fusion(p0), kind=kLoop,
+    calls=producer_computation
+  ROOT consumer = f32[1024,1024] fusion(producer), kind=kLoop,
+    calls=consumer_computation
+})")
+                    .ValueOrDie();
+  HloInstruction* consumer = module->entry_computation()->root_instruction();
+  HloInstruction* producer = consumer->mutable_operand(0);
+
+  TF_ASSERT_OK_AND_ASSIGN(GpuPerformanceModel::RunTimes run_times,
+                          model_.EstimateRunTimes(producer, {consumer}));
+  EXPECT_LT(run_times.time_fused, run_times.time_unfused);
+}
+
+TEST_F(GpuPerformanceModelTest, BroadcastRecomputingExpensiveProducerIsSlower) {
+  // The producer does 1000 multiplies per element, and the consumer
+  // broadcasts each element of it 1024 times.
+  std::string producer_body = "  p0 = f32[1024] parameter(0)\n";
+  std::string previous = "p0";
+  for (int i = 0; i < 1000; ++i) {
+    std::string name = absl::StrCat("multiply.", i);
+    absl::StrAppend(&producer_body, "  ", i == 999 ? "ROOT " : "", name,
+                    " = f32[1024] multiply(", previous, ", p0)\n");
+    previous = name;
+  }
+  auto module = ParseAndReturnVerifiedModule(absl::StrCat(R"(
+HloModule ExpensiveProducer
+
+producer_computation {
+)",
+                                                          producer_body, R"(}
+
+consumer_computation {
+  p0 = f32[1024] parameter(0)
+  ROOT broadcast = f32[1024,1024] broadcast(p0), dimensions={1}
+}
+
+ENTRY entry {
+  p0 = f32[1024] parameter(0)
+  producer = f32[1024] fusion(p0), kind=kLoop, calls=producer_computation
+  ROOT consumer = f32[1024,1024] fusion(producer), kind=kLoop,
+    calls=consumer_computation
+})"))
+                    .ValueOrDie();
+  HloInstruction* consumer = module->entry_computation()->root_instruction();
+  HloInstruction* producer = consumer->mutable_operand(0);
+
+  TF_ASSERT_OK_AND_ASSIGN(GpuPerformanceModel::RunTimes run_times,
+                          model_.EstimateRunTimes(producer, {consumer}));
+  EXPECT_GT(run_times.time_fused, run_times.time_unfused);
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
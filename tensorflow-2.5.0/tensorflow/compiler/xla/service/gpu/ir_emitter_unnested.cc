@@ -2159,6 +2159,31 @@ Status IrEmitterUnnested::EmitCopyFromMlir(MlirEmitterInput input) {
   return EmitUsingElementalIrEmitter(input);
 }
 
+Status IrEmitterUnnested::HandleCopyStart(HloInstruction* copy_start) {
+  // Copy-start/copy-done pairs are inserted by passes that move buffers
+  // between memory spaces ahead of their use. All thunks currently run on a
+  // single stream, so the copy is issued at copy-start and is complete by the
+  // time any user of copy-done runs.
+  const HloInstruction* operand = copy_start->operand(0);
+  BufferAllocation::Slice source_buffer = GetAllocationSlice(*operand);
+  BufferAllocation::Slice destination_buffer =
+      GetAllocationSlice(*copy_start, {0});
+  if (source_buffer != destination_buffer) {
+    AddThunkToThunkSequence(absl::make_unique<DeviceToDeviceCopyThunk>(
+        GetThunkInfo(copy_start),
+        /*source_address=*/source_buffer,
+        /*destination_buffer=*/destination_buffer,
+        /*mem_size=*/ByteSizeOf(operand->shape())));
+  }
+  return Status::OK();
+}
+
+Status IrEmitterUnnested::HandleCopyDone(HloInstruction* copy_done) {
+  // The output of copy-done aliases the destination buffer of copy-start,
+  // which is already filled in.
+  return Status::OK();
+}
+
 Status IrEmitterUnnested::EmitExtraOutputsForReduce(
     absl::Span<const llvm_ir::IrArray> result_ir_arrays,
     const IrArray::Index& index, bool use_linear_index,
@@ -155,6 +155,13 @@ class IrEmitterUnnested : public IrEmitter {
 
   Status HandleCopy(HloInstruction* copy) override;
   Status EmitCopyFromMlir(MlirEmitterInput input);
+  // Lowers copy-start to a device-to-device memcpy on the single thunk stream
+  // and copy-done to nothing. This only lets the GPU backend run modules that
+  // contain asynchronous copies; it does not offload buffers to host memory,
+  // since the GPU compiler does not run memory space assignment and every
+  // buffer is allocated in device memory.
+  Status HandleCopyStart(HloInstruction* copy_start) override;
+  Status HandleCopyDone(HloInstruction* copy_done) override;
 
   Status HandleConditional(HloInstruction* conditional) override;
   Status EmitConditionalFromMlir(MlirEmitterInput mlir_input);
@@ -0,0 +1,71 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/partition_cache.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+int64 SizeInBytes(const PartitionCache::CompiledPartition& partition) {
+  return partition.first.size() + partition.second.size();
+}
+
+}  // namespace
+
+absl::optional<PartitionCache::CompiledPartition> PartitionCache::Lookup(
+    const tensorflow::Fprint128& key) {
+  tensorflow::mutex_lock lock(mu_);
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    return absl::nullopt;
+  }
+  entries_.splice(entries_.begin(), entries_, it->second);
+  return it->second->second;
+}
+
+void PartitionCache::Insert(const tensorflow::Fprint128& key,
+                            const CompiledPartition& partition) {
+  const int64 partition_size = SizeInBytes(partition);
+  if (partition_size > capacity_bytes_) {
+    return;
+  }
+  tensorflow::mutex_lock lock(mu_);
+  if (index_.contains(key)) {
+    // Another thread compiled the same partition concurrently.
+    return;
+  }
+  while (!entries_.empty() && size_bytes_ + partition_size > capacity_bytes_) {
+    size_bytes_ -= SizeInBytes(entries_.back().second);
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+  entries_.emplace_front(key, partition);
+  index_[key] = entries_.begin();
+  size_bytes_ += partition_size;
+}
+
+int64 PartitionCache::size() const {
+  tensorflow::mutex_lock lock(mu_);
+  return entries_.size();
+}
+
+int64 PartitionCache::size_bytes() const {
+  tensorflow::mutex_lock lock(mu_);
+  return size_bytes_;
+}
+
+}  // namespace gpu
+}  // namespace xla
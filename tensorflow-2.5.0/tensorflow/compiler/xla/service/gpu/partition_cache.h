@@ -0,0 +1,82 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_PARTITION_CACHE_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_PARTITION_CACHE_H_
+
+#include <list>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/optional.h"
+#include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace xla {
+namespace gpu {
+
+// A cache of the (PTX, relocatable binary) pairs produced for the partitions
+// of modules compiled in parallel, keyed by a fingerprint of the partition's
+// unoptimized LLVM IR and of everything else that changes its compilation.
+//
+// The cache holds at most `capacity_bytes` of PTX and binaries. When an
+// insertion exceeds the capacity, the least recently used partitions are
+// evicted.
+//
+// This class is thread-safe.
+class PartitionCache {
+ public:
+  using CompiledPartition = std::pair<std::string, std::vector<uint8>>;
+
+  explicit PartitionCache(int64 capacity_bytes)
+      : capacity_bytes_(capacity_bytes) {}
+
+  // Returns the partition compiled for `key`, if it is cached, and marks it as
+  // the most recently used.
+  absl::optional<CompiledPartition> Lookup(const tensorflow::Fprint128& key);
+
+  // Caches `partition` for `key`. Partitions larger than the capacity are not
+  // cached.
+  void Insert(const tensorflow::Fprint128& key,
+              const CompiledPartition& partition);
+
+  // The number of cached partitions.
+  int64 size() const;
+
+  // The number of bytes of PTX and binaries of the cached partitions.
+  int64 size_bytes() const;
+
+ private:
+  using Entry = std::pair<tensorflow::Fprint128, CompiledPartition>;
+
+  const int64 capacity_bytes_;
+
+  mutable tensorflow::mutex mu_;
+  // The most recently used partitions come first.
+  std::list<Entry> entries_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<tensorflow::Fprint128, std::list<Entry>::iterator,
+                      tensorflow::Fprint128Hasher>
+      index_ TF_GUARDED_BY(mu_);
+  int64 size_bytes_ TF_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_PARTITION_CACHE_H_
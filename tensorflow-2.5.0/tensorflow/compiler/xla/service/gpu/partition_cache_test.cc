@@ -0,0 +1,78 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/partition_cache.h"
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+tensorflow::Fprint128 Key(const std::string& ir) {
+  return tensorflow::Fingerprint128(ir);
+}
+
+// A partition of `ptx_size` bytes of PTX and as many bytes of binary.
+PartitionCache::CompiledPartition Partition(int ptx_size, char c) {
+  return {std::string(ptx_size, c), std::vector<uint8>(ptx_size, c)};
+}
+
+TEST(PartitionCacheTest, HitsAndMisses) {
+  PartitionCache cache(/*capacity_bytes=*/1000);
+  EXPECT_FALSE(cache.Lookup(Key("a")).has_value());
+
+  cache.Insert(Key("a"), Partition(10, 'a'));
+  auto hit = cache.Lookup(Key("a"));
+  ASSERT_TRUE(hit.has_value());
+  EXPECT_EQ(*hit, Partition(10, 'a'));
+  EXPECT_FALSE(cache.Lookup(Key("b")).has_value());
+  EXPECT_EQ(cache.size(), 1);
+  EXPECT_EQ(cache.size_bytes(), 20);
+}
+
+TEST(PartitionCacheTest, EvictsLeastRecentlyUsed) {
+  PartitionCache cache(/*capacity_bytes=*/60);
+  cache.Insert(Key("a"), Partition(10, 'a'));
+  cache.Insert(Key("b"), Partition(10, 'b'));
+  cache.Insert(Key("c"), Partition(10, 'c'));
+  // Makes "b" the least recently used partition.
+  ASSERT_TRUE(cache.Lookup(Key("a")).has_value());
+
+  cache.Insert(Key("d"), Partition(10, 'd'));
+  EXPECT_FALSE(cache.Lookup(Key("b")).has_value());
+  EXPECT_TRUE(cache.Lookup(Key("a")).has_value());
+  EXPECT_TRUE(cache.Lookup(Key("c")).has_value());
+  EXPECT_TRUE(cache.Lookup(Key("d")).has_value());
+  EXPECT_EQ(cache.size(), 3);
+  EXPECT_EQ(cache.size_bytes(), 60);
+}
+
+TEST(PartitionCacheTest, DoesNotCachePartitionsLargerThanCapacity) {
+  PartitionCache cache(/*capacity_bytes=*/60);
+  cache.Insert(Key("a"), Partition(10, 'a'));
+  cache.Insert(Key("big"), Partition(40, 'b'));
+  EXPECT_FALSE(cache.Lookup(Key("big")).has_value());
+  EXPECT_TRUE(cache.Lookup(Key("a")).has_value());
+  EXPECT_EQ(cache.size_bytes(), 20);
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
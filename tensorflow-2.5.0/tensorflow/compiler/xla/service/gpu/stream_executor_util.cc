@@ -207,11 +207,18 @@ StatusOr<std::unique_ptr<se::KernelBase>> CreateKernel(
   return std::move(kernel_base);
 }
 
-Status ExecuteKernelOnStream(const se::KernelBase& kernel,
-                             absl::Span<const se::DeviceMemoryBase> args,
-                             const LaunchDimensions& dims, se::Stream* stream) {
-  static constexpr int kKernelArgsLimit = 1024;
-  auto kernel_args = absl::make_unique<se::KernelArgsArray<kKernelArgsLimit>>();
+namespace {
+
+// Launches `kernel` with `args` packed into a KernelArgsArray of capacity
+// kNumArgs. The array is default-initialized with `new` rather than
+// value-initialized with make_unique: the latter would zero every slot of the
+// array on each launch, while only `args.size()` of them are used.
+template <int kNumArgs>
+Status LaunchWithPackedArgs(const se::KernelBase& kernel,
+                            absl::Span<const se::DeviceMemoryBase> args,
+                            const LaunchDimensions& dims, se::Stream* stream) {
+  std::unique_ptr<se::KernelArgsArray<kNumArgs>> kernel_args(
+      new se::KernelArgsArray<kNumArgs>);
   for (const se::DeviceMemoryBase& buf : args) {
     kernel_args->add_device_memory_argument(buf);
   }
@@ -223,6 +230,30 @@ Status ExecuteKernelOnStream(const se::KernelBase& kernel,
       *kernel_args);
 }
 
+}  // namespace
+
+Status ExecuteKernelOnStream(const se::KernelBase& kernel,
+                             absl::Span<const se::DeviceMemoryBase> args,
+                             const LaunchDimensions& dims, se::Stream* stream) {
+  static constexpr int kKernelArgsLimit = 1024;
+  // Most kernels take a handful of arguments; pick the smallest array that
+  // fits so that packing touches as little memory as possible.
+  if (args.size() <= 8) {
+    return LaunchWithPackedArgs<8>(kernel, args, dims, stream);
+  }
+  if (args.size() <= 32) {
+    return LaunchWithPackedArgs<32>(kernel, args, dims, stream);
+  }
+  if (args.size() <= 128) {
+    return LaunchWithPackedArgs<128>(kernel, args, dims, stream);
+  }
+  if (args.size() <= kKernelArgsLimit) {
+    return LaunchWithPackedArgs<kKernelArgsLimit>(kernel, args, dims, stream);
+  }
+  return InternalError("Kernel %s takes %d arguments, more than the limit of %d",
+                       kernel.name(), args.size(), kKernelArgsLimit);
+}
+
 se::GpuAsmOpts PtxOptsFromConfig(const HloModuleConfig& hlo_module_config) {
   string extra_string =
       hlo_module_config.debug_options().xla_gpu_asm_extra_flags();
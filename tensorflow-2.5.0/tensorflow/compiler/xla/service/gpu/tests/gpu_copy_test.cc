@@ -53,5 +53,23 @@ TEST_F(GpuCopyTest, UseMemcpy) {
                      /*match_optimized_ir=*/false);
 }
 
+// An asynchronous copy, as inserted by passes that move buffers between memory
+// spaces, should also be lowered to a memcpy.
+TEST_F(GpuCopyTest, AsyncCopyUsesMemcpy) {
+  const char* hlo_text = R"(
+HloModule AsyncCopy
+
+ENTRY main {
+  p0 = f32[2,2]{1,0} parameter(0)
+  negate = f32[2,2]{1,0} negate(p0)
+  copy-start = (f32[2,2]{1,0}, f32[2,2]{1,0}, u32[]) copy-start(negate)
+  copy-done = f32[2,2]{1,0} copy-done(copy-start)
+  ROOT add = f32[2,2]{1,0} add(copy-done, negate)
+})";
+  CompileAndVerifyIr(hlo_text, "; CHECK-NOT: define void @copy",
+                     /*match_optimized_ir=*/false);
+  EXPECT_TRUE(RunAndCompare(hlo_text, ErrorSpec{1e-5, 1e-5}));
+}
+
 }  // namespace gpu
 }  // namespace xla
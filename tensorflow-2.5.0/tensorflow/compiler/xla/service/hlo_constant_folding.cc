@@ -137,6 +137,29 @@ StatusOr<bool> HloConstantFolding::Run(HloModule* module) {
         }
       }
 
+      // Don't fold instructions that apply a computation to huge operands,
+      // e.g. a reduce or a map. The evaluator interprets the computation once
+      // per element, which can take far longer than running it on device.
+      if (!instruction->called_computations().empty()) {
+        int64 elements_in_operands = 0;
+        for (const HloInstruction* operand : instruction->operands()) {
+          ShapeUtil::ForEachSubshape(
+              operand->shape(),
+              [&](const Shape& subshape, const ShapeIndex& /*index*/) {
+                if (subshape.IsArray()) {
+                  elements_in_operands += ShapeUtil::ElementsIn(subshape);
+                }
+              });
+        }
+        static const int64 kMaximumEvaluatedElements = 10 * 1000 * 1000;
+        if (elements_in_operands > kMaximumEvaluatedElements) {
+          VLOG(2) << "Not constant folding " << instruction->name()
+                  << ": it applies a computation to " << elements_in_operands
+                  << " elements.";
+          continue;
+        }
+      }
+
       Literal result;
       // Currently we skip unimplemented operations.
       // TODO(b/35975797): Fold constant computations for more operations.
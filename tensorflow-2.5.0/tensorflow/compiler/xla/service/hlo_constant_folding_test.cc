@@ -270,6 +270,36 @@ TEST_F(HloConstantFoldingTest, DoesNotFoldLargePad) {
               GmockMatch(m::Pad(m::Constant(), m::Constant())));
 }
 
+TEST_F(HloConstantFoldingTest, DoesNotFoldReduceOfLargeConstant) {
+  const char* const kModuleStr = R"(
+  HloModule ReduceLargeConstant
+
+  add {
+    a = s8[] parameter(0)
+    b = s8[] parameter(1)
+    ROOT add = s8[] add(a, b)
+  }
+
+  ENTRY r {
+    x = s8[4096,4096] parameter(0)
+    init = s8[] constant(0)
+    ROOT reduce = s8[4096] reduce(x, init), dimensions={1}, to_apply=add
+  })";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kModuleStr));
+  HloComputation* entry = module->entry_computation();
+  HloInstruction* param = entry->parameter_instruction(0);
+  HloInstruction* constant = entry->AddInstruction(
+      HloInstruction::CreateConstant(Literal(param->shape())));
+  TF_ASSERT_OK(param->ReplaceAllUsesWith(constant));
+  HloConstantFolding const_folder;
+  TF_ASSERT_OK_AND_ASSIGN(bool result, const_folder.Run(module.get()));
+  EXPECT_FALSE(result);
+
+  EXPECT_THAT(entry->root_instruction(),
+              GmockMatch(m::Reduce(m::Constant(), m::Constant())));
+}
+
 TEST_F(HloConstantFoldingTest, DontFoldSubcomputationContainingAfterAll) {
   const char* const kModuleStr = R"(
   HloModule test
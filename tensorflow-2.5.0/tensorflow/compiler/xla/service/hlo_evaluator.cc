@@ -229,6 +229,24 @@ HloEvaluator::HloEvaluator(int64 max_loop_iterations)
       });
 }
 
+/* static */ bool HloEvaluator::HaveSameElementOrder(
+    const Literal& result, absl::Span<const Literal* const> operands) {
+  const Shape& shape = result.shape();
+  if (!shape.IsArray() || !shape.is_static()) {
+    return false;
+  }
+  for (const Literal* operand : operands) {
+    const Shape& operand_shape = operand->shape();
+    if (!operand_shape.IsArray() || !operand_shape.is_static() ||
+        !ShapeUtil::SameDimensions(shape, operand_shape) ||
+        !Layout::Equal().MinorToMajorOnly()(shape.layout(),
+                                            operand_shape.layout())) {
+      return false;
+    }
+  }
+  return true;
+}
+
 StatusOr<Literal> HloEvaluator::Evaluate(
     const HloComputation& computation,
     absl::Span<const Literal* const> arg_literals) {
@@ -2302,10 +2320,10 @@ Status HloEvaluator::HandleSort(HloInstruction* sort) {
   return Status::OK();
 }
 
-static bool IsScalarAdd(HloComputation* computation) {
+// Returns true if `computation` applies `opcode` to its two scalar parameters.
+static bool IsScalarBinaryOp(HloComputation* computation, HloOpcode opcode) {
   HloInstruction* instruction = computation->root_instruction();
-  if (instruction->opcode() == HloOpcode::kAdd &&
-      computation->num_parameters() == 2) {
+  if (instruction->opcode() == opcode && computation->num_parameters() == 2) {
     const HloInstruction* lhs = instruction->operand(0);
     const HloInstruction* rhs = instruction->operand(1);
     return lhs->opcode() == HloOpcode::kParameter &&
@@ -2385,8 +2403,16 @@ static StatusOr<bool> GenerateReduceOutputElement(
     absl::Span<const int64> arg_dim_steps,
     absl::Span<const int64> arg_dim_counts,
     absl::Span<const int64> result_to_arg_index) {
-  bool use_fast_add = ShapeUtil::ElementIsFloating(init_values[0]->shape()) &&
-                      IsScalarAdd(function) && !is_tuple;
+  const bool is_floating =
+      ShapeUtil::ElementIsFloating(init_values[0]->shape()) && !is_tuple;
+  bool use_fast_add =
+      is_floating && IsScalarBinaryOp(function, HloOpcode::kAdd);
+  // Every floating point value converts to double exactly, so max and min can
+  // be computed in double without changing the result.
+  bool use_fast_max =
+      is_floating && IsScalarBinaryOp(function, HloOpcode::kMaximum);
+  bool use_fast_min =
+      is_floating && IsScalarBinaryOp(function, HloOpcode::kMinimum);
 
   const Shape& arg_shape = input_args[0]->shape();
   absl::Span<const int64> arg_dimensions = AsInt64Slice(arg_shape.dimensions());
@@ -2414,6 +2440,30 @@ static StatusOr<bool> GenerateReduceOutputElement(
     return true;
   }
 
+  if (use_fast_max || use_fast_min) {
+    double computed_result = *init_values[0]->GetAsDouble({});
+    auto reduction_step =
+        [&](absl::Span<const int64> input_index) -> StatusOr<bool> {
+      double argument = *input_args[0]->GetAsDouble(input_index);
+      // Like the kMaximum and kMinimum HLOs, propagate NaNs.
+      if (std::isnan(computed_result)) {
+        return true;
+      }
+      if (std::isnan(argument)) {
+        computed_result = argument;
+      } else if (use_fast_max) {
+        computed_result = std::max(computed_result, argument);
+      } else {
+        computed_result = std::min(computed_result, argument);
+      }
+      return true;
+    };
+    TF_RETURN_IF_ERROR(ShapeUtil::ForEachIndexWithStatus(
+        arg_shape, base, arg_dim_counts, arg_dim_steps, reduction_step));
+    TF_RETURN_IF_ERROR(results[0].SetFromDouble(output_index, computed_result));
+    return true;
+  }
+
   // Iterates only over reduced shape, as counts and steps are set to zero
   // for all non-reduced dimensions.
   TF_RETURN_IF_ERROR(ShapeUtil::ForEachIndexWithStatus(
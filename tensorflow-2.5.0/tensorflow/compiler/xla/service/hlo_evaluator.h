@@ -338,6 +338,14 @@ class HloEvaluator : public DfsHloVisitorWithDefault {
     TF_RET_CHECK(ShapeUtil::SameDimensions(shape, operand->shape()));
 
     Literal result(shape);
+    if (HaveSameElementOrder(result, {&operand_literal})) {
+      absl::Span<const NativeT> operand_data = operand_literal.data<NativeT>();
+      absl::Span<ReturnT> result_data = result.data<ReturnT>();
+      for (int64 i = 0; i < result_data.size(); ++i) {
+        result_data[i] = unary_op(operand_data[i]);
+      }
+      return std::move(result);
+    }
     TF_RETURN_IF_ERROR(
         result.Populate<ReturnT>([&](absl::Span<const int64> multi_index) {
           return unary_op(operand_literal.Get<NativeT>(multi_index));
@@ -345,6 +353,12 @@ class HloEvaluator : public DfsHloVisitorWithDefault {
     return std::move(result);
   }
 
+  // Returns true if `operands` store their elements in the same order as
+  // `result`, so that elementwise ops can walk the buffers linearly instead of
+  // computing each element's linear index from its multi-dimensional index.
+  static bool HaveSameElementOrder(const Literal& result,
+                                   absl::Span<const Literal* const> operands);
+
   // Map from a primitive type to its associated (templated) DfsHloVisitor.
   std::unique_ptr<DfsHloVisitor> typed_visitors_[PrimitiveType_ARRAYSIZE];
 
@@ -14,7 +14,9 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/compiler/xla/service/hlo_evaluator.h"
 
+#include <cmath>
 #include <initializer_list>
+#include <limits>
 #include <memory>
 #include <string>
 #include <tuple>
@@ -322,6 +324,27 @@ TEST_F(HloEvaluatorTest, DoesAdd) {
   TestBinaryOp(HloOpcode::kAdd, std::move(expected), std::move(lhs),
                std::move(rhs));
 }
+// Operands whose layout differs from the result's are indexed element by
+// element rather than walked linearly.
+TEST_F(HloEvaluatorTest, DoesAddWithDifferentLayouts) {
+  const char* hlo_text = R"(
+HloModule AddWithDifferentLayouts
+
+ENTRY main {
+  lhs = f32[2,3]{1,0} parameter(0)
+  rhs = f32[2,3]{0,1} parameter(1)
+  ROOT add = f32[2,3]{1,0} add(lhs, rhs)
+}
+)";
+  auto lhs = LiteralUtil::CreateR2<float>({{1, 2, 3}, {4, 5, 6}});
+  auto rhs = LiteralUtil::CreateR2WithLayout<float>(
+      {{10, 20, 30}, {40, 50, 60}}, LayoutUtil::MakeLayout({0, 1}));
+  auto expected = LiteralUtil::CreateR2<float>({{11, 22, 33}, {44, 55, 66}});
+  TF_ASSERT_OK_AND_ASSIGN(m_, ParseAndReturnVerifiedModule(hlo_text));
+  TF_ASSERT_OK_AND_ASSIGN(Literal result, Evaluate({&lhs, &rhs}));
+  EXPECT_TRUE(LiteralTestUtil::Equal(expected, result));
+}
+
 // Verifies that HloEvaluator evaluates a HLO instruction that performs
 // element-wise and with 2 operands.
 TEST_P(HloEvaluatorBf16Test, DoesAnd) {
@@ -2625,6 +2648,30 @@ TEST_P(HloEvaluatorBf16Test, ReduceAdd) {
   EXPECT_TRUE(LiteralTestUtil::Equal(expected, result));
 }
 
+TEST_F(HloEvaluatorTest, ReduceMaxPropagatesNaN) {
+  const char* hlo_text = R"(
+HloModule ReduceMax
+
+max {
+  lhs = f32[] parameter(0)
+  rhs = f32[] parameter(1)
+  ROOT max = f32[] maximum(lhs, rhs)
+}
+
+ENTRY main {
+  arg = f32[2,3] parameter(0)
+  init = f32[] constant(-inf)
+  ROOT reduce = f32[2] reduce(arg, init), dimensions={1}, to_apply=max
+}
+)";
+  auto arg = LiteralUtil::CreateR2<float>(
+      {{1, 7, 3}, {4, std::numeric_limits<float>::quiet_NaN(), 6}});
+  TF_ASSERT_OK_AND_ASSIGN(m_, ParseAndReturnVerifiedModule(hlo_text));
+  TF_ASSERT_OK_AND_ASSIGN(Literal result, Evaluate({&arg}));
+  EXPECT_EQ(result.Get<float>({0}), 7);
+  EXPECT_TRUE(std::isnan(result.Get<float>({1})));
+}
+
 TEST_P(HloEvaluatorBf16Test, ReduceWindowMax) {
   HloComputation::Builder b(TestName());
 
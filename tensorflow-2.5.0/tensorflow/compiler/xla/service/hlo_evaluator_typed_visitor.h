@@ -2982,11 +2982,21 @@ class HloEvaluatorTypedVisitor : public DfsHloVisitorWithDefault {
 
     Literal result(shape);
 
+    const auto op = ConvertBinaryFunction(binary_op);
+    if (HloEvaluator::HaveSameElementOrder(result,
+                                           {&lhs_literal, &rhs_literal})) {
+      auto lhs_data = lhs_literal.data<ReturnT>();
+      auto rhs_data = rhs_literal.data<ReturnT>();
+      auto result_data = result.data<ReturnT>();
+      for (int64 i = 0; i < result_data.size(); ++i) {
+        result_data[i] = op(lhs_data[i], rhs_data[i]);
+      }
+      return std::move(result);
+    }
     TF_RETURN_IF_ERROR(
         result.Populate<ReturnT>([&](absl::Span<const int64> multi_index) {
-          return ConvertBinaryFunction(binary_op)(
-              lhs_literal.Get<ReturnT>(multi_index),
-              rhs_literal.Get<ReturnT>(multi_index));
+          return op(lhs_literal.Get<ReturnT>(multi_index),
+                    rhs_literal.Get<ReturnT>(multi_index));
         }));
     return std::move(result);
   }
@@ -3009,6 +3019,17 @@ class HloEvaluatorTypedVisitor : public DfsHloVisitorWithDefault {
 
     Literal result(shape);
 
+    if (HloEvaluator::HaveSameElementOrder(
+            result, {&lhs_literal, &rhs_literal, &ehs_literal})) {
+      auto lhs_data = lhs_literal.data<LhsType>();
+      auto rhs_data = rhs_literal.data<RhsType>();
+      auto ehs_data = ehs_literal.data<EhsType>();
+      auto result_data = result.data<ReturnT>();
+      for (int64 i = 0; i < result_data.size(); ++i) {
+        result_data[i] = ternary_op(lhs_data[i], rhs_data[i], ehs_data[i]);
+      }
+      return std::move(result);
+    }
     TF_RETURN_IF_ERROR(
         result.Populate<ReturnT>([&](absl::Span<const int64> multi_index) {
           return ternary_op(lhs_literal.Get<LhsType>(multi_index),
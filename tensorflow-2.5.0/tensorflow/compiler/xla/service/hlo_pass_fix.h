@@ -20,6 +20,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/hlo_module.h"
 #include "tensorflow/compiler/xla/service/hlo_module_group.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_profiler.h"
 #include "tensorflow/compiler/xla/status_macros.h"
 #include "tensorflow/compiler/xla/statusor.h"
 #include "tensorflow/compiler/xla/types.h"
@@ -50,10 +51,12 @@ class HloPassFix : public Pass {
         VLOG(1) << "Unexpectedly high number of iterations in HLO passes '"
                 << Pass::name() << "' for module '" << module->name()
                 << "'. Exiting fixed point loop.";
+        RecordIterations(iteration_count);
         // Return false in case this is fixed point is nested.
         return false;
       }
     }
+    RecordIterations(iteration_count);
     return changed;
   }
 
@@ -72,12 +75,23 @@ class HloPassFix : public Pass {
       if (iteration_count == kLimit) {
         VLOG(1) << "Unexpectedly high number of iterations in HLO passes, "
                    "exiting fixed point loop.";
+        RecordIterations(iteration_count);
         // Return false in case this is fixed point is nested.
         return false;
       }
     }
+    RecordIterations(iteration_count);
     return changed;
   }
+
+ private:
+  void RecordIterations(int64 iteration_count) {
+    // Nested pipelines are profiled pass by pass.
+    if (!Pass::IsPassPipeline()) {
+      HloPassProfiler::Global().RecordFixedPointIterations(Pass::name(),
+                                                           iteration_count);
+    }
+  }
 };
 
 }  // namespace xla
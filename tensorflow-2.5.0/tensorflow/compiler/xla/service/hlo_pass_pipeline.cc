@@ -23,11 +23,15 @@ limitations under the License.
 #include "absl/strings/str_join.h"
 #include "tensorflow/compiler/xla/service/dump.h"
 #include "tensorflow/compiler/xla/service/hlo_graph_dumper.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_profiler.h"
 #include "tensorflow/compiler/xla/service/hlo_proto_util.h"
 #include "tensorflow/compiler/xla/status_macros.h"
 #include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/profiler/lib/traceme_encode.h"
 
 namespace xla {
 
@@ -95,6 +99,22 @@ void RecordPassEndMetadata(HloModuleGroup& module_group,
   }
 }
 
+int64 InstructionCount(const HloModule& module) {
+  int64 count = 0;
+  for (const HloComputation* computation : module.computations()) {
+    count += computation->instruction_count();
+  }
+  return count;
+}
+
+int64 InstructionCount(const HloModuleGroup& module_group) {
+  int64 count = 0;
+  for (const HloModule* module : module_group.modules()) {
+    count += InstructionCount(*module);
+  }
+  return count;
+}
+
 void SetInstructionMetadata(HloModule& module) {
   StatusOr<int64> pass_id = module.metadata()->current_pass_id();
   if (!pass_id.ok()) {
@@ -166,11 +186,32 @@ StatusOr<bool> HloPassPipeline::RunPassesInternal(
     std::string pass_name = std::string(pass->name());
     VLOG(1) << "  HLO pass " << pass_name;
     VLOG(2) << "  Module hash " << hlo->Hash();
-    if (!pass->IsPassPipeline()) {
+    // Nested pipelines record their own passes.
+    const bool profile_pass = !pass->IsPassPipeline();
+    if (profile_pass) {
       compilation_stats_->StartPass(pass_name);
     }
+    const int64 instruction_count_before =
+        profile_pass ? InstructionCount(*hlo) : 0;
+    const uint64 start_micros = tensorflow::Env::Default()->NowMicros();
     RecordPassStartMetadata(*hlo, pass_name, pipeline_name);
-    TF_ASSIGN_OR_RETURN(bool pass_changed, RunHelper(pass, hlo));
+    StatusOr<bool> pass_status;
+    {
+      tensorflow::profiler::TraceMe activity(
+          [&] {
+            return tensorflow::profiler::TraceMeEncode(
+                absl::StrCat("HloPass:", pass_name),
+                {{"pipeline", pipeline_name}, {"module", hlo->name()}});
+          },
+          tensorflow::profiler::TraceMeLevel::kInfo);
+      pass_status = RunHelper(pass, hlo);
+    }
+    TF_ASSIGN_OR_RETURN(bool pass_changed, pass_status);
+    if (profile_pass) {
+      HloPassProfiler::Global().RecordPass(
+          pass_name, start_micros, tensorflow::Env::Default()->NowMicros(),
+          instruction_count_before, InstructionCount(*hlo), pass_changed);
+    }
     SetInstructionMetadata(*hlo);
     MaybeDumpHloAndSaveFilenames(*hlo,
                                  /*after_pass_name=*/pass_name,
@@ -0,0 +1,100 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/hlo_pass_profiler.h"
+
+#include <algorithm>
+
+#include "absl/algorithm/container.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+
+namespace xla {
+
+/* static */
+HloPassProfiler& HloPassProfiler::Global() {
+  static HloPassProfiler* profiler = new HloPassProfiler();
+  return *profiler;
+}
+
+void HloPassProfiler::RecordPass(absl::string_view pass_name,
+                                 uint64 start_micros, uint64 end_micros,
+                                 int64 instruction_count_before,
+                                 int64 instruction_count_after, bool changed) {
+  double duration_ms = (end_micros - start_micros) / 1000.0;
+  tensorflow::mutex_lock l(mu_);
+  PassStats& stats = passes_[std::string(pass_name)];
+  ++stats.num_runs;
+  if (changed) {
+    ++stats.num_changed;
+  }
+  stats.total_ms += duration_ms;
+  stats.max_ms = std::max(stats.max_ms, duration_ms);
+  stats.instruction_count_delta +=
+      instruction_count_after - instruction_count_before;
+}
+
+void HloPassProfiler::RecordFixedPointIterations(absl::string_view pass_name,
+                                                 int64 iterations) {
+  tensorflow::mutex_lock l(mu_);
+  passes_[std::string(pass_name)].fixed_point_iterations += iterations;
+}
+
+std::vector<HloPassProfiler::PassStats> HloPassProfiler::Summary() const {
+  std::vector<PassStats> summary;
+  {
+    tensorflow::mutex_lock l(mu_);
+    summary.reserve(passes_.size());
+    for (const auto& it : passes_) {
+      summary.push_back(it.second);
+      summary.back().pass_name = it.first;
+    }
+  }
+  absl::c_sort(summary, [](const PassStats& a, const PassStats& b) {
+    // Sort passes that take the longest first, break ties using pass names.
+    return std::make_pair(b.total_ms, a.pass_name) <
+           std::make_pair(a.total_ms, b.pass_name);
+  });
+  return summary;
+}
+
+std::string HloPassProfiler::SummaryTable(int max_passes) const {
+  std::vector<PassStats> summary = Summary();
+  double total_ms = 0;
+  for (const PassStats& stats : summary) {
+    total_ms += stats.total_ms;
+  }
+  std::string table = absl::StrFormat(
+      "Total runtime (ms) of HLO passes: %.3f\n"
+      "%-40s %8s %8s %12s %7s %12s %10s %10s\n",
+      total_ms, "Pass name", "Runs", "Changed", "Time (ms)", "Time %",
+      "Max (ms)", "Insts +/-", "Fixpoint");
+  for (int i = 0; i < summary.size() && i < max_passes; ++i) {
+    const PassStats& stats = summary[i];
+    absl::StrAppendFormat(
+        &table, "%-40s %8d %8d %12.3f %6.1f%% %12.3f %10d %10d\n",
+        stats.pass_name, stats.num_runs, stats.num_changed, stats.total_ms,
+        total_ms > 0 ? 100 * stats.total_ms / total_ms : 0.0, stats.max_ms,
+        stats.instruction_count_delta, stats.fixed_point_iterations);
+  }
+  return table;
+}
+
+void HloPassProfiler::Reset() {
+  tensorflow::mutex_lock l(mu_);
+  passes_.clear();
+}
+
+}  // namespace xla
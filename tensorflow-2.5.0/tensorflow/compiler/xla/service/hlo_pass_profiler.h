@@ -0,0 +1,83 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_HLO_PASS_PROFILER_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_HLO_PASS_PROFILER_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace xla {
+
+// Aggregates compile-time statistics of HLO passes across every pass pipeline
+// run in the process, so that the passes which dominate compilation time can
+// be identified. HloPassPipeline records every pass it runs; HloPassFix
+// records the number of iterations it took to reach a fixed point.
+//
+// This class is thread-safe.
+class HloPassProfiler {
+ public:
+  // Statistics of all runs of one pass.
+  struct PassStats {
+    std::string pass_name;
+    int64 num_runs = 0;
+    // The number of runs which changed the HLO.
+    int64 num_changed = 0;
+    double total_ms = 0;
+    double max_ms = 0;
+    // The total change in the number of HLO instructions caused by the pass.
+    int64 instruction_count_delta = 0;
+    // The total number of iterations the pass ran for when run to a fixed
+    // point by HloPassFix.
+    int64 fixed_point_iterations = 0;
+  };
+
+  // Returns the profiler shared by the whole process.
+  static HloPassProfiler& Global();
+
+  // Records one run of the pass named `pass_name`.
+  void RecordPass(absl::string_view pass_name, uint64 start_micros,
+                  uint64 end_micros, int64 instruction_count_before,
+                  int64 instruction_count_after, bool changed);
+
+  // Records that the pass named `pass_name` ran `iterations` times before
+  // reaching a fixed point.
+  void RecordFixedPointIterations(absl::string_view pass_name,
+                                  int64 iterations);
+
+  // Returns the statistics of all passes, the most expensive first.
+  std::vector<PassStats> Summary() const;
+
+  // Returns `Summary()` formatted as a table, limited to the `max_passes` most
+  // expensive passes.
+  std::string SummaryTable(int max_passes = 50) const;
+
+  // Discards all statistics recorded so far.
+  void Reset();
+
+ private:
+  mutable tensorflow::mutex mu_;
+  absl::flat_hash_map<std::string, PassStats> passes_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_HLO_PASS_PROFILER_H_
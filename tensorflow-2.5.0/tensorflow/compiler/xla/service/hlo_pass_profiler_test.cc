@@ -0,0 +1,76 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/hlo_pass_profiler.h"
+
+#include "tensorflow/compiler/xla/test.h"
+
+namespace xla {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::SizeIs;
+
+TEST(HloPassProfilerTest, AggregatesRunsOfEachPass) {
+  HloPassProfiler profiler;
+  profiler.RecordPass("dce", /*start_micros=*/0, /*end_micros=*/1000,
+                      /*instruction_count_before=*/10,
+                      /*instruction_count_after=*/7, /*changed=*/true);
+  profiler.RecordPass("dce", /*start_micros=*/0, /*end_micros=*/3000,
+                      /*instruction_count_before=*/7,
+                      /*instruction_count_after=*/7, /*changed=*/false);
+  profiler.RecordPass("cse", /*start_micros=*/0, /*end_micros=*/500,
+                      /*instruction_count_before=*/7,
+                      /*instruction_count_after=*/5, /*changed=*/true);
+  profiler.RecordFixedPointIterations("cse", 3);
+
+  std::vector<HloPassProfiler::PassStats> summary = profiler.Summary();
+  ASSERT_THAT(summary, SizeIs(2));
+  EXPECT_EQ(summary[0].pass_name, "dce");
+  EXPECT_EQ(summary[0].num_runs, 2);
+  EXPECT_EQ(summary[0].num_changed, 1);
+  EXPECT_DOUBLE_EQ(summary[0].total_ms, 4.0);
+  EXPECT_DOUBLE_EQ(summary[0].max_ms, 3.0);
+  EXPECT_EQ(summary[0].instruction_count_delta, -3);
+  EXPECT_EQ(summary[0].fixed_point_iterations, 0);
+  EXPECT_EQ(summary[1].pass_name, "cse");
+  EXPECT_EQ(summary[1].num_runs, 1);
+  EXPECT_EQ(summary[1].instruction_count_delta, -2);
+  EXPECT_EQ(summary[1].fixed_point_iterations, 3);
+
+  std::string table = profiler.SummaryTable();
+  EXPECT_THAT(table, HasSubstr("Total runtime (ms) of HLO passes: 4.500"));
+  EXPECT_THAT(table, HasSubstr("dce"));
+  EXPECT_THAT(table, HasSubstr("cse"));
+}
+
+TEST(HloPassProfilerTest, SummaryTableIsLimited) {
+  HloPassProfiler profiler;
+  profiler.RecordPass("slow", 0, 2000, 0, 0, false);
+  profiler.RecordPass("fast", 0, 1000, 0, 0, false);
+  std::string table = profiler.SummaryTable(/*max_passes=*/1);
+  EXPECT_THAT(table, HasSubstr("slow"));
+  EXPECT_THAT(table, ::testing::Not(HasSubstr("fast")));
+}
+
+TEST(HloPassProfilerTest, Reset) {
+  HloPassProfiler profiler;
+  profiler.RecordPass("dce", 0, 1000, 0, 0, false);
+  profiler.Reset();
+  EXPECT_THAT(profiler.Summary(), SizeIs(0));
+}
+
+}  // namespace
+}  // namespace xla
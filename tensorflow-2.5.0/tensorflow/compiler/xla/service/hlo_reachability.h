@@ -152,48 +152,86 @@ class HloReachabilityMap {
  private:
   // A bit-vector implementation specialized for this use case which provides a
   // fast bitwise OR operation not available in tensorflow::gtl::BitMap.
+  //
+  // Only the words between the first and the last non-zero word are stored.
+  // Instructions are numbered in post order, so the instructions an
+  // instruction is reachable from tend to form a contiguous range of indices
+  // below its own index. Storing just that range avoids the quadratic memory of
+  // a dense matrix for computations with many independent chains, and keeps
+  // `OrWith` proportional to the size of the range instead of the computation.
   class BitVector {
    public:
     BitVector() = default;
-    BitVector(size_t size)
-        : size_(size), vector_((size + kBits - 1) / kBits, 0) {}
+    BitVector(size_t size) : size_(size) {}
 
     // Return the bit at the given index.
     bool Get(size_t index) const {
       DCHECK(index >= 0 && index < size_);
-      return vector_[index / kBits] & (1ull << (index % kBits));
+      size_t word = index / kBits;
+      if (word < first_word_ || word >= first_word_ + vector_.size()) {
+        return false;
+      }
+      return vector_[word - first_word_] & (1ull << (index % kBits));
     }
 
     // Set the bit at the given index.
     void Set(size_t index) {
       DCHECK(index >= 0 && index < size_);
-      vector_[index / kBits] |= 1ull << (index % kBits);
+      size_t word = index / kBits;
+      Cover(word, word + 1);
+      vector_[word - first_word_] |= 1ull << (index % kBits);
     }
 
     // Set this bitvector to the Logical OR of this bitvector and 'other'.
     void OrWith(const BitVector& other) {
-      for (size_t i = 0; i < vector_.size(); ++i) {
-        vector_[i] |= other.vector_[i];
+      if (other.vector_.empty()) {
+        return;
+      }
+      Cover(other.first_word_, other.first_word_ + other.vector_.size());
+      Word* words = &vector_[other.first_word_ - first_word_];
+      for (size_t i = 0; i < other.vector_.size(); ++i) {
+        words[i] |= other.vector_[i];
       }
     }
 
     // Set the bitvector to all zeros.
-    void SetToZero() { std::fill(vector_.begin(), vector_.end(), 0); }
+    void SetToZero() {
+      first_word_ = 0;
+      vector_.clear();
+    }
 
+    // The stored range always starts and ends with a non-zero word, so equal
+    // bitvectors have equal representations.
     bool operator==(const BitVector& other) const {
-      return vector_ == other.vector_;
-    }
-    bool operator!=(const BitVector& other) const {
-      return vector_ != other.vector_;
+      return first_word_ == other.first_word_ && vector_ == other.vector_;
     }
+    bool operator!=(const BitVector& other) const { return !(*this == other); }
 
    private:
     using Word = uint64;
     static constexpr size_t kBits = 64;
 
+    // Extends the stored range of words to include [begin, end).
+    void Cover(size_t begin, size_t end) {
+      if (vector_.empty()) {
+        first_word_ = begin;
+        vector_.assign(end - begin, 0);
+        return;
+      }
+      if (begin < first_word_) {
+        vector_.insert(vector_.begin(), first_word_ - begin, 0);
+        first_word_ = begin;
+      }
+      if (end > first_word_ + vector_.size()) {
+        vector_.resize(end - first_word_, 0);
+      }
+    }
+
     // Number of bits in the bitvector.
     size_t size_;
 
+    // Index of the word stored in vector_[0].
+    size_t first_word_ = 0;
     std::vector<Word> vector_;
   };
 
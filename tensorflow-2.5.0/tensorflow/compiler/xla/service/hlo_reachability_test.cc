@@ -237,6 +237,39 @@ TEST_F(HloReachabilityTest, ReplaceInstructions) {
   EXPECT_TRUE(reachability->IsReachable(p0, fusion));
 }
 
+TEST_F(HloReachabilityTest, IndependentChains) {
+  // Two chains which are long enough to span several words of the bit vectors,
+  // joined at the root.
+  const int kChainLength = 200;
+  const Shape r0f32 = ShapeUtil::MakeShape(F32, {});
+  auto builder = HloComputation::Builder(TestName());
+  std::vector<HloInstruction*> chains[2];
+  for (int i = 0; i < 2; ++i) {
+    chains[i].push_back(builder.AddInstruction(
+        HloInstruction::CreateParameter(i, r0f32, absl::StrCat("p", i))));
+    for (int j = 1; j < kChainLength; ++j) {
+      chains[i].push_back(builder.AddInstruction(HloInstruction::CreateUnary(
+          r0f32, HloOpcode::kNegate, chains[i].back())));
+    }
+  }
+  auto root = builder.AddInstruction(HloInstruction::CreateBinary(
+      r0f32, HloOpcode::kAdd, chains[0].back(), chains[1].back()));
+  auto module = CreateNewVerifiedModule();
+  auto computation = module->AddEntryComputation(builder.Build());
+
+  auto reachability = HloReachabilityMap::Build(computation);
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_TRUE(reachability->IsReachable(chains[i].front(), chains[i].back()));
+    EXPECT_FALSE(
+        reachability->IsReachable(chains[i].back(), chains[i].front()));
+    EXPECT_FALSE(
+        reachability->IsReachable(chains[i].front(), chains[1 - i].back()));
+    EXPECT_FALSE(reachability->IsConnected(chains[i][kChainLength / 2],
+                                           chains[1 - i][kChainLength / 2]));
+    EXPECT_TRUE(reachability->IsReachable(chains[i].front(), root));
+  }
+}
+
 }  // namespace
 
 }  // namespace xla
@@ -2895,8 +2895,9 @@ Status SpmdPartitioningVisitor::HandleWhile(HloInstruction* hlo) {
                          .status());
   SetPartitionedHlo(hlo, [&] {
     return b_.AddInstruction(HloInstruction::CreateWhile(
-        MakePartitionedShape(hlo->shape(), sharding), hlo->while_condition(),
-        hlo->while_body(),
+        MakePartitionedShape(hlo->shape(), sharding),
+        partitioner_->GetPartitionedComputation(hlo->while_condition()),
+        partitioner_->GetPartitionedComputation(hlo->while_body()),
         GetPartitionedHlo(hlo->operand(0)).Reshard(sharding).hlo()));
   });
   return Status::OK();
@@ -2916,12 +2917,15 @@ Status SpmdPartitioningVisitor::HandleConditional(HloInstruction* hlo) {
 
   // The root of the branch computations must follow the sharding of the
   // conditional instruction.
+  std::vector<HloComputation*> branch_computations;
   for (int64 i = 0; i < hlo->branch_count(); ++i) {
     HloComputation* computation = hlo->branch_computation(i);
     TF_RETURN_IF_ERROR(partitioner_
                            ->PartitionComputation(computation, hlo->sharding(),
                                                   next_channel_id_, logger_)
                            .status());
+    branch_computations.push_back(
+        partitioner_->GetPartitionedComputation(computation));
   }
 
   // We replicate the predicate of the conditional (the first operand) so that
@@ -2932,7 +2936,7 @@ Status SpmdPartitioningVisitor::HandleConditional(HloInstruction* hlo) {
         GetPartitionedHlo(hlo->operand(0))
             .Reshard(HloSharding::Replicate())
             .hlo(),
-        hlo->called_computations(), branch_args));
+        branch_computations, branch_args));
   });
   return Status::OK();
 }
@@ -3436,10 +3440,9 @@ StatusOr<bool> SpmdPartitioningVisitor::DoPartition(
   TF_RETURN_IF_ERROR(
       DoCodeMotionForWindowedDotGeneralLoops(new_computation, options));
 
-  // Replace the original computation with the new SPMD computation.
-  std::unordered_map<HloComputation*, HloComputation*> replacement;
-  replacement[computation] = new_computation;
-  module->ReplaceComputations(replacement);
+  // The original computation is replaced with the new SPMD computation once
+  // the whole module has been partitioned.
+  partitioner_->AddPartitionedComputation(computation, new_computation);
   return changed_;
 }
 
@@ -3680,6 +3683,17 @@ StatusOr<bool> SpmdPartitioner::PartitionComputation(
   return visitor->DoPartition(computation, root_sharding, options_);
 }
 
+void SpmdPartitioner::AddPartitionedComputation(HloComputation* computation,
+                                                HloComputation* partitioned) {
+  partitioned_computations_[computation] = partitioned;
+}
+
+HloComputation* SpmdPartitioner::GetPartitionedComputation(
+    HloComputation* computation) const {
+  auto it = partitioned_computations_.find(computation);
+  return it == partitioned_computations_.end() ? computation : it->second;
+}
+
 std::unique_ptr<SpmdPartitioningVisitor> SpmdPartitioner::CreateVisitor(
     HloComputation* computation, int64 num_partitions, int64 num_replicas,
     const SPMDCollectiveOpsCreator& collective_ops_creator,
@@ -3722,6 +3736,8 @@ StatusOr<bool> SpmdPartitioner::Run(HloModule* module) {
       PartitionComputation(module->entry_computation(), root_sharding,
                            &next_channel_id, &logger));
   changed |= partition_changed;
+  module->ReplaceComputations(partitioned_computations_);
+  partitioned_computations_.clear();
 
   // For the entry computation, make sure that the root instruction and the
   // parameters preserve their signatures.
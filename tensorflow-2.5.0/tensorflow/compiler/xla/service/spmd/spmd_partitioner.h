@@ -191,15 +191,31 @@ class SpmdPartitioner : public HloModulePass {
         options_(std::move(options)),
         collective_ops_creator_(std::move(collective_ops_creator)) {}
   absl::string_view name() const override { return "spmd-partitioning"; }
+
+  // Partitions the computations of `module` one at a time on the calling
+  // thread. Independent computations are not partitioned concurrently: the
+  // visitor adds computations to the module while it runs and draws collective
+  // channel ids from a single counter, so parallel visitors would race on the
+  // module and make channel ids nondeterministic.
   StatusOr<bool> Run(HloModule* module) override;
 
-  // Transforms the given computation with SPMD instructions, replacing it with
-  // a new computation.
+  // Transforms the given computation with SPMD instructions, creating a new
+  // computation that replaces it. The original computation stays in the module
+  // until Run() swaps in all partitioned computations at once; use
+  // GetPartitionedComputation() to refer to the new one in the meantime.
   StatusOr<bool> PartitionComputation(HloComputation* computation,
                                       const HloSharding& root_sharding,
                                       int64* next_channel_id,
                                       SpmdLogger* logger);
 
+  // Records that `partitioned` is the SPMD replacement of `computation`.
+  void AddPartitionedComputation(HloComputation* computation,
+                                 HloComputation* partitioned);
+
+  // Returns the SPMD replacement of `computation`, or `computation` itself if
+  // it has not been partitioned.
+  HloComputation* GetPartitionedComputation(HloComputation* computation) const;
+
   // Creates all-gather(s) based on HloSharding. Can be overridden to customize.
   // The default uses a single all-gather even if there are multiple sharded
   // dimensions, and adds potential reshapes and transposes to achieve that.
@@ -248,6 +264,12 @@ class SpmdPartitioner : public HloModulePass {
 
   SpmdPartitionerOptions options_;
   SPMDCollectiveOpsCreator collective_ops_creator_;
+
+  // Partitioned computations keyed by the computation they replace. Replacing
+  // computations walks every instruction in the module, so it is done once for
+  // all of them at the end of Run() rather than once per computation.
+  std::unordered_map<HloComputation*, HloComputation*>
+      partitioned_computations_;
 };
 
 // Class describes partition state of the data represented by an HLO created
@@ -0,0 +1,111 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Usage:
+//   populate_gpu_autotune_database --database=path/to/database.pb \
+//     [--input_format=hlo|pb|pbtxt] [--device=0] module1.hlo module2.pb ...
+//
+// Runs the XLA:GPU HLO passes over the given HLO modules on a local GPU, so
+// that every GEMM and convolution in them is autotuned, and writes the
+// results to the database file (an xla.gpu.AutotuneDatabaseProto).  Results
+// already in the database are reused and kept.  Processes compiling with
+// --xla_gpu_autotune_database_path pointed at the file then skip autotuning
+// for these operations.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/compiler/xla/debug_options_flags.h"
+#include "tensorflow/compiler/xla/service/compiler.h"
+#include "tensorflow/compiler/xla/service/gpu/autotune_database.h"
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/platform_util.h"
+#include "tensorflow/compiler/xla/status_macros.h"
+#include "tensorflow/compiler/xla/tools/hlo_module_loader.h"
+#include "tensorflow/core/platform/init_main.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/command_line_flags.h"
+
+namespace xla {
+namespace tools {
+namespace {
+
+Status RealMain(const std::string& database_path,
+                const std::string& input_format, int device_ordinal,
+                const std::vector<std::string>& module_paths) {
+  TF_ASSIGN_OR_RETURN(se::Platform * platform,
+                      PlatformUtil::GetPlatform("gpu"));
+  TF_ASSIGN_OR_RETURN(se::StreamExecutor * executor,
+                      platform->ExecutorForDevice(device_ordinal));
+  TF_ASSIGN_OR_RETURN(Compiler * compiler, Compiler::GetForPlatform(platform));
+
+  gpu::AutotuneDatabase* database = gpu::AutotuneDatabase::Global();
+  for (const std::string& path : module_paths) {
+    TF_ASSIGN_OR_RETURN(
+        std::unique_ptr<HloModule> module,
+        LoadModuleFromFile(path, hlo_module_loader_details::Config(),
+                           input_format, [&](HloModuleConfig* config) {
+                             DebugOptions debug_options =
+                                 config->debug_options();
+                             debug_options.set_xla_gpu_autotune_database_path(
+                                 database_path);
+                             config->set_debug_options(debug_options);
+                           }));
+    TF_RET_CHECK(module->config().debug_options().xla_gpu_autotune_level() >
+                 0)
+        << "Autotuning is disabled by --xla_gpu_autotune_level";
+    const int64 num_results = database->size();
+    TF_RETURN_IF_ERROR(compiler
+                           ->RunHloPasses(std::move(module), executor,
+                                          /*device_allocator=*/nullptr)
+                           .status());
+    LOG(INFO) << path << ": " << database->size() - num_results
+              << " new autotuning results";
+  }
+
+  // Rewrite the file to drop entries that were superseded while appending.
+  return database->Save(database_path);
+}
+
+}  // namespace
+}  // namespace tools
+}  // namespace xla
+
+int main(int argc, char** argv) {
+  std::string database_path;
+  std::string input_format;
+  int device_ordinal = 0;
+  std::vector<tensorflow::Flag> flag_list = {
+      tensorflow::Flag("database", &database_path,
+                       "AutotuneDatabaseProto file to populate."),
+      tensorflow::Flag("input_format", &input_format,
+                       "Format of the HLO modules: hlo, pb or pbtxt. Inferred "
+                       "from the file extension when empty."),
+      tensorflow::Flag("device", &device_ordinal,
+                       "Ordinal of the GPU to autotune on."),
+  };
+  xla::AppendDebugOptionsFlags(&flag_list);
+  const std::string usage = tensorflow::Flags::Usage(argv[0], flag_list);
+  bool parse_ok = tensorflow::Flags::Parse(&argc, argv, flag_list);
+  tensorflow::port::InitMain(usage.c_str(), &argc, &argv);
+  QCHECK(parse_ok && argc > 1) << "\n" << usage;
+  QCHECK(!database_path.empty()) << "--database is required";
+
+  std::vector<std::string> module_paths(argv + 1, argv + argc);
+  TF_CHECK_OK(xla::tools::RealMain(database_path, input_format,
+                                   device_ordinal, module_paths));
+  return 0;
+}
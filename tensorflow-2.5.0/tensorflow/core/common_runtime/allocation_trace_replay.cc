@@ -0,0 +1,156 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/allocation_trace_replay.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env_time.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+
+SubAllocator::Visitor RegionCounter::AllocVisitor() {
+  return [this](void* ptr, int index, size_t num_bytes) {
+    num_regions_allocated_.fetch_add(1);
+    const int64 bytes = region_bytes_.fetch_add(num_bytes) + num_bytes;
+    int64 peak = peak_region_bytes_.load();
+    while (bytes > peak &&
+           !peak_region_bytes_.compare_exchange_weak(peak, bytes)) {
+    }
+  };
+}
+
+SubAllocator::Visitor RegionCounter::FreeVisitor() {
+  return [this](void* ptr, int index, size_t num_bytes) {
+    region_bytes_.fetch_sub(num_bytes);
+  };
+}
+
+std::string AllocationReplayStats::DebugString() const {
+  return strings::StrCat(
+      "Allocations:           ", num_allocs, "\n",
+      "Failed allocations:    ", num_failed_allocs, "\n",
+      "Peak bytes requested:  ", peak_bytes_requested, "\n",
+      "Peak bytes in use:     ", peak_bytes_in_use, "\n",
+      "Regions allocated:     ", num_regions_allocated, "\n",
+      "Peak region bytes:     ", peak_region_bytes, "\n",
+      "Fragmentation:         ", fragmentation, "\n",
+      "Nanos per allocation:  ",
+      num_allocs > 0 ? total_alloc_nanos / num_allocs : 0, "\n",
+      "Nanos per free:        ",
+      num_allocs > 0 ? total_free_nanos / num_allocs : 0, "\n");
+}
+
+namespace {
+
+struct ReplayEvent {
+  int64 sequence;
+  int index;
+  bool is_alloc;
+};
+
+}  // namespace
+
+Status ReplayAllocationTrace(const AllocationTrace& trace, Allocator* allocator,
+                             const RegionCounter* region_counter,
+                             AllocationReplayStats* stats) {
+  const int num_allocations = trace.allocations_size();
+  std::vector<ReplayEvent> events;
+  events.reserve(2 * num_allocations);
+  for (int i = 0; i < num_allocations; ++i) {
+    const AllocationTrace::Allocation& allocation = trace.allocations(i);
+    if (allocation.num_bytes() <= 0) {
+      return errors::InvalidArgument("Allocation ", i, " has invalid size ",
+                                     allocation.num_bytes());
+    }
+    events.push_back({allocation.alloc_sequence(), i, true});
+    if (allocation.free_sequence() != 0) {
+      if (allocation.free_sequence() <= allocation.alloc_sequence()) {
+        return errors::InvalidArgument("Allocation ", i,
+                                       " is freed before it is allocated");
+      }
+      events.push_back({allocation.free_sequence(), i, false});
+    }
+  }
+  std::sort(events.begin(), events.end(),
+            [](const ReplayEvent& a, const ReplayEvent& b) {
+              return a.sequence < b.sequence;
+            });
+
+  *stats = AllocationReplayStats();
+  allocator->ClearStats();
+  std::vector<void*> ptrs(num_allocations, nullptr);
+  int64 bytes_requested = 0;
+  auto deallocate = [&](int index) {
+    const uint64 start_nanos = EnvTime::NowNanos();
+    allocator->DeallocateRaw(ptrs[index]);
+    stats->total_free_nanos += EnvTime::NowNanos() - start_nanos;
+    bytes_requested -= trace.allocations(index).num_bytes();
+    ptrs[index] = nullptr;
+  };
+  for (const ReplayEvent& event : events) {
+    const AllocationTrace::Allocation& allocation =
+        trace.allocations(event.index);
+    if (!event.is_alloc) {
+      if (ptrs[event.index] != nullptr) {
+        deallocate(event.index);
+      }
+      continue;
+    }
+    AllocationAttributes attr;
+    attr.retry_on_failure = false;
+    const size_t alignment =
+        std::max<int64>(allocation.alignment(), Allocator::kAllocatorAlignment);
+    const uint64 start_nanos = EnvTime::NowNanos();
+    void* ptr = allocator->AllocateRaw(alignment, allocation.num_bytes(), attr);
+    stats->total_alloc_nanos += EnvTime::NowNanos() - start_nanos;
+    ++stats->num_allocs;
+    if (ptr == nullptr) {
+      ++stats->num_failed_allocs;
+      continue;
+    }
+    ptrs[event.index] = ptr;
+    bytes_requested += allocation.num_bytes();
+    stats->peak_bytes_requested =
+        std::max(stats->peak_bytes_requested, bytes_requested);
+  }
+
+  absl::optional<AllocatorStats> allocator_stats = allocator->GetStats();
+  if (allocator_stats) {
+    stats->peak_bytes_in_use = allocator_stats->peak_bytes_in_use;
+  }
+  if (region_counter != nullptr) {
+    stats->num_regions_allocated = region_counter->num_regions_allocated();
+    stats->peak_region_bytes = region_counter->peak_region_bytes();
+    if (stats->peak_region_bytes > 0) {
+      stats->fragmentation =
+          1.0 - static_cast<double>(stats->peak_bytes_requested) /
+                    stats->peak_region_bytes;
+    }
+  }
+
+  // Free whatever outlived the trace, so that the allocator can be reused.
+  for (int i = 0; i < num_allocations; ++i) {
+    if (ptrs[i] != nullptr) {
+      deallocate(i);
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace tensorflow
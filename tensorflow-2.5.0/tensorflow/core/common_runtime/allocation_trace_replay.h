@@ -0,0 +1,83 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_ALLOCATION_TRACE_REPLAY_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_ALLOCATION_TRACE_REPLAY_H_
+
+#include <atomic>
+#include <string>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/allocation_trace.pb.h"
+
+namespace tensorflow {
+
+// Counts the regions a SubAllocator hands out, through the alloc and free
+// visitors every SubAllocator accepts. For a BFCAllocator each region
+// allocation corresponds to one call to BFCAllocator::Extend().
+class RegionCounter {
+ public:
+  SubAllocator::Visitor AllocVisitor();
+  SubAllocator::Visitor FreeVisitor();
+
+  int64 num_regions_allocated() const { return num_regions_allocated_; }
+  int64 peak_region_bytes() const { return peak_region_bytes_; }
+
+ private:
+  std::atomic<int64> num_regions_allocated_{0};
+  std::atomic<int64> region_bytes_{0};
+  std::atomic<int64> peak_region_bytes_{0};
+};
+
+struct AllocationReplayStats {
+  int64 num_allocs = 0;
+  // Allocations that the replayed allocator could not satisfy. Their frees
+  // are skipped.
+  int64 num_failed_allocs = 0;
+
+  // The maximum number of bytes requested by live allocations in the trace.
+  int64 peak_bytes_requested = 0;
+
+  // Taken from the allocator's stats and the RegionCounter, if available,
+  // else -1.
+  int64 peak_bytes_in_use = -1;
+  int64 num_regions_allocated = -1;
+  int64 peak_region_bytes = -1;
+
+  // 1 - peak_bytes_requested / peak_region_bytes: the fraction of the memory
+  // obtained from the device that never held requested bytes at the peak.
+  // -1 without a RegionCounter.
+  double fragmentation = -1;
+
+  // Time spent inside AllocateRaw and DeallocateRaw.
+  int64 total_alloc_nanos = 0;
+  int64 total_free_nanos = 0;
+
+  std::string DebugString() const;
+};
+
+// Replays the allocations in `trace` against `allocator` from a single
+// thread, in the order in which the calls were recorded. Memory that was
+// never freed in the trace is freed at the end. `region_counter` may be
+// nullptr; otherwise it must be attached to the SubAllocator of `allocator`.
+Status ReplayAllocationTrace(const AllocationTrace& trace, Allocator* allocator,
+                             const RegionCounter* region_counter,
+                             AllocationReplayStats* stats);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_ALLOCATION_TRACE_REPLAY_H_
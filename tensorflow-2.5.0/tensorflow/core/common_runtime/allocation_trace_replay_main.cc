@@ -0,0 +1,170 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Replays an AllocationTrace recorded with RecordingAllocator against an
+// allocator and prints fragmentation, peak memory, region (Extend()) counts
+// and the time spent per allocation.
+//
+// Usage, with the binary built from
+// //tensorflow/core/common_runtime:replay_allocation_trace:
+//   replay_allocation_trace --trace=/tmp/step.pb --allocator=bfc
+//
+// With --allocator=gpu the allocator returned by GPUProcessState for GPU 0 is
+// used, so the usual TF_GPU_ALLOCATOR=cuda_malloc_async and
+// GPUOptions.Experimental settings select the implementation under test.
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/allocation_trace_replay.h"
+#include "tensorflow/core/common_runtime/bfc_allocator.h"
+#include "tensorflow/core/common_runtime/pool_allocator.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/init_main.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/numa.h"
+#include "tensorflow/core/protobuf/allocation_trace.pb.h"
+#include "tensorflow/core/util/command_line_flags.h"
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#include "tensorflow/core/common_runtime/gpu/gpu_id.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_id_manager.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+namespace tensorflow {
+namespace {
+
+struct ReplayFlags {
+  std::string trace;
+  std::string allocator = "bfc";
+  int64 memory_limit_mb = 16 << 10;
+  bool allow_growth = true;
+  int64 small_chunk_cache_mb = 0;
+  int32 iterations = 1;
+};
+
+Status ReplayOnBFC(const AllocationTrace& trace, const ReplayFlags& flags) {
+  for (int i = 0; i < flags.iterations; ++i) {
+    // A fresh allocator per iteration, so that every replay starts from an
+    // empty heap.
+    RegionCounter counter;
+    BFCAllocator allocator(
+        new BasicCPUAllocator(port::kNUMANoAffinity, {counter.AllocVisitor()},
+                              {counter.FreeVisitor()}),
+        flags.memory_limit_mb << 20, flags.allow_growth, "replay_bfc",
+        /*garbage_collection=*/false,
+        /*small_chunk_cache_bytes=*/flags.small_chunk_cache_mb << 20);
+    AllocationReplayStats stats;
+    TF_RETURN_IF_ERROR(
+        ReplayAllocationTrace(trace, &allocator, &counter, &stats));
+    std::cout << "Iteration " << i << ":\n" << stats.DebugString() << "\n";
+  }
+  return Status::OK();
+}
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+Status ReplayOnGPU(const AllocationTrace& trace, const ReplayFlags& flags) {
+  const TfDeviceId tf_device_id(0);
+  TF_RETURN_IF_ERROR(GpuIdManager::InsertTfPlatformDeviceIdPair(
+      tf_device_id, PlatformDeviceId(0)));
+  GPUProcessState* process_state = GPUProcessState::singleton();
+  // Visitors are only invoked by allocators that obtain memory through a
+  // SubAllocator, so the region counts stay at 0 for e.g.
+  // GpuCudaMallocAsyncAllocator.
+  RegionCounter counter;
+  process_state->AddGPUAllocVisitor(process_state->BusIdForGPU(tf_device_id),
+                                    counter.AllocVisitor());
+  GPUOptions options;
+  options.set_allow_growth(flags.allow_growth);
+  options.mutable_experimental()->set_small_allocation_cache_bytes(
+      flags.small_chunk_cache_mb << 20);
+  Allocator* allocator = process_state->GetGPUAllocator(
+      options, tf_device_id, flags.memory_limit_mb << 20, {});
+  if (allocator == nullptr) {
+    return errors::Internal("Could not create the allocator for GPU 0");
+  }
+  // The process-wide allocator cannot be recreated, so later iterations
+  // replay against the memory retained by the earlier ones.
+  for (int i = 0; i < flags.iterations; ++i) {
+    AllocationReplayStats stats;
+    TF_RETURN_IF_ERROR(ReplayAllocationTrace(trace, allocator,
+                                             /*region_counter=*/nullptr,
+                                             &stats));
+    stats.num_regions_allocated = counter.num_regions_allocated();
+    std::cout << "Iteration " << i << " on " << allocator->Name() << ":\n"
+              << stats.DebugString() << "\n";
+  }
+  return Status::OK();
+}
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+Status Replay(const ReplayFlags& flags) {
+  AllocationTrace trace;
+  TF_RETURN_IF_ERROR(
+      ReadTextOrBinaryProto(Env::Default(), flags.trace, &trace));
+  std::cout << "Replaying " << trace.allocations_size()
+            << " allocations recorded on " << trace.allocator_name() << "\n";
+  if (flags.allocator == "bfc") {
+    return ReplayOnBFC(trace, flags);
+  }
+  if (flags.allocator == "gpu") {
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+    return ReplayOnGPU(trace, flags);
+#else
+    return errors::Unimplemented("--allocator=gpu requires a GPU build");
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  }
+  return errors::InvalidArgument("Unknown allocator: ", flags.allocator);
+}
+
+}  // namespace
+}  // namespace tensorflow
+
+int main(int argc, char** argv) {
+  tensorflow::ReplayFlags flags;
+  std::vector<tensorflow::Flag> flag_list = {
+      tensorflow::Flag("trace", &flags.trace,
+                       "Path of an AllocationTrace, in binary or text format"),
+      tensorflow::Flag("allocator", &flags.allocator,
+                       "One of {'bfc', 'gpu'}. 'bfc' replays against a "
+                       "BFCAllocator over host memory, 'gpu' against the "
+                       "allocator GPUProcessState creates for GPU 0."),
+      tensorflow::Flag("memory_limit_mb", &flags.memory_limit_mb,
+                       "Memory limit of the allocator under test"),
+      tensorflow::Flag("allow_growth", &flags.allow_growth,
+                       "Whether the allocator may grow its memory in "
+                       "several regions instead of reserving the limit"),
+      tensorflow::Flag("small_chunk_cache_mb", &flags.small_chunk_cache_mb,
+                       "Size of the BFCAllocator small chunk cache"),
+      tensorflow::Flag("iterations", &flags.iterations,
+                       "Number of times to replay the trace"),
+  };
+  bool parse_result = tensorflow::Flags::Parse(&argc, argv, flag_list);
+  if (!parse_result || flags.trace.empty()) {
+    std::cerr << tensorflow::Flags::Usage(argv[0], flag_list);
+    return -1;
+  }
+  tensorflow::port::InitMain(argv[0], &argc, &argv);
+  tensorflow::Status status = tensorflow::Replay(flags);
+  if (!status.ok()) {
+    LOG(ERROR) << status;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,143 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/allocation_trace_replay.h"
+
+#include <vector>
+
+#include "absl/memory/memory.h"
+
+#include "tensorflow/core/common_runtime/bfc_allocator.h"
+#include "tensorflow/core/common_runtime/pool_allocator.h"
+#include "tensorflow/core/common_runtime/recording_allocator.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/numa.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+std::unique_ptr<BFCAllocator> MakeBFCAllocator(RegionCounter* counter) {
+  SubAllocator* sub_allocator =
+      new BasicCPUAllocator(port::kNUMANoAffinity, {counter->AllocVisitor()},
+                            {counter->FreeVisitor()});
+  return absl::make_unique<BFCAllocator>(sub_allocator, 1 << 30,
+                                         /*allow_growth=*/true, "bfc");
+}
+
+TEST(RecordingAllocatorTest, RecordsAllocationsInOrder) {
+  RegionCounter counter;
+  std::unique_ptr<BFCAllocator> bfc = MakeBFCAllocator(&counter);
+  RecordingAllocator recorder(bfc.get());
+
+  void* p0 = recorder.AllocateRaw(64, 1024);
+  void* p1 = recorder.AllocateRaw(256, 4096);
+  recorder.DeallocateRaw(p0);
+  void* p2 = recorder.AllocateRaw(64, 16);
+
+  AllocationTrace trace = recorder.GetTrace();
+  EXPECT_EQ("bfc", trace.allocator_name());
+  ASSERT_EQ(3, trace.allocations_size());
+  EXPECT_EQ(1024, trace.allocations(0).num_bytes());
+  EXPECT_EQ(64, trace.allocations(0).alignment());
+  EXPECT_EQ(1, trace.allocations(0).alloc_sequence());
+  EXPECT_EQ(3, trace.allocations(0).free_sequence());
+  EXPECT_EQ(4096, trace.allocations(1).num_bytes());
+  EXPECT_EQ(256, trace.allocations(1).alignment());
+  EXPECT_EQ(2, trace.allocations(1).alloc_sequence());
+  EXPECT_EQ(0, trace.allocations(1).free_sequence());
+  EXPECT_EQ(4, trace.allocations(2).alloc_sequence());
+
+  recorder.DeallocateRaw(p1);
+  recorder.DeallocateRaw(p2);
+  trace = recorder.GetTrace();
+  EXPECT_EQ(5, trace.allocations(1).free_sequence());
+  EXPECT_EQ(6, trace.allocations(2).free_sequence());
+
+  recorder.ClearTrace();
+  EXPECT_EQ(0, recorder.GetTrace().allocations_size());
+}
+
+TEST(AllocationTraceReplayTest, ReplaysRecordedTrace) {
+  AllocationTrace trace;
+  {
+    RegionCounter counter;
+    std::unique_ptr<BFCAllocator> bfc = MakeBFCAllocator(&counter);
+    RecordingAllocator recorder(bfc.get());
+    std::vector<void*> live;
+    for (int i = 0; i < 100; ++i) {
+      live.push_back(recorder.AllocateRaw(64, 256 * (i + 1)));
+      if (i % 3 == 0) {
+        recorder.DeallocateRaw(live[i / 2]);
+        live[i / 2] = nullptr;
+      }
+    }
+    for (void* ptr : live) {
+      recorder.DeallocateRaw(ptr);
+    }
+    trace = recorder.GetTrace();
+  }
+  ASSERT_EQ(100, trace.allocations_size());
+
+  RegionCounter counter;
+  std::unique_ptr<BFCAllocator> bfc = MakeBFCAllocator(&counter);
+  AllocationReplayStats stats;
+  TF_ASSERT_OK(ReplayAllocationTrace(trace, bfc.get(), &counter, &stats));
+  EXPECT_EQ(100, stats.num_allocs);
+  EXPECT_EQ(0, stats.num_failed_allocs);
+  EXPECT_GT(stats.peak_bytes_requested, 0);
+  EXPECT_GE(stats.peak_bytes_in_use, stats.peak_bytes_requested);
+  EXPECT_GE(stats.num_regions_allocated, 1);
+  EXPECT_EQ(counter.num_regions_allocated(), stats.num_regions_allocated);
+  EXPECT_GE(stats.peak_region_bytes, stats.peak_bytes_in_use);
+  EXPECT_GE(stats.fragmentation, 0.0);
+  EXPECT_LT(stats.fragmentation, 1.0);
+  // Everything was handed back to the allocator.
+  EXPECT_EQ(0, bfc->GetStats()->bytes_in_use);
+}
+
+TEST(AllocationTraceReplayTest, FreesLiveAllocationsAtEnd) {
+  AllocationTrace trace;
+  AllocationTrace::Allocation* allocation = trace.add_allocations();
+  allocation->set_num_bytes(1 << 20);
+  allocation->set_alignment(64);
+  allocation->set_alloc_sequence(1);
+
+  RegionCounter counter;
+  std::unique_ptr<BFCAllocator> bfc = MakeBFCAllocator(&counter);
+  AllocationReplayStats stats;
+  TF_ASSERT_OK(ReplayAllocationTrace(trace, bfc.get(), &counter, &stats));
+  EXPECT_EQ(1, stats.num_allocs);
+  EXPECT_EQ(1 << 20, stats.peak_bytes_requested);
+  EXPECT_EQ(0, bfc->GetStats()->bytes_in_use);
+}
+
+TEST(AllocationTraceReplayTest, RejectsInconsistentTrace) {
+  AllocationTrace trace;
+  AllocationTrace::Allocation* allocation = trace.add_allocations();
+  allocation->set_num_bytes(64);
+  allocation->set_alignment(64);
+  allocation->set_alloc_sequence(2);
+  allocation->set_free_sequence(1);
+
+  RegionCounter counter;
+  std::unique_ptr<BFCAllocator> bfc = MakeBFCAllocator(&counter);
+  AllocationReplayStats stats;
+  EXPECT_FALSE(
+      ReplayAllocationTrace(trace, bfc.get(), &counter, &stats).ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -36,16 +36,21 @@ namespace tensorflow {
 
 constexpr BFCAllocator::ChunkHandle BFCAllocator::kInvalidChunkHandle;
 constexpr uint64 BFCAllocator::kMemDebugHistorySize;
+constexpr int BFCAllocator::kNumSmallChunkClasses;
+constexpr size_t BFCAllocator::kMaxSmallChunkCacheSize;
 
 BFCAllocator::BFCAllocator(SubAllocator* sub_allocator, size_t total_memory,
                            bool allow_growth, const string& name,
-                           bool garbage_collection)
+                           bool garbage_collection,
+                           size_t small_chunk_cache_bytes)
     : garbage_collection_(garbage_collection),
       coalesce_regions_(sub_allocator->SupportsCoalescing()),
       sub_allocator_(sub_allocator),
       name_(name),
       free_chunks_list_(kInvalidChunkHandle),
-      next_allocation_id_(1) {
+      next_allocation_id_(1),
+      small_chunk_cache_bytes_per_class_(small_chunk_cache_bytes /
+                                         kNumSmallChunkClasses) {
   if (allow_growth) {
     // 2MiB smallest initial allocation, unless total memory available
     // is less.
@@ -253,6 +258,27 @@ void* BFCAllocator::AllocateRawInternalWithRetry(
 void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
                                 const AllocationAttributes& allocation_attr) {
   VLOG(1) << "AllocateRaw " << Name() << "  " << num_bytes;
+  const int size_class = SmallChunkClassForSize(num_bytes);
+  if (size_class >= 0 && allocation_attr.freed_by_func == nullptr) {
+    void* ptr = AllocateFromSmallChunkCache(size_class);
+    if (ptr != nullptr) {
+      return ptr;
+    }
+    // Allocate the whole size class so that the chunk can serve any later
+    // request of the same class once it is cached.
+    num_bytes = kMinAllocationSize << size_class;
+  }
+  void* ptr = AllocateRawNoCache(unused_alignment, num_bytes, allocation_attr);
+  if (ptr != nullptr && size_class >= 0 &&
+      allocation_attr.freed_by_func == nullptr) {
+    RegisterSmallChunk(ptr, size_class);
+  }
+  return ptr;
+}
+
+void* BFCAllocator::AllocateRawNoCache(
+    size_t unused_alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
   if (!allocation_attr.retry_on_failure) {
     // Return immediately upon the first failure if this is for allocating an
     // optional scratch space.
@@ -421,6 +447,16 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
     }
   }
 
+  // Chunks parked in the small chunk cache may be what stands between this
+  // request and a fit, so give them back to the bins before going further.
+  if (FlushSmallChunkCache()) {
+    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
+    if (ptr != nullptr) {
+      AddTraceMe("MemoryAllocation", ptr);
+      return ptr;
+    }
+  }
+
   if ((freed_before == 0) && (!timestamped_chunks_.empty())) {
     // We're unable to satisfy an allocation request without a specific
     // timestamp requirement.  Rather than fail, try merging any held-out
@@ -647,8 +683,14 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
     VLOG(2) << "tried to deallocate nullptr";
     return;
   }
+  if (DeallocateToSmallChunkCache(ptr)) {
+    return;
+  }
   mutex_lock l(lock_);
+  FreeChunkPtr(ptr);
+}
 
+void BFCAllocator::FreeChunkPtr(void* ptr) {
   // Find the chunk from the ptr.
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle);
@@ -677,6 +719,117 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
   }
 }
 
+int BFCAllocator::SmallChunkClassForSize(size_t num_bytes) const {
+  if (small_chunk_cache_bytes_per_class_ == 0 || timing_counter_ != nullptr ||
+      num_bytes == 0 || num_bytes > kMaxSmallChunkCacheSize) {
+    return -1;
+  }
+  int size_class = 0;
+  while ((kMinAllocationSize << size_class) < num_bytes) {
+    ++size_class;
+  }
+  return size_class;
+}
+
+void* BFCAllocator::AllocateFromSmallChunkCache(int size_class) {
+  SmallChunkClass& cache = small_chunk_classes_[size_class];
+  void* ptr = nullptr;
+  {
+    mutex_lock l(cache.mu);
+    if (!cache.free_ptrs.empty()) {
+      ptr = cache.free_ptrs.back();
+      cache.free_ptrs.pop_back();
+    }
+  }
+  if (ptr == nullptr) {
+    small_chunk_cache_misses_.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+  small_chunk_cache_hits_.fetch_add(1, std::memory_order_relaxed);
+  bytes_in_small_chunk_cache_.fetch_sub(kMinAllocationSize << size_class,
+                                        std::memory_order_relaxed);
+  return ptr;
+}
+
+namespace {
+
+int SmallChunkStripeFor(const void* ptr, int num_stripes) {
+  // Chunks are at least kMinAllocationSize apart, so skip the low bits.
+  return (reinterpret_cast<std::uintptr_t>(ptr) >> 8) % num_stripes;
+}
+
+}  // namespace
+
+void BFCAllocator::RegisterSmallChunk(void* ptr, int size_class) {
+  SmallChunkStripe& stripe =
+      small_chunk_stripes_[SmallChunkStripeFor(ptr, kNumSmallChunkStripes)];
+  mutex_lock l(stripe.mu);
+  stripe.size_class[ptr] = size_class;
+}
+
+bool BFCAllocator::DeallocateToSmallChunkCache(void* ptr) {
+  if (small_chunk_cache_bytes_per_class_ == 0) {
+    return false;
+  }
+  SmallChunkStripe& stripe =
+      small_chunk_stripes_[SmallChunkStripeFor(ptr, kNumSmallChunkStripes)];
+  int size_class;
+  {
+    mutex_lock l(stripe.mu);
+    auto it = stripe.size_class.find(ptr);
+    if (it == stripe.size_class.end()) {
+      return false;
+    }
+    size_class = it->second;
+  }
+  const size_t class_bytes = kMinAllocationSize << size_class;
+  SmallChunkClass& cache = small_chunk_classes_[size_class];
+  {
+    mutex_lock l(cache.mu);
+    if (timing_counter_ == nullptr &&
+        (cache.free_ptrs.size() + 1) * class_bytes <=
+            small_chunk_cache_bytes_per_class_) {
+      cache.free_ptrs.push_back(ptr);
+      bytes_in_small_chunk_cache_.fetch_add(class_bytes,
+                                            std::memory_order_relaxed);
+      return true;
+    }
+  }
+  // The size class is full, so this chunk goes back to the bins and must no
+  // longer be recognized as a cached chunk.
+  mutex_lock l(stripe.mu);
+  stripe.size_class.erase(ptr);
+  return false;
+}
+
+bool BFCAllocator::FlushSmallChunkCache() {
+  bool freed = false;
+  for (int size_class = 0; size_class < kNumSmallChunkClasses; ++size_class) {
+    std::vector<void*> free_ptrs;
+    {
+      SmallChunkClass& cache = small_chunk_classes_[size_class];
+      mutex_lock l(cache.mu);
+      free_ptrs.swap(cache.free_ptrs);
+    }
+    for (void* ptr : free_ptrs) {
+      SmallChunkStripe& stripe = small_chunk_stripes_[SmallChunkStripeFor(
+          ptr, kNumSmallChunkStripes)];
+      {
+        mutex_lock l(stripe.mu);
+        stripe.size_class.erase(ptr);
+      }
+      bytes_in_small_chunk_cache_.fetch_sub(kMinAllocationSize << size_class,
+                                            std::memory_order_relaxed);
+      FreeChunkPtr(ptr);
+      freed = true;
+    }
+  }
+  if (freed) {
+    VLOG(1) << "Flushed the small chunk cache of " << Name();
+  }
+  return freed;
+}
+
 // Merges h1 and h2 when Chunk(h1)->next is h2 and Chunk(h2)->prev is c1.
 // We merge Chunk(h2) into Chunk(h1).
 void BFCAllocator::Merge(BFCAllocator::ChunkHandle h1,
@@ -1153,8 +1306,18 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
 }
 
 absl::optional<AllocatorStats> BFCAllocator::GetStats() {
-  mutex_lock l(lock_);
-  return stats_;
+  AllocatorStats stats;
+  {
+    mutex_lock l(lock_);
+    stats = stats_;
+  }
+  stats.small_chunk_cache_hits =
+      small_chunk_cache_hits_.load(std::memory_order_relaxed);
+  stats.small_chunk_cache_misses =
+      small_chunk_cache_misses_.load(std::memory_order_relaxed);
+  stats.bytes_in_small_chunk_cache =
+      bytes_in_small_chunk_cache_.load(std::memory_order_relaxed);
+  return stats;
 }
 
 void BFCAllocator::ClearStats() {
@@ -1162,6 +1325,8 @@ void BFCAllocator::ClearStats() {
   stats_.num_allocs = 0;
   stats_.peak_bytes_in_use = stats_.bytes_in_use;
   stats_.largest_alloc_size = 0;
+  small_chunk_cache_hits_ = 0;
+  small_chunk_cache_misses_ = 0;
 }
 
 std::array<BFCAllocator::BinDebugInfo, BFCAllocator::kNumBins>
@@ -23,6 +23,7 @@ limitations under the License.
 #include <unordered_map>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/common_runtime/allocator_retry.h"
 #include "tensorflow/core/common_runtime/shared_counter.h"
@@ -46,12 +47,20 @@ class MemoryDump;
 // coalescing.  One assumption we make is that the process using this
 // allocator owns pretty much all of the memory, and that nearly
 // all requests to allocate memory go through this interface.
+//
+// If small_chunk_cache_bytes > 0, freed chunks of up to
+// kMaxSmallChunkCacheSize bytes are kept on per-size-class free lists (up to
+// small_chunk_cache_bytes in total) and handed out again for allocations of
+// the same size class without taking the allocator lock. The cached chunks
+// stay allocated from the point of view of the bins and are flushed back to
+// them when an allocation cannot otherwise be satisfied.
 class BFCAllocator : public Allocator {
  public:
   // Takes ownership of sub_allocator.
   BFCAllocator(SubAllocator* sub_allocator, size_t total_memory,
                bool allow_growth, const string& name,
-               bool garbage_collection = false);
+               bool garbage_collection = false,
+               size_t small_chunk_cache_bytes = 0);
   ~BFCAllocator() override;
 
   string Name() override { return name_; }
@@ -88,6 +97,10 @@ class BFCAllocator : public Allocator {
  private:
   struct Bin;
 
+  // AllocateRaw without the small chunk cache.
+  void* AllocateRawNoCache(size_t alignment, size_t num_bytes,
+                           const AllocationAttributes& allocation_attr);
+
   void* AllocateRawInternal(size_t alignment, size_t num_bytes,
                             bool dump_log_on_failure,
                             uint64 freed_before_count);
@@ -98,6 +111,28 @@ class BFCAllocator : public Allocator {
 
   void DeallocateRawInternal(void* ptr);
 
+  // Frees the chunk at `ptr` back into the bins.
+  void FreeChunkPtr(void* ptr) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Small chunk cache. Returns the size class that an allocation of
+  // `num_bytes` is served from, or -1 if it bypasses the cache.
+  int SmallChunkClassForSize(size_t num_bytes) const;
+
+  // Returns a cached chunk of size class `size_class`, or nullptr if there is
+  // none. Does not acquire lock_.
+  void* AllocateFromSmallChunkCache(int size_class);
+
+  // Records that `ptr` was allocated from the bins for `size_class`.
+  void RegisterSmallChunk(void* ptr, int size_class);
+
+  // Returns true if `ptr` was parked in the small chunk cache, in which case
+  // it must not be freed into the bins. Does not acquire lock_.
+  bool DeallocateToSmallChunkCache(void* ptr);
+
+  // Returns every cached chunk to the bins. Returns true if any chunk was
+  // freed.
+  bool FlushSmallChunkCache() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // Chunks whose freed_at_count is later than the safe frontier value are kept
   // on a special list and not subject to merging immediately upon being freed.
   //
@@ -605,6 +640,33 @@ class BFCAllocator : public Allocator {
   AllocatorStats stats_ TF_GUARDED_BY(lock_);
   uint64 action_counter_ TF_GUARDED_BY(lock_);
 
+  // Small chunk cache, see the class comment. Size class i holds chunks of
+  // kMinAllocationSize << i bytes.
+  static constexpr int kNumSmallChunkClasses = 8;
+  static constexpr size_t kMaxSmallChunkCacheSize =
+      kMinAllocationSize << (kNumSmallChunkClasses - 1);
+  static constexpr int kNumSmallChunkStripes = 16;
+
+  struct SmallChunkClass {
+    mutex mu;
+    std::vector<void*> free_ptrs TF_GUARDED_BY(mu);
+  };
+
+  // Maps each pointer allocated on behalf of the cache to its size class.
+  // Striped by pointer so that frees of different chunks rarely contend.
+  struct SmallChunkStripe {
+    mutex mu;
+    absl::flat_hash_map<const void*, int> size_class TF_GUARDED_BY(mu);
+  };
+
+  // Upper bound on the bytes parked in each size class; 0 disables the cache.
+  const size_t small_chunk_cache_bytes_per_class_;
+  std::array<SmallChunkClass, kNumSmallChunkClasses> small_chunk_classes_;
+  std::array<SmallChunkStripe, kNumSmallChunkStripes> small_chunk_stripes_;
+  std::atomic<int64> small_chunk_cache_hits_{0};
+  std::atomic<int64> small_chunk_cache_misses_{0};
+  std::atomic<int64> bytes_in_small_chunk_cache_{0};
+
   // The circular buffer used to track memory operation history.
   static constexpr uint64 kMemDebugHistorySize = 4096;
   int64 size_history_[kMemDebugHistorySize];
@@ -26,7 +26,9 @@ namespace tensorflow {
 // A fake SubAllocator to test the performance of BFCAllocator.
 class FakeSubAllocator : public SubAllocator {
  public:
-  FakeSubAllocator() : SubAllocator({}, {}), alloc_counter_(0) {}
+  // The counter starts at 1 so that the first region is not mistaken for a
+  // failed allocation.
+  FakeSubAllocator() : SubAllocator({}, {}), alloc_counter_(1) {}
   ~FakeSubAllocator() override {}
 
   // Alloc and Free functions are implemented as very cheap operations, so that
@@ -84,4 +86,80 @@ BENCHMARK(BM_Allocator)
     ->ArgPair(1000, 256)
     ->ArgPair(10000, 256);
 
+// Allocates and frees batches of small, short lived buffers, with the small
+// chunk cache sized to state.range(0) bytes.
+void BM_SmallAllocations(::testing::benchmark::State& state) {
+  constexpr int kAllocSize = 1 << 10;
+  constexpr int kShortLivedObjects = 256;
+
+  FakeSubAllocator* sub_allocator = new FakeSubAllocator;
+  BFCAllocator bfc_allocator(sub_allocator, 1 << 30, false, "GPU_0_bfc",
+                             /*garbage_collection=*/false,
+                             /*small_chunk_cache_bytes=*/state.range(0));
+
+  std::vector<void*> short_lived(kShortLivedObjects);
+  for (auto _ : state) {
+    for (int i = 0; i < kShortLivedObjects; i++) {
+      short_lived[i] = bfc_allocator.AllocateRaw(1, kAllocSize);
+    }
+    for (int i = 0; i < kShortLivedObjects; i++) {
+      bfc_allocator.DeallocateRaw(short_lived[i]);
+    }
+  }
+}
+BENCHMARK(BM_SmallAllocations)->Arg(0)->Arg(1 << 20);
+
+TEST(BFCAllocatorTest, SmallChunkCacheReusesFreedChunks) {
+  BFCAllocator bfc_allocator(new FakeSubAllocator, 1 << 24, false, "bfc",
+                             /*garbage_collection=*/false,
+                             /*small_chunk_cache_bytes=*/1 << 20);
+
+  void* p = bfc_allocator.AllocateRaw(1, 1000);
+  ASSERT_NE(p, nullptr);
+  EXPECT_EQ(1024, bfc_allocator.RequestedSize(p));
+  bfc_allocator.DeallocateRaw(p);
+  EXPECT_EQ(1024, bfc_allocator.GetStats()->bytes_in_small_chunk_cache);
+
+  // Any request of the same size class is served by the cached chunk.
+  void* q = bfc_allocator.AllocateRaw(1, 900);
+  EXPECT_EQ(p, q);
+  bfc_allocator.DeallocateRaw(q);
+
+  // Larger requests bypass the cache.
+  void* r = bfc_allocator.AllocateRaw(1, 1 << 20);
+  ASSERT_NE(r, nullptr);
+  bfc_allocator.DeallocateRaw(r);
+
+  absl::optional<AllocatorStats> stats = bfc_allocator.GetStats();
+  EXPECT_EQ(1, stats->small_chunk_cache_hits);
+  EXPECT_EQ(1, stats->small_chunk_cache_misses);
+  EXPECT_EQ(1024, stats->bytes_in_small_chunk_cache);
+}
+
+TEST(BFCAllocatorTest, SmallChunkCacheFlushesUnderMemoryPressure) {
+  constexpr int kNumChunks = 64;
+  constexpr int kChunkSize = 1 << 10;
+  BFCAllocator bfc_allocator(new FakeSubAllocator, kNumChunks * kChunkSize,
+                             false, "bfc", /*garbage_collection=*/false,
+                             /*small_chunk_cache_bytes=*/1 << 20);
+
+  // Fill the whole memory with small chunks, then park them in the cache.
+  std::vector<void*> ptrs(kNumChunks);
+  for (int i = 0; i < kNumChunks; i++) {
+    ptrs[i] = bfc_allocator.AllocateRaw(1, kChunkSize);
+    ASSERT_NE(ptrs[i], nullptr);
+  }
+  for (void* ptr : ptrs) {
+    bfc_allocator.DeallocateRaw(ptr);
+  }
+  EXPECT_EQ(kNumChunks * kChunkSize,
+            bfc_allocator.GetStats()->bytes_in_small_chunk_cache);
+
+  // A request of another size class only fits once the cache is flushed.
+  void* p = bfc_allocator.AllocateRaw(1, 32 * kChunkSize);
+  EXPECT_NE(p, nullptr);
+  EXPECT_EQ(0, bfc_allocator.GetStats()->bytes_in_small_chunk_cache);
+  bfc_allocator.DeallocateRaw(p);
+}
+
 }  // namespace tensorflow
@@ -678,6 +678,15 @@ void CollectiveParamResolverLocal::AssignCollectiveType(CollectiveParams* cp) {
       CollectiveRegistry::LookupParamResolverInstance("NcclReduce", &col_impl)
           .ok();
   cp->instance.impl_details.collective_name = GetCollectiveName(cp, use_nccl);
+  // The hierarchical all-reduce keeps most traffic within tasks, which helps
+  // when the tasks of a CPU group are on different hosts.  It is only chosen
+  // for groups where every task has the same number of devices.
+  if (!use_nccl && cp->instance.type == REDUCTION_COLLECTIVE &&
+      cp->instance.impl_details.communication_hint == "hierarchical" &&
+      cp->group.device_type == DEVICE_CPU && cp->group.num_tasks > 1 &&
+      cp->group.same_num_devices_per_task) {
+    cp->instance.impl_details.collective_name = "HierarchicalReduce";
+  }
   VLOG(1) << "AssignCollectiveType "
           << cp->instance.impl_details.collective_name;
 }
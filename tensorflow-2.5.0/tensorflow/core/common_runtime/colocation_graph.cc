@@ -45,8 +45,11 @@ limitations under the License.
 #include "tensorflow/core/graph/graph_node_util.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/util/device_name_utils.h"
 #include "tensorflow/core/util/dump_graph.h"
 #include "tensorflow/core/util/port.h"
@@ -1298,10 +1301,42 @@ Status ColocationGraph::GetDevicesForNode(
 }
 
 Status ColocationGraph::InitializeMembers() {
+  // Looking up the supported device types of a node dominates this step, and
+  // each member is initialized independently of the others, so large graphs
+  // initialize their members concurrently.
+  constexpr int kMinNodesForParallelInitialization = 4096;
+  std::vector<Node*> nodes;
+  nodes.reserve(graph_.num_op_nodes());
   for (Node* node : graph_.op_nodes()) {
-    Status status = InitializeMember(*node, &members_[node->id()]);
-    if (!status.ok()) {
-      return AttachDef(status, *node);
+    nodes.push_back(node);
+  }
+  const int num_nodes = nodes.size();
+  const int num_threads = std::min(port::MaxParallelism(), num_nodes / 1024);
+  if (num_nodes < kMinNodesForParallelInitialization || num_threads <= 1) {
+    for (Node* node : nodes) {
+      Status status = InitializeMember(*node, &members_[node->id()]);
+      if (!status.ok()) {
+        return AttachDef(status, *node);
+      }
+    }
+    return Status::OK();
+  }
+
+  std::vector<Status> statuses(num_nodes);
+  {
+    thread::ThreadPool pool(Env::Default(), "colocation_graph", num_threads);
+    // A rough per-node cost, in cycles, of a kernel registry lookup.
+    constexpr int64 kCostPerNode = 10000;
+    pool.ParallelFor(num_nodes, kCostPerNode, [&](int64 begin, int64 end) {
+      for (int64 i = begin; i < end; ++i) {
+        statuses[i] = InitializeMember(*nodes[i], &members_[nodes[i]->id()]);
+      }
+    });
+  }
+  // Report the same error as initializing the members one by one would.
+  for (int i = 0; i < num_nodes; ++i) {
+    if (!statuses[i].ok()) {
+      return AttachDef(statuses[i], *nodes[i]);
     }
   }
   return Status::OK();
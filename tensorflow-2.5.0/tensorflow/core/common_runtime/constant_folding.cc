@@ -21,6 +21,8 @@ limitations under the License.
 #include <unordered_map>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/executor.h"
 #include "tensorflow/core/common_runtime/function_utils.h"
@@ -29,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
 #include "tensorflow/core/framework/log_memory.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/node_builder.h"
@@ -36,10 +39,14 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/denormal.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/setround.h"
 #include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -585,8 +592,198 @@ bool ReplaceTensorWithConstant(
   return true;
 }
 
+// Returns a hash of the op and attrs of `n`, or 0 if the outputs of `n` must
+// not be cached because they depend on the body of a function, which is not
+// part of the hash.
+uint64 NodeContentHash(const Node& n) {
+  if (n.IsFunctionCall() || n.IsIfNode() || n.IsWhileNode() ||
+      n.IsCaseNode()) {
+    return 0;
+  }
+  NodeDef def = n.def();
+  for (const auto& attr : def.attr()) {
+    if (attr.second.has_func() || attr.second.list().func_size() > 0) {
+      return 0;
+    }
+  }
+  // Names differ between otherwise identical subgraphs, and inputs are hashed
+  // by content in ConstantFoldingCacheKeys().
+  def.clear_name();
+  def.clear_input();
+  def.clear_device();
+  def.clear_experimental_debug_info();
+  string serialized;
+  if (!SerializeToStringDeterministic(def, &serialized)) return 0;
+  return Fingerprint64(serialized);
+}
+
+// Returns the ConstantFoldingCache key of each tensor in `tensors_to_fetch`,
+// i.e. a content hash of the subgraph of `constant_graph` that computes it,
+// or 0 for tensors that must not be cached.
+std::vector<uint64> ConstantFoldingCacheKeys(
+    const Graph& constant_graph,
+    const std::vector<std::pair<NodeAndOutput, NodeAndOutput>>&
+        tensors_to_fetch) {
+  std::vector<Node*> order;
+  GetReversePostOrder(constant_graph, &order);
+  std::unordered_map<const Node*, uint64> node_hashes;
+  for (const Node* n : order) {
+    if (!n->IsOp()) continue;
+    uint64 hash = NodeContentHash(*n);
+    std::vector<std::pair<uint64, int>> data_inputs(n->num_inputs());
+    uint64 control_inputs = 0;
+    for (const Edge* e : n->in_edges()) {
+      if (hash == 0) break;
+      if (!e->src()->IsOp()) continue;
+      const uint64 src_hash = node_hashes[e->src()];
+      if (src_hash == 0) {
+        hash = 0;
+      } else if (e->IsControlEdge()) {
+        // Control inputs are unordered, so combine them commutatively.
+        control_inputs += src_hash;
+      } else {
+        data_inputs[e->dst_input()] = {src_hash, e->src_output()};
+      }
+    }
+    if (hash != 0) {
+      for (const auto& input : data_inputs) {
+        hash = FingerprintCat64(
+            hash, FingerprintCat64(input.first, input.second));
+      }
+      hash = FingerprintCat64(hash, control_inputs);
+      // 0 is reserved for uncacheable nodes.
+      if (hash == 0) hash = 1;
+    }
+    node_hashes[n] = hash;
+  }
+
+  std::vector<uint64> keys;
+  keys.reserve(tensors_to_fetch.size());
+  for (const auto& tensor : tensors_to_fetch) {
+    const uint64 hash = node_hashes[tensor.first.first];
+    keys.push_back(hash == 0 ? 0
+                             : FingerprintCat64(hash, tensor.first.second));
+  }
+  return keys;
+}
+
 }  // namespace
 
+ConstantFoldingCache::ConstantFoldingCache(Env* env, int64 capacity_bytes,
+                                           const string& disk_cache_dir)
+    : env_(env),
+      capacity_bytes_(capacity_bytes),
+      disk_cache_dir_(disk_cache_dir) {}
+
+ConstantFoldingCache* ConstantFoldingCache::Global() {
+  static ConstantFoldingCache* global_cache = []() -> ConstantFoldingCache* {
+    int64 capacity_bytes;
+    Status status = ReadInt64FromEnvVar("TF_CONSTANT_FOLDING_CACHE_BYTES",
+                                        /*default_val=*/0, &capacity_bytes);
+    if (!status.ok()) {
+      LOG(ERROR) << status.error_message();
+      return nullptr;
+    }
+    if (capacity_bytes <= 0) return nullptr;
+    string disk_cache_dir;
+    status = ReadStringFromEnvVar("TF_CONSTANT_FOLDING_CACHE_DIR",
+                                  /*default_val=*/"", &disk_cache_dir);
+    if (!status.ok()) {
+      LOG(ERROR) << status.error_message();
+    }
+    if (!disk_cache_dir.empty()) {
+      status = Env::Default()->RecursivelyCreateDir(disk_cache_dir);
+      if (!status.ok()) {
+        LOG(ERROR) << "Not using the constant folding disk cache: " << status;
+        disk_cache_dir.clear();
+      }
+    }
+    return new ConstantFoldingCache(Env::Default(), capacity_bytes,
+                                    disk_cache_dir);
+  }();
+  return global_cache;
+}
+
+bool ConstantFoldingCache::Lookup(uint64 key, Tensor* tensor) {
+  {
+    mutex_lock l(mu_);
+    auto it = tensors_.find(key);
+    if (it != tensors_.end()) {
+      ++num_hits_;
+      *tensor = it->second;
+      return true;
+    }
+  }
+
+  if (!disk_cache_dir_.empty()) {
+    const string path = DiskCachePath(key);
+    if (env_->FileExists(path).ok()) {
+      TensorProto proto;
+      Status status = ReadBinaryProto(env_, path, &proto);
+      if (status.ok() && tensor->FromProto(proto)) {
+        mutex_lock l(mu_);
+        ++num_hits_;
+        InsertInMemory(key, *tensor);
+        return true;
+      }
+      LOG(WARNING) << "Ignoring unreadable cached constant " << path << ": "
+                   << status;
+    }
+  }
+
+  mutex_lock l(mu_);
+  ++num_misses_;
+  return false;
+}
+
+void ConstantFoldingCache::Insert(uint64 key, const Tensor& tensor) {
+  if (!disk_cache_dir_.empty()) {
+    // Write to a temporary file first, so that concurrent readers, possibly
+    // in other processes, never see a partial entry.
+    const string path = DiskCachePath(key);
+    const string tmp_path = absl::StrCat(path, ".tmp", env_->NowMicros());
+    TensorProto proto;
+    tensor.AsProtoTensorContent(&proto);
+    Status status = WriteBinaryProto(env_, tmp_path, proto);
+    if (status.ok()) status = env_->RenameFile(tmp_path, path);
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to write cached constant " << path << ": "
+                   << status;
+      env_->DeleteFile(tmp_path).IgnoreError();
+    }
+  }
+
+  mutex_lock l(mu_);
+  InsertInMemory(key, tensor);
+}
+
+int64 ConstantFoldingCache::num_hits() const {
+  mutex_lock l(mu_);
+  return num_hits_;
+}
+
+int64 ConstantFoldingCache::num_misses() const {
+  mutex_lock l(mu_);
+  return num_misses_;
+}
+
+string ConstantFoldingCache::DiskCachePath(uint64 key) const {
+  return io::JoinPath(disk_cache_dir_, absl::StrFormat("%016x.tensor", key));
+}
+
+void ConstantFoldingCache::InsertInMemory(uint64 key, const Tensor& tensor) {
+  const int64 bytes = tensor.TotalBytes();
+  if (bytes > capacity_bytes_ || !tensors_.emplace(key, tensor).second) return;
+  insertion_order_.push_back(key);
+  total_bytes_ += bytes;
+  while (total_bytes_ > capacity_bytes_) {
+    auto it = tensors_.find(insertion_order_.front());
+    total_bytes_ -= it->second.TotalBytes();
+    tensors_.erase(it);
+    insertion_order_.pop_front();
+  }
+}
+
 Status ConstantFold(const ConstantFoldingOptions& opts,
                     FunctionLibraryRuntime* function_library, Env* env,
                     const Device* partition_device, Graph* graph,
@@ -650,6 +847,22 @@ Status ConstantFold(const ConstantFoldingOptions& opts,
     tensors_to_replace.push_back(n.second);
   }
 
+  ConstantFoldingCache* cache =
+      opts.cache != nullptr ? opts.cache : ConstantFoldingCache::Global();
+  std::vector<uint64> cache_keys;
+  std::vector<Tensor> cached_outputs;
+  bool all_cached = false;
+  if (cache != nullptr) {
+    cache_keys =
+        ConstantFoldingCacheKeys(*constant_graph, tensors_to_fetch_sorted);
+    cached_outputs.resize(cache_keys.size());
+    all_cached = true;
+    for (size_t c = 0; c < cache_keys.size() && all_cached; ++c) {
+      all_cached = cache_keys[c] != 0 &&
+                   cache->Lookup(cache_keys[c], &cached_outputs[c]);
+    }
+  }
+
   auto graph_runner = std::unique_ptr<GraphRunner>(new GraphRunner(env));
   // Evaluate the constant foldable nodes.
   std::vector<Tensor> outputs;
@@ -659,13 +872,21 @@ Status ConstantFold(const ConstantFoldingOptions& opts,
     graph_runner.reset(nullptr);
   });
 
-  Status s =
-      graph_runner->Run(constant_graph.get(), function_library, {} /* inputs*/,
-                        tensors_to_fetch_names, &outputs);
-  if (!s.ok()) {
-    VLOG(1) << "Could not fetch constants: " << s;
-    *was_mutated = false;
-    return s;
+  if (all_cached) {
+    VLOG(1) << "Reusing " << cached_outputs.size() << " cached constants";
+    outputs = std::move(cached_outputs);
+  } else {
+    Status s = graph_runner->Run(constant_graph.get(), function_library,
+                                 {} /* inputs*/, tensors_to_fetch_names,
+                                 &outputs);
+    if (!s.ok()) {
+      VLOG(1) << "Could not fetch constants: " << s;
+      *was_mutated = false;
+      return s;
+    }
+    for (size_t c = 0; c < cache_keys.size(); ++c) {
+      if (cache_keys[c] != 0) cache->Insert(cache_keys[c], outputs[c]);
+    }
   }
 
   // Fetch the constant tensors and replace the corresponding tensors in the
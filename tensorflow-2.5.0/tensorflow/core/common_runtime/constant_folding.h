@@ -16,11 +16,16 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_CONSTANT_FOLDING_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_CONSTANT_FOLDING_H_
 
+#include <deque>
+#include <unordered_map>
+
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 
 // TODO(skyewm): can this be combined with EvaluateConstantTensor?
 
@@ -31,6 +36,52 @@ namespace tensorflow {
 using ConstantFoldNameGenerator =
     std::function<string(Graph* graph, string old_name)>;
 
+// Memoizes the tensors computed by constant folding, keyed by a content hash
+// of the subgraph that produces each of them, so that identical subgraphs
+// (e.g. when the same model is loaded into several sessions) are only
+// evaluated once per process. The cache is thread-safe.
+class ConstantFoldingCache {
+ public:
+  // Keeps up to `capacity_bytes` of tensor data in memory, evicting the oldest
+  // entries first. If `disk_cache_dir` is non-empty, entries are also written
+  // to and read back from files in that directory.
+  ConstantFoldingCache(Env* env, int64 capacity_bytes,
+                       const string& disk_cache_dir = "");
+
+  // Returns the process-wide cache, or nullptr if the
+  // TF_CONSTANT_FOLDING_CACHE_BYTES environment variable is not positive. The
+  // TF_CONSTANT_FOLDING_CACHE_DIR environment variable optionally sets its
+  // disk cache directory.
+  static ConstantFoldingCache* Global();
+
+  // Sets `*tensor` to the tensor stored for `key` and returns true, or returns
+  // false if there is none.
+  bool Lookup(uint64 key, Tensor* tensor);
+
+  void Insert(uint64 key, const Tensor& tensor);
+
+  int64 num_hits() const;
+  int64 num_misses() const;
+
+ private:
+  string DiskCachePath(uint64 key) const;
+  void InsertInMemory(uint64 key, const Tensor& tensor)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Env* const env_;
+  const int64 capacity_bytes_;
+  const string disk_cache_dir_;
+  mutable mutex mu_;
+  std::unordered_map<uint64, Tensor> tensors_ TF_GUARDED_BY(mu_);
+  // Keys of `tensors_` in insertion order.
+  std::deque<uint64> insertion_order_ TF_GUARDED_BY(mu_);
+  int64 total_bytes_ TF_GUARDED_BY(mu_) = 0;
+  int64 num_hits_ TF_GUARDED_BY(mu_) = 0;
+  int64 num_misses_ TF_GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ConstantFoldingCache);
+};
+
 // Options specific to constant folding optimizations.
 struct ConstantFoldingOptions {
   // If "consider" is not a nullptr, then only constant fold a node "n" if
@@ -49,6 +100,10 @@ struct ConstantFoldingOptions {
   // default id generator that monotonically increases is used if nullptr is
   // passed.
   ConstantFoldNameGenerator generate_new_name = nullptr;
+
+  // If not nullptr, folded tensors are looked up in and added to this cache.
+  // Otherwise ConstantFoldingCache::Global() is used, if enabled.
+  ConstantFoldingCache* cache = nullptr;  // not owned
 };
 
 // Perform constant folding optimization on "graph".
@@ -134,6 +134,32 @@ TEST_F(ConstantFoldingTest, Basic) {
                          {2, 2});
 }
 
+TEST_F(ConstantFoldingTest, Cache) {
+  ConstantFoldingCache cache(Env::Default(), /*capacity_bytes=*/1 << 20);
+  ConstantFoldingOptions opts;
+  opts.cache = &cache;
+  for (int i = 0; i < 2; ++i) {
+    Scope s = Scope::NewRootScope();
+    BuildSimpleGraph(&s);
+    Graph g(OpRegistry::Global());
+    TF_ASSERT_OK(s.ToGraph(&g));
+
+    bool was_mutated;
+    TF_ASSERT_OK(
+        ConstantFold(opts, nullptr, Env::Default(), nullptr, &g, &was_mutated));
+    EXPECT_TRUE(was_mutated);
+
+    std::unordered_map<string, Node*> index = g.BuildNodeNameIndex();
+    ExpectNodeClose<float>(*(index.at("s1")->in_nodes().begin()),
+                           {1.0, 2.0, 3.0, 4.0}, {2, 2});
+    ExpectNodeClose<float>(*(index.at("s2")->in_nodes().begin()),
+                           {2.0, 1.0, 4.0, 3.0}, {2, 2});
+  }
+  // The second graph is identical, so both of its constants are cached.
+  EXPECT_EQ(2, cache.num_hits());
+  EXPECT_EQ(1, cache.num_misses());
+}
+
 // Tests that different node creation ordering creates same graph after constant
 // folding.
 TEST_F(ConstantFoldingTest, DeterministicFolding) {
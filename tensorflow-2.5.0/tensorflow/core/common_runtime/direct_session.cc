@@ -341,11 +341,21 @@ DirectSession::DirectSession(const SessionOptions& options,
   }
   // The default value of sync_on_finish will be flipped soon and this
   // environment variable will be removed as well.
-  const Status status =
+  Status status =
       ReadBoolFromEnvVar("TF_SYNC_ON_FINISH", true, &sync_on_finish_);
   if (!status.ok()) {
     LOG(ERROR) << status.error_message();
   }
+  status = ReadBoolFromEnvVar("TF_EXECUTOR_PLAN_OUTPUT_MEMORY", false,
+                              &plan_output_memory_);
+  if (!status.ok()) {
+    LOG(ERROR) << status.error_message();
+  }
+  status = ReadInt64FromEnvVar("TF_EXECUTOR_STEP_ARENA_MAX_ALLOCATION_SIZE", 0,
+                               &step_arena_max_allocation_size_);
+  if (!status.ok()) {
+    LOG(ERROR) << status.error_message();
+  }
   session_handle_ =
       strings::StrCat("direct", strings::FpToString(random::New64()));
   int devices_added = 0;
@@ -496,7 +506,8 @@ Status DirectSession::RunInternal(
     int64 step_id, const RunOptions& run_options,
     CallFrameInterface* call_frame, ExecutorsAndKeys* executors_and_keys,
     RunMetadata* run_metadata,
-    const thread::ThreadPoolOptions& threadpool_options) {
+    const thread::ThreadPoolOptions& threadpool_options,
+    const std::vector<Tensor>* preallocated_fetches) {
   const uint64 start_time_usecs = options_.env->NowMicros();
   const int64 executor_step_count = executors_and_keys->step_count.fetch_add(1);
   RunState run_state(step_id, &devices_);
@@ -650,7 +661,12 @@ Status DirectSession::RunInternal(
   args.step_container = &run_state.step_container;
   args.sync_on_finish = sync_on_finish_;
   args.user_intra_op_threadpool = threadpool_options.intra_op_threadpool;
+  args.preallocated_retvals = preallocated_fetches;
   args.run_all_kernels_inline = pool == nullptr;
+  if (pool != nullptr && handler_ptr == nullptr &&
+      options_.config.experimental().use_work_stealing_executor()) {
+    args.work_stealing_num_workers = pool->NumThreads();
+  }
 
   const bool do_trace = (run_options.trace_level() > RunOptions::NO_TRACE);
 
@@ -1372,6 +1388,11 @@ Status DirectSession::CreateExecutors(
     params.device = device;
     params.session_metadata = session_metadata;
     params.function_library = lib;
+    params.plan_output_memory =
+        plan_output_memory_ && device->device_type() == DEVICE_CPU;
+    if (device->device_type() == DEVICE_CPU) {
+      params.step_arena_max_allocation_size = step_arena_max_allocation_size_;
+    }
     auto opseg = device->op_segment();
     params.create_kernel =
         [this, lib, opseg](const std::shared_ptr<const NodeProperties>& props,
@@ -1414,7 +1435,9 @@ Status DirectSession::CreateExecutors(
 
     item->executor = nullptr;
     item->device = device;
-    auto executor_type = options_.config.experimental().executor_type();
+    auto executor_type =
+        SelectExecutorType(options_.config.experimental().executor_type(),
+                           device->device_type(), *partition_graph);
     TF_RETURN_IF_ERROR(
         NewExecutor(executor_type, params, *partition_graph, &item->executor));
     if (!options_.config.experimental().disable_output_partition_graphs() ||
@@ -1988,9 +2011,18 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
     LogMemory::RecordStep(step_id, run_state_args.handle);
   }
 
+  // The call frame overwrites the fetch tensors as the outputs are produced,
+  // so the executors hold on to copies of the preallocated ones.
+  std::vector<Tensor> preallocated_fetches;
+  if (fetch_tensors != nullptr &&
+      executors_and_keys->callable_options.fetch_into_preallocated_tensors()) {
+    preallocated_fetches = *fetch_tensors;
+  }
+
   TF_RETURN_IF_ERROR(RunInternal(
       step_id, executors_and_keys->callable_options.run_options(), &call_frame,
-      executors_and_keys.get(), run_metadata, threadpool_options));
+      executors_and_keys.get(), run_metadata, threadpool_options,
+      preallocated_fetches.empty() ? nullptr : &preallocated_fetches));
 
   if (fetch_tensors != nullptr) {
     size_t output_size = 0;
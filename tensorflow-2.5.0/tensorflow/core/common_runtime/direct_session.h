@@ -267,7 +267,8 @@ class DirectSession : public Session {
       int64 step_id, const RunOptions& run_options,
       CallFrameInterface* call_frame, ExecutorsAndKeys* executors_and_keys,
       RunMetadata* run_metadata,
-      const thread::ThreadPoolOptions& threadpool_options);
+      const thread::ThreadPoolOptions& threadpool_options,
+      const std::vector<Tensor>* preallocated_fetches = nullptr);
 
   // Returns whether inter-op execution uses a global pool or the input
   // `run_options` requests being run on inter_op_thread_pool = 0 in case
@@ -355,6 +356,14 @@ class DirectSession : public Session {
   // If true, blocks until device has finished all queued operations in a step.
   bool sync_on_finish_ = true;
 
+  // If true, executors on CPU devices allocate kernel outputs from a memory
+  // arena planned after the first step.
+  bool plan_output_memory_ = false;
+
+  // If positive, executors on CPU devices allocate the kernel outputs and
+  // temporaries of at most that many bytes from an arena owned by the step.
+  int64 step_arena_max_allocation_size_ = 0;
+
   std::vector<std::unique_ptr<FunctionInfo>> functions_
       TF_GUARDED_BY(executor_lock_);
 
@@ -152,6 +152,112 @@ TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork) {
   EXPECT_FLOAT_EQ(5.0, mat(0, 0));
 }
 
+TEST_F(DirectSessionMinusAXTest, RunCallableWithPreallocatedFetches) {
+  Initialize({3, 2, -1, 0});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  CallableOptions callable_options =
+      MakeCallableOptions({}, {y_ + ":0"}, {y_neg_});
+  callable_options.set_fetch_into_preallocated_tensors(true);
+  Session::CallableHandle handle;
+  TF_ASSERT_OK(session->MakeCallable(callable_options, &handle));
+
+  std::vector<Tensor> outputs;
+  outputs.emplace_back(DT_FLOAT, TensorShape({2, 1}));
+  const void* buffer = outputs[0].tensor_data().data();
+  for (int i = 0; i < 2; ++i) {
+    TF_ASSERT_OK(session->RunCallable(handle, {}, &outputs, nullptr));
+    ASSERT_EQ(1, outputs.size());
+    // The output was written into the preallocated buffer.
+    EXPECT_EQ(buffer, outputs[0].tensor_data().data());
+    auto mat = outputs[0].matrix<float>();
+    EXPECT_FLOAT_EQ(5.0, mat(0, 0));
+    EXPECT_FLOAT_EQ(-1.0, mat(1, 0));
+  }
+
+  // A preallocated tensor of the wrong size is not used.
+  outputs[0] = Tensor(DT_FLOAT, TensorShape({3}));
+  buffer = outputs[0].tensor_data().data();
+  TF_ASSERT_OK(session->RunCallable(handle, {}, &outputs, nullptr));
+  EXPECT_NE(buffer, outputs[0].tensor_data().data());
+  EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+  TF_ASSERT_OK(session->ReleaseCallable(handle));
+}
+
+TEST(DirectSessionTest, RunCallableWithPreallocatedStringFetches) {
+  GraphDef def;
+  Graph g(OpRegistry::Global());
+  Tensor value(DT_STRING, TensorShape({2}));
+  value.vec<tstring>()(0) = "a string that does not fit inline";
+  value.vec<tstring>()(1) = "b";
+  Node* identity = test::graph::Identity(&g, test::graph::Constant(&g, value));
+  Tensor float_value(DT_FLOAT, TensorShape({2}));
+  test::FillValues<float>(&float_value, {1.0, 2.0});
+  Node* float_identity =
+      test::graph::Identity(&g, test::graph::Constant(&g, float_value));
+  g.ToGraphDef(&def);
+
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def));
+  CallableOptions callable_options = MakeCallableOptions(
+      {}, {identity->name() + ":0", float_identity->name() + ":0"}, {});
+  callable_options.set_fetch_into_preallocated_tensors(true);
+  Session::CallableHandle handle;
+  TF_ASSERT_OK(session->MakeCallable(callable_options, &handle));
+
+  // The string elements are owned by the tensor of their buffer, so that
+  // buffer is never handed to a kernel. Neither is a buffer of the right size
+  // but the wrong type.
+  std::vector<Tensor> outputs;
+  outputs.emplace_back(DT_STRING, TensorShape({2}));
+  outputs.emplace_back(DT_INT32, TensorShape({2}));
+  const Tensor string_fetch = outputs[0];
+  const Tensor int_fetch = outputs[1];
+  for (int i = 0; i < 2; ++i) {
+    TF_ASSERT_OK(session->RunCallable(handle, {}, &outputs, nullptr));
+    ASSERT_EQ(2, outputs.size());
+    EXPECT_FALSE(outputs[0].SharesBufferWith(string_fetch));
+    test::ExpectTensorEqual<tstring>(value, outputs[0]);
+    EXPECT_FALSE(outputs[1].SharesBufferWith(int_fetch));
+    test::ExpectTensorEqual<float>(float_value, outputs[1]);
+  }
+  EXPECT_EQ("", string_fetch.vec<tstring>()(0));
+  TF_ASSERT_OK(session->ReleaseCallable(handle));
+}
+
+TEST_F(DirectSessionMinusAXTest, RunSubsetOfFetchesWithOptimizedGraphCache) {
+  setenv("TF_OPTIMIZED_GRAPH_CACHE_SIZE", "4", /*overwrite=*/1);
+  Initialize({3, 2, -1, 0});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+  unsetenv("TF_OPTIMIZED_GRAPH_CACHE_SIZE");
+
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session->Run({}, {y_ + ":0", z_ + ":0"}, {}, &outputs));
+  ASSERT_EQ(2, outputs.size());
+  EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+  EXPECT_FLOAT_EQ(-5.0, outputs[1].matrix<float>()(0, 0));
+
+  // These fetches are contained in the previous ones, so the graph optimized
+  // for them is reused and only pruned again.
+  TF_ASSERT_OK(session->Run({}, {z_ + ":0"}, {}, &outputs));
+  ASSERT_EQ(1, outputs.size());
+  EXPECT_FLOAT_EQ(-5.0, outputs[0].matrix<float>()(0, 0));
+  EXPECT_FLOAT_EQ(-1.0, outputs[0].matrix<float>()(1, 0));
+
+  // A feed changes which graph can be reused.
+  Tensor y(DT_FLOAT, TensorShape({2, 1}));
+  test::FillValues<float>(&y, {1, 2});
+  TF_ASSERT_OK(session->Run({{y_, y}}, {z_ + ":0"}, {}, &outputs));
+  ASSERT_EQ(1, outputs.size());
+  EXPECT_FLOAT_EQ(-1.0, outputs[0].matrix<float>()(0, 0));
+  EXPECT_FLOAT_EQ(-2.0, outputs[0].matrix<float>()(1, 0));
+}
+
 TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_Callable) {
   Initialize({3, 2, -1, 0});
   auto session = CreateSession();
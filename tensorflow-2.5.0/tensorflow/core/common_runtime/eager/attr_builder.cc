@@ -237,6 +237,7 @@ const NodeDef& AttrBuilder::BuildNodeDef() {
 void AttrBuilder::CopyAttributes(const AttrBuilder& other) {
   encoded_attrs_.insert(other.encoded_attrs_.begin(),
                         other.encoded_attrs_.end());
+  cached_cache_key_ = absl::nullopt;
 }
 
 Status AttrTypeByName(const AttrTypeMap& m, const string& attr_name,
@@ -278,11 +279,29 @@ inline tensorflow::Fprint128 CacheKeyHelper(StringPiece s, uint64 b) {
   return CacheKeyHelper(s, {b, b});
 }
 
+bool HasSameAttrs(const gtl::FlatMap<string, string>& a,
+                  const gtl::FlatMap<string, string>& b) {
+  if (a.size() != b.size()) return false;
+  for (const auto& p : a) {
+    auto it = b.find(p.first);
+    if (it == b.end() || it->second != p.second) return false;
+  }
+  return true;
+}
+
 }  // namespace
 
 tensorflow::Fprint128 AttrBuilder::CacheKey(const StringPiece device) {
   if (!cached_cache_key_ || device != device_for_cached_cache_key_) {
-    cached_cache_key_ = BuildCacheKeyForDevice(device);
+    // Comparing the attributes is cheaper than fingerprinting them, and ops
+    // are typically built repeatedly with the same attributes.
+    if (previous_cache_key_ && device == previous_device_for_cache_key_ &&
+        op_name_ == previous_op_name_ &&
+        HasSameAttrs(encoded_attrs_, previous_encoded_attrs_)) {
+      cached_cache_key_ = previous_cache_key_;
+    } else {
+      cached_cache_key_ = BuildCacheKeyForDevice(device);
+    }
     device_for_cached_cache_key_ = string(device);
   }
 
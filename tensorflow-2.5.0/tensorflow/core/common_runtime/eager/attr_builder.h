@@ -101,6 +101,13 @@ class AttrBuilder : public AbstractOpAttrs {
   }
 
   void Reset(const char* op) {
+    // Keep the attributes and cache key of the previous op, so that CacheKey
+    // can reuse the key if the same op is built again with the same attributes.
+    previous_op_name_.swap(op_name_);
+    previous_encoded_attrs_.swap(encoded_attrs_);
+    previous_cache_key_ = cached_cache_key_;
+    previous_device_for_cache_key_.swap(device_for_cached_cache_key_);
+
     op_name_ = op;
     num_inputs_ = 0;
     encoded_attrs_.clear();
@@ -205,6 +212,12 @@ class AttrBuilder : public AbstractOpAttrs {
 
   absl::optional<tensorflow::Fprint128> cached_cache_key_;
   string device_for_cached_cache_key_;
+
+  // The state before the last Reset, see CacheKey.
+  string previous_op_name_;
+  gtl::FlatMap<string, string> previous_encoded_attrs_;
+  absl::optional<tensorflow::Fprint128> previous_cache_key_;
+  string previous_device_for_cache_key_;
 };
 
 template <>
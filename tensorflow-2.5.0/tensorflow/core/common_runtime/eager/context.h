@@ -246,6 +246,12 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
 
   void AddKernelToCache(Fprint128 cache_key, KernelAndDevice* kernel);
 
+  // Incremented whenever kernels are removed from the kernel cache, so that
+  // references to cached kernels held elsewhere can be invalidated.
+  int64 KernelCacheGeneration() const {
+    return kernel_cache_generation_.load(std::memory_order_acquire);
+  }
+
   bool LogDevicePlacement() const { return log_device_placement_; }
   void SetLogDevicePlacement(bool enable) override {
     log_device_placement_ = enable;
@@ -623,6 +629,7 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
   std::unordered_map<Fprint128, core::RefCountPtr<KernelAndDevice>,
                      Fprint128Hasher>
       kernel_cache_ TF_GUARDED_BY(cache_mu_);
+  std::atomic<int64> kernel_cache_generation_{0};
   std::unordered_map<string, RegisteredFunction*> registered_functions_
       TF_GUARDED_BY(cache_mu_);
 
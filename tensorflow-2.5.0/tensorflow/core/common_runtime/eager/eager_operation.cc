@@ -38,6 +38,9 @@ void EagerOperation::Clear() {
   inputs_.clear();
   custom_device_tensor_handles_count_ = 0;
   ClearInferenceState();
+  // Don't keep the kernel alive while the operation waits to be reused, e.g.
+  // across a ClearCaches() of the context.
+  last_kernel_.reset();
 }
 
 Status EagerOperation::SetAttrValue(const char* attr_name,
@@ -316,28 +319,38 @@ Status EagerOperation::Reset(
   DCHECK(inputs_.empty());
   ClearInferenceState();
   bool is_function = false;
-  TF_RETURN_IF_ERROR(AttrTypeMapForOp(op, &attr_types_, &is_function));
-
-  // Don't update the device of direct function calls.
-  // Particularly, if the user did not explicitly request any device for this
-  // function, picking a device would result in this device being the default
-  // for nodes inside the function. This is undesirable for multi-device
-  // functions since the not-explicitly-placed nodes inside the body will all
-  // end up on this default device.
-  colocation_exempt_ = is_function;
-  if (!is_function) {
-    const auto& exempt_ops = InputColocationExemptionRegistry::Global()->Get();
-    colocation_exempt_ = exempt_ops.find(op) != exempt_ops.end();
-
-    TF_RETURN_IF_ERROR(OpDefForOp(op, &op_def_));
-  } else if (!remote && !ctx_.FindFunctionByName(op)) {
-    return errors::NotFound(
-        "'", op,
-        "' is neither a type of a primitive operation nor a name "
-        "of a function registered in binary running on ",
-        port::Hostname(),
-        ". Make sure the operation or function is "
-        "registered in the binary running in this process.");
+  // The registry lookups below only depend on the name of a primitive op, so
+  // their results are kept when the operation is reset to the same op again.
+  if (op == last_reset_primitive_op_name_) {
+    op_def_ = last_reset_op_def_;
+  } else {
+    last_reset_primitive_op_name_.clear();
+    TF_RETURN_IF_ERROR(AttrTypeMapForOp(op, &attr_types_, &is_function));
+
+    // Don't update the device of direct function calls.
+    // Particularly, if the user did not explicitly request any device for
+    // this function, picking a device would result in this device being the
+    // default for nodes inside the function. This is undesirable for
+    // multi-device functions since the not-explicitly-placed nodes inside the
+    // body will all end up on this default device.
+    colocation_exempt_ = is_function;
+    if (!is_function) {
+      const auto& exempt_ops =
+          InputColocationExemptionRegistry::Global()->Get();
+      colocation_exempt_ = exempt_ops.find(op) != exempt_ops.end();
+
+      TF_RETURN_IF_ERROR(OpDefForOp(op, &op_def_));
+      last_reset_primitive_op_name_ = op;
+      last_reset_op_def_ = op_def_;
+    } else if (!remote && !ctx_.FindFunctionByName(op)) {
+      return errors::NotFound(
+          "'", op,
+          "' is neither a type of a primitive operation nor a name "
+          "of a function registered in binary running on ",
+          port::Hostname(),
+          ". Make sure the operation or function is "
+          "registered in the binary running in this process.");
+    }
   }
   attrs_.Reset(op);
   stack_trace_.reset();
@@ -349,6 +362,29 @@ Status EagerOperation::Reset(
   return SetDeviceName(device_name);
 }
 
+core::RefCountPtr<KernelAndDevice> EagerOperation::GetLastKernel(
+    const Fprint128& cache_key, int64 kernel_cache_generation) {
+  if (last_kernel_ != nullptr &&
+      last_kernel_cache_generation_ != kernel_cache_generation) {
+    // The kernel may have been removed from the context's cache.
+    last_kernel_.reset();
+  }
+  if (last_kernel_ == nullptr || !(last_kernel_cache_key_ == cache_key)) {
+    return nullptr;
+  }
+  last_kernel_->Ref();
+  return core::RefCountPtr<KernelAndDevice>(last_kernel_.get());
+}
+
+void EagerOperation::SetLastKernel(const Fprint128& cache_key,
+                                   int64 kernel_cache_generation,
+                                   KernelAndDevice* kernel) {
+  kernel->Ref();
+  last_kernel_.reset(kernel);
+  last_kernel_cache_key_ = cache_key;
+  last_kernel_cache_generation_ = kernel_cache_generation;
+}
+
 Status EagerOperation::MaybeInferSingleInputAttrs(
     ImmediateExecutionTensorHandle* handle) {
   if (!op_def_) return Status::OK();
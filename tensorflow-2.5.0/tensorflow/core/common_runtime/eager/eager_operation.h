@@ -151,6 +151,17 @@ class EagerOperation : public ImmediateExecutionOperation {
   AttrBuilder* MutableAttrs() { return &attrs_; }
   const AttrBuilder& Attrs() const { return attrs_; }
 
+  // Returns the kernel this operation was last run with if its cache key was
+  // 'cache_key' and the context's kernel cache has not been cleared since
+  // (i.e. its generation is still 'kernel_cache_generation'), nullptr
+  // otherwise. Saves the context's kernel cache lookup when a caller runs the
+  // same operation repeatedly, e.g. with TFE_Execute. The kernel is released
+  // by Clear() and once the generation changes.
+  core::RefCountPtr<KernelAndDevice> GetLastKernel(
+      const Fprint128& cache_key, int64 kernel_cache_generation);
+  void SetLastKernel(const Fprint128& cache_key, int64 kernel_cache_generation,
+                     KernelAndDevice* kernel);
+
   // TensorHandleInputs and MutableTensorHandleInputs first check that all
   // inputs are TensorHandles, i.e. that there are no custom device inputs. They
   // return a bad status otherwise.
@@ -222,6 +233,17 @@ class EagerOperation : public ImmediateExecutionOperation {
   AttrBuilder attrs_;
   const AttrTypeMap* attr_types_;
 
+  // See GetLastKernel.
+  core::RefCountPtr<KernelAndDevice> last_kernel_;
+  Fprint128 last_kernel_cache_key_;
+  int64 last_kernel_cache_generation_ = -1;
+
+  // The primitive op given to the last successful Reset, or empty if it was a
+  // function, and its definition. Used to skip the op registry lookups when
+  // the operation is reset to the same op.
+  string last_reset_primitive_op_name_;
+  const tensorflow::OpDef* last_reset_op_def_ = nullptr;
+
   // The number of custom device TensorHandle inputs. These inputs need to be
   // processed by CustomDeviceOpHandler first.
   int custom_device_tensor_handles_count_ = 0;
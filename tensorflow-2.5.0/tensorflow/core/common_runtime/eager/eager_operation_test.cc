@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/eager/eager_operation.h"
 
+#include "tensorflow/core/common_runtime/eager/kernel_and_device.h"
+#include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/test.h"
@@ -47,5 +49,62 @@ TEST(EagerOperationTest, DeviceName) {
   ctx->Unref();
 }
 
+TEST(EagerOperationTest, ReuseAcrossClearCachesAndRemoveFunction) {
+  StaticDeviceMgr device_mgr(DeviceFactory::NewDevice(
+      "CPU", {}, "/job:localhost/replica:0/task:0/device:CPU:0"));
+  auto ctx = new EagerContext(
+      SessionOptions(),
+      tensorflow::ContextDevicePlacementPolicy::DEVICE_PLACEMENT_SILENT, false,
+      &device_mgr, false, nullptr, nullptr);
+  TF_ASSERT_OK(ctx->AddFunctionDef(FunctionDefHelper::Define(
+      "Forward", {"x: float"}, {"y: float"}, {},
+      {{{"y"}, "Identity", {"x"}, {{"T", DT_FLOAT}}}})));
+  auto op = new EagerOperation(ctx);
+
+  // Resetting to the same primitive op again reuses its op def, also after
+  // the caches of the context were cleared.
+  TF_ASSERT_OK(op->Reset("Identity", nullptr));
+  const OpDef* op_def = op->OpDef();
+  ASSERT_NE(op_def, nullptr);
+  op->Clear();
+  ctx->ClearCachesAndDefaultExecutor();
+  TF_ASSERT_OK(op->Reset("Identity", nullptr));
+  EXPECT_EQ(op->OpDef(), op_def);
+  EXPECT_FALSE(op->is_function());
+
+  // Functions are looked up on every Reset.
+  op->Clear();
+  TF_ASSERT_OK(op->Reset("Forward", nullptr));
+  EXPECT_TRUE(op->is_function());
+  op->Clear();
+  TF_ASSERT_OK(ctx->RemoveFunction("Forward"));
+  EXPECT_TRUE(errors::IsNotFound(op->Reset("Forward", nullptr)));
+
+  // The kernel the operation last ran with is released by Clear() and once
+  // the kernel cache was cleared.
+  op->Clear();
+  TF_ASSERT_OK(op->Reset("Identity", nullptr));
+  core::RefCountPtr<KernelAndDevice> kernel(new KernelAndDeviceOp(
+      nullptr, false, nullptr, nullptr, nullptr, nullptr));
+  const Fprint128 cache_key = op->MutableAttrs()->CacheKey("CPU:0");
+  op->SetLastKernel(cache_key, ctx->KernelCacheGeneration(), kernel.get());
+  EXPECT_EQ(op->GetLastKernel(cache_key, ctx->KernelCacheGeneration()).get(),
+            kernel.get());
+  op->Clear();
+  EXPECT_TRUE(kernel->RefCountIsOne());
+  EXPECT_EQ(op->GetLastKernel(cache_key, ctx->KernelCacheGeneration()),
+            nullptr);
+
+  TF_ASSERT_OK(op->Reset("Identity", nullptr));
+  op->SetLastKernel(cache_key, ctx->KernelCacheGeneration(), kernel.get());
+  ctx->ClearCachesAndDefaultExecutor();
+  EXPECT_EQ(op->GetLastKernel(cache_key, ctx->KernelCacheGeneration()),
+            nullptr);
+  EXPECT_TRUE(kernel->RefCountIsOne());
+
+  delete op;
+  ctx->Unref();
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -463,7 +463,17 @@ Status GetOrCreateKernelAndDevice(
     }
   }
 
-  core::RefCountPtr<KernelAndDevice> kernel = ctx.GetCachedKernel(cache_key);
+  // Read the generation before looking up the cache, so that a kernel removed
+  // from the cache concurrently is not remembered as still valid.
+  const int64 kernel_cache_generation = ctx.KernelCacheGeneration();
+  core::RefCountPtr<KernelAndDevice> kernel =
+      op->GetLastKernel(cache_key, kernel_cache_generation);
+  if (kernel == nullptr) {
+    kernel = ctx.GetCachedKernel(cache_key);
+    if (kernel != nullptr) {
+      op->SetLastKernel(cache_key, kernel_cache_generation, kernel.get());
+    }
+  }
   if (kernel == nullptr) {
     DVLOG(2) << "Creating new kernel for " << op->Name() << " on device "
              << DeviceNameOrUnspecified(absl::get<Device*>(op->Device()));
@@ -543,6 +553,7 @@ Status GetOrCreateKernelAndDevice(
 
     if (op->is_function()) {
       ctx.AddKernelToCache(cache_key, kernel.get());
+      op->SetLastKernel(cache_key, kernel_cache_generation, kernel.get());
     } else {
       // Exclude tf.data op kernels from being cached. The reason for this is
       // that tf.data op kernels that accept a user-defined function will have a
@@ -554,6 +565,7 @@ Status GetOrCreateKernelAndDevice(
       TF_RETURN_IF_ERROR(OpDefForOp(op->Name().data(), &op_def));
       if (KernelCacheEnabled(*op_def)) {
         ctx.AddKernelToCache(cache_key, kernel.get());
+        op->SetLastKernel(cache_key, kernel_cache_generation, kernel.get());
       }
     }
   }
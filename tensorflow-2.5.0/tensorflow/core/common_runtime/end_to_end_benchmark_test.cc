@@ -0,0 +1,282 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// End-to-end benchmarks of representative model graphs run through a
+// Session, as opposed to the per-kernel benchmarks elsewhere.  Besides the
+// usual timing, every benchmark reports the step latency percentiles, the CPU
+// allocations per step and the peak CPU memory as counters, which end up as
+// metrics in the benchmark entries written when TEST_REPORT_FILE_PREFIX is set.
+//
+// Run with:
+//   bazel run -c opt \
+//     //tensorflow/core/common_runtime:end_to_end_benchmark_test -- \
+//     --benchmarks=all
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/cc/framework/ops.h"
+#include "tensorflow/cc/framework/scope.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/public/session.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+// One step of a benchmarked model: its graph and what to feed and fetch.
+struct BenchmarkGraph {
+  GraphDef graph_def;
+  std::vector<std::pair<string, Tensor>> feeds;
+  std::vector<string> fetches;
+};
+
+Tensor RandomFloatTensor(const TensorShape& shape) {
+  Tensor tensor(DT_FLOAT, shape);
+  tensor.flat<float>().setRandom();
+  return tensor;
+}
+
+BenchmarkGraph FinishGraph(const Scope& scope,
+                           std::vector<std::pair<Output, Tensor>> feeds,
+                           const std::vector<Output>& fetches) {
+  BenchmarkGraph graph;
+  TF_CHECK_OK(scope.ToGraphDef(&graph.graph_def));
+  for (auto& feed : feeds) {
+    graph.feeds.emplace_back(feed.first.name(), std::move(feed.second));
+  }
+  for (const Output& fetch : fetches) {
+    graph.fetches.push_back(fetch.name());
+  }
+  return graph;
+}
+
+// A transformer encoder block: single-head self-attention followed by a
+// feed-forward layer, each with a residual connection, and a final layer
+// normalization.
+BenchmarkGraph TransformerBlock() {
+  constexpr int kBatch = 8;
+  constexpr int kSequence = 64;
+  constexpr int kModel = 256;
+  constexpr int kHidden = 1024;
+  Scope scope = Scope::NewRootScope();
+  auto weight = [&](int rows, int cols) {
+    return ops::Const(scope, RandomFloatTensor({rows, cols}));
+  };
+
+  auto x = ops::Placeholder(
+      scope, DT_FLOAT,
+      ops::Placeholder::Shape({kBatch * kSequence, kModel}));
+  auto project = [&](Input input) {
+    return ops::Reshape(scope,
+                        ops::MatMul(scope, input, weight(kModel, kModel)),
+                        {kBatch, kSequence, kModel});
+  };
+  auto scores = ops::Multiply(
+      scope,
+      ops::BatchMatMulV2(scope, project(x), project(x),
+                         ops::BatchMatMulV2::AdjY(true)),
+      1.0f / std::sqrt(static_cast<float>(kModel)));
+  auto attention = ops::BatchMatMulV2(scope, ops::Softmax(scope, scores),
+                                      project(x));
+  auto attended = ops::Add(
+      scope, x,
+      ops::MatMul(scope,
+                  ops::Reshape(scope, attention, {kBatch * kSequence, kModel}),
+                  weight(kModel, kModel)));
+  auto hidden = ops::Relu(
+      scope, ops::MatMul(scope, attended, weight(kModel, kHidden)));
+  auto y = ops::Add(scope, attended,
+                    ops::MatMul(scope, hidden, weight(kHidden, kModel)));
+
+  auto mean = ops::Mean(scope, y, {1}, ops::Mean::KeepDims(true));
+  auto centered = ops::Sub(scope, y, mean);
+  auto variance = ops::Mean(scope, ops::Square(scope, centered), {1},
+                            ops::Mean::KeepDims(true));
+  auto normalized = ops::Multiply(
+      scope, centered, ops::Rsqrt(scope, ops::Add(scope, variance, 1e-6f)));
+
+  return FinishGraph(
+      scope, {{x, RandomFloatTensor({kBatch * kSequence, kModel})}},
+      {normalized});
+}
+
+// A ResNet basic block: two 3x3 convolutions with a residual connection.
+BenchmarkGraph ResNetBlock() {
+  constexpr int kBatch = 8;
+  constexpr int kSize = 28;
+  constexpr int kChannels = 64;
+  Scope scope = Scope::NewRootScope();
+
+  auto x = ops::Placeholder(
+      scope, DT_FLOAT,
+      ops::Placeholder::Shape({kBatch, kSize, kSize, kChannels}));
+  auto conv = [&](Input input) {
+    auto filter =
+        ops::Const(scope, RandomFloatTensor({3, 3, kChannels, kChannels}));
+    auto bias = ops::Const(scope, RandomFloatTensor({kChannels}));
+    return ops::BiasAdd(
+        scope, ops::Conv2D(scope, input, filter, {1, 1, 1, 1}, "SAME"), bias);
+  };
+  auto y = ops::Relu(
+      scope, ops::Add(scope, x, conv(ops::Relu(scope, conv(x)))));
+
+  return FinishGraph(
+      scope, {{x, RandomFloatTensor({kBatch, kSize, kSize, kChannels})}}, {y});
+}
+
+// A wide & deep model: a linear model over dense features next to an MLP over
+// embedded sparse ids and the same dense features.
+BenchmarkGraph WideAndDeep() {
+  constexpr int kBatch = 256;
+  constexpr int kIdsPerExample = 8;
+  constexpr int kVocabulary = 50000;
+  constexpr int kEmbedding = 32;
+  constexpr int kDense = 64;
+  Scope scope = Scope::NewRootScope();
+  auto weight = [&](int rows, int cols) {
+    return ops::Const(scope, RandomFloatTensor({rows, cols}));
+  };
+
+  auto ids = ops::Placeholder(
+      scope, DT_INT32, ops::Placeholder::Shape({kBatch, kIdsPerExample}));
+  auto dense = ops::Placeholder(scope, DT_FLOAT,
+                                ops::Placeholder::Shape({kBatch, kDense}));
+  auto embedded = ops::Reshape(
+      scope, ops::GatherV2(scope, weight(kVocabulary, kEmbedding), ids, 0),
+      {kBatch, kIdsPerExample * kEmbedding});
+  auto deep_input = ops::Concat(scope, {Output(embedded), Output(dense)}, 1);
+  auto layer1 = ops::Relu(
+      scope, ops::MatMul(scope, deep_input,
+                         weight(kIdsPerExample * kEmbedding + kDense, 256)));
+  auto layer2 =
+      ops::Relu(scope, ops::MatMul(scope, layer1, weight(256, 128)));
+  auto deep = ops::MatMul(scope, layer2, weight(128, 1));
+  auto wide = ops::MatMul(scope, dense, weight(kDense, 1));
+  auto y = ops::Sigmoid(scope, ops::Add(scope, deep, wide));
+
+  Tensor id_values(DT_INT32, {kBatch, kIdsPerExample});
+  auto id_flat = id_values.flat<int32>();
+  for (int i = 0; i < id_flat.size(); ++i) {
+    id_flat(i) = (i * 7919) % kVocabulary;
+  }
+  return FinishGraph(scope,
+                     {{ids, std::move(id_values)},
+                      {dense, RandomFloatTensor({kBatch, kDense})}},
+                     {y});
+}
+
+// Runs `graph` once per benchmark iteration in a session with `num_threads`
+// inter- and intra-op threads, or with the single-threaded executor if
+// `num_threads` is 0.
+void RunGraphBenchmark(::testing::benchmark::State& state,
+                       const BenchmarkGraph& graph, int num_threads) {
+  SessionOptions options;
+  if (num_threads > 0) {
+    options.config.set_inter_op_parallelism_threads(num_threads);
+    options.config.set_intra_op_parallelism_threads(num_threads);
+  } else {
+    options.config.set_inter_op_parallelism_threads(-1);
+    options.config.mutable_experimental()->set_executor_type(
+        "SINGLE_THREADED_EXECUTOR");
+  }
+  std::unique_ptr<Session> session(NewSession(options));
+  TF_CHECK_OK(session->Create(graph.graph_def));
+
+  CallableOptions callable_options;
+  std::vector<Tensor> feed_values;
+  for (const auto& feed : graph.feeds) {
+    callable_options.add_feed(feed.first);
+    feed_values.push_back(feed.second);
+  }
+  for (const string& fetch : graph.fetches) {
+    callable_options.add_fetch(fetch);
+  }
+  Session::CallableHandle handle;
+  TF_CHECK_OK(session->MakeCallable(callable_options, &handle));
+
+  // The first run optimizes and partitions the graph; leave it out.
+  std::vector<Tensor> outputs;
+  TF_CHECK_OK(session->RunCallable(handle, feed_values, &outputs, nullptr));
+
+  std::vector<double> step_micros;
+  step_micros.reserve(state.max_iterations);
+  Env* env = Env::Default();
+  for (auto s : state) {
+    const uint64 start = env->NowMicros();
+    outputs.clear();
+    TF_CHECK_OK(session->RunCallable(handle, feed_values, &outputs, nullptr));
+    step_micros.push_back(env->NowMicros() - start);
+  }
+  state.SetItemsProcessed(state.iterations());
+
+  if (!step_micros.empty()) {
+    std::sort(step_micros.begin(), step_micros.end());
+    auto percentile = [&](double p) {
+      return step_micros[std::min<size_t>(step_micros.size() - 1,
+                                          p * step_micros.size())];
+    };
+    state.counters["p50_us"] = percentile(0.5);
+    state.counters["p90_us"] = percentile(0.9);
+    state.counters["p99_us"] = percentile(0.99);
+  }
+
+  // Allocator stats take a lock on every allocation, so collect them in a
+  // separate, untimed step.
+  EnableCPUAllocatorStats();
+  Allocator* allocator = cpu_allocator();
+  allocator->ClearStats();
+  outputs.clear();
+  TF_CHECK_OK(session->RunCallable(handle, feed_values, &outputs, nullptr));
+  absl::optional<AllocatorStats> stats = allocator->GetStats();
+  DisableCPUAllocatorStats();
+  if (stats.has_value()) {
+    state.counters["allocs_per_step"] = stats->num_allocs;
+    state.counters["peak_bytes"] = stats->peak_bytes_in_use;
+  }
+
+  TF_CHECK_OK(session->ReleaseCallable(handle));
+  TF_CHECK_OK(session->Close());
+}
+
+void BM_TransformerBlock(::testing::benchmark::State& state) {
+  RunGraphBenchmark(state, TransformerBlock(), state.range(0));
+}
+void BM_ResNetBlock(::testing::benchmark::State& state) {
+  RunGraphBenchmark(state, ResNetBlock(), state.range(0));
+}
+void BM_WideAndDeep(::testing::benchmark::State& state) {
+  RunGraphBenchmark(state, WideAndDeep(), state.range(0));
+}
+
+// The argument is the number of threads; 0 uses the single-threaded executor.
+BENCHMARK(BM_TransformerBlock)->Arg(0)->Arg(1)->Arg(4)->Arg(16);
+BENCHMARK(BM_ResNetBlock)->Arg(0)->Arg(1)->Arg(4)->Arg(16);
+BENCHMARK(BM_WideAndDeep)->Arg(0)->Arg(1)->Arg(4)->Arg(16);
+
+}  // namespace
+}  // namespace tensorflow
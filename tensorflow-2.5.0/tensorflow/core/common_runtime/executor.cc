@@ -17,19 +17,24 @@ limitations under the License.
 
 #include <atomic>
 #include <memory>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "absl/memory/memory.h"
 #include "tensorflow/core/common_runtime/costmodel_manager.h"
 #include "tensorflow/core/common_runtime/entry.h"
 #include "tensorflow/core/common_runtime/executor_factory.h"
+#include "tensorflow/core/common_runtime/executor_memory_planner.h"
 #include "tensorflow/core/common_runtime/graph_view.h"
 #include "tensorflow/core/common_runtime/immutable_executor_state.h"
 #include "tensorflow/core/common_runtime/pending_counts.h"
 #include "tensorflow/core/common_runtime/propagator_state.h"
 #include "tensorflow/core/common_runtime/renamed_device.h"
 #include "tensorflow/core/common_runtime/simple_propagator_state.h"
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
+#include "tensorflow/core/common_runtime/work_stealing_queues.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/collective.h"
@@ -134,13 +139,86 @@ struct KernelTimer {
 typedef gtl::InlinedVector<TensorValue, 4> TensorValueVec;
 typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
 
+// Maps the id of each node that produces a return value to pairs of its output
+// index and the index of the return value.
+typedef std::unordered_map<int, std::vector<std::pair<int, int>>>
+    RetvalOutputMap;
+
+// Allocates the first allocation of the size of `tensor` in the buffer of
+// `tensor`, and every other allocation with `fallback`. Used to let a kernel
+// write a return value directly into a tensor preallocated by the caller (see
+// Executor::Args::preallocated_retvals). Keeps itself alive while it owns
+// allocated memory.
+class PreallocatedOutputAllocator : public Allocator, public core::RefCounted {
+ public:
+  PreallocatedOutputAllocator(const Tensor& tensor, Allocator* fallback)
+      : tensor_(tensor),
+        data_(const_cast<char*>(tensor_.tensor_data().data())),
+        fallback_(fallback) {}
+
+  string Name() override { return "preallocated_output"; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+  }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override {
+    void* ptr;
+    if (num_bytes == tensor_.TotalBytes() &&
+        reinterpret_cast<uintptr_t>(data_) % alignment == 0 &&
+        !used_.exchange(true)) {
+      ptr = data_;
+    } else {
+      ptr = fallback_->AllocateRaw(alignment, num_bytes, allocation_attr);
+    }
+    if (ptr != nullptr) Ref();
+    return ptr;
+  }
+
+  void DeallocateRaw(void* ptr) override {
+    if (ptr != data_) fallback_->DeallocateRaw(ptr);
+    // May delete this allocator.
+    Unref();
+  }
+
+ private:
+  const Tensor tensor_;
+  void* const data_;
+  Allocator* const fallback_;  // Not owned.
+  std::atomic<bool> used_{false};
+};
+
 class ExecutorImpl : public Executor {
  public:
   explicit ExecutorImpl(const LocalExecutorParams& p) : immutable_state_(p) {}
 
+  ~ExecutorImpl() override {
+    if (memory_planner_ != nullptr) memory_planner_->Unref();
+  }
+
   Status Initialize(const Graph& graph) {
     TF_RETURN_IF_ERROR(immutable_state_.Initialize(graph));
+    for (const Node* n : graph.op_nodes()) {
+      if (!n->IsRetval()) continue;
+      int index;
+      const Edge* edge;
+      TF_RETURN_IF_ERROR(GetNodeAttr(n->attrs(), "index", &index));
+      TF_RETURN_IF_ERROR(n->input_edge(0, &edge));
+      retval_outputs_[edge->src()->id()].emplace_back(edge->src_output(),
+                                                      index);
+    }
     kernel_stats_.Initialize(immutable_state_.graph_view());
+    if (immutable_state_.params().plan_output_memory) {
+      const GraphView& gview = immutable_state_.graph_view();
+      std::vector<int> num_outputs(gview.num_nodes(), 0);
+      for (int32 i = 0; i < gview.num_nodes(); ++i) {
+        if (gview.node(i)) num_outputs[i] = gview.node(i)->num_outputs;
+      }
+      memory_planner_ = new ExecutorMemoryPlanner(
+          immutable_state_.params().device->GetAllocator(AllocatorAttributes()),
+          num_outputs);
+    }
     return Status::OK();
   }
 
@@ -214,6 +292,9 @@ class ExecutorImpl : public Executor {
 
   ImmutableExecutorState immutable_state_;
   KernelStats kernel_stats_;
+  // Set if the outputs of the kernels are allocated from a planned arena.
+  ExecutorMemoryPlanner* memory_planner_ = nullptr;
+  RetvalOutputMap retval_outputs_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(ExecutorImpl);
 };
@@ -272,7 +353,9 @@ class ExecutorState {
  public:
   ExecutorState(const Executor::Args& args,
                 const ImmutableExecutorState& immutable_state_,
-                ExecutorImpl::KernelStats* kernel_stats_);
+                ExecutorImpl::KernelStats* kernel_stats_,
+                ExecutorMemoryPlanner* memory_planner_,
+                const RetvalOutputMap& retval_outputs);
   ~ExecutorState();
 
   void RunAsync(Executor::DoneCallback done);
@@ -312,17 +395,35 @@ class ExecutorState {
   // if execution has completed.
   //
   // This method will clear `*ready` before returning.
+  //
+  // `worker_queue` is the work-stealing queue of the calling worker, or -1.
   bool NodeDone(const Status& s, TaggedNodeSeq* ready,
                 NodeExecStatsInterface* stats,
-                TaggedNodeReadyQueue* inline_ready);
+                TaggedNodeReadyQueue* inline_ready, int worker_queue);
 
   // Schedule all the expensive nodes in '*ready', and put all the inexpensive
-  // nodes in 'ready' into 'inline_ready'.
+  // nodes in 'ready' into 'inline_ready'. With work stealing, the expensive
+  // nodes are pushed onto `worker_queue` instead, or spread over all queues
+  // if `inline_ready` is nullptr.
   //
   // This method will clear `*ready` before returning.
   //
   // REQUIRES: `!ready->empty()`.
-  void ScheduleReady(TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready);
+  void ScheduleReady(TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready,
+                     int worker_queue);
+
+  // With work stealing, moves a node from `worker_queue`, or stolen from
+  // another worker's queue, into `inline_ready`. Returns false if there was
+  // no queued node.
+  bool StealReadyNode(int worker_queue, TaggedNodeReadyQueue* inline_ready);
+
+  // Starts up to one new worker per queued node, without exceeding
+  // `max_workers_` concurrently active workers.
+  void MaybeStartWorkers(int64 scheduled_nsec);
+
+  // Body of a work-stealing worker: processes queued nodes until all queues
+  // are empty.
+  void RunWorker(int64 scheduled_nsec);
 
   // A wrapper for runner_ to keep track of the pending queue length. Op
   // execution should dispatch work using this function instead of using runner_
@@ -363,6 +464,12 @@ class ExecutorState {
   CallFrameInterface* call_frame_;
   const ImmutableExecutorState& immutable_state_;
   ExecutorImpl::KernelStats* const kernel_stats_;
+  ExecutorMemoryPlanner* const memory_planner_;  // may be null
+  // The output allocators of the nodes producing return values that were
+  // preallocated by the caller, and the allocators of those return values.
+  std::unordered_map<int, std::vector<Allocator*>> retval_output_allocators_;
+  std::vector<core::RefCountPtr<PreallocatedOutputAllocator>>
+      preallocated_output_allocators_;
   CancellationManager* cancellation_manager_;
   // If not null, use this device to schedule intra-op operation
   std::unique_ptr<DeviceBase> user_device_;
@@ -370,6 +477,25 @@ class ExecutorState {
   bool sync_on_finish_;
   const bool run_all_kernels_inline_;
 
+  // Set if the ready nodes are scheduled by work stealing. Every active
+  // worker counts as an outstanding op, so that the executor is not
+  // finished while a worker may still look at the queues.
+  std::unique_ptr<WorkStealingQueues<TaggedNode>> work_queues_;
+  const int max_workers_;
+  std::atomic<int> num_workers_{0};
+
+  // Finishes the step of the arena and drops the reference of the executor.
+  struct StepArenaDeleter {
+    void operator()(StepArenaAllocator* arena) const {
+      arena->StepFinished();
+      arena->Unref();
+    }
+  };
+  // The arena of the small host tensors of the step, or null. Declared before
+  // propagator_ so that the tensors left in it are freed before the step of
+  // the arena finishes.
+  std::unique_ptr<StepArenaAllocator, StepArenaDeleter> step_arena_;
+
   PropagatorStateType propagator_;
 
   // Invoked when the execution finishes.
@@ -390,7 +516,9 @@ class ExecutorState {
 template <class PropagatorStateType>
 ExecutorState<PropagatorStateType>::ExecutorState(
     const Executor::Args& args, const ImmutableExecutorState& immutable_state,
-    ExecutorImpl::KernelStats* kernel_stats)
+    ExecutorImpl::KernelStats* kernel_stats,
+    ExecutorMemoryPlanner* memory_planner,
+    const RetvalOutputMap& retval_outputs)
     : vlog_(VLOG_IS_ON(1)),
       log_memory_(LogMemory::IsEnabled()),
       step_id_(args.step_id),
@@ -409,17 +537,70 @@ ExecutorState<PropagatorStateType>::ExecutorState(
       call_frame_(args.call_frame),
       immutable_state_(immutable_state),
       kernel_stats_(kernel_stats),
+      memory_planner_(memory_planner),
       cancellation_manager_(args.cancellation_manager),
       runner_(args.runner),
       sync_on_finish_(args.sync_on_finish),
       run_all_kernels_inline_(args.run_all_kernels_inline),
+      max_workers_(args.work_stealing_num_workers),
       propagator_(immutable_state, step_id_, vlog_),
       num_outstanding_ops_(0) {
+  if (max_workers_ > 0 && !run_all_kernels_inline_) {
+    work_queues_ =
+        absl::make_unique<WorkStealingQueues<TaggedNode>>(max_workers_);
+  }
   if (args.user_intra_op_threadpool != nullptr) {
     Device* device = immutable_state_.params().device;
     user_device_ = RenamedDevice::NewRenamedDevice(
         device->name(), device, false, false, args.user_intra_op_threadpool);
   }
+  if (immutable_state_.params().step_arena_max_allocation_size > 0) {
+    step_arena_.reset(
+        new StepArenaAllocator(immutable_state_.params().device->GetAllocator(
+            AllocatorAttributes())));
+  }
+  if (args.preallocated_retvals != nullptr) {
+    const std::vector<Tensor>& retvals = *args.preallocated_retvals;
+    Allocator* device_allocator =
+        immutable_state_.params().device->GetAllocator(AllocatorAttributes());
+    for (const auto& node_outputs : retval_outputs) {
+      const NodeItem* item =
+          immutable_state_.graph_view().node(node_outputs.first);
+      if (item == nullptr) continue;
+      std::vector<Allocator*> allocators(item->num_outputs, nullptr);
+      if (memory_planner_ != nullptr) {
+        Allocator* const* planned =
+            memory_planner_->output_allocators(node_outputs.first);
+        allocators.assign(planned, planned + item->num_outputs);
+      }
+      bool preallocated = false;
+      for (const auto& output : node_outputs.second) {
+        const int index = output.second;
+        // Only buffers of plain data can be handed to a kernel: the elements
+        // of types such as DT_STRING, DT_VARIANT and DT_RESOURCE are
+        // constructed in place and destroyed by the tensor that owns the
+        // buffer, so sharing the buffer would destroy them twice.
+        if (index >= static_cast<int>(retvals.size()) ||
+            !retvals[index].IsInitialized() ||
+            retvals[index].TotalBytes() == 0 ||
+            retvals[index].dtype() != item->output_type(output.first) ||
+            !DataTypeCanUseMemcpy(retvals[index].dtype())) {
+          continue;
+        }
+        Allocator*& allocator = allocators[output.first];
+        preallocated_output_allocators_.emplace_back(
+            new PreallocatedOutputAllocator(
+                retvals[index],
+                allocator != nullptr ? allocator : device_allocator));
+        allocator = preallocated_output_allocators_.back().get();
+        preallocated = true;
+      }
+      if (preallocated) {
+        retval_output_allocators_.emplace(node_outputs.first,
+                                          std::move(allocators));
+      }
+    }
+  }
 }
 
 template <class PropagatorStateType>
@@ -478,7 +659,7 @@ void ExecutorState<PropagatorStateType>::RunAsync(Executor::DoneCallback done) {
   } else {
     done_cb_ = std::move(done);
     // Schedule to run all the ready ops in thread pool.
-    ScheduleReady(&ready, nullptr);
+    ScheduleReady(&ready, nullptr, /*worker_queue=*/-1);
   }
 }
 
@@ -625,7 +806,8 @@ void ExecutorState<PropagatorStateType>::ProcessAsync(
       propagator_.PropagateOutputs(state->tagged_node, &outputs, &ready);
     }
     outputs.clear();
-    const bool completed = NodeDone(s, &ready, stats, nullptr);
+    const bool completed =
+        NodeDone(s, &ready, stats, nullptr, /*worker_queue=*/-1);
     delete state;
     if (completed) ScheduleFinish();
   };
@@ -706,6 +888,9 @@ void ExecutorState<PropagatorStateType>::Process(TaggedNode tagged_node,
   params.function_library = immutable_state_.params().function_library;
   params.resource_manager = device->resource_manager();
   params.step_container = step_container_;
+  params.step_arena_allocator = step_arena_.get();
+  params.step_arena_max_allocation_size =
+      immutable_state_.params().step_arena_max_allocation_size;
   params.slice_reader_cache = slice_reader_cache_;
   params.inputs = &inputs;
   params.input_alloc_attrs = &input_alloc_attrs;
@@ -739,9 +924,13 @@ void ExecutorState<PropagatorStateType>::Process(TaggedNode tagged_node,
 
   EntryVector outputs(1);
 
+  const int worker_queue =
+      work_queues_ != nullptr ? work_queues_->AssignQueue() : -1;
+
   bool completed = false;
   inline_ready.push_back(tagged_node);
-  while (!inline_ready.empty()) {
+  while (!inline_ready.empty() ||
+         StealReadyNode(worker_queue, &inline_ready)) {
     tagged_node = inline_ready.front();
     inline_ready.pop_front();
     const NodeItem& item = tagged_node.get_node_item();
@@ -792,7 +981,7 @@ void ExecutorState<PropagatorStateType>::Process(TaggedNode tagged_node,
         }
         propagator_.MaybeMarkCompleted(tagged_node);
         // Continue to process the nodes in 'inline_ready'.
-        completed = NodeDone(s, &ready, stats, &inline_ready);
+        completed = NodeDone(s, &ready, stats, &inline_ready, worker_queue);
         continue;
       }
 
@@ -802,6 +991,18 @@ void ExecutorState<PropagatorStateType>::Process(TaggedNode tagged_node,
       params.is_input_dead = is_input_dead;
       params.output_attr_array = item.output_attrs();
       params.forward_from_array = item.forward_from();
+      if (memory_planner_ != nullptr) {
+        params.output_allocator_array =
+            memory_planner_->output_allocators(item.node_id);
+      }
+      if (TF_PREDICT_FALSE(!retval_output_allocators_.empty())) {
+        auto it = retval_output_allocators_.find(item.node_id);
+        if (it != retval_output_allocators_.end()) {
+          params.output_allocator_array = it->second.data();
+        } else if (memory_planner_ == nullptr) {
+          params.output_allocator_array = nullptr;
+        }
+      }
       params.outputs_required_array = item.outputs_required.get();
 
       if (item.kernel_is_async) {
@@ -841,7 +1042,7 @@ void ExecutorState<PropagatorStateType>::Process(TaggedNode tagged_node,
         scheduled_nsec = nodestats::NowInNsec();
       }
       // Postprocess.
-      completed = NodeDone(s, &ready, stats, &inline_ready);
+      completed = NodeDone(s, &ready, stats, &inline_ready, worker_queue);
     }
   }  // while !inline_ready.empty()
 
@@ -1062,7 +1263,7 @@ Status ExecutorState<PropagatorStateType>::ProcessOutputs(
 template <class PropagatorStateType>
 bool ExecutorState<PropagatorStateType>::NodeDone(
     const Status& s, TaggedNodeSeq* ready, NodeExecStatsInterface* stats,
-    TaggedNodeReadyQueue* inline_ready) {
+    TaggedNodeReadyQueue* inline_ready, int worker_queue) {
   if (stats) {
     nodestats::SetAllEnd(stats);
     DCHECK_NE(stats_collector_, nullptr);
@@ -1081,7 +1282,7 @@ bool ExecutorState<PropagatorStateType>::NodeDone(
       }
 
       // Schedule the ready nodes in 'ready'.
-      ScheduleReady(ready, inline_ready);
+      ScheduleReady(ready, inline_ready, worker_queue);
 
       return false;
     }
@@ -1139,7 +1340,8 @@ bool ExecutorState<PropagatorStateType>::NodeDone(
 
 template <class PropagatorStateType>
 void ExecutorState<PropagatorStateType>::ScheduleReady(
-    TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready) {
+    TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready,
+    int worker_queue) {
   DCHECK(!ready->empty());
 
   int64 scheduled_nsec = 0;
@@ -1163,6 +1365,29 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
         inline_ready->push_back(tagged_node);
       }
     }
+  } else if (work_queues_ != nullptr) {
+    if (inline_ready == nullptr) {
+      // Spread the nodes over all queues; the workers started below pick
+      // them up.
+      for (auto& tagged_node : *ready) {
+        work_queues_->Push(work_queues_->AssignQueue(), tagged_node);
+      }
+    } else {
+      for (auto& tagged_node : *ready) {
+        const NodeItem& item = *tagged_node.node_item;
+        if (tagged_node.get_is_dead() || !kernel_stats_->IsExpensive(item)) {
+          inline_ready->push_back(tagged_node);
+        } else {
+          // The expensive node goes to this worker's own queue. It runs on
+          // this thread once `inline_ready` is drained, unless an idle
+          // worker steals it first.
+          work_queues_->Push(worker_queue, tagged_node);
+        }
+      }
+    }
+    if (work_queues_->size() > 0) {
+      MaybeStartWorkers(scheduled_nsec);
+    }
   } else {
     const TaggedNode* curr_expensive_node = nullptr;
     if (inline_ready == nullptr) {
@@ -1201,6 +1426,60 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
   ready->clear();
 }
 
+template <class PropagatorStateType>
+bool ExecutorState<PropagatorStateType>::StealReadyNode(
+    int worker_queue, TaggedNodeReadyQueue* inline_ready) {
+  if (work_queues_ == nullptr) {
+    return false;
+  }
+  absl::optional<TaggedNode> tagged_node =
+      work_queues_->PopOrSteal(worker_queue);
+  if (!tagged_node) {
+    return false;
+  }
+  inline_ready->push_back(*tagged_node);
+  return true;
+}
+
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::MaybeStartWorkers(
+    int64 scheduled_nsec) {
+  // The accesses to `num_workers_` here and in RunWorker() are sequentially
+  // consistent, like those to the queue size. Otherwise a worker could exit
+  // after missing a node pushed by a producer that still counted it as
+  // active, with the producer then seeing no room for a new worker.
+  int64 num_queued = work_queues_->size();
+  int num_workers = num_workers_.load(std::memory_order_seq_cst);
+  while (num_queued > 0 && num_workers < max_workers_) {
+    if (!num_workers_.compare_exchange_weak(num_workers, num_workers + 1,
+                                            std::memory_order_seq_cst)) {
+      continue;
+    }
+    num_outstanding_ops_.fetch_add(1, std::memory_order_relaxed);
+    RunTask([this, scheduled_nsec]() { RunWorker(scheduled_nsec); });
+    --num_queued;
+    ++num_workers;
+  }
+}
+
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::RunWorker(int64 scheduled_nsec) {
+  const int worker_queue = work_queues_->AssignQueue();
+  absl::optional<TaggedNode> tagged_node;
+  while ((tagged_node = work_queues_->PopOrSteal(worker_queue))) {
+    Process(*tagged_node, scheduled_nsec);
+  }
+  num_workers_.fetch_sub(1, std::memory_order_seq_cst);
+  // A node may have been queued after the last PopOrSteal() by a producer
+  // that still counted this worker as active.
+  if (work_queues_->size() > 0) {
+    MaybeStartWorkers(scheduled_nsec);
+  }
+  if (num_outstanding_ops_.fetch_sub(1) == 1) {
+    ScheduleFinish();
+  }
+}
+
 template <class PropagatorStateType>
 void ExecutorState<PropagatorStateType>::ScheduleFinish() {
   // Checks condition to decide if needs to invoke Finish(). If there are
@@ -1337,12 +1616,24 @@ void ExecutorState<PropagatorStateType>::Finish() {
 }
 
 void ExecutorImpl::RunAsync(const Args& args, DoneCallback done) {
+  if (memory_planner_ != nullptr) {
+    memory_planner_->StepStarted();
+    memory_planner_->Ref();
+    done = [memory_planner = memory_planner_,
+            done = std::move(done)](const Status& s) {
+      memory_planner->StepFinished();
+      memory_planner->Unref();
+      done(s);
+    };
+  }
   if (immutable_state_.requires_control_flow_support()) {
-    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_))
+    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_,
+                                        memory_planner_, retval_outputs_))
         ->RunAsync(std::move(done));
   } else {
     (new ExecutorState<SimplePropagatorState>(args, immutable_state_,
-                                              &kernel_stats_))
+                                              &kernel_stats_, memory_planner_,
+                                              retval_outputs_))
         ->RunAsync(std::move(done));
   }
 }
@@ -116,6 +116,20 @@ class Executor {
     // If true, all kernels will be treated as "inexpensive", and hence executed
     // on the scheduling thread.
     bool run_all_kernels_inline = false;
+
+    // If positive, ready nodes are scheduled by work stealing among at most
+    // this many concurrently running closures on `runner`, each with its own
+    // queue of ready nodes, instead of one closure per expensive node.
+    // Typically the number of threads behind `runner`. Ignored if
+    // `run_all_kernels_inline` is true.
+    int work_stealing_num_workers = 0;
+
+    // If not null, `(*preallocated_retvals)[i]` may be an initialized tensor on
+    // the executor's device, in which the kernel producing the `i`-th return
+    // value of `call_frame` allocates it, if the sizes match. The value
+    // returned through `call_frame` then shares the buffer of that tensor,
+    // which must not be used otherwise until it is returned.
+    const std::vector<Tensor>* preallocated_retvals = nullptr;
   };
   typedef std::function<void(const Status&)> DoneCallback;
   virtual void RunAsync(const Args& args, DoneCallback done) = 0;
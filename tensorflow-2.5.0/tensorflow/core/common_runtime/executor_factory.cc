@@ -17,12 +17,14 @@ limitations under the License.
 
 #include <unordered_map>
 
+#include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace {
@@ -81,4 +83,48 @@ Status NewExecutor(const string& executor_type,
   return factory->NewExecutor(params, std::move(graph), out_executor);
 }
 
+bool IsSingleThreadedExecutorCandidate(const Graph& graph, int64 max_ops) {
+  if (graph.num_op_nodes() > max_ops) return false;
+  for (const Node* n : graph.op_nodes()) {
+    if (n->IsControlFlow() || n->IsSend() || n->IsHostSend() || n->IsRecv() ||
+        n->IsHostRecv() || n->IsCollective()) {
+      return false;
+    }
+    // The single-threaded executor does not provide a slice reader cache.
+    if (n->type_string() == "Restore" || n->type_string() == "RestoreSlice") {
+      return false;
+    }
+    for (DataType dt : n->output_types()) {
+      if (IsRefType(dt)) return false;
+    }
+  }
+  return true;
+}
+
+string SelectExecutorType(const string& executor_type,
+                          const string& device_type, const Graph& graph) {
+  static const int64 max_ops = [] {
+    int64 value;
+    Status status = ReadInt64FromEnvVar("TF_SINGLE_THREADED_EXECUTOR_MAX_OPS",
+                                        /*default_val=*/0, &value);
+    if (!status.ok()) {
+      LOG(ERROR) << status.error_message();
+      return int64{0};
+    }
+    return value;
+  }();
+  static const char kSingleThreadedExecutor[] = "SINGLE_THREADED_EXECUTOR";
+  if (!executor_type.empty() || max_ops <= 0 || device_type != DEVICE_CPU) {
+    return executor_type;
+  }
+  ExecutorFactory* factory;
+  if (!ExecutorFactory::GetFactory(kSingleThreadedExecutor, &factory).ok() ||
+      !IsSingleThreadedExecutorCandidate(graph, max_ops)) {
+    return executor_type;
+  }
+  VLOG(1) << "Using " << kSingleThreadedExecutor << " for a graph with "
+          << graph.num_op_nodes() << " op nodes.";
+  return kSingleThreadedExecutor;
+}
+
 }  // namespace tensorflow
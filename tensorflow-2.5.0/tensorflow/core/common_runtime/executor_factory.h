@@ -45,6 +45,22 @@ Status NewExecutor(const string& executor_type,
                    const LocalExecutorParams& params, const Graph& graph,
                    std::unique_ptr<Executor>* out_executor);
 
+// Returns true if `graph` is small enough to be run by the
+// "SINGLE_THREADED_EXECUTOR", i.e. it has at most `max_ops` op nodes, and it
+// only contains nodes that executor supports: no low level control flow,
+// send/recv, collective or reference-typed nodes.
+bool IsSingleThreadedExecutorCandidate(const Graph& graph, int64 max_ops);
+
+// Returns the executor type to use for running `graph` on a device of type
+// `device_type`. If `executor_type` is non-empty it is returned unchanged.
+// Otherwise, if the TF_SINGLE_THREADED_EXECUTOR_MAX_OPS environment variable
+// is positive, `device_type` is CPU, the single-threaded executor is linked
+// in and `graph` is a candidate for it (see above), "SINGLE_THREADED_EXECUTOR"
+// is returned, which avoids the scheduling overhead of the default executor
+// for small inference functions. Returns the empty (default) type otherwise.
+string SelectExecutorType(const string& executor_type,
+                          const string& device_type, const Graph& graph);
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_COMMON_RUNTIME_EXECUTOR_FACTORY_H_
@@ -0,0 +1,294 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/executor_memory_planner.h"
+
+#include <algorithm>
+#include <tuple>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+class ExecutorMemoryPlanner::OutputAllocator : public Allocator {
+ public:
+  OutputAllocator(ExecutorMemoryPlanner* planner, int index)
+      : planner_(planner), index_(index) {}
+
+  string Name() override { return "executor_memory_planner"; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+  }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override {
+    void* ptr = planner_->Allocate(index_, alignment, num_bytes);
+    if (ptr == nullptr) {
+      ptr = planner_->allocator_->AllocateRaw(alignment, num_bytes,
+                                              allocation_attr);
+    }
+    if (ptr != nullptr) planner_->Ref();
+    return ptr;
+  }
+
+  void DeallocateRaw(void* ptr) override {
+    if (!planner_->Deallocate(index_, ptr)) {
+      planner_->allocator_->DeallocateRaw(ptr);
+    }
+    // May delete this allocator.
+    planner_->Unref();
+  }
+
+ private:
+  ExecutorMemoryPlanner* const planner_;  // Not owned.
+  const int index_;
+};
+
+ExecutorMemoryPlanner::ExecutorMemoryPlanner(
+    Allocator* allocator, const std::vector<int>& num_outputs)
+    : allocator_(allocator) {
+  node_output_offsets_.reserve(num_outputs.size());
+  for (int n : num_outputs) {
+    node_output_offsets_.push_back(output_allocators_.size());
+    for (int i = 0; i < n; ++i) {
+      output_allocators_.push_back(absl::make_unique<OutputAllocator>(
+          this, output_allocators_.size()));
+      output_allocator_ptrs_.push_back(output_allocators_.back().get());
+    }
+  }
+  outputs_.resize(output_allocators_.size());
+}
+
+ExecutorMemoryPlanner::~ExecutorMemoryPlanner() {
+  for (size_t i = 0; i < num_block_words_; ++i) {
+    DCHECK_EQ(blocks_in_use_[i].load(std::memory_order_relaxed), 0);
+  }
+  if (arena_ != nullptr) allocator_->DeallocateRaw(arena_);
+}
+
+void ExecutorMemoryPlanner::StepStarted() {
+  if (state_.load(std::memory_order_acquire) == State::kPlanned) return;
+  mutex_lock l(mu_);
+  const State state = state_.load(std::memory_order_relaxed);
+  if (state == State::kUnplanned && num_running_steps_ == 0) {
+    state_.store(State::kProfiling, std::memory_order_relaxed);
+    profile_is_valid_ = true;
+  } else if (state == State::kProfiling) {
+    profile_is_valid_ = false;
+  }
+  ++num_running_steps_;
+}
+
+void ExecutorMemoryPlanner::StepFinished() {
+  if (state_.load(std::memory_order_acquire) == State::kPlanned) return;
+  mutex_lock l(mu_);
+  --num_running_steps_;
+  if (state_.load(std::memory_order_relaxed) != State::kProfiling ||
+      num_running_steps_ > 0) {
+    return;
+  }
+  if (profile_is_valid_) {
+    PlanMemory();
+  } else {
+    // Profile the next step that runs alone.
+    state_.store(State::kUnplanned, std::memory_order_relaxed);
+    outputs_.assign(outputs_.size(), Output());
+  }
+}
+
+size_t ExecutorMemoryPlanner::arena_size() const {
+  mutex_lock l(mu_);
+  return arena_size_;
+}
+
+int64 ExecutorMemoryPlanner::num_arena_allocations() const {
+  return num_arena_allocations_.load(std::memory_order_relaxed);
+}
+
+void* ExecutorMemoryPlanner::Allocate(int index, size_t alignment,
+                                      size_t num_bytes) {
+  if (state_.load(std::memory_order_acquire) != State::kPlanned) {
+    mutex_lock l(mu_);
+    if (state_.load(std::memory_order_relaxed) == State::kProfiling) {
+      Output& output = outputs_[index];
+      output.size = num_bytes;
+      output.allocated = clock_++;
+      ++output.num_allocations;
+    }
+    return nullptr;
+  }
+  const Slice& slice = slices_[index];
+  if (arena_ == nullptr || slice.offset < 0 || slice.size != num_bytes ||
+      alignment > Allocator::kAllocatorAlignment || !ClaimSlice(slice)) {
+    return nullptr;
+  }
+  num_arena_allocations_.fetch_add(1, std::memory_order_relaxed);
+  return arena_ + slice.offset;
+}
+
+bool ExecutorMemoryPlanner::Deallocate(int index, void* ptr) {
+  if (state_.load(std::memory_order_acquire) == State::kPlanned) {
+    char* p = static_cast<char*>(ptr);
+    if (arena_ == nullptr || p < arena_ || p >= arena_ + arena_size_) {
+      return false;
+    }
+    ReleaseSlice(slices_[index]);
+    return true;
+  }
+  mutex_lock l(mu_);
+  if (state_.load(std::memory_order_relaxed) == State::kProfiling) {
+    outputs_[index].freed = clock_++;
+  }
+  return false;
+}
+
+namespace {
+
+constexpr int kBitsPerWord = 64;
+
+// Returns the bits of word `word` of a bitmap that lie in [first, last).
+uint64 WordMask(size_t word, size_t first, size_t last) {
+  const size_t word_begin = word * kBitsPerWord;
+  const size_t lo = std::max(first, word_begin) - word_begin;
+  const size_t hi = std::min(last, word_begin + kBitsPerWord) - word_begin;
+  const uint64 bits = hi - lo == kBitsPerWord ? ~uint64{0}
+                                              : (uint64{1} << (hi - lo)) - 1;
+  return bits << lo;
+}
+
+// Returns the range of arena blocks covered by `offset` and `size`.
+std::pair<size_t, size_t> BlockRange(int64 offset, size_t size) {
+  return {offset / Allocator::kAllocatorAlignment,
+          (offset + size + Allocator::kAllocatorAlignment - 1) /
+              Allocator::kAllocatorAlignment};
+}
+
+}  // namespace
+
+bool ExecutorMemoryPlanner::ClaimSlice(const Slice& slice) {
+  size_t first, last;
+  std::tie(first, last) = BlockRange(slice.offset, slice.size);
+  const size_t first_word = first / kBitsPerWord;
+  const size_t last_word = (last - 1) / kBitsPerWord;
+  for (size_t word = first_word; word <= last_word; ++word) {
+    const uint64 mask = WordMask(word, first, last);
+    // Acquires the writes of the output that last used these blocks.
+    const uint64 previous =
+        blocks_in_use_[word].fetch_or(mask, std::memory_order_acquire);
+    if ((previous & mask) != 0) {
+      // Undo the bits set so far. Bits that were already set belong to
+      // another output.
+      blocks_in_use_[word].fetch_and(~(mask & ~previous),
+                                     std::memory_order_relaxed);
+      for (size_t w = first_word; w < word; ++w) {
+        blocks_in_use_[w].fetch_and(~WordMask(w, first, last),
+                                    std::memory_order_relaxed);
+      }
+      return false;
+    }
+  }
+  return true;
+}
+
+void ExecutorMemoryPlanner::ReleaseSlice(const Slice& slice) {
+  size_t first, last;
+  std::tie(first, last) = BlockRange(slice.offset, slice.size);
+  for (size_t word = first / kBitsPerWord; word <= (last - 1) / kBitsPerWord;
+       ++word) {
+    // Publishes the writes of this output to the next one using the blocks.
+    blocks_in_use_[word].fetch_and(~WordMask(word, first, last),
+                                   std::memory_order_release);
+  }
+}
+
+void ExecutorMemoryPlanner::PlanMemory() {
+  // Set last, so that the members set here are visible to the allocation
+  // paths that do not take `mu_`.
+  auto cleanup = gtl::MakeCleanup(
+      [this] { state_.store(State::kPlanned, std::memory_order_release); });
+  // Outputs that are not planned keep offset -1 and are always allocated by
+  // `allocator_`.
+  slices_.resize(outputs_.size());
+
+  // Plan the outputs that were allocated once and freed within the step, from
+  // the largest to the smallest, each at the lowest offset that does not
+  // overlap the outputs already planned that were live at the same time.
+  std::vector<int> planned;
+  for (int i = 0; i < outputs_.size(); ++i) {
+    const Output& output = outputs_[i];
+    if (output.num_allocations == 1 && output.size > 0 &&
+        output.freed > output.allocated) {
+      planned.push_back(i);
+    }
+  }
+  std::stable_sort(planned.begin(), planned.end(), [this](int a, int b) {
+    return outputs_[a].size > outputs_[b].size;
+  });
+
+  const auto aligned_size = [](size_t size) {
+    return (size + Allocator::kAllocatorAlignment - 1) /
+           Allocator::kAllocatorAlignment * Allocator::kAllocatorAlignment;
+  };
+  size_t arena_size = 0;
+  std::vector<std::pair<size_t, size_t>> live;
+  for (int i = 0; i < planned.size(); ++i) {
+    const Output& output = outputs_[planned[i]];
+    live.clear();
+    for (int j = 0; j < i; ++j) {
+      const Output& other = outputs_[planned[j]];
+      if (other.allocated < output.freed && output.allocated < other.freed) {
+        const Slice& slice = slices_[planned[j]];
+        live.emplace_back(slice.offset,
+                          slice.offset + aligned_size(slice.size));
+      }
+    }
+    std::sort(live.begin(), live.end());
+    size_t offset = 0;
+    for (const auto& slice : live) {
+      if (slice.first >= offset + output.size) break;
+      offset = std::max(offset, slice.second);
+    }
+    slices_[planned[i]] = {static_cast<int64>(offset), output.size};
+    arena_size = std::max(arena_size, offset + aligned_size(output.size));
+  }
+  // The profile is not needed anymore.
+  outputs_.clear();
+  outputs_.shrink_to_fit();
+
+  if (arena_size == 0) return;
+  arena_ = static_cast<char*>(
+      allocator_->AllocateRaw(Allocator::kAllocatorAlignment, arena_size));
+  if (arena_ == nullptr) {
+    LOG(WARNING) << "Failed to allocate an arena of " << arena_size
+                 << " bytes for the executor outputs.";
+    return;
+  }
+  arena_size_ = arena_size;
+  num_block_words_ =
+      (arena_size / Allocator::kAllocatorAlignment + kBitsPerWord - 1) /
+      kBitsPerWord;
+  blocks_in_use_.reset(new std::atomic<uint64>[num_block_words_]);
+  for (size_t i = 0; i < num_block_words_; ++i) {
+    blocks_in_use_[i].store(0, std::memory_order_relaxed);
+  }
+  VLOG(1) << "Planned " << planned.size() << " executor outputs in an arena of "
+          << arena_size << " bytes.";
+}
+
+}  // namespace tensorflow
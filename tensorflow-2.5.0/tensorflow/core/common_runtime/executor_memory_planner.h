@@ -0,0 +1,137 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_EXECUTOR_MEMORY_PLANNER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_EXECUTOR_MEMORY_PLANNER_H_
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Plans the memory of the kernel outputs of an executor, so that the steps of
+// an executor with static shapes allocate their outputs from a single arena.
+//
+// Each node output is allocated through its own allocator (see
+// OpKernelContext::Params::output_allocator_array). The first step records
+// the size and the lifetime of every output. When it finishes, each output
+// that was allocated once and freed within the step is assigned an offset in
+// the arena, such that outputs that were live at the same time do not overlap.
+// Later steps allocate these outputs from the arena. An output falls back to
+// the underlying allocator if its size differs from the planned size, or if
+// its slice of the arena is still in use, e.g. by a tensor that outlived a
+// step or by a concurrent step.
+//
+// Once the memory is planned, outputs are allocated and freed without taking
+// a lock: the planned slices are fixed, and the arena blocks in use are
+// tracked in an atomic bitmap.
+class ExecutorMemoryPlanner : public core::RefCounted {
+ public:
+  // `num_outputs[i]` is the number of outputs of node `i`.
+  ExecutorMemoryPlanner(Allocator* allocator,
+                        const std::vector<int>& num_outputs);
+  ~ExecutorMemoryPlanner() override;
+
+  // Returns the allocators of the outputs of node `node_id`. The allocators
+  // keep this planner alive while they own allocated memory.
+  Allocator* const* output_allocators(int node_id) const {
+    return output_allocator_ptrs_.data() + node_output_offsets_[node_id];
+  }
+
+  // Must be called at the start and at the end of every step.
+  void StepStarted();
+  void StepFinished();
+
+  // Returns the size of the arena, or 0 if the memory was not planned yet.
+  size_t arena_size() const;
+
+  // Returns the number of outputs that were allocated from the arena.
+  int64 num_arena_allocations() const;
+
+ private:
+  class OutputAllocator;
+
+  enum class State { kUnplanned, kProfiling, kPlanned };
+
+  // Size and lifetime of an output, in the order of allocation events of the
+  // profiled step.
+  struct Output {
+    size_t size = 0;
+    int num_allocations = 0;
+    int64 allocated = -1;
+    int64 freed = -1;
+  };
+
+  // The slice of the arena planned for an output.
+  struct Slice {
+    // Offset in the arena, or -1 if the output is not planned.
+    int64 offset = -1;
+    size_t size = 0;
+  };
+
+  // Returns the memory of output `index` in the arena, or nullptr if it must
+  // be allocated by the underlying allocator.
+  void* Allocate(int index, size_t alignment, size_t num_bytes);
+  // Returns false if `ptr` was not allocated from the arena.
+  bool Deallocate(int index, void* ptr);
+
+  // Assigns arena offsets to the outputs of the profiled step.
+  void PlanMemory() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Marks the arena blocks of `slice` as in use. Fails without marking any if
+  // one of them is already in use.
+  bool ClaimSlice(const Slice& slice);
+  void ReleaseSlice(const Slice& slice);
+
+  Allocator* const allocator_;
+  std::vector<int> node_output_offsets_;
+  std::vector<std::unique_ptr<OutputAllocator>> output_allocators_;
+  std::vector<Allocator*> output_allocator_ptrs_;
+
+  mutable mutex mu_;
+  // Only changes under `mu_`. Once it is kPlanned, it and the members below
+  // that are set by PlanMemory() no longer change, and are read without `mu_`.
+  std::atomic<State> state_{State::kUnplanned};
+  int num_running_steps_ TF_GUARDED_BY(mu_) = 0;
+  // False if another step ran concurrently with the profiled step.
+  bool profile_is_valid_ TF_GUARDED_BY(mu_) = true;
+  int64 clock_ TF_GUARDED_BY(mu_) = 0;
+  std::vector<Output> outputs_ TF_GUARDED_BY(mu_);
+
+  // Set by PlanMemory().
+  char* arena_ = nullptr;
+  size_t arena_size_ = 0;
+  // Indexed like `output_allocators_`.
+  std::vector<Slice> slices_;
+  // One bit per kAllocatorAlignment bytes of the arena, set while the bytes
+  // belong to an allocated output.
+  std::unique_ptr<std::atomic<uint64>[]> blocks_in_use_;
+  size_t num_block_words_ = 0;
+
+  std::atomic<int64> num_arena_allocations_{0};
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ExecutorMemoryPlanner);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_EXECUTOR_MEMORY_PLANNER_H_
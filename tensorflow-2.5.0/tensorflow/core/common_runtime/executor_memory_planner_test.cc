@@ -0,0 +1,178 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/executor_memory_planner.h"
+
+#include <string.h>
+
+#include <atomic>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+namespace {
+
+class ExecutorMemoryPlannerTest : public ::testing::Test {
+ protected:
+  ExecutorMemoryPlannerTest()
+      : planner_(new ExecutorMemoryPlanner(cpu_allocator(), {1, 2, 1})) {}
+
+  ~ExecutorMemoryPlannerTest() override { planner_->Unref(); }
+
+  Allocator* output_allocator(int node_id, int output) {
+    return planner_->output_allocators(node_id)[output];
+  }
+
+  // Runs a step that allocates the outputs of nodes 0 and 1, frees the output
+  // of node 0, allocates the output of node 2 and frees the others.
+  void RunStep(std::vector<void*>* ptrs) {
+    planner_->StepStarted();
+    void* a = output_allocator(0, 0)->AllocateRaw(64, 1024);
+    void* b = output_allocator(1, 0)->AllocateRaw(64, 256);
+    void* c = output_allocator(1, 1)->AllocateRaw(64, 512);
+    output_allocator(0, 0)->DeallocateRaw(a);
+    void* d = output_allocator(2, 0)->AllocateRaw(64, 1024);
+    output_allocator(1, 0)->DeallocateRaw(b);
+    output_allocator(1, 1)->DeallocateRaw(c);
+    output_allocator(2, 0)->DeallocateRaw(d);
+    planner_->StepFinished();
+    *ptrs = {a, b, c, d};
+  }
+
+  ExecutorMemoryPlanner* planner_;
+};
+
+TEST_F(ExecutorMemoryPlannerTest, PlansOutputsAfterFirstStep) {
+  std::vector<void*> ptrs;
+  RunStep(&ptrs);
+  EXPECT_EQ(planner_->num_arena_allocations(), 0);
+  // Outputs 0 and 2 share a slice, and outputs 1 and 2 are live at the same
+  // time.
+  EXPECT_EQ(planner_->arena_size(), 1024 + 512 + 256);
+
+  RunStep(&ptrs);
+  EXPECT_EQ(planner_->num_arena_allocations(), 4);
+  EXPECT_EQ(ptrs[0], ptrs[3]);
+  EXPECT_NE(ptrs[1], ptrs[2]);
+  EXPECT_NE(ptrs[1], ptrs[3]);
+  EXPECT_NE(ptrs[2], ptrs[3]);
+}
+
+TEST_F(ExecutorMemoryPlannerTest, FallsBackIfSizeChanges) {
+  std::vector<void*> ptrs;
+  RunStep(&ptrs);
+
+  planner_->StepStarted();
+  void* a = output_allocator(0, 0)->AllocateRaw(64, 2048);
+  ASSERT_NE(a, nullptr);
+  output_allocator(0, 0)->DeallocateRaw(a);
+  planner_->StepFinished();
+  EXPECT_EQ(planner_->num_arena_allocations(), 0);
+}
+
+TEST_F(ExecutorMemoryPlannerTest, FallsBackIfSliceIsInUse) {
+  std::vector<void*> ptrs;
+  RunStep(&ptrs);
+
+  planner_->StepStarted();
+  // Output 0 outlives the allocation of output 2, which was planned in the
+  // same slice.
+  void* a = output_allocator(0, 0)->AllocateRaw(64, 1024);
+  void* d = output_allocator(2, 0)->AllocateRaw(64, 1024);
+  ASSERT_NE(d, nullptr);
+  EXPECT_NE(a, d);
+  output_allocator(0, 0)->DeallocateRaw(a);
+  output_allocator(2, 0)->DeallocateRaw(d);
+  planner_->StepFinished();
+  EXPECT_EQ(planner_->num_arena_allocations(), 1);
+}
+
+TEST_F(ExecutorMemoryPlannerTest, ConcurrentStepsDoNotShareSlices) {
+  std::vector<void*> ptrs;
+  RunStep(&ptrs);
+  ASSERT_GT(planner_->arena_size(), 0);
+
+  // Each step fills its outputs with its own byte and checks it before
+  // freeing them, which fails if two live outputs overlap.
+  const int kNumThreads = 8;
+  const int kStepsPerThread = 1000;
+  std::atomic<int> num_corrupted{0};
+  {
+    thread::ThreadPool pool(Env::Default(), "test", kNumThreads);
+    for (int t = 0; t < kNumThreads; ++t) {
+      pool.Schedule([this, t, &num_corrupted]() {
+        const char fill = 'a' + t;
+        auto allocate = [&](int node_id, int output, size_t size) {
+          void* ptr = output_allocator(node_id, output)->AllocateRaw(64, size);
+          memset(ptr, fill, size);
+          return ptr;
+        };
+        auto deallocate = [&](int node_id, int output, void* ptr,
+                              size_t size) {
+          const char* bytes = static_cast<const char*>(ptr);
+          for (size_t i = 0; i < size; ++i) {
+            if (bytes[i] != fill) {
+              ++num_corrupted;
+              break;
+            }
+          }
+          output_allocator(node_id, output)->DeallocateRaw(ptr);
+        };
+        for (int step = 0; step < kStepsPerThread; ++step) {
+          planner_->StepStarted();
+          void* a = allocate(0, 0, 1024);
+          void* b = allocate(1, 0, 256);
+          void* c = allocate(1, 1, 512);
+          deallocate(0, 0, a, 1024);
+          void* d = allocate(2, 0, 1024);
+          deallocate(1, 0, b, 256);
+          deallocate(1, 1, c, 512);
+          deallocate(2, 0, d, 1024);
+          planner_->StepFinished();
+        }
+      });
+    }
+  }
+  EXPECT_EQ(num_corrupted, 0);
+  EXPECT_GT(planner_->num_arena_allocations(), 0);
+}
+
+TEST_F(ExecutorMemoryPlannerTest, DoesNotPlanOutputsThatOutliveTheStep) {
+  planner_->StepStarted();
+  void* a = output_allocator(0, 0)->AllocateRaw(64, 1024);
+  planner_->StepFinished();
+  EXPECT_EQ(planner_->arena_size(), 0);
+  output_allocator(0, 0)->DeallocateRaw(a);
+}
+
+TEST_F(ExecutorMemoryPlannerTest, DoesNotProfileConcurrentSteps) {
+  planner_->StepStarted();
+  planner_->StepStarted();
+  void* a = output_allocator(0, 0)->AllocateRaw(64, 1024);
+  output_allocator(0, 0)->DeallocateRaw(a);
+  planner_->StepFinished();
+  planner_->StepFinished();
+  EXPECT_EQ(planner_->arena_size(), 0);
+
+  std::vector<void*> ptrs;
+  RunStep(&ptrs);
+  EXPECT_GT(planner_->arena_size(), 0);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -91,6 +91,7 @@ class ExecutorTest : public ::testing::Test {
     args.rendezvous = rendez;
     args.stats_collector = &step_stats_collector_;
     args.runner = runner_;
+    args.work_stealing_num_workers = work_stealing_num_workers_;
     return exec_->Run(args);
   }
 
@@ -100,6 +101,7 @@ class ExecutorTest : public ::testing::Test {
   StepStatsCollector step_stats_collector_;
   StepStats step_stats_;
   Executor::Args::Runner runner_;
+  int work_stealing_num_workers_ = 0;
   Rendezvous* rendez_ = nullptr;
 };
 
@@ -255,6 +257,44 @@ TEST_F(ExecutorTest, RandomTree) {
   EXPECT_EQ(4096.0, V(out));
 }
 
+TEST_F(ExecutorTest, RandomTreeWorkStealing) {
+  auto g = absl::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  Create(std::move(g));
+  work_stealing_num_workers_ = thread_pool_->NumThreads();
+  for (int iters = 0; iters < 4; ++iters) {
+    Rendezvous::Args args;
+    TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args,
+                               V(1.0), false));
+    TF_ASSERT_OK(Run(rendez_));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out,
+                               &is_dead));
+    EXPECT_EQ(4096.0, V(out));
+  }
+}
+
+// Runs many short steps, in which workers keep exiting while other workers
+// and the inline thread are still pushing ready nodes.
+TEST_F(ExecutorTest, WorkStealingStress) {
+  auto g = absl::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(64, g.get());
+  Create(std::move(g));
+  work_stealing_num_workers_ = thread_pool_->NumThreads();
+  for (int iters = 0; iters < 2000; ++iters) {
+    Rendezvous::Args args;
+    TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args,
+                               V(1.0), false));
+    TF_ASSERT_OK(Run(rendez_));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out,
+                               &is_dead));
+    ASSERT_EQ(64.0, V(out));
+  }
+}
+
 void BuildConcurrentAddAssign(Graph* g) {
   auto one = test::graph::Constant(g, V(1.0));
   // A variable holds one float.
@@ -433,7 +473,8 @@ TEST_F(ExecutorTest, NoInputTensors) {
 // Create a graph that is 'depth' deep. At each level, fan-in and fan-out a
 // maximum of 'width' nodes. All nodes are no-ops and all dependencies are
 // control dependencies.
-static void BM_executor(::testing::benchmark::State& state) {
+static void BM_executorHelper(::testing::benchmark::State& state,
+                              bool work_stealing) {
   const int width = state.range(0);
   const int depth = state.range(1);
 
@@ -467,12 +508,21 @@ static void BM_executor(::testing::benchmark::State& state) {
   }
 
   FixupSourceAndSinkEdges(g);
-  test::Benchmark("cpu", g, /*old_benchmark_api=*/false).Run(state);
+  SessionOptions options;
+  options.config.mutable_experimental()->set_use_work_stealing_executor(
+      work_stealing);
+  test::Benchmark("cpu", g, &options, nullptr, nullptr, "",
+                  /*old_benchmark_api=*/false)
+      .Run(state);
 
   state.SetLabel(strings::StrCat("Nodes = ", cur));
   state.SetItemsProcessed(cur * static_cast<int64>(state.iterations()));
 }
 
+static void BM_executor(::testing::benchmark::State& state) {
+  BM_executorHelper(state, /*work_stealing=*/false);
+}
+
 // Tall skinny graphs
 BENCHMARK(BM_executor)->UseRealTime()->ArgPair(16, 1024);
 BENCHMARK(BM_executor)->UseRealTime()->ArgPair(32, 8192);
@@ -484,6 +534,16 @@ BENCHMARK(BM_executor)->UseRealTime()->ArgPair(8192, 32);
 // Tall fat graph
 BENCHMARK(BM_executor)->UseRealTime()->ArgPair(1024, 1024);
 
+static void BM_executorWorkStealing(::testing::benchmark::State& state) {
+  BM_executorHelper(state, /*work_stealing=*/true);
+}
+
+BENCHMARK(BM_executorWorkStealing)->UseRealTime()->ArgPair(16, 1024);
+BENCHMARK(BM_executorWorkStealing)->UseRealTime()->ArgPair(32, 8192);
+BENCHMARK(BM_executorWorkStealing)->UseRealTime()->ArgPair(1024, 16);
+BENCHMARK(BM_executorWorkStealing)->UseRealTime()->ArgPair(8192, 32);
+BENCHMARK(BM_executorWorkStealing)->UseRealTime()->ArgPair(1024, 1024);
+
 static void BM_const_identity(::testing::benchmark::State& state) {
   const int width = state.range(0);
   const int outputs_per_const = state.range(1);
@@ -0,0 +1,286 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/function_instantiation_cache.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/graph_constructor.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/public/version.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+namespace {
+
+uint64 FingerprintCatString(uint64 key, StringPiece s) {
+  return FingerprintCat64(key, Fingerprint64(s));
+}
+
+// Environment variables which change how functions are optimized, and so the
+// cached graphs, without showing up in the instantiation options.
+const std::vector<string>& OptimizationEnvVars() {
+  static const std::vector<string>* env_vars = []() {
+    auto* env_vars = new std::vector<string>(
+        {"TF_XLA_FLAGS", "TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_LEVEL",
+         "TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_IGNORE_PERFORMANCE",
+         "TF_USE_CUDNN_BATCHNORM_SPATIAL_PERSISTENT"});
+    for (const char* list_name :
+         {"ALLOWLIST", "INFERLIST", "CLEARLIST", "DENYLIST", "WHITELIST",
+          "GRAYLIST", "BLACKLIST"}) {
+      for (const char* suffix : {"_ADD", "_REMOVE"}) {
+        env_vars->push_back(absl::StrCat(
+            "TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_", list_name, suffix));
+      }
+    }
+    return env_vars;
+  }();
+  return *env_vars;
+}
+
+}  // namespace
+
+FunctionInstantiationCache::FunctionInstantiationCache(
+    Env* env, const string& disk_cache_dir, int capacity)
+    : env_(env), disk_cache_dir_(disk_cache_dir), capacity_(capacity) {}
+
+/* static */ FunctionInstantiationCache* FunctionInstantiationCache::Global() {
+  static FunctionInstantiationCache* cache = []() {
+    bool enabled = false;
+    Status status = ReadBoolFromEnvVar("TF_FUNCTION_INSTANTIATION_CACHE",
+                                       false, &enabled);
+    if (!status.ok()) {
+      LOG(ERROR) << status.error_message();
+    }
+    if (!enabled) return static_cast<FunctionInstantiationCache*>(nullptr);
+    string disk_cache_dir;
+    status = ReadStringFromEnvVar("TF_FUNCTION_INSTANTIATION_CACHE_DIR", "",
+                                  &disk_cache_dir);
+    if (!status.ok()) {
+      LOG(ERROR) << status.error_message();
+    }
+    return new FunctionInstantiationCache(Env::Default(), disk_cache_dir);
+  }();
+  return cache;
+}
+
+/* static */ uint64 FunctionInstantiationCache::Key(
+    const string& function_name, AttrSlice attrs,
+    const FunctionLibraryRuntime::InstantiateOptions& options,
+    const FunctionLibraryDefinition& library, const DeviceSet& devices) {
+  // Canonicalize() identifies the library and the function state by address,
+  // which is neither stable across sessions nor relevant to the graphs, so
+  // fingerprint the library contents instead.
+  FunctionLibraryRuntime::InstantiateOptions key_options = options;
+  key_options.lib_def = nullptr;
+  key_options.state_handle.clear();
+  uint64 key = Fingerprint64(Canonicalize(function_name, attrs, key_options));
+
+  key = FingerprintCatString(key, TF_VERSION_STRING);
+  key = FingerprintCat64(key, TF_GRAPH_DEF_VERSION);
+  key = FingerprintCat64(key, options.is_component_function);
+  key = FingerprintCat64(key, options.default_device_to_target);
+  key = FingerprintCat64(key, options.optimize_graph_fn != nullptr);
+
+  // The disk tier is shared with other processes, which may have been run
+  // with different optimization settings.
+  for (const string& env_var : OptimizationEnvVars()) {
+    const char* value = std::getenv(env_var.c_str());
+    key = FingerprintCatString(
+        key, value == nullptr ? env_var : absl::StrCat(env_var, "=", value));
+  }
+
+  string serialized;
+  SerializeToStringDeterministic(library.ToProto(), &serialized);
+  key = FingerprintCatString(key, serialized);
+
+  std::vector<string> device_names;
+  device_names.reserve(devices.devices().size());
+  for (const Device* device : devices.devices()) {
+    device_names.push_back(device->name());
+  }
+  std::sort(device_names.begin(), device_names.end());
+  for (const string& name : device_names) {
+    key = FingerprintCatString(key, name);
+  }
+
+  std::vector<std::pair<string, const std::vector<string>*>> composite_devices(
+      options.composite_devices.begin(), options.composite_devices.end());
+  std::sort(composite_devices.begin(), composite_devices.end());
+  for (const auto& composite_device : composite_devices) {
+    key = FingerprintCatString(key, composite_device.first);
+    for (const string& underlying_device : *composite_device.second) {
+      key = FingerprintCatString(key, underlying_device);
+    }
+  }
+  return key;
+}
+
+/* static */ std::shared_ptr<const CachedFunctionInstantiation>
+FunctionInstantiationCache::MakeEntry(
+    const std::unordered_map<string, std::unique_ptr<Graph>>& subgraphs,
+    const std::unordered_map<string, string>& node_name_to_control_ret,
+    const FunctionLibraryDefinition& library) {
+  auto entry = std::make_shared<CachedFunctionInstantiation>();
+  for (const auto& subgraph : subgraphs) {
+    GraphDef* graph_def = &(*entry->mutable_partitions())[subgraph.first];
+    subgraph.second->ToGraphDef(graph_def);
+    // The functions are kept once, in `library`, for all the partitions.
+    graph_def->clear_library();
+  }
+  for (const auto& control_ret : node_name_to_control_ret) {
+    (*entry->mutable_node_name_to_control_ret())[control_ret.first] =
+        control_ret.second;
+  }
+  *entry->mutable_library() = library.ToProto();
+  return entry;
+}
+
+/* static */ Status FunctionInstantiationCache::RestoreEntry(
+    const CachedFunctionInstantiation& entry, const DeviceSet& devices,
+    FunctionLibraryDefinition* library,
+    std::unordered_map<string, string>* node_name_to_control_ret,
+    std::unordered_map<string, std::unique_ptr<Graph>>* subgraphs) {
+  TF_RETURN_IF_ERROR(library->AddLibrary(entry.library()));
+
+  for (const auto& partition : entry.partitions()) {
+    if (devices.FindDeviceByName(partition.first) == nullptr) {
+      return errors::NotFound("Cached partition device ", partition.first,
+                              " is not in the device set");
+    }
+    GraphDef graph_def = partition.second;
+    for (NodeDef& node : *graph_def.mutable_node()) {
+      auto incarnation = node.mutable_attr()->find("send_device_incarnation");
+      if (incarnation == node.mutable_attr()->end()) continue;
+      const auto send_device = node.attr().find("send_device");
+      const Device* device =
+          send_device == node.attr().end()
+              ? nullptr
+              : devices.FindDeviceByName(send_device->second.s());
+      if (device == nullptr) {
+        return errors::NotFound("Send device of cached node ", node.name(),
+                                " is not in the device set");
+      }
+      incarnation->second.set_i(
+          static_cast<int64>(device->attributes().incarnation()));
+    }
+
+    // Mirror PartitionFunctionGraph(), which gives each partition the
+    // functions it calls.
+    auto subgraph =
+        absl::make_unique<Graph>(library->ReachableDefinitions(graph_def));
+    GraphConstructorOptions opts;
+    opts.allow_internal_ops = true;
+    opts.expect_device_spec = true;
+    TF_RETURN_IF_ERROR(
+        ConvertGraphDefToGraph(opts, std::move(graph_def), subgraph.get()));
+    subgraphs->emplace(partition.first, std::move(subgraph));
+  }
+
+  for (const auto& control_ret : entry.node_name_to_control_ret()) {
+    node_name_to_control_ret->emplace(control_ret.first, control_ret.second);
+  }
+  return Status::OK();
+}
+
+std::shared_ptr<const CachedFunctionInstantiation>
+FunctionInstantiationCache::Lookup(uint64 key) {
+  {
+    mutex_lock l(mu_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+      ++num_hits_;
+      return it->second;
+    }
+  }
+
+  if (!disk_cache_dir_.empty()) {
+    const string path = DiskCachePath(key);
+    if (env_->FileExists(path).ok()) {
+      auto entry = std::make_shared<CachedFunctionInstantiation>();
+      Status status = ReadBinaryProto(env_, path, entry.get());
+      if (status.ok()) {
+        mutex_lock l(mu_);
+        ++num_hits_;
+        InsertInMemory(key, entry);
+        return entry;
+      }
+      LOG(WARNING) << "Ignoring unreadable cached function instantiation "
+                   << path << ": " << status;
+    }
+  }
+
+  mutex_lock l(mu_);
+  ++num_misses_;
+  return nullptr;
+}
+
+void FunctionInstantiationCache::Insert(
+    uint64 key, std::shared_ptr<const CachedFunctionInstantiation> entry) {
+  if (!disk_cache_dir_.empty()) {
+    // Write to a temporary file first, so that concurrent readers, possibly
+    // in other processes, never see a partial entry.
+    const string path = DiskCachePath(key);
+    const string tmp_path = absl::StrCat(path, ".tmp", env_->NowMicros());
+    Status status = WriteBinaryProto(env_, tmp_path, *entry);
+    if (status.ok()) status = env_->RenameFile(tmp_path, path);
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to write cached function instantiation " << path
+                   << ": " << status;
+      env_->DeleteFile(tmp_path).IgnoreError();
+    }
+  }
+
+  mutex_lock l(mu_);
+  InsertInMemory(key, std::move(entry));
+}
+
+int64 FunctionInstantiationCache::num_hits() const {
+  mutex_lock l(mu_);
+  return num_hits_;
+}
+
+int64 FunctionInstantiationCache::num_misses() const {
+  mutex_lock l(mu_);
+  return num_misses_;
+}
+
+string FunctionInstantiationCache::DiskCachePath(uint64 key) const {
+  return io::JoinPath(disk_cache_dir_, absl::StrFormat("%016x.pb", key));
+}
+
+void FunctionInstantiationCache::InsertInMemory(
+    uint64 key, std::shared_ptr<const CachedFunctionInstantiation> entry) {
+  if (!entries_.emplace(key, std::move(entry)).second) return;
+  insertion_order_.push_back(key);
+  while (insertion_order_.size() > static_cast<size_t>(capacity_)) {
+    entries_.erase(insertion_order_.front());
+    insertion_order_.pop_front();
+  }
+}
+
+}  // namespace tensorflow
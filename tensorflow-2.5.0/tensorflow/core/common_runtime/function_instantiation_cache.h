@@ -0,0 +1,130 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_FUNCTION_INSTANTIATION_CACHE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_FUNCTION_INSTANTIATION_CACHE_H_
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "tensorflow/core/common_runtime/device_set.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/function_instantiation_cache.pb.h"
+
+namespace tensorflow {
+
+// Keeps the optimized partition graphs of instantiated multi-device
+// functions, so that a ProcessFunctionLibraryRuntime instantiating the same
+// function with the same attributes, options and devices again can skip the
+// function and graph optimization passes, placement and partitioning. Only
+// graphs are cached; each runtime still creates its own executors.
+//
+// A cache is meant to be shared by the runtimes of several sessions, e.g. of a
+// server hosting the same SavedModel more than once. If created with a
+// directory, it also writes its entries there and looks up the entries it does
+// not hold in memory there, so that they outlive the process.
+//
+// This class is thread-safe.
+class FunctionInstantiationCache {
+ public:
+  // Keeps up to `capacity` entries in memory, evicting the oldest one first.
+  // If `disk_cache_dir` is non-empty, entries are also stored in that
+  // directory of `env`, which must exist.
+  FunctionInstantiationCache(Env* env, const string& disk_cache_dir,
+                             int capacity = 256);
+
+  // Returns the cache shared by all the ProcessFunctionLibraryRuntimes of this
+  // process, or nullptr unless the TF_FUNCTION_INSTANTIATION_CACHE environment
+  // variable is true. Its on-disk tier is the directory named by
+  // TF_FUNCTION_INSTANTIATION_CACHE_DIR, if set.
+  static FunctionInstantiationCache* Global();
+
+  // Returns the key of instantiating `function_name` with `attrs` and
+  // `options` on `devices`, where `library` holds the function and all the
+  // functions it calls. The key also covers the TensorFlow version, since the
+  // optimization passes, and so the cached graphs, may change between
+  // versions, and the environment variables that configure those passes,
+  // such as TF_XLA_FLAGS.
+  static uint64 Key(const string& function_name, AttrSlice attrs,
+                    const FunctionLibraryRuntime::InstantiateOptions& options,
+                    const FunctionLibraryDefinition& library,
+                    const DeviceSet& devices);
+
+  // Returns a cache entry for the partition graphs `subgraphs`, keyed by
+  // device name, whose control outputs are given by
+  // `node_name_to_control_ret` and which call functions in `library`.
+  static std::shared_ptr<const CachedFunctionInstantiation> MakeEntry(
+      const std::unordered_map<string, std::unique_ptr<Graph>>& subgraphs,
+      const std::unordered_map<string, string>& node_name_to_control_ret,
+      const FunctionLibraryDefinition& library);
+
+  // Rebuilds the partition graphs and control outputs in `entry` for
+  // `devices`, adding the functions they call to `library`. The Send and Recv
+  // nodes are updated with the incarnations of the devices in `devices`,
+  // which differ from the ones the entry was created with unless both come
+  // from the same process.
+  static Status RestoreEntry(
+      const CachedFunctionInstantiation& entry, const DeviceSet& devices,
+      FunctionLibraryDefinition* library,
+      std::unordered_map<string, string>* node_name_to_control_ret,
+      std::unordered_map<string, std::unique_ptr<Graph>>* subgraphs);
+
+  // Returns the entry for `key`, looking it up on disk if it is not held in
+  // memory, or nullptr if there is none.
+  std::shared_ptr<const CachedFunctionInstantiation> Lookup(uint64 key);
+
+  // Stores `entry` for `key`, in memory and, if enabled, on disk.
+  void Insert(uint64 key,
+              std::shared_ptr<const CachedFunctionInstantiation> entry);
+
+  int64 num_hits() const;
+  int64 num_misses() const;
+
+ private:
+  // Returns the file holding the entry for `key` in disk_cache_dir_.
+  string DiskCachePath(uint64 key) const;
+
+  // Stores `entry` in memory, evicting the oldest entries beyond capacity_.
+  void InsertInMemory(uint64 key,
+                      std::shared_ptr<const CachedFunctionInstantiation> entry)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Env* const env_;
+  const string disk_cache_dir_;
+  const int capacity_;
+
+  mutable mutex mu_;
+  std::unordered_map<uint64, std::shared_ptr<const CachedFunctionInstantiation>>
+      entries_ TF_GUARDED_BY(mu_);
+  // Keys of `entries_` in insertion order.
+  std::deque<uint64> insertion_order_ TF_GUARDED_BY(mu_);
+  int64 num_hits_ TF_GUARDED_BY(mu_) = 0;
+  int64 num_misses_ TF_GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FunctionInstantiationCache);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_FUNCTION_INSTANTIATION_CACHE_H_
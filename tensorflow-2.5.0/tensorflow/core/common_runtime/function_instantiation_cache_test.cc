@@ -0,0 +1,200 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/function_instantiation_cache.h"
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/device_set.h"
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+FunctionDefLibrary XTimesTwoLibrary() {
+  FunctionDefLibrary library;
+  *library.add_function() = test::function::XTimesTwo();
+  return library;
+}
+
+class FunctionInstantiationCacheTest : public ::testing::Test {
+ protected:
+  FunctionInstantiationCacheTest()
+      : lib_def_(OpRegistry::Global(), XTimesTwoLibrary()) {
+    device_ = DeviceFactory::NewDevice("CPU", SessionOptions(),
+                                       "/job:a/replica:0/task:0");
+    devices_.AddDevice(device_.get());
+  }
+
+  uint64 Key(const FunctionLibraryRuntime::InstantiateOptions& options,
+             DataType type) {
+    AttrValueMap attrs;
+    SetAttrValue(type, &attrs["T"]);
+    return FunctionInstantiationCache::Key("XTimesTwo", AttrSlice(&attrs),
+                                           options, lib_def_, devices_);
+  }
+
+  // Returns an entry with a single partition on device_ that sends a
+  // constant with the given send device incarnation.
+  CachedFunctionInstantiation SendEntry(int64 incarnation) {
+    CachedFunctionInstantiation entry;
+    GraphDef* graph_def = &(*entry.mutable_partitions())[device_->name()];
+    CHECK(protobuf::TextFormat::ParseFromString(
+        strings::StrCat(
+            "node { name: 'c' op: 'Const' device: '", device_->name(), "'",
+            "       attr { key: 'dtype' value { type: DT_FLOAT } }",
+            "       attr { key: 'value' value { tensor {",
+            "         dtype: DT_FLOAT tensor_shape {} float_val: 1 } } } }",
+            "node { name: 's' op: '_Send' input: 'c' device: '",
+            device_->name(), "'",
+            "       attr { key: 'T' value { type: DT_FLOAT } }",
+            "       attr { key: 'tensor_name' value { s: 'edge_1_c' } }",
+            "       attr { key: 'send_device' value { s: '", device_->name(),
+            "' } }",
+            "       attr { key: 'recv_device' value { s: '", device_->name(),
+            "' } }",
+            "       attr { key: 'send_device_incarnation'",
+            "              value { i: ", incarnation, " } }",
+            "       attr { key: 'client_terminated' value { b: false } } }"),
+        graph_def));
+    (*entry.mutable_node_name_to_control_ret())["s"] = "send";
+    return entry;
+  }
+
+  FunctionLibraryDefinition lib_def_;
+  std::unique_ptr<Device> device_;
+  DeviceSet devices_;
+};
+
+TEST_F(FunctionInstantiationCacheTest, KeyCoversAttrsOptionsAndVersions) {
+  FunctionLibraryRuntime::InstantiateOptions options;
+  const uint64 key = Key(options, DT_FLOAT);
+  EXPECT_EQ(key, Key(options, DT_FLOAT));
+  EXPECT_NE(key, Key(options, DT_INT32));
+
+  FunctionLibraryRuntime::InstantiateOptions target_options;
+  target_options.target = device_->name();
+  EXPECT_NE(key, Key(target_options, DT_FLOAT));
+
+  // The library address and the function state do not change the graphs.
+  FunctionLibraryDefinition other_lib_def(lib_def_);
+  FunctionLibraryRuntime::InstantiateOptions state_options;
+  state_options.lib_def = &other_lib_def;
+  state_options.state_handle = "state";
+  EXPECT_EQ(key, Key(state_options, DT_FLOAT));
+
+  // The library contents do.
+  TF_ASSERT_OK(lib_def_.AddFunctionDef(test::function::XTimesFour()));
+  EXPECT_NE(key, Key(options, DT_FLOAT));
+}
+
+TEST_F(FunctionInstantiationCacheTest, KeyCoversOptimizationEnvVars) {
+  constexpr char kEnvVar[] =
+      "TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_DENYLIST_ADD";
+  FunctionLibraryRuntime::InstantiateOptions options;
+  unsetenv(kEnvVar);
+  const uint64 key = Key(options, DT_FLOAT);
+  setenv(kEnvVar, "Mul", 1);
+  EXPECT_NE(key, Key(options, DT_FLOAT));
+  unsetenv(kEnvVar);
+  EXPECT_EQ(key, Key(options, DT_FLOAT));
+}
+
+TEST_F(FunctionInstantiationCacheTest, InsertLookupAndEvict) {
+  FunctionInstantiationCache cache(Env::Default(), "", /*capacity=*/2);
+  EXPECT_EQ(nullptr, cache.Lookup(1));
+  auto entry = std::make_shared<CachedFunctionInstantiation>(SendEntry(0));
+  cache.Insert(1, entry);
+  EXPECT_EQ(entry, cache.Lookup(1));
+
+  cache.Insert(2, std::make_shared<CachedFunctionInstantiation>());
+  cache.Insert(3, std::make_shared<CachedFunctionInstantiation>());
+  EXPECT_EQ(nullptr, cache.Lookup(1));
+  EXPECT_NE(nullptr, cache.Lookup(2));
+  EXPECT_NE(nullptr, cache.Lookup(3));
+  EXPECT_EQ(3, cache.num_hits());
+  EXPECT_EQ(2, cache.num_misses());
+}
+
+TEST_F(FunctionInstantiationCacheTest, DiskTier) {
+  const string dir = io::JoinPath(testing::TmpDir(), "function_cache_disk");
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(dir));
+  {
+    FunctionInstantiationCache cache(Env::Default(), dir);
+    cache.Insert(42, std::make_shared<CachedFunctionInstantiation>(
+                         SendEntry(7)));
+  }
+
+  // A new cache, e.g. in another process, finds the entry on disk.
+  FunctionInstantiationCache cache(Env::Default(), dir);
+  std::shared_ptr<const CachedFunctionInstantiation> entry = cache.Lookup(42);
+  ASSERT_NE(nullptr, entry);
+  ASSERT_EQ(1, entry->partitions_size());
+  EXPECT_EQ(2, entry->partitions().at(device_->name()).node_size());
+  EXPECT_EQ(nullptr, cache.Lookup(43));
+}
+
+TEST_F(FunctionInstantiationCacheTest, RestoreEntryUpdatesIncarnations) {
+  std::unordered_map<string, string> node_name_to_control_ret;
+  std::unordered_map<string, std::unique_ptr<Graph>> subgraphs;
+  TF_ASSERT_OK(FunctionInstantiationCache::RestoreEntry(
+      SendEntry(12345), devices_, &lib_def_, &node_name_to_control_ret,
+      &subgraphs));
+  EXPECT_EQ("send", node_name_to_control_ret["s"]);
+  ASSERT_EQ(1, subgraphs.count(device_->name()));
+
+  bool found_send = false;
+  for (const Node* node : subgraphs[device_->name()]->op_nodes()) {
+    if (node->name() != "s") continue;
+    found_send = true;
+    int64 incarnation;
+    TF_ASSERT_OK(
+        GetNodeAttr(node->attrs(), "send_device_incarnation", &incarnation));
+    EXPECT_EQ(static_cast<int64>(device_->attributes().incarnation()),
+              incarnation);
+    EXPECT_EQ(device_->name(), node->assigned_device_name());
+  }
+  EXPECT_TRUE(found_send);
+}
+
+TEST_F(FunctionInstantiationCacheTest, RestoreEntryRejectsUnknownDevice) {
+  CachedFunctionInstantiation entry;
+  (*entry.mutable_partitions())["/job:b/replica:0/task:0/device:CPU:0"];
+  std::unordered_map<string, string> node_name_to_control_ret;
+  std::unordered_map<string, std::unique_ptr<Graph>> subgraphs;
+  EXPECT_FALSE(FunctionInstantiationCache::RestoreEntry(
+                   entry, devices_, &lib_def_, &node_name_to_control_ret,
+                   &subgraphs)
+                   .ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
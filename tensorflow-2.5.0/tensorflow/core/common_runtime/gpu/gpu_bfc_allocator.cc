@@ -83,6 +83,8 @@ GPUBFCAllocator::GPUBFCAllocator(SubAllocator* sub_allocator,
                                  const string& name)
     : BFCAllocator(sub_allocator, total_memory,
                    GPUBFCAllocator::GetAllowGrowthValue(gpu_options), name,
-                   GPUBFCAllocator::GetGarbageCollectionValue()) {}
+                   GPUBFCAllocator::GetGarbageCollectionValue(),
+                   gpu_options.experimental().small_allocation_cache_bytes()) {
+}
 
 }  // namespace tensorflow
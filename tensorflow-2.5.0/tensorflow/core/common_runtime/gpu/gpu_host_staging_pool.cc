@@ -0,0 +1,87 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_host_staging_pool.h"
+
+#include "tensorflow/core/lib/core/bits.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+constexpr size_t GpuHostStagingPool::kMinSizeClassBytes;
+
+GpuHostStagingPool::GpuHostStagingPool(Allocator* host_allocator,
+                                       int64 max_cached_bytes)
+    : host_allocator_(host_allocator), max_cached_bytes_(max_cached_bytes) {
+  CHECK(host_allocator_ != nullptr);
+}
+
+GpuHostStagingPool::~GpuHostStagingPool() {
+  mutex_lock l(mu_);
+  for (std::vector<void*>& buffers : free_buffers_) {
+    for (void* ptr : buffers) {
+      host_allocator_->DeallocateRaw(ptr);
+    }
+  }
+}
+
+int GpuHostStagingPool::SizeClass(size_t num_bytes) {
+  if (num_bytes <= kMinSizeClassBytes) return 0;
+  return Log2Ceiling64(num_bytes) - Log2Ceiling64(kMinSizeClassBytes);
+}
+
+size_t GpuHostStagingPool::SizeClassBytes(size_t num_bytes) {
+  return kMinSizeClassBytes << SizeClass(num_bytes);
+}
+
+void* GpuHostStagingPool::Allocate(size_t num_bytes) {
+  const int size_class = SizeClass(num_bytes);
+  {
+    mutex_lock l(mu_);
+    if (size_class < static_cast<int>(free_buffers_.size()) &&
+        !free_buffers_[size_class].empty()) {
+      void* ptr = free_buffers_[size_class].back();
+      free_buffers_[size_class].pop_back();
+      cached_bytes_ -= kMinSizeClassBytes << size_class;
+      return ptr;
+    }
+  }
+  return host_allocator_->AllocateRaw(Allocator::kAllocatorAlignment,
+                                      kMinSizeClassBytes << size_class);
+}
+
+void GpuHostStagingPool::Deallocate(void* ptr, size_t num_bytes) {
+  const int size_class = SizeClass(num_bytes);
+  const int64 size_class_bytes = kMinSizeClassBytes << size_class;
+  {
+    mutex_lock l(mu_);
+    if (cached_bytes_ + size_class_bytes <= max_cached_bytes_) {
+      if (size_class >= static_cast<int>(free_buffers_.size())) {
+        free_buffers_.resize(size_class + 1);
+      }
+      free_buffers_[size_class].push_back(ptr);
+      cached_bytes_ += size_class_bytes;
+      return;
+    }
+  }
+  host_allocator_->DeallocateRaw(ptr);
+}
+
+int64 GpuHostStagingPool::cached_bytes() const {
+  mutex_lock l(mu_);
+  return cached_bytes_;
+}
+
+}  // namespace tensorflow
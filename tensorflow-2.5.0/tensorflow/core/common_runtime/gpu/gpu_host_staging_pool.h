@@ -0,0 +1,75 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_HOST_STAGING_POOL_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_HOST_STAGING_POOL_H_
+
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A cache of pinned host buffers used to stage copies between GPUs and
+// pageable host memory.
+//
+// A DMA to or from pageable memory blocks the calling thread until the copy
+// stream drains, so GPUUtil copies through one of these buffers instead and
+// moves the data to or from its final location on the host. Buffers are
+// rounded up to a power of two so that freed ones can be reused by copies of
+// similar size without going back to the host allocator.
+class GpuHostStagingPool {
+ public:
+  // The smallest size class, in bytes.
+  static constexpr size_t kMinSizeClassBytes = 4096;
+
+  // Buffers are allocated from `host_allocator`, which must return memory GPUs
+  // can DMA to and from. At most `max_cached_bytes` of free buffers are kept.
+  GpuHostStagingPool(Allocator* host_allocator, int64 max_cached_bytes);
+  ~GpuHostStagingPool();
+
+  // Returns a buffer of at least `num_bytes`, or nullptr if the host allocator
+  // is out of memory.
+  void* Allocate(size_t num_bytes);
+
+  // Returns a buffer obtained from Allocate(num_bytes) to the pool.
+  void Deallocate(void* ptr, size_t num_bytes);
+
+  // Returns the size of the buffers handed out for `num_bytes`.
+  static size_t SizeClassBytes(size_t num_bytes);
+
+  // Returns the total size of the free buffers held by the pool.
+  int64 cached_bytes() const;
+
+ private:
+  static int SizeClass(size_t num_bytes);
+
+  Allocator* const host_allocator_;  // Not owned.
+  const int64 max_cached_bytes_;
+
+  mutable mutex mu_;
+  // Free buffers, indexed by size class.
+  std::vector<std::vector<void*>> free_buffers_ TF_GUARDED_BY(mu_);
+  int64 cached_bytes_ TF_GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(GpuHostStagingPool);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_HOST_STAGING_POOL_H_
@@ -0,0 +1,67 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_host_staging_pool.h"
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(GpuHostStagingPoolTest, SizeClasses) {
+  EXPECT_EQ(GpuHostStagingPool::SizeClassBytes(1), 4096);
+  EXPECT_EQ(GpuHostStagingPool::SizeClassBytes(4096), 4096);
+  EXPECT_EQ(GpuHostStagingPool::SizeClassBytes(4097), 8192);
+  EXPECT_EQ(GpuHostStagingPool::SizeClassBytes(1 << 20), 1 << 20);
+  EXPECT_EQ(GpuHostStagingPool::SizeClassBytes((1 << 20) + 1), 2 << 20);
+}
+
+TEST(GpuHostStagingPoolTest, ReusesBuffersOfTheSameSizeClass) {
+  GpuHostStagingPool pool(cpu_allocator(), 1 << 20);
+  void* a = pool.Allocate(5000);
+  ASSERT_NE(a, nullptr);
+  pool.Deallocate(a, 5000);
+  EXPECT_EQ(pool.cached_bytes(), 8192);
+
+  // Same size class.
+  void* b = pool.Allocate(8000);
+  EXPECT_EQ(a, b);
+  EXPECT_EQ(pool.cached_bytes(), 0);
+
+  // Different size class.
+  void* c = pool.Allocate(100);
+  EXPECT_NE(b, c);
+  pool.Deallocate(b, 8000);
+  pool.Deallocate(c, 100);
+  EXPECT_EQ(pool.cached_bytes(), 8192 + 4096);
+}
+
+TEST(GpuHostStagingPoolTest, FreesBuffersBeyondTheCacheLimit) {
+  GpuHostStagingPool pool(cpu_allocator(), 8192);
+  void* a = pool.Allocate(8192);
+  void* b = pool.Allocate(8192);
+  pool.Deallocate(a, 8192);
+  pool.Deallocate(b, 8192);
+  EXPECT_EQ(pool.cached_bytes(), 8192);
+
+  // Buffers larger than the limit are never cached.
+  void* c = pool.Allocate(1 << 20);
+  pool.Deallocate(c, 1 << 20);
+  EXPECT_EQ(pool.cached_bytes(), 8192);
+}
+
+}  // namespace
+}  // namespace tensorflow
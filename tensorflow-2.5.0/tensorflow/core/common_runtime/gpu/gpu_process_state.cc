@@ -320,9 +320,20 @@ Allocator* GPUProcessState::GetGpuHostAllocator(int numa_node) {
     while (gpu_host_free_visitors_.size() <= numa_node) {
       gpu_host_free_visitors_.push_back({});
     }
+    std::vector<SubAllocator::Visitor> alloc_visitors =
+        gpu_host_alloc_visitors_[numa_node];
+    alloc_visitors.push_back([this](void* ptr, int, size_t num_bytes) {
+      mutex_lock l(gpu_host_regions_mu_);
+      gpu_host_regions_[reinterpret_cast<uintptr_t>(ptr)] = num_bytes;
+    });
+    std::vector<SubAllocator::Visitor> free_visitors =
+        gpu_host_free_visitors_[numa_node];
+    free_visitors.push_back([this](void* ptr, int, size_t) {
+      mutex_lock l(gpu_host_regions_mu_);
+      gpu_host_regions_.erase(reinterpret_cast<uintptr_t>(ptr));
+    });
     SubAllocator* sub_allocator = new DeviceHostAllocator(
-        se, numa_node, gpu_host_alloc_visitors_[numa_node],
-        gpu_host_free_visitors_[numa_node]);
+        se, numa_node, alloc_visitors, free_visitors);
     // TODO(zheng-xq): evaluate whether 64GB by default is the best choice.
     int64 gpu_host_mem_limit_in_mb = -1;
     Status status = ReadInt64FromEnvVar("TF_GPU_HOST_MEM_LIMIT_IN_MB",
@@ -366,6 +377,42 @@ Allocator* GPUProcessState::GetGpuHostAllocator(int numa_node) {
   }
 }
 
+GpuHostStagingPool* GPUProcessState::GetGpuHostStagingPool() {
+  CHECK(process_state_);
+  if (!HasGPUDevice() ||
+      !process_state_->ProcessState::FLAGS_brain_mem_reg_gpu_dma) {
+    return nullptr;
+  }
+  {
+    tf_shared_lock lock(mu_);
+    if (gpu_host_staging_pool_ != nullptr) {
+      return gpu_host_staging_pool_.get();
+    }
+  }
+  Allocator* host_allocator = GetGpuHostAllocator(0);
+  int64 max_cached_mb = 0;
+  Status status = ReadInt64FromEnvVar("TF_GPU_HOST_STAGING_POOL_LIMIT_IN_MB",
+                                      256, &max_cached_mb);
+  if (!status.ok()) {
+    LOG(ERROR) << "GetGpuHostStagingPool: " << status.error_message();
+  }
+  mutex_lock lock(mu_);
+  if (gpu_host_staging_pool_ == nullptr) {
+    gpu_host_staging_pool_.reset(
+        new GpuHostStagingPool(host_allocator, max_cached_mb * (1LL << 20)));
+  }
+  return gpu_host_staging_pool_.get();
+}
+
+bool GPUProcessState::IsGpuHostMemory(const void* ptr) {
+  const uintptr_t address = reinterpret_cast<uintptr_t>(ptr);
+  tf_shared_lock l(gpu_host_regions_mu_);
+  auto it = gpu_host_regions_.upper_bound(address);
+  if (it == gpu_host_regions_.begin()) return false;
+  --it;
+  return address < it->first + it->second;
+}
+
 void GPUProcessState::AddGPUAllocVisitor(int bus_id,
                                          const SubAllocator::Visitor& visitor) {
 #if (defined(GOOGLE_CUDA) && GOOGLE_CUDA) || \
@@ -421,6 +468,7 @@ void GPUProcessState::TestOnlyReset() {
     gpu_device_enabled_ = false;
     gpu_allocators_.clear();
     gpu_visitors_.clear();
+    gpu_host_staging_pool_.reset();
     gpu_host_allocators_.clear();
     gpu_host_alloc_visitors_.clear();
     gpu_host_free_visitors_.clear();
@@ -21,6 +21,7 @@ limitations under the License.
 #include <unordered_map>
 #include <vector>
 
+#include "tensorflow/core/common_runtime/gpu/gpu_host_staging_pool.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id.h"
 #include "tensorflow/core/common_runtime/process_state.h"
 #include "tensorflow/core/common_runtime/shared_counter.h"
@@ -92,6 +93,15 @@ class GPUProcessState {
 
   virtual Allocator* GetGpuHostAllocator(int numa_node);
 
+  // Returns the pool of pinned buffers used to stage copies between GPUs and
+  // pageable host memory, or nullptr if host memory isn't registered with
+  // GPUs.
+  virtual GpuHostStagingPool* GetGpuHostStagingPool();
+
+  // Returns true if 'ptr' points into memory allocated by a GpuHostAllocator,
+  // which GPUs can DMA to and from without staging.
+  bool IsGpuHostMemory(const void* ptr);
+
   // Registers a Visitor to be invoked on new chunks of memory allocated by the
   // SubAllocator of every GPU proximate to the specified bus.  The AllocVisitor
   // is provided with a memory pointer, a GPU id, and the size of the area it
@@ -157,6 +167,14 @@ class GPUProcessState {
       TF_GUARDED_BY(mu_);
   std::vector<std::vector<SubAllocator::Visitor>> gpu_host_free_visitors_
       TF_GUARDED_BY(mu_);
+  std::unique_ptr<GpuHostStagingPool> gpu_host_staging_pool_
+      TF_GUARDED_BY(mu_);
+
+  // Start address and size of each region the GpuHostAllocators got from
+  // their SubAllocators.
+  mutex gpu_host_regions_mu_;
+  std::map<uintptr_t, size_t> gpu_host_regions_
+      TF_GUARDED_BY(gpu_host_regions_mu_);
 };
 
 }  // namespace tensorflow
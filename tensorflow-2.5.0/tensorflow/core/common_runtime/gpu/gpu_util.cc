@@ -15,10 +15,13 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_util.h"
 
+#include <cstring>
+
 #include "tensorflow/core/common_runtime/copy_tensor.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device/device_event_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_host_staging_pool.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
 #include "tensorflow/core/common_runtime/gpu_device_context.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -250,6 +253,21 @@ void GPUUtil::DeviceToDeviceCopy(
 static CopyTensor::Registration register_gpu_gpu_copy(
     DEVICE_GPU, DEVICE_GPU, GPUUtil::DeviceToDeviceCopy);
 
+namespace {
+
+// Returns a pinned buffer to stage a copy of 'num_bytes' through if
+// 'host_ptr' is pageable, or nullptr if the copy can use 'host_ptr' directly.
+void* AllocateStagingBuffer(const void* host_ptr, int64 num_bytes,
+                            GpuHostStagingPool** staging_pool) {
+  GPUProcessState* process_state = GPUProcessState::singleton();
+  if (process_state->IsGpuHostMemory(host_ptr)) return nullptr;
+  *staging_pool = process_state->GetGpuHostStagingPool();
+  if (*staging_pool == nullptr) return nullptr;
+  return (*staging_pool)->Allocate(num_bytes);
+}
+
+}  // namespace
+
 // static
 void GPUUtil::CopyGPUTensorToCPU(Device* gpu_device,
                                  const DeviceContext* device_context,
@@ -276,21 +294,32 @@ void GPUUtil::CopyGPUTensorToCPU(Device* gpu_device,
   send_device_to_host_stream->ThenWaitFor(send_stream);
 
   const int64 total_bytes = gpu_tensor->TotalBytes();
+  void* dst_ptr = nullptr;
+  GpuHostStagingPool* staging_pool = nullptr;
+  void* staging_ptr = nullptr;
   if (total_bytes > 0) {
     void* src_ptr = GetBase(gpu_tensor);
     DeviceMemoryBase gpu_src_ptr(src_ptr, total_bytes);
-    void* dst_ptr = GetBase(cpu_tensor);
-    send_device_to_host_stream->ThenMemcpy(dst_ptr, gpu_src_ptr, total_bytes);
+    dst_ptr = GetBase(cpu_tensor);
+    staging_ptr = AllocateStagingBuffer(dst_ptr, total_bytes, &staging_pool);
+    send_device_to_host_stream->ThenMemcpy(
+        staging_ptr != nullptr ? staging_ptr : dst_ptr, gpu_src_ptr,
+        total_bytes);
   }
   // Use of the input may outlive stack scope, so keep a ref.
   TensorReference input_ref(*gpu_tensor);
   dev_info->event_mgr->ThenExecute(
       send_device_to_host_stream,
-      [send_device_to_host_stream, done, input_ref]() {
+      [send_device_to_host_stream, done, input_ref, dst_ptr, staging_pool,
+       staging_ptr, total_bytes]() {
         if (!send_device_to_host_stream->ok()) {
           LOG(FATAL) << "GPU->CPU Memcpy failed";
         }
         input_ref.Unref();
+        if (staging_ptr != nullptr) {
+          std::memcpy(dst_ptr, staging_ptr, total_bytes);
+          staging_pool->Deallocate(staging_ptr, total_bytes);
+        }
         done(Status::OK());
       });
 }
@@ -323,19 +352,30 @@ void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
   }
 
   const int64 total_bytes = cpu_tensor->TotalBytes();
+  GpuHostStagingPool* staging_pool = nullptr;
+  void* staging_ptr = nullptr;
   // Note that 0-size tensors have no backing buffer.
   if (total_bytes > 0) {
     void* src_ptr = GetBase(cpu_tensor);
     void* dst_ptr = GetBase(gpu_tensor);
     DeviceMemoryBase gpu_dst_ptr(dst_ptr, total_bytes);
+    staging_ptr = AllocateStagingBuffer(src_ptr, total_bytes, &staging_pool);
+    if (staging_ptr != nullptr) {
+      std::memcpy(staging_ptr, src_ptr, total_bytes);
+      src_ptr = staging_ptr;
+    }
     recv_host_to_device_stream->ThenMemcpy(&gpu_dst_ptr, src_ptr, total_bytes);
   }
   // Use of cpu_tensor may outlive stack scope, so keep a ref.
   TensorReference input_ref(*cpu_tensor);
   dev_info->event_mgr->ThenExecute(
       recv_host_to_device_stream,
-      [recv_host_to_device_stream, done, input_ref]() {
+      [recv_host_to_device_stream, done, input_ref, staging_pool, staging_ptr,
+       total_bytes]() {
         input_ref.Unref();
+        if (staging_ptr != nullptr) {
+          staging_pool->Deallocate(staging_ptr, total_bytes);
+        }
         if (!recv_host_to_device_stream->ok()) {
           LOG(FATAL) << "CPU->GPU Memcpy failed";
         }
@@ -39,11 +39,14 @@ limitations under the License.
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/tensor_id.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/scanner.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
@@ -57,6 +60,12 @@ namespace {
 // can skip expensive duplicates check in 'AddControlEdge'.
 static constexpr const bool kDoNotCheckDuplicates = true;
 
+// GraphDefs with at least this many nodes have their NodeDefs looked up,
+// defaulted and validated concurrently before any node is added to the Graph
+// (see GraphConstructor::PrepareNodeDefs()). Below it, spinning up the worker
+// threads costs more than it saves.
+static constexpr const int kMinNodesForParallelPrepare = 4096;
+
 inline bool IsMerge(const NodeDef& node_def) {
   return node_def.op() == "Merge" || node_def.op() == "RefMerge" ||
          node_def.op() == "_XlaMerge";
@@ -226,7 +235,9 @@ class GraphConstructor {
            absl::flat_hash_set<int>* unvisited);
   Status IsNodeFullyMapped(const NodeDef& node_def, bool* is_node_mapped);
   Status ValidateColocationConstraints(const NodeDef& node_def);
-  Status MakeNode(NodeDef&& node_def, Node** node);
+  Status PrepareNodeDefs();
+  struct PreparedNode;
+  Status MakeNode(NodeDef&& node_def, PreparedNode* prepared, Node** node);
   Status MakeEdge(Node* src, int output_index, Node* dst, int input_index);
   Status ValidateShape(Node* node);
   Status ModifyNodeDefForImport(NodeDef* node_def);
@@ -283,6 +294,10 @@ class GraphConstructor {
   // possible. After calling this method, the result of get_node_def(i) is
   // undefined.
   virtual NodeDef consume_node_def(int i) = 0;
+  // Returns the i^th node in the graph for in-place modification before it is
+  // consumed, or nullptr if the subclass does not own its NodeDefs. May be
+  // called concurrently for distinct values of i.
+  virtual NodeDef* mutable_node_def(int i) { return nullptr; }
   // Returns the version information for the graph, or nullptr if none is
   // available.
   virtual const VersionDef* versions() const = 0;
@@ -344,6 +359,16 @@ class GraphConstructor {
   // name, the value is the new unique name.
   gtl::FlatMap<string, string> uniquified_names_;
 
+  // The op registration and input/output types of each NodeDef, computed up
+  // front by PrepareNodeDefs(). Empty if the NodeDefs are instead looked up
+  // one at a time as they are converted.
+  struct PreparedNode {
+    const OpRegistrationData* op_reg_data = nullptr;
+    DataTypeVector input_types;
+    DataTypeVector output_types;
+  };
+  std::vector<PreparedNode> prepared_nodes_;
+
   // Index of NodeDefs in node_defs_ with all inputs already converted. We use a
   // (sorted) set so nodes are created in the order defined in the GraphDef.
   std::set<int> ready_;
@@ -450,6 +475,10 @@ class NodeDefMovingGraphConstructor : public GraphConstructor {
     is_consumed_[i] = true;
     return std::move(*graph_def_.mutable_node(i));
   }
+  NodeDef* mutable_node_def(int i) override {
+    DCHECK(!is_consumed_[i]);
+    return graph_def_.mutable_node(i);
+  }
   const VersionDef* versions() const override { return &graph_def_.versions(); }
   const FunctionDefLibrary* library() const override {
     return &graph_def_.library();
@@ -772,11 +801,69 @@ Status GraphConstructor::ValidateColocationConstraints(
   return Status::OK();
 }
 
-Status GraphConstructor::MakeNode(NodeDef&& node_def, Node** node) {
+Status GraphConstructor::PrepareNodeDefs() {
+  const int num_nodes = node_def_count();
+  if (opts_.importing || num_nodes < kMinNodesForParallelPrepare ||
+      mutable_node_def(0) == nullptr) {
+    return Status::OK();
+  }
+
+  prepared_nodes_.resize(num_nodes);
+  std::vector<Status> statuses(num_nodes);
+  auto prepare = [this, &statuses](int64 begin, int64 end) {
+    for (int64 i = begin; i < end; ++i) {
+      NodeDef* node_def = mutable_node_def(i);
+      PreparedNode* prepared = &prepared_nodes_[i];
+      Status* status = &statuses[i];
+      *status =
+          g_->op_registry()->LookUp(node_def->op(), &prepared->op_reg_data);
+      if (!status->ok()) continue;
+      const OpDef& op_def = prepared->op_reg_data->op_def;
+      if (opts_.add_default_attributes) {
+        AddDefaultsToNodeDef(op_def, node_def);
+      }
+      if (opts_.validate_nodes) {
+        *status = ValidateNodeDef(*node_def, op_def);
+        if (!status->ok()) continue;
+      }
+      *status = InOutTypesForNode(*node_def, op_def, &prepared->input_types,
+                                  &prepared->output_types);
+      if (!status->ok()) *status = AttachDef(*status, *node_def);
+    }
+  };
+
+  const int num_threads = std::min(port::MaxParallelism(), num_nodes / 1024);
+  if (num_threads > 1) {
+    thread::ThreadPool pool(Env::Default(), "graph_constructor", num_threads);
+    // A rough per-node cost, in cycles, of an op lookup plus attr defaulting
+    // and validation.
+    constexpr int64 kCostPerNode = 10000;
+    pool.ParallelFor(num_nodes, kCostPerNode, prepare);
+  } else {
+    prepare(0, num_nodes);
+  }
+
+  for (const Status& status : statuses) {
+    if (!status.ok()) {
+      prepared_nodes_.clear();
+      return status;
+    }
+  }
+  return Status::OK();
+}
+
+Status GraphConstructor::MakeNode(NodeDef&& node_def, PreparedNode* prepared,
+                                  Node** node) {
   // Add the node to the graph.
-  Status status;
-  *node = g_->AddNode(std::move(node_def), &status);
-  if (!status.ok()) return status;
+  if (prepared != nullptr) {
+    *node = g_->AddNode(std::move(node_def), prepared->op_reg_data,
+                        std::move(prepared->input_types),
+                        std::move(prepared->output_types));
+  } else {
+    Status status;
+    *node = g_->AddNode(std::move(node_def), &status);
+    if (!status.ok()) return status;
+  }
   if (opts_.expect_device_spec) {
     (*node)->set_assigned_device_name((*node)->def().device());
   }
@@ -1114,6 +1201,16 @@ Status GraphConstructor::Convert() {
     TF_RETURN_IF_ERROR(g_->AddFunctionLibrary(*library()));
   }
 
+  // Size the node and edge tables for the whole GraphDef up front. Back edges
+  // and duplicate control inputs make `num_edges` an upper bound.
+  int num_edges = 0;
+  for (int i = 0; i < node_def_count(); ++i) {
+    num_edges += get_node_def(i).input_size();
+  }
+  g_->Reserve(node_def_count(), num_edges);
+
+  TF_RETURN_IF_ERROR(PrepareNodeDefs());
+
   std::vector<InputInfo> inputs;
   int processed = 0;
 
@@ -1229,9 +1326,11 @@ Status GraphConstructor::Convert() {
       }
     }
 
+    PreparedNode* prepared =
+        prepared_nodes_.empty() ? nullptr : &prepared_nodes_[o];
     if (opts_.importing) {
       TF_RETURN_IF_ERROR(ModifyNodeDefForImport(&node_def));
-    } else {
+    } else if (prepared == nullptr) {
       const OpDef* op_def;
       TF_RETURN_IF_ERROR(
           g_->op_registry()->LookUpOpDef(node_def.op(), &op_def));
@@ -1243,7 +1342,7 @@ Status GraphConstructor::Convert() {
       }
     }
 
-    TF_RETURN_IF_ERROR(MakeNode(std::move(node_def), &node));
+    TF_RETURN_IF_ERROR(MakeNode(std::move(node_def), prepared, &node));
 
     if (opts_.importing) {
       // Use interned original node name so StringPiece remains valid.
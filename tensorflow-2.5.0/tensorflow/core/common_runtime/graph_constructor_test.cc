@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/public/session.h"
 #include "tensorflow/core/public/version.h"
 
@@ -3258,5 +3259,82 @@ TEST_F(GraphConstructorTest, ImportGraphDef_UnknownOps) {
        "when the module is first accessed."});
 }
 
+// Returns a GraphDef with a chain of `num_nodes` TestMul nodes hanging off a
+// single TestInput, with a TestDefaultAttr node control-dependent on every
+// tenth link. It is large enough to be prepared in parallel when `num_nodes`
+// is in the thousands.
+GraphDef LargeGraphDef(int num_nodes) {
+  GraphDef gdef;
+  NodeDef* input = gdef.add_node();
+  input->set_name("in");
+  input->set_op("TestInput");
+  string prev = "in";
+  for (int i = 0; i < num_nodes; ++i) {
+    NodeDef* mul = gdef.add_node();
+    mul->set_name(strings::StrCat("mul", i));
+    mul->set_op("TestMul");
+    mul->add_input(prev);
+    mul->add_input("in:1");
+    prev = mul->name();
+    if (i % 10 == 0) {
+      NodeDef* attr = gdef.add_node();
+      attr->set_name(strings::StrCat("attr", i));
+      attr->set_op("TestDefaultAttr");
+      attr->add_input(strings::StrCat("^", prev));
+    }
+  }
+  return gdef;
+}
+
+TEST_F(GraphConstructorTest, ConvertLargeGraphDef) {
+  const int kNumNodes = 5000;
+  GraphDef gdef = LargeGraphDef(kNumNodes);
+  const int num_node_defs = gdef.node_size();
+  TF_ASSERT_OK(
+      ConvertGraphDefToGraph(GraphConstructorOptions(), std::move(gdef),
+                             &graph_));
+  EXPECT_EQ(num_node_defs, graph_.num_op_nodes());
+
+  Node* last = FindNode(strings::StrCat("mul", kNumNodes - 1));
+  ASSERT_TRUE(last != nullptr);
+  EXPECT_EQ(2, last->num_inputs());
+  EXPECT_EQ(DT_FLOAT, last->input_type(0));
+  EXPECT_EQ(DT_FLOAT, last->output_type(0));
+
+  Node* attr = FindNode("attr0");
+  ASSERT_TRUE(attr != nullptr);
+  int value = 0;
+  TF_ASSERT_OK(GetNodeAttr(attr->attrs(), "default_int", &value));
+  EXPECT_EQ(31415, value);
+}
+
+TEST_F(GraphConstructorTest, ConvertLargeGraphDef_InvalidNode) {
+  GraphDef gdef = LargeGraphDef(5000);
+  gdef.mutable_node(1234)->set_op("OpFromContrib");
+  const string original_graph_description = GraphDebugString();
+  Status s = ConvertGraphDefToGraph(GraphConstructorOptions(), std::move(gdef),
+                                    &graph_);
+  EXPECT_FALSE(s.ok());
+  EXPECT_TRUE(s.error_message().find(
+                  "Op type not registered 'OpFromContrib'") != string::npos)
+      << s;
+  EXPECT_EQ(original_graph_description, GraphDebugString());
+}
+
+void BM_ConvertGraphDefToGraph(::testing::benchmark::State& state) {
+  const int num_nodes = state.range(0);
+  const GraphDef gdef = LargeGraphDef(num_nodes);
+  for (auto s : state) {
+    state.PauseTiming();
+    GraphDef copy = gdef;
+    Graph graph(OpRegistry::Global());
+    state.ResumeTiming();
+    TF_CHECK_OK(ConvertGraphDefToGraph(GraphConstructorOptions(),
+                                       std::move(copy), &graph));
+  }
+  state.SetItemsProcessed(state.iterations() * gdef.node_size());
+}
+BENCHMARK(BM_ConvertGraphDefToGraph)->Arg(1 << 10)->Arg(1 << 14)->Arg(1 << 17);
+
 }  // namespace
 }  // namespace tensorflow
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/graph_execution_state.h"
 
+#include <algorithm>
 #include <memory>
 #include <set>
 #include <string>
@@ -53,6 +54,7 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/util.h"
 
 #ifndef IS_MOBILE_PLATFORM
@@ -80,7 +82,17 @@ GraphExecutionState::GraphExecutionState(
       session_options_(options.session_options),
       session_handle_(options.session_handle),
       flib_def_(std::move(flib_def)),
-      graph_(nullptr) {}
+      graph_(nullptr),
+      max_optimized_graphs_([] {
+        int64 value;
+        Status status = ReadInt64FromEnvVar("TF_OPTIMIZED_GRAPH_CACHE_SIZE",
+                                            /*default_val=*/0, &value);
+        if (!status.ok()) {
+          LOG(ERROR) << status.error_message();
+          return int64{0};
+        }
+        return value;
+      }()) {}
 
 GraphExecutionState::~GraphExecutionState() {
   node_name_to_cost_id_map_.clear();
@@ -847,6 +859,84 @@ Status GraphExecutionState::OptimizeGraph(
 #endif  // IS_MOBILE_PLATFORM
 }
 
+namespace {
+
+std::vector<string> SortedFeeds(const BuildGraphOptions& options) {
+  std::vector<string> feeds(options.callable_options.feed().begin(),
+                            options.callable_options.feed().end());
+  std::sort(feeds.begin(), feeds.end());
+  return feeds;
+}
+
+// Returns the names of the nodes that Grappler must preserve when optimizing
+// for `options`.
+absl::flat_hash_set<string> PreservedNodes(const BuildGraphOptions& options) {
+  absl::flat_hash_set<string> nodes;
+  for (const string& fetch : options.callable_options.fetch()) {
+    nodes.insert(string(ParseTensorName(fetch).node()));
+  }
+  for (const string& target : options.callable_options.target()) {
+    nodes.insert(string(ParseTensorName(target).node()));
+  }
+  return nodes;
+}
+
+}  // namespace
+
+bool GraphExecutionState::LookupOptimizedGraph(
+    const BuildGraphOptions& options, std::unique_ptr<Graph>* optimized_graph,
+    std::unique_ptr<FunctionLibraryDefinition>* optimized_flib) {
+  // Tensor connections feed and fetch tensors at the same time, so they are
+  // not worth the bookkeeping.
+  if (max_optimized_graphs_ <= 0 ||
+      !options.callable_options.tensor_connection().empty()) {
+    return false;
+  }
+  const std::vector<string> feeds = SortedFeeds(options);
+  const absl::flat_hash_set<string> preserved_nodes = PreservedNodes(options);
+  mutex_lock l(optimized_graphs_mu_);
+  for (auto it = optimized_graphs_.rbegin(); it != optimized_graphs_.rend();
+       ++it) {
+    // A graph optimized for other feeds may have folded or removed the nodes
+    // producing the new feeds, or depend on values that are now fed.
+    if (it->feeds != feeds) continue;
+    bool contains_all = true;
+    for (const string& node : preserved_nodes) {
+      if (!it->preserved_nodes.contains(node)) {
+        contains_all = false;
+        break;
+      }
+    }
+    if (!contains_all) continue;
+    optimized_graph->reset(new Graph(OpRegistry::Global()));
+    CopyGraph(*it->graph, optimized_graph->get());
+    optimized_flib->reset(new FunctionLibraryDefinition(*it->flib_def));
+    return true;
+  }
+  return false;
+}
+
+void GraphExecutionState::CacheOptimizedGraph(
+    const BuildGraphOptions& options, const Graph& optimized_graph,
+    const FunctionLibraryDefinition& optimized_flib) {
+  if (max_optimized_graphs_ <= 0 ||
+      !options.callable_options.tensor_connection().empty()) {
+    return;
+  }
+  CachedOptimizedGraph cached;
+  cached.feeds = SortedFeeds(options);
+  cached.preserved_nodes = PreservedNodes(options);
+  cached.graph.reset(new Graph(OpRegistry::Global()));
+  CopyGraph(optimized_graph, cached.graph.get());
+  cached.flib_def.reset(new FunctionLibraryDefinition(optimized_flib));
+  mutex_lock l(optimized_graphs_mu_);
+  optimized_graphs_.push_back(std::move(cached));
+  while (optimized_graphs_.size() >
+         static_cast<size_t>(max_optimized_graphs_)) {
+    optimized_graphs_.pop_front();
+  }
+}
+
 Status GraphExecutionState::BuildGraph(const BuildGraphOptions& options,
                                        std::unique_ptr<ClientGraph>* out) {
   VLOG(1) << "BuildGraph";
@@ -863,7 +953,15 @@ Status GraphExecutionState::BuildGraph(const BuildGraphOptions& options,
   std::unique_ptr<Graph> optimized_graph;
   std::unique_ptr<FunctionLibraryDefinition> optimized_flib;
 
-  Status s = OptimizeGraph(options, &optimized_graph, &optimized_flib);
+  Status s;
+  if (LookupOptimizedGraph(options, &optimized_graph, &optimized_flib)) {
+    VLOG(1) << "Reusing an optimized graph built for a superset of the fetches";
+  } else {
+    s = OptimizeGraph(options, &optimized_graph, &optimized_flib);
+    if (s.ok()) {
+      CacheOptimizedGraph(options, *optimized_graph, *optimized_flib);
+    }
+  }
   if (!s.ok()) {
     VLOG(2) << "Grappler optimization failed. Error: " << s.error_message();
     // Simply copy the original graph and the function library if we couldn't
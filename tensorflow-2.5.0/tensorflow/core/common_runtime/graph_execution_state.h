@@ -16,11 +16,14 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GRAPH_EXECUTION_STATE_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_GRAPH_EXECUTION_STATE_H_
 
+#include <deque>
 #include <functional>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
+
 #include "tensorflow/core/common_runtime/build_graph_options.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_set.h"
@@ -30,6 +33,8 @@ limitations under the License.
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
@@ -187,6 +192,27 @@ class GraphExecutionState {
   Status PruneGraph(const BuildGraphOptions& options, Graph* graph,
                     subgraph::RewriteGraphMetadata* out_rewrite_metadata);
 
+  // A graph that OptimizeGraph() produced for some feeds and fetches.
+  struct CachedOptimizedGraph {
+    std::vector<string> feeds;  // Sorted.
+    // The nodes named by the fetches and targets, which the optimized graph
+    // preserves.
+    absl::flat_hash_set<string> preserved_nodes;
+    std::unique_ptr<Graph> graph;
+    std::unique_ptr<FunctionLibraryDefinition> flib_def;
+  };
+
+  // Sets `*optimized_graph` and `*optimized_flib` to copies of a cached graph
+  // that was optimized for the same feeds as `options` and for fetches and
+  // targets that include those of `options`, which is then only left to be
+  // pruned. Returns false if there is no such graph.
+  bool LookupOptimizedGraph(
+      const BuildGraphOptions& options, std::unique_ptr<Graph>* optimized_graph,
+      std::unique_ptr<FunctionLibraryDefinition>* optimized_flib);
+  void CacheOptimizedGraph(const BuildGraphOptions& options,
+                           const Graph& optimized_graph,
+                           const FunctionLibraryDefinition& optimized_flib);
+
   // The GraphExecutionState must store a copy of the original GraphDef if
   // either of the following conditions holds:
   //
@@ -214,6 +240,16 @@ class GraphExecutionState {
   // The dataflow graph owned by this object.
   Graph* graph_;
 
+  // The maximum number of optimized graphs kept in `optimized_graphs_`, set by
+  // the TF_OPTIMIZED_GRAPH_CACHE_SIZE environment variable. Reusing them
+  // saves running Grappler again when a session is run with fetches that are
+  // contained in those of an earlier run.
+  const int64 max_optimized_graphs_;
+  mutex optimized_graphs_mu_;
+  // The most recently cached graph is at the back.
+  std::deque<CachedOptimizedGraph> optimized_graphs_
+      TF_GUARDED_BY(optimized_graphs_mu_);
+
   TF_DISALLOW_COPY_AND_ASSIGN(GraphExecutionState);
 };
 
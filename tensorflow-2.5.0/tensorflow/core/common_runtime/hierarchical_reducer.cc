@@ -0,0 +1,315 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_reducer.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+// Set true for greater intelligibility of debug mode log messages.
+#define READABLE_KEYS false
+
+namespace tensorflow {
+
+namespace {
+// The steps of the reduction, used to tell their buffers apart.
+enum Phase {
+  kLocalReduceScatter = 0,
+  kRemoteReduceScatter,
+  kRemoteAllGather,
+  kLocalAllGather,
+};
+
+// Key to be used for BufRendezvous by HierarchicalReducer.  A device sends at
+// most one tensor in each step of a phase.
+string HierarchicalReduceBufKey(const string& exec_key, int phase, int step,
+                                int src_rank) {
+  if (READABLE_KEYS) {
+    return strings::StrCat("hreduce(", exec_key, "):phase(", phase, "):step(",
+                           step, "):src(", src_rank, ")");
+  } else {
+    return strings::StrCat(exec_key, ":", phase, ":", step, ":", src_rank);
+  }
+}
+}  // namespace
+
+HierarchicalReducer::HierarchicalReducer()
+    : col_ctx_(nullptr),
+      col_params_(nullptr),
+      num_tasks_(-1),
+      devices_per_task_(-1) {}
+
+Status HierarchicalReducer::InitializeCollectiveParams(
+    CollectiveParams* col_params) {
+  CHECK_EQ(col_params->instance.type, REDUCTION_COLLECTIVE);
+  CHECK_EQ(col_params->instance.impl_details.collective_name,
+           "HierarchicalReduce");
+  const CollGroupParams& group = col_params->group;
+  if (group.device_type != DEVICE_CPU) {
+    return errors::Unimplemented(
+        "HierarchicalReduce only supports CPU devices, got ",
+        group.device_type.type_string());
+  }
+  if (group.num_tasks <= 0 || group.group_size % group.num_tasks != 0) {
+    return errors::InvalidArgument(
+        "HierarchicalReduce requires the same number of devices on each task, "
+        "got ",
+        group.group_size, " devices on ", group.num_tasks, " tasks");
+  }
+  const int devices_per_task = group.group_size / group.num_tasks;
+  for (int di = 0; di < group.group_size; ++di) {
+    const int first_in_task = di - (di % devices_per_task);
+    if (group.task_names[di] != group.task_names[first_in_task] ||
+        (di == first_in_task && di > 0 &&
+         group.task_names[di] == group.task_names[di - 1])) {
+      return errors::InvalidArgument(
+          "HierarchicalReduce requires ", devices_per_task,
+          " adjacent devices on each task, but device ", group.device_names[di],
+          " breaks this");
+    }
+  }
+  return Status::OK();
+}
+
+Status HierarchicalReducer::InitializeCollectiveContext(
+    std::shared_ptr<CollectiveContext> col_ctx) {
+  CHECK(col_ctx->dev_mgr);
+  col_ctx_ = col_ctx;
+  col_params_ = col_ctx->col_params;
+  num_tasks_ = col_params_->group.num_tasks;
+  devices_per_task_ = col_params_->group.group_size / num_tasks_;
+  return collective_util::InitializeDeviceAndLocality(
+      col_ctx->dev_mgr, col_ctx->device_name, &col_ctx->device,
+      &col_ctx->device_locality);
+}
+
+void HierarchicalReducer::Run(StatusCallback done) {
+  CHECK(col_ctx_);
+  CHECK(col_params_);
+  // Like `RingReducer`, this doesn't require non-overlapping collectives.
+  col_ctx_->col_exec->UnblockDependencies(*col_params_);
+
+  // Start by copying input to output if they're not already the same, i.e. if
+  // we're not computing in-place on the input tensor.
+  if ((col_ctx_->input != col_ctx_->output) &&
+      (DMAHelper::base(col_ctx_->input) != DMAHelper::base(col_ctx_->output))) {
+    Notification note;
+    Status status;
+    profiler::TraceMe activity("MemCpyAsync", profiler::TraceMeLevel::kInfo);
+    CollectiveRemoteAccessLocal::MemCpyAsync(
+        col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->op_device_context(), col_ctx_->device,
+        col_ctx_->device, col_ctx_->op_ctx->input_alloc_attr(0),
+        col_ctx_->op_ctx->output_alloc_attr(0), col_ctx_->input,
+        col_ctx_->output, 0 /*dev_to_dev_stream_index*/,
+        [&note, &status](const Status& s) {
+          status.Update(s);
+          note.Notify();
+        });
+    note.WaitForNotification();
+    if (!status.ok()) {
+      done(status);
+      return;
+    }
+  }
+  Status s = RunReduction();
+  if (!s.ok()) StartAbort(s);
+  done(s);
+}
+
+Status HierarchicalReducer::RunReduction() {
+  const int rank = col_params_->default_rank;
+  const int task_idx = rank / devices_per_task_;
+  const int local_idx = rank % devices_per_task_;
+  std::vector<int> local_ring(devices_per_task_);
+  for (int di = 0; di < devices_per_task_; ++di) {
+    local_ring[di] = task_idx * devices_per_task_ + di;
+  }
+  std::vector<int> remote_ring(num_tasks_);
+  for (int ti = 0; ti < num_tasks_; ++ti) {
+    remote_ring[ti] = ti * devices_per_task_ + local_idx;
+  }
+  VLOG(1) << "HierarchicalReducer::Run for device " << col_ctx_->device_name
+          << " default_rank " << rank << " task " << task_idx << " of "
+          << num_tasks_ << " local index " << local_idx << " of "
+          << devices_per_task_;
+
+  Allocator* allocator =
+      col_ctx_->device->GetAllocator(col_ctx_->op_ctx->output_alloc_attr(0));
+  std::unique_ptr<CollectiveAdapter> ca(
+      MakeCollectiveAdapter(col_ctx_->output, devices_per_task_, allocator));
+  {
+    profiler::TraceMe activity("LocalReduceScatter",
+                               profiler::TraceMeLevel::kInfo);
+    TF_RETURN_IF_ERROR(RingReduceScatter(kLocalReduceScatter, local_ring,
+                                         local_idx, ca.get()));
+  }
+
+  // Every device at `local_idx` now holds the same part, reduced over its
+  // task.
+  const int part_idx = (local_idx + 1) % devices_per_task_;
+  if (ca->ChunkBytes(part_idx) > 0) {
+    Tensor part = ca->ChunkAlias(part_idx);
+    if (num_tasks_ > 1) {
+      profiler::TraceMe activity("RemoteAllReduce",
+                                 profiler::TraceMeLevel::kInfo);
+      Tensor part_alias = part;
+      std::unique_ptr<CollectiveAdapter> part_ca(
+          MakeCollectiveAdapter(&part_alias, num_tasks_, allocator));
+      TF_RETURN_IF_ERROR(RingReduceScatter(kRemoteReduceScatter, remote_ring,
+                                           task_idx, part_ca.get()));
+      TF_RETURN_IF_ERROR(RingAllGather(kRemoteAllGather, remote_ring, task_idx,
+                                       part_ca.get()));
+    }
+    if (col_params_->final_op) {
+      Tensor group_size = ca->Scalar(col_params_->group.group_size);
+      TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+          col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+          col_params_->final_op, &part, &group_size));
+    }
+  }
+
+  {
+    profiler::TraceMe activity("LocalAllGather",
+                               profiler::TraceMeLevel::kInfo);
+    TF_RETURN_IF_ERROR(
+        RingAllGather(kLocalAllGather, local_ring, local_idx, ca.get()));
+  }
+  ca->ConsumeFinalValue(col_ctx_->output);
+  return Status::OK();
+}
+
+Status HierarchicalReducer::RingReduceScatter(int phase,
+                                              const std::vector<int>& ring,
+                                              int pos, CollectiveAdapter* ca) {
+  const int n = ring.size();
+  const int send_to = ring[(pos + 1) % n];
+  const int recv_from = ring[(pos + n - 1) % n];
+  for (int step = 0; step < n - 1; ++step) {
+    const int send_idx = (pos + n - step) % n;
+    const int recv_idx = (pos + 2 * n - step - 1) % n;
+    Tensor send_chunk, recv_chunk;
+    if (ca->ChunkBytes(send_idx) > 0) send_chunk = ca->ChunkAlias(send_idx);
+    if (ca->ChunkBytes(recv_idx) > 0) recv_chunk = ca->TempChunk(recv_idx);
+    TF_RETURN_IF_ERROR(
+        SendRecv(phase, step, send_to,
+                 send_chunk.IsInitialized() ? &send_chunk : nullptr, recv_from,
+                 recv_chunk.IsInitialized() ? &recv_chunk : nullptr));
+    if (recv_chunk.IsInitialized()) {
+      Tensor chunk = ca->ChunkAlias(recv_idx);
+      TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+          col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+          col_params_->merge_op, &chunk, &recv_chunk));
+    }
+  }
+  return Status::OK();
+}
+
+Status HierarchicalReducer::RingAllGather(int phase,
+                                          const std::vector<int>& ring,
+                                          int pos, CollectiveAdapter* ca) {
+  const int n = ring.size();
+  const int send_to = ring[(pos + 1) % n];
+  const int recv_from = ring[(pos + n - 1) % n];
+  for (int step = 0; step < n - 1; ++step) {
+    const int send_idx = (pos + n + 1 - step) % n;
+    const int recv_idx = (pos + n - step) % n;
+    Tensor send_chunk, recv_chunk;
+    if (ca->ChunkBytes(send_idx) > 0) send_chunk = ca->ChunkAlias(send_idx);
+    if (ca->ChunkBytes(recv_idx) > 0) recv_chunk = ca->ChunkAlias(recv_idx);
+    TF_RETURN_IF_ERROR(
+        SendRecv(phase, step, send_to,
+                 send_chunk.IsInitialized() ? &send_chunk : nullptr, recv_from,
+                 recv_chunk.IsInitialized() ? &recv_chunk : nullptr));
+  }
+  return Status::OK();
+}
+
+Status HierarchicalReducer::SendRecv(int phase, int step, int send_to,
+                                     const Tensor* send, int recv_from,
+                                     Tensor* recv) {
+  const CollGroupParams& group = col_params_->group;
+  BlockingCounter pending((send != nullptr) + (recv != nullptr));
+  mutex mu;
+  Status status;
+  auto done = [&pending, &mu, &status](const Status& s) {
+    {
+      mutex_lock l(mu);
+      status.Update(s);
+    }
+    pending.DecrementCount();
+  };
+  if (send != nullptr) {
+    string send_buf_key = HierarchicalReduceBufKey(
+        col_ctx_->exec_key, phase, step, col_params_->default_rank);
+    VLOG(3) << "DispatchSend " << send_buf_key << " to_device "
+            << group.device_names[send_to];
+    col_ctx_->col_exec->remote_access()->PostToPeer(
+        group.device_names[send_to], group.task_names[send_to], send_buf_key,
+        col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->output_alloc_attr(0), send,
+        col_ctx_->device_locality, col_ctx_->op_ctx->cancellation_manager(),
+        done);
+  }
+  if (recv != nullptr) {
+    string recv_buf_key =
+        HierarchicalReduceBufKey(col_ctx_->exec_key, phase, step, recv_from);
+    VLOG(3) << "DispatchRecv " << recv_buf_key << " from_device "
+            << group.device_names[recv_from];
+    col_ctx_->col_exec->remote_access()->RecvFromPeer(
+        group.device_names[recv_from], group.task_names[recv_from],
+        col_params_->task.is_local[recv_from], recv_buf_key, col_ctx_->device,
+        col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->output_alloc_attr(0), recv,
+        col_ctx_->device_locality, 0 /*dev_to_dev_stream_index*/,
+        col_ctx_->op_ctx->cancellation_manager(), done);
+  }
+  pending.Wait();
+  mutex_lock l(mu);
+  return status;
+}
+
+void HierarchicalReducer::StartAbort(const Status& s) {
+  LOG(ERROR) << "Aborting HierarchicalReduce with " << s;
+  // If it's cancellation all pending send/recv should be cancelled as well
+  // and there's then no need to abort.
+  CancellationManager* cancel_mgr = col_ctx_->op_ctx->cancellation_manager();
+  if (cancel_mgr == nullptr ||
+      (!cancel_mgr->IsCancelled() && !cancel_mgr->IsCancelling())) {
+    col_ctx_->col_exec->StartAbort(s);
+  }
+}
+
+namespace {
+REGISTER_COLLECTIVE(HierarchicalReduce, HierarchicalReducer);
+}  // namespace
+
+}  // namespace tensorflow
@@ -0,0 +1,90 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/framework/collective.h"
+
+namespace tensorflow {
+
+// Hierarchical implementation of collective all-reduce for groups that span
+// several tasks with the same number of devices each.  With D devices on each
+// task, the tensor is split into D parts.  The devices of each task first
+// ring reduce-scatter the parts, so that each holds one part reduced over its
+// task.  Then the devices holding the same part on different tasks, one per
+// task, ring all-reduce it.  Finally the devices of each task ring all-gather
+// the parts.  Only the middle step crosses tasks, and each device sends just
+// its part over it, so most of the traffic stays in task-local memory.
+class HierarchicalReducer : public CollectiveImplementationInterface {
+ public:
+  HierarchicalReducer();
+  ~HierarchicalReducer() override = default;
+
+  // Checks that every task has the same number of devices, and that the
+  // devices of each task are adjacent in the group's default rank order.
+  Status InitializeCollectiveParams(CollectiveParams* col_params) override;
+
+  // Initializes members of CollectiveContext not yet initialized, i.e. device
+  // and device_locality.  Also saves the CollectiveContext in this object.
+  Status InitializeCollectiveContext(
+      std::shared_ptr<CollectiveContext> col_ctx) override;
+
+  // No-op for hierarchical reducer.
+  Status InitializeCollectiveGroupRuntimeDetails(
+      CollGroupRuntimeDetails*) override {
+    return Status::OK();
+  }
+
+  // Begins async execution of the hierarchical reduce.
+  // Must be called in a blockable thread.
+  void Run(StatusCallback done) override;
+
+ private:
+  // Reduce-scatters the chunks of `ca` among the devices whose default ranks
+  // are `ring`, of which this device is at position `pos`.  Afterwards this
+  // device holds the reduced chunk (pos + 1) % ring.size().
+  Status RingReduceScatter(int phase, const std::vector<int>& ring, int pos,
+                           CollectiveAdapter* ca);
+
+  // Distributes the chunk (pos + 1) % ring.size() of `ca` held by each device
+  // in `ring` to all of them.
+  Status RingAllGather(int phase, const std::vector<int>& ring, int pos,
+                       CollectiveAdapter* ca);
+
+  // Sends `send` to the device at default rank `send_to` while receiving
+  // `recv` from the one at `recv_from`, and waits for both.  A null tensor
+  // is not sent or received.
+  Status SendRecv(int phase, int step, int send_to, const Tensor* send,
+                  int recv_from, Tensor* recv);
+
+  // Runs the three steps of the reduction on the output tensor.
+  Status RunReduction();
+
+  // Aborts the pending sends and receives of the collective.
+  void StartAbort(const Status& s);
+
+  std::shared_ptr<CollectiveContext> col_ctx_;
+  const CollectiveParams* col_params_;  // Not owned
+  int num_tasks_;
+  int devices_per_task_;
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
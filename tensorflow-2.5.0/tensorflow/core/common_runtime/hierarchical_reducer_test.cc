@@ -0,0 +1,418 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_reducer.h"
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/device_resolver_local.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/common_runtime/test_collective_executor_mgr.h"
+#include "tensorflow/core/common_runtime/threadpool_device.h"
+#include "tensorflow/core/framework/cancellation.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/unbounded_work_queue.h"
+#include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+// Wraps CollectiveRemoteAccessLocal with the ability to return an
+// error status to the N'th action.
+class FailTestRMA : public CollectiveRemoteAccessLocal {
+ public:
+  FailTestRMA(const DeviceMgr* dev_mgr, DeviceResolverInterface* dev_resolver,
+              int64 step_id, int fail_after)
+      : CollectiveRemoteAccessLocal(dev_mgr, dev_resolver, step_id),
+        fail_after_(fail_after) {}
+
+  bool MaybeFail(const StatusCallback& done) {
+    bool fail_now = false;
+    {
+      mutex_lock l(mu_);
+      if (fail_after_ > 0) {
+        fail_now = (--fail_after_ == 0);
+      }
+    }
+    if (fail_now) {
+      done(errors::Internal("Deliberate failure"));
+      return true;
+    }
+    return false;
+  }
+
+  void RecvFromPeer(const string& peer_device, const string& peer_task,
+                    bool peer_is_local, const string& key, Device* to_device,
+                    DeviceContext* to_device_ctx,
+                    const AllocatorAttributes& to_alloc_attr, Tensor* to_tensor,
+                    const DeviceLocality& client_locality,
+                    int dev_to_dev_stream_index,
+                    CancellationManager* cancellation_manager,
+                    const StatusCallback& done) override {
+    if (MaybeFail(done)) return;
+    CollectiveRemoteAccessLocal::RecvFromPeer(
+        peer_device, peer_task, peer_is_local, key, to_device, to_device_ctx,
+        to_alloc_attr, to_tensor, client_locality, dev_to_dev_stream_index,
+        cancellation_manager, done);
+  }
+
+  void PostToPeer(const string& peer_device, const string& peer_task,
+                  const string& key, Device* from_device,
+                  DeviceContext* from_device_ctx,
+                  const AllocatorAttributes& from_alloc_attr,
+                  const Tensor* from_tensor,
+                  const DeviceLocality& client_locality,
+                  CancellationManager* cancellation_manager,
+                  const StatusCallback& done) override {
+    if (MaybeFail(done)) return;
+    CollectiveRemoteAccessLocal::PostToPeer(
+        peer_device, peer_task, key, from_device, from_device_ctx,
+        from_alloc_attr, from_tensor, client_locality, cancellation_manager,
+        done);
+  }
+
+  mutex mu_;
+  int fail_after_ TF_GUARDED_BY(mu_);
+};
+
+std::unique_ptr<OpKernel> GetKernel(const NodeDef& node, DeviceBase* device) {
+  Status status;
+  std::unique_ptr<OpKernel> k = CreateOpKernel(
+      DEVICE_CPU, device, device->GetAllocator(AllocatorAttributes()), node,
+      TF_GRAPH_DEF_VERSION, &status);
+  if (!status.ok()) {
+    LOG(FATAL) << status;
+  }
+  return k;
+}
+
+std::unique_ptr<OpKernel> GetBinOp(const string& op, DataType dtype,
+                                   DeviceBase* device) {
+  NodeDef node_def;
+  NodeDefBuilder builder(strings::StrCat(op, "_node"), op);
+  TF_CHECK_OK(builder.Attr("T", dtype)
+                  .Input(FakeInput(dtype))
+                  .Input(FakeInput(dtype))
+                  .Finalize(&node_def));
+  return GetKernel(node_def, device);
+}
+
+static int64 kStepId = 123;
+
+string TaskName(int task) {
+  return strings::StrCat("/job:worker/replica:0/task:", task);
+}
+
+// Returns the group params of `num_tasks` tasks with `num_devices` CPU
+// devices each.
+CollGroupParams MakeGroup(int num_tasks, int num_devices) {
+  CollGroupParams group;
+  group.group_key = 5;
+  group.group_size = num_tasks * num_devices;
+  group.device_type = DEVICE_CPU;
+  group.num_tasks = num_tasks;
+  group.same_num_devices_per_task = true;
+  for (int ti = 0; ti < num_tasks; ++ti) {
+    group.num_devices_per_task[TaskName(ti)] = num_devices;
+    for (int di = 0; di < num_devices; ++di) {
+      group.device_names.push_back(strings::StrCat(TaskName(ti), "/cpu:", di));
+      group.task_names.push_back(TaskName(ti));
+    }
+  }
+  return group;
+}
+
+class HierarchicalReducerTest : public ::testing::Test {
+ protected:
+  ~HierarchicalReducerTest() override {
+    for (auto i : instances_) delete i;
+    if (col_exec_) col_exec_->Unref();
+  }
+
+  void Init(int num_tasks, int num_devices, int fail_after) {
+    std::vector<std::unique_ptr<Device>> local_devices;
+    SessionOptions sess_opts;
+    sess_opts.env = Env::Default();
+    Bytes mem_limit(4 << 20);
+    DeviceLocality dev_locality;
+    group_ = MakeGroup(num_tasks, num_devices);
+    for (const string& dev_name : group_.device_names) {
+      local_devices.push_back(absl::make_unique<ThreadPoolDevice>(
+          sess_opts, dev_name, mem_limit, dev_locality, cpu_allocator()));
+    }
+    dev_mgr_ = absl::make_unique<StaticDeviceMgr>(std::move(local_devices));
+    dev_resolver_ = absl::make_unique<DeviceResolverLocal>(dev_mgr_.get());
+    work_queue_ = std::make_shared<UnboundedWorkQueue>(Env::Default(), "test");
+    rma_ = new FailTestRMA(dev_mgr_.get(), dev_resolver_.get(), kStepId,
+                           fail_after);
+    col_exec_ = new BaseCollectiveExecutor(&col_exec_mgr_, rma_, kStepId,
+                                           dev_mgr_.get(), &gpu_ring_order_,
+                                           work_queue_);
+    for (int rank = 0; rank < group_.group_size; ++rank) {
+      instances_.push_back(new DeviceInstance(rank, this));
+    }
+  }
+
+  template <typename T>
+  void RunTest(DataType dtype, int num_tasks, int num_devices, int tensor_len,
+               int fail_after) {
+    Init(num_tasks, num_devices, fail_after);
+    std::vector<T> expected(tensor_len, 0);
+    for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+      instances_[di]->InitTensor(
+          dtype, TensorShape({tensor_len}), [&expected, di](Tensor* t) {
+            for (int i = 0; i < t->NumElements(); ++i) {
+              T value = static_cast<T>(di * 10 + i);
+              t->flat<T>()(i) = value;
+              expected[i] += value;
+            }
+          });
+    }
+    BlockingCounter done(instances_.size());
+    for (auto di : instances_) {
+      SchedClosure([di, &done] {
+        di->DoReduce();
+        done.DecrementCount();
+      });
+    }
+    done.Wait();
+    if (fail_after > 0) {
+      for (auto di : instances_) {
+        EXPECT_NE(di->status_.error_message().find("Deliberate failure"),
+                  string::npos)
+            << di->status_;
+      }
+      return;
+    }
+    for (int i = 0; i < tensor_len; ++i) {
+      expected[i] /= static_cast<T>(instances_.size());
+    }
+    for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+      TF_ASSERT_OK(instances_[di]->status_);
+      auto actual = instances_[di]->tensor_.template unaligned_flat<T>();
+      for (int i = 0; i < tensor_len; ++i) {
+        EXPECT_EQ(expected[i], actual(i))
+            << "Mismatch at device " << di << " index " << i;
+      }
+    }
+  }
+
+  class DeviceInstance {
+   public:
+    DeviceInstance(int rank, HierarchicalReducerTest* parent)
+        : parent_(parent), col_params_(new CollectiveParams()) {
+      const string& dev_name = parent_->group_.device_names[rank];
+      TF_CHECK_OK(parent_->dev_mgr_->LookupDevice(dev_name, &device_));
+      col_params_->name = "test_collective";
+      col_params_->group = parent_->group_;
+      col_params_->default_rank = rank;
+      col_params_->instance.instance_key = 17;
+      col_params_->instance.type = REDUCTION_COLLECTIVE;
+      col_params_->instance.impl_details.collective_name = "HierarchicalReduce";
+      // This test runs in a single process so is_local is always true.
+      col_params_->task.is_local.resize(parent_->group_.group_size, true);
+    }
+
+    ~DeviceInstance() { col_params_->Unref(); }
+
+    void InitTensor(DataType dtype, const TensorShape& shape,
+                    const std::function<void(Tensor*)>& init_f) {
+      col_params_->instance.data_type = dtype;
+      col_params_->instance.shape = shape;
+      tensor_ =
+          Tensor(device_->GetAllocator(AllocatorAttributes()), dtype, shape);
+      init_f(&tensor_);
+    }
+
+    void DoReduce() {
+      const DataType dtype = col_params_->instance.data_type;
+      merge_op_ = GetBinOp("Add", dtype, device_);
+      final_op_ = GetBinOp("Div", dtype, device_);
+      col_params_->merge_op = merge_op_.get();
+      col_params_->final_op = final_op_.get();
+
+      // Prepare an OpKernelContext.
+      OpKernelContext::Params op_params;
+      op_params.step_id = kStepId;
+      op_params.device = device_;
+      op_params.cancellation_manager = &parent_->cancellation_manager_;
+      gtl::InlinedVector<TensorValue, 4> inputs;
+      inputs.push_back(TensorValue(&tensor_));
+      op_params.inputs = &inputs;
+      gtl::InlinedVector<AllocatorAttributes, 4> input_aa(
+          {AllocatorAttributes()});
+      op_params.input_alloc_attrs = &input_aa;
+      DeviceContext* dev_ctx = new DeviceContext;
+      op_params.op_device_context = dev_ctx;
+      int forward_from = 0;
+      op_params.forward_from_array = &forward_from;
+      AllocatorAttributes generic_alloc_attr;
+      op_params.output_attr_array = &generic_alloc_attr;
+      std::unique_ptr<OpKernel> op = GetCollectiveReduce();
+      op_params.op_kernel = op.get();
+      OpKernelContext ctx(&op_params, 1);
+
+      // We never actually execute the kernel, so we need to do the output
+      // allocation it would do, ourselves.
+      Tensor* output_tensor_ptr = nullptr;
+      TF_CHECK_OK(ctx.forward_input_or_allocate_output({0}, 0, tensor_.shape(),
+                                                       &output_tensor_ptr));
+      CHECK_EQ(output_tensor_ptr, ctx.mutable_output(0));
+
+      string exec_key =
+          strings::StrCat(col_params_->instance.instance_key, ":0:0");
+      HierarchicalReducer* reducer = new HierarchicalReducer;
+      core::ScopedUnref unref(reducer);
+      auto col_ctx = std::make_shared<CollectiveContext>(
+          parent_->col_exec_, /*nccl_communicator*/ nullptr,
+          parent_->dev_mgr_.get(), &ctx, &op_params, col_params_, exec_key,
+          kStepId, &tensor_, &tensor_);
+      status_ = reducer->InitializeCollectiveParams(col_params_);
+      if (status_.ok()) {
+        status_ = reducer->InitializeCollectiveContext(col_ctx);
+      }
+      if (status_.ok()) {
+        reducer->Run([this](Status s) { status_ = s; });
+      }
+      if (status_.ok()) {
+        CHECK(tensor_.CopyFrom(*ctx.mutable_output(0), tensor_.shape()));
+      }
+      dev_ctx->Unref();
+    }
+
+    std::unique_ptr<OpKernel> GetCollectiveReduce() {
+      NodeDef node_def;
+      NodeDefBuilder builder(
+          strings::StrCat("collective_reduce_", col_params_->default_rank),
+          "CollectiveReduce");
+      TF_CHECK_OK(builder.Attr("T", col_params_->instance.data_type)
+                      .Attr("merge_op", "Add")
+                      .Attr("final_op", "Div")
+                      .Attr("group_size", col_params_->group.group_size)
+                      .Attr("group_key", col_params_->group.group_key)
+                      .Attr("instance_key", col_params_->instance.instance_key)
+                      .Attr("subdiv_offsets", std::vector<int>())
+                      .Attr("communication_hint", "hierarchical")
+                      .Input(FakeInput(col_params_->instance.data_type))
+                      .Finalize(&node_def));
+      return GetKernel(node_def, device_);
+    }
+
+    HierarchicalReducerTest* parent_;
+    Device* device_;
+    CollectiveParams* col_params_;
+    Tensor tensor_;
+    std::unique_ptr<OpKernel> merge_op_;
+    std::unique_ptr<OpKernel> final_op_;
+    Status status_;
+  };
+
+  CollGroupParams group_;
+  TestCollectiveExecutorMgr col_exec_mgr_;
+  CollectiveExecutor* col_exec_ = nullptr;
+  CollectiveRemoteAccessLocal* rma_;
+  std::unique_ptr<DeviceResolverLocal> dev_resolver_;
+  std::shared_ptr<UnboundedWorkQueue> work_queue_;
+  std::unique_ptr<DeviceMgr> dev_mgr_;
+  string gpu_ring_order_;
+  std::vector<DeviceInstance*> instances_;
+  CancellationManager cancellation_manager_;
+};
+
+TEST(HierarchicalReducerParamsTest, AcceptsEvenGroup) {
+  CollectiveParams* cp = new CollectiveParams();
+  core::ScopedUnref unref_cp(cp);
+  cp->group = MakeGroup(/*num_tasks=*/3, /*num_devices=*/2);
+  cp->instance.type = REDUCTION_COLLECTIVE;
+  cp->instance.impl_details.collective_name = "HierarchicalReduce";
+  HierarchicalReducer* reducer = new HierarchicalReducer;
+  core::ScopedUnref unref(reducer);
+  TF_EXPECT_OK(reducer->InitializeCollectiveParams(cp));
+}
+
+TEST(HierarchicalReducerParamsTest, RejectsUnevenGroup) {
+  CollectiveParams* cp = new CollectiveParams();
+  core::ScopedUnref unref_cp(cp);
+  cp->group = MakeGroup(/*num_tasks=*/2, /*num_devices=*/2);
+  // Move the last device of task 0 to task 1.
+  cp->group.task_names[1] = TaskName(1);
+  cp->instance.type = REDUCTION_COLLECTIVE;
+  cp->instance.impl_details.collective_name = "HierarchicalReduce";
+  HierarchicalReducer* reducer = new HierarchicalReducer;
+  core::ScopedUnref unref(reducer);
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      reducer->InitializeCollectiveParams(cp)));
+}
+
+TEST(HierarchicalReducerParamsTest, RejectsNonCpuGroup) {
+  CollectiveParams* cp = new CollectiveParams();
+  core::ScopedUnref unref_cp(cp);
+  cp->group = MakeGroup(/*num_tasks=*/2, /*num_devices=*/2);
+  cp->group.device_type = DeviceType(DEVICE_GPU);
+  cp->instance.type = REDUCTION_COLLECTIVE;
+  cp->instance.impl_details.collective_name = "HierarchicalReduce";
+  HierarchicalReducer* reducer = new HierarchicalReducer;
+  core::ScopedUnref unref(reducer);
+  EXPECT_TRUE(
+      errors::IsUnimplemented(reducer->InitializeCollectiveParams(cp)));
+}
+
+#define DEF_TEST(B, W, D, L, A)                                          \
+  TEST_F(HierarchicalReducerTest,                                        \
+         DaTy##B##_WkrCt##W##_DevPerWkr##D##_Len##L##_Abrt##A) {         \
+    DataType dtype = DT_##B;                                             \
+    switch (dtype) {                                                     \
+      case DT_FLOAT: {                                                   \
+        RunTest<float>(dtype, W, D, L, A);                               \
+      } break;                                                           \
+      case DT_DOUBLE: {                                                  \
+        RunTest<double>(dtype, W, D, L, A);                              \
+      } break;                                                           \
+      case DT_INT64: {                                                   \
+        RunTest<int64>(dtype, W, D, L, A);                               \
+      } break;                                                           \
+      default:                                                           \
+        LOG(FATAL) << "Unimplemented";                                   \
+    }                                                                    \
+  }
+
+// Success tests
+DEF_TEST(FLOAT, 2, 1, 1, 0)
+DEF_TEST(FLOAT, 1, 4, 1001, 0)
+DEF_TEST(FLOAT, 2, 1, 1001, 0)
+DEF_TEST(FLOAT, 2, 2, 3, 0)
+DEF_TEST(FLOAT, 2, 4, 128, 0)
+DEF_TEST(FLOAT, 3, 2, 1001, 0)
+DEF_TEST(FLOAT, 4, 4, 4095, 0)
+DEF_TEST(DOUBLE, 3, 3, 1001, 0)
+DEF_TEST(INT64, 2, 4, 1001, 0)
+
+// Failure tests
+DEF_TEST(FLOAT, 2, 2, 1001, 1)
+DEF_TEST(FLOAT, 2, 4, 1001, 7)
+
+}  // namespace
+}  // namespace tensorflow
@@ -75,6 +75,9 @@ Benchmark::Benchmark(const string& device, Graph* g,
 
   pool_ =
       new thread::ThreadPool(options->env, "blocking", port::MaxParallelism());
+  if (options->config.experimental().use_work_stealing_executor()) {
+    work_stealing_num_workers_ = pool_->NumThreads();
+  }
 
   auto runner = [this](std::function<void()> closure) {
     pool_->Schedule(closure);
@@ -117,6 +120,7 @@ Benchmark::Benchmark(const string& device, Graph* g,
     Executor::Args args;
     args.rendezvous = rendez_;
     args.runner = runner;
+    args.work_stealing_num_workers = work_stealing_num_workers_;
     TF_CHECK_OK(init_exec->Run(args));
   }
 
@@ -175,6 +179,7 @@ void Benchmark::RunWithRendezvousArgs(
   args.runner = [this](std::function<void()> closure) {
     pool_->Schedule(closure);
   };
+  args.work_stealing_num_workers = work_stealing_num_workers_;
   static const int kWarmupRuns = 3;
   for (int i = 0; i < kWarmupRuns; ++i) {
     for (const auto& p : inputs) {
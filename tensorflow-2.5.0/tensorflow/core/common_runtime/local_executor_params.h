@@ -19,6 +19,8 @@ limitations under the License.
 #include <functional>
 #include <memory>
 
+#include "tensorflow/core/platform/types.h"
+
 namespace tensorflow {
 
 class Device;
@@ -47,6 +49,16 @@ struct LocalExecutorParams {
                        OpKernel**)>
       create_kernel;
   std::function<void(OpKernel*)> delete_kernel;
+
+  // If true, the executor plans the memory of the kernel outputs after the
+  // first step, and allocates them from a single arena in later steps (see
+  // ExecutorMemoryPlanner). Intended for graphs with static shapes.
+  bool plan_output_memory = false;
+
+  // If positive, the kernels of a step allocate their outputs and temporaries
+  // of at most that many bytes from an arena owned by the step (see
+  // StepArenaAllocator). Intended for graphs with many small host tensors.
+  int64 step_arena_max_allocation_size = 0;
 };
 
 }  // end namespace tensorflow
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/placer.h"
 
 #include <memory>
+#include <set>
 #include <vector>
 
 #include "tensorflow/core/common_runtime/colocation_graph.h"
@@ -28,6 +29,8 @@ limitations under the License.
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/graph/graph_node_util.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/util/dump_graph.h"
 #include "tensorflow/core/util/port.h"
 
@@ -131,17 +134,60 @@ Status AssignAndLog(int assigned_device, Node* node,
 
 }  // namespace
 
+std::shared_ptr<const PlacementCache::Placement> PlacementCache::Lookup(
+    uint64 key) const {
+  mutex_lock l(mu_);
+  auto it = placements_.find(key);
+  if (it == placements_.end()) {
+    ++num_misses_;
+    return nullptr;
+  }
+  ++num_hits_;
+  return it->second;
+}
+
+void PlacementCache::Insert(uint64 key,
+                            std::shared_ptr<const Placement> placement) {
+  mutex_lock l(mu_);
+  if (!placements_.emplace(key, std::move(placement)).second) return;
+  insertion_order_.push_back(key);
+  while (insertion_order_.size() > static_cast<size_t>(capacity_)) {
+    placements_.erase(insertion_order_.front());
+    insertion_order_.pop_front();
+  }
+}
+
+int64 PlacementCache::num_hits() const {
+  mutex_lock l(mu_);
+  return num_hits_;
+}
+
+int64 PlacementCache::num_misses() const {
+  mutex_lock l(mu_);
+  return num_misses_;
+}
+
 Placer::Placer(Graph* graph, const string& function_name,
                const FunctionLibraryDefinition* flib_def,
                const DeviceSet* devices, const Device* default_local_device,
                bool allow_soft_placement, bool log_device_placement)
+    : Placer(graph, function_name, flib_def, devices, default_local_device,
+             allow_soft_placement, log_device_placement,
+             /*placement_cache=*/nullptr) {}
+
+Placer::Placer(Graph* graph, const string& function_name,
+               const FunctionLibraryDefinition* flib_def,
+               const DeviceSet* devices, const Device* default_local_device,
+               bool allow_soft_placement, bool log_device_placement,
+               PlacementCache* placement_cache)
     : graph_(graph),
       function_name_(function_name),
       flib_def_(flib_def),
       devices_(devices),
       default_local_device_(default_local_device),
       allow_soft_placement_(allow_soft_placement),
-      log_device_placement_(log_device_placement) {}
+      log_device_placement_(log_device_placement),
+      placement_cache_(placement_cache) {}
 
 Placer::Placer(Graph* graph, const string& function_name,
                const DeviceSet* devices, const Device* default_local_device)
@@ -171,6 +217,18 @@ Status Placer::Run() {
     }
   }
 
+  uint64 cache_key = 0;
+  if (placement_cache_ != nullptr) {
+    cache_key = PlacementCacheKey();
+    std::shared_ptr<const PlacementCache::Placement> placement =
+        placement_cache_->Lookup(cache_key);
+    if (placement != nullptr && ApplyCachedPlacement(*placement)) {
+      VLOG(1) << "Reused the cached placement of "
+              << (function_name_.empty() ? "the graph" : function_name_);
+      return Status::OK();
+    }
+  }
+
   FunctionStack stack(function_name_);
   ColocationGraph colocation_graph(graph_, stack, flib_def_, devices_,
                                    default_local_device_, allow_soft_placement_,
@@ -287,6 +345,15 @@ Status Placer::Run() {
                                     log_device_placement_));
   }
 
+  if (placement_cache_ != nullptr) {
+    auto placement = std::make_shared<PlacementCache::Placement>();
+    placement->reserve(graph_->num_op_nodes());
+    for (const Node* node : graph_->op_nodes()) {
+      placement->emplace(node->name(), node->assigned_device_name());
+    }
+    placement_cache_->Insert(cache_key, std::move(placement));
+  }
+
   if (VLOG_IS_ON(3)) {
     DumpGraphToFile("placer_output", *graph_, nullptr);
     DumpColocationGraph("colocation_graph", colocation_graph);
@@ -294,6 +361,72 @@ Status Placer::Run() {
   return Status::OK();
 }
 
+uint64 Placer::PlacementCacheKey() const {
+  uint64 key = Fingerprint64(
+      default_local_device_ == nullptr ? "" : default_local_device_->name());
+  key = FingerprintCat64(key, allow_soft_placement_);
+  for (const Device* device : devices_->devices()) {
+    key = FingerprintCat64(key, Fingerprint64(device->name()));
+  }
+
+  std::set<string> function_names;
+  string serialized;
+  for (const Node* node : graph_->op_nodes()) {
+    SerializeToStringDeterministic(node->def(), &serialized);
+    key = FingerprintCat64(key, node->id());
+    key = FingerprintCat64(key, Fingerprint64(serialized));
+    key = FingerprintCat64(key, Fingerprint64(node->assigned_device_name()));
+    // The NodeDef inputs may be stale, so use the edges. They are not stored
+    // in a deterministic order, so combine them commutatively.
+    uint64 edges_key = 0;
+    for (const Edge* edge : node->in_edges()) {
+      edges_key += FingerprintCat64(
+          FingerprintCat64(edge->src()->id(), edge->src_output()),
+          edge->dst_input());
+    }
+    key = FingerprintCat64(key, edges_key);
+
+    if (flib_def_ == nullptr) continue;
+    if (flib_def_->Find(node->type_string()) != nullptr) {
+      function_names.insert(node->type_string());
+    }
+    for (const auto& attr : node->attrs()) {
+      if (attr.second.has_func()) {
+        function_names.insert(attr.second.func().name());
+      }
+      for (const NameAttrList& func : attr.second.list().func()) {
+        function_names.insert(func.name());
+      }
+    }
+  }
+
+  // std::set iterates the names in a deterministic order.
+  for (const string& name : function_names) {
+    const FunctionDef* fdef = flib_def_->Find(name);
+    if (fdef == nullptr) continue;
+    SerializeToStringDeterministic(*fdef, &serialized);
+    key = FingerprintCat64(key, Fingerprint64(serialized));
+  }
+  return key;
+}
+
+bool Placer::ApplyCachedPlacement(const PlacementCache::Placement& placement) {
+  std::vector<std::pair<Node*, const string*>> assignments;
+  assignments.reserve(placement.size());
+  for (Node* node : graph_->op_nodes()) {
+    auto it = placement.find(node->name());
+    if (it == placement.end()) return false;
+    assignments.emplace_back(node, &it->second);
+  }
+  if (assignments.size() != placement.size()) return false;
+
+  for (const auto& assignment : assignments) {
+    assignment.first->set_assigned_device_name(*assignment.second);
+    LogDeviceAssignment(assignment.first, log_device_placement_);
+  }
+  return true;
+}
+
 bool Placer::CanAssignToDevice(const string& candidate_device_name,
                                const std::vector<Device*>& devices) const {
   if (!candidate_device_name.empty()) {
@@ -16,18 +16,64 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_PLACER_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_PLACER_H_
 
+#include <deque>
+#include <memory>
 #include <string>
+#include <unordered_map>
 
 #include "tensorflow/core/common_runtime/device_set.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/public/session_options.h"
 
 namespace tensorflow {
 
+// Remembers the device assignments computed by Placer::Run(), keyed by a
+// fingerprint of the graph being placed and of the placement inputs (the
+// devices, the default local device and the soft placement setting), so that
+// placing an identical graph again, e.g. the body of a function instantiated
+// many times, skips the colocation analysis.
+//
+// The key covers the function definitions directly referenced by the graph's
+// nodes, but not the functions those call in turn. A cache should therefore
+// only be shared by placers whose function libraries agree on the definition
+// of each function name.
+//
+// This class is thread-safe.
+class PlacementCache {
+ public:
+  // Maps each op node name to its assigned device.
+  using Placement = std::unordered_map<string, string>;
+
+  // Keeps up to `capacity` placements, evicting the oldest one first.
+  explicit PlacementCache(int capacity = 64) : capacity_(capacity) {}
+
+  // Returns the placement stored for `key`, or nullptr if there is none.
+  std::shared_ptr<const Placement> Lookup(uint64 key) const;
+
+  void Insert(uint64 key, std::shared_ptr<const Placement> placement);
+
+  int64 num_hits() const;
+  int64 num_misses() const;
+
+ private:
+  const int capacity_;
+  mutable mutex mu_;
+  std::unordered_map<uint64, std::shared_ptr<const Placement>> placements_
+      TF_GUARDED_BY(mu_);
+  // Keys of `placements_` in insertion order.
+  std::deque<uint64> insertion_order_ TF_GUARDED_BY(mu_);
+  mutable int64 num_hits_ TF_GUARDED_BY(mu_) = 0;
+  mutable int64 num_misses_ TF_GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(PlacementCache);
+};
+
 // A placement algorithm that assigns the nodes of the given Graph to
 // devices the given DeviceSet, respecting the following constraints:
 //
@@ -73,6 +119,14 @@ class Placer {
          const Device* default_local_device, bool allow_soft_placement,
          bool log_device_placement);
 
+  // As above, but if "placement_cache" is non-null, Run() first looks up the
+  // placement of an identical graph in it, and stores its own result there
+  // otherwise. "placement_cache" is borrowed and must outlive this Placer.
+  Placer(Graph* graph, const string& function_name,
+         const FunctionLibraryDefinition* flib_def, const DeviceSet* devices,
+         const Device* default_local_device, bool allow_soft_placement,
+         bool log_device_placement, PlacementCache* placement_cache);
+
   Placer(Graph* graph, const string& function_name, const DeviceSet* devices,
          const Device* default_local_device);
 
@@ -93,6 +147,13 @@ class Placer {
   bool CanAssignToDevice(const string& candidate_device_name,
                          const std::vector<Device*>& devices) const;
 
+  // Returns the key of this placement in placement_cache_.
+  uint64 PlacementCacheKey() const;
+
+  // Assigns the devices in "placement" to the nodes of graph_. Returns false,
+  // leaving graph_ unchanged, if "placement" does not cover the graph.
+  bool ApplyCachedPlacement(const PlacementCache::Placement& placement);
+
   Graph* const graph_;  // Not owned.
   const string function_name_;
   const FunctionLibraryDefinition* const flib_def_;  // Not owned.
@@ -100,6 +161,7 @@ class Placer {
   const Device* default_local_device_;               // Not owned.
   const bool allow_soft_placement_;
   const bool log_device_placement_;
+  PlacementCache* const placement_cache_;  // Not owned. May be null.
 
   TF_DISALLOW_COPY_AND_ASSIGN(Placer);
 };
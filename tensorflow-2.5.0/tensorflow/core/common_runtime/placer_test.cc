@@ -418,6 +418,50 @@ TEST_F(PlacerTest, TestNoConstraints) {
   EXPECT_DEVICE_TYPE(g, "n2", "FakeGPU");
 }
 
+// Test that placing an identical graph again reuses the cached placement, and
+// that a different graph is placed from scratch.
+TEST_F(PlacerTest, TestPlacementCache) {
+  auto build_graph = [this](const string& n1_device, Graph* g) {
+    GraphDefBuilder b(GraphDefBuilder::kFailImmediately);
+    Node* input = ops::SourceOp("TestInput", b.opts().WithName("in"));
+    ops::UnaryOp("TestRelu", ops::NodeOut(input, 0),
+                 b.opts().WithName("n1").WithDevice(n1_device));
+    ops::UnaryOp("TestRelu", ops::NodeOut(input, 1), b.opts().WithName("n2"));
+    TF_EXPECT_OK(BuildGraph(b, g));
+  };
+  PlacementCache cache;
+  auto place = [this, &cache](Graph* g) {
+    Placer placer(g, "", &g->flib_def(), &devices_, nullptr, true, false,
+                  &cache);
+    return placer.Run();
+  };
+
+  Graph g1(OpRegistry::Global());
+  build_graph("", &g1);
+  TF_EXPECT_OK(place(&g1));
+  EXPECT_EQ(0, cache.num_hits());
+  EXPECT_EQ(1, cache.num_misses());
+
+  Graph g2(OpRegistry::Global());
+  build_graph("", &g2);
+  TF_EXPECT_OK(place(&g2));
+  EXPECT_EQ(1, cache.num_hits());
+  EXPECT_DEVICE_TYPE(g2, "in", "FakeCPU");
+  EXPECT_DEVICE_TYPE(g2, "n1", "FakeGPU");
+  EXPECT_DEVICE_TYPE(g2, "n2", "FakeGPU");
+  for (const Node* node : g2.op_nodes()) {
+    Node* same_node = g1.FindNodeId(node->id());
+    EXPECT_EQ(same_node->assigned_device_name(), node->assigned_device_name());
+  }
+
+  Graph g3(OpRegistry::Global());
+  build_graph("/device:FakeCPU:0", &g3);
+  TF_EXPECT_OK(place(&g3));
+  EXPECT_EQ(1, cache.num_hits());
+  EXPECT_EQ(2, cache.num_misses());
+  EXPECT_DEVICE_TYPE(g3, "n1", "FakeCPU");
+}
+
 // Test that a graph with no constraints but using kernels that have a specified
 // device priority will successfully assign nodes to the device with higher
 // priority
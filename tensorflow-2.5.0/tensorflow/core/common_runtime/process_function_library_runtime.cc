@@ -50,6 +50,7 @@ limitations under the License.
 #include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/util/device_name_utils.h"
 #include "tensorflow/core/util/dump_graph.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/ptr_util.h"
 #include "tensorflow/core/util/reffed_status_callback.h"
 #if !defined(IS_MOBILE_PLATFORM)
@@ -102,7 +103,17 @@ ProcessFunctionLibraryRuntime::ProcessFunctionLibraryRuntime(
       session_metadata_(session_metadata),
       rendezvous_factory_(std::move(rendezvous_factory)),
       optimizer_options_(optimizer_options),
-      graph_def_version_(graph_def_version) {
+      graph_def_version_(graph_def_version),
+      instantiation_cache_(FunctionInstantiationCache::Global()) {
+  bool cache_placements = false;
+  Status status = ReadBoolFromEnvVar("TF_PLACER_CACHE_FUNCTION_PLACEMENTS",
+                                     false, &cache_placements);
+  if (!status.ok()) {
+    LOG(ERROR) << status.error_message();
+  }
+  if (cache_placements) {
+    placement_cache_ = absl::make_unique<PlacementCache>();
+  }
   if (device_mgr == nullptr) {
     (*flr_map_)[nullptr] = NewFunctionLibraryRuntime(
         nullptr, env, config_ ? &(*config_) : nullptr, nullptr,
@@ -665,92 +676,16 @@ Status GetGraphAndArgRets(
   return Status::OK();
 }
 
-Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
-    const string& function_name, AttrSlice attrs,
+Status
+ProcessFunctionLibraryRuntime::OptimizeAndPartitionMultiDeviceFunction(
+    const string& function_name, const FunctionDef* fdef,
+    const FunctionLibraryDefinition* lib_def,
     const FunctionLibraryRuntime::InstantiateOptions& options,
-    FunctionLibraryRuntime::Handle* handle) {
-  // Check if this function has already been instantiated.
-  const string& function_key = Canonicalize(function_name, attrs, options);
-
-  {
-    mutex_lock l(mu_);
-    const auto& it = table_.find(function_key);
-    if (it != table_.end()) {
-      *handle = it->second;
-      ++mdevice_data_[*handle]->instantiation_counter_;
-      return Status::OK();
-    }
-  }
-
-  VLOG(1) << "Instantiating MultiDevice function \"" << function_name
-          << "\" on default device \"" << options.target << "\"";
-  if (VLOG_IS_ON(3)) {
-    int index = 0;
-    VLOG(3) << "Requested input devices:";
-    for (const string& device : options.input_devices) {
-      VLOG(3) << "    [input " << index++ << "] " << device;
-    }
-    index = 0;
-    VLOG(3) << "Requested output devices:";
-    for (const string& device : options.output_devices) {
-      VLOG(3) << "    [output " << index++ << "] " << device;
-    }
-  }
-
-  const FunctionLibraryDefinition* lib_def =
-      options.lib_def == nullptr ? lib_def_ : options.lib_def;
-
-  const FunctionDef* fdef = lib_def->Find(function_name);
-  if (fdef == nullptr) {
-    return errors::InvalidArgument("Failed to find function \"", function_name,
-                                   "\" in function library: ", lib_def);
-  }
-
-  TF_RETURN_IF_ERROR(ValidateMultiDeviceOptions(*fdef, options));
-
-  std::unique_ptr<Graph> graph;
-  std::vector<Node*> arg_nodes, ret_nodes;
-  std::vector<string> ret_node_names;
-  DataTypeVector ret_types;
-  std::vector<string> control_ret_node_names;
-
-  TF_RETURN_IF_ERROR(GetGraphAndArgRets(
-      function_name, attrs, fdef, lib_def, &graph, &arg_nodes, &ret_nodes,
-      &ret_node_names, &ret_types, &control_ret_node_names));
-
-  if (options.graph_collector != nullptr) {
-    GraphDef def;
-    graph->ToGraphDef(&def);
-    *def.mutable_library() = lib_def->ReachableDefinitions(def).ToProto();
-    options.graph_collector->CollectRawGraph(def);
-  }
-
-  Device* default_device = nullptr;
-  if (options.default_device_to_target && !options.target.empty()) {
-    // Make the `target` device the default device if nothing else is hard
-    // coded. This allows the same function definition to be specialized to
-    // different devices depending on the `PartitionedCallOp` device.
-    FunctionLibraryRuntime* flr = GetFLR(options.target);
-    if (flr == nullptr) {
-      return errors::InvalidArgument(
-          "Cannot instantiate multi-device function with target device ",
-          options.target);
-    }
-    default_device = flr->device();
-  }
-  const std::shared_ptr<DeviceSet> dev_set = device_set();
-
-  TF_RETURN_IF_ERROR(
-      SetArgShape(options.input_resource_dtypes_and_shapes, arg_nodes));
-  TF_RETURN_IF_ERROR(PinArgsAndRets(
-      options.input_devices, options.output_devices, *dev_set, arg_nodes,
-      ret_nodes,
-      options.config_proto.allow_soft_placement() ? default_device : nullptr));
-
-  auto data = absl::make_unique<MultiDeviceFunctionData>(
-      function_name, function_key, ret_node_names.size(),
-      lib_def->ReachableDefinitions(*fdef), std::move(ret_types));
-
+    const std::shared_ptr<DeviceSet>& dev_set, Device* default_device,
+    std::unique_ptr<Graph> graph, std::vector<string> ret_node_names,
+    std::vector<string> control_ret_node_names, MultiDeviceFunctionData* data,
+    std::unordered_map<string, string>* node_name_to_control_ret,
+    std::unordered_map<string, std::unique_ptr<Graph>>* subgraphs) {
   // Do not run function/graph optimization passes for component functions,
   // since they have already processed the main function.
   const bool should_run_optimization_passes = !options.is_component_function;
@@ -760,9 +695,6 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
             << function_name;
   }
 
-  // Mapping from a function body node name to the control output name.
-  std::unordered_map<string, string> node_name_to_control_ret;
-
   bool control_rets_updated = false;
   if (should_run_optimization_passes) {
     TF_RETURN_IF_ERROR(FunctionOptimizationPassRegistry::Global().Run(
@@ -774,11 +706,11 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
     // Function graph pass may have resulted in different nodes/node names for
     // control rets.
     for (const auto& control_ret : control_ret_node_names) {
-      node_name_to_control_ret.emplace(control_ret, control_ret);
+      node_name_to_control_ret->emplace(control_ret, control_ret);
     }
   } else {
     for (const auto& control_ret : fdef->control_ret()) {
-      node_name_to_control_ret.emplace(control_ret.second, control_ret.first);
+      node_name_to_control_ret->emplace(control_ret.second, control_ret.first);
     }
   }
 
@@ -805,7 +737,8 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
   Placer placer(graph.get(), function_name, optimization_options.flib_def,
                 dev_set.get(), default_device,
                 options.config_proto.allow_soft_placement(),
-                options.config_proto.log_device_placement());
+                options.config_proto.log_device_placement(),
+                placement_cache_.get());
   TF_RETURN_IF_ERROR(placer.Run());
 
   DumpGraph("Before running POST_PLACEMENT passes", graph.get());
@@ -853,18 +786,17 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
   VLOG(4) << "Main function graph to be partitioned:";
   VLOG(4) << DebugString(graph->ToGraphDefDebug());
 
-  std::unordered_map<string, std::unique_ptr<Graph>> subgraphs;
   TF_RETURN_IF_ERROR(
-      PartitionFunctionGraph(*dev_set, std::move(graph), &subgraphs));
+      PartitionFunctionGraph(*dev_set, std::move(graph), subgraphs));
 
-  for (const auto& pair : subgraphs) {
+  for (const auto& pair : *subgraphs) {
     DumpGraph(strings::StrCat("Before running POST_PARTITIONING passes (",
                               pair.first, ")"),
               pair.second.get());
   }
   optimization_options.graph = nullptr;
   optimization_options.device_set = nullptr;
-  optimization_options.partition_graphs = &subgraphs;
+  optimization_options.partition_graphs = subgraphs;
   // Normally POST_PARTITIONING passes are run by distributed workers.
   // Distributed workers are currently not supported in this code path, so we
   // run the passes here.
@@ -872,7 +804,7 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
     TF_RETURN_IF_ERROR(OptimizationPassRegistry::Global()->RunGrouping(
         OptimizationPassRegistry::POST_PARTITIONING, optimization_options));
   }
-  for (const auto& pair : subgraphs) {
+  for (const auto& pair : *subgraphs) {
     const auto* optimized_subgraph = pair.second.get();
     DumpGraph(
         strings::StrCat("After all optimization passes (", pair.first, ")"),
@@ -887,13 +819,146 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
   }
 
   if (options.graph_collector != nullptr) {
-    for (const auto& pair : subgraphs) {
+    for (const auto& pair : *subgraphs) {
       GraphDef def;
       pair.second->ToGraphDef(&def);
       *def.mutable_library() = lib_def->ReachableDefinitions(def).ToProto();
       options.graph_collector->CollectPartitionedGraph(def);
     }
   }
+  return Status::OK();
+}
+
+Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
+    const string& function_name, AttrSlice attrs,
+    const FunctionLibraryRuntime::InstantiateOptions& options,
+    FunctionLibraryRuntime::Handle* handle) {
+  // Check if this function has already been instantiated.
+  const string& function_key = Canonicalize(function_name, attrs, options);
+
+  {
+    mutex_lock l(mu_);
+    const auto& it = table_.find(function_key);
+    if (it != table_.end()) {
+      *handle = it->second;
+      ++mdevice_data_[*handle]->instantiation_counter_;
+      return Status::OK();
+    }
+  }
+
+  VLOG(1) << "Instantiating MultiDevice function \"" << function_name
+          << "\" on default device \"" << options.target << "\"";
+  if (VLOG_IS_ON(3)) {
+    int index = 0;
+    VLOG(3) << "Requested input devices:";
+    for (const string& device : options.input_devices) {
+      VLOG(3) << "    [input " << index++ << "] " << device;
+    }
+    index = 0;
+    VLOG(3) << "Requested output devices:";
+    for (const string& device : options.output_devices) {
+      VLOG(3) << "    [output " << index++ << "] " << device;
+    }
+  }
+
+  const FunctionLibraryDefinition* lib_def =
+      options.lib_def == nullptr ? lib_def_ : options.lib_def;
+
+  const FunctionDef* fdef = lib_def->Find(function_name);
+  if (fdef == nullptr) {
+    return errors::InvalidArgument("Failed to find function \"", function_name,
+                                   "\" in function library: ", lib_def);
+  }
+
+  TF_RETURN_IF_ERROR(ValidateMultiDeviceOptions(*fdef, options));
+
+  std::unique_ptr<Graph> graph;
+  std::vector<Node*> arg_nodes, ret_nodes;
+  std::vector<string> ret_node_names;
+  DataTypeVector ret_types;
+  std::vector<string> control_ret_node_names;
+
+  TF_RETURN_IF_ERROR(GetGraphAndArgRets(
+      function_name, attrs, fdef, lib_def, &graph, &arg_nodes, &ret_nodes,
+      &ret_node_names, &ret_types, &control_ret_node_names));
+
+  if (options.graph_collector != nullptr) {
+    GraphDef def;
+    graph->ToGraphDef(&def);
+    *def.mutable_library() = lib_def->ReachableDefinitions(def).ToProto();
+    options.graph_collector->CollectRawGraph(def);
+  }
+
+  Device* default_device = nullptr;
+  if (options.default_device_to_target && !options.target.empty()) {
+    // Make the `target` device the default device if nothing else is hard
+    // coded. This allows the same function definition to be specialized to
+    // different devices depending on the `PartitionedCallOp` device.
+    FunctionLibraryRuntime* flr = GetFLR(options.target);
+    if (flr == nullptr) {
+      return errors::InvalidArgument(
+          "Cannot instantiate multi-device function with target device ",
+          options.target);
+    }
+    default_device = flr->device();
+  }
+  const std::shared_ptr<DeviceSet> dev_set = device_set();
+
+  TF_RETURN_IF_ERROR(
+      SetArgShape(options.input_resource_dtypes_and_shapes, arg_nodes));
+  TF_RETURN_IF_ERROR(PinArgsAndRets(
+      options.input_devices, options.output_devices, *dev_set, arg_nodes,
+      ret_nodes,
+      options.config_proto.allow_soft_placement() ? default_device : nullptr));
+
+  auto data = absl::make_unique<MultiDeviceFunctionData>(
+      function_name, function_key, ret_node_names.size(),
+      lib_def->ReachableDefinitions(*fdef), std::move(ret_types));
+
+  // Mapping from a function body node name to the control output name.
+  std::unordered_map<string, string> node_name_to_control_ret;
+  std::unordered_map<string, std::unique_ptr<Graph>> subgraphs;
+
+  // The instantiation cache is keyed before the optimization passes add
+  // functions to `data->lib_def_`. It is bypassed when collecting graphs,
+  // since restoring the partitions skips the graphs to collect.
+  const bool use_instantiation_cache =
+      instantiation_cache_ != nullptr && options.graph_collector == nullptr;
+  uint64 cache_key = 0;
+  std::shared_ptr<const CachedFunctionInstantiation> cached;
+  if (use_instantiation_cache) {
+    cache_key = FunctionInstantiationCache::Key(function_name, attrs, options,
+                                                data->lib_def_, *dev_set);
+    cached = instantiation_cache_->Lookup(cache_key);
+  }
+  bool restored = false;
+  if (cached != nullptr) {
+    Status s = FunctionInstantiationCache::RestoreEntry(
+        *cached, *dev_set, &data->lib_def_, &node_name_to_control_ret,
+        &subgraphs);
+    if (s.ok()) {
+      VLOG(1) << "Restored the optimized partitions of function \""
+              << function_name << "\" from the instantiation cache";
+      restored = true;
+    } else {
+      LOG(WARNING) << "Ignoring cached instantiation of function \""
+                   << function_name << "\": " << s;
+      node_name_to_control_ret.clear();
+      subgraphs.clear();
+    }
+  }
+  if (!restored) {
+    TF_RETURN_IF_ERROR(OptimizeAndPartitionMultiDeviceFunction(
+        function_name, fdef, lib_def, options, dev_set, default_device,
+        std::move(graph), std::move(ret_node_names),
+        std::move(control_ret_node_names), data.get(),
+        &node_name_to_control_ret, &subgraphs));
+    if (use_instantiation_cache) {
+      instantiation_cache_->Insert(
+          cache_key, FunctionInstantiationCache::MakeEntry(
+                         subgraphs, node_name_to_control_ret, data->lib_def_));
+    }
+  }
 
   // We must preserve control returns in each of the function components,
   // otherwise after function inlining we might prune side-effectful nodes.
@@ -27,6 +27,8 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/composite_device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/device_set.h"
+#include "tensorflow/core/common_runtime/function_instantiation_cache.h"
+#include "tensorflow/core/common_runtime/placer.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -367,6 +369,20 @@ class ProcessFunctionLibraryRuntime {
       const FunctionLibraryRuntime::InstantiateOptions& options,
       FunctionLibraryRuntime::Handle* handle);
 
+  // Runs the function and graph optimization passes, placement and
+  // partitioning of the body `graph` of multi-device function
+  // `function_name`, filling in `subgraphs` with the optimized partition
+  // graphs keyed by device name.
+  Status OptimizeAndPartitionMultiDeviceFunction(
+      const string& function_name, const FunctionDef* fdef,
+      const FunctionLibraryDefinition* lib_def,
+      const FunctionLibraryRuntime::InstantiateOptions& options,
+      const std::shared_ptr<DeviceSet>& dev_set, Device* default_device,
+      std::unique_ptr<Graph> graph, std::vector<string> ret_node_names,
+      std::vector<string> control_ret_node_names, MultiDeviceFunctionData* data,
+      std::unordered_map<string, string>* node_name_to_control_ret,
+      std::unordered_map<string, std::unique_ptr<Graph>>* subgraphs);
+
   void InstantiateRemote(
       const string& function_name, AttrSlice attrs,
       const FunctionLibraryRuntime::InstantiateOptions& options,
@@ -482,6 +498,16 @@ class ProcessFunctionLibraryRuntime {
 
   const OptimizerOptions optimizer_options_;
   const int graph_def_version_;
+
+  // Placements of instantiated multi-device function bodies, reused when the
+  // same body is placed on the same devices again. Only created when the
+  // TF_PLACER_CACHE_FUNCTION_PLACEMENTS environment variable is true.
+  std::unique_ptr<PlacementCache> placement_cache_;
+
+  // The optimized partitions of instantiated multi-device functions, shared
+  // with the other runtimes of this process. See
+  // FunctionInstantiationCache::Global(). Not owned. May be null.
+  FunctionInstantiationCache* const instantiation_cache_;
 };
 
 }  // namespace tensorflow
@@ -61,8 +61,22 @@ ProcessState::MemDesc ProcessState::PtrType(const void* ptr) {
   return MemDesc();
 }
 
+bool ProcessState::EnableNUMA() {
+  mutex_lock lock(mu_);
+  if (cpu_allocators_.empty()) {
+    numa_enabled_.store(true, std::memory_order_release);
+  } else if (!numa_enabled_.load(std::memory_order_relaxed)) {
+    LOG(WARNING) << "Not enabling NUMA allocators because CPU allocators "
+                    "have already been created.";
+  }
+  return numa_enabled_.load(std::memory_order_relaxed);
+}
+
 Allocator* ProcessState::GetCPUAllocator(int numa_node) {
-  if (!numa_enabled_ || numa_node == port::kNUMANoAffinity) numa_node = 0;
+  if (!numa_enabled_.load(std::memory_order_acquire) ||
+      numa_node == port::kNUMANoAffinity) {
+    numa_node = 0;
+  }
 
   // Check if allocator for the numa node is in lock-free cache.
   if (numa_node < cpu_allocators_cached_.load(std::memory_order_acquire)) {
@@ -70,6 +84,7 @@ Allocator* ProcessState::GetCPUAllocator(int numa_node) {
   }
 
   mutex_lock lock(mu_);
+  const bool numa_enabled = numa_enabled_.load(std::memory_order_relaxed);
   while (cpu_allocators_.size() <= static_cast<size_t>(numa_node)) {
     // If visitors have been defined we need an Allocator built from
     // a SubAllocator.  Prefer BFCAllocator, but fall back to PoolAllocator
@@ -84,9 +99,9 @@ Allocator* ProcessState::GetCPUAllocator(int numa_node) {
     }
     Allocator* allocator = nullptr;
     SubAllocator* sub_allocator =
-        (numa_enabled_ || alloc_visitors_defined || use_bfc_allocator)
+        (numa_enabled || alloc_visitors_defined || use_bfc_allocator)
             ? new BasicCPUAllocator(
-                  numa_enabled_ ? numa_node : port::kNUMANoAffinity,
+                  numa_enabled ? numa_node : port::kNUMANoAffinity,
                   cpu_alloc_visitors_, cpu_free_visitors_)
             : nullptr;
     if (use_bfc_allocator) {
@@ -111,7 +126,7 @@ Allocator* ProcessState::GetCPUAllocator(int numa_node) {
           new PoolAllocator(/*pool_size_limit=*/100, /*auto_resize=*/true,
                             sub_allocator, new NoopRounder, "cpu_pool");
       VLOG(2) << "Using PoolAllocator for ProcessState CPU allocator "
-              << "numa_enabled_=" << numa_enabled_
+              << "numa_enabled_=" << numa_enabled
               << " numa_node=" << numa_node;
     } else {
       DCHECK(!sub_allocator);
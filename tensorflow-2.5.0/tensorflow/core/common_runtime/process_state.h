@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_PROCESS_STATE_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_PROCESS_STATE_H_
 
+#include <atomic>
 #include <functional>
 #include <map>
 #include <unordered_map>
@@ -56,8 +57,10 @@ class ProcessState : public ProcessStateInterface {
   };
 
   // If NUMA Allocators are desired, call this before calling any
-  // Allocator accessor.
-  void EnableNUMA() { numa_enabled_ = true; }
+  // Allocator accessor. The choice is made once per process: once a CPU
+  // allocator has been handed out this has no effect, so that all allocators
+  // agree on it. Returns whether NUMA allocators are in use.
+  bool EnableNUMA();
 
   // Returns what we know about the memory at ptr.
   // If we know nothing, it's called CPU 0 with no other attributes.
@@ -93,7 +96,8 @@ class ProcessState : public ProcessStateInterface {
   void TestOnlyReset();
 
   static ProcessState* instance_;
-  bool numa_enabled_;
+  // Only changes while `cpu_allocators_` is empty, under `mu_`.
+  std::atomic<bool> numa_enabled_;
 
   mutex mu_;
 
@@ -383,8 +383,7 @@ void PropagatorState::CleanupFramesIterations(FrameState* frame,
   }
 }
 
-template <bool atomic>
-int PropagatorState::FrameState::ActivateNodesFastPathInternal(
+int PropagatorState::FrameState::ActivateNodesFastPath(
     const NodeItem* item, const bool is_dead, IterationState* iter_state,
     EntryVector* outputs, TaggedNodeSeq* ready) {
   // If we know that none of the item's edge destinations require special
@@ -426,10 +425,8 @@ int PropagatorState::FrameState::ActivateNodesFastPathInternal(
       input_tensors[dst_loc] = (*outputs)[src_slot];
     }
     const PendingCounts::AdjustResult adjust_result =
-        atomic
-            ? iter_state->adjust_for_activation_atomic(dst_pending_id,
-                                                       increment_dead)
-            : iter_state->adjust_for_activation(dst_pending_id, increment_dead);
+        iter_state->adjust_for_activation_atomic(dst_pending_id,
+                                                 increment_dead);
     MAYBE_ADD_TO_READY(dst_id, adjust_result);
   }
 
@@ -438,9 +435,7 @@ int PropagatorState::FrameState::ActivateNodesFastPathInternal(
     const PendingCounts::Handle dst_pending_id =
         immutable_state.pending_ids()[dst_id];
     const PendingCounts::AdjustResult adjust_result =
-        atomic
-            ? iter_state->adjust_for_activation_atomic(dst_pending_id, is_dead)
-            : iter_state->adjust_for_activation(dst_pending_id, is_dead);
+        iter_state->adjust_for_activation_atomic(dst_pending_id, is_dead);
     MAYBE_ADD_TO_READY(dst_id, adjust_result);
   }
 
@@ -509,11 +504,13 @@ int PropagatorState::FrameState::ActivateNodesSlowPath(
         dst_need_input = false;
       }
     } else {
-      // Handle all other (non-merge) nodes.
+      // Handle all other (non-merge) nodes. These may also be activated by
+      // ActivateNodesFastPath(), which does not hold 'mu'.
       const bool increment_dead =
           (is_dead || ((*outputs)[src_slot].state == Entry::State::NO_VALUE));
       const PendingCounts::AdjustResult adjust_result =
-          iter_state->adjust_for_activation(dst_pending_id, increment_dead);
+          iter_state->adjust_for_activation_atomic(dst_pending_id,
+                                                   increment_dead);
       dst_dead = adjust_result.any_dead;
       dst_ready = !adjust_result.any_pending;
     }
@@ -551,7 +548,7 @@ int PropagatorState::FrameState::ActivateNodesSlowPath(
     } else {
       // Handle all other (non-merge) nodes.
       const PendingCounts::AdjustResult adjust_result =
-          iter_state->adjust_for_activation(dst_pending_id, is_dead);
+          iter_state->adjust_for_activation_atomic(dst_pending_id, is_dead);
       dst_dead = adjust_result.any_dead;
       dst_ready = !adjust_result.any_pending;
     }
@@ -570,15 +567,11 @@ bool PropagatorState::FrameState::ActivateNodesAndAdjustOutstanding(
         ActivateNodesSlowPath(item, is_dead, iter_state, outputs, ready);
     return AdjustOutstandingOpsLocked(iter_state, activated - 1, ready);
   }
-  {
-    tf_shared_lock l(mu);
-    int activated =
-        ActivateNodesFastPathShared(item, is_dead, iter_state, outputs, ready);
-    bool iter_done = AdjustOutstandingOpsFastPath(iter_state, activated - 1);
-    if (!iter_done) return false;
-  }
-  mutex_lock l(mu);
-  return CleanupIterations(iter_state, ready);
+  // The node being propagated is still counted in `iter_state`, so the
+  // iteration cannot be cleaned up while its successors are activated.
+  int activated =
+      ActivateNodesFastPath(item, is_dead, iter_state, outputs, ready);
+  return AdjustOutstandingOps(iter_state, activated - 1, ready);
 }
 
 int PropagatorState::FrameState::ActivateNodesLocked(const NodeItem* item,
@@ -589,8 +582,7 @@ int PropagatorState::FrameState::ActivateNodesLocked(const NodeItem* item,
   if (TF_PREDICT_FALSE(item->is_any_consumer_merge_or_control_trigger)) {
     return ActivateNodesSlowPath(item, is_dead, iter_state, outputs, ready);
   } else {
-    return ActivateNodesFastPathLocked(item, is_dead, iter_state, outputs,
-                                       ready);
+    return ActivateNodesFastPath(item, is_dead, iter_state, outputs, ready);
   }
 }
 
@@ -750,6 +742,9 @@ bool PropagatorState::FrameState::AdjustOutstandingOps(
   if (delta == 0) {
     return false;
   }
+  if (TF_PREDICT_TRUE(TryAdjustOutstandingOpsLockFree(iter_state, delta))) {
+    return false;
+  }
   {
     tf_shared_lock sl(mu);
     if (TF_PREDICT_TRUE(!AdjustOutstandingOpsFastPath(iter_state, delta))) {
@@ -767,6 +762,21 @@ bool PropagatorState::FrameState::AdjustOutstandingOpsFastPath(
   return (old_val + delta == 0) && IsIterationDone(iter_state);
 }
 
+bool PropagatorState::FrameState::TryAdjustOutstandingOpsLockFree(
+    IterationState* iter_state, int delta) {
+  // Only the update that drops the count to zero has to be serialized with
+  // CleanupIterations(), which checks and deletes done iterations under 'mu'.
+  // Any other update leaves an op outstanding, so the iteration can't be done.
+  size_t old_val = iter_state->outstanding_ops.load(std::memory_order_relaxed);
+  while (old_val + delta != 0) {
+    if (iter_state->outstanding_ops.compare_exchange_weak(old_val,
+                                                          old_val + delta)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 // Decrement the outstanding op count and clean up the iterations in the
 // frame. Return true iff the execution of the frame is done.
 bool PropagatorState::FrameState::DecrementOutstandingOpsLocked(
@@ -777,13 +787,13 @@ bool PropagatorState::FrameState::DecrementOutstandingOpsLocked(
 
 bool PropagatorState::FrameState::AdjustOutstandingOpsLocked(
     IterationState* iter_state, int delta, TaggedNodeSeq* ready) {
-  // We hold the lock, so we don't need to use an atomic modification.
-  auto cur_val = iter_state->outstanding_ops.load(std::memory_order_relaxed);
+  // Even though we hold the lock, TryAdjustOutstandingOpsLockFree() may
+  // modify the count concurrently, so the update must be atomic.
+  auto cur_val = iter_state->outstanding_ops.fetch_add(delta);
   DCHECK(delta >= 0 || cur_val >= -delta)
       << "cannot adjust outstanding_ops by " << delta
       << " when current value is " << cur_val;
   auto new_val = cur_val + delta;
-  iter_state->outstanding_ops.store(new_val, std::memory_order_relaxed);
   if (new_val != 0) {
     return false;
   }
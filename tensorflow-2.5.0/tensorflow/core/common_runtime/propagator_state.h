@@ -166,10 +166,8 @@ class PropagatorState {
     void increment_dead_count(PendingCounts::Handle h) {
       counts.increment_dead_count(h);
     }
-    PendingCounts::AdjustResult adjust_for_activation(PendingCounts::Handle h,
-                                                      bool increment_dead) {
-      return counts.adjust_for_activation(h, increment_dead);
-    }
+    // Non-merge nodes may be activated concurrently by threads that do not
+    // hold the frame lock, so their counts are always adjusted atomically.
     PendingCounts::AdjustResult adjust_for_activation_atomic(
         PendingCounts::Handle h, bool increment_dead) {
       return counts.adjust_for_activation_atomic(h, increment_dead);
@@ -302,7 +300,8 @@ class PropagatorState {
     // the frame if no more ops are oustanding. Return true iff the execution of
     // the frame is done.
     //
-    // Avoids acquiring the lock in the common case that the frame is not done.
+    // Avoids acquiring the lock in the common case that the count does not
+    // drop to zero.
     bool AdjustOutstandingOps(IterationState* iter_state, int delta,
                               TaggedNodeSeq* ready);
 
@@ -313,6 +312,13 @@ class PropagatorState {
     bool AdjustOutstandingOpsFastPath(IterationState* iter_state, int delta)
         TF_SHARED_LOCKS_REQUIRED(mu);
 
+    // Adjusts the outstanding op count by 'delta' without taking 'mu', unless
+    // that would drop the count to zero. Returns true iff the count was
+    // adjusted. Callers must hold an outstanding op in 'iter_state', so that
+    // it cannot be cleaned up concurrently.
+    bool TryAdjustOutstandingOpsLockFree(IterationState* iter_state,
+                                         int delta);
+
     // Convenience methods for the above 'Adjust' calls where delta takes the
     // common value of -1.
     bool DecrementOutstandingOps(IterationState* iter_state,
@@ -351,8 +357,8 @@ class PropagatorState {
     // indeterminate state after returning from this method.
     //
     // In the case that 'item' is a simple node (no merge/control outputs) this
-    // will acquire a shared lock and can run concurrently with other
-    // invocations.
+    // does not acquire 'mu' unless the iteration may be done, and can run
+    // concurrently with other invocations.
     //
     // Return true if the frame is done after activation.
     bool ActivateNodesAndAdjustOutstanding(const NodeItem* item,
@@ -390,31 +396,12 @@ class PropagatorState {
 
    private:
     // REQUIRES: `!item->is_any_consumer_merge_or_control_trigger`.
-    // This variant does not use atomic operations to modify the pending counts
-    // and thus must hold the exclusive lock.
-    int ActivateNodesFastPathLocked(const NodeItem* item, const bool is_dead,
-                                    IterationState* iter_state,
-                                    EntryVector* outputs, TaggedNodeSeq* ready)
-        TF_EXCLUSIVE_LOCKS_REQUIRED(mu) {
-      return ActivateNodesFastPathInternal<false>(item, is_dead, iter_state,
-                                                  outputs, ready);
-    }
-
-    // REQUIRES: `!item->is_any_consumer_merge_or_control_trigger`.
-    // This variant uses atomic operations to modify the pending counts.
-    int ActivateNodesFastPathShared(const NodeItem* item, const bool is_dead,
-                                    IterationState* iter_state,
-                                    EntryVector* outputs, TaggedNodeSeq* ready)
-        TF_SHARED_LOCKS_REQUIRED(mu) {
-      return ActivateNodesFastPathInternal<true>(item, is_dead, iter_state,
-                                                 outputs, ready);
-    }
-
-    template <bool atomic>
-    int ActivateNodesFastPathInternal(const NodeItem* item, const bool is_dead,
-                                      IterationState* iter_state,
-                                      EntryVector* outputs,
-                                      TaggedNodeSeq* ready);
+    // Uses atomic operations to modify the pending counts, and therefore does
+    // not require 'mu'. The caller must hold an outstanding op in
+    // 'iter_state'.
+    int ActivateNodesFastPath(const NodeItem* item, const bool is_dead,
+                              IterationState* iter_state, EntryVector* outputs,
+                              TaggedNodeSeq* ready);
 
     int ActivateNodesSlowPath(const NodeItem* item, const bool is_dead,
                               IterationState* iter_state, EntryVector* outputs,
@@ -0,0 +1,85 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/recording_allocator.h"
+
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+
+RecordingAllocator::RecordingAllocator(Allocator* allocator)
+    : allocator_(allocator),
+      start_micros_(Env::Default()->NowMicros()),
+      next_sequence_(1) {
+  trace_.set_allocator_name(allocator_->Name());
+}
+
+void* RecordingAllocator::AllocateRaw(
+    size_t alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
+  void* ptr = allocator_->AllocateRaw(alignment, num_bytes, allocation_attr);
+  // Failed allocations are not recorded: on replay the same request would
+  // have to fail just the same to be comparable.
+  if (ptr == nullptr) {
+    return ptr;
+  }
+  const MemoryDebugAnnotation& annotation =
+      ScopedMemoryDebugAnnotation::CurrentAnnotation();
+  const uint64 now_micros = Env::Default()->NowMicros();
+  mutex_lock l(mu_);
+  live_[ptr] = trace_.allocations_size();
+  AllocationTrace::Allocation* allocation = trace_.add_allocations();
+  allocation->set_num_bytes(num_bytes);
+  allocation->set_alignment(alignment);
+  allocation->set_alloc_sequence(next_sequence_++);
+  allocation->set_alloc_micros(now_micros - start_micros_);
+  if (annotation.pending_op_name != nullptr) {
+    allocation->set_op_name(annotation.pending_op_name);
+  }
+  allocation->set_step_id(annotation.pending_step_id);
+  return ptr;
+}
+
+void RecordingAllocator::DeallocateRaw(void* ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
+  {
+    const uint64 now_micros = Env::Default()->NowMicros();
+    mutex_lock l(mu_);
+    auto it = live_.find(ptr);
+    if (it != live_.end()) {
+      AllocationTrace::Allocation* allocation =
+          trace_.mutable_allocations(it->second);
+      allocation->set_free_sequence(next_sequence_++);
+      allocation->set_free_micros(now_micros - start_micros_);
+      live_.erase(it);
+    }
+  }
+  allocator_->DeallocateRaw(ptr);
+}
+
+AllocationTrace RecordingAllocator::GetTrace() const {
+  mutex_lock l(mu_);
+  return trace_;
+}
+
+void RecordingAllocator::ClearTrace() {
+  mutex_lock l(mu_);
+  trace_.clear_allocations();
+  live_.clear();
+}
+
+}  // namespace tensorflow
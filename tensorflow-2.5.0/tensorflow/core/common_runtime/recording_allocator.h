@@ -0,0 +1,88 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_RECORDING_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_RECORDING_ALLOCATOR_H_
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/allocation_trace.pb.h"
+
+namespace tensorflow {
+
+// RecordingAllocator is a wrapper for an Allocator, like TrackingAllocator,
+// that forwards every call to the wrapped allocator and records the size,
+// alignment and lifetime of each allocation as an AllocationTrace. The trace
+// can later be replayed offline against another allocator with
+// ReplayAllocationTrace() to compare allocators on a real workload.
+//
+// Unlike TrackingAllocator, a RecordingAllocator is not reference counted:
+// it must outlive every allocation made through it.
+class RecordingAllocator : public Allocator {
+ public:
+  // Does not take ownership of `allocator`.
+  explicit RecordingAllocator(Allocator* allocator);
+  ~RecordingAllocator() override {}
+
+  std::string Name() override { return allocator_->Name(); }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+  }
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override;
+  void DeallocateRaw(void* ptr) override;
+  bool TracksAllocationSizes() const override {
+    return allocator_->TracksAllocationSizes();
+  }
+  size_t RequestedSize(const void* ptr) const override {
+    return allocator_->RequestedSize(ptr);
+  }
+  size_t AllocatedSize(const void* ptr) const override {
+    return allocator_->AllocatedSize(ptr);
+  }
+  int64 AllocationId(const void* ptr) const override {
+    return allocator_->AllocationId(ptr);
+  }
+  absl::optional<AllocatorStats> GetStats() override {
+    return allocator_->GetStats();
+  }
+  void ClearStats() override { allocator_->ClearStats(); }
+
+  // Returns the allocations recorded so far.
+  AllocationTrace GetTrace() const;
+
+  // Drops the recorded allocations, e.g. to only keep the last step. Frees of
+  // memory allocated before the call are not recorded.
+  void ClearTrace();
+
+ private:
+  Allocator* const allocator_;  // not owned.
+  const uint64 start_micros_;
+
+  mutable mutex mu_;
+  int64 next_sequence_ TF_GUARDED_BY(mu_);
+  AllocationTrace trace_ TF_GUARDED_BY(mu_);
+  // Maps each outstanding pointer to its index in trace_.allocations().
+  absl::flat_hash_map<const void*, int> live_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(RecordingAllocator);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_RECORDING_ALLOCATOR_H_
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <atomic>
 #include <functional>
+#include <memory>
 #include <utility>
 
 #include "tensorflow/core/common_runtime/collective_rma_local.h"
@@ -160,6 +161,27 @@ Status GenerateSubdivsInCollectiveParams(CollectiveParams* col_params) {
 
   return Status::OK();
 }
+
+template <typename T>
+void CastChunk(const Tensor& src, Tensor* dst) {
+  if (src.dtype() == DT_FLOAT) {
+    dst->flat<T>() = src.flat<float>().template cast<T>();
+  } else {
+    dst->flat<float>() = src.flat<T>().template cast<float>();
+  }
+}
+
+// Converts between the DT_FLOAT tensor and the `wire_data_type` tensor of the
+// same shape, in the direction given by their types.
+void ConvertWireChunk(DataType wire_data_type, const Tensor& src,
+                      Tensor* dst) {
+  if (wire_data_type == DT_HALF) {
+    CastChunk<Eigen::half>(src, dst);
+  } else {
+    DCHECK_EQ(wire_data_type, DT_BFLOAT16);
+    CastChunk<bfloat16>(src, dst);
+  }
+}
 }  // namespace
 
 Status RingAlg::InitializeCollectiveParams(CollectiveParams* col_params) {
@@ -389,13 +411,22 @@ void RingAlg::DispatchSend(RingField* rf, const StatusCallback& done) {
   int send_to_rank = (rf->rank + 1) % group_size_;
   int send_to_dev_idx = col_params_->instance.impl_details
                             .subdiv_permutations[rf->subdiv_idx][send_to_rank];
+  const Tensor* send_tensor = &rf->chunk;
+  StatusCallback send_done = done;
+  if (wire_data_type_ != DT_INVALID && rf->send_is_remote) {
+    auto wire_chunk =
+        std::make_shared<Tensor>(wire_data_type_, rf->chunk.shape());
+    ConvertWireChunk(wire_data_type_, rf->chunk, wire_chunk.get());
+    send_tensor = wire_chunk.get();
+    send_done = [wire_chunk, done](const Status& s) { done(s); };
+  }
   col_ctx_->col_exec->remote_access()->PostToPeer(
       col_params_->group.device_names[send_to_dev_idx],
       col_params_->group.task_names[send_to_dev_idx], send_buf_key,
       col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
-      col_ctx_->op_ctx->output_alloc_attr(0), &rf->chunk,
+      col_ctx_->op_ctx->output_alloc_attr(0), send_tensor,
       col_ctx_->device_locality, col_ctx_->op_ctx->cancellation_manager(),
-      done);
+      send_done);
 }
 
 void RingAlg::DispatchRecv(RingField* rf, const StatusCallback& done) {
@@ -409,6 +440,18 @@ void RingAlg::DispatchRecv(RingField* rf, const StatusCallback& done) {
   Tensor* dst_tensor = (!rf->second_pass && (col_params_->merge_op != nullptr))
                            ? &rf->tmp_chunk
                            : &rf->chunk;
+  StatusCallback recv_done = done;
+  if (wire_data_type_ != DT_INVALID && rf->recv_is_remote) {
+    auto wire_chunk =
+        std::make_shared<Tensor>(wire_data_type_, dst_tensor->shape());
+    recv_done = [this, wire_chunk, dst_tensor, done](const Status& s) {
+      if (s.ok()) {
+        ConvertWireChunk(wire_data_type_, *wire_chunk, dst_tensor);
+      }
+      done(s);
+    };
+    dst_tensor = wire_chunk.get();
+  }
   col_ctx_->col_exec->remote_access()->RecvFromPeer(
       col_params_->group.device_names[rf->recv_dev_idx],
       col_params_->group.task_names[rf->recv_dev_idx],
@@ -416,7 +459,13 @@ void RingAlg::DispatchRecv(RingField* rf, const StatusCallback& done) {
       col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
       col_ctx_->op_ctx->output_alloc_attr(0), dst_tensor,
       col_ctx_->device_locality, rf->subdiv_idx,
-      col_ctx_->op_ctx->cancellation_manager(), done);
+      col_ctx_->op_ctx->cancellation_manager(), recv_done);
+}
+
+void RingAlg::RoundChunkToWireType(RingField* rf) {
+  Tensor wire_chunk(wire_data_type_, rf->chunk.shape());
+  ConvertWireChunk(wire_data_type_, rf->chunk, &wire_chunk);
+  ConvertWireChunk(wire_data_type_, wire_chunk, &rf->chunk);
 }
 
 string RingAlg::FieldState() {
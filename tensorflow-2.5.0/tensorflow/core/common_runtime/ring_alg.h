@@ -89,6 +89,10 @@ class RingAlg : public CollectiveImplementationInterface {
   void AdvanceToSecondPass(RingField* rf);
   void DispatchSend(RingField* rf, const StatusCallback& done);
   void DispatchRecv(RingField* rf, const StatusCallback& done);
+  // Rounds the values of `rf`'s chunk to wire_data_type_, so that every
+  // device ends up with the same values whether or not they were sent
+  // between tasks.
+  void RoundChunkToWireType(RingField* rf);
 
   // For constructing log messages for debugging.
   string FieldState();
@@ -120,6 +124,9 @@ class RingAlg : public CollectiveImplementationInterface {
   mutex status_mu_;
   Status status_ TF_GUARDED_BY(status_mu_);
   std::vector<RingField> rfv_;
+  // If not DT_INVALID, the type in which the DT_FLOAT chunks are sent to and
+  // received from other tasks.
+  DataType wire_data_type_ = DT_INVALID;
 };
 
 }  // namespace tensorflow
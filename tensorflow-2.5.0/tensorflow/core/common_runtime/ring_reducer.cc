@@ -64,6 +64,12 @@ void RingReducer::Run(StatusCallback done) {
   num_subdivs_ = static_cast<int>(
       col_params_->instance.impl_details.subdiv_permutations.size());
   CHECK_GT(num_subdivs_, 0);
+  // Values are only converted on CPU; other devices send them as they are.
+  if (col_params_->group.num_tasks > 1 &&
+      col_params_->instance.data_type == DT_FLOAT &&
+      col_params_->group.device_type == DEVICE_CPU) {
+    wire_data_type_ = col_params_->instance.impl_details.wire_data_type;
+  }
 
   if (VLOG_IS_ON(1)) {
     string buf;
@@ -314,6 +320,11 @@ bool RingReducer::RunAsyncParts() {
             ++field_done_count;
             break;  // from do while(!dispatched)
           } else {
+            // The final value is rounded before it is distributed, as the
+            // devices in other tasks receive it in the wire type.
+            if (rf->is_final && rf->do_recv && wire_data_type_ != DT_INVALID) {
+              RoundChunkToWireType(rf);
+            }
             AdvanceToSecondPass(rf);
           }
         }
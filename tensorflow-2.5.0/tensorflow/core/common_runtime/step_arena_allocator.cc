@@ -0,0 +1,181 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include <algorithm>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+constexpr size_t StepArenaAllocator::kDefaultBlockSize;
+constexpr int64 StepArenaAllocator::kDefaultMaxEscapedBytes;
+
+namespace {
+
+// The bytes of the escaped blocks of all arenas.
+std::atomic<int64> total_escaped_bytes{0};
+
+}  // namespace
+
+StepArenaAllocator::StepArenaAllocator(Allocator* allocator,
+                                       size_t block_size,
+                                       int64 max_escaped_bytes)
+    : allocator_(allocator),
+      block_size_(block_size),
+      max_escaped_bytes_(max_escaped_bytes) {}
+
+StepArenaAllocator::~StepArenaAllocator() { DCHECK(blocks_.empty()); }
+
+void* StepArenaAllocator::AllocateRaw(
+    size_t alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
+  const size_t size =
+      (std::max<size_t>(num_bytes, 1) + kAllocatorAlignment - 1) /
+      kAllocatorAlignment * kAllocatorAlignment;
+  if (alignment <= kAllocatorAlignment && size <= block_size_) {
+    while (true) {
+      Block* block = current_.load(std::memory_order_acquire);
+      if (block != nullptr) {
+        // Counted as live first, so that the block is not released meanwhile.
+        block->live.fetch_add(1, std::memory_order_relaxed);
+        const size_t offset =
+            block->used.fetch_add(size, std::memory_order_relaxed);
+        if (offset + size <= block->size) return block->data + offset;
+        block->live.fetch_sub(1, std::memory_order_relaxed);
+      }
+      // Too much memory is pinned by tensors that escaped earlier steps.
+      if (total_escaped_bytes.load(std::memory_order_relaxed) >=
+          max_escaped_bytes_) {
+        break;
+      }
+      if (!NewBlock(block)) break;
+    }
+  }
+  void* ptr = allocator_->AllocateRaw(alignment, num_bytes, allocation_attr);
+  if (ptr != nullptr) Ref();
+  return ptr;
+}
+
+void StepArenaAllocator::DeallocateRaw(void* ptr) {
+  int64 live = -1;
+  {
+    tf_shared_lock l(mu_);
+    const int index = FindBlock(ptr);
+    if (index >= 0) {
+      live = blocks_[index]->live.fetch_sub(1, std::memory_order_acq_rel) - 1;
+    }
+  }
+  if (live < 0) {
+    allocator_->DeallocateRaw(ptr);
+    // May delete this allocator.
+    Unref();
+    return;
+  }
+  if (live > 0 || !finished_.load(std::memory_order_acquire)) return;
+  {
+    // The last allocation of an escaped block. StepFinished may have
+    // released the block meanwhile, so look it up again.
+    mutex_lock l(mu_);
+    const int index = FindBlock(ptr);
+    if (index < 0 ||
+        blocks_[index]->live.load(std::memory_order_acquire) != 0) {
+      return;
+    }
+    ReleaseBlock(index);
+    total_escaped_bytes.fetch_sub(block_size_, std::memory_order_relaxed);
+  }
+  // May delete this allocator.
+  Unref();
+}
+
+void StepArenaAllocator::StepFinished() {
+  int num_released = 0;
+  {
+    mutex_lock l(mu_);
+    finished_.store(true, std::memory_order_release);
+    current_.store(nullptr, std::memory_order_release);
+    for (int i = blocks_.size() - 1; i >= 0; --i) {
+      if (blocks_[i]->live.load(std::memory_order_acquire) == 0) {
+        ReleaseBlock(i);
+        ++num_released;
+      }
+    }
+    num_escaped_blocks_ = blocks_.size();
+    total_escaped_bytes.fetch_add(num_escaped_blocks_ * block_size_,
+                                  std::memory_order_relaxed);
+    if (num_escaped_blocks_ > 0) {
+      VLOG(2) << num_escaped_blocks_ << " step arena blocks hold tensors that "
+              << "outlive the step.";
+    }
+  }
+  for (int i = 0; i < num_released; ++i) Unref();
+}
+
+int64 StepArenaAllocator::num_blocks() const {
+  mutex_lock l(mu_);
+  return num_blocks_;
+}
+
+int64 StepArenaAllocator::num_escaped_blocks() const {
+  mutex_lock l(mu_);
+  return num_escaped_blocks_;
+}
+
+/*static*/ int64 StepArenaAllocator::TotalEscapedBytes() {
+  return total_escaped_bytes.load(std::memory_order_relaxed);
+}
+
+bool StepArenaAllocator::NewBlock(Block* full) {
+  mutex_lock l(mu_);
+  if (finished_.load(std::memory_order_relaxed)) return false;
+  if (current_.load(std::memory_order_relaxed) != full) return true;
+  auto block = absl::make_unique<Block>();
+  block->data = static_cast<char*>(
+      allocator_->AllocateRaw(kAllocatorAlignment, block_size_));
+  if (block->data == nullptr) return false;
+  block->size = block_size_;
+  current_.store(block.get(), std::memory_order_release);
+  auto it = std::upper_bound(
+      blocks_.begin(), blocks_.end(), block->data,
+      [](const char* data, const std::unique_ptr<Block>& b) {
+        return data < b->data;
+      });
+  blocks_.insert(it, std::move(block));
+  ++num_blocks_;
+  Ref();
+  return true;
+}
+
+int StepArenaAllocator::FindBlock(const void* ptr) const {
+  const char* p = static_cast<const char*>(ptr);
+  auto it = std::upper_bound(
+      blocks_.begin(), blocks_.end(), p,
+      [](const char* data, const std::unique_ptr<Block>& b) {
+        return data < b->data;
+      });
+  if (it == blocks_.begin()) return -1;
+  --it;
+  if (p >= (*it)->data + (*it)->size) return -1;
+  return it - blocks_.begin();
+}
+
+void StepArenaAllocator::ReleaseBlock(int index) {
+  allocator_->DeallocateRaw(blocks_[index]->data);
+  blocks_.erase(blocks_.begin() + index);
+}
+
+}  // namespace tensorflow
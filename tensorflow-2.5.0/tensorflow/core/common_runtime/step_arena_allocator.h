@@ -0,0 +1,116 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A bump-pointer allocator for the small host tensors of one executor step.
+//
+// Allocations are carved from blocks obtained from the underlying allocator,
+// and freeing them only decrements a count of live allocations in their block.
+// When the step finishes (StepFinished), the blocks without live allocations
+// are returned to the underlying allocator. A block still holding a tensor
+// that escaped the step, e.g. a fetched output or a tensor stored in a
+// resource, is kept until that tensor is freed, so escaping tensors stay valid
+// without being copied.
+//
+// Since a small escaping tensor pins a whole block, the bytes of the escaped
+// blocks of all arenas are capped: while they exceed `max_escaped_bytes`, no
+// new blocks are allocated and allocations are forwarded to the underlying
+// allocator.
+//
+// Allocations larger than a block, or made after the step finished, are
+// forwarded to the underlying allocator.
+class StepArenaAllocator : public Allocator, public core::RefCounted {
+ public:
+  static constexpr size_t kDefaultBlockSize = 32 << 10;
+  static constexpr int64 kDefaultMaxEscapedBytes = 64 << 20;
+
+  explicit StepArenaAllocator(Allocator* allocator,
+                              size_t block_size = kDefaultBlockSize,
+                              int64 max_escaped_bytes = kDefaultMaxEscapedBytes);
+  ~StepArenaAllocator() override;
+
+  string Name() override { return "step_arena"; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+  }
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override;
+  void DeallocateRaw(void* ptr) override;
+
+  // Must be called once, when the step finished. Allocations still live then
+  // keep their block, and this allocator, alive until they are freed.
+  void StepFinished();
+
+  // Returns the number of blocks allocated during the step.
+  int64 num_blocks() const;
+
+  // Returns the number of blocks that held live allocations when the step
+  // finished.
+  int64 num_escaped_blocks() const;
+
+  // Returns the number of bytes in the escaped blocks of all arenas that are
+  // not yet released.
+  static int64 TotalEscapedBytes();
+
+ private:
+  struct Block {
+    char* data = nullptr;
+    size_t size = 0;
+    std::atomic<size_t> used{0};
+    std::atomic<int64> live{0};
+  };
+
+  // Replaces the current block if it is still `full`. Returns false if no
+  // block could be allocated.
+  bool NewBlock(Block* full);
+
+  // Returns the index in blocks_ of the block holding `ptr`, or -1.
+  int FindBlock(const void* ptr) const TF_SHARED_LOCKS_REQUIRED(mu_);
+
+  // Returns the memory of blocks_[index] and removes it.
+  void ReleaseBlock(int index) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Allocator* const allocator_;
+  const size_t block_size_;
+  const int64 max_escaped_bytes_;
+  std::atomic<Block*> current_{nullptr};
+  std::atomic<bool> finished_{false};
+
+  mutable mutex mu_;
+  // Sorted by address. Each block holds a reference on this allocator.
+  std::vector<std::unique_ptr<Block>> blocks_ TF_GUARDED_BY(mu_);
+  int64 num_blocks_ TF_GUARDED_BY(mu_) = 0;
+  int64 num_escaped_blocks_ TF_GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StepArenaAllocator);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
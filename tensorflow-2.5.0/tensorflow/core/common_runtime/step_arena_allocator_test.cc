@@ -0,0 +1,130 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(StepArenaAllocatorTest, AllocatesFromBlocks) {
+  StepArenaAllocator* arena = new StepArenaAllocator(cpu_allocator(), 1024);
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 32; ++i) {
+    void* ptr = arena->AllocateRaw(Allocator::kAllocatorAlignment, 60);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % Allocator::kAllocatorAlignment,
+              0);
+    ptrs.push_back(ptr);
+  }
+  // 16 allocations of 64 bytes per block.
+  EXPECT_EQ(arena->num_blocks(), 2);
+  // Larger allocations come from the underlying allocator.
+  void* large = arena->AllocateRaw(Allocator::kAllocatorAlignment, 2048);
+  ASSERT_NE(large, nullptr);
+  EXPECT_EQ(arena->num_blocks(), 2);
+  for (void* ptr : ptrs) arena->DeallocateRaw(ptr);
+  arena->DeallocateRaw(large);
+  arena->StepFinished();
+  EXPECT_EQ(arena->num_escaped_blocks(), 0);
+  arena->Unref();
+}
+
+TEST(StepArenaAllocatorTest, EscapedTensorsOutliveStep) {
+  StepArenaAllocator* arena = new StepArenaAllocator(cpu_allocator(), 256);
+  Tensor escaped;
+  {
+    Tensor t(arena, DT_FLOAT, TensorShape({4}));
+    t.flat<float>().setConstant(1.0f);
+    Tensor freed(arena, DT_FLOAT, TensorShape({64}));
+    escaped = t;
+  }
+  Tensor other(arena, DT_FLOAT, TensorShape({64}));
+  other = Tensor();
+  EXPECT_EQ(arena->num_blocks(), 3);
+  arena->StepFinished();
+  EXPECT_EQ(arena->num_escaped_blocks(), 1);
+  // Allocations after the step come from the underlying allocator.
+  Tensor late(arena, DT_FLOAT, TensorShape({4}));
+  EXPECT_EQ(arena->num_blocks(), 3);
+  arena->Unref();
+  // The escaped tensor keeps its block, and the arena, alive.
+  EXPECT_EQ(escaped.flat<float>()(3), 1.0f);
+}
+
+TEST(StepArenaAllocatorTest, CapsBytesPinnedByEscapedTensors) {
+  const int64 escaped_bytes = StepArenaAllocator::TotalEscapedBytes();
+  // Each step lets one small tensor escape, which pins a 256 byte block.
+  auto run_step = [escaped_bytes](Tensor* escaped) {
+    StepArenaAllocator* arena = new StepArenaAllocator(
+        cpu_allocator(), 256, /*max_escaped_bytes=*/escaped_bytes + 512);
+    *escaped = Tensor(arena, DT_FLOAT, TensorShape({4}));
+    const int64 num_blocks = arena->num_blocks();
+    arena->StepFinished();
+    arena->Unref();
+    return num_blocks;
+  };
+  Tensor first, second, third;
+  EXPECT_EQ(run_step(&first), 1);
+  EXPECT_EQ(run_step(&second), 1);
+  EXPECT_EQ(StepArenaAllocator::TotalEscapedBytes(), escaped_bytes + 512);
+  // The cap is reached, so the next step allocates from the underlying
+  // allocator.
+  EXPECT_EQ(run_step(&third), 0);
+  EXPECT_EQ(StepArenaAllocator::TotalEscapedBytes(), escaped_bytes + 512);
+
+  // Freeing an escaped tensor releases its block.
+  first = Tensor();
+  EXPECT_EQ(StepArenaAllocator::TotalEscapedBytes(), escaped_bytes + 256);
+  Tensor fourth;
+  EXPECT_EQ(run_step(&fourth), 1);
+  second = Tensor();
+  third = Tensor();
+  fourth = Tensor();
+  EXPECT_EQ(StepArenaAllocator::TotalEscapedBytes(), escaped_bytes);
+}
+
+TEST(StepArenaAllocatorTest, ConcurrentAllocations) {
+  StepArenaAllocator* arena = new StepArenaAllocator(cpu_allocator(), 4096);
+  constexpr int kNumThreads = 8;
+  constexpr int kNumAllocations = 1000;
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back(Env::Default()->StartThread(
+        ThreadOptions(), "step_arena_test", [arena, i]() {
+          std::vector<int64*> ptrs;
+          for (int j = 0; j < kNumAllocations; ++j) {
+            int64* ptr = static_cast<int64*>(
+                arena->AllocateRaw(Allocator::kAllocatorAlignment, 8));
+            *ptr = i * kNumAllocations + j;
+            ptrs.push_back(ptr);
+          }
+          for (int j = 0; j < kNumAllocations; ++j) {
+            EXPECT_EQ(*ptrs[j], i * kNumAllocations + j);
+            arena->DeallocateRaw(ptrs[j]);
+          }
+        }));
+  }
+  threads.clear();
+  arena->StepFinished();
+  EXPECT_EQ(arena->num_escaped_blocks(), 0);
+  arena->Unref();
+}
+
+}  // namespace
+}  // namespace tensorflow
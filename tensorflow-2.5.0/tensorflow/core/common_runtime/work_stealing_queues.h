@@ -0,0 +1,120 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_QUEUES_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_QUEUES_H_
+
+#include <atomic>
+#include <deque>
+#include <memory>
+
+#include "absl/types/optional.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A fixed set of work queues, one per worker, for work-stealing schedulers.
+//
+// A worker pushes and pops at the back of its own queue, so it runs the most
+// recently produced (and most likely cache-hot) items first. When its queue
+// is empty it steals the oldest item from the front of another queue.
+//
+// Workers are not tied to threads: any number of threads may use the same
+// queue index, which only affects locality, not correctness.
+template <typename T>
+class WorkStealingQueues {
+ public:
+  explicit WorkStealingQueues(int num_queues)
+      : num_queues_(num_queues), queues_(new Queue[num_queues]) {
+    DCHECK_GT(num_queues, 0);
+  }
+
+  WorkStealingQueues(const WorkStealingQueues&) = delete;
+  void operator=(const WorkStealingQueues&) = delete;
+
+  int num_queues() const { return num_queues_; }
+
+  // Returns a queue index for a new worker. Indices are handed out round
+  // robin so that concurrent workers tend to use different queues.
+  int AssignQueue() {
+    return next_queue_.fetch_add(1, std::memory_order_relaxed) % num_queues_;
+  }
+
+  // Adds `item` at the back of queue `index`.
+  void Push(int index, T item) {
+    Queue& queue = queues_[index];
+    mutex_lock l(queue.mu);
+    queue.items.push_back(std::move(item));
+    size_.fetch_add(1, std::memory_order_seq_cst);
+  }
+
+  // Removes an item from the back of queue `index` or, if that queue is
+  // empty, from the front of another queue. Returns nullopt if all queues
+  // were found empty.
+  absl::optional<T> PopOrSteal(int index) {
+    if (size_.load(std::memory_order_acquire) == 0) {
+      return absl::nullopt;
+    }
+    {
+      Queue& queue = queues_[index];
+      mutex_lock l(queue.mu);
+      if (!queue.items.empty()) {
+        absl::optional<T> item(std::move(queue.items.back()));
+        queue.items.pop_back();
+        size_.fetch_sub(1, std::memory_order_relaxed);
+        return item;
+      }
+    }
+    for (int i = 1; i < num_queues_; ++i) {
+      Queue& victim = queues_[(index + i) % num_queues_];
+      mutex_lock l(victim.mu);
+      if (!victim.items.empty()) {
+        absl::optional<T> item(std::move(victim.items.front()));
+        victim.items.pop_front();
+        size_.fetch_sub(1, std::memory_order_relaxed);
+        return item;
+      }
+    }
+    return absl::nullopt;
+  }
+
+  // Returns the number of queued items. The value may be stale by the time it
+  // is used unless all pushes and pops are externally synchronized.
+  //
+  // Push() and size() are sequentially consistent, so that a producer that
+  // pushes and then reads a worker count, and a worker that decrements that
+  // count and then calls size(), cannot both miss the other's update.
+  int64 size() const { return size_.load(std::memory_order_seq_cst); }
+
+ private:
+  // Each queue is padded to its own cache line so that workers operating on
+  // their own queues do not contend.
+  struct alignas(64) Queue {
+    mutex mu;
+    std::deque<T> items TF_GUARDED_BY(mu);
+  };
+
+  const int num_queues_;
+  std::unique_ptr<Queue[]> queues_;
+  std::atomic<uint32> next_queue_{0};
+  std::atomic<int64> size_{0};
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_QUEUES_H_
@@ -0,0 +1,99 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/work_stealing_queues.h"
+
+#include <atomic>
+#include <vector>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(WorkStealingQueuesTest, PopsOwnQueueInLifoOrder) {
+  WorkStealingQueues<int> queues(2);
+  queues.Push(0, 1);
+  queues.Push(0, 2);
+  queues.Push(0, 3);
+  EXPECT_EQ(3, queues.size());
+  EXPECT_EQ(3, *queues.PopOrSteal(0));
+  EXPECT_EQ(2, *queues.PopOrSteal(0));
+  EXPECT_EQ(1, *queues.PopOrSteal(0));
+  EXPECT_FALSE(queues.PopOrSteal(0).has_value());
+  EXPECT_EQ(0, queues.size());
+}
+
+TEST(WorkStealingQueuesTest, StealsOldestItemFromOtherQueues) {
+  WorkStealingQueues<int> queues(3);
+  queues.Push(1, 1);
+  queues.Push(1, 2);
+  queues.Push(2, 3);
+  // Queue 0 is empty, so it steals from the front of queue 1 first.
+  EXPECT_EQ(1, *queues.PopOrSteal(0));
+  EXPECT_EQ(2, *queues.PopOrSteal(0));
+  EXPECT_EQ(3, *queues.PopOrSteal(0));
+  EXPECT_FALSE(queues.PopOrSteal(0).has_value());
+}
+
+TEST(WorkStealingQueuesTest, AssignsQueuesRoundRobin) {
+  WorkStealingQueues<int> queues(3);
+  EXPECT_EQ(3, queues.num_queues());
+  EXPECT_EQ(0, queues.AssignQueue());
+  EXPECT_EQ(1, queues.AssignQueue());
+  EXPECT_EQ(2, queues.AssignQueue());
+  EXPECT_EQ(0, queues.AssignQueue());
+}
+
+TEST(WorkStealingQueuesTest, ConcurrentPushAndSteal) {
+  const int kNumThreads = 8;
+  const int kItemsPerThread = 10000;
+  WorkStealingQueues<int> queues(kNumThreads);
+  std::atomic<int64> sum{0};
+  std::atomic<int> num_popped{0};
+  {
+    thread::ThreadPool pool(Env::Default(), "test", kNumThreads);
+    for (int t = 0; t < kNumThreads; ++t) {
+      pool.Schedule([&queues, &sum, &num_popped]() {
+        const int index = queues.AssignQueue();
+        for (int i = 1; i <= kItemsPerThread; ++i) {
+          queues.Push(index, i);
+          if (i % 2 == 0) {
+            absl::optional<int> item = queues.PopOrSteal(index);
+            if (item) {
+              sum += *item;
+              ++num_popped;
+            }
+          }
+        }
+      });
+    }
+  }
+  absl::optional<int> item;
+  while ((item = queues.PopOrSteal(0))) {
+    sum += *item;
+    ++num_popped;
+  }
+  EXPECT_EQ(kNumThreads * kItemsPerThread, num_popped);
+  EXPECT_EQ(static_cast<int64>(kNumThreads) * kItemsPerThread *
+                (kItemsPerThread + 1) / 2,
+            sum);
+  EXPECT_EQ(0, queues.size());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -14,14 +14,126 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/compression_utils.h"
 
+#include <zlib.h>
+
+#include <limits>
+
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/platform/snappy.h"
 
 namespace tensorflow {
 namespace data {
+namespace {
+
+// zlib counts bytes in `uInt`s, so larger buffers are processed in chunks.
+constexpr size_t kMaxZlibChunk = std::numeric_limits<uInt>::max();
+
+Status ZlibCompress(const char* input, size_t length, int level,
+                    std::string* output) {
+  if (level < Z_DEFAULT_COMPRESSION || level > Z_BEST_COMPRESSION) {
+    return errors::InvalidArgument("Invalid zlib compression level: ", level);
+  }
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  if (deflateInit(&stream, level) != Z_OK) {
+    return errors::Internal("Failed to initialize zlib compression.");
+  }
+  auto cleanup = gtl::MakeCleanup([&stream] { deflateEnd(&stream); });
+  output->resize(deflateBound(&stream, length));
+  stream.next_out = reinterpret_cast<Bytef*>(&(*output)[0]);
+  size_t in_remaining = length;
+  size_t out_remaining = output->size();
+  int result = Z_OK;
+  while (result == Z_OK) {
+    if (stream.avail_in == 0 && in_remaining > 0) {
+      stream.next_in = reinterpret_cast<Bytef*>(
+          const_cast<char*>(input + length - in_remaining));
+      stream.avail_in = std::min(in_remaining, kMaxZlibChunk);
+      in_remaining -= stream.avail_in;
+    }
+    if (stream.avail_out == 0) {
+      stream.avail_out = std::min(out_remaining, kMaxZlibChunk);
+      out_remaining -= stream.avail_out;
+    }
+    result = deflate(&stream, in_remaining > 0 ? Z_NO_FLUSH : Z_FINISH);
+  }
+  if (result != Z_STREAM_END) {
+    return errors::Internal("Failed to compress using zlib: ", result);
+  }
+  output->resize(stream.total_out);
+  return Status::OK();
+}
+
+Status ZlibUncompressToIOVec(const std::string& compressed,
+                             const struct iovec* iov, size_t iov_cnt) {
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  if (inflateInit(&stream) != Z_OK) {
+    return errors::Internal("Failed to initialize zlib decompression.");
+  }
+  auto cleanup = gtl::MakeCleanup([&stream] { inflateEnd(&stream); });
+  size_t in_remaining = compressed.size();
+  auto feed_input = [&]() {
+    if (stream.avail_in == 0 && in_remaining > 0) {
+      stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(
+          compressed.data() + compressed.size() - in_remaining));
+      stream.avail_in = std::min(in_remaining, kMaxZlibChunk);
+      in_remaining -= stream.avail_in;
+    }
+  };
+  bool stream_end = false;
+  for (size_t i = 0; i < iov_cnt; ++i) {
+    char* out = static_cast<char*>(iov[i].iov_base);
+    size_t out_remaining = iov[i].iov_len;
+    while (out_remaining > 0) {
+      if (stream_end) {
+        return errors::Internal(
+            "Zlib data is shorter than the tensor metadata suggests.");
+      }
+      feed_input();
+      stream.next_out = reinterpret_cast<Bytef*>(out);
+      stream.avail_out = std::min(out_remaining, kMaxZlibChunk);
+      size_t chunk = stream.avail_out;
+      int result = inflate(&stream, Z_NO_FLUSH);
+      if (result == Z_STREAM_END) {
+        stream_end = true;
+      } else if (result != Z_OK) {
+        return errors::Internal("Failed to perform zlib decompression: ",
+                                result);
+      }
+      size_t produced = chunk - stream.avail_out;
+      out += produced;
+      out_remaining -= produced;
+    }
+  }
+  if (!stream_end) {
+    // All components are filled; the stream must now end without producing
+    // any more bytes.
+    char unused;
+    feed_input();
+    stream.next_out = reinterpret_cast<Bytef*>(&unused);
+    stream.avail_out = 1;
+    if (inflate(&stream, Z_NO_FLUSH) != Z_STREAM_END ||
+        stream.avail_out != 1) {
+      return errors::Internal(
+          "Zlib data is longer than the tensor metadata suggests.");
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+Status CompressElement(const std::vector<Tensor>& element,
+                       CompressedElement* out) {
+  return CompressElement(element, CompressedElement::SNAPPY, /*level=*/-1,
+                         out);
+}
 
 Status CompressElement(const std::vector<Tensor>& element,
+                       CompressedElement::Codec codec, int level,
                        CompressedElement* out) {
   // Step 1: Determine the total uncompressed size. This requires serializing
   // non-memcopyable tensors, which we save to use again later.
@@ -40,11 +152,19 @@ Status CompressElement(const std::vector<Tensor>& element,
   }
 
   // Step 2: Write the tensor data to a buffer, and compress that buffer.
-  // We use tstring for access to resize_uninitialized.
+  // We use tstring for access to resize_uninitialized. Uncompressed elements
+  // are written straight into the output proto.
   tstring uncompressed;
-  uncompressed.resize_uninitialized(total_size);
-  // Position in `uncompressed` to write the next component.
-  char* position = uncompressed.mdata();
+  char* start;
+  if (codec == CompressedElement::NONE) {
+    out->mutable_data()->resize(total_size);
+    start = &(*out->mutable_data())[0];
+  } else {
+    uncompressed.resize_uninitialized(total_size);
+    start = uncompressed.mdata();
+  }
+  // Position in `start` to write the next component.
+  char* position = start;
   int non_memcpy_component_index = 0;
   for (auto& component : element) {
     CompressedComponentMetadata* metadata =
@@ -62,12 +182,25 @@ Status CompressElement(const std::vector<Tensor>& element,
     }
     position += metadata->tensor_size_bytes();
   }
-  DCHECK_EQ(position, uncompressed.mdata() + total_size);
+  DCHECK_EQ(position, start + total_size);
 
-  if (!port::Snappy_Compress(uncompressed.mdata(), total_size,
-                             out->mutable_data())) {
-    return errors::Internal("Failed to compress using snappy.");
+  switch (codec) {
+    case CompressedElement::SNAPPY:
+      if (!port::Snappy_Compress(start, total_size, out->mutable_data())) {
+        return errors::Internal("Failed to compress using snappy.");
+      }
+      break;
+    case CompressedElement::ZLIB:
+      TF_RETURN_IF_ERROR(
+          ZlibCompress(start, total_size, level, out->mutable_data()));
+      break;
+    case CompressedElement::NONE:
+      break;
+    default:
+      return errors::InvalidArgument("Unsupported compression codec: ",
+                                     codec);
   }
+  out->set_codec(codec);
   VLOG(3) << "Compressed element from " << total_size << " bytes to "
           << out->data().size() << " bytes";
   return Status::OK();
@@ -111,22 +244,49 @@ Status UncompressElement(const CompressedElement& compressed,
 
   // Step 2: Uncompress into the iovec.
   const std::string& compressed_data = compressed.data();
-  size_t uncompressed_size;
-  if (!port::Snappy_GetUncompressedLength(
-          compressed_data.data(), compressed_data.size(), &uncompressed_size)) {
-    return errors::Internal(
-        "Could not get snappy uncompressed length. Compressed data size: ",
-        compressed_data.size());
-  }
-  if (uncompressed_size != static_cast<size_t>(total_size)) {
-    return errors::Internal(
-        "Uncompressed size mismatch. Snappy expects ", uncompressed_size,
-        " whereas the tensor metadata suggests ", total_size);
-  }
-  if (!port::Snappy_UncompressToIOVec(compressed_data.data(),
-                                      compressed_data.size(), iov.data(),
-                                      num_components)) {
-    return errors::Internal("Failed to perform snappy decompression.");
+  switch (compressed.codec()) {
+    case CompressedElement::SNAPPY: {
+      size_t uncompressed_size;
+      if (!port::Snappy_GetUncompressedLength(compressed_data.data(),
+                                              compressed_data.size(),
+                                              &uncompressed_size)) {
+        return errors::Internal(
+            "Could not get snappy uncompressed length. Compressed data size: ",
+            compressed_data.size());
+      }
+      if (uncompressed_size != static_cast<size_t>(total_size)) {
+        return errors::Internal(
+            "Uncompressed size mismatch. Snappy expects ", uncompressed_size,
+            " whereas the tensor metadata suggests ", total_size);
+      }
+      if (!port::Snappy_UncompressToIOVec(compressed_data.data(),
+                                          compressed_data.size(), iov.data(),
+                                          num_components)) {
+        return errors::Internal("Failed to perform snappy decompression.");
+      }
+      break;
+    }
+    case CompressedElement::ZLIB:
+      TF_RETURN_IF_ERROR(
+          ZlibUncompressToIOVec(compressed_data, iov.data(), num_components));
+      break;
+    case CompressedElement::NONE: {
+      if (compressed_data.size() != static_cast<size_t>(total_size)) {
+        return errors::Internal(
+            "Uncompressed size mismatch. The element holds ",
+            compressed_data.size(),
+            " bytes whereas the tensor metadata suggests ", total_size);
+      }
+      const char* position = compressed_data.data();
+      for (int i = 0; i < num_components; ++i) {
+        memcpy(iov[i].iov_base, position, iov[i].iov_len);
+        position += iov[i].iov_len;
+      }
+      break;
+    }
+    default:
+      return errors::InvalidArgument("Unsupported compression codec: ",
+                                     compressed.codec());
   }
 
   // Step 3: Deserialize tensor proto strings to tensors.
@@ -29,7 +29,15 @@ namespace data {
 Status CompressElement(const std::vector<Tensor>& element,
                        CompressedElement* out);
 
-// Uncompresses a `CompressedElement` into a vector of tensor components.
+// Like `CompressElement` above, but compresses with `codec` instead of snappy.
+// `level` is the zlib compression level (-1 for the zlib default, or 0-9), and
+// is ignored by the other codecs.
+Status CompressElement(const std::vector<Tensor>& element,
+                       CompressedElement::Codec codec, int level,
+                       CompressedElement* out);
+
+// Uncompresses a `CompressedElement` into a vector of tensor components, using
+// the codec recorded in `compressed`.
 Status UncompressElement(const CompressedElement& compressed,
                          std::vector<Tensor>* out);
 
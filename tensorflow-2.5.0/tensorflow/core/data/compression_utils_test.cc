@@ -49,5 +49,51 @@ std::vector<std::vector<Tensor>> TestCases() {
 INSTANTIATE_TEST_SUITE_P(Instantiation, ParameterizedCompressionUtilsTest,
                          ::testing::ValuesIn(TestCases()));
 
+class ParameterizedCodecTest
+    : public DatasetOpsTestBase,
+      public ::testing::WithParamInterface<
+          std::tuple<CompressedElement::Codec, std::vector<Tensor>>> {};
+
+TEST_P(ParameterizedCodecTest, RoundTrip) {
+  CompressedElement::Codec codec = std::get<0>(GetParam());
+  std::vector<Tensor> element = std::get<1>(GetParam());
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(element, codec, /*level=*/-1, &compressed));
+  EXPECT_EQ(compressed.codec(), codec);
+  std::vector<Tensor> round_trip_element;
+  TF_ASSERT_OK(UncompressElement(compressed, &round_trip_element));
+  TF_EXPECT_OK(
+      ExpectEqual(element, round_trip_element, /*compare_order=*/true));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Instantiation, ParameterizedCodecTest,
+    ::testing::Combine(::testing::Values(CompressedElement::SNAPPY,
+                                         CompressedElement::ZLIB,
+                                         CompressedElement::NONE),
+                       ::testing::ValuesIn(TestCases())));
+
+TEST(CompressionUtilsTest, InvalidZlibLevel) {
+  CompressedElement compressed;
+  Status s = CompressElement({CreateTensor<int64>(TensorShape{1}, {1})},
+                             CompressedElement::ZLIB, /*level=*/10,
+                             &compressed);
+  EXPECT_EQ(s.code(), error::INVALID_ARGUMENT);
+}
+
+TEST(CompressionUtilsTest, ZlibSizeMismatch) {
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(
+      {CreateTensor<int64>(TensorShape{2}, {1, 2})}, CompressedElement::ZLIB,
+      /*level=*/9, &compressed));
+  compressed.mutable_component_metadata(0)
+      ->mutable_tensor_shape()
+      ->mutable_dim(0)
+      ->set_size(3);
+  std::vector<Tensor> round_trip_element;
+  EXPECT_EQ(UncompressElement(compressed, &round_trip_element).code(),
+            error::INTERNAL);
+}
+
 }  // namespace data
 }  // namespace tensorflow
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include "grpcpp/create_channel.h"
 #include "grpcpp/security/credentials.h"
+#include "absl/strings/str_split.h"
 #include "absl/types/optional.h"
 #include "tensorflow/core/data/service/credentials_factory.h"
 #include "tensorflow/core/data/service/data_transfer.h"
@@ -59,14 +60,27 @@ std::string ProcessingModeToString(ProcessingMode mode) {
   }
 }
 
+int64 SharedLocalityLevels(absl::string_view a, absl::string_view b) {
+  std::vector<absl::string_view> a_levels = absl::StrSplit(a, '/');
+  std::vector<absl::string_view> b_levels = absl::StrSplit(b, '/');
+  int64 shared = 0;
+  while (shared < a_levels.size() && shared < b_levels.size() &&
+         !a_levels[shared].empty() && a_levels[shared] == b_levels[shared]) {
+    ++shared;
+  }
+  return shared;
+}
+
 Status DataServiceDispatcherClient::WorkerHeartbeat(
     const std::string& worker_address, const std::string& transfer_address,
+    const std::string& worker_locality,
     const std::vector<int64>& current_tasks, std::vector<TaskDef>& new_tasks,
     std::vector<int64>& tasks_to_delete) {
   TF_RETURN_IF_ERROR(EnsureInitialized());
   WorkerHeartbeatRequest req;
   req.set_worker_address(worker_address);
   req.set_transfer_address(transfer_address);
+  req.set_worker_locality(worker_locality);
   for (int64 task : current_tasks) {
     req.add_current_tasks(task);
   }
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "grpcpp/impl/codegen/client_context.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/data/service/data_transfer.h"
 #include "tensorflow/core/data/service/dispatcher.grpc.pb.h"
 #include "tensorflow/core/data/service/worker.grpc.pb.h"
@@ -49,6 +50,11 @@ Status ParseProcessingMode(const std::string& s, ProcessingMode& mode);
 // Converts a processing mode to its corresponding string.
 std::string ProcessingModeToString(ProcessingMode mode);
 
+// Returns the number of leading topology levels shared by two localities, e.g.
+// 2 for "zone-a/rack-3/host-7" and "zone-a/rack-3/host-8". Empty levels never
+// match, so an empty locality shares no level with any other.
+int64 SharedLocalityLevels(absl::string_view a, absl::string_view b);
+
 // Base class for data service clients. Data service clients are
 // threadsafe.
 class DataServiceClientBase {
@@ -89,6 +95,7 @@ class DataServiceDispatcherClient : public DataServiceClientBase {
   // `tasks_to_delete`.
   Status WorkerHeartbeat(const std::string& worker_address,
                          const std::string& transfer_address,
+                         const std::string& worker_locality,
                          const std::vector<int64>& current_tasks,
                          std::vector<TaskDef>& new_tasks,
                          std::vector<int64>& tasks_to_delete);
@@ -57,6 +57,17 @@ TEST(DataService, ParseInvalidProcessingMode) {
   EXPECT_EQ(s.code(), error::Code::INVALID_ARGUMENT);
 }
 
+TEST(DataService, SharedLocalityLevels) {
+  EXPECT_EQ(
+      SharedLocalityLevels("zone-a/rack-3/host-7", "zone-a/rack-3/host-7"), 3);
+  EXPECT_EQ(
+      SharedLocalityLevels("zone-a/rack-3/host-7", "zone-a/rack-3/host-8"), 2);
+  EXPECT_EQ(SharedLocalityLevels("zone-a/rack-3/host-7", "zone-a/rack-4"), 1);
+  EXPECT_EQ(SharedLocalityLevels("zone-a/rack-3", "zone-b/rack-3"), 0);
+  EXPECT_EQ(SharedLocalityLevels("", ""), 0);
+  EXPECT_EQ(SharedLocalityLevels("zone-a", ""), 0);
+}
+
 TEST(DataService, ProcessingModeToString) {
   EXPECT_EQ("parallel_epochs",
             ProcessingModeToString(ProcessingMode::PARALLEL_EPOCHS));
@@ -277,6 +277,7 @@ Status DataServiceDispatcherImpl::WorkerHeartbeat(
           << request->worker_address();
   mutex_lock l(mu_);
   const std::string& worker_address = request->worker_address();
+  worker_localities_[worker_address] = request->worker_locality();
   // Assigned tasks from the perspective of the dispatcher.
   std::vector<std::shared_ptr<const Task>> assigned_tasks;
   Status s = state_.TasksForWorker(worker_address, assigned_tasks);
@@ -847,6 +848,10 @@ Status DataServiceDispatcherImpl::ClientHeartbeat(
     task_info->set_task_id(task->task_id);
     task_info->set_job_id(job->job_id);
     task_info->set_starting_round(task->starting_round);
+    auto locality = worker_localities_.find(task->worker_address);
+    if (locality != worker_localities_.end()) {
+      task_info->set_worker_locality(locality->second);
+    }
   }
   response->set_job_finished(job->finished);
   VLOG(4) << "Found " << response->task_info_size()
@@ -282,6 +282,11 @@ class DataServiceDispatcherImpl {
   // Mapping from round robin job id to the round the job is currently on. This
   // is based on the data provided by client heartbeats, and may be stale.
   absl::flat_hash_map<int64, int64> round_robin_rounds_ TF_GUARDED_BY(mu_);
+  // Topology labels reported by workers in their heartbeats, keyed by worker
+  // address. They are not journaled; workers report them again after a
+  // dispatcher restart.
+  absl::flat_hash_map<std::string, std::string> worker_localities_
+      TF_GUARDED_BY(mu_);
   // Map from task id to a TaskRemover which determines when to remove the task.
   absl::flat_hash_map<int64, std::shared_ptr<TaskRemover>> remove_task_requests_
       TF_GUARDED_BY(mu_);
@@ -0,0 +1,205 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/element_cache.h"
+
+#include <string>
+#include <unordered_map>
+
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/str_util.h"
+
+namespace tensorflow {
+namespace data {
+
+namespace {
+int64 ElementBytes(const std::vector<Tensor>& element) {
+  int64 bytes = 0;
+  for (const Tensor& component : element) {
+    bytes += component.TotalBytes();
+  }
+  return bytes;
+}
+
+using NodeMap = std::unordered_map<std::string, const NodeDef*>;
+
+// Dataset ops which take a `seed` and a `seed2` input, mapped to the index of
+// the `seed` input. When both seeds are zero, the op picks random seeds.
+const std::unordered_map<std::string, int>& SeededDatasetOps() {
+  static const auto* ops = new std::unordered_map<std::string, int>(
+      {{"ShuffleDataset", 2},
+       {"ShuffleDatasetV3", 2},
+       {"ShuffleAndRepeatDataset", 2},
+       {"ShuffleAndRepeatDatasetV2", 2},
+       {"SamplingDataset", 2},
+       {"RandomDataset", 0},
+       {"ExperimentalRandomDataset", 0}});
+  return *ops;
+}
+
+// Gets the value of the scalar int64 constant produced by the node which
+// `input` refers to, in either graph or function body format.
+bool GetConstantInput(const std::string& input, const NodeMap& nodes,
+                      int64& value) {
+  auto it = nodes.find(input.substr(0, input.find(':')));
+  if (it == nodes.end() || it->second->op() != "Const") return false;
+  auto attr = it->second->attr().find("value");
+  if (attr == it->second->attr().end()) return false;
+  Tensor tensor;
+  if (!tensor.FromProto(attr->second.tensor()) || tensor.dtype() != DT_INT64 ||
+      tensor.NumElements() != 1) {
+    return false;
+  }
+  value = tensor.flat<int64>()(0);
+  return true;
+}
+
+bool IsRepeatableNode(const NodeDef& node, const NodeMap& nodes) {
+  // Reshuffles with a seed generator shared by all iterations.
+  if (node.op() == "ShuffleDatasetV2") return false;
+  auto seeded_op = SeededDatasetOps().find(node.op());
+  if (seeded_op != SeededDatasetOps().end()) {
+    const int index = seeded_op->second;
+    int64 seed, seed2;
+    if (node.input_size() < index + 2 ||
+        !GetConstantInput(node.input(index), nodes, seed) ||
+        !GetConstantInput(node.input(index + 1), nodes, seed2) ||
+        (seed == 0 && seed2 == 0)) {
+      return false;
+    }
+  }
+  const auto& attrs = node.attr();
+  auto deterministic = attrs.find("deterministic");
+  if (deterministic != attrs.end() && deterministic->second.s() == "false") {
+    return false;
+  }
+  auto sloppy = attrs.find("sloppy");
+  if (sloppy != attrs.end() && sloppy->second.b()) return false;
+  // Random ops such as RandomUniform pick random seeds when both are zero.
+  auto seed = attrs.find("seed");
+  auto seed2 = attrs.find("seed2");
+  if (seed != attrs.end() && seed2 != attrs.end() && seed->second.i() == 0 &&
+      seed2->second.i() == 0 && !str_util::StartsWith(node.op(), "Stateless")) {
+    return false;
+  }
+  return true;
+}
+
+bool AreRepeatableNodes(const protobuf::RepeatedPtrField<NodeDef>& node_defs) {
+  NodeMap nodes;
+  for (const NodeDef& node : node_defs) {
+    nodes[node.name()] = &node;
+  }
+  for (const NodeDef& node : node_defs) {
+    if (!IsRepeatableNode(node, nodes)) {
+      VLOG(3) << "Dataset node " << node.name() << " (" << node.op()
+              << ") may produce different elements in each iteration";
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace
+
+bool IsRepeatableDataset(const GraphDef& graph) {
+  if (!AreRepeatableNodes(graph.node())) return false;
+  for (const FunctionDef& function : graph.library().function()) {
+    if (!AreRepeatableNodes(function.node_def())) return false;
+  }
+  return true;
+}
+
+SharedElementCache::SharedElementCache(std::unique_ptr<TaskIterator> iterator,
+                                       int64 max_bytes)
+    : max_bytes_(max_bytes),
+      cardinality_(iterator->Cardinality()),
+      iterator_(std::move(iterator)) {}
+
+Status SharedElementCache::Get(int64 index, std::vector<Tensor>& element,
+                               bool& end_of_sequence, bool& evicted) {
+  mutex_lock l(mu_);
+  TF_RETURN_IF_ERROR(status_);
+  end_of_sequence = false;
+  evicted = index < window_start_;
+  if (evicted) {
+    return Status::OK();
+  }
+  while (index >= window_start_ + static_cast<int64>(window_.size())) {
+    if (end_of_sequence_) {
+      end_of_sequence = true;
+      return Status::OK();
+    }
+    std::vector<Tensor> next;
+    bool next_end_of_sequence = false;
+    status_ = iterator_->GetNext(next, next_end_of_sequence);
+    TF_RETURN_IF_ERROR(status_);
+    if (next_end_of_sequence) {
+      end_of_sequence_ = true;
+      continue;
+    }
+    window_bytes_ += ElementBytes(next);
+    window_.push_back(std::move(next));
+    while (window_bytes_ > max_bytes_ && window_.size() > 1) {
+      window_bytes_ -= ElementBytes(window_.front());
+      window_.pop_front();
+      ++window_start_;
+    }
+  }
+  // Copying the tensors only copies references to their buffers.
+  element = window_[index - window_start_];
+  return Status::OK();
+}
+
+CachingTaskIterator::CachingTaskIterator(
+    std::shared_ptr<SharedElementCache> cache, IteratorFactory make_iterator)
+    : cache_(std::move(cache)), make_iterator_(std::move(make_iterator)) {}
+
+Status CachingTaskIterator::GetNext(std::vector<Tensor>& element,
+                                    bool& end_of_sequence) {
+  if (!private_iterator_) {
+    bool evicted = false;
+    TF_RETURN_IF_ERROR(cache_->Get(index_, element, end_of_sequence, evicted));
+    if (!evicted) {
+      if (!end_of_sequence) {
+        ++index_;
+      }
+      return Status::OK();
+    }
+    VLOG(2) << "Element " << index_
+            << " was evicted from the shared element cache. Falling back to a "
+               "private iterator.";
+    TF_RETURN_IF_ERROR(make_iterator_(private_iterator_));
+    for (int64 i = 0; i < index_; ++i) {
+      std::vector<Tensor> skipped;
+      TF_RETURN_IF_ERROR(private_iterator_->GetNext(skipped, end_of_sequence));
+      if (end_of_sequence) {
+        return errors::FailedPrecondition(
+            "Dataset ended after ", i, " elements while skipping ", index_,
+            " elements already read from the shared element cache. The "
+            "dataset must be deterministic to use the element cache.");
+      }
+    }
+  }
+  return private_iterator_->GetNext(element, end_of_sequence);
+}
+
+int64 CachingTaskIterator::Cardinality() const {
+  return cache_->Cardinality();
+}
+
+}  // namespace data
+}  // namespace tensorflow
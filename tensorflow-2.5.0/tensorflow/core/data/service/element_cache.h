@@ -0,0 +1,106 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_ELEMENT_CACHE_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_ELEMENT_CACHE_H_
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/data/service/task_runner.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace data {
+
+// Returns whether the dataset defined by `graph` produces the same elements in
+// the same order every time it is iterated, as `SharedElementCache` requires.
+//
+// The check is conservative: datasets which shuffle or sample without a
+// constant seed, which allow non-deterministic ordering, or whose functions
+// call random ops without a seed are not considered repeatable.
+bool IsRepeatableDataset(const GraphDef& graph);
+
+// A sliding window over the elements produced by a single iterator, shared by
+// all tasks on a worker that read the same dataset in PARALLEL_EPOCHS mode.
+//
+// Elements are identified by their index in the iterator's output. The window
+// holds the most recently produced elements, up to `max_bytes` bytes (but at
+// least one element). Reading past the end of the window advances the shared
+// iterator; the oldest elements are evicted once the window is full.
+//
+// Sharing elements is only meaningful for datasets which produce the same
+// elements in the same order every time they are iterated.
+class SharedElementCache {
+ public:
+  SharedElementCache(std::unique_ptr<TaskIterator> iterator, int64 max_bytes);
+
+  // Gets the element at `index`. If `index` is past the end of the dataset,
+  // sets `end_of_sequence` to `true`. If the element was already evicted from
+  // the window, sets `evicted` to `true` and leaves `element` untouched.
+  Status Get(int64 index, std::vector<Tensor>& element, bool& end_of_sequence,
+             bool& evicted);
+  // Reports the cardinality of the dataset that created the shared iterator.
+  int64 Cardinality() const { return cardinality_; }
+
+ private:
+  const int64 max_bytes_;
+  const int64 cardinality_;
+  mutex mu_;
+  // The shared iterator. It is advanced while holding `mu_`, so concurrent
+  // readers never compute the same element twice.
+  std::unique_ptr<TaskIterator> iterator_ TF_GUARDED_BY(mu_);
+  // Elements in [window_start_, window_start_ + window_.size()).
+  std::deque<std::vector<Tensor>> window_ TF_GUARDED_BY(mu_);
+  int64 window_start_ TF_GUARDED_BY(mu_) = 0;
+  int64 window_bytes_ TF_GUARDED_BY(mu_) = 0;
+  bool end_of_sequence_ TF_GUARDED_BY(mu_) = false;
+  // The first error returned by the shared iterator, if any.
+  Status status_ TF_GUARDED_BY(mu_);
+};
+
+// A task iterator which reads its elements from a `SharedElementCache`.
+//
+// If the iterator falls behind the cache window, it switches to a private
+// iterator made by `make_iterator`, skipping the elements it has already
+// produced, and reads from that iterator from then on.
+class CachingTaskIterator : public TaskIterator {
+ public:
+  using IteratorFactory =
+      std::function<Status(std::unique_ptr<TaskIterator>& out)>;
+
+  CachingTaskIterator(std::shared_ptr<SharedElementCache> cache,
+                      IteratorFactory make_iterator);
+  Status GetNext(std::vector<Tensor>& element, bool& end_of_sequence) override;
+  int64 Cardinality() const override;
+
+ private:
+  const std::shared_ptr<SharedElementCache> cache_;
+  const IteratorFactory make_iterator_;
+  // Index of the next element to read.
+  int64 index_ = 0;
+  // Set once the iterator has fallen behind the cache window.
+  std::unique_ptr<TaskIterator> private_iterator_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_ELEMENT_CACHE_H_
@@ -0,0 +1,216 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/element_cache.h"
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Produces the elements 0, 1, ..., `num_elements - 1`, counting how many
+// elements were computed in `*num_computed`.
+class RangeTaskIterator : public TaskIterator {
+ public:
+  RangeTaskIterator(int64 num_elements, int64* num_computed)
+      : num_elements_(num_elements), num_computed_(num_computed) {}
+
+  Status GetNext(std::vector<Tensor>& element, bool& end_of_sequence) override {
+    end_of_sequence = index_ >= num_elements_;
+    if (!end_of_sequence) {
+      element = {Tensor(index_++)};
+      ++*num_computed_;
+    }
+    return Status::OK();
+  }
+
+  int64 Cardinality() const override { return num_elements_; }
+
+ private:
+  const int64 num_elements_;
+  int64* const num_computed_;
+  int64 index_ = 0;
+};
+
+std::unique_ptr<CachingTaskIterator> MakeCachingIterator(
+    std::shared_ptr<SharedElementCache> cache, int64 num_elements,
+    int64* num_computed) {
+  return absl::make_unique<CachingTaskIterator>(
+      std::move(cache), [=](std::unique_ptr<TaskIterator>& out) {
+        out = absl::make_unique<RangeTaskIterator>(num_elements, num_computed);
+        return Status::OK();
+      });
+}
+
+// Reads `n` elements from `iterator`, appending them to `output`.
+Status Read(TaskIterator& iterator, int64 n, std::vector<int64>& output) {
+  for (int64 i = 0; i < n; ++i) {
+    std::vector<Tensor> element;
+    bool end_of_sequence = false;
+    TF_RETURN_IF_ERROR(iterator.GetNext(element, end_of_sequence));
+    if (end_of_sequence) {
+      break;
+    }
+    output.push_back(element[0].scalar<int64>()());
+  }
+  return Status::OK();
+}
+
+std::vector<int64> Range(int64 start, int64 end) {
+  std::vector<int64> result;
+  for (int64 i = start; i < end; ++i) {
+    result.push_back(i);
+  }
+  return result;
+}
+
+TEST(ElementCacheTest, ReadersShareElements) {
+  const int64 num_elements = 10;
+  int64 num_computed = 0;
+  auto cache = std::make_shared<SharedElementCache>(
+      absl::make_unique<RangeTaskIterator>(num_elements, &num_computed),
+      /*max_bytes=*/1 << 20);
+  auto first = MakeCachingIterator(cache, num_elements, &num_computed);
+  auto second = MakeCachingIterator(cache, num_elements, &num_computed);
+  EXPECT_EQ(first->Cardinality(), num_elements);
+
+  std::vector<int64> first_output, second_output;
+  TF_ASSERT_OK(Read(*first, 4, first_output));
+  TF_ASSERT_OK(Read(*second, num_elements + 1, second_output));
+  TF_ASSERT_OK(Read(*first, num_elements + 1, first_output));
+  EXPECT_EQ(first_output, Range(0, num_elements));
+  EXPECT_EQ(second_output, Range(0, num_elements));
+  EXPECT_EQ(num_computed, num_elements);
+}
+
+TEST(ElementCacheTest, EvictedReaderFallsBack) {
+  const int64 num_elements = 10;
+  int64 num_computed = 0;
+  // Each element is a single int64, so the window holds two elements.
+  auto cache = std::make_shared<SharedElementCache>(
+      absl::make_unique<RangeTaskIterator>(num_elements, &num_computed),
+      /*max_bytes=*/2 * sizeof(int64));
+  auto fast = MakeCachingIterator(cache, num_elements, &num_computed);
+  auto slow = MakeCachingIterator(cache, num_elements, &num_computed);
+
+  std::vector<int64> fast_output, slow_output;
+  TF_ASSERT_OK(Read(*slow, 1, slow_output));
+  TF_ASSERT_OK(Read(*fast, 6, fast_output));
+  EXPECT_EQ(fast_output, Range(0, 6));
+  EXPECT_EQ(num_computed, 6);
+  // The slow reader needs element 1, which is no longer in the window.
+  TF_ASSERT_OK(Read(*slow, num_elements + 1, slow_output));
+  EXPECT_EQ(slow_output, Range(0, num_elements));
+  EXPECT_EQ(num_computed, 6 + num_elements);
+}
+
+TEST(ElementCacheTest, LateReaderReadsWindow) {
+  const int64 num_elements = 10;
+  int64 num_computed = 0;
+  auto cache = std::make_shared<SharedElementCache>(
+      absl::make_unique<RangeTaskIterator>(num_elements, &num_computed),
+      /*max_bytes=*/1 << 20);
+  auto first = MakeCachingIterator(cache, num_elements, &num_computed);
+  std::vector<int64> first_output;
+  TF_ASSERT_OK(Read(*first, num_elements + 1, first_output));
+
+  // A reader created after the first one finished reads from the window.
+  auto late = MakeCachingIterator(cache, num_elements, &num_computed);
+  std::vector<int64> late_output;
+  TF_ASSERT_OK(Read(*late, num_elements + 1, late_output));
+  EXPECT_EQ(late_output, Range(0, num_elements));
+  EXPECT_EQ(num_computed, num_elements);
+}
+
+GraphDef ParseGraph(const string& text) {
+  GraphDef graph;
+  CHECK(protobuf::TextFormat::ParseFromString(text, &graph));
+  return graph;
+}
+
+// A scalar int64 constant node.
+string ConstNode(const string& name, int64 value) {
+  return strings::StrCat(
+      "node { name: '", name, "' op: 'Const' attr { key: 'value' value { ",
+      "tensor { dtype: DT_INT64 tensor_shape {} int64_val: ", value,
+      " } } } }");
+}
+
+// A graph which shuffles the range [0, 10) with the given seeds.
+GraphDef ShuffleGraph(int64 seed, int64 seed2) {
+  return ParseGraph(strings::StrCat(
+      ConstNode("stop", 10), ConstNode("step", 1), ConstNode("seed", seed),
+      ConstNode("seed2", seed2), R"pb(
+        node {
+          name: "range"
+          op: "RangeDataset"
+          input: "step"
+          input: "stop"
+          input: "step"
+        }
+        node {
+          name: "shuffle"
+          op: "ShuffleDataset"
+          input: "range"
+          input: "stop"
+          input: "seed"
+          input: "seed2"
+        }
+      )pb"));
+}
+
+TEST(IsRepeatableDatasetTest, Shuffle) {
+  EXPECT_TRUE(IsRepeatableDataset(ShuffleGraph(/*seed=*/42, /*seed2=*/0)));
+  EXPECT_TRUE(IsRepeatableDataset(ShuffleGraph(/*seed=*/0, /*seed2=*/7)));
+  // Without seeds, every iteration shuffles differently.
+  EXPECT_FALSE(IsRepeatableDataset(ShuffleGraph(/*seed=*/0, /*seed2=*/0)));
+}
+
+TEST(IsRepeatableDatasetTest, NonDeterministicParallelMap) {
+  EXPECT_TRUE(IsRepeatableDataset(ParseGraph(R"pb(
+    node { name: "map" op: "ParallelMapDatasetV2"
+           attr { key: "deterministic" value { s: "default" } } }
+  )pb")));
+  EXPECT_FALSE(IsRepeatableDataset(ParseGraph(R"pb(
+    node { name: "map" op: "ParallelMapDatasetV2"
+           attr { key: "deterministic" value { s: "false" } } }
+  )pb")));
+}
+
+TEST(IsRepeatableDatasetTest, UnseededRandomOpInFunction) {
+  EXPECT_FALSE(IsRepeatableDataset(ParseGraph(R"pb(
+    library { function { signature { name: "f" }
+      node_def { name: "uniform" op: "RandomUniform"
+                 attr { key: "seed" value { i: 0 } }
+                 attr { key: "seed2" value { i: 0 } } } } }
+  )pb")));
+  EXPECT_TRUE(IsRepeatableDataset(ParseGraph(R"pb(
+    library { function { signature { name: "f" }
+      node_def { name: "uniform" op: "RandomUniform"
+                 attr { key: "seed" value { i: 1 } }
+                 attr { key: "seed2" value { i: 0 } } } } }
+  )pb")));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
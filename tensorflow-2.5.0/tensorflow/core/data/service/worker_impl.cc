@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/data_transfer.h"
 #include "tensorflow/core/data/service/dispatcher.grpc.pb.h"
 #include "tensorflow/core/data/service/dispatcher.pb.h"
+#include "tensorflow/core/data/service/element_cache.h"
 #include "tensorflow/core/data/service/grpc_util.h"
 #include "tensorflow/core/data/service/split_provider.h"
 #include "tensorflow/core/data/service/task_runner.h"
@@ -72,6 +73,19 @@ Status MoveElementToResponse(std::vector<Tensor>&& element,
   *resp.mutable_compressed() = *compressed;
   return Status::OK();
 }
+
+// Creates an iterator over all elements of the dataset defined by `graph`.
+Status MakeStandaloneTaskIterator(const GraphDef& graph,
+                                  std::unique_ptr<TaskIterator>& out) {
+  standalone::Dataset::Params params;
+  std::unique_ptr<standalone::Dataset> dataset;
+  TF_RETURN_IF_ERROR(standalone::Dataset::FromGraph(params, graph, &dataset));
+  std::unique_ptr<standalone::Iterator> iterator;
+  TF_RETURN_IF_ERROR(dataset->MakeIterator(&iterator));
+  out = absl::make_unique<StandaloneTaskIterator>(std::move(dataset),
+                                                  std::move(iterator));
+  return Status::OK();
+}
 }  // namespace
 
 DataServiceWorkerImpl::DataServiceWorkerImpl(
@@ -207,50 +221,60 @@ Status DataServiceWorkerImpl::EnsureTaskInitialized(
   if (task.initialized) {
     return Status::OK();
   }
-  standalone::Dataset::Params params;
-  std::unique_ptr<standalone::Dataset> dataset;
-  std::unique_ptr<standalone::Iterator> iterator;
-
+  DatasetDef def_from_path;
+  const DatasetDef* def = nullptr;
   switch (task.task_def.dataset_case()) {
     case TaskDef::kDatasetDef:
-      TF_RETURN_IF_ERROR(standalone::Dataset::FromGraph(
-          params, task.task_def.dataset_def().graph(), &dataset));
+      def = &task.task_def.dataset_def();
       break;
     case TaskDef::kPath: {
-      DatasetDef def;
-      Status s = ReadDatasetDef(task.task_def.path(), def);
+      Status s = ReadDatasetDef(task.task_def.path(), def_from_path);
       if (!s.ok()) {
         LOG(INFO) << "Failed to read dataset from " << task.task_def.path()
                   << ": " << s << ". Falling back to reading from dispatcher.";
-        TF_RETURN_IF_ERROR(
-            dispatcher_->GetDatasetDef(task.task_def.dataset_id(), def));
+        TF_RETURN_IF_ERROR(dispatcher_->GetDatasetDef(
+            task.task_def.dataset_id(), def_from_path));
       }
-      TF_RETURN_IF_ERROR(
-          standalone::Dataset::FromGraph(params, def.graph(), &dataset));
+      def = &def_from_path;
       break;
     }
     case TaskDef::DATASET_NOT_SET:
       return errors::Internal("Unrecognized dataset case: ",
                               task.task_def.dataset_case());
   }
+  std::unique_ptr<TaskIterator> task_iterator;
   switch (task.task_def.processing_mode()) {
     case DISTRIBUTED_EPOCH: {
+      standalone::Dataset::Params params;
+      std::unique_ptr<standalone::Dataset> dataset;
+      TF_RETURN_IF_ERROR(
+          standalone::Dataset::FromGraph(params, def->graph(), &dataset));
       auto split_provider = absl::make_unique<DataServiceSplitProvider>(
           config_.dispatcher_address(), config_.protocol(),
           task.task_def.job_id(), config_.dispatcher_timeout_ms());
+      std::unique_ptr<standalone::Iterator> iterator;
       TF_RETURN_IF_ERROR(
           dataset->MakeIterator(std::move(split_provider), &iterator));
+      task_iterator = absl::make_unique<StandaloneTaskIterator>(
+          std::move(dataset), std::move(iterator));
       break;
     }
     case PARALLEL_EPOCHS:
-      TF_RETURN_IF_ERROR(dataset->MakeIterator(&iterator));
+      // Tasks can only share the elements of datasets which produce the same
+      // elements every time.
+      if (config_.element_cache_size_bytes() > 0 &&
+          IsRepeatableDataset(def->graph())) {
+        TF_RETURN_IF_ERROR(MakeCachingTaskIterator(
+            task.task_def.dataset_id(), def->graph(), task_iterator));
+      } else {
+        TF_RETURN_IF_ERROR(
+            MakeStandaloneTaskIterator(def->graph(), task_iterator));
+      }
       break;
     default:
       return errors::InvalidArgument("Unrecognized processing mode: ",
                                      task.task_def.processing_mode());
   }
-  auto task_iterator = absl::make_unique<StandaloneTaskIterator>(
-      std::move(dataset), std::move(iterator));
   TF_RETURN_IF_ERROR(
       TaskRunner::Create(config_, task.task_def, cancellation_manager_,
                          std::move(task_iterator), task.task_runner));
@@ -260,6 +284,41 @@ Status DataServiceWorkerImpl::EnsureTaskInitialized(
   return Status::OK();
 }
 
+Status DataServiceWorkerImpl::MakeCachingTaskIterator(
+    int64 dataset_id, const GraphDef& graph,
+    std::unique_ptr<TaskIterator>& out) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  // The dispatcher assigns the same dataset id to identical dataset graphs, so
+  // the id of a repeatable dataset identifies the elements it produces.
+  std::shared_ptr<SharedElementCache> cache;
+  auto it = element_caches_.find(dataset_id);
+  if (it != element_caches_.end()) {
+    cache = it->second;
+  } else {
+    // Drop the caches which no task reads from anymore before adding a new
+    // one, so that the worker holds windows only for datasets in use or for
+    // the most recent one.
+    for (auto cache_it = element_caches_.begin();
+         cache_it != element_caches_.end();) {
+      if (cache_it->second.use_count() == 1) {
+        element_caches_.erase(cache_it++);
+      } else {
+        ++cache_it;
+      }
+    }
+    std::unique_ptr<TaskIterator> shared_iterator;
+    TF_RETURN_IF_ERROR(MakeStandaloneTaskIterator(graph, shared_iterator));
+    cache = std::make_shared<SharedElementCache>(
+        std::move(shared_iterator), config_.element_cache_size_bytes());
+    element_caches_[dataset_id] = cache;
+    VLOG(3) << "Created shared element cache for dataset " << dataset_id;
+  }
+  out = absl::make_unique<CachingTaskIterator>(
+      std::move(cache), [graph](std::unique_ptr<TaskIterator>& iterator) {
+        return MakeStandaloneTaskIterator(graph, iterator);
+      });
+  return Status::OK();
+}
+
 Status DataServiceWorkerImpl::GetElement(const GetElementRequest* request,
                                          GetElementResponse* response) {
   VLOG(3) << "Received GetElement request for task " << request->task_id();
@@ -382,7 +441,8 @@ Status DataServiceWorkerImpl::Heartbeat() TF_LOCKS_EXCLUDED(mu_) {
   std::vector<int64> tasks_to_delete;
   TF_RETURN_IF_ERROR(
       dispatcher_->WorkerHeartbeat(worker_address_, transfer_address_,
-                                   current_tasks, new_tasks, tasks_to_delete));
+                                   config_.locality(), current_tasks,
+                                   new_tasks, tasks_to_delete));
   mutex_lock l(mu_);
   for (const auto& task : new_tasks) {
     VLOG(1) << "Received new task from dispatcher with id " << task.task_id();
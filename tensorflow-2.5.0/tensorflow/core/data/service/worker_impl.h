@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/data_service.h"
 #include "tensorflow/core/data/service/dispatcher.grpc.pb.h"
+#include "tensorflow/core/data/service/element_cache.h"
 #include "tensorflow/core/data/service/task_runner.h"
 #include "tensorflow/core/data/service/worker.pb.h"
 #include "tensorflow/core/data/standalone.h"
@@ -80,7 +81,13 @@ class DataServiceWorkerImpl {
   // Creates an iterator to process a task.
   Status ProcessTaskInternal(const TaskDef& task)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
-  Status EnsureTaskInitialized(Task& task);
+  Status EnsureTaskInitialized(Task& task) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Creates an iterator for a PARALLEL_EPOCHS task which reads through the
+  // shared element cache of dataset `dataset_id`. The dataset must be
+  // repeatable (see `IsRepeatableDataset`).
+  Status MakeCachingTaskIterator(int64 dataset_id, const GraphDef& graph,
+                                 std::unique_ptr<TaskIterator>& out)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // A thread for notifying the dispatcher when tasks complete.
   void TaskCompletionThread() TF_LOCKS_EXCLUDED(mu_);
   // A thread for doing periodic heartbeats to the dispatcher.
@@ -102,6 +109,10 @@ class DataServiceWorkerImpl {
   absl::flat_hash_set<int64> finished_tasks_ TF_GUARDED_BY(mu_);
   // Completed tasks which haven't yet been communicated to the dispatcher.
   absl::flat_hash_set<int64> pending_completed_tasks_ TF_GUARDED_BY(mu_);
+  // Shared element caches, keyed by dataset id. Only used when
+  // `config_.element_cache_size_bytes()` is positive.
+  absl::flat_hash_map<int64, std::shared_ptr<SharedElementCache>>
+      element_caches_ TF_GUARDED_BY(mu_);
   bool cancelled_ TF_GUARDED_BY(mu_) = false;
   // Whether the worker has registered with the dispatcher yet.
   bool registered_ TF_GUARDED_BY(mu_) = false;
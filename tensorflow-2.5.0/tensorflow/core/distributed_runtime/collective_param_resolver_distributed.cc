@@ -15,6 +15,8 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/collective_param_resolver_distributed.h"
 
 #include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/distributed_runtime/cancellable_call.h"
@@ -86,6 +88,15 @@ class CompleteInstanceCall : public CancellableCall {
   CompleteInstanceResponse resp_;
 };
 
+// The parts of an instance that the group leader checks for consistency
+// across the members of the group.
+string InstanceSignature(const CollInstanceParams& instance) {
+  return absl::StrCat(
+      instance.type, ";", instance.data_type, ";",
+      instance.shape.DebugString(), ";",
+      absl::StrJoin(instance.impl_details.subdiv_offsets, ","));
+}
+
 }  // namespace
 
 CollectiveParamResolverDistributed::CollectiveParamResolverDistributed(
@@ -338,6 +349,21 @@ bool CollectiveParamResolverDistributed::InstanceIsCached(int32 group_key,
   return instance_it != group_it->second.end();
 }
 
+bool CollectiveParamResolverDistributed::InstanceSignatureIsValidated(
+    const CollectiveParams& cp) {
+  mutex_lock l(signature_mu_);
+  auto it = validated_signatures_.find(cp.group.group_key);
+  return it != validated_signatures_.end() &&
+         it->second.count(InstanceSignature(cp.instance)) > 0;
+}
+
+void CollectiveParamResolverDistributed::MarkInstanceSignatureValidated(
+    const CollectiveParams& cp) {
+  mutex_lock l(signature_mu_);
+  validated_signatures_[cp.group.group_key].insert(
+      InstanceSignature(cp.instance));
+}
+
 Status CollectiveParamResolverDistributed::UpdateInstanceCache(
     const GroupRec* gr, CollectiveParams* cp,
     const CompleteInstanceResponse& resp) {
@@ -381,6 +407,14 @@ void CollectiveParamResolverDistributed::CompleteInstanceDistributed(
   if (group_leader_.empty()) {
     // This is the group leader so resolution is local.
     return CompleteInstanceLocal(device, gr, cp, cp->is_source, done);
+  } else if (cp->instance.type != BROADCAST_COLLECTIVE &&
+             InstanceSignatureIsValidated(*cp)) {
+    // Only broadcast needs the leader to agree on per-instance state, namely
+    // the source rank. For other collectives the leader checks that the
+    // members agree on type, data type and shape, so it is asked once per
+    // distinct signature; later instance keys with a signature it confirmed
+    // resolve from the cached GroupRec without an RPC.
+    return CompleteInstanceLocal(device, gr, cp, cp->is_source, done);
   } else if (InstanceIsCached(cp->group.group_key, cp->instance.instance_key)) {
     return CompleteInstanceLocal(device, gr, cp, cp->is_source, done);
   } else {
@@ -402,6 +436,7 @@ void CollectiveParamResolverDistributed::CompleteInstanceDistributed(
         s = UpdateInstanceCache(gr, cp, call->resp_);
       }
       if (s.ok()) {
+        MarkInstanceSignatureValidated(*cp);
         CompleteInstanceLocal(device, gr, cp, cp->is_source, done);
       } else {
         done(s);
@@ -74,6 +74,15 @@ class CollectiveParamResolverDistributed : public CollectiveParamResolverLocal {
   bool InstanceIsCached(int32 group_key, int32 instance_key)
       TF_LOCKS_EXCLUDED(instance_mu_);
 
+  // Returns true iff the group leader has already confirmed an instance of
+  // cp's group with the type, data type, shape and subdivisions of cp.
+  bool InstanceSignatureIsValidated(const CollectiveParams& cp)
+      TF_LOCKS_EXCLUDED(signature_mu_);
+
+  // Records that the group leader confirmed the instance signature of cp.
+  void MarkInstanceSignatureValidated(const CollectiveParams& cp)
+      TF_LOCKS_EXCLUDED(signature_mu_);
+
   // Updates instance_table_ with contents of resp.
   Status UpdateInstanceCache(const GroupRec* gr, CollectiveParams* cp,
                              const CompleteInstanceResponse& resp)
@@ -91,6 +100,10 @@ class CollectiveParamResolverDistributed : public CollectiveParamResolverLocal {
   WorkerCacheInterface* worker_cache_;  // Not owned
   const string group_leader_;
   CancellationManager abortion_cancel_mgr_;
+  mutex signature_mu_;
+  // Instance signatures confirmed by the group leader, by group key.
+  gtl::FlatMap<int32, std::set<string>> validated_signatures_
+      TF_GUARDED_BY(signature_mu_);
 };
 
 }  // namespace tensorflow
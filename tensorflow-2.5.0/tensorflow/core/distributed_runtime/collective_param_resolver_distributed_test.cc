@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/collective_param_resolver_distributed.h"
 
+#include <map>
+
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/distributed_runtime/device_resolver_distributed.h"
@@ -75,14 +77,25 @@ class FakeWorker : public TestWorkerInterface {
                              const CompleteInstanceRequest* request,
                              CompleteInstanceResponse* response,
                              StatusCallback done) override {
+    {
+      mutex_lock l(mu_);
+      ++num_complete_instance_calls_;
+    }
     param_resolver_->CompleteInstanceAsync(request, response, &cm_, done);
   }
 
+  int num_complete_instance_calls() {
+    mutex_lock l(mu_);
+    return num_complete_instance_calls_;
+  }
+
  private:
   string name_;
   DeviceMgr* device_mgr_;
   CancellationManager cm_;
   CollectiveParamResolverDistributed* param_resolver_;
+  mutex mu_;
+  int num_complete_instance_calls_ TF_GUARDED_BY(mu_) = 0;
 };
 
 class FakeCache : public TestWorkerCache {
@@ -353,6 +366,73 @@ TEST_F(DeviceResDistTest, DifferentIncarnation) {
   EXPECT_TRUE(errors::IsFailedPrecondition(status_[device_name]));
 }
 
+TEST_F(DeviceResDistTest, NewInstancesNeedNoInstanceRpc) {
+  const int num_workers = 2;
+  const int num_devices = 2;
+  DefineWorkers(num_workers, num_devices, "CPU", /*nccl*/ false);
+  DefineCollectiveParams(num_workers, num_devices, "CPU");
+  IssueRequests(num_workers, num_devices);
+  ValidateCollectiveParams(num_workers, num_devices);
+  std::map<string, int> num_calls;
+  for (const auto& item : workers_) {
+    num_calls[item.first] = item.second->num_complete_instance_calls();
+  }
+  // Resolve fresh instance keys of the same group, as a step that creates new
+  // collectives would.  The group is cached and the leader already confirmed
+  // an instance of the same type and shape.
+  for (int instance_key = 10; instance_key < 13; ++instance_key) {
+    for (auto& item : cp_) {
+      item.second->Unref();
+      item.second = CreateCollectiveParams(num_workers, num_devices, "CPU");
+      item.second->instance.instance_key = instance_key;
+    }
+    IssueRequests(num_workers, num_devices);
+    ValidateCollectiveParams(num_workers, num_devices);
+  }
+  for (const auto& item : workers_) {
+    EXPECT_EQ(item.second->num_complete_instance_calls(),
+              num_calls[item.first]);
+  }
+}
+
+TEST_F(DeviceResDistTest, NewInstanceWithMismatchedShapeFails) {
+  const int num_workers = 2;
+  const int num_devices = 1;
+  DefineWorkers(num_workers, num_devices, "CPU", /*nccl*/ false);
+  DefineCollectiveParams(num_workers, num_devices, "CPU");
+  IssueRequests(num_workers, num_devices);
+  ValidateCollectiveParams(num_workers, num_devices);
+
+  // A new instance whose shape differs between the workers.  The leader
+  // resolves it first, and the other worker hasn't had a signature with this
+  // shape confirmed, so it asks the leader, which rejects it.
+  const string leader_task = "/job:worker/replica:0/task:0";
+  const string other_task = "/job:worker/replica:0/task:1";
+  for (const string& task_name : {leader_task, other_task}) {
+    const string device_name = absl::StrCat(task_name, "/device:CPU:0");
+    cp_[device_name]->Unref();
+    cp_[device_name] = CreateCollectiveParams(num_workers, num_devices, "CPU");
+    cp_[device_name]->instance.instance_key = 10;
+    if (task_name == other_task) {
+      cp_[device_name]->instance.shape = TensorShape({32});
+    }
+    {
+      mutex_lock l(mu_);
+      num_done_ = 0;
+    }
+    IssueRequest(task_name, device_name, /*group_size=*/1);
+    {
+      mutex_lock l(mu_);
+      while (num_done_ < 1) {
+        done_.wait(l);
+      }
+    }
+  }
+  TF_EXPECT_OK(status_[absl::StrCat(leader_task, "/device:CPU:0")]);
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      status_[absl::StrCat(other_task, "/device:CPU:0")]));
+}
+
 #if !GOOGLE_CUDA && !TENSORFLOW_USE_ROCM
 namespace {
 // A mock NcclReducer for testing group runtime details initialization with CPU
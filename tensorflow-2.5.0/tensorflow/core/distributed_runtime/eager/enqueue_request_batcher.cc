@@ -0,0 +1,185 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/eager/enqueue_request_batcher.h"
+
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace eager {
+namespace {
+
+auto* enqueue_batch_size = monitoring::Sampler<0>::New(
+    {"/tensorflow/core/eager_client/enqueue_batch_size",
+     "The number of queue items in the EnqueueRequests sent by the enqueue "
+     "batcher."},
+    {monitoring::Buckets::Exponential(1, 2, 14)});
+
+auto* enqueue_batch_latency_usecs = monitoring::Sampler<0>::New(
+    {"/tensorflow/core/eager_client/enqueue_batch_latency_usecs",
+     "The time from the first request of a batch being added to the batch "
+     "completing, in microseconds."},
+    {monitoring::Buckets::Exponential(1, 2, 30)});
+
+// The batcher whose 'send_' is running on this thread, if any.
+thread_local const EnqueueRequestBatcher* sending_batcher = nullptr;
+
+}  // namespace
+
+EnqueueRequestBatcher::EnqueueRequestBatcher(const Options& options,
+                                             SendFn send)
+    : options_(options), send_(std::move(send)) {
+  DCHECK_GT(options_.max_batch_items, 0);
+  DCHECK_GE(options_.max_batch_delay_micros, 0);
+}
+
+EnqueueRequestBatcher::~EnqueueRequestBatcher() {
+  // A pending delayed send holds a reference, so only batches that were
+  // never flushed can be left here.
+  if (current_batch_ != nullptr) {
+    Done(errors::Cancelled("EnqueueRequestBatcher destroyed before the batch "
+                           "was sent."),
+         current_batch_.get());
+  }
+}
+
+void EnqueueRequestBatcher::Add(const EnqueueRequest& request,
+                                EnqueueResponse* response,
+                                StatusCallback done) {
+  {
+    mutex_lock l(mu_);
+    if (current_batch_ != nullptr &&
+        current_batch_->request.context_id() != request.context_id()) {
+      CloseBatch(current_batch_id_);
+    }
+    if (current_batch_ == nullptr) {
+      current_batch_ = absl::make_unique<Batch>();
+      current_batch_->request.set_context_id(request.context_id());
+      current_batch_->env = options_.env;
+      current_batch_->start_micros = options_.env->NowMicros();
+      ++current_batch_id_;
+      if (options_.max_batch_delay_micros > 0) {
+        const int64 batch_id = current_batch_id_;
+        Ref();
+        options_.env->SchedClosureAfter(
+            options_.max_batch_delay_micros, [this, batch_id]() {
+              CloseBatchAndSend(batch_id);
+              Unref();
+            });
+      }
+    }
+    Batch* batch = current_batch_.get();
+    for (const QueueItem& item : request.queue()) {
+      *batch->request.add_queue() = item;
+    }
+    batch->members.push_back({response, std::move(done), request.queue_size()});
+    if (options_.max_batch_delay_micros == 0 ||
+        batch->request.queue_size() >= options_.max_batch_items) {
+      CloseBatch(current_batch_id_);
+    }
+  }
+  SendClosedBatches();
+}
+
+void EnqueueRequestBatcher::Flush() {
+  int64 num_batches;
+  {
+    mutex_lock l(mu_);
+    num_batches = CloseBatch(current_batch_id_);
+  }
+  SendClosedBatches();
+  // Another thread may still be sending earlier batches, and will send this
+  // one after them. A callback run synchronously by 'send_' cannot wait for
+  // that, since the batches are sent by its own thread once it returns.
+  if (sending_batcher == this) return;
+  mutex_lock l(mu_);
+  while (num_sent_batches_ < num_batches) {
+    batch_sent_cv_.wait(l);
+  }
+}
+
+int64 EnqueueRequestBatcher::CloseBatch(int64 batch_id) {
+  if (current_batch_ != nullptr && batch_id == current_batch_id_) {
+    closed_batches_.emplace_back(std::move(current_batch_));
+    ++num_closed_batches_;
+  }
+  return num_closed_batches_;
+}
+
+void EnqueueRequestBatcher::CloseBatchAndSend(int64 batch_id) {
+  {
+    mutex_lock l(mu_);
+    CloseBatch(batch_id);
+  }
+  SendClosedBatches();
+}
+
+void EnqueueRequestBatcher::SendClosedBatches() {
+  while (true) {
+    std::shared_ptr<Batch> batch;
+    {
+      mutex_lock l(mu_);
+      if (sending_ || closed_batches_.empty()) return;
+      sending_ = true;
+      batch = std::move(closed_batches_.front());
+      closed_batches_.pop_front();
+    }
+    enqueue_batch_size->GetCell()->Add(batch->request.queue_size());
+    EnqueueResponse* response = &batch->response;
+    const EnqueueRequestBatcher* outer_sending_batcher = sending_batcher;
+    sending_batcher = this;
+    send_(batch->request, response,
+          [batch](const Status& status) { Done(status, batch.get()); });
+    sending_batcher = outer_sending_batcher;
+    {
+      mutex_lock l(mu_);
+      sending_ = false;
+      ++num_sent_batches_;
+    }
+    batch_sent_cv_.notify_all();
+  }
+}
+
+// static
+void EnqueueRequestBatcher::Done(const Status& status, Batch* batch) {
+  enqueue_batch_latency_usecs->GetCell()->Add(batch->env->NowMicros() -
+                                              batch->start_micros);
+  Status batch_status = status;
+  if (batch_status.ok() && batch->response.queue_response_size() !=
+                               batch->request.queue_size()) {
+    batch_status = errors::Internal(
+        "Expected ", batch->request.queue_size(),
+        " queue responses to a batched EnqueueRequest, got ",
+        batch->response.queue_response_size());
+  }
+  int next_response = 0;
+  for (Member& member : batch->members) {
+    if (batch_status.ok()) {
+      for (int i = 0; i < member.num_items; ++i) {
+        member.response->add_queue_response()->Swap(
+            batch->response.mutable_queue_response(next_response++));
+      }
+    }
+    member.done(batch_status);
+  }
+}
+
+}  // namespace eager
+}  // namespace tensorflow
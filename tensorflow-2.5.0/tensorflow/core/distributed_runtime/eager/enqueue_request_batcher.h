@@ -0,0 +1,131 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_EAGER_ENQUEUE_REQUEST_BATCHER_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_EAGER_ENQUEUE_REQUEST_BATCHER_H_
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/eager_service.pb.h"
+
+namespace tensorflow {
+namespace eager {
+
+// Coalesces the EnqueueRequests sent to a remote eager context into fewer,
+// larger requests. Eager programs that issue many small remote ops are
+// otherwise bound by the latency of one RPC per op.
+//
+// The queue items of added requests are appended to the current batch in the
+// order they are added, and batches are sent in the order they are formed, so
+// the remote worker executes the ops in the same order as without batching
+// and the dependencies between them are preserved. A batch is sent once it
+// holds `max_batch_items` items, once its first request has waited
+// `max_batch_delay_micros`, or when Flush() is called. Callers must Flush()
+// before sending any other request to the context that may depend on the
+// enqueued ops (e.g. WaitQueueDone).
+//
+// Each caller receives the responses to its own queue items. If a batch
+// fails, every request in it receives the error.
+class EnqueueRequestBatcher : public core::RefCounted {
+ public:
+  struct Options {
+    // A batch is sent as soon as it holds at least this many queue items.
+    int max_batch_items = 64;
+
+    // The longest time the first request of a batch may wait for others
+    // before the batch is sent. If 0, each request is sent when it is added.
+    int64 max_batch_delay_micros = 0;
+
+    // Used to schedule the sending of batches. Not owned.
+    Env* env = Env::Default();
+  };
+
+  // Sends 'request' and calls 'done' once 'response' is filled in. 'request'
+  // may be deleted as soon as the call returns.
+  using SendFn = std::function<void(const EnqueueRequest& request,
+                                    EnqueueResponse* response,
+                                    StatusCallback done)>;
+
+  EnqueueRequestBatcher(const Options& options, SendFn send);
+  ~EnqueueRequestBatcher() override;
+
+  // Adds the queue items of 'request' to the current batch. 'response' gets
+  // one queue response for each of them, and 'done' is called when the batch
+  // completes. 'request' may be deleted as soon as the call returns.
+  void Add(const EnqueueRequest& request, EnqueueResponse* response,
+           StatusCallback done);
+
+  // Sends the current batch, if it is not empty, and waits until it and every
+  // batch before it have been passed to the send function, so that a request
+  // sent after Flush() returns cannot overtake them.
+  void Flush();
+
+ private:
+  struct Member {
+    EnqueueResponse* response;
+    StatusCallback done;
+    int num_items;
+  };
+
+  struct Batch {
+    EnqueueRequest request;
+    EnqueueResponse response;
+    std::vector<Member> members;
+    Env* env;
+    uint64 start_micros = 0;
+  };
+
+  // Moves the current batch to the send queue if its id is 'batch_id'.
+  // Returns the number of batches closed so far.
+  int64 CloseBatch(int64 batch_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void CloseBatchAndSend(int64 batch_id) TF_LOCKS_EXCLUDED(mu_);
+
+  // Sends the batches in the send queue in order, unless another thread is
+  // already doing so. The lock is not held while sending, since 'send_' may
+  // complete batches (and so re-enter Add) synchronously.
+  void SendClosedBatches() TF_LOCKS_EXCLUDED(mu_);
+
+  static void Done(const Status& status, Batch* batch);
+
+  const Options options_;
+  const SendFn send_;
+
+  mutex mu_;
+  std::unique_ptr<Batch> current_batch_ TF_GUARDED_BY(mu_);
+  // Incremented each time a batch is started, so that a delayed send only
+  // closes the batch it was scheduled for.
+  int64 current_batch_id_ TF_GUARDED_BY(mu_) = 0;
+  std::deque<std::shared_ptr<Batch>> closed_batches_ TF_GUARDED_BY(mu_);
+  bool sending_ TF_GUARDED_BY(mu_) = false;
+  // Batches are passed to 'send_' in the order they are closed.
+  int64 num_closed_batches_ TF_GUARDED_BY(mu_) = 0;
+  int64 num_sent_batches_ TF_GUARDED_BY(mu_) = 0;
+  condition_variable batch_sent_cv_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(EnqueueRequestBatcher);
+};
+
+}  // namespace eager
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_EAGER_ENQUEUE_REQUEST_BATCHER_H_
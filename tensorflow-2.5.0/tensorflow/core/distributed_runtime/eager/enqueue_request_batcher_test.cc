@@ -0,0 +1,343 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/eager/enqueue_request_batcher.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace eager {
+namespace {
+
+// Runs delayed closures only when asked to.
+class ManualSchedEnv : public EnvWrapper {
+ public:
+  ManualSchedEnv() : EnvWrapper(Env::Default()) {}
+
+  void SchedClosureAfter(int64 micros, std::function<void()> closure) override {
+    closures_.push_back(std::move(closure));
+  }
+
+  void RunScheduledClosures() {
+    std::vector<std::function<void()>> closures;
+    closures.swap(closures_);
+    for (auto& closure : closures) closure();
+  }
+
+  int num_scheduled_closures() const { return closures_.size(); }
+
+ private:
+  std::vector<std::function<void()>> closures_;
+};
+
+// Records the requests sent and fills in one queue response per item, whose
+// shape identifies the item's op id.
+class FakeSender {
+ public:
+  EnqueueRequestBatcher::SendFn send_fn() {
+    return [this](const EnqueueRequest& request, EnqueueResponse* response,
+                  StatusCallback done) {
+      requests_.push_back(request);
+      for (const QueueItem& item : request.queue()) {
+        response->add_queue_response()->add_shape()->add_dim()->set_size(
+            item.operation().id());
+      }
+      if (complete_synchronously_) {
+        done(status_);
+      } else {
+        pending_.push_back(std::move(done));
+      }
+    };
+  }
+
+  void CompleteAll() {
+    std::vector<StatusCallback> pending;
+    pending.swap(pending_);
+    for (auto& done : pending) done(status_);
+  }
+
+  void set_status(const Status& status) { status_ = status; }
+  void set_complete_synchronously(bool value) {
+    complete_synchronously_ = value;
+  }
+  const std::vector<EnqueueRequest>& requests() const { return requests_; }
+
+ private:
+  std::vector<EnqueueRequest> requests_;
+  std::vector<StatusCallback> pending_;
+  Status status_;
+  bool complete_synchronously_ = false;
+};
+
+EnqueueRequest MakeRequest(std::vector<int64> op_ids, uint64 context_id = 1) {
+  EnqueueRequest request;
+  request.set_context_id(context_id);
+  for (int64 id : op_ids) {
+    request.add_queue()->mutable_operation()->set_id(id);
+  }
+  return request;
+}
+
+std::vector<int64> OpIds(const EnqueueRequest& request) {
+  std::vector<int64> ids;
+  for (const QueueItem& item : request.queue()) {
+    ids.push_back(item.operation().id());
+  }
+  return ids;
+}
+
+std::vector<int64> ResponseIds(const EnqueueResponse& response) {
+  std::vector<int64> ids;
+  for (const QueueResponse& queue_response : response.queue_response()) {
+    ids.push_back(queue_response.shape(0).dim(0).size());
+  }
+  return ids;
+}
+
+class EnqueueRequestBatcherTest : public ::testing::Test {
+ protected:
+  // Releases the references held by the delayed sends.
+  ~EnqueueRequestBatcherTest() override { env_.RunScheduledClosures(); }
+
+  core::RefCountPtr<EnqueueRequestBatcher> CreateBatcher(
+      int max_batch_items, int64 max_batch_delay_micros) {
+    EnqueueRequestBatcher::Options options;
+    options.max_batch_items = max_batch_items;
+    options.max_batch_delay_micros = max_batch_delay_micros;
+    options.env = &env_;
+    return core::RefCountPtr<EnqueueRequestBatcher>(
+        new EnqueueRequestBatcher(options, sender_.send_fn()));
+  }
+
+  // Adds 'request' to 'batcher', recording the status it completes with.
+  void Add(EnqueueRequestBatcher* batcher, const EnqueueRequest& request,
+           EnqueueResponse* response, Status* status) {
+    batcher->Add(request, response,
+                 [status](const Status& s) { *status = s; });
+  }
+
+  ManualSchedEnv env_;
+  FakeSender sender_;
+};
+
+TEST_F(EnqueueRequestBatcherTest, SendsEachRequestWithoutDelay) {
+  auto batcher = CreateBatcher(/*max_batch_items=*/64,
+                               /*max_batch_delay_micros=*/0);
+  EnqueueResponse response1, response2;
+  Status status1 = errors::Unknown(""), status2 = errors::Unknown("");
+  Add(batcher.get(), MakeRequest({1}), &response1, &status1);
+  Add(batcher.get(), MakeRequest({2, 3}), &response2, &status2);
+  EXPECT_EQ(env_.num_scheduled_closures(), 0);
+  ASSERT_EQ(sender_.requests().size(), 2);
+  EXPECT_EQ(OpIds(sender_.requests()[0]), std::vector<int64>({1}));
+  EXPECT_EQ(OpIds(sender_.requests()[1]), std::vector<int64>({2, 3}));
+
+  sender_.CompleteAll();
+  TF_EXPECT_OK(status1);
+  TF_EXPECT_OK(status2);
+  EXPECT_EQ(ResponseIds(response1), std::vector<int64>({1}));
+  EXPECT_EQ(ResponseIds(response2), std::vector<int64>({2, 3}));
+}
+
+TEST_F(EnqueueRequestBatcherTest, BatchesUntilMaxItems) {
+  auto batcher = CreateBatcher(/*max_batch_items=*/4,
+                               /*max_batch_delay_micros=*/1000);
+  EnqueueResponse response1, response2, response3;
+  Status status1, status2, status3;
+  Add(batcher.get(), MakeRequest({1}), &response1, &status1);
+  Add(batcher.get(), MakeRequest({2}), &response2, &status2);
+  EXPECT_TRUE(sender_.requests().empty());
+  Add(batcher.get(), MakeRequest({3, 4}), &response3, &status3);
+  ASSERT_EQ(sender_.requests().size(), 1);
+  EXPECT_EQ(sender_.requests()[0].context_id(), 1);
+  EXPECT_EQ(OpIds(sender_.requests()[0]), std::vector<int64>({1, 2, 3, 4}));
+
+  sender_.CompleteAll();
+  TF_EXPECT_OK(status1);
+  TF_EXPECT_OK(status2);
+  TF_EXPECT_OK(status3);
+  EXPECT_EQ(ResponseIds(response1), std::vector<int64>({1}));
+  EXPECT_EQ(ResponseIds(response2), std::vector<int64>({2}));
+  EXPECT_EQ(ResponseIds(response3), std::vector<int64>({3, 4}));
+
+  // The delayed send of the full batch does nothing.
+  env_.RunScheduledClosures();
+  EXPECT_EQ(sender_.requests().size(), 1);
+}
+
+TEST_F(EnqueueRequestBatcherTest, SendsBatchAfterDelay) {
+  auto batcher = CreateBatcher(/*max_batch_items=*/64,
+                               /*max_batch_delay_micros=*/1000);
+  EnqueueResponse response1, response2;
+  Status status1, status2;
+  Add(batcher.get(), MakeRequest({1}), &response1, &status1);
+  Add(batcher.get(), MakeRequest({2}), &response2, &status2);
+  EXPECT_TRUE(sender_.requests().empty());
+  EXPECT_EQ(env_.num_scheduled_closures(), 1);
+
+  env_.RunScheduledClosures();
+  ASSERT_EQ(sender_.requests().size(), 1);
+  EXPECT_EQ(OpIds(sender_.requests()[0]), std::vector<int64>({1, 2}));
+  sender_.CompleteAll();
+  TF_EXPECT_OK(status1);
+  TF_EXPECT_OK(status2);
+}
+
+TEST_F(EnqueueRequestBatcherTest, FlushSendsBatch) {
+  auto batcher = CreateBatcher(/*max_batch_items=*/64,
+                               /*max_batch_delay_micros=*/1000);
+  EnqueueResponse response1, response2;
+  Status status1, status2;
+  Add(batcher.get(), MakeRequest({1}), &response1, &status1);
+  batcher->Flush();
+  ASSERT_EQ(sender_.requests().size(), 1);
+  Add(batcher.get(), MakeRequest({2}), &response2, &status2);
+
+  // The delayed send of the first batch leaves the second one alone.
+  EXPECT_EQ(env_.num_scheduled_closures(), 2);
+  env_.RunScheduledClosures();
+  ASSERT_EQ(sender_.requests().size(), 2);
+  EXPECT_EQ(OpIds(sender_.requests()[1]), std::vector<int64>({2}));
+
+  // Flushing an empty batcher sends nothing.
+  batcher->Flush();
+  EXPECT_EQ(sender_.requests().size(), 2);
+  sender_.CompleteAll();
+  TF_EXPECT_OK(status1);
+  TF_EXPECT_OK(status2);
+}
+
+TEST_F(EnqueueRequestBatcherTest, SeparatesContexts) {
+  auto batcher = CreateBatcher(/*max_batch_items=*/64,
+                               /*max_batch_delay_micros=*/1000);
+  EnqueueResponse response1, response2;
+  Status status1, status2;
+  Add(batcher.get(), MakeRequest({1}, /*context_id=*/1), &response1, &status1);
+  Add(batcher.get(), MakeRequest({2}, /*context_id=*/2), &response2, &status2);
+  ASSERT_EQ(sender_.requests().size(), 1);
+  EXPECT_EQ(sender_.requests()[0].context_id(), 1);
+  batcher->Flush();
+  ASSERT_EQ(sender_.requests().size(), 2);
+  EXPECT_EQ(sender_.requests()[1].context_id(), 2);
+  sender_.CompleteAll();
+}
+
+TEST_F(EnqueueRequestBatcherTest, FailsEveryRequestInBatch) {
+  auto batcher = CreateBatcher(/*max_batch_items=*/2,
+                               /*max_batch_delay_micros=*/1000);
+  sender_.set_status(errors::Internal("op failed"));
+  EnqueueResponse response1, response2;
+  Status status1, status2;
+  Add(batcher.get(), MakeRequest({1}), &response1, &status1);
+  Add(batcher.get(), MakeRequest({2}), &response2, &status2);
+  sender_.CompleteAll();
+  EXPECT_TRUE(errors::IsInternal(status1));
+  EXPECT_TRUE(errors::IsInternal(status2));
+  EXPECT_EQ(response1.queue_response_size(), 0);
+  EXPECT_EQ(response2.queue_response_size(), 0);
+}
+
+TEST_F(EnqueueRequestBatcherTest, AddFromSynchronousCompletion) {
+  auto batcher = CreateBatcher(/*max_batch_items=*/1,
+                               /*max_batch_delay_micros=*/1000);
+  sender_.set_complete_synchronously(true);
+  EnqueueResponse response1, response2;
+  Status status1, status2;
+  batcher->Add(MakeRequest({1}), &response1, [&](const Status& s) {
+    status1 = s;
+    // Sent once the first send returns.
+    Add(batcher.get(), MakeRequest({2}), &response2, &status2);
+  });
+  ASSERT_EQ(sender_.requests().size(), 2);
+  EXPECT_EQ(OpIds(sender_.requests()[0]), std::vector<int64>({1}));
+  EXPECT_EQ(OpIds(sender_.requests()[1]), std::vector<int64>({2}));
+  TF_EXPECT_OK(status1);
+  TF_EXPECT_OK(status2);
+  EXPECT_EQ(ResponseIds(response2), std::vector<int64>({2}));
+}
+
+TEST(EnqueueRequestBatcherThreadsTest, FlushWaitsForEarlierSend) {
+  mutex mu;
+  std::vector<std::vector<int64>> sent;
+  Notification first_send_started;
+  Notification release_first_send;
+  EnqueueRequestBatcher::Options options;
+  options.max_batch_delay_micros = 1000000;
+  core::RefCountPtr<EnqueueRequestBatcher> batcher(new EnqueueRequestBatcher(
+      options, [&](const EnqueueRequest& request, EnqueueResponse* response,
+                   StatusCallback done) {
+        {
+          mutex_lock l(mu);
+          sent.push_back(OpIds(request));
+        }
+        if (!first_send_started.HasBeenNotified()) {
+          first_send_started.Notify();
+          release_first_send.WaitForNotification();
+        }
+        for (int i = 0; i < request.queue_size(); ++i) {
+          response->add_queue_response();
+        }
+        done(Status::OK());
+      }));
+
+  Status status1, status2;
+  EnqueueResponse response1, response2;
+  std::unique_ptr<Thread> first_flush(Env::Default()->StartThread(
+      ThreadOptions(), "first_flush", [&]() {
+        batcher->Add(MakeRequest({1}), &response1,
+                     [&](const Status& s) { status1 = s; });
+        batcher->Flush();
+      }));
+  first_send_started.WaitForNotification();
+
+  // The second batch can only be sent by the first thread once its send
+  // returns, and Flush() waits for that.
+  batcher->Add(MakeRequest({2}), &response2,
+               [&](const Status& s) { status2 = s; });
+  Notification second_flush_done;
+  std::unique_ptr<Thread> second_flush(Env::Default()->StartThread(
+      ThreadOptions(), "second_flush", [&]() {
+        batcher->Flush();
+        second_flush_done.Notify();
+      }));
+  Env::Default()->SleepForMicroseconds(100000);
+  EXPECT_FALSE(second_flush_done.HasBeenNotified());
+
+  release_first_send.Notify();
+  second_flush_done.WaitForNotification();
+  {
+    mutex_lock l(mu);
+    ASSERT_EQ(sent.size(), 2);
+    EXPECT_EQ(sent[0], std::vector<int64>({1}));
+    EXPECT_EQ(sent[1], std::vector<int64>({2}));
+  }
+  first_flush.reset();
+  second_flush.reset();
+  TF_EXPECT_OK(status1);
+  TF_EXPECT_OK(status2);
+}
+
+}  // namespace
+}  // namespace eager
+}  // namespace tensorflow
@@ -0,0 +1,71 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/graph_def_cache.h"
+
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+GraphDefCache::GraphDefCache(int64 capacity_bytes)
+    : capacity_bytes_(capacity_bytes) {}
+
+/* static */ int64 GraphDefCache::CapacityBytesFromEnv() {
+  int64 capacity_bytes;
+  Status status = ReadInt64FromEnvVar("TF_WORKER_GRAPH_CACHE_BYTES",
+                                      /*default_val=*/0, &capacity_bytes);
+  if (!status.ok()) {
+    LOG(ERROR) << status.error_message();
+    return 0;
+  }
+  return capacity_bytes;
+}
+
+/* static */ uint64 GraphDefCache::Fingerprint(const GraphDef& graph_def) {
+  string serialized;
+  if (!SerializeToStringDeterministic(graph_def, &serialized)) {
+    LOG(ERROR) << "Failed to serialize a GraphDef for fingerprinting";
+    return 0;
+  }
+  return Fingerprint64(serialized);
+}
+
+std::shared_ptr<const GraphDef> GraphDefCache::Lookup(uint64 fingerprint) {
+  mutex_lock l(mu_);
+  auto it = graphs_.find(fingerprint);
+  return it == graphs_.end() ? nullptr : it->second;
+}
+
+bool GraphDefCache::Insert(uint64 fingerprint, const GraphDef& graph_def) {
+  const int64 bytes = graph_def.ByteSizeLong();
+  if (fingerprint == 0 || bytes > capacity_bytes_) return false;
+  auto graph = std::make_shared<const GraphDef>(graph_def);
+  mutex_lock l(mu_);
+  if (!graphs_.emplace(fingerprint, std::move(graph)).second) return true;
+  insertion_order_.push_back(fingerprint);
+  total_bytes_ += bytes;
+  while (total_bytes_ > capacity_bytes_) {
+    auto it = graphs_.find(insertion_order_.front());
+    total_bytes_ -= it->second->ByteSizeLong();
+    graphs_.erase(it);
+    insertion_order_.pop_front();
+  }
+  return true;
+}
+
+}  // namespace tensorflow
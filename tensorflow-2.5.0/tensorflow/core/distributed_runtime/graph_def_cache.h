@@ -0,0 +1,70 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_GRAPH_DEF_CACHE_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_GRAPH_DEF_CACHE_H_
+
+#include <deque>
+#include <memory>
+#include <unordered_map>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// GraphDefCache keeps the graphs registered on a worker, keyed by the
+// fingerprint the master computed for them (see
+// RegisterGraphRequest.graph_def_fingerprint), so that a master can register
+// a graph the worker already has, e.g. for a new step signature or after the
+// session was recreated, by sending only its fingerprint. Thread safe.
+class GraphDefCache {
+ public:
+  // Keeps up to `capacity_bytes` of serialized graphs, evicting the oldest
+  // ones first. A cache with a capacity of 0 caches nothing.
+  explicit GraphDefCache(int64 capacity_bytes);
+
+  // Returns the capacity set by the TF_WORKER_GRAPH_CACHE_BYTES environment
+  // variable, or 0 if it is not set.
+  static int64 CapacityBytesFromEnv();
+
+  // Returns the fingerprint of `graph_def` that masters send to workers.
+  static uint64 Fingerprint(const GraphDef& graph_def);
+
+  // Returns the graph cached under `fingerprint`, or nullptr if there is none.
+  std::shared_ptr<const GraphDef> Lookup(uint64 fingerprint);
+
+  // Caches a copy of `graph_def` under `fingerprint`. Returns false if the
+  // graph does not fit in the cache.
+  bool Insert(uint64 fingerprint, const GraphDef& graph_def);
+
+ private:
+  const int64 capacity_bytes_;
+  mutex mu_;
+  std::unordered_map<uint64, std::shared_ptr<const GraphDef>> graphs_
+      TF_GUARDED_BY(mu_);
+  // Keys of `graphs_` in insertion order.
+  std::deque<uint64> insertion_order_ TF_GUARDED_BY(mu_);
+  int64 total_bytes_ TF_GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(GraphDefCache);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_GRAPH_DEF_CACHE_H_
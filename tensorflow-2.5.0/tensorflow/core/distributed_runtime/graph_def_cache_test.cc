@@ -0,0 +1,62 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/graph_def_cache.h"
+
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+GraphDef MakeGraphDef(const string& node_name) {
+  GraphDef graph_def;
+  NodeDef* node = graph_def.add_node();
+  node->set_name(node_name);
+  node->set_op("NoOp");
+  return graph_def;
+}
+
+TEST(GraphDefCache, LookupAndInsert) {
+  GraphDefCache cache(/*capacity_bytes=*/1 << 20);
+  const GraphDef graph_def = MakeGraphDef("a");
+  const uint64 fingerprint = GraphDefCache::Fingerprint(graph_def);
+  EXPECT_NE(fingerprint, GraphDefCache::Fingerprint(MakeGraphDef("b")));
+
+  EXPECT_EQ(nullptr, cache.Lookup(fingerprint));
+  EXPECT_TRUE(cache.Insert(fingerprint, graph_def));
+  std::shared_ptr<const GraphDef> cached = cache.Lookup(fingerprint);
+  ASSERT_NE(nullptr, cached);
+  EXPECT_EQ("a", cached->node(0).name());
+}
+
+TEST(GraphDefCache, EvictsOldestGraph) {
+  const GraphDef a = MakeGraphDef("a");
+  const GraphDef b = MakeGraphDef("b");
+  GraphDefCache cache(/*capacity_bytes=*/a.ByteSizeLong() + 1);
+  EXPECT_TRUE(cache.Insert(1, a));
+  EXPECT_TRUE(cache.Insert(2, b));
+  EXPECT_EQ(nullptr, cache.Lookup(1));
+  EXPECT_NE(nullptr, cache.Lookup(2));
+}
+
+TEST(GraphDefCache, Disabled) {
+  GraphDefCache cache(/*capacity_bytes=*/0);
+  EXPECT_FALSE(cache.Insert(1, MakeGraphDef("a")));
+  EXPECT_EQ(nullptr, cache.Lookup(1));
+}
+
+}  // namespace
+}  // namespace tensorflow
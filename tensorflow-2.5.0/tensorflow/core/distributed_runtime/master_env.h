@@ -39,6 +39,7 @@ struct WorkerCacheFactoryOptions {
   const string* job_name = nullptr;
   int task_index;
   const string* protocol = nullptr;
+  const RPCOptions* rpc_options = nullptr;
 
   WorkerCacheFactoryOptions() {}
 
@@ -51,6 +52,7 @@ struct WorkerCacheFactoryOptions {
       job_name = &server_def.job_name();
       task_index = server_def.task_index();
       protocol = &server_def.protocol();
+      rpc_options = &server_def.default_session_config().rpc_options();
     }
   }
 };
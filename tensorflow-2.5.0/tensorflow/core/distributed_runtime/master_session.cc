@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/profile_handler.h"
 #include "tensorflow/core/common_runtime/stats_publisher_interface.h"
 #include "tensorflow/core/debug/debug_graph_utils.h"
+#include "tensorflow/core/distributed_runtime/graph_def_cache.h"
 #include "tensorflow/core/distributed_runtime/request_id.h"
 #include "tensorflow/core/distributed_runtime/scheduler.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
@@ -58,6 +59,7 @@ limitations under the License.
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -437,6 +439,75 @@ Status MasterSession::ReffedClientGraph::DoBuildPartitions(
   return Partition(popts, &client_graph->graph, out_partitions);
 }
 
+namespace {
+
+struct GraphRegistrationOptions {
+  // If true, set by TF_MASTER_REGISTER_GRAPHS_BY_FINGERPRINT, graphs are sent
+  // with their fingerprints, and only the fingerprint is sent to the workers
+  // that reported to have cached the graph (see GraphDefCache).
+  bool register_by_fingerprint = false;
+  // If positive, set by TF_MASTER_MAX_CONCURRENT_GRAPH_REGISTRATIONS, at most
+  // that many RegisterGraph calls of a graph are in flight at a time, which
+  // bounds the memory and bandwidth used by the fan-out to many workers.
+  int64 max_concurrent_registrations = 0;
+};
+
+const GraphRegistrationOptions& GetGraphRegistrationOptions() {
+  static const GraphRegistrationOptions* options = [] {
+    auto* options = new GraphRegistrationOptions;
+    Status status =
+        ReadBoolFromEnvVar("TF_MASTER_REGISTER_GRAPHS_BY_FINGERPRINT",
+                           /*default_val=*/false,
+                           &options->register_by_fingerprint);
+    if (!status.ok()) {
+      LOG(ERROR) << status.error_message();
+    }
+    status = ReadInt64FromEnvVar("TF_MASTER_MAX_CONCURRENT_GRAPH_REGISTRATIONS",
+                                 /*default_val=*/0,
+                                 &options->max_concurrent_registrations);
+    if (!status.ok()) {
+      LOG(ERROR) << status.error_message();
+    }
+    return options;
+  }();
+  return *options;
+}
+
+// The fingerprints of the graphs that each worker reported to have cached.
+// Shared by all sessions of the master, so that sessions recreated after a
+// failure register their graphs by fingerprint. An entry is dropped when the
+// worker no longer has the graph, e.g. because it restarted.
+class CachedWorkerGraphs {
+ public:
+  static CachedWorkerGraphs* Global() {
+    static CachedWorkerGraphs* cached_worker_graphs = new CachedWorkerGraphs;
+    return cached_worker_graphs;
+  }
+
+  bool Contains(const string& worker, uint64 fingerprint) {
+    mutex_lock l(mu_);
+    auto it = fingerprints_.find(worker);
+    return it != fingerprints_.end() && it->second.count(fingerprint) > 0;
+  }
+
+  void Insert(const string& worker, uint64 fingerprint) {
+    mutex_lock l(mu_);
+    fingerprints_[worker].insert(fingerprint);
+  }
+
+  void Erase(const string& worker, uint64 fingerprint) {
+    mutex_lock l(mu_);
+    fingerprints_[worker].erase(fingerprint);
+  }
+
+ private:
+  mutex mu_;
+  std::unordered_map<string, std::unordered_set<uint64>> fingerprints_
+      TF_GUARDED_BY(mu_);
+};
+
+}  // namespace
+
 Status MasterSession::ReffedClientGraph::DoRegisterPartitions(
     const PartitionOptions& popts,
     std::unordered_map<string, GraphDef> graph_partitions) {
@@ -464,10 +535,19 @@ Status MasterSession::ReffedClientGraph::DoRegisterPartitions(
     RegisterGraphRequest req;
     RegisterGraphResponse resp;
     Status status;
+    // The graph while `req` only carries its fingerprint.
+    GraphDef graph_def;
+    StatusCallback done;
   };
+  const GraphRegistrationOptions& registration_options =
+      GetGraphRegistrationOptions();
+  CachedWorkerGraphs* cached_worker_graphs = CachedWorkerGraphs::Global();
   const int num = partitions_.size();
   gtl::InlinedVector<Call, 4> calls(num);
   BlockingCounter done(num);
+  mutex in_flight_mu;
+  condition_variable in_flight_cv;
+  int64 num_in_flight = 0;
   for (int i = 0; i < num; ++i) {
     const Part& part = partitions_[i];
     Call* c = &calls[i];
@@ -476,17 +556,53 @@ Status MasterSession::ReffedClientGraph::DoRegisterPartitions(
     c->req.mutable_graph_def()->Swap(&graph_partitions[part.name]);
     StripDefaultAttributes(*OpRegistry::Global(),
                            c->req.mutable_graph_def()->mutable_node());
+    if (registration_options.register_by_fingerprint) {
+      const uint64 fingerprint = GraphDefCache::Fingerprint(c->req.graph_def());
+      c->req.set_graph_def_fingerprint(fingerprint);
+      if (fingerprint != 0 &&
+          cached_worker_graphs->Contains(part.name, fingerprint)) {
+        c->graph_def.Swap(c->req.mutable_graph_def());
+        c->req.clear_graph_def();
+      }
+    }
     *c->req.mutable_config_proto() = session_opts_.config;
     *c->req.mutable_graph_options() = session_opts_.config.graph_options();
     *c->req.mutable_debug_options() =
         callable_opts_.run_options().debug_options();
     c->req.set_collective_graph_key(collective_graph_key_);
     VLOG(2) << "Register " << c->req.graph_def().DebugString();
-    auto cb = [c, &done](const Status& s) {
+    if (registration_options.max_concurrent_registrations > 0) {
+      mutex_lock l(in_flight_mu);
+      while (num_in_flight >=
+             registration_options.max_concurrent_registrations) {
+        in_flight_cv.wait(l);
+      }
+      ++num_in_flight;
+    }
+    c->done = [c, &part, cached_worker_graphs, &registration_options,
+               &in_flight_mu, &in_flight_cv, &num_in_flight,
+               &done](const Status& s) {
+      const uint64 fingerprint = c->req.graph_def_fingerprint();
+      if (s.ok() && c->resp.graph_def_required()) {
+        // The worker no longer has the graph, so send it again.
+        cached_worker_graphs->Erase(part.name, fingerprint);
+        c->resp.Clear();
+        c->req.mutable_graph_def()->Swap(&c->graph_def);
+        part.worker->RegisterGraphAsync(&c->req, &c->resp, c->done);
+        return;
+      }
+      if (s.ok() && c->resp.graph_def_cached()) {
+        cached_worker_graphs->Insert(part.name, fingerprint);
+      }
       c->status = s;
+      if (registration_options.max_concurrent_registrations > 0) {
+        mutex_lock l(in_flight_mu);
+        --num_in_flight;
+        in_flight_cv.notify_one();
+      }
       done.DecrementCount();
     };
-    part.worker->RegisterGraphAsync(&c->req, &c->resp, cb);
+    part.worker->RegisterGraphAsync(&c->req, &c->resp, c->done);
   }
   done.Wait();
   for (int i = 0; i < num; ++i) {
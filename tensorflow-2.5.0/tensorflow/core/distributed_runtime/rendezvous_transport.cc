@@ -0,0 +1,80 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rendezvous_transport.h"
+
+#include <unordered_map>
+
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+
+namespace {
+
+mutex* get_registry_lock() {
+  static mutex registry_lock(LINKER_INITIALIZED);
+  return &registry_lock;
+}
+
+typedef std::unordered_map<string, RendezvousTransportRegistry::Factory>
+    TransportFactories;
+
+TransportFactories* transport_factories() {
+  static TransportFactories* factories = new TransportFactories;
+  return factories;
+}
+
+}  // namespace
+
+/* static */
+void RendezvousTransportRegistry::Register(const string& name,
+                                           Factory factory) {
+  mutex_lock l(*get_registry_lock());
+  if (!transport_factories()->insert({name, std::move(factory)}).second) {
+    LOG(ERROR) << "Two rendezvous transports are being registered as "
+               << name;
+  }
+}
+
+/* static */
+std::unique_ptr<RendezvousTransport> RendezvousTransportRegistry::Create(
+    const string& name) {
+  Factory factory;
+  {
+    mutex_lock l(*get_registry_lock());
+    auto it = transport_factories()->find(name);
+    if (it == transport_factories()->end()) return nullptr;
+    factory = it->second;
+  }
+  return factory();
+}
+
+/* static */
+RendezvousTransport* RendezvousTransportRegistry::Default() {
+  static RendezvousTransport* transport = []() -> RendezvousTransport* {
+    const char* name = getenv("TF_RENDEZVOUS_TRANSPORT");
+    if (name == nullptr || *name == '\0') return nullptr;
+    std::unique_ptr<RendezvousTransport> result = Create(name);
+    if (result == nullptr) {
+      LOG(WARNING) << "Unknown rendezvous transport " << name
+                   << "; tensors will be sent in RecvTensor responses.";
+    }
+    return result.release();
+  }();
+  return transport;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,106 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RENDEZVOUS_TRANSPORT_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RENDEZVOUS_TRANSPORT_H_
+
+#include <functional>
+#include <memory>
+
+#include "google/protobuf/any.pb.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A RendezvousTransport moves the contents of tensors fetched by RecvTensor
+// out of band, instead of in the RecvTensorResponse payload.
+//
+// The transport is negotiated for every request. The receiver offers it in
+// RecvTensorRequest.transport_options, and the sender accepts it by setting
+// RecvTensorResponse.transport_options instead of the tensor field. Either
+// side may decline, in which case the tensor is sent in the response as
+// usual, so the RPC path always remains the fallback.
+//
+// Implementations must be thread-safe.
+class RendezvousTransport {
+ public:
+  virtual ~RendezvousTransport() {}
+
+  // Receiver side. Returns true and fills `*options` if tensors that are
+  // received into memory with `alloc_attrs` may use this transport.
+  virtual bool OfferRecv(const AllocatorAttributes& alloc_attrs,
+                         protobuf::Any* options) = 0;
+
+  // Sender side. If `request_options` was filled by OfferRecv() of a
+  // compatible transport and `tensor` can be sent out of band, moves its
+  // contents, fills `*response_options` and returns true.
+  virtual bool Send(const protobuf::Any& request_options, const Tensor& tensor,
+                    protobuf::Any* response_options) = 0;
+
+  // Receiver side. Materializes the tensor described by `response_options`,
+  // which was filled by Send().
+  virtual Status Receive(const protobuf::Any& response_options,
+                         Tensor* tensor) = 0;
+};
+
+// Registry of the available transports. The transport used by this process
+// is selected by the TF_RENDEZVOUS_TRANSPORT environment variable.
+class RendezvousTransportRegistry {
+ public:
+  typedef std::function<std::unique_ptr<RendezvousTransport>()> Factory;
+
+  // Registers the factory for the transport called `name`.
+  static void Register(const string& name, Factory factory);
+
+  // Returns the transport named by TF_RENDEZVOUS_TRANSPORT, or nullptr if
+  // the variable is unset or no such transport was registered. The result
+  // is created on first use and never deleted.
+  static RendezvousTransport* Default();
+
+  // Creates a new instance of the transport called `name`, or returns
+  // nullptr if no such transport was registered.
+  static std::unique_ptr<RendezvousTransport> Create(const string& name);
+};
+
+namespace rendezvous_transport_registration {
+
+class RendezvousTransportRegistration {
+ public:
+  RendezvousTransportRegistration(
+      const string& name, RendezvousTransportRegistry::Factory factory) {
+    RendezvousTransportRegistry::Register(name, std::move(factory));
+  }
+};
+
+}  // namespace rendezvous_transport_registration
+
+#define REGISTER_RENDEZVOUS_TRANSPORT(name, factory) \
+  REGISTER_RENDEZVOUS_TRANSPORT_UNIQ_HELPER(__COUNTER__, name, factory)
+#define REGISTER_RENDEZVOUS_TRANSPORT_UNIQ_HELPER(ctr, name, factory) \
+  REGISTER_RENDEZVOUS_TRANSPORT_UNIQ(ctr, name, factory)
+#define REGISTER_RENDEZVOUS_TRANSPORT_UNIQ(ctr, name, factory)           \
+  static ::tensorflow::rendezvous_transport_registration::               \
+      RendezvousTransportRegistration                                    \
+          rendezvous_transport_registration_fn_##ctr TF_ATTRIBUTE_UNUSED = \
+              ::tensorflow::rendezvous_transport_registration::          \
+                  RendezvousTransportRegistration(name, factory)
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RENDEZVOUS_TRANSPORT_H_
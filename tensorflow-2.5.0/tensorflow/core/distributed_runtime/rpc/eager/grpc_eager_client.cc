@@ -17,6 +17,7 @@ limitations under the License.
 
 #include "grpcpp/generic/generic_stub.h"
 #include "tensorflow/core/distributed_runtime/call_options.h"
+#include "tensorflow/core/distributed_runtime/eager/enqueue_request_batcher.h"
 #include "tensorflow/core/distributed_runtime/rpc/eager/grpc_eager_service.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_client_cq_tag.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_state.h"
@@ -63,6 +64,26 @@ bool EnableStreaming() {
   return result;
 }
 
+// Setting environment variable "TF_EAGER_CLIENT_ENQUEUE_BATCH_DELAY_MICROS" to
+// a positive value batches the streaming enqueue requests issued within that
+// many microseconds of each other into one request, of at most
+// "TF_EAGER_CLIENT_ENQUEUE_BATCH_MAX_ITEMS" ops. This saves round trips when
+// many small remote ops are issued, at the cost of delaying each op by up to
+// the delay. An error fails every op of the batch it is in.
+int64 EnqueueBatchDelayMicros() {
+  int64 result;
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_EAGER_CLIENT_ENQUEUE_BATCH_DELAY_MICROS",
+                                  0, &result));
+  return result;
+}
+
+int64 EnqueueBatchMaxItems() {
+  int64 result;
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_EAGER_CLIENT_ENQUEUE_BATCH_MAX_ITEMS", 64,
+                                  &result));
+  return result;
+}
+
 // Ref-counted thread to handle callbacks for completed requests a GRPC
 // completion queue. The thread might be shared by multiple eager clients, and
 // each one of them should hold a reference count to ensure that the thread
@@ -124,6 +145,7 @@ class GrpcEagerClient : public EagerClient {
   void method##Async(const method##Request* request,                      \
                      method##Response* response, StatusCallback done)     \
       override {                                                          \
+    FlushEnqueueBatch(request->context_id());                             \
     StatusCallback done_wrapped = callback_wrapper(std::move(done));      \
     new RPCState<protobuf::Message>(                                      \
         &stub_, cq_, "/tensorflow.eager.EagerService/" #method, *request, \
@@ -143,6 +165,7 @@ class GrpcEagerClient : public EagerClient {
   void method##Async(CallOptions* call_opts, const method##Request* request,  \
                      method##Response* response, StatusCallback done)         \
       override {                                                              \
+    FlushEnqueueBatch(request->context_id());                                 \
     StatusCallback done_wrapped = callback_wrapper(std::move(done));          \
     new RPCState<protobuf::Message>(                                          \
         &stub_, cq_, "/tensorflow.eager.EagerService/" #method, *request,     \
@@ -158,6 +181,7 @@ class GrpcEagerClient : public EagerClient {
   void CloseContextAsync(const CloseContextRequest* request,
                          CloseContextResponse* response,
                          StatusCallback done) override {
+    FlushEnqueueBatch(request->context_id());
     StatusCallback done_wrapped = callback_wrapper(std::move(done));
     new RPCState<protobuf::Message>(
         &stub_, cq_, "/tensorflow.eager.EagerService/CloseContext", *request,
@@ -169,6 +193,7 @@ class GrpcEagerClient : public EagerClient {
             << request->DebugString();
 
     mutex_lock l(mu_);
+    enqueue_batchers_.erase(request->context_id());
     const auto& it = enqueue_dispatchers_.find(request->context_id());
     if (it != enqueue_dispatchers_.end()) {
       it->second.CancelCall();
@@ -185,19 +210,13 @@ class GrpcEagerClient : public EagerClient {
                              StatusCallback done) override {
     StatusCallback done_wrapped = callback_wrapper(std::move(done));
     if (EnableStreaming()) {
-      mutex_lock l(mu_);
-      auto it = enqueue_dispatchers_.find(request->context_id());
-      if (it == enqueue_dispatchers_.end()) {
-        auto it_and_bool = enqueue_dispatchers_.emplace(
-            std::piecewise_construct,
-            std::forward_as_tuple(request->context_id()),
-            std::forward_as_tuple(
-                &stub_, cq_,
-                "/tensorflow.eager.EagerService/StreamingEnqueue"));
-        it = it_and_bool.first;
+      core::RefCountPtr<EnqueueRequestBatcher> batcher =
+          GetEnqueueBatcher(request->context_id());
+      if (batcher != nullptr) {
+        batcher->Add(*request, response, std::move(done_wrapped));
+      } else {
+        SendStreamingEnqueue(*request, response, std::move(done_wrapped));
       }
-      // TODO(haoyuzhang): Consider supporting cancellation for streaming RPC?
-      it->second.SendNextRequest(*request, response, std::move(done_wrapped));
     } else {
       Notification n;
       Status status;
@@ -223,6 +242,65 @@ class GrpcEagerClient : public EagerClient {
   std::unordered_map<uint64, StreamingRPCDispatcher<EnqueueResponse>>
       enqueue_dispatchers_ TF_GUARDED_BY(mu_);
 
+  // Batches of streaming enqueue requests, by context id. Only used when
+  // EnqueueBatchDelayMicros() is positive.
+  std::unordered_map<uint64, core::RefCountPtr<EnqueueRequestBatcher>>
+      enqueue_batchers_ TF_GUARDED_BY(mu_);
+
+  void SendStreamingEnqueue(const EnqueueRequest& request,
+                            EnqueueResponse* response, StatusCallback done)
+      TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    auto it = enqueue_dispatchers_.find(request.context_id());
+    if (it == enqueue_dispatchers_.end()) {
+      auto it_and_bool = enqueue_dispatchers_.emplace(
+          std::piecewise_construct, std::forward_as_tuple(request.context_id()),
+          std::forward_as_tuple(
+              &stub_, cq_, "/tensorflow.eager.EagerService/StreamingEnqueue"));
+      it = it_and_bool.first;
+    }
+    // TODO(haoyuzhang): Consider supporting cancellation for streaming RPC?
+    it->second.SendNextRequest(request, response, std::move(done));
+  }
+
+  // Returns the batcher for 'context_id', or nullptr if enqueue requests are
+  // not batched.
+  core::RefCountPtr<EnqueueRequestBatcher> GetEnqueueBatcher(uint64 context_id)
+      TF_LOCKS_EXCLUDED(mu_) {
+    static const int64 delay_micros = EnqueueBatchDelayMicros();
+    if (delay_micros <= 0) return nullptr;
+    mutex_lock l(mu_);
+    auto& batcher = enqueue_batchers_[context_id];
+    if (batcher == nullptr) {
+      EnqueueRequestBatcher::Options options;
+      options.max_batch_delay_micros = delay_micros;
+      options.max_batch_items = EnqueueBatchMaxItems();
+      // Batches are only sent while they hold requests, each of which holds a
+      // reference to this client, so 'this' outlives every send.
+      batcher.reset(new EnqueueRequestBatcher(
+          options, [this](const EnqueueRequest& request,
+                          EnqueueResponse* response, StatusCallback done) {
+            SendStreamingEnqueue(request, response, std::move(done));
+          }));
+    }
+    batcher->Ref();
+    return core::RefCountPtr<EnqueueRequestBatcher>(batcher.get());
+  }
+
+  // Sends the batched enqueue requests of 'context_id', so that they reach
+  // the remote worker before a request that may depend on them.
+  void FlushEnqueueBatch(uint64 context_id) TF_LOCKS_EXCLUDED(mu_) {
+    core::RefCountPtr<EnqueueRequestBatcher> batcher;
+    {
+      mutex_lock l(mu_);
+      auto it = enqueue_batchers_.find(context_id);
+      if (it == enqueue_batchers_.end()) return;
+      it->second->Ref();
+      batcher.reset(it->second.get());
+    }
+    batcher->Flush();
+  }
+
   StatusCallback callback_wrapper(StatusCallback done) {
     Ref();
     return [this, done = std::move(done)](const Status& status) {
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_channel.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <limits>
 #include <map>
@@ -128,7 +129,8 @@ const ::grpc::ChannelArguments* GetDefaultChannelArguments() {
       LOG(ERROR) << "Invalid compression algorithm: "
                  << rpc_options->compression_algorithm();
     }
-    if (rpc_options->disable_session_connection_sharing()) {
+    if (rpc_options->disable_session_connection_sharing() ||
+        rpc_options->num_channels_per_target() > 1) {
       VLOG(5) << "Disabling TCP connection sharing";
       args.SetInt(GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL, true);
     }
@@ -187,27 +189,36 @@ Status GrpcChannelSpec::AddHostPortsJob(
 namespace {
 
 // GrpcChannelCache that caches results to FindWorkerChannel() calls.
+// When num_channels_per_target > 1, keeps that many channels per target and
+// hands them out in round-robin order.
 class CachingGrpcChannelCache : public GrpcChannelCache {
  public:
-  CachingGrpcChannelCache() {}
+  explicit CachingGrpcChannelCache(int num_channels_per_target = 1)
+      : num_channels_per_target_(std::max(num_channels_per_target, 1)) {}
 
   ~CachingGrpcChannelCache() override {}
 
   SharedGrpcChannelPtr FindWorkerChannel(const string& target) override {
-    SharedGrpcChannelPtr ch = nullptr;
     {
       mutex_lock l(mu_);  // could use reader lock
-      ch = gtl::FindPtrOrNull(channels_, target);
-      if (ch) {
-        return ch;
+      auto it = channels_.find(target);
+      if (it != channels_.end()) {
+        return NextChannel(&it->second);
       }
     }
-    ch = FindChannelOnce(target);
-    if (ch) {
-      mutex_lock l(mu_);
-      channels_.insert({target, ch});
+    ChannelState state;
+    state.channels.reserve(num_channels_per_target_);
+    for (int i = 0; i < num_channels_per_target_; ++i) {
+      SharedGrpcChannelPtr ch = FindChannelOnce(target);
+      if (!ch) {
+        return nullptr;
+      }
+      state.channels.push_back(std::move(ch));
     }
-    return ch;
+    mutex_lock l(mu_);
+    // Another thread may have raced us; keep whichever state was first.
+    auto it = channels_.insert({target, std::move(state)}).first;
+    return NextChannel(&it->second);
   }
 
  protected:
@@ -217,17 +228,32 @@ class CachingGrpcChannelCache : public GrpcChannelCache {
   virtual SharedGrpcChannelPtr FindChannelOnce(const string& target) = 0;
 
  private:
+  struct ChannelState {
+    std::vector<SharedGrpcChannelPtr> channels;
+    int next = 0;
+  };
+
+  SharedGrpcChannelPtr NextChannel(ChannelState* state)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    const SharedGrpcChannelPtr& ch = state->channels[state->next];
+    state->next = (state->next + 1) % state->channels.size();
+    return ch;
+  }
+
+  const int num_channels_per_target_;
+
   // TODO(zhifengc): Eviction when the map becomes too big.
   mutex mu_;
-  std::unordered_map<string, SharedGrpcChannelPtr> channels_ TF_GUARDED_BY(mu_);
+  std::unordered_map<string, ChannelState> channels_ TF_GUARDED_BY(mu_);
 };
 
 // A ChannelCache that is the union of multiple ChannelCaches.
 // Takes ownership of the caches passed to the constructor.
 class MultiGrpcChannelCache : public CachingGrpcChannelCache {
  public:
-  explicit MultiGrpcChannelCache(const std::vector<GrpcChannelCache*>& caches)
-      : CachingGrpcChannelCache(), caches_(caches) {}
+  MultiGrpcChannelCache(const std::vector<GrpcChannelCache*>& caches,
+                        int num_channels_per_target)
+      : CachingGrpcChannelCache(num_channels_per_target), caches_(caches) {}
 
   ~MultiGrpcChannelCache() override {
     for (GrpcChannelCache* cache : caches_) {
@@ -294,8 +320,10 @@ class SparseGrpcChannelCache : public CachingGrpcChannelCache {
  public:
   SparseGrpcChannelCache(const string& job_id,
                          const std::map<int, string>& host_ports,
-                         ChannelCreationFunction channel_func)
-      : job_id_(job_id),
+                         ChannelCreationFunction channel_func,
+                         int num_channels_per_target)
+      : CachingGrpcChannelCache(num_channels_per_target),
+        job_id_(job_id),
         host_ports_(host_ports),
         channel_func_(std::move(channel_func)) {
     LOG(INFO) << "Initialize GrpcChannelCache for job " << ToString();
@@ -370,7 +398,8 @@ class SparseGrpcChannelCache : public CachingGrpcChannelCache {
 }  // namespace
 
 GrpcChannelCache* NewGrpcChannelCache(const GrpcChannelSpec& spec,
-                                      ChannelCreationFunction channel_func) {
+                                      ChannelCreationFunction channel_func,
+                                      const RPCOptions& rpc_options) {
   const int num_jobs = spec.host_ports_jobs().size();
   if (!num_jobs) {
     LOG(ERROR) << "Empty channel spec.";
@@ -379,10 +408,14 @@ GrpcChannelCache* NewGrpcChannelCache(const GrpcChannelSpec& spec,
   std::vector<GrpcChannelCache*> caches;
   caches.reserve(num_jobs);
   for (auto& job : spec.host_ports_jobs()) {
-    caches.push_back(
-        new SparseGrpcChannelCache(job.job_id, job.host_ports, channel_func));
+    caches.push_back(new SparseGrpcChannelCache(
+        job.job_id, job.host_ports, channel_func,
+        rpc_options.num_channels_per_target()));
   }
-  return caches.size() == 1 ? caches[0] : new MultiGrpcChannelCache(caches);
+  return caches.size() == 1
+             ? caches[0]
+             : new MultiGrpcChannelCache(
+                   caches, rpc_options.num_channels_per_target());
 }
 
 }  // end namespace tensorflow
@@ -82,8 +82,11 @@ class GrpcChannelCache {
 
 typedef std::function<SharedGrpcChannelPtr(string)> ChannelCreationFunction;
 
-GrpcChannelCache* NewGrpcChannelCache(const GrpcChannelSpec& channel_spec,
-                                      ChannelCreationFunction channel_func);
+// If rpc_options.num_channels_per_target() > 1, FindWorkerChannel() cycles
+// through that many channels per target.
+GrpcChannelCache* NewGrpcChannelCache(
+    const GrpcChannelSpec& channel_spec, ChannelCreationFunction channel_func,
+    const RPCOptions& rpc_options = RPCOptions());
 
 // Below here are internal-only functions.
 
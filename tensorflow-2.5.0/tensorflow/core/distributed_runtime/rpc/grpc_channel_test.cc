@@ -118,6 +118,32 @@ TEST(GrpcChannelTest, HostPorts) {
   }
 }
 
+TEST(GrpcChannelTest, MultipleChannelsPerTarget) {
+  GrpcChannelSpec spec;
+  TF_EXPECT_OK(spec.AddHostPortsJob("mnist", {"a:1", "b:2"}));
+  TF_EXPECT_OK(spec.AddHostPortsJob("other", {"c:3"}));
+  ChannelCreationFunction channel_func =
+      ConvertToChannelCreationFunction(NewHostPortGrpcChannel);
+  RPCOptions rpc_options;
+  rpc_options.set_num_channels_per_target(3);
+  std::unique_ptr<GrpcChannelCache> cc(
+      NewGrpcChannelCache(spec, channel_func, rpc_options));
+
+  for (const string& target :
+       {"/job:mnist/replica:0/task:0", "/job:other/replica:0/task:0"}) {
+    auto ch_1 = cc->FindWorkerChannel(target);
+    auto ch_2 = cc->FindWorkerChannel(target);
+    auto ch_3 = cc->FindWorkerChannel(target);
+    auto ch_4 = cc->FindWorkerChannel(target);
+
+    // Channels are handed out in round-robin order.
+    EXPECT_NE(ch_1.get(), ch_2.get());
+    EXPECT_NE(ch_1.get(), ch_3.get());
+    EXPECT_NE(ch_2.get(), ch_3.get());
+    EXPECT_EQ(ch_1.get(), ch_4.get());
+  }
+}
+
 TEST(GrpcChannelTest, SparseHostPorts) {
   GrpcChannelSpec spec;
   TF_EXPECT_OK(
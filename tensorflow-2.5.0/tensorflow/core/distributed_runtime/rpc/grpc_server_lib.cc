@@ -370,8 +370,9 @@ Status GrpcServer::WorkerCacheFactory(const WorkerCacheFactoryOptions& options,
   GrpcChannelSpec channel_spec;
   TF_RETURN_IF_ERROR(ParseChannelSpec(options, &channel_spec));
 
-  std::shared_ptr<GrpcChannelCache> channel_cache(
-      NewGrpcChannelCache(channel_spec, GetChannelCreationFunction()));
+  std::shared_ptr<GrpcChannelCache> channel_cache(NewGrpcChannelCache(
+      channel_spec, GetChannelCreationFunction(),
+      options.rpc_options != nullptr ? *options.rpc_options : RPCOptions()));
 
   string name_prefix = strings::StrCat("/job:", *options.job_name, "/replica:0",
                                        "/task:", options.task_index);
@@ -510,6 +511,20 @@ std::shared_ptr<::grpc::ServerCredentials> GrpcServer::GetServerCredentials(
 }
 
 ChannelCreationFunction GrpcServer::GetChannelCreationFunction() const {
+  const int num_channels_per_target =
+      server_def().default_session_config().rpc_options()
+          .num_channels_per_target();
+  if (num_channels_per_target > 1) {
+    // Channels to the same target must not share a connection, otherwise
+    // striping RPCs across them gains nothing.
+    RPCOptions rpc_options;
+    rpc_options.set_num_channels_per_target(num_channels_per_target);
+    return ConvertToChannelCreationFunction(
+        [rpc_options](string target, const RPCOptions*,
+                      SharedGrpcChannelPtr* channel_pointer) {
+          return NewHostPortGrpcChannel(target, &rpc_options, channel_pointer);
+        });
+  }
   // We can do this because SparseGrpcChannelCache is robust to nullptr being
   // returned by the channel creation function
   return ConvertToChannelCreationFunction(NewHostPortGrpcChannel);
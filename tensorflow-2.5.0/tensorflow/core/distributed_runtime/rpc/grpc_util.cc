@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/lib/random/random.h"
 
 namespace tensorflow {
@@ -31,8 +32,51 @@ double GenerateUniformRandomNumberBetween(double a, double b) {
   return a + GenerateUniformRandomNumber() * (b - a);
 }
 
+// A TensorBuffer that points into a received gRPC slice and holds a
+// reference to it.
+class GrpcSliceTensorBuffer : public TensorBuffer {
+ public:
+  GrpcSliceTensorBuffer(const ::grpc::Slice& slice, const char* data,
+                        size_t size)
+      : TensorBuffer(const_cast<char*>(data)), slice_(slice), size_(size) {}
+
+  size_t size() const override { return size_; }
+
+  TensorBuffer* root_buffer() override { return this; }
+
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(static_cast<int64>(size_));
+    proto->set_allocator_name("grpc_slice");
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+
+  // The slice may be shared with gRPC, so its memory must not be forwarded
+  // to kernels that write to their inputs in place.
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const ::grpc::Slice slice_;
+  const size_t size_;
+};
+
 }  // namespace
 
+TensorBuffer* GrpcByteSource::ShareBuffer(const char* data, size_t size) {
+  // If the buffer was compressed, the reader yields decompressed data that
+  // does not live in any slice of buffer_, and nothing is shared.
+  std::vector<::grpc::Slice> slices;
+  if (!buffer_->Dump(&slices).ok()) {
+    return nullptr;
+  }
+  for (const ::grpc::Slice& slice : slices) {
+    const char* begin = reinterpret_cast<const char*>(slice.begin());
+    if (data >= begin && data + size <= begin + slice.size()) {
+      return new GrpcSliceTensorBuffer(slice, data, size);
+    }
+  }
+  return nullptr;
+}
+
 int64 ComputeBackoffMicroseconds(int current_retry_attempt, int64 min_delay,
                                  int64 max_delay) {
   DCHECK_GE(current_retry_attempt, 0);
@@ -40,6 +40,9 @@ int64 ComputeBackoffMicroseconds(int current_retry_attempt,
 
 // Thin wrapper around ::grpc::ProtoBufferReader to give TensorResponse an
 // efficient byte reader from which to decode a RecvTensorResponse.
+//
+// Tensor contents that lie within a single slice of the ByteBuffer are shared
+// with the decoded tensor, which keeps a reference to that slice.
 class GrpcByteSource : public TensorResponse::Source {
  public:
   explicit GrpcByteSource(::grpc::ByteBuffer* buffer) : buffer_(buffer) {}
@@ -53,6 +56,8 @@ class GrpcByteSource : public TensorResponse::Source {
     return stream_;
   }
 
+  TensorBuffer* ShareBuffer(const char* data, size_t size) override;
+
  private:
   void DeleteStream() {
     if (stream_) {
@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/distributed_runtime/graph_mgr.h"
 #include "tensorflow/core/distributed_runtime/rendezvous_mgr_interface.h"
+#include "tensorflow/core/distributed_runtime/rendezvous_transport.h"
 #include "tensorflow/core/distributed_runtime/rpc/async_service_interface.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_call.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_response_cache.h"
@@ -147,6 +148,7 @@ class GrpcWorkerServiceThread {
     SETUP_FOR_REQUEST(RunGraph, 100, true);
     SETUP_FOR_REQUEST(CleanupGraph, 100, false);
     SETUP_FOR_REQUEST(MarkRecvFinished, 10, false);
+    SETUP_FOR_REQUEST(RecvTensors, 100, true);
 
     // TODO(ncteisen): Determine a better policy for enqueuing the
     // appropriate number of each request type.
@@ -300,6 +302,25 @@ class GrpcWorkerServiceThread {
     ENQUEUE_REQUEST(RecvBuf, true);
   }
 
+  void RecvTensorsHandler(
+      WorkerCall<RecvTensorsRequest, RecvTensorsResponse>* call) {
+    Schedule([this, call]() {
+      CallOptions* call_opts = new CallOptions;
+      call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
+      worker_->RecvTensorsAsync(
+          call_opts, &call->request, &call->response,
+          [call, call_opts](const Status& s) {
+            call->ClearCancelCallback();
+            delete call_opts;
+            if (!s.ok()) {
+              VLOG(3) << "Bad response from RecvTensors:" << s;
+            }
+            call->SendResponse(ToGrpcStatus(s));
+          });
+    });
+    ENQUEUE_REQUEST(RecvTensors, true);
+  }
+
   void CompleteGroupHandler(
       WorkerCall<CompleteGroupRequest, CompleteGroupResponse>* call) {
     Schedule([this, call]() {
@@ -416,6 +437,27 @@ class GrpcWorkerService : public AsyncServiceInterface {
   TF_DISALLOW_COPY_AND_ASSIGN(GrpcWorkerService);
 };
 
+// If the receiver offered a rendezvous transport in `request_options` and
+// this process uses a compatible one, sends the contents of `val` through it
+// and encodes the rest of the RecvTensorResponse into `*result`. Returns false
+// if the tensor must be encoded into the response instead.
+bool MaybeEncodeTensorOutOfBand(const protobuf::Any& request_options,
+                                bool is_dead, const Tensor& val,
+                                bool require_ack, ::grpc::ByteBuffer* result) {
+  if (is_dead || request_options.type_url().empty()) return false;
+  RendezvousTransport* transport = RendezvousTransportRegistry::Default();
+  if (transport == nullptr) return false;
+  RecvTensorResponse response;
+  if (!transport->Send(request_options, val,
+                       response.mutable_transport_options())) {
+    return false;
+  }
+  response.set_require_ack(require_ack);
+  response.set_send_start_micros(Env::Default()->NowMicros());
+  grpc::EncodeRecvTensorResponseToByteBuffer(response, result);
+  return true;
+}
+
 }  // namespace
 
 GrpcWorker::GrpcWorker(WorkerEnv* worker_env, const ConfigProto& config)
@@ -447,10 +489,13 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
 
   bool cache_enabled = (response_cache_ != nullptr && request_id != 0);
 
-  auto do_response = [response, done, cache_enabled](const Tensor& tensor,
-                                                     bool is_dead,
-                                                     const Status& status) {
-    if (status.ok()) {
+  auto do_response = [response, done, cache_enabled,
+                      transport_options = request->transport_options()](
+                         const Tensor& tensor, bool is_dead,
+                         const Status& status) {
+    if (status.ok() &&
+        !MaybeEncodeTensorOutOfBand(transport_options, is_dead, tensor,
+                                    cache_enabled, response)) {
       grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled, response);
     }
     done(status);
@@ -555,6 +600,117 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
       });
 }
 
+void GrpcWorker::RecvTensorsAsync(CallOptions* opts,
+                                  const RecvTensorsRequest* request,
+                                  RecvTensorsResponse* response,
+                                  StatusCallback done) {
+  VLOG(3) << "RecvTensorsAsync req: " << request->DebugString();
+  const int64 step_id = request->step_id();
+  const int num_keys = request->rendezvous_key_size();
+  for (int i = 0; i < num_keys; ++i) {
+    response->add_result();
+  }
+
+  // The receives of the tensors can finish after the response was sent, when
+  // they outlast `max_wait_micros`.
+  struct State {
+    mutex mu;
+    bool responded TF_GUARDED_BY(mu) = false;
+    int num_pending TF_GUARDED_BY(mu) = 0;
+  };
+  auto state = std::make_shared<State>();
+  {
+    mutex_lock l(state->mu);
+    state->num_pending = num_keys;
+  }
+  // Sends the response once all tensors are received, or when `expired`.
+  auto maybe_respond = [state, done](bool expired) {
+    {
+      mutex_lock l(state->mu);
+      if (state->responded || (state->num_pending > 0 && !expired)) return;
+      state->responded = true;
+    }
+    done(Status::OK());
+  };
+
+  for (int i = 0; i < num_keys; ++i) {
+    const string& key = request->rendezvous_key(i);
+    RecvTensorsResponse::Result* result = response->mutable_result(i);
+    TRACEPRINTF("RecvTensors: %lld %s", step_id, key.c_str());
+    Rendezvous::ParsedKey parsed;
+    Status s = Rendezvous::ParseKey(key, &parsed);
+    Device* src_dev = nullptr;
+    if (s.ok()) {
+      s = PrepareRecvTensor(parsed, &src_dev);
+    }
+    if (!s.ok()) {
+      {
+        mutex_lock l(state->mu);
+        result->set_ready(true);
+        result->set_status_code(s.code());
+        result->set_status_error_message(s.error_message());
+        --state->num_pending;
+      }
+      continue;
+    }
+    env_->rendezvous_mgr->RecvLocalAsync(
+        step_id, parsed,
+        [this, state, result, step_id, parsed, src_dev, maybe_respond](
+            const Status& status, const Rendezvous::Args& send_args,
+            const Rendezvous::Args& recv_args, const Tensor& val,
+            const bool is_dead) {
+          // Tensors on accelerators are left to RecvTensor, which copies
+          // them to the host.
+          const bool needs_copy = src_dev->tensorflow_gpu_device_info() &&
+                                  !send_args.alloc_attrs.on_host();
+          bool responded;
+          {
+            mutex_lock l(state->mu);
+            responded = state->responded;
+            if (!responded) {
+              if (!status.ok() || !needs_copy) {
+                result->set_ready(true);
+                result->set_status_code(status.code());
+                result->set_status_error_message(status.error_message());
+              }
+              if (status.ok() && !needs_copy) {
+                RecvTensorResponse* tensor_response =
+                    result->mutable_response();
+                if (!is_dead) {
+                  val.AsProtoTensorContent(tensor_response->mutable_tensor());
+                }
+                tensor_response->set_is_dead(is_dead);
+                tensor_response->set_send_start_micros(
+                    Env::Default()->NowMicros());
+              }
+              --state->num_pending;
+            }
+          }
+          if (status.ok() && (responded || needs_copy)) {
+            // Send the tensor again, for the RecvTensor call of the receiver.
+            RemoteRendezvous* rendezvous = env_->rendezvous_mgr->Find(step_id);
+            Status s = rendezvous->Send(parsed, send_args, val, is_dead);
+            rendezvous->Unref();
+            if (!s.ok()) {
+              VLOG(1) << "Failed to resend " << parsed.FullKey() << ": " << s;
+            }
+          }
+          if (!responded) {
+            maybe_respond(/*expired=*/false);
+          }
+        });
+  }
+  maybe_respond(/*expired=*/false);
+  if (request->max_wait_micros() > 0) {
+    env_->env->SchedClosureAfter(request->max_wait_micros(),
+                                 [maybe_respond]() {
+                                   maybe_respond(/*expired=*/true);
+                                 });
+  } else {
+    maybe_respond(/*expired=*/true);
+  }
+}
+
 namespace {
 // If RecvBufRespExtra.tensor_content is a single large string, then gRPC
 // can stall on the recv side when the string buffer needs to be enlarged,
@@ -15,12 +15,15 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <map>
 #include <unordered_set>
+#include <utility>
 
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/distributed_runtime/rendezvous_transport.h"
 #include "tensorflow/core/distributed_runtime/request_id.h"
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
@@ -33,15 +36,55 @@ limitations under the License.
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
 namespace {
 
+class RpcRecvTensorsCall;
+
+struct RecvTensorsBatchOptions {
+  // If positive, set by TF_RPC_RECV_TENSORS_BATCH_WINDOW_USECS, the receives
+  // from the same worker that start within that time are sent in one
+  // RecvTensors call.
+  int64 window_micros = 0;
+  // How long the sender waits for the tensors of a batch, set by
+  // TF_RPC_RECV_TENSORS_MAX_WAIT_USECS. The tensors that are not sent by then
+  // are received with RecvTensor calls of their own.
+  int64 max_wait_micros = 0;
+  // The number of receives after which a batch is sent before the end of its
+  // window, set by TF_RPC_RECV_TENSORS_MAX_BATCH_SIZE.
+  int64 max_batch_size = 0;
+};
+
+RecvTensorsBatchOptions ReadRecvTensorsBatchOptions() {
+  RecvTensorsBatchOptions options;
+  Status status = ReadInt64FromEnvVar("TF_RPC_RECV_TENSORS_BATCH_WINDOW_USECS",
+                                      /*default_val=*/0,
+                                      &options.window_micros);
+  if (!status.ok()) {
+    LOG(ERROR) << status.error_message();
+  }
+  status = ReadInt64FromEnvVar("TF_RPC_RECV_TENSORS_MAX_WAIT_USECS",
+                               /*default_val=*/10000,
+                               &options.max_wait_micros);
+  if (!status.ok()) {
+    LOG(ERROR) << status.error_message();
+  }
+  status = ReadInt64FromEnvVar("TF_RPC_RECV_TENSORS_MAX_BATCH_SIZE",
+                               /*default_val=*/256, &options.max_batch_size);
+  if (!status.ok()) {
+    LOG(ERROR) << status.error_message();
+  }
+  return options;
+}
+
 class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  public:
   RpcRemoteRendezvous(const WorkerEnv* env, int64 step_id)
-      : BaseRemoteRendezvous(env, step_id) {}
+      : BaseRemoteRendezvous(env, step_id),
+        batch_options_(ReadRecvTensorsBatchOptions()) {}
 
  protected:
   void RecvFromRemoteAsync(const Rendezvous::ParsedKey& parsed,
@@ -51,6 +94,31 @@ class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  private:
   ~RpcRemoteRendezvous() override {}
 
+  // Receives the tensor of `parsed` with its own RecvTensor call.
+  void RecvTensorFromRemoteAsync(const Rendezvous::ParsedKey& parsed,
+                                 const Rendezvous::Args& args,
+                                 DoneCallback done);
+
+  // Adds the receive to the batch of its source worker, see
+  // RpcRecvTensorsCall.
+  void AddToRecvTensorsBatch(const string& src_worker,
+                             const Rendezvous::ParsedKey& parsed,
+                             const Rendezvous::Args& args, DoneCallback done);
+
+  // Sends the RecvTensors call of `call` and deletes it once its receives are
+  // done.
+  void StartRecvTensorsCall(RpcRecvTensorsCall* call);
+  void FinishRecvTensorsCall(RpcRecvTensorsCall* call);
+
+  const RecvTensorsBatchOptions batch_options_;
+
+  // The batches that wait for their window to end, by source worker and
+  // cancellation manager.
+  typedef std::pair<string, CancellationManager*> RecvTensorsBatchKey;
+  mutex batches_mu_;
+  std::map<RecvTensorsBatchKey, RpcRecvTensorsCall*> batches_
+      TF_GUARDED_BY(batches_mu_);
+
   TF_DISALLOW_COPY_AND_ASSIGN(RpcRemoteRendezvous);
 };
 
@@ -70,6 +138,14 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     req_.set_step_id(step_id);
     req_.set_rendezvous_key(key.data(), key.size());
     req_.set_request_id(GetUniqueRequestId());
+    // Out-of-band transports deliver host memory tensors only, see
+    // TensorResponse::InitAlloc().
+    RendezvousTransport* transport = RendezvousTransportRegistry::Default();
+    if (transport != nullptr &&
+        (alloc_attrs.on_host() ||
+         dst_device->attributes().device_type() == "CPU")) {
+      transport->OfferRecv(alloc_attrs, req_.mutable_transport_options());
+    }
   }
 
   void Reset() {
@@ -84,6 +160,7 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     // opts_ appropriately.
     req_.Clear();
     resp_.Clear();
+    out_of_band_tensor_ = Tensor();
     {
       mutex_lock l(mu_);
       status_ = Status::OK();
@@ -123,7 +200,10 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     wi_ = nullptr;
   }
 
-  const Tensor& tensor() const { return resp_.tensor(); }
+  const Tensor& tensor() const {
+    return resp_.metadata().has_transport_options() ? out_of_band_tensor_
+                                                    : resp_.tensor();
+  }
 
   bool is_dead() const { return resp_.metadata().is_dead(); }
 
@@ -143,9 +223,19 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
       // Make sure the Rendezvous abort checking is finished before running the
       // callback, which might destroy the current call object.
       abort_checked->WaitForNotification();
-      if (!s.ok()) {
+      Status status = s;
+      if (status.ok() && resp_.metadata().has_transport_options()) {
+        // The sender delivered the tensor contents out of band.
+        RendezvousTransport* transport =
+            RendezvousTransportRegistry::Default();
+        status = transport != nullptr
+                     ? transport->Receive(resp_.metadata().transport_options(),
+                                          &out_of_band_tensor_)
+                     : errors::Internal("Unexpected transport options");
+      }
+      if (!status.ok()) {
         mutex_lock l(mu_);
-        status_.Update(s);
+        status_.Update(status);
       }
       recv_done();
     };
@@ -176,6 +266,8 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
   CallOptions opts_;
   RecvTensorRequest req_;
   TensorResponse resp_;
+  // Set if the sender used the rendezvous transport offered in req_.
+  Tensor out_of_band_tensor_;
   Rendezvous::Args recv_args_;
   Rendezvous::DoneCallback done_;
 
@@ -230,10 +322,252 @@ static RpcRecvTensorFreeList* get_call_freelist() {
   return call_freelist;
 }
 
+// Used to retrieve several tensors from the same remote worker in one
+// RecvTensors call. The tensors are decoded from the response proto, so only
+// receives into host memory are batched.
+class RpcRecvTensorsCall : public BaseRecvTensorCall {
+ public:
+  struct Recv {
+    Rendezvous::ParsedKey parsed;
+    Rendezvous::Args recv_args;
+    Rendezvous::DoneCallback done;
+  };
+
+  RpcRecvTensorsCall(const string& src_worker, int64 step_id,
+                     int64 max_wait_micros)
+      : src_worker_(src_worker), wi_(nullptr) {
+    req_.set_step_id(step_id);
+    req_.set_max_wait_micros(max_wait_micros);
+  }
+
+  ~RpcRecvTensorsCall() override {
+    CHECK_EQ(static_cast<WorkerInterface*>(nullptr), wi_)
+        << "Leaking WorkerInterface in RpcRecvTensorsCall destructor.";
+  }
+
+  void Add(const Rendezvous::ParsedKey& parsed,
+           const Rendezvous::Args& recv_args, Rendezvous::DoneCallback done) {
+    const StringPiece key = parsed.FullKey();
+    req_.add_rendezvous_key(key.data(), key.size());
+    recvs_.push_back({parsed, recv_args, std::move(done)});
+  }
+
+  int size() const { return recvs_.size(); }
+  const string& src_worker() const { return src_worker_; }
+  // The receives of a call share their cancellation manager.
+  const Rendezvous::Args& recv_args() const { return recvs_[0].recv_args; }
+  std::vector<Recv>* mutable_recvs() { return &recvs_; }
+  const RecvTensorsResponse& response() const { return resp_; }
+
+  void SetWorker(WorkerInterface* wi) { wi_ = wi; }
+
+  void ReleaseWorker(WorkerCacheInterface* worker_cache) {
+    DCHECK_NE(static_cast<WorkerInterface*>(nullptr), wi_)
+        << "RpcRecvTensorsCall::ReleaseWorker() called twice.";
+    worker_cache->ReleaseWorker(src_worker_, wi_);
+    wi_ = nullptr;
+  }
+
+  void Start(std::function<void()> recv_done) override {
+    auto abort_checked = std::make_shared<Notification>();
+    auto cb = [this, abort_checked,
+               recv_done = std::move(recv_done)](const Status& s) {
+      abort_checked->WaitForNotification();
+      if (!s.ok()) {
+        mutex_lock l(mu_);
+        status_.Update(s);
+      }
+      recv_done();
+    };
+    wi_->RecvTensorsAsync(&opts_, &req_, &resp_, std::move(cb));
+
+    // Check for an abort that raced with sending the call, as in
+    // RpcRecvTensorCall::StartRTCall().
+    Status s;
+    {
+      mutex_lock l(mu_);
+      s = status_;
+    }
+    if (!s.ok()) {
+      opts_.StartCancel();
+    }
+    abort_checked->Notify();
+  }
+
+  void StartAbort(const Status& s) override {
+    {
+      mutex_lock l(mu_);
+      status_.Update(s);
+    }
+    opts_.StartCancel();
+  }
+
+  Status status() const override {
+    mutex_lock l(mu_);
+    return status_;
+  }
+
+ private:
+  const string src_worker_;
+  WorkerInterface* wi_;  // Not owned.
+  CallOptions opts_;
+  RecvTensorsRequest req_;
+  RecvTensorsResponse resp_;
+  std::vector<Recv> recvs_;
+
+  mutable mutex mu_;
+  Status status_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(RpcRecvTensorsCall);
+};
+
 void RpcRemoteRendezvous::RecvFromRemoteAsync(
     const Rendezvous::ParsedKey& parsed, const Rendezvous::Args& recv_args,
     DoneCallback done) {
   CHECK(is_initialized());
+  string src_worker;
+  string src_rel_device;
+  if (batch_options_.window_micros > 0 &&
+      (recv_args.alloc_attrs.on_host() || parsed.dst.type == DEVICE_CPU) &&
+      DeviceNameUtils::SplitDeviceName(parsed.src_device, &src_worker,
+                                       &src_rel_device)) {
+    AddToRecvTensorsBatch(src_worker, parsed, recv_args, std::move(done));
+    return;
+  }
+  RecvTensorFromRemoteAsync(parsed, recv_args, std::move(done));
+}
+
+void RpcRemoteRendezvous::AddToRecvTensorsBatch(
+    const string& src_worker, const Rendezvous::ParsedKey& parsed,
+    const Rendezvous::Args& recv_args, DoneCallback done) {
+  const RecvTensorsBatchKey key(src_worker, recv_args.cancellation_manager);
+  RpcRecvTensorsCall* full_call = nullptr;
+  {
+    mutex_lock l(batches_mu_);
+    RpcRecvTensorsCall*& call = batches_[key];
+    if (call == nullptr) {
+      call = new RpcRecvTensorsCall(src_worker, step_id_,
+                                    batch_options_.max_wait_micros);
+      // Send the batch at the end of its window, unless it is full before.
+      Ref();
+      env_->env->SchedClosureAfter(
+          batch_options_.window_micros, [this, key, batch = call]() {
+            RpcRecvTensorsCall* expired_call = nullptr;
+            {
+              mutex_lock l(batches_mu_);
+              auto it = batches_.find(key);
+              if (it != batches_.end() && it->second == batch) {
+                expired_call = batch;
+                batches_.erase(it);
+              }
+            }
+            if (expired_call != nullptr) {
+              StartRecvTensorsCall(expired_call);
+            }
+            Unref();
+          });
+    }
+    call->Add(parsed, recv_args, std::move(done));
+    if (call->size() >= batch_options_.max_batch_size) {
+      full_call = call;
+      batches_.erase(key);
+    }
+  }
+  if (full_call != nullptr) {
+    StartRecvTensorsCall(full_call);
+  }
+}
+
+void RpcRemoteRendezvous::StartRecvTensorsCall(RpcRecvTensorsCall* call) {
+  WorkerSession* sess = session();
+  std::shared_ptr<WorkerCacheInterface> worker_cache =
+      sess->GetSharedWorkerCache();
+  WorkerInterface* rwi = worker_cache->GetOrCreateWorker(call->src_worker());
+  if (rwi == nullptr) {
+    // The RecvTensor calls of the receives report the error.
+    FinishRecvTensorsCall(call);
+    return;
+  }
+  call->SetWorker(rwi);
+
+  // Record "call" in active_ so that it can be aborted cleanly.
+  RegisterCall(call, call->recv_args());
+  if (!call->status().ok()) {
+    DeregisterCall(call);
+    call->ReleaseWorker(sess->worker_cache());
+    FinishRecvTensorsCall(call);
+    return;
+  }
+
+  Ref();
+  call->Start([this, call, worker_cache]() {
+    DeregisterCall(call);
+    call->ReleaseWorker(session()->worker_cache());
+    FinishRecvTensorsCall(call);
+    Unref();
+  });
+}
+
+void RpcRemoteRendezvous::FinishRecvTensorsCall(RpcRecvTensorsCall* call) {
+  Status call_status = call->status();
+  // Workers that do not implement RecvTensors serve the receives one by one.
+  const bool unimplemented = errors::IsUnimplemented(call_status);
+  if (unimplemented) {
+    call_status = Status::OK();
+  }
+  const RecvTensorsResponse& response = call->response();
+  std::vector<RpcRecvTensorsCall::Recv>& recvs = *call->mutable_recvs();
+  const int num_recvs = recvs.size();
+  std::vector<Status> statuses(num_recvs, call_status);
+  std::vector<Tensor> tensors(num_recvs);
+  std::vector<bool> is_dead(num_recvs, false);
+  std::vector<bool> ready(num_recvs, false);
+  for (int i = 0; i < num_recvs; ++i) {
+    if (!call_status.ok()) {
+      ready[i] = true;
+      continue;
+    }
+    if (unimplemented || i >= response.result_size() ||
+        !response.result(i).ready()) {
+      continue;
+    }
+    const RecvTensorsResponse::Result& result = response.result(i);
+    ready[i] = true;
+    statuses[i] = Status(result.status_code(), result.status_error_message());
+    is_dead[i] = result.response().is_dead();
+    if (!statuses[i].ok() || is_dead[i]) continue;
+    Device* dst_device;
+    statuses[i] =
+        session()->device_mgr()->LookupDevice(recvs[i].parsed.dst_device,
+                                              &dst_device);
+    if (statuses[i].ok() &&
+        !tensors[i].FromProto(
+            dst_device->GetAllocator(recvs[i].recv_args.alloc_attrs),
+            result.response().tensor())) {
+      statuses[i] = errors::Internal("Invalid tensor received for ",
+                                     recvs[i].parsed.FullKey());
+    }
+  }
+  // Start the RecvTensor calls first, since `*session()` can be deleted
+  // once the callbacks run.
+  for (int i = 0; i < num_recvs; ++i) {
+    if (!ready[i]) {
+      RecvTensorFromRemoteAsync(recvs[i].parsed, recvs[i].recv_args,
+                                std::move(recvs[i].done));
+    }
+  }
+  for (int i = 0; i < num_recvs; ++i) {
+    if (ready[i]) {
+      recvs[i].done(statuses[i], Args(), recvs[i].recv_args, tensors[i],
+                    is_dead[i]);
+    }
+  }
+  delete call;
+}
+
+void RpcRemoteRendezvous::RecvTensorFromRemoteAsync(
+    const Rendezvous::ParsedKey& parsed, const Rendezvous::Args& recv_args,
+    DoneCallback done) {
   Status s;
 
   // Prepare a RecvTensor call that can handle being aborted.
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <atomic>
+
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/distributed_runtime/test_utils.h"
 #include "tensorflow/core/framework/cancellation.h"
@@ -66,20 +68,39 @@ class DummyWorker : public TestWorkerInterface {
       done(Status::OK());
     });
   }
+
+  // Returns the first tensor of the batch as a dead tensor, and lets the
+  // caller receive the others with RecvTensor.
+  void RecvTensorsAsync(CallOptions* opts, const RecvTensorsRequest* request,
+                        RecvTensorsResponse* response,
+                        StatusCallback done) override {
+    ++num_recv_tensors_calls;
+    for (int i = 0; i < request->rendezvous_key_size(); ++i) {
+      RecvTensorsResponse::Result* result = response->add_result();
+      if (i == 0) {
+        result->set_ready(true);
+        result->mutable_response()->set_is_dead(true);
+      }
+    }
+    SchedClosure([done = std::move(done)]() { done(Status::OK()); });
+  }
+
+  std::atomic<int> num_recv_tensors_calls{0};
 };
 
 // Fake cache implementation for WorkerEnv.
 class DummyWorkerCache : public WorkerCacheInterface {
+ public:
   void ListWorkers(std::vector<string>* workers) const override {}
   void ListWorkersInJob(const string& job_name,
                         std::vector<string>* workers) const override {}
   WorkerInterface* GetOrCreateWorker(const string& target) override {
     if (dummy_remote_worker_ == nullptr) {
-      // Ownership transferred to WorkerFreeList
-      dummy_remote_worker_ = new DummyWorker;
+      dummy_remote_worker_.reset(new DummyWorker);
     }
-    return dummy_remote_worker_;
+    return dummy_remote_worker_.get();
   }
+  void ReleaseWorker(const string& target, WorkerInterface* worker) override {}
   Status GetEagerClientCache(
       std::unique_ptr<eager::EagerClientCache>* eager_client_cache) override {
     return errors::Unimplemented("Unimplemented.");
@@ -91,8 +112,10 @@ class DummyWorkerCache : public WorkerCacheInterface {
   void GetDeviceLocalityAsync(const string& device, DeviceLocality* locality,
                               StatusCallback done) override {}
 
+  DummyWorker* dummy_remote_worker() { return dummy_remote_worker_.get(); }
+
  private:
-  DummyWorker* dummy_remote_worker_ = nullptr;
+  std::unique_ptr<DummyWorker> dummy_remote_worker_;
 };
 
 static Device* CreateDevice(const char* type, const char* name) {
@@ -344,4 +367,53 @@ TEST_F(RpcRendezvousMgrTest, RemoteRecvAsyncMany) {
   rmgr_.Cleanup(step_id);
 }
 
+TEST_F(RpcRendezvousMgrTest, RemoteRecvBatched) {
+  setenv("TF_RPC_RECV_TENSORS_BATCH_WINDOW_USECS", "1000", 1);
+  setenv("TF_RPC_RECV_TENSORS_MAX_BATCH_SIZE", "2", 1);
+  const int64 step_id = 123;
+  const Rendezvous::ParsedKey key_a = MakeKey(Rendezvous::CreateKey(
+      "/job:worker/replica:1/task:2/cpu:0", 7890,
+      "/job:mnist/replica:1/task:2/cpu:1", "a", FrameAndIter(0, 0)));
+  const Rendezvous::ParsedKey key_b = MakeKey(Rendezvous::CreateKey(
+      "/job:worker/replica:1/task:2/cpu:0", 7890,
+      "/job:mnist/replica:1/task:2/cpu:1", "b", FrameAndIter(0, 0)));
+  {
+    RemoteRendezvous* rendez = rmgr_.Find(step_id);
+    TF_ASSERT_OK(rendez->Initialize(&worker_session_));
+    core::ScopedUnref unref(rendez);
+    unsetenv("TF_RPC_RECV_TENSORS_BATCH_WINDOW_USECS");
+    unsetenv("TF_RPC_RECV_TENSORS_MAX_BATCH_SIZE");
+    Rendezvous::Args args;
+
+    // "a" is received by the batch, and "b" with its own RecvTensor call.
+    BlockingCounter counter(2);
+    Status status_a, status_b;
+    bool is_dead_a = false;
+    bool is_dead_b = true;
+    rendez->RecvAsync(key_a, args,
+                      [&](const Status& s, const Rendezvous::Args&,
+                          const Rendezvous::Args&, const Tensor&,
+                          const bool is_dead) {
+                        status_a = s;
+                        is_dead_a = is_dead;
+                        counter.DecrementCount();
+                      });
+    rendez->RecvAsync(key_b, args,
+                      [&](const Status& s, const Rendezvous::Args&,
+                          const Rendezvous::Args&, const Tensor&,
+                          const bool is_dead) {
+                        status_b = s;
+                        is_dead_b = is_dead;
+                        counter.DecrementCount();
+                      });
+    counter.Wait();
+    TF_ASSERT_OK(status_a);
+    TF_ASSERT_OK(status_b);
+    EXPECT_TRUE(is_dead_a);
+    EXPECT_FALSE(is_dead_b);
+    EXPECT_EQ(1, cache_->dummy_remote_worker()->num_recv_tensors_calls);
+  }
+  rmgr_.Cleanup(step_id);
+}
+
 }  // namespace tensorflow
@@ -0,0 +1,261 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/shared_memory_transport.h"
+
+#include "tensorflow/core/platform/platform.h"
+
+#if !defined(PLATFORM_WINDOWS)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/protobuf/transport_options.pb.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Segments that have not been mapped by their receivers after this long are
+// unlinked by the sender.
+constexpr uint64 kSegmentLifetimeMicros = 5 * 60 * 1000 * 1000;
+
+#if !defined(PLATFORM_WINDOWS)
+
+// A TensorBuffer over a mapped shared memory object, unmapped when the last
+// reference goes away.
+class MappedTensorBuffer : public TensorBuffer {
+ public:
+  MappedTensorBuffer(void* data, size_t size)
+      : TensorBuffer(data), size_(size) {}
+  ~MappedTensorBuffer() override { munmap(data(), size_); }
+
+  size_t size() const override { return size_; }
+
+  TensorBuffer* root_buffer() override { return this; }
+
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(static_cast<int64>(size_));
+    proto->set_allocator_name("shared_memory");
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+
+  // The memory was not obtained from an Allocator.
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const size_t size_;
+};
+
+#endif  // !defined(PLATFORM_WINDOWS)
+
+}  // namespace
+
+SharedMemoryTransport::SharedMemoryTransport(int64 min_bytes)
+    : min_bytes_(std::max<int64>(min_bytes, 1)) {
+#if !defined(PLATFORM_WINDOWS)
+  string name = absl::StrCat("/tf_rendezvous_probe_", getpid(), "_",
+                             random::New64());
+  int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    LOG(WARNING) << "Cannot create shared memory object " << name
+                 << "; tensors will not be received through shared memory: "
+                 << strerror(errno);
+    return;
+  }
+  close(fd);
+  probe_name_ = std::move(name);
+#endif
+}
+
+SharedMemoryTransport::~SharedMemoryTransport() {
+#if !defined(PLATFORM_WINDOWS)
+  if (!probe_name_.empty()) shm_unlink(probe_name_.c_str());
+  mutex_lock l(mu_);
+  UnlinkSegmentsSentBefore(kuint64max);
+#endif
+}
+
+bool SharedMemoryTransport::OfferRecv(const AllocatorAttributes& alloc_attrs,
+                                      protobuf::Any* options) {
+  // Mapped memory can't be handed to DMA engines that need pinned memory.
+  if (probe_name_.empty() || alloc_attrs.gpu_compatible() ||
+      alloc_attrs.nic_compatible()) {
+    return false;
+  }
+  SharedMemoryRecvTensorRequest request;
+  request.set_probe_name(probe_name_);
+  request.set_min_bytes(min_bytes_);
+  options->PackFrom(request);
+  return true;
+}
+
+bool SharedMemoryTransport::CanOpenProbe(const string& probe_name) {
+#if defined(PLATFORM_WINDOWS)
+  return false;
+#else
+  {
+    mutex_lock l(mu_);
+    auto it = probe_results_.find(probe_name);
+    if (it != probe_results_.end()) return it->second;
+  }
+  int fd = shm_open(probe_name.c_str(), O_RDONLY, 0);
+  const bool result = fd >= 0;
+  if (result) close(fd);
+  mutex_lock l(mu_);
+  probe_results_[probe_name] = result;
+  return result;
+#endif
+}
+
+bool SharedMemoryTransport::Send(const protobuf::Any& request_options,
+                                 const Tensor& tensor,
+                                 protobuf::Any* response_options) {
+#if defined(PLATFORM_WINDOWS)
+  return false;
+#else
+  SharedMemoryRecvTensorRequest request;
+  if (!request_options.UnpackTo(&request) ||
+      !DataTypeCanUseMemcpy(tensor.dtype())) {
+    return false;
+  }
+  const StringPiece data = tensor.tensor_data();
+  if (data.size() < std::max<int64>(request.min_bytes(), 1) ||
+      !CanOpenProbe(request.probe_name())) {
+    return false;
+  }
+
+  string name;
+  {
+    mutex_lock l(mu_);
+    const uint64 now = Env::Default()->NowMicros();
+    if (now > kSegmentLifetimeMicros) {
+      UnlinkSegmentsSentBefore(now - kSegmentLifetimeMicros);
+    }
+    name = absl::StrCat("/tf_rendezvous_", getpid(), "_", next_segment_id_++,
+                        "_", random::New64());
+  }
+  int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    VLOG(1) << "Cannot create shared memory object " << name << ": "
+            << strerror(errno);
+    return false;
+  }
+  void* dst = MAP_FAILED;
+  if (ftruncate(fd, data.size()) == 0) {
+    dst = mmap(nullptr, data.size(), PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (dst == MAP_FAILED) {
+    VLOG(1) << "Cannot map shared memory object " << name << ": "
+            << strerror(errno);
+    shm_unlink(name.c_str());
+    return false;
+  }
+  memcpy(dst, data.data(), data.size());
+  munmap(dst, data.size());
+
+  SharedMemoryRecvTensorResponse response;
+  response.set_segment_name(name);
+  response.set_dtype(tensor.dtype());
+  tensor.shape().AsProto(response.mutable_tensor_shape());
+  response_options->PackFrom(response);
+
+  mutex_lock l(mu_);
+  sent_segments_.emplace_back(Env::Default()->NowMicros(), std::move(name));
+  return true;
+#endif
+}
+
+Status SharedMemoryTransport::Receive(const protobuf::Any& response_options,
+                                      Tensor* tensor) {
+  SharedMemoryRecvTensorResponse response;
+  if (!response_options.UnpackTo(&response)) {
+    return errors::Internal("Unexpected transport options in response: ",
+                            response_options.type_url());
+  }
+#if defined(PLATFORM_WINDOWS)
+  return errors::Unimplemented("Shared memory transport is not supported");
+#else
+  const string& name = response.segment_name();
+  int fd = shm_open(name.c_str(), O_RDWR, 0);
+  if (fd < 0) {
+    return errors::Unavailable("Cannot open shared memory object ", name,
+                               ": ", strerror(errno));
+  }
+  shm_unlink(name.c_str());
+
+  Status s = TensorShape::IsValidShape(response.tensor_shape());
+  const TensorShape shape =
+      s.ok() ? TensorShape(response.tensor_shape()) : TensorShape();
+  if (s.ok() && !DataTypeCanUseMemcpy(response.dtype())) {
+    s = errors::Internal("Unexpected dtype in shared memory object ", name);
+  }
+  const size_t num_bytes =
+      shape.num_elements() * DataTypeSize(response.dtype());
+  struct stat st;
+  if (s.ok() && (fstat(fd, &st) != 0 ||
+                 static_cast<size_t>(st.st_size) != num_bytes)) {
+    s = errors::Internal("Shared memory object ", name, " does not hold ",
+                         num_bytes, " bytes");
+  }
+  void* data = MAP_FAILED;
+  if (s.ok()) {
+    data = mmap(nullptr, num_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+      s = errors::Internal("Cannot map shared memory object ", name, ": ",
+                           strerror(errno));
+    }
+  }
+  close(fd);
+  if (!s.ok()) return s;
+
+  TensorBuffer* buf = new MappedTensorBuffer(data, num_bytes);
+  *tensor = Tensor(response.dtype(), shape, buf);
+  buf->Unref();
+  return Status::OK();
+#endif
+}
+
+void SharedMemoryTransport::UnlinkSegmentsSentBefore(uint64 cutoff_micros) {
+#if !defined(PLATFORM_WINDOWS)
+  while (!sent_segments_.empty() &&
+         sent_segments_.front().first < cutoff_micros) {
+    // Fails with ENOENT if the receiver has already unlinked the segment.
+    shm_unlink(sent_segments_.front().second.c_str());
+    sent_segments_.pop_front();
+  }
+#endif
+}
+
+REGISTER_RENDEZVOUS_TRANSPORT("shared_memory", []() {
+  int64 min_bytes;
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_SHARED_MEMORY_TRANSPORT_MIN_BYTES",
+                                  1 << 20, &min_bytes));
+  return absl::make_unique<SharedMemoryTransport>(min_bytes);
+});
+
+}  // namespace tensorflow
@@ -0,0 +1,75 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_SHARED_MEMORY_TRANSPORT_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_SHARED_MEMORY_TRANSPORT_H_
+
+#include <deque>
+#include <unordered_map>
+
+#include "tensorflow/core/distributed_runtime/rendezvous_transport.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// A RendezvousTransport for tasks that run on the same host. The sender
+// copies the tensor contents into a POSIX shared memory object, and the
+// receiver maps that object as the buffer of the received tensor, so the
+// contents never go through the loopback network or the RPC serializer.
+//
+// Registered as "shared_memory". The minimum tensor size is read from
+// TF_SHARED_MEMORY_TRANSPORT_MIN_BYTES and defaults to 1MB.
+//
+// Not available on Windows, where OfferRecv() and Send() always decline.
+class SharedMemoryTransport : public RendezvousTransport {
+ public:
+  // Tensors with fewer than `min_bytes` bytes are sent in the response.
+  explicit SharedMemoryTransport(int64 min_bytes);
+  ~SharedMemoryTransport() override;
+
+  bool OfferRecv(const AllocatorAttributes& alloc_attrs,
+                 protobuf::Any* options) override;
+  bool Send(const protobuf::Any& request_options, const Tensor& tensor,
+            protobuf::Any* response_options) override;
+  Status Receive(const protobuf::Any& response_options,
+                 Tensor* tensor) override;
+
+ private:
+  // Returns true if the receiver's probe object can be opened, i.e. if the
+  // receiver shares our host, IPC namespace and user.
+  bool CanOpenProbe(const string& probe_name);
+
+  // Unlinks the segments that were sent before `cutoff_micros`. Their
+  // receivers have either mapped them already or given up on them.
+  void UnlinkSegmentsSentBefore(uint64 cutoff_micros)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const int64 min_bytes_;
+  // Created by the constructor, empty if that failed.
+  string probe_name_;
+
+  mutex mu_;
+  std::unordered_map<string, bool> probe_results_ TF_GUARDED_BY(mu_);
+  // Segments created by Send(), with their creation times.
+  std::deque<std::pair<uint64, string>> sent_segments_ TF_GUARDED_BY(mu_);
+  int64 next_segment_id_ TF_GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(SharedMemoryTransport);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_SHARED_MEMORY_TRANSPORT_H_
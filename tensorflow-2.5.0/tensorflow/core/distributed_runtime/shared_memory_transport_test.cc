@@ -0,0 +1,89 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/shared_memory_transport.h"
+
+#include "tensorflow/core/distributed_runtime/rendezvous_transport.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/transport_options.pb.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(SharedMemoryTransportTest, RoundTrip) {
+  SharedMemoryTransport receiver(/*min_bytes=*/16);
+  SharedMemoryTransport sender(/*min_bytes=*/16);
+
+  protobuf::Any request_options;
+  ASSERT_TRUE(receiver.OfferRecv(AllocatorAttributes(), &request_options));
+
+  Tensor src(DT_FLOAT, TensorShape({3, 5}));
+  test::FillIota<float>(&src, 1.0f);
+  protobuf::Any response_options;
+  ASSERT_TRUE(sender.Send(request_options, src, &response_options));
+
+  Tensor received;
+  TF_ASSERT_OK(receiver.Receive(response_options, &received));
+  test::ExpectTensorEqual<float>(received, src);
+  EXPECT_NE(received.tensor_data().data(), src.tensor_data().data());
+
+  // The receiver unlinks the segment once it is mapped.
+  Tensor again;
+  EXPECT_TRUE(
+      errors::IsUnavailable(receiver.Receive(response_options, &again)));
+}
+
+TEST(SharedMemoryTransportTest, DeclinesUnsupportedTensors) {
+  SharedMemoryTransport receiver(/*min_bytes=*/16);
+  SharedMemoryTransport sender(/*min_bytes=*/16);
+  protobuf::Any request_options;
+  ASSERT_TRUE(receiver.OfferRecv(AllocatorAttributes(), &request_options));
+  protobuf::Any response_options;
+
+  // Too small.
+  Tensor small(DT_FLOAT, TensorShape({2}));
+  test::FillIota<float>(&small, 1.0f);
+  EXPECT_FALSE(sender.Send(request_options, small, &response_options));
+
+  // Not memcpy-able.
+  Tensor strings(DT_STRING, TensorShape({8}));
+  EXPECT_FALSE(sender.Send(request_options, strings, &response_options));
+
+  // The receiver is not co-located.
+  SharedMemoryRecvTensorRequest remote;
+  remote.set_probe_name("/tf_rendezvous_probe_does_not_exist");
+  protobuf::Any remote_options;
+  remote_options.PackFrom(remote);
+  Tensor large(DT_FLOAT, TensorShape({64}));
+  test::FillIota<float>(&large, 1.0f);
+  EXPECT_FALSE(sender.Send(remote_options, large, &response_options));
+
+  // Memory for DMA engines is never offered.
+  AllocatorAttributes gpu_attrs;
+  gpu_attrs.set_gpu_compatible(true);
+  EXPECT_FALSE(receiver.OfferRecv(gpu_attrs, &request_options));
+}
+
+TEST(SharedMemoryTransportTest, Registered) {
+  EXPECT_NE(RendezvousTransportRegistry::Create("shared_memory"), nullptr);
+  EXPECT_EQ(RendezvousTransportRegistry::Create("no_such_transport"), nullptr);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -25,6 +25,11 @@ namespace tensorflow {
 
 TensorResponse::Source::~Source() {}
 
+TensorBuffer* TensorResponse::Source::ShareBuffer(const char* data,
+                                                  size_t size) {
+  return nullptr;
+}
+
 void TensorResponse::Clear() {
   on_host_ = false;
   device_ = nullptr;
@@ -144,8 +149,41 @@ bool ReadNestedMessage(protobuf::io::CodedInputStream* input,
 
 }  // namespace
 
+// Tensor contents smaller than this are always copied: sharing the source
+// storage would pin the whole received buffer for little gain.
+constexpr int kMinSharedTensorBytes = 1024;
+
+bool TensorResponse::MaybeShareTensorContent(
+    Source* source, protobuf::io::CodedInputStream* input,
+    const TensorProto& tensor_meta, int num_bytes) {
+  // Memory that is handed to DMA engines must come from allocator_.
+  if (num_bytes < kMinSharedTensorBytes || alloc_attrs_.gpu_compatible() ||
+      alloc_attrs_.nic_compatible()) {
+    return false;
+  }
+  // Only share the contents if they are contiguous in the current buffer of
+  // the stream and satisfy the alignment Eigen expects from tensors.
+  const void* data;
+  int size;
+  if (!input->GetDirectBufferPointer(&data, &size) || size < num_bytes ||
+      reinterpret_cast<uintptr_t>(data) % EIGEN_MAX_ALIGN_BYTES != 0) {
+    return false;
+  }
+  TensorShape shape(tensor_meta.tensor_shape());
+  if (shape.num_elements() * DataTypeSize(tensor_meta.dtype()) != num_bytes) {
+    return false;
+  }
+  TensorBuffer* buf =
+      source->ShareBuffer(static_cast<const char*>(data), num_bytes);
+  if (buf == nullptr) return false;
+  tensor_ = Tensor(tensor_meta.dtype(), shape, buf);
+  buf->Unref();
+  return input->Skip(num_bytes);
+}
+
 bool TensorResponse::ParseTensorSubmessage(
-    protobuf::io::CodedInputStream* input, TensorProto* tensor_meta) {
+    Source* source, protobuf::io::CodedInputStream* input,
+    TensorProto* tensor_meta) {
   bool seen_tensor_content = false;
   while (true) {
     auto p = input->ReadTagWithCutoff(127);
@@ -195,13 +233,13 @@ bool TensorResponse::ParseTensorSubmessage(
         int num_bytes;
         if (!ReadVarintSizeAsInt(input, &num_bytes)) return false;
         seen_tensor_content = true;
+        if (MaybeShareTensorContent(source, input, *tensor_meta, num_bytes)) {
+          break;
+        }
         TensorShape shape(tensor_meta->tensor_shape());
         Tensor t(allocator_, tensor_meta->dtype(), shape);
         StringPiece buf = t.tensor_data();
         if (static_cast<size_t>(num_bytes) != buf.size()) return false;
-        // TODO(jeff,sanjay): Figure out a way to avoid this copy if
-        // the underlying ZeroCopyInputStream data is properly aligned
-        // and compatible with what allocator_ wants.
         if (!input->ReadRaw(const_cast<char*>(buf.data()), num_bytes))
           return false;
         tensor_ = std::move(t);
@@ -235,7 +273,7 @@ bool TensorResponse::ParseFast(Source* source) {
         std::pair<protobuf::io::CodedInputStream::Limit, int> p =
             input.IncrementRecursionDepthAndPushLimit(length);
         if (p.second < 0 ||
-            !ParseTensorSubmessage(&input, meta_.mutable_tensor())) {
+            !ParseTensorSubmessage(source, &input, meta_.mutable_tensor())) {
           return false;
         }
         if (!input.DecrementRecursionDepthAndPopLimit(p.first)) {
@@ -64,6 +64,16 @@ class TensorResponse {
     // Ownership of the returned stream is retained by the Source and
     // should not be deleted by the caller.
     virtual ::tensorflow::protobuf::io::ZeroCopyInputStream* contents() = 0;
+
+    // Returns a TensorBuffer that shares the "size" bytes at "data" without
+    // copying them, or nullptr if the source cannot share its storage.
+    // "data" points into a buffer yielded by the stream most recently
+    // returned by contents(). The returned buffer keeps the underlying
+    // storage alive, and the caller owns one reference to it.
+    //
+    // The default implementation returns nullptr, in which case the data
+    // is copied into a freshly allocated buffer.
+    virtual TensorBuffer* ShareBuffer(const char* data, size_t size);
   };
 
   // Parse the RecvTensorResponse encoded in the data yielded by
@@ -92,8 +102,12 @@ class TensorResponse {
   DeviceBase* device() const { return device_; }
 
  private:
-  bool ParseTensorSubmessage(protobuf::io::CodedInputStream* input,
+  bool ParseTensorSubmessage(Source* source,
+                             protobuf::io::CodedInputStream* input,
                              TensorProto* tensor_meta);
+  bool MaybeShareTensorContent(Source* source,
+                               protobuf::io::CodedInputStream* input,
+                               const TensorProto& tensor_meta, int num_bytes);
   bool ParseFast(Source* source);
   bool ParseSlow(Source* source);
 
@@ -15,10 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 
+#include "absl/memory/memory.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
@@ -156,6 +158,87 @@ TEST_F(TensorResponseTest, Simple) {
 
 TEST_F(TensorResponseTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+// A source over caller-owned memory that shares it with the parsed tensor.
+class SharingSource : public TensorResponse::Source {
+ public:
+  SharingSource(const char* data, size_t size, int block_size)
+      : data_(data), size_(size), block_size_(block_size) {}
+
+  protobuf::io::ZeroCopyInputStream* contents() override {
+    stream_ = absl::make_unique<protobuf::io::ArrayInputStream>(
+        data_, size_, block_size_);
+    return stream_.get();
+  }
+
+  TensorBuffer* ShareBuffer(const char* data, size_t size) override {
+    ++num_shared_;
+    return new UnownedBuffer(data, size);
+  }
+
+  int num_shared() const { return num_shared_; }
+
+ private:
+  class UnownedBuffer : public TensorBuffer {
+   public:
+    UnownedBuffer(const char* data, size_t size)
+        : TensorBuffer(const_cast<char*>(data)), size_(size) {}
+    size_t size() const override { return size_; }
+    TensorBuffer* root_buffer() override { return this; }
+    void FillAllocationDescription(
+        AllocationDescription* proto) const override {}
+    bool OwnsMemory() const override { return false; }
+
+   private:
+    const size_t size_;
+  };
+
+  const char* data_;
+  const size_t size_;
+  const int block_size_;
+  std::unique_ptr<protobuf::io::ArrayInputStream> stream_;
+  int num_shared_ = 0;
+};
+
+TEST_F(TensorResponseTest, SharesAlignedContiguousContent) {
+  Tensor src(DT_FLOAT, TensorShape({4, 256}));
+  test::FillIota<float>(&src, 0.0f);
+  RecvTensorResponse proto;
+  proto.set_send_start_micros(123456);
+  src.AsProtoTensorContent(proto.mutable_tensor());
+  string encoded;
+  proto.AppendToString(&encoded);
+  const size_t content_offset = encoded.find(string(src.tensor_data()));
+  ASSERT_NE(content_offset, string::npos);
+
+  // Lay out the encoded response so that the tensor content is aligned, or
+  // deliberately misaligned by one byte.
+  constexpr size_t kAlign = EIGEN_MAX_ALIGN_BYTES;
+  std::vector<char> storage(encoded.size() + 2 * kAlign);
+  char* aligned = storage.data() + kAlign -
+                  reinterpret_cast<uintptr_t>(storage.data()) % kAlign;
+  for (const bool misaligned : {false, true}) {
+    for (const int block_size : {-1, 1000}) {
+      char* base = aligned + (kAlign - content_offset % kAlign) % kAlign +
+                   (misaligned ? 1 : 0);
+      memcpy(base, encoded.data(), encoded.size());
+      SharingSource source(base, encoded.size(), block_size);
+
+      TensorResponse response;
+      DummyDevice cpu_device(Env::Default());
+      response.InitAlloc(&cpu_device, AllocatorAttributes());
+      TF_EXPECT_OK(response.ParseFrom(&source));
+      test::ExpectTensorEqual<float>(response.tensor(), src);
+      EXPECT_EQ(response.metadata().send_start_micros(), 123456);
+
+      // Only contiguous and aligned content is shared instead of copied.
+      const bool shared = !misaligned && block_size == -1;
+      EXPECT_EQ(source.num_shared(), shared ? 1 : 0);
+      EXPECT_EQ(response.tensor().tensor_data().data() == base + content_offset,
+                shared);
+    }
+  }
+}
+
 string MakeFloatTensorTestCase(int num_elems) {
   std::vector<int8> v(num_elems);
   for (int i = 0; i < num_elems; i++) {
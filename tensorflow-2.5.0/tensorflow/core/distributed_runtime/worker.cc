@@ -28,7 +28,10 @@ limitations under the License.
 
 namespace tensorflow {
 
-Worker::Worker(WorkerEnv* env) : env_(env), recent_request_ids_(100000) {
+Worker::Worker(WorkerEnv* env)
+    : env_(env),
+      recent_request_ids_(100000),
+      registered_graphs_(GraphDefCache::CapacityBytesFromEnv()) {
   // Enable log history collection in StatusGroup so that recent warning and
   // error log messages will be attached to the root error status to be
   // forwarded to the master.
@@ -77,9 +80,31 @@ void Worker::RegisterGraphAsync(const RegisterGraphRequest* request,
   } else {
     session = env_->session_mgr->LegacySession();
   }
+  const GraphDef* graph_def = &request->graph_def();
+  std::shared_ptr<const GraphDef> cached_graph_def;
+  const uint64 fingerprint = request->graph_def_fingerprint();
+  if (s.ok() && fingerprint != 0) {
+    if (!request->has_graph_def()) {
+      cached_graph_def = registered_graphs_.Lookup(fingerprint);
+      if (cached_graph_def == nullptr) {
+        response->set_graph_def_required(true);
+        done(Status::OK());
+        return;
+      }
+      graph_def = cached_graph_def.get();
+    } else if (GraphDefCache::Fingerprint(*graph_def) != fingerprint) {
+      // The cache is keyed by the fingerprint alone, so a wrong fingerprint
+      // would later hand this graph to requests for a different one.
+      s = errors::InvalidArgument(
+          "The fingerprint ", fingerprint,
+          " of the RegisterGraph request does not match its graph_def.");
+    } else if (registered_graphs_.Insert(fingerprint, *graph_def)) {
+      response->set_graph_def_cached(true);
+    }
+  }
   if (s.ok()) {
     s = session->graph_mgr()->Register(
-        request->session_handle(), request->graph_def(), session.get(),
+        request->session_handle(), *graph_def, session.get(),
         request->graph_options(), request->debug_options(),
         request->config_proto(), request->collective_graph_key(),
         session->cluster_flr(), response->mutable_graph_handle());
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <unordered_map>
 
+#include "tensorflow/core/distributed_runtime/graph_def_cache.h"
 #include "tensorflow/core/distributed_runtime/graph_mgr.h"
 #include "tensorflow/core/distributed_runtime/partial_run_mgr.h"
 #include "tensorflow/core/distributed_runtime/recent_request_ids.h"
@@ -111,6 +112,8 @@ class Worker : public WorkerInterface {
  protected:
   WorkerEnv* const env_;  // Not owned.
   RecentRequestIds recent_request_ids_;
+  // The graphs registered on this worker, kept across worker sessions.
+  GraphDefCache registered_graphs_;
 
   Status PrepareRecvTensor(const Rendezvous::ParsedKey& parsed,
                            Device** src_dev);
@@ -0,0 +1,142 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/worker.h"
+
+#include <stdlib.h>
+
+#include <memory>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/distributed_runtime/graph_def_cache.h"
+#include "tensorflow/core/distributed_runtime/session_mgr.h"
+#include "tensorflow/core/distributed_runtime/worker_env.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr char kWorkerName[] = "/job:mnist/replica:0/task:0";
+
+GraphDef NoOpGraph(const string& name) {
+  GraphDef graph_def;
+  NodeDef* node = graph_def.add_node();
+  node->set_name(name);
+  node->set_op("NoOp");
+  node->set_device(strings::StrCat(kWorkerName, "/device:CPU:0"));
+  return graph_def;
+}
+
+class WorkerTest : public ::testing::Test {
+ protected:
+  WorkerTest() {
+    // The worker reads the capacity of its graph cache when it is created.
+    setenv("TF_WORKER_GRAPH_CACHE_BYTES", "1048576", /*overwrite=*/1);
+    std::vector<std::unique_ptr<Device>> devices;
+    TF_CHECK_OK(DeviceFactory::GetFactory("CPU")->CreateDevices(
+        SessionOptions(), kWorkerName, &devices));
+    device_mgr_ = absl::make_unique<StaticDeviceMgr>(std::move(devices));
+    env_.env = Env::Default();
+    env_.device_mgr = device_mgr_.get();
+    env_.local_devices = device_mgr_->ListDevices();
+    session_mgr_ = absl::make_unique<SessionMgr>(
+        &env_, kWorkerName, std::unique_ptr<WorkerCacheInterface>(),
+        [](const ServerDef& server_def, WorkerCacheInterface** worker_cache) {
+          *worker_cache = nullptr;
+          return Status::OK();
+        });
+    env_.session_mgr = session_mgr_.get();
+    worker_ = absl::make_unique<Worker>(&env_);
+  }
+
+  Status RegisterGraph(const RegisterGraphRequest& request,
+                       RegisterGraphResponse* response) {
+    Status status;
+    Notification done;
+    worker_->RegisterGraphAsync(&request, response, [&](const Status& s) {
+      status = s;
+      done.Notify();
+    });
+    done.WaitForNotification();
+    return status;
+  }
+
+  std::unique_ptr<DeviceMgr> device_mgr_;
+  WorkerEnv env_;
+  std::unique_ptr<SessionMgr> session_mgr_;
+  std::unique_ptr<Worker> worker_;
+};
+
+TEST_F(WorkerTest, RegistersCachedGraphFromFingerprint) {
+  const GraphDef graph_def = NoOpGraph("noop");
+  RegisterGraphRequest request;
+  request.set_graph_def_fingerprint(GraphDefCache::Fingerprint(graph_def));
+
+  // The worker has not seen the graph yet, so it asks for it.
+  RegisterGraphResponse response;
+  TF_ASSERT_OK(RegisterGraph(request, &response));
+  EXPECT_TRUE(response.graph_def_required());
+  EXPECT_TRUE(response.graph_handle().empty());
+
+  // The master sends the request again with the graph, which the worker
+  // registers and caches.
+  *request.mutable_graph_def() = graph_def;
+  response.Clear();
+  TF_ASSERT_OK(RegisterGraph(request, &response));
+  EXPECT_FALSE(response.graph_def_required());
+  EXPECT_TRUE(response.graph_def_cached());
+  EXPECT_FALSE(response.graph_handle().empty());
+
+  // From now on the fingerprint is enough.
+  request.clear_graph_def();
+  RegisterGraphResponse cached_response;
+  TF_ASSERT_OK(RegisterGraph(request, &cached_response));
+  EXPECT_FALSE(cached_response.graph_def_required());
+  EXPECT_FALSE(cached_response.graph_handle().empty());
+  EXPECT_NE(cached_response.graph_handle(), response.graph_handle());
+}
+
+TEST_F(WorkerTest, RejectsMismatchedFingerprint) {
+  RegisterGraphRequest request;
+  *request.mutable_graph_def() = NoOpGraph("noop");
+  request.set_graph_def_fingerprint(
+      GraphDefCache::Fingerprint(NoOpGraph("other")));
+
+  RegisterGraphResponse response;
+  const Status status = RegisterGraph(request, &response);
+  EXPECT_TRUE(errors::IsInvalidArgument(status)) << status;
+  EXPECT_FALSE(response.graph_def_cached());
+  EXPECT_TRUE(response.graph_handle().empty());
+
+  // Nothing was cached under the wrong fingerprint.
+  request.clear_graph_def();
+  response.Clear();
+  TF_ASSERT_OK(RegisterGraph(request, &response));
+  EXPECT_TRUE(response.graph_def_required());
+}
+
+}  // namespace
+}  // namespace tensorflow
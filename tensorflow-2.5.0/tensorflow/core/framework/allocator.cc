@@ -30,7 +30,7 @@ namespace tensorflow {
 thread_local MemoryDebugAnnotation ScopedMemoryDebugAnnotation::annotation_;
 
 string AllocatorStats::DebugString() const {
-  return strings::Printf(
+  string result = strings::Printf(
       "Limit:            %20lld\n"
       "InUse:            %20lld\n"
       "MaxInUse:         %20lld\n"
@@ -47,6 +47,16 @@ string AllocatorStats::DebugString() const {
       static_cast<long long>(this->bytes_reserved),
       static_cast<long long>(this->peak_bytes_reserved),
       static_cast<long long>(this->largest_free_block_bytes));
+  if (this->small_chunk_cache_hits + this->small_chunk_cache_misses > 0) {
+    strings::Appendf(&result,
+                     "SmallCacheHits:   %20lld\n"
+                     "SmallCacheMisses: %20lld\n"
+                     "SmallCacheBytes:  %20lld\n",
+                     static_cast<long long>(this->small_chunk_cache_hits),
+                     static_cast<long long>(this->small_chunk_cache_misses),
+                     static_cast<long long>(this->bytes_in_small_chunk_cache));
+  }
+  return result;
 }
 
 constexpr size_t Allocator::kAllocatorAlignment;
@@ -164,6 +164,12 @@ struct AllocatorStats {
 
   int64 largest_free_block_bytes;  // Largest free block's size in heap.
 
+  // Stats for allocators that cache freed small chunks, such as BFCAllocator
+  // with a small chunk cache. Cached bytes are included in bytes_in_use.
+  int64 small_chunk_cache_hits;    // Allocations served from the cache.
+  int64 small_chunk_cache_misses;  // Cacheable allocations that missed.
+  int64 bytes_in_small_chunk_cache;
+
   AllocatorStats()
       : num_allocs(0),
         bytes_in_use(0),
@@ -171,7 +177,10 @@ struct AllocatorStats {
         largest_alloc_size(0),
         bytes_reserved(0),
         peak_bytes_reserved(0),
-        largest_free_block_bytes(0) {}
+        largest_free_block_bytes(0),
+        small_chunk_cache_hits(0),
+        small_chunk_cache_misses(0),
+        bytes_in_small_chunk_cache(0) {}
 
   std::string DebugString() const;
 };
@@ -92,6 +92,7 @@ CollInstanceParams& CollInstanceParams::operator=(
         other.impl_details.subdiv_source_rank.begin(),
         other.impl_details.subdiv_source_rank.end());
     impl_details.dependencies = other.impl_details.dependencies;
+    impl_details.wire_data_type = other.impl_details.wire_data_type;
     devices.assign(other.devices.begin(), other.devices.end());
     permutation.assign(other.permutation.begin(), other.permutation.end());
   }
@@ -117,6 +118,10 @@ string CollInstanceParams::ToString() const {
     }
     strings::StrAppend(&v, "}");  // one subdiv
   }
+  if (impl_details.wire_data_type != DT_INVALID) {
+    strings::StrAppend(&v, " wire_data_type=",
+                       DataTypeString(impl_details.wire_data_type));
+  }
   if (!impl_details.subdiv_source_rank.empty()) {
     strings::StrAppend(&v, " subdiv_source_rank={");
     for (const auto& r : impl_details.subdiv_source_rank) {
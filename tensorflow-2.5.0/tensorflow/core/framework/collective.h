@@ -99,6 +99,10 @@ struct CollImplDetails {
                               // e.g. ring or nccl
   float timeout_seconds;      // If non zero, set a completion timeout for the
                               // collective op to detect staleness.
+  // If set, e.g. to DT_HALF or DT_BFLOAT16, the type in which values are sent
+  // between tasks, trading precision for bandwidth.  Only honored by the ring
+  // reduction of DT_FLOAT tensors on CPU.
+  DataType wire_data_type = DT_INVALID;
 };
 
 // Data common to all members of a collective instance.
@@ -305,6 +309,18 @@ class CollectiveExecutor : public core::RefCounted {
         "a CollectiveExecutor has not been provided."));
   }
 
+  // Like above, but the collective reads `input` and writes `output` instead
+  // of the first input and output of `ctx`.  Used by ops that run one
+  // collective on a buffer of several of their inputs.
+  virtual void ExecuteAsync(OpKernelContext* ctx,
+                            const CollectiveParams* col_params,
+                            const string& exec_key, const Tensor* input,
+                            Tensor* output, StatusCallback done) {
+    done(errors::Internal(
+        "A collective Op has been called in a context in which "
+        "a CollectiveExecutor has not been provided."));
+  }
+
   virtual void CompleteParamsAsync(const DeviceAttributes& device,
                                    CollectiveParams* cp,
                                    CancellationManager* cancel_mgr,
@@ -912,6 +912,17 @@ class DatasetBase : public core::RefCounted {
   // Returns the cardinality of this dataset.
   virtual int64 Cardinality() const { return kUnknownCardinality; }
 
+  // Stores the element at position `index` of the dataset in `*out_tensors`.
+  // Datasets that support random access override this method; it must be safe
+  // to call concurrently, so that consumers can read disjoint ranges of
+  // indices in parallel. `ctx` is null when called from an iterator, so
+  // implementations must not depend on it. Returns `errors::Unimplemented` if
+  // the dataset does not support random access, and
+  // `errors::FailedPrecondition` if it does not support it yet (for example,
+  // because its elements are not yet materialized).
+  virtual Status Get(OpKernelContext* ctx, int64 index,
+                     std::vector<Tensor>* out_tensors) const;
+
   // A human-readable debug string for this dataset.
   virtual string DebugString() const = 0;
 
@@ -50,6 +50,15 @@ auto* graph_pending_queue_length_histogram = monitoring::Sampler<0>::New(
     // Power of 1.5 with bucket count 30 (> 191k)
     {monitoring::Buckets::Exponential(1, 1.5, 30)});
 
+auto* run_handler_queueing_delay_usecs_histogram =
+    monitoring::Sampler<1>::New(
+        {"/tensorflow/core/run_handler_queueing_delay_usecs_histogram",
+         "The time inter-op closures scheduled through a RunHandler wait "
+         "before they start, in microseconds.",
+         "priority"},
+        // Power of 2 with bucket count 24 (> 8 seconds)
+        {monitoring::Buckets::Exponential(1, 2, 24)});
+
 auto* graph_run_input_tensor_bytes = monitoring::Sampler<0>::New(
     {"/tensorflow/core/graph_run_input_tensor_bytes",
      "The size of input tensors in bytes."},
@@ -88,6 +97,47 @@ auto* tf_data_bytes_fetched_counter = monitoring::Counter<0>::New(
 auto* tf_data_elements_counter = monitoring::Counter<1>::New(
     "/tensorflow/data/elements", "tf.data elements", "name");
 
+auto* tf_data_stage_processing_time_gauge = monitoring::Gauge<int64, 2>::New(
+    "/tensorflow/data/autotune/stage_processing_time",
+    "The average time (in nanoseconds) a tf.data stage spends producing an "
+    "element, excluding the time spent in its inputs.",
+    "pipeline", "name");
+
+auto* tf_data_stage_buffer_utilization_gauge =
+    monitoring::Gauge<int64, 2>::New(
+        "/tensorflow/data/autotune/stage_buffer_utilization",
+        "The percentage of its buffer a tf.data stage has filled.", "pipeline",
+        "name");
+
+auto* tf_data_stage_parallelism_gauge = monitoring::Gauge<int64, 2>::New(
+    "/tensorflow/data/autotune/stage_parallelism",
+    "The parallelism of a tf.data stage.", "pipeline", "name");
+
+auto* tf_data_head_of_line_blocking_gauge = monitoring::Gauge<int64, 2>::New(
+    "/tensorflow/data/head_of_line_blocking",
+    "The average time consumers of a deterministic tf.data stage wait for a "
+    "head-of-line element while later elements are available, as a percentage "
+    "of the average time to produce an element.",
+    "pipeline", "name");
+
+auto* tf_data_bottleneck_stage_gauge = monitoring::Gauge<string, 1>::New(
+    "/tensorflow/data/autotune/bottleneck_stage",
+    "The tf.data stage most recently identified as the bottleneck of its "
+    "input pipeline.",
+    "pipeline");
+
+auto* tf_data_bottleneck_latency_gauge = monitoring::Gauge<int64, 1>::New(
+    "/tensorflow/data/autotune/bottleneck_latency",
+    "The time (in nanoseconds) the bottleneck tf.data stage contributes to "
+    "producing an element.",
+    "pipeline");
+
+auto* tf_data_autotune_max_buffered_bytes_gauge =
+    monitoring::Gauge<int64, 0>::New(
+        "/tensorflow/data/autotune/max_buffered_bytes",
+        "The number of bytes the buffers of a tf.data input pipeline can hold "
+        "when full, as chosen by memory-aware autotuning.");
+
 auto* tf_data_experiment_counter = monitoring::Counter<1>::New(
     "/tensorflow/data/experiment",
     "The number of times tf.data experiment is applied to input pipelines.",
@@ -163,6 +213,13 @@ auto* xla_compilation_time_usecs = monitoring::Counter<0>::New(
     "/tensorflow/core/xla_compilation_time_usecs",
     "The total time spent on compiling XLA graphs in microseconds.");
 
+auto* xla_shape_bucket_lookups = monitoring::Counter<2>::New(
+    "/tensorflow/core/xla_shape_bucket_lookups",
+    "The number of XLA cluster launches whose leading dimension was padded "
+    "up to a shape bucket, by bucket size and whether an executable for the "
+    "bucket was already available.",
+    "bucket", "result");
+
 auto* xla_tpu_spmd_cores_per_replica = monitoring::Counter<1>::New(
     "/tensorflow/tpu/xla_spmd_cores_per_replica",
     "The number of cores used by XLA SPMD-replicated models.", "cores");
@@ -190,6 +247,36 @@ monitoring::CounterCell* GetTFDataBytesProducedCounter(const string& name) {
   return tf_data_bytes_produced_counter->GetCell(name);
 }
 
+monitoring::GaugeCell<int64>* GetTFDataStageProcessingTimeGauge(
+    const string& pipeline, const string& name) {
+  return tf_data_stage_processing_time_gauge->GetCell(pipeline, name);
+}
+
+monitoring::GaugeCell<int64>* GetTFDataStageBufferUtilizationGauge(
+    const string& pipeline, const string& name) {
+  return tf_data_stage_buffer_utilization_gauge->GetCell(pipeline, name);
+}
+
+monitoring::GaugeCell<int64>* GetTFDataStageParallelismGauge(
+    const string& pipeline, const string& name) {
+  return tf_data_stage_parallelism_gauge->GetCell(pipeline, name);
+}
+
+monitoring::GaugeCell<int64>* GetTFDataHeadOfLineBlockingGauge(
+    const string& pipeline, const string& name) {
+  return tf_data_head_of_line_blocking_gauge->GetCell(pipeline, name);
+}
+
+void RecordTFDataBottleneckStage(const string& pipeline, const string& name,
+                                 int64 latency_ns) {
+  tf_data_bottleneck_stage_gauge->GetCell(pipeline)->Set(name);
+  tf_data_bottleneck_latency_gauge->GetCell(pipeline)->Set(latency_ns);
+}
+
+void RecordTFDataAutotuneMaxBufferedBytes(int64 num_bytes) {
+  tf_data_autotune_max_buffered_bytes_gauge->GetCell()->Set(num_bytes);
+}
+
 monitoring::CounterCell* GetTFDataBytesReadCounter(const string& name) {
   return tf_data_bytes_read_counter->GetCell(name);
 }
@@ -293,6 +380,11 @@ void UpdateGraphPendingQueueLength(uint64 len) {
   graph_pending_queue_length_cell->Add(len);
 }
 
+monitoring::SamplerCell* GetRunHandlerQueueingDelayCell(int64 priority) {
+  return run_handler_queueing_delay_usecs_histogram->GetCell(
+      absl::StrCat(priority));
+}
+
 void UpdateGraphOptimizationPassTime(const string& pass_name,
                                      const uint64 running_time_usecs) {
   if (running_time_usecs > 0) {
@@ -329,6 +421,11 @@ void UpdateXlaCompilationTime(const uint64 compilation_time_usecs) {
   }
 }
 
+void RecordXlaShapeBucketLookup(const int64 bucket, const bool hit) {
+  xla_shape_bucket_lookups->GetCell(absl::StrCat(bucket), hit ? "hit" : "miss")
+      ->IncrementBy(1);
+}
+
 void UpdateBfcAllocatorDelayTime(const uint64 delay_usecs) {
   static auto* bfc_allocator_delay_cell = bfc_allocator_delay->GetCell();
   if (delay_usecs > 0) {
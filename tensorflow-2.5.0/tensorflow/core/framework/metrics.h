@@ -17,6 +17,8 @@ limitations under the License.
 #define TENSORFLOW_CORE_FRAMEWORK_METRICS_H_
 
 #include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/monitoring/gauge.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
@@ -53,6 +55,59 @@ monitoring::CounterCell* GetTFDataBytesReadCounter(const string& name);
 // The `name` argument identifies the Dataset type (e.g. "Batch" or "Map").
 monitoring::CounterCell* GetTFDataElementsCounter(const string& name);
 
+// Returns a gauge that can be used to record the average time (in nanoseconds)
+// a stage of a tf.data input pipeline spends producing an element, excluding
+// the time spent in its inputs, as observed by the autotuning model.
+//
+// The `pipeline` argument identifies the input pipeline (see
+// `model::Model::id()`) and the `name` argument identifies the stage within it
+// (e.g. "ParallelMapV2(id:3)").
+monitoring::GaugeCell<int64>* GetTFDataStageProcessingTimeGauge(
+    const string& pipeline, const string& name);
+
+// Returns a gauge that can be used to record the percentage of its buffer
+// that a stage of a tf.data input pipeline has filled.
+//
+// The `pipeline` argument identifies the input pipeline (see
+// `model::Model::id()`) and the `name` argument identifies the stage within it
+// (e.g. "ParallelMapV2(id:3)").
+monitoring::GaugeCell<int64>* GetTFDataStageBufferUtilizationGauge(
+    const string& pipeline, const string& name);
+
+// Returns a gauge that can be used to record the parallelism of a stage of a
+// tf.data input pipeline, as chosen by autotuning.
+//
+// The `pipeline` argument identifies the input pipeline (see
+// `model::Model::id()`) and the `name` argument identifies the stage within it
+// (e.g. "ParallelMapV2(id:3)").
+monitoring::GaugeCell<int64>* GetTFDataStageParallelismGauge(
+    const string& pipeline, const string& name);
+
+// Returns a gauge that can be used to record how long consumers of a
+// deterministic tf.data stage wait for a head-of-line element while later
+// elements are already available. The value is the average wait per stalled
+// element, as a percentage of the average time the stage takes to produce an
+// element.
+//
+// The `pipeline` argument identifies the input pipeline (see
+// `model::Model::id()`) and the `name` argument identifies the stage within it
+// (e.g. "ParallelMapV2(id:3)").
+monitoring::GaugeCell<int64>* GetTFDataHeadOfLineBlockingGauge(
+    const string& pipeline, const string& name);
+
+// Records the stage of a tf.data input pipeline that the autotuning model
+// identified as its bottleneck, together with the time (in nanoseconds) the
+// stage contributes to producing an element.
+//
+// The `pipeline` argument identifies the input pipeline (see
+// `model::Model::id()`).
+void RecordTFDataBottleneckStage(const string& pipeline, const string& name,
+                                 int64 latency_ns);
+
+// Records the number of bytes the buffers of a tf.data input pipeline can hold
+// when full, as chosen by the memory-aware autotuning algorithm.
+void RecordTFDataAutotuneMaxBufferedBytes(int64 num_bytes);
+
 // Records the number of bytes fetched from tf.data.Dataset iterator.
 void RecordTFDataBytesFetched(int64 num_bytes);
 
@@ -111,6 +166,14 @@ void RecordTPUXlaSpmdCoresPerReplica(int64 cores_per_replica);
 void UpdateGraphExecTime(const uint64 running_time_usecs);
 void UpdateGraphPendingQueueLength(uint64 len);
 
+// Returns a sampler cell that can be used to record the time (in
+// microseconds) an inter-op closure scheduled through a RunHandler waits
+// before it starts running.
+//
+// The `priority` argument is the RunHandlerPoolOptions.priority of the
+// request that scheduled the closure.
+monitoring::SamplerCell* GetRunHandlerQueueingDelayCell(int64 priority);
+
 // Records that one output of an op of type `op_name` was unused.
 void RecordUnusedOutput(const string& op_name);
 
@@ -138,6 +201,11 @@ void UpdateGrapplerPassTime(const string& pass_name,
 // Updates the metrics stored about time XLA spents compiling graphs.
 void UpdateXlaCompilationTime(const uint64 compilation_time_usecs);
 
+// Records an XLA cluster launch whose leading dimension was padded up to
+// `bucket`. `hit` is true if an executable for the bucket was already
+// available.
+void RecordXlaShapeBucketLookup(const int64 bucket, const bool hit);
+
 // Updates the metrics stored about time BFC allocator spents during delay.
 void UpdateBfcAllocatorDelayTime(const uint64 delay_usecs);
 
@@ -15,12 +15,18 @@ limitations under the License.
 
 #include "tensorflow/core/framework/model.h"
 
+#include <limits>
 #include <memory>
+#include <set>
 
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "absl/time/clock.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/profiler/lib/traceme_encode.h"
 
 namespace tensorflow {
 namespace data {
@@ -1140,6 +1146,50 @@ void Node::FlushMetrics() {
   metrics_.record_num_elements(num_elements_);
 }
 
+NodeStats Node::Stats() const {
+  NodeStats stats;
+  std::shared_ptr<Parameter> parallelism;
+  std::shared_ptr<Parameter> buffer_size_parameter;
+  {
+    tf_shared_lock l(mu_);
+    stats.processing_time = SelfProcessingTimeLocked();
+    stats.bytes_produced = bytes_produced_;
+    auto it = parameters_.find(kParallelism);
+    if (it != parameters_.end()) parallelism = it->second;
+    it = parameters_.find(kBufferSize);
+    if (it != parameters_.end()) buffer_size_parameter = it->second;
+  }
+  // The iterator updates the state of a parameter under the state's mutex,
+  // which is read here without holding `mu_` so that the two are never nested.
+  // Before the iterator sets the initial value of a tunable parameter, its
+  // state is `kAutotune`, in which case the model value is reported instead.
+  auto value = [](const Parameter& parameter) {
+    double state_value;
+    if (parameter.state->mu) {
+      mutex_lock l(*parameter.state->mu);
+      state_value = parameter.state->value;
+    } else {
+      state_value = parameter.state->value;
+    }
+    return state_value > 0 ? state_value : parameter.value;
+  };
+  if (parallelism) {
+    stats.parallelism = value(*parallelism);
+  }
+  // Nodes without an explicit buffer size buffer up to `parallelism` elements.
+  double buffer_size = 0;
+  if (buffer_size_parameter) {
+    buffer_size = value(*buffer_size_parameter);
+  } else if (parallelism) {
+    buffer_size = stats.parallelism;
+  }
+  if (buffer_size > 0) {
+    stats.buffer_utilization =
+        std::min(1.0, static_cast<double>(buffered_elements_) / buffer_size);
+  }
+  return stats;
+}
+
 double Node::OutputTime(absl::flat_hash_map<string, double>* input_times,
                         absl::flat_hash_map<string, double>* gradients) const {
   // To store the output time gradient w.r.t. input time (if `gradients` is not
@@ -1593,6 +1643,32 @@ Status Node::FromProto(ModelProto::Node node_proto,
   return Status::OK();
 }
 
+namespace {
+
+mutex model_ids_mu(LINKER_INITIALIZED);
+int64 next_model_id TF_GUARDED_BY(model_ids_mu) = 0;
+std::set<int64>* released_model_ids TF_GUARDED_BY(model_ids_mu) = nullptr;
+
+}  // namespace
+
+int64 Model::AcquireId() {
+  mutex_lock l(model_ids_mu);
+  if (released_model_ids == nullptr || released_model_ids->empty()) {
+    return next_model_id++;
+  }
+  const int64 id = *released_model_ids->begin();
+  released_model_ids->erase(released_model_ids->begin());
+  return id;
+}
+
+void Model::ReleaseId(int64 id) {
+  mutex_lock l(model_ids_mu);
+  if (released_model_ids == nullptr) {
+    released_model_ids = new std::set<int64>();
+  }
+  released_model_ids->insert(id);
+}
+
 void Model::AddNode(Node::Factory factory, const string& name,
                     std::shared_ptr<Node> parent,
                     std::shared_ptr<Node>* out_node) {
@@ -1625,14 +1701,66 @@ void Model::FlushMetrics() {
     tf_shared_lock l(mu_);
     if (output_) queue.push_back(output_);
   }
+  const string pipeline = absl::StrCat(id_);
+  string bottleneck;
+  double bottleneck_latency = 0;
   while (!queue.empty()) {
     auto node = queue.front();
     queue.pop_front();
     node->FlushMetrics();
-    for (auto input : node->inputs()) {
+    const NodeStats stats = node->Stats();
+    metrics::GetTFDataStageProcessingTimeGauge(pipeline, node->long_name())
+        ->Set(static_cast<int64>(stats.processing_time));
+    if (stats.buffer_utilization >= 0) {
+      metrics::GetTFDataStageBufferUtilizationGauge(pipeline, node->long_name())
+          ->Set(static_cast<int64>(100 * stats.buffer_utilization));
+    }
+    metrics::GetTFDataStageParallelismGauge(pipeline, node->long_name())
+        ->Set(static_cast<int64>(stats.parallelism));
+    const auto inputs = node->inputs();
+    profiler::TraceMe::InstantActivity(
+        [&]() {
+          std::vector<string> input_names;
+          for (const auto& input : inputs) {
+            input_names.push_back(input->long_name());
+          }
+          return profiler::TraceMeEncode(
+              "TFDataStageStats",
+              {{"pipeline", pipeline},
+               {"name", node->long_name()},
+               {"inputs", absl::StrJoin(input_names, ",")},
+               {"processing_time_ns", stats.processing_time},
+               {"bytes_produced", stats.bytes_produced},
+               {"buffer_utilization", stats.buffer_utilization},
+               {"parallelism", stats.parallelism}});
+        },
+        profiler::TraceMeLevel::kInfo);
+    // A node with parallelism `p` overlaps the production of `p` elements, so
+    // it contributes a `1/p` fraction of its processing time to each element.
+    const double latency =
+        stats.processing_time / std::max(stats.parallelism, 1.0);
+    if (latency > bottleneck_latency) {
+      bottleneck = node->long_name();
+      bottleneck_latency = latency;
+    }
+    for (auto input : inputs) {
       queue.push_back(input);
     }
   }
+  if (!bottleneck.empty()) {
+    VLOG(2) << "Bottleneck stage: " << bottleneck << " (" << bottleneck_latency
+            << " ns per element)";
+    metrics::RecordTFDataBottleneckStage(
+        pipeline, bottleneck, static_cast<int64>(bottleneck_latency));
+    profiler::TraceMe::InstantActivity(
+        [&]() {
+          return profiler::TraceMeEncode(
+              "TFDataBottleneckStage", {{"pipeline", pipeline},
+                                        {"name", bottleneck},
+                                        {"latency_ns", bottleneck_latency}});
+        },
+        profiler::TraceMeLevel::kInfo);
+  }
 }
 
 void Model::Optimize(AutotuneAlgorithm algorithm, int64 cpu_budget,
@@ -1656,6 +1784,9 @@ void Model::Optimize(AutotuneAlgorithm algorithm, int64 cpu_budget,
       OptimizeGradientDescent(snapshot, optimization_params,
                               cancellation_manager);
       break;
+    case AutotuneAlgorithm::MEMORY_AWARE:
+      OptimizeMemoryAware(snapshot, optimization_params, cancellation_manager);
+      break;
     default:
       VLOG(2) << "Autotuning algorithm was not recognized. Aborting "
                  "optimization.";
@@ -1909,6 +2040,140 @@ void Model::OptimizeHillClimb(std::shared_ptr<Node> snapshot,
   UpdateStateValues(&parameters);
 }
 
+void Model::OptimizeMemoryAware(std::shared_ptr<Node> snapshot,
+                                const OptimizationParams& optimization_params,
+                                CancellationManager* cancellation_manager) {
+  VLOG(2) << "Starting memory-aware optimization of tunable parameters.";
+  const double processing_time = TotalProcessingTime(snapshot);
+  auto parameters = CollectTunableParameters(snapshot);
+  if (parameters.empty()) {
+    VLOG(2) << "The memory-aware optimization is terminated since no node "
+               "with tunable parameters has recorded elements.";
+    return;
+  }
+  VLOG(2) << "Number of tunable parameters: " << parameters.size();
+
+  // Buffer size parameter will only be incremented if the output latency
+  // improvement is greater than this constant.
+  constexpr double kBufferSizeMinDelta = 1.0L;
+
+  const double ram_budget = optimization_params.ram_budget();
+  const double model_input_time = optimization_params.model_input_time();
+  auto within_budget = [&]() {
+    return TotalMaximumBufferedBytes(snapshot) <= ram_budget;
+  };
+
+  // Start from the values chosen by the previous optimization (or the minimal
+  // values if there was none), so that the parameters only move as far as the
+  // current element sizes require.
+  for (auto& pair : parameters) {
+    Parameter* parameter = pair.second.get();
+    parameter->value =
+        std::min(std::max(std::round(parameter->value), parameter->min),
+                 parameter->max);
+  }
+
+  // Shrinks the parameter with the given name whose decrement increases the
+  // output time the least. Returns false if all such parameters are already at
+  // their minimum.
+  auto shrink = [&](const string& name) {
+    double best_output_time = std::numeric_limits<double>::max();
+    Parameter* best_parameter = nullptr;
+    for (auto& pair : parameters) {
+      Parameter* parameter = pair.second.get();
+      if (parameter->name != name || parameter->value <= parameter->min) {
+        continue;
+      }
+      parameter->value--;
+      const double output_time =
+          OutputTime(snapshot, model_input_time, /*gradients=*/nullptr);
+      if (output_time < best_output_time) {
+        best_output_time = output_time;
+        best_parameter = parameter;
+      }
+      parameter->value++;
+    }
+    if (!best_parameter) {
+      return false;
+    }
+    best_parameter->value--;
+    return true;
+  };
+  while (!within_budget() && shrink(kBufferSize)) {
+  }
+  while (!within_budget() && shrink(kParallelism)) {
+  }
+  if (!within_budget()) {
+    VLOG(2) << "The minimal values of the tunable parameters exceed the RAM "
+               "budget of "
+            << ram_budget << " bytes.";
+  }
+
+  while (!cancellation_manager->IsCancelled()) {
+    const double output_time =
+        OutputTime(snapshot, model_input_time, /*gradients=*/nullptr);
+    if (output_time < processing_time / optimization_params.cpu_budget()) {
+      break;
+    }
+    double best_delta = 0.0L;
+    Parameter* best_increment = nullptr;
+    Parameter* best_decrement = nullptr;
+    auto consider = [&](Parameter* increment, Parameter* decrement) {
+      const double delta =
+          output_time -
+          OutputTime(snapshot, model_input_time, /*gradients=*/nullptr);
+      if (delta > best_delta &&
+          (delta > kBufferSizeMinDelta || increment->name != kBufferSize)) {
+        best_delta = delta;
+        best_increment = increment;
+        best_decrement = decrement;
+      }
+    };
+    for (auto& pair : parameters) {
+      Parameter* increment = pair.second.get();
+      if (increment->value >= increment->max) {
+        continue;
+      }
+      increment->value++;
+      if (within_budget()) {
+        consider(increment, /*decrement=*/nullptr);
+      } else {
+        // The increment does not fit the RAM budget on its own. Check whether
+        // it pays off to make room for it by decrementing another parameter.
+        for (auto& other : parameters) {
+          Parameter* decrement = other.second.get();
+          if (decrement == increment || decrement->value <= decrement->min) {
+            continue;
+          }
+          decrement->value--;
+          if (within_budget()) {
+            consider(increment, decrement);
+          }
+          decrement->value++;
+        }
+      }
+      increment->value--;
+    }
+    if (!best_increment) {
+      VLOG(2) << "Failed to find a change of the tunable parameters that would "
+                 "further decrease the output time within the RAM budget. The "
+                 "optimization attempt will terminate.";
+      break;
+    }
+    best_increment->value++;
+    if (best_decrement) {
+      best_decrement->value--;
+    }
+  }
+  const double buffered_bytes = TotalMaximumBufferedBytes(snapshot);
+  VLOG(1) << "Memory-aware autotuning chose parameters that buffer up to "
+          << buffered_bytes << " bytes within the RAM budget of " << ram_budget
+          << " bytes.";
+  metrics::RecordTFDataAutotuneMaxBufferedBytes(
+      static_cast<int64>(buffered_bytes));
+  UpdateStateValues(&parameters);
+}
+
 double Model::OutputTime(std::shared_ptr<Node> node, double model_input_time,
                          absl::flat_hash_map<string, double>* gradients) {
   // To store the input time for each node.
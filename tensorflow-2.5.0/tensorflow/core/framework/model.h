@@ -109,6 +109,21 @@ std::shared_ptr<Parameter> MakeParameter(const string& name,
                                          std::shared_ptr<SharedState> state,
                                          double min, double max);
 
+// Per-node statistics that `Model::FlushMetrics()` exports to the tf.data
+// metrics and, while a profiler session is active, to the host XPlane.
+struct NodeStats {
+  // Average time (in nanoseconds) the node spends producing an element,
+  // excluding the time spent in its inputs.
+  double processing_time = 0;
+  // Total number of bytes produced by the node.
+  int64 bytes_produced = 0;
+  // Fraction of the node's buffer that is filled, or -1 if the node does not
+  // buffer elements.
+  double buffer_utilization = -1;
+  // Parallelism of the node, or 1 if the node is not parallel.
+  double parallelism = 1;
+};
+
 // Abstract representation of a TensorFlow input pipeline node. It collects
 // information about inputs to this node, processing time spent executing the
 // node logic, number of elements produced by the node, various other
@@ -343,6 +358,9 @@ class Node {
   // Flushes the metrics recorded by this node.
   void FlushMetrics() TF_LOCKS_EXCLUDED(mu_);
 
+  // Returns the current statistics of this node.
+  NodeStats Stats() const TF_LOCKS_EXCLUDED(mu_);
+
   // Returns the per-element output time for this node and if `gradients` is not
   // `nullptr`, collects the output time gradient w.r.t. tunable parameters of
   // the subtree rooted in this node.
@@ -641,7 +659,8 @@ class Model {
 
   // Creates a new model.
   Model()
-      : collect_resource_usage_(false),
+      : id_(AcquireId()),
+        collect_resource_usage_(false),
         optimization_period_ms_(kOptimizationPeriodMinMs) {
     const char* save_dir = std::getenv("TF_DATA_AUTOTUNE_DEBUG_DIR");
     if (save_dir) {
@@ -654,8 +673,15 @@ class Model {
       save_thread_cancelled_ = true;
       save_cond_var_.notify_all();
     }
+    ReleaseId(id_);
   }
 
+  // Returns an identifier of this model that is unique among the models alive
+  // at the same time. Identifiers of destroyed models are reused, so that the
+  // per-pipeline metrics, whose cells are never deleted, stay bounded by the
+  // number of concurrently live input pipelines.
+  int64 id() const { return id_; }
+
   // Indicates whether to collect resource usage.
   bool collect_resource_usage() const { return collect_resource_usage_; }
 
@@ -713,12 +739,22 @@ class Model {
   // Maximum number of optimization snapshots kept in a buffer for saving.
   static constexpr int64 kMaxNumBufferedOptimizeArgs = 100;
 
+  // Returns the smallest identifier not used by a live model.
+  static int64 AcquireId();
+
+  // Makes the identifier of a destroyed model available for reuse.
+  static void ReleaseId(int64 id);
+
   // Collects tunable parameters in the tree rooted in the given node, returning
   // a mapping from a (unique) node name to a tunable parameter.
   absl::flat_hash_map<string, std::shared_ptr<Parameter>>
   CollectTunableParameters(std::shared_ptr<Node> node);
 
-  // Flushes metrics recorded by the model.
+  // Flushes metrics recorded by the model. Besides the metrics of each node,
+  // this exports the node (the "bottleneck stage") with the largest processing
+  // time per element divided by its parallelism, and records the statistics
+  // of every node as instant events that include the model graph structure, so
+  // that they show up in the host XPlane of an active profiler session.
   void FlushMetrics() TF_LOCKS_EXCLUDED(mu_);
 
   // This optimization algorithm starts by setting all tunable parallelism
@@ -742,6 +778,23 @@ class Model {
                                const OptimizationParams& optimization_params,
                                CancellationManager* cancellation_manager);
 
+  // This optimization algorithm treats the RAM budget as a hard constraint on
+  // the memory the buffers of the pipeline could hold when full. It starts
+  // from the current parameter values and, if they exceed the RAM budget,
+  // shrinks buffer sizes first and parallelism only after all buffers are at
+  // their minimum. It then repeatedly applies the parameter increment that
+  // decreases the output time the most while keeping the buffered bytes
+  // within the budget. When no increment fits the budget, it considers
+  // increments paired with a decrement of another parameter, which makes it
+  // possible to trade buffer memory for parallelism. The process is repeated
+  // until no move decreases the output time or the projected output time is
+  // less than the processing time needed to produce an element divided by CPU
+  // budget. The buffered bytes of the chosen parameters are recorded as a
+  // metric.
+  void OptimizeMemoryAware(std::shared_ptr<Node> snapshot,
+                           const OptimizationParams& optimization_params,
+                           CancellationManager* cancellation_manager);
+
   // Collects the output time and if `gradients` is not `nullptr`, the output
   // time gradient w.r.t. tunable parameters of the subtree rooted in the given
   // node.
@@ -782,6 +835,8 @@ class Model {
   // The saving loop is terminated when the model is destroyed.
   Status SaveLoop();
 
+  const int64 id_;
+
   // Used for coordination between different input pipeline threads. Exclusive
   // access is required only when adding or removing nodes. Concurrent access to
   // existing nodes is protected by a node mutex.
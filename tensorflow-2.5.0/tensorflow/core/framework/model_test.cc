@@ -1090,6 +1090,60 @@ TEST_P(SelfProcessingTimeTest, Model) {
 INSTANTIATE_TEST_SUITE_P(Test, SelfProcessingTimeTest,
                          ::testing::Values(0, 1, 2, 5, 10, 20, 40));
 
+TEST(StatsTest, Node) {
+  std::shared_ptr<Node> source = model::MakeSourceNode({1, "source", nullptr});
+  source->add_processing_time(30);
+  source->record_element();
+  NodeStats source_stats = source->Stats();
+  EXPECT_EQ(source_stats.processing_time, 30);
+  EXPECT_EQ(source_stats.buffer_utilization, -1);
+  EXPECT_EQ(source_stats.parallelism, 1);
+
+  std::shared_ptr<Node> async_known_ratio = model::MakeAsyncKnownRatioNode(
+      {2, "async_known_ratio", nullptr}, /*ratio=*/1,
+      {model::MakeParameter(
+          "parallelism",
+          std::make_shared<SharedState>(/*value=*/4, nullptr, nullptr),
+          /*min=*/1, /*max=*/8)});
+  async_known_ratio->add_processing_time(100);
+  async_known_ratio->record_element();
+  async_known_ratio->record_element();
+  async_known_ratio->record_bytes_produced(64);
+  async_known_ratio->record_buffer_event(/*bytes_delta=*/32,
+                                         /*elements_delta=*/2);
+  NodeStats stats = async_known_ratio->Stats();
+  EXPECT_EQ(stats.processing_time, 50);
+  EXPECT_EQ(stats.bytes_produced, 64);
+  EXPECT_EQ(stats.buffer_utilization, 0.5);
+  EXPECT_EQ(stats.parallelism, 4);
+}
+
+TEST(StatsTest, ReadsParametersUnderStateMutex) {
+  auto mu = std::make_shared<mutex>();
+  auto state = std::make_shared<SharedState>(/*value=*/2, mu, nullptr);
+  std::shared_ptr<Node> async_known_ratio = model::MakeAsyncKnownRatioNode(
+      {1, "async_known_ratio", nullptr}, /*ratio=*/1,
+      {model::MakeParameter("parallelism", state, /*min=*/1, /*max=*/8)});
+  EXPECT_EQ(async_known_ratio->Stats().parallelism, 2);
+  {
+    mutex_lock l(*mu);
+    state->value = 6;
+  }
+  EXPECT_EQ(async_known_ratio->Stats().parallelism, 6);
+}
+
+TEST(ModelTest, IdsAreUniqueAmongLiveModels) {
+  auto first = std::make_unique<Model>();
+  auto second = std::make_unique<Model>();
+  EXPECT_NE(first->id(), second->id());
+  const int64 first_id = first->id();
+  first.reset();
+  // The identifier of a destroyed model is reused.
+  auto third = std::make_unique<Model>();
+  EXPECT_EQ(third->id(), first_id);
+  EXPECT_NE(third->id(), second->id());
+}
+
 class OptimizeZeroRamBudgetTest
     : public ::testing::TestWithParam<model::AutotuneAlgorithm> {};
 
@@ -1152,7 +1206,117 @@ TEST_P(OptimizeZeroRamBudgetTest, Model) {
 }
 
 INSTANTIATE_TEST_SUITE_P(Test, OptimizeZeroRamBudgetTest,
-                         ::testing::Values(0, 1));
+                         ::testing::Values(0, 1, 2));
+
+// A pipeline of a parallel map (node 1) reading from a prefetch (node 2) that
+// buffers the elements of a slow synchronous source (node 3). Each element
+// buffered by node 1 or node 2 takes `kElementSize` bytes.
+class MemoryAwarePipeline {
+ public:
+  static constexpr int64 kElementSize = 1000;
+
+  MemoryAwarePipeline() {
+    node1_ = model::MakeAsyncKnownRatioNode(
+        {1, "1", nullptr}, 1,
+        {model::MakeParameter(
+            "parallelism",
+            std::make_shared<SharedState>(
+                /*value=*/model::kAutotune, std::make_shared<mutex>(),
+                std::make_shared<condition_variable>()),
+            /*min=*/1, /*max=*/5)});
+    node2_ = model::MakeAsyncKnownRatioNode(
+        {2, "2", node1_}, 1,
+        {model::MakeParameter(
+            "buffer_size",
+            std::make_shared<SharedState>(
+                /*value=*/model::kAutotune, std::make_shared<mutex>(),
+                std::make_shared<condition_variable>()),
+            /*min=*/0, /*max=*/6)});
+    node3_ = model::MakeKnownRatioNode({3, "3", node2_}, 1);
+    for (auto& node : {node1_, node2_}) {
+      node->record_buffer_event(kElementSize, 1);
+      node->record_bytes_produced(kElementSize);
+      node->record_element();
+    }
+    node1_->add_processing_time(2000);
+    node3_->add_processing_time(1000);
+    node3_->record_element();
+
+    model_.AddNode([this](model::Node::Args args) { return node1_; }, "1",
+                   nullptr, &node1_);
+    model_.AddNode([this](model::Node::Args args) { return node2_; }, "2",
+                   node1_, &node2_);
+    model_.AddNode([this](model::Node::Args args) { return node3_; }, "3",
+                   node2_, &node3_);
+  }
+
+  void Optimize(int64 ram_budget) {
+    CancellationManager cancellation_manager;
+    model_.Optimize(model::AutotuneAlgorithm::MEMORY_AWARE, /*cpu_budget=*/64,
+                    ram_budget, /*model_input_time=*/0, &cancellation_manager);
+  }
+
+  double parallelism() const { return node1_->parameter_value("parallelism"); }
+  double buffer_size() const { return node2_->parameter_value("buffer_size"); }
+  double buffered_bytes() const {
+    return (parallelism() + buffer_size()) * kElementSize;
+  }
+
+ private:
+  std::shared_ptr<Node> node1_;
+  std::shared_ptr<Node> node2_;
+  std::shared_ptr<Node> node3_;
+  model::Model model_;
+};
+
+class OptimizeMemoryAwareTest
+    : public ::testing::TestWithParam<std::tuple<int64, double, double>> {};
+
+TEST_P(OptimizeMemoryAwareTest, Model) {
+  const int64 ram_budget = std::get<0>(GetParam());
+  const double expected_parallelism = std::get<1>(GetParam());
+  const double expected_buffer_size = std::get<2>(GetParam());
+
+  MemoryAwarePipeline pipeline;
+  pipeline.Optimize(ram_budget);
+  EXPECT_EQ(pipeline.parallelism(), expected_parallelism);
+  EXPECT_EQ(pipeline.buffer_size(), expected_buffer_size);
+  // The minimal parameter values are kept even if they exceed the budget.
+  if (ram_budget >= 1 * MemoryAwarePipeline::kElementSize) {
+    EXPECT_LE(pipeline.buffered_bytes(), ram_budget);
+  }
+}
+
+// Unlike hill climbing, which stops only after the buffered bytes exceed the
+// budget, the memory-aware algorithm never chooses values that do not fit.
+INSTANTIATE_TEST_SUITE_P(
+    Test, OptimizeMemoryAwareTest,
+    ::testing::Values(std::make_tuple(0, 1, 0), std::make_tuple(1000, 1, 0),
+                      std::make_tuple(2000, 2, 0), std::make_tuple(3500, 2, 1),
+                      std::make_tuple(5000, 4, 1),
+                      std::make_tuple(int64{1} << 30, 4, 6)));
+
+TEST(OptimizeMemoryAwareShrinkingBudgetTest, Model) {
+  MemoryAwarePipeline pipeline;
+  pipeline.Optimize(/*ram_budget=*/int64{1} << 30);
+  EXPECT_EQ(pipeline.parallelism(), 4);
+  EXPECT_EQ(pipeline.buffer_size(), 6);
+
+  // Shrinking the prefetch buffer to its minimum does not fit the new budget,
+  // so the parallelism is reduced too. The freed memory is then better spent on
+  // one prefetched element than on a third parallel call.
+  pipeline.Optimize(/*ram_budget=*/3000);
+  EXPECT_EQ(pipeline.parallelism(), 2);
+  EXPECT_EQ(pipeline.buffer_size(), 1);
+  EXPECT_LE(pipeline.buffered_bytes(), 3000);
+
+  // A budget that only requires the buffer to shrink leaves the parallelism
+  // untouched.
+  pipeline.Optimize(/*ram_budget=*/int64{1} << 30);
+  pipeline.Optimize(/*ram_budget=*/7000);
+  EXPECT_EQ(pipeline.parallelism(), 4);
+  EXPECT_EQ(pipeline.buffer_size(), 3);
+}
 
 TEST(RecordTimeTest, RecordTimeTest) {
   std::shared_ptr<Node> source = model::MakeSourceNode({});
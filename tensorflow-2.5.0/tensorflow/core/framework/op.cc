@@ -65,6 +65,16 @@ void OpRegistry::Register(const OpRegistrationDataFactory& op_data_factory) {
   }
 }
 
+void OpRegistry::Register(const string& op_name,
+                          const OpRegistrationDataFactory& op_data_factory) {
+  mutex_lock lock(mu_);
+  if (initialized_) {
+    TF_QCHECK_OK(RegisterAlreadyLocked(op_data_factory));
+  } else {
+    deferred_by_name_[op_name].push_back(op_data_factory);
+  }
+}
+
 namespace {
 // Helper function that returns Status message for failed LookUp.
 Status OpNotFound(const string& op_type_name) {
@@ -90,11 +100,11 @@ Status OpRegistry::LookUp(const string& op_type_name,
 const OpRegistrationData* OpRegistry::LookUp(const string& op_type_name) const {
   {
     tf_shared_lock l(mu_);
-    if (initialized_) {
-      if (const OpRegistrationData* res =
-              gtl::FindWithDefault(registry_, op_type_name, nullptr)) {
-        return res;
-      }
+    // registry_ only holds fully registered ops, even while other
+    // registrations are still deferred.
+    if (const OpRegistrationData* res =
+            gtl::FindWithDefault(registry_, op_type_name, nullptr)) {
+      return res;
     }
   }
   return LookUpSlow(op_type_name);
@@ -108,6 +118,11 @@ const OpRegistrationData* OpRegistry::LookUpSlow(
   bool first_unregistered = false;
   {  // Scope for lock.
     mutex_lock lock(mu_);
+    if (!initialized_) {
+      // Avoid building every deferred op when only this one is needed.
+      res = RegisterDeferredByNameLocked(op_type_name);
+      if (res != nullptr) return res;
+    }
     first_call = MustCallDeferred();
     res = gtl::FindWithDefault(registry_, op_type_name, nullptr);
 
@@ -190,6 +205,7 @@ void OpRegistry::DeferRegistrations() {
 void OpRegistry::ClearDeferredRegistrations() {
   mutex_lock lock(mu_);
   deferred_.clear();
+  deferred_by_name_.clear();
 }
 
 Status OpRegistry::ProcessRegistrations() const {
@@ -214,6 +230,12 @@ bool OpRegistry::MustCallDeferred() const {
     TF_QCHECK_OK(RegisterAlreadyLocked(deferred_[i]));
   }
   deferred_.clear();
+  for (const auto& p : deferred_by_name_) {
+    for (const OpRegistrationDataFactory& factory : p.second) {
+      TF_QCHECK_OK(RegisterAlreadyLocked(factory));
+    }
+  }
+  deferred_by_name_.clear();
   return true;
 }
 
@@ -227,9 +249,31 @@ Status OpRegistry::CallDeferred() const {
     }
   }
   deferred_.clear();
+  for (const auto& p : deferred_by_name_) {
+    for (const OpRegistrationDataFactory& factory : p.second) {
+      Status s = RegisterAlreadyLocked(factory);
+      if (!s.ok()) {
+        return s;
+      }
+    }
+  }
+  deferred_by_name_.clear();
   return Status::OK();
 }
 
+const OpRegistrationData* OpRegistry::RegisterDeferredByNameLocked(
+    const string& op_type_name) const {
+  auto it = deferred_by_name_.find(op_type_name);
+  if (it == deferred_by_name_.end()) return nullptr;
+  const std::vector<OpRegistrationDataFactory> factories =
+      std::move(it->second);
+  deferred_by_name_.erase(it);
+  for (const OpRegistrationDataFactory& factory : factories) {
+    TF_QCHECK_OK(RegisterAlreadyLocked(factory));
+  }
+  return gtl::FindWithDefault(registry_, op_type_name, nullptr);
+}
+
 Status OpRegistry::RegisterAlreadyLocked(
     const OpRegistrationDataFactory& op_data_factory) const {
   std::unique_ptr<OpRegistrationData> op_reg_data(new OpRegistrationData);
@@ -293,6 +337,7 @@ namespace register_op {
 
 InitOnStartupMarker OpDefBuilderWrapper::operator()() {
   OpRegistry::Global()->Register(
+      name_,
       [builder =
            std::move(builder_)](OpRegistrationData* op_reg_data) -> Status {
         return builder.Finalize(op_reg_data);
@@ -72,6 +72,14 @@ class OpRegistry : public OpRegistryInterface {
 
   void Register(const OpRegistrationDataFactory& op_data_factory);
 
+  // Like Register(), for a factory that builds the op named `op_name`. While
+  // registrations are deferred, such a factory is run on its own the first
+  // time `op_name` is looked up, rather than together with every other
+  // deferred registration. This keeps startup cheap for processes that only
+  // look up a few ops.
+  void Register(const std::string& op_name,
+                const OpRegistrationDataFactory& op_data_factory);
+
   Status LookUp(const std::string& op_type_name,
                 const OpRegistrationData** op_reg_data) const override;
 
@@ -154,11 +162,19 @@ class OpRegistry : public OpRegistryInterface {
   Status RegisterAlreadyLocked(const OpRegistrationDataFactory& op_data_factory)
       const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Registers the deferred factories registered under `op_type_name`, if any,
+  // and returns the resulting op, or nullptr.
+  const OpRegistrationData* RegisterDeferredByNameLocked(
+      const std::string& op_type_name) const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   const OpRegistrationData* LookUpSlow(const std::string& op_type_name) const;
 
   mutable mutex mu_;
   // Functions in deferred_ may only be called with mu_ held.
   mutable std::vector<OpRegistrationDataFactory> deferred_ TF_GUARDED_BY(mu_);
+  // Deferred factories registered with an op name, keyed by that name.
+  mutable std::unordered_map<string, std::vector<OpRegistrationDataFactory>>
+      deferred_by_name_ TF_GUARDED_BY(mu_);
   // Values are owned.
   mutable std::unordered_map<string, const OpRegistrationData*> registry_
       TF_GUARDED_BY(mu_);
@@ -216,7 +232,8 @@ namespace register_op {
 
 class OpDefBuilderWrapper {
  public:
-  explicit OpDefBuilderWrapper(const char name[]) : builder_(name) {}
+  explicit OpDefBuilderWrapper(const char name[])
+      : name_(name), builder_(name) {}
   OpDefBuilderWrapper& Attr(std::string spec) {
     builder_.Attr(std::move(spec));
     return *this;
@@ -269,6 +286,7 @@ class OpDefBuilderWrapper {
   InitOnStartupMarker operator()();
 
  private:
+  const std::string name_;
   mutable ::tensorflow::OpDefBuilder builder_;
 };
 
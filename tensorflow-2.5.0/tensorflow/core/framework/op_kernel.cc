@@ -366,6 +366,13 @@ OpKernelContext::~OpKernelContext() {
 }
 
 Allocator* OpKernelContext::get_allocator(AllocatorAttributes attr) {
+  // Nearly every allocation uses the default attributes, so resolve that
+  // allocator (and its tracking wrapper, if any) once per context.
+  const bool is_default_attr = attr.value == 0 && attr.scope_id == 0;
+  if (TF_PREDICT_TRUE(is_default_attr)) {
+    Allocator* cached = default_allocator_.load(std::memory_order_acquire);
+    if (cached != nullptr) return cached;
+  }
   Allocator* allocator = nullptr;
   if (TF_PREDICT_FALSE(attr.scope_id > 0)) {
     allocator = params_->device->GetScopedAllocator(attr, step_id());
@@ -374,21 +381,27 @@ Allocator* OpKernelContext::get_allocator(AllocatorAttributes attr) {
     allocator = params_->device->GetAllocator(attr);
   }
   if (TF_PREDICT_FALSE(track_allocations())) {
-    DCHECK(tracking_state_);
-    mutex_lock lock(tracking_state_->mu);
-    for (const auto& wrapped : tracking_state_->wrapped_allocators) {
-      if (wrapped.first == allocator) {
-        return wrapped.second;
-      }
+    allocator = GetTrackingAllocator(allocator);
+  }
+  if (is_default_attr) {
+    default_allocator_.store(allocator, std::memory_order_release);
+  }
+  return allocator;
+}
+
+Allocator* OpKernelContext::GetTrackingAllocator(Allocator* allocator) {
+  DCHECK(tracking_state_);
+  mutex_lock lock(tracking_state_->mu);
+  for (const auto& wrapped : tracking_state_->wrapped_allocators) {
+    if (wrapped.first == allocator) {
+      return wrapped.second;
     }
-    TrackingAllocator* wrapped_allocator =
-        new TrackingAllocator(allocator, params_->track_allocations);
-    tracking_state_->wrapped_allocators.push_back(
-        std::make_pair(allocator, wrapped_allocator));
-    return wrapped_allocator;
-  } else {
-    return allocator;
   }
+  TrackingAllocator* wrapped_allocator =
+      new TrackingAllocator(allocator, params_->track_allocations);
+  tracking_state_->wrapped_allocators.push_back(
+      std::make_pair(allocator, wrapped_allocator));
+  return wrapped_allocator;
 }
 
 void OpKernelContext::SetStatus(const Status& status) {
@@ -711,7 +724,13 @@ Status OpKernelContext::allocate_output(StringPiece name,
 Status OpKernelContext::allocate_tensor(
     DataType type, const TensorShape& shape, Tensor* out_tensor,
     AllocatorAttributes attr, const AllocationAttributes& allocation_attr) {
-  Allocator* a = get_allocator(attr);
+  return allocate_tensor(get_allocator(attr), type, shape, out_tensor,
+                         allocation_attr);
+}
+
+Status OpKernelContext::allocate_tensor(
+    Allocator* a, DataType type, const TensorShape& shape, Tensor* out_tensor,
+    const AllocationAttributes& allocation_attr) {
   Tensor new_tensor(
       a, type, shape,
       AllocationAttributes(
@@ -732,6 +751,21 @@ Status OpKernelContext::allocate_tensor(
   return Status::OK();
 }
 
+Allocator* OpKernelContext::get_step_arena_allocator(DataType type,
+                                                    const TensorShape& shape,
+                                                    AllocatorAttributes attr) {
+  if (params_->step_arena_allocator == nullptr || attr.value != 0 ||
+      attr.scope_id != 0 || track_allocations() ||
+      !DataTypeCanUseMemcpy(type)) {
+    return nullptr;
+  }
+  const int64 num_bytes = shape.num_elements() * DataTypeSize(type);
+  if (num_bytes == 0 || num_bytes > params_->step_arena_max_allocation_size) {
+    return nullptr;
+  }
+  return params_->step_arena_allocator;
+}
+
 Status OpKernelContext::allocate_output(int index, const TensorShape& shape,
                                         Tensor** output,
                                         AllocatorAttributes attr) {
@@ -769,7 +803,18 @@ Status OpKernelContext::allocate_output(int index, const TensorShape& shape,
   ScopedMemoryDebugAnnotation op_annotation(op_kernel().name_view().data(),
                                             step_id(), "output", type, &shape);
   auto output_tensor = MakeUnique<Tensor>();
-  Status s = allocate_tensor(type, shape, output_tensor.get(), attr);
+  Allocator* output_allocator = nullptr;
+  if (params_->output_allocator_array != nullptr && attr.value == 0 &&
+      attr.scope_id == 0 && !track_allocations()) {
+    output_allocator = params_->output_allocator_array[index];
+  }
+  if (output_allocator == nullptr) {
+    output_allocator = get_step_arena_allocator(type, shape, attr);
+  }
+  Status s = output_allocator != nullptr
+                 ? allocate_tensor(output_allocator, type, shape,
+                                   output_tensor.get(), AllocationAttributes())
+                 : allocate_tensor(type, shape, output_tensor.get(), attr);
   if (s.ok()) {
     outputs_[index] = TensorValue(output_tensor.release());
     *output = outputs_[index].tensor;
@@ -799,8 +844,13 @@ Status OpKernelContext::allocate_temp(
   }
   ScopedMemoryDebugAnnotation op_annotation(op_kernel().name_view().data(),
                                             step_id(), "temp", type, &shape);
-  Status s =
-      allocate_tensor(type, shape, out_temp, allocator_attr, allocation_attr);
+  Allocator* step_arena_allocator =
+      get_step_arena_allocator(type, shape, allocator_attr);
+  Status s = step_arena_allocator != nullptr
+                 ? allocate_tensor(step_arena_allocator, type, shape, out_temp,
+                                   allocation_attr)
+                 : allocate_tensor(type, shape, out_temp, allocator_attr,
+                                   allocation_attr);
   if (track_allocations() && s.ok() && out_temp->TotalBytes() > 0) {
     Allocator* a = get_allocator(allocator_attr);
     if (a->TracksAllocationSizes()) {
@@ -1234,9 +1284,17 @@ void LoadDynamicKernels() {
   absl::call_once(dll_loader_flag, LoadDynamicKernelsInternal);
 }
 
+static constexpr size_t kInitialKernelRegistryCapacity = 8192;
+
 void* GlobalKernelRegistry() {
   static KernelRegistry* global_kernel_registry = []() {
     KernelRegistry* registry = new KernelRegistry;
+    {
+      // A full build registers several thousand kernels from static
+      // initializers; size the table up front to avoid rehashing them.
+      mutex_lock l(registry->mu);
+      registry->registry.reserve(kInitialKernelRegistryCapacity);
+    }
     OpRegistry::Global()->RegisterValidator(ValidateKernelRegistrations);
     return registry;
   }();
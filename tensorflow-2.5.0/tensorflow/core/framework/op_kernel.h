@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_OP_KERNEL_H_
 #define TENSORFLOW_CORE_FRAMEWORK_OP_KERNEL_H_
 
+#include <atomic>
 #include <functional>
 #include <unordered_set>
 #include <utility>
@@ -636,6 +637,18 @@ class OpKernelContext {
     // Array indexed by output number for this node
     const AllocatorAttributes* output_attr_array = nullptr;
 
+    // Array indexed by output number for this node. A non-null entry replaces
+    // the device allocator for outputs allocated with default attributes, e.g.
+    // to place them in a memory arena planned by the executor.
+    Allocator* const* output_allocator_array = nullptr;
+
+    // If not null, replaces the device allocator for the outputs and
+    // temporaries of memcpy-able types of at most
+    // step_arena_max_allocation_size bytes allocated with default attributes,
+    // e.g. to allocate small host tensors from an arena owned by the step.
+    Allocator* step_arena_allocator = nullptr;
+    int64 step_arena_max_allocation_size = 0;
+
     // Shared resources accessible by this op kernel invocation.
     ResourceMgr* resource_manager = nullptr;
 
@@ -1280,6 +1293,10 @@ class OpKernelContext {
  private:
   bool record_memory_consumption_ = false;
 
+  // Returns the TrackingAllocator wrapping `allocator` for this context,
+  // creating it on first use.
+  Allocator* GetTrackingAllocator(Allocator* allocator);
+
   // Internal common method used when allocating tensor memory
   Status allocate_tensor(DataType type, const TensorShape& shape,
                          Tensor* out_tensor,
@@ -1292,6 +1309,15 @@ class OpKernelContext {
                          Tensor* out_tensor, AllocatorAttributes allocator_attr,
                          const AllocationAttributes& allocation_attr);
 
+  Status allocate_tensor(Allocator* a, DataType type, const TensorShape& shape,
+                         Tensor* out_tensor,
+                         const AllocationAttributes& allocation_attr);
+
+  // Returns params_->step_arena_allocator if a tensor of the given type and
+  // shape, allocated with `attr`, can come from it, or nullptr.
+  Allocator* get_step_arena_allocator(DataType type, const TensorShape& shape,
+                                      AllocatorAttributes attr);
+
   // Helpers for `set_output()`.
 
   // Returns `true` if the tensor was copied into an allocated output.
@@ -1315,6 +1341,10 @@ class OpKernelContext {
   // TODO(ayushd): change to absl::flat_hash_set.
   std::unique_ptr<std::unordered_set<int32>> allocated_scope_ids_;
 
+  // The allocator returned by `get_allocator(AllocatorAttributes())`, filled
+  // in on first use. Atomic because kernels may allocate from several threads.
+  std::atomic<Allocator*> default_allocator_{nullptr};
+
   // The following data members are only used when allocation tracking is
   // enabled, memory consumption is being recorded, or tensor access is being
   // recorded.
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 #include <memory>
+#include <vector>
 
 #include "tensorflow/core/framework/op.h"
 
@@ -58,4 +59,27 @@ TEST(OpRegistrationTest, TestDuplicate) {
   EXPECT_TRUE(s.ok());
 }
 
+TEST(OpRegistrationTest, NamedRegistrationsAreBuiltOnLookUp) {
+  std::unique_ptr<OpRegistry> registry(new OpRegistry);
+  std::vector<string> built;
+  for (const string op_name : {"Foo", "Bar"}) {
+    registry->Register(op_name, [op_name, &built](
+                                    OpRegistrationData* op_reg_data) -> Status {
+      built.push_back(op_name);
+      op_reg_data->op_def.set_name(op_name);
+      return Status::OK();
+    });
+  }
+
+  const OpRegistrationData* op_reg_data = nullptr;
+  TF_EXPECT_OK(registry->LookUp("Foo", &op_reg_data));
+  EXPECT_EQ(op_reg_data->op_def.name(), "Foo");
+  EXPECT_EQ(built, std::vector<string>({"Foo"}));
+
+  OpList op_list;
+  registry->Export(true, &op_list);
+  EXPECT_EQ(op_list.op().size(), 2);
+  EXPECT_EQ(built, std::vector<string>({"Foo", "Bar"}));
+}
+
 }  // namespace tensorflow
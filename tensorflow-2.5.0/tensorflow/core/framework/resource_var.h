@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_RESOURCE_VAR_H_
 #define TENSORFLOW_CORE_FRAMEWORK_RESOURCE_VAR_H_
 
+#include <atomic>
+#include <memory>
+
 #include "tensorflow/core/framework/resource_mgr.h"
 
 namespace tensorflow {
@@ -57,6 +60,17 @@ namespace tensorflow {
 // mutex as desired. To access the variable in dense mode grab the mutex either
 // directly or via `MaybeLockVariableInputMutexesInOrder` on all variables being
 // modified and then call `PrepareToUpdateVariable` on them in any order.
+//
+// Variables that are read far more often than they are written (e.g. weights
+// that are only ever replaced wholesale while serving) can opt into lock-free
+// reads with `EnableLockFreeReads()`. In this mode the variable keeps a
+// published snapshot of its tensor that dense reads load atomically without
+// touching the mutex. The snapshot aliases the variable's buffer, so the
+// copy-on-write logic above guarantees writers never modify a published buffer
+// in place; they write to a copy and then call `PublishSnapshot()` while still
+// holding the exclusive lock. Lock-free reads and copy-on-read mode are
+// mutually exclusive: sparse writes are rejected, and sparse reads go through
+// the shared lock without switching the variable to copy-on-read mode.
 class Var : public ResourceBase {
  public:
   explicit Var(DataType dtype) : tensor_(dtype) {}
@@ -87,9 +101,35 @@ class Var : public ResourceBase {
   // so desired.
   std::atomic<bool> copy_on_read_mode{false};
 
+  // Switches the variable to lock-free reads and publishes its current value.
+  // REQUIRES: *mu() held exclusively and copy_on_read_mode is false.
+  void EnableLockFreeReads() {
+    // Publish before setting the flag so readers never see an empty snapshot.
+    std::atomic_store(&snapshot_, std::make_shared<const Tensor>(tensor_));
+    lock_free_reads_.store(true);
+  }
+  bool lock_free_reads() const { return lock_free_reads_.load(); }
+
+  // Makes the current value of tensor() visible to lock-free readers. A no-op
+  // unless lock-free reads are enabled.
+  // REQUIRES: *mu() held exclusively.
+  void PublishSnapshot() {
+    if (lock_free_reads_.load()) {
+      std::atomic_store(&snapshot_, std::make_shared<const Tensor>(tensor_));
+    }
+  }
+
+  // Returns the most recently published value. Does not need *mu().
+  // REQUIRES: lock_free_reads() is true.
+  std::shared_ptr<const Tensor> snapshot() const {
+    return std::atomic_load(&snapshot_);
+  }
+
  private:
   mutex mu_;
   Tensor tensor_;
+  std::atomic<bool> lock_free_reads_{false};
+  std::shared_ptr<const Tensor> snapshot_;
 
   ~Var() override {}
   TF_DISALLOW_COPY_AND_ASSIGN(Var);
@@ -23,6 +23,7 @@ limitations under the License.
 #include <memory>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/run_handler_util.h"
 #include "tensorflow/core/lib/core/threadpool_interface.h"
 #include "tensorflow/core/lib/strings/strcat.h"
@@ -82,6 +83,10 @@ RunHandlerEnvironment::Task RunHandlerEnvironment::CreateTask(
 }
 
 void RunHandlerEnvironment::ExecuteTask(const Task& t) {
+  if (t.f->queueing_delay_cell != nullptr) {
+    t.f->queueing_delay_cell->Add(EnvTime::NowMicros() -
+                                  t.f->enqueue_time_us);
+  }
   WithContext wc(t.f->context);
   tracing::ScopedRegion region(tracing::EventCategory::kRunClosure,
                                t.f->trace_id);
@@ -131,6 +136,8 @@ ThreadWorkSource::ThreadWorkSource()
       blocking_inflight_(0),
       non_blocking_inflight_(0),
       traceme_id_(0),
+      priority_(0),
+      queueing_delay_cell_(nullptr),
       version_(0),
       sub_thread_pool_waiter_(nullptr) {
   queue_waiters_.next = &queue_waiters_;
@@ -260,6 +267,22 @@ int64 ThreadWorkSource::GetTracemeId() {
 
 void ThreadWorkSource::SetTracemeId(int64 value) { traceme_id_ = value; }
 
+int64 ThreadWorkSource::GetPriority() {
+  return priority_.load(std::memory_order_relaxed);
+}
+
+void ThreadWorkSource::SetPriority(int64 value) {
+  priority_.store(value, std::memory_order_relaxed);
+}
+
+monitoring::SamplerCell* ThreadWorkSource::GetQueueingDelayCell() {
+  return queueing_delay_cell_.load(std::memory_order_relaxed);
+}
+
+void ThreadWorkSource::SetQueueingDelayCell(monitoring::SamplerCell* cell) {
+  queueing_delay_cell_.store(cell, std::memory_order_relaxed);
+}
+
 void ThreadWorkSource::SetWaiter(uint64 version, Waiter* waiter, mutex* mutex) {
   {
     tf_shared_lock lock(run_handler_waiter_mu_);
@@ -320,6 +343,7 @@ RunHandlerThreadPool::RunHandlerThreadPool(
       num_non_blocking_threads_(num_non_blocking_threads),
       thread_data_(num_threads_),
       env_(env, thread_options, name),
+      max_active_priority_(kint64min),
       name_(name),
       waiters_mu_(waiters_mu),
       queue_waiters_(queue_waiters),
@@ -384,6 +408,12 @@ void RunHandlerThreadPool::AddWorkToQueue(ThreadWorkSource* tws,
                                           bool is_blocking,
                                           std::function<void()> fn) {
   Task t = env_.CreateTask(std::move(fn));
+  if (is_blocking) {
+    t.f->queueing_delay_cell = tws->GetQueueingDelayCell();
+    if (t.f->queueing_delay_cell != nullptr) {
+      t.f->enqueue_time_us = EnvTime::NowMicros();
+    }
+  }
   t = tws->EnqueueTask(std::move(t), is_blocking);
   if (t.f) {
     VLOG(3) << "Running " << (is_blocking ? "inter" : "intra") << " work for "
@@ -440,6 +470,10 @@ void RunHandlerThreadPool::SetThreadWorkSources(
   }
 }
 
+void RunHandlerThreadPool::SetMaxActivePriority(int64 priority) {
+  max_active_priority_.store(priority, std::memory_order_relaxed);
+}
+
 RunHandlerThreadPool::PerThread* RunHandlerThreadPool::GetPerThread() {
   thread_local RunHandlerThreadPool::PerThread per_thread_;
   RunHandlerThreadPool::PerThread* pt = &per_thread_;
@@ -516,6 +550,39 @@ Task RunHandlerThreadPool::FindTask(
   return t;
 }
 
+Task RunHandlerThreadPool::FindHigherPriorityTask(
+    int64 priority, int thread_id, int max_blocking_inflight,
+    bool may_steal_blocking_work,
+    const Eigen::MaxSizeVector<ThreadWorkSource*>& thread_work_sources,
+    bool* task_from_blocking_queue, ThreadWorkSource** tws) {
+  Task t;
+  if (priority >= max_active_priority_.load(std::memory_order_relaxed)) {
+    return t;
+  }
+  for (int i = 0; i < thread_work_sources.size(); ++i) {
+    ThreadWorkSource* source = thread_work_sources[i];
+    if (source->GetPriority() <= priority) {
+      continue;
+    }
+    if (may_steal_blocking_work &&
+        source->GetInflightTaskCount(true) < max_blocking_inflight) {
+      t = source->PopBlockingTask();
+      if (t.f) {
+        *task_from_blocking_queue = true;
+        *tws = source;
+        return t;
+      }
+    }
+    t = source->PopNonBlockingTask(thread_id, true);
+    if (t.f) {
+      *task_from_blocking_queue = false;
+      *tws = source;
+      return t;
+    }
+  }
+  return t;
+}
+
 // Main worker thread loop.
 void RunHandlerThreadPool::WorkerLoop(int thread_id,
                                       bool may_steal_blocking_work) {
@@ -558,10 +625,21 @@ void RunHandlerThreadPool::WorkerLoop(int thread_id,
             std::min(active_requests,
                      std::max(search_range_end, search_range_start + 1));
 
-        t = FindTask(search_range_start, search_range_end, thread_id,
-                     sub_thread_pool_id, kMaxBlockingInflight,
-                     /*may_steal_blocking_work=*/true, *thread_work_sources,
-                     &task_from_blocking_queue, &tws);
+        if (search_range_start < active_requests) {
+          // Higher priority requests take precedence over the requests of
+          // this sub thread pool.
+          t = FindHigherPriorityTask(
+              (*thread_work_sources)[search_range_start]->GetPriority(),
+              thread_id, kMaxBlockingInflight,
+              /*may_steal_blocking_work=*/true, *thread_work_sources,
+              &task_from_blocking_queue, &tws);
+        }
+        if (!t.f) {
+          t = FindTask(search_range_start, search_range_end, thread_id,
+                       sub_thread_pool_id, kMaxBlockingInflight,
+                       /*may_steal_blocking_work=*/true, *thread_work_sources,
+                       &task_from_blocking_queue, &tws);
+        }
         if (!t.f) {
           // Search from all requests if the thread cannot find tasks from
           // requests that belong to its own sub thread pool.
@@ -579,9 +657,18 @@ void RunHandlerThreadPool::WorkerLoop(int thread_id,
                      &task_from_blocking_queue, &tws);
       }
     } else {
+      if (!thread_work_sources->empty()) {
+        // A thread whose primary work source belongs to a lower priority
+        // request yields to higher priority requests between tasks; closures
+        // that are already running are never preempted.
+        t = FindHigherPriorityTask(
+            (*thread_work_sources)[0]->GetPriority(), thread_id,
+            kMaxBlockingInflight, may_steal_blocking_work,
+            *thread_work_sources, &task_from_blocking_queue, &tws);
+      }
       // TODO(chaox): Refactor the following code to share the logic with
       // FindTask.
-      for (int i = 0; i < thread_work_sources->size(); ++i) {
+      for (int i = 0; !t.f && i < thread_work_sources->size(); ++i) {
         tws = (*thread_work_sources)[i];
         // We want a smallish numbers of inter threads since
         // otherwise there will be contention in PropagateOutputs.
@@ -728,6 +815,9 @@ class RunHandler::Impl {
   // Stores now time (in microseconds) since unix epoch when the handler is
   // requested via RunHandlerPool::Get().
   uint64 start_time_us() const { return start_time_us_; }
+  // The deadline of the request in microseconds since unix epoch, or
+  // kuint64max if it has none.
+  uint64 deadline_us() const { return deadline_us_; }
   int64 step_id() const { return step_id_; }
   void ScheduleInterOpClosure(std::function<void()> fn);
   void ScheduleIntraOpClosure(std::function<void()> fn);
@@ -739,7 +829,16 @@ class RunHandler::Impl {
 
   internal::ThreadWorkSource* tws() { return &tws_; }
 
-  int64 priority() { return options_.priority(); }
+  int64 priority() const { return options_.priority(); }
+
+  // Whether this handler should be served before `other`: handlers are
+  // ordered by decreasing priority, then by increasing deadline.
+  bool HasPrecedenceOver(const Impl& other) const {
+    if (priority() != other.priority()) {
+      return priority() > other.priority();
+    }
+    return deadline_us_ < other.deadline_us_;
+  }
 
  private:
   class ThreadPoolInterfaceWrapper : public thread::ThreadPoolInterface {
@@ -757,6 +856,7 @@ class RunHandler::Impl {
 
   RunHandlerPool::Impl* pool_impl_;  // NOT OWNED.
   uint64 start_time_us_;
+  uint64 deadline_us_;
   int64 step_id_;
   std::unique_ptr<thread::ThreadPoolInterface> thread_pool_interface_;
   internal::ThreadWorkSource tws_;
@@ -862,12 +962,11 @@ class RunHandlerPool::Impl {
 
       num_active_requests = sorted_active_handlers_.size() + 1;
       thread_work_sources->resize(num_active_requests);
-      int priority = options.priority();
       auto it = sorted_active_handlers_.cbegin();
       bool new_handler_inserted = false;
       for (int i = 0; i < num_active_requests; ++i) {
         if (!new_handler_inserted && (it == sorted_active_handlers_.cend() ||
-                                      priority > (*it)->priority())) {
+                                      handler_impl->HasPrecedenceOver(**it))) {
           sorted_active_handlers_.insert(it, handler_impl);
           new_handler_inserted = true;
           // Point to the newly added handler.
@@ -877,6 +976,8 @@ class RunHandlerPool::Impl {
         ++it;
       }
       version = ++version_;
+      run_handler_thread_pool_->SetMaxActivePriority(
+          sorted_active_handlers_.front()->priority());
     }
     RecomputePoolStats(num_active_requests, version, *thread_work_sources);
     return WrapUnique<RunHandler>(new RunHandler(handler_impl));
@@ -905,6 +1006,10 @@ class RunHandlerPool::Impl {
     // handlers.
     sorted_active_handlers_.erase(iter);
     free_handlers_.push_back(handler);
+    run_handler_thread_pool_->SetMaxActivePriority(
+        sorted_active_handlers_.empty()
+            ? kint64min
+            : sorted_active_handlers_.front()->priority());
     DCHECK_LE(free_handlers_.size(), max_handlers_);
     LogInfo();
 
@@ -923,6 +1028,16 @@ class RunHandlerPool::Impl {
     return ret;
   }
 
+  std::vector<int64> GetActiveHandlerStepIdsForTesting()
+      TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    std::vector<int64> ret;
+    for (const auto& handler_impl : sorted_active_handlers_) {
+      ret.push_back(handler_impl->step_id());
+    }
+    return ret;
+  }
+
  private:
   void RecomputePoolStats(
       int num_active_requests, uint64 version,
@@ -942,8 +1057,7 @@ class RunHandlerPool::Impl {
 
   std::unique_ptr<internal::RunHandlerThreadPool> run_handler_thread_pool_;
   // Thread compatible part used only by lock under RunHandlerPool.
-  // Handlers are sorted by start time.
-  // TODO(azaks): sort by the remaining latency budget.
+  // Handlers are sorted by priority, then deadline, then start time.
   // TODO(chaox): Consider other data structure for maintaining the sorted
   // active handlers if the searching overhead(currently O(n)) becomes the
   // bottleneck.
@@ -1067,9 +1181,15 @@ void RunHandler::Impl::Reset(
     int64 step_id,
     const RunOptions::Experimental::RunHandlerPoolOptions& options) {
   start_time_us_ = tensorflow::Env::Default()->NowMicros();
+  deadline_us_ = options.deadline_in_ms() > 0
+                     ? start_time_us_ + options.deadline_in_ms() * 1000
+                     : kuint64max;
   step_id_ = step_id;
   options_ = options;
   tws_.SetTracemeId(step_id);
+  tws_.SetPriority(options.priority());
+  tws_.SetQueueingDelayCell(
+      metrics::GetRunHandlerQueueingDelayCell(options.priority()));
 }
 
 RunHandlerPool::RunHandlerPool(int num_inter_op_threads)
@@ -1092,6 +1212,10 @@ std::vector<int64> RunHandlerPool::GetActiveHandlerPrioritiesForTesting()
   return impl_->GetActiveHandlerPrioritiesForTesting();
 }
 
+std::vector<int64> RunHandlerPool::GetActiveHandlerStepIdsForTesting() const {
+  return impl_->GetActiveHandlerStepIdsForTesting();
+}
+
 RunHandler::RunHandler(Impl* impl) : impl_(impl) {}
 
 void RunHandler::ScheduleInterOpClosure(std::function<void()> fn) {
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/histogram/histogram.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/platform/context.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -72,6 +73,10 @@ class RunHandlerPool {
   // order of the active handler list.
   std::vector<int64> GetActiveHandlerPrioritiesForTesting() const;
 
+  // Get the step ids of active handlers, in the same order as the active
+  // handler list.
+  std::vector<int64> GetActiveHandlerStepIdsForTesting() const;
+
  private:
   class Impl;
   friend class RunHandler;
@@ -81,8 +86,9 @@ class RunHandlerPool {
 
 // RunHandler can be used to schedule inter/intra-op closures to run on a global
 // pool shared across all Session::Run(s). The closures are enqueued to a
-// handler specific queue, from which the work is stolen in a priority order
-// (time of the Get() call).
+// handler specific queue, from which the work is stolen in a priority order:
+// by RunHandlerPoolOptions.priority, then by deadline, then by the time of the
+// Get() call.
 //
 // It can only be created via RunHandlerPool::Get().
 //
@@ -116,6 +122,9 @@ class RunHandlerEnvironment {
     std::function<void()> f;
     Context context;
     uint64 trace_id;
+    // If set, receives the time between the task being enqueued and run.
+    monitoring::SamplerCell* queueing_delay_cell = nullptr;
+    uint64 enqueue_time_us = 0;
   };
   Env* const env_;
   const ThreadOptions thread_options_;
@@ -173,6 +182,16 @@ class ThreadWorkSource {
 
   void SetTracemeId(int64 value);
 
+  // The RunHandlerPoolOptions.priority of the request owning this source.
+  int64 GetPriority();
+
+  void SetPriority(int64 value);
+
+  // Cell recording the queueing delay of blocking tasks, or nullptr.
+  monitoring::SamplerCell* GetQueueingDelayCell();
+
+  void SetQueueingDelayCell(monitoring::SamplerCell* cell);
+
   void SetWaiter(uint64 version, Waiter* waiter, mutex* mutex);
 
   int64 GetInflightTaskCount(bool is_blocking);
@@ -204,6 +223,8 @@ class ThreadWorkSource {
   mutex waiters_mu_;
   Waiter queue_waiters_ TF_GUARDED_BY(waiters_mu_);
   std::atomic<int64> traceme_id_;
+  std::atomic<int64> priority_;
+  std::atomic<monitoring::SamplerCell*> queueing_delay_cell_;
 
   mutex run_handler_waiter_mu_;
   uint64 version_ TF_GUARDED_BY(run_handler_waiter_mu_);
@@ -241,6 +262,11 @@ class RunHandlerThreadPool {
       int tid, int start_request_idx, uint64 version,
       const Eigen::MaxSizeVector<ThreadWorkSource*>& thread_work_sources);
 
+  // Sets the highest priority among the active requests. Threads working on
+  // the sources of lower priority requests check the sources of higher
+  // priority requests first whenever they look for a new task.
+  void SetMaxActivePriority(int64 priority);
+
   PerThread* GetPerThread();
 
   int CurrentThreadId() const;
@@ -263,6 +289,14 @@ class RunHandlerThreadPool {
       const Eigen::MaxSizeVector<ThreadWorkSource*>& thread_work_sources,
       bool* task_from_blocking_queue, ThreadWorkSource** tws);
 
+  // Searches for a task in the sources whose priority is higher than
+  // `priority`, if there are any.
+  Task FindHigherPriorityTask(
+      int64 priority, int thread_id, int max_blocking_inflight,
+      bool may_steal_blocking_work,
+      const Eigen::MaxSizeVector<ThreadWorkSource*>& thread_work_sources,
+      bool* task_from_blocking_queue, ThreadWorkSource** tws);
+
   void WaitForWork(bool is_blocking, int thread_id,
                    int32 max_blocking_inflight);
 
@@ -293,6 +327,7 @@ class RunHandlerThreadPool {
   Eigen::MaxSizeVector<ThreadData> thread_data_;
   internal::RunHandlerEnvironment env_;
   std::atomic<bool> cancelled_;
+  std::atomic<int64> max_active_priority_;
   string name_;
   Eigen::MaxSizeVector<mutex>* waiters_mu_;
   Eigen::MaxSizeVector<Waiter>* queue_waiters_;
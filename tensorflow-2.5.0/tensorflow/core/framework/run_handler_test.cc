@@ -113,6 +113,104 @@ TEST(RunHandlerUtilTest, PrioritySchedulingTest) {
   EXPECT_EQ(sorted_active_list[3], 1);
 }
 
+TEST(RunHandlerUtilTest, DeadlineSchedulingTest) {
+  int num_threads = 2;
+  std::unique_ptr<RunHandlerPool> pool(
+      new RunHandlerPool(num_threads, num_threads));
+
+  // Among requests of the same priority, the ones with a deadline go first,
+  // and an earlier deadline goes before a later one. Priorities still take
+  // precedence over deadlines.
+  RunOptions::Experimental::RunHandlerPoolOptions options;
+  options.set_priority(1);
+  auto handler1 = pool->Get(/*step_id=*/1, /*timeout_in_ms=*/0, options);
+  options.set_priority(2);
+  options.set_deadline_in_ms(100000);
+  auto handler2 = pool->Get(/*step_id=*/2, /*timeout_in_ms=*/0, options);
+  options.set_priority(1);
+  options.set_deadline_in_ms(10);
+  auto handler3 = pool->Get(/*step_id=*/3, /*timeout_in_ms=*/0, options);
+  options.set_priority(0);
+  auto handler4 = pool->Get(/*step_id=*/4, /*timeout_in_ms=*/0, options);
+
+  std::vector<int64> sorted_active_list =
+      pool->GetActiveHandlerPrioritiesForTesting();
+  EXPECT_EQ(sorted_active_list.size(), 4);
+  EXPECT_EQ(sorted_active_list[0], 2);
+  EXPECT_EQ(sorted_active_list[1], 1);
+  EXPECT_EQ(sorted_active_list[2], 1);
+  EXPECT_EQ(sorted_active_list[3], 0);
+
+  // handler3 has the same priority as handler1 but a 10ms deadline, so it
+  // comes first although it was requested later.
+  std::vector<int64> sorted_step_ids =
+      pool->GetActiveHandlerStepIdsForTesting();
+  EXPECT_EQ(sorted_step_ids, std::vector<int64>({2, 3, 1, 4}));
+
+  // The closures of every request still run to completion.
+  BlockingCounter counter(4);
+  for (auto* handler : {&handler1, &handler2, &handler3, &handler4}) {
+    (*handler)->ScheduleInterOpClosure([&counter]() {
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+}
+
+TEST(RunHandlerThreadPool, FindHigherPriorityTask) {
+  Eigen::MaxSizeVector<mutex> waiters_mu(2);
+  waiters_mu.resize(2);
+  Eigen::MaxSizeVector<internal::Waiter> waiters(2);
+  waiters.resize(2);
+  internal::RunHandlerThreadPool run_handler_thread_pool(
+      /*num_blocking_threads=*/0, /*num_non_blocking_threads=*/0,
+      Env::Default(), ThreadOptions(), "tf_run_handler_pool", &waiters_mu,
+      &waiters);
+  internal::ThreadWorkSource low_tws;
+  low_tws.SetPriority(1);
+  internal::ThreadWorkSource high_tws;
+  high_tws.SetPriority(2);
+  Eigen::MaxSizeVector<internal::ThreadWorkSource*> thread_work_sources(2);
+  thread_work_sources.push_back(&high_tws);
+  thread_work_sources.push_back(&low_tws);
+  run_handler_thread_pool.SetMaxActivePriority(2);
+
+  int result = 0;
+  run_handler_thread_pool.AddWorkToQueue(&low_tws, /*is_blocking=*/true,
+                                         [&result] { result = 1; });
+  run_handler_thread_pool.AddWorkToQueue(&high_tws, /*is_blocking=*/false,
+                                         [&result] { result = 2; });
+
+  bool task_from_blocking_queue;
+  internal::ThreadWorkSource* tws = nullptr;
+  // No request has a higher priority than the highest active one.
+  internal::Task t = run_handler_thread_pool.FindHigherPriorityTask(
+      /*priority=*/2, /*thread_id=*/0, /*max_blocking_inflight=*/10,
+      /*may_steal_blocking_work=*/true, thread_work_sources,
+      &task_from_blocking_queue, &tws);
+  EXPECT_FALSE(t.f);
+
+  // Only work of the higher priority request is picked up.
+  t = run_handler_thread_pool.FindHigherPriorityTask(
+      /*priority=*/1, /*thread_id=*/0, /*max_blocking_inflight=*/10,
+      /*may_steal_blocking_work=*/true, thread_work_sources,
+      &task_from_blocking_queue, &tws);
+  ASSERT_TRUE(t.f);
+  EXPECT_EQ(tws, &high_tws);
+  EXPECT_FALSE(task_from_blocking_queue);
+  t.f->f();
+  EXPECT_EQ(result, 2);
+
+  t = run_handler_thread_pool.FindHigherPriorityTask(
+      /*priority=*/1, /*thread_id=*/0, /*max_blocking_inflight=*/10,
+      /*may_steal_blocking_work=*/true, thread_work_sources,
+      &task_from_blocking_queue, &tws);
+  EXPECT_FALSE(t.f);
+  EXPECT_EQ(low_tws.TaskQueueSize(/*is_blocking=*/true), 1);
+  low_tws.PopBlockingTask().f->f();
+  EXPECT_EQ(result, 1);
+}
+
 TEST(RunHandlerThreadPool, EnqueueTask) {
   Eigen::MaxSizeVector<mutex> waiters_mu(2);
   waiters_mu.resize(2);
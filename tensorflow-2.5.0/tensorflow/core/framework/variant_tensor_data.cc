@@ -43,8 +43,12 @@ void VariantTensorData::ToProto(VariantTensorDataProto* proto) const {
   proto->set_type_name(type_name());
   proto->set_metadata(metadata_);
   proto->clear_tensors();
+  proto->mutable_tensors()->Reserve(tensors_.size());
   for (const auto& tensor : tensors_) {
-    tensor.AsProtoField(proto->mutable_tensors()->Add());
+    // Encode the nested tensors as raw `tensor_content` bytes rather than
+    // element-by-element repeated fields: the buffer is shared or copied
+    // wholesale instead of being converted one value at a time.
+    tensor.AsProtoTensorContent(proto->mutable_tensors()->Add());
   }
 }
 
@@ -52,10 +56,11 @@ bool VariantTensorData::FromProto(VariantTensorDataProto proto) {
   // TODO(ebrevdo): Do this lazily.
   set_type_name(proto.type_name());
   set_metadata(proto.metadata());
+  tensors_.reserve(tensors_.size() + proto.tensors_size());
   for (const auto& tensor : proto.tensors()) {
     Tensor tmp;
     if (!tmp.FromProto(tensor)) return false;
-    tensors_.push_back(tmp);
+    tensors_.push_back(std::move(tmp));
   }
   return true;
 }
@@ -63,10 +68,11 @@ bool VariantTensorData::FromProto(VariantTensorDataProto proto) {
 bool VariantTensorData::FromConstProto(const VariantTensorDataProto& proto) {
   set_type_name(proto.type_name());
   set_metadata(proto.metadata());
+  tensors_.reserve(tensors_.size() + proto.tensors_size());
   for (const auto& tensor : proto.tensors()) {
     Tensor tmp;
     if (!tmp.FromProto(tensor)) return false;
-    tensors_.push_back(tmp);
+    tensors_.push_back(std::move(tmp));
   }
   return true;
 }
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/variant_encode_decode.h"
 #include "tensorflow/core/framework/variant_tensor_data.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
@@ -595,6 +596,35 @@ TEST(VariantTest, TensorListTest) {
                 "Variant<type: TensorList value: ", data.DebugString(), ">"));
 }
 
+TEST(VariantTest, TensorListProtoUsesTensorContent) {
+  TensorList vec;
+  Tensor ints(DT_INT32, {3});
+  ints.flat<int>().setValues({1, 2, 3});
+  vec.vec.push_back(ints);
+  Tensor strings(DT_STRING, {2});
+  strings.flat<tstring>().setValues({"a", "bc"});
+  vec.vec.push_back(strings);
+  const Variant x = vec;
+
+  VariantTensorData serialized;
+  x.Encode(&serialized);
+  VariantTensorDataProto data;
+  serialized.ToProto(&data);
+  ASSERT_EQ(data.tensors_size(), 2);
+  EXPECT_FALSE(data.tensors(0).tensor_content().empty());
+  EXPECT_EQ(data.tensors(0).int_val_size(), 0);
+  EXPECT_EQ(data.tensors(1).string_val_size(), 0);
+
+  VariantTensorData parsed;
+  ASSERT_TRUE(parsed.FromProto(data));
+  Variant y = TensorList();
+  ASSERT_TRUE(y.Decode(parsed));
+  const TensorList& decoded_vec = *y.get<TensorList>();
+  ASSERT_EQ(decoded_vec.vec.size(), 2);
+  test::ExpectTensorEqual<int>(decoded_vec.vec[0], ints);
+  test::ExpectTensorEqual<tstring>(decoded_vec.vec[1], strings);
+}
+
 template <bool BIG>
 void TestVariantArray() {
   Variant x[2];
@@ -460,17 +460,29 @@ Node* Graph::AddNode(NodeDef node_def, Status* status) {
     return nullptr;
   }
 
+  return AddNode(std::move(node_def), op_reg_data, std::move(inputs),
+                 std::move(outputs));
+}
+
+Node* Graph::AddNode(NodeDef node_def, const OpRegistrationData* op_reg_data,
+                     DataTypeVector inputs, DataTypeVector outputs) {
   Node::NodeClass node_class = op_reg_data->is_function_op
                                    ? Node::NC_FUNCTION_OP
                                    : Node::GetNodeClassForOp(node_def.op());
 
   Node* node = AllocateNode(
       std::make_shared<NodeProperties>(&op_reg_data->op_def,
-                                       std::move(node_def), inputs, outputs),
+                                       std::move(node_def), std::move(inputs),
+                                       std::move(outputs)),
       nullptr, node_class);
   return node;
 }
 
+void Graph::Reserve(int num_nodes, int num_edges) {
+  nodes_.reserve(nodes_.size() + num_nodes);
+  edges_.reserve(edges_.size() + num_edges);
+}
+
 Node* Graph::CopyNode(const Node* node) {
   DCHECK(!node->IsSource());
   DCHECK(!node->IsSink());
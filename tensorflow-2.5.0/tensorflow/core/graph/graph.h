@@ -527,6 +527,19 @@ class Graph {
   // Returns nullptr and sets *status on error.
   Node* AddNode(NodeDef node_def, Status* status);
 
+  // Like AddNode above, but with the op registration and the input/output
+  // types of `node_def` already looked up by the caller, e.g. concurrently for
+  // the nodes of a large GraphDef. `op_reg_data` must come from
+  // op_registry(), and `inputs`/`outputs` must be the result of
+  // InOutTypesForNode() for `node_def`.
+  Node* AddNode(NodeDef node_def, const OpRegistrationData* op_reg_data,
+                DataTypeVector inputs, DataTypeVector outputs);
+
+  // Reserves storage for at least `num_nodes` additional nodes and
+  // `num_edges` additional edges, so that building a large graph does not
+  // repeatedly reallocate the node and edge tables.
+  void Reserve(int num_nodes, int num_edges);
+
   // Copies *node, which may belong to another graph, to a new node,
   // which is returned.  Does not copy any edges.  *this owns the
   // returned instance.
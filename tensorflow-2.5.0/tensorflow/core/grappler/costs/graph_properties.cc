@@ -36,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 
 namespace tensorflow {
@@ -807,6 +808,12 @@ class SymbolicShapeRefiner {
     GrapplerFunctionItem grappler_function_item = *maybe_grappler_function_item;
     MutableGraphView gv(&grappler_function_item.graph);
 
+    // Names of the argument nodes, which are specialized below.
+    absl::flat_hash_set<std::string> arg_node_names;
+    for (const auto& fun_input : grappler_function_item.inputs()) {
+      arg_node_names.insert(fun_input.node_name);
+    }
+
     // Forward shapes from function input nodes to argument nodes.
     for (int i = 0, end = grappler_function_item.inputs().size(); i < end;
          ++i) {
@@ -928,38 +935,65 @@ class SymbolicShapeRefiner {
       output_node->mutable_attr()->erase("index");
     }
 
-    // Perform inference on function body.
-    GraphProperties gp(grappler_function_item);
-    TF_RETURN_IF_ERROR(gp.InferStatically(
-        /*assume_valid_feeds=*/true,
-        /*aggressive_shape_inference=*/aggressive_shape_inference_,
-        /*include_tensor_values=*/true));
-
-    // Add return nodes for output shapes.
-    int output = 0;
-    ctx->output_tensors_as_shapes.resize(grappler_function_item.output_size());
-    ctx->output_tensor_protos.resize(grappler_function_item.output_size(),
-                                     nullptr);
-    for (auto const& out_arg : grappler_function_item.outputs()) {
-      // It is guaranteed that output_tensors does not contain any control
-      // inputs, so port_id >= 0.
-      TensorId out_tensor = ParseTensorName(out_arg.node_name);
-
-      if (output_nodes.count(out_tensor.node()) <= 0) {
-        return errors::FailedPrecondition(
-            "Unable to find return function_node ", out_tensor.node(), " for ",
-            function_node->name());
+    // The same function is frequently called from several call sites with
+    // identical input shapes and values, and UpdateNode revisits function
+    // nodes on every refinement pass; key the body inference on the
+    // specialized argument nodes so that it only runs once per signature.
+    std::string signature = function.name();
+    for (const NodeDef& node : grappler_function_item.graph.node()) {
+      if (!arg_node_names.contains(node.name())) continue;
+      std::string serialized;
+      SerializeToStringDeterministic(node, &serialized);
+      absl::StrAppend(&signature, "|", serialized.size(), ":", serialized);
+    }
+
+    auto cached = function_output_properties_.find(signature);
+    if (cached == function_output_properties_.end()) {
+      // Perform inference on function body.
+      GraphProperties gp(grappler_function_item);
+      TF_RETURN_IF_ERROR(gp.InferStatically(
+          /*assume_valid_feeds=*/true,
+          /*aggressive_shape_inference=*/aggressive_shape_inference_,
+          /*include_tensor_values=*/true));
+
+      std::vector<OpInfo::TensorProperties> function_outputs;
+      function_outputs.reserve(grappler_function_item.output_size());
+      for (auto const& out_arg : grappler_function_item.outputs()) {
+        // It is guaranteed that output_tensors does not contain any control
+        // inputs, so port_id >= 0.
+        TensorId out_tensor = ParseTensorName(out_arg.node_name);
+
+        if (output_nodes.count(out_tensor.node()) <= 0) {
+          return errors::FailedPrecondition(
+              "Unable to find return function_node ", out_tensor.node(),
+              " for ", function_node->name());
+        }
+        const NodeDef* retnode = output_nodes[out_tensor.node()];
+
+        auto output_properties = gp.GetOutputProperties(retnode->name());
+        int output_properties_size = output_properties.size();
+        if (out_tensor.index() >= output_properties_size) {
+          return errors::InvalidArgument(
+              out_tensor.ToString(), " has invalid position ",
+              out_tensor.index(),
+              " (output_properties.size() = ", output_properties.size(), ").");
+        }
+        function_outputs.push_back(
+            std::move(output_properties[out_tensor.index()]));
       }
-      const NodeDef* retnode = output_nodes[out_tensor.node()];
+      cached = function_output_properties_
+                   .emplace(std::move(signature), std::move(function_outputs))
+                   .first;
+    }
 
-      auto output_properties = gp.GetOutputProperties(retnode->name());
-      int output_properties_size = output_properties.size();
-      if (out_tensor.index() >= output_properties_size) {
-        return errors::InvalidArgument(
-            out_tensor.ToString(), " has invalid position ", out_tensor.index(),
-            " (output_properties.size() = ", output_properties.size(), ").");
-      }
-      auto& outprop = output_properties[out_tensor.index()];
+    // Add return nodes for output shapes.
+    const std::vector<OpInfo::TensorProperties>& function_outputs =
+        cached->second;
+    ctx->output_tensors_as_shapes.resize(function_outputs.size());
+    ctx->output_tensor_protos.resize(function_outputs.size(), nullptr);
+    for (int output = 0, end = function_outputs.size(); output < end;
+         ++output) {
+      const OpInfo::TensorProperties& outprop = function_outputs[output];
       TensorShapeProto shape = outprop.shape();
       NormalizeShapeForOutput(&shape);
       ShapeHandle out;
@@ -972,7 +1006,6 @@ class SymbolicShapeRefiner {
         const_tensors_to_propagate_.push_back(outprop.value());
         ctx->output_tensor_protos[output] = &const_tensors_to_propagate_.back();
       }
-      output++;
     }
 
     return Status::OK();
@@ -2036,6 +2069,10 @@ class SymbolicShapeRefiner {
   // instantiation failed it will have an `absl::nullopt`.
   absl::flat_hash_map<string, absl::optional<GrapplerFunctionItem>>
       fun_to_grappler_function_item_;
+  // Output properties of specialized function bodies, keyed by the function
+  // name and the serialized argument nodes (see UpdateFunction).
+  absl::flat_hash_map<std::string, std::vector<OpInfo::TensorProperties>>
+      function_output_properties_;
   FunctionLibraryDefinition function_library_;
   const absl::flat_hash_map<string, absl::flat_hash_set<int>>& fed_ports_;
   // Store TensorProtos for tensor value propagation. Note that we use deque,
@@ -1695,6 +1695,45 @@ TEST_F(GraphPropertiesTest, FunctionWithScalarInput) {
   EXPECT_FALSE(out_prop0.shape().unknown_rank());
 }
 
+TEST_F(GraphPropertiesTest, FunctionCalledWithDifferentShapes) {
+  // Two call sites of the same function with different input shapes must not
+  // share the inferred output shapes; two with the same shapes may.
+  FunctionDefLibrary library;
+  *library.add_function() = FunctionDefHelper::Create(
+      "MyFunc",                                                   // Name
+      {"x: float"},                                               // Inputs
+      {"out: float"},                                             // Outputs
+      {},                                                         // Attrs
+      {{{"a"}, "Identity", {"x"}, {{"T", DataType::DT_FLOAT}}}},  // Nodes
+      {{"out", "a:output:0"}});                                   // Returns
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  TF_ASSERT_OK(s.graph()->AddFunctionLibrary(library));
+  Output p0 = ops::Placeholder(s.WithOpName("p0"), DataType::DT_FLOAT,
+                               ops::Placeholder::Shape(TensorShape({2, 3})));
+  Output p1 = ops::Placeholder(s.WithOpName("p1"), DataType::DT_FLOAT,
+                               ops::Placeholder::Shape(TensorShape({5})));
+  Output p2 = ops::Placeholder(s.WithOpName("p2"), DataType::DT_FLOAT,
+                               ops::Placeholder::Shape(TensorShape({2, 3})));
+  for (const auto& call : {std::make_pair("f0", p0), std::make_pair("f1", p1),
+                           std::make_pair("f2", p2)}) {
+    tensorflow::Node* func_op;
+    TF_ASSERT_OK(
+        tensorflow::NodeBuilder(call.first, "MyFunc", s.graph()->op_registry())
+            .Input(tensorflow::ops::AsNodeOut(s, call.second))
+            .Finalize(s.graph(), &func_op));
+  }
+  GrapplerItem item;
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  GraphProperties properties(item);
+  TF_ASSERT_OK(properties.InferStatically(true));
+  EXPECT_EQ("float: [2,3]",
+            PropToString(properties.GetOutputProperties("f0")[0]));
+  EXPECT_EQ("float: [5]", PropToString(properties.GetOutputProperties("f1")[0]));
+  EXPECT_EQ("float: [2,3]",
+            PropToString(properties.GetOutputProperties("f2")[0]));
+}
+
 TEST_F(GraphPropertiesTest, SimpleFunctionStaticShapeInference) {
   // Test graph produced in python using:
   /*
@@ -35,6 +35,9 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/op_context.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/utils.h"
 #include "tensorflow/core/grappler/graph_topology_view.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/op_types.h"
@@ -3585,8 +3588,10 @@ class OptimizeMaxOrMinOfMonotonicStage : public ArithmeticOptimizerStage {
   }
 };
 
-// Replace a chain of type&shape preserving unary ops with a
-// '_UnaryOpsComposition' node.
+// Replace a chain of type&shape preserving unary ops, and binary ops with a
+// scalar constant operand, with a '_UnaryOpsComposition' node.  The chain is
+// only replaced if the cost model predicts that computing it in a single pass
+// over memory is faster.
 // TODO(ezhulenev): It should be a part of remapper optimizer because it doesn't
 // have to do much with arithmetic (together with FoldMultiplyIntoConv stage?).
 class UnaryOpsComposition : public ArithmeticOptimizerStage {
@@ -3630,6 +3635,15 @@ class UnaryOpsComposition : public ArithmeticOptimizerStage {
                       {"Relu",       {DT_FLOAT, DT_HALF, DT_DOUBLE}},
                       {"Relu6",      {DT_FLOAT, DT_HALF, DT_DOUBLE}},
                       {"Selu",       {DT_FLOAT, DT_HALF, DT_DOUBLE}}};
+    // Binary ops with a scalar operand, which the composition takes as a float
+    // attribute, and whether the scalar can be the first operand.
+    supported_binary_ops_ = {{"Add",     true},
+                             {"AddV2",   true},
+                             {"Sub",     false},
+                             {"Mul",     true},
+                             {"RealDiv", false},
+                             {"Maximum", true},
+                             {"Minimum", true}};
     // clang-format on
   }
   ~UnaryOpsComposition() override = default;
@@ -3646,56 +3660,62 @@ class UnaryOpsComposition : public ArithmeticOptimizerStage {
     TF_RETURN_IF_ERROR(CheckAttrExists(*root, "T"));
     DataType dtype = root->attr().at("T").type();
 
-    // Keep a trace of all supported input nodes that can be fused together.
-    std::vector<string> op_nodes = {root->name()};
-    std::vector<string> op_names = {root->op()};
-
-    // Check if we should follow input(0) while building an op composition.
-    const auto predicate_fn = [&](const NodeDef& input) {
-      if (input.name() == root->name()) return true;
-
-      bool follow_input_node =
-          dtype == GetDataTypeFromAttr(input, "T") &&
-          NumNonControlDataOutputs(input, *ctx().node_map) == 1 &&
-          CanOptimize(input);
-
-      if (follow_input_node) {
-        op_nodes.push_back(input.name());
-        op_names.push_back(input.op());
+    // Keep a trace of all supported input nodes that can be fused together,
+    // following the non-scalar input of each node.
+    std::vector<const NodeDef*> op_nodes;
+    std::vector<string> op_names;
+    std::vector<float> scalars;
+    string chain_input;
+    for (const NodeDef* node = root;;) {
+      int input_index;
+      bool has_scalar;
+      float scalar;
+      if (!GetElementwiseOp(*node, &input_index, &has_scalar, &scalar)) {
+        return errors::Internal("Unsupported op in the chain: ", node->name());
       }
+      op_nodes.push_back(node);
+      op_names.push_back(node->op());
+      if (has_scalar) scalars.push_back(scalar);
+      chain_input = node->input(input_index);
 
-      return follow_input_node;
-    };
-
-    NodeDef* last_op = GetTailOfChain(
-        *root, *ctx().node_map, /*follow_control_input*/ false, predicate_fn);
+      const NodeDef* input = ctx().node_map->GetNode(chain_input);
+      const bool follow_input_node =
+          input != nullptr && input != root &&
+          dtype == GetDataTypeFromAttr(*input, "T") &&
+          NumNonControlDataOutputs(*input, *ctx().node_map) == 1 &&
+          CanOptimize(*input);
+      if (!follow_input_node) break;
+      node = input;
+    }
 
     // We were not able to find a chain that can be replaced.
     if (op_names.size() == 1) return Status::OK();
+    if (!IsFusionProfitable(op_nodes)) return Status::OK();
 
     // Do not add fused nodes to any other chain.
-    std::for_each(op_nodes.begin(), op_nodes.end(),
-                  [this](const string& name) { AddToFusedNodes(name); });
+    for (const NodeDef* node : op_nodes) AddToFusedNodes(node->name());
 
     // Reverse the trace to get correct composition computation order.
     std::reverse(op_names.begin(), op_names.end());
+    std::reverse(scalars.begin(), scalars.end());
 
     VLOG(2) << "Fuse unary ops: root=" << root->name() << " op_names=["
-            << absl::StrJoin(op_names, ", ") << "]";
+            << absl::StrJoin(op_names, ", ") << "] scalars=["
+            << absl::StrJoin(scalars, ", ") << "]";
 
     NodeDef* composition_node = ctx().optimized_graph->add_node();
     composition_node->set_name(OptimizedNodeName(*root));
     composition_node->set_op("_UnaryOpsComposition");
-    composition_node->add_input(last_op->input(0));
+    composition_node->add_input(chain_input);
     composition_node->set_device(root->device());
 
     auto attr = composition_node->mutable_attr();
     SetAttrValue(dtype, &(*attr)["T"]);
     SetAttrValue(op_names, &(*attr)["op_names"]);
+    if (!scalars.empty()) SetAttrValue(scalars, &(*attr)["scalars"]);
 
     ctx().node_map->AddNode(composition_node->name(), composition_node);
-    ctx().node_map->AddOutput(NodeName(last_op->input(0)),
-                              composition_node->name());
+    ctx().node_map->AddOutput(NodeName(chain_input), composition_node->name());
 
     *simplified_node_name = composition_node->name();
 
@@ -3704,8 +3724,10 @@ class UnaryOpsComposition : public ArithmeticOptimizerStage {
 
  private:
   bool CanOptimize(const NodeDef& node) const {
-    DataType dtype = GetDataTypeFromAttr(node, "T");
-    if (!IsSupported(node.op(), dtype)) {
+    int input_index;
+    bool has_scalar;
+    float scalar;
+    if (!GetElementwiseOp(node, &input_index, &has_scalar, &scalar)) {
       return false;
     }
     if (IsInPreserveSet(node)) {
@@ -3737,7 +3759,92 @@ class UnaryOpsComposition : public ArithmeticOptimizerStage {
     return it != supported_ops_.end() && it->second.count(dtype) > 0;
   }
 
+  // Returns true if "node" is an op supported by the _UnaryOpsComposition of
+  // its input "input_index", and of a scalar constant if "*has_scalar".
+  bool GetElementwiseOp(const NodeDef& node, int* input_index,
+                        bool* has_scalar, float* scalar) const {
+    const DataType dtype = GetDataTypeFromAttr(node, "T");
+    *input_index = 0;
+    *has_scalar = false;
+    if (IsSupported(node.op(), dtype)) return node.input_size() >= 1;
+
+    // The scalar is passed as a float attribute, which can represent all the
+    // values of these types.
+    const auto it = supported_binary_ops_.find(node.op());
+    if (it == supported_binary_ops_.end() || node.input_size() < 2 ||
+        (dtype != DT_FLOAT && dtype != DT_HALF)) {
+      return false;
+    }
+    *has_scalar = true;
+    if (GetScalarConstant(node.input(1), dtype, scalar)) return true;
+    *input_index = 1;
+    return it->second && GetScalarConstant(node.input(0), dtype, scalar);
+  }
+
+  bool GetScalarConstant(const string& input, DataType dtype,
+                         float* scalar) const {
+    if (IsControlInput(input)) return false;
+    const NodeDef* node = ctx().node_map->GetNode(input);
+    Tensor tensor;
+    if (node == nullptr || !IsReallyConstant(*node) ||
+        !CheckAttrExists(*node, "value").ok() ||
+        !tensor.FromProto(node->attr().at("value").tensor()) ||
+        tensor.dtype() != dtype || tensor.dims() != 0) {
+      return false;
+    }
+    *scalar = dtype == DT_HALF
+                  ? static_cast<float>(tensor.scalar<Eigen::half>()())
+                  : tensor.scalar<float>()();
+    return true;
+  }
+
+  // Returns true unless the cost model predicts that computing the chain of
+  // "nodes" one op at a time is faster.  Each op of the chain reads and writes
+  // a tensor of the same size, but the composition only reads the input of the
+  // chain and writes its output once.
+  bool IsFusionProfitable(const std::vector<const NodeDef*>& nodes) const {
+    double unfused_time = 0;
+    double compute_time = 0;
+    double memory_time = 0;
+    for (int i = 0; i < nodes.size(); ++i) {
+      const NodeDef& node = *nodes[i];
+      if (!ctx().graph_properties->HasInputProperties(node.name()) ||
+          !ctx().graph_properties->HasOutputProperties(node.name())) {
+        return true;
+      }
+      OpContext op_context;
+      op_context.name = node.name();
+      op_context.device_name = node.device();
+      OpInfo& op_info = op_context.op_info;
+      op_info.set_op(node.op());
+      *op_info.mutable_attr() = node.attr();
+      for (const auto& input :
+           ctx().graph_properties->GetInputProperties(node.name())) {
+        *op_info.add_inputs() = input;
+      }
+      for (const auto& output :
+           ctx().graph_properties->GetOutputProperties(node.name())) {
+        *op_info.add_outputs() = output;
+      }
+      *op_info.mutable_device() = GetDeviceInfo(node.device());
+
+      const Costs costs = cost_estimator_.PredictCosts(op_context);
+      unfused_time += costs.execution_time.count();
+      compute_time += costs.compute_time.count();
+      if (i == 0 || i == nodes.size() - 1) {
+        memory_time += costs.memory_time.count() / 2;
+      }
+    }
+    const double fused_time = compute_time + memory_time;
+    VLOG(2) << "Unary ops composition of " << nodes.size()
+            << " ops: fused time=" << fused_time
+            << "ns, unfused time=" << unfused_time << "ns";
+    return fused_time <= unfused_time;
+  }
+
   std::unordered_map<string, std::set<DataType>> supported_ops_;
+  std::unordered_map<string, bool> supported_binary_ops_;
+  OpLevelCostEstimator cost_estimator_;
   std::unordered_set<string> fused_nodes_;
 };
 
@@ -4487,6 +4487,77 @@ TEST_F(ArithmeticOptimizerTest, UnaryOpsComposition) {
   test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
 }
 
+TEST_F(ArithmeticOptimizerTest, UnaryOpsCompositionWithScalars) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto x = ops::Const(s.WithOpName("x"), {1.0f, 2.0f}, {1, 2});
+  auto two = ops::Const(s.WithOpName("two"), 2.0f, {});
+  auto half = ops::Const(s.WithOpName("half"), 0.5f, {});
+  auto one = ops::Const(s.WithOpName("one"), 1.0f, {});
+  Output sqrt = ops::Sqrt(s.WithOpName("sqrt"), x);
+  Output mul = ops::Mul(s.WithOpName("mul"), sqrt, two);
+  Output add = ops::AddV2(s.WithOpName("add"), half, mul);
+  Output sub = ops::Sub(s.WithOpName("sub"), add, one);
+  Output relu = ops::Relu(s.WithOpName("relu"), sub);
+  Output final_out = ops::Identity(s.WithOpName("final_out"), relu);
+
+  GrapplerItem item;
+  item.fetch = {"final_out"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  ASSERT_EQ(tensors_expected.size(), 1);
+
+  GraphDef output;
+  ArithmeticOptimizer optimizer;
+  EnableOnlyUnaryOpsComposition(&optimizer);
+  OptimizeAndPrune(&optimizer, &item, &output);
+
+  EXPECT_EQ(output.node_size(), 3);
+
+  // Check that the chain was replaced with a single op, and that the scalar
+  // operands were moved into the "scalars" attribute.
+  int required_node_count = 0;
+  for (int i = 0; i < output.node_size(); ++i) {
+    const NodeDef& node = output.node(i);
+    if (node.name() == "final_out") {
+      EXPECT_EQ(node.op(), "Identity");
+      ASSERT_EQ(node.input_size(), 1);
+      EXPECT_EQ(node.input(0), "relu/unary_ops_composition");
+      ++required_node_count;
+    } else if (node.name() == "relu/unary_ops_composition") {
+      EXPECT_EQ(node.op(), "_UnaryOpsComposition");
+      ASSERT_EQ(node.input_size(), 1);
+      EXPECT_EQ(node.input(0), "x");
+
+      auto op_names = node.attr().at("op_names").list().s();
+      ASSERT_EQ(op_names.size(), 5);
+      EXPECT_EQ(op_names[0], "Sqrt");
+      EXPECT_EQ(op_names[1], "Mul");
+      EXPECT_EQ(op_names[2], "AddV2");
+      EXPECT_EQ(op_names[3], "Sub");
+      EXPECT_EQ(op_names[4], "Relu");
+
+      auto scalars = node.attr().at("scalars").list().f();
+      ASSERT_EQ(scalars.size(), 3);
+      EXPECT_EQ(scalars[0], 2.0f);
+      EXPECT_EQ(scalars[1], 0.5f);
+      EXPECT_EQ(scalars[2], 1.0f);
+      ++required_node_count;
+    }
+  }
+  EXPECT_EQ(required_node_count, 2);
+
+  auto tensors = EvaluateNodes(output, item.fetch);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
+}
+
 TEST_F(ArithmeticOptimizerTest, RemoveStackStridedSliceSameAxis) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   auto a_in =
@@ -355,7 +355,10 @@ class AutoMixedPrecisionListsMkl : public AutoMixedPrecisionLists {
   AutoMixedPrecisionListsMkl() {}
 
   // Only ops which are supported by MKL in bfloat16 should be added to the
-  // allow list, infer list, or clear list.
+  // allow list, infer list, or clear list. Ops in the infer and clear lists
+  // that have no bfloat16 CPU kernel registered are left in float32 by the
+  // optimizer's kernel check. Reductions and log/exp-like ops that lose too
+  // much precision in bfloat16 are kept in the deny list.
   gtl::FlatSet<string> AllowList() override {
     auto list = gtl::FlatSet<string>{"Conv2D",
                                      "Conv2DBackpropFilter",
@@ -366,6 +369,7 @@ class AutoMixedPrecisionListsMkl : public AutoMixedPrecisionLists {
                                      "DepthwiseConv2dNative",
                                      "DepthwiseConv2dNativeBackpropFilter",
                                      "DepthwiseConv2dNativeBackpropInput",
+                                     "Einsum",
                                      "MatMul",
                                      "BatchMatMul",
                                      "BatchMatMulV2"};
@@ -389,6 +393,10 @@ class AutoMixedPrecisionListsMkl : public AutoMixedPrecisionLists {
         "BiasAdd",
         "BiasAddGrad",
         "BiasAddV1",
+        "Elu",
+        "EluGrad",
+        "Erf",
+        "Erfc",
         "FusedBatchNormV2",
         "FusedBatchNormGradV2",
         "FusedBatchNormV3",
@@ -396,7 +404,23 @@ class AutoMixedPrecisionListsMkl : public AutoMixedPrecisionLists {
         "LeakyRelu",
         "LeakyReluGrad",
         "Mul",
+        "RealDiv",
+        "Reciprocal",
+        "Rsqrt",
+        "Selu",
+        "SeluGrad",
+        "Sigmoid",
+        "SigmoidGrad",
+        "Softplus",
+        "SoftplusGrad",
+        "Softsign",
+        "SoftsignGrad",
+        "Sqrt",
+        "Square",
+        "SquaredDifference",
         "Sub",
+        "Tanh",
+        "TanhGrad",
     };
     UpdateList("INFERLIST", &list);
     // For backwards compatibility, keeping the original env variable here.
@@ -410,8 +434,12 @@ class AutoMixedPrecisionListsMkl : public AutoMixedPrecisionLists {
         "Exp",
         "Expm1",
         "L2Loss",
+        "Log",
+        "Log1p",
+        "LogSoftmax",
         "Mean",
         "Pow",
+        "Prod",
         "SaveV2",
         "Softmax",
         "SoftmaxCrossEntropyWithLogits",
@@ -427,15 +455,96 @@ class AutoMixedPrecisionListsMkl : public AutoMixedPrecisionLists {
 
   gtl::FlatSet<string> ClearList() override {
     auto list = gtl::FlatSet<string>{
-        "Concat",          "ConcatV2",  "Enter",         "EnsureShape",
-        "Equal",           "Exit",      "ExpandDims",    "Identity",
-        "MaxPool",         "MaxPool3D", "MaxPool3DGrad", "MaxPoolGrad",
-        "MaxPoolV2",       "Maximum",   "Merge",         "NextIteration",
-        "PreventGradient", "Relu",      "Relu6",         "Relu6Grad",
-        "ReluGrad",        "Reshape",   "Select",        "SelectV2",
-        "Shape",           "ShapeN",    "Slice",         "Split",
-        "SplitV",          "Squeeze",   "StopGradient",  "Switch",
-        "Transpose",       "ZerosLike",
+        "Abs",
+        "ArgMax",
+        "ArgMin",
+        "BatchToSpace",
+        "BatchToSpaceND",
+        "BroadcastTo",
+        "Ceil",
+        "CheckNumerics",
+        "ClipByValue",
+        "Concat",
+        "ConcatV2",
+        "DepthToSpace",
+        "DynamicPartition",
+        "DynamicStitch",
+        "Enter",
+        "EnsureShape",
+        "Equal",
+        "Exit",
+        "ExpandDims",
+        "Fill",
+        "Floor",
+        "Gather",
+        "GatherNd",
+        "GatherV2",
+        "Greater",
+        "GreaterEqual",
+        "Identity",
+        "IdentityN",
+        "IsFinite",
+        "IsInf",
+        "IsNan",
+        "Less",
+        "LessEqual",
+        "Max",
+        "MaxPool",
+        "MaxPool3D",
+        "MaxPool3DGrad",
+        "MaxPoolGrad",
+        "MaxPoolV2",
+        "Maximum",
+        "Merge",
+        "Min",
+        "Minimum",
+        "MirrorPad",
+        "MirrorPadGrad",
+        "Neg",
+        "NextIteration",
+        "NotEqual",
+        "OnesLike",
+        "Pack",
+        "Pad",
+        "PadV2",
+        "PreventGradient",
+        "Rank",
+        "Relu",
+        "Relu6",
+        "Relu6Grad",
+        "ReluGrad",
+        "Reshape",
+        "ResizeNearestNeighbor",
+        "ResizeNearestNeighborGrad",
+        "Reverse",
+        "ReverseSequence",
+        "ReverseV2",
+        "Round",
+        "Select",
+        "SelectV2",
+        "Shape",
+        "ShapeN",
+        "Sign",
+        "Size",
+        "Slice",
+        "Snapshot",
+        "SpaceToBatch",
+        "SpaceToBatchND",
+        "SpaceToDepth",
+        "Split",
+        "SplitV",
+        "Squeeze",
+        "StopGradient",
+        "StridedSlice",
+        "StridedSliceGrad",
+        "Switch",
+        "Tile",
+        "TopK",
+        "TopKV2",
+        "Transpose",
+        "Unpack",
+        "Where",
+        "ZerosLike",
     };
     AddTensorListOps(&list);
     UpdateList("CLEARLIST", &list);
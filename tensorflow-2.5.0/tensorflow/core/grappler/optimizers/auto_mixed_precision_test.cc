@@ -1291,6 +1291,51 @@ TEST_F(AutoMixedPrecisionMklTest, Simple) {
   }
 }
 
+TEST_F(AutoMixedPrecisionMklTest, BroadenedLists) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(
+      "/job:localhost/replica:0/task:0/device:CPU:0");
+  // The input varies so that the log-softmax results depend on the precision
+  // of the bfloat16 ops before it.
+  Output input = ops::Const(
+      s.WithOpName("input"),
+      GenerateRandomTensorInRange<DT_FLOAT>(TensorShape({32, 32}), -0.5, 0.5));
+  Output allow1 = ops::MatMul(s.WithOpName("allow1"), input, input);
+  Output infer1 = ops::Tanh(s.WithOpName("infer1"), allow1);
+  Output clr1 = ops::Abs(s.WithOpName("clr1"), infer1);
+  Output allow2 =
+      ops::Einsum(s.WithOpName("allow2"), {clr1, clr1}, "ij,jk->ik");
+  Output deny1 = ops::LogSoftmax(s.WithOpName("deny1"), allow2);
+  Output fetch = ops::Identity(s.WithOpName("fetch"), deny1);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+
+  AutoMixedPrecision optimizer{AutoMixedPrecisionMode::MKL};
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(virtual_cluster_.get(), item, &output));
+
+  VLOG(1) << output.DebugString();
+
+  GraphView output_view(&output);
+  EXPECT_EQ(output.node_size(), item.graph.node_size() + 2);
+  EXPECT_EQ(output_view.GetNode("input")->attr().at("dtype").type(), DT_FLOAT);
+  EXPECT_EQ(output_view.GetNode("allow1")->attr().at("T").type(), DT_BFLOAT16);
+  EXPECT_EQ(output_view.GetNode("infer1")->attr().at("T").type(), DT_BFLOAT16);
+  EXPECT_EQ(output_view.GetNode("clr1")->attr().at("T").type(), DT_BFLOAT16);
+  EXPECT_EQ(output_view.GetNode("allow2")->attr().at("T").type(), DT_BFLOAT16);
+  EXPECT_EQ(output_view.GetNode("deny1")->attr().at("T").type(), DT_FLOAT);
+
+  auto tensors = EvaluateNodes(output, item.fetch);
+  EXPECT_EQ(tensors.size(), tensors_expected.size());
+  EXPECT_EQ(tensors.size(), item.fetch.size());
+  for (int i = 0; i < item.fetch.size(); ++i) {
+    test::ExpectClose(tensors_expected[i], tensors[i], /*atol=*/5e-2,
+                      /*rtol=*/1e-2);
+  }
+}
+
 TEST_F(AutoMixedPrecisionMklTest, TensorListSetGet) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(
       "/job:localhost/replica:0/task:0/device:CPU:0");
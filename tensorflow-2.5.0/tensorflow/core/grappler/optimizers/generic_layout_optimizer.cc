@@ -389,9 +389,8 @@ Status EraseOutputShapeAttrs(TransposeContext* context) {
       continue;
     }
     mutation->RemoveNodeAttr(node, kAttrOutputShape);
-    TF_RETURN_IF_ERROR(mutation->Apply());
   }
-  return Status::OK();
+  return mutation->Apply();
 }
 
 }  // namespace
@@ -423,10 +422,12 @@ Status GenericLayoutOptimizer::Optimize(Cluster* cluster,
     context.AssignDeviceAndDataFormats(kGPU, src_dst_formats.first,
                                        src_dst_formats.second);
   } else {
-    TF_RETURN_IF_ERROR(
-        TransposeContext::InitializeTransposeContext(item, cluster, &context));
+    // Decide whether there is anything to do before initializing the
+    // transpose context, which runs static shape inference over the graph.
     switch (cpu_layout_conversion_) {
       case RewriterConfig::NCHW_TO_NHWC:
+        TF_RETURN_IF_ERROR(TransposeContext::InitializeTransposeContext(
+            item, cluster, &context));
         context.AssignDeviceAndDataFormats(kCPU, kNCHW, kNHWC);
         break;
       // TODO(intel-tf): Add functionality for NHWC_TO_NCHW layout conversion on
@@ -23,6 +23,10 @@ namespace tensorflow {
 namespace grappler {
 
 // Optimize the data layout for convolutional models.
+//
+// Only the plain NHWC and NCHW layouts are chosen between. On CPU the
+// optimizer does nothing unless `layout_conversion` is NCHW_TO_NHWC; blocked
+// channel layouts such as NCHW8c are left to the oneDNN layout pass.
 class GenericLayoutOptimizer : public GraphOptimizer {
  public:
   GenericLayoutOptimizer()
@@ -0,0 +1,267 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/gpu_stream_assignment.h"
+
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <utility>
+
+#include "tensorflow/core/common_runtime/gpu/gpu_id.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_id_manager.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/topological_sort.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kColocationAttr[] = "_class";
+constexpr char kMinBranchSizeParam[] = "min_branch_size";
+
+bool IsPlacedOn(const NodeDef& node,
+                const DeviceNameUtils::ParsedName& device) {
+  DeviceNameUtils::ParsedName parsed;
+  return DeviceNameUtils::ParseFullName(node.device(), &parsed) &&
+         parsed.has_type && parsed.has_id &&
+         DeviceNameUtils::IsSpecification(parsed, device);
+}
+
+// Returns true if `node` has no state tied to the device it is placed on, so
+// it can run on any device sharing the same physical GPU.
+bool IsMovable(const NodeDef& node,
+               const std::unordered_set<string>& nodes_to_preserve) {
+  if (nodes_to_preserve.count(node.name()) > 0) return false;
+  if (node.attr().count(kColocationAttr) > 0) return false;
+  if (IsStateful(node)) return false;
+  const OpDef* op_def = nullptr;
+  if (!OpRegistry::Global()->LookUpOpDef(node.op(), &op_def).ok()) {
+    return false;
+  }
+  DataTypeVector input_types;
+  DataTypeVector output_types;
+  if (!InOutTypesForNode(node, *op_def, &input_types, &output_types).ok()) {
+    return false;
+  }
+  for (const DataTypeVector* types : {&input_types, &output_types}) {
+    for (DataType dtype : *types) {
+      if (IsRefType(dtype) || dtype == DT_RESOURCE || dtype == DT_VARIANT) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+Status AssignGroup(const std::vector<string>& group, int min_branch_size,
+                   const std::unordered_set<string>& nodes_to_preserve,
+                   const std::vector<int>& topo_order,
+                   const std::unordered_map<string, int>& node_index,
+                   GraphDef* graph) {
+  DeviceNameUtils::ParsedName base;
+  if (!DeviceNameUtils::ParseFullName(group[0], &base)) {
+    return errors::InvalidArgument("Invalid device name: ", group[0]);
+  }
+
+  // Split the movable nodes placed on the base device into branches. A node
+  // continues the branch of the fanin with the largest branch that no other
+  // consumer continues yet, and starts a new branch otherwise.
+  const int num_nodes = graph->node_size();
+  std::vector<int> branch(num_nodes, -1);
+  std::vector<bool> continued(num_nodes, false);
+  std::vector<int> branch_size;
+  // The branch each branch forks from or, for a branch without any fanin on
+  // the base device, the first other branch consuming it.
+  std::vector<int> attach;
+  for (int i : topo_order) {
+    const NodeDef& node = graph->node(i);
+    if (!IsPlacedOn(node, base) || !IsMovable(node, nodes_to_preserve)) {
+      continue;
+    }
+    int fork = -1;
+    int continued_fanin = -1;
+    std::vector<int> fanin_branches;
+    for (const string& input : node.input()) {
+      if (IsControlInput(input)) break;
+      auto it = node_index.find(NodeName(input));
+      if (it == node_index.end() || branch[it->second] < 0) continue;
+      const int fanin = it->second;
+      if (fork < 0) fork = branch[fanin];
+      fanin_branches.push_back(branch[fanin]);
+      if (!continued[fanin] &&
+          (continued_fanin < 0 || branch_size[branch[fanin]] >
+                                      branch_size[branch[continued_fanin]])) {
+        continued_fanin = fanin;
+      }
+    }
+    if (continued_fanin >= 0) {
+      continued[continued_fanin] = true;
+      branch[i] = branch[continued_fanin];
+    } else {
+      branch[i] = branch_size.size();
+      branch_size.push_back(0);
+      attach.push_back(fork);
+    }
+    ++branch_size[branch[i]];
+    for (int fanin_branch : fanin_branches) {
+      if (fanin_branch != branch[i] && attach[fanin_branch] < 0) {
+        attach[fanin_branch] = branch[i];
+      }
+    }
+  }
+
+  // Spread the branches large enough to be worth the synchronization over the
+  // devices of the group, always filling the least loaded one.
+  const int num_branches = branch_size.size();
+  std::vector<int> stream(num_branches, -1);
+  std::vector<int64> load(group.size(), 0);
+  int num_large_branches = 0;
+  for (int b = 0; b < num_branches; ++b) {
+    if (branch_size[b] < min_branch_size) continue;
+    stream[b] = std::min_element(load.begin(), load.end()) - load.begin();
+    load[stream[b]] += branch_size[b];
+    ++num_large_branches;
+  }
+  if (num_large_branches < 2) return Status::OK();
+
+  // Smaller branches follow the branch they are attached to, and stay on the
+  // base device when that can't be resolved.
+  for (int b = 0; b < num_branches; ++b) {
+    if (stream[b] >= 0) continue;
+    int target = attach[b];
+    for (int steps = 0; steps < num_branches; ++steps) {
+      if (target < 0 || stream[target] >= 0) break;
+      target = attach[target];
+    }
+    stream[b] = target >= 0 && stream[target] >= 0 ? stream[target] : 0;
+  }
+
+  int num_moved = 0;
+  for (int i = 0; i < num_nodes; ++i) {
+    if (branch[i] < 0 || stream[branch[i]] == 0) continue;
+    graph->mutable_node(i)->set_device(group[stream[branch[i]]]);
+    ++num_moved;
+  }
+  VLOG(1) << "Moved " << num_moved << " nodes in " << num_large_branches
+          << " branches from " << group[0] << " to sibling devices";
+  return Status::OK();
+}
+
+}  // namespace
+
+namespace internal {
+
+Status AssignBranchesToDevices(
+    const std::vector<std::vector<string>>& device_groups, int min_branch_size,
+    const std::unordered_set<string>& nodes_to_preserve, GraphDef* graph) {
+  // The frames of a loop must stay on one device.
+  for (const NodeDef& node : graph->node()) {
+    if (IsControlFlow(node)) {
+      VLOG(1) << "Not assigning GPU streams to a graph with control flow";
+      return Status::OK();
+    }
+  }
+
+  std::vector<const NodeDef*> topo_order;
+  TF_RETURN_IF_ERROR(ComputeTopologicalOrder(*graph, &topo_order));
+  std::unordered_map<const NodeDef*, int> node_position;
+  std::unordered_map<string, int> node_index;
+  for (int i = 0; i < graph->node_size(); ++i) {
+    node_position[&graph->node(i)] = i;
+    node_index[graph->node(i).name()] = i;
+  }
+  std::vector<int> topo_indices;
+  topo_indices.reserve(topo_order.size());
+  for (const NodeDef* node : topo_order) {
+    topo_indices.push_back(node_position[node]);
+  }
+
+  for (const std::vector<string>& group : device_groups) {
+    if (group.size() < 2) continue;
+    TF_RETURN_IF_ERROR(AssignGroup(group, min_branch_size, nodes_to_preserve,
+                                   topo_indices, node_index, graph));
+  }
+  return Status::OK();
+}
+
+}  // namespace internal
+
+Status GpuStreamAssignment::Init(
+    const tensorflow::RewriterConfig_CustomGraphOptimizer* config) {
+  if (config == nullptr) return Status::OK();
+  const auto& params = config->parameter_map();
+  auto it = params.find(kMinBranchSizeParam);
+  if (it != params.end()) {
+    if (it->second.i() < 1) {
+      return errors::InvalidArgument(kMinBranchSizeParam,
+                                     " must be positive, got ", it->second.i());
+    }
+    min_branch_size_ = it->second.i();
+  }
+  return Status::OK();
+}
+
+Status GpuStreamAssignment::Optimize(Cluster* cluster, const GrapplerItem& item,
+                                     GraphDef* optimized_graph) {
+  *optimized_graph = item.graph;
+
+  // Group the virtual GPUs by task and physical GPU, in TF id order. The
+  // mapping is only known for the local task, so this assumes every task
+  // splits its GPUs the same way.
+  std::map<std::pair<string, int>, std::map<int, string>> physical_gpus;
+  for (const string& device : item.devices()) {
+    DeviceNameUtils::ParsedName parsed;
+    if (!DeviceNameUtils::ParseFullName(device, &parsed) ||
+        parsed.type != DEVICE_GPU || !parsed.has_id) {
+      continue;
+    }
+    PlatformDeviceId platform_device_id;
+    if (!GpuIdManager::TfToPlatformDeviceId(TfDeviceId(parsed.id),
+                                            &platform_device_id)
+             .ok()) {
+      continue;
+    }
+    string task;
+    DeviceNameUtils::GetTaskName(parsed, &task);
+    physical_gpus[{task, platform_device_id.value()}][parsed.id] = device;
+  }
+
+  std::vector<std::vector<string>> device_groups;
+  for (const auto& gpu : physical_gpus) {
+    if (gpu.second.size() < 2) continue;
+    device_groups.emplace_back();
+    for (const auto& virtual_device : gpu.second) {
+      device_groups.back().push_back(virtual_device.second);
+    }
+  }
+  if (device_groups.empty()) return Status::OK();
+
+  return internal::AssignBranchesToDevices(
+      device_groups, min_branch_size_, item.NodesToPreserve(), optimized_graph);
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(GpuStreamAssignment, "gpu_stream_assignment");
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,80 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_GPU_STREAM_ASSIGNMENT_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_GPU_STREAM_ASSIGNMENT_H_
+
+#include <unordered_set>
+#include <vector>
+
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace internal {
+
+// For each group in `device_groups`, whose devices all share the compute
+// engine of one physical GPU, moves the independent branches of `graph`
+// placed on the first device of the group to the other devices of the group.
+// A branch is a chain of nodes each consuming the output of the previous one;
+// branches smaller than `min_branch_size` stay with the branch they fork from.
+// Nodes in `nodes_to_preserve` are never moved.
+Status AssignBranchesToDevices(
+    const std::vector<std::vector<string>>& device_groups, int min_branch_size,
+    const std::unordered_set<string>& nodes_to_preserve, GraphDef* graph);
+
+}  // namespace internal
+
+// Runs the independent branches of a step concurrently on one GPU.
+//
+// Each device has a single compute stream, so the kernels of a step placed on
+// one GPU are serialized even where the graph has no dependencies between
+// them. A GPU split into several virtual devices (see
+// GPUOptions.Experimental.virtual_devices) has one compute stream and one
+// allocator per virtual device, so this optimizer spreads the independent
+// branches placed on the first virtual device of a GPU over all of its
+// virtual devices. The partitioner then inserts Send/Recv pairs on the edges
+// between branches, which synchronize the streams with events only where
+// there is a dependency, and each stream allocates from its own BFC pool.
+//
+// Parameters:
+//   min_branch_size: the smallest branch, in nodes, worth an extra stream.
+//     Defaults to 16.
+class GpuStreamAssignment : public CustomGraphOptimizer {
+ public:
+  GpuStreamAssignment() {}
+  ~GpuStreamAssignment() override {}
+
+  string name() const override { return "gpu_stream_assignment"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Init(
+      const tensorflow::RewriterConfig_CustomGraphOptimizer* config) override;
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override;
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimized_graph, double result) override {}
+
+ private:
+  int min_branch_size_ = 16;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_GPU_STREAM_ASSIGNMENT_H_
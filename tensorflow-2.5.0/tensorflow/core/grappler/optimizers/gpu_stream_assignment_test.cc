@@ -0,0 +1,102 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/gpu_stream_assignment.h"
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kGpu0[] = "/job:localhost/replica:0/task:0/device:GPU:0";
+constexpr char kGpu1[] = "/job:localhost/replica:0/task:0/device:GPU:1";
+
+class GpuStreamAssignmentTest : public GrapplerTest {
+ protected:
+  // Builds two independent chains of `length` ops on GPU:0 joined by an Add.
+  GraphDef TwoTowers(int length) {
+    Scope s = Scope::NewRootScope().WithDevice(kGpu0);
+    Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT);
+    Output a = x;
+    Output b = x;
+    for (int i = 0; i < length; ++i) {
+      a = ops::Square(s.WithOpName(strings::StrCat("a", i)), a);
+      b = ops::Square(s.WithOpName(strings::StrCat("b", i)), b);
+    }
+    ops::Add(s.WithOpName("sum"), a, b);
+    GraphDef graph;
+    TF_CHECK_OK(s.ToGraphDef(&graph));
+    return graph;
+  }
+
+  const NodeDef* Node(const GraphDef& graph, const string& name) {
+    for (const NodeDef& node : graph.node()) {
+      if (node.name() == name) return &node;
+    }
+    return nullptr;
+  }
+};
+
+TEST_F(GpuStreamAssignmentTest, IndependentBranchesUseSiblingDevices) {
+  GraphDef graph = TwoTowers(20);
+  TF_ASSERT_OK(internal::AssignBranchesToDevices({{kGpu0, kGpu1}}, 16, {},
+                                                 &graph));
+
+  EXPECT_EQ(Node(graph, "x")->device(), kGpu0);
+  EXPECT_EQ(Node(graph, "sum")->device(), kGpu0);
+  for (int i = 0; i < 20; ++i) {
+    EXPECT_EQ(Node(graph, strings::StrCat("a", i))->device(), kGpu0);
+    EXPECT_EQ(Node(graph, strings::StrCat("b", i))->device(), kGpu1);
+  }
+}
+
+TEST_F(GpuStreamAssignmentTest, SmallBranchesStay) {
+  GraphDef graph = TwoTowers(4);
+  TF_ASSERT_OK(internal::AssignBranchesToDevices({{kGpu0, kGpu1}}, 16, {},
+                                                 &graph));
+
+  for (const NodeDef& node : graph.node()) {
+    EXPECT_EQ(node.device(), kGpu0) << node.name();
+  }
+}
+
+TEST_F(GpuStreamAssignmentTest, PreservedNodesStay) {
+  GraphDef graph = TwoTowers(20);
+  TF_ASSERT_OK(internal::AssignBranchesToDevices({{kGpu0, kGpu1}}, 16,
+                                                 {"b19"}, &graph));
+
+  EXPECT_EQ(Node(graph, "b0")->device(), kGpu1);
+  EXPECT_EQ(Node(graph, "b19")->device(), kGpu0);
+}
+
+TEST_F(GpuStreamAssignmentTest, SingleDeviceGroupIsUnchanged) {
+  GraphDef graph = TwoTowers(20);
+  TF_ASSERT_OK(internal::AssignBranchesToDevices({{kGpu0}}, 16, {}, &graph));
+
+  for (const NodeDef& node : graph.node()) {
+    EXPECT_EQ(node.device(), kGpu0) << node.name();
+  }
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
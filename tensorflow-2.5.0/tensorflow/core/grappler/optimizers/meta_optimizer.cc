@@ -51,8 +51,15 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/grappler/utils/tpu.h"
 #include "tensorflow/core/grappler/verifiers/structure_verifier.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/public/version.h"
 #include "tensorflow/core/util/dump_graph.h"
 #include "tensorflow/core/util/ptr_util.h"
 #include "tensorflow/core/util/util.h"
@@ -177,6 +184,87 @@ Status GetGraphDevice(const GraphDef& g_def, std::set<std::string>* devices) {
   return Status::OK();
 }
 
+// Returns the name of the file caching the result of optimizing `item` with
+// `cfg` on the devices of `cluster` (may be NULL), or an empty string if the
+// item can't be fingerprinted.
+string OptimizedGraphCacheFilename(const string& cache_dir,
+                                   const GrapplerItem& item,
+                                   const ConfigProto& cfg,
+                                   const Cluster* cluster) {
+  string serialized;
+  string key = TF_VERSION_STRING;
+  const auto append_proto = [&](const protobuf::MessageLite& proto) {
+    if (!SerializeToStringDeterministic(proto, &serialized)) return false;
+    absl::StrAppend(&key, "\n", serialized.size(), ":", serialized);
+    return true;
+  };
+  const auto append_strings = [&](std::vector<string> strings) {
+    std::sort(strings.begin(), strings.end());
+    absl::StrAppend(&key, "\n", strings.size(), ":",
+                    absl::StrJoin(strings, ","));
+  };
+
+  if (!append_proto(item.graph) || !append_proto(cfg)) return "";
+  std::vector<string> feed;
+  for (const auto& it : item.feed) {
+    feed.push_back(absl::StrCat(it.first, ":",
+                                DataTypeString(it.second.dtype()),
+                                it.second.shape().DebugString()));
+  }
+  append_strings(std::move(feed));
+  append_strings(item.fetch);
+  append_strings(item.init_ops);
+  append_strings(item.keep_ops);
+  append_strings({item.devices().begin(), item.devices().end()});
+
+  const GrapplerItem::OptimizationOptions& options =
+      item.optimization_options();
+  absl::StrAppend(&key, "\n", options.allow_non_differentiable_rewrites,
+                  options.allow_pruning_stateful_and_dataset_ops,
+                  options.optimize_function_library, options.is_eager_mode);
+
+  if (cluster != nullptr) {
+    const std::map<string, DeviceProperties> devices(
+        cluster->GetDevices().begin(), cluster->GetDevices().end());
+    for (const auto& device : devices) {
+      absl::StrAppend(&key, "\n", device.first);
+      if (!append_proto(device.second)) return "";
+    }
+  }
+
+  const Fprint128 fingerprint = Fingerprint128(key);
+  return io::JoinPath(
+      cache_dir, absl::StrCat(absl::Hex(fingerprint.high64, absl::kZeroPad16),
+                              absl::Hex(fingerprint.low64, absl::kZeroPad16),
+                              ".pb"));
+}
+
+// Writes `graph` to the optimized graph cache. Writes to a temporary file first
+// so that concurrent readers, possibly on other hosts sharing the cache
+// directory, never see a partially written graph.
+Status WriteOptimizedGraphToCache(const string& filename,
+                                  const GraphDef& graph) {
+  Env* env = Env::Default();
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(string(io::Dirname(filename))));
+  string tmp_filename = filename;
+  if (!env->CreateUniqueFileName(&tmp_filename, ".tmp")) {
+    return errors::Unavailable("Unable to create a temporary file for ",
+                               filename);
+  }
+  TF_RETURN_IF_ERROR(WriteBinaryProto(env, tmp_filename, graph));
+  const Status status = env->RenameFile(tmp_filename, filename);
+  if (!status.ok()) env->DeleteFile(tmp_filename).IgnoreError();
+  return status;
+}
+
+// Returns the thread pool shared by all meta optimizers that optimize library
+// functions concurrently.
+thread::ThreadPool* FunctionOptimizationThreadPool() {
+  static thread::ThreadPool* thread_pool = new thread::ThreadPool(
+      Env::Default(), "meta_optimizer_functions", port::MaxParallelism());
+  return thread_pool;
+}
+
 }  // namespace
 
 #define MK_OPT(NAME, CONFIG, VALUE)                                    \
@@ -606,8 +694,9 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
   LOG(WARNING) << logs;
 }
 
-Status MetaOptimizer::OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
-                                    GraphDef* optimized_graph) {
+Status MetaOptimizer::OptimizeGraph(
+    Cluster* cluster, GrapplerItem&& item, GraphDef* optimized_graph,
+    std::vector<GraphOptimizationResult>* optimization_results) {
   int min_graph_nodes = cfg_.min_graph_nodes() == 0 ? kDefaultMinGraphNodes
                                                     : cfg_.min_graph_nodes();
   if (item.graph.node_size() < min_graph_nodes) {
@@ -745,7 +834,7 @@ Status MetaOptimizer::OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
                                    }) != optimization_result.results.end();
 
   // Record graph optimization result.
-  optimization_results_.push_back(optimization_result);
+  optimization_results->push_back(optimization_result);
 
   if (is_optimized) {
     TF_RETURN_IF_ERROR(TopologicalSort(optimized_graph));
@@ -913,13 +1002,32 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       "Deleted $0 unreachable functions from the graph (library size = $1)",
       old_library_size - new_library_size, new_library_size);
 
+  // Skip the optimization entirely if an identical item was already optimized
+  // with the same configuration and devices.
+  string cache_filename;
+  if (!cfg_.meta_optimizer_cache_dir().empty()) {
+    cache_filename = OptimizedGraphCacheFilename(
+        cfg_.meta_optimizer_cache_dir(), item, config_proto_, cluster);
+  }
+  if (!cache_filename.empty() &&
+      Env::Default()->FileExists(cache_filename).ok()) {
+    const Status status =
+        ReadBinaryProto(Env::Default(), cache_filename, optimized_graph);
+    if (status.ok()) {
+      VLOG(1) << "Loaded optimized graph from cache: " << cache_filename;
+      return Status::OK();
+    }
+    LOG(WARNING) << "Failed to read optimized graph from cache: " << status;
+  }
+
   // Save a few small fields from item before we move it.
   bool optimize_function_library =
       item.optimization_options().optimize_function_library;
   const auto producer = item.graph.versions().producer();
 
   // 1. Optimize main graph
-  TF_RETURN_IF_ERROR(OptimizeGraph(cluster, std::move(item), optimized_graph));
+  TF_RETURN_IF_ERROR(OptimizeGraph(cluster, std::move(item), optimized_graph,
+                                   &optimization_results_));
   VLOG(1) << "Optimized main graph.";
   GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
 
@@ -996,13 +1104,22 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
 
   // Optimize each function only once.
   absl::flat_hash_set<string> optimized_funcs;
+  // Functions that do not call one another are optimized concurrently if
+  // enabled. A meta optimizer nested in a function optimization, e.g. for
+  // tf.data functions, runs sequentially, so that it can't wait for threads of
+  // the pool that are all waiting for it.
+  thread::ThreadPool* thread_pool = nullptr;
+  if (cfg_.concurrent_function_optimization()) {
+    thread_pool = FunctionOptimizationThreadPool();
+    if (thread_pool->CurrentThreadId() != -1) thread_pool = nullptr;
+  }
   while (optimize_function_library) {
     optimize_function_library = false;
 
-    int function_idx = 0;
+    // Collect the functions to optimize in this pass over the library.
+    std::vector<const FunctionDef*> funcs;
+    absl::flat_hash_set<string> pending_funcs;
     for (const FunctionDef& func : optimized_graph->library().function()) {
-      GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
-
       const string& func_name = func.signature().name();
 
       // Skip functions that are not reachable from the optimized graph.
@@ -1022,30 +1139,54 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       // and in function instantiation.
       if (data::IsTFDataFunction(func)) continue;
 
-      VLOG(3) << "Optimize function: function=" << func_name << " ["
-              << function_idx++ << " of "
-              << optimized_graph->library().function_size() << "]";
-
       // Function optimization might specialize nested function calls, so we
       // have to reset the flag and do at least one more pass over the library.
       optimize_function_library = true;
       optimized_funcs.insert(func_name);
+      funcs.push_back(&func);
+      pending_funcs.insert(func_name);
+    }
+
+    // Functions called by each function that are optimized in this pass.
+    std::vector<std::vector<string>> func_callees(funcs.size());
+    for (int i = 0; i < funcs.size(); ++i) {
+      for (const NodeDef& node : funcs[i]->node_def()) {
+        if (pending_funcs.contains(node.op())) {
+          func_callees[i].push_back(node.op());
+        }
+        for (const auto& attr : node.attr()) {
+          const AttrValue& attr_value = attr.second;
+          if (attr_value.has_func() &&
+              pending_funcs.contains(attr_value.func().name())) {
+            func_callees[i].push_back(attr_value.func().name());
+          }
+        }
+      }
+    }
+
+    // Optimizes a function body graph. Runs concurrently for the functions in
+    // the same group, and must not modify `flib`.
+    const auto optimize_function =
+        [&](const FunctionDef& func, GrapplerFunctionItem* func_item,
+            GraphDef* optimized_func_graph,
+            std::vector<GraphOptimizationResult>* func_results) -> Status {
+      GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+      const string& func_name = func.signature().name();
 
       // Make a GrapplerItem from a FunctionDef.
-      GrapplerFunctionItem func_item;
       TF_RETURN_IF_ERROR(
-          MakeGrapplerFunctionItem(func, flib, producer, &func_item));
+          MakeGrapplerFunctionItem(func, flib, producer, func_item));
 
       // If we need to compute the gradient of optimized function at runtime, we
       // can't perform non-differentiable rewrites.
-      func_item.optimization_options().allow_non_differentiable_rewrites =
+      func_item->optimization_options().allow_non_differentiable_rewrites =
           !differentiable_functions.contains(func_name);
 
       // Device set available to the function is defined only by the runtime,
       // when we instantiate and execute the function. We can't use all devices
       // available to the main graph, because after partitioning the function
       // call node might execute on a remote worker.
-      if (!func_item.devices().empty()) {
+      if (!func_item->devices().empty()) {
         return errors::Internal("GrapplerFunctionItem devices must be empty.");
       }
 
@@ -1053,11 +1194,10 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       // instantiated by the function definition, because we must guarantee
       // function execution semantics wrt side effects (see
       // function_optimizer.cc).
-      func_item.optimization_options().allow_pruning_stateful_and_dataset_ops =
+      func_item->optimization_options().allow_pruning_stateful_and_dataset_ops =
           false;
 
       // Optimize function body graph.
-      GraphDef optimized_func_graph;
       if (IsTPUGraphDef(*optimized_graph)) {
         // Skip optimizing functions if this is a TPU graph. Currently, Grappler
         // passes do not handle TPU functions correctly in a variety of ways
@@ -1075,34 +1215,99 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
         // Implementation selector needs to have access to valid function
         // signature and attributes, and it doesn't need actual function body.
         FunctionDefLibrary func_item_function_library;
-        func_item_function_library.Swap(func_item.graph.mutable_library());
-        *func_item.graph.mutable_library() =
+        func_item_function_library.Swap(func_item->graph.mutable_library());
+        *func_item->graph.mutable_library() =
             GetFunctionDefLibraryStub(func_item_function_library);
 
-        TF_RETURN_IF_ERROR(implementation_selector.Optimize(
-            cluster, func_item, &optimized_func_graph));
-      } else {
-        GrapplerFunctionItem func_item_copy = func_item;
-        TF_RETURN_IF_ERROR(OptimizeGraph(cluster, std::move(func_item_copy),
-                                         &optimized_func_graph));
+        return implementation_selector.Optimize(cluster, *func_item,
+                                                optimized_func_graph);
+      }
+      GrapplerFunctionItem func_item_copy = *func_item;
+      return OptimizeGraph(cluster, std::move(func_item_copy),
+                           optimized_func_graph, func_results);
+    };
+
+    // Optimize functions in groups, such that the functions called by each
+    // function are optimized before it, unless they call one another.
+    std::vector<bool> is_optimized(funcs.size(), false);
+    int num_optimized = 0;
+    while (num_optimized < funcs.size()) {
+      std::vector<int> group;
+      for (int i = 0; i < funcs.size(); ++i) {
+        if (is_optimized[i]) continue;
+        const bool callees_optimized = std::all_of(
+            func_callees[i].begin(), func_callees[i].end(),
+            [&](const string& callee) {
+              return callee == funcs[i]->signature().name() ||
+                     !pending_funcs.contains(callee);
+            });
+        if (callees_optimized) group.push_back(i);
+      }
+      // Functions in a call cycle are optimized together.
+      if (group.empty()) {
+        for (int i = 0; i < funcs.size(); ++i) {
+          if (!is_optimized[i]) group.push_back(i);
+        }
       }
 
-      // Function body optimization might have created new specialized
-      // functions for each instantiation context. Add them to the library.
-      for (const FunctionDef& func_def :
-           optimized_func_graph.library().function()) {
-        if (flib.Find(func_def.signature().name()) == nullptr) {
-          TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
+      std::vector<GrapplerFunctionItem> func_items(group.size());
+      std::vector<GraphDef> optimized_func_graphs(group.size());
+      std::vector<std::vector<GraphOptimizationResult>> func_results(
+          group.size());
+      std::vector<Status> statuses(group.size());
+      const auto optimize_group_function = [&](int j) {
+        statuses[j] =
+            optimize_function(*funcs[group[j]], &func_items[j],
+                              &optimized_func_graphs[j], &func_results[j]);
+      };
+      if (group.size() == 1 || thread_pool == nullptr) {
+        for (int j = 0; j < group.size(); ++j) {
+          optimize_group_function(j);
         }
+      } else {
+        BlockingCounter counter(group.size());
+        for (int j = 0; j < group.size(); ++j) {
+          thread_pool->Schedule([&, j]() {
+            optimize_group_function(j);
+            counter.DecrementCount();
+          });
+        }
+        counter.Wait();
       }
 
-      // Convert optimized graph back to FunctionDef.
-      FunctionDef optimized_func;
-      func_item.SwapFunctionBody(std::move(optimized_func_graph));
-      TF_RETURN_IF_ERROR(MakeFunctionDef(func_item, flib, &optimized_func));
+      // Update the function library in a deterministic order.
+      for (int j = 0; j < group.size(); ++j) {
+        TF_RETURN_IF_ERROR(statuses[j]);
+        const string& func_name = funcs[group[j]]->signature().name();
+        VLOG(3) << "Optimized function: function=" << func_name << " ["
+                << num_optimized + j << " of " << funcs.size() << "]";
+        for (GraphOptimizationResult& result : func_results[j]) {
+          optimization_results_.push_back(std::move(result));
+        }
+
+        // Function body optimization might have created new specialized
+        // functions for each instantiation context. Add them to the library.
+        for (const FunctionDef& func_def :
+             optimized_func_graphs[j].library().function()) {
+          if (flib.Find(func_def.signature().name()) == nullptr) {
+            TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
+          }
+        }
+
+        // Convert optimized graph back to FunctionDef.
+        FunctionDef optimized_func;
+        func_items[j].SwapFunctionBody(std::move(optimized_func_graphs[j]));
+        TF_RETURN_IF_ERROR(
+            MakeFunctionDef(func_items[j], flib, &optimized_func));
 
-      // Replace optimized function with a new FunctionDef.
-      TF_RETURN_IF_ERROR(flib.ReplaceFunction(func_name, optimized_func));
+        // Replace optimized function with a new FunctionDef.
+        TF_RETURN_IF_ERROR(flib.ReplaceFunction(func_name, optimized_func));
+      }
+      for (int i : group) {
+        is_optimized[i] = true;
+        pending_funcs.erase(funcs[i]->signature().name());
+      }
+      num_optimized += group.size();
     }
 
     // If optimized at least one function, update the graph library.
@@ -1113,6 +1318,13 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
 
   VLOG(1) << "Optimized " << optimized_funcs.size()
           << " functions: " << absl::StrJoin(optimized_funcs, ", ");
+  if (!cache_filename.empty()) {
+    const Status status =
+        WriteOptimizedGraphToCache(cache_filename, *optimized_graph);
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to write optimized graph to cache: " << status;
+    }
+  }
   VLOG(3) << "Optimized graph =\n" << optimized_graph->DebugString();
   if (VLOG_IS_ON(1)) {
     DumpGraphDefToFile(
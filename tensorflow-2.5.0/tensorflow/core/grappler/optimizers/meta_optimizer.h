@@ -92,11 +92,6 @@ class MetaOptimizer : public GraphOptimizer {
 
   void PrintUserAndPluginConfigs(const std::set<string>& device_types) const;
 
-  // Run optimization pass over a single GrapplerItem. Meta optimizer might run
-  // multiple such passes: 1) for the main graph 2) for the function library
-  Status OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
-                       GraphDef* optimized_graph);
-
   DeviceBase* const cpu_device_;  // may be NULL
   ConfigProto config_proto_;
   RewriterConfig& cfg_;
@@ -118,6 +113,14 @@ class MetaOptimizer : public GraphOptimizer {
                       GrapplerItem* optimized_item, GraphDef* optimized_graph,
                       GraphOptimizationResult* optimization_result);
 
+  // Run optimization pass over a single GrapplerItem. Meta optimizer might run
+  // multiple such passes: 1) for the main graph 2) for the function library.
+  // Function library passes may run concurrently, so each pass appends its
+  // results to `optimization_results`.
+  Status OptimizeGraph(
+      Cluster* cluster, GrapplerItem&& item, GraphDef* optimized_graph,
+      std::vector<GraphOptimizationResult>* optimization_results);
+
   std::vector<GraphOptimizationResult> optimization_results_;
 };
 
@@ -18,6 +18,7 @@ limitations under the License.
 #include <atomic>
 
 #include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/substitute.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -32,6 +33,9 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/grappler_test.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/protobuf/config.pb.h"
@@ -98,9 +102,13 @@ class GrapplerItemPropertiesAccumulator : public CustomGraphOptimizer {
   static void SetOptimizationOptions(
       gtl::FlatMap<string, GrapplerItem::OptimizationOptions>*
           optimization_options) {
+    mutex_lock l(mu_);
     optimization_options_ = optimization_options;
   }
-  static void ResetOptimizationOptions() { optimization_options_ = nullptr; }
+  static void ResetOptimizationOptions() {
+    mutex_lock l(mu_);
+    optimization_options_ = nullptr;
+  }
 
   GrapplerItemPropertiesAccumulator() {}
   string name() const override {
@@ -116,6 +124,8 @@ class GrapplerItemPropertiesAccumulator : public CustomGraphOptimizer {
   Status Optimize(Cluster* cluster, const GrapplerItem& item,
                   GraphDef* optimized_graph) override {
     *optimized_graph = item.graph;
+    // Functions are optimized concurrently.
+    mutex_lock l(mu_);
     if (optimization_options_) {
       optimization_options_->insert({item.id, item.optimization_options()});
     }
@@ -126,10 +136,12 @@ class GrapplerItemPropertiesAccumulator : public CustomGraphOptimizer {
                 const GraphDef& optimized_graph, double result) override {}
 
  private:
+  static mutex mu_;
   static gtl::FlatMap<string, GrapplerItem::OptimizationOptions>*
-      optimization_options_;
+      optimization_options_ TF_GUARDED_BY(mu_);
 };
 
+mutex GrapplerItemPropertiesAccumulator::mu_(LINKER_INITIALIZED);
 gtl::FlatMap<string, GrapplerItem::OptimizationOptions>*
     GrapplerItemPropertiesAccumulator::optimization_options_;
 
@@ -261,6 +273,48 @@ TEST_F(MetaOptimizerTest, RunToggleOptimizersAndCustomGraphOptimizerTwice) {
   EXPECT_TRUE(TestGraphOptimizer::IsOptimized());
 }
 
+TEST_F(MetaOptimizerTest, CachesOptimizedGraph) {
+  TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {kDevice});
+  GrapplerItem item;
+  ASSERT_TRUE(fake_input.NextItem(&item));
+
+  const string cache_dir =
+      io::JoinPath(testing::TmpDir(), "meta_optimizer_cache");
+  ConfigProto config_proto;
+  auto& rewriter_config =
+      *config_proto.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.add_optimizers("TestOptimizer");
+  rewriter_config.set_min_graph_nodes(-1);
+  rewriter_config.set_meta_optimizer_cache_dir(cache_dir);
+
+  // The first run optimizes the graph and stores it in the cache.
+  TestOptimizer::SetOptimized(false);
+  GraphDef output;
+  TF_EXPECT_OK(MetaOptimizer(nullptr, config_proto)
+                   .Optimize(nullptr, item, &output));
+  EXPECT_TRUE(TestOptimizer::IsOptimized());
+  std::vector<string> children;
+  TF_ASSERT_OK(Env::Default()->GetChildren(cache_dir, &children));
+  EXPECT_EQ(children.size(), 1);
+
+  // An identical item is loaded from the cache without running optimizers.
+  TestOptimizer::SetOptimized(false);
+  GraphDef cached_output;
+  TF_EXPECT_OK(MetaOptimizer(nullptr, config_proto)
+                   .Optimize(nullptr, item, &cached_output));
+  EXPECT_FALSE(TestOptimizer::IsOptimized());
+  CompareGraphs(output, cached_output);
+
+  // A different item is optimized again.
+  item.fetch.push_back(item.graph.node(0).name());
+  TestOptimizer::SetOptimized(false);
+  TF_EXPECT_OK(MetaOptimizer(nullptr, config_proto)
+                   .Optimize(nullptr, item, &output));
+  EXPECT_TRUE(TestOptimizer::IsOptimized());
+  TF_ASSERT_OK(Env::Default()->GetChildren(cache_dir, &children));
+  EXPECT_EQ(children.size(), 2);
+}
+
 TEST_F(MetaOptimizerTest, OptimizeFunctionLibrary) {
   using test::function::NDef;
 
@@ -709,6 +763,75 @@ TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryWithRestrictions) {
       optimization_options_my_mul_2->allow_non_differentiable_rewrites);
 }
 
+TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryCalleesFirst) {
+  using test::function::NDef;
+
+  gtl::FlatMap<string, GrapplerItem::OptimizationOptions> optimization_options;
+  GrapplerItemPropertiesAccumulator::SetOptimizationOptions(
+      &optimization_options);
+
+  ConfigProto config_proto;
+  auto& rewriter_config =
+      *config_proto.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.add_optimizers("GrapplerItemPropertiesAccumulator");
+  rewriter_config.set_min_graph_nodes(-1);
+  rewriter_config.set_concurrent_function_optimization(true);
+
+  MetaOptimizer optimizer(nullptr, config_proto);
+
+  // MyMul1 and MyMul2 are independent, and MyCaller calls MyMul1.
+  FunctionDef mul_func_1 = FunctionDefHelper::Create(
+      "MyMul1", {"x:float", "y:float"}, {"z:float"}, {},
+      {{{"mul"}, "Mul", {"x", "y"}, {{"T", DT_FLOAT}}}},
+      /*ret_def=*/
+      {{"z", "mul:z:0"}});
+
+  FunctionDef mul_func_2 = FunctionDefHelper::Create(
+      "MyMul2", {"x:float", "y:float"}, {"z:float"}, {},
+      {{{"mul"}, "Mul", {"x", "y"}, {{"T", DT_FLOAT}}}},
+      /*ret_def=*/
+      {{"z", "mul:z:0"}});
+
+  FunctionDef caller_func = FunctionDefHelper::Create(
+      "MyCaller", {"x:float", "y:float"}, {"z:float"}, {},
+      {{{"mul"}, "MyMul1", {"x", "y"}, {}}},
+      /*ret_def=*/
+      {{"z", "mul:z:0"}});
+
+  GrapplerItem item;
+  item.id = "main";
+  item.graph = test::function::GDef(
+      {NDef("x0", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice),
+       NDef("x1", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice),
+       NDef("call", "MyCaller", {"x0", "x1"}, {}, kDevice),
+       NDef("mul_2", "MyMul2", {"x0", "x1"}, {}, kDevice)},
+      /*funcs=*/
+      {caller_func, mul_func_1, mul_func_2});
+  item.fetch = {"call", "mul_2"};
+
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+  GrapplerItemPropertiesAccumulator::ResetOptimizationOptions();
+
+  // The main graph and the three functions were all optimized.
+  EXPECT_EQ(optimization_options.size(), 4);
+
+  // Results are reported in a deterministic order, with MyCaller after the
+  // function that it calls.
+  const string result = optimizer.GetResultString();
+  const auto item_position = [&result](const string& id) {
+    return result.find(
+        absl::StrCat("Optimization results for grappler item: ", id, "\n"));
+  };
+  ASSERT_NE(item_position("main"), string::npos);
+  ASSERT_NE(item_position("MyMul1"), string::npos);
+  ASSERT_NE(item_position("MyMul2"), string::npos);
+  ASSERT_NE(item_position("MyCaller"), string::npos);
+  EXPECT_LT(item_position("main"), item_position("MyMul1"));
+  EXPECT_LT(item_position("main"), item_position("MyMul2"));
+  EXPECT_LT(item_position("MyMul1"), item_position("MyCaller"));
+}
+
 class SleepingOptimizer : public CustomGraphOptimizer {
  public:
   SleepingOptimizer() {}
@@ -156,6 +156,8 @@ BatchResourceBase::BatchTask::CreateSplitTask(
   task->status = this->status;
   task->is_partial = true;
   task->start_time = this->start_time;
+  task->batching_priority = this->batching_priority;
+  task->batching_cost = this->batching_cost;
 
   return task;
 }
@@ -224,6 +226,10 @@ Status BatchResourceBase::RegisterInput(
       batch_components->captured_inputs.push_back(captured_tensor);
     }
   }
+  if (batch_components->batching_cost == 0) {
+    batch_components->batching_cost =
+        tensors[0].NumElements() / tensors[0].shape().dim_size(0);
+  }
   batch_components->context = context;
   batch_components->done_callback = std::move(done_callback);
   batch_components->split_index = 0;
@@ -352,6 +358,15 @@ Status BatchResourceBase::ConcatInputTensors(
   const int num_inputs = batch.task(0).inputs.size();
   concatenated_tensors->reserve(num_inputs);
 
+  // A batch of a single task needing no padding (e.g. one split of a large
+  // input) is its own concatenation, so avoid copying it.
+  if (batch.num_tasks() == 1 && padding_amount == 0) {
+    for (int i = 0; i < num_inputs; ++i) {
+      concatenated_tensors->push_back(batch.task(0).inputs.at(i));
+    }
+    return Status::OK();
+  }
+
   // Process each input one at a time (the typical case has just one).
   for (int i = 0; i < num_inputs; ++i) {
     // Concatenate the tasks ith input tensors into a big output tensor.
@@ -361,30 +376,21 @@ Status BatchResourceBase::ConcatInputTensors(
       to_concatenate.push_back(batch.task(task_idx).inputs.at(i));
     }
 
-    // Add padding as needed. Use the first row of the first task's tensor as
-    // the data for padding.
+    // Add padding as needed. The first row of the first task's tensor is
+    // written into the padding rows of the concatenated tensor.
     if (padding_amount > 0) {
       const Tensor& padding_source = batch.task(0).inputs.at(i);
-      Tensor padding;
       if (padding_source.shape().dim_size(0) == 0) {
         return errors::InvalidArgument(
             "Cannot use an empty tensor with zero rows as padding when "
             "batching. (Input ",
             i, " got shape ", padding_source.shape().DebugString(), ".)");
       }
-      if (padding_source.shape().dim_size(0) == 1) {
-        padding = padding_source;
-      } else {
-        padding = padding_source.Slice(0, 1);
-      }
-      for (int i = 0; i < padding_amount; ++i) {
-        to_concatenate.push_back(padding);
-      }
     }
 
     Tensor concatenated_tensor;
-    Status concat_status =
-        Concat(context, to_concatenate, &concatenated_tensor);
+    Status concat_status = Concat(context, to_concatenate, padding_amount,
+                                  &concatenated_tensor);
     TF_RETURN_IF_ERROR(concat_status);
     concatenated_tensors->push_back(concatenated_tensor);
   }
@@ -531,23 +537,28 @@ Status BatchResourceBase::SplitOutputTensors(
           "the 0th dimension sizes of the input tensors");
     }
 
-    std::vector<Tensor> split_tensor;
-    const Status split_status = tensor::Split(
-        output_tensor, task_sizes_plus_optional_padding, &split_tensor);
-    DCHECK(split_status.ok()) << split_status.ToString();
-    if (!split_status.ok()) {
-      return errors::Internal("Tensor split operation failed: ",
-                              split_status.ToString());
+    if (!DataTypeCanUseMemcpy(output_tensor.dtype()) &&
+        output_tensor.dtype() != DT_STRING) {
+      return errors::Internal("Tensor split operation failed: unexpected ",
+                              DataTypeString(output_tensor.dtype()),
+                              " batched output");
     }
-    DCHECK_EQ(split_tensor.size(), task_sizes_plus_optional_padding.size());
-    if (split_tensor.size() != task_sizes_plus_optional_padding.size()) {
-      return errors::Internal(
-          "Tensor split operation did not work as expected; got ",
-          split_tensor.size(), " splits; expected ",
-          task_sizes_plus_optional_padding.size());
+
+    // Each task's output is a slice sharing the buffer of the batch output,
+    // unless the slice would be misaligned, in which case it is copied out.
+    std::vector<Tensor> split_tensor;
+    split_tensor.reserve(batch->num_tasks());
+    int64 position = 0;
+    for (int j = 0; j < batch->num_tasks(); ++j) {
+      const int64 task_size = task_sizes_plus_optional_padding[j];
+      Tensor slice = output_tensor.Slice(position, position + task_size);
+      if (!slice.IsAligned()) {
+        slice = tensor::DeepCopy(slice);
+      }
+      split_tensor.push_back(std::move(slice));
+      position += task_size;
     }
 
-    // Ignore a possible final split_tensors entry containing the padding.
     for (int j = 0; j < batch->num_tasks(); ++j) {
       BatchTask& task = *(batch->mutable_task(j));
       if (task.is_partial) {
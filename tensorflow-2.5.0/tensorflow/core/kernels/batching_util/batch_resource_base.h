@@ -34,6 +34,10 @@ limitations under the License.
 namespace tensorflow {
 namespace serving {
 
+namespace internal {
+class BatchResourceBaseTestAccess;
+}  // namespace internal
+
 // Base class for resource that encapsulating the state and logic for batching
 // tensors.
 class BatchResourceBase : public ResourceBase {
@@ -91,8 +95,20 @@ class BatchResourceBase : public ResourceBase {
 
     uint64 start_time;
 
+    // The priority and estimated cost of the task, used by queues grouping
+    // tasks by priority and cost (see serving::BatchTask). May be set by
+    // CreateBatchTask(); otherwise the cost is the number of elements in each
+    // row of the first input, i.e. the sequence length of [batch, length]
+    // inputs.
+    int batching_priority = 0;
+    int64 batching_cost = 0;
+
     size_t size() const override { return inputs[0].shape().dim_size(0); }
 
+    int priority() const override { return batching_priority; }
+
+    int64 cost() const override { return batching_cost; }
+
     // Create a split task from this one. The caller needs to setup the inputs
     // of the new task
     std::unique_ptr<BatchTask> CreateSplitTask(
@@ -144,6 +160,8 @@ class BatchResourceBase : public ResourceBase {
       const std::vector<int32>& allowed_batch_sizes);
 
  private:
+  friend class internal::BatchResourceBaseTestAccess;
+
   // Implementation of calling the process batch function.
   virtual void ProcessFuncBatchImpl(
       const BatchResourceBase::BatchTask& last_task,
@@ -0,0 +1,180 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/batch_resource_base.h"
+
+#include <memory>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace serving {
+namespace internal {
+
+class BatchResourceBaseTestAccess {
+ public:
+  explicit BatchResourceBaseTestAccess(const BatchResourceBase* resource)
+      : resource_(resource) {}
+
+  Status ConcatInputTensors(const BatchResourceBase::BatchT& batch,
+                            OpKernelContext* context,
+                            std::vector<Tensor>* concatenated_tensors) {
+    return resource_->ConcatInputTensors(batch, context, concatenated_tensors);
+  }
+
+  Status SplitOutputTensors(const std::vector<Tensor>& combined_outputs,
+                            BatchResourceBase::BatchT* batch) {
+    return resource_->SplitOutputTensors(combined_outputs, batch);
+  }
+
+ private:
+  const BatchResourceBase* const resource_;
+};
+
+}  // namespace internal
+
+namespace {
+
+// A batch resource which only concatenates and splits tensors; it never runs
+// a batch.
+class TestBatchResource : public BatchResourceBase {
+ public:
+  explicit TestBatchResource(std::vector<int32> allowed_batch_sizes)
+      : BatchResourceBase(/*has_process_batch_function=*/true,
+                          std::shared_ptr<BatcherT>(), BatcherT::QueueOptions(),
+                          std::move(allowed_batch_sizes)) {}
+
+  string DebugString() const override { return "TestBatchResource"; }
+
+ private:
+  void ProcessFuncBatchImpl(
+      const BatchResourceBase::BatchTask& last_task,
+      absl::Span<const Tensor> inputs, std::vector<Tensor>* combined_outputs,
+      std::function<void(const Status&)> done) const override {
+    done(errors::Unimplemented("Not used by the test."));
+  }
+};
+
+// Rows are 16 floats wide so that the slice of a task's rows starts as
+// aligned as the batch itself.
+constexpr int kRowSize = 16;
+
+Tensor MakeRows(int num_rows, float first_value) {
+  Tensor rows(DT_FLOAT, TensorShape({num_rows, kRowSize}));
+  test::FillFn<float>(&rows, [first_value](int i) { return first_value + i; });
+  return rows;
+}
+
+class BatchResourceBaseTest : public OpsTestBase {
+ protected:
+  // Sets up a one-output kernel context for the tasks of the batch.
+  void SetUp() override {
+    TF_ASSERT_OK(NodeDefBuilder("op", "Identity")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    AddInputFromArray<float>(TensorShape({1}), {0});
+    TF_ASSERT_OK(RunOpKernel());
+  }
+
+  void AddTask(Tensor input, BatchResourceBase::BatchT* batch) {
+    auto task = absl::make_unique<BatchResourceBase::BatchTask>();
+    task->inputs.push_back(std::move(input));
+    task->context = context_.get();
+    batch->AddTask(std::move(task));
+  }
+};
+
+TEST_F(BatchResourceBaseTest, SingleTaskFillingTheBatchIsPassedThrough) {
+  auto* resource = new TestBatchResource(/*allowed_batch_sizes=*/{4});
+  core::ScopedUnref unref(resource);
+  BatchResourceBase::BatchT batch;
+  const Tensor input = MakeRows(4, 0);
+  AddTask(input, &batch);
+  batch.Close();
+
+  std::vector<Tensor> concatenated;
+  TF_ASSERT_OK(internal::BatchResourceBaseTestAccess(resource)
+                   .ConcatInputTensors(batch, context_.get(), &concatenated));
+  ASSERT_EQ(concatenated.size(), 1);
+  EXPECT_TRUE(concatenated[0].SharesBufferWith(input));
+  test::ExpectTensorEqual<float>(input, concatenated[0]);
+}
+
+TEST_F(BatchResourceBaseTest, PadsWithTheFirstRowOfTheFirstTask) {
+  auto* resource = new TestBatchResource(/*allowed_batch_sizes=*/{5});
+  core::ScopedUnref unref(resource);
+  BatchResourceBase::BatchT batch;
+  const Tensor first = MakeRows(1, 0);
+  const Tensor second = MakeRows(2, 100);
+  AddTask(first, &batch);
+  AddTask(second, &batch);
+  batch.Close();
+
+  std::vector<Tensor> concatenated;
+  TF_ASSERT_OK(internal::BatchResourceBaseTestAccess(resource)
+                   .ConcatInputTensors(batch, context_.get(), &concatenated));
+  ASSERT_EQ(concatenated.size(), 1);
+  ASSERT_EQ(concatenated[0].shape(), TensorShape({5, kRowSize}));
+  test::ExpectTensorEqual<float>(first, concatenated[0].Slice(0, 1));
+  test::ExpectTensorEqual<float>(second, concatenated[0].Slice(1, 3));
+  test::ExpectTensorEqual<float>(first, concatenated[0].Slice(3, 4));
+  test::ExpectTensorEqual<float>(first, concatenated[0].Slice(4, 5));
+}
+
+TEST_F(BatchResourceBaseTest, OutputsAreSlicesOfTheBatchedOutput) {
+  auto* resource = new TestBatchResource(/*allowed_batch_sizes=*/{6});
+  core::ScopedUnref unref(resource);
+  BatchResourceBase::BatchT batch;
+  // The tasks are splits of one input, so their outputs are gathered in a
+  // shared matrix rather than set on the kernel context.
+  auto output = std::make_shared<BatchResourceBase::TensorMatrix>(
+      2, std::vector<Tensor>(1));
+  for (int split_index = 0; split_index < 2; ++split_index) {
+    auto task = absl::make_unique<BatchResourceBase::BatchTask>();
+    task->inputs.push_back(MakeRows(2, 0));
+    task->context = context_.get();
+    task->is_partial = true;
+    task->split_index = split_index;
+    task->output = output;
+    batch.AddTask(std::move(task));
+  }
+  batch.Close();
+
+  // The batched output includes two rows of padding.
+  const Tensor combined_output = MakeRows(6, 0);
+  TF_ASSERT_OK(internal::BatchResourceBaseTestAccess(resource)
+                   .SplitOutputTensors({combined_output}, &batch));
+  for (int split_index = 0; split_index < 2; ++split_index) {
+    const Tensor& split_output = (*output)[split_index][0];
+    EXPECT_TRUE(split_output.SharesBufferWith(combined_output));
+    test::ExpectTensorEqual<float>(
+        combined_output.Slice(2 * split_index, 2 * split_index + 2),
+        split_output);
+  }
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
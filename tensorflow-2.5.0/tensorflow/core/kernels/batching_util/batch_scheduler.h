@@ -64,6 +64,16 @@ class BatchTask {
   // Returns the size of the task, in terms of how much it contributes to the
   // size of a batch. (A batch's size is the sum of its task sizes.)
   virtual size_t size() const = 0;
+
+  // Returns the priority of the task. Schedulers that group tasks by priority
+  // batch tasks with higher priority first.
+  virtual int priority() const { return 0; }
+
+  // Returns an estimate of the cost of processing each unit of the task's
+  // size, e.g. the sequence length of its inputs, or 0 if unknown. Schedulers
+  // that group tasks by cost batch tasks of similar cost together, to reduce
+  // the compute spent on padding them to a common length.
+  virtual int64 cost() const { return 0; }
 };
 
 // A thread-safe collection of BatchTasks, to be executed together in some
@@ -30,13 +30,15 @@ namespace concat_split_util {
 typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
-// Concatenates 'inputs' into a single tensor along the zeroth dimension.
-// Requires that all elements of 'inputs' have element type T. Writes to
-// 'output' using 'context' for the allocation to ensure proper device
+// Concatenates 'inputs' into a single tensor along the zeroth dimension,
+// followed by 'num_padding_rows' copies of the first row of 'inputs[0]'.
+// Requires that all elements of 'inputs' have element type T, and that
+// 'inputs[0]' has at least one row if 'num_padding_rows' is positive. Writes
+// to 'output' using 'context' for the allocation to ensure proper device
 // placement.
 template <typename T>
 Status Concat(OpKernelContext* context, const gtl::ArraySlice<Tensor> inputs,
-              Tensor* output) {
+              int64 num_padding_rows, Tensor* output) {
   const int input_dims = inputs[0].dims();
   const TensorShape& input_shape = inputs[0].shape();
 
@@ -68,19 +70,40 @@ Status Concat(OpKernelContext* context, const gtl::ArraySlice<Tensor> inputs,
     }
     output_dim0 += input.dim_size(0);
   }
+  if (num_padding_rows > 0 &&
+      (input_dims == 0 || input_shape.dim_size(0) == 0)) {
+    return errors::InvalidArgument(
+        "Cannot pad with the first row of a tensor with no rows: shape = ",
+        input_shape.DebugString());
+  }
 
   TensorShape output_shape(input_shape);
-  output_shape.set_dim(0, output_dim0);
+  output_shape.set_dim(0, output_dim0 + num_padding_rows);
   AllocatorAttributes attr;
   attr.set_on_host(true);
   TF_RETURN_IF_ERROR(context->allocate_temp(DataTypeToEnum<T>::value,
                                             output_shape, output, attr));
-  if (output->NumElements() > 0) {
-    auto output_flat = output->shaped<T, 2>({1, output->NumElements()});
+  // The padding rows are written in place after the inputs, rather than
+  // being concatenated as separate tensors.
+  if (num_padding_rows > 0 && output->NumElements() > 0) {
+    const int64 row_size = input_shape.num_elements() / input_shape.dim_size(0);
+    const T* first_row = inputs[0].unaligned_flat<T>().data();
+    T* padding = output->unaligned_flat<T>().data() + output_dim0 * row_size;
+    for (int64 i = 0; i < num_padding_rows; ++i) {
+      std::copy(first_row, first_row + row_size, padding + i * row_size);
+    }
+  }
+  // The slice shares the output buffer and starts at its beginning, so it is
+  // as aligned as the output.
+  Tensor unpadded_output =
+      num_padding_rows > 0 ? output->Slice(0, output_dim0) : *output;
+  if (unpadded_output.NumElements() > 0) {
+    auto output_flat =
+        unpadded_output.shaped<T, 2>({1, unpadded_output.NumElements()});
 #if (defined(GOOGLE_CUDA) && GOOGLE_CUDA) || \
     (defined(TENSORFLOW_USE_ROCM) && TENSORFLOW_USE_ROCM)
     if (std::is_same<Device, GPUDevice>::value) {
-      ConcatGPU<T>(context, inputs_flat, output, &output_flat);
+      ConcatGPU<T>(context, inputs_flat, &unpadded_output, &output_flat);
       return Status::OK();
     }
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
@@ -90,15 +113,24 @@ Status Concat(OpKernelContext* context, const gtl::ArraySlice<Tensor> inputs,
   return Status::OK();
 }
 
+// Same as 'Concat' above, without padding.
+template <typename T>
+Status Concat(OpKernelContext* context, const gtl::ArraySlice<Tensor> inputs,
+              Tensor* output) {
+  return Concat<T>(context, inputs, /*num_padding_rows=*/0, output);
+}
+
 // Same as 'Concat' above, but handles Tensor dtype deduction automatically.
 inline Status Concat(OpKernelContext* context,
-                     const gtl::ArraySlice<Tensor> inputs, Tensor* output) {
+                     const gtl::ArraySlice<Tensor> inputs,
+                     int64 num_padding_rows, Tensor* output) {
   const DataType type = inputs[0].dtype();
   Status concat_status;
   switch (type) {
-#define CASE(type)                                         \
-  case DataTypeToEnum<type>::value:                        \
-    concat_status = Concat<type>(context, inputs, output); \
+#define CASE(type)                                                         \
+  case DataTypeToEnum<type>::value:                                        \
+    concat_status =                                                        \
+        Concat<type>(context, inputs, num_padding_rows, output);           \
     break;
     TF_CALL_ALL_TYPES(CASE);
 #undef CASE
@@ -109,6 +141,12 @@ inline Status Concat(OpKernelContext* context,
   return concat_status;
 }
 
+// Same as 'Concat' above, without padding.
+inline Status Concat(OpKernelContext* context,
+                     const gtl::ArraySlice<Tensor> inputs, Tensor* output) {
+  return Concat(context, inputs, /*num_padding_rows=*/0, output);
+}
+
 // The Split*() functions split 'input' with element type T into 'sizes.size()'
 // tensors along the zeroth dimension, with the ith split having zeroth-
 // dimension size 'sizes[i]'. They allocate the output tensors using 'context',
@@ -0,0 +1,165 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/latency_slo_batch_tuner.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "tensorflow/core/lib/monitoring/gauge.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+// The number of batches to observe before adapting.
+constexpr int64 kMinBatchesToAdapt = 10;
+
+// The 99th percentile of the standard normal distribution.
+constexpr double kP99ZScore = 2.326;
+
+void RecordSloBatchSize(int64 batch_size, const string& name) {
+  static auto* cell = monitoring::Gauge<int64, 1>::New(
+      "/tensorflow/serving/batching/slo_batch_size",
+      "Tracks the batch size chosen to meet the latency target.",
+      "queue_name");
+  cell->GetCell(name)->Set(batch_size);
+}
+
+void RecordSloBatchTimeoutMicros(int64 batch_timeout_micros,
+                                 const string& name) {
+  static auto* cell = monitoring::Gauge<int64, 1>::New(
+      "/tensorflow/serving/batching/slo_batch_timeout_micros",
+      "Tracks the batch timeout chosen to meet the latency target.",
+      "queue_name");
+  cell->GetCell(name)->Set(batch_timeout_micros);
+}
+
+}  // namespace
+
+LatencySloBatchTuner::LatencySloBatchTuner(const Options& options)
+    : options_(options),
+      batch_size_(options.max_batch_size),
+      batch_timeout_micros_(options.initial_batch_timeout_micros) {
+  DCHECK_GT(options_.target_latency_micros, 0);
+  DCHECK_GT(options_.max_batch_size, 0);
+  DCHECK(options_.smoothing > 0 && options_.smoothing <= 1);
+}
+
+void LatencySloBatchTuner::RecordTasks(int64 now_micros, size_t num_tasks) {
+  if (arrival_window_start_micros_ < 0) {
+    arrival_window_start_micros_ = now_micros;
+  }
+  num_window_tasks_ += num_tasks;
+}
+
+void LatencySloBatchTuner::RecordBatch(int64 now_micros, size_t batch_size,
+                                       int64 processing_micros) {
+  UpdateCostModel(batch_size, processing_micros);
+  UpdateArrivalRate(now_micros);
+  UpdateDecisions();
+}
+
+double LatencySloBatchTuner::EstimatedP99ProcessingMicros(
+    size_t batch_size) const {
+  return intercept_ + slope_ * batch_size +
+         kP99ZScore * std::sqrt(residual_variance_);
+}
+
+void LatencySloBatchTuner::UpdateCostModel(double batch_size,
+                                           double processing_micros) {
+  const double alpha = options_.smoothing;
+  if (num_batches_ > 0) {
+    const double residual =
+        processing_micros - (intercept_ + slope_ * batch_size);
+    residual_variance_ = num_batches_ == 1
+                             ? residual * residual
+                             : (1 - alpha) * residual_variance_ +
+                                   alpha * residual * residual;
+  }
+  ++num_batches_;
+
+  const double decay = 1 - alpha;
+  sum_weights_ = decay * sum_weights_ + 1;
+  sum_x_ = decay * sum_x_ + batch_size;
+  sum_y_ = decay * sum_y_ + processing_micros;
+  sum_xx_ = decay * sum_xx_ + batch_size * batch_size;
+  sum_xy_ = decay * sum_xy_ + batch_size * processing_micros;
+
+  const double mean_x = sum_x_ / sum_weights_;
+  const double mean_y = sum_y_ / sum_weights_;
+  const double variance_x = sum_xx_ / sum_weights_ - mean_x * mean_x;
+  // Below this spread of batch sizes, the slope can't be told apart from the
+  // intercept.
+  constexpr double kMinVarianceX = 0.25;
+  if (variance_x > kMinVarianceX) {
+    slope_ = (sum_xy_ / sum_weights_ - mean_x * mean_y) / variance_x;
+    intercept_ = mean_y - slope_ * mean_x;
+  } else {
+    // Assume the cost is proportional to the batch size, which overestimates
+    // the cost of larger batches if there is a fixed cost per batch.
+    slope_ = mean_y / mean_x;
+    intercept_ = 0;
+  }
+  if (slope_ < 0) {
+    slope_ = 0;
+    intercept_ = mean_y;
+  } else if (intercept_ < 0) {
+    // Fit through the origin instead.
+    slope_ = sum_xy_ / sum_xx_;
+    intercept_ = 0;
+  }
+}
+
+void LatencySloBatchTuner::UpdateArrivalRate(int64 now_micros) {
+  if (arrival_window_start_micros_ < 0 ||
+      now_micros <= arrival_window_start_micros_) {
+    return;
+  }
+  const double rate = static_cast<double>(num_window_tasks_) /
+                      (now_micros - arrival_window_start_micros_);
+  if (arrival_rate_ == 0) {
+    arrival_rate_ = rate;
+  } else {
+    arrival_rate_ =
+        (1 - options_.smoothing) * arrival_rate_ + options_.smoothing * rate;
+  }
+  arrival_window_start_micros_ = now_micros;
+  num_window_tasks_ = 0;
+}
+
+void LatencySloBatchTuner::UpdateDecisions() {
+  if (num_batches_ < kMinBatchesToAdapt || arrival_rate_ <= 0) return;
+
+  const double target = options_.target_latency_micros;
+  const double budget =
+      target - intercept_ - kP99ZScore * std::sqrt(residual_variance_);
+  // Largest batch size that can fill and be processed within the target.
+  const double size = budget / (1 / arrival_rate_ + slope_);
+  batch_size_ = size < 1 ? 1
+                         : std::min<double>(std::floor(size),
+                                            options_.max_batch_size);
+  const double timeout = target - EstimatedP99ProcessingMicros(batch_size_);
+  batch_timeout_micros_ = std::max<int64>(0, static_cast<int64>(timeout));
+
+  if (!options_.name.empty()) {
+    RecordSloBatchSize(batch_size_, options_.name);
+    RecordSloBatchTimeoutMicros(batch_timeout_micros_, options_.name);
+  }
+}
+
+}  // namespace serving
+}  // namespace tensorflow
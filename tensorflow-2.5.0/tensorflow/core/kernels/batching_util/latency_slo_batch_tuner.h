@@ -0,0 +1,128 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_LATENCY_SLO_BATCH_TUNER_H_
+#define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_LATENCY_SLO_BATCH_TUNER_H_
+
+#include <stddef.h>
+
+#include <string>
+
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace serving {
+
+// Chooses the batch size and batch timeout of a batching queue so that the
+// latency of its tasks, from submission to the end of batch processing, stays
+// below a target at the 99th percentile, while making batches as large as
+// possible for throughput.
+//
+// The tuner learns a linear model of batch processing time versus batch size
+// from completed batches, and tracks the task arrival rate. Both are averaged
+// with exponential forgetting, so the decisions follow changes in load, model
+// or hardware. A task waits at most for its batch to fill, about
+// batch_size / arrival_rate, and then for the batch to be processed, so the
+// tuner picks the largest batch size for which
+//
+//   batch_size / arrival_rate + p99_processing_time(batch_size) <= target
+//
+// and a timeout of target - p99_processing_time(batch_size), which bounds the
+// latency when arrivals slow down. The p99 processing time is estimated from
+// the model and the spread of its residuals. Time spent waiting for a free
+// batch thread is not modeled.
+//
+// Until enough batches have been observed, the tuner returns the maximum batch
+// size and the initial timeout.
+//
+// Not thread-safe.
+class LatencySloBatchTuner {
+ public:
+  struct Options {
+    // The target latency, in microseconds. Must be positive.
+    int64 target_latency_micros = 0;
+
+    // The largest batch size the tuner may choose.
+    size_t max_batch_size = 1000;
+
+    // The timeout used until enough batches have been observed.
+    int64 initial_batch_timeout_micros = 0;
+
+    // The weight of each new observation in the running averages, in (0, 1].
+    double smoothing = 0.05;
+
+    // If not empty, the decisions are exported to the
+    // /tensorflow/serving/batching/slo_* gauges under this name.
+    std::string name;
+  };
+
+  explicit LatencySloBatchTuner(const Options& options);
+
+  // Records that `num_tasks` units of work were submitted at `now_micros`.
+  void RecordTasks(int64 now_micros, size_t num_tasks);
+
+  // Records that a batch of `batch_size` units of work finished processing at
+  // `now_micros`, after `processing_micros`, and updates the decisions.
+  void RecordBatch(int64 now_micros, size_t batch_size,
+                   int64 processing_micros);
+
+  size_t batch_size() const { return batch_size_; }
+  int64 batch_timeout_micros() const { return batch_timeout_micros_; }
+
+  // Returns the estimated 99th percentile of the processing time of a batch of
+  // `batch_size`, in microseconds.
+  double EstimatedP99ProcessingMicros(size_t batch_size) const;
+
+  // Returns the estimated task arrival rate, in units of work per microsecond.
+  double arrival_rate() const { return arrival_rate_; }
+
+ private:
+  // Updates the cost model with a processing time sample.
+  void UpdateCostModel(double batch_size, double processing_micros);
+
+  // Updates the arrival rate from the tasks recorded since the last update.
+  void UpdateArrivalRate(int64 now_micros);
+
+  // Recomputes batch_size_ and batch_timeout_micros_.
+  void UpdateDecisions();
+
+  const Options options_;
+
+  // Cost model: processing_micros = intercept_ + slope_ * batch_size, fitted
+  // from exponentially weighted sums of the samples.
+  double sum_weights_ = 0;
+  double sum_x_ = 0;
+  double sum_y_ = 0;
+  double sum_xx_ = 0;
+  double sum_xy_ = 0;
+  double intercept_ = 0;
+  double slope_ = 0;
+  // Exponentially weighted variance of the residuals of the model.
+  double residual_variance_ = 0;
+  int64 num_batches_ = 0;
+
+  // Tasks recorded since arrival_window_start_micros_.
+  size_t num_window_tasks_ = 0;
+  int64 arrival_window_start_micros_ = -1;
+  double arrival_rate_ = 0;
+
+  size_t batch_size_;
+  int64 batch_timeout_micros_;
+};
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_LATENCY_SLO_BATCH_TUNER_H_
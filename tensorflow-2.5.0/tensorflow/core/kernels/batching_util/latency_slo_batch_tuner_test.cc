@@ -0,0 +1,135 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/latency_slo_batch_tuner.h"
+
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+// Feeds `num_batches` batches with sizes cycling through [min_size, max_size],
+// arriving at `arrival_rate` units of work per microsecond and processed in
+// `fixed_micros + micros_per_task * size`.
+void FeedBatches(int num_batches, size_t min_size, size_t max_size,
+                 double arrival_rate, double fixed_micros,
+                 double micros_per_task, int64* now_micros,
+                 LatencySloBatchTuner* tuner) {
+  for (int i = 0; i < num_batches; ++i) {
+    const size_t size = min_size + i % (max_size - min_size + 1);
+    tuner->RecordTasks(*now_micros, size);
+    *now_micros += static_cast<int64>(size / arrival_rate);
+    tuner->RecordBatch(*now_micros, size,
+                       static_cast<int64>(fixed_micros +
+                                          micros_per_task * size));
+  }
+}
+
+LatencySloBatchTuner::Options GetOptions(int64 target_latency_micros) {
+  LatencySloBatchTuner::Options options;
+  options.target_latency_micros = target_latency_micros;
+  options.max_batch_size = 128;
+  options.initial_batch_timeout_micros = 500;
+  return options;
+}
+
+TEST(LatencySloBatchTunerTest, UsesInitialValuesUntilAdapted) {
+  LatencySloBatchTuner tuner(GetOptions(/*target_latency_micros=*/1000));
+  int64 now_micros = 0;
+  FeedBatches(/*num_batches=*/5, /*min_size=*/10, /*max_size=*/30,
+              /*arrival_rate=*/1, /*fixed_micros=*/100,
+              /*micros_per_task=*/10, &now_micros, &tuner);
+
+  EXPECT_EQ(tuner.batch_size(), 128);
+  EXPECT_EQ(tuner.batch_timeout_micros(), 500);
+}
+
+TEST(LatencySloBatchTunerTest, LearnsLinearCostModel) {
+  LatencySloBatchTuner tuner(GetOptions(/*target_latency_micros=*/1000));
+  int64 now_micros = 0;
+  FeedBatches(/*num_batches=*/300, /*min_size=*/10, /*max_size=*/30,
+              /*arrival_rate=*/1, /*fixed_micros=*/100,
+              /*micros_per_task=*/10, &now_micros, &tuner);
+
+  EXPECT_NEAR(tuner.EstimatedP99ProcessingMicros(1), 110, 1);
+  EXPECT_NEAR(tuner.EstimatedP99ProcessingMicros(50), 600, 1);
+  EXPECT_NEAR(tuner.arrival_rate(), 1, 1e-6);
+}
+
+TEST(LatencySloBatchTunerTest, ChoosesLargestBatchMeetingTarget) {
+  LatencySloBatchTuner tuner(GetOptions(/*target_latency_micros=*/1000));
+  int64 now_micros = 0;
+  FeedBatches(/*num_batches=*/300, /*min_size=*/10, /*max_size=*/30,
+              /*arrival_rate=*/1, /*fixed_micros=*/100,
+              /*micros_per_task=*/10, &now_micros, &tuner);
+
+  // A batch of b fills in b us and is processed in 100 + 10 * b us, so the
+  // largest batch within 1000 us is 81, with 1000 - 910 us left to fill it.
+  EXPECT_EQ(tuner.batch_size(), 81);
+  EXPECT_NEAR(tuner.batch_timeout_micros(), 90, 1);
+}
+
+TEST(LatencySloBatchTunerTest, LimitsBatchSize) {
+  LatencySloBatchTuner tuner(GetOptions(/*target_latency_micros=*/100000));
+  int64 now_micros = 0;
+  FeedBatches(/*num_batches=*/100, /*min_size=*/10, /*max_size=*/30,
+              /*arrival_rate=*/1, /*fixed_micros=*/100,
+              /*micros_per_task=*/10, &now_micros, &tuner);
+
+  EXPECT_EQ(tuner.batch_size(), 128);
+}
+
+TEST(LatencySloBatchTunerTest, ProcessesImmediatelyIfTargetIsUnreachable) {
+  LatencySloBatchTuner tuner(GetOptions(/*target_latency_micros=*/100));
+  int64 now_micros = 0;
+  FeedBatches(/*num_batches=*/100, /*min_size=*/10, /*max_size=*/30,
+              /*arrival_rate=*/1, /*fixed_micros=*/100,
+              /*micros_per_task=*/10, &now_micros, &tuner);
+
+  EXPECT_EQ(tuner.batch_size(), 1);
+  EXPECT_EQ(tuner.batch_timeout_micros(), 0);
+}
+
+TEST(LatencySloBatchTunerTest, AdaptsToSlowerModel) {
+  LatencySloBatchTuner tuner(GetOptions(/*target_latency_micros=*/1000));
+  int64 now_micros = 0;
+  FeedBatches(/*num_batches=*/100, /*min_size=*/10, /*max_size=*/30,
+              /*arrival_rate=*/1, /*fixed_micros=*/100,
+              /*micros_per_task=*/10, &now_micros, &tuner);
+  EXPECT_EQ(tuner.batch_size(), 81);
+
+  FeedBatches(/*num_batches=*/300, /*min_size=*/10, /*max_size=*/30,
+              /*arrival_rate=*/1, /*fixed_micros=*/100,
+              /*micros_per_task=*/20, &now_micros, &tuner);
+  // (1000 - 100) / (1 + 20) = 42.9.
+  EXPECT_NEAR(tuner.batch_size(), 42, 1);
+}
+
+TEST(LatencySloBatchTunerTest, AdaptsToArrivalRate) {
+  LatencySloBatchTuner tuner(GetOptions(/*target_latency_micros=*/1000));
+  int64 now_micros = 0;
+  FeedBatches(/*num_batches=*/300, /*min_size=*/10, /*max_size=*/30,
+              /*arrival_rate=*/0.1, /*fixed_micros=*/100,
+              /*micros_per_task=*/10, &now_micros, &tuner);
+
+  // (1000 - 100) / (10 + 10) = 45.
+  EXPECT_NEAR(tuner.batch_size(), 45, 1);
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <stddef.h>
 
+#include <algorithm>
 #include <deque>
 #include <functional>
 #include <list>
@@ -28,6 +29,7 @@ limitations under the License.
 
 #include "absl/time/clock.h"
 #include "tensorflow/core/kernels/batching_util/batch_scheduler.h"
+#include "tensorflow/core/kernels/batching_util/latency_slo_batch_tuner.h"
 #include "tensorflow/core/kernels/batching_util/periodic_function.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -195,6 +197,29 @@ class SharedBatchScheduler
     // submit batches whose size is in a small set of allowed sizes, that can be
     // done by adding padding in the process-batch callback.
     size_t max_execution_batch_size = 1000;
+
+    // If positive, a target for the 99th percentile latency of tasks, in
+    // microseconds, from Schedule() to the end of batch processing. The queue
+    // then learns how long batches take to process and how fast tasks arrive,
+    // and adapts the batch size at which the open batch is scheduled and the
+    // batch timeout to maximize throughput within the target (see
+    // LatencySloBatchTuner). `batch_timeout_micros` is used until enough
+    // batches have been processed. Batches may still grow up to the maximum
+    // batch size while all batch threads are busy.
+    int64 target_latency_micros = 0;
+
+    // Identifies the queue in the batch size and timeout metrics exported when
+    // `target_latency_micros` is set. No metrics are exported if empty.
+    std::string queue_name;
+
+    // If true, each batch is formed from all enqueued tasks when it is
+    // scheduled, rather than from tasks in arrival order: tasks with the
+    // highest BatchTask::priority() are batched first, grouped with others
+    // of similar BatchTask::cost() to reduce padding, and capacity left over
+    // is filled with lower-priority tasks that cost no more. The remaining
+    // tasks stay enqueued in arrival order. (Note that a steady stream of
+    // higher-priority tasks can starve lower-priority ones.)
+    bool enable_priority_and_cost_grouping = false;
   };
   Status AddQueue(const QueueOptions& options,
                   std::function<void(std::unique_ptr<Batch<TaskType>>)>
@@ -243,6 +268,118 @@ class SharedBatchScheduler
 
 namespace internal {
 
+// Chooses which of 'tasks', given in arrival order, to process together in a
+// batch of size at most 'max_batch_size'. Returns their indices in arrival
+// order.
+//
+// Among the tasks of the highest priority sorted by cost, picks the run of
+// tasks that fits in the batch, includes the oldest one and makes the most of
+// the batch, i.e. maximizes the summed cost of its tasks per unit of cost of
+// its most costly task. Then fills the space left with the other tasks that
+// cost no more than that, by decreasing priority and cost.
+template <typename TaskType>
+std::vector<int> SelectTasksToBatch(
+    const std::vector<std::unique_ptr<TaskType>>& tasks,
+    size_t max_batch_size) {
+  std::vector<int> selected;
+  if (tasks.empty()) {
+    return selected;
+  }
+  // Tasks of unknown cost count as having the smallest cost.
+  auto cost = [&tasks](int i) { return std::max<int64>(tasks[i]->cost(), 1); };
+  auto size = [&tasks](int i) { return tasks[i]->size(); };
+
+  const int num_tasks = tasks.size();
+  int top_priority = tasks[0]->priority();
+  for (const auto& task : tasks) {
+    top_priority = std::max(top_priority, task->priority());
+  }
+  std::vector<int> candidates;
+  for (int i = 0; i < num_tasks; ++i) {
+    if (tasks[i]->priority() == top_priority) {
+      candidates.push_back(i);
+    }
+  }
+  const int oldest = candidates.front();
+  std::sort(candidates.begin(), candidates.end(), [&cost](int a, int b) {
+    return cost(a) != cost(b) ? cost(a) < cost(b) : a < b;
+  });
+  const int oldest_pos =
+      std::find(candidates.begin(), candidates.end(), oldest) -
+      candidates.begin();
+
+  // For each start of the run, extends it as far as it fits. Both ends only
+  // move forward.
+  const int num_candidates = candidates.size();
+  int best_begin = oldest_pos;
+  int best_end = oldest_pos + 1;
+  double best_utilization = -1;
+  int end = 0;
+  size_t run_size = 0;
+  double run_cost = 0;
+  for (int begin = 0; begin <= oldest_pos; ++begin) {
+    if (end < begin) {
+      end = begin;
+      run_size = 0;
+      run_cost = 0;
+    }
+    while (end < num_candidates &&
+           run_size + size(candidates[end]) <= max_batch_size) {
+      run_size += size(candidates[end]);
+      run_cost += static_cast<double>(size(candidates[end])) *
+                  cost(candidates[end]);
+      ++end;
+    }
+    if (end > oldest_pos) {
+      const double utilization = run_cost / cost(candidates[end - 1]);
+      if (utilization > best_utilization) {
+        best_utilization = utilization;
+        best_begin = begin;
+        best_end = end;
+      }
+    }
+    if (end > begin) {
+      run_size -= size(candidates[begin]);
+      run_cost -= static_cast<double>(size(candidates[begin])) *
+                  cost(candidates[begin]);
+    }
+  }
+
+  std::vector<bool> is_selected(tasks.size(), false);
+  size_t batch_size = 0;
+  for (int pos = best_begin; pos < best_end; ++pos) {
+    is_selected[candidates[pos]] = true;
+    batch_size += size(candidates[pos]);
+  }
+
+  const int64 max_cost = cost(candidates[best_end - 1]);
+  std::vector<int> fillers;
+  for (int i = 0; i < num_tasks; ++i) {
+    if (!is_selected[i] && cost(i) <= max_cost) {
+      fillers.push_back(i);
+    }
+  }
+  std::sort(fillers.begin(), fillers.end(), [&tasks, &cost](int a, int b) {
+    if (tasks[a]->priority() != tasks[b]->priority()) {
+      return tasks[a]->priority() > tasks[b]->priority();
+    }
+    return cost(a) != cost(b) ? cost(a) > cost(b) : a < b;
+  });
+  for (const int i : fillers) {
+    if (batch_size + size(i) <= max_batch_size) {
+      is_selected[i] = true;
+      batch_size += size(i);
+    }
+  }
+
+  for (int i = 0; i < num_tasks; ++i) {
+    if (is_selected[i]) {
+      selected.push_back(i);
+    }
+  }
+  return selected;
+}
+
 // A task queue for SharedBatchScheduler. Accepts tasks and accumulates them
 // into batches, and dispenses those batches to be processed via a "pull"
 // interface. The queue's behavior is governed by maximum batch size, timeout
@@ -346,6 +483,17 @@ class Queue {
   // currently schedulable.
   bool IsOpenBatchSchedulable() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Moves the tasks chosen by SelectTasksToBatch() out of all batches in
+  // 'batches_' into the front-most one, and repacks the others in arrival
+  // order into the batches behind it. Requires at least two batches.
+  void GroupTasksByPriorityAndCost() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // The batch size at which the open batch becomes schedulable, and how long
+  // its first task may wait before it does. Chosen by 'latency_tuner_' if
+  // there is one.
+  size_t schedulable_batch_size() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  int64 batch_timeout_micros() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   const typename SharedBatchScheduler<TaskType>::QueueOptions options_;
 
   // The environment to use.
@@ -380,6 +528,10 @@ class Queue {
   // Used to keep track of when to call 'schedulable_batch_callback_'.
   bool schedulable_batch_ TF_GUARDED_BY(mu_) = false;
 
+  // Adapts the batch size and timeout to 'options_.target_latency_micros'.
+  // Null if there is no target.
+  std::unique_ptr<LatencySloBatchTuner> latency_tuner_ TF_GUARDED_BY(mu_);
+
   // The number of batches currently being processed by batch threads.
   // Incremented in ScheduleBatch() and decremented in ProcessBatch().
   int num_batches_being_processed_ TF_GUARDED_BY(mu_) = 0;
@@ -474,6 +626,11 @@ Status SharedBatchScheduler<TaskType>::AddQueue(
         "max_enqueued_batches must be non-negative; was ",
         options.max_enqueued_batches);
   }
+  if (options.target_latency_micros < 0) {
+    return errors::InvalidArgument(
+        "target_latency_micros must be non-negative; was ",
+        options.target_latency_micros);
+  }
 
   if (options.enable_large_batch_splitting &&
       options.split_input_task_func == nullptr) {
@@ -601,6 +758,14 @@ Queue<TaskType>::Queue(
   traceme_context_id_counter_ = absl::GetCurrentTimeNanos() << 32;
   // Create an initial, open batch.
   batches_.emplace_back(new Batch<TaskType>);
+  if (options_.target_latency_micros > 0) {
+    LatencySloBatchTuner::Options tuner_options;
+    tuner_options.target_latency_micros = options_.target_latency_micros;
+    tuner_options.max_batch_size = max_execution_batch_size();
+    tuner_options.initial_batch_timeout_micros = options_.batch_timeout_micros;
+    tuner_options.name = options_.queue_name;
+    latency_tuner_.reset(new LatencySloBatchTuner(tuner_options));
+  }
 }
 
 template <typename TaskType>
@@ -646,6 +811,9 @@ Status Queue<TaskType>::ScheduleWithoutSplit(std::unique_ptr<TaskType>* task) {
     if (batches_.back()->empty()) {
       open_batch_start_time_micros_ = env_->NowMicros();
     }
+    if (latency_tuner_ != nullptr) {
+      latency_tuner_->RecordTasks(env_->NowMicros(), (*task)->size());
+    }
     profiler::TraceMeProducer trace_me(
         [task] {
           return profiler::TraceMeEncode(
@@ -719,6 +887,9 @@ Status Queue<TaskType>::ScheduleWithSplit(std::unique_ptr<TaskType>* task) {
         max_execution_batch_size - batches_.back()->size();
 
     const int64 input_task_size = (*task)->size();
+    if (latency_tuner_ != nullptr) {
+      latency_tuner_->RecordTasks(env_->NowMicros(), input_task_size);
+    }
 
     std::vector<std::unique_ptr<TaskType>> output_tasks;
 
@@ -798,6 +969,9 @@ std::unique_ptr<Batch<TaskType>> Queue<TaskType>::ScheduleBatch() {
     }
 
     if (batches_.size() >= 2) {
+      if (options_.enable_priority_and_cost_grouping) {
+        GroupTasksByPriorityAndCost();
+      }
       // There is at least one closed batch that is ready to be scheduled.
       ++num_batches_being_processed_;
       batch_to_schedule = std::move(batches_.front());
@@ -820,10 +994,17 @@ void Queue<TaskType>::ProcessBatch(std::unique_ptr<Batch<TaskType>> batch) {
       },
       profiler::ContextType::kSharedBatchScheduler,
       batch->traceme_context_id());
+  const size_t batch_size = batch->size();
+  const uint64 start_time_micros = env_->NowMicros();
   process_batch_callback_(std::move(batch));
 
   {
     mutex_lock l(mu_);
+    if (latency_tuner_ != nullptr) {
+      const uint64 end_time_micros = env_->NowMicros();
+      latency_tuner_->RecordBatch(end_time_micros, batch_size,
+                                  end_time_micros - start_time_micros);
+    }
     --num_batches_being_processed_;
     if (empty_notification_ != nullptr && IsEmptyInternal()) {
       empty_notification_->Notify();
@@ -882,9 +1063,59 @@ bool Queue<TaskType>::IsOpenBatchSchedulable() const {
   if (open_batch->empty()) {
     return false;
   }
-  return closed_ || open_batch->size() >= max_execution_batch_size() ||
+  return closed_ || open_batch->size() >= schedulable_batch_size() ||
          env_->NowMicros() >=
-             open_batch_start_time_micros_ + options_.batch_timeout_micros;
+             open_batch_start_time_micros_ + batch_timeout_micros();
+}
+
+template <typename TaskType>
+void Queue<TaskType>::GroupTasksByPriorityAndCost() {
+  const uint64 traceme_context_id = batches_.front()->traceme_context_id();
+  std::vector<std::unique_ptr<TaskType>> tasks;
+  for (auto& batch : batches_) {
+    const int first_task = tasks.size();
+    while (!batch->empty()) {
+      tasks.push_back(batch->RemoveTask());
+    }
+    std::reverse(tasks.begin() + first_task, tasks.end());
+    if (!batch->IsClosed()) {
+      batch->Close();
+    }
+  }
+  batches_.clear();
+
+  const std::vector<int> selected =
+      SelectTasksToBatch(tasks, max_execution_batch_size());
+  batches_.emplace_back(new Batch<TaskType>(traceme_context_id));
+  for (const int i : selected) {
+    batches_.back()->AddTask(std::move(tasks[i]));
+  }
+  StartNewBatch();
+  for (auto& task : tasks) {
+    if (task == nullptr) {
+      continue;
+    }
+    if (batches_.back()->size() + task->size() > max_execution_batch_size()) {
+      StartNewBatch();
+    }
+    batches_.back()->AddTask(std::move(task));
+  }
+}
+
+template <typename TaskType>
+size_t Queue<TaskType>::schedulable_batch_size() const {
+  if (latency_tuner_ != nullptr) {
+    return latency_tuner_->batch_size();
+  }
+  return max_execution_batch_size();
+}
+
+template <typename TaskType>
+int64 Queue<TaskType>::batch_timeout_micros() const {
+  if (latency_tuner_ != nullptr) {
+    return latency_tuner_->batch_timeout_micros();
+  }
+  return options_.batch_timeout_micros;
 }
 
 template <typename TaskType>
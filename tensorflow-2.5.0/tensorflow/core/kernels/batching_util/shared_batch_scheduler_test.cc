@@ -28,14 +28,21 @@ namespace {
 
 class FakeTask : public BatchTask {
  public:
-  explicit FakeTask(size_t size) : size_(size) {}
+  explicit FakeTask(size_t size, int priority = 0, int64 cost = 0)
+      : size_(size), priority_(priority), cost_(cost) {}
 
   ~FakeTask() override = default;
 
   size_t size() const override { return size_; }
 
+  int priority() const override { return priority_; }
+
+  int64 cost() const override { return cost_; }
+
  private:
   const size_t size_;
+  const int priority_;
+  const int64 cost_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(FakeTask);
 };
@@ -254,6 +261,158 @@ TEST(SharedBatchSchedulerTest, ObeysTimeout) {
   stop_teardown.Notify();
 }
 
+TEST(SharedBatchSchedulerTest, AdaptsBatchSizeToTargetLatency) {
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+
+  {
+    mutex mu;
+    std::vector<size_t> batch_sizes;
+    // Each batch takes 110us per task to process.
+    auto callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+      env.AdvanceByMicroseconds(110 * batch->size());
+      mutex_lock l(mu);
+      batch_sizes.push_back(batch->size());
+    };
+    auto wait_for_batches = [&](size_t num_batches) {
+      for (;;) {
+        {
+          mutex_lock l(mu);
+          if (batch_sizes.size() >= num_batches) return;
+        }
+        Env::Default()->SleepForMicroseconds(100);
+      }
+    };
+
+    SharedBatchScheduler<FakeTask>::Options options;
+    options.num_batch_threads = 1;
+    options.env = &env;
+    std::shared_ptr<SharedBatchScheduler<FakeTask>> scheduler;
+    TF_ASSERT_OK(SharedBatchScheduler<FakeTask>::Create(options, &scheduler));
+    SharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+    queue_options.input_batch_size_limit = 100;
+    queue_options.batch_timeout_micros = 0;
+    queue_options.max_enqueued_batches = 2;
+    queue_options.target_latency_micros = 1000;
+    std::unique_ptr<BatchScheduler<FakeTask>> queue;
+    TF_ASSERT_OK(scheduler->AddQueue(queue_options, callback, &queue));
+
+    // Without a timeout, tasks are processed one at a time, one every 110us,
+    // until the tuner has seen enough batches to adapt.
+    constexpr int kNumTrainingBatches = 10;
+    for (int i = 0; i < kNumTrainingBatches; ++i) {
+      TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+      wait_for_batches(i + 1);
+    }
+
+    // A batch of 4 fills in 440us and is processed in 440us, a batch of 5
+    // would take 1100us, so the queue waits for 4 tasks.
+    for (int i = 0; i < 3; ++i) {
+      TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    }
+    Env::Default()->SleepForMicroseconds(10 * 1000 /* 10 milliseconds */);
+    {
+      mutex_lock l(mu);
+      EXPECT_EQ(batch_sizes.size(), kNumTrainingBatches);
+    }
+    TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    wait_for_batches(kNumTrainingBatches + 1);
+    {
+      mutex_lock l(mu);
+      EXPECT_EQ(batch_sizes.back(), 4);
+    }
+
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
+TEST(SharedBatchSchedulerTest, RejectsNegativeTargetLatency) {
+  SharedBatchScheduler<FakeTask>::Options options;
+  std::shared_ptr<SharedBatchScheduler<FakeTask>> scheduler;
+  TF_ASSERT_OK(SharedBatchScheduler<FakeTask>::Create(options, &scheduler));
+  SharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+  queue_options.target_latency_micros = -1;
+  std::unique_ptr<BatchScheduler<FakeTask>> queue;
+  EXPECT_FALSE(
+      scheduler
+          ->AddQueue(queue_options,
+                     [](std::unique_ptr<Batch<FakeTask>> batch) {}, &queue)
+          .ok());
+}
+
+TEST(SharedBatchSchedulerTest, SelectsTasksOfSimilarCost) {
+  std::vector<std::unique_ptr<FakeTask>> tasks;
+  for (const int64 cost : {10, 50, 11, 52, 12, 51}) {
+    tasks.emplace_back(new FakeTask(1, 0, cost));
+  }
+  EXPECT_EQ(internal::SelectTasksToBatch(tasks, 3),
+            std::vector<int>({0, 2, 4}));
+  EXPECT_EQ(internal::SelectTasksToBatch(tasks, 6),
+            std::vector<int>({0, 1, 2, 3, 4, 5}));
+}
+
+TEST(SharedBatchSchedulerTest, SelectsHighPriorityTasksFirst) {
+  std::vector<std::unique_ptr<FakeTask>> tasks;
+  tasks.emplace_back(new FakeTask(1, 0, 5));
+  tasks.emplace_back(new FakeTask(2, 1, 10));
+  tasks.emplace_back(new FakeTask(1, 0, 20));
+  tasks.emplace_back(new FakeTask(1, 0, 8));
+  // Only the low-priority tasks costing no more than the high-priority one
+  // fill the rest of the batch.
+  EXPECT_EQ(internal::SelectTasksToBatch(tasks, 4),
+            std::vector<int>({0, 1, 3}));
+  EXPECT_EQ(internal::SelectTasksToBatch(tasks, 3), std::vector<int>({1, 3}));
+  EXPECT_EQ(internal::SelectTasksToBatch(tasks, 2), std::vector<int>({1}));
+}
+
+TEST(SharedBatchSchedulerTest, GroupsTasksByPriorityAndCost) {
+  mutex mu;
+  std::vector<std::vector<int64>> batch_costs;
+  Notification blocking_batch_started, unblock;
+  auto callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+    std::vector<int64> costs;
+    for (int i = 0; i < batch->num_tasks(); ++i) {
+      costs.push_back(batch->task(i).cost());
+    }
+    if (costs == std::vector<int64>({0})) {
+      blocking_batch_started.Notify();
+      unblock.WaitForNotification();
+    }
+    mutex_lock l(mu);
+    batch_costs.push_back(costs);
+  };
+
+  {
+    SharedBatchScheduler<FakeTask>::Options options;
+    options.num_batch_threads = 1;
+    std::shared_ptr<SharedBatchScheduler<FakeTask>> scheduler;
+    TF_ASSERT_OK(SharedBatchScheduler<FakeTask>::Create(options, &scheduler));
+    SharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+    queue_options.input_batch_size_limit = 3;
+    queue_options.batch_timeout_micros = 0;
+    queue_options.enable_priority_and_cost_grouping = true;
+    std::unique_ptr<BatchScheduler<FakeTask>> queue;
+    TF_ASSERT_OK(scheduler->AddQueue(queue_options, callback, &queue));
+
+    // Occupy the batch thread while the other tasks are enqueued.
+    std::unique_ptr<FakeTask> blocking_task(new FakeTask(3));
+    TF_ASSERT_OK(queue->Schedule(&blocking_task));
+    blocking_batch_started.WaitForNotification();
+    for (const int64 cost : {10, 50, 11, 52, 12, 51}) {
+      std::unique_ptr<FakeTask> task(new FakeTask(1, 0, cost));
+      TF_ASSERT_OK(queue->Schedule(&task));
+    }
+    unblock.Notify();
+  }
+
+  mutex_lock l(mu);
+  EXPECT_EQ(batch_costs, std::vector<std::vector<int64>>(
+                             {{0}, {10, 11, 12}, {50, 52, 51}}));
+}
+
 TEST(SharedBatchSchedulerTest, ObeysTimeoutWithRealClock) {
   Notification first_batch_processed, second_batch_processed;
   auto callback = [&first_batch_processed, &second_batch_processed](
@@ -18,6 +18,9 @@ limitations under the License.
 #include "tensorflow/core/platform/errors.h"
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <vector>
+
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.h"
@@ -35,6 +38,142 @@ typedef Eigen::GpuDevice GPUDevice;
 
 namespace functor {
 
+namespace {
+
+// Above this size of the per-thread partial bins, the bins are instead split
+// into ranges that are each updated by a single thread (see
+// BincountByBinRange).
+constexpr int64 kMaxPartialBinsBytes = 16 << 20;
+
+// Up to this number of bins, each thread interleaves its updates over several
+// partial histograms, so that consecutive updates of the same bin don't wait
+// for each other's stores.
+constexpr int64 kMaxBinsForSubHistograms = 1024;
+constexpr int64 kNumSubHistograms = 4;
+
+// Returns the number of partial histograms that
+// PartialBincount<Tacc> allocates, or 0 if BincountByBinRange should be used.
+template <typename Tacc>
+int64 NumPartialBins(int64 num_threads, int64 num_bins) {
+  if (num_threads * num_bins * sizeof(Tacc) > kMaxPartialBinsBytes) return 0;
+  return num_bins <= kMaxBinsForSubHistograms
+             ? num_threads * kNumSubHistograms
+             : num_threads;
+}
+
+// Accumulates every arr(i) < num_bins into a matrix of 'num_partial' partial
+// histograms with update(&partial_bins(p, arr(i)), i). The caller reduces
+// them along the 0th axis.
+template <typename Tacc, typename Tidx, typename Update>
+Status PartialBincount(OpKernelContext* context,
+                       const typename TTypes<Tidx, 1>::ConstTensor& arr,
+                       const Tidx num_bins, int64 num_partial, Update update,
+                       Tensor* partial_bins_t) {
+  TF_RETURN_IF_ERROR(context->allocate_temp(
+      DataTypeToEnum<Tacc>::value, TensorShape({num_partial, num_bins}),
+      partial_bins_t));
+  auto partial_bins = partial_bins_t->matrix<Tacc>();
+  partial_bins.setZero();
+  // Worker ids in ParallelForWithWorkerId range from 0 to NumThreads()
+  // inclusive.
+  ThreadPool* thread_pool =
+      context->device()->tensorflow_cpu_worker_threads()->workers;
+  const int64 num_sub = num_partial / (thread_pool->NumThreads() + 1);
+  thread_pool->ParallelForWithWorkerId(
+      arr.size(), 8 /* cost */,
+      [&](int64 start_ind, int64 limit_ind, int64 worker_id) {
+        const int64 first = worker_id * num_sub;
+        for (int64 i = start_ind; i < limit_ind; i++) {
+          Tidx value = arr(i);
+          if (value < num_bins) {
+            update(&partial_bins(first + i % num_sub, value), i);
+          }
+        }
+      });
+  return Status::OK();
+}
+
+// Accumulates every arr(i) < num_bins directly into output with
+// update(&output(arr(i)), i), using memory proportional to the size of arr
+// rather than to the number of bins. The positions of arr are first
+// partitioned by ranges of bins with a stable counting sort, then each range
+// is updated by a single thread, in the order of the positions.
+template <typename T, typename Tidx, typename Update>
+Status BincountByBinRange(OpKernelContext* context,
+                          const typename TTypes<Tidx, 1>::ConstTensor& arr,
+                          typename TTypes<T, 1>::Tensor& output,
+                          const Tidx num_bins, Update update) {
+  // Bin ranges of at most 256KB, and enough of them to balance the threads.
+  static constexpr int64 kMaxRangeBytes = 256 << 10;
+  ThreadPool* thread_pool =
+      context->device()->tensorflow_cpu_worker_threads()->workers;
+  const int64 num_threads = thread_pool->NumThreads() + 1;
+  const int64 size = arr.size();
+  const int64 num_ranges = std::max<int64>(
+      4 * num_threads,
+      (static_cast<int64>(num_bins) * sizeof(T) + kMaxRangeBytes - 1) /
+          kMaxRangeBytes);
+  const int64 bins_per_range = (num_bins + num_ranges - 1) / num_ranges;
+
+  output.device(context->eigen_cpu_device()) = output.constant(T(0));
+  if (size == 0) return Status::OK();
+  const int64 num_chunks = std::min(num_threads, size);
+  const int64 chunk_size = (size + num_chunks - 1) / num_chunks;
+
+  // counts[c * num_ranges + r] is the number of values of chunk c in range r,
+  // and then the position in 'order' of the next one.
+  std::vector<int64> counts(num_chunks * num_ranges, 0);
+  auto for_each_chunk = [&](auto fn) {
+    thread_pool->ParallelFor(
+        num_chunks, chunk_size * 8 /* cost */, [&](int64 begin, int64 end) {
+          for (int64 c = begin; c < end; ++c) {
+            fn(c * chunk_size, std::min(size, (c + 1) * chunk_size),
+               &counts[c * num_ranges]);
+          }
+        });
+  };
+  for_each_chunk([&](int64 start_ind, int64 limit_ind, int64* chunk_counts) {
+    for (int64 i = start_ind; i < limit_ind; ++i) {
+      Tidx value = arr(i);
+      if (value < num_bins) ++chunk_counts[value / bins_per_range];
+    }
+  });
+  std::vector<int64> range_starts(num_ranges + 1);
+  int64 total = 0;
+  for (int64 r = 0; r < num_ranges; ++r) {
+    range_starts[r] = total;
+    for (int64 c = 0; c < num_chunks; ++c) {
+      const int64 count = counts[c * num_ranges + r];
+      counts[c * num_ranges + r] = total;
+      total += count;
+    }
+  }
+  range_starts[num_ranges] = total;
+
+  Tensor order_t;
+  TF_RETURN_IF_ERROR(
+      context->allocate_temp(DT_INT64, TensorShape({total}), &order_t));
+  auto order = order_t.vec<int64>();
+  for_each_chunk([&](int64 start_ind, int64 limit_ind, int64* chunk_next) {
+    for (int64 i = start_ind; i < limit_ind; ++i) {
+      Tidx value = arr(i);
+      if (value < num_bins) order(chunk_next[value / bins_per_range]++) = i;
+    }
+  });
+
+  thread_pool->ParallelFor(
+      num_ranges, std::max<int64>(1, total / num_ranges) * 8 /* cost */,
+      [&](int64 begin, int64 end) {
+        for (int64 j = range_starts[begin]; j < range_starts[end]; ++j) {
+          const int64 i = order(j);
+          update(&output(arr(i)), i);
+        }
+      });
+  return Status::OK();
+}
+
+}  // namespace
+
 template <typename Tidx, typename T>
 struct BincountFunctor<CPUDevice, Tidx, T, true> {
   static Status Compute(OpKernelContext* context,
@@ -51,31 +190,24 @@ struct BincountFunctor<CPUDevice, Tidx, T, true> {
       return errors::InvalidArgument("Input arr must be non-negative!");
     }
 
-    // Allocate partial output bin sums for each worker thread. Worker ids in
-    // ParallelForWithWorkerId range from 0 to NumThreads() inclusive.
-    ThreadPool* thread_pool =
-        context->device()->tensorflow_cpu_worker_threads()->workers;
-    const int64 num_threads = thread_pool->NumThreads() + 1;
+    const int64 num_threads = context->device()
+                                  ->tensorflow_cpu_worker_threads()
+                                  ->workers->NumThreads() +
+                              1;
+    const int64 num_partial = NumPartialBins<bool>(num_threads, num_bins);
+    if (num_partial == 0) {
+      return BincountByBinRange<T, Tidx>(context, arr, output, num_bins,
+                                         [](T* bin, int64 i) { *bin = T(1); });
+    }
     Tensor partial_bins_t;
-    TF_RETURN_IF_ERROR(context->allocate_temp(
-        DT_BOOL, TensorShape({num_threads, num_bins}), &partial_bins_t));
-    auto partial_bins = partial_bins_t.matrix<bool>();
-    partial_bins.setZero();
-    thread_pool->ParallelForWithWorkerId(
-        arr.size(), 8 /* cost */,
-        [&](int64 start_ind, int64 limit_ind, int64 worker_id) {
-          for (int64 i = start_ind; i < limit_ind; i++) {
-            Tidx value = arr(i);
-            if (value < num_bins) {
-              partial_bins(worker_id, value) = true;
-            }
-          }
-        });
+    TF_RETURN_IF_ERROR(PartialBincount<bool, Tidx>(
+        context, arr, num_bins, num_partial,
+        [](bool* bin, int64 i) { *bin = true; }, &partial_bins_t));
 
     // Sum the partial bins along the 0th axis.
     Eigen::array<int, 1> reduce_dim({0});
     output.device(context->eigen_cpu_device()) =
-        partial_bins.any(reduce_dim).cast<T>();
+        partial_bins_t.matrix<bool>().any(reduce_dim).cast<T>();
     return Status::OK();
   }
 };
@@ -96,36 +228,32 @@ struct BincountFunctor<CPUDevice, Tidx, T, false> {
       return errors::InvalidArgument("Input arr must be non-negative!");
     }
 
-    // Allocate partial output bin sums for each worker thread. Worker ids in
-    // ParallelForWithWorkerId range from 0 to NumThreads() inclusive.
-    ThreadPool* thread_pool =
-        context->device()->tensorflow_cpu_worker_threads()->workers;
-    const int64 num_threads = thread_pool->NumThreads() + 1;
+    const bool has_weights = weights.size();
+    auto update = [&weights, has_weights](T* bin, int64 i) {
+      if (has_weights) {
+        *bin += weights(i);
+      } else {
+        // Complex numbers don't support "++".
+        *bin += T(1);
+      }
+    };
+    const int64 num_threads = context->device()
+                                  ->tensorflow_cpu_worker_threads()
+                                  ->workers->NumThreads() +
+                              1;
+    const int64 num_partial = NumPartialBins<T>(num_threads, num_bins);
+    if (num_partial == 0) {
+      return BincountByBinRange<T, Tidx>(context, arr, output, num_bins,
+                                         update);
+    }
     Tensor partial_bins_t;
-    TF_RETURN_IF_ERROR(context->allocate_temp(
-        DataTypeToEnum<T>::value, TensorShape({num_threads, num_bins}),
-        &partial_bins_t));
-    auto partial_bins = partial_bins_t.matrix<T>();
-    partial_bins.setZero();
-    thread_pool->ParallelForWithWorkerId(
-        arr.size(), 8 /* cost */,
-        [&](int64 start_ind, int64 limit_ind, int64 worker_id) {
-          for (int64 i = start_ind; i < limit_ind; i++) {
-            Tidx value = arr(i);
-            if (value < num_bins) {
-              if (weights.size()) {
-                partial_bins(worker_id, value) += weights(i);
-              } else {
-                // Complex numbers don't support "++".
-                partial_bins(worker_id, value) += T(1);
-              }
-            }
-          }
-        });
+    TF_RETURN_IF_ERROR(PartialBincount<T, Tidx>(
+        context, arr, num_bins, num_partial, update, &partial_bins_t));
 
     // Sum the partial bins along the 0th axis.
     Eigen::array<int, 1> reduce_dim({0});
-    output.device(context->eigen_cpu_device()) = partial_bins.sum(reduce_dim);
+    output.device(context->eigen_cpu_device()) =
+        partial_bins_t.matrix<T>().sum(reduce_dim);
     return Status::OK();
   }
 };
@@ -418,7 +546,6 @@ class RaggedBincountOp : public OpKernel {
 
     int num_rows = splits.size() - 1;
     int num_values = values.size();
-    int batch_idx = 0;
 
     OP_REQUIRES(ctx, splits(0) == 0,
                 errors::InvalidArgument("Splits must start with 0, not with ",
@@ -429,29 +556,45 @@ class RaggedBincountOp : public OpKernel {
                     "Splits must end with the number of values, got ",
                     splits(num_rows), " instead of ", num_values));
 
+    for (int row = 0; row < num_rows; ++row) {
+      OP_REQUIRES(ctx, splits(row) <= splits(row + 1),
+                  errors::InvalidArgument(
+                      "Splits must be non-decreasing, got ", splits(row),
+                      " followed by ", splits(row + 1)));
+    }
+    for (int idx = 0; idx < num_values; ++idx) {
+      OP_REQUIRES(ctx, values(idx) >= 0,
+                  errors::InvalidArgument("Input must be non-negative"));
+    }
+
     Tensor* out_t;
     OP_REQUIRES_OK(
         ctx, ctx->allocate_output(0, TensorShape({num_rows, size}), &out_t));
     functor::SetZeroFunctor<Device, T> fill;
     fill(ctx->eigen_device<Device>(), out_t->flat<T>());
-    const auto out = out_t->matrix<T>();
-
-    for (int idx = 0; idx < num_values; ++idx) {
-      while (idx >= splits(batch_idx)) {
-        batch_idx++;
-      }
-      Tidx bin = values(idx);
-      OP_REQUIRES(ctx, bin >= 0,
-                  errors::InvalidArgument("Input must be non-negative"));
-      if (bin < size) {
-        if (binary_output_) {
-          out(batch_idx - 1, bin) = T(1);
-        } else {
-          T value = (weights_size > 0) ? weights(idx) : T(1);
-          out(batch_idx - 1, bin) += value;
+    auto out = out_t->matrix<T>();
+
+    // Each row of the output is only updated by the values of its split.
+    const bool binary_output = binary_output_;
+    auto count_rows = [&](int64 begin, int64 end) {
+      for (int64 row = begin; row < end; ++row) {
+        for (int64 idx = splits(row); idx < splits(row + 1); ++idx) {
+          Tidx bin = values(idx);
+          if (bin < size) {
+            if (binary_output) {
+              out(row, bin) = T(1);
+            } else {
+              T value = (weights_size > 0) ? weights(idx) : T(1);
+              out(row, bin) += value;
+            }
+          }
         }
       }
-    }
+    };
+    const int64 cost_per_row =
+        std::max<int64>(1, num_values / std::max(num_rows, 1)) * 8;
+    ctx->device()->tensorflow_cpu_worker_threads()->workers->ParallelFor(
+        num_rows, cost_per_row, count_rows);
   }
 
  private:
@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/boosted_trees/boosted_trees.pb.h"
 #include "tensorflow/core/kernels/boosted_trees/tree_helper.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -1277,16 +1278,24 @@ class BoostedTreesMakeStatsSummaryOp : public OpKernel {
     auto temp_stats_double = temp_stats_double_t.tensor<double, 4>();
     temp_stats_double.setZero();
 
-    // Partition by node, and then bucketize.
-    for (int feature_idx = 0; feature_idx < num_features_; ++feature_idx) {
-      const auto& features = bucketized_features_list[feature_idx].vec<int32>();
-      for (int i = 0; i < batch_size; ++i) {
-        const int32 node = node_ids(i);
-        const int32 bucket = features(i);
-        temp_stats_double(feature_idx, node, bucket, 0) += gradients(i, 0);
-        temp_stats_double(feature_idx, node, bucket, 1) += hessians(i, 0);
+    // Partition by node, and then bucketize. Each feature accumulates into
+    // its own slice of the stats, so features are processed in parallel.
+    auto accumulate_features = [&](int64 begin, int64 end) {
+      for (int64 feature_idx = begin; feature_idx < end; ++feature_idx) {
+        const auto& features =
+            bucketized_features_list[feature_idx].vec<int32>();
+        for (int i = 0; i < batch_size; ++i) {
+          const int32 node = node_ids(i);
+          const int32 bucket = features(i);
+          temp_stats_double(feature_idx, node, bucket, 0) += gradients(i, 0);
+          temp_stats_double(feature_idx, node, bucket, 1) += hessians(i, 0);
+        }
       }
-    }
+    };
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, num_features_,
+          /*cost_per_unit=*/10 * batch_size, accumulate_features);
 
     // Copy temp tensor over to output tensor.
     Tensor* output_stats_summary_t = nullptr;
@@ -1354,22 +1363,31 @@ class BoostedTreesAggregateStatsOp : public OpKernel {
     auto temp_stats_double = temp_stats_double_t.tensor<double, 4>();
     temp_stats_double.setZero();
 
-    for (int i = 0; i < batch_size; ++i) {
-      const int32 node = node_ids(i);
-      for (int feature_dim = 0; feature_dim < feature_dims; ++feature_dim) {
-        const int32 feature_value = feature(i, feature_dim);
-        const int32 bucket =
-            (feature_value == -1) ? num_buckets_ : feature_value;
-        for (int stat_dim = 0; stat_dim < logits_dims; ++stat_dim) {
-          temp_stats_double(node, feature_dim, bucket, stat_dim) +=
-              gradients(i, stat_dim);
-        }
-        for (int stat_dim = logits_dims; stat_dim < stats_dims; ++stat_dim) {
-          temp_stats_double(node, feature_dim, bucket, stat_dim) +=
-              hessians(i, stat_dim - logits_dims);
+    // Each feature dimension accumulates into its own slice of the stats, so
+    // feature dimensions are processed in parallel.
+    auto accumulate_feature_dims = [&](int64 begin, int64 end) {
+      for (int i = 0; i < batch_size; ++i) {
+        const int32 node = node_ids(i);
+        for (int64 feature_dim = begin; feature_dim < end; ++feature_dim) {
+          const int32 feature_value = feature(i, feature_dim);
+          const int32 bucket =
+              (feature_value == -1) ? num_buckets_ : feature_value;
+          for (int stat_dim = 0; stat_dim < logits_dims; ++stat_dim) {
+            temp_stats_double(node, feature_dim, bucket, stat_dim) +=
+                gradients(i, stat_dim);
+          }
+          for (int stat_dim = logits_dims; stat_dim < stats_dims; ++stat_dim) {
+            temp_stats_double(node, feature_dim, bucket, stat_dim) +=
+                hessians(i, stat_dim - logits_dims);
+          }
         }
       }
-    }
+    };
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, feature_dims,
+          /*cost_per_unit=*/10 * batch_size * stats_dims,
+          accumulate_feature_dims);
 
     // Copy temp tensor over to output tensor, downcasting to float.
     Tensor* output_stats_summary_t = nullptr;
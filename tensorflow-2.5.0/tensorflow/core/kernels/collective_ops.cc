@@ -12,6 +12,8 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <cstring>
+
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/collective.h"
 #include "tensorflow/core/framework/node_def.pb.h"
@@ -50,10 +52,26 @@ static std::unique_ptr<OpKernel> BuildOpKernel(OpKernelConstruction* c,
   return k;
 }
 
-class CollectiveOpV1Kernel : public AsyncOpKernel {
+// Base of the collective kernels, which only hand their work off to the
+// collective executor's work queue and so are cheap to launch.  Marking them
+// inexpensive lets the executor run them inline as soon as their inputs are
+// ready instead of queueing them in the inter-op thread pool behind compute
+// kernels, so that e.g. gradient all-reduces start while the rest of the
+// backward pass runs.  Kernels on GPU are already treated this way.
+class CollectiveAsyncOpKernel : public AsyncOpKernel {
+ public:
+  explicit CollectiveAsyncOpKernel(OpKernelConstruction* c)
+      : AsyncOpKernel(c) {}
+
+  bool IsExpensive() override { return false; }
+};
+
+class CollectiveOpV1Kernel : public CollectiveAsyncOpKernel {
  public:
   explicit CollectiveOpV1Kernel(OpKernelConstruction* c)
-      : AsyncOpKernel(c), name_(name()), col_params_(new CollectiveParams()) {}
+      : CollectiveAsyncOpKernel(c),
+        name_(name()),
+        col_params_(new CollectiveParams()) {}
 
   ~CollectiveOpV1Kernel() override { col_params_->Unref(); }
 
@@ -463,10 +481,10 @@ REGISTER_KERNEL_BUILDER(Name("CollectiveBcastRecv").Device(DEVICE_CPU),
 REGISTER_KERNEL_BUILDER(Name("CollectiveBcastRecv").Device(DEVICE_GPU),
                         CollectiveBcastRecvOpKernel);
 
-class CollectiveReduceV2OpKernel : public AsyncOpKernel {
+class CollectiveReduceV2OpKernel : public CollectiveAsyncOpKernel {
  public:
   explicit CollectiveReduceV2OpKernel(OpKernelConstruction* c)
-      : AsyncOpKernel(c), device_type_(DEVICE_DEFAULT) {
+      : CollectiveAsyncOpKernel(c), device_type_(DEVICE_DEFAULT) {
     OP_REQUIRES_OK(c, c->GetAttr("T", &data_type_));
     string merge_op_name;
     OP_REQUIRES_OK(c, c->GetAttr("merge_op", &merge_op_name));
@@ -480,6 +498,13 @@ class CollectiveReduceV2OpKernel : public AsyncOpKernel {
     OP_REQUIRES_OK(c, c->GetAttr("final_op", &final_op_name));
     OP_REQUIRES_OK(c, c->GetAttr("communication_hint", &communication_hint_));
     OP_REQUIRES_OK(c, c->GetAttr("timeout_seconds", &timeout_seconds_));
+    string compression;
+    OP_REQUIRES_OK(c, c->GetAttr("compression", &compression));
+    if (compression == "fp16") {
+      wire_data_type_ = DT_HALF;
+    } else if (compression == "bf16") {
+      wire_data_type_ = DT_BFLOAT16;
+    }
     // Prepare OpKernels for reduction and final operations.
     // The merge_op takes two inputs
     NodeDef sub_node;
@@ -498,26 +523,47 @@ class CollectiveReduceV2OpKernel : public AsyncOpKernel {
   }
 
   void ComputeAsync(OpKernelContext* c, DoneCallback done) override {
-    CollectiveExecutor* col_exec = c->collective_executor();
-    OP_REQUIRES_ASYNC(
-        c, col_exec,
-        errors::Internal(
-            "Failed to get CollectiveExecutor from OpKernelContext for Op ",
-            name_),
-        done);
+    CollectiveParams* col_params = nullptr;
+    OP_REQUIRES_OK_ASYNC(c, MakeParams(c, /*first_key_input=*/1, &col_params),
+                         done);
     const Tensor& input = c->input(0);
-    const Tensor& group_size = c->input(1);
-    const Tensor& group_key = c->input(2);
-    const Tensor& instance_key = c->input(3);
-    OP_REQUIRES_ASYNC(
-        c, group_size.dims() == 0,
-        errors::Internal("Unexpected dimensions on input group_size"), done);
-    OP_REQUIRES_ASYNC(
-        c, group_key.dims() == 0,
-        errors::Internal("Unexpected dimensions on input group_key"), done);
-    OP_REQUIRES_ASYNC(
-        c, instance_key.dims() == 0,
-        errors::Internal("Unexpected dimensions on input instance_key"), done);
+    auto done_with_cleanup = [col_params, done = std::move(done)]() {
+      done();
+      col_params->Unref();
+    };
+
+    // Allocate the output tensor, trying to reuse the input.
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK_ASYNC(
+        c, c->forward_input_or_allocate_output({0}, 0, input.shape(), &output),
+        done_with_cleanup);
+    col_params->instance.shape = input.shape();
+    Run(c, col_params, &input, output, std::move(done_with_cleanup));
+  }
+
+ protected:
+  // Creates the params of the reduction from the attributes and the scalar
+  // group_size, group_key and instance_key inputs, which start at index
+  // `first_key_input`.  The caller owns a reference to the params.
+  Status MakeParams(OpKernelContext* c, int first_key_input,
+                    CollectiveParams** params) {
+    if (c->collective_executor() == nullptr) {
+      return errors::Internal(
+          "Failed to get CollectiveExecutor from OpKernelContext for Op ",
+          name_);
+    }
+    const Tensor& group_size = c->input(first_key_input);
+    const Tensor& group_key = c->input(first_key_input + 1);
+    const Tensor& instance_key = c->input(first_key_input + 2);
+    if (group_size.dims() != 0) {
+      return errors::Internal("Unexpected dimensions on input group_size");
+    }
+    if (group_key.dims() != 0) {
+      return errors::Internal("Unexpected dimensions on input group_key");
+    }
+    if (instance_key.dims() != 0) {
+      return errors::Internal("Unexpected dimensions on input instance_key");
+    }
 
     auto col_params = new CollectiveParams();
     col_params->name = name_;
@@ -529,6 +575,7 @@ class CollectiveReduceV2OpKernel : public AsyncOpKernel {
     col_params->instance.data_type = data_type_;
     col_params->instance.impl_details.communication_hint = communication_hint_;
     col_params->instance.impl_details.timeout_seconds = timeout_seconds_;
+    col_params->instance.impl_details.wire_data_type = wire_data_type_;
     // Add a default value for subdiv offsets, which is the same as the default
     // value in the V1 op's attribute.
     col_params->instance.impl_details.subdiv_offsets.push_back(0);
@@ -537,32 +584,29 @@ class CollectiveReduceV2OpKernel : public AsyncOpKernel {
     VLOG(1) << "CollectiveReduceV2 group_size " << col_params->group.group_size
             << " group_key " << col_params->group.group_key << " instance_key "
             << col_params->instance.instance_key;
+    *params = col_params;
+    return Status::OK();
+  }
 
-    auto done_with_cleanup = [col_params, done = std::move(done)]() {
-      done();
-      col_params->Unref();
-    };
-
-    // Allocate the output tensor, trying to reuse the input.
-    Tensor* output = nullptr;
-    OP_REQUIRES_OK_ASYNC(
-        c, c->forward_input_or_allocate_output({0}, 0, input.shape(), &output),
-        done_with_cleanup);
-    col_params->instance.shape = input.shape();
-
+  // Resolves `col_params`, whose shape must be set, and reduces `input` into
+  // `output`.  `done` is called when the reduction completes, with any error
+  // set on `c`.
+  void Run(OpKernelContext* c, CollectiveParams* col_params,
+           const Tensor* input, Tensor* output, DoneCallback done) {
+    CollectiveExecutor* col_exec = c->collective_executor();
     // Resolve the collective params.
     // Schedule the `CompleteParamsAsync` call on a work queue that can handle
     // blocking work because it's not guaranteed that this call cannot block.
-    c->collective_executor()->RunClosure([c,
-                                          done = std::move(done_with_cleanup),
-                                          col_params, col_exec]() {
+    col_exec->RunClosure([c, done = std::move(done), col_params, col_exec,
+                          input, output]() {
       VLOG(1) << "CollectiveReduceV2 CompleteParams for collective "
               << col_params->name << " device " << c->device()->name()
               << " group " << col_params->group.group_key << " instance "
               << col_params->instance.instance_key;
       col_exec->CompleteParamsAsync(
           c->device()->attributes(), col_params, c->cancellation_manager(),
-          [c, done = std::move(done), col_params, col_exec](const Status& s) {
+          [c, done = std::move(done), col_params, col_exec, input,
+           output](const Status& s) {
             if (s.ok()) {
               auto actual_done = [c, group_key = col_params->group.group_key,
                                   instance_key =
@@ -585,7 +629,7 @@ class CollectiveReduceV2OpKernel : public AsyncOpKernel {
                   c, col_params,
                   CollectiveKey(c, col_params->group.group_key,
                                 col_params->instance.instance_key),
-                  actual_done);
+                  input, output, actual_done);
             } else {
               c->SetStatus(s);
               done();
@@ -599,6 +643,7 @@ class CollectiveReduceV2OpKernel : public AsyncOpKernel {
   DataType data_type_ = DT_INVALID;
   string communication_hint_;
   float timeout_seconds_ = 0;
+  DataType wire_data_type_ = DT_INVALID;
   DeviceType device_type_;
   std::unique_ptr<OpKernel> merge_op_;
   std::unique_ptr<OpKernel> final_op_;
@@ -613,10 +658,79 @@ REGISTER_KERNEL_BUILDER(Name("CollectiveReduceV2")
                             .HostMemory("instance_key"),
                         CollectiveReduceV2OpKernel);
 
-class CollectiveGatherV2OpKernel : public AsyncOpKernel {
+// Reduces a list of tensors with a single collective, which saves the param
+// resolution and the per-collective overhead of one CollectiveReduceV2 per
+// tensor, e.g. for many small gradients.  The inputs are packed into one
+// contiguous buffer that is reduced in place and unpacked into the outputs.
+class CollectiveBatchReduceV2OpKernel : public CollectiveReduceV2OpKernel {
+ public:
+  explicit CollectiveBatchReduceV2OpKernel(OpKernelConstruction* c)
+      : CollectiveReduceV2OpKernel(c) {
+    OP_REQUIRES_OK(c, c->GetAttr("N", &num_tensors_));
+  }
+
+  void ComputeAsync(OpKernelContext* c, DoneCallback done) override {
+    CollectiveParams* col_params = nullptr;
+    OP_REQUIRES_OK_ASYNC(
+        c, MakeParams(c, /*first_key_input=*/num_tensors_, &col_params), done);
+    auto buffer = new Tensor();
+    auto done_with_cleanup = [col_params, buffer, done = std::move(done)]() {
+      done();
+      delete buffer;
+      col_params->Unref();
+    };
+
+    const DataType dtype = c->input(0).dtype();
+    const int64 element_size = DataTypeSize(dtype);
+    int64 num_elements = 0;
+    for (int i = 0; i < num_tensors_; ++i) {
+      num_elements += c->input(i).NumElements();
+    }
+    OP_REQUIRES_OK_ASYNC(
+        c, c->allocate_temp(dtype, TensorShape({num_elements}), buffer),
+        done_with_cleanup);
+    char* data = const_cast<char*>(buffer->tensor_data().data());
+    for (int i = 0; i < num_tensors_; ++i) {
+      const StringPiece input = c->input(i).tensor_data();
+      std::memcpy(data, input.data(), input.size());
+      data += input.size();
+    }
+    col_params->instance.shape = buffer->shape();
+
+    auto unpack_done = [this, c, buffer, element_size,
+                        done = std::move(done_with_cleanup)]() {
+      if (!c->status().ok()) {
+        done();
+        return;
+      }
+      const char* data = buffer->tensor_data().data();
+      for (int i = 0; i < num_tensors_; ++i) {
+        const TensorShape& shape = c->input(i).shape();
+        Tensor* output = nullptr;
+        OP_REQUIRES_OK_ASYNC(
+            c, c->forward_input_or_allocate_output({i}, i, shape, &output),
+            done);
+        const int64 size = shape.num_elements() * element_size;
+        std::memcpy(const_cast<char*>(output->tensor_data().data()), data,
+                    size);
+        data += size;
+      }
+      done();
+    };
+    Run(c, col_params, buffer, buffer, std::move(unpack_done));
+  }
+
+ private:
+  int num_tensors_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("CollectiveBatchReduceV2").Device(DEVICE_CPU),
+                        CollectiveBatchReduceV2OpKernel);
+
+class CollectiveGatherV2OpKernel : public CollectiveAsyncOpKernel {
  public:
   explicit CollectiveGatherV2OpKernel(OpKernelConstruction* c)
-      : AsyncOpKernel(c), device_type_(DEVICE_DEFAULT) {
+      : CollectiveAsyncOpKernel(c), device_type_(DEVICE_DEFAULT) {
     OP_REQUIRES_OK(c, c->GetAttr("T", &data_type_));
     OP_REQUIRES_OK(c, c->GetAttr("communication_hint", &communication_hint_));
     OP_REQUIRES_OK(c, c->GetAttr("timeout_seconds", &timeout_seconds_));
@@ -748,10 +862,10 @@ REGISTER_KERNEL_BUILDER(Name("CollectiveGatherV2")
                             .HostMemory("instance_key"),
                         CollectiveGatherV2OpKernel);
 
-class CollectiveBcastSendV2OpKernel : public AsyncOpKernel {
+class CollectiveBcastSendV2OpKernel : public CollectiveAsyncOpKernel {
  public:
   explicit CollectiveBcastSendV2OpKernel(OpKernelConstruction* c)
-      : AsyncOpKernel(c), device_type_(DEVICE_DEFAULT) {
+      : CollectiveAsyncOpKernel(c), device_type_(DEVICE_DEFAULT) {
     OP_REQUIRES_OK(c, c->GetAttr("T", &data_type_));
     OP_REQUIRES_OK(c, c->GetAttr("communication_hint", &communication_hint_));
     OP_REQUIRES_OK(c, c->GetAttr("timeout_seconds", &timeout_seconds_));
@@ -874,10 +988,10 @@ REGISTER_KERNEL_BUILDER(Name("CollectiveBcastSendV2")
                             .HostMemory("instance_key"),
                         CollectiveBcastSendV2OpKernel);
 
-class CollectiveBcastRecvV2OpKernel : public AsyncOpKernel {
+class CollectiveBcastRecvV2OpKernel : public CollectiveAsyncOpKernel {
  public:
   explicit CollectiveBcastRecvV2OpKernel(OpKernelConstruction* c)
-      : AsyncOpKernel(c), device_type_(DEVICE_DEFAULT) {
+      : CollectiveAsyncOpKernel(c), device_type_(DEVICE_DEFAULT) {
     OP_REQUIRES_OK(c, c->GetAttr("T", &data_type_));
     OP_REQUIRES_OK(c, c->GetAttr("communication_hint", &communication_hint_));
     OP_REQUIRES_OK(c, c->GetAttr("timeout_seconds", &timeout_seconds_));
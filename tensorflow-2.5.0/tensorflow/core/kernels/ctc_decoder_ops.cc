@@ -17,6 +17,7 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
 #include <limits>
 
 #include "tensorflow/core/framework/op.h"
@@ -316,42 +317,48 @@ class CTCBeamSearchDecoderOp : public OpKernel {
 
     log_prob_t.setZero();
 
-    std::vector<typename TTypes<T>::UnalignedConstMatrix> input_list_t;
-
-    input_list_t.reserve(max_time);
-    for (std::size_t t = 0; t < max_time; ++t) {
-      input_list_t.emplace_back(inputs_t.data() + t * batch_size * num_classes,
-                                batch_size, num_classes);
-    }
-
-    ctc::CTCBeamSearchDecoder<T> beam_search(num_classes, beam_width_,
-                                             &beam_scorer_, 1 /* batch_size */,
-                                             merge_repeated_);
-    Tensor input_chip(DataTypeToEnum<T>::v(), TensorShape({num_classes}));
-    auto input_chip_t = input_chip.flat<T>();
-
     std::vector<std::vector<std::vector<int> > > best_paths(batch_size);
-    std::vector<T> log_probs;
+    std::vector<Status> statuses(batch_size);
 
+    // Batch entries are decoded independently, so each shard runs its own
+    // decoder over a contiguous range of the batch. The scorer is stateless.
     // Assumption: the blank index is num_classes - 1
-    for (int b = 0; b < batch_size; ++b) {
-      auto& best_paths_b = best_paths[b];
-      best_paths_b.resize(decode_helper_.GetTopPaths());
-      for (int t = 0; t < seq_len_t(b); ++t) {
-        input_chip_t = input_list_t[t].chip(b, 0);
-        auto input_bi = Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, 1>>(
-            input_chip_t.data(), num_classes);
-        beam_search.Step(input_bi);
+    auto decode = [&](const int64 begin, const int64 end) {
+      ctc::CTCBeamSearchDecoder<T> beam_search(
+          num_classes, beam_width_, &beam_scorer_, 1 /* batch_size */,
+          merge_repeated_);
+      std::vector<T> log_probs;
+      for (int64 b = begin; b < end; ++b) {
+        auto& best_paths_b = best_paths[b];
+        best_paths_b.resize(decode_helper_.GetTopPaths());
+        for (int t = 0; t < seq_len_t(b); ++t) {
+          // inputs is [max_time, batch_size, num_classes], so the logits for
+          // (t, b) are contiguous and can be read in place.
+          auto input_bi = Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, 1>>(
+              inputs_t.data() + (t * batch_size + b) * num_classes,
+              num_classes);
+          beam_search.Step(input_bi);
+        }
+        statuses[b] = beam_search.TopPaths(decode_helper_.GetTopPaths(),
+                                           &best_paths_b, &log_probs,
+                                           merge_repeated_);
+        beam_search.Reset();
+        if (!statuses[b].ok()) continue;
+
+        for (int bp = 0; bp < decode_helper_.GetTopPaths(); ++bp) {
+          log_prob_t(b, bp) = log_probs[bp];
+        }
       }
-      OP_REQUIRES_OK(
-          ctx, beam_search.TopPaths(decode_helper_.GetTopPaths(), &best_paths_b,
-                                    &log_probs, merge_repeated_));
-
-      beam_search.Reset();
+    };
 
-      for (int bp = 0; bp < decode_helper_.GetTopPaths(); ++bp) {
-        log_prob_t(b, bp) = log_probs[bp];
-      }
+    const int64 kCostPerUnit =
+        50 * max_time * num_classes * std::max(beam_width_, 1);
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, batch_size,
+          kCostPerUnit, decode);
+    for (const Status& s : statuses) {
+      OP_REQUIRES_OK(ctx, s);
     }
 
     OP_REQUIRES_OK(ctx, decode_helper_.StoreAllDecodedSequences(
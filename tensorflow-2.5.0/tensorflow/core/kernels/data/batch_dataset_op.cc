@@ -148,7 +148,9 @@ class BatchDatasetOp::Dataset : public DatasetBase {
   class Iterator : public DatasetIterator<Dataset> {
    public:
     explicit Iterator(const Params& params)
-        : DatasetIterator<Dataset>(params) {}
+        : DatasetIterator<Dataset>(params),
+          slab_pool_(
+              /*max_slabs=*/2 * params.dataset->output_dtypes().size()) {}
 
     Status Initialize(IteratorContext* ctx) override {
       return dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_);
@@ -157,51 +159,44 @@ class BatchDatasetOp::Dataset : public DatasetBase {
     Status GetNextInternal(IteratorContext* ctx,
                            std::vector<Tensor>* out_tensors,
                            bool* end_of_sequence) override {
-      // Each row of `batch_elements` is a tuple of tensors from the
-      // input iterator.
-      std::vector<std::vector<Tensor>> batch_elements;
+      if (dataset()->parallel_copy_) {
+        return GetNextParallelCopy(ctx, out_tensors, end_of_sequence);
+      }
+      // Copy each input element into its row of the output batch as soon as
+      // it is produced, so that the element can be released before the next
+      // one is computed.
+      BatchBuilder batch(dataset()->batch_size_, &slab_pool_);
       {
         mutex_lock l(mu_);
         if (!input_impl_) {
           *end_of_sequence = true;
           return Status::OK();
         }
-        batch_elements.reserve(dataset()->reserve_size_);
         *end_of_sequence = false;
         for (int i = 0; i < dataset()->batch_size_ && !*end_of_sequence; ++i) {
           std::vector<Tensor> batch_element_tuple;
           TF_RETURN_IF_ERROR(
               input_impl_->GetNext(ctx, &batch_element_tuple, end_of_sequence));
           if (!*end_of_sequence) {
-            batch_elements.emplace_back(std::move(batch_element_tuple));
+            TF_RETURN_IF_ERROR(batch.Add(ctx, &batch_element_tuple));
           } else {
             input_impl_.reset();
           }
         }
       }
 
-      if (batch_elements.empty()) {
+      if (batch.num_elements() == 0) {
         DCHECK(*end_of_sequence);
         return Status::OK();
       }
 
       if (dataset()->drop_remainder_ &&
-          batch_elements.size() < dataset()->batch_size_) {
+          batch.num_elements() < dataset()->batch_size_) {
         *end_of_sequence = true;
         return Status::OK();
       }
 
-      // Copy the retrieved batch elements into one output tensor per tuple
-      // component.
-      //
-      // NOTE(mrry): If the input or output sizes are statically known, we
-      // could potentially read the input values in-place into their
-      // respective slice locations. This would require a different GetNext()
-      // overload that supports zero-copy, and might make sense in an
-      // optimization pass.
-      TF_RETURN_IF_ERROR(CopyBatch(/*parallel_copy=*/dataset()->parallel_copy_,
-                                   ctx, out_tensors, &batch_elements));
-
+      batch.Finish(out_tensors);
       *end_of_sequence = false;
       return Status::OK();
     }
@@ -239,7 +234,56 @@ class BatchDatasetOp::Dataset : public DatasetBase {
     }
 
    private:
+    // Gathers a whole batch of input elements and then copies them into the
+    // output batch in parallel.
+    Status GetNextParallelCopy(IteratorContext* ctx,
+                               std::vector<Tensor>* out_tensors,
+                               bool* end_of_sequence) {
+      // Each row of `batch_elements` is a tuple of tensors from the
+      // input iterator.
+      std::vector<std::vector<Tensor>> batch_elements;
+      {
+        mutex_lock l(mu_);
+        if (!input_impl_) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+        batch_elements.reserve(dataset()->reserve_size_);
+        *end_of_sequence = false;
+        for (int i = 0; i < dataset()->batch_size_ && !*end_of_sequence; ++i) {
+          std::vector<Tensor> batch_element_tuple;
+          TF_RETURN_IF_ERROR(
+              input_impl_->GetNext(ctx, &batch_element_tuple, end_of_sequence));
+          if (!*end_of_sequence) {
+            batch_elements.emplace_back(std::move(batch_element_tuple));
+          } else {
+            input_impl_.reset();
+          }
+        }
+      }
+
+      if (batch_elements.empty()) {
+        DCHECK(*end_of_sequence);
+        return Status::OK();
+      }
+
+      if (dataset()->drop_remainder_ &&
+          batch_elements.size() < dataset()->batch_size_) {
+        *end_of_sequence = true;
+        return Status::OK();
+      }
+
+      TF_RETURN_IF_ERROR(CopyBatch(/*parallel_copy=*/true, ctx, out_tensors,
+                                   &batch_elements, &slab_pool_));
+      *end_of_sequence = false;
+      return Status::OK();
+    }
+
     mutex mu_;
+    // Output batches are allocated from this pool, which holds enough slabs
+    // for two batches so that one batch can be filled while the consumer still
+    // holds the previous one.
+    BatchSlabPool slab_pool_;
     std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
   };
 
@@ -283,6 +283,31 @@ IteratorSaveAndRestoreTestCases() {
 ITERATOR_SAVE_AND_RESTORE_TEST_P(BatchDatasetOpTest, BatchDatasetParams,
                                  IteratorSaveAndRestoreTestCases())
 
+// Output batches are allocated from a pool of reused slabs, so a batch which
+// the consumer still holds must not be handed out again.
+TEST_F(BatchDatasetOpTest, HeldBatchIsNotOverwritten) {
+  for (auto batch_dataset_params :
+       {BatchDatasetParams1(), BatchDatasetParams2()}) {
+    TF_ASSERT_OK(Initialize(batch_dataset_params));
+    std::vector<Tensor> held;
+    bool end_of_sequence = false;
+    TF_ASSERT_OK(
+        iterator_->GetNext(iterator_ctx_.get(), &held, &end_of_sequence));
+    ASSERT_FALSE(end_of_sequence);
+    for (int i = 0; i < 2; ++i) {
+      std::vector<Tensor> next;
+      TF_ASSERT_OK(
+          iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+      ASSERT_FALSE(end_of_sequence);
+      ASSERT_EQ(next.size(), 1);
+      EXPECT_FALSE(next[0].SharesBufferWith(held[0]));
+    }
+    ASSERT_EQ(held.size(), 1);
+    test::ExpectTensorEqual<int64>(
+        held[0], CreateTensor<int64>(TensorShape({4}), {0, 1, 2, 3}));
+  }
+}
+
 TEST_F(BatchDatasetOpTest, InvalidBatchSize) {
   auto batch_dataset_params = InvalidBatchSizeBatchDatasetParams();
   EXPECT_EQ(Initialize(batch_dataset_params).code(),
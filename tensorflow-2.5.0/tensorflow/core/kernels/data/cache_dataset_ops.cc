@@ -14,16 +14,20 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/cache_dataset_ops.h"
 
+#include <atomic>
+
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/cache_ops.h"
 #include "tensorflow/core/kernels/data/dataset_utils.h"
+#include "tensorflow/core/kernels/data/mapped_cache.h"
 #include "tensorflow/core/kernels/data/name_utils.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
 namespace tensorflow {
@@ -48,6 +52,7 @@ constexpr char kLockFileSuffix[] = ".lockfile";
 constexpr char kIterationCompleted[] = "iteration_completed";
 constexpr char kCurIndex[] = "cur_index";
 constexpr char kShardId[] = "shard_id";
+constexpr char kMappedFormat[] = "mapped_format";
 constexpr char kCreatedAt[] = "Created at";
 constexpr char kMemoryDatasetPrefix[] = "Memory";
 constexpr char kMemoryCache[] = "MemoryCache";
@@ -65,6 +70,20 @@ constexpr char kIncompleteCacheErrorMessage[] =
     "contents of the dataset  will be discarded. This can happen if you have "
     "an input pipeline similar to `dataset.cache().take(k).repeat()`. You "
     "should use `dataset.take(k).cache().repeat()` instead.";
+// When set to true, new file caches are written in the format described in
+// mapped_cache.h instead of as a tensor bundle. Existing caches are read in
+// whichever format they were written.
+constexpr char kMappedCacheFormatEnvVar[] = "TF_DATA_MAPPED_FILE_CACHE";
+
+bool UseMappedCacheFormat() {
+  bool use_mapped_format = false;
+  Status s = ReadBoolFromEnvVar(kMappedCacheFormatEnvVar,
+                                /*default_val=*/false, &use_mapped_format);
+  if (!s.ok()) {
+    LOG(WARNING) << s;
+  }
+  return use_mapped_format;
+}
 
 }  // namespace
 
@@ -81,7 +100,8 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         item_index_padding_size_(StringPaddingSize(kMaxItems)),
         tensor_format_string_(strings::Printf(kKeyStrFormat,
                                               item_index_padding_size_,
-                                              tensor_index_padding_size_)) {
+                                              tensor_index_padding_size_)),
+        use_mapped_format_(UseMappedCacheFormat()) {
     input_->Ref();
     DCHECK_EQ(item_index_padding_size_, 7);
   }
@@ -135,13 +155,30 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
                            tensor_index);
   }
 
+  // Returns whether the cache has been completely written, in either format.
+  bool CacheCompleted() const {
+    return env_->FileExists(MetaFilename(filename_)).ok() ||
+           env_->FileExists(MappedCacheMetaFilename(filename_)).ok();
+  }
+
+  // Returns the reader shared by all iterators reading a mapped cache.
+  Status GetMappedReader(std::shared_ptr<const MappedCacheReader>* out) const {
+    mutex_lock l(mapped_reader_mu_);
+    if (!mapped_reader_) {
+      std::unique_ptr<MappedCacheReader> reader;
+      TF_RETURN_IF_ERROR(
+          MappedCacheReader::Open(env_, filename_, num_tensors_, &reader));
+      mapped_reader_ = std::move(reader);
+    }
+    *out = mapped_reader_;
+    return Status::OK();
+  }
+
   class FileIterator : public DatasetIterator<FileDatasetBase> {
    public:
     explicit FileIterator(const Params& params)
         : DatasetIterator<FileDatasetBase>(params) {
-      if (params.dataset->env_
-              ->FileExists(MetaFilename(params.dataset->filename_))
-              .ok()) {
+      if (params.dataset->CacheCompleted()) {
         mode_ = Mode::read;
       } else {
         mode_ = Mode::write;
@@ -156,7 +193,9 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
     Status GetNextInternal(IteratorContext* ctx,
                            std::vector<Tensor>* out_tensors,
                            bool* end_of_sequence) override {
-      mutex_lock l(mu_);
+      // `iterator_` is only replaced by `Initialize` and `RestoreInternal`, and
+      // synchronizes its own state, so concurrent calls can share the lock.
+      tf_shared_lock l(mu_);
       return iterator_->GetNext(ctx, out_tensors, end_of_sequence);
     }
 
@@ -181,10 +220,7 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kMode), &temp));
         mode_ = static_cast<Mode>(temp);
       }
-      if (mode_ == Mode::write &&
-          dataset()
-              ->env_->FileExists(MetaFilename(dataset()->filename_))
-              .ok()) {
+      if (mode_ == Mode::write && dataset()->CacheCompleted()) {
         // This could happen if the cache was completely written after the
         // checkpoint was saved.
         LOG(WARNING)
@@ -226,10 +262,11 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
                 strings::StrCat(params.dataset->filename_, "_", shard_id_)),
             lockfile_(strings::StrCat(filename_, kLockFileSuffix)),
             lockfile_created_(false),
-            iteration_completed_(false) {}
+            iteration_completed_(false),
+            use_mapped_format_(params.dataset->use_mapped_format_) {}
 
       ~FileWriterIterator() override {
-        if (!dataset()->env_->FileExists(MetaFilename(filename_)).ok()) {
+        if (!ShardCompleted(filename_)) {
           LOG(WARNING) << kIncompleteCacheErrorMessage;
           std::vector<string> cache_files;
           Status s = dataset()->env_->GetMatchingPaths(
@@ -262,7 +299,7 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         if (*end_of_sequence) {
           return Status::OK();
         }
-        TF_RETURN_IF_ERROR(writer_->status());
+        TF_RETURN_IF_ERROR(WriterStatus());
         if (cur_index_ >= kMaxItems) {
           // As a courtesy, close the [truncated] cache file.
           Status s = Finish();
@@ -287,11 +324,15 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
               "Expected ",
               dataset()->num_tensors_, " got: ", out_tensors->size());
         }
-        size_t tensor_index = 0;
-        for (const Tensor& t : *out_tensors) {
-          DCHECK_LT(tensor_index, dataset()->num_tensors_);
-          string key = dataset()->FormatName(cur_index_, tensor_index++);
-          TF_RETURN_IF_ERROR(writer_->Add(key, t));
+        if (use_mapped_format_) {
+          TF_RETURN_IF_ERROR(mapped_writer_->Add(*out_tensors));
+        } else {
+          size_t tensor_index = 0;
+          for (const Tensor& t : *out_tensors) {
+            DCHECK_LT(tensor_index, dataset()->num_tensors_);
+            string key = dataset()->FormatName(cur_index_, tensor_index++);
+            TF_RETURN_IF_ERROR(writer_->Add(key, t));
+          }
         }
         if (*end_of_sequence) {
           TF_RETURN_IF_ERROR(Finish());
@@ -312,6 +353,10 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         mutex_lock l(mu_);
         TF_RETURN_IF_ERROR(
             writer->WriteScalar(full_name(kCurIndex), cur_index_));
+        if (use_mapped_format_) {
+          TF_RETURN_IF_ERROR(
+              writer->WriteScalar(full_name(kMappedFormat), ""));
+        }
 
         if (iteration_completed_) {
           TF_RETURN_IF_ERROR(
@@ -325,8 +370,8 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         // about flushing the current shard. This ensures that we never write
         // empty shards.
         if (lockfile_created_) {
-          // Flush the current bundle.
-          TF_RETURN_IF_ERROR(writer_->Finish());
+          // Flush the current shard.
+          TF_RETURN_IF_ERROR(FinishWriter());
 
           // Note: We do not delete the lockfile here. We keep lockfiles of
           // all shards around until the entire cache has been written to
@@ -357,6 +402,10 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
           }
         }
 
+        // Shards of one cache must all be written in the same format, so the
+        // format of the checkpointed shards wins over the current setting.
+        use_mapped_format_ = reader->Contains(full_name(kMappedFormat));
+
         if (reader->Contains(full_name(kIterationCompleted))) {
           iteration_completed_ = true;
           return Status::OK();
@@ -375,11 +424,42 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         }
         filename_ = strings::StrCat(dataset()->filename_, "_", shard_id_);
         lockfile_ = strings::StrCat(filename_, kLockFileSuffix);
-        writer_ = absl::make_unique<BundleWriter>(dataset()->env_, filename_);
+        NewWriter();
         return Status::OK();
       }
 
      private:
+      // Returns whether the shard with prefix `shard_prefix` has been
+      // completely written.
+      bool ShardCompleted(const string& shard_prefix) {
+        return dataset()
+            ->env_
+            ->FileExists(use_mapped_format_
+                             ? MappedCacheIndexFilename(shard_prefix)
+                             : MetaFilename(shard_prefix))
+            .ok();
+      }
+
+      void NewWriter() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (use_mapped_format_) {
+          mapped_writer_ =
+              absl::make_unique<MappedCacheWriter>(dataset()->env_, filename_);
+        } else {
+          writer_ =
+              absl::make_unique<BundleWriter>(dataset()->env_, filename_);
+        }
+      }
+
+      Status WriterStatus() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        return use_mapped_format_ ? mapped_writer_->status()
+                                  : writer_->status();
+      }
+
+      Status FinishWriter() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        return use_mapped_format_ ? mapped_writer_->Finish()
+                                  : writer_->Finish();
+      }
+
       Status EnsureLockFileExists(bool* end_of_sequence)
           TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         if (iteration_completed_) {
@@ -395,7 +475,14 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
 
         // 1. Check that a checkpoint for the shard has not already been
         // written.
-        if (dataset()->env_->FileExists(MetaFilename(filename_)).ok()) {
+        if (ShardCompleted(filename_)) {
+          if (use_mapped_format_) {
+            return errors::AlreadyExists(
+                "Existing cache files found: \n",
+                MappedCacheIndexFilename(filename_), "\n",
+                MappedCacheDataFilename(filename_), "\n",
+                "To continue delete the above files.");
+          }
           return errors::AlreadyExists("Existing cache files found: \n",
                                        MetaFilename(filename_), "\n",
                                        DataFilename(filename_, 0, 1), "\n",
@@ -437,15 +524,23 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         // conditions are not met since BundleWriter's constructor creates
         // new temp files which can delete the temp files created by a
         // BundleWriter in another Session.
-        writer_ = absl::make_unique<BundleWriter>(dataset()->env_, filename_);
+        NewWriter();
         lockfile_created_ = true;
         return Status::OK();
       }
 
       Status Finish() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         iteration_completed_ = true;
-        // Flush the current bundle.
-        TF_RETURN_IF_ERROR(writer_->Finish());
+        // Flush the current shard.
+        TF_RETURN_IF_ERROR(FinishWriter());
+        if (use_mapped_format_) {
+          // Mapped shards are read in place, so instead of being merged they
+          // are listed in the cache metadata.
+          TF_RETURN_IF_ERROR(WriteMappedCacheMeta(
+              dataset()->env_, dataset()->filename_, shard_id_ + 1,
+              dataset()->num_tensors_));
+          return DeleteLockFiles();
+        }
         // Merge all the bundles.
         // Currently there are `shard_id_ + 1` bundles, one for each
         // checkpoint. Each bundle has prefix <filename>_<id> where `id` is an
@@ -463,7 +558,10 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
           TF_RETURN_IF_ERROR(
               MergeBundles(dataset()->env_, prefixes, dataset()->filename_));
         }
-        // Delete all lockfiles.
+        return DeleteLockFiles();
+      }
+
+      Status DeleteLockFiles() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         for (size_t i = 0; i <= shard_id_; ++i) {
           TF_RETURN_IF_ERROR(dataset()->env_->DeleteFile(
               strings::StrCat(dataset()->filename_, "_", i, kLockFileSuffix)));
@@ -481,9 +579,13 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
       // `StrCat(dataset()->filename_, "_", shard_id_)`.
       string filename_;
       std::unique_ptr<BundleWriter> writer_ TF_GUARDED_BY(mu_);
+      std::unique_ptr<MappedCacheWriter> mapped_writer_ TF_GUARDED_BY(mu_);
       string lockfile_ TF_GUARDED_BY(mu_);
       bool lockfile_created_ TF_GUARDED_BY(mu_);
       bool iteration_completed_ TF_GUARDED_BY(mu_);
+      // Whether shards are written in the mapped format rather than as
+      // bundles.
+      bool use_mapped_format_;
     };  // FileWriterIterator
 
     class FileReaderIterator : public DatasetIterator<FileDatasetBase> {
@@ -575,6 +677,67 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
       bool iterator_restored_ TF_GUARDED_BY(mu_);
     };  // FileReaderIterator
 
+    // MappedFileReaderIterator reads a cache written in the format described
+    // in mapped_cache.h. Only claiming the next index happens under `mu_`;
+    // components are built outside the lock and alias the mapped shards where
+    // possible, so concurrent callers and iterators read in parallel.
+    class MappedFileReaderIterator : public DatasetIterator<FileDatasetBase> {
+     public:
+      explicit MappedFileReaderIterator(const Params& params)
+          : DatasetIterator<FileDatasetBase>(params), cur_index_(0) {}
+
+      Status Initialize(IteratorContext* ctx) override {
+        return dataset()->GetMappedReader(&reader_);
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        int64 index;
+        {
+          mutex_lock l(mu_);
+          if (cur_index_ >= reader_->num_elements()) {
+            *end_of_sequence = true;
+            return Status::OK();
+          }
+          index = cur_index_++;
+        }
+        *end_of_sequence = false;
+        return reader_->Read(index, out_tensors);
+      }
+
+     protected:
+      std::shared_ptr<model::Node> CreateNode(
+          IteratorContext* ctx, model::Node::Args args) const override {
+        return model::MakeKnownRatioNode(std::move(args),
+                                         /*ratio=*/1);
+      }
+
+      Status SaveInternal(SerializationContext* ctx,
+                          IteratorStateWriter* writer) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(full_name(kCurIndex), cur_index_));
+        return Status::OK();
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(full_name(kCurIndex), &cur_index_));
+        if (cur_index_ < 0) {
+          return errors::Internal("Invalid value for cur_index ", cur_index_);
+        }
+        return Status::OK();
+      }
+
+     private:
+      mutex mu_;
+      int64 cur_index_ TF_GUARDED_BY(mu_);
+      std::shared_ptr<const MappedCacheReader> reader_;
+    };  // MappedFileReaderIterator
+
     Status InitializeIterator(IteratorContext* ctx)
         TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       // We intentionally use the same prefix for both `FileReaderIterator` and
@@ -587,9 +750,18 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
       // `cur_index`.
       switch (mode_) {
         case Mode::read:
-          iterator_ =
-              absl::make_unique<FileReaderIterator>(FileReaderIterator::Params{
-                  dataset(), strings::StrCat(prefix(), kImpl)});
+          if (dataset()
+                  ->env_
+                  ->FileExists(MappedCacheMetaFilename(dataset()->filename_))
+                  .ok()) {
+            iterator_ = absl::make_unique<MappedFileReaderIterator>(
+                MappedFileReaderIterator::Params{
+                    dataset(), strings::StrCat(prefix(), kImpl)});
+          } else {
+            iterator_ = absl::make_unique<FileReaderIterator>(
+                FileReaderIterator::Params{dataset(),
+                                           strings::StrCat(prefix(), kImpl)});
+          }
           break;
         case Mode::write:
           iterator_ =
@@ -612,6 +784,10 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
   static constexpr size_t kMaxItems = 10000000;  // 10 million
   const size_t item_index_padding_size_;
   const string tensor_format_string_;
+  const bool use_mapped_format_;
+  mutable mutex mapped_reader_mu_;
+  mutable std::shared_ptr<const MappedCacheReader> mapped_reader_
+      TF_GUARDED_BY(mapped_reader_mu_);
 };  // FileDatasetBase
 
 class CacheDatasetOp::FileDataset : public CacheDatasetOp::FileDatasetBase {
@@ -696,6 +872,24 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
 
   int64 Cardinality() const override { return input_->Cardinality(); }
 
+  // Random access is supported once an iterator has completely filled the
+  // cache.
+  Status Get(OpKernelContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    std::shared_ptr<const MemoryCache::Elements> elements = cache_->snapshot();
+    if (!elements) {
+      return errors::FailedPrecondition(
+          "Random access into a cache dataset requires the cache to be "
+          "completely filled first.");
+    }
+    if (index < 0 || index >= static_cast<int64>(elements->size())) {
+      return errors::OutOfRange("Index ", index, " is out of range [0, ",
+                                elements->size(), ")");
+    }
+    *out_tensors = (*elements)[index];
+    return Status::OK();
+  }
+
   Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
     inputs->push_back(input_);
     return Status::OK();
@@ -719,7 +913,8 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
     Status GetNextInternal(IteratorContext* ctx,
                            std::vector<Tensor>* out_tensors,
                            bool* end_of_sequence) override {
-      mutex_lock l(mu_);
+      // See `FileIterator::GetNextInternal`.
+      tf_shared_lock l(mu_);
       return iterator_->GetNext(ctx, out_tensors, end_of_sequence);
     }
 
@@ -832,6 +1027,9 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
       std::vector<std::vector<Tensor>> temp_cache_ TF_GUARDED_BY(mu_);
     };  // MemoryWriterIterator
 
+    // MemoryReaderIterator reads from an immutable snapshot of the completed
+    // cache and claims indices with an atomic counter, so concurrent calls to
+    // `GetNext` do not serialize on a lock.
     class MemoryReaderIterator : public DatasetIterator<MemoryDatasetBase> {
      public:
       explicit MemoryReaderIterator(const Params& params, MemoryCache* cache)
@@ -840,14 +1038,18 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
             index_(0) {}
 
       Status Initialize(IteratorContext* ctx) override {
+        elements_ = cache_->snapshot();
+        if (!elements_) {
+          return errors::Internal(
+              "The memory cache was reset before it could be read.");
+        }
         // The memory allocated for the cache is owned by the parent
         // dataset but performance modeling uses the iterator abstraction and
         // thus we record the memory allocated for the cache here. The caveat
         // is that this is incorrect if there are concurrent instances of this
         // iterator.
-        tf_shared_lock l(mu_);
-        for (size_t i = 0; i < cache_->size(); ++i) {
-          RecordBufferEnqueue(ctx, cache_->at(i));
+        for (const std::vector<Tensor>& element : *elements_) {
+          RecordBufferEnqueue(ctx, element);
         }
         return Status::OK();
       }
@@ -855,12 +1057,11 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
       Status GetNextInternal(IteratorContext* ctx,
                              std::vector<Tensor>* out_tensors,
                              bool* end_of_sequence) override {
-        mutex_lock l(mu_);
-        if (index_ < cache_->size()) {
-          const std::vector<Tensor>& cache_tensors = cache_->at(index_);
+        const int64 index = index_.fetch_add(1, std::memory_order_relaxed);
+        if (index < static_cast<int64>(elements_->size())) {
+          const std::vector<Tensor>& cache_tensors = (*elements_)[index];
           out_tensors->insert(out_tensors->begin(), cache_tensors.begin(),
                               cache_tensors.end());
-          index_++;
           *end_of_sequence = false;
           return Status::OK();
         } else {
@@ -878,30 +1079,34 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
 
       Status SaveInternal(SerializationContext* ctx,
                           IteratorStateWriter* writer) override {
-        mutex_lock l(mu_);
-        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kIndex), index_));
+        // Calls past the end keep incrementing `index_`, so clamp it.
+        const int64 index =
+            std::min<int64>(index_.load(std::memory_order_relaxed),
+                            elements_->size());
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kIndex), index));
         return Status::OK();
       }
 
       Status RestoreInternal(IteratorContext* ctx,
                              IteratorStateReader* reader) override {
-        mutex_lock l(mu_);
         {
           // kIndex will not be set if we are restoring from a checkpoint
           // written by a MemoryWriterIterator that has completed its cache.
-          int64 temp = cache_->size();
+          int64 temp = elements_->size();
           if (reader->Contains(full_name(kIndex))) {
             TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kIndex), &temp));
           }
-          index_ = static_cast<size_t>(temp);
+          index_.store(temp, std::memory_order_relaxed);
         }
         return Status::OK();
       }
 
      private:
-      mutex mu_;
-      MemoryCache* const cache_ TF_GUARDED_BY(mu_);  // not owned.
-      size_t index_ TF_GUARDED_BY(mu_);
+      MemoryCache* const cache_;  // not owned.
+      // Set by `Initialize` and immutable afterwards.
+      std::shared_ptr<const MemoryCache::Elements> elements_;
+      // The index of the next element to produce.
+      std::atomic<int64> index_;
     };  // MemoryReaderIterator
 
     Status InitializeIterator(IteratorContext* ctx)
@@ -199,6 +199,35 @@ TEST_P(ParameterizedGetNextTest, GetNext) {
 INSTANTIATE_TEST_SUITE_P(CacheDatasetOpTest, ParameterizedGetNextTest,
                          ::testing::ValuesIn(GetNextTestCases()));
 
+TEST_F(CacheDatasetOpTest, MemoryCacheRandomAccess) {
+  auto dataset_params = CacheDatasetParams3();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<Tensor> element;
+  EXPECT_EQ(dataset_->Get(/*ctx=*/nullptr, /*index=*/0, &element).code(),
+            error::FAILED_PRECONDITION);
+
+  bool end_of_sequence = false;
+  while (!end_of_sequence) {
+    std::vector<Tensor> next;
+    TF_ASSERT_OK(
+        iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+  }
+  TF_ASSERT_OK(dataset_->Get(/*ctx=*/nullptr, /*index=*/1, &element));
+  TF_EXPECT_OK(ExpectEqual(
+      element, CreateTensors<int64>(TensorShape({3, 1}), {{3, 4, 5}}),
+      /*compare_order=*/true));
+  EXPECT_EQ(dataset_->Get(/*ctx=*/nullptr, /*index=*/3, &element).code(),
+            error::OUT_OF_RANGE);
+}
+
+TEST_F(CacheDatasetOpTest, FileCacheHasNoRandomAccess) {
+  auto dataset_params = CacheDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<Tensor> element;
+  EXPECT_EQ(dataset_->Get(/*ctx=*/nullptr, /*index=*/0, &element).code(),
+            error::UNIMPLEMENTED);
+}
+
 TEST_F(CacheDatasetOpTest, DatasetNodeName) {
   auto dataset_params = CacheDatasetParams1();
   TF_ASSERT_OK(Initialize(dataset_params));
@@ -36,7 +36,7 @@ string MemoryCacheManager::DebugString() const { return kMemoryCache; }
 void MemoryCache::Complete(std::vector<std::vector<Tensor>>&& cache) {
   mutex_lock l(mu_);
   if (!completed_) {
-    cache_ = std::move(cache);
+    cache_ = std::make_shared<const Elements>(std::move(cache));
     completed_ = true;
   }
 }
@@ -49,23 +49,28 @@ bool MemoryCache::IsCompleted() {
 void MemoryCache::Reset() {
   mutex_lock l(mu_);
   completed_ = false;
-  cache_.clear();
+  cache_ = std::make_shared<const Elements>();
 }
 
 const std::vector<Tensor>& MemoryCache::at(int64 index) {
   tf_shared_lock l(mu_);
-  DCHECK(index < cache_.size());
-  return cache_[index];
+  DCHECK(index < cache_->size());
+  return (*cache_)[index];
 }
 
 size_t MemoryCache::size() {
   tf_shared_lock l(mu_);
-  return cache_.size();
+  return cache_->size();
 }
 
 const std::vector<std::vector<Tensor>>& MemoryCache::data() {
   tf_shared_lock l(mu_);
-  return cache_;
+  return *cache_;
+}
+
+std::shared_ptr<const MemoryCache::Elements> MemoryCache::snapshot() {
+  tf_shared_lock l(mu_);
+  return completed_ ? cache_ : nullptr;
 }
 
 AnonymousMemoryCacheHandleOp::AnonymousMemoryCacheHandleOp(
@@ -26,9 +26,12 @@ namespace data {
 //
 // The expected use is that a single `MemoryWriterIterator` populates the
 // cache with dataset elements. Once all elements are cached, the cache can
-// be used by one or more `MemoryReaderIterator`s.
+// be used by one or more `MemoryReaderIterator`s. The contents of a completed
+// cache are immutable, so readers holding a `snapshot()` need no locking.
 class MemoryCache {
  public:
+  using Elements = std::vector<std::vector<Tensor>>;
+
   MemoryCache() = default;
 
   // Marks the cache as completed.
@@ -50,11 +53,17 @@ class MemoryCache {
   // invalidated by any call to Reset().
   const std::vector<std::vector<Tensor>>& data();
 
+  // Returns the contents of the completed cache, or nullptr if the cache is
+  // not completed. The contents stay valid for as long as the returned
+  // pointer is held, even across calls to Reset().
+  std::shared_ptr<const Elements> snapshot();
+
  private:
   mutex mu_;
   // Determines whether all elements of the dataset have been cached.
   bool completed_ TF_GUARDED_BY(mu_) = false;
-  std::vector<std::vector<Tensor>> cache_ TF_GUARDED_BY(mu_);
+  std::shared_ptr<const Elements> cache_ TF_GUARDED_BY(mu_) =
+      std::make_shared<const Elements>();
 };
 
 // A resource wrapping a shared instance of a memory cache.
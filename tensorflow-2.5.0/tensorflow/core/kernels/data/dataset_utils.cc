@@ -844,9 +844,105 @@ Status ProcessBatch(int64 batch_size, int64 num_elements, bool drop_remainder,
   return Status::OK();
 }
 
+Status BatchSlabPool::Allocate(Allocator* allocator, DataType dtype,
+                               const TensorShape& shape, Tensor* out) {
+  if (!DataTypeCanUseMemcpy(dtype)) {
+    *out = Tensor(allocator, dtype, shape);
+    return Status::OK();
+  }
+  mutex_lock l(mu_);
+  int64 released_index = -1;
+  for (int64 i = 0; i < slabs_.size(); ++i) {
+    if (!slabs_[i].RefCountIsOne()) {
+      continue;
+    }
+    if (slabs_[i].dtype() == dtype && slabs_[i].shape() == shape) {
+      *out = slabs_[i];
+      return Status::OK();
+    }
+    released_index = i;
+  }
+  *out = Tensor(allocator, dtype, shape);
+  if (!out->IsInitialized()) {
+    return Status::OK();
+  }
+  if (slabs_.size() < max_slabs_) {
+    slabs_.push_back(*out);
+  } else if (released_index >= 0) {
+    // Evict a released slab of a different shape, e.g. the partial final
+    // batch of an earlier epoch.
+    slabs_[released_index] = *out;
+  }
+  return Status::OK();
+}
+
+Status BatchBuilder::Add(IteratorContext* ctx, std::vector<Tensor>* element) {
+  if (num_elements_ == 0) {
+    batch_.clear();
+    element_shapes_.clear();
+    batch_.reserve(element->size());
+    element_shapes_.reserve(element->size());
+    for (size_t i = 0; i < element->size(); ++i) {
+      const Tensor& component = (*element)[i];
+      TensorShape batch_component_shape({batch_size_});
+      batch_component_shape.AppendShape(component.shape());
+      element_shapes_.push_back(component.shape());
+      batch_.emplace_back();
+      if (slab_pool_) {
+        TF_RETURN_IF_ERROR(slab_pool_->Allocate(ctx->allocator({}),
+                                                component.dtype(),
+                                                batch_component_shape,
+                                                &batch_.back()));
+      } else {
+        batch_.back() = Tensor(ctx->allocator({}), component.dtype(),
+                               batch_component_shape);
+      }
+      if (!batch_.back().IsInitialized()) {
+        return errors::ResourceExhausted(
+            "Failed to allocate memory for the batch of component ", i);
+      }
+    }
+  } else if (element->size() != batch_.size()) {
+    return errors::InvalidArgument(
+        "Cannot batch elements with different numbers of components. First "
+        "element had ",
+        batch_.size(), " components and element ", num_elements_, " had ",
+        element->size(), ".");
+  }
+  for (size_t i = 0; i < element->size(); ++i) {
+    if ((*element)[i].shape() != element_shapes_[i]) {
+      return errors::InvalidArgument(
+          "Cannot batch tensors with different shapes in component ", i,
+          ". First element had shape ", element_shapes_[i].DebugString(),
+          " and element ", num_elements_, " had shape ",
+          (*element)[i].shape().DebugString(), ".");
+    }
+    TF_RETURN_IF_ERROR(batch_util::CopyElementToSlice(
+        std::move((*element)[i]), &batch_[i], num_elements_));
+  }
+  element->clear();
+  ++num_elements_;
+  return Status::OK();
+}
+
+void BatchBuilder::Finish(std::vector<Tensor>* out_tensors) {
+  DCHECK_GT(num_elements_, 0);
+  out_tensors->reserve(out_tensors->size() + batch_.size());
+  for (Tensor& batch_component : batch_) {
+    if (num_elements_ < batch_size_) {
+      out_tensors->push_back(batch_component.Slice(0, num_elements_));
+    } else {
+      out_tensors->push_back(std::move(batch_component));
+    }
+  }
+  batch_.clear();
+  num_elements_ = 0;
+}
+
 Status CopyBatch(bool parallel_copy, IteratorContext* ctx,
                  std::vector<Tensor>* out_tensors,
-                 std::vector<std::vector<Tensor>>* batch_elements) {
+                 std::vector<std::vector<Tensor>>* batch_elements,
+                 BatchSlabPool* slab_pool) {
   const size_t num_tuple_components = (*batch_elements)[0].size();
   out_tensors->reserve(num_tuple_components);
   const int64 num_batch_elements = batch_elements->size();
@@ -859,8 +955,15 @@ Status CopyBatch(bool parallel_copy, IteratorContext* ctx,
     // is moved into the output batch.
     TensorShape first_element_shape(first_element.shape());
     batch_component_shape.AppendShape(first_element_shape);
-    out_tensors->emplace_back(ctx->allocator({}), first_element.dtype(),
-                              batch_component_shape);
+    if (slab_pool) {
+      out_tensors->emplace_back();
+      TF_RETURN_IF_ERROR(slab_pool->Allocate(
+          ctx->allocator({}), first_element.dtype(), batch_component_shape,
+          &out_tensors->back()));
+    } else {
+      out_tensors->emplace_back(ctx->allocator({}), first_element.dtype(),
+                                batch_component_shape);
+    }
     if (!out_tensors->back().IsInitialized()) {
       return errors::ResourceExhausted(
           "Failed to allocate memory for the batch of component ",
@@ -20,6 +20,8 @@ limitations under the License.
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 
 namespace tensorflow {
 namespace data {
@@ -329,10 +331,68 @@ Status ProcessBatch(int64 batch_size, int64 num_elements, bool drop_remainder,
                     std::vector<Tensor>* output, bool* end_of_sequence,
                     std::vector<Tensor>* batch);
 
-// Copies the input elements to a batch.
+// A pool of batch output tensors ("slabs") which are reused once the consumer
+// of a batch has released it, so that steady-state batching does not allocate
+// a fresh output buffer for every batch.
+//
+// A slab is only handed out again when the pool holds the only reference to
+// it. Because the pool keeps a reference to every slab it hands out, batches
+// allocated from the pool cannot be forwarded in-place by downstream kernels.
+// Only types which can be copied with memcpy are pooled.
+//
+// This class is thread-safe.
+class BatchSlabPool {
+ public:
+  explicit BatchSlabPool(int64 max_slabs) : max_slabs_(max_slabs) {}
+
+  // Sets `*out` to a tensor with the given type and shape, reusing a released
+  // slab when one matches and allocating from `allocator` otherwise.
+  Status Allocate(Allocator* allocator, DataType dtype,
+                  const TensorShape& shape, Tensor* out);
+
+ private:
+  const int64 max_slabs_;
+  mutex mu_;
+  std::vector<Tensor> slabs_ TF_GUARDED_BY(mu_);
+};
+
+// Builds a batch by copying each element into the output batch as soon as it
+// arrives, so that the input elements can be released while the rest of the
+// batch is produced instead of being buffered until the batch is complete.
+//
+// This class is not thread-safe.
+class BatchBuilder {
+ public:
+  // `slab_pool` may be null, in which case every batch is freshly allocated.
+  BatchBuilder(int64 batch_size, BatchSlabPool* slab_pool)
+      : batch_size_(batch_size), slab_pool_(slab_pool) {}
+
+  // Copies the components of `element` into the next row of the batch. The
+  // components are consumed.
+  Status Add(IteratorContext* ctx, std::vector<Tensor>* element);
+
+  // The number of elements added since the last call to `Finish()`.
+  int64 num_elements() const { return num_elements_; }
+
+  // Moves the batch built so far into `out_tensors`. If fewer than
+  // `batch_size` elements were added, the outputs only cover the added
+  // elements. Must only be called after at least one element was added.
+  void Finish(std::vector<Tensor>* out_tensors);
+
+ private:
+  const int64 batch_size_;
+  BatchSlabPool* const slab_pool_;
+  int64 num_elements_ = 0;
+  std::vector<TensorShape> element_shapes_;
+  std::vector<Tensor> batch_;
+};
+
+// Copies the input elements to a batch. If `slab_pool` is non-null, the output
+// tensors are allocated from it.
 Status CopyBatch(bool parallel_copy, IteratorContext* ctx,
                  std::vector<Tensor>* out_tensors,
-                 std::vector<std::vector<Tensor>>* batch_elements);
+                 std::vector<std::vector<Tensor>>* batch_elements,
+                 BatchSlabPool* slab_pool = nullptr);
 
 }  // namespace data
 }  // namespace tensorflow
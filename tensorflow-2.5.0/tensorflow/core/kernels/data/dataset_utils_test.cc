@@ -298,6 +298,48 @@ TEST(DatasetUtilsTest, BoolConstructor) {
   EXPECT_FALSE(DeterminismPolicy(false).IsDefault());
 }
 
+TEST(DatasetUtilsTest, BatchSlabPoolReusesReleasedSlabs) {
+  BatchSlabPool pool(/*max_slabs=*/1);
+  Allocator* allocator = cpu_allocator();
+  Tensor first;
+  TF_ASSERT_OK(pool.Allocate(allocator, DT_INT64, TensorShape({4, 2}), &first));
+  const void* first_data = first.tensor_data().data();
+
+  // The first slab is still held, so a new slab is allocated.
+  Tensor second;
+  TF_ASSERT_OK(
+      pool.Allocate(allocator, DT_INT64, TensorShape({4, 2}), &second));
+  EXPECT_NE(second.tensor_data().data(), first_data);
+
+  // Once released, the first slab is handed out again.
+  first = Tensor();
+  second = Tensor();
+  Tensor third;
+  TF_ASSERT_OK(pool.Allocate(allocator, DT_INT64, TensorShape({4, 2}), &third));
+  EXPECT_EQ(third.tensor_data().data(), first_data);
+}
+
+TEST(DatasetUtilsTest, BatchSlabPoolMatchesShapeAndType) {
+  BatchSlabPool pool(/*max_slabs=*/2);
+  Allocator* allocator = cpu_allocator();
+  Tensor slab;
+  TF_ASSERT_OK(pool.Allocate(allocator, DT_INT64, TensorShape({4, 2}), &slab));
+  const void* slab_data = slab.tensor_data().data();
+  slab = Tensor();
+
+  Tensor other_shape;
+  TF_ASSERT_OK(
+      pool.Allocate(allocator, DT_INT64, TensorShape({3, 2}), &other_shape));
+  EXPECT_NE(other_shape.tensor_data().data(), slab_data);
+  EXPECT_EQ(other_shape.shape(), TensorShape({3, 2}));
+
+  Tensor other_type;
+  TF_ASSERT_OK(
+      pool.Allocate(allocator, DT_DOUBLE, TensorShape({4, 2}), &other_type));
+  EXPECT_NE(other_type.tensor_data().data(), slab_data);
+  EXPECT_EQ(other_type.dtype(), DT_DOUBLE);
+}
+
 class SelectOptimizationsHashTest : public ::testing::TestWithParam<uint64> {};
 
 TEST_P(SelectOptimizationsHashTest, DatasetUtils) {
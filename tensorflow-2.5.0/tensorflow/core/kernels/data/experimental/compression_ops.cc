@@ -23,7 +23,13 @@ namespace data {
 namespace experimental {
 
 CompressElementOp::CompressElementOp(OpKernelConstruction* ctx)
-    : OpKernel(ctx) {}
+    : OpKernel(ctx) {
+  std::string codec;
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kCodec, &codec));
+  OP_REQUIRES(ctx, CompressedElement::Codec_Parse(codec, &codec_),
+              errors::InvalidArgument("Unsupported codec: ", codec));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kLevel, &level_));
+}
 
 void CompressElementOp::Compute(OpKernelContext* ctx) {
   std::vector<Tensor> components;
@@ -31,7 +37,8 @@ void CompressElementOp::Compute(OpKernelContext* ctx) {
     components.push_back(ctx->input(i));
   }
   CompressedElement compressed;
-  OP_REQUIRES_OK(ctx, CompressElement(components, &compressed));
+  OP_REQUIRES_OK(ctx,
+                 CompressElement(components, codec_, level_, &compressed));
 
   Tensor* output;
   OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({}), &output));
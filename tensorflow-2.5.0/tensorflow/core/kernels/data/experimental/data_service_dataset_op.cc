@@ -45,6 +45,7 @@ limitations under the License.
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/profiler/lib/traceme_encode.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
@@ -226,6 +227,11 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
         : DatasetIterator<Dataset>(params),
           iterator_index_(iterator_index),
           max_outstanding_requests_(params.dataset->max_outstanding_requests_) {
+      Status s = ReadStringFromEnvVar("TF_DATA_SERVICE_CLIENT_LOCALITY", "",
+                                      &client_locality_);
+      if (!s.ok()) {
+        LOG(WARNING) << "Failed to read TF_DATA_SERVICE_CLIENT_LOCALITY: " << s;
+      }
     }
 
     ~Iterator() override {
@@ -382,12 +388,17 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
    private:
     struct Task {
       Task(const TaskInfo& info,
-           std::unique_ptr<DataServiceWorkerClient> worker)
-          : info(info), worker(std::move(worker)) {}
+           std::unique_ptr<DataServiceWorkerClient> worker,
+           int64 shared_locality_levels)
+          : info(info),
+            worker(std::move(worker)),
+            shared_locality_levels(shared_locality_levels) {}
 
       const TaskInfo info;
       // Client for fetching task elements from the tf.data service worker.
       const std::unique_ptr<DataServiceWorkerClient> worker;
+      // The number of topology levels the worker shares with this client.
+      const int64 shared_locality_levels;
       // The next round to read from the task.
       int64 round = 0;
       // Whether the task has been removed. The task will eventually be
@@ -487,7 +498,10 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
       TF_RETURN_IF_ERROR(CreateDataServiceWorkerClient(
           task_info.transfer_address(), dataset()->protocol_,
           dataset()->data_transfer_protocol_, worker));
-      tasks_.push_back(std::make_shared<Task>(task_info, std::move(worker)));
+      tasks_.push_back(std::make_shared<Task>(
+          task_info, std::move(worker),
+          SharedLocalityLevels(client_locality_,
+                               task_info.worker_locality())));
       worker_thread_cv_.notify_one();
       if (StrictRoundRobin()) {
         VLOG(1) << "Consumer " << dataset()->consumer_index_.value()
@@ -613,6 +627,9 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
     // Searches for a task to process, returning nullptr if none is found.
     std::shared_ptr<Task> GetTaskToProcess() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       VLOG(4) << "Searching for task to process";
+      if (!StrictRoundRobin() && !client_locality_.empty()) {
+        return GetClosestTaskToProcess();
+      }
       for (int i = 0; i < tasks_.size(); ++i) {
         std::shared_ptr<Task>& task = tasks_[next_task_index_];
         if (StrictRoundRobin() &&
@@ -643,6 +660,40 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
       return nullptr;
     }
 
+    // Like `GetTaskToProcess`, but prefers the tasks whose workers share the
+    // most topology levels with the client, breaking ties in round-robin
+    // order. Since each task serves one request at a time, farther workers
+    // are only read from while all closer ones are busy, i.e. when the closer
+    // workers alone cannot keep up with the client.
+    std::shared_ptr<Task> GetClosestTaskToProcess()
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      int64 best_index = -1;
+      for (int i = 0; i < tasks_.size(); ++i) {
+        const int64 index = (next_task_index_ + i) % tasks_.size();
+        const std::shared_ptr<Task>& task = tasks_[index];
+        if (current_round_ < task->info.starting_round() || task->in_use ||
+            task->end_of_sequence || task->removed) {
+          continue;
+        }
+        if (best_index < 0 || task->shared_locality_levels >
+                                  tasks_[best_index]->shared_locality_levels) {
+          best_index = index;
+        }
+      }
+      if (best_index < 0) {
+        return nullptr;
+      }
+      std::shared_ptr<Task> task = tasks_[best_index];
+      VLOG(3) << "Reading from task " << task->info.task_id() << " on worker "
+              << task->info.worker_address() << ", which shares "
+              << task->shared_locality_levels
+              << " topology levels with the client";
+      next_task_index_ = best_index;
+      task->round = current_round_;
+      AdvanceTaskIndex();
+      return task;
+    }
+
     void RunWorkerThread(std::function<void()> done) {
       auto cleanup = gtl::MakeCleanup([done = std::move(done)]() {
         done();
@@ -888,6 +939,11 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
     // List of tasks to read from.
     std::vector<std::shared_ptr<Task>> tasks_ TF_GUARDED_BY(mu_);
 
+    // Topology labels of the client, read from
+    // TF_DATA_SERVICE_CLIENT_LOCALITY. If set, the client prefers reading from
+    // the workers closest to it. See `WorkerConfig.locality`.
+    std::string client_locality_;
+
     // The current round robin round we are engaged in. A round involves reading
     // from each task once.
     int64 current_round_ TF_GUARDED_BY(mu_) = 0;
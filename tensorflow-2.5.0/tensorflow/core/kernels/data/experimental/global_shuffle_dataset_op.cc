@@ -0,0 +1,355 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/global_shuffle_dataset_op.h"
+
+#include <array>
+
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/data/dataset_utils.h"
+#include "tensorflow/core/kernels/data/name_utils.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// Constants declared in global_shuffle_dataset_op.h and used both here and in
+// test cases.
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kDatasetType;
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kInputDataset;
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kSeed;
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kSeed2;
+/* static */ constexpr const char* const
+    GlobalShuffleDatasetOp::kReshuffleEachIteration;
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kOutputTypes;
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kOutputShapes;
+
+namespace {
+
+constexpr char kPosition[] = "position";
+constexpr char kIterationSeed[] = "iteration_seed";
+constexpr char kIterationSeed2[] = "iteration_seed2";
+
+// A pseudorandom permutation of `[0, size)` that is evaluated on demand, so it
+// takes constant memory regardless of `size`.
+//
+// The permutation is a balanced Feistel network over the smallest domain of
+// `2^(2k)` values that covers `size`. Outputs that fall outside of `[0, size)`
+// are fed back through the network ("cycle walking") until they land inside
+// it; because the network is a bijection on its domain this terminates and
+// yields a bijection on `[0, size)`. Since the domain is less than four times
+// `size`, the expected number of walks per index is below four.
+class IndexPermutation {
+ public:
+  IndexPermutation(int64 size, int64 seed, int64 seed2) : size_(size) {
+    int bits = 2;
+    while (bits < 62 && (uint64{1} << bits) < size_) {
+      bits += 2;
+    }
+    half_bits_ = bits / 2;
+    half_mask_ = (uint64{1} << half_bits_) - 1;
+    random::PhiloxRandom generator(seed, seed2);
+    for (int i = 0; i < kNumRounds; i += 2) {
+      random::PhiloxRandom::ResultType sample = generator();
+      keys_[i] = (static_cast<uint64>(sample[0]) << 32) | sample[1];
+      keys_[i + 1] = (static_cast<uint64>(sample[2]) << 32) | sample[3];
+    }
+  }
+
+  // Returns the index that `position` is mapped to.
+  int64 operator()(int64 position) const {
+    uint64 value = position;
+    do {
+      value = Encrypt(value);
+    } while (value >= size_);
+    return value;
+  }
+
+ private:
+  static constexpr int kNumRounds = 8;
+
+  // A splitmix64-style finalizer, truncated to the width of one half.
+  uint64 Round(uint64 value, uint64 key) const {
+    uint64 z = (value + 0x9e3779b97f4a7c15ULL) ^ key;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return (z ^ (z >> 31)) & half_mask_;
+  }
+
+  uint64 Encrypt(uint64 value) const {
+    uint64 left = value >> half_bits_;
+    uint64 right = value & half_mask_;
+    for (uint64 key : keys_) {
+      uint64 next = left ^ Round(right, key);
+      left = right;
+      right = next;
+    }
+    return (left << half_bits_) | right;
+  }
+
+  const uint64 size_;
+  int half_bits_;
+  uint64 half_mask_;
+  std::array<uint64, kNumRounds> keys_;
+};
+
+}  // namespace
+
+class GlobalShuffleDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, const DatasetBase* input, int64 seed,
+          int64 seed2, bool reshuffle_each_iteration)
+      : DatasetBase(DatasetContext(ctx)),
+        input_(input),
+        seeds_(seed, seed2),
+        effective_seeds_(MaybeOverrideSeeds(seeds_)),
+        reshuffle_each_iteration_(reshuffle_each_iteration),
+        cardinality_(input->Cardinality()) {
+    input_->Ref();
+  }
+
+  ~Dataset() override { input_->Unref(); }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return absl::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return input_->output_dtypes();
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return input_->output_shapes();
+  }
+
+  string DebugString() const override {
+    return name_utils::DatasetDebugString(kDatasetType);
+  }
+
+  int64 Cardinality() const override { return cardinality_; }
+
+  // Random access uses the seeds the dataset was created with, so repeated
+  // calls for the same index agree even if `reshuffle_each_iteration` is set.
+  Status Get(OpKernelContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    if (index < 0 || index >= cardinality_) {
+      return errors::OutOfRange("Index ", index, " is out of range [0, ",
+                                cardinality_, ")");
+    }
+    IndexPermutation permutation(cardinality_, effective_seeds_.first,
+                                 effective_seeds_.second);
+    return input_->Get(ctx, permutation(index), out_tensors);
+  }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    inputs->push_back(input_);
+    return Status::OK();
+  }
+
+  Status CheckExternalState() const override {
+    return input_->CheckExternalState();
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* input_graph_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
+    Node* seed = nullptr;
+    Node* seed2 = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(seeds_.first, &seed));
+    TF_RETURN_IF_ERROR(b->AddScalar(seeds_.second, &seed2));
+    AttrValue reshuffle_each_iteration;
+    b->BuildAttrValue(reshuffle_each_iteration_, &reshuffle_each_iteration);
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this, {input_graph_node, seed, seed2},
+        {std::make_pair(kReshuffleEachIteration, reshuffle_each_iteration)},
+        output));
+    return Status::OK();
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params) {}
+
+    Status Initialize(IteratorContext* ctx) override {
+      mutex_lock l(mu_);
+      seeds_ = dataset()->NextIterationSeeds();
+      ResetPermutation();
+      return Status::OK();
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      int64 index;
+      {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(EnsureInputMaterialized(ctx));
+        if (position_ >= dataset()->cardinality_) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+        index = (*permutation_)(position_++);
+      }
+      // Reading the element is done outside of the lock, so that concurrent
+      // callers only serialize on claiming a position.
+      *end_of_sequence = false;
+      return dataset()->input_->Get(/*ctx=*/nullptr, index, out_tensors);
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeKnownRatioNode(std::move(args), /*ratio=*/1);
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(full_name(kIterationSeed), seeds_.first));
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(full_name(kIterationSeed2), seeds_.second));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kPosition), position_));
+      return Status::OK();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(full_name(kIterationSeed), &seeds_.first));
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(full_name(kIterationSeed2), &seeds_.second));
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kPosition), &position_));
+      ResetPermutation();
+      return Status::OK();
+    }
+
+   private:
+    void ResetPermutation() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      permutation_ = absl::make_unique<IndexPermutation>(
+          dataset()->cardinality_, seeds_.first, seeds_.second);
+    }
+
+    // Some inputs only support random access once their elements have been
+    // produced (for example, an in-memory cache that is filled on its first
+    // iteration). In that case, the input is iterated over once to
+    // materialize its elements before any of them is read by index.
+    Status EnsureInputMaterialized(IteratorContext* ctx)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (input_materialized_ || dataset()->cardinality_ == 0) {
+        return Status::OK();
+      }
+      std::vector<Tensor> unused;
+      Status s = dataset()->input_->Get(/*ctx=*/nullptr, 0, &unused);
+      if (errors::IsFailedPrecondition(s)) {
+        std::unique_ptr<IteratorBase> input_impl;
+        TF_RETURN_IF_ERROR(
+            dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl));
+        bool end_of_input = false;
+        while (!end_of_input) {
+          unused.clear();
+          TF_RETURN_IF_ERROR(input_impl->GetNext(ctx, &unused, &end_of_input));
+        }
+        s = dataset()->input_->Get(/*ctx=*/nullptr, 0, &unused);
+      }
+      if (errors::IsUnimplemented(s)) {
+        return errors::InvalidArgument(
+            "`global_shuffle` requires an input dataset that supports random "
+            "access, but ", dataset()->input_->DebugString(),
+            " does not. Consider applying `cache()` to the input first.");
+      }
+      TF_RETURN_IF_ERROR(s);
+      input_materialized_ = true;
+      return Status::OK();
+    }
+
+    mutex mu_;
+    std::pair<int64, int64> seeds_ TF_GUARDED_BY(mu_);
+    std::unique_ptr<IndexPermutation> permutation_ TF_GUARDED_BY(mu_);
+    int64 position_ TF_GUARDED_BY(mu_) = 0;
+    bool input_materialized_ TF_GUARDED_BY(mu_) = false;
+  };
+
+  // Returns the seeds to use for the permutation of a new iterator.
+  std::pair<int64, int64> NextIterationSeeds() const {
+    if (!reshuffle_each_iteration_) {
+      return effective_seeds_;
+    }
+    mutex_lock l(mu_);
+    random::PhiloxRandom generator(effective_seeds_.first,
+                                   effective_seeds_.second);
+    generator.Skip(num_iterations_++);
+    random::PhiloxRandom::ResultType sample = generator();
+    return {(static_cast<int64>(sample[0]) << 32) | sample[1],
+            (static_cast<int64>(sample[2]) << 32) | sample[3]};
+  }
+
+  const DatasetBase* const input_;
+  const std::pair<int64, int64> seeds_;
+  // `seeds_` with zero seeds replaced by random ones, fixed for the lifetime
+  // of the dataset so that all its iterators agree when not reshuffling.
+  const std::pair<int64, int64> effective_seeds_;
+  const bool reshuffle_each_iteration_;
+  const int64 cardinality_;
+  mutable mutex mu_;
+  mutable int64 num_iterations_ TF_GUARDED_BY(mu_) = 0;
+};
+
+GlobalShuffleDatasetOp::GlobalShuffleDatasetOp(OpKernelConstruction* ctx)
+    : UnaryDatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kReshuffleEachIteration,
+                                   &reshuffle_each_iteration_));
+}
+
+void GlobalShuffleDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                         DatasetBase* input,
+                                         DatasetBase** output) {
+  int64 seed;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, kSeed, &seed));
+
+  int64 seed2;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, kSeed2, &seed2));
+
+  OP_REQUIRES(ctx, input->Cardinality() >= 0,
+              errors::InvalidArgument(
+                  "`global_shuffle` requires an input dataset with a known, "
+                  "finite cardinality, but the cardinality of ",
+                  input->DebugString(), " is ",
+                  input->Cardinality() == kInfiniteCardinality ? "infinite"
+                                                               : "unknown",
+                  "."));
+
+  *output = new Dataset(ctx, input, seed, seed2, reshuffle_each_iteration_);
+}
+
+namespace {
+REGISTER_KERNEL_BUILDER(Name("GlobalShuffleDataset").Device(DEVICE_CPU),
+                        GlobalShuffleDatasetOp);
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,216 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/global_shuffle_dataset_op.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "tensorflow/core/kernels/data/dataset_test_base.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kNodeName[] = "global_shuffle_dataset";
+constexpr int64 kRandomSeed = 42;
+constexpr int64 kRandomSeed2 = 7;
+
+class GlobalShuffleDatasetParams : public DatasetParams {
+ public:
+  template <typename T>
+  GlobalShuffleDatasetParams(T input_dataset_params,
+                             bool reshuffle_each_iteration,
+                             DataTypeVector output_dtypes,
+                             std::vector<PartialTensorShape> output_shapes,
+                             string node_name)
+      : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
+                      std::move(node_name)),
+        reshuffle_each_iteration_(reshuffle_each_iteration) {
+    input_dataset_params_.push_back(absl::make_unique<T>(input_dataset_params));
+    iterator_prefix_ =
+        name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
+                                   input_dataset_params.iterator_prefix());
+  }
+
+  std::vector<Tensor> GetInputTensors() const override {
+    return {CreateTensor<int64>(TensorShape({}), {kRandomSeed}),
+            CreateTensor<int64>(TensorShape({}), {kRandomSeed2})};
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {GlobalShuffleDatasetOp::kInputDataset,
+                    GlobalShuffleDatasetOp::kSeed,
+                    GlobalShuffleDatasetOp::kSeed2};
+    return Status::OK();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {{GlobalShuffleDatasetOp::kReshuffleEachIteration,
+                     reshuffle_each_iteration_},
+                    {GlobalShuffleDatasetOp::kOutputTypes, output_dtypes_},
+                    {GlobalShuffleDatasetOp::kOutputShapes, output_shapes_}};
+    return Status::OK();
+  }
+
+  string dataset_type() const override {
+    return GlobalShuffleDatasetOp::kDatasetType;
+  }
+
+ private:
+  bool reshuffle_each_iteration_;
+};
+
+class GlobalShuffleDatasetOpTest : public DatasetOpsTestBase {
+ protected:
+  // Returns the values produced by `iterator`, which must be a scalar int64
+  // dataset.
+  Status GetValues(IteratorBase* iterator, std::vector<int64>* values) {
+    bool end_of_sequence = false;
+    while (true) {
+      std::vector<Tensor> next;
+      TF_RETURN_IF_ERROR(
+          iterator->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+      if (end_of_sequence) {
+        return Status::OK();
+      }
+      values->push_back(next[0].scalar<int64>()());
+    }
+  }
+};
+
+GlobalShuffleDatasetParams RangeParams(int64 stop,
+                                       bool reshuffle_each_iteration) {
+  return GlobalShuffleDatasetParams(
+      RangeDatasetParams(0, stop, 1), reshuffle_each_iteration,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({})},
+      /*node_name=*/kNodeName);
+}
+
+GlobalShuffleDatasetParams NoRandomAccessParams() {
+  return GlobalShuffleDatasetParams(
+      TakeDatasetParams(RangeDatasetParams(0, 10, 1), /*count=*/5,
+                        /*output_dtypes=*/{DT_INT64},
+                        /*output_shapes=*/{PartialTensorShape({})},
+                        /*node_name=*/"take_dataset"),
+      /*reshuffle_each_iteration=*/false,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({})},
+      /*node_name=*/kNodeName);
+}
+
+TEST_F(GlobalShuffleDatasetOpTest, ProducesPermutation) {
+  for (int64 stop : {0, 1, 2, 3, 17, 100, 1000}) {
+    auto dataset_params = RangeParams(stop, /*reshuffle_each_iteration=*/false);
+    TF_ASSERT_OK(Initialize(dataset_params));
+    std::vector<int64> values;
+    TF_ASSERT_OK(GetValues(iterator_.get(), &values));
+    std::vector<int64> expected(stop);
+    std::iota(expected.begin(), expected.end(), 0);
+    if (stop >= 17) {
+      EXPECT_NE(values, expected);
+    }
+    std::sort(values.begin(), values.end());
+    EXPECT_EQ(values, expected);
+  }
+}
+
+TEST_F(GlobalShuffleDatasetOpTest, SameOrderWithoutReshuffle) {
+  auto dataset_params = RangeParams(100, /*reshuffle_each_iteration=*/false);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<int64> first;
+  TF_ASSERT_OK(GetValues(iterator_.get(), &first));
+
+  std::unique_ptr<IteratorBase> iterator;
+  TF_ASSERT_OK(dataset_->MakeIterator(iterator_ctx_.get(), /*parent=*/nullptr,
+                                      dataset_params.iterator_prefix(),
+                                      &iterator));
+  std::vector<int64> second;
+  TF_ASSERT_OK(GetValues(iterator.get(), &second));
+  EXPECT_EQ(first, second);
+}
+
+TEST_F(GlobalShuffleDatasetOpTest, DifferentOrderWithReshuffle) {
+  auto dataset_params = RangeParams(100, /*reshuffle_each_iteration=*/true);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<int64> first;
+  TF_ASSERT_OK(GetValues(iterator_.get(), &first));
+
+  std::unique_ptr<IteratorBase> iterator;
+  TF_ASSERT_OK(dataset_->MakeIterator(iterator_ctx_.get(), /*parent=*/nullptr,
+                                      dataset_params.iterator_prefix(),
+                                      &iterator));
+  std::vector<int64> second;
+  TF_ASSERT_OK(GetValues(iterator.get(), &second));
+  EXPECT_NE(first, second);
+  std::sort(first.begin(), first.end());
+  std::sort(second.begin(), second.end());
+  EXPECT_EQ(first, second);
+}
+
+TEST_F(GlobalShuffleDatasetOpTest, RandomAccessMatchesIteration) {
+  auto dataset_params = RangeParams(50, /*reshuffle_each_iteration=*/false);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<int64> values;
+  TF_ASSERT_OK(GetValues(iterator_.get(), &values));
+  for (int64 i = 0; i < values.size(); ++i) {
+    std::vector<Tensor> element;
+    TF_ASSERT_OK(dataset_->Get(/*ctx=*/nullptr, i, &element));
+    EXPECT_EQ(element[0].scalar<int64>()(), values[i]);
+  }
+  std::vector<Tensor> element;
+  EXPECT_TRUE(
+      errors::IsOutOfRange(dataset_->Get(/*ctx=*/nullptr, 50, &element)));
+}
+
+TEST_F(GlobalShuffleDatasetOpTest, SaveAndRestore) {
+  auto dataset_params = RangeParams(20, /*reshuffle_each_iteration=*/true);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<int64> values;
+  TF_ASSERT_OK(GetValues(iterator_.get(), &values));
+  std::vector<Tensor> expected_outputs;
+  for (int64 value : values) {
+    expected_outputs.push_back(CreateTensor<int64>(TensorShape({}), {value}));
+  }
+  // Each restored iterator is created with fresh seeds, so the elements are
+  // only all produced exactly once if restoring resumes the saved permutation.
+  TF_ASSERT_OK(CheckIteratorSaveAndRestore(
+      name_utils::IteratorPrefix(GlobalShuffleDatasetOp::kDatasetType,
+                                 dataset_params.iterator_prefix()),
+      expected_outputs, /*breakpoints=*/{0, 5, 20}, /*compare_order=*/false));
+}
+
+TEST_F(GlobalShuffleDatasetOpTest, DatasetCardinality) {
+  auto dataset_params = RangeParams(20, /*reshuffle_each_iteration=*/true);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetCardinality(20));
+}
+
+TEST_F(GlobalShuffleDatasetOpTest, InputWithoutRandomAccess) {
+  auto dataset_params = NoRandomAccessParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  bool end_of_sequence = false;
+  std::vector<Tensor> out_tensors;
+  EXPECT_EQ(
+      iterator_->GetNext(iterator_ctx_.get(), &out_tensors, &end_of_sequence)
+          .code(),
+      tensorflow::error::INVALID_ARGUMENT);
+}
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
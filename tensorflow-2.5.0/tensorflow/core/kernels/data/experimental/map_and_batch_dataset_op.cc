@@ -17,6 +17,9 @@ limitations under the License.
 #include <atomic>
 #include <utility>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/match.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/input_colocation_exemption_registry.h"
 #include "tensorflow/core/common_runtime/metrics.h"
@@ -77,8 +80,110 @@ constexpr char kStatus[] = "status";
 // Computes ceil(x / y).
 inline int64 CeilDiv(int64 x, int64 y) { return (x + y - 1) / y; }
 
+// Element-wise ops that cannot fail on well-typed inputs, so that applying
+// them to a batch produces the batch of their per-element outputs.
+bool IsElementwiseUnaryOp(const string& op) {
+  static const auto* const kOps = new absl::flat_hash_set<string>(
+      {"Abs", "Cast", "Ceil", "Cos", "Exp", "Floor", "Identity", "IsFinite",
+       "IsInf", "IsNan", "Log", "Log1p", "LogicalNot", "Neg", "Relu", "Relu6",
+       "Round", "Rsqrt", "Sigmoid", "Sign", "Sin", "Sqrt", "Square", "Tanh"});
+  return kOps->contains(op);
+}
+
+bool IsElementwiseBinaryOp(const string& op) {
+  static const auto* const kOps = new absl::flat_hash_set<string>(
+      {"Add", "AddV2", "Equal", "Greater", "GreaterEqual", "Less", "LessEqual",
+       "LogicalAnd", "LogicalOr", "Maximum", "Minimum", "Mul", "NotEqual",
+       "RealDiv", "SquaredDifference", "Sub"});
+  return kOps->contains(op);
+}
+
 }  // namespace
 
+bool IsBatchPolymorphic(const FunctionDef& fdef,
+                        const std::vector<PartialTensorShape>& input_shapes,
+                        const std::vector<Tensor>& captured_inputs) {
+  struct Value {
+    bool batched;
+    int rank;
+  };
+  const auto& args = fdef.signature().input_arg();
+  if (args.size() != input_shapes.size() + captured_inputs.size()) {
+    return false;
+  }
+  absl::flat_hash_map<string, Value> values;
+  for (int i = 0; i < args.size(); ++i) {
+    if (i < input_shapes.size()) {
+      if (input_shapes[i].unknown_rank()) return false;
+      values[args[i].name()] = {true, input_shapes[i].dims()};
+    } else {
+      values[args[i].name()] = {
+          false, captured_inputs[i - input_shapes.size()].dims()};
+    }
+  }
+  // Resolves a reference to a function argument or to the (single) output of
+  // a node that has already been visited.
+  auto lookup = [&values](const string& input, Value* value) {
+    auto it = values.find(input.substr(0, input.find(':')));
+    if (it == values.end()) return false;
+    *value = it->second;
+    return true;
+  };
+  // Nodes in a `FunctionDef` are not necessarily in topological order, so
+  // keep visiting them until no more progress can be made.
+  std::vector<const NodeDef*> pending;
+  for (const NodeDef& node : fdef.node_def()) {
+    pending.push_back(&node);
+  }
+  while (!pending.empty()) {
+    std::vector<const NodeDef*> next_pending;
+    for (const NodeDef* node : pending) {
+      std::vector<Value> inputs;
+      bool ready = true;
+      for (const string& input : node->input()) {
+        if (absl::StartsWith(input, "^")) continue;
+        Value value;
+        if (!lookup(input, &value)) {
+          ready = false;
+          break;
+        }
+        inputs.push_back(value);
+      }
+      if (!ready) {
+        next_pending.push_back(node);
+        continue;
+      }
+      Value output;
+      if (node->op() == "Const" && inputs.empty()) {
+        auto it = node->attr().find("value");
+        if (it == node->attr().end()) return false;
+        output = {false, it->second.tensor().tensor_shape().dim_size()};
+      } else if (IsElementwiseUnaryOp(node->op()) && inputs.size() == 1) {
+        output = inputs[0];
+      } else if (IsElementwiseBinaryOp(node->op()) && inputs.size() == 2) {
+        const Value& a = inputs[0];
+        const Value& b = inputs[1];
+        if (a.batched && b.batched && a.rank != b.rank) return false;
+        if (a.batched != b.batched &&
+            (a.batched ? b.rank > a.rank : a.rank > b.rank)) {
+          return false;
+        }
+        output = {a.batched || b.batched, std::max(a.rank, b.rank)};
+      } else {
+        return false;
+      }
+      values[node->name()] = output;
+    }
+    if (next_pending.size() == pending.size()) return false;
+    pending = std::move(next_pending);
+  }
+  for (const auto& ret : fdef.ret()) {
+    Value value;
+    if (!lookup(ret.second, &value) || !value.batched) return false;
+  }
+  return true;
+}
+
 class MapAndBatchDatasetOp::Dataset : public DatasetBase {
  public:
   Dataset(OpKernelContext* ctx, const DatasetBase* input, int64 batch_size,
@@ -226,6 +331,17 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
       params.cancellation_manager = cancellation_manager_.get();
       TF_RETURN_IF_ERROR(dataset()->input_->MakeIterator(
           IteratorContext(params), this, prefix(), &input_impl_));
+      const FunctionDef* fdef = dataset()->captured_func_->lib_def()->Find(
+          dataset()->captured_func_->func().name());
+      vectorize_ =
+          fdef != nullptr &&
+          IsBatchPolymorphic(*fdef, dataset()->input_->output_shapes(),
+                             dataset()->captured_func_->captured_inputs());
+      if (vectorize_) {
+        VLOG(2) << "Applying " << dataset()->captured_func_->func().name()
+                << " to batches of " << dataset()->batch_size_
+                << " elements at a time in " << prefix();
+      }
       return dataset()->captured_func_->Instantiate(
           ctx, &instantiated_captured_func_);
     }
@@ -341,13 +457,13 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
     // BatchResult encapsulates the output batch, as well as ancillary
     // metadata required to execute the fused map-and-batch operation.
     struct BatchResult {
-      explicit BatchResult(int64 batch_size)
+      explicit BatchResult(int64 num_calls)
           : end_of_input(false),
             num_elements(0),
             output_allocated(false),
             status(Status::OK()),
             status_offset(-1),
-            num_calls(batch_size),
+            num_calls(num_calls),
             uid(tensorflow::EnvTime::NowNanos()) {}
 
       // UpdateStatus updates the batch's aggregate Status.
@@ -422,14 +538,7 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
       std::shared_ptr<std::vector<Tensor>> return_values =
           std::make_shared<std::vector<Tensor>>();
       auto done = [this, ctx, result, return_values, offset](Status status) {
-        if (dataset()->preserve_cardinality_ && errors::IsOutOfRange(status)) {
-          // To guarantee that the transformation preserves the cardinality of
-          // the dataset, we convert `OutOfRange` to `InvalidArgument` as the
-          // former may be interpreted by a caller as the end of sequence.
-          status = errors::InvalidArgument(
-              "Function invocation produced OutOfRangeError: ",
-              status.error_message());
-        }
+        status = FunctionStatus(status);
         result->UpdateStatus(status, offset);
         if (status.ok()) {
           Status allocate_status =
@@ -479,6 +588,86 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
                                             std::move(done), model_node());
     }
 
+    // Applies the map function once to a batch of up to `batch_size_` input
+    // elements. Only used when the function is batch-polymorphic, in which
+    // case this is equivalent to calling it on each element and batching the
+    // results.
+    void CallBatchFunction(std::shared_ptr<IteratorContext> ctx,
+                           const std::shared_ptr<BatchResult>& result)
+        TF_LOCKS_EXCLUDED(*mu_) {
+      profiler::TraceMe traceme([&] {
+        return profiler::TraceMeEncode("MapAndBatchProduce",
+                                       {{"element_id", result->uid}});
+      });
+      std::vector<std::vector<Tensor>> input_elements;
+      input_elements.reserve(dataset()->batch_size_);
+      bool end_of_input = false;
+      Status status;
+      while (input_elements.size() < dataset()->batch_size_) {
+        std::vector<Tensor> input_element;
+        status = input_impl_->GetNext(ctx.get(), &input_element, &end_of_input);
+        if (!status.ok() || end_of_input) break;
+        input_elements.push_back(std::move(input_element));
+      }
+      const int64 num_elements = input_elements.size();
+      std::vector<Tensor> batched_input;
+      if (status.ok() && num_elements > 0) {
+        status = CopyBatch(/*parallel_copy=*/false, ctx.get(), &batched_input,
+                           &input_elements);
+      }
+      bool return_early;
+      {
+        mutex_lock l(result->mu);
+        result->end_of_input = end_of_input;
+        result->status.Update(status);
+        return_early = num_elements == 0 || !result->status.ok();
+      }
+      if (return_early) {
+        CallCompleted(ctx, result);
+        return;
+      }
+
+      std::shared_ptr<std::vector<Tensor>> return_values =
+          std::make_shared<std::vector<Tensor>>();
+      auto done = [this, ctx, result, return_values,
+                   num_elements](Status status) {
+        status = FunctionStatus(status);
+        for (size_t i = 0; status.ok() && i < return_values->size(); ++i) {
+          const Tensor& tensor = return_values->at(i);
+          if (tensor.dims() == 0 || tensor.dim_size(0) != num_elements) {
+            status = errors::Internal(
+                "Batched function invocation produced a component of shape ",
+                tensor.shape().DebugString(), " for a batch of ", num_elements,
+                " elements.");
+          }
+        }
+        result->UpdateStatus(status, /*offset=*/0);
+        if (status.ok()) {
+          mutex_lock l(result->mu);
+          result->output = std::move(*return_values);
+          result->output_allocated = true;
+          result->num_elements = num_elements;
+          RecordBufferEnqueue(ctx.get(), result->output);
+        }
+        CallCompleted(ctx, result);
+      };
+      instantiated_captured_func_->RunAsync(ctx.get(), std::move(batched_input),
+                                            return_values.get(),
+                                            std::move(done), model_node());
+    }
+
+    Status FunctionStatus(const Status& status) const {
+      if (dataset()->preserve_cardinality_ && errors::IsOutOfRange(status)) {
+        // To guarantee that the transformation preserves the cardinality of
+        // the dataset, we convert `OutOfRange` to `InvalidArgument` as the
+        // former may be interpreted by a caller as the end of sequence.
+        return errors::InvalidArgument(
+            "Function invocation produced OutOfRangeError: ",
+            status.error_message());
+      }
+      return status;
+    }
+
     void CancelThreads(bool wait) TF_LOCKS_EXCLUDED(mu_) {
       cancellation_manager_->StartCancel();
       mutex_lock l(*mu_);
@@ -568,6 +757,15 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
           }
 
           while (!busy()) {
+            if (vectorize_) {
+              // A single call produces the whole batch.
+              batch_results_.push_back(
+                  std::make_shared<BatchResult>(/*num_calls=*/1));
+              new_calls.emplace_back(batch_results_.back(), 0);
+              call_counter_ += dataset()->batch_size_;
+              num_calls_++;
+              continue;
+            }
             if (call_counter_ % dataset()->batch_size_ == 0) {
               batch_results_.push_back(
                   std::make_shared<BatchResult>(dataset()->batch_size_));
@@ -587,7 +785,11 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
               num_elements());
         }
         for (const auto& call : new_calls) {
-          CallFunction(ctx, call.first, call.second);
+          if (vectorize_) {
+            CallBatchFunction(ctx, call.first);
+          } else {
+            CallFunction(ctx, call.first, call.second);
+          }
         }
         new_calls.clear();
       }
@@ -681,6 +883,9 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
     // Identifies the maximum number of batch results to store.
     int64 max_batch_results_ TF_GUARDED_BY(*mu_);
     std::unique_ptr<InstantiatedCapturedFunction> instantiated_captured_func_;
+    // Whether the map function is applied to whole batches rather than to
+    // individual elements. Set in `Initialize()`.
+    bool vectorize_ = false;
 
     // Method for deregistering the cancellation callback.
     std::function<void()> deregister_fn_;
@@ -15,6 +15,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_MAP_AND_BATCH_DATASET_OP_H_
 #define TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_MAP_AND_BATCH_DATASET_OP_H_
 
+#include <vector>
+
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/kernels/data/captured_function.h"
 
@@ -25,6 +27,20 @@ namespace experimental {
 // See documentation in ../../ops/experimental_dataset_ops.cc for a high-level
 // description of the following op.
 
+// Returns whether `fdef`, applied to a batch of elements with the given
+// per-element `input_shapes` (and the unbatched `captured_inputs`), produces
+// the batch of its per-element outputs. If so, the iterator of
+// `MapAndBatchDatasetOp` applies `fdef` to whole batches at a time.
+//
+// This holds if the function body consists only of element-wise ops, and if
+// broadcasting a batched operand against another operand gives the same
+// result as broadcasting each of its elements; the latter is the case when
+// both operands are batched and have the same rank, or when the unbatched
+// operand has at most the rank of the (unbatched) element.
+bool IsBatchPolymorphic(const FunctionDef& fdef,
+                        const std::vector<PartialTensorShape>& input_shapes,
+                        const std::vector<Tensor>& captured_inputs);
+
 class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
  public:
   static constexpr const char* const kDatasetType = "MapAndBatch";
@@ -225,6 +225,40 @@ MapAndBatchDatasetParams InvalidNumParallelCallsMapAndBatchDatasetParams() {
       /*node_name=*/kNodeName);
 }
 
+// `XTimesTwo` is element-wise, so it is applied to whole batches at a time.
+MapAndBatchDatasetParams LargeBatchMapAndBatchDatasetParams() {
+  return MapAndBatchDatasetParams(RangeDatasetParams(0, 100, 1),
+                                  /*other_arguments=*/{},
+                                  /*batch_size=*/32,
+                                  /*num_parallel_calls=*/4,
+                                  /*drop_remainder=*/false,
+                                  /*func=*/MapFunc("XTimesTwo", DT_INT64),
+                                  /*func_lib=*/{test::function::XTimesTwo()},
+                                  /*type_arguments*/ {},
+                                  /*preserve_cardinality=*/true,
+                                  /*output_dtypes=*/{DT_INT64},
+                                  /*output_shapes=*/{PartialTensorShape({-1})},
+                                  /*node_name=*/kNodeName);
+}
+
+// `XTimesFour` calls `XTimesTwo`, which is not an element-wise op, so it is
+// applied to one element at a time.
+MapAndBatchDatasetParams LargeBatchPerElementMapAndBatchDatasetParams() {
+  return MapAndBatchDatasetParams(
+      RangeDatasetParams(0, 100, 1),
+      /*other_arguments=*/{},
+      /*batch_size=*/32,
+      /*num_parallel_calls=*/4,
+      /*drop_remainder=*/false,
+      /*func=*/MapFunc("XTimesFour", DT_INT64),
+      /*func_lib=*/{test::function::XTimesTwo(), test::function::XTimesFour()},
+      /*type_arguments*/ {},
+      /*preserve_cardinality=*/true,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1})},
+      /*node_name=*/kNodeName);
+}
+
 MapAndBatchDatasetParams InvalidBatchSizeMapAndBatchDatasetParams() {
   return MapAndBatchDatasetParams(
       RangeDatasetParams(0, 10, 2),
@@ -407,6 +441,40 @@ ITERATOR_SAVE_AND_RESTORE_TEST_P(MapAndBatchDatasetOpTest,
                                  MapAndBatchDatasetParams,
                                  IteratorSaveAndRestoreTestCases())
 
+// Returns the batches of 32 elements of `factor * i` for i in [0, 100).
+std::vector<Tensor> LargeBatchOutputs(int64 factor) {
+  std::vector<Tensor> outputs;
+  for (int64 start = 0; start < 100; start += 32) {
+    std::vector<int64> values;
+    for (int64 i = start; i < std::min<int64>(start + 32, 100); ++i) {
+      values.push_back(factor * i);
+    }
+    outputs.push_back(CreateTensor<int64>(
+        TensorShape({static_cast<int64>(values.size())}), values));
+  }
+  return outputs;
+}
+
+TEST_F(MapAndBatchDatasetOpTest, LargeBatches) {
+  auto dataset_params = LargeBatchMapAndBatchDatasetParams();
+  EXPECT_TRUE(IsBatchPolymorphic(test::function::XTimesTwo(),
+                                 /*input_shapes=*/{PartialTensorShape({})},
+                                 /*captured_inputs=*/{}));
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckIteratorGetNext(LargeBatchOutputs(/*factor=*/2),
+                                    /*compare_order=*/true));
+}
+
+TEST_F(MapAndBatchDatasetOpTest, LargeBatchesPerElement) {
+  auto dataset_params = LargeBatchPerElementMapAndBatchDatasetParams();
+  EXPECT_FALSE(IsBatchPolymorphic(test::function::XTimesFour(),
+                                  /*input_shapes=*/{PartialTensorShape({})},
+                                  /*captured_inputs=*/{}));
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckIteratorGetNext(LargeBatchOutputs(/*factor=*/4),
+                                    /*compare_order=*/true));
+}
+
 TEST_F(MapAndBatchDatasetOpTest, InvalidBatchSize) {
   auto dataset_params = InvalidBatchSizeMapAndBatchDatasetParams();
   EXPECT_EQ(Initialize(dataset_params).code(),
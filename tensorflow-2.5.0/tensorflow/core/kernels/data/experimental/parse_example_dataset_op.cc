@@ -641,13 +641,15 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
                           std::vector<Tensor>* output) {
         thread::ThreadPool* device_threadpool =
             ctx->flr()->device()->tensorflow_cpu_worker_threads()->workers;
-        std::vector<tstring> slice_vec;
+        // The serialized examples are parsed in place, from views into the
+        // input tensors.
+        std::vector<StringPiece> slice_vec;
         for (const Tensor& t : input) {
           auto serialized_t = t.flat<tstring>();
-          gtl::ArraySlice<tstring> slice(serialized_t.data(),
-                                         serialized_t.size());
-          for (auto it = slice.begin(); it != slice.end(); it++)
-            slice_vec.push_back(*it);
+          for (int64 i = 0; i < serialized_t.size(); ++i) {
+            slice_vec.emplace_back(serialized_t(i).data(),
+                                   serialized_t(i).size());
+          }
         }
         example::FastParseExampleConfig config = dataset()->config_;
         // local copy of config_ for modification.
@@ -83,6 +83,7 @@ namespace experimental {
 /* static */ constexpr const char* const
     SnapshotDatasetV2Op::kShardFuncTarguments;
 /* static */ constexpr const int SnapshotDatasetV2Op::kFileFormatVersion;
+/* static */ constexpr const int SnapshotDatasetV2Op::kGzipFileFormatVersion;
 
 // ==== Snapshot Implementation ====
 
@@ -151,6 +152,8 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
   const std::string compression_;
   const std::string reader_prefix_;
   const std::string writer_prefix_;
+  // The file format version of newly written snapshots.
+  const int version_;
 
   std::unique_ptr<CapturedFunction> reader_func_;
   std::unique_ptr<CapturedFunction> shard_func_;
@@ -315,6 +318,8 @@ SnapshotDatasetV2Op::Dataset::Dataset(
       compression_(compression),
       reader_prefix_(reader_prefix),
       writer_prefix_(writer_prefix),
+      version_(compression == io::compression::kGzip ? kGzipFileFormatVersion
+                                                     : kFileFormatVersion),
       reader_func_(std::move(reader_func)),
       shard_func_(std::move(shard_func)) {
   input_->Ref();
@@ -651,7 +656,7 @@ Status SnapshotDatasetV2Op::Dataset::Iterator::Writer::WriteMetadataFile(
   metadata.set_creation_timestamp(EnvTime::NowMicros());
   metadata.set_graph_hash(strings::StrCat(dataset()->hash_));
   metadata.set_run_id(strings::StrCat(run_id_));
-  metadata.set_version(kFileFormatVersion);
+  metadata.set_version(dataset()->version_);
   for (const auto& output_dtype : dataset()->output_dtypes()) {
     metadata.add_dtype(output_dtype);
   }
@@ -749,7 +754,7 @@ Status SnapshotDatasetV2Op::Dataset::Iterator::Writer::GetNextInternal(
           snapshot_util::ShardDirectory(run_dir_, shard_index);
       auto writer = std::make_unique<snapshot_util::AsyncWriter>(
           ctx->env(), shard_index, snapshot_shard_directory,
-          current_checkpoint_id_, dataset()->compression_, kFileFormatVersion,
+          current_checkpoint_id_, dataset()->compression_, dataset()->version_,
           dataset()->output_dtypes(), [this](Status s) {
             if (!s.ok()) {
               LOG(ERROR) << "AsyncWriter in snapshot writer failed: " << s;
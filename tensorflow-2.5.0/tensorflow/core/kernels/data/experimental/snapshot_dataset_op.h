@@ -68,7 +68,10 @@ class SnapshotDatasetV2Op : public UnaryDatasetOpKernel {
                    DatasetBase** output) override;
 
  private:
-  static constexpr const int kFileFormatVersion = 2;
+  static constexpr const int kFileFormatVersion = 3;
+  // Version 3 files are either uncompressed or snappy compressed, so GZIP
+  // snapshots are written in the version 2 format.
+  static constexpr const int kGzipFileFormatVersion = 2;
 
   class Dataset;
 
@@ -15,10 +15,13 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/data/experimental/snapshot_util.h"
 
+#include <algorithm>
 #include <queue>
 
 #include "absl/memory/memory.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/tensor.pb.h"
@@ -32,11 +35,16 @@ limitations under the License.
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
 #include "tensorflow/core/lib/io/zlib_outputbuffer.h"
 #include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/platform/snappy.h"
 #include "tensorflow/core/platform/stringprintf.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/protobuf/snapshot.pb.h"
 
@@ -48,6 +56,62 @@ namespace snapshot_util {
     CustomReader::kSnappyReaderInputBufferSizeBytes;
 /* static */ constexpr const int64
     CustomReader::kSnappyReaderOutputBufferSizeBytes;
+/* static */ constexpr const int64 BlockWriter::kTargetBlockSizeBytes;
+/* static */ constexpr const uint64 BlockWriter::kMagic;
+/* static */ constexpr const size_t BlockWriter::kFooterSize;
+/* static */ constexpr const int BlockReader::kNumParallelDecodes;
+
+namespace {
+
+constexpr uint64 kBlockAlignment = Allocator::kAllocatorAlignment;
+
+uint64 AlignUp(uint64 offset) {
+  return (offset + kBlockAlignment - 1) / kBlockAlignment * kBlockAlignment;
+}
+
+// A TensorBuffer aliasing part of a block. The block stays alive for as long
+// as any tensor refers to it.
+class BlockTensorBuffer : public TensorBuffer {
+ public:
+  BlockTensorBuffer(std::shared_ptr<const char> block, const char* data,
+                    size_t size)
+      : TensorBuffer(const_cast<char*>(data)),
+        block_(std::move(block)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+
+  TensorBuffer* root_buffer() override { return this; }
+
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(static_cast<int64>(size_));
+    proto->set_allocator_name("snapshot_block");
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+
+  // Blocks may be read-only mappings, so ops must not forward the buffer to an
+  // output and write to it in place.
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<const char> block_;
+  const size_t size_;
+};
+
+std::shared_ptr<char> AllocateBlock(size_t size) {
+  return std::shared_ptr<char>(
+      static_cast<char*>(port::AlignedMalloc(std::max<size_t>(size, 1),
+                                             kBlockAlignment)),
+      port::AlignedFree);
+}
+
+thread::ThreadPool* BlockDecodeThreadPool() {
+  static thread::ThreadPool* pool = new thread::ThreadPool(
+      Env::Default(), "snapshot_block_decode", port::MaxParallelism());
+  return pool;
+}
+
+}  // namespace
 
 std::string HashDirectory(const std::string& path, uint64 hash) {
   return io::JoinPath(
@@ -92,6 +156,10 @@ Status Writer::Create(Env* env, const std::string& filename,
       *out_writer =
           absl::make_unique<TFRecordWriter>(filename, compression_type);
       break;
+    case 3:
+      *out_writer =
+          absl::make_unique<BlockWriter>(filename, compression_type, dtypes);
+      break;
     default:
       return errors::InvalidArgument("Snapshot writer version: ", version,
                                      " is not supported.");
@@ -318,6 +386,115 @@ Status CustomWriter::WriteRecord(const absl::Cord& data) {
 }
 #endif  // TF_CORD_SUPPORT
 
+BlockWriter::BlockWriter(const std::string& filename,
+                         const std::string& compression_type,
+                         const DataTypeVector& dtypes)
+    : filename_(filename),
+      compression_type_(compression_type),
+      dtypes_(dtypes),
+      index_(absl::make_unique<experimental::SnapshotFileIndex>()) {}
+
+Status BlockWriter::Initialize(tensorflow::Env* env) {
+  if (compression_type_ != io::compression::kNone &&
+      compression_type_ != io::compression::kSnappy) {
+    return errors::InvalidArgument("Compression ", compression_type_,
+                                   " is not supported by snapshot version 3.");
+  }
+  return env->NewWritableFile(filename_, &dest_);
+}
+
+Status BlockWriter::WriteTensors(const std::vector<Tensor>& tensors) {
+  if (!block_started_) {
+    index_->add_block();
+    block_started_ = true;
+  }
+  experimental::SnapshotTensorMetadata* element =
+      index_->mutable_block(index_->block_size() - 1)->add_element();
+  for (const auto& tensor : tensors) {
+    experimental::TensorMetadata* tensor_metadata =
+        element->add_tensor_metadata();
+    tensor.shape().AsProto(tensor_metadata->mutable_tensor_shape());
+    block_.resize(AlignUp(block_.size()), '\0');
+    const size_t start = block_.size();
+    if (DataTypeCanUseMemcpy(tensor.dtype())) {
+      StringPiece data = tensor.tensor_data();
+      block_.append(data.data(), data.size());
+    } else {
+      TensorProto proto;
+      tensor.AsProtoTensorContent(&proto);
+      proto.AppendToString(&block_);
+    }
+    tensor_metadata->set_tensor_size_bytes(block_.size() - start);
+  }
+  if (block_.size() >= kTargetBlockSizeBytes) {
+    return FlushBlock();
+  }
+  return Status::OK();
+}
+
+Status BlockWriter::FlushBlock() {
+  if (!block_started_) {
+    return Status::OK();
+  }
+  TF_RETURN_IF_ERROR(Pad());
+  experimental::SnapshotBlockMetadata* block =
+      index_->mutable_block(index_->block_size() - 1);
+  block->set_offset(offset_);
+  block->set_uncompressed_size_bytes(block_.size());
+  if (compression_type_ == io::compression::kSnappy) {
+    std::string compressed;
+    if (!port::Snappy_Compress(block_.data(), block_.size(), &compressed)) {
+      return errors::Internal("Failed to compress using snappy.");
+    }
+    block->set_stored_size_bytes(compressed.size());
+    TF_RETURN_IF_ERROR(Append(compressed));
+  } else {
+    block->set_stored_size_bytes(block_.size());
+    TF_RETURN_IF_ERROR(Append(block_));
+  }
+  block_.clear();
+  block_started_ = false;
+  return Status::OK();
+}
+
+Status BlockWriter::Append(StringPiece data) {
+  TF_RETURN_IF_ERROR(dest_->Append(data));
+  offset_ += data.size();
+  return Status::OK();
+}
+
+Status BlockWriter::Pad() {
+  static const char kZeros[kBlockAlignment] = {0};
+  return Append(StringPiece(kZeros, AlignUp(offset_) - offset_));
+}
+
+Status BlockWriter::Sync() {
+  TF_RETURN_IF_ERROR(FlushBlock());
+  return dest_->Sync();
+}
+
+Status BlockWriter::Close() {
+  if (dest_ != nullptr) {
+    TF_RETURN_IF_ERROR(FlushBlock());
+    const uint64 index_offset = offset_;
+    TF_RETURN_IF_ERROR(Append(index_->SerializeAsString()));
+    char footer[kFooterSize];
+    core::EncodeFixed64(footer, index_offset);
+    core::EncodeFixed64(footer + sizeof(uint64), kMagic);
+    TF_RETURN_IF_ERROR(Append(StringPiece(footer, sizeof(footer))));
+    TF_RETURN_IF_ERROR(dest_->Close());
+    dest_ = nullptr;
+  }
+  return Status::OK();
+}
+
+BlockWriter::~BlockWriter() {
+  Status s = Close();
+  if (!s.ok()) {
+    LOG(ERROR) << "Failed to close snapshot file " << filename_ << ": " << s;
+  }
+}
+
 Status Reader::Create(Env* env, const std::string& filename,
                       const string& compression_type, int version,
                       const DataTypeVector& dtypes,
@@ -335,6 +512,10 @@ Status Reader::Create(Env* env, const std::string& filename,
       *out_reader =
           absl::make_unique<TFRecordReader>(filename, compression_type, dtypes);
       break;
+    case 3:
+      *out_reader =
+          absl::make_unique<BlockReader>(filename, compression_type, dtypes);
+      break;
     default:
       return errors::InvalidArgument("Snapshot reader version: ", version,
                                      " is not supported.");
@@ -848,6 +1029,258 @@ Status CustomReader::ReadRecord(absl::Cord* record) {
 }
 #endif  // TF_CORD_SUPPORT
 
+// The contents of a snapshot file, either memory-mapped or read on demand.
+struct BlockReader::Source {
+  std::shared_ptr<const ReadOnlyMemoryRegion> region;
+  std::unique_ptr<RandomAccessFile> file;
+  uint64 size = 0;
+
+  // Returns `n` bytes starting at `offset`, aligned to `kBlockAlignment`.
+  // Mapped files are not copied.
+  Status Read(uint64 offset, uint64 n, std::shared_ptr<const char>* out) const {
+    if (offset > size || n > size - offset) {
+      return errors::DataLoss("Snapshot file is truncated: needed ", n,
+                              " bytes at offset ", offset, " but the size is ",
+                              size);
+    }
+    if (region) {
+      *out = std::shared_ptr<const char>(
+          region, static_cast<const char*>(region->data()) + offset);
+      return Status::OK();
+    }
+    std::shared_ptr<char> buffer = AllocateBlock(n);
+    StringPiece result;
+    TF_RETURN_IF_ERROR(file->Read(offset, n, &result, buffer.get()));
+    if (result.size() != n) {
+      return errors::DataLoss("Snapshot file is truncated: needed ", n,
+                              " bytes at offset ", offset, " but read ",
+                              result.size());
+    }
+    if (result.data() != buffer.get()) {
+      memcpy(buffer.get(), result.data(), n);
+    }
+    *out = std::move(buffer);
+    return Status::OK();
+  }
+};
+
+struct BlockReader::DecodedBlock {
+  Notification decoded;
+  Status status;
+  std::vector<std::vector<Tensor>> elements;
+};
+
+/* static */
+Status BlockReader::DecodeBlock(
+    const Source& source, const experimental::SnapshotBlockMetadata& metadata,
+    const string& compression_type, const DataTypeVector& dtypes,
+    std::vector<std::vector<Tensor>>* elements) {
+  std::shared_ptr<const char> block;
+  TF_RETURN_IF_ERROR(
+      source.Read(metadata.offset(), metadata.stored_size_bytes(), &block));
+  const uint64 size = metadata.uncompressed_size_bytes();
+  if (compression_type == io::compression::kSnappy) {
+    size_t uncompressed_size;
+    if (!port::Snappy_GetUncompressedLength(
+            block.get(), metadata.stored_size_bytes(), &uncompressed_size) ||
+        uncompressed_size != size) {
+      return errors::DataLoss("Snapshot block at offset ", metadata.offset(),
+                              " is corrupted.");
+    }
+    std::shared_ptr<char> uncompressed = AllocateBlock(size);
+    if (!port::Snappy_Uncompress(block.get(), metadata.stored_size_bytes(),
+                                 uncompressed.get())) {
+      return errors::Internal("Failed to perform snappy decompression.");
+    }
+    block = std::move(uncompressed);
+  } else if (metadata.stored_size_bytes() != size) {
+    return errors::DataLoss("Snapshot block at offset ", metadata.offset(),
+                            " has size ", metadata.stored_size_bytes(),
+                            " but expected ", size);
+  }
+
+  elements->reserve(metadata.element_size());
+  uint64 offset = 0;
+  for (const auto& element : metadata.element()) {
+    if (element.tensor_metadata_size() != dtypes.size()) {
+      return errors::DataLoss("Expected ", dtypes.size(),
+                              " tensors per element but found ",
+                              element.tensor_metadata_size());
+    }
+    elements->emplace_back();
+    std::vector<Tensor>& tensors = elements->back();
+    tensors.reserve(dtypes.size());
+    for (int i = 0; i < dtypes.size(); ++i) {
+      const auto& tensor_metadata = element.tensor_metadata(i);
+      offset = AlignUp(offset);
+      const uint64 tensor_size = tensor_metadata.tensor_size_bytes();
+      if (offset + tensor_size > size) {
+        return errors::DataLoss("Snapshot block at offset ", metadata.offset(),
+                                " is truncated.");
+      }
+      const char* data = block.get() + offset;
+      offset += tensor_size;
+      if (DataTypeCanUseMemcpy(dtypes[i])) {
+        TensorShape shape(tensor_metadata.tensor_shape());
+        if (shape.num_elements() * DataTypeSize(dtypes[i]) != tensor_size) {
+          return errors::DataLoss("Tensor of shape ", shape.DebugString(),
+                                  " has ", tensor_size, " bytes.");
+        }
+        if (tensor_size == 0) {
+          tensors.emplace_back(dtypes[i], shape);
+          continue;
+        }
+        auto* buffer = new BlockTensorBuffer(block, data, tensor_size);
+        tensors.emplace_back(dtypes[i], shape, buffer);
+        buffer->Unref();
+      } else {
+        TensorProto proto;
+        if (!proto.ParseFromArray(data, tensor_size)) {
+          return errors::DataLoss("Unable to parse tensor from stored proto.");
+        }
+        tensors.emplace_back();
+        if (!tensors.back().FromProto(proto)) {
+          return errors::DataLoss("Unable to parse tensor from stored proto.");
+        }
+      }
+    }
+  }
+  return Status::OK();
+}
+
+BlockReader::BlockReader(const std::string& filename,
+                         const string& compression_type,
+                         const DataTypeVector& dtypes)
+    : filename_(filename),
+      compression_type_(compression_type),
+      dtypes_(dtypes) {}
+
+BlockReader::~BlockReader() {
+  // Pending decodes own everything they use, so they are left to finish in the
+  // background.
+}
+
+Status BlockReader::Initialize(Env* env) {
+  auto source = std::make_shared<Source>();
+  std::unique_ptr<ReadOnlyMemoryRegion> region;
+  Status s = env->NewReadOnlyMemoryRegionFromFile(filename_, &region);
+  if (s.ok()) {
+    source->size = region->length();
+    source->region = std::move(region);
+  } else {
+    VLOG(2) << "Could not memory-map snapshot file " << filename_ << ": " << s
+            << ". Reading it instead.";
+    TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename_, &source->file));
+    TF_RETURN_IF_ERROR(env->GetFileSize(filename_, &source->size));
+  }
+  if (source->size < BlockWriter::kFooterSize) {
+    return errors::DataLoss("Snapshot file ", filename_, " is truncated.");
+  }
+
+  std::shared_ptr<const char> footer;
+  TF_RETURN_IF_ERROR(source->Read(source->size - BlockWriter::kFooterSize,
+                                  BlockWriter::kFooterSize, &footer));
+  const uint64 index_offset = core::DecodeFixed64(footer.get());
+  if (core::DecodeFixed64(footer.get() + sizeof(uint64)) !=
+          BlockWriter::kMagic ||
+      index_offset > source->size - BlockWriter::kFooterSize) {
+    return errors::DataLoss("Snapshot file ", filename_,
+                            " is not a version 3 snapshot file.");
+  }
+  const uint64 index_size =
+      source->size - BlockWriter::kFooterSize - index_offset;
+  std::shared_ptr<const char> index_data;
+  TF_RETURN_IF_ERROR(source->Read(index_offset, index_size, &index_data));
+  auto index = std::make_shared<experimental::SnapshotFileIndex>();
+  if (!index->ParseFromArray(index_data.get(), index_size)) {
+    return errors::DataLoss("Could not parse the index of snapshot file ",
+                            filename_);
+  }
+  source_ = std::move(source);
+  index_ = std::move(index);
+  return Status::OK();
+}
+
+int64 BlockReader::NumBlocks() const { return index_->block_size(); }
+
+void BlockReader::ScheduleDecodes() {
+  while (pending_.size() < kNumParallelDecodes &&
+         next_block_ + static_cast<int64>(pending_.size()) < NumBlocks()) {
+    const int64 block_index = next_block_ + pending_.size();
+    auto decoded = std::make_shared<DecodedBlock>();
+    pending_.push_back(decoded);
+    BlockDecodeThreadPool()->Schedule(
+        [source = source_, index = index_, block_index,
+         compression_type = compression_type_, dtypes = dtypes_, decoded]() {
+          profiler::TraceMe activity("snapshot_util::BlockReader::DecodeBlock",
+                                     profiler::TraceMeLevel::kInfo);
+          decoded->status =
+              DecodeBlock(*source, index->block(block_index), compression_type,
+                          dtypes, &decoded->elements);
+          decoded->decoded.Notify();
+        });
+  }
+}
+
+Status BlockReader::NextBlock() {
+  if (next_block_ >= NumBlocks()) {
+    return errors::OutOfRange("No more blocks in snapshot file ", filename_);
+  }
+  ScheduleDecodes();
+  current_ = std::move(pending_.front());
+  pending_.pop_front();
+  ++next_block_;
+  current_element_ = 0;
+  // Keep the decode pipeline full while the consumer waits.
+  ScheduleDecodes();
+  current_->decoded.WaitForNotification();
+  return current_->status;
+}
+
+Status BlockReader::ReadTensors(std::vector<Tensor>* read_tensors) {
+  while (!current_ ||
+         current_element_ >= static_cast<int64>(current_->elements.size())) {
+    TF_RETURN_IF_ERROR(NextBlock());
+  }
+  std::vector<Tensor>& element = current_->elements[current_element_++];
+  read_tensors->reserve(read_tensors->size() + element.size());
+  for (auto& tensor : element) {
+    read_tensors->push_back(std::move(tensor));
+  }
+  return Status::OK();
+}
+
+Status BlockReader::SkipRecords(int64 num_records) {
+  while (num_records > 0) {
+    if (current_) {
+      const int64 num_skipped = std::min(
+          num_records,
+          static_cast<int64>(current_->elements.size()) - current_element_);
+      current_element_ += num_skipped;
+      num_records -= num_skipped;
+      if (num_records == 0) {
+        break;
+      }
+      current_.reset();
+    }
+    if (next_block_ >= NumBlocks()) {
+      return errors::OutOfRange("No more blocks in snapshot file ", filename_);
+    }
+    const int64 block_size = index_->block(next_block_).element_size();
+    if (num_records >= block_size) {
+      // Skip the whole block without waiting for it to be decoded.
+      if (!pending_.empty()) {
+        pending_.pop_front();
+      }
+      ++next_block_;
+      num_records -= block_size;
+      continue;
+    }
+    TF_RETURN_IF_ERROR(NextBlock());
+  }
+  return Status::OK();
+}
+
 Status WriteMetadataFile(Env* env, const string& dir,
                          const experimental::SnapshotMetadataRecord* metadata) {
   string metadata_filename = io::JoinPath(dir, kMetadataFilename);
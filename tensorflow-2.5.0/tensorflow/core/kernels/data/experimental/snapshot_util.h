@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_SNAPSHOT_UTIL_H_
 #define TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_SNAPSHOT_UTIL_H_
 
+#include <deque>
+
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
@@ -36,6 +38,8 @@ namespace data {
 
 namespace experimental {
 
+class SnapshotBlockMetadata;
+class SnapshotFileIndex;
 class SnapshotMetadataRecord;
 class SnapshotTensorMetadata;
 
@@ -163,6 +167,54 @@ class CustomWriter : public Writer {
   int num_complex_ = 0;
 };
 
+// Writes snapshots with the block file format (version 3).
+//
+// Elements are grouped into blocks of about `kTargetBlockSizeBytes`
+// uncompressed bytes. Within a block, every tensor starts at an offset aligned
+// to `Allocator::kAllocatorAlignment`, so that readers can use the contents of
+// tensors in place. Blocks are stored either uncompressed or snappy
+// compressed, each at an aligned file offset. Closing the writer appends an
+// index of the blocks and a footer:
+//
+//   block_0 ... block_n | SnapshotFileIndex | index offset | magic
+class BlockWriter : public Writer {
+ public:
+  static constexpr const int64 kTargetBlockSizeBytes = 16 << 20;  // 16 MiB
+  static constexpr const uint64 kMagic = 0x7f5f4b434f4c4233ULL;
+  static constexpr const size_t kFooterSize = 2 * sizeof(uint64);
+
+  BlockWriter(const std::string& filename, const std::string& compression_type,
+              const DataTypeVector& dtypes);
+
+  Status WriteTensors(const std::vector<Tensor>& tensors) override;
+
+  // Writes out the current block, even if it is not full yet.
+  Status Sync() override;
+
+  Status Close() override;
+
+  ~BlockWriter() override;
+
+ protected:
+  Status Initialize(tensorflow::Env* env) override;
+
+ private:
+  Status FlushBlock();
+  Status Append(StringPiece data);
+  Status Pad();
+
+  const std::string filename_;
+  const std::string compression_type_;
+  const DataTypeVector dtypes_;
+
+  std::unique_ptr<WritableFile> dest_;
+  uint64 offset_ = 0;
+  std::unique_ptr<experimental::SnapshotFileIndex> index_;
+  // Uncompressed contents of the block being built, if any.
+  std::string block_;
+  bool block_started_ = false;
+};
+
 // Interface class for reading snapshot files previous written with Writer.
 class Reader {
  public:
@@ -280,6 +332,58 @@ class CustomReader : public Reader {
   std::vector<bool> simple_tensor_mask_;  // true for simple, false for complex.
 };
 
+// Reads snapshots previously written with `BlockWriter`.
+//
+// If the file system supports it, the file is memory-mapped and tensors of
+// uncompressed blocks alias the mapping instead of being copied. Up to
+// `kNumParallelDecodes` blocks are read and decoded ahead of the consumer on a
+// thread pool shared by all readers, while elements are still produced in
+// order. Skipped blocks are not decoded at all.
+class BlockReader : public Reader {
+ public:
+  static constexpr const int kNumParallelDecodes = 4;
+
+  BlockReader(const std::string& filename, const string& compression_type,
+              const DataTypeVector& dtypes);
+
+  Status ReadTensors(std::vector<Tensor>* read_tensors) override;
+
+  Status SkipRecords(int64 num_records) override;
+
+  ~BlockReader() override;
+
+ protected:
+  Status Initialize(Env* env) override;
+
+ private:
+  struct Source;
+  struct DecodedBlock;
+
+  // Starts decoding blocks until `kNumParallelDecodes` are in flight.
+  void ScheduleDecodes();
+  // Waits for the next block and makes it the current block.
+  Status NextBlock();
+  int64 NumBlocks() const;
+
+  static Status DecodeBlock(const Source& source,
+                            const experimental::SnapshotBlockMetadata& metadata,
+                            const string& compression_type,
+                            const DataTypeVector& dtypes,
+                            std::vector<std::vector<Tensor>>* elements);
+
+  const std::string filename_;
+  const string compression_type_;
+  const DataTypeVector dtypes_;
+
+  std::shared_ptr<const Source> source_;
+  std::shared_ptr<const experimental::SnapshotFileIndex> index_;
+  // Blocks in [next_block_, next_block_ + pending_.size()) are being decoded.
+  std::deque<std::shared_ptr<DecodedBlock>> pending_;
+  int64 next_block_ = 0;
+  std::shared_ptr<DecodedBlock> current_;
+  int64 current_element_ = 0;
+};
+
 // Writes snapshot metadata to the given directory.
 Status WriteMetadataFile(Env* env, const string& dir,
                          const experimental::SnapshotMetadataRecord* metadata);
@@ -89,6 +89,46 @@ TEST(SnapshotUtilTest, CombinationRoundTripTest) {
   SnapshotRoundTrip(io::compression::kNone, 2);
   SnapshotRoundTrip(io::compression::kGzip, 2);
   SnapshotRoundTrip(io::compression::kSnappy, 2);
+
+  SnapshotRoundTrip(io::compression::kNone, 3);
+  SnapshotRoundTrip(io::compression::kSnappy, 3);
+}
+
+TEST(SnapshotUtilTest, BlockReaderSkipsAcrossBlocks) {
+  // Each element is larger than a block, so every element is its own block.
+  const int64 num_elements = 5;
+  DataTypeVector dtypes = {DT_INT64, DT_STRING};
+  std::string filename;
+  EXPECT_TRUE(Env::Default()->LocalTempFilename(&filename));
+
+  std::unique_ptr<Writer> writer;
+  TF_ASSERT_OK(Writer::Create(Env::Default(), filename,
+                              io::compression::kSnappy, 3, dtypes, &writer));
+  for (int64 i = 0; i < num_elements; ++i) {
+    Tensor values(DT_INT64,
+                  TensorShape({BlockWriter::kTargetBlockSizeBytes / 8}));
+    values.flat<int64>().setConstant(i);
+    TF_ASSERT_OK(writer->WriteTensors({values, Tensor(tstring("element"))}));
+  }
+  TF_ASSERT_OK(writer->Close());
+
+  std::unique_ptr<Reader> reader;
+  TF_ASSERT_OK(Reader::Create(Env::Default(), filename,
+                              io::compression::kSnappy, 3, dtypes, &reader));
+  std::vector<Tensor> read_tensors;
+  TF_ASSERT_OK(reader->ReadTensors(&read_tensors));
+  EXPECT_EQ(read_tensors[0].flat<int64>()(0), 0);
+  TF_ASSERT_OK(reader->SkipRecords(2));
+  read_tensors.clear();
+  TF_ASSERT_OK(reader->ReadTensors(&read_tensors));
+  ASSERT_EQ(read_tensors.size(), 2);
+  EXPECT_EQ(read_tensors[0].flat<int64>()(0), 3);
+  EXPECT_EQ(read_tensors[1].scalar<tstring>()(), "element");
+  TF_ASSERT_OK(reader->SkipRecords(1));
+  read_tensors.clear();
+  EXPECT_TRUE(errors::IsOutOfRange(reader->ReadTensors(&read_tensors)));
+
+  TF_ASSERT_OK(Env::Default()->DeleteFile(filename));
 }
 
 void SnapshotReaderBenchmarkLoop(::testing::benchmark::State& state,
@@ -141,11 +181,21 @@ void SnapshotTFRecordReaderGzipBenchmark(::testing::benchmark::State& state) {
   SnapshotReaderBenchmarkLoop(state, io::compression::kGzip, 2);
 }
 
+void SnapshotBlockReaderNoneBenchmark(::testing::benchmark::State& state) {
+  SnapshotReaderBenchmarkLoop(state, io::compression::kNone, 3);
+}
+
+void SnapshotBlockReaderSnappyBenchmark(::testing::benchmark::State& state) {
+  SnapshotReaderBenchmarkLoop(state, io::compression::kSnappy, 3);
+}
+
 BENCHMARK(SnapshotCustomReaderNoneBenchmark);
 BENCHMARK(SnapshotCustomReaderGzipBenchmark);
 BENCHMARK(SnapshotCustomReaderSnappyBenchmark);
 BENCHMARK(SnapshotTFRecordReaderNoneBenchmark);
 BENCHMARK(SnapshotTFRecordReaderGzipBenchmark);
+BENCHMARK(SnapshotBlockReaderNoneBenchmark);
+BENCHMARK(SnapshotBlockReaderSnappyBenchmark);
 
 void SnapshotWriterBenchmarkLoop(::testing::benchmark::State& state,
                                  std::string compression_type, int version) {
@@ -197,7 +247,17 @@ BENCHMARK(SnapshotCustomWriterGzipBenchmark);
 BENCHMARK(SnapshotCustomWriterSnappyBenchmark);
 BENCHMARK(SnapshotTFRecordWriterNoneBenchmark);
 BENCHMARK(SnapshotTFRecordWriterGzipBenchmark);
+void SnapshotBlockWriterNoneBenchmark(::testing::benchmark::State& state) {
+  SnapshotWriterBenchmarkLoop(state, io::compression::kNone, 3);
+}
+
+void SnapshotBlockWriterSnappyBenchmark(::testing::benchmark::State& state) {
+  SnapshotWriterBenchmarkLoop(state, io::compression::kSnappy, 3);
+}
+
 BENCHMARK(SnapshotTFRecordWriterSnappyBenchmark);
+BENCHMARK(SnapshotBlockWriterNoneBenchmark);
+BENCHMARK(SnapshotBlockWriterSnappyBenchmark);
 
 }  // namespace
 }  // namespace snapshot_util
@@ -28,6 +28,11 @@ namespace data {
 namespace experimental {
 namespace {
 
+// Records are written in batches of up to this many records or bytes, to
+// amortize the cost of appending to the file.
+constexpr int kMaxBatchRecords = 1024;
+constexpr size_t kMaxBatchBytes = 1 << 20;
+
 class ToTFRecordOp : public AsyncOpKernel {
  public:
   explicit ToTFRecordOp(OpKernelConstruction* ctx)
@@ -89,14 +94,28 @@ class ToTFRecordOp : public AsyncOpKernel {
 
     std::vector<Tensor> components;
     components.reserve(dataset->output_dtypes().size());
+    // The pending records point into the tensors in `batch`.
+    std::vector<Tensor> batch;
+    std::vector<StringPiece> records;
+    size_t batch_bytes = 0;
     bool end_of_sequence;
     do {
       TF_RETURN_IF_ERROR(
           iterator->GetNext(&iter_ctx, &components, &end_of_sequence));
 
       if (!end_of_sequence) {
-        TF_RETURN_IF_ERROR(
-            writer->WriteRecord(components[0].scalar<tstring>()()));
+        batch.push_back(std::move(components[0]));
+        const tstring& record = batch.back().scalar<tstring>()();
+        records.emplace_back(record.data(), record.size());
+        batch_bytes += record.size();
+      }
+      if (!records.empty() &&
+          (end_of_sequence || records.size() >= kMaxBatchRecords ||
+           batch_bytes >= kMaxBatchBytes)) {
+        TF_RETURN_IF_ERROR(writer->WriteRecords(records));
+        batch.clear();
+        records.clear();
+        batch_bytes = 0;
       }
       components.clear();
     } while (!end_of_sequence);
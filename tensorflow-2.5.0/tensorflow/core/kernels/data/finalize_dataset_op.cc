@@ -292,6 +292,9 @@ void GetModelDatasetParams(const Options& options,
   if (options.optimization_options().autotune_buffers()) {
     *algorithm = model::AutotuneAlgorithm::GRADIENT_DESCENT;
   }
+  if (options.optimization_options().autotune_enforce_ram_budget()) {
+    *algorithm = model::AutotuneAlgorithm::MEMORY_AWARE;
+  }
   *cpu_budget = options.optimization_options().autotune_cpu_budget();
   *ram_budget = options.optimization_options().autotune_ram_budget();
 }
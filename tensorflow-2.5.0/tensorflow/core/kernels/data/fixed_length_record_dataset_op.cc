@@ -14,10 +14,13 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/fixed_length_record_dataset_op.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/common_runtime/metrics.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/name_utils.h"
+#include "tensorflow/core/kernels/data/split_utils.h"
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
@@ -44,6 +47,9 @@ namespace data {
 constexpr char kFixedLengthRecordDataset[] = "FixedLengthRecordDataset";
 constexpr char kCurrentFileIndex[] = "current_file_index";
 constexpr char kCurrentPos[] = "current_pos";
+constexpr char kFilePosLimit[] = "file_pos_limit";
+constexpr char kSplitProvider[] = "split_provider";
+constexpr char kSlash[] = "/";
 constexpr char kZLIB[] = "ZLIB";
 constexpr char kGZIP[] = "GZIP";
 
@@ -97,6 +103,17 @@ class FixedLengthRecordDatasetOp::Dataset : public DatasetBase {
     return Status::OK();
   }
 
+  Status MakeSplitProvider(
+      std::unique_ptr<SplitProvider>* split_provider) const override {
+    if (!compression_type_.empty()) {
+      return errors::Unimplemented(
+          "Cannot create a split provider for dataset of type ", type_string(),
+          " reading compressed files.");
+    }
+    return MakeFileRangeSplitProvider(filenames_, /*seekable=*/true,
+                                      split_provider);
+  }
+
   Status CheckExternalState() const override { return Status::OK(); }
 
  protected:
@@ -129,6 +146,11 @@ class FixedLengthRecordDatasetOp::Dataset : public DatasetBase {
     explicit UncompressedIterator(const Params& params)
         : DatasetIterator<Dataset>(params) {}
 
+    Status Initialize(IteratorContext* ctx) override {
+      split_provider_ = ctx->split_provider();
+      return Status::OK();
+    }
+
     Status GetNextInternal(IteratorContext* ctx,
                            std::vector<Tensor>* out_tensors,
                            bool* end_of_sequence) override {
@@ -154,15 +176,26 @@ class FixedLengthRecordDatasetOp::Dataset : public DatasetBase {
             return Status::OK();
           }
 
-          // We have reached the end of the current file, so maybe move on to
-          // next file.
+          // We have reached the end of the current file or split, so maybe
+          // move on to next file.
           input_buffer_.reset();
           file_.reset();
           ++current_file_index_;
         }
 
-        // Iteration ends when there are no more files to process.
-        if (current_file_index_ == dataset()->filenames_.size()) {
+        int64 split_start = 0, split_end = -1;
+        if (split_provider_) {
+          Tensor split;
+          TF_RETURN_IF_ERROR(split_provider_->GetNext(&split, end_of_sequence));
+          if (*end_of_sequence) {
+            return Status::OK();
+          }
+          int64 file_index;
+          TF_RETURN_IF_ERROR(FileRangeSplitProvider::ParseSplit(
+              split, &file_index, &split_start, &split_end));
+          current_file_index_ = file_index;
+        } else if (current_file_index_ == dataset()->filenames_.size()) {
+          // Iteration ends when there are no more files to process.
           *end_of_sequence = true;
           return Status::OK();
         }
@@ -191,6 +224,15 @@ class FixedLengthRecordDatasetOp::Dataset : public DatasetBase {
         input_buffer_ = absl::make_unique<io::InputBuffer>(
             file_.get(), dataset()->buffer_size_);
         TF_RETURN_IF_ERROR(input_buffer_->SkipNBytes(dataset()->header_bytes_));
+        if (split_provider_) {
+          // Only read the records starting in [split_start, split_end).
+          if (split_end >= 0) {
+            file_pos_limit_ =
+                std::min(file_pos_limit_, RecordBoundary(split_end));
+          }
+          TF_RETURN_IF_ERROR(input_buffer_->Seek(
+              std::min(file_pos_limit_, RecordBoundary(split_start))));
+        }
       } while (true);
     }
 
@@ -207,6 +249,15 @@ class FixedLengthRecordDatasetOp::Dataset : public DatasetBase {
       int64 current_pos = input_buffer_ ? input_buffer_->Tell() : -1;
       TF_RETURN_IF_ERROR(
           writer->WriteScalar(full_name(kCurrentPos), current_pos));
+      if (split_provider_) {
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(full_name(kFilePosLimit), file_pos_limit_));
+        TF_RETURN_IF_ERROR(split_provider_->Save(
+            [this](const std::string& key) {
+              return SplitProviderKeyNameFn(key);
+            },
+            writer));
+      }
       return Status::OK();
     }
 
@@ -235,17 +286,45 @@ class FixedLengthRecordDatasetOp::Dataset : public DatasetBase {
             file_.get(), dataset()->buffer_size_);
         TF_RETURN_IF_ERROR(input_buffer_->Seek(current_pos));
       }
+      if (split_provider_) {
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(full_name(kFilePosLimit), &file_pos_limit_));
+        TF_RETURN_IF_ERROR(split_provider_->Restore(
+            [this](const std::string& key) {
+              return SplitProviderKeyNameFn(key);
+            },
+            reader));
+      }
 
       return Status::OK();
     }
 
    private:
+    // Returns the offset of the first record starting at or after `offset`.
+    int64 RecordBoundary(int64 offset) const {
+      const int64 header_bytes = dataset()->header_bytes_;
+      const int64 record_bytes = dataset()->record_bytes_;
+      if (offset <= header_bytes) {
+        return header_bytes;
+      }
+      return header_bytes +
+             (offset - header_bytes + record_bytes - 1) / record_bytes *
+                 record_bytes;
+    }
+
+    std::string SplitProviderKeyNameFn(const std::string& key) {
+      return full_name(absl::StrCat(kSplitProvider, kSlash, key));
+    }
+
     mutex mu_;
     size_t current_file_index_ TF_GUARDED_BY(mu_) = 0;
     std::unique_ptr<RandomAccessFile> file_
         TF_GUARDED_BY(mu_);  // must outlive input_buffer_
     std::unique_ptr<io::InputBuffer> input_buffer_ TF_GUARDED_BY(mu_);
     int64 file_pos_limit_ TF_GUARDED_BY(mu_) = -1;
+    // If set, the iterator reads the byte ranges of files provided as splits
+    // instead of whole files.
+    std::shared_ptr<SplitProvider> split_provider_;
   };
 
   class CompressedIterator : public DatasetIterator<Dataset> {
@@ -265,6 +265,27 @@ ITERATOR_SAVE_AND_RESTORE_TEST_P(FixedLengthRecordDatasetOpTest,
                                  FixedLengthRecordDatasetParams,
                                  IteratorSaveAndRestoreTestCases())
 
+// Splits of 4 bytes cut across the records of both files: the records start
+// at offsets 5, 8 and 11 of the first file, and 5 and 8 of the second one.
+TEST_F(FixedLengthRecordDatasetOpTest, SplitProviderCutsAcrossRecords) {
+  auto params = FixedLengthRecordDatasetParams3();
+  TF_ASSERT_OK(InitializeRuntime(params));
+  setenv("TF_DATA_FILE_SPLIT_BYTES", "4", /*overwrite=*/1);
+  TF_EXPECT_OK(CheckSplitProviderFullIteration(
+      params, CreateTensors<tstring>(
+                  TensorShape({}),
+                  {{"111"}, {"222"}, {"333"}, {"aaa"}, {"bbb"}})));
+  // The splits are [0, 4), [4, 8), [8, 12) and [12, 16) of the first file
+  // and [0, 4), [4, 8), [8, 12) and [12, 13) of the second one.
+  TF_EXPECT_OK(CheckSplitProviderShardedIteration(
+      params, /*num_shards=*/2, /*shard_index=*/0,
+      CreateTensors<tstring>(TensorShape({}), {{"222"}, {"333"}, {"bbb"}})));
+  TF_EXPECT_OK(CheckSplitProviderShardedIteration(
+      params, /*num_shards=*/2, /*shard_index=*/1,
+      CreateTensors<tstring>(TensorShape({}), {{"111"}, {"aaa"}})));
+  unsetenv("TF_DATA_FILE_SPLIT_BYTES");
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
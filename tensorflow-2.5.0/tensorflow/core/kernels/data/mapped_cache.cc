@@ -0,0 +1,373 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/data/mapped_cache.h"
+
+#include <algorithm>
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_split.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/numbers.h"
+#include "tensorflow/core/platform/strcat.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr char kMetaSuffix[] = ".mapped_meta";
+constexpr char kIndexSuffix[] = ".mapped_index";
+constexpr char kDataSuffix[] = ".mapped_data";
+constexpr char kTempSuffix[] = ".tmp";
+constexpr char kMetaMagic[] = "tf_data_mapped_cache_v1";
+constexpr uint64 kAlignment = Allocator::kAllocatorAlignment;
+
+// How a component's payload is encoded.
+enum Encoding : int32 {
+  kRaw = 0,
+  kTensorProto = 1,
+};
+
+// The fixed-size header preceding every component in a data file.
+struct ComponentHeader {
+  int32 dtype;
+  int32 encoding;
+  int64 num_dims;
+  uint64 payload_bytes;
+};
+static_assert(sizeof(ComponentHeader) == 24,
+              "ComponentHeader is part of the file format");
+
+uint64 AlignUp(uint64 offset) {
+  return (offset + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+// Writes `contents` to `filename` through a temporary file, so that readers
+// never observe a partially written file.
+Status WriteFileAtomically(Env* env, const std::string& filename,
+                           StringPiece contents) {
+  std::string temp_filename = strings::StrCat(filename, kTempSuffix);
+  TF_RETURN_IF_ERROR(WriteStringToFile(env, temp_filename, contents));
+  return env->RenameFile(temp_filename, filename);
+}
+
+// A TensorBuffer aliasing a mapped data file. The mapping stays alive for as
+// long as any tensor refers to it.
+class MappedTensorBuffer : public TensorBuffer {
+ public:
+  MappedTensorBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                     const char* data, size_t size)
+      : TensorBuffer(const_cast<char*>(data)),
+        region_(std::move(region)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+
+  TensorBuffer* root_buffer() override { return this; }
+
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(static_cast<int64>(size_));
+    proto->set_allocator_name("mapped_cache");
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+
+  // The mapping is read-only, so ops must not forward the buffer to an output
+  // and write to it in place.
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const size_t size_;
+};
+
+}  // namespace
+
+std::string MappedCacheMetaFilename(const std::string& filename) {
+  return strings::StrCat(filename, kMetaSuffix);
+}
+
+std::string MappedCacheIndexFilename(const std::string& shard_prefix) {
+  return strings::StrCat(shard_prefix, kIndexSuffix);
+}
+
+std::string MappedCacheDataFilename(const std::string& shard_prefix) {
+  return strings::StrCat(shard_prefix, kDataSuffix);
+}
+
+MappedCacheWriter::MappedCacheWriter(Env* env, const std::string& shard_prefix)
+    : env_(env), shard_prefix_(shard_prefix) {
+  status_ = env_->NewWritableFile(MappedCacheDataFilename(shard_prefix_),
+                                  &data_file_);
+}
+
+Status MappedCacheWriter::Append(StringPiece data) {
+  if (data.empty()) {
+    return Status::OK();
+  }
+  status_ = data_file_->Append(data);
+  offset_ += data.size();
+  return status_;
+}
+
+Status MappedCacheWriter::Pad() {
+  static const char kZeros[kAlignment] = {0};
+  return Append(StringPiece(kZeros, AlignUp(offset_) - offset_));
+}
+
+Status MappedCacheWriter::Add(const std::vector<Tensor>& element) {
+  TF_RETURN_IF_ERROR(status_);
+  if (!data_file_) {
+    return errors::FailedPrecondition("Cannot add to a finished shard: ",
+                                      shard_prefix_);
+  }
+  index_.push_back(offset_);
+  for (const Tensor& component : element) {
+    ComponentHeader header;
+    header.dtype = component.dtype();
+    header.num_dims = component.dims();
+    std::string serialized;
+    StringPiece payload;
+    if (DataTypeCanUseMemcpy(component.dtype())) {
+      header.encoding = kRaw;
+      payload = component.tensor_data();
+    } else {
+      header.encoding = kTensorProto;
+      TensorProto proto;
+      component.AsProtoTensorContent(&proto);
+      if (!proto.SerializeToString(&serialized)) {
+        return errors::Internal("Failed to serialize a ",
+                                DataTypeString(component.dtype()),
+                                " tensor for the cache.");
+      }
+      payload = serialized;
+    }
+    header.payload_bytes = payload.size();
+    gtl::InlinedVector<int64, 4> dims = component.shape().dim_sizes();
+    TF_RETURN_IF_ERROR(Append(StringPiece(
+        reinterpret_cast<const char*>(&header), sizeof(header))));
+    TF_RETURN_IF_ERROR(
+        Append(StringPiece(reinterpret_cast<const char*>(dims.data()),
+                           dims.size() * sizeof(int64))));
+    TF_RETURN_IF_ERROR(Pad());
+    TF_RETURN_IF_ERROR(Append(payload));
+    TF_RETURN_IF_ERROR(Pad());
+  }
+  return Status::OK();
+}
+
+Status MappedCacheWriter::Finish() {
+  TF_RETURN_IF_ERROR(status_);
+  if (!data_file_) {
+    return Status::OK();
+  }
+  status_ = data_file_->Close();
+  data_file_.reset();
+  TF_RETURN_IF_ERROR(status_);
+  status_ = WriteFileAtomically(
+      env_, MappedCacheIndexFilename(shard_prefix_),
+      StringPiece(reinterpret_cast<const char*>(index_.data()),
+                  index_.size() * sizeof(uint64)));
+  return status_;
+}
+
+Status WriteMappedCacheMeta(Env* env, const std::string& filename,
+                            int64 num_shards, int64 num_components) {
+  return WriteFileAtomically(
+      env, MappedCacheMetaFilename(filename),
+      strings::StrCat(kMetaMagic, " ", num_shards, " ", num_components, "\n"));
+}
+
+Status MappedCacheReader::Open(Env* env, const std::string& filename,
+                               int64 num_components,
+                               std::unique_ptr<MappedCacheReader>* out) {
+  std::string meta;
+  TF_RETURN_IF_ERROR(
+      ReadFileToString(env, MappedCacheMetaFilename(filename), &meta));
+  std::vector<std::string> fields =
+      absl::StrSplit(absl::StripAsciiWhitespace(meta), ' ');
+  int64 num_shards;
+  int64 meta_num_components;
+  if (fields.size() != 3 || fields[0] != kMetaMagic ||
+      !strings::safe_strto64(fields[1], &num_shards) ||
+      !strings::safe_strto64(fields[2], &meta_num_components) ||
+      num_shards < 0) {
+    return errors::DataLoss("Corrupted cache metadata in ",
+                            MappedCacheMetaFilename(filename));
+  }
+  if (meta_num_components != num_components) {
+    return errors::InvalidArgument(
+        "The cache at ", filename, " holds elements with ",
+        meta_num_components, " components, but the dataset produces ",
+        num_components, " components.");
+  }
+
+  std::unique_ptr<MappedCacheReader> reader(
+      new MappedCacheReader(num_components));
+  reader->shards_.resize(num_shards);
+  for (int64 i = 0; i < num_shards; ++i) {
+    Shard& shard = reader->shards_[i];
+    std::string shard_prefix = strings::StrCat(filename, "_", i);
+
+    std::string index;
+    TF_RETURN_IF_ERROR(ReadFileToString(
+        env, MappedCacheIndexFilename(shard_prefix), &index));
+    if (index.size() % sizeof(uint64) != 0) {
+      return errors::DataLoss("Corrupted cache index ",
+                              MappedCacheIndexFilename(shard_prefix));
+    }
+    shard.offsets.resize(index.size() / sizeof(uint64));
+    memcpy(shard.offsets.data(), index.data(), index.size());
+
+    std::string data_filename = MappedCacheDataFilename(shard_prefix);
+    TF_RETURN_IF_ERROR(env->GetFileSize(data_filename, &shard.file_size));
+    for (uint64 offset : shard.offsets) {
+      if (offset >= shard.file_size) {
+        return errors::DataLoss("Cache index ",
+                                MappedCacheIndexFilename(shard_prefix),
+                                " points past the end of ", data_filename);
+      }
+    }
+    if (shard.file_size > 0) {
+      std::unique_ptr<ReadOnlyMemoryRegion> region;
+      Status s = env->NewReadOnlyMemoryRegionFromFile(data_filename, &region);
+      if (s.ok() && region->length() == shard.file_size) {
+        shard.mapped_data = static_cast<const char*>(region->data());
+        shard.region = std::move(region);
+      } else if (s.ok() || errors::IsUnimplemented(s)) {
+        TF_RETURN_IF_ERROR(
+            env->NewRandomAccessFile(data_filename, &shard.file));
+      } else {
+        return s;
+      }
+    }
+    reader->num_elements_ += shard.offsets.size();
+    reader->shard_limits_.push_back(reader->num_elements_);
+  }
+  *out = std::move(reader);
+  return Status::OK();
+}
+
+Status MappedCacheReader::Read(int64 index, std::vector<Tensor>* out) const {
+  if (index < 0 || index >= num_elements_) {
+    return errors::OutOfRange("Cache element ", index, " is out of range [0, ",
+                              num_elements_, ")");
+  }
+  size_t shard_index =
+      std::upper_bound(shard_limits_.begin(), shard_limits_.end(), index) -
+      shard_limits_.begin();
+  int64 first_index = shard_index == 0 ? 0 : shard_limits_[shard_index - 1];
+  const Shard& shard = shards_[shard_index];
+  uint64 offset = shard.offsets[index - first_index];
+  out->clear();
+  out->resize(num_components_);
+  for (int64 i = 0; i < num_components_; ++i) {
+    TF_RETURN_IF_ERROR(ReadComponent(shard, &offset, &(*out)[i]));
+  }
+  return Status::OK();
+}
+
+Status MappedCacheReader::ReadComponent(const Shard& shard, uint64* offset,
+                                        Tensor* out) const {
+  // Reads `n` bytes at `pos`. `scratch` is only used when the shard is not
+  // mapped.
+  auto read = [&shard](uint64 pos, uint64 n, char* scratch,
+                       StringPiece* result) -> Status {
+    if (pos > shard.file_size || n > shard.file_size - pos) {
+      return errors::DataLoss(
+          "Cache component extends past the end of its data file.");
+    }
+    if (shard.region) {
+      *result = StringPiece(shard.mapped_data + pos, n);
+      return Status::OK();
+    }
+    TF_RETURN_IF_ERROR(shard.file->Read(pos, n, result, scratch));
+    if (result->size() != n) {
+      return errors::DataLoss("Short read from a cache data file.");
+    }
+    return Status::OK();
+  };
+
+  ComponentHeader header;
+  StringPiece data;
+  TF_RETURN_IF_ERROR(read(*offset, sizeof(header),
+                          reinterpret_cast<char*>(&header), &data));
+  memcpy(&header, data.data(), sizeof(header));
+  if (!DataType_IsValid(header.dtype) || header.num_dims < 0 ||
+      header.num_dims > TensorShape::MaxDimensions() ||
+      (header.encoding != kRaw && header.encoding != kTensorProto)) {
+    return errors::DataLoss("Corrupted cache component header.");
+  }
+  const DataType dtype = static_cast<DataType>(header.dtype);
+
+  gtl::InlinedVector<int64, 4> dims(header.num_dims);
+  TF_RETURN_IF_ERROR(read(*offset + sizeof(header),
+                          header.num_dims * sizeof(int64),
+                          reinterpret_cast<char*>(dims.data()), &data));
+  if (!data.empty()) {
+    memcpy(dims.data(), data.data(), data.size());
+  }
+  TensorShape shape;
+  TF_RETURN_IF_ERROR(
+      TensorShapeUtils::MakeShape(dims.data(), dims.size(), &shape));
+
+  const uint64 payload_offset =
+      AlignUp(*offset + sizeof(header) + header.num_dims * sizeof(int64));
+  const uint64 payload_bytes = header.payload_bytes;
+  *offset = AlignUp(payload_offset + payload_bytes);
+
+  if (header.encoding == kTensorProto) {
+    std::string scratch(shard.region ? 0 : payload_bytes, '\0');
+    TF_RETURN_IF_ERROR(
+        read(payload_offset, payload_bytes, &scratch[0], &data));
+    TensorProto proto;
+    if (!proto.ParseFromArray(data.data(), data.size()) ||
+        !out->FromProto(proto) || out->dtype() != dtype ||
+        out->shape() != shape) {
+      return errors::DataLoss("Corrupted cache component.");
+    }
+    return Status::OK();
+  }
+
+  if (!DataTypeCanUseMemcpy(dtype) ||
+      payload_bytes != shape.num_elements() * DataTypeSize(dtype)) {
+    return errors::DataLoss("Corrupted cache component.");
+  }
+  if (shard.region && payload_bytes > 0) {
+    const char* payload = shard.mapped_data + payload_offset;
+    if (reinterpret_cast<uintptr_t>(payload) % EIGEN_MAX_ALIGN_BYTES == 0 &&
+        payload_offset + payload_bytes <= shard.file_size) {
+      auto* buffer =
+          new MappedTensorBuffer(shard.region, payload, payload_bytes);
+      *out = Tensor(dtype, shape, buffer);
+      buffer->Unref();
+      return Status::OK();
+    }
+  }
+  *out = Tensor(dtype, shape);
+  char* buffer = const_cast<char*>(out->tensor_data().data());
+  TF_RETURN_IF_ERROR(read(payload_offset, payload_bytes, buffer, &data));
+  if (payload_bytes > 0 && data.data() != buffer) {
+    memcpy(buffer, data.data(), payload_bytes);
+  }
+  return Status::OK();
+}
+
+}  // namespace data
+}  // namespace tensorflow
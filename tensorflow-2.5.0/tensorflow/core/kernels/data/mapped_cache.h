@@ -0,0 +1,136 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_MAPPED_CACHE_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_MAPPED_CACHE_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace data {
+
+// A file cache format whose elements are read back without deserialization.
+//
+// A cache with prefix `filename` is written as one or more shards with prefix
+// `<filename>_<shard_id>`. Each shard consists of:
+//
+//  * `<shard>.mapped_data`: the components of each element, back to back.
+//    Every component is a fixed-size header followed by its dimensions and its
+//    payload. Headers and payloads start at `Allocator::kAllocatorAlignment`
+//    boundaries, so a mapped payload can back a `Tensor` directly. Payloads of
+//    memcpy-able dtypes are the raw tensor bytes; other dtypes are serialized
+//    `TensorProto`s.
+//  * `<shard>.mapped_index`: one uint64 per element holding the offset of the
+//    element in the data file. The index is written last, so its presence
+//    marks the shard as complete.
+//
+// A complete cache also has `<filename>.mapped_meta`, which records the number
+// of shards and components. Data is written in host byte order, so a cache can
+// only be read on a machine with the same endianness.
+
+// Returns the name of the file marking `filename` as a complete mapped cache.
+std::string MappedCacheMetaFilename(const std::string& filename);
+
+// Returns the name of the index file of the shard with prefix `shard_prefix`.
+std::string MappedCacheIndexFilename(const std::string& shard_prefix);
+
+// Returns the name of the data file of the shard with prefix `shard_prefix`.
+std::string MappedCacheDataFilename(const std::string& shard_prefix);
+
+// Writes one shard of a mapped cache. Not thread-safe.
+class MappedCacheWriter {
+ public:
+  MappedCacheWriter(Env* env, const std::string& shard_prefix);
+
+  // Appends `element` to the shard.
+  Status Add(const std::vector<Tensor>& element);
+
+  // Flushes the shard and writes its index. No elements may be added after
+  // `Finish` is called.
+  Status Finish();
+
+  // Returns the first error encountered by the writer.
+  Status status() const { return status_; }
+
+ private:
+  Status Append(StringPiece data);
+  Status Pad();
+
+  Env* const env_;
+  const std::string shard_prefix_;
+  std::unique_ptr<WritableFile> data_file_;
+  uint64 offset_ = 0;
+  std::vector<uint64> index_;
+  Status status_;
+};
+
+// Marks the cache with prefix `filename`, consisting of `num_shards` shards of
+// elements with `num_components` components, as complete.
+Status WriteMappedCacheMeta(Env* env, const std::string& filename,
+                            int64 num_shards, int64 num_components);
+
+// Reads a complete mapped cache. The shards are mapped into memory when the
+// file system supports it, in which case memcpy-able components alias the
+// mapping; otherwise they are read into freshly allocated tensors.
+//
+// The reader is thread-safe, so any number of iterators can share one.
+class MappedCacheReader {
+ public:
+  // Opens the cache with prefix `filename`, whose elements must have
+  // `num_components` components.
+  static Status Open(Env* env, const std::string& filename,
+                     int64 num_components,
+                     std::unique_ptr<MappedCacheReader>* out);
+
+  int64 num_elements() const { return num_elements_; }
+
+  // Reads the element at `index`, which must be less than `num_elements()`.
+  Status Read(int64 index, std::vector<Tensor>* out) const;
+
+ private:
+  struct Shard {
+    // Set when the data file is mapped. `mapped_data` is the start of the
+    // mapping.
+    std::shared_ptr<ReadOnlyMemoryRegion> region;
+    const char* mapped_data = nullptr;
+    // Set when the data file cannot be mapped.
+    std::unique_ptr<RandomAccessFile> file;
+    uint64 file_size = 0;
+    std::vector<uint64> offsets;
+  };
+
+  explicit MappedCacheReader(int64 num_components)
+      : num_components_(num_components) {}
+
+  Status ReadComponent(const Shard& shard, uint64* offset, Tensor* out) const;
+
+  const int64 num_components_;
+  std::vector<Shard> shards_;
+  // `shard_limits_[i]` is the number of elements in shards 0 to i.
+  std::vector<int64> shard_limits_;
+  int64 num_elements_ = 0;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_MAPPED_CACHE_H_
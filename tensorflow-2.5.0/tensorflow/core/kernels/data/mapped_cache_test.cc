@@ -0,0 +1,132 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/data/mapped_cache.h"
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/data/dataset_test_base.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+std::vector<std::vector<Tensor>> TestElements() {
+  return {
+      {CreateTensor<int64>(TensorShape({2}), {1, 2}),
+       CreateTensor<tstring>(TensorShape({1}), {"a"})},
+      {CreateTensor<int64>(TensorShape({3}), {3, 4, 5}),
+       CreateTensor<tstring>(TensorShape({2}), {"b", "cd"})},
+      {CreateTensor<int64>(TensorShape({0}), {}),
+       CreateTensor<tstring>(TensorShape({}), {"e"})},
+  };
+}
+
+// Writes `elements` into a cache with prefix `filename`, starting a new shard
+// after every `shard_size` elements.
+void WriteCache(const std::string& filename,
+                const std::vector<std::vector<Tensor>>& elements,
+                int shard_size) {
+  Env* env = Env::Default();
+  int64 num_shards = 0;
+  for (int i = 0; i < elements.size(); i += shard_size) {
+    MappedCacheWriter writer(env, strings::StrCat(filename, "_", num_shards++));
+    for (int j = i; j < std::min<int>(i + shard_size, elements.size()); ++j) {
+      TF_ASSERT_OK(writer.Add(elements[j]));
+    }
+    TF_ASSERT_OK(writer.Finish());
+  }
+  TF_ASSERT_OK(WriteMappedCacheMeta(env, filename, num_shards,
+                                    elements.front().size()));
+}
+
+class MappedCacheTest : public ::testing::TestWithParam<int> {};
+
+TEST_P(MappedCacheTest, RoundTrip) {
+  std::string filename =
+      io::JoinPath(testing::TmpDir(),
+                   strings::StrCat("mapped_cache_round_trip_", GetParam()));
+  std::vector<std::vector<Tensor>> elements = TestElements();
+  WriteCache(filename, elements, /*shard_size=*/GetParam());
+
+  std::unique_ptr<MappedCacheReader> reader;
+  TF_ASSERT_OK(MappedCacheReader::Open(Env::Default(), filename,
+                                       /*num_components=*/2, &reader));
+  ASSERT_EQ(reader->num_elements(), elements.size());
+  // Read out of order, as concurrent iterators would.
+  for (int i = elements.size() - 1; i >= 0; --i) {
+    std::vector<Tensor> element;
+    TF_ASSERT_OK(reader->Read(i, &element));
+    ASSERT_EQ(element.size(), 2);
+    test::ExpectTensorEqual<int64>(element[0], elements[i][0]);
+    test::ExpectTensorEqual<tstring>(element[1], elements[i][1]);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(element[0].tensor_data().data()) %
+                  EIGEN_MAX_ALIGN_BYTES,
+              0);
+  }
+  std::vector<Tensor> element;
+  EXPECT_EQ(reader->Read(elements.size(), &element).code(),
+            error::OUT_OF_RANGE);
+}
+
+INSTANTIATE_TEST_SUITE_P(ShardSizes, MappedCacheTest,
+                         ::testing::Values(1, 2, 3));
+
+TEST(MappedCacheTest, ComponentCountMismatch) {
+  std::string filename =
+      io::JoinPath(testing::TmpDir(), "mapped_cache_component_mismatch");
+  WriteCache(filename, TestElements(), /*shard_size=*/3);
+  std::unique_ptr<MappedCacheReader> reader;
+  EXPECT_EQ(MappedCacheReader::Open(Env::Default(), filename,
+                                    /*num_components=*/3, &reader)
+                .code(),
+            error::INVALID_ARGUMENT);
+}
+
+TEST(MappedCacheTest, IncompleteCache) {
+  std::string filename =
+      io::JoinPath(testing::TmpDir(), "mapped_cache_incomplete");
+  MappedCacheWriter writer(Env::Default(), strings::StrCat(filename, "_0"));
+  TF_ASSERT_OK(writer.Add(TestElements()[0]));
+  TF_ASSERT_OK(writer.Finish());
+  EXPECT_EQ(writer.Add(TestElements()[1]).code(), error::FAILED_PRECONDITION);
+  std::unique_ptr<MappedCacheReader> reader;
+  EXPECT_EQ(MappedCacheReader::Open(Env::Default(), filename,
+                                    /*num_components=*/2, &reader)
+                .code(),
+            error::NOT_FOUND);
+}
+
+TEST(MappedCacheTest, CorruptedIndex) {
+  std::string filename =
+      io::JoinPath(testing::TmpDir(), "mapped_cache_corrupted_index");
+  WriteCache(filename, TestElements(), /*shard_size=*/3);
+  uint64 bad_offset = 1 << 30;
+  TF_ASSERT_OK(WriteStringToFile(
+      Env::Default(), MappedCacheIndexFilename(strings::StrCat(filename, "_0")),
+      StringPiece(reinterpret_cast<const char*>(&bad_offset),
+                  sizeof(bad_offset))));
+  std::unique_ptr<MappedCacheReader> reader;
+  EXPECT_EQ(MappedCacheReader::Open(Env::Default(), filename,
+                                    /*num_components=*/2, &reader)
+                .code(),
+            error::DATA_LOSS);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -37,6 +37,19 @@ namespace {
 // Default share of available RAM that can be used by model's internal buffers.
 constexpr double kRamBudgetShare = 0.5;
 
+const char* AlgorithmName(model::AutotuneAlgorithm algorithm) {
+  switch (algorithm) {
+    case model::AutotuneAlgorithm::HILL_CLIMB:
+      return "hill climb";
+    case model::AutotuneAlgorithm::GRADIENT_DESCENT:
+      return "gradient descent";
+    case model::AutotuneAlgorithm::MEMORY_AWARE:
+      return "memory aware";
+    default:
+      return "unknown";
+  }
+}
+
 }  // namespace
 
 /* static */ constexpr const char* const ModelDatasetOp::kDatasetType;
@@ -62,9 +75,7 @@ class ModelDatasetOp::Dataset : public DatasetBase {
         cpu_budget_(cpu_budget),
         ram_budget_(ram_budget),
         traceme_metadata_(
-            {{"algorithm", algorithm == model::AutotuneAlgorithm::HILL_CLIMB
-                               ? "hill climb"
-                               : "gradient descent"},
+            {{"algorithm", AlgorithmName(algorithm)},
              {"cpu_budget",
               strings::Printf("%lld", static_cast<long long>(cpu_budget))},
              {"ram_budget",
@@ -12,6 +12,7 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <cstring>
 #include <deque>
 
 #include "tensorflow/core/common_runtime/input_colocation_exemption_registry.h"
@@ -40,6 +41,19 @@ const char kDevices[] = "devices";
 const char kOutputShapes[] = "output_shapes";
 const char kOutputTypes[] = "output_types";
 
+// Returns true if any of `devices` is a GPU, in which case elements are staged
+// in pinned host memory before they are handed to the per-device iterators.
+bool HasGpuDevice(const std::vector<string>& devices) {
+  for (const string& device : devices) {
+    DeviceNameUtils::ParsedName parsed;
+    if (DeviceNameUtils::ParseFullName(device, &parsed) && parsed.has_type &&
+        parsed.type == DEVICE_GPU) {
+      return true;
+    }
+  }
+  return false;
+}
+
 struct HostBufferElement {
   Status status;
   bool end_of_sequence;
@@ -63,6 +77,7 @@ class MultiDeviceIterator : public ResourceBase {
         output_types_(output_types),
         output_shapes_(output_shapes),
         devices_(devices),
+        stage_in_pinned_memory_(HasGpuDevice(devices)),
         flib_def_(std::move(flib_def)),
         flr_(flr),
         pflr_(std::move(pflr)),
@@ -92,9 +107,17 @@ class MultiDeviceIterator : public ResourceBase {
     ++incarnation_id_;
     *incarnation_id = incarnation_id_;
 
+    std::unique_ptr<BatchSlabPool> staging_pool;
+    if (stage_in_pinned_memory_) {
+      // Every buffered element, plus the element being copied to each device,
+      // can hold one staging slab per component.
+      staging_pool = absl::make_unique<BatchSlabPool>(
+          /*max_slabs=*/devices_.size() * (max_buffer_size + 1) *
+          output_types_.size());
+    }
     multi_device_buffer_ = absl::make_unique<MultiDeviceBuffer>(
         devices_.size(), max_buffer_size, incarnation_id_, std::move(iterator),
-        this);
+        std::move(staging_pool), this);
     return Status::OK();
   }
 
@@ -153,12 +176,14 @@ class MultiDeviceIterator : public ResourceBase {
    public:
     MultiDeviceBuffer(size_t size, int64 max_buffer_size, int64 incarnation_id,
                       std::unique_ptr<IteratorBase> host_iterator,
+                      std::unique_ptr<BatchSlabPool> staging_pool,
                       MultiDeviceIterator* parent)
         : buffer_(size),
           size_(size),
           max_buffer_size_(max_buffer_size),
           incarnation_id_(incarnation_id),
           host_iterator_(std::move(host_iterator)),
+          staging_pool_(std::move(staging_pool)),
           parent_(parent) {}
 
     ~MultiDeviceBuffer() {
@@ -315,6 +340,8 @@ class MultiDeviceIterator : public ResourceBase {
 
         if (elem.status.ok() && elem.end_of_sequence) {
           end_of_iterator = true;
+        } else if (elem.status.ok() && staging_pool_) {
+          elem.status = StageInPinnedMemory(ctx.get(), &elem.value);
         }
 
         {
@@ -349,6 +376,38 @@ class MultiDeviceIterator : public ResourceBase {
       }
     }
 
+    // Copies the components of `value` into pinned host memory, so that the
+    // copies to the devices can be issued as asynchronous DMA transfers instead
+    // of being staged through a pageable bounce buffer on the consumer thread.
+    // The staging buffers are recycled once the device copies have released
+    // them.
+    Status StageInPinnedMemory(IteratorContext* ctx,
+                               std::vector<Tensor>* value) {
+      AllocatorAttributes attrs;
+      attrs.set_on_host(true);
+      attrs.set_gpu_compatible(true);
+      Allocator* allocator = ctx->allocator(attrs);
+      for (size_t i = 0; i < value->size(); ++i) {
+        Tensor& component = (*value)[i];
+        if (!DataTypeCanUseMemcpy(component.dtype()) ||
+            component.NumElements() == 0) {
+          continue;
+        }
+        Tensor staged;
+        TF_RETURN_IF_ERROR(staging_pool_->Allocate(
+            allocator, component.dtype(), component.shape(), &staged));
+        if (!staged.IsInitialized()) {
+          return errors::ResourceExhausted(
+              "Failed to allocate pinned host memory for component ", i);
+        }
+        StringPiece src = component.tensor_data();
+        std::memcpy(const_cast<char*>(staged.tensor_data().data()), src.data(),
+                    src.size());
+        component = std::move(staged);
+      }
+      return Status::OK();
+    }
+
     struct HostBuffer {
       condition_variable cond_var;
       std::deque<HostBufferElement> data;
@@ -369,6 +428,8 @@ class MultiDeviceIterator : public ResourceBase {
     const int64 max_buffer_size_;
     const int64 incarnation_id_;
     const std::unique_ptr<IteratorBase> host_iterator_;
+    // Null unless elements are staged in pinned host memory.
+    const std::unique_ptr<BatchSlabPool> staging_pool_;
     MultiDeviceIterator* const parent_;  // Not owned.
   };
 
@@ -377,6 +438,7 @@ class MultiDeviceIterator : public ResourceBase {
   const DataTypeVector output_types_;
   const std::vector<PartialTensorShape> output_shapes_;
   const std::vector<string> devices_;
+  const bool stage_in_pinned_memory_;
   const std::unique_ptr<FunctionLibraryDefinition> flib_def_;
   FunctionLibraryRuntime* const flr_ = nullptr;  // not owned.
   const std::unique_ptr<ProcessFunctionLibraryRuntime> pflr_;
@@ -196,6 +196,12 @@ class ParallelBatchDatasetOp::Dataset : public DatasetBase {
       if (num_parallel_calls_->value == model::kAutotune) {
         num_parallel_calls_->value = ctx->runner_threadpool_size();
       }
+      // Autotuning never raises the parallelism above its initial value, so
+      // the pool has room for every batch in flight plus the one held by the
+      // consumer.
+      slab_pool_ = absl::make_unique<BatchSlabPool>(
+          /*max_slabs=*/(num_parallel_calls_->value + 1) *
+              dataset()->output_dtypes().size());
       cancellation_manager_ = absl::make_unique<CancellationManager>();
       TF_RETURN_IF_ERROR(RegisterCancellationCallback(
           ctx->cancellation_manager(),
@@ -378,8 +384,9 @@ class ParallelBatchDatasetOp::Dataset : public DatasetBase {
         Status status;
         {
           mutex_lock l(result->mu);
-          status = CopyBatch(/*parallel_copy=*/false, ctx.get(),
-                             &result->output, batch_elements.get());
+          status =
+              CopyBatch(/*parallel_copy=*/false, ctx.get(), &result->output,
+                        batch_elements.get(), slab_pool_.get());
           result->status.Update(status);
           RecordBufferEnqueue(ctx.get(), result->output);
         }
@@ -558,6 +565,10 @@ class ParallelBatchDatasetOp::Dataset : public DatasetBase {
     // Counts the number of outstanding calls for this batch.
     int64 num_calls_ TF_GUARDED_BY(*mu_) = 0;
     std::unique_ptr<IteratorBase> input_impl_;
+    // Output batches are allocated from this pool. Elements are still gathered
+    // before they are copied, because the copies of different batches run in
+    // parallel on the runner while the input is read sequentially.
+    std::unique_ptr<BatchSlabPool> slab_pool_;
     // Buffer for storing the (intermediate) batch results.
     std::deque<std::shared_ptr<BatchResult>> batch_results_ TF_GUARDED_BY(*mu_);
     // Background thread used for coordinating input processing.
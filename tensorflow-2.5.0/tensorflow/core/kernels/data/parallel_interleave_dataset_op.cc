@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/data/captured_function.h"
 #include "tensorflow/core/kernels/data/dataset_utils.h"
 #include "tensorflow/core/kernels/data/name_utils.h"
+#include "tensorflow/core/kernels/data/prefetch_autotuner.h"
 #include "tensorflow/core/kernels/data/stats_utils.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/threadpool.h"
@@ -110,6 +111,12 @@ constexpr char kParallelInterleaveDatasetV4[] = "ParallelInterleaveDatasetV4";
 // a remote file) with other computation.
 constexpr double kDefaultCyclePrefetchFactor = 2.0L;
 
+// When the number of prefetched future cycle elements is autotuned, it starts
+// at the default above and grows up to `kMaxCyclePrefetchFactor * cycle_length`
+// whenever the interleave cycle runs out of future elements. Future workers are
+// only started as the number grows.
+constexpr double kMaxCyclePrefetchFactor = 4.0L;
+
 // `kPerIteratorPrefetchFactor * block_length + 1` is the defualt number of
 // per-iterator results that will be prefetched ahead of time. The `+ 1` is to
 // match the behavior of the original implementation.
@@ -135,7 +142,7 @@ int64 ComputePrefetchInputElements(int64 configured_prefetch_input_elements,
   if (configured_prefetch_input_elements != model::kAutotune) {
     return configured_prefetch_input_elements;
   }
-  return kDefaultCyclePrefetchFactor * cycle_length;
+  return kMaxCyclePrefetchFactor * cycle_length;
 }
 
 int64 OpVersionFromOpName(absl::string_view op_name) {
@@ -173,6 +180,8 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
             ComputeBufferOutputElements(buffer_output_elements, block_length)),
         prefetch_input_elements_(ComputePrefetchInputElements(
             prefetch_input_elements, cycle_length)),
+        autotune_prefetch_input_elements_(prefetch_input_elements ==
+                                          model::kAutotune),
         num_parallel_calls_(num_parallel_calls),
         deterministic_(deterministic),
         output_types_(output_types),
@@ -270,7 +279,9 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       inputs.emplace_back(input_index++, buffer_output_elements_node);
 
       Node* prefetch_input_elements_node;
-      TF_RETURN_IF_ERROR(b->AddScalar(prefetch_input_elements_,
+      TF_RETURN_IF_ERROR(b->AddScalar(autotune_prefetch_input_elements_
+                                          ? model::kAutotune
+                                          : prefetch_input_elements_,
                                       &prefetch_input_elements_node));
       inputs.emplace_back(input_index++, prefetch_input_elements_node);
     }
@@ -315,7 +326,13 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
               params.dataset->num_parallel_calls_, mu_,
               num_parallel_calls_cond_var_)),
           deterministic_(deterministic),
-          current_elements_(params.dataset->cycle_length_) {}
+          current_elements_(params.dataset->cycle_length_),
+          future_elements_autotuner_(
+              params.dataset->autotune_prefetch_input_elements_
+                  ? model::kAutotune
+                  : params.dataset->prefetch_input_elements_,
+              /*buffer_size_min=*/kDefaultCyclePrefetchFactor *
+                  params.dataset->cycle_length_) {}
 
     ~ParallelInterleaveIterator() override {
       CancelThreads(/*wait=*/true);
@@ -689,6 +706,18 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         // We've consumed all results from the element. Get a new element from
         // future_elements, or create a new element if no future elements are
         // available.
+        const int64 future_elements_limit = FutureElementsLimit();
+        future_elements_autotuner_.RecordConsumption(future_elements_.size());
+        if (FutureElementsLimit() > future_elements_limit) {
+          VLOG(2) << "Increased the number of prefetched future elements to "
+                  << FutureElementsLimit();
+          // Until the worker manager starts the first future workers, it
+          // picks up the new limit by itself.
+          if (num_future_workers_ > 0) {
+            StartFutureWorkers();
+          }
+          future_workers_cond_var_.notify_all();
+        }
         if (!future_elements_.empty()) {
           std::shared_ptr<Element> future_element =
               std::move(future_elements_.front());
@@ -747,28 +776,21 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         DecrementOutstandingThreads();
       });
       int initial_current_workers;
-      // When elements are moved from `future_elements_` to `current_elements_`,
-      // the future worker which created the element may continue to process
-      // the element for some time. That is why we need an additional
-      // `cycle_length_` future workers to guarantee that whenever
-      // `future_element_.size() < future_elements_prefetch_`, there will be a
-      // future worker available to create a new future element.
-      int future_workers =
-          dataset()->prefetch_input_elements_ + dataset()->cycle_length_;
       {
         mutex_lock l(*mu_);
         initial_current_workers = num_parallel_calls_->value;
-        outstanding_threads_ += initial_current_workers + future_workers;
+        outstanding_threads_ += initial_current_workers;
         num_current_workers_ += initial_current_workers;
-        num_active_workers_ += initial_current_workers + future_workers;
+        num_active_workers_ += initial_current_workers;
         num_current_active_workers_ += initial_current_workers;
       }
       // Start current workers before future workers to improve startup time.
       for (int i = 0; i < initial_current_workers; ++i) {
         StartCurrentWorkerThread();
       }
-      for (int i = 0; i < future_workers; ++i) {
-        StartFutureWorkerThread();
+      {
+        mutex_lock l(*mu_);
+        StartFutureWorkers();
       }
       while (true) {
         {
@@ -799,6 +821,23 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       thread_pool_->Schedule([this]() { FutureWorkerThread(); });
     }
 
+    // Starts the future workers needed for the current limit of future
+    // elements. When elements are moved from `future_elements_` to
+    // `current_elements_`, the future worker which created the element may
+    // continue to process the element for some time. That is why we need an
+    // additional `cycle_length_` future workers to guarantee that whenever
+    // `future_elements_.size() < FutureElementsLimit()`, there will be a future
+    // worker available to create a new future element.
+    void StartFutureWorkers() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      const int64 future_workers =
+          FutureElementsLimit() + dataset()->cycle_length_;
+      for (; num_future_workers_ < future_workers; ++num_future_workers_) {
+        IncrementOutstandingThreads();
+        IncrementActiveWorkers();
+        StartFutureWorkerThread();
+      }
+    }
+
     // Current workers are responsible for keeping elements in
     // `current_elements_` processed. An element is processed if it is either
     // done or its `results` buffer is full (contains `kPerIteratorPrefetch`
@@ -897,9 +936,9 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
               current_workers_cond_var_.notify_one();
             }
           }
-          while (!cancelled_ && (future_elements_.size() >=
-                                     dataset()->prefetch_input_elements_ ||
-                                 wait_for_checkpoint_)) {
+          while (!cancelled_ &&
+                 (future_elements_.size() >= FutureElementsLimit() ||
+                  wait_for_checkpoint_)) {
             WaitWorkerThread(&future_workers_cond_var_, &l);
           }
           if (cancelled_) {
@@ -1026,6 +1065,14 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       }
     }
 
+    // Returns the number of future elements to keep prefetched. Future workers
+    // open the inputs of these elements and compute their first results ahead
+    // of time, so that e.g. the latency of opening remote files is hidden.
+    int64 FutureElementsLimit() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      return std::min(future_elements_autotuner_.buffer_limit(),
+                      dataset()->prefetch_input_elements_);
+    }
+
     // Adds an error result for the given element.
     void AddErrorResult(std::shared_ptr<Element> element, Status status)
         TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -1532,6 +1579,15 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
     // current element is exhausted.
     std::deque<std::shared_ptr<Element>> future_elements_ TF_GUARDED_BY(mu_);
 
+    // Adjusts the number of future elements to prefetch if
+    // `prefetch_input_elements` is autotuned: the number grows whenever the
+    // interleave cycle needs a new element and none has been prefetched.
+    PrefetchAutotuner future_elements_autotuner_ TF_GUARDED_BY(mu_);
+
+    // Number of future worker threads started so far. The thread pool has
+    // room for the future workers of the largest limit of future elements.
+    int64 num_future_workers_ TF_GUARDED_BY(mu_) = 0;
+
     // Identifies whether the global end of input has been reached.
     bool end_of_input_ TF_GUARDED_BY(mu_) = false;
 
@@ -1564,7 +1620,9 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
   const int64 cycle_length_;
   const int64 block_length_;
   const int64 buffer_output_elements_;
+  // The maximum number of future elements to prefetch.
   const int64 prefetch_input_elements_;
+  const bool autotune_prefetch_input_elements_;
   const int64 num_parallel_calls_;
   const DeterminismPolicy deterministic_;
   const DataTypeVector output_types_;
@@ -67,6 +67,12 @@ constexpr char kErrorMessage[] = "error_message";
 // Period between reporting dataset statistics.
 constexpr int kStatsReportingPeriodMillis = 1000;
 
+// In deterministic mode, completed results are buffered behind a slow
+// head-of-line element. The buffer starts out holding `num_parallel_calls`
+// results and is doubled, up to this multiple, whenever a consumer stalls on
+// the head-of-line element while later results are ready.
+constexpr int64 kMaxReorderBufferFactor = 4;
+
 }  // namespace
 
 class ParallelMapDatasetOp::Dataset : public DatasetBase {
@@ -222,6 +228,13 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
       if (num_parallel_calls_->value == model::kAutotune) {
         num_parallel_calls_->value = ctx->runner_threadpool_size();
       }
+      if (deterministic_ && ctx->model() && model_node()) {
+        // Labeled like the autotuning stage metrics, so that the same stage of
+        // concurrently running input pipelines is reported separately.
+        head_of_line_blocking_gauge_ =
+            metrics::GetTFDataHeadOfLineBlockingGauge(
+                absl::StrCat(ctx->model()->id()), model_node()->long_name());
+      }
       cancellation_manager_ = absl::make_unique<CancellationManager>();
       TF_RETURN_IF_ERROR(RegisterCancellationCallback(
           ctx->cancellation_manager(),
@@ -238,6 +251,7 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
                            std::vector<Tensor>* out_tensors,
                            bool* end_of_sequence) override {
       std::shared_ptr<InvocationResult> result;
+      bool head_of_line_stall = false;
       {
         mutex_lock l(*mu_);
         EnsureThreadsStarted(ctx);
@@ -249,9 +263,21 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
         if (cancelled_) {
           return errors::Cancelled("Iterator was cancelled");
         }
+        head_of_line_stall = deterministic_ && IsHeadOfLineStall(*result);
+        if (head_of_line_stall &&
+            reorder_buffer_factor_ < kMaxReorderBufferFactor) {
+          // Make room for the runner thread to keep `num_parallel_calls`
+          // calls in flight while the head-of-line element is outstanding.
+          reorder_buffer_factor_ *= 2;
+          cond_var_->notify_all();
+        }
       }
       RecordStop(ctx);
+      const uint64 wait_start_ns = EnvTime::NowNanos();
       result->notification.WaitForNotification();
+      if (head_of_line_stall) {
+        RecordHeadOfLineStall(EnvTime::NowNanos() - wait_start_ns);
+      }
       RecordStart(ctx);
       profiler::TraceMe traceme([&] {
         return profiler::TraceMeEncode("ParallelMapConsume",
@@ -412,6 +438,9 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
         TF_LOCKS_EXCLUDED(*mu_) {
       mutex_lock l(*mu_);
       num_calls_--;
+      // `uid` is the time at which the call was scheduled.
+      element_time_ns_ += EnvTime::NowNanos() - result->uid;
+      num_elements_completed_++;
       result->notification.Notify();
       cond_var_->notify_all();
     }
@@ -512,8 +541,12 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
       }
       auto busy = [this]() TF_EXCLUSIVE_LOCKS_REQUIRED(*mu_) -> bool {
         int64 num_parallel_calls = num_parallel_calls_->value;
+        int64 max_results = num_parallel_calls;
+        if (deterministic_) {
+          max_results *= reorder_buffer_factor_;
+        }
         return num_calls_ >= num_parallel_calls ||
-               invocation_results_.size() >= num_parallel_calls;
+               invocation_results_.size() >= max_results;
       };
       while (true) {
         {
@@ -572,6 +605,36 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
       return true;
     }
 
+    // Determines whether a consumer is about to wait for `result`, the
+    // head-of-line element, while later results are already available.
+    bool IsHeadOfLineStall(const InvocationResult& result)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(*mu_) {
+      if (result.notification.HasBeenNotified()) {
+        return false;
+      }
+      for (const auto& later_result : invocation_results_) {
+        if (later_result->notification.HasBeenNotified()) {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    void RecordHeadOfLineStall(int64 wait_ns) TF_LOCKS_EXCLUDED(*mu_) {
+      mutex_lock l(*mu_);
+      head_of_line_wait_ns_ += wait_ns;
+      num_head_of_line_stalls_++;
+      if (head_of_line_blocking_gauge_ != nullptr && element_time_ns_ > 0) {
+        double average_wait_ns =
+            static_cast<double>(head_of_line_wait_ns_) /
+            num_head_of_line_stalls_;
+        double average_element_ns =
+            static_cast<double>(element_time_ns_) / num_elements_completed_;
+        head_of_line_blocking_gauge_->Set(
+            static_cast<int64>(100 * average_wait_ns / average_element_ns));
+      }
+    }
+
     void StatsThread(const std::shared_ptr<IteratorContext>& ctx) {
       for (int64 step = 0;; ++step) {
         int num_calls;
@@ -644,6 +707,15 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
     const bool autotune_;
     // Counts the number of outstanding calls.
     int64 num_calls_ TF_GUARDED_BY(*mu_) = 0;
+    // In deterministic mode, `invocation_results_` holds up to
+    // `reorder_buffer_factor_ * num_parallel_calls` results.
+    int64 reorder_buffer_factor_ TF_GUARDED_BY(*mu_) = 1;
+    // Statistics used to report head-of-line blocking in deterministic mode.
+    int64 element_time_ns_ TF_GUARDED_BY(*mu_) = 0;
+    int64 num_elements_completed_ TF_GUARDED_BY(*mu_) = 0;
+    int64 head_of_line_wait_ns_ TF_GUARDED_BY(*mu_) = 0;
+    int64 num_head_of_line_stalls_ TF_GUARDED_BY(*mu_) = 0;
+    monitoring::GaugeCell<int64>* head_of_line_blocking_gauge_ = nullptr;
     // Controls cancellation of `input_impl_`. Must be ordered before
     // `input_impl_` so that `input_impl_` is destroyed first.
     std::unique_ptr<CancellationManager> cancellation_manager_;
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/data/prefetch_autotuner.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/platform/test.h"
 
@@ -103,6 +105,26 @@ TEST(PrefetchAutotuner, StartWithMin) {
   }
 }
 
+// Mirrors how parallel interleave autotunes the number of prefetched future
+// cycle elements: it starts at twice the cycle length and is capped at four
+// times the cycle length.
+TEST(PrefetchAutotuner, GrowsFutureElementsUpToCap) {
+  constexpr int64 kCycleLength = 3;
+  constexpr int64 kCap = 4 * kCycleLength;
+  PrefetchAutotuner t(model::kAutotune, 2 * kCycleLength);
+  auto limit = [&t]() { return std::min<int64>(t.buffer_limit(), kCap); };
+  EXPECT_EQ(6, limit());
+  t.RecordConsumption(0);  // Expect buffer limit to stay the same!
+  EXPECT_EQ(6, limit());
+  t.RecordConsumption(6);  // Expect buffer limit to stay the same!
+  EXPECT_EQ(6, limit());
+  t.RecordConsumption(0);  // Expect buffer limit to increase.
+  EXPECT_EQ(12, limit());
+  t.RecordConsumption(12);
+  t.RecordConsumption(0);  // Expect buffer limit to stay at the cap.
+  EXPECT_EQ(12, limit());
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
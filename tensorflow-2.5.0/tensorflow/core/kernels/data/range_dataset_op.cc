@@ -81,6 +81,24 @@ class RangeCounter {
   mutable mutex mu_;
   int64 next_ TF_GUARDED_BY(mu_);
 };
+
+// Appends `value`, converted to `dtype`, to `out_tensors`.
+Status AppendValue(DataType dtype, int64 value,
+                   std::vector<Tensor>* out_tensors) {
+  switch (dtype) {
+#define HANDLE_TYPE(type)                                \
+  case DataTypeToEnum<type>::value: {                    \
+    out_tensors->emplace_back(static_cast<type>(value)); \
+    break;                                               \
+  }
+    TF_CALL_NUMBER_TYPES(HANDLE_TYPE);
+#undef HANDLE_TYPE
+    default:
+      return errors::InvalidArgument("Unsupported data type: ",
+                                     DataTypeString(dtype));
+  }
+  return Status::OK();
+}
 }  // namespace
 
 // Split provider where splits are individual outputs from RangeDataset.
@@ -165,6 +183,16 @@ class RangeDatasetOp::Dataset : public DatasetBase {
     }
   }
 
+  Status Get(OpKernelContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    if (index < 0 || index >= Cardinality()) {
+      return errors::OutOfRange("Index ", index, " is out of range [0, ",
+                                Cardinality(), ")");
+    }
+    out_tensors->clear();
+    return AppendValue(output_dtypes_[0], start_ + index * step_, out_tensors);
+  }
+
   Status MakeSplitProvider(
       std::unique_ptr<SplitProvider>* split_provider) const override {
     *split_provider =
@@ -226,20 +254,7 @@ class RangeDatasetOp::Dataset : public DatasetBase {
         }
       }
       out_tensors->reserve(1);
-      switch (dataset()->output_dtypes()[0]) {
-#define HANDLE_TYPE(type)                                \
-  case DataTypeToEnum<type>::value: {                    \
-    out_tensors->emplace_back(static_cast<type>(value)); \
-    break;                                               \
-  }
-        TF_CALL_NUMBER_TYPES(HANDLE_TYPE);
-#undef HANDLE_TYPE
-        default:
-          return errors::InvalidArgument(
-              "Unsupported data type: ",
-              DataTypeString(dataset()->output_dtypes()[0]));
-      }
-      return Status::OK();
+      return AppendValue(dataset()->output_dtypes()[0], value, out_tensors);
     }
 
    protected:
@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/executor.h"
+#include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/common_runtime/process_util.h"
@@ -273,6 +274,26 @@ TEST_F(ExecutorTest, ControlDependenciesFromSpecialNodes) {
   EXPECT_EQ(3.0, V(retvals[0]));  // out = 1.0 + 2.0 = 3.0
 }
 
+TEST_F(ExecutorTest, SingleThreadedExecutorCandidate) {
+  auto g = absl::make_unique<Graph>(OpRegistry::Global());
+  auto in0 = test::graph::Arg(g.get(), 0, DT_FLOAT);
+  auto in1 = test::graph::Arg(g.get(), 1, DT_FLOAT);
+  auto tmp = test::graph::Add(g.get(), in0, in1);
+  test::graph::Retval(g.get(), 0, tmp);
+  FixupSourceAndSinkEdges(g.get());
+  EXPECT_TRUE(IsSingleThreadedExecutorCandidate(*g, /*max_ops=*/4));
+  // Too many op nodes.
+  EXPECT_FALSE(IsSingleThreadedExecutorCandidate(*g, /*max_ops=*/3));
+  // An explicitly requested executor type is never overridden.
+  EXPECT_EQ("DEFAULT", SelectExecutorType("DEFAULT", DEVICE_CPU, *g));
+  EXPECT_EQ("", SelectExecutorType("", DEVICE_GPU, *g));
+
+  // Low level control flow is not supported.
+  auto pred = test::graph::Constant(g.get(), VB(true));
+  test::graph::Switch(g.get(), tmp, pred);
+  EXPECT_FALSE(IsSingleThreadedExecutorCandidate(*g, /*max_ops=*/100));
+}
+
 void BM_executor(::testing::benchmark::State& state) {
   const int width = state.range(0);
   const int depth = state.range(1);
@@ -14,6 +14,12 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/split_utils.h"
 
+#include <algorithm>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/util/env_var.h"
+
 namespace tensorflow {
 namespace data {
 namespace {
@@ -21,6 +27,9 @@ constexpr char kNumToSkip[] = "num_to_skip";
 constexpr char kSplitProvider[] = "split_provider";
 constexpr char kSlash[] = "/";
 constexpr char kIndex[] = "index";
+constexpr char kFileIndex[] = "file_index";
+constexpr char kOffset[] = "offset";
+constexpr int64 kDefaultFileSplitBytes = 64LL << 20;  // 64MB.
 }  // namespace
 
 IndexSplitProvider::IndexSplitProvider(int64 n) : i_(0), n_(n) {}
@@ -111,5 +120,95 @@ Status ShardingSplitProvider::Restore(
   return Status::OK();
 }
 
+FileRangeSplitProvider::FileRangeSplitProvider(std::vector<int64> file_sizes,
+                                               int64 split_bytes)
+    : file_sizes_(std::move(file_sizes)), split_bytes_(split_bytes) {}
+
+Status FileRangeSplitProvider::GetNext(Tensor* split, bool* end_of_splits) {
+  mutex_lock l(mu_);
+  if (split_bytes_ > 0) {
+    while (file_index_ < file_sizes_.size() &&
+           offset_ >= file_sizes_[file_index_]) {
+      ++file_index_;
+      offset_ = 0;
+    }
+  }
+  if (file_index_ >= file_sizes_.size()) {
+    *end_of_splits = true;
+    return Status::OK();
+  }
+  *end_of_splits = false;
+  *split = Tensor(DT_INT64, TensorShape{3});
+  auto split_vec = split->vec<int64>();
+  split_vec(0) = file_index_;
+  split_vec(1) = offset_;
+  if (split_bytes_ > 0) {
+    offset_ = std::min(offset_ + split_bytes_, file_sizes_[file_index_]);
+    split_vec(2) = offset_;
+  } else {
+    ++file_index_;
+    split_vec(2) = -1;
+  }
+  return Status::OK();
+}
+
+Status FileRangeSplitProvider::Reset() {
+  mutex_lock l(mu_);
+  file_index_ = 0;
+  offset_ = 0;
+  return Status::OK();
+}
+
+Status FileRangeSplitProvider::Save(
+    std::function<std::string(std::string)> full_name,
+    IteratorStateWriter* writer) {
+  mutex_lock l(mu_);
+  TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kFileIndex), file_index_));
+  return writer->WriteScalar(full_name(kOffset), offset_);
+}
+
+Status FileRangeSplitProvider::Restore(
+    std::function<std::string(std::string)> full_name,
+    IteratorStateReader* reader) {
+  mutex_lock l(mu_);
+  TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kFileIndex), &file_index_));
+  return reader->ReadScalar(full_name(kOffset), &offset_);
+}
+
+/* static */
+Status FileRangeSplitProvider::ParseSplit(const Tensor& split,
+                                          int64* file_index, int64* start,
+                                          int64* end) {
+  if (split.dtype() != DT_INT64 || split.shape() != TensorShape({3})) {
+    return errors::InvalidArgument(
+        "Expected a file range split to be an int64 vector of size 3, but got ",
+        split.DebugString());
+  }
+  auto split_vec = split.vec<int64>();
+  *file_index = split_vec(0);
+  *start = split_vec(1);
+  *end = split_vec(2);
+  return Status::OK();
+}
+
+Status MakeFileRangeSplitProvider(const std::vector<string>& filenames,
+                                  bool seekable,
+                                  std::unique_ptr<SplitProvider>* out) {
+  std::vector<int64> file_sizes(filenames.size(), 0);
+  int64 split_bytes = 0;
+  if (seekable) {
+    TF_RETURN_IF_ERROR(ReadInt64FromEnvVar(
+        "TF_DATA_FILE_SPLIT_BYTES", kDefaultFileSplitBytes, &split_bytes));
+    for (int i = 0; i < filenames.size(); ++i) {
+      uint64 file_size;
+      TF_RETURN_IF_ERROR(Env::Default()->GetFileSize(filenames[i], &file_size));
+      file_sizes[i] = file_size;
+    }
+  }
+  *out = absl::make_unique<FileRangeSplitProvider>(std::move(file_sizes),
+                                                   split_bytes);
+  return Status::OK();
+}
+
 }  // namespace data
 }  // namespace tensorflow
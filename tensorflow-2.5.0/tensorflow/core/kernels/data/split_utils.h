@@ -61,6 +61,46 @@ class ShardingSplitProvider : public SplitProvider {
   int64 num_to_skip_ TF_GUARDED_BY(mu_);
 };
 
+// A class which produces splits covering byte ranges of a list of files.
+//
+// Each split is an int64 vector `[file_index, start, end]`. Readers should
+// produce the records of file `file_index` which start at an offset in
+// `[start, end)`, so that records crossing a split boundary are read exactly
+// once. An `end` of -1 stands for the end of the file.
+class FileRangeSplitProvider : public SplitProvider {
+ public:
+  // If `split_bytes` is positive, the file of size `file_sizes[i]` is cut into
+  // ranges of `split_bytes` bytes, and empty files produce no split.
+  // Otherwise, every file is produced as a single `[i, 0, -1]` split, which is
+  // what readers of non-seekable (e.g. compressed) files need.
+  FileRangeSplitProvider(std::vector<int64> file_sizes, int64 split_bytes);
+
+  Status GetNext(Tensor* split, bool* end_of_splits) override;
+  Status Reset() override;
+  Status Save(std::function<std::string(std::string)> full_name,
+              IteratorStateWriter* writer) override;
+  Status Restore(std::function<std::string(std::string)> full_name,
+                 IteratorStateReader* reader) override;
+
+  // Parses a split produced by a `FileRangeSplitProvider`.
+  static Status ParseSplit(const Tensor& split, int64* file_index,
+                           int64* start, int64* end);
+
+ private:
+  const std::vector<int64> file_sizes_;
+  const int64 split_bytes_;
+  mutex mu_;
+  int64 file_index_ TF_GUARDED_BY(mu_) = 0;
+  int64 offset_ TF_GUARDED_BY(mu_) = 0;
+};
+
+// Creates a `FileRangeSplitProvider` over `filenames`. If `seekable` is true,
+// files are split into ranges of TF_DATA_FILE_SPLIT_BYTES bytes (64MB by
+// default); otherwise each file is a single split.
+Status MakeFileRangeSplitProvider(const std::vector<string>& filenames,
+                                  bool seekable,
+                                  std::unique_ptr<SplitProvider>* out);
+
 }  // namespace data
 }  // namespace tensorflow
 
@@ -137,6 +137,46 @@ TEST(ShardingSplitProviderTest, SaveAndRestore) {
   EXPECT_TRUE(end_of_splits);
 }
 
+TEST(FileRangeSplitProviderTest, SplitsFiles) {
+  FileRangeSplitProvider split_provider({10, 0, 4}, /*split_bytes=*/4);
+  TF_EXPECT_OK(CheckOutput(
+      &split_provider,
+      CreateTensors<int64>(TensorShape({3}), {{0, 0, 4},
+                                              {0, 4, 8},
+                                              {0, 8, 10},
+                                              {2, 0, 4}})));
+}
+
+TEST(FileRangeSplitProviderTest, WholeFiles) {
+  FileRangeSplitProvider split_provider({10, 0}, /*split_bytes=*/0);
+  TF_EXPECT_OK(CheckOutput(
+      &split_provider,
+      CreateTensors<int64>(TensorShape({3}), {{0, 0, -1}, {1, 0, -1}})));
+}
+
+TEST(FileRangeSplitProviderTest, SaveAndRestore) {
+  FileRangeSplitProvider split_provider({5, 3}, /*split_bytes=*/3);
+  std::vector<Tensor> expected = CreateTensors<int64>(
+      TensorShape({3}), {{0, 0, 3}, {0, 3, 5}, {1, 0, 3}});
+  for (int i = 0; i < expected.size(); ++i) {
+    TF_ASSERT_OK(SaveAndRestore(&split_provider));
+    Tensor split;
+    bool end_of_splits = true;
+    TF_ASSERT_OK(split_provider.GetNext(&split, &end_of_splits));
+    EXPECT_FALSE(end_of_splits);
+    test::ExpectEqual(split, expected[i]);
+    int64 file_index, start, end;
+    TF_ASSERT_OK(
+        FileRangeSplitProvider::ParseSplit(split, &file_index, &start, &end));
+    EXPECT_EQ(file_index, expected[i].vec<int64>()(0));
+  }
+  TF_ASSERT_OK(SaveAndRestore(&split_provider));
+  Tensor split;
+  bool end_of_splits = false;
+  TF_ASSERT_OK(split_provider.GetNext(&split, &end_of_splits));
+  EXPECT_TRUE(end_of_splits);
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
@@ -18,6 +18,7 @@ limitations under the License.
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/name_utils.h"
+#include "tensorflow/core/kernels/data/split_utils.h"
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
@@ -36,6 +37,9 @@ constexpr char kZLIB[] = "ZLIB";
 constexpr char kGZIP[] = "GZIP";
 constexpr char kCurrentFileIndex[] = "current_file_index";
 constexpr char kCurrentPos[] = "current_pos";
+constexpr char kSplitEnd[] = "split_end";
+constexpr char kSplitProvider[] = "split_provider";
+constexpr char kSlash[] = "/";
 
 class TextLineDatasetOp::Dataset : public DatasetBase {
  public:
@@ -74,6 +78,13 @@ class TextLineDatasetOp::Dataset : public DatasetBase {
     return Status::OK();
   }
 
+  Status MakeSplitProvider(
+      std::unique_ptr<SplitProvider>* split_provider) const override {
+    return MakeFileRangeSplitProvider(filenames_,
+                                      /*seekable=*/!use_compression_,
+                                      split_provider);
+  }
+
   Status CheckExternalState() const override { return Status::OK(); }
 
  protected:
@@ -97,6 +108,11 @@ class TextLineDatasetOp::Dataset : public DatasetBase {
     explicit Iterator(const Params& params)
         : DatasetIterator<Dataset>(params) {}
 
+    Status Initialize(IteratorContext* ctx) override {
+      split_provider_ = ctx->split_provider();
+      return Status::OK();
+    }
+
     Status GetNextInternal(IteratorContext* ctx,
                            std::vector<Tensor>* out_tensors,
                            bool* end_of_sequence) override {
@@ -104,29 +120,39 @@ class TextLineDatasetOp::Dataset : public DatasetBase {
       do {
         // We are currently processing a file, so try to read the next line.
         if (buffered_input_stream_) {
-          Tensor line_contents(tstring{});
-          tstring& line_contents_str = line_contents.scalar<tstring>()();
-          Status s = buffered_input_stream_->ReadLine(&line_contents_str);
-
-          if (s.ok()) {
-            // Produce the line as output.
-            static monitoring::CounterCell* bytes_counter =
-                metrics::GetTFDataBytesReadCounter(
-                    name_utils::OpName(TextLineDatasetOp::kDatasetType));
-            bytes_counter->IncrementBy(line_contents_str.size());
-            out_tensors->push_back(std::move(line_contents));
-            *end_of_sequence = false;
-            return Status::OK();
-          } else if (!errors::IsOutOfRange(s)) {
-            // Report non-EOF errors to the caller.
-            return s;
+          if (!SplitEndReachedLocked()) {
+            Tensor line_contents(tstring{});
+            tstring& line_contents_str = line_contents.scalar<tstring>()();
+            Status s = buffered_input_stream_->ReadLine(&line_contents_str);
+
+            if (s.ok()) {
+              // Produce the line as output.
+              static monitoring::CounterCell* bytes_counter =
+                  metrics::GetTFDataBytesReadCounter(
+                      name_utils::OpName(TextLineDatasetOp::kDatasetType));
+              bytes_counter->IncrementBy(line_contents_str.size());
+              out_tensors->push_back(std::move(line_contents));
+              *end_of_sequence = false;
+              return Status::OK();
+            } else if (!errors::IsOutOfRange(s)) {
+              // Report non-EOF errors to the caller.
+              return s;
+            }
           }
-          // We have reached the end of the current file, so maybe
+          // We have reached the end of the current file or split, so maybe
           // move on to next file.
           ResetStreamsLocked();
           ++current_file_index_;
         }
 
+        if (split_provider_) {
+          TF_RETURN_IF_ERROR(NextSplitLocked(ctx->env(), end_of_sequence));
+          if (*end_of_sequence) {
+            return Status::OK();
+          }
+          continue;
+        }
+
         // Iteration ends when there are no more files to process.
         if (current_file_index_ == dataset()->filenames_.size()) {
           *end_of_sequence = true;
@@ -155,6 +181,15 @@ class TextLineDatasetOp::Dataset : public DatasetBase {
         TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kCurrentPos),
                                                buffered_input_stream_->Tell()));
       }
+      if (split_provider_) {
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(full_name(kSplitEnd), split_end_));
+        TF_RETURN_IF_ERROR(split_provider_->Save(
+            [this](const std::string& key) {
+              return SplitProviderKeyNameFn(key);
+            },
+            writer));
+      }
       return Status::OK();
     }
 
@@ -166,6 +201,15 @@ class TextLineDatasetOp::Dataset : public DatasetBase {
       TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kCurrentFileIndex),
                                             &current_file_index));
       current_file_index_ = size_t(current_file_index);
+      if (split_provider_) {
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(full_name(kSplitEnd), &split_end_));
+        TF_RETURN_IF_ERROR(split_provider_->Restore(
+            [this](const std::string& key) {
+              return SplitProviderKeyNameFn(key);
+            },
+            reader));
+      }
       // The key "current_pos" is written only if the iterator was saved
       // with an open file.
       if (reader->Contains(full_name(kCurrentPos))) {
@@ -216,6 +260,42 @@ class TextLineDatasetOp::Dataset : public DatasetBase {
       file_.reset();
     }
 
+    // Sets up reader streams to read the lines of the next split, i.e. the
+    // lines starting in the split's byte range.
+    Status NextSplitLocked(Env* env, bool* end_of_splits)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      Tensor split;
+      TF_RETURN_IF_ERROR(split_provider_->GetNext(&split, end_of_splits));
+      if (*end_of_splits) {
+        return Status::OK();
+      }
+      int64 file_index, start;
+      TF_RETURN_IF_ERROR(FileRangeSplitProvider::ParseSplit(
+          split, &file_index, &start, &split_end_));
+      current_file_index_ = file_index;
+      TF_RETURN_IF_ERROR(SetupStreamsLocked(env));
+      if (start > 0) {
+        // The line containing byte `start - 1` belongs to the previous split.
+        TF_RETURN_IF_ERROR(buffered_input_stream_->Seek(start - 1));
+        tstring skipped;
+        Status s = buffered_input_stream_->ReadLine(&skipped);
+        if (!s.ok() && !errors::IsOutOfRange(s)) {
+          return s;
+        }
+      }
+      return Status::OK();
+    }
+
+    // Whether the next line starts past the end of the current split.
+    bool SplitEndReachedLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      return split_provider_ && split_end_ >= 0 &&
+             buffered_input_stream_->Tell() >= split_end_;
+    }
+
+    std::string SplitProviderKeyNameFn(const std::string& key) {
+      return full_name(absl::StrCat(kSplitProvider, kSlash, key));
+    }
+
     mutex mu_;
     std::unique_ptr<io::RandomAccessInputStream> input_stream_
         TF_GUARDED_BY(mu_);
@@ -225,6 +305,11 @@ class TextLineDatasetOp::Dataset : public DatasetBase {
     size_t current_file_index_ TF_GUARDED_BY(mu_) = 0;
     std::unique_ptr<RandomAccessFile> file_
         TF_GUARDED_BY(mu_);  // must outlive input_stream_
+    // If set, the iterator reads the byte ranges of files provided as splits
+    // instead of whole files.
+    std::shared_ptr<SplitProvider> split_provider_;
+    // End of the byte range of the current split, or -1 for the end of file.
+    int64 split_end_ TF_GUARDED_BY(mu_) = -1;
   };
 
   const std::vector<string> filenames_;
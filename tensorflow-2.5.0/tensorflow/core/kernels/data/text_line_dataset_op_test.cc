@@ -244,6 +244,32 @@ IteratorSaveAndRestoreTestCases() {
 ITERATOR_SAVE_AND_RESTORE_TEST_P(TextLineDatasetOpTest, TextLineDatasetParams,
                                  IteratorSaveAndRestoreTestCases())
 
+// Splits of 10 bytes cut across the lines of both files: the lines start at
+// offsets 0 and 12 of the first file, and 0, 11 and 23 of the second one.
+TEST_F(TextLineDatasetOpTest, SplitProviderCutsAcrossLines) {
+  auto params = TextLineDatasetParams3();
+  TF_ASSERT_OK(InitializeRuntime(params));
+  setenv("TF_DATA_FILE_SPLIT_BYTES", "10", /*overwrite=*/1);
+  TF_EXPECT_OK(CheckSplitProviderFullIteration(
+      params, CreateTensors<tstring>(TensorShape({}), {{"hello world"},
+                                                       {"11223334455"},
+                                                       {"abcd, EFgH"},
+                                                       {"           "},
+                                                       {"$%^&*()"}})));
+  // The splits are [0, 10), [10, 20) and [20, 24) of the first file and
+  // [0, 10), [10, 20), [20, 30) and [30, 31) of the second one.
+  TF_EXPECT_OK(CheckSplitProviderShardedIteration(
+      params, /*num_shards=*/2, /*shard_index=*/0,
+      CreateTensors<tstring>(TensorShape({}),
+                             {{"hello world"}, {"           "}})));
+  TF_EXPECT_OK(CheckSplitProviderShardedIteration(
+      params, /*num_shards=*/2, /*shard_index=*/1,
+      CreateTensors<tstring>(TensorShape({}), {{"11223334455"},
+                                               {"abcd, EFgH"},
+                                               {"$%^&*()"}})));
+  unsetenv("TF_DATA_FILE_SPLIT_BYTES");
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
@@ -14,10 +14,15 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/tf_record_dataset_op.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/common_runtime/metrics.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/name_utils.h"
+#include "tensorflow/core/kernels/data/split_utils.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
@@ -38,10 +43,15 @@ namespace data {
 
 constexpr char kCurrentFileIndex[] = "current_file_index";
 constexpr char kOffset[] = "offset";
+constexpr char kSplitEnd[] = "split_end";
+constexpr char kSplitProvider[] = "split_provider";
+constexpr char kSlash[] = "/";
 constexpr char kGcsFsPrefix[] = "gs://";
 constexpr char kS3FsPrefix[] = "s3://";
 constexpr int64 kCloudTpuBlockSize = 127LL << 20;  // 127MB.
 constexpr int64 kS3BlockSize = kCloudTpuBlockSize;
+// Number of bytes read at a time when looking for the first record of a split.
+constexpr int64 kRecordScanChunkSize = 64 << 10;  // 64KB.
 
 bool is_cloud_tpu_gcs_fs() {
 #if (defined(PLATFORM_CLOUD_TPU) && defined(TPU_GCS_FS)) || \
@@ -90,6 +100,13 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     return Status::OK();
   }
 
+  Status MakeSplitProvider(
+      std::unique_ptr<SplitProvider>* split_provider) const override {
+    return MakeFileRangeSplitProvider(filenames_,
+                                      /*seekable=*/compression_type_.empty(),
+                                      split_provider);
+  }
+
   Status CheckExternalState() const override { return Status::OK(); }
 
  protected:
@@ -113,6 +130,11 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     explicit Iterator(const Params& params)
         : DatasetIterator<Dataset>(params) {}
 
+    Status Initialize(IteratorContext* ctx) override {
+      split_provider_ = ctx->split_provider();
+      return Status::OK();
+    }
+
     Status GetNextInternal(IteratorContext* ctx,
                            std::vector<Tensor>* out_tensors,
                            bool* end_of_sequence) override {
@@ -120,7 +142,7 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       mutex_lock l(mu_);
       do {
         // We are currently processing a file, so try to read the next record.
-        if (reader_) {
+        if (reader_ && !SplitEndReachedLocked()) {
           out_tensors->emplace_back(ctx->allocator({}), DT_STRING,
                                     TensorShape({}));
           Status s =
@@ -147,6 +169,17 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
           // next file.
           ResetStreamsLocked();
           ++current_file_index_;
+        } else if (reader_) {
+          // We have reached the end of the current split.
+          ResetStreamsLocked();
+        }
+
+        if (split_provider_) {
+          TF_RETURN_IF_ERROR(NextSplitLocked(ctx->env(), end_of_sequence));
+          if (*end_of_sequence) {
+            return Status::OK();
+          }
+          continue;
         }
 
         // Iteration ends when there are no more files to process.
@@ -161,6 +194,11 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
 
     Status SkipInternal(IteratorContext* ctx, int num_to_skip,
                         bool* end_of_sequence, int* num_skipped) override {
+      if (split_provider_) {
+        // Skipping whole records could run past the end of the split.
+        return DatasetIterator<Dataset>::SkipInternal(
+            ctx, num_to_skip, end_of_sequence, num_skipped);
+      }
       *num_skipped = 0;
       mutex_lock l(mu_);
       do {
@@ -216,6 +254,15 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
         TF_RETURN_IF_ERROR(
             writer->WriteScalar(full_name(kOffset), reader_->TellOffset()));
       }
+      if (split_provider_) {
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(full_name(kSplitEnd), split_end_));
+        TF_RETURN_IF_ERROR(split_provider_->Save(
+            [this](const std::string& key) {
+              return SplitProviderKeyNameFn(key);
+            },
+            writer));
+      }
       return Status::OK();
     }
 
@@ -227,6 +274,15 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kCurrentFileIndex),
                                             &current_file_index));
       current_file_index_ = size_t(current_file_index);
+      if (split_provider_) {
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(full_name(kSplitEnd), &split_end_));
+        TF_RETURN_IF_ERROR(split_provider_->Restore(
+            [this](const std::string& key) {
+              return SplitProviderKeyNameFn(key);
+            },
+            reader));
+      }
       if (reader->Contains(full_name(kOffset))) {
         int64 offset;
         TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kOffset), &offset));
@@ -259,6 +315,93 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       file_.reset();
     }
 
+    // Sets up reader streams to read the records of the next split, i.e. the
+    // records starting in the split's byte range.
+    Status NextSplitLocked(Env* env, bool* end_of_splits)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      Tensor split;
+      TF_RETURN_IF_ERROR(split_provider_->GetNext(&split, end_of_splits));
+      if (*end_of_splits) {
+        return Status::OK();
+      }
+      int64 file_index, start;
+      TF_RETURN_IF_ERROR(FileRangeSplitProvider::ParseSplit(
+          split, &file_index, &start, &split_end_));
+      current_file_index_ = file_index;
+      TF_RETURN_IF_ERROR(SetupStreamsLocked(env));
+      if (start > 0) {
+        uint64 file_size;
+        TF_RETURN_IF_ERROR(env->GetFileSize(
+            dataset()->filenames_[current_file_index_], &file_size));
+        int64 record_start;
+        TF_RETURN_IF_ERROR(
+            FindRecordStartLocked(start, file_size, &record_start));
+        TF_RETURN_IF_ERROR(reader_->SeekOffset(record_start));
+      }
+      return Status::OK();
+    }
+
+    // Finds the offset of the first record starting in
+    // `[start, split_end_)`, or `split_end_` if there is none. TFRecord files
+    // have no sync markers, so a record start is recognized by a header whose
+    // length matches its checksum, followed by data matching its checksum.
+    // Candidates whose length runs past the end of the `file_size` byte file
+    // are rejected before their data is read.
+    Status FindRecordStartLocked(int64 start, uint64 file_size,
+                                 int64* record_start)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      constexpr size_t kHeaderSize = io::RecordReader::kHeaderSize;
+      constexpr size_t kFooterSize = io::RecordReader::kFooterSize;
+      io::RecordReader verifier(file_.get());
+      std::string scratch;
+      for (int64 chunk_start = start; chunk_start < split_end_;
+           chunk_start += kRecordScanChunkSize) {
+        const size_t n =
+            std::min(kRecordScanChunkSize, split_end_ - chunk_start) +
+            kHeaderSize - 1;
+        scratch.resize(n);
+        StringPiece chunk;
+        Status s = file_->Read(chunk_start, n, &chunk, &scratch[0]);
+        if (!s.ok() && !errors::IsOutOfRange(s)) {
+          return s;
+        }
+        for (size_t i = 0; i + kHeaderSize <= chunk.size() &&
+                           chunk_start + static_cast<int64>(i) < split_end_;
+             ++i) {
+          const char* header = chunk.data() + i;
+          if (crc32c::Unmask(core::DecodeFixed32(header + sizeof(uint64))) !=
+              crc32c::Value(header, sizeof(uint64))) {
+            continue;
+          }
+          uint64 offset = chunk_start + i;
+          // A random match of the length checksum may give any length, and
+          // ReadRecord would try to read that many bytes.
+          const uint64 length = core::DecodeFixed64(header);
+          if (offset + kHeaderSize + kFooterSize > file_size ||
+              length > file_size - offset - kHeaderSize - kFooterSize) {
+            continue;
+          }
+          tstring record;
+          if (verifier.ReadRecord(&offset, &record).ok()) {
+            *record_start = chunk_start + i;
+            return Status::OK();
+          }
+        }
+      }
+      *record_start = split_end_;
+      return Status::OK();
+    }
+
+    // Whether the next record starts past the end of the current split.
+    bool SplitEndReachedLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      return split_provider_ && split_end_ >= 0 &&
+             reader_->TellOffset() >= split_end_;
+    }
+
+    std::string SplitProviderKeyNameFn(const std::string& key) {
+      return full_name(absl::StrCat(kSplitProvider, kSlash, key));
+    }
+
     mutex mu_;
     size_t current_file_index_ TF_GUARDED_BY(mu_) = 0;
 
@@ -266,6 +409,11 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     // we must destroy `reader_` before `file_`.
     std::unique_ptr<RandomAccessFile> file_ TF_GUARDED_BY(mu_);
     std::unique_ptr<io::SequentialRecordReader> reader_ TF_GUARDED_BY(mu_);
+    // If set, the iterator reads the byte ranges of files provided as splits
+    // instead of whole files.
+    std::shared_ptr<SplitProvider> split_provider_;
+    // End of the byte range of the current split, or -1 for the end of file.
+    int64 split_end_ TF_GUARDED_BY(mu_) = -1;
   };
 
   const std::vector<string> filenames_;
@@ -12,6 +12,9 @@ limitations under the License.
 #include "tensorflow/core/kernels/data/tf_record_dataset_op.h"
 
 #include "tensorflow/core/kernels/data/dataset_test_base.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/io/record_reader.h"
 
 namespace tensorflow {
 namespace data {
@@ -263,6 +266,53 @@ IteratorSaveAndRestoreTestCases() {
 ITERATOR_SAVE_AND_RESTORE_TEST_P(TFRecordDatasetOpTest, TFRecordDatasetParams,
                                  IteratorSaveAndRestoreTestCases())
 
+// Splits of 10 bytes cut across the records of both files: the 17, 18 and 19
+// byte records start at offsets 0, 17 and 35 of each file.
+TEST_F(TFRecordDatasetOpTest, SplitProviderCutsAcrossRecords) {
+  auto params = TFRecordDatasetParams3();
+  TF_ASSERT_OK(InitializeRuntime(params));
+  setenv("TF_DATA_FILE_SPLIT_BYTES", "10", /*overwrite=*/1);
+  TF_EXPECT_OK(CheckSplitProviderFullIteration(
+      params,
+      CreateTensors<tstring>(
+          TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})));
+  // Each file is cut into [0, 10), [10, 20), ..., [50, 54).
+  TF_EXPECT_OK(CheckSplitProviderShardedIteration(
+      params, /*num_shards=*/2, /*shard_index=*/0,
+      CreateTensors<tstring>(TensorShape({}), {{"1"}, {"a"}})));
+  TF_EXPECT_OK(CheckSplitProviderShardedIteration(
+      params, /*num_shards=*/2, /*shard_index=*/1,
+      CreateTensors<tstring>(TensorShape({}),
+                             {{"22"}, {"333"}, {"bb"}, {"ccc"}})));
+  unsetenv("TF_DATA_FILE_SPLIT_BYTES");
+}
+
+// The data of the first record holds a record header with a valid length
+// checksum but a length past the end of the file, which a split starting
+// before it must skip rather than try to read.
+TEST_F(TFRecordDatasetOpTest, SplitProviderSkipsHeadersPastEndOfFile) {
+  char fake_header[io::RecordReader::kHeaderSize];
+  core::EncodeFixed64(fake_header, uint64{1} << 40);
+  core::EncodeFixed32(fake_header + sizeof(uint64),
+                      crc32c::Mask(crc32c::Value(fake_header, sizeof(uint64))));
+  const string first_record =
+      absl::StrCat(absl::string_view(fake_header, sizeof(fake_header)), "xxxx");
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/tf_record_fake_header")};
+  TF_ASSERT_OK(CreateTestFiles(filenames, {{first_record, "next"}},
+                               CompressionType::UNCOMPRESSED));
+  TFRecordDatasetParams params(
+      filenames, /*compression_type=*/CompressionType::UNCOMPRESSED,
+      /*buffer_size=*/10, /*node_name=*/kNodeName);
+  TF_ASSERT_OK(InitializeRuntime(params));
+  // The fake header is at offset 12, inside the split [8, 16).
+  setenv("TF_DATA_FILE_SPLIT_BYTES", "8", /*overwrite=*/1);
+  TF_EXPECT_OK(CheckSplitProviderFullIteration(
+      params, CreateTensors<tstring>(TensorShape({}),
+                                     {{first_record}, {"next"}})));
+  unsetenv("TF_DATA_FILE_SPLIT_BYTES");
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/bits.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
@@ -154,31 +155,18 @@ class FFTCPU : public FFTBase {
 
   void DoFFT(OpKernelContext* ctx, const Tensor& in, uint64* fft_shape,
              Tensor* out) override {
-    // Create the axes (which are always trailing).
-    const auto axes = Eigen::ArrayXi::LinSpaced(FFTRank, 1, FFTRank);
-    auto device = ctx->eigen_device<CPUDevice>();
-
     const bool is_complex128 =
         in.dtype() == DT_COMPLEX128 || out->dtype() == DT_COMPLEX128;
 
     if (!IsReal()) {
-      // Compute the FFT using Eigen.
-      constexpr auto direction =
-          Forward ? Eigen::FFT_FORWARD : Eigen::FFT_REVERSE;
       if (is_complex128) {
         DCHECK_EQ(in.dtype(), DT_COMPLEX128);
         DCHECK_EQ(out->dtype(), DT_COMPLEX128);
-        auto input = Tensor(in).flat_inner_dims<complex128, FFTRank + 1>();
-        auto output = out->flat_inner_dims<complex128, FFTRank + 1>();
-        output.device(device) =
-            input.template fft<Eigen::BothParts, direction>(axes);
+        DoComplexFFT<complex128>(ctx, fft_shape, in, out);
       } else {
         DCHECK_EQ(in.dtype(), DT_COMPLEX64);
         DCHECK_EQ(out->dtype(), DT_COMPLEX64);
-        auto input = Tensor(in).flat_inner_dims<complex64, FFTRank + 1>();
-        auto output = out->flat_inner_dims<complex64, FFTRank + 1>();
-        output.device(device) =
-            input.template fft<Eigen::BothParts, direction>(axes);
+        DoComplexFFT<complex64>(ctx, fft_shape, in, out);
       }
     } else {
       if (IsForward()) {
@@ -205,12 +193,54 @@ class FFTCPU : public FFTBase {
     }
   }
 
+  // Eigen's TensorFFT evaluates on the calling thread whatever the device, so
+  // split the independent transforms along the outer (batch) dimension across
+  // the intra-op thread pool. `fn(start, limit)` transforms batch entries
+  // [start, limit).
+  template <typename Fn>
+  void ShardOverBatch(OpKernelContext* ctx, const uint64* fft_shape,
+                      int64 batch_size, Fn&& fn) {
+    uint64 fft_size = 1;
+    for (int i = 0; i < FFTRank; ++i) {
+      fft_size *= fft_shape[i];
+    }
+    // Roughly 5 * N * log2(N) flops per transform of size N.
+    const int64 cost_per_unit =
+        5 * fft_size * std::max(1, Log2Ceiling64(fft_size));
+    const auto& worker_threads =
+        *(ctx->device()->tensorflow_cpu_worker_threads());
+    Shard(worker_threads.num_threads, worker_threads.workers, batch_size,
+          cost_per_unit, std::forward<Fn>(fn));
+  }
+
+  template <typename ComplexT>
+  void DoComplexFFT(OpKernelContext* ctx, const uint64* fft_shape,
+                    const Tensor& in, Tensor* out) {
+    // Create the axes (which are always trailing).
+    const auto axes = Eigen::ArrayXi::LinSpaced(FFTRank, 1, FFTRank);
+    constexpr auto direction =
+        Forward ? Eigen::FFT_FORWARD : Eigen::FFT_REVERSE;
+    auto input = Tensor(in).flat_inner_dims<ComplexT, FFTRank + 1>();
+    auto output = out->flat_inner_dims<ComplexT, FFTRank + 1>();
+
+    ShardOverBatch(
+        ctx, fft_shape, input.dimension(0), [&](int64 start, int64 limit) {
+          Eigen::DSizes<Eigen::DenseIndex, FFTRank + 1> offsets;
+          offsets[0] = start;
+          Eigen::DSizes<Eigen::DenseIndex, FFTRank + 1> sizes =
+              input.dimensions();
+          sizes[0] = limit - start;
+          output.slice(offsets, sizes) =
+              input.slice(offsets, sizes)
+                  .template fft<Eigen::BothParts, direction>(axes);
+        });
+  }
+
   template <typename RealT, typename ComplexT>
   void DoRealForwardFFT(OpKernelContext* ctx, uint64* fft_shape,
                         const Tensor& in, Tensor* out) {
     // Create the axes (which are always trailing).
     const auto axes = Eigen::ArrayXi::LinSpaced(FFTRank, 1, FFTRank);
-    auto device = ctx->eigen_device<CPUDevice>();
     auto input = Tensor(in).flat_inner_dims<RealT, FFTRank + 1>();
     const auto input_dims = input.dimensions();
 
@@ -227,26 +257,35 @@ class FFTCPU : public FFTBase {
                                         temp_shape.DebugString()));
 
     auto output = out->flat_inner_dims<ComplexT, FFTRank + 1>();
-    const Eigen::DSizes<Eigen::DenseIndex, FFTRank + 1> zero_start_indices;
 
     // Compute the full FFT using a temporary tensor.
     Tensor temp;
     OP_REQUIRES_OK(ctx, ctx->allocate_temp(DataTypeToEnum<ComplexT>::v(),
                                            temp_shape, &temp));
     auto full_fft = temp.flat_inner_dims<ComplexT, FFTRank + 1>();
-    full_fft.device(device) =
-        input.slice(zero_start_indices, input_slice_sizes)
-            .template fft<Eigen::BothParts, Eigen::FFT_FORWARD>(axes);
 
-    // Slice away the negative frequency components.
-    output.device(device) =
-        full_fft.slice(zero_start_indices, output.dimensions());
+    ShardOverBatch(
+        ctx, fft_shape, input_dims[0], [&](int64 start, int64 limit) {
+          Eigen::DSizes<Eigen::DenseIndex, FFTRank + 1> offsets;
+          offsets[0] = start;
+          auto slice_sizes = input_slice_sizes;
+          slice_sizes[0] = limit - start;
+          full_fft.slice(offsets, slice_sizes) =
+              input.slice(offsets, slice_sizes)
+                  .template fft<Eigen::BothParts, Eigen::FFT_FORWARD>(axes);
+
+          // Slice away the negative frequency components.
+          Eigen::DSizes<Eigen::DenseIndex, FFTRank + 1> output_sizes =
+              output.dimensions();
+          output_sizes[0] = limit - start;
+          output.slice(offsets, output_sizes) =
+              full_fft.slice(offsets, output_sizes);
+        });
   }
 
   template <typename ComplexT, typename RealT>
   void DoRealBackwardFFT(OpKernelContext* ctx, uint64* fft_shape,
                          const Tensor& in, Tensor* out) {
-    auto device = ctx->eigen_device<CPUDevice>();
     // Reconstruct the full FFT and take the inverse.
     auto input = Tensor(in).flat_inner_dims<ComplexT, FFTRank + 1>();
     auto output = out->flat_inner_dims<RealT, FFTRank + 1>();
@@ -274,48 +313,63 @@ class FFTCPU : public FFTBase {
                                            full_fft_shape, &temp));
     auto full_fft = temp.flat_inner_dims<ComplexT, FFTRank + 1>();
 
-    // Calculate the starting point and range of the source of
-    // negative frequency part.
-    auto neg_sizes = input_slice_sizes;
-    neg_sizes[FFTRank] = fft_shape[FFTRank - 1] - input_slice_sizes[FFTRank];
-    Eigen::DSizes<Eigen::DenseIndex, FFTRank + 1> neg_target_indices;
-    neg_target_indices[FFTRank] = input_slice_sizes[FFTRank];
-
-    const Eigen::DSizes<Eigen::DenseIndex, FFTRank + 1> start_indices;
-    Eigen::DSizes<Eigen::DenseIndex, FFTRank + 1> neg_start_indices;
-    neg_start_indices[FFTRank] = 1;
-
-    full_fft.slice(start_indices, input_slice_sizes).device(device) =
-        input.slice(start_indices, input_slice_sizes);
-
-    // First, conduct IFFTs on outer dimensions. We save computation (and
-    // avoid touching uninitialized memory) by slicing full_fft to the
-    // subregion we wrote input to.
-    if (FFTRank > 1) {
-      const auto outer_axes =
-          Eigen::ArrayXi::LinSpaced(FFTRank - 1, 1, FFTRank - 1);
-      full_fft.slice(start_indices, input_slice_sizes).device(device) =
-          full_fft.slice(start_indices, input_slice_sizes)
-              .template fft<Eigen::BothParts, Eigen::FFT_REVERSE>(outer_axes);
-    }
-
     // Reconstruct the full FFT by appending reversed and conjugated
     // spectrum as the negative frequency part.
     Eigen::array<bool, FFTRank + 1> reverse_last_axis;
     for (auto i = 0; i <= FFTRank; i++) {
       reverse_last_axis[i] = i == FFTRank;
     }
-
-    if (neg_sizes[FFTRank] != 0) {
-      full_fft.slice(neg_target_indices, neg_sizes).device(device) =
-          full_fft.slice(neg_start_indices, neg_sizes)
-              .reverse(reverse_last_axis)
-              .conjugate();
-    }
-
-    auto inner_axis = Eigen::array<int, 1>{FFTRank};
-    output.device(device) =
-        full_fft.template fft<Eigen::RealPart, Eigen::FFT_REVERSE>(inner_axis);
+    const int64 num_neg_frequencies =
+        fft_shape[FFTRank - 1] - input_slice_sizes[FFTRank];
+
+    ShardOverBatch(
+        ctx, fft_shape, input_dims[0], [&](int64 start, int64 limit) {
+          Eigen::DSizes<Eigen::DenseIndex, FFTRank + 1> start_indices;
+          start_indices[0] = start;
+          auto slice_sizes = input_slice_sizes;
+          slice_sizes[0] = limit - start;
+
+          // Calculate the starting point and range of the source of
+          // negative frequency part.
+          auto neg_sizes = slice_sizes;
+          neg_sizes[FFTRank] = num_neg_frequencies;
+          auto neg_target_indices = start_indices;
+          neg_target_indices[FFTRank] = slice_sizes[FFTRank];
+          auto neg_start_indices = start_indices;
+          neg_start_indices[FFTRank] = 1;
+
+          full_fft.slice(start_indices, slice_sizes) =
+              input.slice(start_indices, slice_sizes);
+
+          // First, conduct IFFTs on outer dimensions. We save computation (and
+          // avoid touching uninitialized memory) by slicing full_fft to the
+          // subregion we wrote input to.
+          if (FFTRank > 1) {
+            const auto outer_axes =
+                Eigen::ArrayXi::LinSpaced(FFTRank - 1, 1, FFTRank - 1);
+            full_fft.slice(start_indices, slice_sizes) =
+                full_fft.slice(start_indices, slice_sizes)
+                    .template fft<Eigen::BothParts, Eigen::FFT_REVERSE>(
+                        outer_axes);
+          }
+
+          if (num_neg_frequencies != 0) {
+            full_fft.slice(neg_target_indices, neg_sizes) =
+                full_fft.slice(neg_start_indices, neg_sizes)
+                    .reverse(reverse_last_axis)
+                    .conjugate();
+          }
+
+          auto full_sizes = full_fft.dimensions();
+          full_sizes[0] = limit - start;
+          auto output_sizes = output.dimensions();
+          output_sizes[0] = limit - start;
+          auto inner_axis = Eigen::array<int, 1>{FFTRank};
+          output.slice(start_indices, output_sizes) =
+              full_fft.slice(start_indices, full_sizes)
+                  .template fft<Eigen::RealPart, Eigen::FFT_REVERSE>(
+                      inner_axis);
+        });
   }
 };
 
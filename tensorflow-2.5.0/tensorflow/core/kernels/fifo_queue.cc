@@ -51,32 +51,51 @@ void FIFOQueue::TryEnqueue(const Tuple& tuple, OpKernelContext* ctx,
                            DoneCallback callback) {
   CancellationManager* cm = ctx->cancellation_manager();
   CancellationToken token = cm->get_cancellation_token();
-  bool already_cancelled;
+  bool already_cancelled = false;
+  bool enqueued = false;
+  bool has_pending_dequeues = false;
   {
     mutex_lock l(mu_);
-    already_cancelled = !cm->RegisterCallback(
-        token, [this, cm, token]() { Cancel(kEnqueue, cm, token); });
-    if (!already_cancelled) {
-      enqueue_attempts_.emplace_back(
-          1, callback, ctx, cm, token,
-          [tuple, this](Attempt* attempt) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-            if (closed_) {
-              attempt->context->SetStatus(
-                  errors::Cancelled("FIFOQueue '", name_, "' is closed."));
-              return kComplete;
-            }
-            if (queues_[0].size() < static_cast<size_t>(capacity_)) {
-              for (int i = 0; i < num_components(); ++i) {
-                queues_[i].push_back(PersistentTensor(tuple[i]));
+    if (!closed_ && enqueue_attempts_.empty() &&
+        queues_[0].size() < static_cast<size_t>(capacity_) &&
+        !cm->IsCancelled()) {
+      // Fast path: no earlier enqueue is waiting and there is room, so add
+      // the element directly instead of registering a cancellation callback
+      // and queueing an attempt for FlushUnlocked() to run.
+      for (int i = 0; i < num_components(); ++i) {
+        queues_[i].push_back(PersistentTensor(tuple[i]));
+      }
+      enqueued = true;
+      has_pending_dequeues = !dequeue_attempts_.empty();
+    } else {
+      already_cancelled = !cm->RegisterCallback(
+          token, [this, cm, token]() { Cancel(kEnqueue, cm, token); });
+      if (!already_cancelled) {
+        enqueue_attempts_.emplace_back(
+            1, callback, ctx, cm, token,
+            [tuple, this](Attempt* attempt) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+              if (closed_) {
+                attempt->context->SetStatus(
+                    errors::Cancelled("FIFOQueue '", name_, "' is closed."));
+                return kComplete;
               }
-              return kComplete;
-            } else {
-              return kNoProgress;
-            }
-          });
+              if (queues_[0].size() < static_cast<size_t>(capacity_)) {
+                for (int i = 0; i < num_components(); ++i) {
+                  queues_[i].push_back(PersistentTensor(tuple[i]));
+                }
+                return kComplete;
+              } else {
+                return kNoProgress;
+              }
+            });
+      }
     }
   }
-  if (!already_cancelled) {
+  if (enqueued) {
+    // Wake up any dequeue that was blocked on an empty queue.
+    if (has_pending_dequeues) FlushUnlocked();
+    callback();
+  } else if (!already_cancelled) {
     FlushUnlocked();
   } else {
     ctx->SetStatus(errors::Cancelled("Enqueue operation was cancelled"));
@@ -155,36 +174,56 @@ void FIFOQueue::TryEnqueueMany(const Tuple& tuple, OpKernelContext* ctx,
 void FIFOQueue::TryDequeue(OpKernelContext* ctx, CallbackWithTuple callback) {
   CancellationManager* cm = ctx->cancellation_manager();
   CancellationToken token = cm->get_cancellation_token();
-  bool already_cancelled;
+  bool already_cancelled = false;
+  Tuple tuple;
+  bool dequeued = false;
+  bool has_pending_enqueues = false;
   {
     mutex_lock l(mu_);
-    already_cancelled = !cm->RegisterCallback(
-        token, [this, cm, token]() { Cancel(kDequeue, cm, token); });
-    if (!already_cancelled) {
-      // TODO(josh11b): This makes two copies of callback, avoid this if possible.
-      dequeue_attempts_.emplace_back(
-          1, [callback]() { callback(Tuple()); }, ctx, cm, token,
-          [callback, this](Attempt* attempt) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-            const int64 queue_size = queues_[0].size();
-            if (closed_ && queue_size == 0) {
-              attempt->context->SetStatus(errors::OutOfRange(
-                  "FIFOQueue '", name_, "' is closed and has ",
-                  "insufficient elements (requested ", 1, ", current size ",
-                  queue_size, ")"));
-              return kComplete;
-            }
-            if (queue_size > 0) {
-              Tuple tuple;
-              DequeueLocked(attempt->context, &tuple);
-              attempt->done_callback = [callback, tuple]() { callback(tuple); };
-              return kComplete;
-            } else {
-              return kNoProgress;
-            }
-          });
+    if (dequeue_attempts_.empty() && !queues_[0].empty() &&
+        !cm->IsCancelled()) {
+      // Fast path, mirroring TryEnqueue(): take an available element directly
+      // when no earlier dequeue is waiting.
+      DequeueLocked(ctx, &tuple);
+      dequeued = true;
+      has_pending_enqueues = !enqueue_attempts_.empty();
+    } else {
+      already_cancelled = !cm->RegisterCallback(
+          token, [this, cm, token]() { Cancel(kDequeue, cm, token); });
+      if (!already_cancelled) {
+        // TODO(josh11b): This makes two copies of callback, avoid this if
+        // possible.
+        dequeue_attempts_.emplace_back(
+            1, [callback]() { callback(Tuple()); }, ctx, cm, token,
+            [callback, this](Attempt* attempt)
+                TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+              const int64 queue_size = queues_[0].size();
+              if (closed_ && queue_size == 0) {
+                attempt->context->SetStatus(errors::OutOfRange(
+                    "FIFOQueue '", name_, "' is closed and has ",
+                    "insufficient elements (requested ", 1, ", current size ",
+                    queue_size, ")"));
+                return kComplete;
+              }
+              if (queue_size > 0) {
+                Tuple tuple;
+                DequeueLocked(attempt->context, &tuple);
+                attempt->done_callback = [callback, tuple]() {
+                  callback(tuple);
+                };
+                return kComplete;
+              } else {
+                return kNoProgress;
+              }
+            });
+      }
     }
   }
-  if (!already_cancelled) {
+  if (dequeued) {
+    // Wake up any enqueue that was blocked on a full queue.
+    if (has_pending_enqueues) FlushUnlocked();
+    callback(tuple);
+  } else if (!already_cancelled) {
     FlushUnlocked();
   } else {
     ctx->SetStatus(errors::Cancelled("Dequeue operation was cancelled"));
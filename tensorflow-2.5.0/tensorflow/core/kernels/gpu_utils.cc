@@ -22,11 +22,17 @@ limitations under the License.
 #include "google/protobuf/any.pb.h"
 #include "absl/algorithm/container.h"
 #include "absl/base/call_once.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logger.h"
 #include "tensorflow/core/protobuf/autotuning.pb.h"
 #include "tensorflow/core/protobuf/conv_autotuning.pb.h"
 #include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/proto/proto_utils.h"
+#include "tensorflow/core/util/use_cudnn.h"
 #include "tensorflow/stream_executor/gpu/asm_compiler.h"
 #include "tensorflow/stream_executor/gpu/redzone_allocator.h"
 
@@ -214,6 +220,211 @@ void LogFusedConvForwardAutotuneResults(
   Logger::GetSingleton()->LogProto(log);
 }
 
+namespace {
+
+#if GOOGLE_CUDA
+constexpr char kGpuPlatformName[] = "CUDA";
+#else
+constexpr char kGpuPlatformName[] = "ROCM";
+#endif
+
+// Describes the GPUs of this machine and the version of their DNN library.
+// Autotuning results only carry over between machines with equal descriptions.
+std::string DescribeMachine() {
+  auto platform_or =
+      se::MultiPlatformManager::PlatformWithName(kGpuPlatformName);
+  if (!platform_or.ok()) {
+    return "";
+  }
+  se::Platform* platform = platform_or.ValueOrDie();
+  std::vector<std::string> devices;
+  std::string dnn_version;
+  for (int i = 0; i < platform->VisibleDeviceCount(); ++i) {
+    auto executor_or = platform->ExecutorForDevice(i);
+    if (!executor_or.ok()) {
+      return "";
+    }
+    se::StreamExecutor* executor = executor_or.ValueOrDie();
+    devices.push_back(executor->GetDeviceDescription().name());
+    if (i == 0) {
+      CudnnVersion version = GetCudnnVersion(executor);
+      dnn_version = absl::StrCat(version.major(), ".", version.minor(), ".",
+                                 version.patch());
+    }
+  }
+  return absl::StrCat(absl::StrJoin(devices, ","), " dnn ", dnn_version);
+}
+
+std::string AutotuneResultsKey(absl::string_view map_name,
+                               absl::string_view params) {
+  return absl::StrCat(map_name, "\t", params);
+}
+
+}  // namespace
+
+AutotuneResultsFile::AutotuneResultsFile(std::string path, std::string machine,
+                                         bool read_only)
+    : path_(std::move(path)),
+      machine_(std::move(machine)),
+      read_only_(read_only) {
+  Env* env = Env::Default();
+  if (!env->FileExists(path_).ok()) {
+    return;
+  }
+  std::string contents;
+  Status status = ReadFileToString(env, path_, &contents);
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to read autotuning results from " << path_ << ": "
+                 << status;
+    return;
+  }
+  mutex_lock lock(mu_);
+  for (absl::string_view line : absl::StrSplit(contents, '\n')) {
+    std::vector<absl::string_view> fields = absl::StrSplit(line, '\t');
+    if (fields.size() == 4 && fields[0] == machine_) {
+      configs_[AutotuneResultsKey(fields[1], fields[2])] =
+          std::string(fields[3]);
+    }
+  }
+  VLOG(1) << "Loaded " << configs_.size() << " autotuning results from "
+          << path_;
+}
+
+/*static*/ AutotuneResultsFile* AutotuneResultsFile::Global() {
+  static AutotuneResultsFile* file = []() -> AutotuneResultsFile* {
+    std::string path;
+    TF_CHECK_OK(ReadStringFromEnvVar("TF_AUTOTUNE_RESULTS_FILE",
+                                     /*default_val=*/"", &path));
+    // Execution plans of the cuDNN frontend cannot be persisted, and configs
+    // persisted without the frontend cannot be used with it.
+    if (path.empty() || CudnnUseFrontend()) {
+      return nullptr;
+    }
+    bool read_only = false;
+    TF_CHECK_OK(ReadBoolFromEnvVar("TF_AUTOTUNE_RESULTS_READ_ONLY",
+                                   /*default_val=*/false, &read_only));
+    return new AutotuneResultsFile(path, DescribeMachine(), read_only);
+  }();
+  return file;
+}
+
+absl::optional<std::string> AutotuneResultsFile::Lookup(
+    absl::string_view map_name, absl::string_view params) const {
+  mutex_lock lock(mu_);
+  auto it = configs_.find(AutotuneResultsKey(map_name, params));
+  if (it == configs_.end()) {
+    return absl::nullopt;
+  }
+  return it->second;
+}
+
+void AutotuneResultsFile::Insert(absl::string_view map_name,
+                                 absl::string_view params,
+                                 absl::string_view config) {
+  mutex_lock lock(mu_);
+  std::string& stored = configs_[AutotuneResultsKey(map_name, params)];
+  if (stored == config) {
+    return;
+  }
+  stored = std::string(config);
+  if (read_only_) {
+    return;
+  }
+  std::unique_ptr<WritableFile> file;
+  Status status = Env::Default()->NewAppendableFile(path_, &file);
+  if (status.ok()) {
+    status = file->Append(absl::StrCat(machine_, "\t", map_name, "\t", params,
+                                       "\t", config, "\n"));
+  }
+  if (status.ok()) {
+    status = file->Close();
+  }
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to append autotuning result to " << path_ << ": "
+                 << status;
+  }
+}
+
+namespace {
+
+// Formats an algorithm as "<id>,<tensor ops enabled>".
+bool AlgorithmToString(const absl::optional<se::dnn::AlgorithmDesc>& algorithm,
+                       std::string* str) {
+  if (!algorithm.has_value()) {
+    str->clear();
+    return true;
+  }
+  if (algorithm->IsExecutionPlan()) {
+    return false;
+  }
+  *str = absl::StrCat(algorithm->algo_id(), ",",
+                      algorithm->tensor_ops_enabled() ? 1 : 0);
+  return true;
+}
+
+bool AlgorithmFromString(absl::string_view str,
+                         absl::optional<se::dnn::AlgorithmDesc>* algorithm) {
+  if (str.empty()) {
+    algorithm->reset();
+    return true;
+  }
+  std::vector<absl::string_view> fields = absl::StrSplit(str, ',');
+  int64 algo_id;
+  int tensor_ops_enabled;
+  if (fields.size() != 2 || !absl::SimpleAtoi(fields[0], &algo_id) ||
+      !absl::SimpleAtoi(fields[1], &tensor_ops_enabled)) {
+    return false;
+  }
+  *algorithm = se::dnn::AlgorithmDesc(algo_id, tensor_ops_enabled != 0);
+  return true;
+}
+
+}  // namespace
+
+// Formats a config as "<algorithm>;<algorithm without scratch>;<scratch size>",
+// where absent fields are empty.
+bool AutotuneConfigToString(const se::dnn::AlgorithmConfig& config,
+                            std::string* str) {
+  std::string algorithm, algorithm_no_scratch;
+  if (!AlgorithmToString(config.algorithm(), &algorithm) ||
+      !AlgorithmToString(config.algorithm_no_scratch(),
+                         &algorithm_no_scratch)) {
+    return false;
+  }
+  *str = absl::StrCat(
+      algorithm, ";", algorithm_no_scratch, ";",
+      config.scratch_size().has_value() ? absl::StrCat(*config.scratch_size())
+                                        : "");
+  return true;
+}
+
+bool AutotuneConfigFromString(absl::string_view str,
+                              se::dnn::AlgorithmConfig* config) {
+  std::vector<absl::string_view> fields = absl::StrSplit(str, ';');
+  if (fields.size() != 3) {
+    return false;
+  }
+  absl::optional<se::dnn::AlgorithmDesc> algorithm, algorithm_no_scratch;
+  uint64 scratch_size = 0;
+  if (!AlgorithmFromString(fields[0], &algorithm) ||
+      !AlgorithmFromString(fields[1], &algorithm_no_scratch) ||
+      (!fields[2].empty() && !absl::SimpleAtoi(fields[2], &scratch_size))) {
+    return false;
+  }
+  se::dnn::AlgorithmConfig result;
+  if (algorithm.has_value()) {
+    result.set_algorithm(*algorithm);
+  }
+  if (algorithm_no_scratch.has_value()) {
+    result.set_algorithm_no_scratch(*algorithm_no_scratch);
+  }
+  if (!fields[2].empty()) {
+    result.set_scratch_size(scratch_size);
+  }
+  *config = std::move(result);
+  return true;
+}
+
 // The following function allows deterministic ops to be implemented relatively
 // quickly using environment variables. It is intended to be temporary. The
 // longer-term intention is to enable deterministic ops via tf.config and
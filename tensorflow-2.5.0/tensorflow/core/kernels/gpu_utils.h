@@ -18,8 +18,12 @@ limitations under the License.
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
+#include <string>
 #include <unordered_map>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
 #include "absl/types/span.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -27,7 +31,9 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 
 namespace stream_executor {
 class RedzoneAllocator;
@@ -66,6 +72,63 @@ inline se::DeviceMemory<T> AsDeviceMemory(const T* cuda_memory, uint64 size) {
   return typed;
 }
 
+// Autotuning results accepted by earlier processes.
+//
+// If the TF_AUTOTUNE_RESULTS_FILE environment variable names a file, the
+// results stored in it by processes that ran on the same kind of machine (same
+// GPU models and DNN library version) are loaded on first use, and each result
+// accepted from then on is appended to it. With
+// TF_AUTOTUNE_RESULTS_READ_ONLY=true the file is only read, which allows many
+// jobs to share a prepopulated file.
+//
+// Each line of the file holds one result, as tab-separated machine
+// description, autotune map name, parameters and config.
+//
+// This class is thread-safe.
+class AutotuneResultsFile {
+ public:
+  AutotuneResultsFile(std::string path, std::string machine, bool read_only);
+
+  // Returns the file named by TF_AUTOTUNE_RESULTS_FILE, or nullptr if the
+  // variable is not set.
+  static AutotuneResultsFile* Global();
+
+  // Returns the config stored for `params` in the autotune map `map_name`.
+  absl::optional<std::string> Lookup(absl::string_view map_name,
+                                     absl::string_view params) const;
+
+  // Records `config` for `params` in the autotune map `map_name`, and appends
+  // it to the file unless it is read-only. Failing to append is logged but
+  // otherwise ignored.
+  void Insert(absl::string_view map_name, absl::string_view params,
+              absl::string_view config);
+
+ private:
+  const std::string path_;
+  const std::string machine_;
+  const bool read_only_;
+  mutable mutex mu_;
+  // Keyed by map name and parameters, separated by a tab.
+  absl::flat_hash_map<std::string, std::string> configs_ TF_GUARDED_BY(mu_);
+};
+
+// Converts autotuned configs to and from the strings stored in an
+// AutotuneResultsFile. Configs of types without an overload, and configs which
+// cannot be described by a string (e.g. cuDNN execution plans) are not
+// persisted.
+template <typename Config>
+bool AutotuneConfigToString(const Config& config, std::string* str) {
+  return false;
+}
+template <typename Config>
+bool AutotuneConfigFromString(absl::string_view str, Config* config) {
+  return false;
+}
+bool AutotuneConfigToString(const se::dnn::AlgorithmConfig& config,
+                            std::string* str);
+bool AutotuneConfigFromString(absl::string_view str,
+                              se::dnn::AlgorithmConfig* config);
+
 // A helper class that looks up the best autotuned config from parameters.
 // Due to the noisy nature of autotune, especially with multiple devices, it
 // only accepts a config if its margin exceeds a threshold.
@@ -79,19 +142,55 @@ inline se::DeviceMemory<T> AsDeviceMemory(const T* cuda_memory, uint64 size) {
 template <typename Parameters, typename Config>
 class AutoTuneMap {
  public:
-  bool Find(const Parameters& params, Config* config) const {
-    mutex_lock lock(mu_);
-    auto iter = params_config_map_.find(params);
-    if (iter == params_config_map_.end() ||
-        (iter->second.score < min_score_threshold_ &&
-         iter->second.count <= max_autotune_count_)) {
+  bool Find(const Parameters& params, Config* config) {
+    {
+      mutex_lock lock(mu_);
+      auto iter = params_config_map_.find(params);
+      if (iter != params_config_map_.end()) {
+        if (iter->second.score < min_score_threshold_ &&
+            iter->second.count <= max_autotune_count_) {
+          return false;
+        }
+        *config = iter->second.config;
+        return true;
+      }
+    }
+    // The results file is consulted without holding `mu_`, since loading it
+    // queries the devices and reads the file.
+    if (!FindPersisted(params, config)) {
       return false;
     }
+    // A config accepted by an earlier process counts as accepted here too, so
+    // later lookups stay in memory. Another thread may have inserted one in
+    // the meantime, which then wins.
+    mutex_lock lock(mu_);
+    auto iter =
+        params_config_map_
+            .insert(std::make_pair(
+                params, ValueType{*config, min_score_threshold_, 1}))
+            .first;
     *config = iter->second.config;
     return true;
   }
   void Insert(const Parameters& params, const Config& config) {
-    mutex_lock lock(mu_);
+    absl::optional<Config> accepted;
+    {
+      mutex_lock lock(mu_);
+      accepted = InsertLocked(params, config);
+    }
+    // Written outside `mu_` for the same reason as in Find().
+    if (accepted.has_value()) {
+      Persist(params, *accepted);
+    }
+  }
+
+ private:
+  // Records `config` as the result of one autotuning run for `params`, and
+  // returns the config accepted for `params` if one was accepted by it.
+  absl::optional<Config> InsertLocked(const Parameters& params,
+                                      const Config& config)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    absl::optional<Config> accepted;
     auto iter = params_config_map_.find(params);
     int new_score = 0;
     if (iter == params_config_map_.end()) {
@@ -121,6 +220,7 @@ class AutoTuneMap {
     }
     if (new_score >= min_score_threshold_) {
       VLOG(1) << GetActionSummary("accepts", params, config);
+      accepted = config;
     } else if (autotune_global_count_ >= max_autotune_global_count_) {
       // The autotuning exceeds the max iteration threshold and we accept the
       // the winner if it exists in the map, otherwise we accept the current
@@ -133,19 +233,21 @@ class AutoTuneMap {
         }
         params_config_map_.insert(
             std::make_pair(params, ValueType{config, min_score_threshold_, 1}));
+        accepted = config;
       } else {
         int promotes_times = min_score_threshold_ - winner->second.score;
         for (int i = 0; i < promotes_times; ++i) {
           VLOG(1) << GetActionSummary("promotes", params, config);
         }
         winner->second.score = min_score_threshold_;
+        accepted = winner->second.config;
       }
       VLOG(1) << GetActionSummary("accepts", params, config);
     }
     autotune_global_count_++;
+    return accepted;
   }
 
- private:
   AutoTuneMap(const std::string& name) : name_(name) {
     min_score_threshold_ = 1;
     int min_warmup_iterations = 10;
@@ -175,6 +277,28 @@ class AutoTuneMap {
     }
   };
 
+  // Looks up a config accepted by an earlier process. These are used as is,
+  // without further autotuning.
+  bool FindPersisted(const Parameters& params, Config* config) const
+      TF_LOCKS_EXCLUDED(mu_) {
+    AutotuneResultsFile* file = AutotuneResultsFile::Global();
+    if (file == nullptr) {
+      return false;
+    }
+    absl::optional<std::string> str = file->Lookup(name_, params.ToString());
+    return str.has_value() && AutotuneConfigFromString(*str, config);
+  }
+
+  // Records an accepted config for later processes.
+  void Persist(const Parameters& params, const Config& config)
+      TF_LOCKS_EXCLUDED(mu_) {
+    AutotuneResultsFile* file = AutotuneResultsFile::Global();
+    std::string str;
+    if (file != nullptr && AutotuneConfigToString(config, &str)) {
+      file->Insert(name_, params.ToString(), str);
+    }
+  }
+
   std::string GetActionSummary(StringPiece action, const Parameters& params,
                                const Config& config) {
     return strings::Printf("autotune_map %s %s: %s -> (%s)", name_.c_str(),
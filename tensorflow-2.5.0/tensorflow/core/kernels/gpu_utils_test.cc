@@ -0,0 +1,107 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#include "tensorflow/core/kernels/gpu_utils.h"
+
+#include <string>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(AutotuneConfigStringTest, RoundTrip) {
+  se::dnn::AlgorithmConfig config(se::dnn::AlgorithmDesc(7, true), 1024,
+                                  se::dnn::AlgorithmDesc(2, false));
+  std::string str;
+  ASSERT_TRUE(AutotuneConfigToString(config, &str));
+  EXPECT_EQ("7,1;2,0;1024", str);
+
+  se::dnn::AlgorithmConfig parsed;
+  ASSERT_TRUE(AutotuneConfigFromString(str, &parsed));
+  EXPECT_EQ(config, parsed);
+}
+
+TEST(AutotuneConfigStringTest, RoundTripEmptyConfig) {
+  se::dnn::AlgorithmConfig config;
+  std::string str;
+  ASSERT_TRUE(AutotuneConfigToString(config, &str));
+  EXPECT_EQ(";;", str);
+
+  se::dnn::AlgorithmConfig parsed(se::dnn::AlgorithmDesc(7, true));
+  ASSERT_TRUE(AutotuneConfigFromString(str, &parsed));
+  EXPECT_EQ(config, parsed);
+}
+
+TEST(AutotuneConfigStringTest, RejectsMalformedStrings) {
+  se::dnn::AlgorithmConfig config;
+  EXPECT_FALSE(AutotuneConfigFromString("", &config));
+  EXPECT_FALSE(AutotuneConfigFromString("7,1;2,0", &config));
+  EXPECT_FALSE(AutotuneConfigFromString("7;;", &config));
+  EXPECT_FALSE(AutotuneConfigFromString("x,1;;", &config));
+  EXPECT_FALSE(AutotuneConfigFromString("7,1;;big", &config));
+}
+
+TEST(AutotuneResultsFileTest, LoadsResultsOfTheSameMachine) {
+  const std::string path =
+      io::JoinPath(testing::TmpDir(), "autotune_results_load");
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), path,
+                                 "gpu_a\tconv\tparams_1\t7,1;;\n"
+                                 "gpu_b\tconv\tparams_2\t3,0;;\n"
+                                 "malformed line\n"
+                                 "gpu_a\tconv\tparams_3\n"
+                                 "gpu_a\tmatmul\tparams_1\t5,0;;16\n"));
+  AutotuneResultsFile file(path, "gpu_a", /*read_only=*/true);
+  EXPECT_EQ("7,1;;", file.Lookup("conv", "params_1").value_or(""));
+  EXPECT_EQ("5,0;;16", file.Lookup("matmul", "params_1").value_or(""));
+  EXPECT_FALSE(file.Lookup("conv", "params_2").has_value());
+  EXPECT_FALSE(file.Lookup("conv", "params_3").has_value());
+}
+
+TEST(AutotuneResultsFileTest, AppendsInsertedResults) {
+  const std::string path =
+      io::JoinPath(testing::TmpDir(), "autotune_results_append");
+  {
+    AutotuneResultsFile file(path, "gpu_a", /*read_only=*/false);
+    EXPECT_FALSE(file.Lookup("conv", "params_1").has_value());
+    file.Insert("conv", "params_1", "7,1;;");
+    file.Insert("conv", "params_2", "3,0;;");
+    EXPECT_EQ("7,1;;", file.Lookup("conv", "params_1").value_or(""));
+  }
+  AutotuneResultsFile file(path, "gpu_a", /*read_only=*/false);
+  EXPECT_EQ("7,1;;", file.Lookup("conv", "params_1").value_or(""));
+  EXPECT_EQ("3,0;;", file.Lookup("conv", "params_2").value_or(""));
+  AutotuneResultsFile other_machine(path, "gpu_b", /*read_only=*/false);
+  EXPECT_FALSE(other_machine.Lookup("conv", "params_1").has_value());
+}
+
+TEST(AutotuneResultsFileTest, ReadOnlyFileIsNotWritten) {
+  const std::string path =
+      io::JoinPath(testing::TmpDir(), "autotune_results_read_only");
+  AutotuneResultsFile file(path, "gpu_a", /*read_only=*/true);
+  file.Insert("conv", "params_1", "7,1;;");
+  EXPECT_EQ("7,1;;", file.Lookup("conv", "params_1").value_or(""));
+  EXPECT_TRUE(errors::IsNotFound(Env::Default()->FileExists(path)));
+}
+
+}  // namespace
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
@@ -0,0 +1,265 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/image_ops.cc
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/jpeg/jpeg_mem.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+namespace {
+
+// Rough cost of decoding one byte of an output image, in cycles.
+constexpr int64 kDecodeCostPerByte = 50;
+
+// What to decode for one image of the batch.
+struct ImageDecode {
+  jpeg::UncompressFlags flags;
+  int height = 0;
+  int width = 0;
+  Status status;
+};
+
+// Returns the largest DCT scaling ratio (1, 2, 4 or 8) at which a region of
+// the given size still covers the target size. A target dimension of 0 doesn't
+// constrain the ratio.
+int ChooseRatio(int height, int width, int target_height, int target_width) {
+  if (target_height <= 0 && target_width <= 0) return 1;
+  for (int ratio = 8; ratio > 1; ratio /= 2) {
+    if (height / ratio >= target_height && width / ratio >= target_width) {
+      return ratio;
+    }
+  }
+  return 1;
+}
+
+// Decodes a batch of JPEG images in parallel into a zero-padded batch.
+//
+// Each image is decoded at the largest DCT scaling ratio that keeps it (or its
+// crop window) at least as large as the target size, so that libjpeg does
+// most of the downscaling of a subsequent resize while decoding.
+class DecodeJpegBatchOp : public OpKernel {
+ public:
+  explicit DecodeJpegBatchOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("channels", &channels_));
+    OP_REQUIRES(context, channels_ == 1 || channels_ == 3,
+                errors::InvalidArgument("channels must be 1 or 3, got ",
+                                        channels_));
+    OP_REQUIRES_OK(context, context->GetAttr("target_height", &target_height_));
+    OP_REQUIRES_OK(context, context->GetAttr("target_width", &target_width_));
+    OP_REQUIRES(context, target_height_ >= 0 && target_width_ >= 0,
+                errors::InvalidArgument(
+                    "target_height and target_width must be non-negative, "
+                    "got ",
+                    target_height_, " and ", target_width_));
+    flags_.components = channels_;
+    OP_REQUIRES_OK(context, context->GetAttr("fancy_upscaling",
+                                             &flags_.fancy_upscaling));
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("try_recover_truncated",
+                                    &flags_.try_recover_truncated_jpeg));
+    OP_REQUIRES_OK(context, context->GetAttr("acceptable_fraction",
+                                             &flags_.min_acceptable_fraction));
+    string dct_method;
+    OP_REQUIRES_OK(context, context->GetAttr("dct_method", &dct_method));
+    OP_REQUIRES(
+        context,
+        (dct_method.empty() || dct_method == "INTEGER_FAST" ||
+         dct_method == "INTEGER_ACCURATE"),
+        errors::InvalidArgument("dct_method must be one of "
+                                "{'', 'INTEGER_FAST', 'INTEGER_ACCURATE'}"));
+    // The TensorFlow-chosen default for JPEG decoding is IFAST, sacrificing
+    // image quality for speed.
+    flags_.dct_method =
+        dct_method == "INTEGER_ACCURATE" ? JDCT_ISLOW : JDCT_IFAST;
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& contents_t = context->input(0);
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(contents_t.shape()),
+                errors::InvalidArgument("contents must be a vector, got shape ",
+                                        contents_t.shape().DebugString()));
+    const int64 batch_size = contents_t.NumElements();
+    const Tensor& crop_windows_t = context->input(1);
+    OP_REQUIRES(
+        context,
+        TensorShapeUtils::IsMatrix(crop_windows_t.shape()) &&
+            crop_windows_t.dim_size(1) == 4 &&
+            (crop_windows_t.dim_size(0) == 0 ||
+             crop_windows_t.dim_size(0) == batch_size),
+        errors::InvalidArgument(
+            "crop_windows must have shape [0, 4] or [", batch_size,
+            ", 4], got ", crop_windows_t.shape().DebugString()));
+    const auto contents = contents_t.vec<tstring>();
+    const auto crop_windows = crop_windows_t.matrix<int32>();
+    const bool crop = crop_windows_t.dim_size(0) > 0;
+
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    std::vector<ImageDecode> decodes(batch_size);
+    auto plan = [&](int64 begin, int64 end) {
+      for (int64 i = begin; i < end; ++i) {
+        PlanDecode(contents(i), crop, crop_windows, i, &decodes[i]);
+      }
+    };
+    // Only the headers are parsed here.
+    Shard(worker_threads->num_threads, worker_threads->workers, batch_size,
+          /*cost_per_unit=*/10000, plan);
+    int max_height = 0;
+    int max_width = 0;
+    for (const ImageDecode& decode : decodes) {
+      OP_REQUIRES_OK(context, decode.status);
+      max_height = std::max(max_height, decode.height);
+      max_width = std::max(max_width, decode.width);
+    }
+
+    Tensor* images_t = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       0, TensorShape({batch_size, max_height, max_width,
+                                       channels_}),
+                       &images_t));
+    Tensor* image_sizes_t = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(
+                                1, TensorShape({batch_size, 2}),
+                                &image_sizes_t));
+    auto image_sizes = image_sizes_t->matrix<int32>();
+    uint8* images = images_t->flat<uint8>().data();
+    const int64 row_bytes = static_cast<int64>(max_width) * channels_;
+    const int64 image_bytes = row_bytes * max_height;
+    const int channels = channels_;
+
+    auto decode_images = [&](int64 begin, int64 end) {
+      for (int64 i = begin; i < end; ++i) {
+        ImageDecode* decode = &decodes[i];
+        uint8* image = images + i * image_bytes;
+        decode->flags.stride = row_bytes;
+        const int height = decode->height;
+        const int width = decode->width;
+        // Decode straight into the image's slot of the batch.
+        const uint8* decoded = jpeg::Uncompress(
+            contents(i).data(), contents(i).size(), decode->flags,
+            nullptr /* nwarn */,
+            [=](int w, int h, int c) -> uint8* {
+              return w == width && h == height && c == channels ? image
+                                                                : nullptr;
+            });
+        if (decoded == nullptr) {
+          decode->status = errors::InvalidArgument(
+              "jpeg::Uncompress failed for image ", i,
+              ". Invalid JPEG data or crop window.");
+          continue;
+        }
+        image_sizes(i, 0) = height;
+        image_sizes(i, 1) = width;
+        // Zero the padding.
+        const int64 image_row_bytes = static_cast<int64>(width) * channels_;
+        for (int y = 0; y < height; ++y) {
+          std::memset(image + y * row_bytes + image_row_bytes, 0,
+                      row_bytes - image_row_bytes);
+        }
+        std::memset(image + height * row_bytes, 0,
+                    (max_height - height) * row_bytes);
+      }
+    };
+    Shard(worker_threads->num_threads, worker_threads->workers, batch_size,
+          image_bytes * kDecodeCostPerByte, decode_images);
+    for (const ImageDecode& decode : decodes) {
+      OP_REQUIRES_OK(context, decode.status);
+    }
+  }
+
+ private:
+  // Parses the header of 'input' and chooses the flags and output size of
+  // image 'index'.
+  void PlanDecode(StringPiece input, bool crop,
+                  const TTypes<int32>::ConstMatrix& crop_windows, int64 index,
+                  ImageDecode* decode) {
+    if (input.size() > std::numeric_limits<int>::max()) {
+      decode->status = errors::InvalidArgument(
+          "Image ", index, " is too large for int: ", input.size());
+      return;
+    }
+    int height;
+    int width;
+    if (!jpeg::GetImageInfo(input.data(), input.size(), &width, &height,
+                            nullptr)) {
+      decode->status = errors::InvalidArgument(
+          "Image ", index, " is not a valid JPEG image.");
+      return;
+    }
+    decode->flags = flags_;
+    if (!crop) {
+      const int ratio =
+          ChooseRatio(height, width, target_height_, target_width_);
+      decode->flags.ratio = ratio;
+      // libjpeg rounds the scaled size up.
+      decode->height = (height + ratio - 1) / ratio;
+      decode->width = (width + ratio - 1) / ratio;
+      return;
+    }
+
+    const int crop_y = crop_windows(index, 0);
+    const int crop_x = crop_windows(index, 1);
+    const int crop_height = crop_windows(index, 2);
+    const int crop_width = crop_windows(index, 3);
+    if (crop_height <= 0 || crop_width <= 0 || crop_y < 0 || crop_x < 0 ||
+        crop_height > height - crop_y || crop_width > width - crop_x) {
+      decode->status = errors::InvalidArgument(
+          "Crop window [", crop_y, ", ", crop_x, ", ", crop_height, ", ",
+          crop_width, "] of image ", index, " is outside of its ", height,
+          "x", width, " pixels.");
+      return;
+    }
+    // The crop window applies to the scaled image, so scale it as well.
+    const int ratio =
+        ChooseRatio(crop_height, crop_width, target_height_, target_width_);
+    const int scaled_height = (height + ratio - 1) / ratio;
+    const int scaled_width = (width + ratio - 1) / ratio;
+    decode->flags.ratio = ratio;
+    decode->flags.crop = true;
+    decode->flags.crop_y = crop_y / ratio;
+    decode->flags.crop_x = crop_x / ratio;
+    decode->height = std::min(std::max(1, crop_height / ratio),
+                              scaled_height - decode->flags.crop_y);
+    decode->width = std::min(std::max(1, crop_width / ratio),
+                             scaled_width - decode->flags.crop_x);
+    decode->flags.crop_height = decode->height;
+    decode->flags.crop_width = decode->width;
+  }
+
+  int channels_;
+  int target_height_;
+  int target_width_;
+  jpeg::UncompressFlags flags_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("DecodeJpegBatch").Device(DEVICE_CPU),
+                        DecodeJpegBatchOp);
+
+}  // namespace
+}  // namespace tensorflow
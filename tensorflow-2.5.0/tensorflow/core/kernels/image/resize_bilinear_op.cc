@@ -22,10 +22,7 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/image/resize_bilinear_op.h"
 
-#ifdef __SSE4_1__
-#include <xmmintrin.h>
-#endif
-
+#include <algorithm>
 #include <memory>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -105,156 +102,105 @@ inline void compute_interpolation_weights(const Scaler scaler,
   }
 }
 
-/**
- * Computes the bilinear interpolation from the appropriate 4 float points
- * and the linear interpolation weights.
- */
-inline float compute_lerp(const float top_left, const float top_right,
-                          const float bottom_left, const float bottom_right,
-                          const float x_lerp, const float y_lerp) {
-  const float top = top_left + (top_right - top_left) * x_lerp;
-  const float bottom = bottom_left + (bottom_right - bottom_left) * x_lerp;
-  return top + (bottom - top) * y_lerp;
-}
-
-#ifdef __SSE4_1__
-/* Vector version of the above */
-inline __m128 compute_lerp_v(const __m128 top_left, const __m128 top_right,
-                             const __m128 bottom_left,
-                             const __m128 bottom_right, const __m128 x_lerp,
-                             const __m128 y_lerp) {
-  const __m128 top =
-      _mm_add_ps(top_left, _mm_mul_ps(_mm_sub_ps(top_right, top_left), x_lerp));
-  const __m128 bottom = _mm_add_ps(
-      bottom_left, _mm_mul_ps(_mm_sub_ps(bottom_right, bottom_left), x_lerp));
-  return _mm_add_ps(top, _mm_mul_ps(_mm_sub_ps(bottom, top), y_lerp));
-}
-#endif
-
-template <typename T>
-void ResizeLineChannels(const T* const ys_input_lower_ptr,
-                        const T* const ys_input_upper_ptr,
-                        const CachedInterpolation* const xs,
-                        const float ys_lerp, const int64 out_width,
-                        float* out_y, const int channels) {
+// Interpolates one input row along the x axis into 'out_row', which holds
+// out_width * channels floats. 'channels' is known at compile time when
+// kChannels > 0, which lets the channel loop be unrolled.
+template <int kChannels, typename T>
+void ResizeRowHorizontalChannels(const T* const in_row,
+                                 const CachedInterpolation* const xs,
+                                 const int64 out_width, const int channels,
+                                 float* out_row) {
+  const int num_channels = kChannels > 0 ? kChannels : channels;
   for (int64 x = 0; x < out_width; ++x) {
-    const int64 xs_lower = xs[x].lower;
-    const int64 xs_upper = xs[x].upper;
+    const T* const left = in_row + xs[x].lower;
+    const T* const right = in_row + xs[x].upper;
     const float xs_lerp = xs[x].lerp;
-
-    for (int c = 0; c < channels; ++c) {
-      const float top_left(ys_input_lower_ptr[xs_lower + c]);
-      const float top_right(ys_input_lower_ptr[xs_upper + c]);
-      const float bottom_left(ys_input_upper_ptr[xs_lower + c]);
-      const float bottom_right(ys_input_upper_ptr[xs_upper + c]);
-
-      out_y[x * channels + c] = compute_lerp(top_left, top_right, bottom_left,
-                                             bottom_right, xs_lerp, ys_lerp);
+    for (int c = 0; c < num_channels; ++c) {
+      const float l(left[c]);
+      const float r(right[c]);
+      out_row[c] = l + (r - l) * xs_lerp;
     }
+    out_row += num_channels;
   }
 }
 
-#ifdef __SSE4_1__
-
-// Load 3 floats from the given buffer, which must be of size at least 4.
 template <typename T>
-inline __m128 load_3xfloat_v(T* values) {
-  return _mm_set_ps(0.0f, static_cast<float>(values[2]),
-                    static_cast<float>(values[1]),
-                    static_cast<float>(values[0]));
-}
-
-// Specialize cases that can be done more efficiently.
-template <>
-inline __m128 load_3xfloat_v(float* values) {
-  return _mm_loadu_ps(values);
-}
-
-template <typename T>
-void ResizeLine3ChannelsVector(const T* const ys_input_lower_ptr,
-                               const T* const ys_input_upper_ptr,
-                               const CachedInterpolation* const xs,
-                               const float ys_lerp, const int64 out_width,
-                               float* out_y) {
-  const __m128 ys_lerp_v = _mm_set1_ps(ys_lerp);
-  // All pixels but the last one can overflow, vectorize the inside of the
-  // row.
-  int64 x = 0;
-  for (x = 0; x < out_width - 1; ++x) {
-    const int64 xs_lower = xs[x].lower;
-    const int64 xs_upper = xs[x].upper;
-    const __m128 xs_lerp_v = _mm_set1_ps(xs[x].lerp);
-
-    const __m128 top_left_v = load_3xfloat_v(ys_input_lower_ptr + xs_lower);
-    const __m128 top_right_v = load_3xfloat_v(ys_input_lower_ptr + xs_upper);
-    const __m128 bottom_left_v = load_3xfloat_v(ys_input_upper_ptr + xs_lower);
-    const __m128 bottom_right_v = load_3xfloat_v(ys_input_upper_ptr + xs_upper);
-
-    _mm_storeu_ps(out_y + x * 3,
-                  compute_lerp_v(top_left_v, top_right_v, bottom_left_v,
-                                 bottom_right_v, xs_lerp_v, ys_lerp_v));
+void ResizeRowHorizontal(const T* const in_row,
+                         const CachedInterpolation* const xs,
+                         const int64 out_width, const int channels,
+                         float* out_row) {
+  switch (channels) {
+    case 1:
+      ResizeRowHorizontalChannels<1>(in_row, xs, out_width, channels, out_row);
+      break;
+    case 3:
+      ResizeRowHorizontalChannels<3>(in_row, xs, out_width, channels, out_row);
+      break;
+    case 4:
+      ResizeRowHorizontalChannels<4>(in_row, xs, out_width, channels, out_row);
+      break;
+    default:
+      ResizeRowHorizontalChannels<0>(in_row, xs, out_width, channels, out_row);
   }
-  // The last pixel of each row must be done in a non-vectorized way
-  // because we cannot overflow.
-  ResizeLineChannels(ys_input_lower_ptr, ys_input_upper_ptr, xs + out_width - 1,
-                     ys_lerp, 1, out_y + (out_width - 1) * 3, 3);
 }
-#endif
 
+// Resizes the output rows [begin, end) of the flattened [batch, out_height]
+// output in two separable passes. Each input row needed by the range is
+// interpolated along x once into a float row buffer, which is kept while
+// consecutive output rows read it. The output rows are then interpolated along
+// y from two row buffers with packet math.
 template <typename T>
-void resize_image(
-    typename TTypes<T, 4>::ConstTensor images, const int batch_size,
-    const int64 in_height, const int64 in_width, const int64 out_height,
-    const int64 out_width, const int channels,
-    const std::vector<CachedInterpolation>& xs,
-    const std::vector<CachedInterpolation>& ys,
-    typename TTypes<float, 4>::Tensor output) TF_ATTRIBUTE_NOINLINE;
-template <typename T>
-void resize_image(typename TTypes<T, 4>::ConstTensor images,
-                  const int batch_size, const int64 in_height,
-                  const int64 in_width, const int64 out_height,
-                  const int64 out_width, const int channels,
-                  const std::vector<CachedInterpolation>& xs_vec,
-                  const std::vector<CachedInterpolation>& ys,
-                  typename TTypes<float, 4>::Tensor output) {
+void ResizeImageRows(typename TTypes<T, 4>::ConstTensor images,
+                     const int64 in_height, const int64 in_width,
+                     const int64 out_height, const int64 out_width,
+                     const int channels,
+                     const std::vector<CachedInterpolation>& xs,
+                     const std::vector<CachedInterpolation>& ys,
+                     typename TTypes<float, 4>::Tensor output,
+                     const int64 begin, const int64 end) {
   const int64 in_row_size = in_width * channels;
-  const int64 in_batch_num_values = in_height * in_row_size;
   const int64 out_row_size = out_width * channels;
-
-  const T* input_b_ptr = images.data();
-  const CachedInterpolation* xs = xs_vec.data();
-
-  if (channels == 3) {
-    float* output_y_ptr = output.data();
-    for (int b = 0; b < batch_size; ++b) {
-      for (int64 y = 0; y < out_height; ++y) {
-        const T* ys_input_lower_ptr = input_b_ptr + ys[y].lower * in_row_size;
-        const T* ys_input_upper_ptr = input_b_ptr + ys[y].upper * in_row_size;
-#ifdef __SSE4_1__
-        ResizeLine3ChannelsVector(ys_input_lower_ptr, ys_input_upper_ptr, xs,
-                                  ys[y].lerp, out_width, output_y_ptr);
-#else
-        ResizeLineChannels(ys_input_lower_ptr, ys_input_upper_ptr, xs,
-                           ys[y].lerp, out_width, output_y_ptr, 3);
-#endif
-        output_y_ptr += out_row_size;
+  using Row = Eigen::Map<Eigen::ArrayXf>;
+  using ConstRow = Eigen::Map<const Eigen::ArrayXf>;
+
+  std::vector<float> buffers(2 * out_row_size);
+  float* top = buffers.data();
+  float* bottom = top + out_row_size;
+  // The input rows, counted over the whole batch, held in 'top' and 'bottom'.
+  int64 top_row = -1;
+  int64 bottom_row = -1;
+  auto load_row = [&](int64 row, float* buffer) {
+    ResizeRowHorizontal(images.data() + row * in_row_size, xs.data(),
+                        out_width, channels, buffer);
+  };
+
+  for (int64 i = begin; i < end; ++i) {
+    const int64 b = i / out_height;
+    const CachedInterpolation& y = ys[i % out_height];
+    const int64 lower = b * in_height + y.lower;
+    const int64 upper = b * in_height + y.upper;
+    if (lower != top_row) {
+      if (lower == bottom_row) {
+        // Moving down: the previous bottom row becomes the top row.
+        std::swap(top, bottom);
+        std::swap(top_row, bottom_row);
+      } else {
+        load_row(lower, top);
+        top_row = lower;
       }
-      input_b_ptr += in_batch_num_values;
     }
-  } else {
-    float* output_y_ptr = output.data();
-    for (int b = 0; b < batch_size; ++b) {
-      for (int64 y = 0; y < out_height; ++y) {
-        const T* ys_input_lower_ptr = input_b_ptr + ys[y].lower * in_row_size;
-        const T* ys_input_upper_ptr = input_b_ptr + ys[y].upper * in_row_size;
-
-        ResizeLineChannels(ys_input_lower_ptr, ys_input_upper_ptr, xs,
-                           ys[y].lerp, out_width, output_y_ptr, channels);
-
-        output_y_ptr += out_row_size;
-      }
-      input_b_ptr += in_batch_num_values;
+    Row out_row(output.data() + i * out_row_size, out_row_size);
+    if (upper == lower || y.lerp == 0) {
+      out_row = ConstRow(top, out_row_size);
+      continue;
+    }
+    if (upper != bottom_row) {
+      load_row(upper, bottom);
+      bottom_row = upper;
     }
+    ConstRow top_values(top, out_row_size);
+    ConstRow bottom_values(bottom, out_row_size);
+    out_row = top_values + (bottom_values - top_values) * y.lerp;
   }
 }
 
@@ -324,8 +270,19 @@ struct ResizeBilinear<CPUDevice, T> {
       xs[i].upper *= channels;
     }
 
-    resize_image<T>(images, batch_size, in_height, in_width, out_height,
-                    out_width, channels, xs, ys, output);
+    // Each output row takes a horizontal pass over up to two input rows and a
+    // vertical pass over the output row.
+    const int64 out_row_size = out_width * channels;
+    const Eigen::TensorOpCost cost(
+        /*bytes_loaded=*/2 * out_row_size * (sizeof(T) + sizeof(float)),
+        /*bytes_stored=*/out_row_size * sizeof(float),
+        /*compute_cycles=*/4 * out_row_size);
+    d.parallelFor(batch_size * out_height, cost,
+                  [&](Eigen::Index begin, Eigen::Index end) {
+                    ResizeImageRows<T>(images, in_height, in_width, out_height,
+                                       out_width, channels, xs, ys, output,
+                                       begin, end);
+                  });
   }
 };
 }  // namespace functor
@@ -22,6 +22,8 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_types.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 
 namespace tensorflow {
 
@@ -41,6 +43,13 @@ class ImmutableConstantOp : public OpKernel {
   string region_name_;
   DataType dtype_;
   TensorShape shape_;
+
+  // The tensor aliasing the memory region, mapped on the first Compute() and
+  // returned by every later one.
+  mutex mu_;
+  Tensor tensor_ TF_GUARDED_BY(mu_);
+  bool initialized_ TF_GUARDED_BY(mu_) = false;
+
   TF_DISALLOW_COPY_AND_ASSIGN(ImmutableConstantOp);
 };
 
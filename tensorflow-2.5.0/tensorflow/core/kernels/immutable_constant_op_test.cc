@@ -117,6 +117,12 @@ TEST(ImmutableConstantOpTest, Simple) {
   EXPECT_EQ(outputs.front().flat<float>()(1), 2.0f * 3.0f);
   EXPECT_EQ(outputs.front().flat<float>()(2), 2.0f * 3.0f);
   EXPECT_EQ(outputs.front().flat<float>()(kTestTensorSize - 1), 2.0f * 3.0f);
+
+  // The region is mapped once and reused by later steps.
+  outputs.clear();
+  TF_ASSERT_OK(session->Run({}, {result.node()->name() + ":0"}, {}, &outputs));
+  ASSERT_EQ(outputs.size(), 1);
+  EXPECT_EQ(outputs.front().flat<float>()(0), 2.0f * 3.0f);
 }
 
 // Creates a test graph with two immutable_const tensors and a simple math
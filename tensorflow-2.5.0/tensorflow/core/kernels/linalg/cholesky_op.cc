@@ -57,6 +57,16 @@ class CholeskyOp : public LinearAlgebraOp<Scalar> {
       // Therefore, we return X.
       return;
     }
+    // Use fixed-size decompositions for tiny matrices, which avoid heap
+    // allocation and are unrolled; batches of these are common.
+    switch (input.rows()) {
+      case 2:
+        return ComputeFixedSize<2>(context, input, &outputs->at(0));
+      case 3:
+        return ComputeFixedSize<3>(context, input, &outputs->at(0));
+      case 4:
+        return ComputeFixedSize<4>(context, input, &outputs->at(0));
+    }
     // Perform the actual LL^T Cholesky decomposition. This will only use
     // the lower triangular part of data_in by default. The upper triangular
     // part of the matrix will not be read.
@@ -70,6 +80,17 @@ class CholeskyOp : public LinearAlgebraOp<Scalar> {
     // Output the lower triangular in a dense form.
     outputs->at(0) = llt_decomposition.matrixL();
   }
+
+ private:
+  template <int N>
+  void ComputeFixedSize(OpKernelContext* context, const ConstMatrixMap& input,
+                        MatrixMap* output) {
+    using FixedMatrix = Eigen::Matrix<Scalar, N, N, Eigen::RowMajor>;
+    Eigen::LLT<FixedMatrix> llt_decomposition{FixedMatrix(input)};
+    OP_REQUIRES(context, llt_decomposition.info() == Eigen::Success,
+                errors::InvalidArgument(kErrMsg));
+    *output = llt_decomposition.matrixL();
+  }
 };
 
 #if GOOGLE_CUDA
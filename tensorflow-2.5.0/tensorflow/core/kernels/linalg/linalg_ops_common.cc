@@ -100,11 +100,23 @@ void LinearAlgebraOp<InputScalar, OutputScalar>::Compute(
                  &output_matrix_shapes);
   if (!context->status().ok()) return;
 
+  // Resolve the buffers and matrix sizes once rather than for every matrix,
+  // which matters for large batches of small matrices.
+  MatrixSlices slices;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    slices.input_data.push_back(inputs[i]->flat<InputScalar>().data());
+    slices.input_sizes.push_back(input_matrix_shapes[i].num_elements());
+  }
+  for (size_t i = 0; i < output_matrix_shapes.size(); ++i) {
+    slices.output_data.push_back(outputs[i]->flat<OutputScalar>().data());
+    slices.output_sizes.push_back(output_matrix_shapes[i].num_elements());
+  }
+
   // Process the individual matrix problems in parallel using a threadpool.
-  auto shard = [this, &inputs, &input_matrix_shapes, &outputs,
-                &output_matrix_shapes, context](int64 begin, int64 end) {
+  auto shard = [this, &slices, &input_matrix_shapes, &output_matrix_shapes,
+                context](int64 begin, int64 end) {
     for (int64 i = begin; i < end; ++i) {
-      ComputeTensorSlice(context, i, inputs, input_matrix_shapes, outputs,
+      ComputeTensorSlice(context, i, slices, input_matrix_shapes,
                          output_matrix_shapes);
     }
   };
@@ -218,16 +230,15 @@ void LinearAlgebraOp<InputScalar, OutputScalar>::PrepareOutputs(
 
 template <class InputScalar, class OutputScalar>
 void LinearAlgebraOp<InputScalar, OutputScalar>::ComputeTensorSlice(
-    OpKernelContext* context, int64 matrix_index, const TensorInputs& inputs,
-    const TensorShapes& input_matrix_shapes, const TensorOutputs& outputs,
+    OpKernelContext* context, int64 matrix_index, const MatrixSlices& slices,
+    const TensorShapes& input_matrix_shapes,
     const TensorShapes& output_matrix_shapes) {
   InputConstMatrixMaps matrix_inputs;
-  for (size_t i = 0; i < inputs.size(); ++i) {
+  for (size_t i = 0; i < slices.input_data.size(); ++i) {
     // TODO(kalakris): Handle alignment if possible. Eigen::Map is
     // unaligned by default.
     matrix_inputs.emplace_back(
-        inputs[i]->flat<InputScalar>().data() +
-            matrix_index * input_matrix_shapes[i].num_elements(),
+        slices.input_data[i] + matrix_index * slices.input_sizes[i],
         input_matrix_shapes[i].dim_size(0), input_matrix_shapes[i].dim_size(1));
   }
 
@@ -241,8 +252,7 @@ void LinearAlgebraOp<InputScalar, OutputScalar>::ComputeTensorSlice(
                               ? output_matrix_shapes[i].dim_size(1)
                               : 1;
     matrix_outputs.emplace_back(
-        outputs[i]->flat<OutputScalar>().data() +
-            matrix_index * output_matrix_shapes[i].num_elements(),
+        slices.output_data[i] + matrix_index * slices.output_sizes[i],
         num_output_rows, num_output_cols);
   }
   ComputeMatrix(context, matrix_inputs, &matrix_outputs);
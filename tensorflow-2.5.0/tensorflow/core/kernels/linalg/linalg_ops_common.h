@@ -153,6 +153,14 @@ class LinearAlgebraOp : public OpKernel {
  private:
   using TensorInputs = gtl::InlinedVector<const Tensor*, 4>;
   using TensorOutputs = gtl::InlinedVector<Tensor*, 4>;
+  // Base pointers and per-matrix element counts of the input and output
+  // tensors, resolved once per Compute() call.
+  struct MatrixSlices {
+    gtl::InlinedVector<const InputScalar*, 4> input_data;
+    gtl::InlinedVector<int64, 4> input_sizes;
+    gtl::InlinedVector<OutputScalar*, 4> output_data;
+    gtl::InlinedVector<int64, 4> output_sizes;
+  };
   // This function maps 2-d slices (matrices) of the input and output tensors
   // using Eigen::Map and calls ComputeMatrix implemented in terms of the
   // Eigen::MatrixBase API by the derived class.
@@ -161,19 +169,16 @@ class LinearAlgebraOp : public OpKernel {
   // from each input tensor, and the index of the matrix to be written to each
   // output tensor. The input matrices are in row major order, and located at
   // the memory addresses
-  //   inputs[i].flat<Scalar>().data() +
-  //   matrix_index * input_matrix_shapes[i].num_elements()
+  //   slices.input_data[i] + matrix_index * slices.input_sizes[i]
   // for i in 0...inputs.size()-1.
   // The output matrices are in row major order, and located at the memory
   // address
-  //   outputs[i]->flat<Scalar>().data() +
-  //   matrix_index * output_matrix_shapes[i].num_elements().
+  //   slices.output_data[i] + matrix_index * slices.output_sizes[i]
   // for i in 0...outputs.size()-1.
   //
   void ComputeTensorSlice(OpKernelContext* context, int64 matrix_index,
-                          const TensorInputs& inputs,
+                          const MatrixSlices& slices,
                           const TensorShapes& input_matrix_shapes,
-                          const TensorOutputs& outputs,
                           const TensorShapes& output_matrix_shapes);
 
   void AnalyzeInputs(OpKernelContext* context, TensorInputs* inputs,
@@ -55,6 +55,16 @@ class MatrixInverseOp : public LinearAlgebraOp<Scalar> {
       // By definition, an empty matrix's inverse is an empty matrix.
       return;
     }
+    // Batches of tiny matrices are common (e.g. geometry); use fixed-size
+    // decompositions for them, which avoid heap allocation and are unrolled.
+    switch (input.rows()) {
+      case 2:
+        return ComputeFixedSize<2>(context, input, &outputs->at(0));
+      case 3:
+        return ComputeFixedSize<3>(context, input, &outputs->at(0));
+      case 4:
+        return ComputeFixedSize<4>(context, input, &outputs->at(0));
+    }
     Eigen::PartialPivLU<Matrix> lu_decomposition;
     if (adjoint_) {
       // TODO(rmlarsen): For Eigen 3.2, this creates a temporary copy.
@@ -78,6 +88,24 @@ class MatrixInverseOp : public LinearAlgebraOp<Scalar> {
   }
 
  private:
+  template <int N>
+  void ComputeFixedSize(OpKernelContext* context, const ConstMatrixMap& input,
+                        MatrixMap* output) {
+    using FixedMatrix = Eigen::Matrix<Scalar, N, N, Eigen::RowMajor>;
+    Eigen::PartialPivLU<FixedMatrix> lu_decomposition;
+    if (adjoint_) {
+      lu_decomposition.compute(FixedMatrix(input.adjoint()));
+    } else {
+      lu_decomposition.compute(FixedMatrix(input));
+    }
+    // Same exact-zero pivot check as in ComputeMatrix.
+    const RealScalar min_abs_pivot =
+        lu_decomposition.matrixLU().diagonal().cwiseAbs().minCoeff();
+    OP_REQUIRES(context, min_abs_pivot > RealScalar(0),
+                errors::InvalidArgument("Input is not invertible."));
+    output->noalias() = lu_decomposition.inverse();
+  }
+
   bool adjoint_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(MatrixInverseOp);
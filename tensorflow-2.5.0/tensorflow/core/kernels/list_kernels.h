@@ -113,6 +113,12 @@ class TensorListStack : public OpKernel {
                     partial_element_shape.DebugString()));
     TensorShape output_shape = element_shape;
     output_shape.InsertDim(0, tensor_list->tensors().size());
+    Tensor stacked;
+    if (tensor_list->GetStacked(&stacked) && stacked.shape() == output_shape) {
+      // The elements are the unmodified rows of a single tensor; return it.
+      c->set_output(0, stacked);
+      return;
+    }
     Tensor* output;
     OP_REQUIRES_OK(c, c->allocate_output(0, output_shape, &output));
     if (output->NumElements() == 0) {
@@ -671,12 +677,23 @@ class TensorListFromTensor : public OpKernel {
                     " from a tensor with shape ", output_shape.DebugString()));
     output_list.element_shape = element_shape;
     output_list.tensors().reserve(t.shape().dim_size(0));
+    // When every row of `t` is aligned, the elements alias `t` directly, and
+    // `TensorListStack` can later return `t` itself instead of concatenating.
+    // A ref input may be assigned to in place afterwards, so the list copies
+    // it to keep a snapshot.
+    bool all_rows_aliased =
+        DataTypeCanUseMemcpy(t.dtype()) && !IsRefType(c->input_type(0));
     for (int i = 0; i < t.shape().dim_size(0); ++i) {
       Tensor tmp = t.Slice(i, i + 1);
       TensorShape tmp_shape = tmp.shape();
       tmp_shape.RemoveDim(0);
       OP_REQUIRES(c, tmp.CopyFrom(tmp, tmp_shape),
                   errors::Unknown("Unexpected shape error."));
+      if (all_rows_aliased && tmp.IsAligned()) {
+        output_list.tensors().push_back(tmp);
+        continue;
+      }
+      all_rows_aliased = false;
       // TODO(apassos) maybe not always align; but weird compiler bugs seem to
       // prevent this.
       Tensor aligned;
@@ -685,6 +702,9 @@ class TensorListFromTensor : public OpKernel {
           tmp.unaligned_flat<T>();
       output_list.tensors().push_back(aligned);
     }
+    if (all_rows_aliased) {
+      output_list.set_stacked(t);
+    }
     output_tensor->scalar<Variant>()() = std::move(output_list);
   }
 };
@@ -16,9 +16,12 @@ limitations under the License.
 #include "tensorflow/core/kernels/lookup_table_op.h"
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <array>
 #include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.h"
@@ -26,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/initializable_lookup_table.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/platform/prefetch.h"
 #include "tensorflow/core/platform/random.h"
 
 namespace tensorflow {
@@ -36,11 +40,182 @@ std::string UniqueNodeName(const std::string& base) {
   return strings::StrCat(base, "/", counter.fetch_add(1), "/", random::New64());
 }
 
+namespace {
+
+// Number of independently locked stripes that the keys of a MutableHashTable
+// are spread over. Find, Insert and Remove only lock the stripes their keys
+// hash to, so concurrent lookups and inserts on one table rarely contend.
+constexpr int kNumTableStripes = 16;
+
+template <typename T>
+inline int StripeIndex(const T& key) {
+  // std::hash is the identity for integers, so mix the bits before picking a
+  // stripe to keep consecutive ids from clustering.
+  const uint64 h =
+      static_cast<uint64>(std::hash<T>()(key)) * 0x9E3779B97F4A7C15ULL;
+  return static_cast<int>((h >> 32) % kNumTableStripes);
+}
+
+// An unordered_map split into kNumTableStripes stripes, each guarded by its
+// own mutex. Whole-table operations (import, export) lock every stripe in
+// index order, so they observe and produce a consistent snapshot.
+template <class K, class V>
+class StripedHashMap {
+ public:
+  typedef std::unordered_map<K, V> Map;
+  typedef std::array<const Map*, kNumTableStripes> ConstMaps;
+
+  size_t size() const {
+    size_t total = 0;
+    for (const Stripe& stripe : stripes_) {
+      tf_shared_lock l(stripe.mu);
+      total += stripe.map.size();
+    }
+    return total;
+  }
+
+  // Calls `fn(map, i)` for each index `i` of `keys`, where `map` is the
+  // read-locked stripe that `keys(i)` belongs to.
+  template <typename Fn>
+  void ForEachKey(typename TTypes<K>::ConstFlat keys, Fn fn) const {
+    std::vector<int64> order;
+    std::array<int64, kNumTableStripes + 1> offsets;
+    GroupByStripe(keys, &order, &offsets);
+    for (int s = 0; s < kNumTableStripes; ++s) {
+      if (offsets[s] == offsets[s + 1]) continue;
+      const Stripe& stripe = stripes_[s];
+      tf_shared_lock l(stripe.mu);
+      for (int64 j = offsets[s]; j < offsets[s + 1]; ++j) {
+        fn(stripe.map, order[j]);
+      }
+    }
+  }
+
+  // Calls `fn(&map, i)` for each index `i` of `keys`, where `map` is the
+  // write-locked stripe that `keys(i)` belongs to. If `clear` is true, the
+  // whole table is emptied first and stays locked until all keys are seen.
+  template <typename Fn>
+  void MutateEachKey(typename TTypes<K>::ConstFlat keys, bool clear, Fn fn) {
+    if (clear) {
+      LockAll();
+      for (Stripe& stripe : stripes_) {
+        ClearLocked(&stripe);
+      }
+      for (int64 i = 0; i < keys.size(); ++i) {
+        fn(MapLocked(&stripes_[StripeIndex(
+               SubtleMustCopyIfIntegral(keys(i)))]),
+           i);
+      }
+      UnlockAll();
+      return;
+    }
+    std::vector<int64> order;
+    std::array<int64, kNumTableStripes + 1> offsets;
+    GroupByStripe(keys, &order, &offsets);
+    for (int s = 0; s < kNumTableStripes; ++s) {
+      if (offsets[s] == offsets[s + 1]) continue;
+      Stripe& stripe = stripes_[s];
+      mutex_lock l(stripe.mu);
+      for (int64 j = offsets[s]; j < offsets[s + 1]; ++j) {
+        fn(&stripe.map, order[j]);
+      }
+    }
+  }
+
+  // Calls `fn(maps)` with every stripe read-locked, giving `fn` a consistent
+  // view of the whole table.
+  template <typename Fn>
+  void ReadAll(Fn fn) const TF_NO_THREAD_SAFETY_ANALYSIS {
+    ConstMaps maps;
+    for (int s = 0; s < kNumTableStripes; ++s) {
+      stripes_[s].mu.lock_shared();
+      maps[s] = &stripes_[s].map;
+    }
+    fn(maps);
+    for (int s = kNumTableStripes - 1; s >= 0; --s) {
+      stripes_[s].mu.unlock_shared();
+    }
+  }
+
+ private:
+  struct Stripe {
+    mutable mutex mu;
+    Map map TF_GUARDED_BY(mu);
+  };
+
+  // Stores in `order` the indices of `keys` sorted by stripe, such that the
+  // keys of stripe `s` are at order[offsets[s]] ... order[offsets[s + 1] - 1].
+  static void GroupByStripe(typename TTypes<K>::ConstFlat keys,
+                            std::vector<int64>* order,
+                            std::array<int64, kNumTableStripes + 1>* offsets) {
+    const int64 num_keys = keys.size();
+    std::vector<uint8> stripe_of(num_keys);
+    offsets->fill(0);
+    for (int64 i = 0; i < num_keys; ++i) {
+      stripe_of[i] = StripeIndex(SubtleMustCopyIfIntegral(keys(i)));
+      ++(*offsets)[stripe_of[i] + 1];
+    }
+    for (int s = 0; s < kNumTableStripes; ++s) {
+      (*offsets)[s + 1] += (*offsets)[s];
+    }
+    std::array<int64, kNumTableStripes> next;
+    std::copy(offsets->begin(), offsets->begin() + kNumTableStripes,
+              next.begin());
+    order->resize(num_keys);
+    for (int64 i = 0; i < num_keys; ++i) {
+      (*order)[next[stripe_of[i]]++] = i;
+    }
+  }
+
+  void LockAll() TF_NO_THREAD_SAFETY_ANALYSIS {
+    for (Stripe& stripe : stripes_) {
+      stripe.mu.lock();
+    }
+  }
+
+  void UnlockAll() TF_NO_THREAD_SAFETY_ANALYSIS {
+    for (int s = kNumTableStripes - 1; s >= 0; --s) {
+      stripes_[s].mu.unlock();
+    }
+  }
+
+  // Must only be called between LockAll() and UnlockAll().
+  static Map* MapLocked(Stripe* stripe) TF_NO_THREAD_SAFETY_ANALYSIS {
+    return &stripe->map;
+  }
+  static void ClearLocked(Stripe* stripe) TF_NO_THREAD_SAFETY_ANALYSIS {
+    stripe->map.clear();
+  }
+
+  std::array<Stripe, kNumTableStripes> stripes_;
+};
+
+// Returns the number of slots used by the buckets of `map`, where an empty
+// bucket counts as one slot.
+template <class Map>
+int64 BucketMemory(const Map& map) {
+  int64 ret = 0;
+  for (unsigned i = 0; i < map.bucket_count(); ++i) {
+    size_t bucket_size = map.bucket_size(i);
+    if (bucket_size == 0) {
+      ret++;
+    } else {
+      ret += bucket_size;
+    }
+  }
+  return ret;
+}
+
+}  // namespace
+
 // Lookup table that wraps an unordered_map, where the key and value data type
 // is specified. Each individual value must be a scalar. If vector values are
 // required, use MutableHashTableOfTensors.
 //
 // This table is mutable and thread safe - Insert can be called at any time.
+// The keys are striped over several independently locked maps (see
+// StripedHashMap), so lookups and inserts that run concurrently only contend
+// when their keys hash to the same stripe.
 //
 // Sample use case:
 //
@@ -55,10 +230,7 @@ class MutableHashTableOfScalars final : public LookupInterface {
  public:
   MutableHashTableOfScalars(OpKernelContext* ctx, OpKernel* kernel) {}
 
-  size_t size() const override {
-    tf_shared_lock l(mu_);
-    return table_.size();
-  }
+  size_t size() const override { return table_.size(); }
 
   Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
               const Tensor& default_value) override {
@@ -70,8 +242,7 @@ class MutableHashTableOfScalars final : public LookupInterface {
     int64 default_total = default_flat.size();
     bool is_full_size_default = (total == default_total);
 
-    tf_shared_lock l(mu_);
-    for (int64 i = 0; i < key_values.size(); ++i) {
+    table_.ForEachKey(key_values, [&](const Map& map, int64 i) {
       // is_full_size_default is true:
       //   Each key has an independent default value, key_values(i)
       //   corresponding uses default_flat(i) as its default value.
@@ -79,9 +250,9 @@ class MutableHashTableOfScalars final : public LookupInterface {
       // is_full_size_default is false:
       //   All keys will share the default_flat(0) as default value.
       value_values(i) = gtl::FindWithDefault(
-          table_, SubtleMustCopyIfIntegral(key_values(i)),
+          map, SubtleMustCopyIfIntegral(key_values(i)),
           is_full_size_default ? default_flat(i) : default_flat(0));
-    }
+    });
 
     return Status::OK();
   }
@@ -90,14 +261,10 @@ class MutableHashTableOfScalars final : public LookupInterface {
     const auto key_values = keys.flat<K>();
     const auto value_values = values.flat<V>();
 
-    mutex_lock l(mu_);
-    if (clear) {
-      table_.clear();
-    }
-    for (int64 i = 0; i < key_values.size(); ++i) {
-      gtl::InsertOrUpdate(&table_, SubtleMustCopyIfIntegral(key_values(i)),
+    table_.MutateEachKey(key_values, clear, [&](Map* map, int64 i) {
+      gtl::InsertOrUpdate(map, SubtleMustCopyIfIntegral(key_values(i)),
                           SubtleMustCopyIfIntegral(value_values(i)));
-    }
+    });
     return Status::OK();
   }
 
@@ -109,10 +276,9 @@ class MutableHashTableOfScalars final : public LookupInterface {
   Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
     const auto key_values = keys.flat<K>();
 
-    mutex_lock l(mu_);
-    for (int64 i = 0; i < key_values.size(); ++i) {
-      table_.erase(SubtleMustCopyIfIntegral(key_values(i)));
-    }
+    table_.MutateEachKey(key_values, false, [&](Map* map, int64 i) {
+      map->erase(SubtleMustCopyIfIntegral(key_values(i)));
+    });
     return Status::OK();
   }
 
@@ -122,24 +288,31 @@ class MutableHashTableOfScalars final : public LookupInterface {
   }
 
   Status ExportValues(OpKernelContext* ctx) override {
-    tf_shared_lock l(mu_);
-    int64 size = table_.size();
-
-    Tensor* keys;
-    Tensor* values;
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("keys", TensorShape({size}), &keys));
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("values", TensorShape({size}), &values));
-
-    auto keys_data = keys->flat<K>();
-    auto values_data = values->flat<V>();
-    int64 i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
-      keys_data(i) = it->first;
-      values_data(i) = it->second;
-    }
-    return Status::OK();
+    Status status;
+    table_.ReadAll([&](const typename Table::ConstMaps& maps) {
+      int64 size = 0;
+      for (const Map* map : maps) {
+        size += map->size();
+      }
+
+      Tensor* keys;
+      Tensor* values;
+      status = ctx->allocate_output("keys", TensorShape({size}), &keys);
+      if (!status.ok()) return;
+      status = ctx->allocate_output("values", TensorShape({size}), &values);
+      if (!status.ok()) return;
+
+      auto keys_data = keys->flat<K>();
+      auto values_data = values->flat<V>();
+      int64 i = 0;
+      for (const Map* map : maps) {
+        for (auto it = map->begin(); it != map->end(); ++it, ++i) {
+          keys_data(i) = it->first;
+          values_data(i) = it->second;
+        }
+      }
+    });
+    return status;
   }
 
   DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
@@ -152,21 +325,19 @@ class MutableHashTableOfScalars final : public LookupInterface {
 
   int64 MemoryUsed() const override {
     int64 ret = 0;
-    tf_shared_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
+    table_.ReadAll([&](const typename Table::ConstMaps& maps) {
+      for (const Map* map : maps) {
+        ret += BucketMemory(*map);
       }
-    }
+    });
     return sizeof(MutableHashTableOfScalars) + ret;
   }
 
  private:
-  mutable mutex mu_;
-  std::unordered_map<K, V> table_ TF_GUARDED_BY(mu_);
+  typedef StripedHashMap<K, V> Table;
+  typedef typename Table::Map Map;
+
+  Table table_;
 };
 
 // Lookup table that wraps an unordered_map. Behaves identical to
@@ -183,10 +354,7 @@ class MutableHashTableOfTensors final : public LookupInterface {
                                 value_shape_.DebugString()));
   }
 
-  size_t size() const override {
-    tf_shared_lock l(mu_);
-    return table_.size();
-  }
+  size_t size() const override { return table_.size(); }
 
   Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
               const Tensor& default_value) override {
@@ -199,10 +367,9 @@ class MutableHashTableOfTensors final : public LookupInterface {
     int64 default_total = default_flat.size();
     bool is_full_size_default = (total == default_total);
 
-    tf_shared_lock l(mu_);
-    for (int64 i = 0; i < key_values.size(); ++i) {
-      ValueArray* value_vec =
-          gtl::FindOrNull(table_, SubtleMustCopyIfIntegral(key_values(i)));
+    table_.ForEachKey(key_values, [&](const Map& map, int64 i) {
+      const ValueArray* value_vec =
+          gtl::FindOrNull(map, SubtleMustCopyIfIntegral(key_values(i)));
       if (value_vec != nullptr) {
         for (int64 j = 0; j < value_dim; j++) {
           value_values(i, j) = value_vec->at(j);
@@ -219,7 +386,7 @@ class MutableHashTableOfTensors final : public LookupInterface {
               is_full_size_default ? default_flat(i, j) : default_flat(0, j);
         }
       }
-    }
+    });
 
     return Status::OK();
   }
@@ -229,19 +396,15 @@ class MutableHashTableOfTensors final : public LookupInterface {
     const auto value_values = values.flat_inner_dims<V, 2>();
     int64 value_dim = value_shape_.dim_size(0);
 
-    mutex_lock l(mu_);
-    if (clear) {
-      table_.clear();
-    }
-    for (int64 i = 0; i < key_values.size(); ++i) {
+    table_.MutateEachKey(key_values, clear, [&](Map* map, int64 i) {
       ValueArray value_vec;
       for (int64 j = 0; j < value_dim; j++) {
         V value = value_values(i, j);
         value_vec.push_back(value);
       }
-      gtl::InsertOrUpdate(&table_, SubtleMustCopyIfIntegral(key_values(i)),
+      gtl::InsertOrUpdate(map, SubtleMustCopyIfIntegral(key_values(i)),
                           value_vec);
-    }
+    });
     return Status::OK();
   }
 
@@ -253,10 +416,9 @@ class MutableHashTableOfTensors final : public LookupInterface {
   Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
     const auto key_values = keys.flat<K>();
 
-    mutex_lock l(mu_);
-    for (int64 i = 0; i < key_values.size(); ++i) {
-      table_.erase(SubtleMustCopyIfIntegral(key_values(i)));
-    }
+    table_.MutateEachKey(key_values, false, [&](Map* map, int64 i) {
+      map->erase(SubtleMustCopyIfIntegral(key_values(i)));
+    });
     return Status::OK();
   }
 
@@ -266,29 +428,37 @@ class MutableHashTableOfTensors final : public LookupInterface {
   }
 
   Status ExportValues(OpKernelContext* ctx) override {
-    tf_shared_lock l(mu_);
-    int64 size = table_.size();
     int64 value_dim = value_shape_.dim_size(0);
+    Status status;
+    table_.ReadAll([&](const typename Table::ConstMaps& maps) {
+      int64 size = 0;
+      for (const Map* map : maps) {
+        size += map->size();
+      }
 
-    Tensor* keys;
-    Tensor* values;
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("keys", TensorShape({size}), &keys));
-    TF_RETURN_IF_ERROR(ctx->allocate_output(
-        "values", TensorShape({size, value_dim}), &values));
-
-    auto keys_data = keys->flat<K>();
-    auto values_data = values->matrix<V>();
-    int64 i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
-      K key = it->first;
-      ValueArray value = it->second;
-      keys_data(i) = key;
-      for (int64 j = 0; j < value_dim; j++) {
-        values_data(i, j) = value[j];
+      Tensor* keys;
+      Tensor* values;
+      status = ctx->allocate_output("keys", TensorShape({size}), &keys);
+      if (!status.ok()) return;
+      status = ctx->allocate_output("values", TensorShape({size, value_dim}),
+                                    &values);
+      if (!status.ok()) return;
+
+      auto keys_data = keys->flat<K>();
+      auto values_data = values->matrix<V>();
+      int64 i = 0;
+      for (const Map* map : maps) {
+        for (auto it = map->begin(); it != map->end(); ++it, ++i) {
+          K key = it->first;
+          const ValueArray& value = it->second;
+          keys_data(i) = key;
+          for (int64 j = 0; j < value_dim; j++) {
+            values_data(i, j) = value[j];
+          }
+        }
       }
-    }
-    return Status::OK();
+    });
+    return status;
   }
 
   DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
@@ -301,23 +471,21 @@ class MutableHashTableOfTensors final : public LookupInterface {
 
   int64 MemoryUsed() const override {
     int64 ret = 0;
-    tf_shared_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
+    table_.ReadAll([&](const typename Table::ConstMaps& maps) {
+      for (const Map* map : maps) {
+        ret += BucketMemory(*map);
       }
-    }
+    });
     return sizeof(MutableHashTableOfTensors) + ret;
   }
 
  private:
-  TensorShape value_shape_;
-  mutable mutex mu_;
   typedef gtl::InlinedVector<V, 4> ValueArray;
-  std::unordered_map<K, ValueArray> table_ TF_GUARDED_BY(mu_);
+  typedef StripedHashMap<K, ValueArray> Table;
+  typedef typename Table::Map Map;
+
+  TensorShape value_shape_;
+  Table table_;
 };
 
 namespace {
@@ -329,6 +497,12 @@ inline uint64 HashScalar(const T& key) {
 
 inline uint64 HashScalar(const tstring& key) { return Hash64(key); }
 
+// Number of keys whose home buckets MutableDenseHashTable::Find prefetches
+// before it starts probing. It should be large enough to cover the memory
+// latency of a bucket miss, but small enough that the prefetched lines are
+// still in cache when they are probed.
+constexpr int64 kFindPrefetchGroupSize = 16;
+
 // If the given shape is a scalar return {1} instead. Otherwise leave it alone.
 TensorShape MaybeVectorizeShape(const TensorShape& shape) {
   if (shape.dims() == 0) {
@@ -340,6 +514,12 @@ TensorShape MaybeVectorizeShape(const TensorShape& shape) {
 }  // namespace
 
 // Modeled after densehashtable in https://github.com/sparsehash/sparsehash
+//
+// Unlike MutableHashTable, this table is not striped. Its entries live in a
+// single open-addressing bucket array whose probe sequences span the whole
+// array, and an insert can replace the array when it grows, so a lock covering
+// a subset of the buckets would not protect a lookup. Lookups share `mu_` and
+// only inserts, removals and rehashes take it exclusively.
 template <class K, class V>
 class MutableDenseHashTable final : public LookupInterface {
  public:
@@ -434,43 +614,62 @@ class MutableDenseHashTable final : public LookupInterface {
     const auto deleted_key_matrix =
         deleted_key_.AccessTensor(ctx)->template shaped<K, 2>({1, key_size});
     const int64 bit_mask = num_buckets_ - 1;
+    // Keys are resolved in groups of kFindPrefetchGroupSize: the hashes of the
+    // whole group are computed and the home bucket of every key is prefetched
+    // before any of them is probed, so that the cache misses of the group
+    // overlap instead of being taken one after the other.
+    uint64 key_hashes[kFindPrefetchGroupSize];
     // TODO(andreasst): parallelize using work_sharder
-    for (int64 i = 0; i < num_elements; ++i) {
-      const uint64 key_hash = HashKey(key_matrix, i);
-      if (empty_key_hash_ == key_hash &&
-          IsEqualKey(empty_key_matrix, 0, key_matrix, i)) {
-        return errors::InvalidArgument(
-            "Using the empty_key as a table key is not allowed");
-      }
-      if (deleted_key_hash_ == key_hash &&
-          IsEqualKey(deleted_key_matrix, 0, key_matrix, i)) {
-        return errors::InvalidArgument(
-            "Using the deleted_key as a table key is not allowed");
+    for (int64 group_start = 0; group_start < num_elements;
+         group_start += kFindPrefetchGroupSize) {
+      const int64 group_end =
+          std::min(num_elements, group_start + kFindPrefetchGroupSize);
+      for (int64 i = group_start; i < group_end; ++i) {
+        const uint64 key_hash = HashKey(key_matrix, i);
+        if (empty_key_hash_ == key_hash &&
+            IsEqualKey(empty_key_matrix, 0, key_matrix, i)) {
+          return errors::InvalidArgument(
+              "Using the empty_key as a table key is not allowed");
+        }
+        if (deleted_key_hash_ == key_hash &&
+            IsEqualKey(deleted_key_matrix, 0, key_matrix, i)) {
+          return errors::InvalidArgument(
+              "Using the deleted_key as a table key is not allowed");
+        }
+        key_hashes[i - group_start] = key_hash;
+        const int64 bucket_index = key_hash & bit_mask;
+        port::prefetch<port::PREFETCH_HINT_T0>(
+            &key_buckets_matrix(bucket_index, 0));
+        port::prefetch<port::PREFETCH_HINT_T0>(
+            &value_buckets_matrix(bucket_index, 0));
       }
-      int64 bucket_index = key_hash & bit_mask;
-      int64 num_probes = 0;
-      while (true) {
-        if (IsEqualKey(key_buckets_matrix, bucket_index, key_matrix, i)) {
-          for (int64 j = 0; j < value_size; ++j) {
-            // TODO(andreasst): check if we can get rid of SubtleMustCopy
-            // here and elsewhere in this file.
-            value_matrix(i, j) =
-                SubtleMustCopyIfIntegral(value_buckets_matrix(bucket_index, j));
+      for (int64 i = group_start; i < group_end; ++i) {
+        int64 bucket_index = key_hashes[i - group_start] & bit_mask;
+        int64 num_probes = 0;
+        while (true) {
+          if (IsEqualKey(key_buckets_matrix, bucket_index, key_matrix, i)) {
+            for (int64 j = 0; j < value_size; ++j) {
+              // TODO(andreasst): check if we can get rid of SubtleMustCopy
+              // here and elsewhere in this file.
+              value_matrix(i, j) = SubtleMustCopyIfIntegral(
+                  value_buckets_matrix(bucket_index, j));
+            }
+            break;
           }
-          break;
-        }
-        if (IsEqualKey(key_buckets_matrix, bucket_index, empty_key_matrix, 0)) {
-          for (int64 j = 0; j < value_size; ++j) {
-            value_matrix(i, j) = SubtleMustCopyIfIntegral(default_flat(j));
+          if (IsEqualKey(key_buckets_matrix, bucket_index, empty_key_matrix,
+                         0)) {
+            for (int64 j = 0; j < value_size; ++j) {
+              value_matrix(i, j) = SubtleMustCopyIfIntegral(default_flat(j));
+            }
+            break;
+          }
+          ++num_probes;
+          bucket_index =
+              (bucket_index + num_probes) & bit_mask;  // quadratic probing
+          if (num_probes >= num_buckets_) {
+            return errors::Internal(
+                "Internal error in MutableDenseHashTable lookup");
           }
-          break;
-        }
-        ++num_probes;
-        bucket_index =
-            (bucket_index + num_probes) & bit_mask;  // quadratic probing
-        if (num_probes >= num_buckets_) {
-          return errors::Internal(
-              "Internal error in MutableDenseHashTable lookup");
         }
       }
     }
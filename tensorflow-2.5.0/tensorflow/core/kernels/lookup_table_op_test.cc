@@ -0,0 +1,253 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/public/session.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int64 kTableSize = 1 << 20;
+constexpr int64 kBatchSize = 4096;
+
+Node* MutableHashTable(Graph* g) {
+  Node* ret;
+  TF_CHECK_OK(NodeBuilder(g->NewName("table"), "MutableHashTableV2")
+                  .Attr("key_dtype", DT_INT64)
+                  .Attr("value_dtype", DT_INT64)
+                  .Attr("shared_name", "benchmark_table")
+                  .Finalize(g, &ret));
+  return ret;
+}
+
+Node* MutableDenseHashTable(Graph* g) {
+  Node* ret;
+  TF_CHECK_OK(
+      NodeBuilder(g->NewName("table"), "MutableDenseHashTableV2")
+          .Input(test::graph::Constant(g, test::AsScalar<int64>(-1)))
+          .Input(test::graph::Constant(g, test::AsScalar<int64>(-2)))
+          .Attr("value_dtype", DT_INT64)
+          .Attr("shared_name", "benchmark_table")
+          .Finalize(g, &ret));
+  return ret;
+}
+
+// Returns a constant holding `num_keys` keys spread over [0, key_space).
+Node* Keys(Graph* g, int64 num_keys, int64 seed,
+           int64 key_space = kTableSize) {
+  Tensor keys(DT_INT64, TensorShape({num_keys}));
+  auto keys_flat = keys.flat<int64>();
+  for (int64 i = 0; i < num_keys; ++i) {
+    keys_flat(i) = (i * 7919 + seed) % key_space;
+  }
+  return test::graph::Constant(g, keys);
+}
+
+Node* Insert(Graph* g, Node* table, Node* keys) {
+  Node* ret;
+  TF_CHECK_OK(NodeBuilder(g->NewName("insert"), "LookupTableInsertV2")
+                  .Input(table)
+                  .Input(keys)
+                  .Input(keys)
+                  .Finalize(g, &ret));
+  return ret;
+}
+
+Node* Find(Graph* g, Node* table, Node* keys) {
+  Node* ret;
+  TF_CHECK_OK(NodeBuilder(g->NewName("find"), "LookupTableFindV2")
+                  .Input(table)
+                  .Input(keys)
+                  .Input(test::graph::Constant(g, test::AsScalar<int64>(-1)))
+                  .Finalize(g, &ret));
+  return ret;
+}
+
+// Returns a constant holding the keys [start, start + num_keys).
+Node* KeyRange(Graph* g, int64 start, int64 num_keys) {
+  Tensor keys(DT_INT64, TensorShape({num_keys}));
+  auto keys_flat = keys.flat<int64>();
+  for (int64 i = 0; i < num_keys; ++i) {
+    keys_flat(i) = start + i;
+  }
+  return test::graph::Constant(g, keys);
+}
+
+// Inserts fresh keys from some threads while other threads look up keys that
+// are already in the table, and checks that every lookup sees them. The dense
+// table starts out small, so the inserts also rehash it under the lookups.
+void TestConcurrentInsertAndFind(Node* table, Graph* g) {
+  constexpr int64 kNumPreloaded = 1024;
+  constexpr int64 kNumInsertedPerThread = 4096;
+  constexpr int kNumThreads = 4;
+  constexpr int kNumSteps = 20;
+  constexpr int64 kNumKeys =
+      kNumPreloaded + kNumThreads * kNumInsertedPerThread;
+
+  Node* preload = Insert(g, table, KeyRange(g, 0, kNumPreloaded));
+  Node* find_all = Find(g, table, KeyRange(g, 0, kNumKeys));
+  std::vector<string> inserts;
+  std::vector<string> finds;
+  for (int i = 0; i < kNumThreads; ++i) {
+    inserts.push_back(
+        Insert(g, table,
+               KeyRange(g, kNumPreloaded + i * kNumInsertedPerThread,
+                        kNumInsertedPerThread))
+            ->name());
+    finds.push_back(Find(g, table, KeyRange(g, 0, kNumPreloaded))->name());
+  }
+  GraphDef graph_def;
+  g->ToGraphDef(&graph_def);
+  std::unique_ptr<Session> session(NewSession(SessionOptions()));
+  TF_ASSERT_OK(session->Create(graph_def));
+  TF_ASSERT_OK(session->Run({}, {}, {preload->name()}, nullptr));
+
+  Tensor expected(DT_INT64, TensorShape({kNumPreloaded}));
+  test::FillFn<int64>(&expected, [](int i) -> int64 { return i; });
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back(Env::Default()->StartThread(
+        ThreadOptions(), "insert", [&session, &inserts, i]() {
+          for (int step = 0; step < kNumSteps; ++step) {
+            TF_EXPECT_OK(session->Run({}, {}, {inserts[i]}, nullptr));
+          }
+        }));
+    threads.emplace_back(Env::Default()->StartThread(
+        ThreadOptions(), "find", [&session, &finds, &expected, i]() {
+          for (int step = 0; step < kNumSteps; ++step) {
+            std::vector<Tensor> outputs;
+            TF_EXPECT_OK(session->Run({}, {finds[i]}, {}, &outputs));
+            test::ExpectTensorEqual<int64>(expected, outputs[0]);
+          }
+        }));
+  }
+  threads.clear();
+
+  // Every inserted key is in the table afterwards.
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session->Run({}, {find_all->name()}, {}, &outputs));
+  Tensor all_keys(DT_INT64, TensorShape({kNumKeys}));
+  test::FillFn<int64>(&all_keys, [](int i) -> int64 { return i; });
+  test::ExpectTensorEqual<int64>(all_keys, outputs[0]);
+}
+
+TEST(MutableHashTableTest, ConcurrentInsertAndFind) {
+  Graph g(OpRegistry::Global());
+  Node* table;
+  TF_ASSERT_OK(NodeBuilder("table", "MutableHashTableV2")
+                   .Attr("key_dtype", DT_INT64)
+                   .Attr("value_dtype", DT_INT64)
+                   .Finalize(&g, &table));
+  TestConcurrentInsertAndFind(table, &g);
+}
+
+TEST(MutableDenseHashTableTest, ConcurrentInsertAndFind) {
+  Graph g(OpRegistry::Global());
+  Node* table;
+  TF_ASSERT_OK(
+      NodeBuilder("table", "MutableDenseHashTableV2")
+          .Input(test::graph::Constant(&g, test::AsScalar<int64>(-1)))
+          .Input(test::graph::Constant(&g, test::AsScalar<int64>(-2)))
+          .Attr("value_dtype", DT_INT64)
+          .Attr("initial_num_buckets", 16)
+          .Finalize(&g, &table));
+  TestConcurrentInsertAndFind(table, &g);
+}
+
+// Runs `num_readers` concurrent LookupTableFindV2 ops against one
+// MutableHashTable, optionally alongside `num_writers` concurrent
+// LookupTableInsertV2 ops, to measure lookup throughput versus thread count.
+void BM_MutableHashTableFind(::testing::benchmark::State& state) {
+  const int num_readers = state.range(0);
+  const int num_writers = state.range(1);
+
+  Graph* init = new Graph(OpRegistry::Global());
+  Insert(init, MutableHashTable(init), Keys(init, kTableSize, 0));
+
+  Graph* run = new Graph(OpRegistry::Global());
+  Node* table = MutableHashTable(run);
+  for (int i = 0; i < num_readers; ++i) {
+    Find(run, table, Keys(run, kBatchSize, i));
+  }
+  for (int i = 0; i < num_writers; ++i) {
+    Insert(run, table, Keys(run, kBatchSize, num_readers + i));
+  }
+
+  SessionOptions opts;
+  opts.config.set_intra_op_parallelism_threads(1);
+  opts.config.set_inter_op_parallelism_threads(num_readers + num_writers);
+  test::Benchmark("cpu", run, &opts, init, nullptr, "",
+                  /*old_benchmark_api=*/false)
+      .Run(state);
+  state.SetItemsProcessed(state.iterations() * num_readers * kBatchSize);
+}
+BENCHMARK(BM_MutableHashTableFind)
+    ->UseRealTime()
+    ->ArgPair(1, 0)
+    ->ArgPair(2, 0)
+    ->ArgPair(4, 0)
+    ->ArgPair(8, 0)
+    ->ArgPair(16, 0)
+    ->ArgPair(1, 1)
+    ->ArgPair(4, 1)
+    ->ArgPair(8, 1)
+    ->ArgPair(16, 1);
+
+// Looks up a large batch of keys, half of which are present, in a
+// MutableDenseHashTable holding `num_entries` entries. Once the table no
+// longer fits in cache this is dominated by the latency of bucket misses.
+void BM_MutableDenseHashTableFind(::testing::benchmark::State& state) {
+  const int64 num_entries = state.range(0);
+  const int64 batch_size = 1 << 16;
+
+  Graph* init = new Graph(OpRegistry::Global());
+  Insert(init, MutableDenseHashTable(init),
+         Keys(init, num_entries, 0, num_entries));
+
+  Graph* run = new Graph(OpRegistry::Global());
+  Find(run, MutableDenseHashTable(run),
+       Keys(run, batch_size, 1, 2 * num_entries));
+
+  SessionOptions opts;
+  opts.config.set_intra_op_parallelism_threads(1);
+  opts.config.set_inter_op_parallelism_threads(1);
+  test::Benchmark("cpu", run, &opts, init, nullptr, "",
+                  /*old_benchmark_api=*/false)
+      .Run(state);
+  state.SetItemsProcessed(state.iterations() * batch_size);
+}
+BENCHMARK(BM_MutableDenseHashTableFind)
+    ->UseRealTime()
+    ->Arg(1 << 12)
+    ->Arg(1 << 16)
+    ->Arg(1 << 20)
+    ->Arg(1 << 22);
+
+}  // namespace
+}  // namespace tensorflow
@@ -39,6 +39,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/fill_functor.h"
 #include "tensorflow/core/kernels/fused_eigen_output_kernels.h"
 #include "tensorflow/core/util/tensor_format.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 #if defined(TENSORFLOW_USE_CUSTOM_CONTRACTION_KERNEL)
 #include "tensorflow/core/kernels/eigen_contraction_kernel.h"
@@ -81,7 +82,15 @@ struct LaunchFusedMatMulOp<CPUDevice, T> {
             output_kernel(output_mapper, params, i, j, num_rows, num_cols);
           });
 
-      out.device(d) = lhs.contract(rhs, dim_pair, output_kernel_wrapper);
+      if (out.dimension(0) == 1) {
+        // A single output row would pack the whole RHS for one pass over it,
+        // which dominates the cost for batch-1 inference. Compute it as a
+        // matrix-vector product instead, sharded over output columns.
+        ExecuteVectorMatrix(context, a, b, dim_pair, output_kernel_wrapper,
+                            output);
+      } else {
+        out.device(d) = lhs.contract(rhs, dim_pair, output_kernel_wrapper);
+      }
     };
 
     BiasAddArgs<T> bias_add_args;
@@ -120,6 +129,51 @@ struct LaunchFusedMatMulOp<CPUDevice, T> {
   }
 
  private:
+  struct OutputKernelWrapper;
+
+  // Computes `output` = `a` * `b` for a single-row `output` without packing
+  // `b`, then applies `output_kernel` to each shard of output columns.
+  static void ExecuteVectorMatrix(
+      OpKernelContext* context, const Tensor& a, const Tensor& b,
+      const Eigen::array<Eigen::IndexPair<Eigen::DenseIndex>, 1>& dim_pair,
+      const OutputKernelWrapper& output_kernel, Tensor* output) {
+    using Vector = Eigen::Matrix<T, 1, Eigen::Dynamic, Eigen::RowMajor>;
+    using Matrix =
+        Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+    // `a` has a single row (or a single column if transposed), so it is a
+    // contiguous vector either way.
+    const bool transpose_b = dim_pair[0].second == 1;
+    const Eigen::Index k = b.dim_size(transpose_b ? 1 : 0);
+    const Eigen::Index n = output->dim_size(1);
+    Eigen::Map<const Vector> x(a.flat<T>().data(), k);
+    Eigen::Map<const Matrix> w(b.flat<T>().data(), b.dim_size(0),
+                               b.dim_size(1));
+    T* out_data = output->flat<T>().data();
+
+    Eigen::TensorContractionParams params;
+    params.swapped_arguments = true;
+
+    auto compute_columns = [&](int64 start, int64 limit) {
+      const Eigen::Index num_cols = limit - start;
+      Eigen::Map<Vector> y(out_data + start, num_cols);
+      if (transpose_b) {
+        y.noalias() = x * w.middleRows(start, num_cols).transpose();
+      } else {
+        y.noalias() = x * w.middleCols(start, num_cols);
+      }
+      // The contraction output kernels see the output as column-major with
+      // swapped arguments, i.e. rows are output columns.
+      ContractionOutputMapper<T, Eigen::Index> output_mapper(out_data + start,
+                                                             n);
+      output_kernel(output_mapper, params, start, 0, num_cols, 1);
+    };
+
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+    Shard(worker_threads.num_threads, worker_threads.workers, n,
+          /*cost_per_unit=*/2 * k, compute_columns);
+  }
+
   // Wrap output_kernel into type erased struct to reduce the number of unique
   // template instantiations for Eigen Tensor contraction expressions.
   //
@@ -31,12 +31,14 @@ limitations under the License.
 #endif
 
 #include <array>
+#include <memory>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #define GEMMLOWP_ALLOW_SLOW_SCALAR_FALLBACK
 #include "public/gemmlowp.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/mutex.h"
 
 namespace tensorflow {
 
@@ -963,6 +965,38 @@ class TensorflowGemmContext : public gemmlowp::MultiThreadGemmContextBase {
   TF_DISALLOW_COPY_AND_ASSIGN(TensorflowGemmContext);
 };
 
+// Keeps a TensorflowGemmContext, and with it gemmlowp's packing allocator,
+// alive across the Compute calls of a kernel. A context runs one GEMM at a
+// time, so a call that finds the cached context busy uses a fresh one.
+class TensorflowGemmContextCache {
+ public:
+  TensorflowGemmContextCache() = default;
+
+  // Calls `gemm` with a TensorflowGemmContext* that uses `workers`.
+  template <typename Gemm>
+  void Run(int num_threads, thread::ThreadPool* workers, Gemm gemm) {
+    mutex_lock l(mu_, std::try_to_lock);
+    if (!l) {
+      TensorflowGemmContext context(num_threads, workers);
+      gemm(&context);
+      return;
+    }
+    if (context_ == nullptr || workers_ != workers) {
+      context_.reset(new TensorflowGemmContext(num_threads, workers));
+      workers_ = workers;
+    }
+    context_->set_max_num_threads(num_threads);
+    gemm(context_.get());
+  }
+
+ private:
+  mutex mu_;
+  std::unique_ptr<TensorflowGemmContext> context_ TF_GUARDED_BY(mu_);
+  thread::ThreadPool* workers_ TF_GUARDED_BY(mu_) = nullptr;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(TensorflowGemmContextCache);
+};
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_KERNELS_QUANTIZATION_UTILS_H_
@@ -302,6 +302,14 @@ class Im2ColConvFunctor {
     const int64 chunk_count =
         (patch_count + (patches_per_chunk - 1)) / patches_per_chunk;
 
+    // The gemmlowp context keeps its packing allocator and worker pool between
+    // calls, so share one across all the chunks instead of rebuilding it for
+    // every GEMM.
+    auto& worker_threads =
+        *(context->device()->tensorflow_cpu_worker_threads());
+    TensorflowGemmContext gemm_context(worker_threads.num_threads,
+                                       worker_threads.workers);
+
     for (int64 chunk_index = 0; chunk_index < chunk_count; ++chunk_index) {
       const int64 patch_index_start = chunk_index * patches_per_chunk;
       const int64 patch_index_end =
@@ -432,13 +440,9 @@ class Im2ColConvFunctor {
             output_data_as_int32, m, n, ldc);
         const std::tuple<> empty_pipeline = {};
 
-        auto& worker_threads =
-            *(context->device()->tensorflow_cpu_worker_threads());
-        TensorflowGemmContext context(worker_threads.num_threads,
-                                      worker_threads.workers);
         gemmlowp::GemmWithOutputPipeline<std::uint8_t, std::int32_t,
                                          gemmlowp::DefaultL8R8BitDepthParams>(
-            &context, lhs, rhs, &result, -input_offset, -filter_offset,
+            &gemm_context, lhs, rhs, &result, -input_offset, -filter_offset,
             empty_pipeline);
         // Since gemmlowp uses assembly to write to the output, msan won't
         // detect the output buffer as written to, so we mark it manually.
@@ -32,9 +32,11 @@ namespace tensorflow {
 // combinations of transpose attributes we need to support, and they have to be
 // compile-time constants to work with the templates used internally.
 template <bool TransposeA, bool TransposeB, bool TransposeC>
-void GemmlowpMultiply(OpKernelContext* op_context, const quint8* a_data,
-                      const quint8* b_data, qint32* c_data, int m, int n, int k,
-                      int offset_a, int offset_b, int lda, int ldb, int ldc) {
+void GemmlowpMultiply(OpKernelContext* op_context,
+                      TensorflowGemmContextCache* gemm_contexts,
+                      const quint8* a_data, const quint8* b_data,
+                      qint32* c_data, int m, int n, int k, int offset_a,
+                      int offset_b, int lda, int ldb, int ldc) {
   const uint8* a_data_as_uint8 = &(a_data->value);
   const uint8* b_data_as_uint8 = &(b_data->value);
   int32* c_data_as_int32 = &(c_data->value);
@@ -53,11 +55,13 @@ void GemmlowpMultiply(OpKernelContext* op_context, const quint8* a_data,
   const std::tuple<> empty_pipeline = {};
   auto& worker_threads =
       *(op_context->device()->tensorflow_cpu_worker_threads());
-  TensorflowGemmContext context(worker_threads.num_threads,
-                                worker_threads.workers);
-  gemmlowp::GemmWithOutputPipeline<std::uint8_t, std::int32_t,
-                                   gemmlowp::DefaultL8R8BitDepthParams>(
-      &context, lhs, rhs, &result, -offset_a, -offset_b, empty_pipeline);
+  gemm_contexts->Run(
+      worker_threads.num_threads, worker_threads.workers,
+      [&](TensorflowGemmContext* context) {
+        gemmlowp::GemmWithOutputPipeline<std::uint8_t, std::int32_t,
+                                         gemmlowp::DefaultL8R8BitDepthParams>(
+            context, lhs, rhs, &result, -offset_a, -offset_b, empty_pipeline);
+      });
   // Since gemmlowp uses assembly to write to the output, msan won't detect
   // the output buffer as written to, so we mark it manually.
   TF_ANNOTATE_MEMORY_IS_INITIALIZED(c_data_as_int32, m * n * sizeof(int32));
@@ -148,23 +152,23 @@ class QuantizedMatMulOp : public OpKernel {
       // reference implementation if not.
       if (transpose_a_) {
         if (transpose_b_) {
-          GemmlowpMultiply<true, true, false>(context, a_data, b_data, c_data,
-                                              m, n, k, offset_a, offset_b, lda,
-                                              ldb, ldc);
+          GemmlowpMultiply<true, true, false>(context, &gemm_contexts_, a_data,
+                                              b_data, c_data, m, n, k, offset_a,
+                                              offset_b, lda, ldb, ldc);
         } else {
-          GemmlowpMultiply<true, false, false>(context, a_data, b_data, c_data,
-                                               m, n, k, offset_a, offset_b, lda,
-                                               ldb, ldc);
+          GemmlowpMultiply<true, false, false>(
+              context, &gemm_contexts_, a_data, b_data, c_data, m, n, k,
+              offset_a, offset_b, lda, ldb, ldc);
         }
       } else {
         if (transpose_b_) {
-          GemmlowpMultiply<false, true, false>(context, a_data, b_data, c_data,
-                                               m, n, k, offset_a, offset_b, lda,
-                                               ldb, ldc);
+          GemmlowpMultiply<false, true, false>(
+              context, &gemm_contexts_, a_data, b_data, c_data, m, n, k,
+              offset_a, offset_b, lda, ldb, ldc);
         } else {
-          GemmlowpMultiply<false, false, false>(context, a_data, b_data, c_data,
-                                                m, n, k, offset_a, offset_b,
-                                                lda, ldb, ldc);
+          GemmlowpMultiply<false, false, false>(
+              context, &gemm_contexts_, a_data, b_data, c_data, m, n, k,
+              offset_a, offset_b, lda, ldb, ldc);
         }
       }
     } else {
@@ -189,6 +193,7 @@ class QuantizedMatMulOp : public OpKernel {
  private:
   bool transpose_a_;
   bool transpose_b_;
+  TensorflowGemmContextCache gemm_contexts_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("QuantizedMatMul")
@@ -82,6 +82,51 @@ TEST_F(QuantizedMatMulTest, Small_NoParams) {
   test::ExpectTensorEqual<qint32>(expected, *GetOutput(0));
 }
 
+// Runs the same kernel repeatedly with different shapes, so the cached gemmlowp
+// context is reused across calls.
+TEST_F(QuantizedMatMulTest, ReusesKernelAcrossShapes) {
+  TF_ASSERT_OK(NodeDefBuilder("quantized_mat_mul_op", "QuantizedMatMul")
+                   .Input(FakeInput(DT_QUINT8))
+                   .Input(FakeInput(DT_QUINT8))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Attr("Toutput", DataTypeToEnum<qint32>::v())
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  for (int iteration = 0; iteration < 3; ++iteration) {
+    const int m = 2 + iteration;
+    const int k = 3;
+    const int n = 4 - iteration;
+    std::vector<quint8> a_values(m * k);
+    std::vector<quint8> b_values(k * n);
+    for (int i = 0; i < a_values.size(); ++i) a_values[i] = i + 1;
+    for (int i = 0; i < b_values.size(); ++i) b_values[i] = i + 7;
+    inputs_.clear();
+    AddInputFromArray<quint8>(TensorShape({m, k}), a_values);
+    AddInputFromArray<quint8>(TensorShape({k, n}), b_values);
+    AddInputFromArray<float>(TensorShape({1}), {0});
+    AddInputFromArray<float>(TensorShape({1}), {255.0f});
+    AddInputFromArray<float>(TensorShape({1}), {0});
+    AddInputFromArray<float>(TensorShape({1}), {255.0f});
+    TF_ASSERT_OK(RunOpKernel());
+
+    Tensor expected(allocator(), DT_QINT32, TensorShape({m, n}));
+    auto expected_matrix = expected.matrix<qint32>();
+    for (int i = 0; i < m; ++i) {
+      for (int j = 0; j < n; ++j) {
+        int32 sum = 0;
+        for (int l = 0; l < k; ++l) {
+          sum += a_values[i * k + l].value * b_values[l * n + j].value;
+        }
+        expected_matrix(i, j) = sum;
+      }
+    }
+    test::ExpectTensorEqual<qint32>(expected, *GetOutput(0));
+  }
+}
+
 // This test multiplies two 1x1 8bit matrices, and compares the
 // results with hand-calculated expectations.
 TEST_F(QuantizedMatMulTest, VerySmall_WithParams) {
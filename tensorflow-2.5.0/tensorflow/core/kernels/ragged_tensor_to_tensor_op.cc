@@ -40,6 +40,7 @@ limitations under the License.
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/bcast.h"
 #include "tensorflow/core/util/ragged_to_dense_util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -481,7 +482,7 @@ class RaggedTensorToTensorOp : public RaggedTensorToTensorBaseOp<INDEX_TYPE> {
     TensorShape element_shape = output_tensor->shape();
     element_shape.RemoveDimRange(0, ragged_rank + 1);
     int value_element_size = element_shape.num_elements();
-    size_t output_index_size = output_index.size();
+    const INDEX_TYPE output_index_size = output_index.size();
 
     // Broadcast the default value to value_element_size.  (We can skip this
     // if default_value_tensor.NumElements() == 1, since we use std::fill
@@ -508,15 +509,75 @@ class RaggedTensorToTensorOp : public RaggedTensorToTensorBaseOp<INDEX_TYPE> {
       default_value = bcast_default.flat<VALUE_TYPE>().data();
     }
 
+    const INDEX_TYPE num_dst_elements =
+        output_tensor->NumElements() / value_element_size;
+    const bool scalar_default = default_value_tensor.NumElements() == 1;
+
+    // The valid entries of output_index are strictly increasing, so the values
+    // can be split into shards of consecutive rows that write disjoint ranges
+    // of the output. Shard i owns the output range that starts right after
+    // the last destination used by shards 0..i-1 (a prefix max over the last
+    // destination of each shard), and pads up to where shard i+1 starts.
+    const auto& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    const int64 num_shards = std::max<int64>(
+        1, std::min<int64>(worker_threads.num_threads,
+                           output_index_size / kMinValuesPerShard));
+    vector<INDEX_TYPE> src_limits(num_shards + 1);
+    for (int64 i = 0; i <= num_shards; ++i) {
+      src_limits[i] = output_index_size * i / num_shards;
+    }
+    vector<INDEX_TYPE> dst_limits(num_shards + 1, 0);
+    for (int64 i = 0; i < num_shards; ++i) {
+      dst_limits[i + 1] = dst_limits[i];
+      for (INDEX_TYPE src_i = src_limits[i + 1] - 1; src_i >= src_limits[i];
+           --src_i) {
+        if (output_index[src_i] >= 0) {
+          dst_limits[i + 1] = output_index[src_i] + 1;
+          break;
+        }
+      }
+    }
+    dst_limits[num_shards] = num_dst_elements;
+
+    auto copy_shards = [&](int64 begin, int64 end) {
+      for (int64 i = begin; i < end; ++i) {
+        CopyValues(output_index, src_limits[i], src_limits[i + 1],
+                   dst_limits[i], dst_limits[i + 1], value_element_size,
+                   values_base, default_value, scalar_default, output_base);
+      }
+    };
+    // Each shard copies and pads about num_dst_elements / num_shards rows.
+    const int64 cost_per_shard =
+        num_dst_elements / num_shards * value_element_size;
+    Shard(worker_threads.num_threads, worker_threads.workers, num_shards,
+          cost_per_shard, copy_shards);
+  }
+
+ private:
+  // Below this many value rows per shard, splitting the copy across threads
+  // costs more than it saves.
+  static constexpr int64 kMinValuesPerShard = 4096;
+
+  // Copies the values in rows [src_begin, src_end) to the output rows given by
+  // output_index, and fills the output rows in [dst_begin, dst_end) that no
+  // value maps to with default_value. Every valid output_index in the source
+  // range must lie in [dst_begin, dst_end).
+  static void CopyValues(const vector<INDEX_TYPE>& output_index,
+                         INDEX_TYPE src_begin, INDEX_TYPE src_end,
+                         INDEX_TYPE dst_begin, INDEX_TYPE dst_limit,
+                         int value_element_size, const VALUE_TYPE* values_base,
+                         const VALUE_TYPE* default_value, bool scalar_default,
+                         VALUE_TYPE* output_base) {
     // Loop through the output_index vector, finding contiguous regions that
     // should be copied.  Once we find the end of a contiguous region, copy it
     // and add any necessary padding (with default_value).
-    INDEX_TYPE src_start = 0;  // Start of contiguous region (in values)
-    INDEX_TYPE dst_start = 0;  // Destination for contiguous region (in output)
-    INDEX_TYPE dst_end = 0;    // Destination for contiguous region (in output)
-    for (int src_i = 0; src_i <= output_index_size; ++src_i) {
+    INDEX_TYPE src_start = src_begin;  // Start of contiguous region (in values)
+    INDEX_TYPE dst_start = dst_begin;  // Destination for contiguous region
+    INDEX_TYPE dst_end = dst_begin;    // Destination for contiguous region
+    for (INDEX_TYPE src_i = src_begin; src_i <= src_end; ++src_i) {
       // dst_i is the destination where the value at src_i should be copied.
-      INDEX_TYPE dst_i = src_i < output_index_size ? output_index[src_i] : -1;
+      INDEX_TYPE dst_i = src_i < src_end ? output_index[src_i] : -1;
 
       // If we're still in a contiguous region, then update dst_end go to the
       // next src_i.
@@ -527,7 +588,7 @@ class RaggedTensorToTensorOp : public RaggedTensorToTensorBaseOp<INDEX_TYPE> {
 
       // We found the end of contiguous region.  This can be because we found
       // a gap (dst_i > dst_end), or a source value that shouldn't be copied
-      // because it's out-of-bounds (dst_i == -1), or the end of the tensor
+      // because it's out-of-bounds (dst_i == -1), or the end of the range
       // (dst_i = -1).
       if (dst_start < dst_end) {
         // Copy the contiguous region.
@@ -538,13 +599,12 @@ class RaggedTensorToTensorOp : public RaggedTensorToTensorBaseOp<INDEX_TYPE> {
       }
 
       // Add any necessary padding (w/ default_value).
-      if (src_i >= output_index_size) {
-        // We reached the end of values: pad to the end of output.
-        size_t output_size = output_tensor->NumElements();
-        dst_i = output_size / value_element_size;
+      if (src_i >= src_end) {
+        // We reached the end of the range: pad to the end of its output.
+        dst_i = dst_limit;
       }
       if (dst_i > dst_end) {
-        if (default_value_tensor.NumElements() == 1) {
+        if (scalar_default) {
           std::fill(output_base + dst_end * value_element_size,
                     output_base + dst_i * value_element_size, *default_value);
           dst_end = dst_i;
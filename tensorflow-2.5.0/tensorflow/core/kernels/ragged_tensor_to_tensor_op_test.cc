@@ -490,6 +490,39 @@ TEST_F(RaggedTensorToTensorOpTest, RaggedTensorToTensor_4DParamsConstrained) {
                                                     TensorShape({2, 2, 2, 2})));
 }
 
+TEST_F(RaggedTensorToTensorOpTest, RaggedTensorToTensorManyRows) {
+  // Enough rows for the copy to be split across threads. Row i has i % 5
+  // values, and rows longer than 3 are truncated.
+  constexpr int kNumRows = 50000;
+  constexpr int kWidth = 3;
+  std::vector<int64> row_splits = {0};
+  std::vector<float> values;
+  std::vector<float> expected;
+  for (int i = 0; i < kNumRows; ++i) {
+    const int row_length = i % 5;
+    for (int j = 0; j < row_length; ++j) {
+      values.push_back(values.size());
+    }
+    for (int j = 0; j < kWidth; ++j) {
+      expected.push_back(j < row_length ? row_splits.back() + j : -1);
+    }
+    row_splits.push_back(values.size());
+  }
+  BuildRaggedTensorToTensorGraph<float, int64>(
+      TensorShape({kNumRows, kWidth}),  // shape
+      {"ROW_SPLITS"},                   // row_partition_types
+      createVector<float>(values),      // values
+      createScalar<float>(-1),          // default_value
+      {createVector<int64>(row_splits)}  // row_partition_tensors
+  );
+
+  TF_ASSERT_OK(RunOpKernel());
+
+  test::ExpectTensorEqual<float>(
+      *GetOutput(0),
+      test::AsTensor<float>(expected, TensorShape({kNumRows, kWidth})));
+}
+
 TEST_F(RaggedTensorToTensorOpTest, ShapeWrongDimensions) {
   BuildRaggedTensorToTensorGraph<int32, int32>(
       TensorShape({10, 7, 10, 20}),  // shape
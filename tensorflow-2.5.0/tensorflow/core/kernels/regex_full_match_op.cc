@@ -18,13 +18,30 @@ limitations under the License.
 #include "re2/re2.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/regex_util.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
-#include "tensorflow/core/platform/mutex.h"
-#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/util/ptr_util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
+namespace {
+
+// Sets `output(i)` to whether `input(i)` fully matches `regex`, sharding the
+// strings across the CPU worker threads.
+void FullMatchAll(OpKernelContext* ctx, const RE2& regex,
+                  TTypes<tstring>::ConstFlat input, TTypes<bool>::Flat output) {
+  auto match = [&](int64 begin, int64 end) {
+    for (int64 i = begin; i < end; ++i) {
+      output(i) = RE2::FullMatch(input(i), regex);
+    }
+  };
+  auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads->num_threads, worker_threads->workers, input.size(),
+        RegexCostPerString(input), match);
+}
+
+}  // namespace
 
 class RegexFullMatchOp : public OpKernel {
  public:
@@ -43,7 +60,7 @@ class RegexFullMatchOp : public OpKernel {
                 errors::InvalidArgument("Pattern must be scalar, but received ",
                                         pattern_tensor->shape().DebugString()));
     const string pattern = pattern_tensor->flat<tstring>()(0);
-    std::shared_ptr<RE2> regex = CachedRE2(pattern);
+    std::shared_ptr<const RE2> regex = GetCachedRegex(pattern);
     OP_REQUIRES(ctx, regex->ok(),
                 errors::InvalidArgument("Invalid pattern: ", pattern,
                                         ", error: ", regex->error()));
@@ -51,34 +68,10 @@ class RegexFullMatchOp : public OpKernel {
     Tensor* output_tensor = nullptr;
     OP_REQUIRES_OK(ctx, ctx->allocate_output("output", input_tensor->shape(),
                                              &output_tensor));
-    auto output_flat = output_tensor->flat<bool>();
-    for (size_t i = 0; i < input_flat.size(); ++i) {
-      output_flat(i) = RE2::FullMatch(input_flat(i), *regex);
-    }
+    FullMatchAll(ctx, *regex, input_flat, output_tensor->flat<bool>());
   }
 
  private:
-  std::shared_ptr<RE2> CachedRE2(const string& pattern) {
-    {
-      tf_shared_lock l(mu_);
-      if (regex_ != nullptr && regex_->pattern() == pattern) {
-        return regex_;
-      }
-    }
-    // Construct the new RE2 object before acquiring the lock.
-    auto regex = std::make_shared<RE2>(pattern);
-    {
-      mutex_lock l(mu_);
-      // Swap instead of assigning so that we destruct the old
-      // RE2 object (when necessary) after releasing the lock.
-      regex_.swap(regex);
-      return regex_;
-    }
-  }
-
-  mutex mu_;
-  std::shared_ptr<RE2> regex_ TF_GUARDED_BY(mu_);
-
   TF_DISALLOW_COPY_AND_ASSIGN(RegexFullMatchOp);
 };
 
@@ -104,10 +97,7 @@ class StaticRegexFullMatchOp : public OpKernel {
     Tensor* output_tensor = nullptr;
     OP_REQUIRES_OK(ctx, ctx->allocate_output("output", input_tensor->shape(),
                                              &output_tensor));
-    auto output_flat = output_tensor->flat<bool>();
-    for (size_t i = 0; i < input_flat.size(); ++i) {
-      output_flat(i) = RE2::FullMatch(input_flat(i), *re_);
-    }
+    FullMatchAll(ctx, *re_, input_flat, output_tensor->flat<bool>());
   }
 
  private:
@@ -18,11 +18,11 @@ limitations under the License.
 #include "re2/re2.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/regex_util.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
-#include "tensorflow/core/platform/mutex.h"
-#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/util/ptr_util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -49,17 +49,23 @@ Status InternalCompute(const RE2& regex, const string& rewrite,
     output_tensor->flat<tstring>() = input_tensor->flat<tstring>();
   }
   auto output_flat = output_tensor->flat<tstring>();
-  for (size_t i = 0; i < output_flat.size(); ++i) {
-    // TODO(dero): Mitigate copy; Global and GlobalReplace below currently only
-    // accept std::string.
-    string buf = output_flat(i);
-    if (replace_global) {
-      RE2::GlobalReplace(&buf, regex, rewrite);
-    } else {
-      RE2::Replace(&buf, regex, rewrite);
+  auto replace = [&](int64 begin, int64 end) {
+    for (int64 i = begin; i < end; ++i) {
+      // TODO(dero): Mitigate copy; Global and GlobalReplace below currently
+      // only accept std::string.
+      string buf = output_flat(i);
+      if (replace_global) {
+        RE2::GlobalReplace(&buf, regex, rewrite);
+      } else {
+        RE2::Replace(&buf, regex, rewrite);
+      }
+      output_flat(i) = std::move(buf);
     }
-    output_flat(i) = std::move(buf);
-  }
+  };
+  auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads->num_threads, worker_threads->workers,
+        output_flat.size(), RegexCostPerString(input_tensor->flat<tstring>()),
+        replace);
   return Status::OK();
 }
 }  // namespace
@@ -79,7 +85,7 @@ class RegexReplaceOp : public OpKernel {
                 errors::InvalidArgument("Pattern must be scalar, but received ",
                                         pattern_tensor->shape().DebugString()));
     const string& pattern = pattern_tensor->scalar<tstring>()();
-    std::shared_ptr<RE2> regex = CachedRE2(pattern);
+    std::shared_ptr<const RE2> regex = GetCachedRegex(pattern);
     OP_REQUIRES(ctx, regex->ok(),
                 errors::InvalidArgument("Invalid pattern: ", pattern,
                                         ", error: ", regex->error()));
@@ -94,27 +100,7 @@ class RegexReplaceOp : public OpKernel {
   }
 
  private:
-  std::shared_ptr<RE2> CachedRE2(const string& pattern) {
-    {
-      tf_shared_lock l(mu_);
-      if (regex_ != nullptr && regex_->pattern() == pattern) {
-        return regex_;
-      }
-    }
-    // Construct the new RE2 object before acquiring the lock.
-    auto regex = std::make_shared<RE2>(pattern);
-    {
-      mutex_lock l(mu_);
-      // Swap instead of assigning so that we destruct the old
-      // RE2 object (when necessary) after releasing the lock.
-      regex_.swap(regex);
-      return regex_;
-    }
-  }
-
   bool replace_global_;
-  mutex mu_;
-  std::shared_ptr<RE2> regex_ TF_GUARDED_BY(mu_);
 
   TF_DISALLOW_COPY_AND_ASSIGN(RegexReplaceOp);
 };
@@ -0,0 +1,270 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "re2/re2.h"
+#include "re2/set.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/regex_util.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+namespace {
+
+re2::StringPiece ToRe2StringPiece(const tstring& s) {
+  return re2::StringPiece(s.data(), s.size());
+}
+
+// A list of patterns compiled into one RE2::Set, which finds all the patterns
+// that match a string in a single pass over it. It also keeps the cached RE2
+// of each pattern, to rewrite strings and to match them one pattern at a time
+// when the set runs out of memory.
+class CompiledRegexSet {
+ public:
+  CompiledRegexSet(const std::vector<string>& patterns, RE2::Anchor anchor)
+      : patterns_(patterns), anchor_(anchor), set_(RE2::Options(), anchor) {}
+
+  // Compiles the patterns.
+  Status Compile() {
+    for (const string& pattern : patterns_) {
+      std::shared_ptr<const RE2> regex = GetCachedRegex(pattern);
+      if (!regex->ok()) {
+        return errors::InvalidArgument("Invalid pattern: ", pattern,
+                                       ", error: ", regex->error());
+      }
+      regexes_.push_back(std::move(regex));
+      string error;
+      if (set_.Add(pattern, &error) < 0) {
+        return errors::InvalidArgument("Invalid pattern: ", pattern,
+                                       ", error: ", error);
+      }
+    }
+    if (!patterns_.empty() && !set_.Compile()) {
+      return errors::ResourceExhausted("Failed to compile the ",
+                                       patterns_.size(),
+                                       " patterns into a regex set");
+    }
+    return Status::OK();
+  }
+
+  const std::vector<string>& patterns() const { return patterns_; }
+
+  const RE2& regex(int i) const { return *regexes_[i]; }
+
+  // Sets `matches` to the sorted indices of the patterns that match `text`.
+  void Match(re2::StringPiece text, std::vector<int>* matches) const {
+    matches->clear();
+    if (patterns_.empty()) return;
+    RE2::Set::ErrorInfo error_info;
+    if (set_.Match(text, matches, &error_info)) {
+      std::sort(matches->begin(), matches->end());
+      return;
+    }
+    if (error_info.kind == RE2::Set::kNoError) return;
+    // The DFA of the set ran out of memory, which happens for large sets on
+    // long strings. Match the patterns one by one instead.
+    matches->clear();
+    for (int i = 0, n = regexes_.size(); i < n; ++i) {
+      if (regexes_[i]->Match(text, 0, text.size(), anchor_, nullptr, 0)) {
+        matches->push_back(i);
+      }
+    }
+  }
+
+ private:
+  const std::vector<string> patterns_;
+  const RE2::Anchor anchor_;
+  RE2::Set set_;
+  std::vector<std::shared_ptr<const RE2>> regexes_;
+};
+
+// Base class of the regex set kernels, which keeps the set compiled for the
+// last patterns it was given.
+class RegexSetOpBase : public OpKernel {
+ public:
+  RegexSetOpBase(OpKernelConstruction* ctx, RE2::Anchor anchor)
+      : OpKernel(ctx), anchor_(anchor) {}
+
+ protected:
+  Status GetRegexSet(OpKernelContext* ctx,
+                     std::shared_ptr<const CompiledRegexSet>* regex_set) {
+    const Tensor* patterns_tensor;
+    TF_RETURN_IF_ERROR(ctx->input("patterns", &patterns_tensor));
+    if (!TensorShapeUtils::IsVector(patterns_tensor->shape())) {
+      return errors::InvalidArgument("Patterns must be a vector, but received ",
+                                     patterns_tensor->shape().DebugString());
+    }
+    const auto patterns_flat = patterns_tensor->vec<tstring>();
+    std::vector<string> patterns(patterns_flat.size());
+    for (int64 i = 0; i < patterns_flat.size(); ++i) {
+      patterns[i] = patterns_flat(i);
+    }
+    {
+      tf_shared_lock l(mu_);
+      if (regex_set_ != nullptr && regex_set_->patterns() == patterns) {
+        *regex_set = regex_set_;
+        return Status::OK();
+      }
+    }
+    // Compile the new set before acquiring the lock.
+    auto compiled = std::make_shared<CompiledRegexSet>(patterns, anchor_);
+    TF_RETURN_IF_ERROR(compiled->Compile());
+    std::shared_ptr<const CompiledRegexSet> new_set = std::move(compiled);
+    *regex_set = new_set;
+    mutex_lock l(mu_);
+    // Swap instead of assigning so that we destruct the old set (when
+    // necessary) after releasing the lock.
+    regex_set_.swap(new_set);
+    return Status::OK();
+  }
+
+ private:
+  const RE2::Anchor anchor_;
+  mutex mu_;
+  std::shared_ptr<const CompiledRegexSet> regex_set_ TF_GUARDED_BY(mu_);
+};
+
+class RegexMatchSetOp : public RegexSetOpBase {
+ public:
+  explicit RegexMatchSetOp(OpKernelConstruction* ctx)
+      : RegexSetOpBase(ctx, RE2::ANCHOR_BOTH) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor* input_tensor;
+    OP_REQUIRES_OK(ctx, ctx->input("input", &input_tensor));
+    const auto input_flat = input_tensor->flat<tstring>();
+    std::shared_ptr<const CompiledRegexSet> regex_set;
+    OP_REQUIRES_OK(ctx, GetRegexSet(ctx, &regex_set));
+    const int64 num_patterns = regex_set->patterns().size();
+
+    TensorShape output_shape = input_tensor->shape();
+    output_shape.AddDim(num_patterns);
+    Tensor* output_tensor = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output("output", output_shape,
+                                             &output_tensor));
+    auto output = output_tensor->flat_inner_dims<bool>();
+    output.setConstant(false);
+    if (num_patterns == 0) return;
+
+    auto match = [&](int64 begin, int64 end) {
+      std::vector<int> matches;
+      for (int64 i = begin; i < end; ++i) {
+        regex_set->Match(ToRe2StringPiece(input_flat(i)), &matches);
+        for (int j : matches) output(i, j) = true;
+      }
+    };
+    auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          input_flat.size(), RegexCostPerString(input_flat), match);
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("RegexMatchSet").Device(DEVICE_CPU),
+                        RegexMatchSetOp);
+
+class RegexReplaceSetOp : public RegexSetOpBase {
+ public:
+  explicit RegexReplaceSetOp(OpKernelConstruction* ctx)
+      : RegexSetOpBase(ctx, RE2::UNANCHORED) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("replace_global", &replace_global_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor* input_tensor;
+    OP_REQUIRES_OK(ctx, ctx->input("input", &input_tensor));
+    std::shared_ptr<const CompiledRegexSet> regex_set;
+    OP_REQUIRES_OK(ctx, GetRegexSet(ctx, &regex_set));
+    const int num_patterns = regex_set->patterns().size();
+    const Tensor* rewrites_tensor;
+    OP_REQUIRES_OK(ctx, ctx->input("rewrites", &rewrites_tensor));
+    OP_REQUIRES(ctx,
+                TensorShapeUtils::IsVector(rewrites_tensor->shape()) &&
+                    rewrites_tensor->NumElements() == num_patterns,
+                errors::InvalidArgument(
+                    "Rewrites must be a vector of ", num_patterns,
+                    " strings, one per pattern, but received ",
+                    rewrites_tensor->shape().DebugString()));
+    const auto rewrites = rewrites_tensor->vec<tstring>();
+
+    Tensor* output_tensor;
+    std::unique_ptr<Tensor> maybe_forwarded = ctx->forward_input(
+        0 /*input_index*/, 0 /*output_index*/, DT_STRING,
+        input_tensor->shape(), ctx->input_memory_type(0),
+        ctx->input_alloc_attr(0));
+    if (maybe_forwarded) {
+      output_tensor = maybe_forwarded.get();
+      OP_REQUIRES_OK(ctx, ctx->set_output("output", *output_tensor));
+    } else {
+      OP_REQUIRES_OK(ctx, ctx->allocate_output("output", input_tensor->shape(),
+                                               &output_tensor));
+      output_tensor->flat<tstring>() = input_tensor->flat<tstring>();
+    }
+    if (num_patterns == 0) return;
+    auto output_flat = output_tensor->flat<tstring>();
+
+    // Applying the patterns in order is the same as chaining RegexReplace
+    // ops: each pattern rewrites the result of the previous ones. The set
+    // finds the next pattern that matches in one pass, and only needs to run
+    // again after a pattern has rewritten the string.
+    auto replace = [&](int64 begin, int64 end) {
+      std::vector<int> matches;
+      for (int64 i = begin; i < end; ++i) {
+        regex_set->Match(ToRe2StringPiece(output_flat(i)), &matches);
+        if (matches.empty()) continue;
+        string buf = output_flat(i);
+        int next = 0;
+        while (true) {
+          auto it = std::lower_bound(matches.begin(), matches.end(), next);
+          if (it == matches.end()) break;
+          const int j = *it;
+          const RE2& regex = regex_set->regex(j);
+          const re2::StringPiece rewrite = ToRe2StringPiece(rewrites(j));
+          if (replace_global_) {
+            RE2::GlobalReplace(&buf, regex, rewrite);
+          } else {
+            RE2::Replace(&buf, regex, rewrite);
+          }
+          next = j + 1;
+          if (next == num_patterns) break;
+          regex_set->Match(buf, &matches);
+        }
+        output_flat(i) = std::move(buf);
+      }
+    };
+    auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          output_flat.size(), RegexCostPerString(input_tensor->flat<tstring>()),
+          replace);
+  }
+
+ private:
+  bool replace_global_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("RegexReplaceSet").Device(DEVICE_CPU),
+                        RegexReplaceSetOp);
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,110 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/regex_util.h"
+
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace {
+
+// The number of compiled patterns kept by GetCachedRegex.
+constexpr size_t kMaxCachedRegexes = 256;
+
+// Cycles per input byte of a regex pass, roughly.
+constexpr int64 kRegexCostPerByte = 50;
+
+// Returns a key that tells apart the RE2 options that change the compiled
+// regex.
+string OptionsKey(const RE2::Options& options) {
+  return strings::StrCat(
+      options.encoding(), options.posix_syntax(), options.longest_match(),
+      options.literal(), options.never_nl(), options.dot_nl(),
+      options.never_capture(), options.case_sensitive(),
+      options.perl_classes(), options.word_boundary(), options.one_line(),
+      ":", options.max_mem(), ":");
+}
+
+class RegexCache {
+ public:
+  static RegexCache* Global() {
+    static RegexCache* cache = new RegexCache;
+    return cache;
+  }
+
+  std::shared_ptr<const RE2> Lookup(StringPiece pattern,
+                                    const RE2::Options& options) {
+    string key = strings::StrCat(OptionsKey(options), pattern);
+    {
+      mutex_lock l(mu_);
+      auto it = index_.find(key);
+      if (it != index_.end()) {
+        // Move the entry to the front of the LRU list.
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return it->second->second;
+      }
+    }
+    // Compile the regex without holding the lock.
+    std::shared_ptr<const RE2> regex = std::make_shared<const RE2>(
+        re2::StringPiece(pattern.data(), pattern.size()), options);
+    // The entries evicted below are destroyed after the lock is released.
+    std::list<Entry> evicted;
+    mutex_lock l(mu_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+      // Another thread compiled the pattern in the meantime.
+      return it->second->second;
+    }
+    lru_.emplace_front(key, regex);
+    index_.emplace(std::move(key), lru_.begin());
+    while (lru_.size() > kMaxCachedRegexes) {
+      index_.erase(lru_.back().first);
+      evicted.splice(evicted.begin(), lru_, std::prev(lru_.end()));
+    }
+    return regex;
+  }
+
+ private:
+  using Entry = std::pair<string, std::shared_ptr<const RE2>>;
+
+  mutex mu_;
+  // Most recently used first.
+  std::list<Entry> lru_ TF_GUARDED_BY(mu_);
+  std::unordered_map<string, std::list<Entry>::iterator> index_
+      TF_GUARDED_BY(mu_);
+};
+
+}  // namespace
+
+std::shared_ptr<const RE2> GetCachedRegex(StringPiece pattern,
+                                          const RE2::Options& options) {
+  return RegexCache::Global()->Lookup(pattern, options);
+}
+
+int64 RegexCostPerString(TTypes<tstring>::ConstFlat input) {
+  if (input.size() == 0) return 0;
+  int64 total_bytes = 0;
+  for (int64 i = 0; i < input.size(); ++i) {
+    total_bytes += input(i).size();
+  }
+  return kRegexCostPerByte * (total_bytes / input.size() + 1);
+}
+
+}  // namespace tensorflow
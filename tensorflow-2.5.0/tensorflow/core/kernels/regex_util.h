@@ -0,0 +1,44 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_REGEX_UTIL_H_
+#define TENSORFLOW_CORE_KERNELS_REGEX_UTIL_H_
+
+#include <memory>
+
+#include "re2/re2.h"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/platform/stringpiece.h"
+#include "tensorflow/core/platform/tstring.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Returns the RE2 compiled from `pattern` with `options`, which may be invalid
+// (check `ok()`). Compiled patterns are kept in a process-wide LRU cache
+// shared by all regex kernels, so that graphs that feed patterns as tensors
+// don't recompile them on every step.
+std::shared_ptr<const RE2> GetCachedRegex(StringPiece pattern,
+                                          const RE2::Options& options);
+inline std::shared_ptr<const RE2> GetCachedRegex(StringPiece pattern) {
+  return GetCachedRegex(pattern, RE2::Options());
+}
+
+// Returns the estimated cost, in cycles, of running a regex over one string of
+// `input`, for sharding the strings across threads.
+int64 RegexCostPerString(TTypes<tstring>::ConstFlat input);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_REGEX_UTIL_H_
@@ -142,6 +142,17 @@ void ReadVariableOp::Compute(OpKernelContext* ctx) {
                   "Debug info: container=", handle.container(),
                   ", status=", status.ToString()));
 
+  if (variable->lock_free_reads()) {
+    std::shared_ptr<const Tensor> snapshot = variable->snapshot();
+    OP_REQUIRES(ctx, dtype_ == snapshot->dtype(),
+                errors::InvalidArgument(
+                    "Trying to read variable with wrong dtype. Expected ",
+                    DataTypeString(dtype_), " got ",
+                    DataTypeString(snapshot->dtype())));
+    ctx->set_output(0, *snapshot);
+    return;
+  }
+
   tf_shared_lock ml(*variable->mu());
   // We're acquiring a reference to the underlying buffer while
   // holding a shared lock to guarantee ordering of reads and
@@ -192,6 +203,18 @@ void ReadVariablesOp::Compute(OpKernelContext* ctx) {
                   absl::StrJoin(uninitialized_vars, ", ")));
 
   for (size_t i = 0; i < dtypes_.size(); ++i) {
+    if (variables[i]->lock_free_reads()) {
+      std::shared_ptr<const Tensor> snapshot = variables[i]->snapshot();
+      OP_REQUIRES(ctx, dtypes_[i] == snapshot->dtype(),
+                  errors::InvalidArgument(
+                      "Trying to read variable ", handles[i]->name(),
+                      " from Container: ", handles[i]->container(),
+                      " with wrong dtype. Expected ",
+                      DataTypeString(dtypes_[i]), " got ",
+                      DataTypeString(snapshot->dtype())));
+      ctx->set_output(i, *snapshot);
+      continue;
+    }
     // We're acquiring a reference to the underlying buffer while
     // holding a shared lock to guarantee ordering of reads and
     // writes.
@@ -376,6 +399,9 @@ class AssignVariableOp : public OpKernel {
              .ok()) {
       relax_constraints_ = false;
     }
+    if (!c->GetAttr("_lock_free_reads", &lock_free_reads_).ok()) {
+      lock_free_reads_ = false;
+    }
   }
 
   void Compute(OpKernelContext* context) override {
@@ -435,11 +461,23 @@ class AssignVariableOp : public OpKernel {
       *variable->tensor() = value;
     }
     variable->is_initialized = true;
+    if (lock_free_reads_ && !variable->lock_free_reads()) {
+      OP_REQUIRES(context, !variable->copy_on_read_mode.load(),
+                  errors::FailedPrecondition(
+                      "Cannot enable lock-free reads on a variable that has "
+                      "been accessed sparsely."));
+      variable->EnableLockFreeReads();
+    } else {
+      variable->PublishSnapshot();
+    }
   }
 
  private:
   DataType dtype_;
   bool relax_constraints_;
+  // Set by the "_lock_free_reads" attribute; switches the assigned variable
+  // to lock-free reads (see Var::EnableLockFreeReads).
+  bool lock_free_reads_;
 };
 
 template <typename Device>
@@ -492,6 +530,7 @@ class AssignVariableOp<Device, Variant> : public OpKernel {
 
     if (input_alias) {
       *variable->tensor() = *input_alias;
+      variable->PublishSnapshot();
       return;
     }
 
@@ -513,6 +552,7 @@ class AssignVariableOp<Device, Variant> : public OpKernel {
     for (int64 i = 0; i < elements_in.size(); ++i) {
       elements_out(i) = elements_in(i);
     }
+    variable->PublishSnapshot();
   }
 
  private:
@@ -572,6 +612,7 @@ class AssignUpdateVariableOp : public OpKernel {
     functor::DenseUpdate<Device, T, Op> update_functor;
     update_functor(context->eigen_device<Device>(), var_tensor->flat<T>(),
                    value.flat<T>());
+    variable->PublishSnapshot();
   }
 };
 
@@ -655,7 +696,11 @@ class ResourceGatherOp : public OpKernel {
   void Compute(OpKernelContext* c) override {
     core::RefCountPtr<Var> v;
     OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &v));
-    OP_REQUIRES_OK(c, EnsureSparseVariableAccess<Device, T>(c, v.get()));
+    // Variables with lock-free reads never have their buffer updated in
+    // place, so they can be gathered from without switching to copy-on-read.
+    if (!v->lock_free_reads()) {
+      OP_REQUIRES_OK(c, EnsureSparseVariableAccess<Device, T>(c, v.get()));
+    }
     // NOTE: We hold the lock for the whole gather operation instead
     // of increasing the reference count of v->tensor() to avoid a
     // situation where a write to the same variable will see a
@@ -821,7 +866,11 @@ class ResourceGatherNdOp : public OpKernel {
   void Compute(OpKernelContext* c) override {
     core::RefCountPtr<Var> v;
     OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &v));
-    OP_REQUIRES_OK(c, EnsureSparseVariableAccess<Device, T>(c, v.get()));
+    // Variables with lock-free reads never have their buffer updated in
+    // place, so they can be gathered from without switching to copy-on-read.
+    if (!v->lock_free_reads()) {
+      OP_REQUIRES_OK(c, EnsureSparseVariableAccess<Device, T>(c, v.get()));
+    }
     // NOTE: We hold the lock for the whole gather operation instead
     // of increasing the reference count of v->tensor() to avoid a
     // situation where a write to the same variable will see a
@@ -868,6 +917,114 @@ TF_CALL_GPU_NUMBER_TYPES(REGISTER_GATHER_ND_GPU);
 #undef REGISTER_GATHER_ND_ALL_INDICES
 #undef REGISTER_GATHER_ND_FULL
 
+// Gathers rows of a variable and combines them per segment, so that a
+// parameter server returns `num_segments` rows instead of one row per index.
+template <typename T, typename Index, typename SegmentId>
+class ResourceSparseSegmentCombineOp : public OpKernel {
+ public:
+  explicit ResourceSparseSegmentCombineOp(OpKernelConstruction* c)
+      : OpKernel(c) {
+    OP_REQUIRES_OK(c, c->GetAttr("combiner", &combiner_));
+  }
+
+  void Compute(OpKernelContext* c) override {
+    core::RefCountPtr<Var> v;
+    OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &v));
+    OP_REQUIRES_OK(c, EnsureSparseVariableAccess<CPUDevice, T>(c, v.get()));
+    // As in ResourceGatherOp, hold the lock for the whole operation to avoid
+    // forcing a copy of the variable on a concurrent sparse write.
+    tf_shared_lock ml(*v->mu());
+    const Tensor& params = *v->tensor();
+    const Tensor& indices = c->input(1);
+    const Tensor& segment_ids = c->input(2);
+    const Tensor& num_segments_t = c->input(3);
+    OP_REQUIRES(
+        c, TensorShapeUtils::IsVectorOrHigher(params.shape()),
+        errors::InvalidArgument("params must be at least 1 dimensional"));
+    OP_REQUIRES(c, TensorShapeUtils::IsVector(indices.shape()),
+                errors::InvalidArgument("indices must be a vector: ",
+                                        indices.shape().DebugString()));
+    OP_REQUIRES(c, indices.shape().IsSameSize(segment_ids.shape()),
+                errors::InvalidArgument(
+                    "segment_ids and indices must have the same shape: ",
+                    segment_ids.shape().DebugString(), " vs ",
+                    indices.shape().DebugString()));
+    OP_REQUIRES(c, TensorShapeUtils::IsScalar(num_segments_t.shape()),
+                errors::InvalidArgument("num_segments must be a scalar: ",
+                                        num_segments_t.shape().DebugString()));
+    const int64 num_segments = num_segments_t.dtype() == DT_INT32
+                                   ? num_segments_t.scalar<int32>()()
+                                   : num_segments_t.scalar<int64>()();
+    OP_REQUIRES(c, num_segments >= 0,
+                errors::InvalidArgument("num_segments must be non-negative: ",
+                                        num_segments));
+
+    TensorShape result_shape = params.shape();
+    result_shape.set_dim(0, num_segments);
+    Tensor* out = nullptr;
+    OP_REQUIRES_OK(c, c->allocate_output(0, result_shape, &out));
+    if (out->NumElements() == 0) return;
+
+    auto out_flat = out->flat_outer_dims<T>();
+    out_flat.setZero();
+    const auto params_flat = params.flat_outer_dims<T>();
+    const auto indices_vec = indices.vec<Index>();
+    const auto segment_ids_vec = segment_ids.vec<SegmentId>();
+    const int64 N = indices.NumElements();
+    const int64 first_dim_size = params.dim_size(0);
+    std::vector<int64> counts(num_segments, 0);
+    for (int64 i = 0; i < N; ++i) {
+      const Index index = internal::SubtleMustCopy(indices_vec(i));
+      OP_REQUIRES(c, FastBoundsCheck(index, first_dim_size),
+                  errors::InvalidArgument("indices[", i, "] = ", index,
+                                          " is not in [0, ", first_dim_size,
+                                          ")"));
+      const SegmentId segment = internal::SubtleMustCopy(segment_ids_vec(i));
+      OP_REQUIRES(c, FastBoundsCheck(segment, num_segments),
+                  errors::InvalidArgument("segment_ids[", i, "] = ", segment,
+                                          " is not in [0, ", num_segments,
+                                          ")"));
+      out_flat.template chip<0>(segment) += params_flat.template chip<0>(index);
+      ++counts[segment];
+    }
+
+    if (combiner_ == "sum") return;
+    for (int64 s = 0; s < num_segments; ++s) {
+      if (counts[s] <= 1) continue;
+      const T scale = combiner_ == "mean"
+                          ? T(1) / static_cast<T>(counts[s])
+                          : T(1) / std::sqrt(static_cast<T>(counts[s]));
+      out_flat.template chip<0>(s) = out_flat.template chip<0>(s) * scale;
+    }
+  }
+
+ private:
+  string combiner_;
+};
+
+#define REGISTER_SEGMENT_COMBINE_FULL(type, index_type, segment_type) \
+  REGISTER_KERNEL_BUILDER(                                            \
+      Name("ResourceSparseSegmentCombine")                            \
+          .Device(DEVICE_CPU)                                         \
+          .TypeConstraint<type>("dtype")                              \
+          .TypeConstraint<index_type>("Tidx")                         \
+          .TypeConstraint<segment_type>("Tsegmentids"),               \
+      ResourceSparseSegmentCombineOp<type, index_type, segment_type>)
+
+#define REGISTER_SEGMENT_COMBINE_ALL_INDICES(type)   \
+  REGISTER_SEGMENT_COMBINE_FULL(type, int32, int32); \
+  REGISTER_SEGMENT_COMBINE_FULL(type, int32, int64); \
+  REGISTER_SEGMENT_COMBINE_FULL(type, int64, int32); \
+  REGISTER_SEGMENT_COMBINE_FULL(type, int64, int64)
+
+// Only a CPU kernel is registered: the op is meant to run on the parameter
+// server that hosts the variable.
+TF_CALL_float(REGISTER_SEGMENT_COMBINE_ALL_INDICES);
+TF_CALL_double(REGISTER_SEGMENT_COMBINE_ALL_INDICES);
+
+#undef REGISTER_SEGMENT_COMBINE_ALL_INDICES
+#undef REGISTER_SEGMENT_COMBINE_FULL
+
 template <typename Device, typename T, typename Index, scatter_op::UpdateOp op>
 class ResourceScatterUpdateOp : public OpKernel {
  public:
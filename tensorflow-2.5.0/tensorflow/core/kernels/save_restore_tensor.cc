@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 #include "tensorflow/core/util/tensor_slice_reader.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
@@ -237,6 +238,47 @@ namespace {
 // Tensors larger than this threshold will be restored from a thread-pool.
 const int64 kLargeShapeThreshold = 16 << 20;  // 16M
 
+// Whether restore ops alias memory-mapped checkpoint data where possible (see
+// BundleReader::LookupMemoryMapped), instead of reading each tensor in full.
+// Restoring then costs little more than reading the metadata, regardless of
+// the size of the tensors, and their contents are paged in on first access or
+// by a background prefetch of the restored tensors.
+//
+// Enabled by setting the environment variable
+// TF_RESTORE_MEMORY_MAPPED_TENSORS=true.
+bool RestoreMemoryMappedTensors() {
+  static const bool restore_memory_mapped = [] {
+    bool value;
+    Status s = ReadBoolFromEnvVar("TF_RESTORE_MEMORY_MAPPED_TENSORS",
+                                  /*default_val=*/false, &value);
+    if (!s.ok()) {
+      LOG(ERROR) << s;
+      return false;
+    }
+    return value;
+  }();
+  return restore_memory_mapped;
+}
+
+// Touches every page of the memory-mapped tensors, so that they are resident
+// by the time they are first accessed.  Runs in the background and holds a
+// reference to the tensors, which keeps their mappings alive.
+void PrefetchMemoryMappedTensors(std::vector<Tensor> tensors) {
+  if (tensors.empty()) return;
+  Env::Default()->SchedClosure([tensors = std::move(tensors)]() {
+    constexpr size_t kPageSize = 4096;
+    int64 checksum = 0;
+    for (const Tensor& t : tensors) {
+      const StringPiece data = t.tensor_data();
+      for (size_t i = 0; i < data.size(); i += kPageSize) {
+        checksum += static_cast<const volatile char*>(data.data())[i];
+      }
+    }
+    VLOG(2) << "Prefetched " << tensors.size()
+            << " memory-mapped tensors: " << checksum;
+  });
+}
+
 // A restore operation for a single tensor.  Small tensors may be restored
 // directly from the op thread to improve read locality.  Large tensors can be
 // restored from a thread pool: this requires creating a separate BundleReader
@@ -274,7 +316,16 @@ struct RestoreOp {
     VLOG(1) << "Restoring tensor " << idx << " : " << tensor_name << " : "
             << restored_full_shape.num_elements();
     Tensor* restored_tensor;
-    if (shape_and_slice.empty()) {
+    if (shape_and_slice.empty() && RestoreMemoryMappedTensors()) {
+      // Lookup the full tensor, aliasing the data file where possible.
+      Tensor tensor;
+      bool memory_mapped;
+      TF_RETURN_IF_ERROR(
+          reader->LookupMemoryMapped(tensor_name, &tensor, &memory_mapped));
+      context->set_output(idx, tensor);
+      restored_tensor = context->mutable_output(idx);
+      if (memory_mapped) mapped_tensor = tensor;
+    } else if (shape_and_slice.empty()) {
       // Lookup the full tensor.
       TF_RETURN_IF_ERROR(
           context->allocate_output(idx, restored_full_shape, &restored_tensor));
@@ -301,7 +352,7 @@ struct RestoreOp {
       TF_RETURN_IF_ERROR(
           reader->LookupSlice(tensor_name, parsed_slice, restored_tensor));
     }
-    if (VLOG_IS_ON(5)) {
+    if (VLOG_IS_ON(5) && !mapped_tensor.IsInitialized()) {
       if (restored_tensor->dtype() == DT_FLOAT) {
         const float* t_data = restored_tensor->flat<float>().data();
         float min = std::numeric_limits<float>::infinity();
@@ -329,6 +380,8 @@ struct RestoreOp {
   string reader_prefix;
 
   ::tensorflow::Status status;
+  // The restored tensor, if it aliases memory-mapped checkpoint data.
+  Tensor mapped_tensor;
 };
 
 }  // namespace
@@ -376,9 +429,26 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
     return errors::InvalidArgument(error_msg);
   }
 
+  // Full tensors are restored with a single batched lookup, which coalesces
+  // and parallelizes the reads of their contents.
+  std::vector<StringPiece> batched_names;
+  std::vector<Tensor*> batched_tensors;
+  int64 batched_num_elements = 0;
   for (auto i : sorted_name_idx) {
     const string& tensor_name = tensor_names_flat(i);
     const string& shape_and_slice = shape_and_slices_flat(i);
+    if (shape_and_slice.empty() && !RestoreMemoryMappedTensors()) {
+      TensorShape restored_full_shape;
+      TF_RETURN_IF_ERROR(default_reader.LookupTensorShape(
+          tensor_name, &restored_full_shape));
+      Tensor* restored_tensor;
+      TF_RETURN_IF_ERROR(
+          context->allocate_output(i, restored_full_shape, &restored_tensor));
+      batched_names.push_back(tensor_name);
+      batched_tensors.push_back(restored_tensor);
+      batched_num_elements += restored_full_shape.num_elements();
+      continue;
+    }
     auto op =
         new RestoreOp{context, i, tensor_name, shape_and_slice, prefix_string};
     if (op->should_run_in_pool(&default_reader)) {
@@ -392,7 +462,8 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
     // Schedule any threaded operations first, skipping thread pool creation if
     // we don't have any expensive operations.
     std::unique_ptr<thread::ThreadPool> reader_pool;
-    if (!pool_restore_ops.empty()) {
+    if (!pool_restore_ops.empty() ||
+        batched_num_elements > kLargeShapeThreshold) {
       reader_pool.reset(
           new thread::ThreadPool(Env::Default(), "restore_tensors", 8));
       for (auto& op : pool_restore_ops) {
@@ -400,6 +471,11 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
       }
     }
 
+    VLOG(1) << "Restoring " << batched_names.size() << " tensors : "
+            << batched_num_elements;
+    TF_RETURN_IF_ERROR(default_reader.LookupMany(
+        batched_names, batched_tensors, reader_pool.get()));
+
     // Read small tensors from the op thread
     for (auto& op : direct_restore_ops) {
       TF_RETURN_IF_ERROR(op->run(&default_reader));
@@ -411,6 +487,16 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
     TF_RETURN_IF_ERROR(op->status);
   }
 
+  std::vector<Tensor> mapped_tensors;
+  for (auto* ops : {&pool_restore_ops, &direct_restore_ops}) {
+    for (auto& op : *ops) {
+      if (op->mapped_tensor.IsInitialized()) {
+        mapped_tensors.push_back(op->mapped_tensor);
+      }
+    }
+  }
+  PrefetchMemoryMappedTensors(std::move(mapped_tensors));
+
   for (auto i : sorted_name_idx) {
     const string& tensor_name = tensor_names_flat(i);
     if (dtypes[i] != context->mutable_output(i)->dtype()) {
@@ -16,7 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_SCATTER_FUNCTOR_H_
 #define TENSORFLOW_CORE_KERNELS_SCATTER_FUNCTOR_H_
 
+#include <algorithm>
 #include <type_traits>
+#include <vector>
 
 #include "third_party/eigen3/Eigen/Core"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -137,46 +139,59 @@ struct ScatterFunctor {
 
 template <typename Device, typename T, typename Index, scatter_op::UpdateOp op>
 struct ScatterFunctorBase {
+  // Splits the rows of 'params' into contiguous ranges and applies the
+  // updates to each range on one thread, in the order they appear in
+  // 'indices'. No two threads touch the same row, so there is no locking, and
+  // duplicate indices produce the same result as SerialExecute.
   Index ParallelExecute(OpKernelContext* c, const Device& d,
                         typename TTypes<T>::Matrix params,
                         typename TTypes<T>::ConstMatrix updates,
-                        typename TTypes<Index>::ConstFlat indices) {
+                        typename TTypes<Index>::ConstFlat indices,
+                        Index num_partitions) {
     const Index N = static_cast<Index>(indices.size());
     const Index limit = static_cast<Index>(params.dimension(0));
-    const Index kMaxLocks = 1024;
-    const Index entries_per_lock = (limit + kMaxLocks - 1) / kMaxLocks;
-    // To reduce the number of locks and the memory usage, we divide the whole
-    // index space into kMaxLocks regions with each lock serializing access to
-    // a region.
-    mutex accessed[kMaxLocks];
-    std::atomic<Index> bad_index(-1);
-    auto ParallelScatter = [&](Index start, Index end) {
-      for (Index i = start; i < end; ++i) {
-        // Grab the index and check its validity.  Do this carefully,
-        // to avoid checking the value and grabbing it again from
-        // memory a second time (a security risk since it may change in
-        // between).
-        const Index index = ::tensorflow::internal::SubtleMustCopy(indices(i));
-        if (!FastBoundsCheck(index, limit)) {
-          bad_index = i;
-          return;
-        }
-        const Index lock_id = index / entries_per_lock;
-        // Copy last Ndim-1 dimensions of updates[i] to params[index]
-        {
-          mutex_lock l(accessed[lock_id]);
-          scatter_op::internal::Assign<op>::Run(params.template chip<0>(index),
-                                                updates.template chip<0>(i));
+    const Index rows_per_partition =
+        (limit + num_partitions - 1) / num_partitions;
+
+    // Bucket the update positions by partition, keeping their order. Grab
+    // each index only once, to avoid checking the value and grabbing it again
+    // from memory a second time (a security risk since it may change in
+    // between).
+    std::vector<Index> safe_indices(N);
+    std::vector<Index> partition_start(num_partitions + 1, 0);
+    for (Index i = 0; i < N; ++i) {
+      const Index index = ::tensorflow::internal::SubtleMustCopy(indices(i));
+      if (!FastBoundsCheck(index, limit)) return i;
+      safe_indices[i] = index;
+      ++partition_start[index / rows_per_partition + 1];
+    }
+    for (Index p = 0; p < num_partitions; ++p) {
+      partition_start[p + 1] += partition_start[p];
+    }
+    std::vector<Index> positions(N);
+    std::vector<Index> next(partition_start.begin(), partition_start.end() - 1);
+    for (Index i = 0; i < N; ++i) {
+      positions[next[safe_indices[i] / rows_per_partition]++] = i;
+    }
+
+    auto PartitionedScatter = [&](Index start, Index end) {
+      for (Index p = start; p < end; ++p) {
+        for (Index j = partition_start[p]; j < partition_start[p + 1]; ++j) {
+          const Index i = positions[j];
+          scatter_op::internal::Assign<op>::Run(
+              params.template chip<0>(safe_indices[i]),
+              updates.template chip<0>(i));
         }
       }
     };
     const float kMovingCost = 2.5f;
-    float shard_cost = kMovingCost * params.dimension(1);
+    const float shard_cost =
+        kMovingCost * params.dimension(1) * N / num_partitions;
     const DeviceBase::CpuWorkerThreads& worker_threads =
         *(c->device()->tensorflow_cpu_worker_threads());
-    Shard(worker_threads.num_threads, worker_threads.workers, N, shard_cost,
-          ParallelScatter);  // TODO: Come up with a good cost estimate.
-    return bad_index;
+    Shard(worker_threads.num_threads, worker_threads.workers, num_partitions,
+          shard_cost, PartitionedScatter);
+    return -1;
   }
   Index SerialExecute(OpKernelContext* c, const Device& d,
                       typename TTypes<T>::Matrix params,
@@ -202,31 +217,21 @@ struct ScatterFunctorBase {
                    typename TTypes<T>::Matrix params,
                    typename TTypes<T>::ConstMatrix updates,
                    typename TTypes<Index>::ConstFlat indices) {
-#ifdef PLATFORM_GOOGLE
-    // The parallel version is significantly slower internally. Only call the
-    // serial version for now.
-    // TODO(penporn): Avoid locking in parallelization (sort beforehand).
-    return SerialExecute(c, d, params, updates, indices);
-#else
     // indices and params sizes were validated in DoCompute().
     const Index N = static_cast<Index>(indices.size());
     const Index limit = static_cast<Index>(params.dimension(0));
     const Index min_n_threshold = 1024;
-    const Index ser_par_ratio = 10000;
-    // For parallelizing the updates, duplicate entries need to be handled
-    // correctly. Multiple updates to the same index has to be serialized.
-    // This can lead to lock contention which may nullify the benefits of
-    // parallelization. Assuming uniform random distribution of the indices, we
-    // come up with a rough heuristic and determine whether the updates execute
-    // serially or parallelly. Also if 'N' is small, overheads of parallel
-    // execution outweigh its benefits and hence we check the value of N.
-    const bool execute_serial =
-        ((N < min_n_threshold) || ((N / limit) > ser_par_ratio));
-    if (execute_serial)
+    // Use several row ranges per thread so that skewed indices still spread
+    // over the threads. If 'N' is small, the overheads of parallel execution
+    // outweigh its benefits.
+    const Index kPartitionsPerThread = 8;
+    const Index num_partitions = std::min<Index>(
+        limit, kPartitionsPerThread *
+                   c->device()->tensorflow_cpu_worker_threads()->num_threads);
+    if (N < min_n_threshold || num_partitions < 2) {
       return SerialExecute(c, d, params, updates, indices);
-    else
-      return ParallelExecute(c, d, params, updates, indices);
-#endif  // PLATFORM_GOOGLE
+    }
+    return ParallelExecute(c, d, params, updates, indices, num_partitions);
   }
 };
 
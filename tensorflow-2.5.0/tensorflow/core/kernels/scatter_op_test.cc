@@ -217,6 +217,45 @@ TEST_F(ScatterSubOpTest, StressIndexTest) {
   test::ExpectTensorEqual<int32>(expected, params_tensor);
 }
 
+TEST_F(ScatterSubOpTest, StressDuplicateIndicesManyRows) {
+  MakeOp(DT_INT32_REF, DT_INT32);
+  // Feed and run
+  const int kRows = 1000;
+  std::vector<int32> values(kRows, 0);
+  const int kNumUpdates = 100000;
+  std::vector<int32> indices(kNumUpdates);
+  for (int i = 0; i < kNumUpdates; ++i) {
+    indices[i] = (i * 7) % kRows;
+  }
+  std::vector<int32> updates(kNumUpdates, 1);
+  AddInputFromArray<int32>(TensorShape({kRows}), values);
+  AddInputFromArray<int32>(TensorShape({kNumUpdates}), indices);
+  AddInputFromArray<int32>(TensorShape({kNumUpdates}), updates);
+  TF_ASSERT_OK(RunOpKernel());
+  Tensor params_tensor = *mutable_input(0).tensor;
+  Tensor expected(allocator(), DT_INT32, TensorShape({kRows}));
+  test::FillFn<int32>(&expected, [](int) { return -kNumUpdates / kRows; });
+  test::ExpectTensorEqual<int32>(expected, params_tensor);
+}
+
+TEST_F(ScatterSubOpTest, Error_IndexOutOfRangeManyUpdates) {
+  MakeOp(DT_FLOAT_REF, DT_INT32);
+  // Feed and run
+  const int kRows = 100;
+  const int kNumUpdates = 10000;
+  std::vector<int32> indices(kNumUpdates, 3);
+  indices[5000] = 99999;
+  indices[8000] = -1;
+  AddInputFromArray<float>(TensorShape({kRows}), std::vector<float>(kRows));
+  AddInputFromArray<int32>(TensorShape({kNumUpdates}), indices);
+  AddInputFromArray<float>(TensorShape({kNumUpdates}),
+                           std::vector<float>(kNumUpdates, 1));
+  Status s = RunOpKernel();
+  EXPECT_TRUE(absl::StrContains(s.ToString(),
+                                "indices[5000] = 99999 is not in [0, 100)"))
+      << s;
+}
+
 TEST_F(ScatterUpdateOpTest, Error_WrongDimsIndices) {
   MakeOp(DT_FLOAT_REF, DT_INT32);
 
@@ -38,7 +38,10 @@ limitations under the License.
 #include "tensorflow/core/kernels/segment_reduction_ops.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/prefetch.h"
 #include "tensorflow/core/util/util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
@@ -531,61 +534,108 @@ class SparseSegmentReductionOpBase : public OpKernel {
     }
     auto temp_flat = temp.flat_outer_dims<float>();
 
-    int64 start = 0, end = 1;
-    // Index from which the output is not initialized.
-    SegmentId uninitialized_index = 0;
-    SegmentId out_index = internal::SubtleMustCopy(segment_vec(start));
-
-    while (true) {
-      // We initialize next_index to 0 to avoid "warning: 'next_index' may be
-      // used uninitialized in this function" in the Mac build (since the
-      // compiler isn't smart enough to realize the code is safe).
-      SegmentId next_index = 0;
-      if (end < num_indices) {
-        next_index = internal::SubtleMustCopy(segment_vec(end));
-        if (out_index == next_index) {
-          ++end;
-          continue;
+    // Validate the segment ids and indices in the order in which they used to
+    // be reduced, so that the same error is reported for invalid inputs, and
+    // record where each segment starts.
+    std::vector<int64> segment_starts;
+    std::vector<SegmentId> segment_out_ids;
+    {
+      int64 start = 0, end = 1;
+      SegmentId out_index = internal::SubtleMustCopy(segment_vec(start));
+
+      while (true) {
+        // We initialize next_index to 0 to avoid "warning: 'next_index' may be
+        // used uninitialized in this function" in the Mac build (since the
+        // compiler isn't smart enough to realize the code is safe).
+        SegmentId next_index = 0;
+        if (end < num_indices) {
+          next_index = internal::SubtleMustCopy(segment_vec(end));
+          if (out_index == next_index) {
+            ++end;
+            continue;
+          }
+          // We have a new segment here.  Verify that the segment ids are
+          // growing.
+          OP_REQUIRES(
+              context, out_index < next_index,
+              errors::InvalidArgument("segment ids are not increasing"));
         }
-        // We have a new segment here.  Verify that the segment ids are growing.
-        OP_REQUIRES(context, out_index < next_index,
-                    errors::InvalidArgument("segment ids are not increasing"));
-      }
 
-      OP_REQUIRES(
-          context, FastBoundsCheck(out_index, output_rows),
-          errors::InvalidArgument(
-              "Segment id ", out_index, " out of range [0, ", output_rows,
-              "), possibly because 'segment_ids' input is not sorted."));
+        OP_REQUIRES(
+            context, FastBoundsCheck(out_index, output_rows),
+            errors::InvalidArgument(
+                "Segment id ", out_index, " out of range [0, ", output_rows,
+                "), possibly because 'segment_ids' input is not sorted."));
+        for (int64 i = start; i < end; ++i) {
+          OP_REQUIRES(context,
+                      FastBoundsCheck(indices_vec(i), input_flat.dimension(0)),
+                      errors::InvalidArgument(
+                          "Bad: indices[", i, "] == ", indices_vec(i),
+                          " out of range [0, ", input_flat.dimension(0), ")"));
+        }
+        segment_starts.push_back(start);
+        segment_out_ids.push_back(out_index);
 
-      // If there is a gap between two indices, we need to set that gap to the
-      // default value.
-      if (out_index > uninitialized_index) {
-        Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
-            out_index - uninitialized_index, num_col);
-        Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>, Eigen::Unaligned>
-            gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
-        gap_slice.setConstant(default_value_);
+        start = end;
+        ++end;
+        out_index = next_index;
+        if (end > num_indices) break;
       }
-
-      auto out = output_flat.template chip<0>(out_index);
-      auto temp = temp_flat.template chip<0>(out_index);
-      const int bad_offset = Reduce<T, Index>(input_flat, indices_vec, start,
-                                              end - start, out, temp);
-      OP_REQUIRES(context, bad_offset < 0,
-                  errors::InvalidArgument(
-                      "Bad: indices[", start + bad_offset,
-                      "] == ", indices_vec(start + bad_offset),
-                      " out of range [0, ", input_flat.dimension(0), ")"));
-
-      start = end;
-      ++end;
-      uninitialized_index = out_index + 1;
-      out_index = next_index;
-      if (end > num_indices) break;
     }
+    segment_starts.push_back(num_indices);
+    const int64 num_segments = segment_out_ids.size();
+
+    // Reduce blocks of segments in parallel. Each segment also fills the gap
+    // of missing segment ids in front of it with the default value.
+    mutex mu;
+    Status status;
+    auto reduce_segments = [&](int64 begin, int64 end) {
+      for (int64 s = begin; s < end; ++s) {
+        const SegmentId out_index = segment_out_ids[s];
+        const SegmentId uninitialized_index =
+            s == 0 ? 0 : segment_out_ids[s - 1] + 1;
+        if (out_index > uninitialized_index) {
+          Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
+              out_index - uninitialized_index, num_col);
+          Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>,
+                           Eigen::Unaligned>
+              gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
+          gap_slice.setConstant(default_value_);
+        }
+        // The rows of a segment are gathered from arbitrary positions, which
+        // the hardware prefetcher can't predict, so prefetch the rows of the
+        // next segment while this one is reduced.
+        if (s + 1 < end) {
+          PrefetchRows<Index>(input_flat, indices_vec, segment_starts[s + 1],
+                              segment_starts[s + 2]);
+        }
+
+        const int64 start = segment_starts[s];
+        const int64 num = segment_starts[s + 1] - start;
+        auto out = output_flat.template chip<0>(out_index);
+        auto temp = temp_flat.template chip<0>(out_index);
+        const int bad_offset =
+            Reduce<T, Index>(input_flat, indices_vec, start, num, out, temp);
+        if (bad_offset >= 0) {
+          // Only possible if the indices changed after they were validated.
+          mutex_lock l(mu);
+          status.Update(errors::InvalidArgument(
+              "Bad: indices[", start + bad_offset,
+              "] == ", indices_vec(start + bad_offset), " out of range [0, ",
+              input_flat.dimension(0), ")"));
+        }
+      }
+    };
+    const int64 cost_per_segment =
+        std::max<int64>(1, num_indices / num_segments) * num_col *
+        Eigen::TensorOpCost::AddCost<T>();
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, num_segments,
+          cost_per_segment, reduce_segments);
+    OP_REQUIRES_OK(context, status);
 
     // Fill the gap at the end with the default value.
+    const SegmentId uninitialized_index = segment_out_ids.back() + 1;
     if (uninitialized_index < output_rows) {
       Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
           output_rows - uninitialized_index, num_col);
@@ -615,6 +665,21 @@ class SparseSegmentReductionOpBase : public OpKernel {
     return input_flat.template chip<0>(index).template cast<float>();
   }
 
+  template <typename Tindex>
+  static void PrefetchRows(const typename TTypes<T>::ConstMatrix& input_flat,
+                           const typename TTypes<Tindex>::ConstVec& indices_vec,
+                           int64 start, int64 end) {
+    static constexpr int64 kCacheLineSize = 64;
+    const int64 row_bytes = input_flat.dimension(1) * sizeof(T);
+    for (int64 i = start; i < end; ++i) {
+      const char* row = reinterpret_cast<const char*>(
+          &input_flat(internal::SubtleMustCopy(indices_vec(i)), 0));
+      for (int64 offset = 0; offset < row_bytes; offset += kCacheLineSize) {
+        port::prefetch<port::PREFETCH_HINT_T0>(row + offset);
+      }
+    }
+  }
+
   template <typename Tout>
   EIGEN_ALWAYS_INLINE Tout get_scaling_factor(int64 num) {
     Tout m(1);
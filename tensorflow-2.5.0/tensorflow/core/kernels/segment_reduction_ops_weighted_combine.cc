@@ -0,0 +1,361 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/math_ops.cc.
+
+#include <cmath>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/bounds_check.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+namespace {
+
+enum class Combiner { kSum, kMean, kSqrtN };
+
+Status GetCombiner(OpKernelConstruction* context, Combiner* combiner) {
+  string combiner_str;
+  TF_RETURN_IF_ERROR(context->GetAttr("combiner", &combiner_str));
+  if (combiner_str == "sum") {
+    *combiner = Combiner::kSum;
+  } else if (combiner_str == "mean") {
+    *combiner = Combiner::kMean;
+  } else if (combiner_str == "sqrtn") {
+    *combiner = Combiner::kSqrtN;
+  } else {
+    return errors::InvalidArgument("Unknown combiner: ", combiner_str);
+  }
+  return Status::OK();
+}
+
+// Validates `indices`, `weights` and `segment_ids` and splits the entries into
+// runs of equal (sorted) segment ids. On return `segment_starts` holds the
+// offset of the first entry of every run followed by a trailing `num_indices`,
+// and `output_rows` is one past the largest segment id.
+template <typename Index, typename SegmentId>
+Status ComputeSegmentStarts(const Tensor& indices, const Tensor& weights,
+                            const Tensor& segment_ids, int64 data_rows,
+                            std::vector<int64>* segment_starts,
+                            int64* output_rows) {
+  if (!TensorShapeUtils::IsVector(indices.shape())) {
+    return errors::InvalidArgument("indices should be a vector.");
+  }
+  if (!TensorShapeUtils::IsVector(weights.shape())) {
+    return errors::InvalidArgument("weights should be a vector.");
+  }
+  if (!TensorShapeUtils::IsVector(segment_ids.shape())) {
+    return errors::InvalidArgument("segment_ids should be a vector.");
+  }
+  const int64 num_indices = indices.NumElements();
+  if (num_indices != segment_ids.NumElements() ||
+      num_indices != weights.NumElements()) {
+    return errors::InvalidArgument(
+        "indices, weights and segment_ids should have same size.");
+  }
+
+  const auto indices_vec = indices.vec<Index>();
+  const auto segment_vec = segment_ids.vec<SegmentId>();
+  segment_starts->clear();
+  SegmentId previous_id = 0;
+  for (int64 i = 0; i < num_indices; ++i) {
+    const Index index = internal::SubtleMustCopy(indices_vec(i));
+    if (!FastBoundsCheck(index, data_rows)) {
+      return errors::InvalidArgument("Bad: indices[", i, "] == ", index,
+                                     " out of range [0, ", data_rows, ")");
+    }
+    const SegmentId id = internal::SubtleMustCopy(segment_vec(i));
+    if (id < 0) {
+      return errors::InvalidArgument("segment ids must be >= 0");
+    }
+    if (i == 0 || id != previous_id) {
+      if (i > 0 && id < previous_id) {
+        return errors::InvalidArgument("segment ids are not increasing");
+      }
+      segment_starts->push_back(i);
+      previous_id = id;
+    }
+  }
+  segment_starts->push_back(num_indices);
+  *output_rows = num_indices > 0 ? static_cast<int64>(previous_id) + 1 : 0;
+  return Status::OK();
+}
+
+// Returns the value the weighted sum of segment [start, end) is divided by.
+template <typename T>
+T SegmentDivisor(Combiner combiner, const typename TTypes<T>::ConstVec& weights,
+                 int64 start, int64 end) {
+  T divisor(0);
+  switch (combiner) {
+    case Combiner::kSum:
+      return T(1);
+    case Combiner::kMean:
+      for (int64 i = start; i < end; ++i) divisor += weights(i);
+      return divisor;
+    case Combiner::kSqrtN:
+      for (int64 i = start; i < end; ++i) divisor += weights(i) * weights(i);
+      return std::sqrt(divisor);
+  }
+  return divisor;
+}
+
+}  // namespace
+
+// Computes output[segment_ids[i]] = combine_i(weights[i] * data[indices[i]])
+// without materializing the gathered rows: every segment is accumulated
+// directly into its output row and then divided by the combiner's divisor.
+template <typename T, typename Index, typename SegmentId>
+class SparseSegmentWeightedCombineOp : public OpKernel {
+ public:
+  explicit SparseSegmentWeightedCombineOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, GetCombiner(context, &combiner_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& data = context->input(0);
+    const Tensor& indices = context->input(1);
+    const Tensor& weights = context->input(2);
+    const Tensor& segment_ids = context->input(3);
+
+    OP_REQUIRES(context, TensorShapeUtils::IsVectorOrHigher(data.shape()),
+                errors::InvalidArgument("data must be at least rank 1"));
+    std::vector<int64> segment_starts;
+    int64 output_rows;
+    OP_REQUIRES_OK(context, (ComputeSegmentStarts<Index, SegmentId>(
+                                indices, weights, segment_ids, data.dim_size(0),
+                                &segment_starts, &output_rows)));
+
+    TensorShape output_shape = data.shape();
+    output_shape.set_dim(0, output_rows);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+    if (output->NumElements() == 0) return;
+    auto output_flat = output->flat_outer_dims<T>();
+    output_flat.setZero();
+
+    const auto data_flat = data.flat_outer_dims<T>();
+    const int64 num_col = data_flat.dimension(1);
+    const auto indices_vec = indices.vec<Index>();
+    const auto weights_vec = weights.vec<T>();
+    const auto segment_vec = segment_ids.vec<SegmentId>();
+    const int64 num_segments = segment_starts.size() - 1;
+    const Combiner combiner = combiner_;
+
+    auto work = [&](int64 begin, int64 end) {
+      for (int64 s = begin; s < end; ++s) {
+        const int64 start = segment_starts[s];
+        const int64 limit = segment_starts[s + 1];
+        T* out = &output_flat(segment_vec(start), 0);
+        for (int64 i = start; i < limit; ++i) {
+          const T* row = &data_flat(indices_vec(i), 0);
+          const T w = weights_vec(i);
+          for (int64 k = 0; k < num_col; ++k) out[k] += w * row[k];
+        }
+        if (combiner != Combiner::kSum) {
+          const T divisor =
+              SegmentDivisor<T>(combiner, weights_vec, start, limit);
+          for (int64 k = 0; k < num_col; ++k) out[k] /= divisor;
+        }
+      }
+    };
+    const int64 cost_per_segment =
+        num_col * (segment_starts.back() / num_segments + 1);
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, num_segments,
+          cost_per_segment, work);
+  }
+
+ private:
+  Combiner combiner_;
+};
+
+// Gradient of SparseSegmentWeightedCombine. The gradient with respect to
+// `data` is returned as the IndexedSlices (output_indices, output_values)
+// holding one row per distinct index, in order of first appearance. The
+// gradient with respect to `weights` only needs per-entry dot products with
+// the incoming gradient, so neither gradient materializes [nnz, dim] rows.
+template <typename T, typename Index, typename SegmentId>
+class SparseSegmentWeightedCombineGradOp : public OpKernel {
+ public:
+  explicit SparseSegmentWeightedCombineGradOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, GetCombiner(context, &combiner_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& grad = context->input(0);
+    const Tensor& data = context->input(1);
+    const Tensor& indices = context->input(2);
+    const Tensor& weights = context->input(3);
+    const Tensor& segment_ids = context->input(4);
+
+    OP_REQUIRES(context, TensorShapeUtils::IsVectorOrHigher(data.shape()),
+                errors::InvalidArgument("data must be at least rank 1"));
+    OP_REQUIRES(context, grad.dims() == data.dims(),
+                errors::InvalidArgument("grad and data must have same rank"));
+    for (int d = 1; d < data.dims(); ++d) {
+      OP_REQUIRES(context, grad.dim_size(d) == data.dim_size(d),
+                  errors::InvalidArgument(
+                      "grad and data must agree in dimension ", d, ": ",
+                      grad.shape().DebugString(), " vs. ",
+                      data.shape().DebugString()));
+    }
+    std::vector<int64> segment_starts;
+    int64 output_rows;
+    OP_REQUIRES_OK(context, (ComputeSegmentStarts<Index, SegmentId>(
+                                indices, weights, segment_ids, data.dim_size(0),
+                                &segment_starts, &output_rows)));
+    OP_REQUIRES(context, output_rows <= grad.dim_size(0),
+                errors::InvalidArgument("segment ids must be < grad.shape[0]"));
+
+    const int64 num_indices = indices.NumElements();
+    const int64 num_segments = segment_starts.size() - 1;
+    const auto indices_vec = indices.vec<Index>();
+    const auto weights_vec = weights.vec<T>();
+    const auto segment_vec = segment_ids.vec<SegmentId>();
+
+    // Assign every distinct index an output row.
+    absl::flat_hash_map<Index, int64> index_to_row;
+    std::vector<int64> rows(num_indices);
+    for (int64 i = 0; i < num_indices; ++i) {
+      rows[i] = index_to_row.emplace(indices_vec(i), index_to_row.size())
+                    .first->second;
+    }
+    const int64 num_unique = index_to_row.size();
+
+    Tensor* output_indices = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, TensorShape({num_unique}),
+                                            &output_indices));
+    auto output_indices_vec = output_indices->vec<Index>();
+    for (const auto& entry : index_to_row) {
+      output_indices_vec(entry.second) = entry.first;
+    }
+
+    TensorShape values_shape = data.shape();
+    values_shape.set_dim(0, num_unique);
+    Tensor* output_values = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(1, values_shape, &output_values));
+    Tensor* weights_grad = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(2, weights.shape(),
+                                                     &weights_grad));
+    if (num_indices == 0) return;
+
+    auto values_flat = output_values->flat_outer_dims<T>();
+    values_flat.setZero();
+    auto weights_grad_vec = weights_grad->vec<T>();
+    const auto grad_flat = grad.flat_outer_dims<T>();
+    const auto data_flat = data.flat_outer_dims<T>();
+    const int64 num_col = data_flat.dimension(1);
+    const Combiner combiner = combiner_;
+
+    std::vector<T> divisors(num_segments);
+    auto work = [&](int64 begin, int64 end) {
+      for (int64 s = begin; s < end; ++s) {
+        const int64 start = segment_starts[s];
+        const int64 limit = segment_starts[s + 1];
+        const T divisor =
+            SegmentDivisor<T>(combiner, weights_vec, start, limit);
+        divisors[s] = divisor;
+        const T* g = &grad_flat(segment_vec(start), 0);
+        // weights_grad first holds the dot product of `g` with each row, and
+        // `g_dot_out` the dot product of `g` with the forward output.
+        T g_dot_out(0);
+        for (int64 i = start; i < limit; ++i) {
+          const T* row = &data_flat(indices_vec(i), 0);
+          T dot(0);
+          for (int64 k = 0; k < num_col; ++k) dot += g[k] * row[k];
+          weights_grad_vec(i) = dot;
+          g_dot_out += weights_vec(i) * dot;
+        }
+        g_dot_out /= divisor;
+        for (int64 i = start; i < limit; ++i) {
+          switch (combiner) {
+            case Combiner::kSum:
+              break;
+            case Combiner::kMean:
+              weights_grad_vec(i) = (weights_grad_vec(i) - g_dot_out) / divisor;
+              break;
+            case Combiner::kSqrtN:
+              weights_grad_vec(i) =
+                  (weights_grad_vec(i) - g_dot_out * weights_vec(i) / divisor) /
+                  divisor;
+              break;
+          }
+        }
+      }
+    };
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, num_segments,
+          num_col * (num_indices / num_segments + 1), work);
+
+    // Different segments may share an index, so the scatter into the unique
+    // rows is done sequentially.
+    for (int64 s = 0; s < num_segments; ++s) {
+      const T* g = &grad_flat(segment_vec(segment_starts[s]), 0);
+      for (int64 i = segment_starts[s]; i < segment_starts[s + 1]; ++i) {
+        T* out = &values_flat(rows[i], 0);
+        const T c = weights_vec(i) / divisors[s];
+        for (int64 k = 0; k < num_col; ++k) out[k] += c * g[k];
+      }
+    }
+  }
+
+ private:
+  Combiner combiner_;
+};
+
+#define REGISTER_CPU_KERNELS(type, index_type, segment_ids_type)     \
+  REGISTER_KERNEL_BUILDER(Name("SparseSegmentWeightedCombine")       \
+                              .Device(DEVICE_CPU)                    \
+                              .TypeConstraint<type>("T")             \
+                              .TypeConstraint<index_type>("Tidx")    \
+                              .TypeConstraint<segment_ids_type>(     \
+                                  "Tsegmentids"),                    \
+                          SparseSegmentWeightedCombineOp<            \
+                              type, index_type, segment_ids_type>);  \
+  REGISTER_KERNEL_BUILDER(Name("SparseSegmentWeightedCombineGrad")   \
+                              .Device(DEVICE_CPU)                    \
+                              .TypeConstraint<type>("T")             \
+                              .TypeConstraint<index_type>("Tidx")    \
+                              .TypeConstraint<segment_ids_type>(     \
+                                  "Tsegmentids"),                    \
+                          SparseSegmentWeightedCombineGradOp<        \
+                              type, index_type, segment_ids_type>);
+#define REGISTER_CPU_KERNELS_FOR_EACH_SEGMENT_ID_TYPE(type, index_type) \
+  REGISTER_CPU_KERNELS(type, index_type, int32)                         \
+  REGISTER_CPU_KERNELS(type, index_type, int64)
+#define REGISTER_CPU_KERNELS_FOR_EACH_INDEX_TYPE(type)       \
+  REGISTER_CPU_KERNELS_FOR_EACH_SEGMENT_ID_TYPE(type, int32) \
+  REGISTER_CPU_KERNELS_FOR_EACH_SEGMENT_ID_TYPE(type, int64)
+
+REGISTER_CPU_KERNELS_FOR_EACH_INDEX_TYPE(float);
+REGISTER_CPU_KERNELS_FOR_EACH_INDEX_TYPE(double);
+
+#undef REGISTER_CPU_KERNELS_FOR_EACH_INDEX_TYPE
+#undef REGISTER_CPU_KERNELS_FOR_EACH_SEGMENT_ID_TYPE
+#undef REGISTER_CPU_KERNELS
+
+}  // namespace tensorflow
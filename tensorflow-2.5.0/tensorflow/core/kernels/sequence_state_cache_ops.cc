@@ -0,0 +1,278 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Kernels for SequenceStateCache and the ops that read and write it.
+
+#include <string.h>
+
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/resource_op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/strcat.h"
+
+namespace tensorflow {
+namespace {
+
+// Holds the state of up to `capacity` sequences in one preallocated pool of
+// shape [capacity] + state_shape. A sequence is assigned a row ("slot") of the
+// pool the first time its state is stored and keeps it until it is released,
+// so steady-state decoding never allocates.
+class SequenceStateCacheResource : public ResourceBase {
+ public:
+  SequenceStateCacheResource(Tensor pool, const TensorShape& state_shape)
+      : pool_(std::move(pool)),
+        state_shape_(state_shape),
+        state_bytes_(state_shape.num_elements() * DataTypeSize(pool_.dtype())) {
+    free_slots_.reserve(capacity());
+    for (int64 slot = capacity() - 1; slot >= 0; --slot) {
+      free_slots_.push_back(slot);
+    }
+  }
+
+  std::string DebugString() const override {
+    return strings::StrCat("SequenceStateCache(", DataTypeString(dtype()), "/",
+                           state_shape_.DebugString(), " x ", capacity(), ")");
+  }
+
+  int64 MemoryUsed() const override { return pool_.TotalBytes(); }
+
+  DataType dtype() const { return pool_.dtype(); }
+  const TensorShape& state_shape() const { return state_shape_; }
+  int64 capacity() const { return pool_.dim_size(0); }
+
+  // Copies the state of each of `ids` into the rows of `states`, or zeros for
+  // ids that have no slot.
+  void Gather(const std::vector<int64>& ids, Tensor* states) {
+    char* out = const_cast<char*>(states->tensor_data().data());
+    const char* pool = pool_.tensor_data().data();
+    tf_shared_lock l(mu_);
+    for (int64 i = 0; i < ids.size(); ++i) {
+      char* dst = out + i * state_bytes_;
+      auto it = slots_.find(ids[i]);
+      if (it == slots_.end()) {
+        memset(dst, 0, state_bytes_);
+      } else {
+        memcpy(dst, pool + it->second * state_bytes_, state_bytes_);
+      }
+    }
+  }
+
+  // Copies the rows of `states` into the slots of `ids`, assigning slots to
+  // ids that have none. Fails without changing anything if there are not
+  // enough free slots.
+  Status Scatter(const std::vector<int64>& ids, const Tensor& states) {
+    const char* in = states.tensor_data().data();
+    char* pool = const_cast<char*>(pool_.tensor_data().data());
+    mutex_lock l(mu_);
+    int64 num_new = 0;
+    for (int64 id : ids) {
+      if (!slots_.contains(id)) ++num_new;
+    }
+    if (num_new > static_cast<int64>(free_slots_.size())) {
+      return errors::ResourceExhausted(
+          "SequenceStateCache is full: ", num_new, " new sequences but only ",
+          free_slots_.size(), " of ", capacity(), " slots are free.");
+    }
+    for (int64 i = 0; i < ids.size(); ++i) {
+      auto insert = slots_.emplace(ids[i], 0);
+      if (insert.second) {
+        insert.first->second = free_slots_.back();
+        free_slots_.pop_back();
+      }
+      memcpy(pool + insert.first->second * state_bytes_, in + i * state_bytes_,
+             state_bytes_);
+    }
+    return Status::OK();
+  }
+
+  // Returns the slots of `ids` to the pool.
+  void Release(const std::vector<int64>& ids) {
+    mutex_lock l(mu_);
+    for (int64 id : ids) {
+      auto it = slots_.find(id);
+      if (it != slots_.end()) {
+        free_slots_.push_back(it->second);
+        slots_.erase(it);
+      }
+    }
+  }
+
+ private:
+  // The pool buffer is only read under a shared and written under an
+  // exclusive lock of mu_.
+  const Tensor pool_;
+  const TensorShape state_shape_;
+  const int64 state_bytes_;
+
+  mutex mu_;
+  absl::flat_hash_map<int64, int64> slots_ TF_GUARDED_BY(mu_);
+  std::vector<int64> free_slots_ TF_GUARDED_BY(mu_);
+};
+
+class SequenceStateCacheOp
+    : public ResourceOpKernel<SequenceStateCacheResource> {
+ public:
+  explicit SequenceStateCacheOp(OpKernelConstruction* context)
+      : ResourceOpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("dtype", &dtype_));
+    OP_REQUIRES(context, DataTypeCanUseMemcpy(dtype_),
+                errors::InvalidArgument(
+                    "SequenceStateCache does not support dtype ",
+                    DataTypeString(dtype_)));
+    PartialTensorShape state_shape;
+    OP_REQUIRES_OK(context, context->GetAttr("state_shape", &state_shape));
+    OP_REQUIRES(context, state_shape.AsTensorShape(&state_shape_),
+                errors::InvalidArgument(
+                    "SequenceStateCache requires a fully defined state_shape, "
+                    "got ",
+                    state_shape.DebugString()));
+    OP_REQUIRES_OK(context, context->GetAttr("capacity", &capacity_));
+  }
+
+ private:
+  Status CreateResource(SequenceStateCacheResource** resource) override
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    TensorShape pool_shape({capacity_});
+    pool_shape.AppendShape(state_shape_);
+    Tensor pool(dtype_, pool_shape);
+    if (!pool.IsInitialized() && pool_shape.num_elements() > 0) {
+      return errors::ResourceExhausted(
+          "Failed to allocate a SequenceStateCache of shape ",
+          pool_shape.DebugString());
+    }
+    *resource = new SequenceStateCacheResource(std::move(pool), state_shape_);
+    return Status::OK();
+  }
+
+  Status VerifyResource(SequenceStateCacheResource* resource) override {
+    if (resource->dtype() != dtype_ ||
+        resource->state_shape() != state_shape_ ||
+        resource->capacity() != capacity_) {
+      return errors::InvalidArgument(
+          "Shared SequenceStateCache is ", resource->DebugString(), ", not ",
+          DataTypeString(dtype_), "/", state_shape_.DebugString(), " x ",
+          capacity_);
+    }
+    return Status::OK();
+  }
+
+  DataType dtype_;
+  TensorShape state_shape_;
+  int64 capacity_;
+};
+
+// Looks up the cache and the sequence ids shared by the ops below.
+Status GetCacheAndIds(OpKernelContext* context,
+                      core::RefCountPtr<SequenceStateCacheResource>* cache,
+                      std::vector<int64>* ids) {
+  TF_RETURN_IF_ERROR(
+      LookupResource(context, HandleFromInput(context, 0), cache));
+  const Tensor& ids_tensor = context->input(1);
+  if (!TensorShapeUtils::IsVector(ids_tensor.shape())) {
+    return errors::InvalidArgument("sequence_ids must be a vector, got shape ",
+                                   ids_tensor.shape().DebugString());
+  }
+  const auto ids_flat = ids_tensor.vec<int64>();
+  ids->assign(ids_flat.data(), ids_flat.data() + ids_flat.size());
+  return Status::OK();
+}
+
+class SequenceStateCacheGatherOp : public OpKernel {
+ public:
+  explicit SequenceStateCacheGatherOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("dtype", &dtype_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    core::RefCountPtr<SequenceStateCacheResource> cache;
+    std::vector<int64> ids;
+    OP_REQUIRES_OK(context, GetCacheAndIds(context, &cache, &ids));
+    OP_REQUIRES(context, cache->dtype() == dtype_,
+                errors::InvalidArgument(
+                    "Trying to gather ", DataTypeString(dtype_), " from ",
+                    cache->DebugString()));
+    TensorShape states_shape({static_cast<int64>(ids.size())});
+    states_shape.AppendShape(cache->state_shape());
+    Tensor* states = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, states_shape, &states));
+    cache->Gather(ids, states);
+  }
+
+ private:
+  DataType dtype_;
+};
+
+class SequenceStateCacheScatterOp : public OpKernel {
+ public:
+  explicit SequenceStateCacheScatterOp(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    core::RefCountPtr<SequenceStateCacheResource> cache;
+    std::vector<int64> ids;
+    OP_REQUIRES_OK(context, GetCacheAndIds(context, &cache, &ids));
+    const Tensor& states = context->input(2);
+    TensorShape expected_shape({static_cast<int64>(ids.size())});
+    expected_shape.AppendShape(cache->state_shape());
+    OP_REQUIRES(context,
+                states.dtype() == cache->dtype() &&
+                    states.shape() == expected_shape,
+                errors::InvalidArgument(
+                    "Expected states of type ", DataTypeString(cache->dtype()),
+                    " and shape ", expected_shape.DebugString(), ", got ",
+                    DataTypeString(states.dtype()), " and ",
+                    states.shape().DebugString()));
+    absl::flat_hash_set<int64> unique_ids(ids.begin(), ids.end());
+    OP_REQUIRES(context, unique_ids.size() == ids.size(),
+                errors::InvalidArgument("sequence_ids must be distinct."));
+    OP_REQUIRES_OK(context, cache->Scatter(ids, states));
+  }
+};
+
+class SequenceStateCacheReleaseOp : public OpKernel {
+ public:
+  explicit SequenceStateCacheReleaseOp(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    core::RefCountPtr<SequenceStateCacheResource> cache;
+    std::vector<int64> ids;
+    OP_REQUIRES_OK(context, GetCacheAndIds(context, &cache, &ids));
+    cache->Release(ids);
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("SequenceStateCache").Device(DEVICE_CPU),
+                        SequenceStateCacheOp);
+REGISTER_KERNEL_BUILDER(Name("SequenceStateCacheGather").Device(DEVICE_CPU),
+                        SequenceStateCacheGatherOp);
+REGISTER_KERNEL_BUILDER(Name("SequenceStateCacheScatter").Device(DEVICE_CPU),
+                        SequenceStateCacheScatterOp);
+REGISTER_KERNEL_BUILDER(Name("SequenceStateCacheRelease").Device(DEVICE_CPU),
+                        SequenceStateCacheReleaseOp);
+
+}  // namespace
+}  // namespace tensorflow
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/kernels/fill_functor.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -329,6 +330,152 @@ Status SparseTensorDenseMatMulImpl(
   }
   return Status::OK();
 }
+
+// Computes the same product as SparseTensorDenseMatMulImpl, but first buckets
+// the nonzeros of 'a' by output row (i.e. converts them to CSR) so that blocks
+// of output rows can be computed in parallel without synchronization.
+template <typename T, typename Tsum, typename Tindices, bool ADJ_A, bool ADJ_B>
+Status SparseTensorDenseMatMulCsrImpl(
+    OpKernelContext* ctx, typename TTypes<Tsum>::Matrix out,
+    typename TTypes<Tindices>::ConstMatrix a_indices,
+    typename TTypes<T>::ConstVec a_values, typename TTypes<T>::ConstMatrix b) {
+  static constexpr std::size_t kNumVectorize = 32;
+
+  const std::size_t nnz = a_values.size();
+  const std::size_t rhs_right = (ADJ_B ? b.dimension(0) : b.dimension(1));
+  const std::size_t lhs_right = (ADJ_B ? b.dimension(1) : b.dimension(0));
+  const int lhs_index_a = ADJ_A ? 1 : 0;
+  const int rhs_index_a = ADJ_A ? 0 : 1;
+  const int64 num_rows = out.dimension(0);
+
+  // Count the nonzeros of each row, validating the indices in the same order
+  // as SparseTensorDenseMatMulImpl so that the same error is reported.
+  Tensor row_offsets_t;
+  TF_RETURN_IF_ERROR(ctx->allocate_temp(
+      DT_INT64, TensorShape({num_rows + 1}), &row_offsets_t));
+  auto row_offsets = row_offsets_t.vec<int64>();
+  row_offsets.setZero();
+  for (std::size_t i = 0; i < nnz; ++i) {
+    const Tindices m = internal::SubtleMustCopy(a_indices(i, lhs_index_a));
+    const Tindices k = internal::SubtleMustCopy(a_indices(i, rhs_index_a));
+    if (!FastBoundsCheck(k, lhs_right)) {
+      return KOutOfBoundsError(k, i, rhs_index_a, lhs_right);
+    }
+    if (!FastBoundsCheck(m, num_rows)) {
+      return MOutOfBoundsError(m, i, lhs_index_a, num_rows);
+    }
+    ++row_offsets(m + 1);
+  }
+  for (int64 m = 0; m < num_rows; ++m) {
+    row_offsets(m + 1) += row_offsets(m);
+  }
+
+  // Stable counting sort: the entries of a row keep their original order, so
+  // every output element accumulates the same terms in the same order as in
+  // SparseTensorDenseMatMulImpl.
+  Tensor csr_cols_t;
+  TF_RETURN_IF_ERROR(ctx->allocate_temp(DataTypeToEnum<Tindices>::value,
+                                        TensorShape({static_cast<int64>(nnz)}),
+                                        &csr_cols_t));
+  Tensor csr_values_t;
+  TF_RETURN_IF_ERROR(ctx->allocate_temp(DataTypeToEnum<T>::value,
+                                        TensorShape({static_cast<int64>(nnz)}),
+                                        &csr_values_t));
+  auto csr_cols = csr_cols_t.vec<Tindices>();
+  auto csr_values = csr_values_t.vec<T>();
+  {
+    std::vector<int64> next(row_offsets.data(), row_offsets.data() + num_rows);
+    for (std::size_t i = 0; i < nnz; ++i) {
+      // The indices may be modified concurrently, so the values read here are
+      // checked again rather than trusted from the first pass.
+      const Tindices m = internal::SubtleMustCopy(a_indices(i, lhs_index_a));
+      const Tindices k = internal::SubtleMustCopy(a_indices(i, rhs_index_a));
+      if (!FastBoundsCheck(k, lhs_right)) {
+        return KOutOfBoundsError(k, i, rhs_index_a, lhs_right);
+      }
+      if (!FastBoundsCheck(m, num_rows)) {
+        return MOutOfBoundsError(m, i, lhs_index_a, num_rows);
+      }
+      if (next[m] == row_offsets(m + 1)) {
+        return errors::InvalidArgument("Index[", i, ",", lhs_index_a,
+                                       "] changed during the computation");
+      }
+      const int64 pos = next[m]++;
+      csr_cols(pos) = k;
+      csr_values(pos) = ADJ_A ? MaybeConj(a_values(i)) : a_values(i);
+    }
+  }
+
+  // Each shard owns a contiguous block of output rows.
+  const int64 cost_per_row =
+      std::max<int64>(1, nnz / num_rows) * rhs_right *
+      (Eigen::TensorOpCost::AddCost<Tsum>() +
+       Eigen::TensorOpCost::MulCost<Tsum>());
+  auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+
+  if (rhs_right < kNumVectorize) {
+    auto maybe_adjoint_b = MaybeAdjoint<decltype(b), ADJ_B>(b);
+    Shard(worker_threads->num_threads, worker_threads->workers, num_rows,
+          cost_per_row, [&](int64 begin, int64 end) {
+            for (int64 m = begin; m < end; ++m) {
+              for (int64 j = row_offsets(m); j < row_offsets(m + 1); ++j) {
+                const Tindices k = csr_cols(j);
+                const Tsum a_value = static_cast<Tsum>(csr_values(j));
+                for (std::size_t n = 0; n < rhs_right; ++n) {
+                  out(m, n) +=
+                      a_value * static_cast<Tsum>(maybe_adjoint_b(k, n));
+                }
+              }
+            }
+          });
+    return Status::OK();
+  }
+
+  const int b_chip_index = ADJ_B ? 1 : 0;
+  auto accumulate_rows = [&](const auto& b_passed) {
+    Shard(worker_threads->num_threads, worker_threads->workers, num_rows,
+          cost_per_row, [&](int64 begin, int64 end) {
+            for (int64 m = begin; m < end; ++m) {
+              auto out_row = out.template chip<0>(m);
+              for (int64 j = row_offsets(m); j < row_offsets(m + 1); ++j) {
+                out_row += b_passed.template chip<b_chip_index>(csr_cols(j))
+                               .template cast<Tsum>() *
+                           static_cast<Tsum>(csr_values(j));
+              }
+            }
+          });
+  };
+  if (ADJ_B) {
+    // Perform transpose and conjugation on B once, since we chip out B's
+    // columns in the nnz loop.
+    Eigen::array<int, 2> shuffle(1, 0);  // preserve dimension order
+    Eigen::Tensor<T, 2, Eigen::ColMajor> col_major_conj_b =
+        b.swap_layout().shuffle(shuffle).conjugate();
+    accumulate_rows(col_major_conj_b);
+  } else {
+    accumulate_rows(b);
+  }
+  return Status::OK();
+}
+
+// Uses the parallel CSR implementation when the product is large enough to
+// amortize the cost of converting 'a'.
+template <typename T, typename Tsum, typename Tindices, bool ADJ_A, bool ADJ_B>
+Status SparseTensorDenseMatMulDispatch(
+    OpKernelContext* ctx, typename TTypes<Tsum>::Matrix out,
+    typename TTypes<Tindices>::ConstMatrix a_indices,
+    typename TTypes<T>::ConstVec a_values, typename TTypes<T>::ConstMatrix b) {
+  static constexpr int64 kMinCsrCost = 1 << 17;
+  const int64 rhs_right = ADJ_B ? b.dimension(0) : b.dimension(1);
+  if (out.dimension(0) > 1 &&
+      ctx->device()->tensorflow_cpu_worker_threads()->num_threads > 1 &&
+      a_values.size() * rhs_right >= kMinCsrCost) {
+    return SparseTensorDenseMatMulCsrImpl<T, Tsum, Tindices, ADJ_A, ADJ_B>(
+        ctx, out, a_indices, a_values, b);
+  }
+  return SparseTensorDenseMatMulImpl<T, Tsum, Tindices, ADJ_A, ADJ_B>(
+      out, a_indices, a_values, b);
+}
 }  // namespace
 
 template <typename T, typename Tindices, bool ADJ_A, bool ADJ_B>
@@ -346,8 +493,8 @@ struct SparseTensorDenseMatMulFunctor<CPUDevice, T, Tindices, ADJ_A, ADJ_B> {
       auto temp_out = temp_out_t.matrix<Tsum>();
       temp_out.setZero();
       TF_RETURN_IF_ERROR(
-          SparseTensorDenseMatMulImpl<T, Tsum, Tindices, ADJ_A, ADJ_B>(
-              temp_out, a_indices, a_values, b));
+          SparseTensorDenseMatMulDispatch<T, Tsum, Tindices, ADJ_A, ADJ_B>(
+              ctx, temp_out, a_indices, a_values, b));
       out = temp_out.template cast<T>();
     } else {
       out.setZero();
@@ -356,8 +503,8 @@ struct SparseTensorDenseMatMulFunctor<CPUDevice, T, Tindices, ADJ_A, ADJ_B> {
       auto out_workaround =
           *reinterpret_cast<typename TTypes<Tsum>::Matrix*>(&out);
       TF_RETURN_IF_ERROR(
-          SparseTensorDenseMatMulImpl<T, Tsum, Tindices, ADJ_A, ADJ_B>(
-              out_workaround, a_indices, a_values, b));
+          SparseTensorDenseMatMulDispatch<T, Tsum, Tindices, ADJ_A, ADJ_B>(
+              ctx, out_workaround, a_indices, a_values, b));
     }
     return Status::OK();
   }
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <string>
 
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/errors.h"
@@ -44,18 +45,30 @@ class StringToHashBucketOp : public OpKernel {
                                             &output_tensor));
     auto output_flat = output_tensor->flat<int64>();
 
-    typedef decltype(input_flat.size()) Index;
-    for (Index i = 0; i < input_flat.size(); ++i) {
-      const uint64 input_hash = hash(input_flat(i));
-      const uint64 bucket_id = input_hash % num_buckets_;
-      // The number of buckets is always in the positive range of int64 so is
-      // the resulting bucket_id. Casting the bucket_id from uint64 to int64 is
-      // safe.
-      output_flat(i) = static_cast<int64>(bucket_id);
-    }
+    const uint64 num_buckets = num_buckets_;
+    auto compute = [&input_flat, &output_flat, num_buckets](Eigen::Index start,
+                                                            Eigen::Index end) {
+      for (Eigen::Index i = start; i < end; ++i) {
+        const uint64 input_hash = hash(input_flat(i));
+        const uint64 bucket_id = input_hash % num_buckets;
+        // The number of buckets is always in the positive range of int64 so
+        // is the resulting bucket_id. Casting the bucket_id from uint64 to
+        // int64 is safe.
+        output_flat(i) = static_cast<int64>(bucket_id);
+      }
+    };
+    // Large batches of strings are hashed in parallel.
+    const Eigen::TensorOpCost cost(/*bytes_loaded=*/sizeof(tstring),
+                                   /*bytes_stored=*/sizeof(int64),
+                                   kCostPerElement);
+    context->eigen_cpu_device().parallelFor(input_flat.size(), cost, compute);
   }
 
  private:
+  // Approximate number of cycles to hash a short string and compute its
+  // bucket.
+  static constexpr int kCostPerElement = 50;
+
   int64 num_buckets_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(StringToHashBucketOp);
@@ -13,6 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#define EIGEN_USE_THREADS
+
 #include "tensorflow/core/kernels/string_to_hash_bucket_op.h"
 
 #include "tensorflow/core/lib/hash/hash.h"
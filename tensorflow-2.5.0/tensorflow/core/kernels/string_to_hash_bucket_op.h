@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <string>
 
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/errors.h"
@@ -26,7 +27,7 @@ limitations under the License.
 
 namespace tensorflow {
 
-template <uint64 hash(const uint64 (&)[2], const string&)>
+template <uint64 hash(const uint64 (&)[2], StringPiece)>
 class StringToKeyedHashBucketOp : public OpKernel {
  public:
   explicit StringToKeyedHashBucketOp(OpKernelConstruction* ctx)
@@ -51,18 +52,27 @@ class StringToKeyedHashBucketOp : public OpKernel {
                                             &output_tensor));
     auto output_flat = output_tensor->flat<int64>();
 
-    typedef decltype(input_flat.size()) Index;
-    for (Index i = 0; i < input_flat.size(); ++i) {
-      const uint64 input_hash = hash(key_, input_flat(i));
-      const uint64 bucket_id = input_hash % num_buckets_;
-      // The number of buckets is always in the positive range of int64 so is
-      // the resulting bucket_id. Casting the bucket_id from uint64 to int64 is
-      // safe.
-      output_flat(i) = static_cast<int64>(bucket_id);
-    }
+    auto compute = [this, &input_flat, &output_flat](Eigen::Index start,
+                                                     Eigen::Index end) {
+      for (Eigen::Index i = start; i < end; ++i) {
+        const uint64 input_hash = hash(key_, input_flat(i));
+        const uint64 bucket_id = input_hash % num_buckets_;
+        // The number of buckets is always in the positive range of int64 so
+        // is the resulting bucket_id. Casting the bucket_id from uint64 to
+        // int64 is safe.
+        output_flat(i) = static_cast<int64>(bucket_id);
+      }
+    };
+    const Eigen::TensorOpCost cost(/*bytes_loaded=*/sizeof(tstring),
+                                   /*bytes_stored=*/sizeof(int64),
+                                   kCostPerElement);
+    context->eigen_cpu_device().parallelFor(input_flat.size(), cost, compute);
   }
 
  private:
+  // Approximate number of cycles of a keyed hash of a short string.
+  static constexpr int kCostPerElement = 200;
+
   int64 num_buckets_;
   uint64 key_[2];
 
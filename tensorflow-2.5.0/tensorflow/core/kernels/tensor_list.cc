@@ -25,6 +25,29 @@ TensorList::~TensorList() {
   if (tensors_) tensors_->Unref();
 }
 
+bool TensorList::GetStacked(Tensor* stacked) const {
+  const Tensor& slab = tensors_->stacked_;
+  const std::vector<Tensor>& elements = tensors();
+  if (!slab.IsInitialized() || elements.empty() || slab.dims() == 0 ||
+      slab.dim_size(0) != static_cast<int64>(elements.size())) {
+    return false;
+  }
+  TensorShape row_shape = slab.shape();
+  row_shape.RemoveDim(0);
+  const StringPiece slab_data = slab.tensor_data();
+  const size_t row_bytes = slab_data.size() / elements.size();
+  for (size_t i = 0; i < elements.size(); ++i) {
+    const Tensor& t = elements[i];
+    if (t.dtype() != slab.dtype() || t.shape() != row_shape ||
+        !t.SharesBufferWith(slab) ||
+        t.tensor_data().data() != slab_data.data() + i * row_bytes) {
+      return false;
+    }
+  }
+  *stacked = slab;
+  return true;
+}
+
 void TensorList::Encode(VariantTensorData* data) const {
   data->set_type_name(TypeName());
   std::vector<size_t> invalid_indices;
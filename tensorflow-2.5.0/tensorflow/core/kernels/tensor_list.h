@@ -134,9 +134,21 @@ class TensorList {
     out.max_num_elements = max_num_elements;
     // This performs a copy of the std::vector.
     out.tensors_->values_ = tensors_->values_;
+    out.tensors_->stacked_ = tensors_->stacked_;
     return out;
   }
 
+  // Records that the elements of this list were created as the rows of
+  // `stacked`, i.e. `tensors()[i]` aliases `stacked.Slice(i, i + 1)` with the
+  // leading dimension removed.
+  void set_stacked(const Tensor& stacked) { tensors_->stacked_ = stacked; }
+
+  // If the elements are still exactly the rows of the tensor passed to
+  // `set_stacked`, stores that tensor in `*stacked` and returns true, so that
+  // stacking the list does not need to copy. Returns false if the list has
+  // been modified since in a way that breaks the correspondence.
+  bool GetStacked(Tensor* stacked) const;
+
   // Is this TensorList the only one with a reference to the underlying
   // container?
   bool RefCountIsOne() const { return tensors_->RefCountIsOne(); }
@@ -145,6 +157,8 @@ class TensorList {
   class Tensors : public core::RefCounted {
    public:
     std::vector<Tensor> values_;
+    // Optional tensor whose rows back `values_`. See `set_stacked`.
+    Tensor stacked_;
   };
   Tensors* tensors_;
 };
@@ -20,8 +20,11 @@ limitations under the License.
 #include "tensorflow/core/kernels/topk_op.h"
 
 #include <algorithm>
+#include <cstring>
 #include <numeric>
+#include <utility>
 #include <vector>
+
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -29,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/gtl/top_n.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
@@ -99,6 +103,161 @@ class TopK : public OpKernel {
 
 namespace functor {
 
+// Rows at least this wide are split across threads with a radix select when
+// there are too few rows to keep every thread busy.
+constexpr int64 kRadixSelectMinCols = 1 << 16;
+
+// Maps values to unsigned keys with the same order, for the radix select.
+// -0.0 gets the key of 0.0 since the two compare equal, and NaNs, which are
+// unordered, have no key.
+template <typename T>
+struct RadixKey {
+  static constexpr bool kSupported = false;
+  typedef uint32 Type;
+  static bool Get(T value, uint32* key) { return false; }
+};
+
+template <>
+struct RadixKey<float> {
+  static constexpr bool kSupported = true;
+  typedef uint32 Type;
+  static bool Get(float value, uint32* key) {
+    uint32 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    if ((bits & 0x7fffffffu) > 0x7f800000u) return false;
+    if (value == 0) bits = 0;
+    *key = (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+    return true;
+  }
+};
+
+template <>
+struct RadixKey<double> {
+  static constexpr bool kSupported = true;
+  typedef uint64 Type;
+  static bool Get(double value, uint64* key) {
+    uint64 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    if ((bits & 0x7fffffffffffffffull) > 0x7ff0000000000000ull) return false;
+    if (value == 0) bits = 0;
+    *key = (bits & 0x8000000000000000ull) ? ~bits
+                                          : bits | 0x8000000000000000ull;
+    return true;
+  }
+};
+
+template <>
+struct RadixKey<int32> {
+  static constexpr bool kSupported = true;
+  typedef uint32 Type;
+  static bool Get(int32 value, uint32* key) {
+    *key = static_cast<uint32>(value) ^ 0x80000000u;
+    return true;
+  }
+};
+
+template <>
+struct RadixKey<int64> {
+  static constexpr bool kSupported = true;
+  typedef uint64 Type;
+  static bool Get(int64 value, uint64* key) {
+    *key = static_cast<uint64>(value) ^ 0x8000000000000000ull;
+    return true;
+  }
+};
+
+// Finds the top k of a single long row with all the worker threads, and writes
+// them sorted by decreasing value, ties broken by increasing index as in the
+// heap path. Returns false, without writing anything, if the row has NaNs.
+//
+// Each pass histograms the next digit of the keys sharing the prefix found so
+// far, until the digit at the k-th largest key holds few enough elements. The
+// keys at or above that prefix are then gathered and sorted.
+template <typename T>
+bool RadixSelectTopK(const DeviceBase::CpuWorkerThreads& worker_threads,
+                     const T* input_data, const int64 num_cols, const int k,
+                     int32* indices, T* values) {
+  typedef typename RadixKey<T>::Type Key;
+  constexpr int kKeyBits = sizeof(Key) * 8;
+  constexpr int kDigitBits = 11;
+  const int64 cost_per_col = 4 * Eigen::TensorOpCost::AddCost<T>();
+
+  mutex mu;
+  bool has_nan = false;
+  Key prefix = 0;
+  int prefix_bits = 0;
+  int64 remaining = k;
+  while (prefix_bits < kKeyBits) {
+    const int digit_bits = std::min(kDigitBits, kKeyBits - prefix_bits);
+    const int shift = kKeyBits - prefix_bits - digit_bits;
+    const Key digit_mask = (Key(1) << digit_bits) - 1;
+    std::vector<int64> histogram(1 << digit_bits, 0);
+    auto count_digits = [&](int64 start, int64 limit) {
+      std::vector<int64> local_histogram(1 << digit_bits, 0);
+      for (int64 c = start; c < limit; ++c) {
+        Key key;
+        if (!RadixKey<T>::Get(input_data[c], &key)) {
+          mutex_lock l(mu);
+          has_nan = true;
+          return;
+        }
+        if (prefix_bits > 0 && (key >> (kKeyBits - prefix_bits)) != prefix) {
+          continue;
+        }
+        ++local_histogram[(key >> shift) & digit_mask];
+      }
+      mutex_lock l(mu);
+      for (int i = 0; i < static_cast<int>(histogram.size()); ++i) {
+        histogram[i] += local_histogram[i];
+      }
+    };
+    Shard(worker_threads.num_threads, worker_threads.workers, num_cols,
+          cost_per_col, count_digits);
+    if (has_nan) return false;
+
+    int digit = histogram.size() - 1;
+    int64 above = 0;
+    while (digit > 0 && above + histogram[digit] < remaining) {
+      above += histogram[digit--];
+    }
+    remaining -= above;
+    prefix = (prefix << digit_bits) | digit;
+    prefix_bits += digit_bits;
+    if (histogram[digit] <= 4 * k) break;
+  }
+
+  const Key lower_bound = prefix << (kKeyBits - prefix_bits);
+  std::vector<std::pair<Key, int32>> candidates;
+  auto gather = [&](int64 start, int64 limit) {
+    std::vector<std::pair<Key, int32>> local_candidates;
+    for (int64 c = start; c < limit; ++c) {
+      Key key;
+      RadixKey<T>::Get(input_data[c], &key);
+      if (key >= lower_bound) local_candidates.emplace_back(key, c);
+    }
+    mutex_lock l(mu);
+    candidates.insert(candidates.end(), local_candidates.begin(),
+                      local_candidates.end());
+  };
+  Shard(worker_threads.num_threads, worker_threads.workers, num_cols,
+        cost_per_col, gather);
+
+  const auto comp = [](const std::pair<Key, int32>& a,
+                       const std::pair<Key, int32>& b) {
+    return a.first > b.first || (a.first == b.first && a.second < b.second);
+  };
+  if (static_cast<int64>(candidates.size()) > k) {
+    std::nth_element(candidates.begin(), candidates.begin() + k,
+                     candidates.end(), comp);
+  }
+  std::sort(candidates.begin(), candidates.begin() + k, comp);
+  for (int i = 0; i < k; ++i) {
+    indices[i] = candidates[i].second;
+    values[i] = input_data[candidates[i].second];
+  }
+  return true;
+}
+
 template <typename T>
 struct TopKFunctor<CPUDevice, T> {
   static EIGEN_ALWAYS_INLINE Status
@@ -222,6 +381,16 @@ struct TopKFunctor<CPUDevice, T> {
                                  ? kint64max
                                  : static_cast<int64>(total_cost);
     auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+    if (RadixKey<T>::kSupported && num_cols >= kRadixSelectMinCols &&
+        k < num_cols && num_rows < worker_threads.num_threads) {
+      for (int64 b = 0; b < num_rows; ++b) {
+        if (!RadixSelectTopK(worker_threads, &input(b, 0), num_cols, k,
+                             &indices(b, 0), &values(b, 0))) {
+          SortIndices(b, b + 1);
+        }
+      }
+      return Status::OK();
+    }
     Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
           final_cost, SortIndices);
 
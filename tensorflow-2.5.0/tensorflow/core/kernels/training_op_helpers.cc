@@ -15,10 +15,31 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/training_op_helpers.h"
 
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/ptr_util.h"
 
 namespace tensorflow {
 
+SparseApplyLocking GetSparseApplyLocking() {
+  static const SparseApplyLocking locking = [] {
+    string mode;
+    TF_CHECK_OK(
+        ReadStringFromEnvVar("TF_SPARSE_APPLY_LOCKING", "variable", &mode));
+    if (mode == "row") return SparseApplyLocking::kRow;
+    if (mode != "variable") {
+      LOG(WARNING) << "Unknown TF_SPARSE_APPLY_LOCKING value: " << mode
+                   << ". Locking whole variables.";
+    }
+    return SparseApplyLocking::kVariable;
+  }();
+  return locking;
+}
+
+SparseApplyRowLocks* SparseApplyRowLocks::Global() {
+  static SparseApplyRowLocks* row_locks = new SparseApplyRowLocks;
+  return row_locks;
+}
+
 
 void MaybeForwardRefInputToRefOutput(OpKernelContext* ctx, int input,
                                      int output) {
@@ -22,9 +22,48 @@ limitations under the License.
 #include "tensorflow/core/kernels/dense_update_functor.h"
 #include "tensorflow/core/kernels/variable_ops.h"
 #include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/platform/mutex.h"
 
 namespace tensorflow {
 
+// How the sparse apply kernels protect a variable when use_locking is true,
+// selected by the TF_SPARSE_APPLY_LOCKING environment variable.
+//
+// "variable" (the default): the variable's mutex is held exclusively for the
+//   whole update. A concurrent read, including a checkpoint save, sees either
+//   none or all of an update.
+// "row": on CPU, the mutex of a resource or ref variable is only held shared,
+//   which still excludes dense updates, and each updated row of the variable
+//   and its slots is protected by a striped row lock, so updates touching
+//   different rows run concurrently. Updates to the same row are still
+//   serialized, but a concurrent read doesn't take row locks and can see an
+//   update partially applied, or a row in the middle of one.
+//
+// With use_locking false, updates are Hogwild: nothing is serialized and
+// concurrent updates to the same row race.
+enum class SparseApplyLocking { kVariable, kRow };
+SparseApplyLocking GetSparseApplyLocking();
+
+// A fixed set of mutexes shared by the rows of all variables, for sparse
+// updates that lock rows instead of whole variables.
+class SparseApplyRowLocks {
+ public:
+  static SparseApplyRowLocks* Global();
+
+  // Returns the mutex protecting row 'row' of the variable whose buffer
+  // starts at 'base'.
+  mutex* ForRow(const void* base, int64 row) {
+    const uint64 hash =
+        Hash64Combine(reinterpret_cast<uintptr_t>(base), row);
+    return &stripes_[hash % kNumStripes];
+  }
+
+ private:
+  static constexpr int kNumStripes = 4096;
+  mutex stripes_[kNumStripes];
+};
+
 // Must be called before performing a sparse operation on a variable. Ensures
 // that no concurrent dense operations can happen while holding the variable's
 // lock.
@@ -33,6 +72,10 @@ Status EnsureSparseVariableAccess(OpKernelContext* ctx, Var* var) {
   if (var->copy_on_read_mode.load()) {
     return Status::OK();
   }
+  if (var->lock_free_reads()) {
+    return errors::FailedPrecondition(
+        "Sparse updates are not supported on variables with lock-free reads.");
+  }
   mutex_lock ml(*var->mu());
   // Once copy-on-read mode is True the refcount is guaranteed to be 1. This can
   // also happen if there are no concurrent reads of the variable and
@@ -86,6 +129,13 @@ struct VariableInputLockHolder {
         shared_locks_(std::move(other.shared_locks_)) {}
 
   ~VariableInputLockHolder() {
+    // Dense updates are done by now; make them visible to lock-free readers
+    // while the exclusive locks are still held.
+    if (locks_ != nullptr && !locks_->empty()) {
+      for (Var* var : vars_) {
+        var->PublishSnapshot();
+      }
+    }
     // Release the locks before unreffing the Vars, because each lock
     // is potentially borrowed from a Var in vars_.
     locks_.reset();
@@ -134,13 +184,15 @@ mutex* GetTrainingVariableMutex(OpKernelContext* ctx, int input, bool sparse,
 // variable gets switched to copy-on-read mode before trying to acquire the
 // locks. If do_lock is false, returns immediately for reference variables. For
 // resource variables in copy-on-read-mode it will grab a shared lock if do_lock
-// is false, exclusive lock otherwise.  Note that this silently doesn't lock
-// mutexes for invalid variable references; in all usages this is followed by
-// GetInputTensor which will signal a failure.
+// is false, exclusive lock otherwise. If lock_refs_shared is true, reference
+// variables are locked shared as well, like resource variables in
+// copy-on-read mode, even though do_lock is false. Note that this silently
+// doesn't lock mutexes for invalid variable references; in all usages this is
+// followed by GetInputTensor which will signal a failure.
 template <typename Device, typename T>
 VariableInputLockHolder MaybeLockVariableInputMutexesInOrder(
     OpKernelContext* ctx, bool do_lock, bool sparse,
-    const std::vector<int>& input_ids) {
+    const std::vector<int>& input_ids, bool lock_refs_shared = false) {
   bool any_resource = false;
   for (auto i : input_ids) {
     if (ctx->input_dtype(i) == DT_RESOURCE) {
@@ -148,7 +200,7 @@ VariableInputLockHolder MaybeLockVariableInputMutexesInOrder(
       break;
     }
   }
-  if (!do_lock && !any_resource) {
+  if (!do_lock && !any_resource && !lock_refs_shared) {
     return VariableInputLockHolder({}, {}, {});
   }
   std::vector<Var*> vars;
@@ -40,6 +40,35 @@ inline T sgn(const T x) {
   T one(1);
   return (x == zero ? zero : (x < zero ? -one : one));
 }
+
+// Holds the lock of a row of a sparse update if row_locks is not null.
+class MaybeLockRow {
+ public:
+  MaybeLockRow(SparseApplyRowLocks* row_locks, const void* base, int64 row)
+      TF_NO_THREAD_SAFETY_ANALYSIS
+      : mu_(row_locks == nullptr ? nullptr : row_locks->ForRow(base, row)) {
+    if (mu_ != nullptr) mu_->lock();
+  }
+  ~MaybeLockRow() TF_NO_THREAD_SAFETY_ANALYSIS {
+    if (mu_ != nullptr) mu_->unlock();
+  }
+
+ private:
+  mutex* const mu_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(MaybeLockRow);
+};
+
+// Returns the row locks a sparse update takes instead of locking its
+// variables, or nullptr if it locks its variables (see SparseApplyLocking).
+template <typename Device>
+SparseApplyRowLocks* SparseApplyRowLocksFor(bool use_locking) {
+  if (!use_locking || !std::is_same<Device, CPUDevice>::value ||
+      GetSparseApplyLocking() != SparseApplyLocking::kRow) {
+    return nullptr;
+  }
+  return SparseApplyRowLocks::Global();
+}
 }  // namespace
 
 namespace functor {
@@ -170,7 +199,7 @@ struct SparseApplyAdagrad<CPUDevice, T, Tindex, has_epsilon> {
                     typename TTypes<T>::ConstScalar epsilon,
                     typename TTypes<T>::ConstMatrix grad,
                     typename TTypes<Tindex>::ConstVec indices, int64 inner_dim,
-                    bool update_slots) {
+                    bool update_slots, SparseApplyRowLocks* row_locks) {
     const Tindex N = static_cast<Tindex>(indices.dimension(0));
     if (N == 0) return Status::OK();
     const Tindex first_dim_size = static_cast<Tindex>(var.dimension(0));
@@ -197,6 +226,7 @@ struct SparseApplyAdagrad<CPUDevice, T, Tindex, has_epsilon> {
           auto a = accum.template chip<0>(index);
           auto g = grad.template chip<0>(i);
           auto v = var.template chip<0>(index);
+          MaybeLockRow row_lock(row_locks, var.data(), index);
           if (update_slots) {
             a += g.square();
           }
@@ -224,6 +254,7 @@ struct SparseApplyAdagrad<CPUDevice, T, Tindex, has_epsilon> {
           const Tindex index = internal::SubtleMustCopy(indices(i));
           T& a = accum(index);
           const T& g = grad(i);
+          MaybeLockRow row_lock(row_locks, var.data(), index);
           if (update_slots) {
             a += g * g;
           }
@@ -597,7 +628,8 @@ struct SparseApplyFtrl<CPUDevice, T, Tindex, has_l2_shrinkage> {
                     typename TTypes<T>::ConstScalar lr_power,
                     typename TTypes<T>::ConstMatrix grad_flat,
                     typename TTypes<Tindex>::ConstVec indices_vec,
-                    int64 inner_dim, bool multiply_linear_by_lr) {
+                    int64 inner_dim, bool multiply_linear_by_lr,
+                    SparseApplyRowLocks* row_locks) {
     const Tindex N = static_cast<Tindex>(indices_vec.dimension(0));
     if (N > 0) {
       T lr_scalar = lr();
@@ -608,17 +640,22 @@ struct SparseApplyFtrl<CPUDevice, T, Tindex, has_l2_shrinkage> {
         l2_shrinkage_scalar = l2_shrinkage();
       }
       T lr_power_scalar = lr_power();
-      if (inner_dim > 1) {
-        const Tindex first_dim_size =
-            static_cast<Tindex>(var_flat.dimension(0));
+      const Tindex first_dim_size =
+          inner_dim > 1 ? static_cast<Tindex>(var_flat.dimension(0))
+                        : static_cast<Tindex>(accum_flat.size());
+      for (Tindex i = 0; i < N; i++) {
+        const Tindex index = internal::SubtleMustCopy(indices_vec(i));
+        if (!FastBoundsCheck(index, first_dim_size)) {
+          return errors::InvalidArgument(
+              strings::StrCat("Index ", index, " at offset ", i,
+                              " in indices is out of range"));
+        }
+      }
 
-        for (Tindex i = 0; i < N; i++) {
-          const Tindex index = internal::SubtleMustCopy(indices_vec(i));
-          if (!FastBoundsCheck(index, first_dim_size)) {
-            return errors::InvalidArgument(
-                strings::StrCat("Index ", index, " at offset ", i,
-                                " in indices is out of range"));
-          }
+      const auto update_row = [&](Tindex i) {
+        const Tindex index = internal::SubtleMustCopy(indices_vec(i));
+        MaybeLockRow row_lock(row_locks, var_flat.data(), index);
+        if (inner_dim > 1) {
           auto accum = accum_flat.template chip<0>(index);
           auto linear = linear_flat.template chip<0>(index);
           auto grad = grad_flat.template chip<0>(i);
@@ -642,17 +679,7 @@ struct SparseApplyFtrl<CPUDevice, T, Tindex, has_l2_shrinkage> {
                         /*lr_power_scalar=*/lr_power_scalar,
                         /*lr_scalar=*/lr_scalar);
           }
-        }
-      } else {
-        const Tindex first_dim_size = accum_flat.size();
-
-        for (Tindex i = 0; i < N; i++) {
-          const Tindex index = internal::SubtleMustCopy(indices_vec(i));
-          if (!FastBoundsCheck(index, first_dim_size)) {
-            return errors::InvalidArgument(
-                strings::StrCat("Index ", index, " at offset ", i,
-                                " in indices is out of range"));
-          }
+        } else {
           T& a = accum_flat(index);
           T& l = linear_flat(index);
           T& v = var_flat(index);
@@ -677,6 +704,24 @@ struct SparseApplyFtrl<CPUDevice, T, Tindex, has_l2_shrinkage> {
           a = updated_a;
           l = updated_l;
         }
+      };
+
+      if (row_locks == nullptr) {
+        // Duplicate indices would race if updated in parallel.
+        for (Tindex i = 0; i < N; i++) {
+          update_row(i);
+        }
+      } else {
+        const int in_bytes = inner_dim * sizeof(T) * 4;
+        const int out_bytes = inner_dim * sizeof(T) * 3;
+        const int cycles = inner_dim * (Eigen::TensorOpCost::AddCost<T>() * 8 +
+                                        Eigen::TensorOpCost::MulCost<T>() * 8);
+        const Eigen::TensorOpCost cost(in_bytes, out_bytes, cycles);
+        d.parallelFor(N, cost, [&](Tindex start_idx, Tindex end_idx) {
+          for (Tindex i = start_idx; i < end_idx; ++i) {
+            update_row(i);
+          }
+        });
       }
     }
     return Status::OK();
@@ -1521,6 +1566,122 @@ REGISTER_KERNELS(double, int32);
 REGISTER_KERNELS(double, int64);
 #undef REGISTER_KERNELS
 
+// Applies the gradient of ResourceSparseSegmentCombine: grad holds one row per
+// segment, and every row of var gathered into a segment is updated with that
+// row scaled by the combiner weight of the segment.
+template <typename T, typename Tindex, typename Tsegment>
+class SparseSegmentApplyGradientDescentOp : public OpKernel {
+ public:
+  explicit SparseSegmentApplyGradientDescentOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("combiner", &combiner_));
+  }
+
+  void Compute(OpKernelContext* ctx) override TF_NO_THREAD_SAFETY_ANALYSIS {
+    const bool sparse = true;
+    auto locks = MaybeLockVariableInputMutexesInOrder<CPUDevice, T>(
+        ctx, use_exclusive_lock_, sparse, {0});
+    Tensor var;
+    OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<CPUDevice, T>(
+                            ctx, 0, use_exclusive_lock_, sparse, &var));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVectorOrHigher(var.shape()),
+                errors::InvalidArgument("var must be at least 1 dimensional"));
+
+    const Tensor& alpha = ctx->input(1);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(alpha.shape()),
+                errors::InvalidArgument("alpha is not a scalar: ",
+                                        alpha.shape().DebugString()));
+    const Tensor& grad = ctx->input(2);
+    const Tensor& indices = ctx->input(3);
+    const Tensor& segment_ids = ctx->input(4);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVector(indices.shape()),
+                errors::InvalidArgument("indices must be one-dimensional"));
+    OP_REQUIRES(ctx, indices.shape().IsSameSize(segment_ids.shape()),
+                errors::InvalidArgument(
+                    "segment_ids and indices must have the same shape: ",
+                    segment_ids.shape().DebugString(), " vs ",
+                    indices.shape().DebugString()));
+    OP_REQUIRES(ctx, var.dims() == grad.dims(),
+                errors::InvalidArgument("var and grad must have the same rank"));
+    for (int d = 1; d < var.dims(); d++) {
+      OP_REQUIRES(ctx, var.dim_size(d) == grad.dim_size(d),
+                  errors::InvalidArgument(strings::StrCat(
+                      "var and grad must match in dimension ", d)));
+    }
+
+    const int64 N = indices.dim_size(0);
+    const int64 num_segments = grad.dim_size(0);
+    if (N == 0 || var.NumElements() == 0) {
+      MaybeForwardRefInputToRefOutput(ctx, 0, 0);
+      return;
+    }
+
+    auto indices_vec = indices.vec<Tindex>();
+    auto segment_ids_vec = segment_ids.vec<Tsegment>();
+    std::vector<int64> counts(num_segments, 0);
+    for (int64 i = 0; i < N; i++) {
+      const Tsegment segment = internal::SubtleMustCopy(segment_ids_vec(i));
+      OP_REQUIRES(ctx, FastBoundsCheck(segment, num_segments),
+                  errors::InvalidArgument(
+                      strings::StrCat("Segment id ", segment, " at offset ", i,
+                                      " in segment_ids is out of range")));
+      ++counts[segment];
+    }
+
+    // The update of each segment is alpha times its combiner weight.
+    const T alpha_scalar = alpha.scalar<T>()();
+    std::vector<T> scales(num_segments, alpha_scalar);
+    if (combiner_ != "sum") {
+      for (int64 s = 0; s < num_segments; s++) {
+        if (counts[s] <= 1) continue;
+        scales[s] /= combiner_ == "mean"
+                         ? static_cast<T>(counts[s])
+                         : std::sqrt(static_cast<T>(counts[s]));
+      }
+    }
+
+    const Tindex first_dim_size = var.dim_size(0);
+    auto var_flat = var.flat_outer_dims<T>();
+    auto grad_flat = grad.flat_outer_dims<T>();
+    for (int64 i = 0; i < N; i++) {
+      const Tindex index = internal::SubtleMustCopy(indices_vec(i));
+      OP_REQUIRES(ctx, FastBoundsCheck(index, first_dim_size),
+                  errors::InvalidArgument(
+                      strings::StrCat("Index ", index, " at offset ", i,
+                                      " in indices is out of range")));
+      const Tsegment segment = internal::SubtleMustCopy(segment_ids_vec(i));
+      var_flat.template chip<0>(index) -=
+          grad_flat.template chip<0>(segment) * scales[segment];
+    }
+
+    MaybeForwardRefInputToRefOutput(ctx, 0, 0);
+  }
+
+ private:
+  bool use_exclusive_lock_;
+  string combiner_;
+};
+
+#define REGISTER_KERNELS(T, Tindices, Tsegmentids)                        \
+  REGISTER_KERNEL_BUILDER(                                                \
+      Name("ResourceSparseSegmentApplyGradientDescent")                   \
+          .Device(DEVICE_CPU)                                             \
+          .TypeConstraint<T>("T")                                         \
+          .TypeConstraint<Tindices>("Tidx")                               \
+          .TypeConstraint<Tsegmentids>("Tsegmentids"),                    \
+      SparseSegmentApplyGradientDescentOp<T, Tindices, Tsegmentids>);
+
+REGISTER_KERNELS(float, int32, int32);
+REGISTER_KERNELS(float, int32, int64);
+REGISTER_KERNELS(float, int64, int32);
+REGISTER_KERNELS(float, int64, int64);
+REGISTER_KERNELS(double, int32, int32);
+REGISTER_KERNELS(double, int32, int64);
+REGISTER_KERNELS(double, int64, int32);
+REGISTER_KERNELS(double, int64, int64);
+#undef REGISTER_KERNELS
+
 template <typename Device, typename T>
 class ApplyAdagradOp : public OpKernel {
  public:
@@ -1840,8 +2001,12 @@ class SparseApplyAdagradOp : public OpKernel {
 
   void Compute(OpKernelContext* ctx) override TF_NO_THREAD_SAFETY_ANALYSIS {
     const bool sparse = true;
+    SparseApplyRowLocks* row_locks =
+        SparseApplyRowLocksFor<Device>(use_exclusive_lock_);
+    const bool lock_variables = use_exclusive_lock_ && row_locks == nullptr;
     auto locks = MaybeLockVariableInputMutexesInOrder<Device, T>(
-        ctx, use_exclusive_lock_, sparse, {0, 1});
+        ctx, lock_variables, sparse, {0, 1},
+        /*lock_refs_shared=*/row_locks != nullptr);
     Tensor var;
     OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<Device, T>(
                             ctx, 0, use_exclusive_lock_, sparse, &var));
@@ -1897,7 +2062,7 @@ class SparseApplyAdagradOp : public OpKernel {
                  device, var.flat_outer_dims<T>(), accum.flat_outer_dims<T>(),
                  // Note: Passing lr as a placeholder for unused epsilon.
                  lr.scalar<T>(), lr.scalar<T>(), grad.flat_outer_dims<T>(),
-                 indices.vec<Tindex>(), inner_dim, update_slots_));
+                 indices.vec<Tindex>(), inner_dim, update_slots_, row_locks));
 
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
@@ -1970,8 +2135,12 @@ class SparseApplyAdagradV2Op : public OpKernel {
 
   void Compute(OpKernelContext* ctx) override TF_NO_THREAD_SAFETY_ANALYSIS {
     const bool sparse = true;
+    SparseApplyRowLocks* row_locks =
+        SparseApplyRowLocksFor<Device>(use_exclusive_lock_);
+    const bool lock_variables = use_exclusive_lock_ && row_locks == nullptr;
     auto locks = MaybeLockVariableInputMutexesInOrder<Device, T>(
-        ctx, use_exclusive_lock_, sparse, {0, 1});
+        ctx, lock_variables, sparse, {0, 1},
+        /*lock_refs_shared=*/row_locks != nullptr);
     Tensor var;
     OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<Device, T>(
                             ctx, 0, use_exclusive_lock_, sparse, &var));
@@ -2030,7 +2199,7 @@ class SparseApplyAdagradV2Op : public OpKernel {
                                          /*has_epsilon = */ true>()(
                  device, var.flat_outer_dims<T>(), accum.flat_outer_dims<T>(),
                  lr.scalar<T>(), epsilon.scalar<T>(), grad.flat_outer_dims<T>(),
-                 indices.vec<Tindex>(), inner_dim, update_slots_));
+                 indices.vec<Tindex>(), inner_dim, update_slots_, row_locks));
 
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
@@ -2758,8 +2927,12 @@ class SparseApplyFtrlOp : public OpKernel {
 
   void Compute(OpKernelContext* ctx) override TF_NO_THREAD_SAFETY_ANALYSIS {
     const bool sparse = true;
+    SparseApplyRowLocks* row_locks =
+        SparseApplyRowLocksFor<Device>(use_exclusive_lock_);
+    const bool lock_variables = use_exclusive_lock_ && row_locks == nullptr;
     auto locks = MaybeLockVariableInputMutexesInOrder<Device, T>(
-        ctx, use_exclusive_lock_, sparse, {0, 1, 2});
+        ctx, lock_variables, sparse, {0, 1, 2},
+        /*lock_refs_shared=*/row_locks != nullptr);
     Tensor var;
     OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<Device, T>(
                             ctx, 0, use_exclusive_lock_, sparse, &var));
@@ -2880,7 +3053,7 @@ class SparseApplyFtrlOp : public OpKernel {
                  // (it will not be used).
                  has_l2_shrinkage ? l2_shrinkage->scalar<T>() : l2.scalar<T>(),
                  lr_power.scalar<T>(), grad.flat_outer_dims<T>(), indices_vec,
-                 inner_dim, multiply_linear_by_lr_));
+                 inner_dim, multiply_linear_by_lr_, row_locks));
 
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
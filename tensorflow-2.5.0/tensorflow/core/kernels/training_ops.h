@@ -22,6 +22,9 @@ limitations under the License.
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
+
+class SparseApplyRowLocks;
+
 namespace functor {
 
 // Each training algorithm has a ApplyXYZ functor struct declared in
@@ -94,14 +97,15 @@ struct ApplyAdagradDA {
 
 template <typename Device, typename T, typename Tindex, bool has_epsilon>
 struct SparseApplyAdagrad {
-  // Note that epsilon is ignored if has_epsilon is false.
+  // Note that epsilon is ignored if has_epsilon is false. If row_locks is not
+  // null, each updated row is locked while it is updated (CPU only).
   Status operator()(const Device& d, typename TTypes<T>::Matrix var,
                     typename TTypes<T>::Matrix accum,
                     typename TTypes<T>::ConstScalar lr,
                     typename TTypes<T>::ConstScalar epsilon,
                     typename TTypes<T>::ConstMatrix grad,
                     typename TTypes<Tindex>::ConstVec indices, int64 inner_dim,
-                    bool update_slots);
+                    bool update_slots, SparseApplyRowLocks* row_locks);
 };
 
 template <typename Device, typename T>
@@ -177,6 +181,8 @@ struct ApplyFtrlV2MultiplyLinearByLr {
 
 template <typename Device, typename T, typename Tindex, bool has_l2_shrinkage>
 struct SparseApplyFtrl {
+  // If row_locks is not null, each updated row is locked while it is updated
+  // (CPU only).
   Status operator()(const Device& d, typename TTypes<T>::Matrix var_flat,
                     typename TTypes<T>::Matrix accum_flat,
                     typename TTypes<T>::Matrix linear_flat,
@@ -187,7 +193,8 @@ struct SparseApplyFtrl {
                     typename TTypes<T>::ConstScalar lr_power,
                     typename TTypes<T>::ConstMatrix grad_flat,
                     typename TTypes<Tindex>::ConstVec indices_vec,
-                    int64 inner_dim, bool multiply_linear_by_lr);
+                    int64 inner_dim, bool multiply_linear_by_lr,
+                    SparseApplyRowLocks* row_locks);
 };
 
 template <typename Device, typename T>
@@ -435,7 +435,7 @@ struct SparseApplyAdagrad<GPUDevice, T, Tindex, has_epsilon> {
                     typename TTypes<T>::ConstScalar epsilon,
                     typename TTypes<T>::ConstMatrix grad,
                     typename TTypes<Tindex>::ConstVec indices, int64 inner_dim,
-                    bool update_slots) {
+                    bool update_slots, SparseApplyRowLocks* row_locks) {
     const Tindex first_dim_size = var.dimension(0);
     const Tindex grad_size = grad.size();
     const Tindex indices_size = indices.size();
@@ -706,7 +706,8 @@ struct SparseApplyFtrl<GPUDevice, T, Tindex, has_l2_shrinkage> {
                     typename TTypes<T>::ConstScalar lr_power,
                     typename TTypes<T>::ConstMatrix grad,
                     typename TTypes<Tindex>::ConstVec indices, int64 inner_dim,
-                    bool multiply_linear_by_lr) {
+                    bool multiply_linear_by_lr,
+                    SparseApplyRowLocks* row_locks) {
     const Tindex first_dim_size = var.dimension(0);
     const Tindex grad_size = grad.size();
     const Tindex indices_size = indices.size();
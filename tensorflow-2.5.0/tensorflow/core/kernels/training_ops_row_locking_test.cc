@@ -0,0 +1,213 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Tests of the sparse apply kernels with TF_SPARSE_APPLY_LOCKING=row. The
+// locking mode is read once per process, so these tests live in their own
+// binary and set it before running any kernel.
+
+#include <stdlib.h>
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/kernels/training_op_helpers.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int kNumRows = 64;
+constexpr int kInnerDim = 8;
+
+// Indices that visit every row several times, in an interleaved order, so
+// that the updates of one row are spread over the shards of the kernel.
+std::vector<int32> DuplicatedIndices(int num_updates_per_row) {
+  std::vector<int32> indices;
+  for (int i = 0; i < num_updates_per_row; ++i) {
+    for (int row = 0; row < kNumRows; ++row) {
+      indices.push_back((row * 7 + i) % kNumRows);
+    }
+  }
+  return indices;
+}
+
+// The gradient of an update depends only on its row, so the result doesn't
+// depend on the order in which the updates of a row are applied.
+std::vector<float> GradientsFor(const std::vector<int32>& indices) {
+  std::vector<float> grad;
+  for (int32 index : indices) {
+    for (int j = 0; j < kInnerDim; ++j) {
+      grad.push_back(0.01f * (index + 1) - 0.005f * j);
+    }
+  }
+  return grad;
+}
+
+class SparseApplyRowLockingTest : public OpsTestBase {
+ protected:
+  void SetUp() override {
+    setenv("TF_SPARSE_APPLY_LOCKING", "row", /*overwrite=*/1);
+    ASSERT_EQ(GetSparseApplyLocking(), SparseApplyLocking::kRow);
+  }
+};
+
+TEST_F(SparseApplyRowLockingTest, AdagradDuplicateIndices) {
+  TF_ASSERT_OK(NodeDefBuilder("op", "SparseApplyAdagrad")
+                   .Input(FakeInput(DT_FLOAT_REF))
+                   .Input(FakeInput(DT_FLOAT_REF))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_INT32))
+                   .Attr("use_locking", true)
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+
+  constexpr int kNumUpdatesPerRow = 64;
+  constexpr float kLr = 0.1f;
+  const std::vector<int32> indices = DuplicatedIndices(kNumUpdatesPerRow);
+  const std::vector<float> grad = GradientsFor(indices);
+  const int num_indices = indices.size();
+  AddInput<float>(TensorShape({kNumRows, kInnerDim}),
+                  [](int i) { return 1.0f; });
+  AddInput<float>(TensorShape({kNumRows, kInnerDim}),
+                  [](int i) { return 0.1f; });
+  AddInputFromArray<float>(TensorShape({}), {kLr});
+  AddInputFromArray<float>(TensorShape({num_indices, kInnerDim}), grad);
+  AddInputFromArray<int32>(TensorShape({num_indices}), indices);
+  TF_ASSERT_OK(RunOpKernel());
+
+  // Applies the updates of each row one after the other.
+  Tensor expected_var(allocator(), DT_FLOAT,
+                      TensorShape({kNumRows, kInnerDim}));
+  Tensor expected_accum(allocator(), DT_FLOAT,
+                        TensorShape({kNumRows, kInnerDim}));
+  auto var = expected_var.matrix<float>();
+  auto accum = expected_accum.matrix<float>();
+  for (int row = 0; row < kNumRows; ++row) {
+    for (int j = 0; j < kInnerDim; ++j) {
+      const float g = 0.01f * (row + 1) - 0.005f * j;
+      float v = 1.0f;
+      float a = 0.1f;
+      for (int i = 0; i < kNumUpdatesPerRow; ++i) {
+        a += g * g;
+        v -= kLr * g / std::sqrt(a);
+      }
+      var(row, j) = v;
+      accum(row, j) = a;
+    }
+  }
+  test::ExpectTensorNear<float>(expected_var, *mutable_input(0).tensor, 1e-5);
+  test::ExpectTensorNear<float>(expected_accum, *mutable_input(1).tensor,
+                                1e-5);
+}
+
+TEST_F(SparseApplyRowLockingTest, ParallelFtrlMatchesSerial) {
+  constexpr int kNumUpdatesPerRow = 16;
+  const std::vector<int32> indices = DuplicatedIndices(kNumUpdatesPerRow);
+  const std::vector<float> grad = GradientsFor(indices);
+  const int num_indices = indices.size();
+
+  // With use_locking false the FTRL kernel updates one index after the other,
+  // with use_locking true it updates rows in parallel under row locks.
+  std::vector<Tensor> results[2];
+  for (bool use_locking : {false, true}) {
+    TF_ASSERT_OK(NodeDefBuilder("op", "SparseApplyFtrl")
+                     .Input(FakeInput(DT_FLOAT_REF))
+                     .Input(FakeInput(DT_FLOAT_REF))
+                     .Input(FakeInput(DT_FLOAT_REF))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_INT32))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Attr("use_locking", use_locking)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    inputs_.clear();
+    AddInput<float>(TensorShape({kNumRows, kInnerDim}),
+                    [](int i) { return 0.01f * (i % 13); });
+    AddInput<float>(TensorShape({kNumRows, kInnerDim}),
+                    [](int i) { return 0.1f; });
+    AddInput<float>(TensorShape({kNumRows, kInnerDim}),
+                    [](int i) { return 0.0f; });
+    AddInputFromArray<float>(TensorShape({num_indices, kInnerDim}), grad);
+    AddInputFromArray<int32>(TensorShape({num_indices}), indices);
+    AddInputFromArray<float>(TensorShape({}), {0.1f});
+    AddInputFromArray<float>(TensorShape({}), {0.001f});
+    AddInputFromArray<float>(TensorShape({}), {0.01f});
+    AddInputFromArray<float>(TensorShape({}), {-0.5f});
+    TF_ASSERT_OK(RunOpKernel());
+    for (int i = 0; i < 3; ++i) {
+      results[use_locking].push_back(*mutable_input(i).tensor);
+    }
+  }
+
+  for (int i = 0; i < 3; ++i) {
+    test::ExpectTensorEqual<float>(results[false][i], results[true][i]);
+  }
+}
+
+TEST_F(SparseApplyRowLockingTest, WaitsForDenseUpdateOfRefVariable) {
+  TF_ASSERT_OK(NodeDefBuilder("op", "SparseApplyAdagrad")
+                   .Input(FakeInput(DT_FLOAT_REF))
+                   .Input(FakeInput(DT_FLOAT_REF))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_INT32))
+                   .Attr("use_locking", true)
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  AddInput<float>(TensorShape({kNumRows, kInnerDim}),
+                  [](int i) { return 1.0f; });
+  AddInput<float>(TensorShape({kNumRows, kInnerDim}),
+                  [](int i) { return 0.1f; });
+  AddInputFromArray<float>(TensorShape({}), {0.1f});
+  AddInputFromArray<float>(TensorShape({1, kInnerDim}),
+                           std::vector<float>(kInnerDim, 1.0f));
+  AddInputFromArray<int32>(TensorShape({1}), {0});
+
+  // A dense update of a ref variable holds its mutex exclusively, which keeps
+  // the row-locked update waiting even though it only takes the mutex shared.
+  Notification done;
+  std::unique_ptr<Thread> thread;
+  {
+    mutex_lock dense_update(lock_for_refs_);
+    thread.reset(Env::Default()->StartThread(
+        ThreadOptions(), "sparse_apply", [this, &done] {
+          TF_EXPECT_OK(RunOpKernel());
+          done.Notify();
+        }));
+    Env::Default()->SleepForMicroseconds(100 * 1000);
+    EXPECT_FALSE(done.HasBeenNotified());
+  }
+  done.WaitForNotification();
+  thread.reset();
+  EXPECT_LT(mutable_input(0).tensor->matrix<float>()(0, 0), 1.0f);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -15,6 +15,7 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
 #include <complex>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -65,12 +66,204 @@ void TransposeSimple(const CPUDevice& device, const Tensor& in,
   device.parallelFor(in.NumElements(), cost, std::move(transpose_fn));
 }
 
+// Transposes a rows x cols block: out[y * out_stride + x] = in[x * in_stride +
+// y] for 0 <= x < rows and 0 <= y < cols.
+template <typename T, bool conjugate,
+          bool use_packets =
+              sizeof(T) == sizeof(float) && !conjugate &&
+              (Eigen::internal::packet_traits<float>::size > 1)>
+struct BlockTransposer {
+  static void Run(const T* in, int64 in_stride, T* out, int64 out_stride,
+                  int64 rows, int64 cols) {
+    for (int64 y = 0; y < cols; ++y) {
+      T* out_row = out + y * out_stride;
+      for (int64 x = 0; x < rows; ++x) {
+        if (conjugate) {
+          out_row[x] = Eigen::numext::conj(in[x * in_stride + y]);
+        } else {
+          out_row[x] = in[x * in_stride + y];
+        }
+      }
+    }
+  }
+};
+
+// Same as above for 4-byte types, which are moved as floats: square tiles of
+// packets are loaded from consecutive input rows, transposed in registers
+// and stored to consecutive output rows.
+template <typename T>
+struct BlockTransposer<T, /*conjugate=*/false, /*use_packets=*/true> {
+  static void Run(const T* in, int64 in_stride, T* out, int64 out_stride,
+                  int64 rows, int64 cols) {
+    using Packet = typename Eigen::internal::packet_traits<float>::type;
+    static constexpr int kSize = Eigen::internal::unpacket_traits<Packet>::size;
+    const float* in_f = reinterpret_cast<const float*>(in);
+    float* out_f = reinterpret_cast<float*>(out);
+    const int64 full_rows = rows - rows % kSize;
+    const int64 full_cols = cols - cols % kSize;
+    for (int64 x = 0; x < full_rows; x += kSize) {
+      for (int64 y = 0; y < full_cols; y += kSize) {
+        Eigen::internal::PacketBlock<Packet, kSize> tile;
+        for (int i = 0; i < kSize; ++i) {
+          tile.packet[i] =
+              Eigen::internal::ploadu<Packet>(in_f + (x + i) * in_stride + y);
+        }
+        Eigen::internal::ptranspose(tile);
+        for (int i = 0; i < kSize; ++i) {
+          Eigen::internal::pstoreu(out_f + (y + i) * out_stride + x,
+                                   tile.packet[i]);
+        }
+      }
+    }
+    // The remaining columns of all rows, then the remaining rows.
+    BlockTransposer<T, false, false>::Run(in + full_cols, in_stride,
+                                          out + full_cols * out_stride,
+                                          out_stride, rows, cols - full_cols);
+    BlockTransposer<T, false, false>::Run(in + full_rows * in_stride, in_stride,
+                                          out + full_rows, out_stride,
+                                          rows - full_rows, full_cols);
+  }
+};
+
+// Transposes the row-major tensor 'p' of shape 'dims' into 'q' according to
+// 'perm', where no two dimensions that are adjacent in the input are also
+// adjacent and in order in the output (see ReduceTransposeDimensions).
+//
+// If the innermost dimension doesn't move, each output row is a contiguous
+// copy of an input row. Otherwise, the innermost input dimension and the
+// input dimension that becomes innermost in the output form a plane that is
+// transposed in cache-sized square blocks, with the outer dimensions and the
+// blocks split across threads.
+template <typename T, bool conjugate>
+void TransposeReduced(const CPUDevice& device,
+                      const internal::TransposeDimsVec& dims,
+                      const internal::TransposePermsVec& perm, const T* p,
+                      T* q) {
+  const int ndims = dims.size();
+  internal::TransposeDimsVec in_strides(ndims);
+  internal::TransposeDimsVec out_dims(ndims);
+  internal::TransposeDimsVec out_strides(ndims);
+  in_strides[ndims - 1] = 1;
+  out_strides[ndims - 1] = 1;
+  for (int i = ndims - 1; i >= 0; --i) {
+    out_dims[i] = dims[perm[i]];
+    if (i < ndims - 1) {
+      in_strides[i] = in_strides[i + 1] * dims[i + 1];
+      out_strides[i] = out_strides[i + 1] * out_dims[i + 1];
+    }
+  }
+  const int64 num_elements = out_strides[0] * out_dims[0];
+  const double index_cycles =
+      ndims * (Eigen::TensorOpCost::DivCost<int64>() +
+               2 * Eigen::TensorOpCost::MulCost<int64>() +
+               2 * Eigen::TensorOpCost::AddCost<int64>());
+
+  if (perm[ndims - 1] == ndims - 1) {
+    const int64 row_size = dims[ndims - 1];
+    auto copy_rows = [=, &in_strides, &out_dims, &perm](int64 begin,
+                                                        int64 end) {
+      for (int64 row = begin; row < end; ++row) {
+        int64 t = row;
+        int64 in_offset = 0;
+        for (int i = ndims - 2; i >= 0; --i) {
+          in_offset += (t % out_dims[i]) * in_strides[perm[i]];
+          t /= out_dims[i];
+        }
+        const T* in_row = p + in_offset;
+        T* out_row = q + row * row_size;
+        if (conjugate) {
+          for (int64 j = 0; j < row_size; ++j) {
+            out_row[j] = Eigen::numext::conj(in_row[j]);
+          }
+        } else {
+          std::copy(in_row, in_row + row_size, out_row);
+        }
+      }
+    };
+    Eigen::TensorOpCost cost(/*bytes_loaded=*/row_size * sizeof(T),
+                             /*bytes_stored=*/row_size * sizeof(T),
+                             index_cycles + (conjugate ? row_size : 0));
+    device.parallelFor(num_elements / row_size, cost, std::move(copy_rows));
+    return;
+  }
+
+  // The plane is made of input rows along dimension 'x_dim' and input columns
+  // along the innermost dimension, which lands at output position 'y_pos'.
+  const int x_dim = perm[ndims - 1];
+  const int y_pos =
+      std::find(perm.begin(), perm.end(), ndims - 1) - perm.begin();
+  const int64 rows = dims[x_dim];
+  const int64 cols = dims[ndims - 1];
+  const int64 in_stride = in_strides[x_dim];
+  const int64 out_stride = out_strides[y_pos];
+  // 32x32 blocks of the input and output fit in L1 for 8-byte types.
+  static constexpr int64 kBlockSize = 32;
+  const int64 row_blocks = (rows + kBlockSize - 1) / kBlockSize;
+  const int64 col_blocks = (cols + kBlockSize - 1) / kBlockSize;
+  const int64 num_outer = num_elements / (rows * cols);
+  auto transpose_blocks = [=, &in_strides, &out_dims, &out_strides, &perm](
+                              int64 begin, int64 end) {
+    for (int64 block = begin; block < end; ++block) {
+      const int64 x_begin = (block % row_blocks) * kBlockSize;
+      const int64 y_begin = (block / row_blocks % col_blocks) * kBlockSize;
+      int64 t = block / (row_blocks * col_blocks);
+      int64 in_offset = x_begin * in_stride + y_begin;
+      int64 out_offset = y_begin * out_stride + x_begin;
+      for (int i = ndims - 2; i >= 0; --i) {
+        if (i == y_pos) continue;
+        const int64 index = t % out_dims[i];
+        t /= out_dims[i];
+        in_offset += index * in_strides[perm[i]];
+        out_offset += index * out_strides[i];
+      }
+      BlockTransposer<T, conjugate>::Run(
+          p + in_offset, in_stride, q + out_offset, out_stride,
+          std::min(kBlockSize, rows - x_begin),
+          std::min(kBlockSize, cols - y_begin));
+    }
+  };
+  const int64 block_elements = std::min(rows, kBlockSize) *
+                               std::min(cols, kBlockSize);
+  Eigen::TensorOpCost cost(/*bytes_loaded=*/block_elements * sizeof(T),
+                           /*bytes_stored=*/block_elements * sizeof(T),
+                           index_cycles + block_elements);
+  device.parallelFor(num_outer * row_blocks * col_blocks, cost,
+                     std::move(transpose_blocks));
+}
+
+// Returns false, leaving the transpose to Eigen or TransposeSimple, for
+// tensors that are empty or whose reduced permutation is the identity.
+template <typename T, bool conjugate>
+bool MaybeTransposeReduced(const CPUDevice& device, const Tensor& in,
+                           const gtl::ArraySlice<int32> perm, Tensor* out) {
+  if (in.dims() < 2 || in.NumElements() == 0) return false;
+  internal::TransposePermsVec new_perm;
+  internal::TransposeDimsVec new_dims;
+  internal::ReduceTransposeDimensions(in.shape(), perm, &new_perm, &new_dims);
+  if (new_perm.size() < 2) return false;
+  TransposeReduced<T, conjugate>(
+      device, new_dims, new_perm,
+      reinterpret_cast<const T*>(in.tensor_data().data()),
+      reinterpret_cast<T*>(const_cast<char*>(out->tensor_data().data())));
+  return true;
+}
+
+// Strings are not trivially copyable, so they keep the Eigen implementation.
+template <>
+bool MaybeTransposeReduced<tstring, false>(const CPUDevice& device,
+                                           const Tensor& in,
+                                           const gtl::ArraySlice<int32> perm,
+                                           Tensor* out) {
+  return false;
+}
+
 }  // namespace
 
 template <typename T, bool conjugate>
 struct Transpose<CPUDevice, T, conjugate> {
   static void run(const CPUDevice& d, const Tensor& in,
                   const gtl::ArraySlice<int32> perm, Tensor* out) {
+    if (MaybeTransposeReduced<T, conjugate>(d, in, perm, out)) return;
     switch (in.dims()) {
       case 2:
         internal::TransposeUsingEigen<CPUDevice, T, 2>(d, in, perm, conjugate,
@@ -37,14 +37,33 @@ struct UnaryOpsCompositionBase {
   using OutputBuffer = typename TTypes<T>::Flat;
 
   using ComputeFn = void (*)(const InputBuffer&, OutputBuffer*);
+  // Computes a binary op of the input and a scalar.
+  using BinaryComputeFn = void (*)(const InputBuffer&, T, OutputBuffer*);
 
+  template <typename Fn>
   struct ComputeFnRegistration {
-    ComputeFn compute_fn;
+    Fn compute_fn;
     int cost;
   };
 
+  // A compute function, bound to its scalar operand if it is a binary op.
+  struct BoundComputeFn {
+    ComputeFn compute_fn = nullptr;
+    BinaryComputeFn binary_compute_fn = nullptr;
+    T scalar;
+
+    void operator()(const InputBuffer& in, OutputBuffer* out) const {
+      if (compute_fn != nullptr) {
+        compute_fn(in, out);
+      } else {
+        binary_compute_fn(in, scalar, out);
+      }
+    }
+  };
+
   bool HasComputeFn(const string& name) {
-    return compute_fns.find(name) != compute_fns.end();
+    return compute_fns.find(name) != compute_fns.end() ||
+           binary_compute_fns.find(name) != binary_compute_fns.end();
   }
 
  protected:
@@ -53,26 +72,53 @@ struct UnaryOpsCompositionBase {
     compute_fns[name] = {compute_fn, cost};
   }
 
+  void RegisterComputeFn(const string& name, BinaryComputeFn compute_fn,
+                         int cost) {
+    VLOG(5) << "Register binary compute fn: name=" << name
+            << " cost=" << cost;
+    binary_compute_fns[name] = {compute_fn, cost};
+  }
+
  private:
   friend class UnaryOpsComposition<T>;
 
   Status ExportComputeFns(const std::vector<string>& op_names,
-                          std::vector<ComputeFn>* fns, int* cost) {
+                          const std::vector<float>& scalars,
+                          std::vector<BoundComputeFn>* fns, int* cost) {
+    int num_scalars = 0;
     for (const string& op_name : op_names) {
+      BoundComputeFn fn;
       auto it = compute_fns.find(op_name);
-      if (it == compute_fns.end())
+      auto binary_it = binary_compute_fns.find(op_name);
+      if (it != compute_fns.end()) {
+        fn.compute_fn = it->second.compute_fn;
+        *cost += it->second.cost;
+      } else if (binary_it != binary_compute_fns.end()) {
+        if (num_scalars == scalars.size()) {
+          return errors::InvalidArgument("Missing a scalar for binary op: ",
+                                         op_name);
+        }
+        fn.binary_compute_fn = binary_it->second.compute_fn;
+        fn.scalar = static_cast<T>(scalars[num_scalars++]);
+        *cost += binary_it->second.cost;
+      } else {
         return errors::InvalidArgument(
             "Do not have a compute function registered for op: ", op_name);
-
-      const ComputeFnRegistration& reg = it->second;
-      fns->push_back(reg.compute_fn);
-      *cost += reg.cost;
+      }
+      fns->push_back(fn);
+    }
+    if (num_scalars != scalars.size()) {
+      return errors::InvalidArgument("Got ", scalars.size(),
+                                     " scalars for ", num_scalars,
+                                     " binary ops");
     }
 
     return Status::OK();
   }
 
-  std::unordered_map<string, ComputeFnRegistration> compute_fns;
+  std::unordered_map<string, ComputeFnRegistration<ComputeFn>> compute_fns;
+  std::unordered_map<string, ComputeFnRegistration<BinaryComputeFn>>
+      binary_compute_fns;
 };
 
 template <typename T>
@@ -87,18 +133,22 @@ class UnaryOpsComposition : public OpKernel {
 
   using InputBuffer = typename Support::InputBuffer;
   using OutputBuffer = typename Support::OutputBuffer;
-  using ComputeFn = typename Support::ComputeFn;
+  using BoundComputeFn = typename Support::BoundComputeFn;
 
   explicit UnaryOpsComposition(OpKernelConstruction* context)
       : OpKernel(context) {
     OP_REQUIRES_OK(context, context->GetAttr("op_names", &op_names_));
+    std::vector<float> scalars;
+    if (context->HasAttr("scalars")) {
+      OP_REQUIRES_OK(context, context->GetAttr("scalars", &scalars));
+    }
 
     OP_REQUIRES(context, !op_names_.empty(),
                 errors::InvalidArgument(
                     "Unary op composition must have at least one op"));
 
-    OP_REQUIRES_OK(context,
-                   support_.ExportComputeFns(op_names_, &fns_, &cost_));
+    OP_REQUIRES_OK(context, support_.ExportComputeFns(op_names_, scalars,
+                                                      &fns_, &cost_));
 
     VLOG(2) << "Composed unary op: [" << absl::StrJoin(op_names_, ", ")
             << "]; cost=" << cost_;
@@ -152,7 +202,7 @@ class UnaryOpsComposition : public OpKernel {
   Support support_;
 
   std::vector<string> op_names_;
-  std::vector<ComputeFn> fns_;
+  std::vector<BoundComputeFn> fns_;
   int cost_ = 0;
 };
 
@@ -210,9 +260,65 @@ class UnaryOpsComposition : public OpKernel {
                 Eigen::NumTraits<T>::MulCost);                                \
   }
 
+// Register compute functions for the binary ops of the input and a scalar.
+#define REGISTER_BINARY_HELPER()                                              \
+  static inline void ComputeAdd(const InputBuffer& in, T scalar,              \
+                                OutputBuffer* out) {                          \
+    *out = in + scalar;                                                       \
+  }                                                                           \
+  static inline int CostAdd() { return Eigen::NumTraits<T>::AddCost; }        \
+                                                                              \
+  static inline void ComputeSub(const InputBuffer& in, T scalar,              \
+                                OutputBuffer* out) {                          \
+    *out = in - scalar;                                                       \
+  }                                                                           \
+  static inline int CostSub() { return Eigen::NumTraits<T>::AddCost; }        \
+                                                                              \
+  static inline void ComputeMul(const InputBuffer& in, T scalar,              \
+                                OutputBuffer* out) {                          \
+    *out = in * scalar;                                                       \
+  }                                                                           \
+  static inline int CostMul() { return Eigen::NumTraits<T>::MulCost; }        \
+                                                                              \
+  static inline void ComputeRealDiv(const InputBuffer& in, T scalar,          \
+                                    OutputBuffer* out) {                      \
+    *out = in / scalar;                                                       \
+  }                                                                           \
+  static inline int CostRealDiv() {                                           \
+    return Eigen::internal::functor_traits<                                   \
+        Eigen::internal::scalar_quotient_op<T>>::Cost;                        \
+  }                                                                           \
+                                                                              \
+  static inline void ComputeMaximum(const InputBuffer& in, T scalar,          \
+                                    OutputBuffer* out) {                      \
+    *out = in.cwiseMax(scalar);                                               \
+  }                                                                           \
+  static inline int CostMaximum() {                                           \
+    return Eigen::internal::functor_traits<                                   \
+        Eigen::internal::scalar_max_op<T>>::Cost;                             \
+  }                                                                           \
+                                                                              \
+  static inline void ComputeMinimum(const InputBuffer& in, T scalar,          \
+                                    OutputBuffer* out) {                      \
+    *out = in.cwiseMin(scalar);                                               \
+  }                                                                           \
+  static inline int CostMinimum() {                                           \
+    return Eigen::internal::functor_traits<                                   \
+        Eigen::internal::scalar_min_op<T>>::Cost;                             \
+  }
+
 #define REGISTER_COMPUTE_FN(func) \
   RegisterComputeFn(#func, Compute##func, Cost##func());
 
+#define REGISTER_BINARY_COMPUTE_FNS()                 \
+  RegisterComputeFn("Add", ComputeAdd, CostAdd());    \
+  RegisterComputeFn("AddV2", ComputeAdd, CostAdd());  \
+  REGISTER_COMPUTE_FN(Sub);                           \
+  REGISTER_COMPUTE_FN(Mul);                           \
+  REGISTER_COMPUTE_FN(RealDiv);                       \
+  REGISTER_COMPUTE_FN(Maximum);                       \
+  REGISTER_COMPUTE_FN(Minimum);
+
 template <>
 struct UnaryOpsCompositionSupport<float> : UnaryOpsCompositionBase<float> {
   using T = float;
@@ -253,9 +359,13 @@ struct UnaryOpsCompositionSupport<float> : UnaryOpsCompositionBase<float> {
     REGISTER_COMPUTE_FN(Relu);
     REGISTER_COMPUTE_FN(Relu6);
     REGISTER_COMPUTE_FN(Selu);
+
+    // Binary ops with a scalar operand.
+    REGISTER_BINARY_COMPUTE_FNS();
   }
 
   REGISTER_RELU_HELPER();
+  REGISTER_BINARY_HELPER();
 
   // clang-format off
   REGISTER_COMPUTE_FN_HELPER(Abs,        functor::abs<T>);
@@ -318,9 +428,13 @@ struct UnaryOpsCompositionSupport<Eigen::half>
     REGISTER_COMPUTE_FN(Relu);
     REGISTER_COMPUTE_FN(Relu6);
     REGISTER_COMPUTE_FN(Selu);
+
+    // Binary ops with a scalar operand.
+    REGISTER_BINARY_COMPUTE_FNS();
   }
 
   REGISTER_RELU_HELPER();
+  REGISTER_BINARY_HELPER();
 
   // clang-format off
   REGISTER_COMPUTE_FN_HELPER(Abs,        functor::abs<T>);
@@ -382,9 +496,13 @@ struct UnaryOpsCompositionSupport<double> : UnaryOpsCompositionBase<double> {
     REGISTER_COMPUTE_FN(Relu);
     REGISTER_COMPUTE_FN(Relu6);
     REGISTER_COMPUTE_FN(Selu);
+
+    // Binary ops with a scalar operand.
+    REGISTER_BINARY_COMPUTE_FNS();
   }
 
   REGISTER_RELU_HELPER();
+  REGISTER_BINARY_HELPER();
 
   // clang-format off
   REGISTER_COMPUTE_FN_HELPER(Abs,        functor::abs<T>);
@@ -33,11 +33,13 @@ namespace {
 class UnaryOpsCompositionTest : public OpsTestBase {
  protected:
   template <typename T>
-  void RunComposedOp(const std::vector<string> op_names, T input, T expected) {
+  void RunComposedOp(const std::vector<string> op_names, T input, T expected,
+                     const std::vector<float> scalars = {}) {
     TF_ASSERT_OK(NodeDefBuilder("unary_op_composition", "_UnaryOpsComposition")
                      .Input(FakeInput(DataTypeToEnum<T>::v()))
                      .Attr("T", DataTypeToEnum<T>::v())
                      .Attr("op_names", op_names)
+                     .Attr("scalars", scalars)
                      .Finalize(node_def()));
     TF_ASSERT_OK(InitOp());
 
@@ -80,6 +82,28 @@ TEST_F(UnaryOpsCompositionTest, Compose_Tanh_Relu6_F) {
   RunComposedOp<float>({"Relu6"}, 11.0f, 6.0f);
 }
 
+TEST_F(UnaryOpsCompositionTest, Compose_Mul_Add_Relu_F) {
+  RunComposedOp<float>({"Mul", "AddV2", "Relu"}, 3.0f, 5.0f, {2.0f, -1.0f});
+}
+
+TEST_F(UnaryOpsCompositionTest, Compose_Sqrt_RealDiv_Sub_D) {
+  RunComposedOp<double>({"Sqrt", "RealDiv", "Sub"}, 81.0, 1.0, {4.5, 1.0});
+}
+
+TEST_F(UnaryOpsCompositionTest, Compose_Maximum_Minimum_F) {
+  RunComposedOp<float>({"Maximum", "Minimum"}, 11.0f, 6.0f, {0.0f, 6.0f});
+}
+
+TEST_F(UnaryOpsCompositionTest, WrongNumberOfScalars) {
+  TF_ASSERT_OK(NodeDefBuilder("unary_op_composition", "_UnaryOpsComposition")
+                   .Input(FakeInput(DT_FLOAT))
+                   .Attr("T", DT_FLOAT)
+                   .Attr("op_names", std::vector<string>({"Mul", "Add"}))
+                   .Attr("scalars", std::vector<float>({2.0f}))
+                   .Finalize(node_def()));
+  EXPECT_FALSE(InitOp().ok());
+}
+
 // Performance benchmarks below.
 
 string Function(int i) {
@@ -13,9 +13,11 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <functional>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/bounds_check.h"
@@ -26,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -68,6 +71,127 @@ struct UniqueOpHashMap<bfloat16, TIndex> {
   using map_type = std::unordered_map<bfloat16, TIndex>;
 };
 
+// Inputs with at least this many elements are uniquified in parallel.
+constexpr int64 kMinParallelUniqueSize = 1 << 15;
+
+// Uniquifies the `n` keys `key_at(0), ..., key_at(n - 1)` on the CPU worker
+// threads, producing the same result as inserting them into one map in order.
+//
+// Keys are radix-partitioned by `hash_at(i)` so that equal keys always land in
+// the same partition, and every partition is deduplicated into its own map
+// (created by `make_map()`) on its own thread. Partition-local ids are then
+// remapped to global ids, numbered in order of first appearance.
+//
+// On return `idx[i]` holds the global id of key `i` and `first_positions[g]`
+// the position of the first occurrence of the key with global id `g`.
+template <typename TIndex, typename MakeMap, typename KeyAt, typename HashAt>
+void ParallelUnique(OpKernelContext* context, int64 n,
+                    const MakeMap& make_map, const KeyAt& key_at,
+                    const HashAt& hash_at, TIndex* idx,
+                    std::vector<int64>* first_positions) {
+  const auto& worker_threads =
+      *context->device()->tensorflow_cpu_worker_threads();
+  const int num_partitions = worker_threads.num_threads;
+  const int64 chunk_size = (n + num_partitions - 1) / num_partitions;
+  auto shard_chunks = [&](int64 cost_per_chunk,
+                          const std::function<void(int, int64, int64)>& fn) {
+    Shard(worker_threads.num_threads, worker_threads.workers, num_partitions,
+          cost_per_chunk, [&](int64 begin, int64 end) {
+            for (int64 c = begin; c < end; ++c) {
+              fn(c, c * chunk_size, std::min(n, (c + 1) * chunk_size));
+            }
+          });
+  };
+
+  // Hash every key and count the keys of each chunk that fall in each
+  // partition.
+  std::vector<int32> partition(n);
+  std::vector<int64> counts(num_partitions * num_partitions, 0);
+  shard_chunks(chunk_size * 20, [&](int c, int64 start, int64 limit) {
+    int64* chunk_counts = &counts[c * num_partitions];
+    for (int64 i = start; i < limit; ++i) {
+      // Use the high bits of the hash so that the keys of a partition still
+      // differ in the low bits the partition's own map relies on.
+      const uint64 h = static_cast<uint64>(hash_at(i)) * 0x9E3779B97F4A7C15ULL;
+      partition[i] = static_cast<int32>((h >> 32) % num_partitions);
+      ++chunk_counts[partition[i]];
+    }
+  });
+
+  // Scatter the positions into per-partition ranges of `positions`. Chunks
+  // are laid out in order, so each range stays sorted by position.
+  std::vector<int64> partition_starts(num_partitions + 1, 0);
+  std::vector<int64> offsets(num_partitions * num_partitions);
+  int64 offset = 0;
+  for (int p = 0; p < num_partitions; ++p) {
+    partition_starts[p] = offset;
+    for (int c = 0; c < num_partitions; ++c) {
+      offsets[c * num_partitions + p] = offset;
+      offset += counts[c * num_partitions + p];
+    }
+  }
+  partition_starts[num_partitions] = offset;
+  std::vector<int64> positions(n);
+  shard_chunks(chunk_size * 2, [&](int c, int64 start, int64 limit) {
+    int64* chunk_offsets = &offsets[c * num_partitions];
+    for (int64 i = start; i < limit; ++i) {
+      positions[chunk_offsets[partition[i]]++] = i;
+    }
+  });
+
+  // Deduplicate every partition independently, flagging first occurrences.
+  std::vector<int64> num_local_uniques(num_partitions, 0);
+  std::vector<uint8> is_first(n, 0);
+  Shard(worker_threads.num_threads, worker_threads.workers, num_partitions,
+        chunk_size * 100, [&](int64 begin, int64 end) {
+          for (int64 p = begin; p < end; ++p) {
+            auto uniq = make_map();
+            uniq.reserve(2 * (partition_starts[p + 1] - partition_starts[p]));
+            TIndex j = 0;
+            for (int64 k = partition_starts[p]; k < partition_starts[p + 1];
+                 ++k) {
+              const int64 i = positions[k];
+              auto it = uniq.emplace(key_at(i), j);
+              idx[i] = it.first->second;
+              if (it.second) {
+                is_first[i] = 1;
+                ++j;
+              }
+            }
+            num_local_uniques[p] = j;
+          }
+        });
+
+  // Number the first occurrences in order of position to get the global ids.
+  std::vector<int64> chunk_uniques(num_partitions, 0);
+  shard_chunks(chunk_size, [&](int c, int64 start, int64 limit) {
+    for (int64 i = start; i < limit; ++i) chunk_uniques[c] += is_first[i];
+  });
+  int64 num_uniques = 0;
+  for (int c = 0; c < num_partitions; ++c) {
+    const int64 chunk_count = chunk_uniques[c];
+    chunk_uniques[c] = num_uniques;
+    num_uniques += chunk_count;
+  }
+  first_positions->resize(num_uniques);
+  std::vector<std::vector<TIndex>> remap(num_partitions);
+  for (int p = 0; p < num_partitions; ++p) {
+    remap[p].resize(num_local_uniques[p]);
+  }
+  shard_chunks(chunk_size * 2, [&](int c, int64 start, int64 limit) {
+    int64 g = chunk_uniques[c];
+    for (int64 i = start; i < limit; ++i) {
+      if (is_first[i]) {
+        (*first_positions)[g] = i;
+        remap[partition[i]][idx[i]] = g++;
+      }
+    }
+  });
+  shard_chunks(chunk_size * 2, [&](int c, int64 start, int64 limit) {
+    for (int64 i = start; i < limit; ++i) idx[i] = remap[partition[i]][idx[i]];
+  });
+}
+
 // `UniqueOp` computes the unique elements in the input tensor.
 //
 // * `T` is the element type.
@@ -142,8 +266,33 @@ class UniqueOp : public OpKernel {
                                 1, TensorShape({new_sizes[1]}), &idx));
     auto idx_vec = idx->template vec<TIndex>();
 
+    const bool parallel =
+        new_sizes[1] >= kMinParallelUniqueSize &&
+        context->device()->tensorflow_cpu_worker_threads()->num_threads > 1;
     int64 uniq_size;
-    if (new_sizes[0] == 1 && new_sizes[2] == 1) {
+    if (new_sizes[0] == 1 && new_sizes[2] == 1 && parallel) {
+      using map_type = typename UniqueOpHashMap<T, TIndex>::map_type;
+      auto Tin = input.flat<T>();
+      const typename map_type::hasher hasher;
+      std::vector<int64> first_positions;
+      ParallelUnique<TIndex>(
+          context, Tin.size(), [] { return map_type(); },
+          [&Tin](int64 i) -> const T& { return Tin(i); },
+          [&Tin, &hasher](int64 i) { return hasher(Tin(i)); }, idx_vec.data(),
+          &first_positions);
+
+      uniq_size = static_cast<int64>(first_positions.size());
+      TensorShape output_shape(input.shape());
+      output_shape.set_dim(axis, uniq_size);
+      Tensor* output = nullptr;
+      OP_REQUIRES_OK(context,
+                     context->allocate_output(0, output_shape, &output));
+      auto Tout = output->flat<T>();
+
+      for (int64 g = 0; g < uniq_size; ++g) {
+        Tout(g) = Tin(first_positions[g]);
+      }
+    } else if (new_sizes[0] == 1 && new_sizes[2] == 1) {
       // Specialized and faster implementation when unique is run over single
       // elements. Here we put T directly into the map rather than ints pointing
       // to them as in the general case.
@@ -197,31 +346,54 @@ class UniqueOp : public OpKernel {
         return true;
       };
 
-      absl::flat_hash_map<int64, int64, decltype(hash_fn),
-                          decltype(equal_to_fn)>
-          uniq(0, hash_fn, equal_to_fn);
+      using map_type = absl::flat_hash_map<int64, int64, decltype(hash_fn),
+                                           decltype(equal_to_fn)>;
 
-      uniq.reserve(2 * Tin.dimension(1));
+      if (parallel) {
+        std::vector<int64> first_positions;
+        ParallelUnique<TIndex>(
+            context, Tin.dimension(1),
+            [&] { return map_type(0, hash_fn, equal_to_fn); },
+            [](int64 i) { return i; }, hash_fn, idx_vec.data(),
+            &first_positions);
 
-      for (int64 i = 0, j = 0; i < Tin.dimension(1); ++i) {
-        auto it = uniq.emplace(i, j);
-        idx_vec(i) = it.first->second;
-        if (it.second) {
-          ++j;
+        uniq_size = static_cast<int64>(first_positions.size());
+        new_sizes[1] = uniq_size;
+        TensorShape output_shape(input.shape());
+        output_shape.set_dim(axis, uniq_size);
+        Tensor* output = nullptr;
+        OP_REQUIRES_OK(context,
+                       context->allocate_output(0, output_shape, &output));
+        auto Tout = output->shaped<T, 3>(new_sizes);
+
+        for (int64 g = 0; g < uniq_size; ++g) {
+          Tout.chip(g, 1) = Tin.chip(first_positions[g], 1);
         }
-      }
+      } else {
+        map_type uniq(0, hash_fn, equal_to_fn);
 
-      uniq_size = static_cast<int64>(uniq.size());
-      new_sizes[1] = uniq_size;
-      TensorShape output_shape(input.shape());
-      output_shape.set_dim(axis, uniq_size);
-      Tensor* output = nullptr;
-      OP_REQUIRES_OK(context,
-                     context->allocate_output(0, output_shape, &output));
-      auto Tout = output->shaped<T, 3>(new_sizes);
+        uniq.reserve(2 * Tin.dimension(1));
 
-      for (auto it : uniq) {
-        Tout.chip(it.second, 1) = Tin.chip(it.first, 1);
+        for (int64 i = 0, j = 0; i < Tin.dimension(1); ++i) {
+          auto it = uniq.emplace(i, j);
+          idx_vec(i) = it.first->second;
+          if (it.second) {
+            ++j;
+          }
+        }
+
+        uniq_size = static_cast<int64>(uniq.size());
+        new_sizes[1] = uniq_size;
+        TensorShape output_shape(input.shape());
+        output_shape.set_dim(axis, uniq_size);
+        Tensor* output = nullptr;
+        OP_REQUIRES_OK(context,
+                       context->allocate_output(0, output_shape, &output));
+        auto Tout = output->shaped<T, 3>(new_sizes);
+
+        for (auto it : uniq) {
+          Tout.chip(it.second, 1) = Tin.chip(it.first, 1);
+        }
       }
     }
 
@@ -370,6 +370,42 @@ TEST(ThreadPool, Parallelism) {
   }
 }
 
+TEST(ThreadPool, WorkerOptions) {
+  for (auto spin_mode : {ThreadPool::WorkerOptions::SpinMode::kDefault,
+                         ThreadPool::WorkerOptions::SpinMode::kFixed,
+                         ThreadPool::WorkerOptions::SpinMode::kAdaptive}) {
+    ThreadPool::WorkerOptions worker_options;
+    worker_options.spin_mode = spin_mode;
+    worker_options.spin_wait_us = 100;
+    worker_options.cpu_affinity = {0};
+    ThreadPool pool(Env::Default(), ThreadOptions(), "test", kNumThreads,
+                    worker_options);
+    const int kTasks = 1000;
+    absl::BlockingCounter counter(kTasks);
+    std::atomic<int> num_scheduled(0);
+    std::function<void()> work = [&]() {
+      counter.DecrementCount();
+      // Schedules the next task from a worker, which others may steal.
+      if (num_scheduled.fetch_add(1) + 1 < kTasks) pool.Schedule(work);
+    };
+    num_scheduled.fetch_add(1);
+    pool.Schedule(work);
+    counter.Wait();
+    ThreadPool::Stats stats = pool.GetStats();
+    EXPECT_EQ(kTasks, stats.tasks_scheduled);
+    EXPECT_LE(stats.tasks_stolen, kTasks);
+    if (spin_mode == ThreadPool::WorkerOptions::SpinMode::kFixed) {
+      EXPECT_EQ(100, stats.spin_wait_us);
+    } else if (spin_mode == ThreadPool::WorkerOptions::SpinMode::kDefault) {
+      EXPECT_EQ(0, stats.spin_wait_us);
+    }
+  }
+  // Pools constructed without WorkerOptions do not collect statistics.
+  ThreadPool pool(Env::Default(), "test", kNumThreads);
+  pool.Schedule([]() {});
+  EXPECT_EQ(0, pool.GetStats().tasks_scheduled);
+}
+
 static void BM_Sequential(::testing::benchmark::State& state) {
   for (auto s : state) {
     state.PauseTiming();
@@ -15,8 +15,9 @@ limitations under the License.
 
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
-// SSE4.2 accelerated CRC32c.
+// SSE4.2 and ARMv8 accelerated CRC32c.
 
 // See if the SSE4.2 crc32c instruction is available.
 #undef USE_SSE_CRC32C
@@ -37,14 +38,27 @@ limitations under the License.
 #undef USE_SSE_CRC32C
 #endif
 
+// See if the ARMv8 crc32c instructions are available. They are optional in
+// ARMv8.0, so they are also checked for at runtime.
+#undef USE_ARM_CRC32C
+#if defined(__aarch64__) && defined(__ARM_FEATURE_CRC32) && defined(__linux__)
+#define USE_ARM_CRC32C 1
+#endif
+
 #ifdef USE_SSE_CRC32C
 #include <nmmintrin.h>
 #endif
 
+#ifdef USE_ARM_CRC32C
+#include <arm_acle.h>
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
+
 namespace tensorflow {
 namespace crc32c {
 
-#ifndef USE_SSE_CRC32C
+#if !defined(USE_SSE_CRC32C) && !defined(USE_ARM_CRC32C)
 
 bool CanAccelerate() { return false; }
 uint32_t AcceleratedExtend(uint32_t crc, const char *buf, size_t size) {
@@ -54,40 +68,180 @@ uint32_t AcceleratedExtend(uint32_t crc, const char *buf, size_t size) {
 
 #else
 
-// SSE4.2 optimized crc32c computation.
-bool CanAccelerate() { return __builtin_cpu_supports("sse4.2"); }
+namespace {
+
+#ifdef USE_SSE_CRC32C
+bool CanAccelerateImpl() { return __builtin_cpu_supports("sse4.2"); }
+
+inline uint32_t ExtendByte(uint32_t crc, uint8_t value) {
+  return _mm_crc32_u8(crc, value);
+}
+
+inline uint32_t ExtendWord(uint32_t crc, uint64_t value) {
+  return static_cast<uint32_t>(_mm_crc32_u64(crc, value));
+}
+#else
+bool CanAccelerateImpl() { return getauxval(AT_HWCAP) & HWCAP_CRC32; }
+
+inline uint32_t ExtendByte(uint32_t crc, uint8_t value) {
+  return __crc32cb(crc, value);
+}
+
+inline uint32_t ExtendWord(uint32_t crc, uint64_t value) {
+  return __crc32cd(crc, value);
+}
+#endif
+
+inline uint64_t LoadWord(const uint8_t *p) {
+  uint64_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+// The crc32c instructions have a latency of several cycles but can start one
+// per cycle. Long inputs are therefore split into three adjacent blocks whose
+// CRCs are computed in interleaved independent lanes, and then folded into one
+// CRC by shifting each lane over the bytes of the blocks that follow it. The
+// shift is a linear operator over GF(2), precomputed as lookup tables for the
+// two block sizes below.
+constexpr size_t kLongBlock = 8192;
+constexpr size_t kShortBlock = 256;
+
+// The reflected CRC-32C (Castagnoli) polynomial.
+constexpr uint32_t kPolynomial = 0x82f63b78;
+
+// Lookup tables applying the shift operator to each byte of a CRC.
+struct ShiftTables {
+  uint32_t long_block[4][256];
+  uint32_t short_block[4][256];
+};
+
+uint32_t Gf2MatrixTimes(const uint32_t *matrix, uint32_t vector) {
+  uint32_t sum = 0;
+  for (; vector != 0; vector >>= 1, ++matrix) {
+    if (vector & 1) {
+      sum ^= *matrix;
+    }
+  }
+  return sum;
+}
+
+void Gf2MatrixSquare(uint32_t *square, const uint32_t *matrix) {
+  for (int i = 0; i < 32; ++i) {
+    square[i] = Gf2MatrixTimes(matrix, matrix[i]);
+  }
+}
+
+// Computes the operator that appends `length` zero bytes to a CRC, where
+// `length` is a power of two.
+void ZerosOperator(uint32_t *even, size_t length) {
+  // The operator for one zero bit.
+  uint32_t odd[32];
+  odd[0] = kPolynomial;
+  for (int i = 1; i < 32; ++i) {
+    odd[i] = 1u << (i - 1);
+  }
+  // The operators for two and four zero bits.
+  Gf2MatrixSquare(even, odd);
+  Gf2MatrixSquare(odd, even);
+  // Each squaring doubles the number of zero bytes, starting from one.
+  while (true) {
+    Gf2MatrixSquare(even, odd);
+    length >>= 1;
+    if (length == 0) {
+      return;
+    }
+    Gf2MatrixSquare(odd, even);
+    length >>= 1;
+    if (length == 0) {
+      memcpy(even, odd, sizeof(odd));
+      return;
+    }
+  }
+}
+
+void MakeShiftTable(uint32_t table[4][256], size_t length) {
+  uint32_t op[32];
+  ZerosOperator(op, length);
+  for (uint32_t i = 0; i < 256; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      table[j][i] = Gf2MatrixTimes(op, i << (8 * j));
+    }
+  }
+}
+
+const ShiftTables &GetShiftTables() {
+  static const ShiftTables *tables = [] {
+    ShiftTables *tables = new ShiftTables;
+    MakeShiftTable(tables->long_block, kLongBlock);
+    MakeShiftTable(tables->short_block, kShortBlock);
+    return tables;
+  }();
+  return *tables;
+}
+
+inline uint32_t Shift(const uint32_t table[4][256], uint32_t crc) {
+  return table[0][crc & 0xff] ^ table[1][(crc >> 8) & 0xff] ^
+         table[2][(crc >> 16) & 0xff] ^ table[3][crc >> 24];
+}
+
+// Extends `crc` over the `3 * block_size` bytes starting at `p`.
+inline uint32_t ExtendThreeBlocks(uint32_t crc, const uint8_t *p,
+                                  size_t block_size,
+                                  const uint32_t shift[4][256]) {
+  uint32_t crc1 = 0;
+  uint32_t crc2 = 0;
+  for (const uint8_t *end = p + block_size; p < end; p += 8) {
+    crc = ExtendWord(crc, LoadWord(p));
+    crc1 = ExtendWord(crc1, LoadWord(p + block_size));
+    crc2 = ExtendWord(crc2, LoadWord(p + 2 * block_size));
+  }
+  crc = Shift(shift, crc) ^ crc1;
+  return Shift(shift, crc) ^ crc2;
+}
+
+}  // namespace
+
+bool CanAccelerate() { return CanAccelerateImpl(); }
 
 uint32_t AcceleratedExtend(uint32_t crc, const char *buf, size_t size) {
   const uint8_t *p = reinterpret_cast<const uint8_t *>(buf);
-  const uint8_t *e = p + size;
   uint32_t l = crc ^ 0xffffffffu;
 
-  // Advance p until aligned to 8-bytes..
-  // Point x at first 7-byte aligned byte in string.  This might be
-  // just past the end of the string.
-  const uintptr_t pval = reinterpret_cast<uintptr_t>(p);
-  const uint8_t *x = reinterpret_cast<const uint8_t *>(((pval + 7) >> 3) << 3);
-  if (x <= e) {
-    // Process bytes until finished or p is 8-byte aligned
-    while (p != x) {
-      l = _mm_crc32_u8(l, *p);
-      p++;
+  // Process bytes until p is 8-byte aligned.
+  while (size > 0 && (reinterpret_cast<uintptr_t>(p) & 7) != 0) {
+    l = ExtendByte(l, *p);
+    ++p;
+    --size;
+  }
+
+  // Process large inputs three blocks at a time.
+  if (size >= 3 * kShortBlock) {
+    const ShiftTables &tables = GetShiftTables();
+    while (size >= 3 * kLongBlock) {
+      l = ExtendThreeBlocks(l, p, kLongBlock, tables.long_block);
+      p += 3 * kLongBlock;
+      size -= 3 * kLongBlock;
+    }
+    while (size >= 3 * kShortBlock) {
+      l = ExtendThreeBlocks(l, p, kShortBlock, tables.short_block);
+      p += 3 * kShortBlock;
+      size -= 3 * kShortBlock;
     }
   }
 
-  // Process bytes 16 at a time
-  uint64_t l64 = l;
-  while ((e - p) >= 16) {
-    l64 = _mm_crc32_u64(l64, *reinterpret_cast<const uint64_t *>(p));
-    l64 = _mm_crc32_u64(l64, *reinterpret_cast<const uint64_t *>(p + 8));
-    p += 16;
+  // Process bytes 8 at a time.
+  while (size >= 8) {
+    l = ExtendWord(l, LoadWord(p));
+    p += 8;
+    size -= 8;
   }
 
   // Process remaining bytes one at a time.
-  l = l64;
-  while (p < e) {
-    l = _mm_crc32_u8(l, *p);
-    p++;
+  while (size > 0) {
+    l = ExtendByte(l, *p);
+    ++p;
+    --size;
   }
 
   return l ^ 0xffffffffu;
@@ -14,6 +14,9 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/lib/hash/crc32c.h"
+
+#include <algorithm>
+
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
@@ -62,6 +65,25 @@ TEST(CRC, Extend) {
   ASSERT_EQ(Value("hello world", 11), Extend(Value("hello ", 6), "world", 5));
 }
 
+TEST(CRC, ExtendLarge) {
+  // Large inputs are processed in several interleaved blocks; check them
+  // against an extension in small steps, at every alignment.
+  std::string input(100000, '\0');
+  for (int i = 0; i < input.size(); i++) {
+    input[i] = static_cast<char>(i * 7 + i / 251);
+  }
+  for (int size : {767, 768, 769, 24575, 24576, 24577, 99990}) {
+    for (int offset = 0; offset < 8; offset++) {
+      const char* data = input.data() + offset;
+      uint32 expected = 0;
+      for (int i = 0; i < size; i += 100) {
+        expected = Extend(expected, data + i, std::min(100, size - i));
+      }
+      ASSERT_EQ(expected, Value(data, size)) << size << " " << offset;
+    }
+  }
+}
+
 TEST(CRC, Mask) {
   uint32 crc = Value("foo", 3);
   ASSERT_NE(crc, Mask(crc));
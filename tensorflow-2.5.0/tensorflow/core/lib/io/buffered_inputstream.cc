@@ -16,10 +16,13 @@ limitations under the License.
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 
 #include "tensorflow/core/lib/io/random_inputstream.h"
+#include "tensorflow/core/platform/mem.h"
 
 namespace tensorflow {
 namespace io {
 
+constexpr size_t BufferedInputStream::kAlignment;
+
 BufferedInputStream::BufferedInputStream(InputStreamInterface* input_stream,
                                          size_t buffer_bytes,
                                          bool owns_input_stream)
@@ -32,12 +35,22 @@ BufferedInputStream::BufferedInputStream(InputStreamInterface* input_stream,
 BufferedInputStream::BufferedInputStream(RandomAccessFile* file,
                                          size_t buffer_bytes)
     : BufferedInputStream(new RandomAccessInputStream(file), buffer_bytes,
-                          true) {}
+                          true) {
+  if (size_ > 0 && size_ % kAlignment == 0) {
+    file_stream_ = static_cast<RandomAccessInputStream*>(input_stream_);
+    aligned_buf_ = static_cast<char*>(port::AlignedMalloc(size_, kAlignment));
+    // Release the buffer reserved above, buf_ only views aligned_buf_.
+    buf_ = tstring();
+  }
+}
 
 BufferedInputStream::~BufferedInputStream() {
   if (owns_input_stream_) {
     delete input_stream_;
   }
+  if (aligned_buf_ != nullptr) {
+    port::AlignedFree(aligned_buf_);
+  }
 }
 
 Status BufferedInputStream::FillBuffer() {
@@ -46,6 +59,9 @@ Status BufferedInputStream::FillBuffer() {
     limit_ = 0;
     return file_status_;
   }
+  if (aligned_buf_ != nullptr) {
+    return FillAlignedBuffer();
+  }
   Status s = input_stream_->ReadNBytes(size_, &buf_);
   pos_ = 0;
   limit_ = buf_.size();
@@ -55,15 +71,41 @@ Status BufferedInputStream::FillBuffer() {
   return s;
 }
 
+Status BufferedInputStream::FillAlignedBuffer() {
+  // Reads the aligned block holding the current position, the bytes before it
+  // are kept so that Seek() can go back to them.
+  const int64 offset = input_stream_->Tell();
+  const int64 aligned_offset = offset - offset % kAlignment;
+  StringPiece data;
+  Status s = file_stream_->file()->Read(aligned_offset, size_, &data,
+                                        aligned_buf_);
+  buf_.assign_as_view(data.data(), data.size());
+  TF_RETURN_IF_ERROR(file_stream_->Seek(aligned_offset + data.size()));
+  if (aligned_offset + static_cast<int64>(data.size()) > offset) {
+    pos_ = offset - aligned_offset;
+    limit_ = data.size();
+  } else {
+    pos_ = 0;
+    limit_ = 0;
+  }
+  if (!s.ok()) {
+    file_status_ = s;
+  }
+  return s;
+}
+
 template <typename StringType>
 Status BufferedInputStream::ReadLineHelper(StringType* result,
                                            bool include_eol) {
   result->clear();
   Status s;
+  // Only reads buf_ through const accessors, which unlike the non-const ones
+  // don't copy the buffer when it is a view of aligned_buf_.
+  const tstring& buf = buf_;
   size_t start_pos = pos_;
   while (true) {
     if (pos_ == limit_) {
-      result->append(buf_.data() + start_pos, pos_ - start_pos);
+      result->append(buf.data() + start_pos, pos_ - start_pos);
       // Get more data into buffer
       s = FillBuffer();
       if (limit_ == 0) {
@@ -71,9 +113,9 @@ Status BufferedInputStream::ReadLineHelper(StringType* result,
       }
       start_pos = pos_;
     }
-    char c = buf_[pos_];
+    char c = buf.data()[pos_];
     if (c == '\n') {
-      result->append(buf_.data() + start_pos, pos_ - start_pos);
+      result->append(buf.data() + start_pos, pos_ - start_pos);
       if (include_eol) {
         result->append(1, c);
       }
@@ -82,7 +124,7 @@ Status BufferedInputStream::ReadLineHelper(StringType* result,
     }
     // We don't append '\r' to *result
     if (c == '\r') {
-      result->append(buf_.data() + start_pos, pos_ - start_pos);
+      result->append(buf.data() + start_pos, pos_ - start_pos);
       start_pos = pos_ + 1;
     }
     pos_++;
@@ -185,13 +227,14 @@ Status BufferedInputStream::Seek(int64 position) {
 template <typename T>
 Status BufferedInputStream::ReadAll(T* result) {
   result->clear();
+  const tstring& buf = buf_;
   Status status;
   while (status.ok()) {
     status = FillBuffer();
     if (limit_ == 0) {
       break;
     }
-    result->append(buf_);
+    result->append(buf.data() + pos_, limit_ - pos_);
     pos_ = limit_;
   }
 
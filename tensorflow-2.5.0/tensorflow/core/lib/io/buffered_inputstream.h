@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_LIB_IO_BUFFERED_INPUTSTREAM_H_
 
 #include "tensorflow/core/lib/io/inputstream_interface.h"
+#include "tensorflow/core/lib/io/random_inputstream.h"
 #include "tensorflow/core/platform/file_system.h"
 
 namespace tensorflow {
@@ -37,8 +38,16 @@ class BufferedInputStream : public InputStreamInterface {
   // InputBuffer exposes. Does not take ownership of file. file must outlive
   // *this. This will be removed once we migrate all uses of this class to the
   // constructor above.
+  //
+  // If buffer_bytes is a multiple of kAlignment, the buffer is aligned to
+  // kAlignment and filled with aligned reads of buffer_bytes straight from
+  // file, so that file systems reading with direct I/O (e.g. the POSIX one with
+  // TF_POSIX_USE_DIRECT_IO set) bypass the page cache without extra copies.
   BufferedInputStream(RandomAccessFile* file, size_t buffer_bytes);
 
+  // The alignment of direct I/O reads.
+  static constexpr size_t kAlignment = 4096;
+
   ~BufferedInputStream() override;
 
   tensorflow::Status ReadNBytes(int64 bytes_to_read, tstring* result) override;
@@ -87,6 +96,7 @@ class BufferedInputStream : public InputStreamInterface {
 
  private:
   tensorflow::Status FillBuffer();
+  tensorflow::Status FillAlignedBuffer();
   template <typename StringType>
   tensorflow::Status ReadLineHelper(StringType* result, bool include_eol);
 
@@ -97,6 +107,10 @@ class BufferedInputStream : public InputStreamInterface {
   size_t pos_ = 0;    // current position in buf_.
   size_t limit_ = 0;  // just past the end of valid data in buf_.
   bool owns_input_stream_ = false;
+  // Set when constructed from a RandomAccessFile with an aligned buffer size:
+  // the stream input_stream_ points to, and the buffer buf_ is a view of.
+  RandomAccessInputStream* file_stream_ = nullptr;
+  char* aligned_buf_ = nullptr;
   // When EoF is reached, file_status_ contains the status to skip unnecessary
   // buffer allocations.
   tensorflow::Status file_status_ = Status::OK();
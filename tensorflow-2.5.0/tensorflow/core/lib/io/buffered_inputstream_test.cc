@@ -363,6 +363,38 @@ TEST(BufferedInputStream, SkipNBytesRandomAccessFile) {
   }
 }
 
+TEST(BufferedInputStream, AlignedBufferRandomAccessFile) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  string contents;
+  for (int i = 0; i < 3 * BufferedInputStream::kAlignment + 100; ++i) {
+    contents.push_back('a' + i % 26);
+  }
+  TF_ASSERT_OK(WriteStringToFile(env, fname, contents));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+
+  const size_t buf_size = BufferedInputStream::kAlignment;
+  tstring read;
+  BufferedInputStream in(file.get(), buf_size);
+  TF_ASSERT_OK(in.SkipNBytes(10));
+  TF_ASSERT_OK(in.ReadNBytes(buf_size, &read));
+  EXPECT_EQ(read, contents.substr(10, buf_size));
+  EXPECT_EQ(10 + buf_size, in.Tell());
+  // Seeks back into the aligned block read before the current position.
+  TF_ASSERT_OK(in.Seek(buf_size + 5));
+  TF_ASSERT_OK(in.ReadNBytes(20, &read));
+  EXPECT_EQ(read, contents.substr(buf_size + 5, 20));
+  TF_ASSERT_OK(in.Seek(2 * buf_size + 1));
+  TF_ASSERT_OK(in.ReadAll(&read));
+  EXPECT_EQ(read, contents.substr(2 * buf_size + 1));
+  EXPECT_EQ(contents.size(), in.Tell());
+  TF_ASSERT_OK(in.Seek(3));
+  TF_ASSERT_OK(in.ReadAll(&read));
+  EXPECT_EQ(read, contents.substr(3));
+}
+
 TEST(BufferedInputStream, Seek) {
   Env* env = Env::Default();
   string fname;
@@ -0,0 +1,67 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// A FilterPolicy creates a small filter from a set of keys.  Filters are
+// stored in the table and consulted to decide whether a block may contain a
+// key, which lets lookups for keys that are not in the table skip the read of
+// the block.
+//
+// A builtin bloom filter policy is provided.  Clients may use their own
+// implementations as long as the same policy is used to write and read a
+// table.
+
+#ifndef TENSORFLOW_CORE_LIB_IO_FILTER_POLICY_H_
+#define TENSORFLOW_CORE_LIB_IO_FILTER_POLICY_H_
+
+#include <string>
+
+#include "tensorflow/core/platform/stringpiece.h"
+
+namespace tensorflow {
+namespace table {
+
+class FilterPolicy {
+ public:
+  virtual ~FilterPolicy();
+
+  // Returns the name of this policy.  The name is stored in the table along
+  // with the filters, and a table is only filtered when it is read with a
+  // policy of the same name.  Change the name whenever the encoding of the
+  // filters changes incompatibly.
+  virtual const char* Name() const = 0;
+
+  // Appends a filter that summarizes keys[0, n-1] to *dst.  The keys are in
+  // sorted order and may contain duplicates.
+  virtual void CreateFilter(const StringPiece* keys, int n,
+                            std::string* dst) const = 0;
+
+  // Returns true if "key" was in the list of keys passed to CreateFilter() to
+  // create "filter".  May return true for keys that were not in the list,
+  // but should do so with a low probability.  Must never return false for
+  // keys that were in the list.
+  virtual bool KeyMayMatch(const StringPiece& key,
+                           const StringPiece& filter) const = 0;
+};
+
+// Returns a new filter policy that uses a bloom filter with approximately
+// "bits_per_key" bits per key.  A good value is 10, which yields a filter
+// with a false positive rate of about 1%.  The caller owns the result, which
+// must outlive any table opened or built with it.
+const FilterPolicy* NewBloomFilterPolicy(int bits_per_key);
+
+}  // namespace table
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_FILTER_POLICY_H_
@@ -50,6 +50,8 @@ class RandomAccessInputStream : public InputStreamInterface {
 
   Status Reset() override { return Seek(0); }
 
+  RandomAccessFile* file() const { return file_; }
+
  private:
   RandomAccessFile* file_;  // Not owned.
   int64 pos_ = 0;           // Tracks where we are in the file.
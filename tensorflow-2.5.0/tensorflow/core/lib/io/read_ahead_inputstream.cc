@@ -0,0 +1,196 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/read_ahead_inputstream.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+namespace io {
+namespace {
+
+// The number of threads of the thread pool shared by instances that are not
+// given a thread pool. The threads mostly wait for I/O to complete.
+constexpr int kDefaultNumThreads = 32;
+
+thread::ThreadPool* DefaultThreadPool() {
+  static thread::ThreadPool* thread_pool = new thread::ThreadPool(
+      Env::Default(), "read_ahead_inputstream", kDefaultNumThreads);
+  return thread_pool;
+}
+
+}  // namespace
+
+ReadAheadInputStream::ReadAheadInputStream(RandomAccessFile* file,
+                                           size_t buffer_bytes,
+                                           int num_buffers,
+                                           thread::ThreadPool* thread_pool,
+                                           bool owns_file)
+    : file_(file),
+      buffer_bytes_(buffer_bytes),
+      num_buffers_(std::max(num_buffers, 1)),
+      thread_pool_(thread_pool ? thread_pool : DefaultThreadPool()),
+      owns_file_(owns_file) {
+  DCHECK_GT(buffer_bytes_, 0);
+}
+
+ReadAheadInputStream::~ReadAheadInputStream() {
+  {
+    mutex_lock l(mu_);
+    while (num_in_flight_ > 0) {
+      cond_var_.wait(l);
+    }
+  }
+  if (owns_file_) {
+    delete file_;
+  }
+}
+
+void ReadAheadInputStream::FillWindowLocked() {
+  while (static_cast<int>(buffers_.size()) < num_buffers_ &&
+         (file_size_ < 0 || next_offset_ < file_size_)) {
+    auto buffer = std::make_shared<Buffer>(next_offset_);
+    next_offset_ += buffer_bytes_;
+    buffers_.push_back(buffer);
+    ++num_in_flight_;
+    thread_pool_->Schedule([this, buffer]() {
+      buffer->data.resize_uninitialized(buffer_bytes_);
+      char* scratch = &buffer->data[0];
+      StringPiece data;
+      Status s = file_->Read(buffer->offset, buffer_bytes_, &data, scratch);
+      if (data.data() != scratch) {
+        memmove(scratch, data.data(), data.size());
+      }
+      buffer->data.resize(data.size());
+      mutex_lock l(mu_);
+      buffer->status = errors::IsOutOfRange(s) ? Status::OK() : s;
+      buffer->done = true;
+      if (buffer->status.ok() && data.size() < buffer_bytes_) {
+        file_size_ = buffer->offset + data.size();
+      }
+      --num_in_flight_;
+      cond_var_.notify_all();
+    });
+  }
+}
+
+void ReadAheadInputStream::RestartLocked(int64 position) {
+  buffers_.clear();
+  pos_ = position;
+  next_offset_ = position;
+}
+
+Status ReadAheadInputStream::ConsumeLocked(int64 bytes_to_consume,
+                                           tstring* result, mutex_lock* lock) {
+  while (bytes_to_consume > 0) {
+    FillWindowLocked();
+    if (buffers_.empty()) {
+      return errors::OutOfRange("reached end of file");
+    }
+    std::shared_ptr<Buffer> buffer = buffers_.front();
+    while (!buffer->done) {
+      cond_var_.wait(*lock);
+    }
+    if (!buffer->status.ok()) {
+      // Discard the read ahead, so that the next call retries the failed read.
+      Status s = buffer->status;
+      RestartLocked(pos_);
+      return s;
+    }
+    const int64 buffer_end = buffer->offset + buffer->data.size();
+    const int64 bytes = std::min(bytes_to_consume, buffer_end - pos_);
+    if (bytes <= 0) {
+      return errors::OutOfRange("reached end of file");
+    }
+    if (result) {
+      result->append(buffer->data.data() + (pos_ - buffer->offset), bytes);
+    }
+    pos_ += bytes;
+    bytes_to_consume -= bytes;
+    // A short read marks the end of the file, so it is kept to report it.
+    if (pos_ == buffer_end && buffer->data.size() == buffer_bytes_) {
+      buffers_.pop_front();
+    }
+  }
+  return Status::OK();
+}
+
+Status ReadAheadInputStream::ReadNBytes(int64 bytes_to_read, tstring* result) {
+  if (bytes_to_read < 0) {
+    return errors::InvalidArgument("Cannot read negative number of bytes");
+  }
+  result->clear();
+  result->reserve(bytes_to_read);
+  mutex_lock l(mu_);
+  return ConsumeLocked(bytes_to_read, result, &l);
+}
+
+Status ReadAheadInputStream::SkipNBytes(int64 bytes_to_skip) {
+  if (bytes_to_skip < 0) {
+    return errors::InvalidArgument("Can't skip a negative number of bytes");
+  }
+  int64 target;
+  {
+    mutex_lock l(mu_);
+    target = pos_ + bytes_to_skip;
+    if (target <= next_offset_) {
+      return ConsumeLocked(bytes_to_skip, /*result=*/nullptr, &l);
+    }
+  }
+  // The target is beyond the read-ahead window. Read the last skipped byte to
+  // check that the file is long enough and restart the window at the target.
+  char scratch;
+  StringPiece data;
+  Status s = file_->Read(target - 1, 1, &data, &scratch);
+  if (!s.ok() && !errors::IsOutOfRange(s)) {
+    return s;
+  }
+  mutex_lock l(mu_);
+  if (data.size() == 1) {
+    RestartLocked(target);
+    return Status::OK();
+  }
+  // Skipping past the end of the file consumes the rest of it, so that the
+  // position ends up at the end of the file.
+  return ConsumeLocked(bytes_to_skip, /*result=*/nullptr, &l);
+}
+
+int64 ReadAheadInputStream::Tell() const {
+  tf_shared_lock l(mu_);
+  return pos_;
+}
+
+Status ReadAheadInputStream::Seek(int64 position) {
+  if (position < 0) {
+    return errors::InvalidArgument("Seeking to a negative position: ",
+                                   position);
+  }
+  mutex_lock l(mu_);
+  // Positions within the read-ahead window reuse the outstanding reads. Like
+  // for RandomAccessInputStream, seeking past the end of the file succeeds and
+  // only the next read reports it.
+  if (position < pos_ || position > next_offset_ ||
+      !ConsumeLocked(position - pos_, /*result=*/nullptr, &l).ok()) {
+    RestartLocked(position);
+  }
+  return Status::OK();
+}
+
+}  // namespace io
+}  // namespace tensorflow
@@ -0,0 +1,113 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_READ_AHEAD_INPUTSTREAM_H_
+#define TENSORFLOW_CORE_LIB_IO_READ_AHEAD_INPUTSTREAM_H_
+
+#include <deque>
+#include <memory>
+
+#include "tensorflow/core/lib/io/inputstream_interface.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+namespace io {
+
+// Wraps a RandomAccessFile in an InputStreamInterface that keeps up to
+// `num_buffers` reads of `buffer_bytes` each outstanding ahead of the current
+// position. The reads are issued on a thread pool, so that the latency of
+// remote file systems is hidden for sequential reads. Seeking or skipping
+// outside of the read-ahead window discards the outstanding reads.
+//
+// A given instance of ReadAheadInputStream is NOT safe for concurrent use by
+// multiple threads.
+class ReadAheadInputStream : public InputStreamInterface {
+ public:
+  // Does not take ownership of `file` unless `owns_file` is set to true. `file`
+  // must outlive *this and be safe for concurrent reads. If `thread_pool` is
+  // null, a thread pool shared by all instances is used. Otherwise, it must
+  // outlive *this.
+  ReadAheadInputStream(RandomAccessFile* file, size_t buffer_bytes,
+                       int num_buffers, thread::ThreadPool* thread_pool,
+                       bool owns_file = false);
+
+  // Blocks until all outstanding reads have completed.
+  ~ReadAheadInputStream() override;
+
+  Status ReadNBytes(int64 bytes_to_read, tstring* result) override;
+
+  Status SkipNBytes(int64 bytes_to_skip) override;
+
+  int64 Tell() const override;
+
+  // Seeks to this offset within the file. Reads that are outstanding for a
+  // different part of the file are discarded.
+  Status Seek(int64 position);
+
+  Status Reset() override { return Seek(0); }
+
+ private:
+  // A read of up to `buffer_bytes_` bytes starting at `offset`.
+  struct Buffer {
+    explicit Buffer(int64 offset) : offset(offset) {}
+
+    const int64 offset;
+    // The fields below are written by the thread pool before `done` is set and
+    // are read only afterwards.
+    tstring data;
+    Status status;
+    bool done = false;
+  };
+
+  // Consumes `bytes_to_consume` bytes starting at the current position,
+  // appending them to `result` unless it is null.
+  Status ConsumeLocked(int64 bytes_to_consume, tstring* result,
+                       mutex_lock* lock) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Issues reads until `num_buffers_` are pending or the end of the file is
+  // known to be reached.
+  void FillWindowLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Discards all pending reads and restarts reading at `position`.
+  void RestartLocked(int64 position) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  RandomAccessFile* const file_;
+  const size_t buffer_bytes_;
+  const int num_buffers_;
+  thread::ThreadPool* const thread_pool_;  // Not owned.
+  const bool owns_file_;
+
+  mutable mutex mu_;
+  condition_variable cond_var_;
+  // Reads in file order. The first one contains the current position.
+  std::deque<std::shared_ptr<Buffer>> buffers_ TF_GUARDED_BY(mu_);
+  // The current position in the file.
+  int64 pos_ TF_GUARDED_BY(mu_) = 0;
+  // The offset at which the next read will be issued.
+  int64 next_offset_ TF_GUARDED_BY(mu_) = 0;
+  // The size of the file, or -1 if the end of the file has not been reached.
+  int64 file_size_ TF_GUARDED_BY(mu_) = -1;
+  // The number of reads that have not completed, including discarded ones.
+  int64 num_in_flight_ TF_GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ReadAheadInputStream);
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_READ_AHEAD_INPUTSTREAM_H_
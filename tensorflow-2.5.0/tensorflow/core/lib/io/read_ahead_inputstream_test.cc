@@ -0,0 +1,177 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/read_ahead_inputstream.h"
+
+#include <atomic>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace io {
+namespace {
+
+static std::vector<int> BufferSizes() { return {1, 2, 3, 4, 7, 10, 65536}; }
+
+static std::vector<int> NumBuffers() { return {1, 2, 5}; }
+
+// Fails the first read that starts at `failing_offset`.
+class FailOnceFile : public RandomAccessFile {
+ public:
+  FailOnceFile(RandomAccessFile* file, uint64 failing_offset)
+      : file_(file), failing_offset_(failing_offset) {}
+
+  Status Read(uint64 offset, size_t n, StringPiece* result,
+              char* scratch) const override {
+    if (offset == failing_offset_ && !failed_.exchange(true)) {
+      *result = StringPiece();
+      return errors::Unavailable("Injected failure");
+    }
+    return file_->Read(offset, n, result, scratch);
+  }
+
+ private:
+  RandomAccessFile* const file_;
+  const uint64 failing_offset_;
+  mutable std::atomic<bool> failed_{false};
+};
+
+class ReadAheadInputStreamTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    Env* env = Env::Default();
+    string fname;
+    ASSERT_TRUE(env->LocalTempFilename(&fname));
+    TF_ASSERT_OK(WriteStringToFile(env, fname, "0123456789"));
+    TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file_));
+  }
+
+  std::unique_ptr<RandomAccessFile> file_;
+};
+
+TEST_F(ReadAheadInputStreamTest, ReadNBytes) {
+  for (auto buf_size : BufferSizes()) {
+    for (auto num_buffers : NumBuffers()) {
+      ReadAheadInputStream in(file_.get(), buf_size, num_buffers,
+                              /*thread_pool=*/nullptr);
+      tstring read;
+      EXPECT_EQ(0, in.Tell());
+      TF_ASSERT_OK(in.ReadNBytes(3, &read));
+      EXPECT_EQ(read, "012");
+      EXPECT_EQ(3, in.Tell());
+      TF_ASSERT_OK(in.ReadNBytes(0, &read));
+      EXPECT_EQ(read, "");
+      EXPECT_EQ(3, in.Tell());
+      TF_ASSERT_OK(in.ReadNBytes(4, &read));
+      EXPECT_EQ(read, "3456");
+      EXPECT_EQ(7, in.Tell());
+      EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(5, &read)));
+      EXPECT_EQ(read, "789");
+      EXPECT_EQ(10, in.Tell());
+      EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(5, &read)));
+      EXPECT_EQ(read, "");
+      EXPECT_EQ(10, in.Tell());
+    }
+  }
+}
+
+TEST_F(ReadAheadInputStreamTest, SkipNBytes) {
+  for (auto buf_size : BufferSizes()) {
+    for (auto num_buffers : NumBuffers()) {
+      ReadAheadInputStream in(file_.get(), buf_size, num_buffers,
+                              /*thread_pool=*/nullptr);
+      tstring read;
+      TF_ASSERT_OK(in.SkipNBytes(1));
+      EXPECT_EQ(1, in.Tell());
+      TF_ASSERT_OK(in.ReadNBytes(2, &read));
+      EXPECT_EQ(read, "12");
+      TF_ASSERT_OK(in.SkipNBytes(4));
+      EXPECT_EQ(7, in.Tell());
+      TF_ASSERT_OK(in.ReadNBytes(1, &read));
+      EXPECT_EQ(read, "7");
+      TF_ASSERT_OK(in.SkipNBytes(2));
+      EXPECT_EQ(10, in.Tell());
+      EXPECT_TRUE(errors::IsOutOfRange(in.SkipNBytes(1)));
+      EXPECT_EQ(10, in.Tell());
+    }
+  }
+}
+
+TEST_F(ReadAheadInputStreamTest, SkipPastEndOfFile) {
+  for (auto buf_size : BufferSizes()) {
+    for (auto num_buffers : NumBuffers()) {
+      ReadAheadInputStream in(file_.get(), buf_size, num_buffers,
+                              /*thread_pool=*/nullptr);
+      tstring read;
+      TF_ASSERT_OK(in.ReadNBytes(2, &read));
+      EXPECT_TRUE(errors::IsOutOfRange(in.SkipNBytes(20)));
+      EXPECT_EQ(10, in.Tell());
+      EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &read)));
+    }
+  }
+}
+
+TEST_F(ReadAheadInputStreamTest, Seek) {
+  for (auto buf_size : BufferSizes()) {
+    for (auto num_buffers : NumBuffers()) {
+      ReadAheadInputStream in(file_.get(), buf_size, num_buffers,
+                              /*thread_pool=*/nullptr);
+      tstring read;
+      TF_ASSERT_OK(in.Seek(6));
+      EXPECT_EQ(6, in.Tell());
+      TF_ASSERT_OK(in.ReadNBytes(2, &read));
+      EXPECT_EQ(read, "67");
+      TF_ASSERT_OK(in.Seek(1));
+      TF_ASSERT_OK(in.ReadNBytes(3, &read));
+      EXPECT_EQ(read, "123");
+      TF_ASSERT_OK(in.Seek(5));
+      TF_ASSERT_OK(in.ReadNBytes(1, &read));
+      EXPECT_EQ(read, "5");
+      TF_ASSERT_OK(in.Reset());
+      EXPECT_EQ(0, in.Tell());
+      TF_ASSERT_OK(in.ReadNBytes(10, &read));
+      EXPECT_EQ(read, "0123456789");
+    }
+  }
+}
+
+TEST_F(ReadAheadInputStreamTest, RetriesFailedRead) {
+  for (auto num_buffers : NumBuffers()) {
+    FailOnceFile file(file_.get(), /*failing_offset=*/4);
+    ReadAheadInputStream in(&file, /*buffer_bytes=*/2, num_buffers,
+                            /*thread_pool=*/nullptr);
+    tstring read;
+    Status s = in.ReadNBytes(6, &read);
+    EXPECT_TRUE(errors::IsUnavailable(s)) << s;
+    EXPECT_EQ(4, in.Tell());
+    TF_ASSERT_OK(in.ReadNBytes(6, &read));
+    EXPECT_EQ(read, "456789");
+  }
+}
+
+TEST_F(ReadAheadInputStreamTest, CustomThreadPool) {
+  thread::ThreadPool thread_pool(Env::Default(), "test", /*num_threads=*/2);
+  ReadAheadInputStream in(file_.get(), /*buffer_bytes=*/3, /*num_buffers=*/4,
+                          &thread_pool);
+  tstring read;
+  TF_ASSERT_OK(in.ReadNBytes(10, &read));
+  EXPECT_EQ(read, "0123456789");
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace tensorflow
@@ -23,11 +23,14 @@ limitations under the License.
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 #include "tensorflow/core/lib/io/compression.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
+#include "tensorflow/core/lib/io/read_ahead_inputstream.h"
 #include "tensorflow/core/platform/env.h"
 
 namespace tensorflow {
 namespace io {
 
+/* static */ constexpr int64 RecordReaderOptions::kDefaultReadAheadBufferSize;
+
 RecordReaderOptions RecordReaderOptions::CreateRecordReaderOptions(
     const string& compression_type) {
   RecordReaderOptions options;
@@ -59,9 +62,16 @@ RecordReader::RecordReader(RandomAccessFile* file,
     : options_(options),
       input_stream_(new RandomAccessInputStream(file)),
       last_read_failed_(false) {
-  if (options.buffer_size > 0) {
-    input_stream_.reset(new BufferedInputStream(input_stream_.release(),
-                                                options.buffer_size, true));
+  if (options.read_ahead_buffers > 0) {
+    const int64 buffer_size =
+        options.buffer_size > 0
+            ? options.buffer_size
+            : RecordReaderOptions::kDefaultReadAheadBufferSize;
+    input_stream_.reset(new ReadAheadInputStream(
+        file, buffer_size, options.read_ahead_buffers,
+        options.read_ahead_thread_pool));
+  } else if (options.buffer_size > 0) {
+    input_stream_.reset(new BufferedInputStream(file, options.buffer_size));
   }
 #if defined(IS_SLIM_BUILD)
   if (options.compression_type != RecordReaderOptions::NONE) {
@@ -209,6 +219,22 @@ Status RecordReader::ReadRecord(uint64* offset, tstring* record) {
   return Status::OK();
 }
 
+Status RecordReader::ReadRecords(uint64* offset, int max_records,
+                                 std::vector<tstring>* records) {
+  int num_read = 0;
+  tstring record;
+  while (num_read < max_records) {
+    Status s = ReadRecord(offset, &record);
+    if (!s.ok()) {
+      if (errors::IsOutOfRange(s) && num_read > 0) break;
+      return s;
+    }
+    records->push_back(std::move(record));
+    ++num_read;
+  }
+  return Status::OK();
+}
+
 Status RecordReader::SkipRecords(uint64* offset, int num_to_skip,
                                  int* num_skipped) {
   TF_RETURN_IF_ERROR(PositionInputStream(*offset));
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_LIB_IO_RECORD_READER_H_
 #define TENSORFLOW_CORE_LIB_IO_RECORD_READER_H_
 
+#include <vector>
+
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/io/inputstream_interface.h"
@@ -32,6 +34,10 @@ namespace tensorflow {
 
 class RandomAccessFile;
 
+namespace thread {
+class ThreadPool;
+}  // namespace thread
+
 namespace io {
 
 struct RecordReaderOptions {
@@ -44,9 +50,24 @@ struct RecordReaderOptions {
 
   // If buffer_size is non-zero, then all reads must be sequential, and no
   // skipping around is permitted. (Note: this is the same behavior as reading
-  // compressed files.) Consider using SequentialRecordReader.
+  // compressed files.) Consider using SequentialRecordReader. A multiple of
+  // BufferedInputStream::kAlignment reads the file in aligned blocks, which
+  // lets file systems using direct I/O bypass the page cache.
   int64 buffer_size = 0;
 
+  // If read_ahead_buffers is positive, the file is read through that many
+  // reads of buffer_size bytes (or kDefaultReadAheadBufferSize bytes if
+  // buffer_size is zero) that are kept outstanding ahead of the current
+  // position. This hides the latency of remote file systems for sequential
+  // reads. Reads that skip past the outstanding ones restart the read-ahead.
+  int read_ahead_buffers = 0;
+
+  // The thread pool on which the read-ahead is issued. If null, a thread pool
+  // shared by all readers is used. Not owned; must outlive the reader.
+  thread::ThreadPool* read_ahead_thread_pool = nullptr;
+
+  static constexpr int64 kDefaultReadAheadBufferSize = 256 << 10;
+
   static RecordReaderOptions CreateRecordReaderOptions(
       const string& compression_type);
 
@@ -97,6 +118,14 @@ class RecordReader {
   // OUT_OF_RANGE for end of file, or something else for an error.
   Status ReadRecord(uint64* offset, tstring* record);
 
+  // Reads up to `max_records` records starting at "*offset", appends them to
+  // *records and updates *offset to point to the offset of the next record.
+  // Returns OK if at least one record was read, OUT_OF_RANGE if the end of
+  // file was reached before any record, or something else for an error. On
+  // error, *records and *offset reflect the records read before the error.
+  Status ReadRecords(uint64* offset, int max_records,
+                     std::vector<tstring>* records);
+
   // Skip num_to_skip record starting at "*offset" and update *offset
   // to point to the offset of the next num_to_skip + 1 record.
   // Return OK on success, OUT_OF_RANGE for end of file, or something
@@ -147,6 +176,13 @@ class SequentialRecordReader {
     return underlying_.ReadRecord(&offset_, record);
   }
 
+  // Read up to max_records of the next records in the file and append them to
+  // *records. Returns OK if at least one record was read, OUT_OF_RANGE for end
+  // of file, or something else for an error.
+  Status ReadRecords(int max_records, std::vector<tstring>* records) {
+    return underlying_.ReadRecords(&offset_, max_records, records);
+  }
+
   // Skip the next num_to_skip record in the file. Return OK on success,
   // OUT_OF_RANGE for end of file, or something else for an error.
   // "*num_skipped" records the number of records that are actually skipped.
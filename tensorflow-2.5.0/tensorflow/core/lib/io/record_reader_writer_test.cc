@@ -229,6 +229,108 @@ TEST(RecordReaderWriterTest, TestSkipOutOfRange) {
   }
 }
 
+TEST(RecordReaderWriterTest, TestReadAhead) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_read_ahead_test";
+
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriter writer(file.get());
+    for (int i = 0; i < 100; ++i) {
+      TF_EXPECT_OK(writer.WriteRecord(strings::StrCat("record", i)));
+    }
+    TF_CHECK_OK(writer.Flush());
+  }
+
+  for (auto buf_size : BufferSizes()) {
+    std::unique_ptr<RandomAccessFile> read_file;
+    TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+    io::RecordReaderOptions options;
+    options.buffer_size = buf_size;
+    options.read_ahead_buffers = 4;
+    io::RecordReader reader(read_file.get(), options);
+    uint64 offset = 0;
+    int num_skipped;
+    tstring record;
+    TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+    EXPECT_EQ("record0", record);
+    TF_CHECK_OK(reader.SkipRecords(&offset, 50, &num_skipped));
+    EXPECT_EQ(50, num_skipped);
+    for (int i = 51; i < 100; ++i) {
+      TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+      EXPECT_EQ(strings::StrCat("record", i), record);
+    }
+    EXPECT_EQ(error::OUT_OF_RANGE, reader.ReadRecord(&offset, &record).code());
+
+    io::RecordReader::Metadata md;
+    TF_ASSERT_OK(reader.GetMetadata(&md));
+    EXPECT_EQ(100, md.stats.entries);
+  }
+}
+
+TEST(RecordReaderWriterTest, TestBatched) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_batched_test";
+  string unbatched_fname =
+      testing::TmpDir() + "/record_reader_writer_unbatched_test";
+
+  std::vector<string> records;
+  for (int i = 0; i < 100; ++i) {
+    records.push_back(string(i * 37, 'a' + i % 26));
+  }
+
+  for (auto compression : {"", "ZLIB"}) {
+    io::RecordWriterOptions options =
+        io::RecordWriterOptions::CreateRecordWriterOptions(compression);
+    {
+      std::unique_ptr<WritableFile> file;
+      TF_CHECK_OK(env->NewWritableFile(fname, &file));
+      io::RecordWriter writer(file.get(), options);
+      TF_EXPECT_OK(writer.WriteRecords({}));
+      TF_EXPECT_OK(writer.WriteRecord(records[0]));
+      std::vector<StringPiece> batch(records.begin() + 1, records.end());
+      TF_EXPECT_OK(writer.WriteRecords(batch));
+      TF_CHECK_OK(writer.Close());
+      TF_CHECK_OK(file->Close());
+    }
+    {
+      std::unique_ptr<WritableFile> file;
+      TF_CHECK_OK(env->NewWritableFile(unbatched_fname, &file));
+      io::RecordWriter writer(file.get(), options);
+      for (const string& record : records) {
+        TF_EXPECT_OK(writer.WriteRecord(record));
+      }
+      TF_CHECK_OK(writer.Close());
+      TF_CHECK_OK(file->Close());
+    }
+    if (options.compression_type == io::RecordWriterOptions::NONE) {
+      string batched_contents, unbatched_contents;
+      TF_CHECK_OK(ReadFileToString(env, fname, &batched_contents));
+      TF_CHECK_OK(ReadFileToString(env, unbatched_fname, &unbatched_contents));
+      EXPECT_EQ(unbatched_contents, batched_contents);
+    }
+
+    std::unique_ptr<RandomAccessFile> read_file;
+    TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+    io::SequentialRecordReader reader(read_file.get(),
+                                      GetMatchingReaderOptions(options));
+    std::vector<tstring> read_records;
+    while (read_records.size() < records.size()) {
+      const size_t num_read = read_records.size();
+      TF_CHECK_OK(reader.ReadRecords(30, &read_records));
+      EXPECT_EQ(std::min<size_t>(num_read + 30, records.size()),
+                read_records.size());
+    }
+    for (int i = 0; i < records.size(); ++i) {
+      EXPECT_EQ(records[i], read_records[i]);
+    }
+    EXPECT_EQ(error::OUT_OF_RANGE,
+              reader.ReadRecords(30, &read_records).code());
+    EXPECT_EQ(records.size(), read_records.size());
+  }
+}
+
 TEST(RecordReaderWriterTest, TestSnappy) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/record_reader_writer_snappy_test";
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/lib/io/record_writer.h"
 
+#include <string.h>
+
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
 #include "tensorflow/core/lib/io/compression.h"
@@ -115,6 +117,29 @@ Status RecordWriter::WriteRecord(StringPiece data) {
   return dest_->Append(StringPiece(footer, sizeof(footer)));
 }
 
+Status RecordWriter::WriteRecords(absl::Span<const StringPiece> records) {
+  if (dest_ == nullptr) {
+    return Status(::tensorflow::error::FAILED_PRECONDITION,
+                  "Writer not initialized or previously closed");
+  }
+  size_t total_size = 0;
+  for (const StringPiece& data : records) {
+    total_size += kHeaderSize + data.size() + kFooterSize;
+  }
+  string buffer;
+  buffer.resize(total_size);
+  char* p = &buffer[0];
+  for (const StringPiece& data : records) {
+    PopulateHeader(p, data.data(), data.size());
+    p += kHeaderSize;
+    memcpy(p, data.data(), data.size());
+    PopulateFooter(p + data.size(), data.data(), data.size());
+    p += data.size() + kFooterSize;
+  }
+  DCHECK_EQ(p, buffer.data() + buffer.size());
+  return dest_->Append(buffer);
+}
+
 #if defined(TF_CORD_SUPPORT)
 Status RecordWriter::WriteRecord(const absl::Cord& data) {
   if (dest_ == nullptr) {
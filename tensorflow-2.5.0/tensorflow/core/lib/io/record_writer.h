@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_LIB_IO_RECORD_WRITER_H_
 #define TENSORFLOW_CORE_LIB_IO_RECORD_WRITER_H_
 
+#include "absl/types/span.h"
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
@@ -79,6 +80,13 @@ class RecordWriter {
 
   Status WriteRecord(StringPiece data);
 
+  // Writes `records` in order, as if by calling `WriteRecord()` on each of
+  // them. The records are framed into a single buffer which is appended to
+  // the file at once, which amortizes the per-call overhead of the
+  // underlying file (and of the compression buffers, if any) across the
+  // batch.
+  Status WriteRecords(absl::Span<const StringPiece> records);
+
 #if defined(TF_CORD_SUPPORT)
   Status WriteRecord(const absl::Cord& data);
 #endif
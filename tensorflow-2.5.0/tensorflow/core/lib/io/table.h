@@ -26,6 +26,7 @@ class RandomAccessFile;
 
 namespace table {
 
+class Footer;
 struct Options;
 
 // A Table is a sorted map from strings to strings.  Tables are
@@ -61,6 +62,13 @@ class Table {
   // be close to the file length.
   uint64 ApproximateOffsetOf(const StringPiece& key) const;
 
+  // Returns false if the table is known not to contain "key", which is
+  // decided from the index and the filter of the data block that "key"
+  // would be in, without reading from the file.  Returns true if "key" may
+  // be in the table, which is always the case if the table is opened
+  // without a filter policy or was built without one.
+  bool KeyMayMatch(const StringPiece& key) const;
+
  private:
   struct Rep;
   Rep* rep_;
@@ -68,6 +76,9 @@ class Table {
   explicit Table(Rep* rep) { rep_ = rep; }
   static Iterator* BlockReader(void*, const StringPiece&);
 
+  void ReadMeta(const Footer& footer);
+  void ReadFilter(const StringPiece& filter_handle_value);
+
   // Calls (*handle_result)(arg, ...) with the entry found after a call
   // to Seek(key).  May not make such a call if filter policy says
   // that key is not present.
@@ -22,6 +22,7 @@ namespace tensorflow {
 namespace table {
 
 class Cache;
+class FilterPolicy;
 
 // DB contents are stored in a set of blocks, each of which holds a
 // sequence of key,value pairs.  Each block may be compressed before
@@ -68,6 +69,12 @@ struct Options {
 
   // If non-null, use the specified cache for blocks.
   Cache* block_cache = nullptr;
+
+  // If non-null, use the specified filter policy to build a filter for the
+  // keys of each data block when writing a table, and to skip the data
+  // blocks that cannot contain a key when reading it.  Tables written with
+  // a filter can be read without one, and vice versa.  Not owned.
+  const FilterPolicy* filter_policy = nullptr;
 };
 
 }  // namespace table
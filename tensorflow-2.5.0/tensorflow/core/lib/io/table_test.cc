@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -24,10 +25,12 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/io/block.h"
 #include "tensorflow/core/lib/io/block_builder.h"
+#include "tensorflow/core/lib/io/filter_policy.h"
 #include "tensorflow/core/lib/io/format.h"
 #include "tensorflow/core/lib/io/iterator.h"
 #include "tensorflow/core/lib/io/table_builder.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/snappy.h"
 #include "tensorflow/core/platform/test.h"
@@ -218,6 +221,13 @@ class BlockConstructor : public Constructor {
 class TableConstructor : public Constructor {
  public:
   TableConstructor() : source_(nullptr), table_(nullptr) {}
+  // Opens the table with "read_filter_policy" rather than the policy it was
+  // built with.
+  explicit TableConstructor(const FilterPolicy* read_filter_policy)
+      : use_read_filter_policy_(true),
+        read_filter_policy_(read_filter_policy),
+        source_(nullptr),
+        table_(nullptr) {}
   ~TableConstructor() override { Reset(); }
   Status FinishImpl(const Options& options, const KVMap& data) override {
     Reset();
@@ -236,6 +246,9 @@ class TableConstructor : public Constructor {
     // Open the table
     source_ = new StringSource(sink.contents());
     Options table_options;
+    table_options.filter_policy = use_read_filter_policy_
+                                      ? read_filter_policy_
+                                      : options.filter_policy;
     return Table::Open(table_options, source_, sink.contents().size(), &table_);
   }
 
@@ -245,6 +258,10 @@ class TableConstructor : public Constructor {
     return table_->ApproximateOffsetOf(key);
   }
 
+  bool KeyMayMatch(const StringPiece& key) const {
+    return table_->KeyMayMatch(key);
+  }
+
   uint64 BytesRead() const { return source_->BytesRead(); }
 
  private:
@@ -255,6 +272,8 @@ class TableConstructor : public Constructor {
     source_ = nullptr;
   }
 
+  bool use_read_filter_policy_ = false;
+  const FilterPolicy* read_filter_policy_ = nullptr;
   StringSource* source_;
   Table* table_;
 };
@@ -633,5 +652,65 @@ TEST(TableTest, SeekToFirstKeyDoesNotReadTooMuch) {
   EXPECT_LT(c.BytesRead(), 200);
 }
 
+TEST(TableTest, FilterPolicy) {
+  std::unique_ptr<const FilterPolicy> policy(NewBloomFilterPolicy(10));
+  std::unique_ptr<const FilterPolicy> other_policy(NewBloomFilterPolicy(10));
+  for (const FilterPolicy* read_policy : {policy.get(), other_policy.get()}) {
+    TableConstructor c(read_policy);
+    for (int i = 0; i < 1000; i += 2) {
+      c.Add(strings::Printf("k%04d", i), strings::Printf("v%d", i));
+    }
+    std::vector<string> keys;
+    KVMap kvmap;
+    Options options;
+    options.block_size = 256;
+    options.compression = kNoCompression;
+    options.filter_policy = policy.get();
+    c.Finish(options, &keys, &kvmap);
+
+    // All keys that are present match.
+    for (const string& key : keys) {
+      EXPECT_TRUE(c.KeyMayMatch(key)) << key;
+    }
+    // Few of the keys that are absent do.
+    int false_positives = 0;
+    for (int i = 1; i < 1000; i += 2) {
+      if (c.KeyMayMatch(strings::Printf("k%04d", i))) ++false_positives;
+    }
+    EXPECT_LT(false_positives, 25);
+    EXPECT_FALSE(c.KeyMayMatch("a"));
+    EXPECT_FALSE(c.KeyMayMatch("z"));
+
+    // The filter does not change the contents of the table.
+    std::unique_ptr<Iterator> iter(c.NewIterator());
+    iter->SeekToFirst();
+    for (const string& key : keys) {
+      ASSERT_TRUE(iter->Valid());
+      EXPECT_EQ(key, iter->key());
+      EXPECT_EQ(kvmap[key], iter->value());
+      iter->Next();
+    }
+    EXPECT_FALSE(iter->Valid());
+  }
+}
+
+TEST(TableTest, FilterPolicyNotUsedWhenReading) {
+  std::unique_ptr<const FilterPolicy> policy(NewBloomFilterPolicy(10));
+  TableConstructor c(/*read_filter_policy=*/nullptr);
+  for (int i = 0; i < 100; i += 2) {
+    c.Add(strings::Printf("k%04d", i), "v");
+  }
+  std::vector<string> keys;
+  KVMap kvmap;
+  Options options;
+  options.block_size = 256;
+  options.filter_policy = policy.get();
+  c.Finish(options, &keys, &kvmap);
+  // Without a filter, only keys past the end of the table are ruled out.
+  EXPECT_TRUE(c.KeyMayMatch("k0001"));
+  EXPECT_TRUE(c.KeyMayMatch("a"));
+  EXPECT_FALSE(c.KeyMayMatch("z"));
+}
+
 }  // namespace table
 }  // namespace tensorflow
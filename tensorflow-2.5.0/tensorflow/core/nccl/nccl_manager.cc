@@ -22,12 +22,14 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/unbounded_work_queue.h"
 #include "tensorflow/core/profiler/lib/annotated_traceme.h"
 #include "tensorflow/core/profiler/lib/connected_traceme.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/util/env_var.h"
 #if GOOGLE_CUDA
 #include "tensorflow/stream_executor/cuda/cuda_activation.h"
 #elif TENSORFLOW_USE_ROCM
@@ -111,12 +113,17 @@ struct NcclManager::CommunicatorMember {
 struct NcclManager::Communicator {
  public:
   explicit Communicator(std::vector<CommunicatorMember> members,
-                        const string& key)
-      : num_devices(members.size()), members(std::move(members)), key(key) {}
+                        const string& key, bool single_node)
+      : num_devices(members.size()),
+        members(std::move(members)),
+        key(key),
+        single_node(single_node) {}
 
   const int num_devices;
   std::vector<CommunicatorMember> members;
   const string key;
+  // True if all the devices of the communicator are local.
+  const bool single_node;
 };
 
 namespace {
@@ -148,6 +155,27 @@ void StringToNcclUniqueId(const string& str_id, ncclUniqueId* nccl_id) {
   }
 }
 
+int NumStreamsPerDeviceFromEnv() {
+  int64 num_streams = 1;
+  Status status = ReadInt64FromEnvVar("TF_NCCL_NUM_STREAMS_PER_DEVICE",
+                                      /*default_val=*/1, &num_streams);
+  if (!status.ok() || num_streams < 1) {
+    LOG(ERROR) << "Invalid TF_NCCL_NUM_STREAMS_PER_DEVICE " << num_streams
+               << " (" << status << "), using 1 stream per device.";
+    return 1;
+  }
+  return num_streams;
+}
+
+void RecordCommunicatorInitTime(uint64 micros) {
+  static auto* cell = monitoring::Sampler<0>::New(
+      {"/tensorflow/core/nccl/communicator_init_time_usecs",
+       "The time spent creating and initializing a NCCL communicator."},
+      // Power of 2 buckets from 1ms to ~17 minutes.
+      monitoring::Buckets::Exponential(1000, 2, 20));
+  cell->GetCell()->Add(micros);
+}
+
 }  // namespace
 
 // A `Collective` encapsulates state for a collective instance at one node.
@@ -225,8 +253,13 @@ struct NcclManager::Collective : public core::RefCounted {
   Status status;
 };
 
-NcclManager::NcclManager() {
-  VLOG(2) << "New NcclManager " << this;
+NcclManager::NcclManager() : NcclManager(NumStreamsPerDeviceFromEnv()) {}
+
+NcclManager::NcclManager(int num_streams_per_device)
+    : num_streams_per_device_(num_streams_per_device) {
+  DCHECK_GE(num_streams_per_device_, 1);
+  VLOG(2) << "New NcclManager " << this << " num_streams_per_device "
+          << num_streams_per_device_;
 #if TENSORFLOW_USE_ROCM
   ++instance_count;
 #endif
@@ -285,12 +318,13 @@ Status NcclManager::GetCommunicator(NcclManager::Collective* collective,
     return status_;
   }
 
-  if (collective->communicator_key.empty()) {
-    // For single-node collectives, when the caller does not specify a
-    // `communicator_key`, we identify a communicator uniquely by the set of
-    // devices participating in the collective.  For example, if a collective is
-    // for GPUs 0, 1, and 2 then this will scan to find the communicator for
-    // GPUs 0, 1, and 2.
+  if (collective->communicator_key.empty() || collective->single_node) {
+    // For single-node collectives, we identify a communicator uniquely by the
+    // set of devices participating in the collective, even if the caller
+    // specifies a `communicator_key`, so that the collective groups with the
+    // same devices share a communicator instead of initializing one each.
+    // For example, if a collective is for GPUs 0, 1, and 2 then this will scan
+    // to find the communicator for GPUs 0, 1, and 2.
     //
     // Note that each executor identifies a context on one device, so this is
     // the same as getting the communicator connecting the devices in the
@@ -308,7 +342,8 @@ Status NcclManager::GetCommunicator(NcclManager::Collective* collective,
     // kernels to per-stream launch queues.  The launch queues are processed by
     // LoopKernelLaunches.
     for (auto& comm : communicators_) {
-      if (comm->num_devices == collective->num_global_devices) {
+      if (comm->single_node &&
+          comm->num_devices == collective->num_global_devices) {
         int i;
         for (i = 0; i < collective->num_local_devices; ++i) {
           if (comm->members[i].nccl_stream->executor !=
@@ -334,7 +369,10 @@ Status NcclManager::GetCommunicator(NcclManager::Collective* collective,
     }
     // This is an instance of multi-node collective.  We have previously
     // created a NCCL unique id and shared with all workers.  Now we find the
-    // `Communicator` corresponding to this id.
+    // `Communicator` corresponding to this id.  Unlike single-node ones, these
+    // communicators aren't shared by groups with the same devices: the
+    // workers could launch the collectives of the groups in different orders,
+    // which would match up the wrong collectives on a shared communicator.
     for (auto& comm : communicators_) {
       if (comm->key == collective->communicator_key) {
         *communicator = comm.get();
@@ -344,6 +382,7 @@ Status NcclManager::GetCommunicator(NcclManager::Collective* collective,
   }
 
   auto* env = Env::Default();
+  const uint64 start_micros = env->NowMicros();
   std::set<NcclStream*> used_streams;
 
   // Create and initialize a new communicator.
@@ -354,13 +393,20 @@ Status NcclManager::GetCommunicator(NcclManager::Collective* collective,
   for (int i = 0; i < collective->num_local_devices; ++i) {
     auto* executor = collective->participants[i]->executor;
 
-    // Find a communication stream to use for the device.
+    // Find a communication stream to use for the device.  The communicators
+    // of a device are assigned its streams round-robin, and a new stream is
+    // created until there are `num_streams_per_device_` of them.
     auto& streams = device_to_comm_streams_[executor];
+    const int stream_idx =
+        device_to_num_communicators_[executor]++ % num_streams_per_device_;
     NcclStream* nccl_stream = nullptr;
-    for (const auto& s : streams) {
-      if (used_streams.insert(s).second) {
-        nccl_stream = s;
-        break;
+    if (stream_idx < streams.size()) {
+      for (int j = 0; j < streams.size(); ++j) {
+        NcclStream* s = streams[(stream_idx + j) % streams.size()];
+        if (used_streams.insert(s).second) {
+          nccl_stream = s;
+          break;
+        }
       }
     }
     if (nccl_stream == nullptr) {
@@ -423,9 +469,11 @@ Status NcclManager::GetCommunicator(NcclManager::Collective* collective,
   for (int i = 0; i < collective->num_local_devices; ++i) {
     members[i].nccl_comm = nccl_comms[i];
   }
-  communicators_.emplace_back(
-      new Communicator(std::move(members), collective->communicator_key));
+  communicators_.emplace_back(new Communicator(std::move(members),
+                                               collective->communicator_key,
+                                               collective->single_node));
   *communicator = communicators_.back().get();
+  RecordCommunicatorInitTime(env->NowMicros() - start_micros);
   return Status::OK();
 }
 
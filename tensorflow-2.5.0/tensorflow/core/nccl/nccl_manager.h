@@ -49,7 +49,15 @@ namespace tensorflow {
 class NcclManager {
  public:
   typedef std::function<void(Status)> DoneCallback;
+  // Runs the collectives on up to TF_NCCL_NUM_STREAMS_PER_DEVICE (default 1)
+  // communication streams per device.
   NcclManager();
+  // Spreads the communicators that include a device over up to
+  // `num_streams_per_device` communication streams, so that collectives of
+  // different communicators may overlap.  Note that NCCL kernels running
+  // concurrently on a device can deadlock if they can't all be resident at
+  // once, which is why a single stream is the default.
+  explicit NcclManager(int num_streams_per_device);
   ~NcclManager();
 
   static NcclManager* instance();
@@ -251,6 +259,11 @@ class NcclManager {
   // include the same device.
   absl::flat_hash_map<se::StreamExecutor*, std::vector<NcclStream*>>
       device_to_comm_streams_ TF_GUARDED_BY(mu_);
+  // The number of communicators created for each device, used to assign the
+  // streams of new communicators round-robin.
+  absl::flat_hash_map<se::StreamExecutor*, int> device_to_num_communicators_
+      TF_GUARDED_BY(mu_);
+  const int num_streams_per_device_;
 
   std::vector<std::unique_ptr<Communicator>> communicators_ TF_GUARDED_BY(mu_);
 
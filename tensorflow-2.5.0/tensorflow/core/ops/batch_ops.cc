@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/framework/common_shape_fns.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/shape_inference.h"
+#include "tensorflow/core/framework/tensor_shape.h"
 
 namespace tensorflow {
 
@@ -121,4 +122,66 @@ REGISTER_OP("UnbatchGrad")
       return Status::OK();
     });
 
+REGISTER_OP("SequenceStateCache")
+    .Output("handle: resource")
+    .Attr("dtype: type")
+    .Attr("state_shape: shape")
+    .Attr("capacity: int >= 1")
+    .Attr("container: string = ''")
+    .Attr("shared_name: string = ''")
+    .SetIsStateful()
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      c->set_output(0, c->Scalar());
+      DataType dtype;
+      TF_RETURN_IF_ERROR(c->GetAttr("dtype", &dtype));
+      PartialTensorShape state_shape;
+      TF_RETURN_IF_ERROR(c->GetAttr("state_shape", &state_shape));
+      shape_inference::ShapeHandle s;
+      TF_RETURN_IF_ERROR(c->MakeShapeFromPartialTensorShape(state_shape, &s));
+      c->set_output_handle_shapes_and_types(
+          0, std::vector<shape_inference::ShapeAndType>{{s, dtype}});
+      return Status::OK();
+    });
+
+REGISTER_OP("SequenceStateCacheGather")
+    .Input("handle: resource")
+    .Input("sequence_ids: int64")
+    .Output("states: dtype")
+    .Attr("dtype: type")
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      shape_inference::ShapeHandle ids;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &ids));
+      auto* handle_data = c->input_handle_shapes_and_types(0);
+      if (handle_data == nullptr || handle_data->empty()) {
+        c->set_output(0, c->UnknownShape());
+        return Status::OK();
+      }
+      shape_inference::ShapeHandle out;
+      TF_RETURN_IF_ERROR(c->Concatenate(ids, (*handle_data)[0].shape, &out));
+      c->set_output(0, out);
+      return Status::OK();
+    });
+
+REGISTER_OP("SequenceStateCacheScatter")
+    .Input("handle: resource")
+    .Input("sequence_ids: int64")
+    .Input("states: dtype")
+    .Attr("dtype: type")
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      shape_inference::ShapeHandle ids;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &ids));
+      shape_inference::ShapeHandle states;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(2), 1, &states));
+      shape_inference::DimensionHandle unused;
+      return c->Merge(c->Dim(ids, 0), c->Dim(states, 0), &unused);
+    });
+
+REGISTER_OP("SequenceStateCacheRelease")
+    .Input("handle: resource")
+    .Input("sequence_ids: int64")
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      shape_inference::ShapeHandle unused;
+      return c->WithRank(c->input(1), 1, &unused);
+    });
+
 }  // namespace tensorflow
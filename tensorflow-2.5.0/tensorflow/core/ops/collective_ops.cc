@@ -117,9 +117,33 @@ REGISTER_OP("CollectiveReduceV2")
     .Attr("communication_hint: string = 'auto'")
     .Attr("timeout_seconds: float = 0")
     .Attr("Nordering_token: int >= 0 = 0")
+    .Attr("compression: {'none', 'fp16', 'bf16'} = 'none'")
     .SetIsStateful()
     .SetShapeFn(shape_inference::UnchangedShape);
 
+REGISTER_OP("CollectiveBatchReduceV2")
+    .Input("inputs: N * T")
+    .Output("data: N * T")
+    .Attr("N: int >= 1")
+    .Attr("T: {float, float16, float64, int32, int64}")
+    .Input("group_size: int32")
+    .Input("group_key: int32")
+    .Input("instance_key: int32")
+    .Input("ordering_token: Nordering_token * resource")
+    .Attr("merge_op: {'Min', 'Max', 'Mul', 'Add'}")
+    .Attr("final_op: {'Id', 'Div'}")
+    .Attr("communication_hint: string = 'auto'")
+    .Attr("timeout_seconds: float = 0")
+    .Attr("Nordering_token: int >= 0 = 0")
+    .Attr("compression: {'none', 'fp16', 'bf16'} = 'none'")
+    .SetIsStateful()
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      for (int i = 0; i < c->num_outputs(); ++i) {
+        c->set_output(i, c->input(i));
+      }
+      return Status::OK();
+    });
+
 REGISTER_OP("CollectiveGatherV2")
     .Input("input: T")
     .Output("data: T")
@@ -302,8 +302,16 @@ REGISTER_OP("_UnaryOpsComposition")
     .Output("y: T")
     .Attr("T: {float, half, double}")
     .Attr("op_names: list(string)")
+    .Attr("scalars: list(float) = []")
     .SetShapeFn(shape_inference::UnchangedShape)
     .Doc(R"doc(
+Computes a chain of elementwise ops in a single pass over `x`.
+
+The ops in `op_names` are applied in order.  Unary ops (e.g. "Relu") apply to
+the result of the preceding op.  Binary ops ("Add", "AddV2", "Sub", "Mul",
+"RealDiv", "Maximum" and "Minimum") apply to the result of the preceding op
+and the next value of `scalars`, in that order.
+
 *NOTE*: Do not invoke this operator directly in Python. Graph rewrite pass is
 expected to create these operators.
 )doc");
@@ -1197,6 +1205,54 @@ Status SparseSegmentReductionGradShapeFn(InferenceContext* c) {
   return Status::OK();
 }
 
+Status SparseSegmentWeightedCombineShapeFn(InferenceContext* c) {
+  ShapeHandle data_shape;
+  TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(0), 1, &data_shape));
+
+  // indices, weights and segment_ids should merge cleanly.
+  ShapeHandle indices_shape;
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &indices_shape));
+  TF_RETURN_IF_ERROR(c->Merge(indices_shape, c->input(2), &indices_shape));
+  TF_RETURN_IF_ERROR(c->Merge(indices_shape, c->input(3), &indices_shape));
+
+  ShapeHandle subshape;
+  TF_RETURN_IF_ERROR(c->Subshape(data_shape, 1, &subshape));
+
+  ShapeHandle out;
+  TF_RETURN_IF_ERROR(
+      c->Concatenate(c->Vector(InferenceContext::kUnknownDim), subshape, &out));
+  c->set_output(0, out);
+  return Status::OK();
+}
+
+Status SparseSegmentWeightedCombineGradShapeFn(InferenceContext* c) {
+  ShapeHandle data_shape;
+  TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(1), 1, &data_shape));
+
+  ShapeHandle grad_shape;
+  TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(0), 1, &grad_shape));
+
+  ShapeHandle subshape;
+  TF_RETURN_IF_ERROR(c->Subshape(data_shape, 1, &subshape));
+  ShapeHandle grad_subshape;
+  TF_RETURN_IF_ERROR(c->Subshape(grad_shape, 1, &grad_subshape));
+  TF_RETURN_IF_ERROR(c->Merge(subshape, grad_subshape, &subshape));
+
+  // indices, weights and segment_ids should merge cleanly.
+  ShapeHandle indices_shape;
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &indices_shape));
+  TF_RETURN_IF_ERROR(c->Merge(indices_shape, c->input(3), &indices_shape));
+  TF_RETURN_IF_ERROR(c->Merge(indices_shape, c->input(4), &indices_shape));
+
+  ShapeHandle values_shape;
+  TF_RETURN_IF_ERROR(c->Concatenate(c->Vector(InferenceContext::kUnknownDim),
+                                    subshape, &values_shape));
+  c->set_output(0, c->Vector(InferenceContext::kUnknownDim));
+  c->set_output(1, values_shape);
+  c->set_output(2, indices_shape);
+  return Status::OK();
+}
+
 Status SparseSegmentReductionWithNumSegmentsShapeFn(InferenceContext* c) {
   ShapeHandle data_shape;
   TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(0), 1, &data_shape));
@@ -1405,6 +1461,33 @@ REGISTER_OP("SparseSegmentSqrtNGrad")
     .Attr("Tsegmentids: {int32, int64} = DT_INT32")
     .SetShapeFn(SparseSegmentReductionGradShapeFn);
 
+REGISTER_OP("SparseSegmentWeightedCombine")
+    .Input("data: T")
+    .Input("indices: Tidx")
+    .Input("weights: T")
+    .Input("segment_ids: Tsegmentids")
+    .Output("output: T")
+    .Attr("combiner: {'sum', 'mean', 'sqrtn'} = 'sum'")
+    .Attr("T: {float, double}")
+    .Attr("Tidx: {int32, int64} = DT_INT32")
+    .Attr("Tsegmentids: {int32, int64} = DT_INT32")
+    .SetShapeFn(SparseSegmentWeightedCombineShapeFn);
+
+REGISTER_OP("SparseSegmentWeightedCombineGrad")
+    .Input("grad: T")
+    .Input("data: T")
+    .Input("indices: Tidx")
+    .Input("weights: T")
+    .Input("segment_ids: Tsegmentids")
+    .Output("output_indices: Tidx")
+    .Output("output_values: T")
+    .Output("weights_grad: T")
+    .Attr("combiner: {'sum', 'mean', 'sqrtn'} = 'sum'")
+    .Attr("T: {float, double}")
+    .Attr("Tidx: {int32, int64} = DT_INT32")
+    .Attr("Tsegmentids: {int32, int64} = DT_INT32")
+    .SetShapeFn(SparseSegmentWeightedCombineGradShapeFn);
+
 REGISTER_OP("All")
     .Input("input: bool")
     .Input("reduction_indices: Tidx")
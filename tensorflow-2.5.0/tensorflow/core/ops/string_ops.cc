@@ -74,6 +74,35 @@ REGISTER_OP("StaticRegexFullMatch")
     .Output("output: bool")
     .SetShapeFn(shape_inference::UnchangedShape);
 
+REGISTER_OP("RegexReplaceSet")
+    .Input("input: string")
+    .Input("patterns: string")
+    .Input("rewrites: string")
+    .Output("output: string")
+    .Attr("replace_global: bool = true")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle patterns;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &patterns));
+      ShapeHandle rewrites;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &rewrites));
+      TF_RETURN_IF_ERROR(c->Merge(patterns, rewrites, &patterns));
+      c->set_output(0, c->input(0));
+      return Status::OK();
+    });
+
+REGISTER_OP("RegexMatchSet")
+    .Input("input: string")
+    .Input("patterns: string")
+    .Output("output: bool")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle patterns;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &patterns));
+      ShapeHandle output;
+      TF_RETURN_IF_ERROR(c->Concatenate(c->input(0), patterns, &output));
+      c->set_output(0, output);
+      return Status::OK();
+    });
+
 REGISTER_OP("StringToHashBucketFast")
     .Input("input: string")
     .Output("output: int64")
@@ -164,6 +164,39 @@ REGISTER_OP("ResourceSparseApplyProximalGradientDescent")
     .SetShapeFn(ApplyProximalGradientDescentShapeFn</*is_sparse=*/true,
                                                     /*is_resource=*/true>);
 
+REGISTER_OP("ResourceSparseSegmentApplyGradientDescent")
+    .Input("var: resource")
+    .Input("alpha: T")
+    .Input("grad: T")
+    .Input("indices: Tidx")
+    .Input("segment_ids: Tsegmentids")
+    .Attr("T: {float, double}")
+    .Attr("combiner: {'sum', 'mean', 'sqrtn'} = 'sum'")
+    .Attr("Tidx: {int32, int64} = DT_INT32")
+    .Attr("Tsegmentids: {int32, int64} = DT_INT32")
+    .Attr("use_locking: bool = false")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle var = ShapeOrHandleShape</*is_resource=*/true>(c, 0);
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 0, &unused));  // alpha
+      ShapeHandle grad;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(2), 1, &grad));
+      ShapeHandle indices;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 1, &indices));
+      ShapeHandle segment_ids;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(4), 1, &segment_ids));
+      TF_RETURN_IF_ERROR(c->Merge(indices, segment_ids, &unused));
+
+      // The rows of grad are the gradients of the combined segments, and
+      // match the rows of var.
+      ShapeHandle var_subshape;
+      TF_RETURN_IF_ERROR(c->Subshape(var, 1, &var_subshape));
+      ShapeHandle grad_subshape;
+      TF_RETURN_IF_ERROR(c->Subshape(grad, 1, &grad_subshape));
+      TF_RETURN_IF_ERROR(c->Merge(var_subshape, grad_subshape, &unused));
+      return Status::OK();
+    });
+
 template <bool is_sparse, bool is_resource>
 static Status ApplyAdadeltaShapeFn(InferenceContext* c) {
   ShapeHandle unused;
@@ -56,6 +56,14 @@ class FileBlockCacheStatsInterface {
   /// RecordBlockLoadRequest is called to record the size of a missed block.
   virtual void RecordCacheMissBlockSize(size_t bytes_transferred) = 0;
 
+  /// RecordReadaheadDepth is called with the number of blocks fetched ahead of
+  /// a sequential read.
+  virtual void RecordReadaheadDepth(size_t num_blocks) {}
+
+  /// RecordUnusedReadaheadBytes is called with the size of a block that was
+  /// fetched ahead of a sequential read, but evicted before it was read.
+  virtual void RecordUnusedReadaheadBytes(size_t bytes) {}
+
   virtual ~FileBlockCacheStatsInterface() = default;
 };
 
@@ -101,6 +109,11 @@ class FileBlockCache {
   virtual bool ValidateAndUpdateFileSignature(const string& filename,
                                               int64 file_signature) = 0;
 
+  /// Records that `filename` is `file_size` bytes long. Caches that fetch
+  /// blocks ahead of reads only do so for files of known size, so that they
+  /// never fetch past the end of the file.
+  virtual void SetFileSize(const string& filename, uint64 file_size) {}
+
   /// Remove all cached blocks for `filename`.
   virtual void RemoveFile(const string& filename) = 0;
 
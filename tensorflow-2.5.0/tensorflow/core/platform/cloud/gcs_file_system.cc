@@ -145,6 +145,18 @@ constexpr char kAppendMode[] = "GCS_APPEND_MODE";
 // objects.
 constexpr char kComposeAppend[] = "compose";
 
+// The environment variable that enables parallel composite uploads: writable
+// files are uploaded in chunks of this size, in MB, while they are written,
+// and the chunks are composed into the object on flush. Disabled by default,
+// and ignored with GCS_APPEND_MODE=compose.
+constexpr char kParallelUploadChunkSize[] = "GCS_PARALLEL_UPLOAD_CHUNK_SIZE_MB";
+// The environment variable that overrides the number of threads uploading
+// chunks of parallel composite uploads.
+constexpr char kParallelUploadThreads[] = "GCS_PARALLEL_UPLOAD_THREADS";
+constexpr int64 kDefaultParallelUploadThreads = 8;
+// The maximum number of source objects of a GCS compose request.
+constexpr size_t kMaxComposeSources = 32;
+
 Status GetTmpFilename(string* filename) {
   *filename = io::GetTempFilename("");
   return Status::OK();
@@ -422,6 +434,8 @@ class GcsWritableFile : public WritableFile {
                   GcsFileSystem::TimeoutConfig* timeouts,
                   std::function<void()> file_cache_erase,
                   RetryConfig retry_config, bool compose_append,
+                  size_t parallel_upload_chunk_size,
+                  thread::ThreadPool* upload_pool,
                   SessionCreator session_creator,
                   ObjectUploader object_uploader, StatusPoller status_poller,
                   GenerationGetter generation_getter)
@@ -434,6 +448,11 @@ class GcsWritableFile : public WritableFile {
         retry_config_(retry_config),
         compose_append_(compose_append),
         start_offset_(0),
+        parallel_upload_chunk_size_(
+            compose_append || upload_pool == nullptr
+                ? 0
+                : parallel_upload_chunk_size),
+        upload_pool_(upload_pool),
         session_creator_(std::move(session_creator)),
         object_uploader_(std::move(object_uploader)),
         status_poller_(std::move(status_poller)),
@@ -456,6 +475,8 @@ class GcsWritableFile : public WritableFile {
                   GcsFileSystem::TimeoutConfig* timeouts,
                   std::function<void()> file_cache_erase,
                   RetryConfig retry_config, bool compose_append,
+                  size_t parallel_upload_chunk_size,
+                  thread::ThreadPool* upload_pool,
                   SessionCreator session_creator,
                   ObjectUploader object_uploader, StatusPoller status_poller,
                   GenerationGetter generation_getter)
@@ -468,6 +489,11 @@ class GcsWritableFile : public WritableFile {
         retry_config_(retry_config),
         compose_append_(compose_append),
         start_offset_(0),
+        parallel_upload_chunk_size_(
+            compose_append || upload_pool == nullptr
+                ? 0
+                : parallel_upload_chunk_size),
+        upload_pool_(upload_pool),
         session_creator_(std::move(session_creator)),
         object_uploader_(std::move(object_uploader)),
         status_poller_(std::move(status_poller)),
@@ -482,12 +508,24 @@ class GcsWritableFile : public WritableFile {
   ~GcsWritableFile() override {
     Close().IgnoreError();
     std::remove(tmp_content_filename_.c_str());
+    if (parallel_upload_chunk_size_ > 0) {
+      WaitForChunkUploads().IgnoreError();
+      mutex_lock l(upload_mu_);
+      for (const Chunk& chunk : chunks_) {
+        if (!chunk.uploaded) {
+          std::remove(chunk.filename.c_str());
+        }
+      }
+    }
   }
 
   Status Append(StringPiece data) override {
     TF_RETURN_IF_ERROR(CheckWritable());
     VLOG(3) << "Append: " << GetGcsPath() << " size " << data.length();
     sync_needed_ = true;
+    if (parallel_upload_chunk_size_ > 0) {
+      return AppendToChunks(data);
+    }
     outfile_ << data;
     if (!outfile_.good()) {
       return errors::Internal(
@@ -502,6 +540,7 @@ class GcsWritableFile : public WritableFile {
       Status sync_status = Sync();
       if (sync_status.ok()) {
         outfile_.close();
+        sync_status = DeleteChunkObjects();
       }
       return sync_status;
     }
@@ -523,7 +562,7 @@ class GcsWritableFile : public WritableFile {
     if (!sync_needed_) {
       return Status::OK();
     }
-    Status status = SyncImpl();
+    Status status = HasChunks() ? SyncChunks() : SyncImpl();
     VLOG(3) << "Sync finished " << GetGcsPath();
     if (status.ok()) {
       sync_needed_ = false;
@@ -536,6 +575,7 @@ class GcsWritableFile : public WritableFile {
     if (*position == -1) {
       return errors::Internal("tellp on the internal temporary file failed");
     }
+    *position += chunk_start_;
     return Status::OK();
   }
 
@@ -710,6 +750,266 @@ class GcsWritableFile : public WritableFile {
     return status;
   }
 
+  /// A part of the file uploaded as a temporary object.
+  struct Chunk {
+    string object;
+    // The local file holding the chunk, deleted once it is uploaded.
+    string filename;
+    uint64 size;
+    bool uploaded;
+  };
+
+  bool HasChunks() {
+    mutex_lock l(upload_mu_);
+    return !chunks_.empty();
+  }
+
+  /// Appends data to the local file, starting the upload of every chunk that
+  /// is filled up.
+  Status AppendToChunks(StringPiece data) {
+    while (!data.empty()) {
+      uint64 size;
+      TF_RETURN_IF_ERROR(GetCurrentFileSize(&size));
+      const size_t n = std::min<uint64>(
+          data.size(), size < parallel_upload_chunk_size_
+                           ? parallel_upload_chunk_size_ - size
+                           : 0);
+      outfile_.write(data.data(), n);
+      if (!outfile_.good()) {
+        return errors::Internal(
+            "Could not append to the internal temporary file.");
+      }
+      data.remove_prefix(n);
+      if (size + n >= parallel_upload_chunk_size_) {
+        TF_RETURN_IF_ERROR(StartChunkUpload());
+      }
+    }
+    return Status::OK();
+  }
+
+  /// Schedules the upload of the local file as the next chunk and continues
+  /// writing to a new local file.
+  Status StartChunkUpload() {
+    Chunk chunk;
+    TF_RETURN_IF_ERROR(GetCurrentFileSize(&chunk.size));
+    outfile_.close();
+    if (outfile_.fail()) {
+      return errors::Internal(
+          "Could not write to the internal temporary file.");
+    }
+    chunk.object = TmpComposeObject(strings::StrCat(chunk_start_));
+    chunk.filename = tmp_content_filename_;
+    chunk.uploaded = false;
+    chunk_start_ += chunk.size;
+    TF_RETURN_IF_ERROR(GetTmpFilename(&tmp_content_filename_));
+    outfile_.open(tmp_content_filename_,
+                  std::ofstream::binary | std::ofstream::app);
+    size_t index;
+    {
+      mutex_lock l(upload_mu_);
+      index = chunks_.size();
+      chunks_.push_back(chunk);
+    }
+    ScheduleChunkUpload(index);
+    return Status::OK();
+  }
+
+  void ScheduleChunkUpload(size_t index) {
+    Chunk chunk;
+    {
+      mutex_lock l(upload_mu_);
+      chunk = chunks_[index];
+      ++pending_uploads_;
+    }
+    upload_pool_->Schedule([this, index, chunk]() {
+      const Status status = UploadChunk(chunk);
+      mutex_lock l(upload_mu_);
+      if (status.ok()) {
+        chunks_[index].uploaded = true;
+        std::remove(chunk.filename.c_str());
+      } else {
+        upload_status_.Update(status);
+      }
+      if (--pending_uploads_ == 0) {
+        upload_cv_.notify_all();
+      }
+    });
+  }
+
+  /// Waits for the scheduled chunk uploads and returns the first error any of
+  /// them hit since the last call.
+  Status WaitForChunkUploads() {
+    mutex_lock l(upload_mu_);
+    while (pending_uploads_ > 0) {
+      upload_cv_.wait(l);
+    }
+    Status status = upload_status_;
+    upload_status_ = Status::OK();
+    return status;
+  }
+
+  /// Uploads a chunk to its temporary object, resuming failed uploads like
+  /// SyncImpl().
+  Status UploadChunk(const Chunk& chunk) {
+    const string gcs_path = GetGcsPathWithObject(chunk.object);
+    UploadSessionHandle session_handle;
+    TF_RETURN_IF_ERROR(session_creator_(0, chunk.object, bucket_, chunk.size,
+                                        gcs_path, &session_handle));
+    uint64 already_uploaded = 0;
+    bool first_attempt = true;
+    const Status upload_status = RetryingUtils::CallWithRetries(
+        [&first_attempt, &already_uploaded, &session_handle, &chunk, &gcs_path,
+         this]() {
+          if (session_handle.resumable && !first_attempt) {
+            bool completed;
+            TF_RETURN_IF_ERROR(status_poller_(session_handle.session_uri,
+                                              chunk.size, gcs_path, &completed,
+                                              &already_uploaded));
+            if (completed) {
+              return Status::OK();
+            }
+          }
+          first_attempt = false;
+          return object_uploader_(session_handle.session_uri, 0,
+                                  already_uploaded, chunk.filename, chunk.size,
+                                  gcs_path);
+        },
+        retry_config_);
+    if (upload_status.code() == errors::Code::NOT_FOUND) {
+      // As in SyncImpl(), rely on the RetryingFileSystem to retry the Sync()
+      // call, which uploads the chunk again.
+      return errors::Unavailable(
+          strings::StrCat("Upload to ", gcs_path,
+                          " failed, caused by: ", upload_status.ToString()));
+    }
+    return upload_status;
+  }
+
+  /// Uploads the rest of the file as the last chunk so far and composes all
+  /// the chunks into the object.
+  Status SyncChunks() {
+    uint64 size;
+    TF_RETURN_IF_ERROR(GetCurrentFileSize(&size));
+    if (size > 0) {
+      TF_RETURN_IF_ERROR(StartChunkUpload());
+    }
+    // Chunks whose upload failed are still on local disk, retry them.
+    WaitForChunkUploads().IgnoreError();
+    std::vector<size_t> failed;
+    std::vector<string> sources;
+    {
+      mutex_lock l(upload_mu_);
+      for (size_t i = 0; i < chunks_.size(); ++i) {
+        if (!chunks_[i].uploaded) {
+          failed.push_back(i);
+        }
+        sources.push_back(chunks_[i].object);
+      }
+    }
+    for (size_t index : failed) {
+      ScheduleChunkUpload(index);
+    }
+    TF_RETURN_IF_ERROR(WaitForChunkUploads());
+    TF_RETURN_IF_ERROR(ComposeChunks(std::move(sources)));
+    // Erase the file from the file cache on every successful write.
+    file_cache_erase_();
+    return Status::OK();
+  }
+
+  /// Composes the sources into the object, first composing them into
+  /// intermediate objects while there are more than a compose request takes.
+  Status ComposeChunks(std::vector<string> sources) {
+    std::vector<string> intermediates;
+    Status status;
+    for (int level = 0; status.ok() && sources.size() > kMaxComposeSources;
+         ++level) {
+      std::vector<string> targets;
+      for (size_t i = 0; status.ok() && i < sources.size();
+           i += kMaxComposeSources) {
+        const size_t end = std::min(sources.size(), i + kMaxComposeSources);
+        if (end - i == 1) {
+          targets.push_back(sources[i]);
+          continue;
+        }
+        const string target = TmpComposeObject(
+            strings::StrCat("compose", level, ".", i / kMaxComposeSources));
+        status = ComposeObjects(
+            std::vector<string>(sources.begin() + i, sources.begin() + end),
+            target);
+        if (status.ok()) {
+          intermediates.push_back(target);
+          targets.push_back(target);
+        }
+      }
+      sources.swap(targets);
+    }
+    if (status.ok()) {
+      status = ComposeObjects(sources, object_);
+    }
+    for (const string& intermediate : intermediates) {
+      status.Update(DeleteObject(intermediate));
+    }
+    return status;
+  }
+
+  /// Overwrites target with the concatenation of the source objects.
+  Status ComposeObjects(const std::vector<string>& sources,
+                        const string& target) {
+    VLOG(3) << "ComposeObjects: " << sources.size() << " objects to "
+            << GetGcsPathWithObject(target);
+    string request_body = "{'sourceObjects': [";
+    for (size_t i = 0; i < sources.size(); ++i) {
+      strings::StrAppend(&request_body, i > 0 ? "," : "", "{'name': '",
+                         sources[i], "'}");
+    }
+    strings::StrAppend(&request_body, "]}");
+    return RetryingUtils::CallWithRetries(
+        [&request_body, &target, this]() {
+          std::unique_ptr<HttpRequest> request;
+          TF_RETURN_IF_ERROR(filesystem_->CreateHttpRequest(&request));
+          request->SetUri(strings::StrCat(kGcsUriBase, "b/", bucket_, "/o/",
+                                          request->EscapeString(target),
+                                          "/compose"));
+          request->SetTimeouts(timeouts_->connect, timeouts_->idle,
+                               timeouts_->metadata);
+          request->AddHeader("content-type", "application/json");
+          request->SetPostFromBuffer(request_body.c_str(), request_body.size());
+          TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(),
+                                          " when composing to ",
+                                          GetGcsPathWithObject(target));
+          return Status::OK();
+        },
+        retry_config_);
+  }
+
+  /// Deletes the temporary objects of the chunks once the object is complete.
+  Status DeleteChunkObjects() {
+    std::vector<Chunk> chunks;
+    {
+      mutex_lock l(upload_mu_);
+      chunks.swap(chunks_);
+    }
+    Status status;
+    for (const Chunk& chunk : chunks) {
+      status.Update(DeleteObject(chunk.object));
+    }
+    return status;
+  }
+
+  Status DeleteObject(const string& object) {
+    const string object_path = GetGcsPathWithObject(object);
+    return RetryingUtils::DeleteWithRetries(
+        [&object_path, this]() {
+          return filesystem_->DeleteFile(object_path, nullptr);
+        },
+        retry_config_);
+  }
+
+  string TmpComposeObject(const string& suffix) const {
+    return strings::StrCat(io::Dirname(object_), "/.tmpcompose/",
+                           io::Basename(object_), ".", suffix);
+  }
+
   string GetGcsPathWithObject(string object) const {
     return strings::StrCat("gs://", bucket_, "/", object);
   }
@@ -726,6 +1026,16 @@ class GcsWritableFile : public WritableFile {
   RetryConfig retry_config_;
   bool compose_append_;
   uint64 start_offset_;
+  // Parallel composite uploads: the chunk size, 0 if disabled, the pool the
+  // chunks are uploaded on and the offset of the local file in the object.
+  const size_t parallel_upload_chunk_size_;
+  thread::ThreadPool* const upload_pool_;  // Not owned.
+  uint64 chunk_start_ = 0;
+  mutex upload_mu_;
+  condition_variable upload_cv_;
+  std::vector<Chunk> chunks_ TF_GUARDED_BY(upload_mu_);
+  int pending_uploads_ TF_GUARDED_BY(upload_mu_) = 0;
+  Status upload_status_ TF_GUARDED_BY(upload_mu_);
   // Callbacks to the file system used to upload object into GCS.
   const SessionCreator session_creator_;
   const ObjectUploader object_uploader_;
@@ -799,12 +1109,17 @@ GcsFileSystem::GcsFileSystem(bool make_default_cache) {
   if (GetEnvVar(kMaxStaleness, strings::safe_strtou64, &value)) {
     max_staleness = value;
   }
+
+  if (GetEnvVar(kMaxReadaheadBlocks, strings::safe_strtou64, &value)) {
+    max_readahead_blocks_ = value;
+  }
   if (!make_default_cache) {
     max_bytes = 0;
   }
   VLOG(1) << "GCS cache max size = " << max_bytes << " ; "
           << "block size = " << block_size_ << " ; "
-          << "max staleness = " << max_staleness;
+          << "max staleness = " << max_staleness << " ; "
+          << "max readahead blocks = " << max_readahead_blocks_;
   file_block_cache_ = MakeFileBlockCache(block_size_, max_bytes, max_staleness);
   // Apply overrides for the stat cache max age and max entries, if provided.
   uint64 stat_cache_max_age = kStatCacheDefaultMaxAge;
@@ -925,6 +1240,14 @@ GcsFileSystem::GcsFileSystem(bool make_default_cache) {
   } else {
     compose_append_ = false;
   }
+
+  uint64 chunk_size_mb;
+  if (GetEnvVar(kParallelUploadChunkSize, strings::safe_strtou64,
+                &chunk_size_mb)) {
+    int64 num_threads = kDefaultParallelUploadThreads;
+    GetEnvVar(kParallelUploadThreads, strings::safe_strto64, &num_threads);
+    SetParallelUploads(chunk_size_mb * 1024 * 1024, num_threads);
+  }
 }
 
 GcsFileSystem::GcsFileSystem(
@@ -979,6 +1302,7 @@ Status GcsFileSystem::NewRandomAccessFile(
             << "File signature has been changed. Refreshing the cache. Path: "
             << fname;
       }
+      file_block_cache_->SetFileSize(fname, stat.base.length);
       *result = StringPiece();
       size_t bytes_transferred;
       TF_RETURN_IF_ERROR(file_block_cache_->Read(fname, offset, n, scratch,
@@ -1032,7 +1356,8 @@ std::unique_ptr<FileBlockCache> GcsFileSystem::MakeFileBlockCache(
              size_t* bytes_transferred) {
         return LoadBufferFromGCS(filename, offset, n, buffer,
                                  bytes_transferred);
-      }));
+      },
+      Env::Default(), max_readahead_blocks_));
 
   // Check if cache is enabled here to avoid unnecessary mutex contention.
   cache_enabled_ = file_block_cache->IsCacheEnabled();
@@ -1298,8 +1623,8 @@ Status GcsFileSystem::NewWritableFile(const string& fname,
   result->reset(new GcsWritableFile(
       bucket, object, this, &timeouts_,
       [this, fname]() { ClearFileCaches(fname); }, retry_config_,
-      compose_append_, session_creator, object_uploader, status_poller,
-      generation_getter));
+      compose_append_, parallel_upload_chunk_size_, upload_pool_.get(),
+      session_creator, object_uploader, status_poller, generation_getter));
   return Status::OK();
 }
 
@@ -1378,8 +1703,8 @@ Status GcsFileSystem::NewAppendableFile(const string& fname,
   result->reset(new GcsWritableFile(
       bucket, object, this, old_content_filename, &timeouts_,
       [this, fname]() { ClearFileCaches(fname); }, retry_config_,
-      compose_append_, session_creator, object_uploader, status_poller,
-      generation_getter));
+      compose_append_, parallel_upload_chunk_size_, upload_pool_.get(),
+      session_creator, object_uploader, status_poller, generation_getter));
   return Status::OK();
 }
 
@@ -2084,6 +2409,15 @@ void GcsFileSystem::SetCacheStats(FileBlockCacheStatsInterface* cache_stats) {
   file_block_cache_->SetStats(cache_stats);
 }
 
+void GcsFileSystem::SetParallelUploads(size_t chunk_size, int num_threads) {
+  upload_pool_.reset();
+  parallel_upload_chunk_size_ = num_threads > 0 ? chunk_size : 0;
+  if (parallel_upload_chunk_size_ > 0) {
+    upload_pool_.reset(
+        new thread::ThreadPool(Env::Default(), "gcs_upload", num_threads));
+  }
+}
+
 void GcsFileSystem::SetAuthProvider(
     std::unique_ptr<AuthProvider> auth_provider) {
   mutex_lock l(mu_);
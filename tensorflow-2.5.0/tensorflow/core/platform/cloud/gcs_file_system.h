@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/platform/file_system.h"
 #include "tensorflow/core/platform/retrying_file_system.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 
@@ -62,6 +63,11 @@ constexpr size_t kDefaultMaxCacheSize = 0;
 // will be evicted on the next read.
 constexpr char kMaxStaleness[] = "GCS_READ_CACHE_MAX_STALENESS";
 constexpr uint64 kDefaultMaxStaleness = 0;
+// The environment variable that overrides the maximum number of blocks fetched
+// ahead of sequential reads through the block cache, in parallel. Read-ahead
+// is disabled by default.
+constexpr char kMaxReadaheadBlocks[] = "GCS_READ_CACHE_MAX_READAHEAD_BLOCKS";
+constexpr size_t kDefaultMaxReadaheadBlocks = 0;
 
 // Helper function to extract an environment variable and convert it into a
 // value of type T.
@@ -195,6 +201,14 @@ class GcsFileSystem : public FileSystem {
   /// Set an object to collect file block cache stats.
   void SetCacheStats(FileBlockCacheStatsInterface* cache_stats);
 
+  /// \brief Enables parallel composite uploads for new writable files.
+  ///
+  /// Writable files cut into chunks of `chunk_size` bytes, which are uploaded
+  /// by `num_threads` threads as temporary objects while writing continues
+  /// and composed into the target object on Sync(). A `chunk_size` of 0
+  /// disables parallel uploads. Must be called before any file is opened.
+  void SetParallelUploads(size_t chunk_size, int num_threads);
+
   /// These accessors are mainly for testing purposes, to verify that the
   /// environment variables that control these parameters are handled correctly.
   size_t block_size() {
@@ -215,6 +229,9 @@ class GcsFileSystem : public FileSystem {
   }
 
   bool compose_append() const { return compose_append_; }
+  size_t parallel_upload_chunk_size() const {
+    return parallel_upload_chunk_size_;
+  }
   string additional_header_name() const {
     return additional_header_ ? additional_header_->first : "";
   }
@@ -415,6 +432,10 @@ class GcsFileSystem : public FileSystem {
   // Reads smaller than block_size_ will trigger a read of block_size_.
   uint64 block_size_;
 
+  // The maximum number of blocks the block cache fetches ahead of sequential
+  // reads.
+  size_t max_readahead_blocks_ = kDefaultMaxReadaheadBlocks;
+
   // block_cache_lock_ protects the file_block_cache_ pointer (Note that
   // FileBlockCache instances are themselves threadsafe).
   mutex block_cache_lock_;
@@ -441,6 +462,11 @@ class GcsFileSystem : public FileSystem {
   // Additional header material to be transmitted with all GCS requests
   std::unique_ptr<std::pair<const string, const string>> additional_header_;
 
+  // Chunk size of parallel composite uploads, 0 if they are disabled, and the
+  // pool the chunks are uploaded on.
+  size_t parallel_upload_chunk_size_ = 0;
+  std::unique_ptr<thread::ThreadPool> upload_pool_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(GcsFileSystem);
 };
 
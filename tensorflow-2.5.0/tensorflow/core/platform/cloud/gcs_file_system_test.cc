@@ -1323,6 +1323,92 @@ TEST(GcsFileSystemTest, NewWritableFile_UploadReturns410) {
   EXPECT_EQ(tmp_files_before, results.size());
 }
 
+TEST(GcsFileSystemTest, NewWritableFile_ParallelCompositeUpload) {
+  // The file is cut into chunks of 9 bytes, uploaded to temporary objects and
+  // composed into the object on close.
+  const std::vector<std::pair<string, string>> chunks(
+      {{"0", "content1,"}, {"9", "content2,"}, {"18", "tail"}});
+  std::vector<HttpRequest*> requests;
+  for (const auto& chunk : chunks) {
+    requests.push_back(new FakeHttpRequest(
+        strings::StrCat("Uri: https://www.googleapis.com/upload/storage/v1/b/"
+                        "bucket/o?uploadType=resumable&name=path%2F.tmpcompose"
+                        "%2Fwriteable.",
+                        chunk.first,
+                        "\n"
+                        "Auth Token: fake_token\n"
+                        "Header X-Upload-Content-Length: ",
+                        chunk.second.size(),
+                        "\n"
+                        "Post: yes\n"
+                        "Timeouts: 5 1 10\n"),
+        "", {{"Location", "https://custom/upload/location"}}));
+    requests.push_back(new FakeHttpRequest(
+        strings::StrCat("Uri: https://custom/upload/location\n"
+                        "Auth Token: fake_token\n"
+                        "Header Content-Range: bytes 0-",
+                        chunk.second.size() - 1, "/", chunk.second.size(),
+                        "\n"
+                        "Timeouts: 5 1 30\n"
+                        "Put body: ",
+                        chunk.second, "\n"),
+        ""));
+  }
+  requests.push_back(new FakeHttpRequest(
+      "Uri: https://www.googleapis.com/storage/v1/b/bucket/o/"
+      "path%2Fwriteable/compose\n"
+      "Auth Token: fake_token\n"
+      "Timeouts: 5 1 10\n"
+      "Header content-type: application/json\n"
+      "Post body: {'sourceObjects': [{'name': "
+      "'path/.tmpcompose/writeable.0'},{'name': "
+      "'path/.tmpcompose/writeable.9'},{'name': "
+      "'path/.tmpcompose/writeable.18'}]}\n",
+      ""));
+  for (const auto& chunk : chunks) {
+    requests.push_back(new FakeHttpRequest(
+        strings::StrCat("Uri: https://www.googleapis.com/storage/v1/b/bucket/"
+                        "o/path%2F.tmpcompose%2Fwriteable.",
+                        chunk.first,
+                        "\n"
+                        "Auth Token: fake_token\n"
+                        "Timeouts: 5 1 10\n"
+                        "Delete: yes\n"),
+        ""));
+  }
+  GcsFileSystem fs(
+      std::unique_ptr<AuthProvider>(new FakeAuthProvider),
+      std::unique_ptr<HttpRequest::Factory>(
+          new FakeHttpRequestFactory(&requests)),
+      std::unique_ptr<ZoneProvider>(new FakeZoneProvider), 8 /* block size */,
+      0 /* max bytes */, 0 /* max staleness */, 0 /* stat cache max age */,
+      0 /* stat cache max entries */, 0 /* matching paths cache max age */,
+      0 /* matching paths cache max entries */, kTestRetryConfig,
+      kTestTimeoutConfig, *kAllowedLocationsDefault,
+      nullptr /* gcs additional header */, false /* compose append */);
+  // A single upload thread keeps the order of the requests deterministic.
+  fs.SetParallelUploads(9 /* chunk size */, 1 /* num threads */);
+
+  std::unique_ptr<WritableFile> file;
+  TF_EXPECT_OK(
+      fs.NewWritableFile("gs://bucket/path/writeable", nullptr, &file));
+  TF_EXPECT_OK(file->Append("content1,cont"));
+  TF_EXPECT_OK(file->Append("ent2,tail"));
+  int64 position;
+  TF_EXPECT_OK(file->Tell(&position));
+  EXPECT_EQ(22, position);
+  TF_EXPECT_OK(file->Close());
+}
+
+TEST(GcsFileSystemTest, ParallelUploadChunkSize) {
+  setenv("GCS_PARALLEL_UPLOAD_CHUNK_SIZE_MB", "16", 1);
+  GcsFileSystem fs1;
+  EXPECT_EQ(16 * 1024 * 1024, fs1.parallel_upload_chunk_size());
+  unsetenv("GCS_PARALLEL_UPLOAD_CHUNK_SIZE_MB");
+  GcsFileSystem fs2;
+  EXPECT_EQ(0, fs2.parallel_upload_chunk_size());
+}
+
 TEST(GcsFileSystemTest, NewWritableFile_NoObjectName) {
   std::vector<HttpRequest*> requests;
   GcsFileSystem fs(
@@ -39,13 +39,18 @@ std::shared_ptr<RamFileBlockCache::Block> RamFileBlockCache::Lookup(
       if (cache_stats_ != nullptr) {
         cache_stats_->RecordCacheHitBlockSize(entry->second->data.size());
       }
+      entry->second->readahead = false;
       return entry->second;
     } else {
       // Remove the stale block and continue.
       RemoveFile_Locked(key.first);
     }
   }
+  return Insert_Locked(key);
+}
 
+std::shared_ptr<RamFileBlockCache::Block> RamFileBlockCache::Insert_Locked(
+    const Key& key) {
   // Insert a new empty block, setting the bookkeeping to sentinel values
   // in order to update them as appropriate.
   auto new_entry = std::make_shared<Block>();
@@ -58,6 +63,59 @@ std::shared_ptr<RamFileBlockCache::Block> RamFileBlockCache::Lookup(
   return new_entry;
 }
 
+void RamFileBlockCache::FetchInBackground(const string& filename, size_t begin,
+                                          size_t end, bool readahead) {
+  std::vector<std::pair<Key, std::shared_ptr<Block>>> fetches;
+  {
+    mutex_lock lock(mu_);
+    for (size_t pos = begin; pos < end; pos += block_size_) {
+      Key key = std::make_pair(filename, pos);
+      if (block_map_.find(key) != block_map_.end()) continue;
+      std::shared_ptr<Block> block = Insert_Locked(key);
+      block->readahead = readahead;
+      fetches.emplace_back(std::move(key), std::move(block));
+    }
+  }
+  for (auto& fetch : fetches) {
+    readahead_pool_->Schedule([this, fetch]() {
+      Status status = MaybeFetch(fetch.first, fetch.second);
+      if (status.ok()) status = UpdateLRU(fetch.first, fetch.second);
+      if (!status.ok()) {
+        // The block is fetched again when it is read.
+        VLOG(1) << "Background fetch of " << fetch.first.first << " @ "
+                << fetch.first.second << " failed: " << status;
+      }
+    });
+  }
+}
+
+void RamFileBlockCache::Readahead(const string& filename, size_t offset,
+                                  size_t n, size_t finish) {
+  size_t end;
+  size_t depth;
+  {
+    mutex_lock lock(mu_);
+    auto it = readahead_state_.find(filename);
+    if (it == readahead_state_.end()) return;
+    ReadaheadState& state = it->second;
+    if (offset == state.next_offset) {
+      state.depth = std::min(std::max<size_t>(1, 2 * state.depth),
+                             max_readahead_blocks_);
+    } else {
+      state.depth = 0;
+    }
+    state.next_offset = offset + n;
+    depth = state.depth;
+    end = std::min<uint64>(finish + depth * block_size_, state.file_size);
+  }
+  if (cache_stats_ != nullptr) {
+    cache_stats_->RecordReadaheadDepth(depth);
+  }
+  if (depth > 0) {
+    FetchInBackground(filename, finish, end, /*readahead=*/true);
+  }
+}
+
 // Remove blocks from the cache until we do not exceed our maximum size.
 void RamFileBlockCache::Trim() {
   while (!lru_list_.empty() && cache_size_ > max_bytes_) {
@@ -182,6 +240,19 @@ Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
   if (finish < offset + n) {
     finish += block_size_;
   }
+  if (readahead_pool_ != nullptr && finish - start > block_size_) {
+    // Fetch the other blocks of the read in parallel with the first one, up to
+    // the end of the file if it is known.
+    size_t end = 0;
+    {
+      mutex_lock lock(mu_);
+      auto it = readahead_state_.find(filename);
+      if (it != readahead_state_.end()) {
+        end = std::min<uint64>(finish, it->second.file_size);
+      }
+    }
+    FetchInBackground(filename, start + block_size_, end, /*readahead=*/false);
+  }
   size_t total_bytes_transferred = 0;
   // Now iterate through the blocks, reading them one at a time.
   for (size_t pos = start; pos < finish; pos += block_size_) {
@@ -224,6 +295,9 @@ Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
     }
   }
   *bytes_transferred = total_bytes_transferred;
+  if (readahead_pool_ != nullptr) {
+    Readahead(filename, offset, total_bytes_transferred, finish);
+  }
   return Status::OK();
 }
 
@@ -266,12 +340,19 @@ void RamFileBlockCache::Prune() {
   }
 }
 
+void RamFileBlockCache::SetFileSize(const string& filename, uint64 file_size) {
+  if (max_readahead_blocks_ == 0) return;
+  mutex_lock lock(mu_);
+  readahead_state_[filename].file_size = file_size;
+}
+
 void RamFileBlockCache::Flush() {
   mutex_lock lock(mu_);
   block_map_.clear();
   lru_list_.clear();
   lra_list_.clear();
   cache_size_ = 0;
+  readahead_state_.clear();
 }
 
 void RamFileBlockCache::RemoveFile(const string& filename) {
@@ -280,6 +361,7 @@ void RamFileBlockCache::RemoveFile(const string& filename) {
 }
 
 void RamFileBlockCache::RemoveFile_Locked(const string& filename) {
+  readahead_state_.erase(filename);
   Key begin = std::make_pair(filename, 0);
   auto it = block_map_.lower_bound(begin);
   while (it != block_map_.end() && it->first.first == filename) {
@@ -293,6 +375,9 @@ void RamFileBlockCache::RemoveBlock(BlockMap::iterator entry) {
   // This signals that the block is removed, and should not be inadvertently
   // reinserted into the cache in UpdateLRU.
   entry->second->timestamp = 0;
+  if (entry->second->readahead && cache_stats_ != nullptr) {
+    cache_stats_->RecordUnusedReadaheadBytes(entry->second->data.size());
+  }
   lru_list_.erase(entry->second->lru_iterator);
   lra_list_.erase(entry->second->lra_iterator);
   cache_size_ -= entry->second->data.capacity();
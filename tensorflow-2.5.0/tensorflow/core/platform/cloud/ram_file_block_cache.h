@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_PLATFORM_CLOUD_RAM_FILE_BLOCK_CACHE_H_
 #define TENSORFLOW_CORE_PLATFORM_CLOUD_RAM_FILE_BLOCK_CACHE_H_
 
+#include <algorithm>
 #include <functional>
 #include <list>
 #include <map>
@@ -30,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/stringpiece.h"
 #include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
@@ -38,6 +40,12 @@ namespace tensorflow {
 ///
 /// This class should be shared by read-only random access files on a remote
 /// filesystem (e.g. GCS).
+///
+/// If `max_readahead_blocks` is positive, the cache detects sequential reads of
+/// files whose size was given to SetFileSize, and fetches up to that many
+/// blocks ahead of them in the background. The read-ahead depth doubles with
+/// each sequential read and drops back to zero on a seek. Reads that span
+/// several missing blocks of such files also fetch the blocks in parallel.
 class RamFileBlockCache : public FileBlockCache {
  public:
   /// The callback executed when a block is not found in the cache, and needs to
@@ -51,21 +59,34 @@ class RamFileBlockCache : public FileBlockCache {
       BlockFetcher;
 
   RamFileBlockCache(size_t block_size, size_t max_bytes, uint64 max_staleness,
-                    BlockFetcher block_fetcher, Env* env = Env::Default())
+                    BlockFetcher block_fetcher, Env* env = Env::Default(),
+                    size_t max_readahead_blocks = 0)
       : block_size_(block_size),
         max_bytes_(max_bytes),
         max_staleness_(max_staleness),
         block_fetcher_(block_fetcher),
-        env_(env) {
+        env_(env),
+        // Leave at least half of the cache to the blocks being read.
+        max_readahead_blocks_(
+            IsCacheEnabled()
+                ? std::min(max_readahead_blocks, max_bytes / (2 * block_size))
+                : 0) {
     if (max_staleness_ > 0) {
       pruning_thread_.reset(env_->StartThread(ThreadOptions(), "TF_prune_FBC",
                                               [this] { Prune(); }));
     }
+    if (max_readahead_blocks_ > 0) {
+      readahead_pool_.reset(new thread::ThreadPool(
+          env_, "TF_readahead_FBC", static_cast<int>(max_readahead_blocks_)));
+    }
     VLOG(1) << "GCS file block cache is "
-            << (IsCacheEnabled() ? "enabled" : "disabled");
+            << (IsCacheEnabled() ? "enabled" : "disabled")
+            << ", read-ahead of up to " << max_readahead_blocks_ << " blocks";
   }
 
   ~RamFileBlockCache() override {
+    // Wait for the background fetches, which use the cache.
+    readahead_pool_.reset();
     if (pruning_thread_) {
       stop_pruning_thread_.Notify();
       // Destroying pruning_thread_ will block until Prune() receives the above
@@ -99,6 +120,9 @@ class RamFileBlockCache : public FileBlockCache {
                                       int64 file_signature) override
       TF_LOCKS_EXCLUDED(mu_);
 
+  void SetFileSize(const string& filename, uint64 file_size) override
+      TF_LOCKS_EXCLUDED(mu_);
+
   /// Remove all cached blocks for `filename`.
   void RemoveFile(const string& filename) override TF_LOCKS_EXCLUDED(mu_);
 
@@ -131,6 +155,8 @@ class RamFileBlockCache : public FileBlockCache {
   const BlockFetcher block_fetcher_;
   /// The Env from which we read timestamps.
   Env* const env_;  // not owned
+  /// The maximum number of blocks fetched ahead of sequential reads.
+  const size_t max_readahead_blocks_;
 
   /// \brief The key type for the file block cache.
   ///
@@ -175,6 +201,8 @@ class RamFileBlockCache : public FileBlockCache {
     std::list<Key>::iterator lra_iterator;
     /// The timestamp (seconds since epoch) at which the block was cached.
     uint64 timestamp;
+    /// Whether the block was fetched ahead of a read, and not read since.
+    bool readahead = false;
     /// Mutex to guard state variable
     mutex mu;
     /// The state of the block.
@@ -197,6 +225,21 @@ class RamFileBlockCache : public FileBlockCache {
   /// Look up a Key in the block cache.
   std::shared_ptr<Block> Lookup(const Key& key) TF_LOCKS_EXCLUDED(mu_);
 
+  /// Insert a new, not yet fetched block for `key` into the block cache.
+  std::shared_ptr<Block> Insert_Locked(const Key& key)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Fetch the blocks of `filename` in [`begin`, `end`) that aren't cached on
+  /// the read-ahead thread pool.
+  void FetchInBackground(const string& filename, size_t begin, size_t end,
+                         bool readahead) TF_LOCKS_EXCLUDED(mu_);
+
+  /// Update the read-ahead state of `filename` after a successful read of
+  /// `n` bytes at `offset`, whose blocks end at `finish`, and fetch the blocks
+  /// after it if the file is read sequentially.
+  void Readahead(const string& filename, size_t offset, size_t n,
+                 size_t finish) TF_LOCKS_EXCLUDED(mu_);
+
   Status MaybeFetch(const Key& key, const std::shared_ptr<Block>& block)
       TF_LOCKS_EXCLUDED(mu_);
 
@@ -221,6 +264,9 @@ class RamFileBlockCache : public FileBlockCache {
   /// Notification for stopping the cache pruning thread.
   Notification stop_pruning_thread_;
 
+  /// The threads that fetch blocks ahead of reads, if read-ahead is enabled.
+  std::unique_ptr<thread::ThreadPool> readahead_pool_;
+
   /// Guards access to the block map, LRU list, and cached byte count.
   mutable mutex mu_;
 
@@ -243,6 +289,16 @@ class RamFileBlockCache : public FileBlockCache {
 
   // A filename->file_signature map.
   std::map<string, int64> file_signature_map_ TF_GUARDED_BY(mu_);
+
+  /// The read-ahead state of a file of known size.
+  struct ReadaheadState {
+    uint64 file_size;
+    /// The offset a sequential read would start at.
+    size_t next_offset = 0;
+    /// The number of blocks fetched ahead of the last read.
+    size_t depth = 0;
+  };
+  std::map<string, ReadaheadState> readahead_state_ TF_GUARDED_BY(mu_);
 };
 
 }  // namespace tensorflow
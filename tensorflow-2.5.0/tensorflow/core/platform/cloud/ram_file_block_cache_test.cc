@@ -15,12 +15,14 @@ limitations under the License.
 
 #include "tensorflow/core/platform/cloud/ram_file_block_cache.h"
 
+#include <algorithm>
 #include <cstring>
 
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/cloud/now_seconds_env.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/test.h"
 
@@ -566,5 +568,98 @@ TEST(RamFileBlockCacheTest, Flush) {
   EXPECT_EQ(calls, 2);
 }
 
+TEST(RamFileBlockCacheTest, ReadaheadFetchesEachBlockOnce) {
+  const size_t block_size = 8;
+  const size_t file_size = 9 * block_size + 4;
+  mutex mu;
+  std::vector<size_t> offsets;
+  auto fetcher = [&](const string& filename, size_t offset, size_t n,
+                     char* buffer, size_t* bytes_transferred) {
+    EXPECT_LT(offset, file_size);
+    {
+      mutex_lock l(mu);
+      offsets.push_back(offset);
+    }
+    *bytes_transferred = std::min(n, file_size - offset);
+    memset(buffer, 'x', *bytes_transferred);
+    return Status::OK();
+  };
+  {
+    RamFileBlockCache cache(block_size, 16 * block_size, 0, fetcher,
+                            Env::Default(), /*max_readahead_blocks=*/4);
+    cache.SetFileSize("a", file_size);
+    std::vector<char> out;
+    for (size_t offset = 0; offset < file_size; offset += block_size) {
+      Status status = ReadCache(&cache, "a", offset, block_size, &out);
+      EXPECT_TRUE(status.ok() || (offset + block_size > file_size)) << status;
+      EXPECT_EQ(out, std::vector<char>(std::min(block_size, file_size - offset),
+                                       'x'));
+    }
+    // Destroying the cache waits for the background fetches.
+  }
+  std::sort(offsets.begin(), offsets.end());
+  std::vector<size_t> want;
+  for (size_t offset = 0; offset < file_size; offset += block_size) {
+    want.push_back(offset);
+  }
+  EXPECT_EQ(offsets, want);
+}
+
+TEST(RamFileBlockCacheTest, NoReadaheadWithoutFileSizeOrOnSeeks) {
+  const size_t block_size = 8;
+  mutex mu;
+  int calls = 0;
+  auto fetcher = [&](const string& filename, size_t offset, size_t n,
+                     char* buffer, size_t* bytes_transferred) {
+    {
+      mutex_lock l(mu);
+      calls++;
+    }
+    memset(buffer, 'x', n);
+    *bytes_transferred = n;
+    return Status::OK();
+  };
+  {
+    RamFileBlockCache cache(block_size, 16 * block_size, 0, fetcher,
+                            Env::Default(), /*max_readahead_blocks=*/4);
+    std::vector<char> out;
+    // The size of "a" is unknown.
+    TF_EXPECT_OK(ReadCache(&cache, "a", 0, block_size, &out));
+    TF_EXPECT_OK(ReadCache(&cache, "a", block_size, block_size, &out));
+    // Each read of "b" is a seek.
+    cache.SetFileSize("b", 100 * block_size);
+    for (int block : {5, 0, 3, 9}) {
+      TF_EXPECT_OK(
+          ReadCache(&cache, "b", block * block_size, block_size, &out));
+    }
+  }
+  EXPECT_EQ(calls, 6);
+}
+
+TEST(RamFileBlockCacheTest, LargeReadFetchesBlocksInParallel) {
+  // This fetcher won't respond until all the blocks of the read are being
+  // fetched concurrently, or 10 seconds have elapsed.
+  const int num_blocks = 3;
+  const size_t block_size = 8;
+  BlockingCounter counter(num_blocks);
+  auto fetcher = [&counter](const string& filename, size_t offset, size_t n,
+                            char* buffer, size_t* bytes_transferred) {
+    counter.DecrementCount();
+    if (!counter.WaitFor(std::chrono::seconds(10))) {
+      return errors::FailedPrecondition("desired concurrency not reached");
+    }
+    memset(buffer, 'x', n);
+    *bytes_transferred = n;
+    return Status::OK();
+  };
+  RamFileBlockCache cache(block_size, 16 * block_size, 0, fetcher,
+                          Env::Default(),
+                          /*max_readahead_blocks=*/num_blocks - 1);
+  cache.SetFileSize("a", num_blocks * block_size);
+  std::vector<char> out;
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, num_blocks * block_size, &out));
+  EXPECT_EQ(out, std::vector<char>(num_blocks * block_size, 'x'));
+}
+
 }  // namespace
 }  // namespace tensorflow
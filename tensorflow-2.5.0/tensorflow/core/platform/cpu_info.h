@@ -64,6 +64,10 @@ int NumTotalCPUs();
 // identified.  If successful, the return value will be in [0, NumTotalCPUs()).
 int GetCurrentCPU();
 
+// Restricts the calling thread to run on the CPU with the given id, in
+// [0, NumTotalCPUs()). Returns false if that is unsupported or fails.
+bool SetCurrentThreadCPUAffinity(int cpu);
+
 // Returns an estimate of the number of hyperthreads per physical core
 // on the CPU
 int NumHyperthreadsPerCore();
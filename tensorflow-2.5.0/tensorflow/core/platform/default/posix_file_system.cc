@@ -22,6 +22,16 @@ limitations under the License.
 
 #if defined(__linux__)
 #include <sys/sendfile.h>
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define TF_POSIX_HAS_IO_URING 1
+#endif
+#endif
+#endif
 #endif
 #include <sys/stat.h>
 #include <sys/time.h>
@@ -29,12 +39,19 @@ limitations under the License.
 #include <time.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
 #include "tensorflow/core/platform/default/posix_file_system.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/error.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/file_system_helper.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/strcat.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
@@ -44,19 +61,290 @@ namespace tensorflow {
 // 128KB of copy buffer
 constexpr size_t kPosixCopyFileBufferSize = 128 * 1024;
 
+#if defined(__linux__) && defined(O_DIRECT)
+#define TF_POSIX_HAS_DIRECT_IO 1
+namespace {
+// The environment variable that makes NewRandomAccessFile() also open the file
+// with O_DIRECT (format: "1" or "true"). Reads whose offset, length and buffer
+// are all multiples of kPosixDirectIOAlignment then bypass the page cache;
+// other reads use the regular file descriptor.
+constexpr char kUseDirectIO[] = "TF_POSIX_USE_DIRECT_IO";
+constexpr uint64 kPosixDirectIOAlignment = 4096;
+
+bool UseDirectIO() {
+  static const bool use_direct_io = []() {
+    const char* value = std::getenv(kUseDirectIO);
+    return value != nullptr &&
+           (strcmp(value, "1") == 0 || strcmp(value, "true") == 0);
+  }();
+  return use_direct_io;
+}
+}  // namespace
+#endif  // defined(__linux__) && defined(O_DIRECT)
+
+#if defined(TF_POSIX_HAS_IO_URING)
+namespace {
+
+// The environment variable that makes PosixRandomAccessFile::ReadAsync()
+// submit the reads to an io_uring instead of calling pread() for each of them
+// (format: "1" or "true"). If the kernel does not support io_uring, the pread()
+// path is used.
+constexpr char kUseIoUring[] = "TF_POSIX_USE_IO_URING";
+// The number of submission queue entries of the ring.
+constexpr unsigned kIoUringEntries = 256;
+
+// A process-wide io_uring running reads, with a thread reaping completions.
+class IoUring {
+ public:
+  // Called with the result of a read: the number of bytes read, or -errno.
+  typedef std::function<void(int64)> Callback;
+
+  struct Read {
+    int fd;
+    char* buffer;
+    size_t n;
+    uint64 offset;
+    Callback callback;
+  };
+
+  // Returns the ring, or nullptr if it is disabled or unavailable.
+  static IoUring* Get() {
+    static IoUring* ring = []() -> IoUring* {
+      const char* use_io_uring = std::getenv(kUseIoUring);
+      if (use_io_uring == nullptr || (strcmp(use_io_uring, "1") != 0 &&
+                                      strcmp(use_io_uring, "true") != 0)) {
+        return nullptr;
+      }
+      IoUring* ring = new IoUring;
+      if (!ring->Init()) {
+        delete ring;
+        return nullptr;
+      }
+      return ring;
+    }();
+    return ring;
+  }
+
+  // Submits the reads, blocking while the ring has as many reads in flight as
+  // its completion queue holds. The callbacks are called from the reaper
+  // thread, and must not block on other reads.
+  void Submit(std::vector<Read>* reads) {
+    std::vector<std::pair<Op*, int>> failed;
+    {
+      mutex_lock l(mu_);
+      size_t i = 0;
+      while (i < reads->size()) {
+        while (in_flight_ >= cq_entries_) {
+          cv_.wait(l);
+        }
+        // The submission queue is empty: the kernel consumes the entries in
+        // io_uring_enter(), which is only called with mu_ held.
+        const unsigned tail = *sq_tail_;
+        unsigned count = 0;
+        while (i < reads->size() && count < sq_entries_ &&
+               in_flight_ + count < cq_entries_) {
+          Read& read = (*reads)[i++];
+          Op* op = new Op{{read.buffer, read.n}, std::move(read.callback)};
+          const unsigned index = (tail + count) & sq_mask_;
+          io_uring_sqe* sqe = &sqes_[index];
+          memset(sqe, 0, sizeof(*sqe));
+          sqe->opcode = IORING_OP_READV;
+          sqe->fd = read.fd;
+          sqe->addr = reinterpret_cast<uint64>(&op->iov);
+          sqe->len = 1;
+          sqe->off = read.offset;
+          sqe->user_data = reinterpret_cast<uint64>(op);
+          sq_array_[index] = index;
+          ++count;
+        }
+        __atomic_store_n(sq_tail_, tail + count, __ATOMIC_RELEASE);
+        unsigned submitted = 0;
+        int error = 0;
+        while (submitted < count) {
+          const int r = syscall(__NR_io_uring_enter, ring_fd_,
+                                count - submitted, 0, 0, nullptr, 0);
+          if (r >= 0) {
+            submitted += r;
+          } else if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            error = errno;
+            break;
+          }
+        }
+        if (submitted < count) {
+          // Takes back the entries the kernel did not consume.
+          LOG(ERROR) << "io_uring_enter() failed: " << strerror(error);
+          for (unsigned j = submitted; j < count; ++j) {
+            const io_uring_sqe& sqe = sqes_[(tail + j) & sq_mask_];
+            failed.emplace_back(reinterpret_cast<Op*>(sqe.user_data), -error);
+          }
+          __atomic_store_n(sq_tail_, tail + submitted, __ATOMIC_RELEASE);
+        }
+        in_flight_ += submitted;
+      }
+    }
+    for (const auto& op_and_result : failed) {
+      op_and_result.first->callback(op_and_result.second);
+      delete op_and_result.first;
+    }
+  }
+
+ private:
+  // A submitted read.
+  struct Op {
+    struct iovec iov;
+    Callback callback;
+  };
+
+  IoUring() = default;
+
+  ~IoUring() {
+    if (sqes_ != nullptr) munmap(sqes_, sq_entries_ * sizeof(io_uring_sqe));
+    if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+      munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_ != nullptr) munmap(sq_ring_, sq_ring_size_);
+    if (ring_fd_ >= 0) close(ring_fd_);
+  }
+
+  bool Init() {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring_fd_ = syscall(__NR_io_uring_setup, kIoUringEntries, &params);
+    if (ring_fd_ < 0) {
+      LOG(WARNING) << "io_uring is not available, reading files with pread(): "
+                   << strerror(errno);
+      return false;
+    }
+    sq_entries_ = params.sq_entries;
+    cq_entries_ = params.cq_entries;
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ =
+        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+      sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    }
+    sq_ring_ = Map(sq_ring_size_, IORING_OFF_SQ_RING);
+    if (sq_ring_ == nullptr) return false;
+    cq_ring_ = single_mmap ? sq_ring_ : Map(cq_ring_size_, IORING_OFF_CQ_RING);
+    if (cq_ring_ == nullptr) return false;
+    sqes_ = static_cast<io_uring_sqe*>(
+        Map(sq_entries_ * sizeof(io_uring_sqe), IORING_OFF_SQES));
+    if (sqes_ == nullptr) return false;
+
+    char* sq = static_cast<char*>(sq_ring_);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    char* cq = static_cast<char*>(cq_ring_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    reaper_.reset(Env::Default()->StartThread(
+        ThreadOptions(), "io_uring_reaper", [this]() { ReapCompletions(); }));
+    return true;
+  }
+
+  void* Map(size_t size, off_t offset) {
+    void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, ring_fd_, offset);
+    if (ptr == MAP_FAILED) {
+      LOG(WARNING) << "Could not map the io_uring, reading files with "
+                      "pread(): "
+                   << strerror(errno);
+      return nullptr;
+    }
+    return ptr;
+  }
+
+  // Waits for completions and calls their callbacks, forever.
+  void ReapCompletions() {
+    std::vector<std::pair<Op*, int>> completed;
+    while (true) {
+      if (syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS,
+                  nullptr, 0) < 0 &&
+          errno != EINTR) {
+        LOG(ERROR) << "io_uring_enter() failed: " << strerror(errno);
+        Env::Default()->SleepForMicroseconds(1000);
+      }
+      unsigned head = *cq_head_;
+      const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+      for (; head != tail; ++head) {
+        const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+        completed.emplace_back(reinterpret_cast<Op*>(cqe.user_data), cqe.res);
+      }
+      __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+      if (completed.empty()) continue;
+      {
+        mutex_lock l(mu_);
+        in_flight_ -= completed.size();
+      }
+      cv_.notify_all();
+      for (const auto& op_and_result : completed) {
+        op_and_result.first->callback(op_and_result.second);
+        delete op_and_result.first;
+      }
+      completed.clear();
+    }
+  }
+
+  int ring_fd_ = -1;
+  unsigned sq_entries_ = 0;
+  unsigned cq_entries_ = 0;
+  size_t sq_ring_size_ = 0;
+  size_t cq_ring_size_ = 0;
+  void* sq_ring_ = nullptr;
+  void* cq_ring_ = nullptr;
+  io_uring_sqe* sqes_ = nullptr;
+  unsigned* sq_tail_ = nullptr;
+  unsigned sq_mask_ = 0;
+  unsigned* sq_array_ = nullptr;
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  unsigned cq_mask_ = 0;
+  io_uring_cqe* cqes_ = nullptr;
+  std::unique_ptr<Thread> reaper_;
+
+  mutex mu_;
+  condition_variable cv_;
+  unsigned in_flight_ TF_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace
+#endif  // TF_POSIX_HAS_IO_URING
+
 // pread() based random-access
 class PosixRandomAccessFile : public RandomAccessFile {
  private:
   string filename_;
   int fd_;
+  // A descriptor of the same file opened with O_DIRECT, or -1.
+  int direct_fd_;
+
+  // Returns the descriptor to read n bytes at offset into dst with.
+  int ReadFd(uint64 offset, size_t n, const char* dst) const {
+#if defined(TF_POSIX_HAS_DIRECT_IO)
+    if (direct_fd_ >= 0 && offset % kPosixDirectIOAlignment == 0 &&
+        n % kPosixDirectIOAlignment == 0 &&
+        reinterpret_cast<uintptr_t>(dst) % kPosixDirectIOAlignment == 0) {
+      return direct_fd_;
+    }
+#endif
+    return fd_;
+  }
 
  public:
-  PosixRandomAccessFile(const string& fname, int fd)
-      : filename_(fname), fd_(fd) {}
+  PosixRandomAccessFile(const string& fname, int fd, int direct_fd = -1)
+      : filename_(fname), fd_(fd), direct_fd_(direct_fd) {}
   ~PosixRandomAccessFile() override {
     if (close(fd_) < 0) {
       LOG(ERROR) << "close() failed: " << strerror(errno);
     }
+    if (direct_fd_ >= 0 && close(direct_fd_) < 0) {
+      LOG(ERROR) << "close() failed: " << strerror(errno);
+    }
   }
 
   Status Name(StringPiece* result) const override {
@@ -77,8 +365,13 @@ class PosixRandomAccessFile : public RandomAccessFile {
       } else {
         requested_read_length = n;
       }
+      const int fd = ReadFd(offset, requested_read_length, dst);
       ssize_t r =
-          pread(fd_, dst, requested_read_length, static_cast<off_t>(offset));
+          pread(fd, dst, requested_read_length, static_cast<off_t>(offset));
+      if (r < 0 && errno == EINVAL && fd != fd_) {
+        // The file system rejected the direct read, read through the cache.
+        r = pread(fd_, dst, requested_read_length, static_cast<off_t>(offset));
+      }
       if (r > 0) {
         dst += r;
         n -= r;
@@ -95,6 +388,68 @@ class PosixRandomAccessFile : public RandomAccessFile {
     return s;
   }
 
+#if defined(TF_POSIX_HAS_IO_URING)
+  void ReadAsync(std::vector<ReadRequest>* requests,
+                 std::function<void()> done) const override {
+    IoUring* ring = IoUring::Get();
+    if (ring == nullptr || requests->empty()) {
+      RandomAccessFile::ReadAsync(requests, std::move(done));
+      return;
+    }
+    struct Batch {
+      Batch(size_t num_requests, std::function<void()> done)
+          : pending(num_requests), done(std::move(done)) {}
+      std::atomic<size_t> pending;
+      std::function<void()> done;
+    };
+    Batch* batch = new Batch(requests->size(), std::move(done));
+    auto finish_request = [batch]() {
+      if (--batch->pending == 0) {
+        batch->done();
+        delete batch;
+      }
+    };
+    std::vector<IoUring::Read> reads;
+    reads.reserve(requests->size());
+    for (ReadRequest& request : *requests) {
+      if (request.n > INT32_MAX) {
+        // The ring returns 32-bit results.
+        request.status = Read(request.offset, request.n, &request.result,
+                              request.scratch);
+        finish_request();
+        continue;
+      }
+      reads.push_back(
+          {fd_, request.scratch, request.n, request.offset,
+           [this, &request, finish_request](int64 r) {
+             if (r == static_cast<int64>(request.n)) {
+               request.result = StringPiece(request.scratch, request.n);
+               request.status = Status::OK();
+             } else if (r == 0) {
+               request.result = StringPiece(request.scratch, 0);
+               request.status = Status(error::OUT_OF_RANGE,
+                                       "Read less bytes than requested");
+             } else if (r > 0) {
+               // Reads the rest of a short read, if any, with pread().
+               StringPiece rest;
+               request.status = Read(request.offset + r, request.n - r, &rest,
+                                     request.scratch + r);
+               request.result =
+                   StringPiece(request.scratch, r + rest.size());
+             } else if (r == -EINTR || r == -EAGAIN) {
+               request.status = Read(request.offset, request.n,
+                                     &request.result, request.scratch);
+             } else {
+               request.result = StringPiece(request.scratch, 0);
+               request.status = IOError(filename_, -r);
+             }
+             finish_request();
+           }});
+    }
+    ring->Submit(&reads);
+  }
+#endif
+
 #if defined(TF_CORD_SUPPORT)
   Status Read(uint64 offset, size_t n, absl::Cord* cord) const override {
     if (n == 0) {
@@ -229,7 +584,15 @@ Status PosixFileSystem::NewRandomAccessFile(
   if (fd < 0) {
     s = IOError(fname, errno);
   } else {
-    result->reset(new PosixRandomAccessFile(translated_fname, fd));
+    int direct_fd = -1;
+#if defined(TF_POSIX_HAS_DIRECT_IO)
+    if (UseDirectIO()) {
+      // Not every file system supports O_DIRECT; keep the buffered descriptor
+      // only in that case.
+      direct_fd = open(translated_fname.c_str(), O_RDONLY | O_DIRECT);
+    }
+#endif
+    result->reset(new PosixRandomAccessFile(translated_fname, fd, direct_fd));
   }
   return s;
 }
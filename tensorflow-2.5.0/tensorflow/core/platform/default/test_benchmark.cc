@@ -18,6 +18,7 @@ limitations under the License.
 #include <algorithm>
 #include <cstdio>
 #include <cstdlib>
+#include <map>
 #include <vector>
 
 #include "tensorflow/core/platform/env.h"
@@ -37,6 +38,7 @@ static std::vector<Benchmark*>* all_benchmarks = nullptr;
 static std::string label;
 static int64 bytes_processed;
 static int64 items_processed;
+static std::map<std::string, double> counters;
 static int64 accum_time = 0;
 static int64 start_time = 0;
 static Env* env;
@@ -218,6 +220,10 @@ void Benchmark::Run(const char* pattern) {
                  (items_processed * 1e-6) / seconds);
         full_label += buf;
       }
+      for (const auto& counter : counters) {
+        strings::StrAppend(&full_label, " ", counter.first, "=",
+                           counter.second);
+      }
       printf("%-*s %10.0f %10d\t%s\n", width, name.c_str(),
              seconds * 1e9 / iters, iters, full_label.c_str());
 
@@ -233,6 +239,13 @@ void Benchmark::Run(const char* pattern) {
         LOG(ERROR) << s.ToString();
         exit(EXIT_FAILURE);
       }
+      for (const auto& counter : counters) {
+        s = reporter.AddMetric(counter.first, counter.second);
+        if (!s.ok()) {
+          LOG(ERROR) << s.ToString();
+          exit(EXIT_FAILURE);
+        }
+      }
       s = reporter.Close();
       if (!s.ok()) {
         LOG(ERROR) << s.ToString();
@@ -260,6 +273,7 @@ void Benchmark::Run(int arg1, int arg2, int* run_count, double* run_seconds) {
     bytes_processed = -1;
     items_processed = -1;
     label.clear();
+    counters.clear();
     if (fn0_) {
       (*fn0_)(iters);
     } else if (fn1_) {
@@ -271,6 +285,7 @@ void Benchmark::Run(int arg1, int arg2, int* run_count, double* run_seconds) {
       ::testing::benchmark::State state(iters, instantiated_num_args_,
                                         std::move(arg_list));
       (*fn_state_)(state);
+      counters = state.counters;
     }
     StopTiming();
     const double seconds = accum_time * 1e-6;
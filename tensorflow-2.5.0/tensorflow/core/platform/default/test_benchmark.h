@@ -17,6 +17,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_PLATFORM_DEFAULT_TEST_BENCHMARK_H_
 #define TENSORFLOW_CORE_PLATFORM_DEFAULT_TEST_BENCHMARK_H_
 
+#include <map>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -216,6 +218,12 @@ class State {
   // REQUIRES: a benchmark is currently executing
   void SetLabel(absl::string_view label);
 
+  // Named values to report along with the timing of the benchmark, e.g.
+  //   state.counters["peak_bytes"] = peak_bytes;
+  // They are appended to the benchmark report line and recorded as metrics of
+  // the benchmark entry written by TestReporter.
+  std::map<std::string, double> counters;
+
   // For parameterized benchmarks, range(i) returns the value of the ith
   // parameter. Simple benchmarks are not parameterized and do not need to call
   // range().
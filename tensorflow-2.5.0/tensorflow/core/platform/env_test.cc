@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/cord.h"
+#include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/null_file_system.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/protobuf.h"
@@ -90,6 +91,43 @@ TEST_F(DefaultEnvTest, IncompleteReadOutOfRange) {
   EXPECT_EQ(input, result);
 }
 
+TEST_F(DefaultEnvTest, ReadAsync) {
+  // Uses io_uring where the kernel supports it, pread() otherwise.
+  setenv("TF_POSIX_USE_IO_URING", "1", 1);
+  const string filename = io::JoinPath(BaseDir(), "read_async");
+  const int kLength = 100000;
+  const string input = CreateTestFile(env_, filename, kLength);
+  std::unique_ptr<RandomAccessFile> f;
+  TF_EXPECT_OK(env_->NewRandomAccessFile(filename, &f));
+
+  // More reads than an io_uring queue holds, the last ones past EOF.
+  const int kNumReads = 1000;
+  const int kReadSize = 1000;
+  std::vector<string> scratch(kNumReads, string(kReadSize, 0));
+  std::vector<RandomAccessFile::ReadRequest> requests(kNumReads);
+  for (int i = 0; i < kNumReads; ++i) {
+    requests[i].offset = (i * 997) % (kLength + 2 * kReadSize);
+    requests[i].n = kReadSize;
+    requests[i].scratch = &scratch[i][0];
+  }
+  Notification done;
+  f->ReadAsync(&requests, [&done]() { done.Notify(); });
+  done.WaitForNotification();
+
+  for (int i = 0; i < kNumReads; ++i) {
+    const RandomAccessFile::ReadRequest& request = requests[i];
+    const string expected = request.offset < kLength
+                                ? input.substr(request.offset, kReadSize)
+                                : string();
+    EXPECT_EQ(expected, request.result);
+    if (expected.size() == kReadSize) {
+      TF_EXPECT_OK(request.status);
+    } else {
+      EXPECT_EQ(error::OUT_OF_RANGE, request.status.code());
+    }
+  }
+}
+
 TEST_F(DefaultEnvTest, ReadFileToString) {
   for (const int length : {0, 1, 1212, 2553, 4928, 8196, 9000, (1 << 20) - 1,
                            1 << 20, (1 << 20) + 1, (256 << 20) + 100}) {
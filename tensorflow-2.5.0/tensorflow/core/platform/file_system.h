@@ -751,6 +751,37 @@ class RandomAccessFile {
   virtual tensorflow::Status Read(uint64 offset, size_t n, StringPiece* result,
                                   char* scratch) const = 0;
 
+  /// \brief A read of up to `n` bytes from the file starting at `offset` into
+  /// `scratch[0..n-1]`, for ReadAsync().
+  struct ReadRequest {
+    uint64 offset = 0;
+    size_t n = 0;
+    char* scratch = nullptr;
+    /// Set by ReadAsync() to the `*result` and the status of Read().
+    StringPiece result;
+    tensorflow::Status status;
+  };
+
+  /// \brief Reads all the `*requests`, then calls `done`.
+  ///
+  /// Implementations may keep all the requests in flight at once, so that a
+  /// single thread can issue many reads, and call `done` from another thread,
+  /// possibly before ReadAsync() returns. The file, `*requests` and their
+  /// scratch buffers must stay live until `done` is called.
+  ///
+  /// The default implementation calls Read() for each request in the calling
+  /// thread.
+  ///
+  /// Safe for concurrent use by multiple threads.
+  virtual void ReadAsync(std::vector<ReadRequest>* requests,
+                         std::function<void()> done) const {
+    for (ReadRequest& request : *requests) {
+      request.status = Read(request.offset, request.n, &request.result,
+                            request.scratch);
+    }
+    done();
+  }
+
 #if defined(TF_CORD_SUPPORT)
   /// \brief Read up to `n` bytes from the file starting at `offset`.
   virtual tensorflow::Status Read(uint64 offset, size_t n,
@@ -39,6 +39,7 @@ limitations under the License.
 #include <cmath>
 #include <cstdlib>
 
+#include "tensorflow/core/platform/cloud/ram_file_block_cache.h"
 #include "tensorflow/core/platform/file_system_helper.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/path.h"
@@ -71,6 +72,24 @@ static const int kUploadRetries = 3;
 static const int kDownloadRetries = 3;
 static const char* kExecutorTag = "TransferManagerExecutor";
 
+// The block cache of random access files is configured like the GCS one.
+// It is disabled unless S3_READ_CACHE_MAX_SIZE_MB is set.
+static const uint64 kS3ReadCacheDefaultBlockSize = 16 * 1024 * 1024;  // 16 MB
+static const uint64 kS3ReadCacheDefaultMaxSize = 0;
+static const uint64 kS3ReadCacheDefaultMaxStaleness = 0;
+static const uint64 kS3ReadCacheDefaultMaxReadaheadBlocks = 0;
+
+// Converts the environment variable `varname` to uint64, or returns
+// `default_value` if it is unset or invalid.
+uint64 GetEnvUint64(const char* varname, uint64 default_value) {
+  const char* value_str = getenv(varname);
+  uint64 value;
+  if (value_str && strings::safe_strtou64(value_str, &value)) {
+    return value;
+  }
+  return default_value;
+}
+
 Aws::Client::ClientConfiguration& GetDefaultClientConfig() {
   static mutex cfg_lock(LINKER_INITIALIZED);
   static bool init(false);
@@ -159,6 +178,12 @@ Aws::Client::ClientConfiguration& GetDefaultClientConfig() {
       cfg.caPath = Aws::String(ca_path);
     }
 
+    // The connection pool of the client bounds the number of concurrent
+    // requests, e.g. of parallel input pipelines, parts of multi part
+    // transfers and block cache fetches.
+    cfg.maxConnections = static_cast<unsigned>(
+        GetEnvUint64("S3_MAX_CONNECTIONS", cfg.maxConnections));
+
     init = true;
   }
 
@@ -234,12 +259,14 @@ class S3RandomAccessFile : public RandomAccessFile {
       const string& bucket, const string& object,
       const bool use_multi_part_download,
       std::shared_ptr<Aws::Transfer::TransferManager> transfer_manager,
-      std::shared_ptr<Aws::S3::S3Client> s3_client)
+      std::shared_ptr<Aws::S3::S3Client> s3_client,
+      FileBlockCache* file_block_cache = nullptr)
       : bucket_(bucket),
         object_(object),
         use_multi_part_download_(use_multi_part_download),
         transfer_manager_(transfer_manager),
-        s3_client_(s3_client) {}
+        s3_client_(s3_client),
+        file_block_cache_(file_block_cache) {}
 
   Status Name(StringPiece* result) const override {
     return errors::Unimplemented("S3RandomAccessFile does not support Name()");
@@ -249,6 +276,9 @@ class S3RandomAccessFile : public RandomAccessFile {
               char* scratch) const override {
     VLOG(1) << "ReadFilefromS3 s3://" << bucket_ << "/" << object_ << " from "
             << offset << " for n:" << n;
+    if (file_block_cache_ != nullptr) {
+      return ReadBlockCache(offset, n, result, scratch);
+    }
     if (use_multi_part_download_) {
       return ReadS3TransferManager(offset, n, result, scratch);
     } else {
@@ -256,6 +286,20 @@ class S3RandomAccessFile : public RandomAccessFile {
     }
   }
 
+  Status ReadBlockCache(uint64 offset, size_t n, StringPiece* result,
+                        char* scratch) const {
+    VLOG(3) << "Using block cache";
+    size_t bytes_transferred;
+    TF_RETURN_IF_ERROR(file_block_cache_->Read(
+        strings::StrCat("s3://", bucket_, "/", object_), offset, n, scratch,
+        &bytes_transferred));
+    *result = StringPiece(scratch, bytes_transferred);
+    if (bytes_transferred < n) {
+      return Status(error::OUT_OF_RANGE, "Read less bytes than requested");
+    }
+    return Status::OK();
+  }
+
   Status ReadS3TransferManager(uint64 offset, size_t n, StringPiece* result,
                                char* scratch) const {
     VLOG(3) << "Using TransferManager";
@@ -342,6 +386,7 @@ class S3RandomAccessFile : public RandomAccessFile {
   std::shared_ptr<Aws::S3::S3Client> s3_client_;
   std::shared_ptr<Aws::Transfer::TransferManager> transfer_manager_;
   bool use_multi_part_download_;
+  FileBlockCache* file_block_cache_;  // Not owned.
 };
 
 class S3WritableFile : public WritableFile {
@@ -349,11 +394,13 @@ class S3WritableFile : public WritableFile {
   S3WritableFile(
       const string& bucket, const string& object,
       std::shared_ptr<Aws::Transfer::TransferManager> transfer_manager,
-      std::shared_ptr<Aws::S3::S3Client> s3_client)
+      std::shared_ptr<Aws::S3::S3Client> s3_client,
+      std::function<void()> file_cache_erase)
       : bucket_(bucket),
         object_(object),
         s3_client_(s3_client),
         transfer_manager_(transfer_manager),
+        file_cache_erase_(std::move(file_cache_erase)),
         sync_needed_(true),
         outfile_(Aws::MakeShared<Aws::Utils::TempFile>(
             kS3FileSystemAllocationTag, kS3TempFileTemplate,
@@ -421,6 +468,8 @@ class S3WritableFile : public WritableFile {
                              handle->GetFailedParts().size(), " failed parts. ",
                              handle->GetLastError().GetMessage());
     }
+    // Erase the file from the block cache on every successful write.
+    file_cache_erase_();
     outfile_->clear();
     outfile_->seekp(offset);
     sync_needed_ = false;
@@ -432,6 +481,7 @@ class S3WritableFile : public WritableFile {
   string object_;
   std::shared_ptr<Aws::S3::S3Client> s3_client_;
   std::shared_ptr<Aws::Transfer::TransferManager> transfer_manager_;
+  std::function<void()> file_cache_erase_;
   bool sync_needed_;
   std::shared_ptr<Aws::Utils::TempFile> outfile_;
 };
@@ -500,9 +550,65 @@ S3FileSystem::S3FileSystem()
 
   this->transfer_managers_.insert(upload_pair);
   this->transfer_managers_.insert(download_pair);
+
+  const uint64 max_bytes =
+      GetEnvUint64("S3_READ_CACHE_MAX_SIZE_MB", kS3ReadCacheDefaultMaxSize) *
+      1024 * 1024;
+  if (max_bytes > 0) {
+    const uint64 block_size =
+        GetEnvUint64("S3_READ_CACHE_BLOCK_SIZE_MB",
+                     kS3ReadCacheDefaultBlockSize / (1024 * 1024)) *
+        1024 * 1024;
+    const uint64 max_staleness = GetEnvUint64(
+        "S3_READ_CACHE_MAX_STALENESS", kS3ReadCacheDefaultMaxStaleness);
+    const uint64 max_readahead_blocks =
+        GetEnvUint64("S3_READ_CACHE_MAX_READAHEAD_BLOCKS",
+                     kS3ReadCacheDefaultMaxReadaheadBlocks);
+    VLOG(1) << "S3 cache max size = " << max_bytes << " ; "
+            << "block size = " << block_size << " ; "
+            << "max staleness = " << max_staleness << " ; "
+            << "max readahead blocks = " << max_readahead_blocks;
+    file_block_cache_.reset(new RamFileBlockCache(
+        block_size, max_bytes, max_staleness,
+        [this](const string& fname, size_t offset, size_t n, char* buffer,
+               size_t* bytes_transferred) {
+          return LoadBufferFromS3(fname, offset, n, buffer, bytes_transferred);
+        },
+        Env::Default(), max_readahead_blocks));
+  }
 }
 
-S3FileSystem::~S3FileSystem() {}
+S3FileSystem::~S3FileSystem() {
+  // The block cache fetches in the background with the S3 client.
+  file_block_cache_.reset();
+}
+
+Status S3FileSystem::LoadBufferFromS3(const string& fname, size_t offset,
+                                      size_t n, char* buffer,
+                                      size_t* bytes_transferred) {
+  string bucket, object;
+  TF_RETURN_IF_ERROR(ParseS3Path(fname, false, &bucket, &object));
+  S3RandomAccessFile file(bucket, object, false, nullptr, this->GetS3Client());
+  StringPiece result;
+  Status status = file.ReadS3Client(offset, n, &result, buffer);
+  if (!status.ok() && status.code() != error::OUT_OF_RANGE) {
+    return status;
+  }
+  *bytes_transferred = result.size();
+  return Status::OK();
+}
+
+void S3FileSystem::ClearFileCaches(const string& fname) {
+  if (file_block_cache_) {
+    file_block_cache_->RemoveFile(fname);
+  }
+}
+
+void S3FileSystem::FlushCaches(TransactionToken* token) {
+  if (file_block_cache_) {
+    file_block_cache_->Flush();
+  }
+}
 
 // Initializes s3_client_, if needed, and returns it.
 std::shared_ptr<Aws::S3::S3Client> S3FileSystem::GetS3Client() {
@@ -581,10 +687,26 @@ Status S3FileSystem::NewRandomAccessFile(
 
   // check if an override was defined for this file. used for testing
   bool use_mpd = this->use_multi_part_download_ && use_multi_part_download;
+  if (file_block_cache_) {
+    // Drop the cached blocks if the object has been modified since they were
+    // read, and bound the read-ahead by the object size.
+    FileStatistics stats;
+    if (Stat(fname, token, &stats).ok()) {
+      if (!file_block_cache_->ValidateAndUpdateFileSignature(
+              fname, stats.mtime_nsec)) {
+        VLOG(1) << "File signature has been changed. Refreshing the cache. "
+                   "Path: "
+                << fname;
+      }
+      file_block_cache_->SetFileSize(fname, stats.length);
+    } else {
+      file_block_cache_->RemoveFile(fname);
+    }
+  }
   result->reset(new S3RandomAccessFile(
       bucket, object, use_mpd,
       this->GetTransferManager(Aws::Transfer::TransferDirection::DOWNLOAD),
-      this->GetS3Client()));
+      this->GetS3Client(), file_block_cache_.get()));
   return Status::OK();
 }
 
@@ -596,7 +718,7 @@ Status S3FileSystem::NewWritableFile(const string& fname,
   result->reset(new S3WritableFile(
       bucket, object,
       this->GetTransferManager(Aws::Transfer::TransferDirection::UPLOAD),
-      this->GetS3Client()));
+      this->GetS3Client(), [this, fname]() { ClearFileCaches(fname); }));
 
   return Status::OK();
 }
@@ -616,7 +738,7 @@ Status S3FileSystem::NewAppendableFile(const string& fname,
   result->reset(new S3WritableFile(
       bucket, object,
       this->GetTransferManager(Aws::Transfer::TransferDirection::UPLOAD),
-      this->GetS3Client()));
+      this->GetS3Client(), [this, fname]() { ClearFileCaches(fname); }));
 
   while (true) {
     status = reader->Read(offset, kS3ReadAppendableFileBufferSize, &read_chunk,
@@ -786,6 +908,7 @@ Status S3FileSystem::DeleteFile(const string& fname, TransactionToken* token) {
 
   auto deleteObjectOutcome =
       this->GetS3Client()->DeleteObject(deleteObjectRequest);
+  ClearFileCaches(fname);
   if (!deleteObjectOutcome.IsSuccess()) {
     return CreateStatusFromAwsError(deleteObjectOutcome.GetError());
   }
@@ -1174,6 +1297,10 @@ Status S3FileSystem::RenameFile(const string& src, const string& target,
       TF_RETURN_IF_ERROR(CopyFile(Aws::String(src_bucket.c_str()), src_key,
                                   Aws::String(target_bucket.c_str()),
                                   target_key));
+      ClearFileCaches(
+          strings::StrCat("s3://", src_bucket, "/", src_key.c_str()));
+      ClearFileCaches(
+          strings::StrCat("s3://", target_bucket, "/", target_key.c_str()));
 
       deleteObjectRequest.SetBucket(src_bucket.c_str());
       deleteObjectRequest.SetKey(src_key.c_str());
@@ -22,6 +22,7 @@ limitations under the License.
 #include <aws/s3/model/CompletedMultipartUpload.h>
 #include <aws/transfer/TransferManager.h>
 
+#include "tensorflow/core/platform/cloud/file_block_cache.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/retrying_file_system.h"
@@ -94,6 +95,8 @@ class S3FileSystem : public FileSystem {
 
   Status HasAtomicMove(const string& path, bool* has_atomic_move) override;
 
+  void FlushCaches(TransactionToken* token) override;
+
  private:
   // Returns the member S3 client, initializing as-needed.
   // When the client tries to access the object in S3, e.g.,
@@ -144,6 +147,13 @@ class S3FileSystem : public FileSystem {
       const std::shared_ptr<const Aws::Client::AsyncCallerContext>&
           multiPartContext);
 
+  // Loads a block of a file for the block cache with a range GET.
+  Status LoadBufferFromS3(const string& fname, size_t offset, size_t n,
+                          char* buffer, size_t* bytes_transferred);
+
+  // Clears the cached blocks of the file, after it has been modified.
+  void ClearFileCaches(const string& fname);
+
   // Lock held when checking for s3_client_ and transfer_manager_ initialization
   mutex initialization_lock_;
 
@@ -151,6 +161,10 @@ class S3FileSystem : public FileSystem {
   std::map<Aws::Transfer::TransferDirection, uint64> multi_part_chunk_size_;
 
   bool use_multi_part_download_;
+
+  // Cache of the blocks read by random access files, null if disabled. The
+  // block cache fetches blocks concurrently and ahead of sequential reads.
+  std::unique_ptr<FileBlockCache> file_block_cache_;
 };
 
 /// S3 implementation of a file system with retry on failures.
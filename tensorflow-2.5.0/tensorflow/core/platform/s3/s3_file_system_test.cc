@@ -180,6 +180,36 @@ TEST_F(S3FileSystemTest, NewRandomAccessFile) {
   EXPECT_EQ(content.substr(2, 4), result);
 }
 
+TEST_F(S3FileSystemTest, NewRandomAccessFile_BlockCache) {
+  setenv("S3_READ_CACHE_MAX_SIZE_MB", "4", 1);
+  setenv("S3_READ_CACHE_BLOCK_SIZE_MB", "1", 1);
+  setenv("S3_READ_CACHE_MAX_READAHEAD_BLOCKS", "2", 1);
+  S3FileSystem cached_s3fs;
+  unsetenv("S3_READ_CACHE_MAX_SIZE_MB");
+  unsetenv("S3_READ_CACHE_BLOCK_SIZE_MB");
+  unsetenv("S3_READ_CACHE_MAX_READAHEAD_BLOCKS");
+
+  const string fname = TmpDir("RandomAccessFileBlockCache");
+  for (const string& content : {"abcdefghijklmn", "opqrstuvwxyz"}) {
+    // Writing the file drops its cached blocks.
+    std::unique_ptr<WritableFile> writer;
+    TF_ASSERT_OK(cached_s3fs.NewWritableFile(fname, &writer));
+    TF_ASSERT_OK(writer->Append(content));
+    TF_ASSERT_OK(writer->Close());
+
+    std::unique_ptr<RandomAccessFile> reader;
+    TF_EXPECT_OK(cached_s3fs.NewRandomAccessFile(fname, &reader));
+    string got;
+    got.resize(content.size() + 1);
+    StringPiece result;
+    EXPECT_EQ(error::OUT_OF_RANGE,
+              reader->Read(0, content.size() + 1, &result, &got[0]).code());
+    EXPECT_EQ(content, result);
+    TF_EXPECT_OK(reader->Read(2, 4, &result, &got[0]));
+    EXPECT_EQ(content.substr(2, 4), result);
+  }
+}
+
 TEST_F(S3FileSystemTest, NewWritableFile) {
   std::unique_ptr<WritableFile> writer;
   const string fname = TmpDir("WritableFile");
@@ -19,6 +19,7 @@ limitations under the License.
 #include "highwayhash/sip_hash.h"  // from @highwayhash
 #include "highwayhash/state_helpers.h"  // from @highwayhash
 #include "tensorflow/core/platform/platform.h"
+#include "tensorflow/core/platform/stringpiece.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
@@ -35,9 +36,8 @@ namespace tensorflow {
 //   uint64 hash_value = StrongKeyedHash(key, input);
 //
 inline uint64 StrongKeyedHash(const tensorflow::uint64 (&key)[2],
-                              const string& s) {
-  return highwayhash::StringHasher<highwayhash::SipHashState>()(
-      {key[0], key[1]}, s);
+                              StringPiece s) {
+  return highwayhash::SipHash({key[0], key[1]}, s.data(), s.size());
 }
 
 }  // namespace tensorflow
@@ -21,7 +21,9 @@ limitations under the License.
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/context.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/denormal.h"
+#include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/numa.h"
@@ -31,12 +33,86 @@ limitations under the License.
 namespace tensorflow {
 namespace thread {
 
+// The WorkerOptions of a pool and the statistics of its tasks.
+struct WorkerState {
+  explicit WorkerState(const ThreadPool::WorkerOptions& options)
+      : options(options) {}
+
+  // Called when a task is scheduled. Returns the worker scheduling it, or -1.
+  int OnSchedule() {
+    tasks_scheduled.fetch_add(1, std::memory_order_relaxed);
+    queue_depth.fetch_add(1, std::memory_order_relaxed);
+    if (options.spin_mode == ThreadPool::WorkerOptions::SpinMode::kAdaptive) {
+      // Keeps a moving average of the time between tasks, over about the
+      // last 8 of them.
+      const uint64 now = EnvTime::NowNanos();
+      const uint64 last = last_schedule_nanos.exchange(now);
+      if (last != 0 && now > last) {
+        const int64 mean = mean_gap_nanos.load(std::memory_order_relaxed);
+        const int64 gap = now - last;
+        mean_gap_nanos.store(mean == 0 ? gap : mean + (gap - mean) / 8,
+                             std::memory_order_relaxed);
+      }
+    }
+    return pool->CurrentThreadId();
+  }
+
+  // Called by the thread running a task scheduled by worker scheduled_by.
+  void OnExecute(int scheduled_by) {
+    queue_depth.fetch_sub(1, std::memory_order_relaxed);
+    if (scheduled_by >= 0 && scheduled_by != pool->CurrentThreadId()) {
+      tasks_stolen.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  // Returns how long a worker spins after running a task.
+  int64 SpinNanos() const {
+    const int64 max_spin = options.spin_wait_us * 1000;
+    switch (options.spin_mode) {
+      case ThreadPool::WorkerOptions::SpinMode::kDefault:
+        return 0;
+      case ThreadPool::WorkerOptions::SpinMode::kFixed:
+        return max_spin;
+      case ThreadPool::WorkerOptions::SpinMode::kAdaptive: {
+        // Spinning for twice the mean gap catches most of the next tasks;
+        // past max_spin the wake-up latency is cheaper than the burnt CPU.
+        const int64 mean = mean_gap_nanos.load(std::memory_order_relaxed);
+        if (mean == 0 || mean > max_spin) return 0;
+        return std::min(2 * mean, max_spin);
+      }
+    }
+    return 0;
+  }
+
+  // Called by a worker after running a task: spins until another task is
+  // scheduled or the spin ends, then lets the pool look for work or park.
+  void SpinWait() const {
+    const int64 spin = SpinNanos();
+    if (spin == 0 || pool->CurrentThreadId() < 0) return;
+    const uint64 deadline = EnvTime::NowNanos() + spin;
+    while (queue_depth.load(std::memory_order_relaxed) == 0 &&
+           EnvTime::NowNanos() < deadline) {
+    }
+  }
+
+  const ThreadPool::WorkerOptions options;
+  // Set once the pool is constructed, before any task is scheduled.
+  Eigen::ThreadPoolInterface* pool = nullptr;
+  std::atomic<int> num_workers{0};
+  std::atomic<int64> queue_depth{0};
+  std::atomic<int64> tasks_scheduled{0};
+  std::atomic<int64> tasks_stolen{0};
+  std::atomic<uint64> last_schedule_nanos{0};
+  std::atomic<int64> mean_gap_nanos{0};
+};
+
 struct EigenEnvironment {
   typedef Thread EnvThread;
   struct TaskImpl {
     std::function<void()> f;
     Context context;
     uint64 trace_id;
+    int scheduled_by;
   };
   struct Task {
     std::unique_ptr<TaskImpl> f;
@@ -45,12 +121,24 @@ struct EigenEnvironment {
   Env* const env_;
   const ThreadOptions thread_options_;
   const string name_;
+  // Null unless the pool was constructed with WorkerOptions.
+  const std::shared_ptr<WorkerState> worker_state_;
 
   EigenEnvironment(Env* env, const ThreadOptions& thread_options,
-                   const string& name)
-      : env_(env), thread_options_(thread_options), name_(name) {}
+                   const string& name,
+                   std::shared_ptr<WorkerState> worker_state = nullptr)
+      : env_(env),
+        thread_options_(thread_options),
+        name_(name),
+        worker_state_(std::move(worker_state)) {}
 
   EnvThread* CreateThread(std::function<void()> f) {
+    int cpu = -1;
+    if (worker_state_ != nullptr &&
+        !worker_state_->options.cpu_affinity.empty()) {
+      const std::vector<int>& cpus = worker_state_->options.cpu_affinity;
+      cpu = cpus[worker_state_->num_workers.fetch_add(1) % cpus.size()];
+    }
     return env_->StartThread(thread_options_, name_, [=]() {
       // Set the processor flag to flush denormals to zero.
       port::ScopedFlushDenormal flush;
@@ -59,6 +147,10 @@ struct EigenEnvironment {
       if (thread_options_.numa_node != port::kNUMANoAffinity) {
         port::NUMASetThreadNodeAffinity(thread_options_.numa_node);
       }
+      if (cpu >= 0 && !port::SetCurrentThreadCPUAffinity(cpu)) {
+        LOG(WARNING) << "Could not pin a thread of " << name_ << " to CPU "
+                     << cpu;
+      }
       f();
     });
   }
@@ -69,20 +161,31 @@ struct EigenEnvironment {
       id = tracing::GetUniqueArg();
       tracing::RecordEvent(tracing::EventCategory::kScheduleClosure, id);
     }
+    const int scheduled_by =
+        worker_state_ != nullptr ? worker_state_->OnSchedule() : -1;
     return Task{
         std::unique_ptr<TaskImpl>(new TaskImpl{
             std::move(f),
             Context(ContextKind::kThread),
             id,
+            scheduled_by,
         }),
     };
   }
 
   void ExecuteTask(const Task& t) {
-    WithContext wc(t.f->context);
-    tracing::ScopedRegion region(tracing::EventCategory::kRunClosure,
-                                 t.f->trace_id);
-    t.f->f();
+    if (worker_state_ != nullptr) {
+      worker_state_->OnExecute(t.f->scheduled_by);
+    }
+    {
+      WithContext wc(t.f->context);
+      tracing::ScopedRegion region(tracing::EventCategory::kRunClosure,
+                                   t.f->trace_id);
+      t.f->f();
+    }
+    if (worker_state_ != nullptr) {
+      worker_state_->SpinWait();
+    }
   }
 };
 
@@ -105,6 +208,24 @@ ThreadPool::ThreadPool(Env* env, const ThreadOptions& thread_options,
                                                        num_threads, allocator));
 }
 
+ThreadPool::ThreadPool(Env* env, const ThreadOptions& thread_options,
+                       const string& name, int num_threads,
+                       const WorkerOptions& worker_options,
+                       Eigen::Allocator* allocator)
+    : worker_state_(std::make_shared<WorkerState>(worker_options)) {
+  CHECK_GE(num_threads, 1);
+  // The workers spin themselves in the other modes, see WorkerState.
+  const bool allow_spinning =
+      worker_options.spin_mode == WorkerOptions::SpinMode::kDefault;
+  eigen_threadpool_.reset(new Eigen::ThreadPoolTempl<EigenEnvironment>(
+      num_threads, allow_spinning,
+      EigenEnvironment(env, thread_options, "tf_" + name, worker_state_)));
+  worker_state_->pool = eigen_threadpool_.get();
+  underlying_threadpool_ = eigen_threadpool_.get();
+  threadpool_device_.reset(new Eigen::ThreadPoolDevice(underlying_threadpool_,
+                                                       num_threads, allocator));
+}
+
 ThreadPool::ThreadPool(thread::ThreadPoolInterface* user_threadpool) {
   underlying_threadpool_ = user_threadpool;
   threadpool_device_.reset(new Eigen::ThreadPoolDevice(
@@ -267,5 +388,19 @@ Eigen::ThreadPoolInterface* ThreadPool::AsEigenThreadPool() const {
   DCHECK(underlying_threadpool_ != nullptr);
   return underlying_threadpool_;
 }
+
+ThreadPool::Stats ThreadPool::GetStats() const {
+  Stats stats;
+  if (worker_state_ != nullptr) {
+    stats.queue_depth =
+        worker_state_->queue_depth.load(std::memory_order_relaxed);
+    stats.tasks_scheduled =
+        worker_state_->tasks_scheduled.load(std::memory_order_relaxed);
+    stats.tasks_stolen =
+        worker_state_->tasks_stolen.load(std::memory_order_relaxed);
+    stats.spin_wait_us = worker_state_->SpinNanos() / 1000;
+  }
+  return stats;
+}
 }  // namespace thread
 }  // namespace tensorflow
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <functional>
 #include <memory>
+#include <vector>
 
 #include "absl/types/optional.h"
 #include "tensorflow/core/platform/env.h"
@@ -38,6 +39,7 @@ namespace tensorflow {
 namespace thread {
 
 struct EigenEnvironment;
+struct WorkerState;
 
 class ThreadPool {
  public:
@@ -99,6 +101,37 @@ class ThreadPool {
     absl::optional<int64> block_size_;
   };
 
+  // Tuning of the worker threads of a pool, for latency-sensitive uses.
+  struct WorkerOptions {
+    enum class SpinMode {
+      // Idle workers spin as for low_latency_hint = true.
+      kDefault,
+      // A worker spins for spin_wait_us after running a task before parking.
+      kFixed,
+      // A worker spins for up to spin_wait_us after running a task, but only
+      // while the observed time between scheduled tasks suggests that another
+      // one arrives within the spin. Busy pools spin, idle pools park.
+      kAdaptive,
+    };
+    SpinMode spin_mode = SpinMode::kDefault;
+    int64 spin_wait_us = 0;
+
+    // If not empty, the i-th worker thread is pinned to the CPU
+    // cpu_affinity[i % cpu_affinity.size()].
+    std::vector<int> cpu_affinity;
+  };
+
+  // Statistics of a pool constructed with WorkerOptions.
+  struct Stats {
+    // Tasks scheduled that have not started running.
+    int64 queue_depth = 0;
+    int64 tasks_scheduled = 0;
+    // Tasks scheduled from a worker and run by another one.
+    int64 tasks_stolen = 0;
+    // The current spin of workers before parking.
+    int64 spin_wait_us = 0;
+  };
+
   // Constructs a pool that contains "num_threads" threads with specified
   // "name". env->StartThread() is used to create individual threads with the
   // given ThreadOptions. If "low_latency_hint" is true the thread pool
@@ -125,6 +158,16 @@ class ThreadPool {
   ThreadPool(Env* env, const ThreadOptions& thread_options,
              const std::string& name, int num_threads);
 
+  // Constructs a pool that contains "num_threads" threads with specified
+  // "name", tuned by "worker_options", which also collects Stats.
+  // env->StartThread() is used to create individual threads with the given
+  // ThreadOptions.
+  // REQUIRES: num_threads > 0
+  ThreadPool(Env* env, const ThreadOptions& thread_options,
+             const std::string& name, int num_threads,
+             const WorkerOptions& worker_options,
+             Eigen::Allocator* allocator = nullptr);
+
   // Constructs a pool that wraps around the thread::ThreadPoolInterface
   // instance provided by the caller. Caller retains ownership of
   // `user_threadpool` and must ensure its lifetime is longer than the
@@ -215,6 +258,10 @@ class ThreadPool {
   // pointer points to, and should not attempt to delete.
   Eigen::ThreadPoolInterface* AsEigenThreadPool() const;
 
+  // Returns the statistics of the pool. They are only collected by pools
+  // constructed with WorkerOptions, and are all zero otherwise.
+  Stats GetStats() const;
+
  private:
   // Divides the work represented by the range [0, total) into k shards.
   // Calls fn(i*block_size, (i+1)*block_size) from the ith shard (0 <= i < k).
@@ -234,6 +281,9 @@ class ThreadPool {
   // user_threadpool is not in the constructor.
   std::unique_ptr<Eigen::ThreadPoolTempl<EigenEnvironment>> eigen_threadpool_;
   std::unique_ptr<Eigen::ThreadPoolDevice> threadpool_device_;
+  // Shared with the workers of eigen_threadpool_ if constructed with
+  // WorkerOptions, null otherwise.
+  std::shared_ptr<WorkerState> worker_state_;
   TF_DISALLOW_COPY_AND_ASSIGN(ThreadPool);
 };
 
@@ -99,6 +99,12 @@ int GetCurrentCPU() {
   return GetCurrentProcessorNumber();
 }
 
+bool SetCurrentThreadCPUAffinity(int cpu) {
+  // Like GetCurrentCPU, only CPUs of the current processor group.
+  if (cpu < 0 || cpu >= 64) return false;
+  return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR{1} << cpu) != 0;
+}
+
 bool NUMAEnabled() {
   // Not yet implemented: coming soon.
   return false;
@@ -0,0 +1,64 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/profiler/convert/rolling_op_metrics_db.h"
+
+#include <utility>
+
+#include "absl/algorithm/container.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/profiler/convert/op_metrics_db_combiner.h"
+#include "tensorflow/core/profiler/protobuf/op_metrics.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+
+RollingOpMetricsDb::RollingOpMetricsDb(int max_windows, int max_ops_per_window)
+    : max_windows_(max_windows), max_ops_per_window_(max_ops_per_window) {
+  DCHECK_GT(max_windows_, 0);
+  DCHECK_GE(max_ops_per_window_, 0);
+}
+
+void RollingOpMetricsDb::AddWindow(uint64 start_time_ns, uint64 duration_ns,
+                                   OpMetricsDb db) {
+  db.set_total_time_ps(duration_ns * 1000);
+  if (db.metrics_db_size() > max_ops_per_window_) {
+    absl::c_sort(*db.mutable_metrics_db(),
+                 [](const OpMetrics& a, const OpMetrics& b) {
+                   return a.self_time_ps() > b.self_time_ps();
+                 });
+    db.mutable_metrics_db()->DeleteSubrange(
+        max_ops_per_window_, db.metrics_db_size() - max_ops_per_window_);
+  }
+  DCHECK(windows_.empty() || windows_.back().start_time_ns <= start_time_ns);
+  if (windows_.size() == static_cast<size_t>(max_windows_)) {
+    windows_.pop_front();
+  }
+  windows_.push_back(Window{start_time_ns, std::move(db)});
+}
+
+OpMetricsDb RollingOpMetricsDb::Combine(uint64 min_start_time_ns) const {
+  OpMetricsDb result;
+  OpMetricsDbCombiner combiner(&result);
+  for (const Window& window : windows_) {
+    if (window.start_time_ns >= min_start_time_ns) {
+      combiner.Combine(window.db);
+    }
+  }
+  return result;
+}
+
+}  // namespace profiler
+}  // namespace tensorflow
@@ -0,0 +1,65 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_PROFILER_CONVERT_ROLLING_OP_METRICS_DB_H_
+#define TENSORFLOW_CORE_PROFILER_CONVERT_ROLLING_OP_METRICS_DB_H_
+
+#include <deque>
+
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/protobuf/op_metrics.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+
+// Keeps the op metrics of the most recent profiling windows in bounded memory,
+// e.g. for a profiler that samples short windows continuously.
+// Not thread-safe.
+class RollingOpMetricsDb {
+ public:
+  // Keeps at most `max_windows` windows of at most `max_ops_per_window` ops.
+  RollingOpMetricsDb(int max_windows, int max_ops_per_window);
+
+  // Adds the op metrics of a window of `duration_ns` starting at
+  // `start_time_ns`, which must not be before the start of the previous
+  // window, dropping the oldest window if there are too many. Only the
+  // ops with the largest self time are kept, but the time of the others still
+  // counts towards the total op time. The total time of `db` is set to the
+  // duration of the window.
+  void AddWindow(uint64 start_time_ns, uint64 duration_ns, OpMetricsDb db);
+
+  // Returns the op metrics combined over the windows starting at or after
+  // `min_start_time_ns`.
+  OpMetricsDb Combine(uint64 min_start_time_ns) const;
+
+  // Returns the number of windows currently kept.
+  int num_windows() const { return windows_.size(); }
+
+ private:
+  struct Window {
+    uint64 start_time_ns;
+    OpMetricsDb db;
+  };
+
+  const int max_windows_;
+  const int max_ops_per_window_;
+  // Ordered by start time, oldest first.
+  std::deque<Window> windows_;
+};
+
+}  // namespace profiler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PROFILER_CONVERT_ROLLING_OP_METRICS_DB_H_
@@ -0,0 +1,97 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/profiler/convert/rolling_op_metrics_db.h"
+
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/protobuf/op_metrics.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+OpMetricsDb MakeOpMetricsDb(
+    std::initializer_list<std::pair<const char*, uint64>> ops) {
+  OpMetricsDb db;
+  for (const auto& op : ops) {
+    OpMetrics* metrics = db.add_metrics_db();
+    metrics->set_name(op.first);
+    metrics->set_occurrences(1);
+    metrics->set_time_ps(op.second);
+    metrics->set_self_time_ps(op.second);
+    db.set_total_op_time_ps(db.total_op_time_ps() + op.second);
+  }
+  return db;
+}
+
+const OpMetrics* FindOp(const OpMetricsDb& db, absl::string_view name) {
+  for (const OpMetrics& metrics : db.metrics_db()) {
+    if (metrics.name() == name) return &metrics;
+  }
+  return nullptr;
+}
+
+TEST(RollingOpMetricsDbTest, CombinesWindows) {
+  RollingOpMetricsDb rolling(/*max_windows=*/4, /*max_ops_per_window=*/10);
+  rolling.AddWindow(/*start_time_ns=*/1000, /*duration_ns=*/100,
+                    MakeOpMetricsDb({{"MatMul", 30}, {"Add", 10}}));
+  rolling.AddWindow(/*start_time_ns=*/2000, /*duration_ns=*/100,
+                    MakeOpMetricsDb({{"MatMul", 50}}));
+
+  OpMetricsDb all = rolling.Combine(/*min_start_time_ns=*/0);
+  EXPECT_EQ(all.total_time_ps(), 200000);
+  EXPECT_EQ(all.total_op_time_ps(), 90);
+  ASSERT_NE(FindOp(all, "MatMul"), nullptr);
+  EXPECT_EQ(FindOp(all, "MatMul")->occurrences(), 2);
+  EXPECT_EQ(FindOp(all, "MatMul")->self_time_ps(), 80);
+  ASSERT_NE(FindOp(all, "Add"), nullptr);
+  EXPECT_EQ(FindOp(all, "Add")->self_time_ps(), 10);
+
+  OpMetricsDb recent = rolling.Combine(/*min_start_time_ns=*/1500);
+  EXPECT_EQ(recent.total_time_ps(), 100000);
+  EXPECT_EQ(FindOp(recent, "Add"), nullptr);
+  EXPECT_EQ(FindOp(recent, "MatMul")->self_time_ps(), 50);
+}
+
+TEST(RollingOpMetricsDbTest, DropsOldestWindows) {
+  RollingOpMetricsDb rolling(/*max_windows=*/2, /*max_ops_per_window=*/10);
+  rolling.AddWindow(1000, 100, MakeOpMetricsDb({{"Conv2D", 10}}));
+  rolling.AddWindow(2000, 100, MakeOpMetricsDb({{"MatMul", 20}}));
+  rolling.AddWindow(3000, 100, MakeOpMetricsDb({{"MatMul", 30}}));
+
+  EXPECT_EQ(rolling.num_windows(), 2);
+  OpMetricsDb all = rolling.Combine(/*min_start_time_ns=*/0);
+  EXPECT_EQ(FindOp(all, "Conv2D"), nullptr);
+  EXPECT_EQ(FindOp(all, "MatMul")->self_time_ps(), 50);
+}
+
+TEST(RollingOpMetricsDbTest, KeepsMostExpensiveOpsPerWindow) {
+  RollingOpMetricsDb rolling(/*max_windows=*/2, /*max_ops_per_window=*/2);
+  rolling.AddWindow(
+      1000, 100,
+      MakeOpMetricsDb({{"Add", 10}, {"MatMul", 30}, {"Relu", 5}, {"Mul", 20}}));
+
+  OpMetricsDb all = rolling.Combine(/*min_start_time_ns=*/0);
+  EXPECT_EQ(all.metrics_db_size(), 2);
+  EXPECT_NE(FindOp(all, "MatMul"), nullptr);
+  EXPECT_NE(FindOp(all, "Mul"), nullptr);
+  // The dropped ops still count towards the total op time.
+  EXPECT_EQ(all.total_op_time_ps(), 65);
+}
+
+}  // namespace
+}  // namespace profiler
+}  // namespace tensorflow
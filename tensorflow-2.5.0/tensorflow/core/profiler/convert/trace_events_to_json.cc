@@ -84,6 +84,17 @@ inline void AddResourceMetadata(uint32 device_id, uint32 resource_id,
                   R"(,"args":{"sort_index":)", sort_index, "}},");
 }
 
+inline void AddDeviceAndResourcesMetadata(uint32 device_id,
+                                          const Device& device,
+                                          std::string* json) {
+  AddDeviceMetadata(device_id, device, json);
+  for (const auto* id_and_resource : SortByKey(device.resources())) {
+    uint32 resource_id = id_and_resource->first;
+    const Resource& resource = id_and_resource->second;
+    AddResourceMetadata(device_id, resource_id, resource, json);
+  }
+}
+
 inline void AddTraceEvent(const TraceEvent& event, string* json) {
   auto duration_ps = std::max(event.duration_ps(), protobuf_uint64{1});
   absl::StrAppend(json, R"({"ph":"X","pid":)", event.device_id(), R"(,"tid":)",
@@ -103,29 +114,58 @@ inline void AddTraceEvent(const TraceEvent& event, string* json) {
   absl::StrAppend(json, "},");
 }
 
+constexpr char kJsonPrefix[] =
+    R"({"displayTimeUnit":"ns","metadata":{"highres-ticks":true},)"
+    R"("traceEvents":[)";
+
+// Add one fake event to avoid dealing with no-trailing-comma rule.
+constexpr char kJsonSuffix[] = "{}]}";
+
 }  // namespace
 
 std::string TraceEventsToJson(const Trace& trace) {
-  std::string json =
-      R"({"displayTimeUnit":"ns","metadata":{"highres-ticks":true},)"
-      R"("traceEvents":[)";
+  std::string json = kJsonPrefix;
   for (const auto* id_and_device : SortByKey(trace.devices())) {
-    uint32 device_id = id_and_device->first;
-    const Device& device = id_and_device->second;
-    AddDeviceMetadata(device_id, device, &json);
-    for (const auto* id_and_resource : SortByKey(device.resources())) {
-      uint32 resource_id = id_and_resource->first;
-      const Resource& resource = id_and_resource->second;
-      AddResourceMetadata(device_id, resource_id, resource, &json);
-    }
+    AddDeviceAndResourcesMetadata(id_and_device->first, id_and_device->second,
+                                  &json);
   }
   for (const TraceEvent& event : trace.trace_events()) {
     AddTraceEvent(event, &json);
   }
-  // Add one fake event to avoid dealing with no-trailing-comma rule.
-  absl::StrAppend(&json, "{}]}");
+  absl::StrAppend(&json, kJsonSuffix);
   return json;
 }
 
+TraceEventsJsonWriter::TraceEventsJsonWriter(WritableFile* output,
+                                             size_t chunk_size)
+    : output_(output), chunk_size_(chunk_size), buffer_(kJsonPrefix) {
+  buffer_.reserve(chunk_size_);
+}
+
+void TraceEventsJsonWriter::WriteDevice(uint32 device_id,
+                                        const Device& device) {
+  AddDeviceAndResourcesMetadata(device_id, device, &buffer_);
+  MaybeFlush();
+}
+
+void TraceEventsJsonWriter::WriteEvent(const TraceEvent& event) {
+  AddTraceEvent(event, &buffer_);
+  MaybeFlush();
+}
+
+Status TraceEventsJsonWriter::Finish() {
+  absl::StrAppend(&buffer_, kJsonSuffix);
+  if (status_.ok()) status_ = output_->Append(buffer_);
+  if (status_.ok()) status_ = output_->Flush();
+  buffer_.clear();
+  return status_;
+}
+
+void TraceEventsJsonWriter::MaybeFlush() {
+  if (buffer_.size() < chunk_size_) return;
+  if (status_.ok()) status_ = output_->Append(buffer_);
+  buffer_.clear();
+}
+
 }  // namespace profiler
 }  // namespace tensorflow
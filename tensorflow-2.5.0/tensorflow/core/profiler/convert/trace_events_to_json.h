@@ -18,6 +18,8 @@ limitations under the License.
 
 #include <string>
 
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/protobuf/trace_events.pb.h"
 
@@ -28,6 +30,35 @@ namespace profiler {
 // consumed by catapult trace viewer.
 std::string TraceEventsToJson(const Trace& trace);
 
+// Writes the same JSON as TraceEventsToJson incrementally, so that traces too
+// large to hold in memory can be converted. The JSON is appended to `output`
+// in chunks of about `chunk_size` bytes. Devices and events may be written in
+// any order and interleaved; the first error is reported by Finish().
+class TraceEventsJsonWriter {
+ public:
+  static constexpr size_t kDefaultChunkSize = 1 << 20;
+
+  explicit TraceEventsJsonWriter(WritableFile* output,
+                                 size_t chunk_size = kDefaultChunkSize);
+
+  // Writes the metadata of `device` and of its resources.
+  void WriteDevice(uint32 device_id, const Device& device);
+
+  void WriteEvent(const TraceEvent& event);
+
+  // Terminates the JSON and flushes it to `output`. Nothing may be written
+  // afterwards.
+  Status Finish();
+
+ private:
+  void MaybeFlush();
+
+  WritableFile* output_;
+  const size_t chunk_size_;
+  std::string buffer_;
+  Status status_;
+};
+
 }  // namespace profiler
 }  // namespace tensorflow
 
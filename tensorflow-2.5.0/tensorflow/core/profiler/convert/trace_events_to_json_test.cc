@@ -18,7 +18,10 @@ limitations under the License.
 #include <string>
 
 #include "json/json.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/file_system.h"
 #include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/profiler/protobuf/trace_events.pb.h"
 
@@ -26,6 +29,26 @@ namespace tensorflow {
 namespace profiler {
 namespace {
 
+class StringWritableFile : public WritableFile {
+ public:
+  explicit StringWritableFile(std::string* contents) : contents_(contents) {}
+
+  Status Append(StringPiece data) override {
+    contents_->append(data.data(), data.size());
+    ++num_appends_;
+    return Status::OK();
+  }
+  Status Close() override { return Status::OK(); }
+  Status Flush() override { return Status::OK(); }
+  Status Sync() override { return Status::OK(); }
+
+  int num_appends() const { return num_appends_; }
+
+ private:
+  std::string* contents_;
+  int num_appends_ = 0;
+};
+
 std::string ConvertTextFormattedTraceToJson(const std::string& trace_str) {
   Trace trace;
   EXPECT_TRUE(protobuf::TextFormat::ParseFromString(trace_str, &trace));
@@ -122,6 +145,51 @@ TEST(TraceEventsToJson, JsonConversion) {
   EXPECT_EQ(json, expected_json);
 }
 
+TEST(TraceEventsToJson, StreamingWriterMatchesTraceEventsToJson) {
+  Trace trace;
+  ASSERT_TRUE(protobuf::TextFormat::ParseFromString(R"proto(
+    devices {
+      key: 1
+      value {
+        name: 'D1'
+        device_id: 1
+        resources {
+          key: 2
+          value { resource_id: 2 name: 'R1.2' }
+        }
+      }
+    }
+    trace_events {
+      device_id: 1
+      resource_id: 2
+      name: 'E1'
+      timestamp_ps: 100000
+      duration_ps: 10000
+      args { key: 'arg' value: 'val' }
+    }
+    trace_events {
+      device_id: 1
+      resource_id: 2
+      name: 'E2'
+      timestamp_ps: 120000
+      duration_ps: 5000
+    }
+  )proto", &trace));
+
+  std::string json;
+  StringWritableFile output(&json);
+  TraceEventsJsonWriter writer(&output, /*chunk_size=*/64);
+  writer.WriteDevice(1, trace.devices().at(1));
+  for (const TraceEvent& event : trace.trace_events()) {
+    writer.WriteEvent(event);
+  }
+  TF_ASSERT_OK(writer.Finish());
+
+  EXPECT_EQ(json, TraceEventsToJson(trace));
+  // The small chunk size makes the writer flush more than once.
+  EXPECT_GT(output.num_appends(), 1);
+}
+
 }  // namespace
 }  // namespace profiler
 }  // namespace tensorflow
@@ -24,7 +24,10 @@ limitations under the License.
 
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/convert/trace_events_to_json.h"
 #include "tensorflow/core/profiler/protobuf/trace_events.pb.h"
 #include "tensorflow/core/profiler/protobuf/xplane.pb.h"
 #include "tensorflow/core/profiler/utils/tf_xplane_visitor.h"
@@ -58,6 +61,37 @@ void BuildDeviceAndResources(uint32 device_id, const XPlaneVisitor& plane,
   });
 }
 
+bool IsInternalXEvent(const XEventVisitor& xevent) {
+  int64 event_type =
+      xevent.Type().value_or(HostEventType::kUnknownHostEventType);
+  return IsInternalEvent(event_type);
+}
+
+void ConvertXEventToTraceEvent(uint32 device_id, uint32 resource_id,
+                               const XEventVisitor& xevent,
+                               TraceEvent* event) {
+  auto& args = *event->mutable_args();
+  event->set_device_id(device_id);
+  event->set_resource_id(resource_id);
+  if (xevent.HasDisplayName()) {
+    event->set_name(std::string(xevent.DisplayName()));
+    args["long_name"] = std::string(xevent.Name());
+  } else {
+    event->set_name(std::string(xevent.Name()));
+  }
+  event->set_timestamp_ps(xevent.TimestampPs());
+  event->set_duration_ps(xevent.DurationPs());
+
+  xevent.ForEachStat([&](const XStatVisitor& stat) {
+    if (stat.ValueCase() == XStat::VALUE_NOT_SET) return;
+    if (IsInternalStat(stat.Type())) return;
+    if (stat.Type() == StatType::kStepName) {
+      event->set_name(stat.ToString());
+    }
+    args[std::string(stat.Name())] = stat.ToString();
+  });
+}
+
 void ConvertXPlaneToTraceEvents(uint32 device_id, const XPlaneVisitor& xplane,
                                 Trace* trace) {
   // Convert devices and resources.
@@ -69,34 +103,67 @@ void ConvertXPlaneToTraceEvents(uint32 device_id, const XPlaneVisitor& xplane,
     uint32 resource_id = xline.DisplayId();
     xline.ForEachEvent(
         [device_id, resource_id, trace](const XEventVisitor& xevent) {
-          int64 event_type =
-              xevent.Type().value_or(HostEventType::kUnknownHostEventType);
-          if (IsInternalEvent(event_type)) return;
-          auto* event = trace->add_trace_events();
-          auto& args = *event->mutable_args();
-          event->set_device_id(device_id);
-          event->set_resource_id(resource_id);
-          if (xevent.HasDisplayName()) {
-            event->set_name(std::string(xevent.DisplayName()));
-            args["long_name"] = std::string(xevent.Name());
-          } else {
-            event->set_name(std::string(xevent.Name()));
-          }
-          event->set_timestamp_ps(xevent.TimestampPs());
-          event->set_duration_ps(xevent.DurationPs());
-
-          xevent.ForEachStat([&](const XStatVisitor& stat) {
-            if (stat.ValueCase() == XStat::VALUE_NOT_SET) return;
-            if (IsInternalStat(stat.Type())) return;
-            if (stat.Type() == StatType::kStepName) {
-              event->set_name(stat.ToString());
-            }
-            args[std::string(stat.Name())] = stat.ToString();
-          });
+          if (IsInternalXEvent(xevent)) return;
+          ConvertXEventToTraceEvent(device_id, resource_id, xevent,
+                                    trace->add_trace_events());
         });
   });
 }
 
+void StreamXPlaneToTraceEvents(uint32 device_id, const XPlaneVisitor& xplane,
+                               const TraceEventsOptions& options,
+                               TraceEventsJsonWriter* writer) {
+  Device device;
+  BuildDeviceAndResources(device_id, xplane, &device);
+  writer->WriteDevice(device_id, device);
+
+  TraceEvent event;
+  xplane.ForEachLine([&](const XLineVisitor& xline) {
+    uint32 resource_id = xline.DisplayId();
+    // Events on a line are in time order, so short events can be downsampled
+    // by keeping the first one in each resolution_ps interval.
+    uint64 next_short_event_ps = 0;
+    xline.ForEachEvent([&](const XEventVisitor& xevent) {
+      if (IsInternalXEvent(xevent)) return;
+      uint64 timestamp_ps = xevent.TimestampPs();
+      uint64 duration_ps = xevent.DurationPs();
+      if (timestamp_ps >= options.end_time_ps ||
+          timestamp_ps + duration_ps < options.start_time_ps) {
+        return;
+      }
+      if (duration_ps < options.resolution_ps) {
+        if (timestamp_ps < next_short_event_ps) return;
+        next_short_event_ps = timestamp_ps + options.resolution_ps;
+      }
+      event.Clear();
+      ConvertXEventToTraceEvent(device_id, resource_id, xevent, &event);
+      writer->WriteEvent(event);
+    });
+  });
+}
+
+// Calls `fn(device_id, xplane)` for the host plane and then for the device
+// planes of `xspace`.
+template <typename Fn>
+void ForEachTracePlane(const XSpace& xspace, Fn fn) {
+  const XPlane* host_plane = FindPlaneWithName(xspace, kHostThreadsPlaneName);
+  if (host_plane != nullptr) {
+    XPlaneVisitor xplane = CreateTfXPlaneVisitor(host_plane);
+    fn(kHostThreadsDeviceId, xplane);
+  }
+  std::vector<const XPlane*> device_planes =
+      FindPlanesWithPrefix(xspace, kGpuPlanePrefix);
+  // We don't expect GPU and TPU planes to be present in the same XSpace.
+  if (device_planes.empty()) {
+    device_planes = FindPlanesWithPrefix(xspace, kTpuPlanePrefix);
+  }
+  for (const XPlane* device_plane : device_planes) {
+    XPlaneVisitor xplane = CreateTfXPlaneVisitor(device_plane);
+    uint32 device_id = kFirstDeviceId + xplane.Id();
+    fn(device_id, xplane);
+  }
+}
+
 }  // namespace
 
 void MaybeDropEventsForTraceViewer(Trace* trace, uint32 limit) {
@@ -121,22 +188,10 @@ void MaybeDropEventsForTraceViewer(Trace* trace, uint32 limit) {
 }
 
 void ConvertXSpaceToTraceEvents(const XSpace& xspace, Trace* trace) {
-  const XPlane* host_plane = FindPlaneWithName(xspace, kHostThreadsPlaneName);
-  if (host_plane != nullptr) {
-    XPlaneVisitor xplane = CreateTfXPlaneVisitor(host_plane);
-    ConvertXPlaneToTraceEvents(kHostThreadsDeviceId, xplane, trace);
-  }
-  std::vector<const XPlane*> device_planes =
-      FindPlanesWithPrefix(xspace, kGpuPlanePrefix);
-  // We don't expect GPU and TPU planes to be present in the same XSpace.
-  if (device_planes.empty()) {
-    device_planes = FindPlanesWithPrefix(xspace, kTpuPlanePrefix);
-  }
-  for (const XPlane* device_plane : device_planes) {
-    XPlaneVisitor xplane = CreateTfXPlaneVisitor(device_plane);
-    uint32 device_id = kFirstDeviceId + xplane.Id();
+  ForEachTracePlane(xspace, [trace](uint32 device_id,
+                                    const XPlaneVisitor& xplane) {
     ConvertXPlaneToTraceEvents(device_id, xplane, trace);
-  }
+  });
 
   // Trace viewer (non-streaming) has scalability issues, we need to drop
   // events to avoid loading failure for trace viewer.
@@ -151,5 +206,16 @@ void ConvertXSpaceToTraceEventsString(const XSpace& xspace,
   trace.SerializeToString(content);
 }
 
+Status ConvertXSpaceToTraceEventsJson(const XSpace& xspace,
+                                      const TraceEventsOptions& options,
+                                      WritableFile* output) {
+  TraceEventsJsonWriter writer(output);
+  ForEachTracePlane(xspace, [&](uint32 device_id,
+                                const XPlaneVisitor& xplane) {
+    StreamXPlaneToTraceEvents(device_id, xplane, options, &writer);
+  });
+  return writer.Finish();
+}
+
 }  // namespace profiler
 }  // namespace tensorflow
@@ -18,6 +18,8 @@ limitations under the License.
 
 #include <string>
 
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/protobuf/trace_events.pb.h"
 #include "tensorflow/core/profiler/protobuf/xplane.pb.h"
@@ -30,6 +32,22 @@ void ConvertXSpaceToTraceEvents(const XSpace& xspace, Trace* trace);
 void ConvertXSpaceToTraceEventsString(const XSpace& xspace,
                                       std::string* content);
 
+struct TraceEventsOptions {
+  // Only events overlapping [start_time_ps, end_time_ps) are converted.
+  uint64 start_time_ps = 0;
+  uint64 end_time_ps = kuint64max;
+  // If non-zero, events shorter than resolution_ps are downsampled to at most
+  // one per resolution_ps on each line. Longer events are always kept.
+  uint64 resolution_ps = 0;
+};
+
+// Converts `xspace` to trace viewer JSON and streams it to `output` one event
+// at a time, instead of building the whole Trace in memory. Unlike
+// ConvertXSpaceToTraceEvents, events are only dropped as per `options`.
+Status ConvertXSpaceToTraceEventsJson(const XSpace& xspace,
+                                      const TraceEventsOptions& options,
+                                      WritableFile* output);
+
 // Not Public API, Testing only.
 void MaybeDropEventsForTraceViewer(Trace* trace, uint32 limit);
 
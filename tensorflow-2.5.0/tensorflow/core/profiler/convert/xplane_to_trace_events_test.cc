@@ -15,6 +15,13 @@ limitations under the License.
 
 #include "tensorflow/core/profiler/convert/xplane_to_trace_events.h"
 
+#include <string>
+#include <vector>
+
+#include "json/json.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/profiler/protobuf/trace_events.pb.h"
 #include "tensorflow/core/profiler/protobuf/xplane.pb.h"
@@ -59,6 +66,36 @@ void CreateXSpace(XSpace* space) {
                       55);
 }
 
+class StringWritableFile : public WritableFile {
+ public:
+  explicit StringWritableFile(std::string* contents) : contents_(contents) {}
+
+  Status Append(StringPiece data) override {
+    contents_->append(data.data(), data.size());
+    return Status::OK();
+  }
+  Status Close() override { return Status::OK(); }
+  Status Flush() override { return Status::OK(); }
+  Status Sync() override { return Status::OK(); }
+
+ private:
+  std::string* contents_;
+};
+
+// Returns the names of the complete events in trace viewer JSON.
+std::vector<std::string> GetEventNames(const std::string& json_str) {
+  Json::Value json;
+  Json::Reader reader;
+  EXPECT_TRUE(reader.parse(json_str, json));
+  std::vector<std::string> names;
+  for (const Json::Value& event : json["traceEvents"]) {
+    if (event["ph"].asString() == "X") {
+      names.push_back(event["name"].asString());
+    }
+  }
+  return names;
+}
+
 TEST(ConvertXPlaneToTraceEvents, Convert) {
   XSpace xspace;
   CreateXSpace(&xspace);
@@ -72,6 +109,63 @@ TEST(ConvertXPlaneToTraceEvents, Convert) {
   EXPECT_EQ(trace.trace_events_size(), 3);
 }
 
+TEST(ConvertXPlaneToTraceEvents, StreamToJson) {
+  XSpace xspace;
+  CreateXSpace(&xspace);
+
+  std::string json;
+  StringWritableFile output(&json);
+  TF_ASSERT_OK(ConvertXSpaceToTraceEventsJson(xspace, TraceEventsOptions(),
+                                              &output));
+
+  EXPECT_THAT(GetEventNames(json),
+              ::testing::UnorderedElementsAre("event1", "event2", "kernel1"));
+}
+
+TEST(ConvertXPlaneToTraceEvents, StreamTimeWindow) {
+  XSpace xspace;
+  CreateXSpace(&xspace);
+
+  // Overlaps event2 (160-170us) and kernel1 (180-190us) only.
+  TraceEventsOptions options;
+  options.start_time_ps = 165000000;
+  options.end_time_ps = 185000000;
+  std::string json;
+  StringWritableFile output(&json);
+  TF_ASSERT_OK(ConvertXSpaceToTraceEventsJson(xspace, options, &output));
+
+  EXPECT_THAT(GetEventNames(json),
+              ::testing::UnorderedElementsAre("event2", "kernel1"));
+}
+
+TEST(ConvertXPlaneToTraceEvents, StreamResolution) {
+  XSpace xspace;
+  XPlaneBuilder host_plane(xspace.add_planes());
+  host_plane.SetName(kHostThreadsPlaneName);
+  XLineBuilder thread = host_plane.GetOrCreateLine(10);
+  auto add_event = [&](absl::string_view name, int64 timestamp_ns,
+                       int64 duration_ns) {
+    XEventBuilder event =
+        thread.AddEvent(*host_plane.GetOrCreateEventMetadata(name));
+    event.SetTimestampNs(timestamp_ns);
+    event.SetDurationNs(duration_ns);
+  };
+  add_event("short1", 1000, 10);
+  add_event("short2", 1050, 10);
+  add_event("long", 1100, 500);
+  add_event("short3", 1200, 10);
+
+  TraceEventsOptions options;
+  options.resolution_ps = 100000;
+  std::string json;
+  StringWritableFile output(&json);
+  TF_ASSERT_OK(ConvertXSpaceToTraceEventsJson(xspace, options, &output));
+
+  // short2 falls within the resolution of short1; long events are kept.
+  EXPECT_THAT(GetEventNames(json),
+              ::testing::UnorderedElementsAre("short1", "long", "short3"));
+}
+
 TEST(ConvertXPlaneToTraceEvents, Drop) {
   Trace trace;
   for (int i = 0; i < 100; i++) {
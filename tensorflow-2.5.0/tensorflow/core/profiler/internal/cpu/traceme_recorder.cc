@@ -18,6 +18,8 @@ limitations under the License.
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
+#include <deque>
 #include <memory>
 #include <new>
 #include <utility>
@@ -103,18 +105,20 @@ class SplitEventTracker {
 // start_ is the first occupied slot, end_ is the first unoccupied slot.
 //
 // Push writes at end_, and then advances it, allocating a block if needed.
-// Consume takes ownership of events in the range [start_, end_).
+// PopAll takes ownership of events in the range [start_, end_).
 // Clear removes events in the range [start_, end_).
-// The end_ pointer is atomic so Push and Consume can be concurrent.
+// The end_ pointer is atomic so Push and PopAll can be concurrent. The start_
+// pointer is atomic so Push can drop events once the queue holds capacity_
+// events, which bounds its memory if it isn't drained quickly enough.
 //
-// Push and Consume are lock free and each might be called from at most one
-// thread. Push is only called by the owner thread. Consume is only called by
-// the tracing control thread.
+// Push and PopAll are lock free and each might be called from at most one
+// thread at a time. Push is only called by the owner thread. PopAll is only
+// called by the tracing control or drain thread, under TraceMeRecorder::mutex_.
 //
-// Thus, Consume might race with Push, so Consume only removes events that were
-// in the queue when it was invoked. If Push is called while Consume is active,
+// Thus, PopAll might race with Push, so PopAll only removes events that were
+// in the queue when it was invoked. If Push is called while PopAll is active,
 // the new event remains in the queue. Thus, the tracing control thread should
-// call Consume when tracing stops to remove events created during tracing, and
+// call PopAll when tracing stops to remove events created during tracing, and
 // Clear when tracing starts again to remove any remaining events.
 class EventQueue {
  public:
@@ -122,7 +126,7 @@ class EventQueue {
       : start_block_(new Block{/*start=*/0, /*next=*/nullptr}),
         start_(start_block_->start),
         end_block_(start_block_),
-        end_(start_) {}
+        end_(start_block_->start) {}
 
   // Memory should be deallocated and trace events destroyed on destruction.
   // This doesn't require global lock as this discards all the stored trace
@@ -135,8 +139,15 @@ class EventQueue {
   }
 
   // Add a new event to the back of the queue. Fast and lock-free.
+  // Drops the event if the queue is full.
   void Push(TraceMeRecorder::Event&& event) {
     size_t end = end_.load(std::memory_order_relaxed);
+    // A stale start_ only makes the queue look fuller than it is.
+    if (TF_PREDICT_FALSE(end - start_.load(std::memory_order_relaxed) >=
+                         capacity_.load(std::memory_order_relaxed))) {
+      num_dropped_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
     new (&end_block_->events[end++ - end_block_->start].event)
         TraceMeRecorder::Event(std::move(event));
     if (TF_PREDICT_FALSE(end - end_block_->start == Block::kNumSlots)) {
@@ -150,62 +161,57 @@ class EventQueue {
   // Removes all events from the queue.
   void Clear() {
     size_t end = end_.load(std::memory_order_acquire);
-    while (start_ != end) {
+    while (start_.load(std::memory_order_relaxed) != end) {
       Pop();
     }
   }
 
-  // Retrieve and remove all events in the queue at the time of invocation.
-  // If Push is called while Consume is active, the new event will not be
-  // removed from the queue.
-  // Consume is only called from ThreadLocalRecorder::Clear, which in turn is
-  // only called while holding TraceMeRecorder::Mutex, so Consume has a single
-  // caller at a time.
-  TF_MUST_USE_RESULT std::deque<TraceMeRecorder::Event> Consume(
-      SplitEventTracker* split_event_tracker) {
+  // Moves all events in the queue at the time of invocation to the back of
+  // `events`. If Push is called while PopAll is active, the new event will not
+  // be removed from the queue.
+  void PopAll(std::deque<TraceMeRecorder::Event>* events) {
     // Read index before contents.
     size_t end = end_.load(std::memory_order_acquire);
-    std::deque<TraceMeRecorder::Event> result;
-    while (start_ != end) {
-      TraceMeRecorder::Event event = Pop();
-      // Copy data from start events to end events. TraceMe records events in
-      // its destructor, so this results in complete events sorted by their
-      // end_time in the thread they ended. Within the same thread, the start
-      // event must appear before the corresponding end event.
-      if (event.IsStart()) {
-        split_event_tracker->AddStart(std::move(event));
-        continue;
-      }
-      result.emplace_back(std::move(event));
-      if (result.back().IsEnd()) {
-        split_event_tracker->AddEnd(&result.back());
-      }
+    while (start_.load(std::memory_order_relaxed) != end) {
+      events->push_back(Pop());
     }
-    return result;
+  }
+
+  // Sets the maximum number of events held by the queue.
+  void SetCapacity(size_t capacity) {
+    capacity_.store(capacity, std::memory_order_relaxed);
+  }
+
+  // Returns the number of events dropped by Push since the last call.
+  size_t TakeNumDropped() {
+    return num_dropped_.exchange(0, std::memory_order_relaxed);
   }
 
  private:
   // Returns true if the queue is empty at the time of invocation.
   bool Empty() const {
-    return (start_ == end_.load(std::memory_order_acquire));
+    return start_.load(std::memory_order_relaxed) ==
+           end_.load(std::memory_order_acquire);
   }
 
   // Remove one event off the front of the queue and return it.
   // REQUIRES: The queue must not be empty.
   TraceMeRecorder::Event Pop() {
     DCHECK(!Empty());
+    size_t start = start_.load(std::memory_order_relaxed);
     // Move the next event into the output.
-    auto& event = start_block_->events[start_++ - start_block_->start].event;
+    auto& event = start_block_->events[start++ - start_block_->start].event;
     TraceMeRecorder::Event out = std::move(event);
     event.~Event();  // Events must be individually destroyed.
     // If we reach the end of a block, we own it and should delete it.
     // The next block is present: end always points to something.
-    if (TF_PREDICT_FALSE(start_ - start_block_->start == Block::kNumSlots)) {
+    if (TF_PREDICT_FALSE(start - start_block_->start == Block::kNumSlots)) {
       auto* next_block = start_block_->next;
       delete start_block_;
       start_block_ = next_block;
-      DCHECK_EQ(start_, start_block_->start);
+      DCHECK_EQ(start, start_block_->start);
     }
+    start_.store(start, std::memory_order_relaxed);
     return out;
   }
 
@@ -231,10 +237,13 @@ class EventQueue {
 
   // Head of list for reading. Only accessed by consumer thread.
   Block* start_block_;
-  size_t start_;
+  std::atomic<size_t> start_;  // Atomic: also read by producer thread.
   // Tail of list for writing. Accessed by producer thread.
   Block* end_block_;
   std::atomic<size_t> end_;  // Atomic: also read by consumer thread.
+
+  std::atomic<size_t> capacity_{TraceMeRecorder::kDefaultMaxEventsPerThread};
+  std::atomic<size_t> num_dropped_{0};
 };
 
 }  // namespace
@@ -261,17 +270,58 @@ class TraceMeRecorder::ThreadLocalRecorder {
 
   // Clear is called from the control thread when tracing starts to remove any
   // elements added due to Record racing with Consume.
-  void Clear() { queue_.Clear(); }
+  void Clear(size_t max_events) {
+    queue_.SetCapacity(max_events);
+    queue_.Clear();
+    queue_.TakeNumDropped();
+    events_.clear();
+    num_overwritten_ = 0;
+  }
+
+  // Drain is called from the drain thread while tracing is active. It moves
+  // events out of the queue, keeping only the last max_events.
+  void Drain(size_t max_events) {
+    queue_.PopAll(&events_);
+    while (events_.size() > max_events) {
+      events_.pop_front();
+      ++num_overwritten_;
+    }
+  }
 
   // Consume is called from the control thread when tracing stops.
+  // Adds the number of events dropped or overwritten to *num_dropped.
   TF_MUST_USE_RESULT TraceMeRecorder::ThreadEvents Consume(
-      SplitEventTracker* split_event_tracker) {
-    return {info_, queue_.Consume(split_event_tracker)};
+      SplitEventTracker* split_event_tracker, size_t max_events,
+      size_t* num_dropped) {
+    Drain(max_events);
+    std::deque<TraceMeRecorder::Event> result;
+    for (TraceMeRecorder::Event& event : events_) {
+      // Copy data from start events to end events. TraceMe records events in
+      // its destructor, so this results in complete events sorted by their
+      // end_time in the thread they ended. Within the same thread, the start
+      // event must appear before the corresponding end event.
+      if (event.IsStart()) {
+        split_event_tracker->AddStart(std::move(event));
+        continue;
+      }
+      result.emplace_back(std::move(event));
+      if (result.back().IsEnd()) {
+        split_event_tracker->AddEnd(&result.back());
+      }
+    }
+    events_.clear();
+    *num_dropped += num_overwritten_ + queue_.TakeNumDropped();
+    num_overwritten_ = 0;
+    return {info_, std::move(result)};
   }
 
  private:
   TraceMeRecorder::ThreadInfo info_;
   EventQueue queue_;
+  // Events moved out of queue_ by Drain. Only accessed by the control and
+  // drain threads, under TraceMeRecorder::mutex_.
+  std::deque<TraceMeRecorder::Event> events_;
+  size_t num_overwritten_ = 0;
   bool active_ = true;
 };
 
@@ -310,6 +360,8 @@ class TraceMeRecorder::ThreadLocalRecorderWrapper {
 void TraceMeRecorder::RegisterThread(
     uint32 tid, std::shared_ptr<ThreadLocalRecorder> thread) {
   mutex_lock lock(mutex_);
+  // The thread has not recorded anything yet, this only sets its capacity.
+  thread->Clear(max_events_per_thread_);
   threads_.insert_or_assign(tid, std::move(thread));
 }
 
@@ -328,7 +380,7 @@ void TraceMeRecorder::UnregisterThread(uint32 tid) {
 void TraceMeRecorder::Clear() {
   for (auto& id_and_recorder : threads_) {
     auto& recorder = id_and_recorder.second;
-    recorder->Clear();
+    recorder->Clear(max_events_per_thread_);
     // We should not have an inactive ThreadLocalRecorder here. If a thread is
     // destroyed while tracing is inactive, its ThreadLocalRecorder is removed
     // in UnregisterThread.
@@ -344,10 +396,11 @@ TraceMeRecorder::Events TraceMeRecorder::Consume() {
   TraceMeRecorder::Events result;
   result.reserve(threads_.size());
   SplitEventTracker split_event_tracker;
+  size_t num_dropped = 0;
   for (auto iter = threads_.begin(); iter != threads_.end();) {
     auto& recorder = iter->second;
-    TraceMeRecorder::ThreadEvents events =
-        recorder->Consume(&split_event_tracker);
+    TraceMeRecorder::ThreadEvents events = recorder->Consume(
+        &split_event_tracker, max_events_per_thread_, &num_dropped);
     if (!events.events.empty()) {
       result.push_back(std::move(events));
     }
@@ -360,21 +413,44 @@ TraceMeRecorder::Events TraceMeRecorder::Consume() {
     }
   }
   split_event_tracker.HandleCrossThreadEvents();
+  if (num_dropped > 0) {
+    LOG(WARNING) << "TraceMeRecorder dropped " << num_dropped
+                 << " events; at most " << max_events_per_thread_
+                 << " events are kept per thread.";
+  }
   return result;
 }
 
-bool TraceMeRecorder::StartRecording(int level) {
-  level = std::max(0, level);
+void TraceMeRecorder::DrainLoop() {
+  constexpr int64 kDrainIntervalMs = 20;
   mutex_lock lock(mutex_);
-  // Change trace_level_ while holding mutex_.
-  int expected = kTracingDisabled;
-  bool started = internal::g_trace_level.compare_exchange_strong(
-      expected, level, std::memory_order_acq_rel);
-  if (started) {
+  while (!stop_draining_) {
+    drain_cv_.wait_for(lock, std::chrono::milliseconds(kDrainIntervalMs));
+    if (stop_draining_) break;
+    for (auto& id_and_recorder : threads_) {
+      id_and_recorder.second->Drain(max_events_per_thread_);
+    }
+  }
+}
+
+bool TraceMeRecorder::StartRecording(int level, size_t max_events_per_thread) {
+  level = std::max(0, level);
+  mutex_lock control_lock(control_mutex_);
+  {
+    mutex_lock lock(mutex_);
+    // Change trace_level_ while holding mutex_.
+    int expected = kTracingDisabled;
+    bool started = internal::g_trace_level.compare_exchange_strong(
+        expected, level, std::memory_order_acq_rel);
+    if (!started) return false;
+    max_events_per_thread_ = std::max<size_t>(max_events_per_thread, 1);
+    stop_draining_ = false;
     // We may have old events in buffers because Record() raced with Stop().
     Clear();
   }
-  return started;
+  drain_thread_.reset(Env::Default()->StartThread(
+      ThreadOptions(), "traceme_recorder_drain", [this] { DrainLoop(); }));
+  return true;
 }
 
 void TraceMeRecorder::Record(Event&& event) {
@@ -384,12 +460,19 @@ void TraceMeRecorder::Record(Event&& event) {
 
 TraceMeRecorder::Events TraceMeRecorder::StopRecording() {
   TraceMeRecorder::Events events;
-  mutex_lock lock(mutex_);
-  // Change trace_level_ while holding mutex_.
-  if (internal::g_trace_level.exchange(
-          kTracingDisabled, std::memory_order_acq_rel) != kTracingDisabled) {
-    events = Consume();
+  mutex_lock control_lock(control_mutex_);
+  {
+    mutex_lock lock(mutex_);
+    // Change trace_level_ while holding mutex_.
+    if (internal::g_trace_level.exchange(
+            kTracingDisabled, std::memory_order_acq_rel) != kTracingDisabled) {
+      events = Consume();
+    }
+    stop_draining_ = true;
+    drain_cv_.notify_all();
   }
+  // Joins the drain thread, which exits without draining again.
+  drain_thread_.reset();
   return events;
 }
 
@@ -22,6 +22,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -49,6 +50,11 @@ TF_EXPORT extern std::atomic<int> g_trace_level;
 // events. TraceMe::ActivityStart records start events, and TraceMe::ActivityEnd
 // records end events. The profiler then stops the recorder and finds start/end
 // pairs. (Unpaired start/end events are discarded at that point).
+//
+// Memory is bounded: while recording, a background thread periodically moves
+// events out of the per-thread queues into per-thread buffers that keep only
+// the most recent max_events_per_thread events. A thread that records faster
+// than the queue is drained drops its newest events instead.
 class TraceMeRecorder {
  public:
   // An Event is either the start of a TraceMe, the end of a TraceMe, or both.
@@ -80,10 +86,17 @@ class TraceMeRecorder {
   };
   using Events = std::vector<ThreadEvents>;
 
+  // Default number of events kept per thread, about 12MB for short names.
+  static constexpr size_t kDefaultMaxEventsPerThread = 1 << 18;
+
   // Starts recording of TraceMe().
   // Only traces <= level will be recorded.
   // Level must be >= 0. If level is 0, no traces will be recorded.
-  static bool Start(int level) { return Get()->StartRecording(level); }
+  // At most max_events_per_thread of the last events of each thread are kept.
+  static bool Start(int level,
+                    size_t max_events_per_thread = kDefaultMaxEventsPerThread) {
+    return Get()->StartRecording(level, max_events_per_thread);
+  }
 
   // Stops recording and returns events recorded since Start().
   // Events passed to Record after Stop has started will be dropped.
@@ -117,7 +130,7 @@ class TraceMeRecorder {
   void RegisterThread(uint32 tid, std::shared_ptr<ThreadLocalRecorder> thread);
   void UnregisterThread(uint32 tid);
 
-  bool StartRecording(int level);
+  bool StartRecording(int level, size_t max_events_per_thread);
   Events StopRecording();
 
   // Clears events from all active threads that were added due to Record
@@ -127,7 +140,19 @@ class TraceMeRecorder {
   // Gathers events from all active threads, and clears their buffers.
   TF_MUST_USE_RESULT Events Consume() TF_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
+  // Body of drain_thread_: periodically moves events out of the per-thread
+  // queues until stop_draining_ is set.
+  void DrainLoop();
+
+  // Serializes StartRecording and StopRecording. Acquired before mutex_.
+  mutex control_mutex_;
+  std::unique_ptr<Thread> drain_thread_ TF_GUARDED_BY(control_mutex_);
+
   mutex mutex_;
+  condition_variable drain_cv_;
+  bool stop_draining_ TF_GUARDED_BY(mutex_) = false;
+  size_t max_events_per_thread_ TF_GUARDED_BY(mutex_) =
+      kDefaultMaxEventsPerThread;
   // A ThreadLocalRecorder stores trace events. Ownership is shared with
   // ThreadLocalRecorderWrapper, which is allocated in thread_local storage.
   // ThreadLocalRecorderWrapper creates the ThreadLocalRecorder and registers it
@@ -56,6 +56,21 @@ TEST(RecorderTest, SingleThreaded) {
               ElementsAre(Named("during1"), Named("during2")));
 }
 
+TEST(RecorderTest, BoundedEventsPerThread) {
+  constexpr int kMaxEventsPerThread = 10;
+  int64 start_time = GetCurrentTimeNanos();
+  int64 end_time = start_time + SecondsToNanos(1);
+
+  TraceMeRecorder::Start(/*level=*/1, kMaxEventsPerThread);
+  for (int i = 0; i < 10 * kMaxEventsPerThread; ++i) {
+    TraceMeRecorder::Record({absl::StrCat("event", i), start_time, end_time});
+  }
+  auto results = TraceMeRecorder::Stop();
+
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_EQ(results[0].events.size(), kMaxEventsPerThread);
+}
+
 // Checks the functional behavior of the recorder, when used from several
 // unsynchronized threads.
 //
@@ -15,20 +15,51 @@ limitations under the License.
 
 #include "tensorflow/core/profiler/rpc/profiler_server.h"
 
+#include <algorithm>
 #include <memory>
 #include <string>
 
 #include "grpcpp/grpcpp.h"
 #include "absl/strings/str_cat.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/profiler_service.grpc.pb.h"
 #include "tensorflow/core/profiler/rpc/profiler_service_impl.h"
+#include "tensorflow/core/profiler/rpc/sampling_profiler.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace profiler {
 
 void ProfilerServer::StartProfilerServer(int32 port) {
+  int64 sampling_period_ms = 0;
+  Status status = ReadInt64FromEnvVar("TF_PROFILER_SAMPLING_PERIOD_MS",
+                                      /*default_val=*/0, &sampling_period_ms);
+  if (!status.ok()) {
+    LOG(ERROR) << "Not sampling host activity: " << status;
+  } else if (sampling_period_ms > 0) {
+    SamplingProfilerOptions sampling_options;
+    sampling_options.period_ms = sampling_period_ms;
+    sampling_options.window_ms =
+        std::min<uint64>(sampling_options.window_ms, sampling_period_ms);
+    StartProfilerServer(port, sampling_options);
+    return;
+  }
+  StartServer(port);
+}
+
+void ProfilerServer::StartProfilerServer(
+    int32 port, const SamplingProfilerOptions& sampling_options) {
+  Status status =
+      SamplingProfiler::Start(sampling_options, &sampling_profiler_);
+  if (!status.ok()) {
+    LOG(ERROR) << "Unable to sample host activity: " << status;
+  }
+  StartServer(port);
+}
+
+void ProfilerServer::StartServer(int32 port) {
   VLOG(1) << "Starting profiler server.";
   std::string server_address = absl::StrCat("[::]:", port);
   service_ = CreateProfilerService();
@@ -20,6 +20,7 @@ limitations under the License.
 #include "grpcpp/grpcpp.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/profiler_service.grpc.pb.h"
+#include "tensorflow/core/profiler/rpc/sampling_profiler.h"
 
 namespace tensorflow {
 namespace profiler {
@@ -27,10 +28,19 @@ namespace profiler {
 class ProfilerServer {
  public:
   ~ProfilerServer();
-  // Starts a profiler server with a given port.
+  // Starts a profiler server with a given port. If the environment variable
+  // TF_PROFILER_SAMPLING_PERIOD_MS is positive, host activity is also sampled
+  // with that period for the Monitor RPC.
   void StartProfilerServer(int32 port);
+  // Starts a profiler server with a given port, and samples host activity in
+  // the background with `sampling_options` for the Monitor RPC.
+  void StartProfilerServer(int32 port,
+                           const SamplingProfilerOptions& sampling_options);
 
  private:
+  void StartServer(int32 port);
+
+  std::unique_ptr<SamplingProfiler> sampling_profiler_;
   std::unique_ptr<grpc::ProfilerService::Service> service_;
   std::unique_ptr<::grpc::Server> server_;
 };
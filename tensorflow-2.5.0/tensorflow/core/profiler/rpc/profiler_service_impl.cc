@@ -15,12 +15,18 @@ limitations under the License.
 
 #include "tensorflow/core/profiler/rpc/profiler_service_impl.h"
 
+#include <algorithm>
 #include <memory>
+#include <vector>
 
 #include "grpcpp/support/status.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_replace.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/errors.h"
@@ -31,8 +37,11 @@ limitations under the License.
 #include "tensorflow/core/profiler/lib/profiler_session.h"
 #include "tensorflow/core/profiler/profiler_service.grpc.pb.h"
 #include "tensorflow/core/profiler/profiler_service.pb.h"
+#include "tensorflow/core/profiler/protobuf/op_metrics.pb.h"
 #include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+#include "tensorflow/core/profiler/rpc/sampling_profiler.h"
 #include "tensorflow/core/profiler/utils/file_system_utils.h"
+#include "tensorflow/core/profiler/utils/op_metrics_db_utils.h"
 #include "tensorflow/core/profiler/utils/xplane_utils.h"
 
 namespace tensorflow {
@@ -69,16 +78,75 @@ Status CollectDataToRepository(const ProfileRequest& request,
   return WriteBinaryProto(Env::Default(), out_path, xspace);
 }
 
+// Formats the ops with the largest self time in `db`, all of them if `max_ops`
+// is negative.
+std::string FormatSampledOpMetrics(const OpMetricsDb& db, int max_ops) {
+  std::vector<const OpMetrics*> ops;
+  for (const OpMetrics& metrics : db.metrics_db()) {
+    if (!IsIdleOp(metrics)) ops.push_back(&metrics);
+  }
+  std::sort(ops.begin(), ops.end(), [](const OpMetrics* a, const OpMetrics* b) {
+    return a->self_time_ps() > b->self_time_ps();
+  });
+  if (max_ops >= 0 && ops.size() > static_cast<size_t>(max_ops)) {
+    ops.resize(max_ops);
+  }
+
+  std::string data = absl::StrFormat(
+      "Sampled %.1f ms of host activity, %.1f ms in ops.\n",
+      db.total_time_ps() / 1e9, db.total_op_time_ps() / 1e9);
+  absl::StrAppendFormat(&data, "%-48s %-24s %12s %14s %12s %8s\n", "Op",
+                        "Type", "Occurrences", "Self time (ms)",
+                        "Avg (us)", "% ops");
+  for (const OpMetrics* metrics : ops) {
+    const double avg_us =
+        metrics->occurrences() == 0
+            ? 0.0
+            : metrics->time_ps() / 1e6 / metrics->occurrences();
+    const double percent =
+        db.total_op_time_ps() == 0
+            ? 0.0
+            : 100.0 * metrics->self_time_ps() / db.total_op_time_ps();
+    absl::StrAppendFormat(&data, "%-48s %-24s %12d %14.3f %12.1f %7.1f%%\n",
+                          metrics->name(), metrics->category(),
+                          metrics->occurrences(),
+                          metrics->self_time_ps() / 1e9, avg_us, percent);
+  }
+  return data;
+}
+
 class ProfilerServiceImpl : public grpc::ProfilerService::Service {
  public:
+  // Reports the op metrics collected by the running SamplingProfiler over the
+  // last `duration_ms`: the top ops at monitoring level 1, all of them above.
   ::grpc::Status Monitor(::grpc::ServerContext* ctx, const MonitorRequest* req,
                          MonitorResponse* response) override {
-    return ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED, "unimplemented.");
+    OpMetricsDb db;
+    Status status =
+        SamplingProfiler::GetRunningOpMetricsDb(req->duration_ms(), &db);
+    if (!status.ok()) {
+      return ::grpc::Status(::grpc::StatusCode::FAILED_PRECONDITION,
+                            status.error_message());
+    }
+    constexpr int kMaxOpsAtLevelOne = 10;
+    std::string data = FormatSampledOpMetrics(
+        db, req->monitoring_level() <= 1 ? kMaxOpsAtLevelOne : -1);
+    if (req->timestamp()) {
+      data = absl::StrCat(
+          "Timestamp: ",
+          absl::FormatTime("%Y-%m-%d %H:%M:%S", absl::Now(),
+                           absl::LocalTimeZone()),
+          "\n", data);
+    }
+    response->set_data(data);
+    return ::grpc::Status::OK;
   }
 
   ::grpc::Status Profile(::grpc::ServerContext* ctx, const ProfileRequest* req,
                          ProfileResponse* response) override {
     VLOG(1) << "Received a profile request: " << req->DebugString();
+    // Keeps a running SamplingProfiler from holding the profiler.
+    SamplingProfiler::ScopedPause pause_sampling;
     std::unique_ptr<ProfilerSession> profiler =
         ProfilerSession::Create(req->opts());
     Status status = profiler->Status();
@@ -0,0 +1,70 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/profiler/rpc/profiler_service_impl.h"
+
+#include <memory>
+
+#include "grpcpp/grpcpp.h"
+#include "absl/strings/match.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/profiler/profiler_service.grpc.pb.h"
+#include "tensorflow/core/profiler/profiler_service.pb.h"
+#include "tensorflow/core/profiler/rpc/sampling_profiler.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+::grpc::Status Monitor(const MonitorRequest& request,
+                       MonitorResponse* response) {
+  std::unique_ptr<grpc::ProfilerService::Service> service =
+      CreateProfilerService();
+  ::grpc::ServerContext ctx;
+  return service->Monitor(&ctx, &request, response);
+}
+
+TEST(ProfilerServiceImplTest, MonitorFailsWithoutSamplingProfiler) {
+  MonitorRequest request;
+  MonitorResponse response;
+  EXPECT_EQ(Monitor(request, &response).error_code(),
+            ::grpc::StatusCode::FAILED_PRECONDITION);
+  EXPECT_TRUE(response.data().empty());
+}
+
+TEST(ProfilerServiceImplTest, MonitorReportsSampledWindows) {
+  SamplingProfilerOptions options;
+  options.window_ms = 10;
+  // Only the window sampled below is reported.
+  options.period_ms = 3600 * 1000;
+  std::unique_ptr<SamplingProfiler> profiler;
+  TF_ASSERT_OK(SamplingProfiler::Start(options, &profiler));
+  TF_ASSERT_OK(profiler->SampleWindow());
+
+  MonitorRequest request;
+  request.set_monitoring_level(2);
+  request.set_timestamp(true);
+  MonitorResponse response;
+  ASSERT_TRUE(Monitor(request, &response).ok());
+  EXPECT_TRUE(absl::StartsWith(response.data(), "Timestamp: "))
+      << response.data();
+  EXPECT_TRUE(absl::StrContains(response.data(), "Sampled "))
+      << response.data();
+}
+
+}  // namespace
+}  // namespace profiler
+}  // namespace tensorflow
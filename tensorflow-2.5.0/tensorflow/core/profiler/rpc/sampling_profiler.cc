@@ -0,0 +1,213 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/profiler/rpc/sampling_profiler.h"
+
+#include <memory>
+#include <utility>
+
+#include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/env_time.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/profiler/convert/xplane_to_op_metrics_db.h"
+#include "tensorflow/core/profiler/lib/profiler_session.h"
+#include "tensorflow/core/profiler/profiler_options.pb.h"
+#include "tensorflow/core/profiler/protobuf/op_metrics.pb.h"
+#include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+#include "tensorflow/core/profiler/utils/xplane_schema.h"
+#include "tensorflow/core/profiler/utils/xplane_utils.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+// Process-wide state shared by the running SamplingProfiler, the Monitor RPC
+// and ScopedPause.
+struct SamplingState {
+  mutex mu;
+  condition_variable window_ended;
+  SamplingProfiler* running TF_GUARDED_BY(mu) = nullptr;
+  int num_pauses TF_GUARDED_BY(mu) = 0;
+  bool in_window TF_GUARDED_BY(mu) = false;
+};
+
+SamplingState& GetSamplingState() {
+  static SamplingState* state = new SamplingState;
+  return *state;
+}
+
+}  // namespace
+
+Status SamplingProfiler::Start(const SamplingProfilerOptions& options,
+                               std::unique_ptr<SamplingProfiler>* profiler) {
+  if (options.window_ms == 0 || options.period_ms < options.window_ms) {
+    return errors::InvalidArgument(
+        "The sampling window must be positive and not longer than the period, "
+        "got window_ms=",
+        options.window_ms, " and period_ms=", options.period_ms);
+  }
+  if (options.max_windows <= 0 || options.max_ops_per_window < 0) {
+    return errors::InvalidArgument(
+        "max_windows must be positive and max_ops_per_window not negative.");
+  }
+  std::unique_ptr<SamplingProfiler> sampler(new SamplingProfiler(options));
+  {
+    SamplingState& state = GetSamplingState();
+    mutex_lock lock(state.mu);
+    if (state.running != nullptr) {
+      return errors::AlreadyExists("A sampling profiler is already running.");
+    }
+    state.running = sampler.get();
+  }
+  SamplingProfiler* raw_sampler = sampler.get();
+  sampler->thread_.reset(Env::Default()->StartThread(
+      ThreadOptions(), "tf_sampling_profiler",
+      [raw_sampler] { raw_sampler->Run(); }));
+  *profiler = std::move(sampler);
+  return Status::OK();
+}
+
+SamplingProfiler::SamplingProfiler(const SamplingProfilerOptions& options)
+    : options_(options),
+      windows_(options.max_windows, options.max_ops_per_window) {}
+
+SamplingProfiler::~SamplingProfiler() {
+  {
+    SamplingState& state = GetSamplingState();
+    mutex_lock lock(state.mu);
+    if (state.running == this) {
+      state.running = nullptr;
+    }
+  }
+  stopped_.Notify();
+  // Joins the thread.
+  thread_.reset();
+}
+
+void SamplingProfiler::Run() {
+  const int64 idle_us =
+      (options_.period_ms - options_.window_ms) * EnvTime::kMillisToMicros;
+  while (!WaitForNotificationWithTimeout(&stopped_, idle_us)) {
+    Status status = SampleWindow();
+    if (!status.ok()) {
+      VLOG(1) << "Skipped a sampling window: " << status;
+    }
+  }
+}
+
+Status SamplingProfiler::SampleWindow() {
+  SamplingState& state = GetSamplingState();
+  {
+    mutex_lock lock(state.mu);
+    if (state.num_pauses > 0) {
+      mutex_lock profiler_lock(mutex_);
+      ++num_skipped_windows_;
+      return errors::Unavailable("Sampling is paused.");
+    }
+    state.in_window = true;
+  }
+  auto end_window = gtl::MakeCleanup([&state] {
+    mutex_lock lock(state.mu);
+    state.in_window = false;
+    state.window_ended.notify_all();
+  });
+
+  ProfileOptions profile_options = ProfilerSession::DefaultOptions();
+  profile_options.set_host_tracer_level(options_.host_tracer_level);
+  // Starting and stopping device tracers is too expensive to do periodically.
+  profile_options.set_device_tracer_level(0);
+  profile_options.set_python_tracer_level(0);
+  profile_options.set_include_dataset_ops(false);
+
+  const uint64 start_time_ns = EnvTime::NowNanos();
+  std::unique_ptr<ProfilerSession> session =
+      ProfilerSession::Create(profile_options);
+  Status status = session->Status();
+  if (!status.ok()) {
+    // Another session is active, e.g. an explicit capture.
+    mutex_lock lock(mutex_);
+    ++num_skipped_windows_;
+    return status;
+  }
+  WaitForNotificationWithTimeout(
+      &stopped_, options_.window_ms * EnvTime::kMillisToMicros);
+  XSpace space;
+  TF_RETURN_IF_ERROR(session->CollectData(&space));
+  const uint64 duration_ns = EnvTime::NowNanos() - start_time_ns;
+  session.reset();
+
+  OpMetricsDb db;
+  if (const XPlane* host_plane =
+          FindPlaneWithName(space, kHostThreadsPlaneName)) {
+    db = ConvertHostThreadsXPlaneToOpMetricsDb(*host_plane);
+  }
+  mutex_lock lock(mutex_);
+  windows_.AddWindow(start_time_ns, duration_ns, std::move(db));
+  return Status::OK();
+}
+
+OpMetricsDb SamplingProfiler::GetOpMetricsDb(uint64 duration_ms) const {
+  uint64 min_start_time_ns = 0;
+  const uint64 now_ns = EnvTime::NowNanos();
+  const uint64 duration_ns = duration_ms * EnvTime::kMillisToNanos;
+  if (duration_ms > 0 && duration_ns < now_ns) {
+    min_start_time_ns = now_ns - duration_ns;
+  }
+  mutex_lock lock(mutex_);
+  return windows_.Combine(min_start_time_ns);
+}
+
+int SamplingProfiler::num_windows() const {
+  mutex_lock lock(mutex_);
+  return windows_.num_windows();
+}
+
+int SamplingProfiler::num_skipped_windows() const {
+  mutex_lock lock(mutex_);
+  return num_skipped_windows_;
+}
+
+Status SamplingProfiler::GetRunningOpMetricsDb(uint64 duration_ms,
+                                               OpMetricsDb* db) {
+  SamplingState& state = GetSamplingState();
+  mutex_lock lock(state.mu);
+  if (state.running == nullptr) {
+    return errors::FailedPrecondition("No sampling profiler is running.");
+  }
+  *db = state.running->GetOpMetricsDb(duration_ms);
+  return Status::OK();
+}
+
+SamplingProfiler::ScopedPause::ScopedPause() {
+  SamplingState& state = GetSamplingState();
+  mutex_lock lock(state.mu);
+  ++state.num_pauses;
+  while (state.in_window) {
+    state.window_ended.wait(lock);
+  }
+}
+
+SamplingProfiler::ScopedPause::~ScopedPause() {
+  SamplingState& state = GetSamplingState();
+  mutex_lock lock(state.mu);
+  --state.num_pauses;
+}
+
+}  // namespace profiler
+}  // namespace tensorflow
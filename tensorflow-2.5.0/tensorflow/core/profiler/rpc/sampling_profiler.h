@@ -0,0 +1,116 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_PROFILER_RPC_SAMPLING_PROFILER_H_
+#define TENSORFLOW_CORE_PROFILER_RPC_SAMPLING_PROFILER_H_
+
+#include <memory>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/convert/rolling_op_metrics_db.h"
+#include "tensorflow/core/profiler/protobuf/op_metrics.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+
+struct SamplingProfilerOptions {
+  // Length of each profiling window.
+  uint64 window_ms = 100;
+  // Time between the starts of two windows. Only window_ms / period_ms of the
+  // time is profiled, and tracing is off in between.
+  uint64 period_ms = 10000;
+  // Number of windows kept in memory, the oldest are dropped.
+  int max_windows = 360;
+  // Number of ops kept per window, the ones with the largest self time.
+  int max_ops_per_window = 200;
+  // Host tracer level of the windows, 1 only records op executions and other
+  // critical TraceMe events.
+  int host_tracer_level = 1;
+};
+
+// Profiles short windows of host activity periodically, and keeps the op
+// metrics of the recent windows in bounded memory. This is cheap enough to be
+// left on in production, and allows looking into latency regressions after the
+// fact through the Monitor RPC of the ProfilerService.
+//
+// At most one SamplingProfiler runs at a time. Sampling skips windows while
+// another ProfilerSession is active, and a ScopedPause stops it from taking
+// the profiler away from an explicit capture.
+class SamplingProfiler {
+ public:
+  // Starts sampling in a background thread. Fails if a SamplingProfiler is
+  // already running.
+  static Status Start(const SamplingProfilerOptions& options,
+                      std::unique_ptr<SamplingProfiler>* profiler);
+
+  // Stops sampling.
+  ~SamplingProfiler();
+
+  // Sets `db` to the op metrics of the running SamplingProfiler's windows that
+  // started within the last `duration_ms`, or all windows if 0. Its total time
+  // is the profiled time. Fails if no SamplingProfiler is running.
+  static Status GetRunningOpMetricsDb(uint64 duration_ms, OpMetricsDb* db);
+
+  // Pauses sampling while in scope, waiting for an ongoing window to end.
+  class ScopedPause {
+   public:
+    ScopedPause();
+    ~ScopedPause();
+
+    ScopedPause(const ScopedPause&) = delete;
+    ScopedPause& operator=(const ScopedPause&) = delete;
+  };
+
+  // Profiles a window now. The background thread does this every period.
+  Status SampleWindow() TF_LOCKS_EXCLUDED(mutex_);
+
+  // Returns the op metrics of the windows that started within the last
+  // `duration_ms`, or all windows if 0.
+  OpMetricsDb GetOpMetricsDb(uint64 duration_ms) const
+      TF_LOCKS_EXCLUDED(mutex_);
+
+  // Returns the number of windows currently kept.
+  int num_windows() const TF_LOCKS_EXCLUDED(mutex_);
+
+  // Returns the number of windows skipped because the profiler was busy.
+  int num_skipped_windows() const TF_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  explicit SamplingProfiler(const SamplingProfilerOptions& options);
+
+  SamplingProfiler(const SamplingProfiler&) = delete;
+  SamplingProfiler& operator=(const SamplingProfiler&) = delete;
+
+  // Samples a window every period until stopped.
+  void Run();
+
+  const SamplingProfilerOptions options_;
+  Notification stopped_;
+  std::unique_ptr<Thread> thread_;
+
+  mutable mutex mutex_;
+  RollingOpMetricsDb windows_ TF_GUARDED_BY(mutex_);
+  int num_skipped_windows_ TF_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace profiler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PROFILER_RPC_SAMPLING_PROFILER_H_
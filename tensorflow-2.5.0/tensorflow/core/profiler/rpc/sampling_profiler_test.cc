@@ -0,0 +1,118 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/profiler/rpc/sampling_profiler.h"
+
+#include <memory>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/profiler/lib/profiler_session.h"
+#include "tensorflow/core/profiler/protobuf/op_metrics.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+// The period is long enough for the background thread to never sample during
+// a test, which samples windows explicitly instead.
+SamplingProfilerOptions TestOptions() {
+  SamplingProfilerOptions options;
+  options.window_ms = 10;
+  options.period_ms = 3600 * 1000;
+  options.max_windows = 2;
+  return options;
+}
+
+TEST(SamplingProfilerTest, RejectsInvalidOptions) {
+  std::unique_ptr<SamplingProfiler> profiler;
+  SamplingProfilerOptions options = TestOptions();
+  options.window_ms = 0;
+  EXPECT_TRUE(
+      errors::IsInvalidArgument(SamplingProfiler::Start(options, &profiler)));
+  options = TestOptions();
+  options.period_ms = options.window_ms - 1;
+  EXPECT_TRUE(
+      errors::IsInvalidArgument(SamplingProfiler::Start(options, &profiler)));
+  options = TestOptions();
+  options.max_windows = 0;
+  EXPECT_TRUE(
+      errors::IsInvalidArgument(SamplingProfiler::Start(options, &profiler)));
+}
+
+TEST(SamplingProfilerTest, OnlyOneRunsAtATime) {
+  OpMetricsDb db;
+  EXPECT_TRUE(errors::IsFailedPrecondition(
+      SamplingProfiler::GetRunningOpMetricsDb(/*duration_ms=*/0, &db)));
+  {
+    std::unique_ptr<SamplingProfiler> profiler;
+    TF_ASSERT_OK(SamplingProfiler::Start(TestOptions(), &profiler));
+    std::unique_ptr<SamplingProfiler> other;
+    EXPECT_TRUE(errors::IsAlreadyExists(
+        SamplingProfiler::Start(TestOptions(), &other)));
+    TF_EXPECT_OK(
+        SamplingProfiler::GetRunningOpMetricsDb(/*duration_ms=*/0, &db));
+  }
+  EXPECT_TRUE(errors::IsFailedPrecondition(
+      SamplingProfiler::GetRunningOpMetricsDb(/*duration_ms=*/0, &db)));
+}
+
+TEST(SamplingProfilerTest, KeepsTheLatestWindows) {
+  std::unique_ptr<SamplingProfiler> profiler;
+  TF_ASSERT_OK(SamplingProfiler::Start(TestOptions(), &profiler));
+  EXPECT_EQ(profiler->num_windows(), 0);
+  TF_ASSERT_OK(profiler->SampleWindow());
+  EXPECT_EQ(profiler->num_windows(), 1);
+  const OpMetricsDb one_window = profiler->GetOpMetricsDb(/*duration_ms=*/0);
+  // The profiled time covers at least the length of the window.
+  EXPECT_GE(one_window.total_time_ps(), 10ULL * 1000 * 1000 * 1000);
+
+  TF_ASSERT_OK(profiler->SampleWindow());
+  TF_ASSERT_OK(profiler->SampleWindow());
+  EXPECT_EQ(profiler->num_windows(), 2);
+  EXPECT_EQ(profiler->num_skipped_windows(), 0);
+}
+
+TEST(SamplingProfilerTest, SkipsWindowsWhilePaused) {
+  std::unique_ptr<SamplingProfiler> profiler;
+  TF_ASSERT_OK(SamplingProfiler::Start(TestOptions(), &profiler));
+  {
+    SamplingProfiler::ScopedPause pause;
+    EXPECT_TRUE(errors::IsUnavailable(profiler->SampleWindow()));
+  }
+  EXPECT_EQ(profiler->num_windows(), 0);
+  EXPECT_EQ(profiler->num_skipped_windows(), 1);
+
+  TF_ASSERT_OK(profiler->SampleWindow());
+  EXPECT_EQ(profiler->num_windows(), 1);
+}
+
+TEST(SamplingProfilerTest, SkipsWindowsWhileAnotherSessionIsActive) {
+  std::unique_ptr<SamplingProfiler> profiler;
+  TF_ASSERT_OK(SamplingProfiler::Start(TestOptions(), &profiler));
+  {
+    std::unique_ptr<ProfilerSession> session =
+        ProfilerSession::Create(ProfilerSession::DefaultOptions());
+    TF_ASSERT_OK(session->Status());
+    EXPECT_FALSE(profiler->SampleWindow().ok());
+  }
+  EXPECT_EQ(profiler->num_windows(), 0);
+  EXPECT_EQ(profiler->num_skipped_windows(), 1);
+}
+
+}  // namespace
+}  // namespace profiler
+}  // namespace tensorflow
@@ -14,6 +14,9 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/summary/summary_file_writer.h"
 
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+
 #include "tensorflow/core/summary/summary_converter.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -21,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/framework/summary.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/util/events_writer.h"
 #include "tensorflow/core/util/ptr_util.h"
 
@@ -44,19 +48,22 @@ class SummaryFileWriter : public SummaryWriterInterface {
       }
       TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(logdir));
     }
-    mutex_lock ml(mu_);
-    events_writer_ =
-        tensorflow::MakeUnique<EventsWriter>(io::JoinPath(logdir, "events"));
-    TF_RETURN_WITH_CONTEXT_IF_ERROR(
-        events_writer_->InitWithSuffix(filename_suffix),
-        "Could not initialize events writer.");
-    last_flush_ = env_->NowMicros();
-    is_initialized_ = true;
+    {
+      mutex_lock wl(writer_mu_);
+      events_writer_ =
+          tensorflow::MakeUnique<EventsWriter>(io::JoinPath(logdir, "events"));
+      TF_RETURN_WITH_CONTEXT_IF_ERROR(
+          events_writer_->InitWithSuffix(filename_suffix),
+          "Could not initialize events writer.");
+      is_initialized_ = true;
+    }
+    thread_.reset(env_->StartThread(ThreadOptions(), "summary_file_writer",
+                                    [this]() { WriterLoop(); }));
     return Status::OK();
   }
 
   Status Flush() override {
-    mutex_lock ml(mu_);
+    mutex_lock wl(writer_mu_);
     if (!is_initialized_) {
       return errors::FailedPrecondition("Class was not properly initialized.");
     }
@@ -64,7 +71,13 @@ class SummaryFileWriter : public SummaryWriterInterface {
   }
 
   ~SummaryFileWriter() override {
-    (void)Flush();  // Ignore errors.
+    {
+      mutex_lock ml(mu_);
+      shutdown_ = true;
+      cv_.notify_all();
+    }
+    thread_.reset();  // Joins the background writer thread.
+    (void)Flush();    // Ignore errors.
   }
 
   Status WriteTensor(int64 global_step, Tensor t, const string& tag,
@@ -138,14 +151,26 @@ class SummaryFileWriter : public SummaryWriterInterface {
     return WriteEvent(std::move(e));
   }
 
+  // Queues `event` for the background thread, which serializes and appends
+  // it to the events file. Returns the error of a previous background flush,
+  // if any.
   Status WriteEvent(std::unique_ptr<Event> event) override {
-    mutex_lock ml(mu_);
-    queue_.emplace_back(std::move(event));
-    if (queue_.size() > max_queue_ ||
-        env_->NowMicros() - last_flush_ > 1000 * flush_millis_) {
-      return InternalFlush();
+    {
+      mutex_lock ml(mu_);
+      queue_.emplace_back(std::move(event));
+      if (queue_.size() > max_queue_) {
+        cv_.notify_one();
+      }
+      if (queue_.size() <= kMaxPendingQueues * (max_queue_ + 1)) {
+        Status s = background_status_;
+        background_status_ = Status::OK();
+        return s;
+      }
     }
-    return Status::OK();
+    // The background thread has fallen far behind (e.g. a slow remote
+    // filesystem); write on the calling thread to bound the pending memory.
+    mutex_lock wl(writer_mu_);
+    return InternalFlush();
   }
 
   string DebugString() const override { return "SummaryFileWriter"; }
@@ -155,26 +180,65 @@ class SummaryFileWriter : public SummaryWriterInterface {
     return static_cast<double>(env_->NowMicros()) / 1.0e6;
   }
 
-  Status InternalFlush() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    for (const std::unique_ptr<Event>& e : queue_) {
+  // Takes all queued events and appends them to the events file. Holding
+  // `writer_mu_` for the whole flush keeps events in the order they were
+  // queued, while `mu_` is only held to swap out the queue so that
+  // WriteEvent() does not wait for the file system.
+  Status InternalFlush() TF_EXCLUSIVE_LOCKS_REQUIRED(writer_mu_) {
+    std::vector<std::unique_ptr<Event>> events;
+    {
+      mutex_lock ml(mu_);
+      events.swap(queue_);
+    }
+    for (const std::unique_ptr<Event>& e : events) {
       events_writer_->WriteEvent(*e);
     }
-    queue_.clear();
     TF_RETURN_WITH_CONTEXT_IF_ERROR(events_writer_->Flush(),
                                     "Could not flush events file.");
-    last_flush_ = env_->NowMicros();
     return Status::OK();
   }
 
-  bool is_initialized_;
+  // Flushes whenever more than `max_queue_` events are queued, or at least
+  // every `flush_millis_` milliseconds while events are pending.
+  void WriterLoop() {
+    while (true) {
+      {
+        mutex_lock ml(mu_);
+        if (!shutdown_ && queue_.size() <= max_queue_) {
+          cv_.wait_for(ml, std::chrono::milliseconds(
+                               std::max(flush_millis_, 1)));
+        }
+        if (shutdown_) return;
+        if (queue_.empty()) continue;
+      }
+      mutex_lock wl(writer_mu_);
+      const Status s = InternalFlush();
+      if (!s.ok()) {
+        mutex_lock ml(mu_);
+        if (background_status_.ok()) background_status_ = s;
+      }
+    }
+  }
+
+  // WriteEvent() flushes on the calling thread once this many full queues
+  // are pending.
+  static constexpr int kMaxPendingQueues = 4;
+
+  bool is_initialized_ TF_GUARDED_BY(writer_mu_);
   const int max_queue_;
   const int flush_millis_;
-  uint64 last_flush_;
   Env* env_;
+  // Guards `events_writer_`. Acquired before `mu_` when both are held.
+  mutex writer_mu_;
   mutex mu_;
+  condition_variable cv_;
   std::vector<std::unique_ptr<Event>> queue_ TF_GUARDED_BY(mu_);
+  bool shutdown_ TF_GUARDED_BY(mu_) = false;
+  // The first error from a background flush not yet returned by WriteEvent().
+  Status background_status_ TF_GUARDED_BY(mu_);
   // A pointer to allow deferred construction.
-  std::unique_ptr<EventsWriter> events_writer_ TF_GUARDED_BY(mu_);
+  std::unique_ptr<EventsWriter> events_writer_ TF_GUARDED_BY(writer_mu_);
+  std::unique_ptr<Thread> thread_;
   std::vector<std::pair<string, SummaryMetadata>> registered_summaries_
       TF_GUARDED_BY(mu_);
 };
@@ -560,6 +560,7 @@ xla::StatusOr<std::unique_ptr<OutputBuffers>> AllocateOutputTensors(
           var.var()->tensor()->dtype(), output_tensor_shapes[i], &unused,
           &output_tensor));
       *var.var()->tensor() = *output_tensor;
+      var.var()->PublishSnapshot();
     } else {
       // This output corresponds to a non-resource input to the TPUExecute
       // operator. This case occurs for the distributed TPU rewrite which
@@ -115,6 +115,7 @@ Status TPUReshardVariablesOpKernel::DoWork(OpKernelContext* context) {
   // Change the state.
   *format_state_var->tensor() = *new_format_key;
   format_state_var->is_initialized = true;
+  format_state_var->PublishSnapshot();
   return Status::OK();
 }
 
@@ -259,6 +260,7 @@ Status TPUReshardVariablesOpKernel::DoTpuExecute(
     // Release variables holding inputs.
     for (int i = 0; i < variables.size(); ++i) {
       *variables[i].var()->tensor() = Tensor();
+      variables[i].var()->PublishSnapshot();
     }
     // Flush on-device program memory cache.
     TF_RETURN_IF_ERROR(
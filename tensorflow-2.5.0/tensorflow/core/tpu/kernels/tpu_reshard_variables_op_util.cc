@@ -304,6 +304,7 @@ Status UpdateOutputVariables(
         &output_tensor));
     *variables[i].var()->tensor() = *output_tensor;
     transfer_buffers(i, output_tensor);
+    variables[i].var()->PublishSnapshot();
   }
   return allocator->Deallocate(output_buffers.device_ordinal(),
                                output_buffers.buffer({}));
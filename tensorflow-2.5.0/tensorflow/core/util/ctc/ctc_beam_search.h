@@ -21,6 +21,7 @@ limitations under the License.
 #include <cmath>
 #include <limits>
 #include <memory>
+#include <numeric>
 #include <vector>
 
 #include "third_party/eigen3/Eigen/Core"
@@ -220,25 +221,33 @@ template <typename Vector>
 T CTCBeamSearchDecoder<T, CTCBeamState, CTCBeamComparer>::GetTopK(
     const int K, const Vector& input, std::vector<T>* top_k_logits,
     std::vector<int>* top_k_indices) {
-  // Find Top K choices, complexity nk in worst case. The array input is read
-  // just once.
+  // Find Top K choices among the non-blank labels with a partial selection,
+  // O(n + k log k). Ties are broken in favor of the lower label index, and
+  // NaN logits rank below every other value.
   CHECK_EQ(this->num_classes_, input.size());
+  const int num_labels = this->num_classes_ - 1;
+  auto logit_at = [&input](int j) -> T {
+    const T logit = input(j);
+    return Eigen::numext::isnan(logit) ? -std::numeric_limits<T>::infinity()
+                                       : logit;
+  };
+  auto ranks_before = [&logit_at](int a, int b) {
+    const T logit_a = logit_at(a);
+    const T logit_b = logit_at(b);
+    return logit_a > logit_b || (logit_a == logit_b && a < b);
+  };
+  std::vector<int> labels(num_labels);
+  std::iota(labels.begin(), labels.end(), 0);
+  std::nth_element(labels.begin(), labels.begin() + K, labels.end(),
+                   ranks_before);
+  std::sort(labels.begin(), labels.begin() + K, ranks_before);
   top_k_logits->clear();
   top_k_indices->clear();
-  top_k_logits->resize(K, -INFINITY);
-  top_k_indices->resize(K, -1);
-  for (int j = 0; j < this->num_classes_ - 1; ++j) {
-    const T logit = input(j);
-    if (logit > (*top_k_logits)[K - 1]) {
-      int k = K - 1;
-      while (k > 0 && logit > (*top_k_logits)[k - 1]) {
-        (*top_k_logits)[k] = (*top_k_logits)[k - 1];
-        (*top_k_indices)[k] = (*top_k_indices)[k - 1];
-        k--;
-      }
-      (*top_k_logits)[k] = logit;
-      (*top_k_indices)[k] = j;
-    }
+  top_k_logits->reserve(K);
+  top_k_indices->reserve(K);
+  for (int k = 0; k < K; ++k) {
+    top_k_indices->push_back(labels[k]);
+    top_k_logits->push_back(input(labels[k]));
   }
   // Return max value which is in 0th index or blank character logit
   return std::max((*top_k_logits)[0], input(this->num_classes_ - 1));
@@ -264,11 +273,9 @@ void CTCBeamSearchDecoder<T, CTCBeamState, CTCBeamComparer>::Step(
     max_coeff = raw_input.maxCoeff();
   }
   // Get normalization term of softmax: log(sum(exp(logit[j]-max_coeff))).
-  T logsumexp = T(0.0);
-  for (int j = 0; j < raw_input.size(); ++j) {
-    logsumexp += Eigen::numext::exp(raw_input(j) - max_coeff);
-  }
-  logsumexp = Eigen::numext::log(logsumexp);
+  // Evaluated as a single Eigen expression so that exp() is vectorized.
+  const T logsumexp =
+      Eigen::numext::log((raw_input.array() - max_coeff).exp().sum());
   // Final normalization offset to get correct log probabilities.
   T norm_offset = max_coeff + logsumexp;
 
@@ -366,14 +366,21 @@ Status DebugEventsWriter::FlushNonExecutionFiles() {
 Status DebugEventsWriter::FlushExecutionFiles() {
   TF_RETURN_IF_ERROR(Init());
 
+  // Serializes flushes so that events taken out of the circular buffers by
+  // concurrent calls are still written in order. The buffers themselves are
+  // only locked long enough to take their contents, so that producers are
+  // not blocked on file I/O.
+  mutex_lock flush_lock(execution_flush_mu_);
   if (execution_writer_ != nullptr) {
     if (circular_buffer_size_ > 0) {
       // Write out all the content in the circular buffers.
-      mutex_lock l(execution_buffer_mu_);
-      while (!execution_buffer_.empty()) {
-        execution_writer_->WriteSerializedDebugEvent(execution_buffer_.front());
-        // SerializeAndWriteDebugEvent(&execution_buffer_.front());
-        execution_buffer_.pop_front();
+      std::deque<string> pending;
+      {
+        mutex_lock l(execution_buffer_mu_);
+        pending.swap(execution_buffer_);
+      }
+      for (const string& serialized : pending) {
+        execution_writer_->WriteSerializedDebugEvent(serialized);
       }
     }
     TF_RETURN_IF_ERROR(execution_writer_->Flush());
@@ -382,11 +389,13 @@ Status DebugEventsWriter::FlushExecutionFiles() {
   if (graph_execution_traces_writer_ != nullptr) {
     if (circular_buffer_size_ > 0) {
       // Write out all the content in the circular buffers.
-      mutex_lock l(graph_execution_trace_buffer_mu_);
-      while (!graph_execution_trace_buffer_.empty()) {
-        graph_execution_traces_writer_->WriteSerializedDebugEvent(
-            graph_execution_trace_buffer_.front());
-        graph_execution_trace_buffer_.pop_front();
+      std::deque<string> pending;
+      {
+        mutex_lock l(graph_execution_trace_buffer_mu_);
+        pending.swap(graph_execution_trace_buffer_);
+      }
+      for (const string& serialized : pending) {
+        graph_execution_traces_writer_->WriteSerializedDebugEvent(serialized);
       }
     }
     TF_RETURN_IF_ERROR(graph_execution_traces_writer_->Flush());
@@ -485,6 +494,7 @@ DebugEventsWriter::DebugEventsWriter(const string& dump_root,
       execution_buffer_mu_(),
       graph_execution_trace_buffer_(),
       graph_execution_trace_buffer_mu_(),
+      execution_flush_mu_(),
       device_name_to_id_(),
       device_mu_() {}
 
@@ -200,7 +200,11 @@ class DebugEventsWriter {
   Status FlushNonExecutionFiles();
 
   // Writes current contents of the circular buffers to their respective
-  // debug event files and clears the circular buffers.
+  // debug event files and clears the circular buffers. The buffers are swapped
+  // out under their mutexes and written after releasing them, so threads that
+  // record execution events only wait for the swap, never for file I/O.
+  // Flushing still happens on the calling thread: there is no background
+  // writer, and every recorded event is kept (no sampling).
   Status FlushExecutionFiles();
 
   // Close() calls FlushNonExecutionFiles() and FlushExecutionFiles()
@@ -249,6 +253,8 @@ class DebugEventsWriter {
   std::deque<string> graph_execution_trace_buffer_
       TF_GUARDED_BY(graph_execution_trace_buffer_mu_);
   mutex graph_execution_trace_buffer_mu_;
+  // Held while the circular buffers are written out by FlushExecutionFiles().
+  mutex execution_flush_mu_;
 
   absl::flat_hash_map<string, int> device_name_to_id_ TF_GUARDED_BY(device_mu_);
   mutex device_mu_;
@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/platform/byte_order.h"
 #include "tensorflow/core/platform/logging.h"
@@ -569,7 +570,7 @@ void LogSparseFeatureDataLoss(StringPiece feature_name) {
 }
 
 Status FastParseSerializedExample(
-    const tstring& serialized_example, const tstring& example_name,
+    StringPiece serialized_example, StringPiece example_name,
     const size_t example_index, const Config& config,
     const PresizedCuckooMap<std::pair<size_t, Type>>& config_index,
     SeededHasher hasher, std::vector<Tensor>* output_dense,
@@ -1109,12 +1110,13 @@ void CopySparseBufferToTensor(DataType dtype, size_t offset, SparseBuffer* src,
   }
 }
 
-}  // namespace
-
-Status FastParseExample(const Config& config,
-                        gtl::ArraySlice<tstring> serialized,
-                        gtl::ArraySlice<tstring> example_names,
-                        thread::ThreadPool* thread_pool, Result* result) {
+// Parses a batch of serialized Examples, where `Serialized` is a string type
+// convertible to StringPiece.
+template <typename Serialized>
+Status FastParseExampleImpl(const Config& config,
+                            gtl::ArraySlice<Serialized> serialized,
+                            gtl::ArraySlice<tstring> example_names,
+                            thread::ThreadPool* thread_pool, Result* result) {
   DCHECK(result != nullptr);
   // Check config so we can safely CHECK(false) in switches on config.*.dtype
   TF_RETURN_IF_ERROR(CheckConfigDataTypes(config));
@@ -1425,6 +1427,36 @@ Status FastParseExample(const Config& config,
   return Status::OK();
 }
 
+}  // namespace
+
+Status FastParseExample(const Config& config,
+                        gtl::ArraySlice<tstring> serialized,
+                        gtl::ArraySlice<tstring> example_names,
+                        thread::ThreadPool* thread_pool, Result* result) {
+  return FastParseExampleImpl(config, serialized, example_names, thread_pool,
+                              result);
+}
+
+Status FastParseExample(const Config& config,
+                        gtl::ArraySlice<StringPiece> serialized,
+                        gtl::ArraySlice<tstring> example_names,
+                        thread::ThreadPool* thread_pool, Result* result) {
+  return FastParseExampleImpl(config, serialized, example_names, thread_pool,
+                              result);
+}
+
+Status FastParseExampleRecords(const Config& config,
+                               io::SequentialRecordReader* reader,
+                               int max_examples,
+                               thread::ThreadPool* thread_pool,
+                               Result* result, int* num_examples) {
+  std::vector<tstring> serialized;
+  TF_RETURN_IF_ERROR(reader->ReadRecords(max_examples, &serialized));
+  *num_examples = serialized.size();
+  return FastParseExampleImpl(config, gtl::ArraySlice<tstring>(serialized), {},
+                              thread_pool, result);
+}
+
 Status FastParseSingleExample(const Config& config, StringPiece serialized,
                               Result* result) {
   DCHECK(result != nullptr);
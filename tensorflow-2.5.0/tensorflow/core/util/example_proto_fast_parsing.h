@@ -32,6 +32,10 @@ limitations under the License.
 #include "tensorflow/core/util/sparse/sparse_tensor.h"
 
 namespace tensorflow {
+namespace io {
+class SequentialRecordReader;
+}  // namespace io
+
 namespace example {
 
 // FastParseExampleConfig defines how to parse features in Example.
@@ -138,6 +142,25 @@ Status FastParseExample(const FastParseExampleConfig& config,
                         gtl::ArraySlice<tstring> example_names,
                         thread::ThreadPool* thread_pool, Result* result);
 
+// Same as above, but the serialized Example protos are views into buffers
+// owned by the caller (e.g. the records of a TFRecord file, or the chunks of
+// a Cord), which saves copying them into a string tensor first.
+Status FastParseExample(const FastParseExampleConfig& config,
+                        gtl::ArraySlice<StringPiece> serialized,
+                        gtl::ArraySlice<tstring> example_names,
+                        thread::ThreadPool* thread_pool, Result* result);
+
+// Reads up to `max_examples` serialized Example protos from `reader` and
+// parses them as a batch into result according to given config. Sets
+// `*num_examples` to the size of the batch, which is smaller than
+// `max_examples` only at the end of the file. Returns OUT_OF_RANGE if the
+// reader is at the end of the file.
+Status FastParseExampleRecords(const FastParseExampleConfig& config,
+                               io::SequentialRecordReader* reader,
+                               int max_examples,
+                               thread::ThreadPool* thread_pool,
+                               Result* result, int* num_examples);
+
 // TODO(mrry): Move the hash table construction into the config object.
 typedef FastParseExampleConfig FastParseSingleExampleConfig;
 
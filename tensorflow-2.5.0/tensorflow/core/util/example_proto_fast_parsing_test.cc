@@ -19,8 +19,13 @@ limitations under the License.
 
 #include "tensorflow/core/example/example.pb.h"
 #include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
@@ -321,6 +326,66 @@ TEST(FastParse, StatsCollection) {
   }
 }
 
+TEST(FastParse, ParseViewsAndRecords) {
+  const int kNumExamples = 13;
+  const int kBatchSize = 5;
+  std::vector<tstring> serialized(kNumExamples, ExampleWithSomeFeatures());
+
+  FastParseExampleConfig config;
+  AddDenseFeature("bytes_list", DT_STRING, {2}, false, 2, &config);
+  AddDenseFeature("float_list", DT_FLOAT, {-1}, true, 1, &config);
+  AddSparseFeature("int64_list", DT_INT64, &config);
+
+  Result expected;
+  TF_CHECK_OK(FastParseExample(config, serialized, {}, nullptr, &expected));
+
+  std::vector<StringPiece> views(serialized.begin(), serialized.end());
+  Result result;
+  TF_CHECK_OK(FastParseExample(config, views, {}, nullptr, &result));
+  test::ExpectTensorEqual<tstring>(expected.dense_values[0],
+                                   result.dense_values[0]);
+  test::ExpectTensorEqual<float>(expected.dense_values[1],
+                                 result.dense_values[1]);
+  test::ExpectTensorEqual<int64>(expected.sparse_indices[0],
+                                 result.sparse_indices[0]);
+  test::ExpectTensorEqual<int64>(expected.sparse_values[0],
+                                 result.sparse_values[0]);
+
+  Env* env = Env::Default();
+  const string fname = io::JoinPath(testing::TmpDir(), "examples.tfrecord");
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriter writer(file.get());
+    for (const tstring& example : serialized) {
+      TF_CHECK_OK(writer.WriteRecord(example));
+    }
+    TF_CHECK_OK(writer.Close());
+    TF_CHECK_OK(file->Close());
+  }
+  std::unique_ptr<RandomAccessFile> file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &file));
+  io::SequentialRecordReader reader(file.get());
+  int total_examples = 0;
+  while (total_examples < kNumExamples) {
+    Result batch;
+    int num_examples;
+    TF_CHECK_OK(FastParseExampleRecords(config, &reader, kBatchSize, nullptr,
+                                         &batch, &num_examples));
+    EXPECT_EQ(std::min(kBatchSize, kNumExamples - total_examples),
+              num_examples);
+    EXPECT_EQ(num_examples, batch.dense_values[0].dim_size(0));
+    EXPECT_EQ(num_examples, batch.sparse_shapes[0].vec<int64>()(0));
+    total_examples += num_examples;
+  }
+  Result batch;
+  int num_examples;
+  EXPECT_EQ(error::OUT_OF_RANGE,
+            FastParseExampleRecords(config, &reader, kBatchSize, nullptr,
+                                    &batch, &num_examples)
+                .code());
+}
+
 string RandStr(random::SimplePhilox* rng) {
   static const char key_char_lookup[] =
       "0123456789{}~`!@#$%^&*()"
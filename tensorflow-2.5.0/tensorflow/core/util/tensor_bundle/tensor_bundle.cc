@@ -18,9 +18,12 @@ limitations under the License.
 #include <algorithm>
 #include <cstdlib>
 #include <cstring>
+#include <map>
 #include <memory>
+#include <tuple>
 #include <utility>
 
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
@@ -31,10 +34,13 @@ limitations under the License.
 #include "tensorflow/core/framework/variant_tensor_data.h"
 #include "tensorflow/core/framework/versions.h"
 #include "tensorflow/core/framework/versions.pb.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/io/filter_policy.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/io/table_builder.h"
 #include "tensorflow/core/lib/random/random.h"
@@ -54,11 +60,20 @@ namespace tensorflow {
 // Versioning of the tensor bundle format.
 const int kTensorBundleMinProducer = 0;
 const int kTensorBundleMinConsumer = 0;
-const int kTensorBundleVersion = 1;
+const int kTensorBundleVersion = 2;
+
+// The minimum consumer version of bundles that refer to base bundles.
+static const int kTensorBundleIncrementalMinConsumer = 2;
 
 // Size of our input buffer for streaming reads
 static const int kBufferSize = 1024 * 1024;
 
+// Reads of tensors are coalesced by "BundleReader::LookupMany()" if they are
+// stored at most kMaxCoalescedGap bytes apart, as long as the coalesced read
+// spans at most kMaxCoalescedBytes.
+static const int64 kMaxCoalescedGap = 4096;
+static const int64 kMaxCoalescedBytes = 16 << 20;
+
 // Key to the special BundleHeaderProto entry.  Do not change this, as clients
 // can make the assumption that the header is always the first entry in the
 // bundle.
@@ -379,8 +394,46 @@ Status CorruptFileError(const Status& in_status, const string& filename,
                       detail, "): ", in_status.error_message()));
 }
 
+// A TensorBuffer aliasing a memory-mapped data file.  The mapping stays live
+// for as long as any tensor refers to it.
+class MappedTensorBuffer : public TensorBuffer {
+ public:
+  MappedTensorBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                     const char* data, size_t size)
+      : TensorBuffer(const_cast<char*>(data)),
+        region_(std::move(region)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+
+  TensorBuffer* root_buffer() override { return this; }
+
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(static_cast<int64>(size_));
+    proto->set_allocator_name("tensor_bundle_mapped");
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+
+  // The mapping is read-only, so ops must not forward the buffer to an output
+  // and write to it in place.  Updates of a variable restored from it copy the
+  // buffer first.
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const size_t size_;
+};
+
+// Bloom filter policy for the metadata table, which lets lookups of keys that
+// are not in the bundle be answered without reading its data blocks.
+const table::FilterPolicy* BundleFilterPolicy() {
+  static const table::FilterPolicy* policy = table::NewBloomFilterPolicy(10);
+  return policy;
+}
+
 table::Options TableBuilderOptions() {
   table::Options o;
+  o.filter_policy = BundleFilterPolicy();
   // Compressed tables cannot be read by TensorFlow releases prior to 1.1.
   // To smoothen the transition, compressed writes are disabled for now
   // (version 1.2) with the intention that they will be enabled again at
@@ -431,9 +484,30 @@ BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
   out_ = std::unique_ptr<FileOutputBuffer>(
       new FileOutputBuffer(wrapper.release(), 8 << 20 /* 8MB write buffer */));
 
+  if (!options_.base_prefix.empty()) {
+    base_.reset(new BundleReader(env_, options_.base_prefix));
+    status_ = base_->status();
+    if (!status_.ok()) return;
+    // Entries copied from the base bundle keep their "base_bundle" index,
+    // and the entries of its own data files refer to the last base bundle.
+    base_bundles_ = base_->base_bundles_;
+    BundleHeaderProto::BaseBundle base_bundle;
+    base_bundle.set_prefix(options_.base_prefix);
+    base_bundle.set_num_shards(base_->num_shards_);
+    base_bundles_.push_back(std::move(base_bundle));
+  }
+
   VLOG(1) << "Writing to file " << data_path_;
 }
 
+bool BundleWriter::BaseHolds(const BundleEntryProto& base_entry,
+                             const Tensor& val) {
+  if (val.NumElements() == 0) return true;
+  Tensor base_val(val.dtype(), val.shape());
+  return base_->GetValue(base_entry, &base_val).ok() &&
+         base_val.tensor_data() == val.tensor_data();
+}
+
 Status BundleWriter::Add(StringPiece key, const Tensor& val) {
   if (!status_.ok()) return status_;
   CHECK_NE(key, kHeaderEntryKey);
@@ -443,6 +517,27 @@ Status BundleWriter::Add(StringPiece key, const Tensor& val) {
     return status_;
   }
 
+  if (base_ != nullptr && DataTypeCanUseMemcpy(val.dtype()) &&
+      !base_->need_to_swap_bytes_) {
+    // Refers to the contents in the base bundle if they are unchanged.  The
+    // checksum only rules out changed contents cheaply: equal checksums don't
+    // imply equal bytes, so the base contents are read back and compared.
+    BundleEntryProto base_entry;
+    if (base_->GetBundleEntryProto(key, &base_entry).ok() &&
+        base_entry.slices().empty() && base_entry.dtype() == val.dtype() &&
+        TensorShape(base_entry.shape()) == val.shape() &&
+        base_entry.size() == val.TotalBytes() &&
+        crc32c::Unmask(base_entry.crc32c()) ==
+            crc32c::Value(val.tensor_data().data(), val.TotalBytes()) &&
+        BaseHolds(base_entry, val)) {
+      if (base_entry.base_bundle() == 0) {
+        base_entry.set_base_bundle(base_bundles_.size());
+      }
+      entries_[key_string].Swap(&base_entry);
+      return status_;
+    }
+  }
+
   BundleEntryProto* entry = &entries_[key_string];
   entry->set_dtype(val.dtype());
   val.shape().AsProto(entry->mutable_shape());
@@ -537,6 +632,7 @@ Status BundleWriter::Finish() {
     // platforms (e.g. Android).  The metadata file is small, so this is fine.
     table::Options options;
     options.compression = table::kNoCompression;
+    options.filter_policy = BundleFilterPolicy();
     table::TableBuilder builder(options, file.get());
     // Header entry.
     BundleHeaderProto header;
@@ -546,6 +642,12 @@ Status BundleWriter::Finish() {
     VersionDef* version = header.mutable_version();
     version->set_producer(kTensorBundleVersion);
     version->set_min_consumer(kTensorBundleMinConsumer);
+    if (!base_bundles_.empty()) {
+      version->set_min_consumer(kTensorBundleIncrementalMinConsumer);
+      for (const auto& base_bundle : base_bundles_) {
+        *header.add_base_bundles() = base_bundle;
+      }
+    }
 
     builder.Add(kHeaderEntryKey, header.SerializeAsString());
 
@@ -585,6 +687,10 @@ struct MergeState {
   std::map<string, BundleEntryProto> entries;
   // Data file path -> new shard id in the final merged bundle.
   std::unordered_map<string, int32> shard_ids;
+  // The bundles referred to by the merged entries, and the index of each
+  // one's prefix in "base_bundles" plus one.
+  std::vector<BundleHeaderProto::BaseBundle> base_bundles;
+  std::unordered_map<string, int32> base_bundle_ids;
 };
 
 // Merges entries of "prefix" into the accumulator state "merge".
@@ -605,6 +711,8 @@ static Status MergeOneBundle(Env* env, StringPiece prefix,
   std::unique_ptr<table::Iterator> iter(table->NewIterator());
 
   int num_shards;
+  // Maps the "base_bundle" indices of this bundle to those of the merged one.
+  std::vector<int32> base_bundle_ids = {0};
   // Process header.
   {
     iter->Seek(kHeaderEntryKey);
@@ -617,6 +725,10 @@ static Status MergeOneBundle(Env* env, StringPiece prefix,
     if (!s.ok()) return CorruptFileError(s, filename, "unable to parse header");
 
     merge_state->num_shards += header.num_shards();
+    // Bundles that refer to base bundles require a newer consumer version,
+    // which the merged bundle inherits.
+    const int min_consumer = header.version().min_consumer();
+    header.mutable_version()->set_min_consumer(kTensorBundleMinConsumer);
     if (!merge_state->seen_first_bundle) {
       merge_state->seen_first_bundle = true;
       merge_state->endianness = header.endianness();
@@ -637,7 +749,15 @@ static Status MergeOneBundle(Env* env, StringPiece prefix,
             merge_version, " vs. curr ", curr_version);
       }
     }
+    merge_state->version.set_min_consumer(
+        std::max(merge_state->version.min_consumer(), min_consumer));
     num_shards = header.num_shards();
+    for (const auto& base_bundle : header.base_bundles()) {
+      auto result = merge_state->base_bundle_ids.insert(
+          {base_bundle.prefix(), merge_state->base_bundles.size() + 1});
+      if (result.second) merge_state->base_bundles.push_back(base_bundle);
+      base_bundle_ids.push_back(result.first->second);
+    }
     iter->Next();
   }
 
@@ -679,6 +799,19 @@ static Status MergeOneBundle(Env* env, StringPiece prefix,
     }
 
     // Key doesn't duplicate: a fresh tensor/slice entry.
+    if (to_merge_entry.base_bundle() != 0) {
+      // The data lies in a base bundle, whose data files are left as is.
+      if (to_merge_entry.base_bundle() < 0 ||
+          to_merge_entry.base_bundle() >= base_bundle_ids.size()) {
+        return errors::DataLoss("Invalid base bundle ",
+                                to_merge_entry.base_bundle(), " of tensor ",
+                                key, " when merging prefix: ", prefix);
+      }
+      to_merge_entry.set_base_bundle(
+          base_bundle_ids[to_merge_entry.base_bundle()]);
+      merge_state->entries[key] = to_merge_entry;
+      continue;
+    }
     auto result = merge_state->shard_ids.insert(
         {DataFilename(prefix, to_merge_entry.shard_id(), num_shards),
          merge_state->shard_ids.size()});
@@ -719,6 +852,9 @@ Status MergeBundles(Env* env, gtl::ArraySlice<tstring> prefixes,
     header.set_num_shards(merge.num_shards);
     header.set_endianness(merge.endianness);
     *header.mutable_version() = merge.version;
+    for (const auto& base_bundle : merge.base_bundles) {
+      *header.add_base_bundles() = base_bundle;
+    }
     builder.Add(kHeaderEntryKey, header.SerializeAsString());
     // All others.
     for (const auto& p : merge.entries) {
@@ -759,6 +895,7 @@ BundleReader::BundleReader(Env* env, StringPiece prefix)
   metadata_ = wrapper.release();
 
   table::Options o;
+  o.filter_policy = BundleFilterPolicy();
   int64 cache_size;
   Status s =
       ReadInt64FromEnvVar("TF_TABLE_INDEX_CACHE_SIZE_IN_MB", 0, &cache_size);
@@ -785,6 +922,8 @@ BundleReader::BundleReader(Env* env, StringPiece prefix)
     return;
   }
   num_shards_ = header.num_shards();
+  base_bundles_.assign(header.base_bundles().begin(),
+                       header.base_bundles().end());
   if ((header.endianness() == BundleHeaderProto::BIG && port::kLittleEndian) ||
       (header.endianness() == BundleHeaderProto::LITTLE &&
        !port::kLittleEndian)) {
@@ -821,6 +960,9 @@ Status BundleReader::GetBundleEntryProto(StringPiece key,
                                          BundleEntryProto* entry) {
   entry->Clear();
   TF_CHECK_OK(status_);
+  if (!table_->KeyMayMatch(key)) {
+    return errors::NotFound("Key ", key, " not found in checkpoint");
+  }
   Seek(key);
   if (!iter_->Valid() || iter_->key() != key) {
     return errors::NotFound("Key ", key, " not found in checkpoint");
@@ -838,6 +980,39 @@ Status BundleReader::GetBundleEntryProto(StringPiece key,
   return Status::OK();
 }
 
+Status BundleReader::GetDataFilename(const BundleEntryProto& entry,
+                                     string* filename) {
+  if (entry.base_bundle() == 0) {
+    *filename = DataFilename(prefix_, entry.shard_id(), num_shards_);
+    return Status::OK();
+  }
+  if (entry.base_bundle() < 0 || entry.base_bundle() > base_bundles_.size()) {
+    return errors::DataLoss("TensorBundle at ", prefix_,
+                            ": invalid base bundle ", entry.base_bundle());
+  }
+  const BundleHeaderProto::BaseBundle& base_bundle =
+      base_bundles_[entry.base_bundle() - 1];
+  *filename = DataFilename(base_bundle.prefix(), entry.shard_id(),
+                           base_bundle.num_shards());
+  return Status::OK();
+}
+
+Status BundleReader::GetDataFile(const BundleEntryProto& entry,
+                                 io::InputBuffer** buffered_file) {
+  string filename;
+  TF_RETURN_IF_ERROR(GetDataFilename(entry, &filename));
+  *buffered_file = data_[filename];
+  if (*buffered_file == nullptr) {
+    std::unique_ptr<RandomAccessFile> file = nullptr;
+    TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(filename, &file));
+    *buffered_file = new io::InputBuffer(file.release(), kBufferSize);
+    // The InputBuffer and RandomAccessFile objects are both released in dtor.
+    data_[filename] = *buffered_file;
+  }
+  CHECK(*buffered_file != nullptr);
+  return Status::OK();
+}
+
 Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
   Tensor* ret = val;
   const TensorShape stored_shape(TensorShape(entry.shape()));
@@ -867,17 +1042,8 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
     }
   }
 
-  // Open the data file if it has not been opened.
-  io::InputBuffer* buffered_file = data_[entry.shard_id()];
-  if (buffered_file == nullptr) {
-    std::unique_ptr<RandomAccessFile> file = nullptr;
-    TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(
-        DataFilename(prefix_, entry.shard_id(), num_shards_), &file));
-    buffered_file = new io::InputBuffer(file.release(), kBufferSize);
-    // The InputBuffer and RandomAccessFile objects are both released in dtor.
-    data_[entry.shard_id()] = buffered_file;
-  }
-  CHECK(buffered_file != nullptr);
+  io::InputBuffer* buffered_file;
+  TF_RETURN_IF_ERROR(GetDataFile(entry, &buffered_file));
 
   TF_RETURN_IF_ERROR(buffered_file->Seek(entry.offset()));
   uint32 actual_crc32c = 0;
@@ -948,6 +1114,221 @@ Status BundleReader::Lookup(StringPiece key, Tensor* val) {
   }
 }
 
+Status BundleReader::LookupMany(gtl::ArraySlice<StringPiece> keys,
+                                gtl::ArraySlice<Tensor*> vals,
+                                thread::ThreadPool* pool) {
+  CHECK_EQ(keys.size(), vals.size());
+  struct TensorRead {
+    size_t index;
+    BundleEntryProto entry;
+  };
+  // A range read covering the contents of one or more tensors.
+  struct RangeRead {
+    RandomAccessFile* file;
+    int64 offset;
+    int64 size;
+    std::vector<const TensorRead*> tensors;
+    std::unique_ptr<char[]> scratch;
+    Status status;
+  };
+
+  // Looks up the metadata of all tensors first, since "iter_" cannot be used
+  // concurrently.
+  std::vector<TensorRead> reads;
+  reads.reserve(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    CHECK(vals[i] != nullptr);
+    BundleEntryProto entry;
+    TF_RETURN_IF_ERROR(GetBundleEntryProto(keys[i], &entry));
+    if (!entry.slices().empty()) {
+      TF_RETURN_IF_ERROR(GetSliceValue(
+          keys[i], entry,
+          /* a full slice */ TensorSlice(TensorShape(entry.shape()).dims()),
+          vals[i]));
+      continue;
+    }
+    if (!DataTypeCanUseMemcpy(entry.dtype())) {
+      TF_RETURN_IF_ERROR(GetValue(entry, vals[i]));
+      continue;
+    }
+    Tensor* val = vals[i];
+    if (val->NumElements() == 0) {
+      *val = Tensor(entry.dtype(), TensorShape(entry.shape()));
+    }
+    if (entry.size() != val->TotalBytes()) {
+      return errors::DataLoss("Invalid size in bundle entry: key ", keys[i],
+                              "; stored size ", entry.size(),
+                              "; expected size ", val->TotalBytes());
+    }
+    if (entry.size() > 0) reads.push_back({i, std::move(entry)});
+  }
+  std::sort(reads.begin(), reads.end(),
+            [](const TensorRead& a, const TensorRead& b) {
+              return std::make_tuple(a.entry.base_bundle(),
+                                     a.entry.shard_id(), a.entry.offset()) <
+                     std::make_tuple(b.entry.base_bundle(),
+                                     b.entry.shard_id(), b.entry.offset());
+            });
+
+  std::vector<RangeRead> ranges;
+  for (const TensorRead& read : reads) {
+    const BundleEntryProto& entry = read.entry;
+    if (!ranges.empty()) {
+      RangeRead& last = ranges.back();
+      const int64 end = entry.offset() + entry.size();
+      const BundleEntryProto& last_entry = last.tensors.back()->entry;
+      if (last_entry.base_bundle() == entry.base_bundle() &&
+          last_entry.shard_id() == entry.shard_id() &&
+          entry.offset() >= last.offset + last.size &&
+          entry.offset() - (last.offset + last.size) <= kMaxCoalescedGap &&
+          end - last.offset <= kMaxCoalescedBytes) {
+        last.size = end - last.offset;
+        last.tensors.push_back(&read);
+        continue;
+      }
+    }
+    io::InputBuffer* buffered_file;
+    TF_RETURN_IF_ERROR(GetDataFile(entry, &buffered_file));
+    ranges.push_back({buffered_file->file(), entry.offset(), entry.size()});
+    ranges.back().tensors.push_back(&read);
+  }
+
+  auto backing_buffer = [&vals](RangeRead* range) -> char* {
+    if (range->tensors.size() == 1) {
+      return const_cast<char*>(
+          vals[range->tensors[0]->index]->tensor_data().data());
+    }
+    range->scratch.reset(new char[range->size]);
+    return range->scratch.get();
+  };
+  // Moves the bytes read for "range" into its tensors and checks them.
+  auto finish_range = [this, &vals](RangeRead* range, StringPiece sp) {
+    for (const TensorRead* read : range->tensors) {
+      const BundleEntryProto& entry = read->entry;
+      Tensor* val = vals[read->index];
+      char* data = const_cast<char*>(val->tensor_data().data());
+      const char* src = sp.data() + (entry.offset() - range->offset);
+      if (src != data) memmove(data, src, entry.size());
+      // Note that we compute the checksum *before* byte-swapping.
+      const uint32 actual_crc32c = crc32c::Value(data, entry.size());
+      if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
+        range->status = errors::DataLoss(
+            "TensorBundle at ", prefix_, " shard ", entry.shard_id(), " (",
+            entry.size(), " bytes): Checksum does not match: stored ",
+            strings::Printf("%08u", crc32c::Unmask(entry.crc32c())),
+            " vs. calculated on the restored bytes ", actual_crc32c);
+        return;
+      }
+      if (need_to_swap_bytes_) {
+        range->status = ByteSwapTensor(val);
+        if (!range->status.ok()) return;
+      }
+    }
+    range->scratch.reset();
+  };
+  auto read_range = [&backing_buffer, &finish_range](RangeRead* range) {
+    char* buffer = backing_buffer(range);
+    StringPiece sp;
+    range->status = range->file->Read(range->offset, range->size, &sp, buffer);
+    if (range->status.ok()) finish_range(range, sp);
+  };
+
+  if (pool == nullptr || ranges.size() <= 1) {
+    // Submits the ranges of each data file as one batch of reads, which the
+    // file system may keep in flight at once from this thread.
+    std::map<RandomAccessFile*, std::vector<RangeRead*>> file_ranges;
+    for (RangeRead& range : ranges) {
+      file_ranges[range.file].push_back(&range);
+    }
+    std::vector<std::vector<RandomAccessFile::ReadRequest>> batches;
+    batches.reserve(file_ranges.size());
+    BlockingCounter counter(file_ranges.size());
+    for (const auto& file_and_ranges : file_ranges) {
+      batches.emplace_back();
+      std::vector<RandomAccessFile::ReadRequest>& requests = batches.back();
+      for (RangeRead* range : file_and_ranges.second) {
+        requests.emplace_back();
+        requests.back().offset = range->offset;
+        requests.back().n = range->size;
+        requests.back().scratch = backing_buffer(range);
+      }
+      file_and_ranges.first->ReadAsync(
+          &requests, [&counter]() { counter.DecrementCount(); });
+    }
+    counter.Wait();
+    size_t i = 0;
+    for (const auto& file_and_ranges : file_ranges) {
+      const std::vector<RandomAccessFile::ReadRequest>& requests = batches[i++];
+      for (size_t j = 0; j < requests.size(); ++j) {
+        RangeRead* range = file_and_ranges.second[j];
+        range->status = requests[j].status;
+        if (range->status.ok()) finish_range(range, requests[j].result);
+        TF_RETURN_IF_ERROR(range->status);
+      }
+    }
+    return Status::OK();
+  }
+  BlockingCounter counter(ranges.size());
+  for (RangeRead& range : ranges) {
+    pool->Schedule([&read_range, &range, &counter]() {
+      read_range(&range);
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+  for (const RangeRead& range : ranges) {
+    TF_RETURN_IF_ERROR(range.status);
+  }
+  return Status::OK();
+}
+
+Status BundleReader::LookupMemoryMapped(StringPiece key, Tensor* val,
+                                        bool* memory_mapped) {
+  CHECK(val != nullptr);
+  *memory_mapped = false;
+  BundleEntryProto entry;
+  TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+  const TensorShape shape(entry.shape());
+
+  if (entry.slices().empty() && DataTypeCanUseMemcpy(entry.dtype()) &&
+      !need_to_swap_bytes_ && shape.num_elements() > 0 &&
+      entry.size() == shape.num_elements() * DataTypeSize(entry.dtype())) {
+    string filename;
+    TF_RETURN_IF_ERROR(GetDataFilename(entry, &filename));
+    auto it = mapped_data_.find(filename);
+    if (it == mapped_data_.end()) {
+      std::unique_ptr<ReadOnlyMemoryRegion> region;
+      Status s = env_->NewReadOnlyMemoryRegionFromFile(filename, &region);
+      if (!s.ok()) {
+        VLOG(1) << "Reading " << filename << " without memory mapping: " << s;
+      }
+      it = mapped_data_.emplace(filename, std::move(region)).first;
+    }
+    const std::shared_ptr<ReadOnlyMemoryRegion>& region = it->second;
+    if (region != nullptr &&
+        entry.offset() + entry.size() <= region->length()) {
+      const char* data =
+          static_cast<const char*>(region->data()) + entry.offset();
+      const uintptr_t address = reinterpret_cast<uintptr_t>(data);
+      if (address % Allocator::kAllocatorAlignment == 0) {
+        *val = Tensor(entry.dtype(), shape,
+                      core::RefCountPtr<TensorBuffer>(
+                          new MappedTensorBuffer(region, data, entry.size())));
+        *memory_mapped = true;
+        return Status::OK();
+      }
+    }
+  }
+
+  *val = Tensor(entry.dtype(), shape);
+  if (entry.slices().empty()) {
+    return GetValue(entry, val);
+  } else {
+    return GetSliceValue(key, entry,
+                         /* a full slice */ TensorSlice(shape.dims()), val);
+  }
+}
+
 Status BundleReader::ReadCurrent(Tensor* val) {
   CHECK(val != nullptr);
   BundleEntryProto entry;
@@ -1102,6 +1483,7 @@ Status BundleReader::GetSliceValue(StringPiece full_tensor_key,
 }
 
 bool BundleReader::Contains(StringPiece key) {
+  if (!table_->KeyMayMatch(key)) return false;
   Seek(key);
   return Valid() && (this->key() == key);
 }
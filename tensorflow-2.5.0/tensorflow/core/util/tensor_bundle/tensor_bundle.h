@@ -62,8 +62,10 @@ limitations under the License.
 #define TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_TENSOR_BUNDLE_H_
 
 #include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
@@ -84,14 +86,21 @@ limitations under the License.
 
 namespace tensorflow {
 
+class BundleReader;
 class FileOutputBuffer;
 
+namespace thread {
+class ThreadPool;
+}  // namespace thread
+
 // Versioning of the tensor bundle format.
 // Follows the same rules as 3p/tf/core/public/version.h.
 //
 // History:
 // 0. Any tensor bundles produced before this field was added.
 // 1. Added this field (2016-09-14).
+// 2. Added incremental bundles, whose entries may refer to the data files of
+//    previous bundles.  Such bundles require consumer version 2 (2021-06-01).
 extern const int kTensorBundleMinProducer;
 extern const int kTensorBundleMinConsumer;
 extern const int kTensorBundleVersion;
@@ -113,6 +122,13 @@ class BundleWriter {
     // Alignment, in bytes, for tensor data.
     // Must be >= 1. The default size of 1 densely packs tensors.
     int data_alignment{1};
+    // If non-empty, the prefix of a previous bundle to write incrementally
+    // against.  Tensors and slices of types that can be memcpy'ed whose dtype,
+    // shape and bytes match those of the same key in the previous bundle are
+    // not written again: their entries refer to the data files holding them.
+    // The resulting bundle can only be read as long as the data files of the
+    // previous bundles it refers to exist.
+    string base_prefix;
   };
   BundleWriter(Env* env, StringPiece prefix,
                const Options& options = Options());
@@ -147,6 +163,9 @@ class BundleWriter {
   Status status() const { return status_; }
 
  private:
+  // Returns true if the data of "base_entry" in the base bundle is "val".
+  bool BaseHolds(const BundleEntryProto& base_entry, const Tensor& val);
+
   Env* const env_;  // Not owned.
   const Options options_;
   const string prefix_;
@@ -156,6 +175,10 @@ class BundleWriter {
   std::unique_ptr<FileOutputBuffer> out_;
   int64 size_;  // Number of bytes written into out_.
   std::map<string, BundleEntryProto> entries_;
+  // The bundle named by "options_.base_prefix", if any, and the bundles that
+  // the new one may refer to.
+  std::unique_ptr<BundleReader> base_;
+  std::vector<BundleHeaderProto::BaseBundle> base_bundles_;
   Status status_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(BundleWriter);
@@ -220,6 +243,39 @@ class BundleReader {
   // REQUIRES: status().ok()
   Status Lookup(StringPiece key, Tensor* val) TF_MUST_USE_RESULT;
 
+  // Looks up the tensor keyed by "key" like "Lookup()", but when possible
+  // sets "val" to a tensor that aliases a read-only memory mapping of the
+  // data file, so that its contents are paged in from the file when they
+  // are first accessed rather than read by this call.  Sets
+  // "*memory_mapped" accordingly.
+  //
+  // This is possible for unpartitioned tensors of types that can be
+  // memcpy'ed, whose stored bytes need no byte swapping and are aligned to
+  // Allocator::kAllocatorAlignment (see BundleWriter::Options::data_alignment),
+  // in a data file that the Env can memory-map.  Other tensors are allocated
+  // and read in full.  The checksum of memory-mapped contents is not
+  // validated.
+  // The mapping stays live as long as any tensor aliases it.
+  // REQUIRES: status().ok()
+  Status LookupMemoryMapped(StringPiece key, Tensor* val,
+                            bool* memory_mapped) TF_MUST_USE_RESULT;
+
+  // Looks up the tensors keyed by "keys" into the corresponding "vals", with
+  // the same effect as calling "Lookup()" for each of them.
+  //
+  // The contents of the unpartitioned tensors of types that can be memcpy'ed
+  // are fetched with range reads of the data files, in file order, coalescing
+  // the reads of tensors stored close to each other.  Unless they are
+  // coalesced, the reads place the bytes directly into the tensors in "vals".
+  // If "pool" is non-null, the reads are issued in parallel on it.  Other
+  // tensors are read one at a time by the calling thread.
+  //
+  // On error, "vals" may contain nonsense data.
+  // REQUIRES: status().ok() && keys.size() == vals.size()
+  Status LookupMany(gtl::ArraySlice<StringPiece> keys,
+                    gtl::ArraySlice<Tensor*> vals,
+                    thread::ThreadPool* pool) TF_MUST_USE_RESULT;
+
   // Looks up the tensor pointed to by the internal iterator.
   //
   // On error, "val" may contain nonsense data.
@@ -271,6 +327,16 @@ class BundleReader {
   Status GetBundleEntryProto(StringPiece key,
                              BundleEntryProto* entry) TF_MUST_USE_RESULT;
 
+  // Returns the name of the data file holding the contents of "entry",
+  // which may belong to a base bundle.
+  Status GetDataFilename(const BundleEntryProto& entry,
+                         string* filename) TF_MUST_USE_RESULT;
+
+  // Opens the data file holding the contents of "entry" if it has not been
+  // opened.
+  Status GetDataFile(const BundleEntryProto& entry,
+                     io::InputBuffer** buffered_file) TF_MUST_USE_RESULT;
+
   // Reads the tensor value described by the metadata proto "entry".
   // Usage for "val" follows the comment of "Lookup()".
   Status GetValue(const BundleEntryProto& entry,
@@ -292,8 +358,18 @@ class BundleReader {
   table::Table* table_;
   table::Cache* index_cache_;
   table::Iterator* iter_;
-  // Owned the InputBuffer objects and their underlying RandomAccessFile's.
-  std::unordered_map<int32, io::InputBuffer*> data_;
+  // The bundles that entries with a non-zero "base_bundle" refer to.
+  std::vector<BundleHeaderProto::BaseBundle> base_bundles_;
+
+  // Owned the InputBuffer objects and their underlying RandomAccessFile's,
+  // keyed by data file name.
+  std::unordered_map<string, io::InputBuffer*> data_;
+
+  // Memory mappings of the data files, or null for the files that cannot be
+  // mapped, keyed by data file name.  Populated on-demand by
+  // "LookupMemoryMapped()".
+  std::unordered_map<string, std::shared_ptr<ReadOnlyMemoryRegion>>
+      mapped_data_;
 
   // Maps each partitioned tensor's key to its stored slices (represented in a
   // TensorSliceSet).  Populated on-demand.
@@ -307,6 +383,7 @@ class BundleReader {
   // differs from that of the current system's processor architecture.
   bool need_to_swap_bytes_;
 
+  friend class BundleWriter;  // For writing incrementally against a bundle.
   friend class TensorBundleAlignmentTest;  // For testing data alignment.
 
   TF_DISALLOW_COPY_AND_ASSIGN(BundleReader);
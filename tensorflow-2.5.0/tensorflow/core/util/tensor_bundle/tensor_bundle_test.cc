@@ -25,10 +25,13 @@ limitations under the License.
 #include "tensorflow/core/framework/variant_op_registry.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/io/table_builder.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/util/tensor_bundle/byte_swap.h"
@@ -702,6 +705,202 @@ TEST(TensorBundleTest, NonStandardShapes) {
   TestNonStandardShapes<bfloat16>();
 }
 
+TEST(TensorBundleTest, AbsentKeys) {
+  {
+    BundleWriter writer(Env::Default(), Prefix("absent_keys"));
+    for (int i = 0; i < 1000; i += 2) {
+      TF_EXPECT_OK(writer.Add(strings::Printf("v%04d", i),
+                              Constant_2x3<float>(i)));
+    }
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(Env::Default(), Prefix("absent_keys"));
+  TF_ASSERT_OK(reader.status());
+  for (int i = 0; i < 1000; ++i) {
+    const string key = strings::Printf("v%04d", i);
+    if (i % 2 == 0) {
+      EXPECT_TRUE(reader.Contains(key));
+      Expect<float>(&reader, key, Constant_2x3<float>(i));
+    } else {
+      EXPECT_FALSE(reader.Contains(key));
+      Tensor val(DT_FLOAT, TensorShape({2, 3}));
+      EXPECT_TRUE(errors::IsNotFound(reader.Lookup(key, &val)));
+    }
+  }
+  // Iteration is unaffected by the lookups of absent keys.
+  reader.Seek(kHeaderEntryKey);
+  reader.Next();
+  for (int i = 0; i < 1000; i += 2) {
+    ASSERT_TRUE(reader.Valid());
+    EXPECT_EQ(strings::Printf("v%04d", i), reader.key());
+    reader.Next();
+  }
+  EXPECT_FALSE(reader.Valid());
+}
+
+TEST(TensorBundleTest, Incremental) {
+  Env* env = Env::Default();
+  auto DataFileSize = [env](const string& prefix) {
+    uint64 size;
+    TF_CHECK_OK(env->GetFileSize(DataFilename(prefix, 0, 1), &size));
+    return size;
+  };
+  {
+    BundleWriter writer(env, Prefix("full"));
+    TF_EXPECT_OK(writer.Add("unchanged", Constant_2x3<float>(1)));
+    TF_EXPECT_OK(writer.Add("changed", Constant_2x3<float>(2)));
+    TF_EXPECT_OK(writer.Add("string", Constant_2x3<tstring>("foo")));
+    TF_EXPECT_OK(writer.AddSlice("part", TensorShape({4, 3}),
+                                 TensorSlice::ParseOrDie("0,2:-"),
+                                 Constant_2x3<int32>(3)));
+    TF_EXPECT_OK(writer.AddSlice("part", TensorShape({4, 3}),
+                                 TensorSlice::ParseOrDie("2,2:-"),
+                                 Constant_2x3<int32>(4)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    BundleWriter::Options opts;
+    opts.base_prefix = Prefix("full");
+    BundleWriter writer(env, Prefix("delta"), opts);
+    TF_EXPECT_OK(writer.Add("unchanged", Constant_2x3<float>(1)));
+    TF_EXPECT_OK(writer.Add("changed", Constant_2x3<float>(5)));
+    TF_EXPECT_OK(writer.Add("string", Constant_2x3<tstring>("foo")));
+    TF_EXPECT_OK(writer.Add("new", Constant_2x3<double>(6)));
+    TF_EXPECT_OK(writer.AddSlice("part", TensorShape({4, 3}),
+                                 TensorSlice::ParseOrDie("0,2:-"),
+                                 Constant_2x3<int32>(3)));
+    TF_EXPECT_OK(writer.AddSlice("part", TensorShape({4, 3}),
+                                 TensorSlice::ParseOrDie("2,2:-"),
+                                 Constant_2x3<int32>(7)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  // Only "changed", "string", "new" and the second slice are written again.
+  {
+    BundleWriter writer(env, Prefix("changes"));
+    TF_EXPECT_OK(writer.Add("changed", Constant_2x3<float>(5)));
+    TF_EXPECT_OK(writer.Add("string", Constant_2x3<tstring>("foo")));
+    TF_EXPECT_OK(writer.Add("new", Constant_2x3<double>(6)));
+    TF_EXPECT_OK(writer.Add("slice", Constant_2x3<int32>(7)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  EXPECT_EQ(DataFileSize(Prefix("changes")), DataFileSize(Prefix("delta")));
+  {
+    BundleWriter::Options opts;
+    opts.base_prefix = Prefix("delta");
+    BundleWriter writer(env, Prefix("delta2"), opts);
+    TF_EXPECT_OK(writer.Add("unchanged", Constant_2x3<float>(1)));
+    TF_EXPECT_OK(writer.Add("changed", Constant_2x3<float>(5)));
+    TF_EXPECT_OK(writer.Add("new", Constant_2x3<double>(6)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  EXPECT_EQ(0, DataFileSize(Prefix("delta2")));
+  {
+    BundleReader reader(env, Prefix("delta2"));
+    TF_ASSERT_OK(reader.status());
+    Expect<float>(&reader, "unchanged", Constant_2x3<float>(1));
+    Expect<float>(&reader, "changed", Constant_2x3<float>(5));
+    Expect<double>(&reader, "new", Constant_2x3<double>(6));
+  }
+
+  // Merging keeps the references to the base bundles.
+  TF_ASSERT_OK(MergeBundles(env, {Prefix("delta")}, Prefix("merged")));
+  {
+    BundleReader reader(env, Prefix("merged"));
+    TF_ASSERT_OK(reader.status());
+    Expect<float>(&reader, "unchanged", Constant_2x3<float>(1));
+    Expect<float>(&reader, "changed", Constant_2x3<float>(5));
+    Expect<tstring>(&reader, "string", Constant_2x3<tstring>("foo"));
+    Expect<double>(&reader, "new", Constant_2x3<double>(6));
+    Tensor part(DT_INT32, TensorShape({4, 3}));
+    TF_ASSERT_OK(reader.Lookup("part", &part));
+    test::ExpectTensorEqual<int32>(
+        part,
+        test::AsTensor<int32>({3, 3, 3, 3, 3, 3, 7, 7, 7, 7, 7, 7}, {4, 3}));
+  }
+
+  // Older consumers cannot read bundles that refer to base bundles.
+  {
+    std::unique_ptr<RandomAccessFile> file;
+    const string filename = MetaFilename(Prefix("delta2"));
+    TF_ASSERT_OK(env->NewRandomAccessFile(filename, &file));
+    uint64 file_size;
+    TF_ASSERT_OK(env->GetFileSize(filename, &file_size));
+    table::Table* table = nullptr;
+    TF_ASSERT_OK(
+        table::Table::Open(table::Options(), file.get(), file_size, &table));
+    std::unique_ptr<table::Table> table_deleter(table);
+    std::unique_ptr<table::Iterator> iter(table->NewIterator());
+    iter->Seek(kHeaderEntryKey);
+    ASSERT_TRUE(iter->Valid());
+    BundleHeaderProto header;
+    ASSERT_TRUE(header.ParseFromArray(iter->value().data(),
+                                      iter->value().size()));
+    EXPECT_EQ(2, header.version().min_consumer());
+    ASSERT_EQ(2, header.base_bundles_size());
+    EXPECT_EQ(Prefix("full"), header.base_bundles(0).prefix());
+    EXPECT_EQ(Prefix("delta"), header.base_bundles(1).prefix());
+  }
+}
+
+// Returns a non-zero difference of 8-byte values that leaves their CRC32C
+// unchanged.  The checksum of data of a given length is affine in its bits, so
+// some combination of any 33 single-bit differences has no effect on it.
+uint64 Crc32cPreservingDifference() {
+  const uint64 zero = 0;
+  const uint32 zero_crc =
+      crc32c::Value(reinterpret_cast<const char*>(&zero), sizeof(zero));
+  // Linearly independent checksum differences, by their highest bit, and the
+  // value differences causing them.
+  uint32 crc_basis[32] = {};
+  uint64 diff_basis[32] = {};
+  for (int bit = 0; bit < 64; ++bit) {
+    uint64 diff = uint64{1} << bit;
+    uint32 crc =
+        crc32c::Value(reinterpret_cast<const char*>(&diff), sizeof(diff)) ^
+        zero_crc;
+    for (int high = 31; high >= 0 && crc != 0; --high) {
+      if ((crc >> high & 1) == 0) continue;
+      if (crc_basis[high] == 0) {
+        crc_basis[high] = crc;
+        diff_basis[high] = diff;
+        break;
+      }
+      crc ^= crc_basis[high];
+      diff ^= diff_basis[high];
+    }
+    if (crc == 0) return diff;
+  }
+  LOG(FATAL) << "No CRC32C-preserving difference found";
+}
+
+TEST(TensorBundleTest, IncrementalComparesBytes) {
+  Env* env = Env::Default();
+  const uint64 base_value = 0x0123456789abcdef;
+  const uint64 new_value = base_value ^ Crc32cPreservingDifference();
+  ASSERT_NE(base_value, new_value);
+  ASSERT_EQ(
+      crc32c::Value(reinterpret_cast<const char*>(&base_value), 8),
+      crc32c::Value(reinterpret_cast<const char*>(&new_value), 8));
+  {
+    BundleWriter writer(env, Prefix("crc_base"));
+    TF_EXPECT_OK(writer.Add(
+        "x", test::AsScalar<int64>(static_cast<int64>(base_value))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    BundleWriter::Options opts;
+    opts.base_prefix = Prefix("crc_base");
+    BundleWriter writer(env, Prefix("crc_delta"), opts);
+    TF_EXPECT_OK(writer.Add(
+        "x", test::AsScalar<int64>(static_cast<int64>(new_value))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(env, Prefix("crc_delta"));
+  TF_ASSERT_OK(reader.status());
+  Expect<int64>(&reader, "x",
+                test::AsScalar<int64>(static_cast<int64>(new_value)));
+}
+
 TEST(TensorBundleTest, StringTensorsOldFormat) {
   // Test string tensor bundle made with previous version of code that use
   // varint32s to store string lengths (we now use varint64s).
@@ -1112,6 +1311,114 @@ TEST_F(TensorBundleAlignmentTest, AlignmentTest) {
   }
 }
 
+TEST(TensorBundleTest, LookupMemoryMapped) {
+  {
+    BundleWriter::Options opts;
+    opts.data_alignment = Allocator::kAllocatorAlignment;
+    BundleWriter writer(Env::Default(), Prefix("mapped"), opts);
+    TF_EXPECT_OK(writer.Add("float", Constant_2x3<float>(1.5)));
+    TF_EXPECT_OK(writer.Add("int64", Constant_2x3<int64>(7)));
+    TF_EXPECT_OK(writer.Add("string", Constant_2x3<tstring>("foo")));
+    TF_EXPECT_OK(writer.Add("empty", Constant<float>(0, TensorShape({0}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(Env::Default(), Prefix("mapped"));
+  TF_ASSERT_OK(reader.status());
+  Tensor val;
+  bool memory_mapped;
+  TF_ASSERT_OK(reader.LookupMemoryMapped("float", &val, &memory_mapped));
+  EXPECT_TRUE(memory_mapped);
+  test::ExpectTensorEqual<float>(val, Constant_2x3<float>(1.5));
+  TF_ASSERT_OK(reader.LookupMemoryMapped("int64", &val, &memory_mapped));
+  EXPECT_TRUE(memory_mapped);
+  test::ExpectTensorEqual<int64>(val, Constant_2x3<int64>(7));
+  // Tensors that cannot alias the data file are read in full.
+  TF_ASSERT_OK(reader.LookupMemoryMapped("string", &val, &memory_mapped));
+  EXPECT_FALSE(memory_mapped);
+  test::ExpectTensorEqual<tstring>(val, Constant_2x3<tstring>("foo"));
+  TF_ASSERT_OK(reader.LookupMemoryMapped("empty", &val, &memory_mapped));
+  EXPECT_FALSE(memory_mapped);
+  EXPECT_EQ(TensorShape({0}), val.shape());
+  EXPECT_TRUE(errors::IsNotFound(
+      reader.LookupMemoryMapped("absent", &val, &memory_mapped)));
+}
+
+TEST(TensorBundleTest, LookupMemoryMappedUnaligned) {
+  {
+    BundleWriter writer(Env::Default(), Prefix("unaligned"));
+    TF_EXPECT_OK(writer.Add("foo_000", Constant_2x3<float>(0)));
+    TF_EXPECT_OK(writer.Add("foo_001", Constant_2x3<float>(1)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(Env::Default(), Prefix("unaligned"));
+  TF_ASSERT_OK(reader.status());
+  Tensor val;
+  bool memory_mapped;
+  TF_ASSERT_OK(reader.LookupMemoryMapped("foo_000", &val, &memory_mapped));
+  test::ExpectTensorEqual<float>(val, Constant_2x3<float>(0));
+  // Stored at offset 24, which is not suitably aligned.
+  TF_ASSERT_OK(reader.LookupMemoryMapped("foo_001", &val, &memory_mapped));
+  EXPECT_FALSE(memory_mapped);
+  test::ExpectTensorEqual<float>(val, Constant_2x3<float>(1));
+}
+
+void TestLookupMany(thread::ThreadPool* pool, int data_alignment) {
+  const string prefix = Prefix(strings::StrCat("many_", data_alignment));
+  {
+    BundleWriter::Options opts;
+    opts.data_alignment = data_alignment;
+    BundleWriter writer(Env::Default(), prefix, opts);
+    for (int i = 0; i < 100; ++i) {
+      TF_EXPECT_OK(writer.Add(strings::Printf("float_%03d", i),
+                              Constant_2x3<float>(i)));
+    }
+    TF_EXPECT_OK(writer.Add("big", Constant<double>(2.5, TensorShape({1000}))));
+    TF_EXPECT_OK(writer.Add("empty", Constant<float>(0, TensorShape({0}))));
+    TF_EXPECT_OK(writer.Add("string", Constant_2x3<tstring>("foo")));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(Env::Default(), prefix);
+  TF_ASSERT_OK(reader.status());
+
+  // Looks up the tensors out of order, into both allocated and empty tensors.
+  std::vector<string> keys = {"string", "big", "empty"};
+  for (int i = 99; i >= 0; i -= 3) {
+    keys.push_back(strings::Printf("float_%03d", i));
+  }
+  std::vector<Tensor> tensors(keys.size());
+  tensors[1] = Tensor(DT_DOUBLE, TensorShape({1000}));
+  std::vector<StringPiece> key_pieces(keys.begin(), keys.end());
+  std::vector<Tensor*> vals;
+  for (Tensor& t : tensors) vals.push_back(&t);
+  TF_ASSERT_OK(reader.LookupMany(key_pieces, vals, pool));
+
+  test::ExpectTensorEqual<tstring>(tensors[0], Constant_2x3<tstring>("foo"));
+  test::ExpectTensorEqual<double>(tensors[1],
+                                  Constant<double>(2.5, TensorShape({1000})));
+  EXPECT_EQ(TensorShape({0}), tensors[2].shape());
+  for (int i = 99, j = 3; i >= 0; i -= 3, ++j) {
+    test::ExpectTensorEqual<float>(tensors[j], Constant_2x3<float>(i));
+  }
+
+  // Mismatched shapes and absent keys are reported.
+  Tensor wrong_shape(DT_DOUBLE, TensorShape({10}));
+  Tensor* wrong_shape_ptr = &wrong_shape;
+  EXPECT_TRUE(errors::IsDataLoss(
+      reader.LookupMany({"big"}, {wrong_shape_ptr}, pool)));
+  Tensor absent;
+  Tensor* absent_ptr = &absent;
+  EXPECT_TRUE(
+      errors::IsNotFound(reader.LookupMany({"absent"}, {absent_ptr}, pool)));
+}
+
+TEST(TensorBundleTest, LookupMany) {
+  thread::ThreadPool pool(Env::Default(), "lookup_many", 4);
+  for (int data_alignment : {1, 64}) {
+    TestLookupMany(nullptr, data_alignment);
+    TestLookupMany(&pool, data_alignment);
+  }
+}
+
 static void BM_BundleAlignment(::testing::benchmark::State& state) {
   {
     const int alignment = state.range(0);
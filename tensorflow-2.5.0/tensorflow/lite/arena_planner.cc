@@ -25,6 +25,8 @@ limitations under the License.
 
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/graph_info.h"
+#include "tensorflow/lite/memory_planner.h"
+#include "tensorflow/lite/minimal_logging.h"
 #include "tensorflow/lite/simple_memory_arena.h"
 
 namespace tflite {
@@ -32,6 +34,27 @@ namespace {
 
 constexpr int32_t kNodeNotAssigned = std::numeric_limits<int32_t>::max();
 
+// Number of plans kept by ArenaPlanner for the tensor sizes seen most recently,
+// e.g. for the input shapes of a model that is resized on every request.
+constexpr int kMaxCachedPlans = 4;
+
+// Returns true if the allocations are for the same tensors, sizes and usage
+// intervals, regardless of their offsets.
+bool HaveSameRequirements(const std::vector<ArenaAllocWithUsageInterval>& a,
+                          const std::vector<ArenaAllocWithUsageInterval>& b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.size(); ++i) {
+    if (a[i].tensor != b[i].tensor || a[i].size != b[i].size ||
+        a[i].first_node != b[i].first_node ||
+        a[i].last_node != b[i].last_node) {
+      return false;
+    }
+  }
+  return true;
+}
+
 }  // namespace
 
 ArenaPlanner::ArenaPlanner(TfLiteContext* context,
@@ -59,7 +82,9 @@ std::intptr_t ArenaPlanner::BasePointer(TfLiteAllocationType type) {
 }
 
 TfLiteStatus ArenaPlanner::ResetAllocations() {
-  TF_LITE_ENSURE_STATUS(arena_.ClearPlan());
+  // All tensors in arena_ are planned again and need to be written before they
+  // are read, so there is no point in preserving their data when it grows.
+  TF_LITE_ENSURE_STATUS(arena_.ClearPlanAndDiscardData());
   TF_LITE_ENSURE_STATUS(persistent_arena_.ClearPlan());
   allocs_.clear();
   allocs_.resize(graph_info_->num_tensors());
@@ -108,7 +133,7 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
       return kTfLiteOk;
     }
     TF_LITE_ENSURE(context_, dealloc_node_[tensor] == kNodeNotAssigned);
-    dealloc_node_[tensor] = node;
+    dealloc_node_[tensor] = DeallocationNode(node);
     return kTfLiteOk;
   };
 
@@ -204,7 +229,7 @@ TfLiteStatus ArenaPlanner::ExecuteAllocations(int first_node, int last_node) {
       int tensor_index = node_temporaries->data[j];
       alloc_node_[tensor_index] = i;
       if (!preserve_intermediates_) {
-        dealloc_node_[tensor_index] = i;
+        dealloc_node_[tensor_index] = DeallocationNode(i);
       }
     }
   }
@@ -253,6 +278,53 @@ bool ArenaPlanner::HasNonPersistentMemory() {
   return arena_.GetBufferSize() != 0;
 }
 
+TfLiteStatus ArenaPlanner::SetOfflinePlannedOffsets(
+    std::vector<int32_t> offsets) {
+  TF_LITE_ENSURE(context_, offsets.size() <= graph_info_->num_tensors());
+  offline_offsets_ = std::move(offsets);
+  return kTfLiteOk;
+}
+
+TfLiteStatus ArenaPlanner::GetPlannedOffsets(std::vector<int32_t>* offsets) {
+  offsets->assign(graph_info_->num_tensors(), kOnlinePlannedOffset);
+  for (int i = 0; i < static_cast<int>(allocs_.size()); ++i) {
+    const TfLiteTensor& tensor = *graph_info_->tensor(i);
+    if (tensor.allocation_type == kTfLiteArenaRw && allocs_[i].size != 0) {
+      TF_LITE_ENSURE(context_, allocs_[i].offset <=
+                                   std::numeric_limits<int32_t>::max());
+      (*offsets)[i] = static_cast<int32_t>(allocs_[i].offset);
+    }
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus ArenaPlanner::SetExecutionStages(std::vector<int> stage_starts) {
+  stage_last_node_.clear();
+  if (stage_starts.empty()) {
+    return kTfLiteOk;
+  }
+  const int num_nodes = graph_info_->num_execution_nodes();
+  TF_LITE_ENSURE(context_, stage_starts.front() == 0);
+  TF_LITE_ENSURE(context_, stage_starts.back() == num_nodes);
+  stage_last_node_.resize(num_nodes);
+  for (int i = 0; i + 1 < static_cast<int>(stage_starts.size()); ++i) {
+    TF_LITE_ENSURE(context_, stage_starts[i] < stage_starts[i + 1]);
+    for (int node = stage_starts[i]; node < stage_starts[i + 1]; ++node) {
+      stage_last_node_[node] = stage_starts[i + 1] - 1;
+    }
+  }
+  return kTfLiteOk;
+}
+
+int32_t ArenaPlanner::DeallocationNode(int node) const {
+  // Tensors used by a stage are allocated no later than the stage, so keeping
+  // them until its end makes the usage intervals of all of them overlap.
+  if (node < static_cast<int>(stage_last_node_.size())) {
+    return stage_last_node_[node];
+  }
+  return node;
+}
+
 TfLiteStatus ArenaPlanner::Commit() {
   TF_LITE_ENSURE_STATUS(arena_.Commit(context_));
   TF_LITE_ENSURE_STATUS(persistent_arena_.Commit(context_));
@@ -300,11 +372,71 @@ std::vector<int32_t> ArenaPlanner::CreateTensorAllocationVector(int first_node,
   return tensor_order;
 }
 
+bool ArenaPlanner::HasOfflinePlannedOffset(int tensor_index) const {
+  return tensor_index < static_cast<int>(offline_offsets_.size()) &&
+         offline_offsets_[tensor_index] != kOnlinePlannedOffset &&
+         graph_info_->tensor(tensor_index)->allocation_type == kTfLiteArenaRw;
+}
+
+bool ArenaPlanner::CanUseOfflinePlannedOffsets(int first_node,
+                                               int last_node) const {
+  std::vector<ArenaAllocWithUsageInterval> planned;
+  for (int i = 0; i < static_cast<int>(allocs_.size()); ++i) {
+    const TfLiteTensor& tensor = *graph_info_->tensor(i);
+    if (!HasOfflinePlannedOffset(i)) {
+      // Tensors planned at runtime by an earlier call keep their place, so the
+      // offline planned tensors must not overlap them either.
+      if (tensor.allocation_type == kTfLiteArenaRw && allocs_[i].size != 0 &&
+          alloc_node_[i] < first_node) {
+        planned.push_back(allocs_[i]);
+      }
+      continue;
+    }
+    if (alloc_node_[i] > last_node || tensor.bytes == 0) {
+      continue;
+    }
+    if (offline_offsets_[i] < 0 ||
+        offline_offsets_[i] % tensor_alignment_ != 0) {
+      return false;
+    }
+    planned.emplace_back();
+    planned.back().offset = offline_offsets_[i];
+    planned.back().size = tensor.bytes;
+    planned.back().tensor = i;
+    planned.back().first_node = alloc_node_[i];
+    planned.back().last_node = dealloc_node_[i];
+  }
+  // Only allocations that overlap in memory need to have disjoint usage
+  // intervals; after sorting by offset those are found by a forward scan.
+  std::sort(planned.begin(), planned.end());
+  for (auto it = planned.begin(); it != planned.end(); ++it) {
+    for (auto other = it + 1;
+         other != planned.end() && other->offset < it->offset + it->size;
+         ++other) {
+      if ((HasOfflinePlannedOffset(it->tensor) ||
+           HasOfflinePlannedOffset(other->tensor)) &&
+          other->first_node <= it->last_node &&
+          other->last_node >= it->first_node) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
 TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
   // Indices of tensors in order their allocation offsets will be calculated.
   const std::vector<int32_t> tensor_order =
       CreateTensorAllocationVector(first_node, last_node);
 
+  if (!offline_offsets_.empty() &&
+      !CanUseOfflinePlannedOffsets(first_node, last_node)) {
+    TFLITE_LOG(TFLITE_LOG_WARNING,
+               "Offline planned tensor offsets don't fit the tensors, "
+               "planning memory at runtime instead.");
+    offline_offsets_.clear();
+  }
+
   // Deallocate if the tensor was already allocated.
   for (const auto& tensor_index : tensor_order) {
     TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
@@ -314,10 +446,55 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
     }
   }
 
+  // Place the tensors with an offline planned offset first, so that the
+  // remaining ones are fitted around them.
+  for (const auto& tensor_index : tensor_order) {
+    if (HasOfflinePlannedOffset(tensor_index)) {
+      TF_LITE_ENSURE_STATUS(arena_.AllocateAt(
+          context_, offline_offsets_[tensor_index],
+          graph_info_->tensor(tensor_index)->bytes, tensor_index,
+          alloc_node_[tensor_index], dealloc_node_[tensor_index],
+          &allocs_[tensor_index]));
+    }
+  }
+
+  // When arena_ is empty apart from the tensors planned here, their offsets
+  // only depend on their sizes and usage intervals, so a plan computed for the
+  // same requirements before is reused instead of searching for gaps again.
+  std::vector<ArenaAllocWithUsageInterval> requirements;
+  bool reused_cached_plan = false;
+  if (offline_offsets_.empty() && IsArenaEmptyOutside(first_node, last_node)) {
+    for (const auto& tensor_index : tensor_order) {
+      const TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
+      if (tensor.allocation_type == kTfLiteArenaRw) {
+        requirements.emplace_back();
+        requirements.back().size = tensor.bytes;
+        requirements.back().tensor = tensor_index;
+        requirements.back().first_node = alloc_node_[tensor_index];
+        requirements.back().last_node = dealloc_node_[tensor_index];
+      }
+    }
+    for (auto it = plan_cache_.begin(); it != plan_cache_.end(); ++it) {
+      if (!HaveSameRequirements(*it, requirements)) {
+        continue;
+      }
+      for (const auto& alloc : *it) {
+        TF_LITE_ENSURE_STATUS(arena_.AllocateAt(
+            context_, alloc.offset, alloc.size, alloc.tensor, alloc.first_node,
+            alloc.last_node, &allocs_[alloc.tensor]));
+      }
+      // Keep the most recently used plans at the front.
+      std::rotate(plan_cache_.begin(), it, it + 1);
+      reused_cached_plan = true;
+      break;
+    }
+  }
+
   // Vector of ids of already allocated tensors, ordered by offset.
   for (const auto& tensor_index : tensor_order) {
     TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
-    if (tensor.allocation_type == kTfLiteArenaRw) {
+    if (tensor.allocation_type == kTfLiteArenaRw && !reused_cached_plan &&
+        !HasOfflinePlannedOffset(tensor_index)) {
       TF_LITE_ENSURE_STATUS(
           arena_.Allocate(context_, tensor_alignment_, tensor.bytes,
                           tensor_index, alloc_node_[tensor_index],
@@ -333,9 +510,30 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
           &allocs_[tensor_index]));
     }
   }
+
+  if (!requirements.empty() && !reused_cached_plan) {
+    for (auto& alloc : requirements) {
+      alloc.offset = allocs_[alloc.tensor].offset;
+    }
+    if (plan_cache_.size() == kMaxCachedPlans) {
+      plan_cache_.pop_back();
+    }
+    plan_cache_.insert(plan_cache_.begin(), std::move(requirements));
+  }
   return kTfLiteOk;
 }
 
+bool ArenaPlanner::IsArenaEmptyOutside(int first_node, int last_node) const {
+  for (int i = 0; i < static_cast<int>(allocs_.size()); ++i) {
+    if (allocs_[i].size != 0 &&
+        graph_info_->tensor(i)->allocation_type == kTfLiteArenaRw &&
+        (alloc_node_[i] < first_node || alloc_node_[i] > last_node)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 TfLiteStatus ArenaPlanner::ResolveTensorAllocation(int tensor_index) {
   TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
   if (tensor.allocation_type == kTfLiteArenaRw) {
@@ -63,6 +63,9 @@ class ArenaPlanner : public MemoryPlanner {
   TfLiteStatus ReleaseNonPersistentMemory() override;
   TfLiteStatus AcquireNonPersistentMemory() override;
   bool HasNonPersistentMemory() override;
+  TfLiteStatus SetOfflinePlannedOffsets(std::vector<int32_t> offsets) override;
+  TfLiteStatus GetPlannedOffsets(std::vector<int32_t>* offsets) override;
+  TfLiteStatus SetExecutionStages(std::vector<int> stage_starts) override;
 
   // Returns the base arena location for a given allocation type.
   std::intptr_t BasePointer(TfLiteAllocationType type);
@@ -86,6 +89,19 @@ class ArenaPlanner : public MemoryPlanner {
   // for all tensors affected by ops in the interval [first_node, last_node].
   TfLiteStatus CalculateAllocations(int first_node, int last_node);
 
+  // Returns true if arena_ holds no tensors other than the ones allocated by
+  // ops in the interval [first_node, last_node].
+  bool IsArenaEmptyOutside(int first_node, int last_node) const;
+
+  // Returns true if the tensor should be placed at its offline planned offset.
+  bool HasOfflinePlannedOffset(int tensor_index) const;
+
+  // Returns true if all tensors allocated no later than 'last_node' can be
+  // placed at their offline planned offsets, given their current sizes and
+  // usage intervals, without overlapping each other or the tensors placed at
+  // runtime before 'first_node'.
+  bool CanUseOfflinePlannedOffsets(int first_node, int last_node) const;
+
   // Assign absolute memory location to a tensor, based on its relative
   // position inside the corresponding arena buffer.
   TfLiteStatus ResolveTensorAllocation(int tensor_index);
@@ -98,6 +114,10 @@ class ArenaPlanner : public MemoryPlanner {
   // 'node_index'.
   TfLiteStatus CalculateDeallocationOfInternalTensors(int node_index);
 
+  // Returns the node after which a tensor last used by 'node' can be
+  // deallocated, the last node of its execution stage.
+  int32_t DeallocationNode(int node) const;
+
   TfLiteContext* context_;
   std::unique_ptr<GraphInfo> graph_info_;
 
@@ -112,6 +132,19 @@ class ArenaPlanner : public MemoryPlanner {
   // the node's operation.
   std::vector<int32_t> dealloc_node_;
 
+  // Last node of the execution stage of each node, indexed by node, if nodes
+  // may be executed concurrently. Empty otherwise.
+  std::vector<int32_t> stage_last_node_;
+
+  // Offsets in arena_ given to SetOfflinePlannedOffsets(), indexed by tensor.
+  // Cleared if they turn out not to fit the tensors.
+  std::vector<int32_t> offline_offsets_;
+
+  // Allocations in arena_ of the most recent plans that started from an empty
+  // arena, most recently used first. Each is ordered like the tensors in
+  // CalculateAllocations().
+  std::vector<std::vector<ArenaAllocWithUsageInterval>> plan_cache_;
+
   // Raw memory buffer that is allocated for all temporary and graph outputs
   // that are declared kTfLiteArenaRw.
   SimpleMemoryArena arena_;
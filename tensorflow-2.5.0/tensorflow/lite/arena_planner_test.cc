@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/graph_info.h"
+#include "tensorflow/lite/memory_planner.h"
 #include "tensorflow/lite/testing/util.h"
 
 namespace tflite {
@@ -294,6 +295,118 @@ TEST_F(ArenaPlannerTest, SimpleGraph) {
   EXPECT_EQ(GetOffset(1), 0);
 }
 
+TEST_F(ArenaPlannerTest, ResizedTensorsAreReplanned) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},     // First op
+                      {{2, 0}, {4, 5}, {}},  // Second op
+                      {{4, 5}, {3}, {}}      // Third op
+                  },
+                  {3});
+  SetGraph(&graph);
+  Execute(0, 10);
+  std::vector<std::ptrdiff_t> offsets;
+  for (int i = 0; i < 6; ++i) {
+    offsets.push_back(GetOffset(i));
+  }
+  const size_t original_bytes = (*graph.tensors())[5].bytes;
+
+  // Growing tensor 5 must not reuse the plan computed for the old sizes.
+  (*graph.tensors())[5].bytes = 1000;
+  ASSERT_EQ(planner_->ResetAllocations(), kTfLiteOk);
+  Execute(0, 10);
+  EXPECT_EQ(GetOffset(5), 0);
+  EXPECT_EQ(GetOffset(4), GetOffsetAfter(5));
+  EXPECT_EQ(GetOffset(3), GetOffsetAfter(4));
+  EXPECT_EQ(GetOffset(2), GetOffsetAfter(4));
+  EXPECT_EQ(GetOffset(0), GetOffsetAfter(2));
+  EXPECT_EQ(GetOffset(1), 0);
+
+  // Going back to the original sizes gives the original offsets.
+  (*graph.tensors())[5].bytes = original_bytes;
+  ASSERT_EQ(planner_->ResetAllocations(), kTfLiteOk);
+  Execute(0, 10);
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(GetOffset(i), offsets[i]);
+  }
+}
+
+TEST_F(ArenaPlannerTest, PlannedOffsetsRoundTrip) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},     // First op
+                      {{2, 0}, {4, 5}, {}},  // Second op
+                      {{4, 5}, {3}, {}}      // Third op
+                  },
+                  {3});
+  SetGraph(&graph);
+  Execute(0, 10);
+  std::vector<int32_t> offsets;
+  ASSERT_EQ(planner_->GetPlannedOffsets(&offsets), kTfLiteOk);
+  ASSERT_EQ(offsets.size(), 6);
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(offsets[i], GetOffset(i));
+  }
+
+  SetGraph(&graph);
+  ASSERT_EQ(planner_->SetOfflinePlannedOffsets(offsets), kTfLiteOk);
+  Execute(0, 10);
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(GetOffset(i), offsets[i]);
+  }
+}
+
+TEST_F(ArenaPlannerTest, OfflinePlannedOffsets) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},     // First op
+                      {{2, 0}, {4, 5}, {}},  // Second op
+                      {{4, 5}, {3}, {}}      // Third op
+                  },
+                  {3});
+  SetGraph(&graph);
+  ASSERT_EQ(planner_->SetOfflinePlannedOffsets(
+                {0, 32, 64, kOnlinePlannedOffset, 96, 128}),
+            kTfLiteOk);
+  Execute(0, 10);
+
+  EXPECT_EQ(GetOffset(0), 0);
+  EXPECT_EQ(GetOffset(1), 32);
+  EXPECT_EQ(GetOffset(2), 64);
+  EXPECT_EQ(GetOffset(4), 96);
+  EXPECT_EQ(GetOffset(5), 128);
+  // Tensor 3 is planned at runtime around the other tensors. It is only alive
+  // together with 4 and 5, and the gap between them is the best fit.
+  EXPECT_EQ(GetOffset(3), GetOffsetAfter(4));
+}
+
+TEST_F(ArenaPlannerTest, OverlappingOfflinePlannedOffsetsAreDropped) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},     // First op
+                      {{2, 0}, {4, 5}, {}},  // Second op
+                      {{4, 5}, {3}, {}}      // Third op
+                  },
+                  {3});
+  SetGraph(&graph);
+  // Tensors 0 and 1 are alive at the same time, so they can't share memory.
+  ASSERT_EQ(planner_->SetOfflinePlannedOffsets({0, 0, 64, 0, 96, 128}),
+            kTfLiteOk);
+  Execute(0, 10);
+
+  // The same plan as in SimpleGraph.
+  EXPECT_EQ(GetOffset(5), 0);
+  EXPECT_EQ(GetOffset(4), GetOffsetAfter(5));
+  EXPECT_EQ(GetOffset(3), GetOffsetAfter(4));
+  EXPECT_EQ(GetOffset(2), GetOffsetAfter(4));
+  EXPECT_EQ(GetOffset(0), GetOffsetAfter(2));
+  EXPECT_EQ(GetOffset(1), 0);
+}
+
 TEST_F(ArenaPlannerTest, SimpleGraphInputsPreserved) {
   TestGraph graph({0, 1},
                   {
@@ -336,6 +449,45 @@ TEST_F(ArenaPlannerTest, SimpleGraphWithTemporary) {
   EXPECT_EQ(GetOffset(1), 0);
 }
 
+TEST_F(ArenaPlannerTest, TensorsOfConcurrentNodesDontShareMemory) {
+  TestGraph graph({0},
+                  {
+                      /* in, out, tmp */
+                      {{0}, {1}, {4}},    // First op, with temporary
+                      {{0}, {2}, {5}},    // Second op, with temporary
+                      {{1, 2}, {3}, {}}   // Third op
+                  },
+                  {3});
+  SetGraph(&graph);
+  Execute(0, 10);
+  // Run one at a time, the first op's temporary is reused by the second op.
+  EXPECT_EQ(GetOffset(5), GetOffset(4));
+
+  // Run the first two ops concurrently.
+  ASSERT_EQ(planner_->SetExecutionStages({0, 2, 3}), kTfLiteOk);
+  CHECK(planner_->PlanAllocations() == kTfLiteOk);
+  Execute(0, 10);
+  const std::vector<int> stage_tensors = {0, 1, 2, 4, 5};
+  for (int a : stage_tensors) {
+    for (int b : stage_tensors) {
+      if (a == b) continue;
+      EXPECT_TRUE(GetOffset(a) >= GetOffsetAfter(b) ||
+                  GetOffset(b) >= GetOffsetAfter(a))
+          << "Tensors " << a << " and " << b << " overlap";
+    }
+  }
+}
+
+TEST_F(ArenaPlannerTest, InvalidExecutionStages) {
+  TestGraph graph({0}, {{{0}, {1}, {}}, {{1}, {2}, {}}}, {2});
+  SetGraph(&graph);
+  EXPECT_EQ(planner_->SetExecutionStages({1, 2}), kTfLiteError);
+  EXPECT_EQ(planner_->SetExecutionStages({0, 1}), kTfLiteError);
+  EXPECT_EQ(planner_->SetExecutionStages({0, 1, 1, 2}), kTfLiteError);
+  EXPECT_EQ(planner_->SetExecutionStages({0, 1, 2}), kTfLiteOk);
+  EXPECT_EQ(planner_->SetExecutionStages({}), kTfLiteOk);
+}
+
 TEST_F(ArenaPlannerTest, SimpleGraphWithResetAllocationsAfter) {
   TestGraph graph({0, 1},
                   {
@@ -24,6 +24,7 @@ limitations under the License.
 #include <cstring>
 #include <iterator>
 #include <memory>
+#include <numeric>
 #include <utility>
 #include <vector>
 
@@ -38,6 +39,7 @@ limitations under the License.
 #include "tensorflow/lite/core/macros.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
 #include "tensorflow/lite/graph_info.h"
+#include "tensorflow/lite/inter_op_thread_pool.h"
 #include "tensorflow/lite/memory_planner.h"
 #include "tensorflow/lite/minimal_logging.h"
 #include "tensorflow/lite/schema/schema_generated.h"
@@ -191,6 +193,11 @@ class SubgraphGuard {
   bool* is_subgraph_in_use_;
 };
 
+// The CPU backend context that kernels running on an inter-op worker thread
+// use instead of the interpreter's one, which only the thread calling Invoke()
+// may use.
+thread_local TfLiteExternalContext* inter_op_cpu_backend_context = nullptr;
+
 }  // namespace
 
 // A trivial implementation of GraphInfo around the Interpreter.
@@ -464,6 +471,10 @@ TfLiteStatus Subgraph::ReplaceNodeSubsetsWithDelegateKernels(
 
 TfLiteExternalContext* Subgraph::GetExternalContext(
     TfLiteExternalContextType type) {
+  if (type == kTfLiteCpuBackendContext &&
+      inter_op_cpu_backend_context != nullptr) {
+    return inter_op_cpu_backend_context;
+  }
   if (static_cast<int>(type) >= 0 && type < kTfLiteMaxExternalContexts) {
     return external_contexts_[type];
   }
@@ -969,6 +980,12 @@ TfLiteStatus Subgraph::PrepareOpsAndTensors() {
         &context_, std::unique_ptr<GraphInfo>(new InterpreterInfo(this)),
         /*preserve_inputs=*/true, preserve_all_tensors_,
         kDefaultTensorAlignment));
+    if (!offline_planned_offsets_.empty()) {
+      TF_LITE_ENSURE_STATUS(memory_planner_->SetOfflinePlannedOffsets(
+          std::move(offline_planned_offsets_)));
+      offline_planned_offsets_.clear();
+    }
+    TF_LITE_ENSURE_STATUS(PlanExecutionStages());
     memory_planner_->PlanAllocations();
   }
 
@@ -1048,6 +1065,13 @@ TfLiteStatus Subgraph::Invoke() {
   }
   TFLITE_SCOPED_TAGGED_DEFAULT_PROFILE(profiler_.get(), "Invoke");
 
+  // Nodes are only executed concurrently if all of them could be prepared
+  // ahead, and ops aren't profiled.
+  if (!execution_stages_.empty() && !has_dynamic_tensors_ && !profiler_ &&
+      next_execution_plan_index_to_prepare_ == execution_plan_.size()) {
+    return InvokeExecutionStages();
+  }
+
   // Invocations are always done in node order.
   // Note that calling Invoke repeatedly will cause the original memory plan to
   // be reused, unless either ResizeInputTensor() or AllocateTensors() has been
@@ -1068,41 +1092,7 @@ TfLiteStatus Subgraph::Invoke() {
     if (profiler_) op_name = GetTFLiteOpName(registration);
     TFLITE_SCOPED_TAGGED_OPERATOR_PROFILE(profiler_.get(), op_name, node_index);
 
-    // TODO(ycling): This is an extra loop through inputs to check if the data
-    // need to be copied from Delegate buffer to raw memory, which is often not
-    // needed. We may want to cache this in prepare to know if this needs to be
-    // done for a node or not.
-    for (int i = 0; i < node.inputs->size; ++i) {
-      int tensor_index = node.inputs->data[i];
-      if (tensor_index == kTfLiteOptionalTensor) {
-        continue;
-      }
-      TfLiteTensor* tensor = &tensors_[tensor_index];
-      if (tensor->delegate && tensor->delegate != node.delegate &&
-          tensor->data_is_stale) {
-        TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(tensor_index));
-      }
-      if (tensor->data.raw == nullptr && tensor->bytes > 0) {
-        if (registration.builtin_code == kTfLiteBuiltinReshape && i == 1 &&
-            tensor->dims->size != 1) {
-          // In general, having a tensor here with no buffer will be an error.
-          // However, for the reshape operator, the second input tensor is
-          // sometimes only used for the shape, not for the data. Thus, null
-          // buffer is ok in this situation.
-          // The situation where null buffer is not ok for reshape operator is
-          // only when there are 2 inputs given to the node and the one
-          // corresponding to the shape (i == 1) is a vector that contains all
-          // dimensions. See `GetOutputShape()` function in
-          // `tensorflow/lite/kernels/reshape.cc`
-          continue;
-        } else {
-          // In all other cases, we need to return an error as otherwise we will
-          // trigger a null pointer dereference (likely).
-          ReportError("Input tensor %d lacks data", tensor_index);
-          return kTfLiteError;
-        }
-      }
-    }
+    TF_LITE_ENSURE_STATUS(EnsureNodeInputsReadable(node_index));
 
     if (check_cancelled_func_ != nullptr &&
         check_cancelled_func_(cancellation_data_)) {
@@ -1141,6 +1131,192 @@ TfLiteStatus Subgraph::Invoke() {
   return status;
 }
 
+TfLiteStatus Subgraph::EnsureNodeInputsReadable(int node_index) {
+  const TfLiteNode& node = nodes_and_registration_[node_index].first;
+  const TfLiteRegistration& registration =
+      nodes_and_registration_[node_index].second;
+  // TODO(ycling): This is an extra loop through inputs to check if the data
+  // need to be copied from Delegate buffer to raw memory, which is often not
+  // needed. We may want to cache this in prepare to know if this needs to be
+  // done for a node or not.
+  for (int i = 0; i < node.inputs->size; ++i) {
+    int tensor_index = node.inputs->data[i];
+    if (tensor_index == kTfLiteOptionalTensor) {
+      continue;
+    }
+    TfLiteTensor* tensor = &tensors_[tensor_index];
+    if (tensor->delegate && tensor->delegate != node.delegate &&
+        tensor->data_is_stale) {
+      TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(tensor_index));
+    }
+    if (tensor->data.raw == nullptr && tensor->bytes > 0) {
+      if (registration.builtin_code == kTfLiteBuiltinReshape && i == 1 &&
+          tensor->dims->size != 1) {
+        // In general, having a tensor here with no buffer will be an error.
+        // However, for the reshape operator, the second input tensor is
+        // sometimes only used for the shape, not for the data. Thus, null
+        // buffer is ok in this situation.
+        // The situation where null buffer is not ok for reshape operator is
+        // only when there are 2 inputs given to the node and the one
+        // corresponding to the shape (i == 1) is a vector that contains all
+        // dimensions. See `GetOutputShape()` function in
+        // `tensorflow/lite/kernels/reshape.cc`
+        continue;
+      } else {
+        // In all other cases, we need to return an error as otherwise we will
+        // trigger a null pointer dereference (likely).
+        ReportError("Input tensor %d lacks data", tensor_index);
+        return kTfLiteError;
+      }
+    }
+  }
+  return kTfLiteOk;
+}
+
+bool Subgraph::MustExecuteAlone(int node_index) const {
+  const TfLiteNode& node = nodes_and_registration_[node_index].first;
+  const TfLiteRegistration& registration =
+      nodes_and_registration_[node_index].second;
+  // Delegate kernels may share state, like a thread pool, among their nodes,
+  // and control flow ops invoke other subgraphs.
+  if (node.delegate != nullptr ||
+      registration.builtin_code == kTfLiteBuiltinWhile ||
+      registration.builtin_code == kTfLiteBuiltinIf ||
+      registration.builtin_code == kTfLiteBuiltinCallOnce) {
+    return true;
+  }
+  // Resource and variable tensors are accessed by several nodes without the
+  // dependencies between them being visible in the graph.
+  auto uses_state = [this](const TfLiteIntArray* tensor_indices) {
+    for (int tensor_index : TfLiteIntArrayView(tensor_indices)) {
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      const TfLiteTensor& tensor = tensors_[tensor_index];
+      if (tensor.is_variable || tensor.type == kTfLiteResource ||
+          tensor.type == kTfLiteVariant) {
+        return true;
+      }
+    }
+    return false;
+  };
+  return uses_state(node.inputs) || uses_state(node.outputs);
+}
+
+TfLiteStatus Subgraph::PlanExecutionStages() {
+  execution_stages_.clear();
+  if (inter_op_thread_pool_ == nullptr ||
+      inter_op_thread_pool_->num_threads() <= 1) {
+    return memory_planner_->SetExecutionStages({});
+  }
+
+  // Nodes are leveled so that each one has a higher level than the nodes
+  // producing its inputs, making nodes of the same level independent. Nodes
+  // that must execute alone also get a higher level than the previous such
+  // node, to keep their order.
+  const int num_nodes = execution_plan_.size();
+  std::vector<int> tensor_level(tensors_.size(), 0);
+  std::vector<int> node_level(num_nodes, 0);
+  std::vector<bool> alone(num_nodes, false);
+  int last_alone_level = -1;
+  for (int i = 0; i < num_nodes; ++i) {
+    const TfLiteNode& node = nodes_and_registration_[execution_plan_[i]].first;
+    int level = 0;
+    for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+      if (tensor_index != kTfLiteOptionalTensor) {
+        level = std::max(level, tensor_level[tensor_index]);
+      }
+    }
+    alone[i] = MustExecuteAlone(execution_plan_[i]);
+    if (alone[i]) {
+      level = std::max(level, last_alone_level + 1);
+      last_alone_level = level;
+    }
+    node_level[i] = level;
+    for (int tensor_index : TfLiteIntArrayView(node.outputs)) {
+      if (tensor_index != kTfLiteOptionalTensor) {
+        tensor_level[tensor_index] = level + 1;
+      }
+    }
+  }
+
+  // Order nodes by level, the one node of a level that must execute alone, if
+  // any, going last.
+  std::vector<int> order(num_nodes);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+    return std::make_pair(node_level[a], alone[a]) <
+           std::make_pair(node_level[b], alone[b]);
+  });
+  std::vector<int> stages;
+  bool has_concurrent_nodes = false;
+  for (int i = 0; i < num_nodes; ++i) {
+    if (i == 0 || alone[order[i]] ||
+        node_level[order[i]] != node_level[order[i - 1]]) {
+      stages.push_back(i);
+    } else {
+      has_concurrent_nodes = true;
+    }
+  }
+  if (!has_concurrent_nodes) {
+    return memory_planner_->SetExecutionStages({});
+  }
+
+  std::vector<int> new_plan(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    new_plan[i] = execution_plan_[order[i]];
+  }
+  execution_plan_ = std::move(new_plan);
+  stages.push_back(num_nodes);
+  execution_stages_ = stages;
+  return memory_planner_->SetExecutionStages(std::move(stages));
+}
+
+TfLiteStatus Subgraph::InvokeExecutionStages() {
+  std::vector<TfLiteStatus> statuses;
+  for (int stage = 0; stage + 1 < execution_stages_.size(); ++stage) {
+    const int first_index = execution_stages_[stage];
+    const int num_nodes = execution_stages_[stage + 1] - first_index;
+    for (int i = first_index; i < first_index + num_nodes; ++i) {
+      TF_LITE_ENSURE_STATUS(EnsureNodeInputsReadable(execution_plan_[i]));
+    }
+
+    if (IsCancelled()) {
+      ReportError("Client requested cancel during Invoke()");
+      return kTfLiteError;
+    }
+
+    EnsureTensorsVectorCapacity();
+    statuses.assign(num_nodes, kTfLiteOk);
+    inter_op_thread_pool_->Run(num_nodes, [&](int task, int thread) {
+      auto& node_and_registration =
+          nodes_and_registration_[execution_plan_[first_index + task]];
+      if (thread != 0) {
+        ExternalCpuBackendContext* cpu_backend_context =
+            inter_op_thread_pool_->cpu_backend_context(thread);
+        // Kernels create the internal context with the interpreter's number
+        // of threads; workers run single threaded, next to each other.
+        if (auto* internal = cpu_backend_context->internal_backend_context()) {
+          internal->SetMaxNumThreads(1);
+        }
+        inter_op_cpu_backend_context = cpu_backend_context;
+      }
+      statuses[task] = OpInvoke(node_and_registration.second,
+                                &node_and_registration.first);
+      inter_op_cpu_backend_context = nullptr;
+    });
+
+    for (int task = 0; task < num_nodes; ++task) {
+      if (statuses[task] != kTfLiteOk) {
+        const int node_index = execution_plan_[first_index + task];
+        return ReportOpError(&context_,
+                             nodes_and_registration_[node_index].first,
+                             nodes_and_registration_[node_index].second,
+                             node_index, "failed to invoke");
+      }
+    }
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus Subgraph::ResizeTensor(TfLiteContext* context,
                                     TfLiteTensor* tensor,
                                     TfLiteIntArray* new_size) {
@@ -1545,6 +1721,7 @@ void Subgraph::EnsureTensorsVectorCapacity() {
 TfLiteStatus Subgraph::EnsureMemoryAllocations() {
   if (memory_planner_) {
     state_ = kStateUninvokable;
+    TF_LITE_ENSURE_OK(&context_, PlanExecutionStages());
     TF_LITE_ENSURE_OK(&context_, memory_planner_->PlanAllocations());
   }
   TF_LITE_ENSURE_OK(&context_, AllocateTensors());
@@ -1671,6 +1848,46 @@ TfLiteStatus Subgraph::SetCustomAllocationForTensor(
   return kTfLiteOk;
 }
 
+TfLiteStatus Subgraph::SetOfflinePlannedOffsets(std::vector<int32_t> offsets) {
+  if (memory_planner_) {
+    ReportError(
+        "SetOfflinePlannedOffsets() must be called before AllocateTensors().");
+    return kTfLiteError;
+  }
+  if (offsets.size() != tensors_.size()) {
+    ReportError("Got %d offline planned offsets for %d tensors.",
+                static_cast<int>(offsets.size()),
+                static_cast<int>(tensors_.size()));
+    return kTfLiteError;
+  }
+  offline_planned_offsets_ = std::move(offsets);
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::GetPlannedOffsets(std::vector<int32_t>* offsets) {
+  if (!memory_planner_ || state_ == kStateUninvokable) {
+    ReportError("GetPlannedOffsets() must be called after AllocateTensors().");
+    return kTfLiteError;
+  }
+  return memory_planner_->GetPlannedOffsets(offsets);
+}
+
+TfLiteStatus Subgraph::SetInterOpThreadPool(InterOpThreadPool* thread_pool) {
+  if (state_ == kStateInvokableAndImmutable) {
+    ReportError(
+        "SetInterOpThreadPool is disallowed when graph is immutable.");
+    return kTfLiteError;
+  }
+  inter_op_thread_pool_ = thread_pool;
+  if (memory_planner_) {
+    // The execution stages change the memory plan.
+    state_ = kStateUninvokable;
+    TF_LITE_ENSURE_STATUS(PlanExecutionStages());
+    TF_LITE_ENSURE_STATUS(memory_planner_->PlanAllocations());
+  }
+  return kTfLiteOk;
+}
+
 void Subgraph::SetName(const char* name) {
   if (name) {
     name_ = name;
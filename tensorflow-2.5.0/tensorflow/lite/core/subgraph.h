@@ -31,6 +31,7 @@ limitations under the License.
 #include "tensorflow/lite/core/api/profiler.h"
 #include "tensorflow/lite/core/macros.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
+#include "tensorflow/lite/inter_op_thread_pool.h"
 #include "tensorflow/lite/memory_planner.h"
 #include "tensorflow/lite/util.h"
 
@@ -350,6 +351,39 @@ class Subgraph {
       int tensor_index, const TfLiteCustomAllocation& allocation,
       int64_t flags = kTfLiteCustomAllocationFlagsNone);
 
+  // Sets offsets in the non-persistent arena, indexed by tensor, at which the
+  // memory planner places tensors instead of planning them at runtime; e.g.,
+  // the result of GetPlannedOffsets() for an earlier instance of the same
+  // model. kOnlinePlannedOffset leaves a tensor to the planner. Offsets that
+  // don't fit the tensor sizes are dropped during AllocateTensors().
+  //
+  // NOTE: Must be called before AllocateTensors().
+  //
+  // WARNING: This is an experimental interface that is subject to change.
+  TfLiteStatus SetOfflinePlannedOffsets(std::vector<int32_t> offsets);
+
+  // Returns the offsets, indexed by tensor, that the memory planner has placed
+  // tensors on the non-persistent arena at, with kOnlinePlannedOffset for
+  // tensors that are not on it. Must be called after AllocateTensors().
+  //
+  // WARNING: This is an experimental interface that is subject to change.
+  TfLiteStatus GetPlannedOffsets(std::vector<int32_t>* offsets);
+
+  // Sets the thread pool on which independent nodes are executed concurrently,
+  // or nullptr to execute nodes one at a time. The pool isn't owned and must
+  // outlive the subgraph.
+  //
+  // Nodes are reordered so that independent ones are adjacent in the execution
+  // plan, which may increase the arena size. Delegate kernels, control flow ops
+  // and nodes using resource or variable tensors always execute alone, in their
+  // original order. Concurrent execution is skipped while a profiler is set or
+  // the subgraph has dynamic tensors.
+  //
+  // NOTE: If tensors were allocated, AllocateTensors() must be called again.
+  //
+  // WARNING: This is an experimental interface that is subject to change.
+  TfLiteStatus SetInterOpThreadPool(InterOpThreadPool* thread_pool);
+
   void SetName(const char* name);
   const std::string& GetName() const;
 
@@ -609,6 +643,24 @@ class Subgraph {
   // Ensures the memory required is planned and allocated.
   TfLiteStatus EnsureMemoryAllocations();
 
+  // Makes sure the inputs of the given node can be read by its kernel, copying
+  // them from delegate buffers if needed.
+  TfLiteStatus EnsureNodeInputsReadable(int node_index);
+
+  // Returns true if the given node must not execute concurrently with other
+  // nodes, nor be reordered with respect to other such nodes.
+  bool MustExecuteAlone(int node_index) const;
+
+  // Splits the execution plan into stages of independent nodes that are
+  // executed concurrently on `inter_op_thread_pool_`, reordering it so that
+  // each stage is contiguous, and tells the memory planner about them. Must be
+  // followed by planning allocations.
+  TfLiteStatus PlanExecutionStages();
+
+  // Invokes the nodes in `execution_stages_`, running the nodes of each stage
+  // concurrently.
+  TfLiteStatus InvokeExecutionStages();
+
   // Returns true if cancellation function returns true.
   bool IsCancelled();
 
@@ -715,6 +767,18 @@ class Subgraph {
 
   std::unique_ptr<MemoryPlanner> memory_planner_;
 
+  // Offsets given to SetOfflinePlannedOffsets(), handed over to the memory
+  // planner once it is created.
+  std::vector<int32_t> offline_planned_offsets_;
+
+  // Thread pool executing independent nodes concurrently, if any. Not owned.
+  InterOpThreadPool* inter_op_thread_pool_ = nullptr;
+
+  // Indices in `execution_plan_` at which each stage of concurrently executed
+  // nodes starts, followed by the size of the execution plan. Empty if nodes
+  // are executed one at a time.
+  std::vector<int> execution_stages_;
+
   // Contains <tensor idx, custom allocation> pairs for all applicable tensors.
   std::vector<std::pair<int, TfLiteCustomAllocation>> custom_allocations_;
 
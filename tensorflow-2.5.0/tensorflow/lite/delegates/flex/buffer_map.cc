@@ -61,16 +61,19 @@ class BaseTfLiteTensorBuffer : public tensorflow::TensorBuffer {
 };
 
 // A tensor buffer for most data types. Numeric types have exactly the same
-// representation in TFLITE and TF, so we just need use memcpy().
+// representation in TFLITE and TF, so we either use the TF Lite buffer as is
+// or, if that is not allowed or not suitably aligned, memcpy() it.
 class TfLiteTensorBuffer : public BaseTfLiteTensorBuffer {
  public:
-  explicit TfLiteTensorBuffer(const TfLiteTensor* tensor)
-      : BaseTfLiteTensorBuffer(tensorflow::cpu_allocator()->AllocateRaw(
-            EIGEN_MAX_ALIGN_BYTES, tensor->bytes)) {
-    // TODO(ahentz): if we can guarantee that TF Lite allocated tensors with
-    // the same alignment as TensorFlow (EIGEN_MAX_ALIGN_BYTES), then we can
-    // potentially eliminate the copy below.
+  TfLiteTensorBuffer(const TfLiteTensor* tensor, bool allow_reusing)
+      : BaseTfLiteTensorBuffer(
+            CanReuse(tensor, allow_reusing)
+                ? tensor->data.raw
+                : tensorflow::cpu_allocator()->AllocateRaw(
+                      EIGEN_MAX_ALIGN_BYTES, tensor->bytes)),
+        reused_buffer_from_tflite_(CanReuse(tensor, allow_reusing)) {
     len_ = tensor->bytes;
+    if (reused_buffer_from_tflite_) return;
 
     LogAllocation();
 
@@ -80,6 +83,7 @@ class TfLiteTensorBuffer : public BaseTfLiteTensorBuffer {
   }
 
   ~TfLiteTensorBuffer() override {
+    if (reused_buffer_from_tflite_) return;
     LogDeallocation();
     tensorflow::cpu_allocator()->DeallocateRaw(data());
   }
@@ -87,7 +91,16 @@ class TfLiteTensorBuffer : public BaseTfLiteTensorBuffer {
   size_t size() const override { return len_; }
 
  private:
+  // TensorFlow expects tensor data aligned to EIGEN_MAX_ALIGN_BYTES.
+  static bool CanReuse(const TfLiteTensor* tensor, bool allow_reusing) {
+    return allow_reusing && tensor->data.raw != nullptr &&
+           reinterpret_cast<uintptr_t>(tensor->data.raw) %
+                   EIGEN_MAX_ALIGN_BYTES ==
+               0;
+  }
+
   size_t len_;
+  const bool reused_buffer_from_tflite_;
 };
 
 // A string buffer. TFLITE string tensor format is different than
@@ -155,7 +168,8 @@ const tensorflow::Tensor* BufferMap::GetTensorPtr(int tensor_index) const {
   return &tensor;
 }
 
-void BufferMap::SetFromTfLite(int tensor_index, const TfLiteTensor* tensor) {
+void BufferMap::SetFromTfLite(int tensor_index, const TfLiteTensor* tensor,
+                              bool allow_reusing) {
   // TODO(b/179094265): This is an experimental implementation, subject to
   // change. This can be re-implemented with life cycle management mechanism
   // like reference counting.
@@ -189,7 +203,7 @@ void BufferMap::SetFromTfLite(int tensor_index, const TfLiteTensor* tensor) {
   if (tensor->type == kTfLiteString) {
     buf = new StringTfLiteTensorBuffer(tensor);
   } else {
-    buf = new TfLiteTensorBuffer(tensor);
+    buf = new TfLiteTensorBuffer(tensor, allow_reusing);
   }
   tensorflow::Tensor t = tensorflow::TensorCApi::MakeTensor(
       GetTensorFlowDataType(tensor->type), shape, buf);
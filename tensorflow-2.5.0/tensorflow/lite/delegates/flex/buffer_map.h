@@ -58,8 +58,12 @@ class BufferMap {
   void SetFromTensorFlow(int tensor_index, tensorflow::Tensor tensor);
 
   // Same as above but creates a new tensorflow::Tensor with a copy of the
-  // given TfLiteTensor's data.
-  void SetFromTfLite(int tensor_index, const TfLiteTensor* tensor);
+  // given TfLiteTensor's data. If 'allow_reusing' is true, non-string data
+  // that is suitably aligned is not copied; the tensorflow::Tensor then points
+  // into the TfLiteTensor's buffer, which must remain valid and unmodified for
+  // as long as TensorFlow may read it.
+  void SetFromTfLite(int tensor_index, const TfLiteTensor* tensor,
+                     bool allow_reusing = false);
 
  private:
   // Mapping from TL Lite tensor ID to TensorFlow's Tensor. All tensors that
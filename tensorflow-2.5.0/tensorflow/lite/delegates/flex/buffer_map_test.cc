@@ -132,6 +132,37 @@ TEST(BufferMapTest, SetFromTfLiteString) {
   ASSERT_THAT(GetTensorShape(out_tensor), ElementsAre(1, 2, 1, 3));
 }
 
+TEST(BufferMapTest, SetFromTfLiteReusingBuffer) {
+  alignas(EIGEN_MAX_ALIGN_BYTES) float data[8] = {0, 0, 0, 0.123f,
+                                                  0, 0, 0, 0};
+  TfLiteTensor t = {};
+  t.type = kTfLiteFloat32;
+  t.allocation_type = kTfLiteCustom;
+  t.dims = ConvertVectorToTfLiteIntArray({1, 2, 1, 3});
+  t.bytes = 6 * sizeof(float);
+
+  // An aligned buffer is used as is.
+  BufferMap buffer_map;
+  t.data.raw = reinterpret_cast<char*>(data);
+  buffer_map.SetFromTfLite(0, &t, /*allow_reusing=*/true);
+  EXPECT_EQ(buffer_map.GetTensor(0).tensor_data().data(), t.data.raw);
+  EXPECT_THAT(GetTensorData<float>(buffer_map.GetTensor(0)),
+              ElementsAre(0, 0, 0, 0.123f, 0, 0));
+
+  // Unless reusing is not allowed.
+  buffer_map.SetFromTfLite(0, &t);
+  EXPECT_NE(buffer_map.GetTensor(0).tensor_data().data(), t.data.raw);
+
+  // A misaligned buffer is copied.
+  t.data.raw = reinterpret_cast<char*>(data + 1);
+  buffer_map.SetFromTfLite(0, &t, /*allow_reusing=*/true);
+  EXPECT_NE(buffer_map.GetTensor(0).tensor_data().data(), t.data.raw);
+  EXPECT_THAT(GetTensorData<float>(buffer_map.GetTensor(0)),
+              ElementsAre(0, 0, 0.123f, 0, 0, 0));
+
+  TfLiteIntArrayFree(t.dims);
+}
+
 TEST(BufferMapTest, SetFromTfLiteTwice) {
   UniqueTfLiteTensor t1 =
       MakeLiteTensor<float>({1, 2, 1, 3}, {0, 0, 0, 0.123f, 0, 0});
@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/eager/tensor_handle.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/lite/builtin_ops.h"
 #include "tensorflow/lite/c/common.h"
@@ -370,6 +371,12 @@ struct OpData {
   std::vector<std::unique_ptr<OpNode>> nodes;
   std::vector<int> subgraph_inputs;
   std::vector<int> subgraph_outputs;
+  // Whether TF Lite input buffers may be handed to TensorFlow without a copy.
+  // This is only done if none of the ops is stateful and none of them reads
+  // or writes a resource or variant, since those could hold on to their
+  // inputs beyond a single invocation (e.g. TensorListPushBack keeps its
+  // input inside the output list).
+  bool reuse_tflite_buffers = false;
 };
 
 DelegateKernel::DelegateKernel() : op_data_(new OpData) {}
@@ -451,13 +458,36 @@ TfLiteStatus DelegateKernel::Prepare(TfLiteContext* context, TfLiteNode* node) {
   // graph, so we can make them "forwardable" if there is only one reference.
   std::map<int, int> tensor_ref_count;
 
+  op_data_->reuse_tflite_buffers = true;
+  auto holds_references = [context](int tensor_index) {
+    const TfLiteType type = context->tensors[tensor_index].type;
+    return type == kTfLiteResource || type == kTfLiteVariant;
+  };
+  for (const auto& node_data : op_data_->nodes) {
+    if (node_data->op_reg_data() &&
+        node_data->op_reg_data()->op_def.is_stateful()) {
+      op_data_->reuse_tflite_buffers = false;
+    }
+    for (int i = 0; i < node_data->inputs().Size(); ++i) {
+      if (holds_references(node_data->inputs().TfLiteIndex(i))) {
+        op_data_->reuse_tflite_buffers = false;
+      }
+    }
+    for (int i = 0; i < node_data->outputs().Size(); ++i) {
+      if (holds_references(node_data->outputs().TfLiteIndex(i))) {
+        op_data_->reuse_tflite_buffers = false;
+      }
+    }
+  }
+
   // Whenever we find a constant tensor, insert it in the buffer map.
   BufferMap* buffer_map = op_data_->buffer_map;
   for (auto tensor_index : op_data_->subgraph_inputs) {
     TfLiteTensor* tensor = &context->tensors[tensor_index];
     if (IsConstantTensor(tensor)) {
       if (!tensor->data_is_stale || !buffer_map->HasTensor(tensor_index)) {
-        buffer_map->SetFromTfLite(tensor_index, tensor);
+        buffer_map->SetFromTfLite(tensor_index, tensor,
+                                  op_data_->reuse_tflite_buffers);
       }
     }
 
@@ -596,6 +626,7 @@ TfLiteStatus DelegateKernel::Eval(TfLiteContext* context, TfLiteNode* node) {
 
   // Insert a tensor in the buffer map for all inputs that are not constant.
   // Constants were handled in Prepare() already.
+  std::vector<int> reused_inputs;
   for (auto tensor_index : op_data_->subgraph_inputs) {
     TfLiteTensor* tensor = &context->tensors[tensor_index];
     if (!IsConstantTensor(tensor)) {
@@ -603,7 +634,11 @@ TfLiteStatus DelegateKernel::Eval(TfLiteContext* context, TfLiteNode* node) {
       // to the BufferMap again, because TF already knows about it and its
       // contents are kept automatically up-to-date.
       if (!tensor->data_is_stale || !buffer_map->HasTensor(tensor_index)) {
-        buffer_map->SetFromTfLite(tensor_index, tensor);
+        buffer_map->SetFromTfLite(tensor_index, tensor,
+                                  op_data_->reuse_tflite_buffers);
+        if (op_data_->reuse_tflite_buffers) {
+          reused_inputs.push_back(tensor_index);
+        }
       }
     }
   }
@@ -618,6 +653,24 @@ TfLiteStatus DelegateKernel::Eval(TfLiteContext* context, TfLiteNode* node) {
     TF_LITE_ENSURE_OK(context, ConvertStatus(context, status));
   }
 
+  // An output may alias a reused TF Lite input buffer, e.g. if it was produced
+  // by Identity or Reshape. TF Lite is free to reuse that memory once this
+  // node is done, so such outputs get their own copy.
+  if (!reused_inputs.empty()) {
+    for (auto tensor_index : op_data_->subgraph_outputs) {
+      if (!buffer_map->HasTensor(tensor_index)) continue;
+      const tensorflow::Tensor tf_tensor = buffer_map->GetTensor(tensor_index);
+      for (auto input_index : reused_inputs) {
+        if (input_index != tensor_index &&
+            tf_tensor.SharesBufferWith(buffer_map->GetTensor(input_index))) {
+          buffer_map->SetFromTensorFlow(
+              tensor_index, tensorflow::tensor::DeepCopy(tf_tensor));
+          break;
+        }
+      }
+    }
+  }
+
   for (auto tensor_index : op_data_->subgraph_outputs) {
     if (!buffer_map->HasTensor(tensor_index)) {
       context->ReportError(context, "Cannot write to invalid tensor index %d",
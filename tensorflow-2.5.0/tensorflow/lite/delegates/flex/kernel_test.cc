@@ -228,6 +228,53 @@ TEST_F(KernelTest, SplitGraph) {
   ASSERT_THAT(GetValues(17), ElementsAre(18.0f));
 }
 
+// A TensorList built by one flex subgraph holds on to its elements until a
+// later subgraph stacks them. The element pushed here is an intermediate TF
+// Lite tensor, whose arena memory is reused by the TF Lite ops in between,
+// so it must not be handed to TensorFlow without a copy.
+TEST_F(KernelTest, TensorListAcrossSubgraphs) {
+  AddTensors(10, {0, 1}, {8, 9}, kTfLiteFloat32, {2});
+  TfLiteQuantizationParams quant;
+  for (int i : {4, 5}) {
+    CHECK_EQ(interpreter_->SetTensorParametersReadWrite(
+                 i, kTfLiteVariant, /*name=*/"", /*dims=*/{}, quant),
+             kTfLiteOk);
+  }
+  const int32_t element_shape[] = {2};
+  SetConstTensor(2, {1}, kTfLiteInt32,
+                 reinterpret_cast<const char*>(element_shape),
+                 sizeof(element_shape));
+  const int32_t max_num_elements[] = {-1};
+  SetConstTensor(3, {}, kTfLiteInt32,
+                 reinterpret_cast<const char*>(max_num_elements),
+                 sizeof(max_num_elements));
+
+  AddTfLiteMulOp({0, 1}, {6});  // => 2 * in
+  AddTfOp(testing::kEmptyTensorList, {2, 3}, {4});
+  AddTfOp(testing::kTensorListPushBack, {4, 6}, {5});
+  AddTfLiteMulOp({0, 0}, {7});  // => in * in
+  AddTfLiteMulOp({7, 1}, {8});  // => 2 * in * in
+  AddTfOp(testing::kTensorListStack, {5, 2}, {9});
+
+  ApplyFlexDelegate();
+
+  SetShape(0, {2});
+  SetValues(0, {3.0f, 4.0f});
+  SetShape(1, {2});
+  SetValues(1, {2.0f, 2.0f});
+
+  ASSERT_TRUE(Invoke());
+  ASSERT_THAT(GetValues(8), ElementsAre(18.0f, 32.0f));
+  ASSERT_THAT(GetShape(9), ElementsAre(1, 2));
+  ASSERT_THAT(GetValues(9), ElementsAre(6.0f, 8.0f));
+
+  SetValues(0, {5.0f, 6.0f});
+
+  ASSERT_TRUE(Invoke());
+  ASSERT_THAT(GetValues(8), ElementsAre(50.0f, 72.0f));
+  ASSERT_THAT(GetValues(9), ElementsAre(10.0f, 12.0f));
+}
+
 class MultipleSubgraphsTest : public KernelTest {
  public:
   static constexpr int kInput = 0;
@@ -139,6 +139,23 @@ void FlexModelTest::AddTfOp(TfOpType op, const std::vector<int>& inputs,
     return " attr{ key: '" + key + "' value {" + value + "}}";
   };
 
+  if (op == kEmptyTensorList || op == kTensorListPushBack ||
+      op == kTensorListStack) {
+    string attributes = attr("element_dtype", "type: DT_FLOAT");
+    if (op == kEmptyTensorList) {
+      attributes += attr("shape_type", "type: DT_INT32");
+      AddTfOp("FlexEmptyTensorList", "EmptyTensorList", attributes, inputs,
+              outputs);
+    } else if (op == kTensorListPushBack) {
+      AddTfOp("FlexTensorListPushBack", "TensorListPushBack", attributes,
+              inputs, outputs);
+    } else {
+      AddTfOp("FlexTensorListStack", "TensorListStack", attributes, inputs,
+              outputs);
+    }
+    return;
+  }
+
   string type_attribute;
   switch (interpreter_->tensor(inputs[0])->type) {
     case kTfLiteInt32:
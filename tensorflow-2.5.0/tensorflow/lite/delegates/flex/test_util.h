@@ -30,6 +30,10 @@ enum TfOpType {
   kMul,
   kRfft,
   kImag,
+  // TensorList ops on float elements with int32 shapes.
+  kEmptyTensorList,
+  kTensorListPushBack,
+  kTensorListStack,
   // Represents an op that does not exist in TensorFlow.
   kNonExistent,
   // Represents an valid TensorFlow op where the NodeDef is incompatible.
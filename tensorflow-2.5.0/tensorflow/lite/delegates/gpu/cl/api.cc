@@ -23,6 +23,7 @@ limitations under the License.
 #include <cstring>
 
 #include "absl/memory/memory.h"
+#include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "tensorflow/lite/delegates/gpu/cl/cl_command_queue.h"
 #include "tensorflow/lite/delegates/gpu/cl/cl_errors.h"
@@ -895,6 +896,12 @@ class InferenceEnvironmentImpl : public InferenceEnvironment {
         CreateProfilingCommandQueue(device, context, &profiling_queue));
     environment_ = Environment(std::move(device), std::move(context),
                                std::move(queue), std::move(profiling_queue));
+    if (!options_.tuning_database.empty()) {
+      RETURN_IF_ERROR(environment_.tuning_database()->AddSerialized(
+          absl::string_view(
+              reinterpret_cast<const char*>(options_.tuning_database.data()),
+              options_.tuning_database.size())));
+    }
     return environment_.Init();
   }
 
@@ -985,6 +992,25 @@ class InferenceEnvironmentImpl : public InferenceEnvironment {
     return data;
   }
 
+  absl::Status AddSerializedBinaryCache(
+      absl::Span<const uint8_t> serialized_binary_cache) final {
+    if (!environment_.program_cache()) {
+      return absl::UnavailableError("Program cache is not available.");
+    }
+    return environment_.program_cache()->AddSerializedCache(
+        environment_.context(), environment_.device(),
+        serialized_binary_cache);
+  }
+
+  std::string GetDeviceDescription() const final {
+    return environment_.device().GetDeviceDescription();
+  }
+
+  std::vector<uint8_t> GetTuningDatabase() const final {
+    const std::string data = environment_.tuning_database()->Serialize();
+    return std::vector<uint8_t>(data.begin(), data.end());
+  }
+
   const InferenceEnvironmentProperties& properties() const {
     return properties_;
   }
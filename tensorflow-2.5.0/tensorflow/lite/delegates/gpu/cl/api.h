@@ -104,6 +104,25 @@ class InferenceEnvironment {
   // Returned data is valid only if used on the same device, otherwise it will
   // not be compatible and will be discarded.
   virtual std::vector<uint8_t> GetSerializedBinaryCache() const = 0;
+
+  // Adds compiled OpenCL kernels previously returned from
+  // GetSerializedBinaryCache to the cache of this environment, in addition to
+  // InferenceEnvironmentOptions::serialized_binary_cache. Returns an error and
+  // leaves the cache unchanged if data is invalid or was compiled for another
+  // device or driver.
+  virtual absl::Status AddSerializedBinaryCache(
+      absl::Span<const uint8_t> serialized_binary_cache) = 0;
+
+  // Returns a description of the OpenCL device, driver and platform used by
+  // this environment. Serialized models and binary caches are only compatible
+  // with environments that have the same description.
+  virtual std::string GetDeviceDescription() const = 0;
+
+  // Returns work group sizes selected by exhaustive tuning in this environment
+  // together with the ones passed in InferenceEnvironmentOptions. Data is
+  // portable text, see TuningDatabase, and can be concatenated with databases
+  // collected on other devices before it is bundled with an application.
+  virtual std::vector<uint8_t> GetTuningDatabase() const = 0;
 };
 
 struct InferenceEnvironmentOptions {
@@ -128,6 +147,12 @@ struct InferenceEnvironmentOptions {
   // incompatible when GPU driver is updated.
   absl::Span<const uint8_t> serialized_binary_cache;
 
+  // Should contain data returned from InferenceEnvironment::GetTuningDatabase
+  // method, possibly collected on many devices. Work group sizes tuned for
+  // this device and driver are used instead of tuning kernels again.
+  // Malformed data fails creation of the environment.
+  absl::Span<const uint8_t> tuning_database;
+
   bool IsGlAware() const {
     return egl_context != EGL_NO_CONTEXT && egl_display != EGL_NO_DISPLAY;
   }
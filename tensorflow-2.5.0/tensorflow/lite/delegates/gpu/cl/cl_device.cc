@@ -292,6 +292,13 @@ std::string CLDevice::GetPlatformVersion() const {
   return GetPlatformInfo(platform_id_, CL_PLATFORM_VERSION);
 }
 
+std::string CLDevice::GetDeviceDescription() const {
+  return absl::StrCat(GetDeviceInfo<std::string>(id_, CL_DEVICE_VENDOR), "/",
+                      GetDeviceInfo<std::string>(id_, CL_DEVICE_NAME), "/",
+                      GetDeviceInfo<std::string>(id_, CL_DRIVER_VERSION), "/",
+                      GetPlatformVersion());
+}
+
 void CLDevice::DisableOneLayerTextureArray() {
   info_.adreno_info.support_one_layer_texture_array = false;
 }
@@ -46,6 +46,10 @@ class CLDevice {
   cl_platform_id platform() const { return platform_id_; }
   std::string GetPlatformVersion() const;
 
+  // Describes the device vendor and name with the driver and platform
+  // versions. Compiled programs are only valid for the same description.
+  std::string GetDeviceDescription() const;
+
   // To track bug on some Adreno. b/131099086
   void DisableOneLayerTextureArray();
 
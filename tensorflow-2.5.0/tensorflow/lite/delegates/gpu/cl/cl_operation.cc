@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/lite/delegates/gpu/cl/cl_operation.h"
 
+#include "tensorflow/lite/delegates/gpu/cl/cl_program.h"
+#include <farmhash.h>
+
 namespace tflite {
 namespace gpu {
 namespace cl {
@@ -249,6 +252,31 @@ absl::Status ClOperation::Tune(TuningType tuning_type, const GpuInfo& gpu_info,
   }
 }
 
+absl::Status ClOperation::SetWorkGroupSize(const GpuInfo& gpu_info,
+                                           const int3& work_group_size) {
+  if (work_group_size.x <= 0 || work_group_size.y <= 0 ||
+      work_group_size.z <= 0 ||
+      work_group_size.x > gpu_info.GetMaxWorkGroupSizeForX() ||
+      work_group_size.y > gpu_info.GetMaxWorkGroupSizeForY() ||
+      work_group_size.z > gpu_info.GetMaxWorkGroupSizeForZ() ||
+      work_group_size.x * work_group_size.y * work_group_size.z >
+          kernel_.info_.max_work_group_size) {
+    return absl::InvalidArgumentError(
+        "Work group size exceeds kernel or device limits.");
+  }
+  operation_->work_group_size_ = work_group_size;
+  operation_->work_groups_count_ = GetWorkGroupsCount(
+      operation_->grid_dimension_, operation_->grid_size_,
+      operation_->work_group_size_, operation_->work_group_launch_order_);
+  return absl::OkStatus();
+}
+
+uint64_t ClOperation::GetKernelFingerprint(const GpuInfo& gpu_info) const {
+  return ::util::Fingerprint64(operation_->code_) +
+         ::util::Fingerprint64(
+             CompilerOptionsToString(gpu_info, operation_->compiler_options_));
+}
+
 }  // namespace cl
 }  // namespace gpu
 }  // namespace tflite
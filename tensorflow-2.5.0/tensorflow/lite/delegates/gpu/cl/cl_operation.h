@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_DELEGATES_GPU_CL_CL_OPERATION_H_
 #define TENSORFLOW_LITE_DELEGATES_GPU_CL_CL_OPERATION_H_
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -74,6 +75,18 @@ class ClOperation {
   absl::Status Tune(TuningType tuning_type, const GpuInfo& gpu_info,
                     ProfilingCommandQueue* profiling_queue);
 
+  // Uses work_group_size found by previous tuning if the kernel can be
+  // launched with it on this device.
+  absl::Status SetWorkGroupSize(const GpuInfo& gpu_info,
+                                const int3& work_group_size);
+
+  // Fingerprint of kernel source and compiler options, the same that is used
+  // by ProgramCache. Valid only before ReleaseCPURepresentation.
+  uint64_t GetKernelFingerprint(const GpuInfo& gpu_info) const;
+
+  const int3& GetGridSize() const { return operation_->grid_size_; }
+  const int3& GetWorkGroupSize() const { return operation_->work_group_size_; }
+
   absl::Status Compile(const CreationContext& creation_context);
 
   absl::Status CompileDeserialized(const CreationContext& creation_context);
@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/lite/delegates/gpu/cl/cl_context.h"
 #include "tensorflow/lite/delegates/gpu/cl/cl_device.h"
 #include "tensorflow/lite/delegates/gpu/cl/program_cache.h"
+#include "tensorflow/lite/delegates/gpu/cl/tuning_database.h"
 #include "tensorflow/lite/delegates/gpu/common/data_type.h"
 #include "tensorflow/lite/delegates/gpu/common/gpu_info.h"
 #include "tensorflow/lite/delegates/gpu/common/precision.h"
@@ -51,6 +52,8 @@ class Environment {
   ProfilingCommandQueue* profiling_queue() { return &profiling_queue_; }
   ProgramCache* program_cache() { return &program_cache_; }
   const ProgramCache* program_cache() const { return &program_cache_; }
+  TuningDatabase* tuning_database() { return &tuning_database_; }
+  const TuningDatabase* tuning_database() const { return &tuning_database_; }
 
   std::vector<CalculationsPrecision> GetSupportedPrecisions() const;
   bool IsSupported(CalculationsPrecision precision) const;
@@ -73,6 +76,7 @@ class Environment {
   CLCommandQueue queue_;
   ProfilingCommandQueue profiling_queue_;
   ProgramCache program_cache_;
+  TuningDatabase tuning_database_;
 };
 
 TensorStorageType GetFastestStorageType(const GpuInfo& gpu_info);
@@ -44,6 +44,7 @@ limitations under the License.
 #include "tensorflow/lite/delegates/gpu/common/transformations/merge_padding_with.h"
 #include "tensorflow/lite/delegates/gpu/common/types.h"
 #include "tensorflow/lite/delegates/gpu/common/util.h"
+#include <farmhash.h>
 
 namespace tflite {
 namespace gpu {
@@ -179,8 +180,11 @@ absl::Status InferenceContext::InitFromGraph(
       tuning_type = TuningType::kFast;
     }
   }
-  RETURN_IF_ERROR(
-      Tune(tuning_type, env->device().GetInfo(), env->profiling_queue()));
+  const uint64_t device_fingerprint =
+      ::util::Fingerprint64(env->device().GetDeviceDescription());
+  RETURN_IF_ERROR(Tune(tuning_type, env->device().GetInfo(),
+                       env->profiling_queue(), device_fingerprint,
+                       env->tuning_database()));
 
   if (serialized_model) {
     for (auto& node : nodes_) {
@@ -636,10 +640,27 @@ absl::Status InferenceContext::Compile(
 
 absl::Status InferenceContext::Tune(TuningType tuning_type,
                                     const GpuInfo& gpu_info,
-                                    ProfilingCommandQueue* profiling_queue) {
+                                    ProfilingCommandQueue* profiling_queue,
+                                    uint64_t device_fingerprint,
+                                    TuningDatabase* tuning_database) {
   for (auto& node : nodes_) {
-    RETURN_IF_ERROR(
-        node.cl_operation.Tune(tuning_type, gpu_info, profiling_queue));
+    ClOperation& operation = node.cl_operation;
+    const uint64_t kernel_fingerprint =
+        operation.GetKernelFingerprint(gpu_info);
+    int3 work_group_size;
+    if (tuning_database->Find(device_fingerprint, kernel_fingerprint,
+                              operation.GetGridSize(), &work_group_size) &&
+        operation.SetWorkGroupSize(gpu_info, work_group_size).ok()) {
+      continue;
+    }
+    RETURN_IF_ERROR(operation.Tune(tuning_type, gpu_info, profiling_queue));
+    // Only exhaustive tuning measures work groups, so only its results are
+    // worth reusing.
+    if (tuning_type == TuningType::kExhaustive) {
+      tuning_database->Add(device_fingerprint, kernel_fingerprint,
+                           operation.GetGridSize(),
+                           operation.GetWorkGroupSize());
+    }
   }
   return absl::OkStatus();
 }
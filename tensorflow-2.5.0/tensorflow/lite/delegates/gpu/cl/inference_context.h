@@ -31,6 +31,7 @@ limitations under the License.
 #include "tensorflow/lite/delegates/gpu/cl/opencl_wrapper.h"
 #include "tensorflow/lite/delegates/gpu/cl/serialization_generated.h"
 #include "tensorflow/lite/delegates/gpu/cl/tensor.h"
+#include "tensorflow/lite/delegates/gpu/cl/tuning_database.h"
 #include "tensorflow/lite/delegates/gpu/common/model.h"
 #include "tensorflow/lite/delegates/gpu/common/model_hints.h"
 #include "tensorflow/lite/delegates/gpu/common/precision.h"
@@ -136,8 +137,12 @@ class InferenceContext {
 
   void BindMemoryToOperations();
   absl::Status Compile(const CreationContext& creation_context);
+  // Work group sizes found in tuning_database are used as is, work group sizes
+  // found by exhaustive tuning are added to it.
   absl::Status Tune(TuningType tuning_type, const GpuInfo& gpu_info,
-                    ProfilingCommandQueue* profiling_queue);
+                    ProfilingCommandQueue* profiling_queue,
+                    uint64_t device_fingerprint,
+                    TuningDatabase* tuning_database);
   absl::Status UpdateParams();
 
   void ReleaseCPURepresentation();
@@ -0,0 +1,141 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/delegates/gpu/cl/tuning_database.h"
+
+#include <algorithm>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
+
+namespace tflite {
+namespace gpu {
+namespace cl {
+namespace {
+
+bool ParseFingerprint(absl::string_view text, uint64_t* fingerprint) {
+  if (text.empty() || text.size() > 16) return false;
+  uint64_t result = 0;
+  for (char c : text) {
+    int digit;
+    if (c >= '0' && c <= '9') {
+      digit = c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+      digit = c - 'a' + 10;
+    } else if (c >= 'A' && c <= 'F') {
+      digit = c - 'A' + 10;
+    } else {
+      return false;
+    }
+    result = (result << 4) | digit;
+  }
+  *fingerprint = result;
+  return true;
+}
+
+bool ParseSize(absl::string_view text, int3* size) {
+  std::vector<absl::string_view> parts = absl::StrSplit(text, 'x');
+  return parts.size() == 3 && absl::SimpleAtoi(parts[0], &size->x) &&
+         absl::SimpleAtoi(parts[1], &size->y) &&
+         absl::SimpleAtoi(parts[2], &size->z) && size->x >= 0 &&
+         size->y >= 0 && size->z >= 0;
+}
+
+}  // namespace
+
+bool TuningDatabase::Find(uint64_t device_fingerprint,
+                          uint64_t kernel_fingerprint, const int3& grid_size,
+                          int3* work_group_size) const {
+  auto it =
+      entries_.find(Key{device_fingerprint, kernel_fingerprint, grid_size});
+  if (it == entries_.end()) {
+    return false;
+  }
+  *work_group_size = it->second;
+  return true;
+}
+
+void TuningDatabase::Add(uint64_t device_fingerprint,
+                         uint64_t kernel_fingerprint, const int3& grid_size,
+                         const int3& work_group_size) {
+  entries_[Key{device_fingerprint, kernel_fingerprint, grid_size}] =
+      work_group_size;
+}
+
+absl::Status TuningDatabase::AddSerialized(absl::string_view data) {
+  std::vector<std::pair<Key, int3>> entries;
+  int line_number = 0;
+  for (absl::string_view line : absl::StrSplit(data, '\n')) {
+    ++line_number;
+    line = absl::StripAsciiWhitespace(line);
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::vector<absl::string_view> fields =
+        absl::StrSplit(line, ' ', absl::SkipEmpty());
+    Key key;
+    int3 work_group_size;
+    if (fields.size() != 4 ||
+        !ParseFingerprint(fields[0], &key.device_fingerprint) ||
+        !ParseFingerprint(fields[1], &key.kernel_fingerprint) ||
+        !ParseSize(fields[2], &key.grid_size) ||
+        !ParseSize(fields[3], &work_group_size) || work_group_size.x == 0 ||
+        work_group_size.y == 0 || work_group_size.z == 0) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Malformed tuning database entry at line ", line_number,
+                       ": ", line));
+    }
+    entries.emplace_back(key, work_group_size);
+  }
+  for (const auto& entry : entries) {
+    entries_[entry.first] = entry.second;
+  }
+  return absl::OkStatus();
+}
+
+std::string TuningDatabase::Serialize() const {
+  std::vector<std::pair<Key, int3>> entries(entries_.begin(), entries_.end());
+  // Sorted, so that databases generated from the same runs are identical.
+  std::sort(entries.begin(), entries.end(),
+            [](const std::pair<Key, int3>& a, const std::pair<Key, int3>& b) {
+              const Key& ka = a.first;
+              const Key& kb = b.first;
+              return std::tie(ka.device_fingerprint, ka.kernel_fingerprint,
+                              ka.grid_size.x, ka.grid_size.y, ka.grid_size.z) <
+                     std::tie(kb.device_fingerprint, kb.kernel_fingerprint,
+                              kb.grid_size.x, kb.grid_size.y, kb.grid_size.z);
+            });
+  std::string result;
+  for (const auto& entry : entries) {
+    const Key& key = entry.first;
+    const int3& work_group_size = entry.second;
+    absl::StrAppendFormat(&result, "%016x %016x %dx%dx%d %dx%dx%d\n",
+                          key.device_fingerprint, key.kernel_fingerprint,
+                          key.grid_size.x, key.grid_size.y, key.grid_size.z,
+                          work_group_size.x, work_group_size.y,
+                          work_group_size.z);
+  }
+  return result;
+}
+
+}  // namespace cl
+}  // namespace gpu
+}  // namespace tflite
@@ -0,0 +1,95 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_DELEGATES_GPU_CL_TUNING_DATABASE_H_
+#define TENSORFLOW_LITE_DELEGATES_GPU_CL_TUNING_DATABASE_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/lite/delegates/gpu/common/status.h"
+#include "tensorflow/lite/delegates/gpu/common/types.h"
+
+namespace tflite {
+namespace gpu {
+namespace cl {
+
+// Work group sizes found by exhaustive tuning, keyed by device and kernel
+// launch. A database is populated on device farms with TuningType::kExhaustive
+// and bundled with an application, so InferenceContext can reuse the tuned
+// sizes at init without paying for the tuning.
+//
+// The serialized form is plain text that is independent of the host and can
+// be merged by concatenation. Every line holds one entry:
+//   <device fingerprint> <kernel fingerprint> <grid size> <work group size>
+// where fingerprints are 16 hex digits and sizes are written as XxYxZ. Empty
+// lines and lines starting with '#' are ignored.
+class TuningDatabase {
+ public:
+  TuningDatabase() = default;
+
+  // Move only
+  TuningDatabase(TuningDatabase&& database) = default;
+  TuningDatabase& operator=(TuningDatabase&& database) = default;
+  TuningDatabase(const TuningDatabase&) = delete;
+  TuningDatabase& operator=(const TuningDatabase&) = delete;
+
+  // device_fingerprint identifies GPU model and driver, kernel_fingerprint
+  // identifies kernel source and compiler options. Together with grid size
+  // they determine the best work group size.
+  bool Find(uint64_t device_fingerprint, uint64_t kernel_fingerprint,
+            const int3& grid_size, int3* work_group_size) const;
+  void Add(uint64_t device_fingerprint, uint64_t kernel_fingerprint,
+           const int3& grid_size, const int3& work_group_size);
+
+  // Adds all entries of serialized database. Existing entries are overwritten
+  // by entries from data. On error database stays unchanged.
+  absl::Status AddSerialized(absl::string_view data);
+  std::string Serialize() const;
+
+  bool empty() const { return entries_.empty(); }
+  size_t size() const { return entries_.size(); }
+
+ private:
+  struct Key {
+    uint64_t device_fingerprint;
+    uint64_t kernel_fingerprint;
+    int3 grid_size;
+
+    bool operator==(const Key& other) const {
+      return device_fingerprint == other.device_fingerprint &&
+             kernel_fingerprint == other.kernel_fingerprint &&
+             grid_size == other.grid_size;
+    }
+
+    template <typename H>
+    friend H AbslHashValue(H h, const Key& key) {
+      return H::combine(std::move(h), key.device_fingerprint,
+                        key.kernel_fingerprint, key.grid_size.x,
+                        key.grid_size.y, key.grid_size.z);
+    }
+  };
+
+  absl::flat_hash_map<Key, int3> entries_;
+};
+
+}  // namespace cl
+}  // namespace gpu
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_DELEGATES_GPU_CL_TUNING_DATABASE_H_
@@ -0,0 +1,89 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/delegates/gpu/cl/tuning_database.h"
+
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace gpu {
+namespace cl {
+namespace {
+
+TEST(TuningDatabaseTest, FindAddedEntry) {
+  TuningDatabase database;
+  database.Add(1, 2, int3(64, 32, 4), int3(8, 4, 1));
+  int3 work_group_size;
+  ASSERT_TRUE(database.Find(1, 2, int3(64, 32, 4), &work_group_size));
+  EXPECT_EQ(work_group_size, int3(8, 4, 1));
+  EXPECT_FALSE(database.Find(3, 2, int3(64, 32, 4), &work_group_size));
+  EXPECT_FALSE(database.Find(1, 3, int3(64, 32, 4), &work_group_size));
+  EXPECT_FALSE(database.Find(1, 2, int3(64, 32, 8), &work_group_size));
+}
+
+TEST(TuningDatabaseTest, SerializationRoundTrip) {
+  TuningDatabase database;
+  database.Add(0xfedcba9876543210, 7, int3(64, 32, 4), int3(8, 4, 1));
+  database.Add(1, 0x0123456789abcdef, int3(1, 1, 1), int3(1, 1, 1));
+  const std::string serialized = database.Serialize();
+  EXPECT_EQ(serialized,
+            "0000000000000001 0123456789abcdef 1x1x1 1x1x1\n"
+            "fedcba9876543210 0000000000000007 64x32x4 8x4x1\n");
+
+  TuningDatabase restored;
+  ASSERT_TRUE(restored.AddSerialized(serialized).ok());
+  EXPECT_EQ(restored.size(), 2);
+  int3 work_group_size;
+  ASSERT_TRUE(restored.Find(0xfedcba9876543210, 7, int3(64, 32, 4),
+                            &work_group_size));
+  EXPECT_EQ(work_group_size, int3(8, 4, 1));
+  EXPECT_EQ(restored.Serialize(), serialized);
+}
+
+TEST(TuningDatabaseTest, SkipsCommentsAndOverwritesEntries) {
+  TuningDatabase database;
+  database.Add(1, 2, int3(16, 16, 1), int3(4, 4, 1));
+  ASSERT_TRUE(database
+                  .AddSerialized("# Adreno 640\n"
+                                 "\n"
+                                 "0000000000000001 0000000000000002 16x16x1 "
+                                 "8x2x1\r\n")
+                  .ok());
+  EXPECT_EQ(database.size(), 1);
+  int3 work_group_size;
+  ASSERT_TRUE(database.Find(1, 2, int3(16, 16, 1), &work_group_size));
+  EXPECT_EQ(work_group_size, int3(8, 2, 1));
+}
+
+TEST(TuningDatabaseTest, MalformedDataLeavesDatabaseUnchanged) {
+  TuningDatabase database;
+  EXPECT_FALSE(database
+                   .AddSerialized("0000000000000001 0000000000000002 "
+                                  "16x16x1 8x2x1\n"
+                                  "0000000000000001 0000000000000003 16x16\n")
+                   .ok());
+  EXPECT_FALSE(
+      database.AddSerialized("000000000000000g 0000000000000002 1x1x1 1x1x1")
+          .ok());
+  EXPECT_FALSE(
+      database.AddSerialized("0000000000000001 0000000000000002 1x1x1 0x1x1")
+          .ok());
+  EXPECT_TRUE(database.empty());
+}
+
+}  // namespace
+}  // namespace cl
+}  // namespace gpu
+}  // namespace tflite
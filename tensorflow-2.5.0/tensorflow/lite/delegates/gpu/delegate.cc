@@ -17,11 +17,14 @@ limitations under the License.
 
 #include <cstdint>
 #include <memory>
+#include <string>
 #include <thread>  // NOLINT(build/c++11)
 #include <vector>
 
+#include <farmhash.h>
 #include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
 #include "absl/types/span.h"
 #include "tensorflow/lite/builtin_ops.h"
 #include "tensorflow/lite/c/common.h"
@@ -34,6 +37,7 @@ limitations under the License.
 #include "tensorflow/lite/delegates/gpu/common/model_transformer.h"
 #include "tensorflow/lite/delegates/gpu/common/quantization_util.h"
 #include "tensorflow/lite/delegates/gpu/common/status.h"
+#include "tensorflow/lite/delegates/gpu/delegate_serialization.h"
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
 #include "tensorflow/lite/minimal_logging.h"
 
@@ -69,6 +73,15 @@ InferenceUsage ToUsage(int32_t usage) {
   return InferenceUsage::UNKNOWN;
 }
 
+bool RefsMatch(const std::vector<int64_t>& serialized_refs,
+               const std::vector<uint32_t>& graph_refs) {
+  if (serialized_refs.size() != graph_refs.size()) return false;
+  for (int i = 0; i < graph_refs.size(); ++i) {
+    if (serialized_refs[i] != graph_refs[i]) return false;
+  }
+  return true;
+}
+
 // Forward declarations.
 TfLiteStatus DelegatePrepare(TfLiteContext* context, TfLiteDelegate* delegate);
 
@@ -85,6 +98,11 @@ class Delegate {
   TfLiteDelegate* tflite_delegate() { return &delegate_; }
   const TfLiteGpuDelegateOptionsV2& options() const { return options_; }
 
+  bool IsSerializationEnabled() const {
+    return options_.serialization_dir && options_.serialization_dir[0] &&
+           options_.model_token && options_.model_token[0];
+  }
+
   bool IsQuantOpsAllowed() const {
     return options_.experimental_flags &
            TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_QUANT;
@@ -134,14 +152,16 @@ class DelegateKernel {
     bool graph_is_destroyed;
     const int experimental_flags = delegate_->options().experimental_flags;
     if (experimental_flags & TFLITE_GPU_EXPERIMENTAL_FLAGS_CL_ONLY) {
-      RETURN_IF_ERROR(
-          InitializeOpenClApi(&graph, &builder, &graph_is_destroyed));
+      RETURN_IF_ERROR(InitializeOpenClApi(context, delegate_params, input_refs,
+                                          output_refs, &graph, &builder,
+                                          &graph_is_destroyed));
     } else if (experimental_flags & TFLITE_GPU_EXPERIMENTAL_FLAGS_GL_ONLY) {
       RETURN_IF_ERROR(InitializeOpenGlApi(&graph, &builder));
     } else {
       // By default, we try CL first & fall back to GL if that fails.
-      absl::Status status =
-          InitializeOpenClApi(&graph, &builder, &graph_is_destroyed);
+      absl::Status status = InitializeOpenClApi(
+          context, delegate_params, input_refs, output_refs, &graph, &builder,
+          &graph_is_destroyed);
       if (!status.ok()) {
         TF_LITE_KERNEL_LOG(context, std::string(status.message()).c_str());
         TF_LITE_KERNEL_LOG(context, "Falling back to OpenGL");
@@ -174,7 +194,9 @@ class DelegateKernel {
                                                   GetObjectDef(tensor_index)));
     }
 
-    return builder->Build(&runner_);
+    RETURN_IF_ERROR(builder->Build(&runner_));
+    SaveSerializedData();
+    return absl::OkStatus();
   }
 
   // This directs the runtime to allocate memory for input/output temporary
@@ -283,15 +305,26 @@ class DelegateKernel {
     return absl::OkStatus();
   }
 
-  absl::Status InitializeOpenClApi(GraphFloat32* graph,
+  absl::Status InitializeOpenClApi(TfLiteContext* context,
+                                   const TfLiteDelegateParams* delegate_params,
+                                   const std::vector<uint32_t>& input_refs,
+                                   const std::vector<uint32_t>& output_refs,
+                                   GraphFloat32* graph,
                                    std::unique_ptr<InferenceBuilder>* builder,
                                    bool* graph_is_destroyed) {
     *graph_is_destroyed = false;
+    serialization_path_.clear();
+    serialized_model_.clear();
+    auto delegate_options = delegate_->options();
     cl::InferenceEnvironmentOptions env_options;
+    if (delegate_options.tuning_database) {
+      env_options.tuning_database =
+          absl::MakeConstSpan(delegate_options.tuning_database,
+                              delegate_options.tuning_database_size);
+    }
     cl::InferenceEnvironmentProperties properties;
     RETURN_IF_ERROR(cl::NewInferenceEnvironment(env_options, &cl_environment_,
                                                 &properties));
-    auto delegate_options = delegate_->options();
     cl::InferenceOptions options;
     // If is_precision_loss_allowed == -1, then just use priorities instead
     // of paying attention to is_precision_loss_allowed value.
@@ -308,6 +341,11 @@ class DelegateKernel {
       }
     }
     options.usage = ToUsage(delegate_options.inference_preference);
+    if (delegate_->IsSerializationEnabled()) {
+      return InitializeOpenClApiWithSerialization(
+          context, delegate_params, input_refs, output_refs, options, graph,
+          builder, graph_is_destroyed);
+    }
     *graph_is_destroyed = true;
     RETURN_IF_ERROR(cl_environment_->NewInferenceBuilder(
         options, std::move(*graph), builder));
@@ -316,6 +354,109 @@ class DelegateKernel {
     return absl::OkStatus();
   }
 
+  // Restores the inference context and compiled programs persisted in
+  // serialization_dir by a previous run. If there is nothing to restore, the
+  // graph is compiled from scratch through a serialized model, which is saved
+  // together with the compiled programs once the builder is built.
+  absl::Status InitializeOpenClApiWithSerialization(
+      TfLiteContext* context, const TfLiteDelegateParams* delegate_params,
+      const std::vector<uint32_t>& input_refs,
+      const std::vector<uint32_t>& output_refs,
+      const cl::InferenceOptions& options, GraphFloat32* graph,
+      std::unique_ptr<InferenceBuilder>* builder, bool* graph_is_destroyed) {
+    const auto& delegate_options = delegate_->options();
+    const std::string options_description = absl::StrCat(
+        delegate_options.is_precision_loss_allowed, ",",
+        static_cast<int>(options.priority1), ",",
+        static_cast<int>(options.priority2), ",",
+        static_cast<int>(options.priority3), ",",
+        static_cast<int>(options.usage), ",",
+        delegate_options.experimental_flags, "|",
+        delegate_options.tuning_database
+            ? ::util::Fingerprint64(
+                  reinterpret_cast<const char*>(
+                      delegate_options.tuning_database),
+                  delegate_options.tuning_database_size)
+            : 0);
+    const std::string path = SerializationPathPrefix(
+        delegate_options.serialization_dir,
+        cl_environment_->GetDeviceDescription(), delegate_options.model_token,
+        DescribePartition(context, delegate_params), options_description);
+
+    std::vector<uint8_t> binary_cache;
+    if (ReadFile(path + ".bin", &binary_cache)) {
+      const absl::Status status =
+          cl_environment_->AddSerializedBinaryCache(binary_cache);
+      if (!status.ok()) {
+        TFLITE_LOG_PROD(TFLITE_LOG_WARNING,
+                        "Discarding GPU program cache %s.bin: %s",
+                        path.c_str(), std::string(status.message()).c_str());
+      }
+    }
+
+    std::vector<uint8_t> serialized_model;
+    std::vector<int64_t> in_refs;
+    std::vector<int64_t> out_refs;
+    if (ReadFile(path + ".model", &serialized_model)) {
+      const absl::Status status = cl_environment_->NewInferenceBuilder(
+          serialized_model, builder, &in_refs, &out_refs);
+      if (status.ok() && RefsMatch(in_refs, input_refs) &&
+          RefsMatch(out_refs, output_refs)) {
+        // Programs the restored model needs may still be missing from the
+        // binary cache, so refresh it after the build.
+        serialization_path_ = path;
+        TFLITE_LOG_PROD_ONCE(tflite::TFLITE_LOG_INFO,
+                             "Initialized OpenCL-based API from serialized "
+                             "model.");
+        return absl::OkStatus();
+      }
+      TFLITE_LOG_PROD(TFLITE_LOG_WARNING,
+                      "Discarding serialized GPU model %s.model", path.c_str());
+      builder->reset();
+      in_refs.clear();
+      out_refs.clear();
+    }
+
+    *graph_is_destroyed = true;
+    serialized_model.clear();
+    RETURN_IF_ERROR(cl_environment_->BuildSerializedModel(
+        options, std::move(*graph), &serialized_model));
+    RETURN_IF_ERROR(cl_environment_->NewInferenceBuilder(
+        serialized_model, builder, &in_refs, &out_refs));
+    serialization_path_ = path;
+    serialized_model_ = std::move(serialized_model);
+    TFLITE_LOG_PROD_ONCE(tflite::TFLITE_LOG_INFO,
+                         "Initialized OpenCL-based API.");
+    return absl::OkStatus();
+  }
+
+  // Persists the serialized model built in this run, if any, and the compiled
+  // programs. Failures only cost a recompilation on the next run, so they are
+  // logged and otherwise ignored.
+  void SaveSerializedData() {
+    if (serialization_path_.empty() || !cl_environment_) return;
+    if (!serialized_model_.empty()) {
+      const absl::Status status =
+          WriteFile(serialization_path_ + ".model", serialized_model_);
+      if (!status.ok()) {
+        TFLITE_LOG_PROD(TFLITE_LOG_WARNING, "%s",
+                        std::string(status.message()).c_str());
+      }
+    }
+    const std::vector<uint8_t> binary_cache =
+        cl_environment_->GetSerializedBinaryCache();
+    if (!binary_cache.empty()) {
+      const absl::Status status =
+          WriteFile(serialization_path_ + ".bin", binary_cache);
+      if (!status.ok()) {
+        TFLITE_LOG_PROD(TFLITE_LOG_WARNING, "%s",
+                        std::string(status.message()).c_str());
+      }
+    }
+    serialized_model_.clear();
+    serialized_model_.shrink_to_fit();
+  }
+
   absl::Status InitializeOpenGlApi(GraphFloat32* graph,
                                    std::unique_ptr<InferenceBuilder>* builder) {
 #ifndef CL_DELEGATE_NO_GL
@@ -351,6 +492,11 @@ class DelegateKernel {
   // originally quantized (8-bit) tensor to its float version added in
   // model_builder - and vice versa.
   absl::flat_hash_map<int, int> quant_conversion_map_;
+  // Path prefix of the files persisted in serialization_dir for this kernel,
+  // empty when the OpenCL backend isn't serialized, and the serialized model
+  // that still has to be written there.
+  std::string serialization_path_;
+  std::vector<uint8_t> serialized_model_;
   std::thread::id thread_id_prepare_;  // thread id used for Prapare()
   bool enforce_same_thread_ = false;   // flag to enforce same thread for Invoke
 };
@@ -450,6 +596,10 @@ TfLiteGpuDelegateOptionsV2 TfLiteGpuDelegateOptionsV2Default() {
       .inference_priority3 = TFLITE_GPU_INFERENCE_PRIORITY_AUTO,
       .experimental_flags = TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_QUANT,
       .max_delegated_partitions = 1,
+      .serialization_dir = nullptr,
+      .model_token = nullptr,
+      .tuning_database = nullptr,
+      .tuning_database_size = 0,
   };
   return options;
 }
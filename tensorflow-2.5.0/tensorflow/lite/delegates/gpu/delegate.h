@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_DELEGATES_GPU_DELEGATE_H_
 #define TENSORFLOW_LITE_DELEGATES_GPU_DELEGATE_H_
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include "tensorflow/lite/c/common.h"
@@ -101,6 +102,27 @@ typedef struct {
   // This limits the maximum number of partitions to be delegated. By default,
   // it's set to 1 in TfLiteGpuDelegateOptionsV2Default().
   int32_t max_delegated_partitions;
+
+  // Directory in which the OpenCL backend persists compiled programs and the
+  // serialized inference context, so that later application launches skip
+  // kernel compilation and tuning. The directory must exist and be writable
+  // by the application. Serialization is enabled only if both
+  // serialization_dir and model_token are set.
+  const char* serialization_dir;
+
+  // Token that uniquely identifies the model, e.g. a fingerprint of the model
+  // file. It has to change whenever the model changes. Cache entries are
+  // additionally keyed by the OpenCL device and driver, the delegated
+  // partition and the delegate options, so entries produced for another
+  // device, driver or configuration are never reused.
+  const char* model_token;
+
+  // Work group sizes tuned offline for the OpenCL backend, as returned by
+  // cl::InferenceEnvironment::GetTuningDatabase() on possibly many devices.
+  // Kernels found in the database for the current device and driver are not
+  // tuned at init. Data must stay alive until TfLiteGpuDelegateV2Delete.
+  const uint8_t* tuning_database;
+  size_t tuning_database_size;
 } TfLiteGpuDelegateOptionsV2;
 
 // Populates TfLiteGpuDelegateOptionsV2 as follows:
@@ -111,6 +133,10 @@ typedef struct {
 //   priority3 = TFLITE_GPU_INFERENCE_PRIORITY_AUTO
 //   experimental_flags = TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_QUANT
 //   max_delegated_partitions = 1
+//   serialization_dir = nullptr
+//   model_token = nullptr
+//   tuning_database = nullptr
+//   tuning_database_size = 0
 TFL_CAPI_EXPORT TfLiteGpuDelegateOptionsV2 TfLiteGpuDelegateOptionsV2Default();
 
 // Creates a new delegate instance that need to be destroyed with
@@ -0,0 +1,129 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/delegates/gpu/delegate_serialization.h"
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <random>
+
+#include <farmhash.h>
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "tensorflow/lite/version.h"
+
+namespace tflite {
+namespace gpu {
+namespace {
+
+// Returns a name for a temporary file next to `path` that no other writer,
+// in this or another process, uses at the same time.
+std::string UniqueTempPath(const std::string& path) {
+  static std::atomic<uint64_t> counter(0);
+  static const uint64_t process_id = [] {
+    std::random_device random;
+    return (static_cast<uint64_t>(random()) << 32) | random();
+  }();
+  return absl::StrFormat("%s.tmp%016x.%d", path, process_id, counter++);
+}
+
+}  // namespace
+
+std::string DescribePartition(TfLiteContext* context,
+                              const TfLiteDelegateParams* delegate_params) {
+  std::string description;
+  const auto append_tensors = [&](const TfLiteIntArray* tensors) {
+    for (int i = 0; i < tensors->size; ++i) {
+      const int tensor_index = tensors->data[i];
+      absl::StrAppend(&description, tensor_index, ":");
+      if (tensor_index < 0) continue;
+      const TfLiteTensor& tensor = context->tensors[tensor_index];
+      absl::StrAppend(&description, static_cast<int>(tensor.type), ":",
+                      static_cast<int>(tensor.allocation_type));
+      if (tensor.dims) {
+        for (int d = 0; d < tensor.dims->size; ++d) {
+          absl::StrAppend(&description, "x", tensor.dims->data[d]);
+        }
+      }
+      absl::StrAppend(&description, ",");
+    }
+    absl::StrAppend(&description, ";");
+  };
+  const TfLiteIntArray* nodes = delegate_params->nodes_to_replace;
+  for (int i = 0; i < nodes->size; ++i) {
+    TfLiteNode* node = nullptr;
+    TfLiteRegistration* registration = nullptr;
+    if (context->GetNodeAndRegistration(context, nodes->data[i], &node,
+                                        &registration) != kTfLiteOk) {
+      continue;
+    }
+    absl::StrAppend(
+        &description, nodes->data[i], "/", registration->builtin_code, "/",
+        registration->version, "/",
+        registration->custom_name ? registration->custom_name : "", "(");
+    append_tensors(node->inputs);
+    append_tensors(node->outputs);
+    absl::StrAppend(&description, ")");
+  }
+  append_tensors(delegate_params->input_tensors);
+  append_tensors(delegate_params->output_tensors);
+  return description;
+}
+
+std::string SerializationPathPrefix(absl::string_view serialization_dir,
+                                    absl::string_view device_description,
+                                    absl::string_view model_token,
+                                    absl::string_view partition_description,
+                                    absl::string_view options_description) {
+  const std::string key =
+      absl::StrCat(TFLITE_VERSION_STRING, "|", device_description, "|",
+                   model_token, "|", partition_description, "|",
+                   options_description);
+  return absl::StrFormat("%s/gpu_delegate_%016x", serialization_dir,
+                         ::util::Fingerprint64(key));
+}
+
+bool ReadFile(const std::string& path, std::vector<uint8_t>* data) {
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file) return false;
+  const std::streamsize size = file.tellg();
+  if (size <= 0) return false;
+  data->resize(size);
+  file.seekg(0);
+  return static_cast<bool>(
+      file.read(reinterpret_cast<char*>(data->data()), size));
+}
+
+absl::Status WriteFile(const std::string& path,
+                       absl::Span<const uint8_t> data) {
+  const std::string tmp_path = UniqueTempPath(path);
+  {
+    std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+    if (!file.write(reinterpret_cast<const char*>(data.data()), data.size()) ||
+        !file.flush()) {
+      std::remove(tmp_path.c_str());
+      return absl::UnavailableError(absl::StrCat("Can't write ", tmp_path));
+    }
+  }
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    std::remove(tmp_path.c_str());
+    return absl::UnavailableError(absl::StrCat("Can't rename ", tmp_path));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace gpu
+}  // namespace tflite
@@ -0,0 +1,59 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_DELEGATES_GPU_DELEGATE_SERIALIZATION_H_
+#define TENSORFLOW_LITE_DELEGATES_GPU_DELEGATE_SERIALIZATION_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/delegates/gpu/common/status.h"
+
+namespace tflite {
+namespace gpu {
+
+// Describes the structure of the delegated partition: its operations and the
+// types and shapes of tensors it touches. The model token of the delegate
+// options covers everything else.
+std::string DescribePartition(TfLiteContext* context,
+                              const TfLiteDelegateParams* delegate_params);
+
+// Returns the path prefix, in `serialization_dir`, of the files persisted for
+// a delegated partition. It is keyed by the TFLite version and by each of the
+// other arguments, so entries produced for another device, driver, model,
+// partition or configuration are never reused.
+std::string SerializationPathPrefix(absl::string_view serialization_dir,
+                                    absl::string_view device_description,
+                                    absl::string_view model_token,
+                                    absl::string_view partition_description,
+                                    absl::string_view options_description);
+
+// Reads the whole file at `path`. Returns false if it can't be read or is
+// empty.
+bool ReadFile(const std::string& path, std::vector<uint8_t>* data);
+
+// Writes `data` to a temporary file with a unique name that is then renamed to
+// `path`, so that a concurrently starting process never observes a partially
+// written file, even if it writes the same file.
+absl::Status WriteFile(const std::string& path, absl::Span<const uint8_t> data);
+
+}  // namespace gpu
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_DELEGATES_GPU_DELEGATE_SERIALIZATION_H_
@@ -0,0 +1,170 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/delegates/gpu/delegate_serialization.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/c/common.h"
+
+namespace tflite {
+namespace gpu {
+namespace {
+
+// A delegated partition with a single node, which reads tensor 0 and writes
+// tensor 1.
+class Partition {
+ public:
+  Partition() {
+    for (int i = 0; i < 2; ++i) {
+      tensors_[i] = {};
+      tensors_[i].type = kTfLiteFloat32;
+      tensors_[i].allocation_type = kTfLiteArenaRw;
+      tensors_[i].dims = TfLiteIntArrayCreate(2);
+      tensors_[i].dims->data[0] = 1;
+      tensors_[i].dims->data[1] = 8;
+    }
+    inputs_ = TfLiteIntArrayCreate(1);
+    inputs_->data[0] = 0;
+    outputs_ = TfLiteIntArrayCreate(1);
+    outputs_->data[0] = 1;
+    nodes_ = TfLiteIntArrayCreate(1);
+    nodes_->data[0] = 0;
+
+    node_ = {};
+    node_.inputs = inputs_;
+    node_.outputs = outputs_;
+    registration_ = {};
+    registration_.builtin_code = kTfLiteBuiltinRelu;
+    registration_.version = 1;
+
+    context_ = {};
+    context_.tensors = tensors_;
+    context_.tensors_size = 2;
+    context_.impl_ = this;
+    context_.GetNodeAndRegistration =
+        [](TfLiteContext* context, int node_index, TfLiteNode** node,
+           TfLiteRegistration** registration) {
+          auto* partition = static_cast<Partition*>(context->impl_);
+          if (node_index != 0) return kTfLiteError;
+          *node = &partition->node_;
+          *registration = &partition->registration_;
+          return kTfLiteOk;
+        };
+
+    params_ = {};
+    params_.nodes_to_replace = nodes_;
+    params_.input_tensors = inputs_;
+    params_.output_tensors = outputs_;
+  }
+
+  ~Partition() {
+    for (TfLiteTensor& tensor : tensors_) TfLiteIntArrayFree(tensor.dims);
+    TfLiteIntArrayFree(inputs_);
+    TfLiteIntArrayFree(outputs_);
+    TfLiteIntArrayFree(nodes_);
+  }
+
+  std::string Describe() { return DescribePartition(&context_, &params_); }
+
+  TfLiteTensor* tensor(int index) { return &tensors_[index]; }
+  TfLiteRegistration* registration() { return &registration_; }
+
+ private:
+  TfLiteTensor tensors_[2];
+  TfLiteIntArray* inputs_;
+  TfLiteIntArray* outputs_;
+  TfLiteIntArray* nodes_;
+  TfLiteNode node_;
+  TfLiteRegistration registration_;
+  TfLiteContext context_;
+  TfLiteDelegateParams params_;
+};
+
+TEST(DelegateSerializationTest, PartitionDescriptionCoversStructure) {
+  Partition partition;
+  const std::string description = partition.Describe();
+  EXPECT_EQ(description, Partition().Describe());
+
+  partition.tensor(0)->dims->data[1] = 16;
+  EXPECT_NE(partition.Describe(), description);
+  partition.tensor(0)->dims->data[1] = 8;
+  EXPECT_EQ(partition.Describe(), description);
+
+  partition.tensor(1)->type = kTfLiteFloat16;
+  EXPECT_NE(partition.Describe(), description);
+  partition.tensor(1)->type = kTfLiteFloat32;
+
+  partition.registration()->version = 2;
+  EXPECT_NE(partition.Describe(), description);
+  partition.registration()->version = 1;
+
+  partition.registration()->builtin_code = kTfLiteBuiltinRelu6;
+  EXPECT_NE(partition.Describe(), description);
+}
+
+TEST(DelegateSerializationTest, PathPrefixIsKeyedByEveryInput) {
+  const std::string prefix =
+      SerializationPathPrefix("/dir", "device", "model", "partition", "opts");
+  EXPECT_THAT(prefix, ::testing::StartsWith("/dir/gpu_delegate_"));
+  EXPECT_EQ(prefix, SerializationPathPrefix("/dir", "device", "model",
+                                            "partition", "opts"));
+  EXPECT_NE(prefix, SerializationPathPrefix("/other", "device", "model",
+                                            "partition", "opts"));
+  EXPECT_NE(prefix, SerializationPathPrefix("/dir", "other", "model",
+                                            "partition", "opts"));
+  EXPECT_NE(prefix, SerializationPathPrefix("/dir", "device", "other",
+                                            "partition", "opts"));
+  EXPECT_NE(prefix, SerializationPathPrefix("/dir", "device", "model",
+                                            "other", "opts"));
+  EXPECT_NE(prefix, SerializationPathPrefix("/dir", "device", "model",
+                                            "partition", "other"));
+}
+
+TEST(DelegateSerializationTest, WriteAndReadFile) {
+  const std::string path = ::testing::TempDir() + "/delegate_serialization";
+  std::remove(path.c_str());
+  std::vector<uint8_t> data;
+  EXPECT_FALSE(ReadFile(path, &data));
+
+  const std::vector<uint8_t> first = {1, 2, 3, 4, 5};
+  ASSERT_TRUE(WriteFile(path, first).ok());
+  ASSERT_TRUE(ReadFile(path, &data));
+  EXPECT_EQ(data, first);
+
+  // Writing again replaces the file.
+  const std::vector<uint8_t> second = {6, 7};
+  ASSERT_TRUE(WriteFile(path, second).ok());
+  ASSERT_TRUE(ReadFile(path, &data));
+  EXPECT_EQ(data, second);
+  std::remove(path.c_str());
+}
+
+TEST(DelegateSerializationTest, WriteFileFailsInMissingDirectory) {
+  const std::vector<uint8_t> data = {1};
+  EXPECT_FALSE(
+      WriteFile(::testing::TempDir() + "/missing_dir/delegate_serialization",
+                data)
+          .ok());
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace tflite
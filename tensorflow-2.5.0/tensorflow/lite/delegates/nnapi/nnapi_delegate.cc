@@ -520,6 +520,18 @@ uint64_t GetHash(const TfLiteIntArray* int_array, uint64_t combine_with = 0) {
   return result;
 }
 
+// Folds `value` into the running hash `seed`, in the same way as GetHash().
+uint64_t CombineHash(uint64_t seed, uint64_t value) {
+  constexpr auto kHashConst = 0x9e3779b97f4a7800ULL;
+  return seed ^ (value + kHashConst + (seed << 10) + (seed >> 4));
+}
+
+// Folds the content of a buffer into the running hash `seed`.
+uint64_t CombineHash(uint64_t seed, const void* data, size_t size) {
+  return CombineHash(
+      seed, ::util::Fingerprint64(static_cast<const char*>(data), size));
+}
+
 bool HasZeroes(TfLiteIntArrayView array) {
   for (auto value : array) {
     if (value == 0) {
@@ -715,7 +727,7 @@ class NNAPIOpBuilder {
                      allocation_mapping,
                  std::vector<int>* nnapi_to_tflite_op_mapping,
                  ANeuralNetworksModel* nn_model, int* nnapi_errno,
-                 bool allow_dynamic_dimensions)
+                 bool allow_dynamic_dimensions, uint64_t* model_fingerprint)
       : nnapi_(nnapi),
         context_(context),
         operand_mapping_(tensor_mapping),
@@ -724,7 +736,8 @@ class NNAPIOpBuilder {
         nnapi_to_tflite_op_mapping_(nnapi_to_tflite_op_mapping),
         nn_model_(nn_model),
         nnapi_errno_(nnapi_errno),
-        allow_dynamic_dimensions_(allow_dynamic_dimensions) {}
+        allow_dynamic_dimensions_(allow_dynamic_dimensions),
+        model_fingerprint_(model_fingerprint) {}
 
   TfLiteStatus AddScalarBoolOperand(bool value) {
     return AddScalarOperand<bool>(value, ANEURALNETWORKS_BOOL);
@@ -991,6 +1004,12 @@ class NNAPIOpBuilder {
         nnapi_->ANeuralNetworksModel_addOperation(
             nn_model_, type, input_count, inputs, output_count, outputs),
         "adding operation", nnapi_errno_);
+    if (model_fingerprint_) {
+      uint64_t hash = CombineHash(*model_fingerprint_, type);
+      hash = CombineHash(hash, inputs, input_count * sizeof(uint32_t));
+      *model_fingerprint_ =
+          CombineHash(hash, outputs, output_count * sizeof(uint32_t));
+    }
     nnapi_to_tflite_op_mapping_->push_back(lite_node_index);
     return kTfLiteOk;
   }
@@ -1015,7 +1034,7 @@ class NNAPIOpBuilder {
           reinterpret_cast<uint32_t*>(tensor.dims->data), 0.f, 0};
       RETURN_TFLITE_ERROR_IF_NN_ERROR(
           context_,
-          nnapi_->ANeuralNetworksModel_addOperand(nn_model_, &operand_type),
+          AddOperandToModel(&operand_type),
           "adding operand", nnapi_errno_);
       dequantized_ann_index = operand_mapping_->add_new_non_tensor_operand();
 
@@ -1062,7 +1081,7 @@ class NNAPIOpBuilder {
     ANeuralNetworksOperandType operand_type{.type = nn_type};
     RETURN_TFLITE_ERROR_IF_NN_ERROR_FOR_TENSOR(
         context_,
-        nnapi_->ANeuralNetworksModel_addOperand(nn_model_, &operand_type),
+        AddOperandToModel(&operand_type),
         "adding operand", tensor, nnapi_errno_);
     int ann_tensor_index = operand_mapping_->lite_index_to_ann(tensor_index);
     if (ann_tensor_index != -1) {
@@ -1120,16 +1139,15 @@ class NNAPIOpBuilder {
 
     RETURN_TFLITE_ERROR_IF_NN_ERROR(
         context_,
-        nnapi_->ANeuralNetworksModel_addOperand(nn_model_, &operand_type),
+        AddOperandToModel(&operand_type),
         "adding operand", nnapi_errno_);
 
     augmented_inputs_.push_back(ann_tensor_index);
 
     RETURN_TFLITE_ERROR_IF_NN_ERROR(
         context_,
-        nnapi_->ANeuralNetworksModel_setOperandValue(
-            nn_model_, ann_tensor_index, new_tensor->data.raw,
-            new_tensor->bytes),
+        SetOperandValue(ann_tensor_index, new_tensor->data.raw,
+                        new_tensor->bytes),
         "setting new operand value", nnapi_errno_);
 
     return kTfLiteOk;
@@ -1151,6 +1169,30 @@ class NNAPIOpBuilder {
   }
 
  private:
+  // Adds an operand to nn_model_ and, if requested, folds its type into
+  // *model_fingerprint_. Returns the NNAPI result code.
+  int AddOperandToModel(const ANeuralNetworksOperandType* operand_type) {
+    if (model_fingerprint_) {
+      uint64_t hash = CombineHash(*model_fingerprint_, operand_type->type);
+      hash = CombineHash(hash, operand_type->dimensions,
+                         operand_type->dimensionCount * sizeof(uint32_t));
+      hash = CombineHash(hash, &operand_type->scale, sizeof(float));
+      *model_fingerprint_ = CombineHash(hash, operand_type->zeroPoint);
+    }
+    return nnapi_->ANeuralNetworksModel_addOperand(nn_model_, operand_type);
+  }
+
+  // Sets the value of an operand of nn_model_ and, if requested, folds it into
+  // *model_fingerprint_. Returns the NNAPI result code.
+  int SetOperandValue(int32_t index, const void* buffer, size_t length) {
+    if (model_fingerprint_) {
+      *model_fingerprint_ =
+          CombineHash(CombineHash(*model_fingerprint_, index), buffer, length);
+    }
+    return nnapi_->ANeuralNetworksModel_setOperandValue(nn_model_, index,
+                                                        buffer, length);
+  }
+
   // Returns a TF Lite type which has the same memory representation as a
   // provided NN API type.
   TfLiteStatus GetEquivalentToANNType(TfLiteContext* context, int nn_type,
@@ -1176,13 +1218,12 @@ class NNAPIOpBuilder {
     ANeuralNetworksOperandType operand_type{.type = nn_type};
     RETURN_TFLITE_ERROR_IF_NN_ERROR(
         context_,
-        nnapi_->ANeuralNetworksModel_addOperand(nn_model_, &operand_type),
+        AddOperandToModel(&operand_type),
         "adding operand", nnapi_errno_);
     const int ann_index = operand_mapping_->add_new_non_tensor_operand();
     RETURN_TFLITE_ERROR_IF_NN_ERROR(
         context_,
-        nnapi_->ANeuralNetworksModel_setOperandValue(nn_model_, ann_index,
-                                                     &value, sizeof(T)),
+        SetOperandValue(ann_index, &value, sizeof(T)),
         "setting new operand value", nnapi_errno_);
     augmented_inputs_.push_back(ann_index);
     return kTfLiteOk;
@@ -1200,14 +1241,13 @@ class NNAPIOpBuilder {
 
     RETURN_TFLITE_ERROR_IF_NN_ERROR(
         context_,
-        nnapi_->ANeuralNetworksModel_addOperand(nn_model_, &operand_type),
+        AddOperandToModel(&operand_type),
         "adding operand", nnapi_errno_);
 
     const int ann_index = operand_mapping_->add_new_non_tensor_operand();
     RETURN_TFLITE_ERROR_IF_NN_ERROR(
         context_,
-        nnapi_->ANeuralNetworksModel_setOperandValue(
-            nn_model_, ann_index, values, sizeof(T) * num_values),
+        SetOperandValue(ann_index, values, sizeof(T) * num_values),
         "settings new operand value", nnapi_errno_);
     augmented_inputs_.push_back(ann_index);
     return kTfLiteOk;
@@ -1242,7 +1282,7 @@ class NNAPIOpBuilder {
     };
     RETURN_TFLITE_ERROR_IF_NN_ERROR(
         context_,
-        nnapi_->ANeuralNetworksModel_addOperand(nn_model_, &operand_type),
+        AddOperandToModel(&operand_type),
         "adding operand", nnapi_errno_);
     const int ann_index = operand_mapping_->add_new_non_tensor_operand();
     augmented_outputs_.push_back(ann_index);
@@ -1394,10 +1434,17 @@ class NNAPIOpBuilder {
                                             scale, zeroPoint};
     RETURN_TFLITE_ERROR_IF_NN_ERROR_FOR_TENSOR(
         context_,
-        nnapi_->ANeuralNetworksModel_addOperand(nn_model_, &operand_type),
+        AddOperandToModel(&operand_type),
         "adding operand", tensor, nnapi_errno_);
 
     if (nn_type == ANEURALNETWORKS_TENSOR_QUANT8_SYMM_PER_CHANNEL) {
+      if (model_fingerprint_) {
+        uint64_t hash =
+            CombineHash(*model_fingerprint_, ann_perchannel_params.channelDim);
+        *model_fingerprint_ =
+            CombineHash(hash, ann_perchannel_params.scales,
+                        ann_perchannel_params.scaleCount * sizeof(float));
+      }
       RETURN_TFLITE_ERROR_IF_NN_ERROR_FOR_TENSOR(
           context_,
           nnapi_->ANeuralNetworksModel_setOperandSymmPerChannelQuantParams(
@@ -1434,9 +1481,8 @@ class NNAPIOpBuilder {
         }
         RETURN_TFLITE_ERROR_IF_NN_ERROR_FOR_TENSOR(
             context_,
-            nnapi_->ANeuralNetworksModel_setOperandValue(
-                nn_model_, ann_tensor_index, new_tensor->data.raw,
-                new_tensor->bytes),
+            SetOperandValue(ann_tensor_index, new_tensor->data.raw,
+                            new_tensor->bytes),
             "setting new operand value", tensor, nnapi_errno_);
 #ifdef TFLITE_NNAPI_ALLOW_MMAP_SHARING
       } else if (tensor->allocation &&
@@ -1457,6 +1503,11 @@ class NNAPIOpBuilder {
         // Compute the offset to the base pointer of the MMAPAllocation.
         auto offset = reinterpret_cast<const uint8_t*>(tensor->data.raw) -
                       reinterpret_cast<const uint8_t*>(mmap_alloc->base());
+        if (model_fingerprint_) {
+          *model_fingerprint_ = CombineHash(
+              CombineHash(*model_fingerprint_, ann_tensor_index),
+              tensor->data.raw, tensor->bytes);
+        }
         RETURN_TFLITE_ERROR_IF_NN_ERROR_FOR_TENSOR(
             context_,
             nnapi_->ANeuralNetworksModel_setOperandValueFromMemory(
@@ -1467,8 +1518,7 @@ class NNAPIOpBuilder {
       } else {
         RETURN_TFLITE_ERROR_IF_NN_ERROR_FOR_TENSOR(
             context_,
-            nnapi_->ANeuralNetworksModel_setOperandValue(
-                nn_model_, ann_tensor_index, tensor->data.raw, tensor->bytes),
+            SetOperandValue(ann_tensor_index, tensor->data.raw, tensor->bytes),
             "setting new operand value", tensor, nnapi_errno_);
       }
     }
@@ -1512,6 +1562,9 @@ class NNAPIOpBuilder {
 
   // Whether to allow dynamic batch size without re-compilation.
   bool allow_dynamic_dimensions_;
+
+  // If not null, everything added to nn_model_ is folded into this hash.
+  uint64_t* model_fingerprint_;
 };  // namespace nnapi
 
 namespace {
@@ -3655,17 +3708,29 @@ TfLiteStatus NNAPIDelegateKernel::Init(TfLiteContext* context,
   nn_compilation_cache_token_.clear();
   const char* cache_dir = delegate_options.cache_dir;
   const char* model_token = delegate_options.model_token;
-  if (nnapi_->android_sdk_version >= kMinSdkVersionForNNAPI12 && cache_dir &&
-      model_token) {
+  if (nnapi_->android_sdk_version >= kMinSdkVersionForNNAPI12 && cache_dir) {
     // Compilation caching could be enabled, try construct the uint8
     // token.
     // TODO(b/133342794): use a generic token generator class.
     uint64_t token_parts[4];
-    // Create bits from model_token.
+    // Create bits from model_token, or from the fingerprint of the NNAPI model
+    // computed in BuildGraph() if the application did not provide one.
     // Using farmhash fingerprint instead of std::hash, as the latter is not
     // guaranteed to be stable across program invocations.
     token_parts[0] =
-        ::util::Fingerprint64(model_token, std::strlen(model_token));
+        model_token
+            ? ::util::Fingerprint64(model_token, std::strlen(model_token))
+            : nn_model_fingerprint_;
+    // Mix in the options that select the device and the compilation mode.
+    token_parts[0] =
+        CombineHash(token_parts[0], delegate_options.execution_preference);
+    token_parts[0] =
+        CombineHash(token_parts[0], delegate_options.disallow_nnapi_cpu);
+    if (delegate_options.accelerator_name) {
+      const char* accelerator_name = delegate_options.accelerator_name;
+      token_parts[0] = CombineHash(token_parts[0], accelerator_name,
+                                   std::strlen(accelerator_name));
+    }
     // Create bits from params->nodes_to_replace.
     token_parts[1] = GetHash(params->nodes_to_replace);
     // Create bits from params->input_tensors. These include the input tensor
@@ -4209,14 +4274,16 @@ void NNAPIDelegateKernel::AddDequantizeOperatorsWhereNeeded(
 }
 
 TfLiteStatus NNAPIDelegateKernel::AddOpsAndTensors(
-    TfLiteContext* context, int* nnapi_errno, bool allow_dynamic_dimensions) {
+    TfLiteContext* context, int* nnapi_errno, bool allow_dynamic_dimensions,
+    uint64_t* model_fingerprint) {
   DequantizeMapping dequantize_mapping;
   // The operand builder allows creating a single op. It is created outside
   // the for loop to avoid reallocating the vectors.
   NNAPIOpBuilder builder(nnapi_, context, &operand_mapping_,
                          &dequantize_mapping, &allocation_memory_mapping_,
                          &nnapi_to_tflite_op_mapping_, nn_model_.get(),
-                         nnapi_errno, allow_dynamic_dimensions);
+                         nnapi_errno, allow_dynamic_dimensions,
+                         model_fingerprint);
   // If we have target accelerators the target SDK version might be
   // different than the current android version.
   target_sdk_version_ = nnapi_->android_sdk_version;
@@ -4708,9 +4775,16 @@ TfLiteStatus NNAPIDelegateKernel::BuildGraph(
     const StatefulNnApiDelegate::Options& delegate_options,
     const TfLiteIntArray* input_tensors, const TfLiteIntArray* output_tensors,
     int* nnapi_errno) {
+  // When compilation caching is requested without a model token, the token is
+  // derived from a fingerprint of the NNAPI model as it is being built.
+  const bool fingerprint_model =
+      delegate_options.cache_dir != nullptr &&
+      delegate_options.model_token == nullptr;
+  nn_model_fingerprint_ = 0;
   // Build the ops and tensors.
   TF_LITE_ENSURE_STATUS(AddOpsAndTensors(
-      context, nnapi_errno, delegate_options.allow_dynamic_dimensions));
+      context, nnapi_errno, delegate_options.allow_dynamic_dimensions,
+      fingerprint_model ? &nn_model_fingerprint_ : nullptr));
   // Map input and output tensor indices to ANN
   std::vector<uint32_t> inputs;
   inputs.reserve(input_tensors->size);
@@ -4775,6 +4849,12 @@ TfLiteStatus NNAPIDelegateKernel::BuildGraph(
 
   auto allow_fp16 =
       context->allow_fp32_relax_to_fp16 | delegate_options.allow_fp16;
+  if (fingerprint_model) {
+    uint64_t hash = CombineHash(nn_model_fingerprint_, allow_fp16);
+    hash = CombineHash(hash, inputs.data(), inputs.size() * sizeof(uint32_t));
+    nn_model_fingerprint_ =
+        CombineHash(hash, outputs.data(), outputs.size() * sizeof(uint32_t));
+  }
   if (nnapi_->android_sdk_version >= kMinSdkVersionForNNAPI11) {
     RETURN_TFLITE_ERROR_IF_NN_ERROR(
         context,
@@ -64,15 +64,17 @@ class StatefulNnApiDelegate : public TfLiteDelegate {
 
     // The nul-terminated cache dir for NNAPI model.
     // Default to nullptr, which implies the NNAPI will not try caching the
-    // compilation.
+    // compilation. Compilations cached there are reused by any interpreter,
+    // in this or a later process, that delegates the same partition.
     const char* cache_dir = nullptr;
 
     // The unique nul-terminated token string for NNAPI model.
-    // Default to nullptr, which implies the NNAPI will not try caching the
-    // compilation. It is the caller's responsibility to ensure there is no
-    // clash of the tokens.
-    // NOTE: when using compilation caching, it is not recommended to use the
-    // same delegate instance for multiple models.
+    // Default to nullptr, in which case, if cache_dir is set, the token is
+    // derived from a fingerprint of the NNAPI model built by the delegate,
+    // including the constant tensor data. Otherwise it is the caller's
+    // responsibility to ensure there is no clash of the tokens.
+    // NOTE: when using compilation caching with an explicit token, it is not
+    // recommended to use the same delegate instance for multiple models.
     const char* model_token = nullptr;
 
     // Whether to disallow NNAPI CPU usage. Only effective on Android 10 and
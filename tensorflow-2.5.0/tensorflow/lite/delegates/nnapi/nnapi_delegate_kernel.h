@@ -358,6 +358,9 @@ class NNAPIDelegateKernel {
   std::unique_ptr<NNMemory> nn_output_memory_;
 
   std::vector<uint8_t> nn_compilation_cache_token_;
+  // Fingerprint of nn_model_, only computed when compilation caching is
+  // enabled without a model token.
+  uint64_t nn_model_fingerprint_ = 0;
 
   std::vector<int> nnapi_to_tflite_op_mapping_;
 
@@ -369,7 +372,8 @@ class NNAPIDelegateKernel {
       int tflite_node_index, NNAPIOpBuilder* builder, int* nnapi_errno);
 
   TfLiteStatus AddOpsAndTensors(TfLiteContext* context, int* nnapi_errno,
-                                bool allow_dynamic_dimensions);
+                                bool allow_dynamic_dimensions,
+                                uint64_t* model_fingerprint);
 
   TfLiteStatus BuildGraph(TfLiteContext* context,
                           const StatefulNnApiDelegate::Options& options,
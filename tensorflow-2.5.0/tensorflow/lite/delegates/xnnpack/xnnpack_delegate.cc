@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <array>
+#include <cmath>
 #include <cstdint>
 #include <cstring>
 #include <limits>
@@ -46,7 +47,9 @@ class Delegate {
   friend class Subgraph;
 
  public:
-  explicit Delegate(const TfLiteXNNPackDelegateOptions* options) {
+  explicit Delegate(const TfLiteXNNPackDelegateOptions* options)
+      : options_(options != nullptr ? *options
+                                    : TfLiteXNNPackDelegateOptionsDefault()) {
 #if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
     if (options != nullptr && options->num_threads > 1) {
       threadpool_.reset(
@@ -60,6 +63,16 @@ class Delegate {
   TfLiteIntArray* PrepareOpsToDelegate(TfLiteContext* context);
   TfLiteDelegate* tflite_delegate() { return &delegate_; }
 
+  // Signed 8-bit operators need the full XNNPACK library rather than the
+  // FP32-only build, so the option is honored only in QS8-enabled builds.
+  bool support_signed_8bit_quantization() const {
+#ifdef XNNPACK_DELEGATE_ENABLE_QS8
+    return (options_.flags & TFLITE_XNNPACK_DELEGATE_FLAG_QS8) != 0;
+#else
+    return false;
+#endif
+  }
+
   pthreadpool_t threadpool() const {
 #if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
     return nullptr;
@@ -91,6 +104,7 @@ class Delegate {
   std::unordered_set<int> static_unpack_nodes_;
   // Set of indices of tensors with unpacked static sparse weights.
   std::unordered_set<int> static_sparse_weights_;
+  TfLiteXNNPackDelegateOptions options_;
 #if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
   // Thread pool with smart-pointer for lifetime management.
   std::unique_ptr<pthreadpool, decltype(&pthreadpool_destroy)> threadpool_{
@@ -201,12 +215,46 @@ class Subgraph {
     // XNNPACK Value IDs for TFLite tensors
     std::vector<uint32_t> xnnpack_tensors(tensors.back() + 1);
     for (int t : tensors) {
-      if (context->tensors[t].type != kTfLiteFloat32) {
-        TF_LITE_KERNEL_LOG(
-            context,
-            "unsupported datatype (%s) of tensor %d in XNNPACK delegate",
-            TfLiteTypeGetName(context->tensors[t].type), t);
-        return nullptr;
+      xnn_datatype datatype = xnn_datatype_invalid;
+      switch (context->tensors[t].type) {
+        case kTfLiteFloat32:
+          datatype = xnn_datatype_fp32;
+          break;
+        case kTfLiteInt8:
+        case kTfLiteInt32: {
+          const bool is_int8 = context->tensors[t].type == kTfLiteInt8;
+          if (context->tensors[t].quantization.type !=
+              kTfLiteAffineQuantization) {
+            TF_LITE_KERNEL_LOG(context,
+                               "unsupported quantization type %d for %s "
+                               "tensor %d in XNNPACK delegate",
+                               context->tensors[t].quantization.type,
+                               TfLiteTypeGetName(context->tensors[t].type), t);
+            return nullptr;
+          }
+          const auto* quantization_params =
+              static_cast<const TfLiteAffineQuantization*>(
+                  context->tensors[t].quantization.params);
+          if (quantization_params->scale == nullptr) {
+            TF_LITE_KERNEL_LOG(context,
+                               "missing scale quantization parameters for %s "
+                               "tensor %d in XNNPACK delegate",
+                               TfLiteTypeGetName(context->tensors[t].type), t);
+            return nullptr;
+          }
+          if (quantization_params->scale->size == 1) {
+            datatype = is_int8 ? xnn_datatype_qint8 : xnn_datatype_qint32;
+          } else {
+            datatype = is_int8 ? xnn_datatype_qcint8 : xnn_datatype_qcint32;
+          }
+          break;
+        }
+        default:
+          TF_LITE_KERNEL_LOG(
+              context,
+              "unsupported datatype (%s) of tensor %d in XNNPACK delegate",
+              TfLiteTypeGetName(context->tensors[t].type), t);
+          return nullptr;
       }
 
       uint32_t flags = 0;
@@ -234,9 +282,33 @@ class Subgraph {
           &context->tensors[t].dims->data[0],
           &context->tensors[t].dims->data[context->tensors[t].dims->size]);
 
-      const xnn_status status = xnn_define_tensor_value(
-          subgraph.get(), xnn_datatype_fp32, dims.size(), dims.data(), data,
-          static_cast<uint32_t>(t), flags, &xnnpack_tensors[t]);
+      const auto* quantization_params =
+          static_cast<const TfLiteAffineQuantization*>(
+              context->tensors[t].quantization.params);
+      xnn_status status = xnn_status_success;
+      switch (datatype) {
+        case xnn_datatype_qint8:
+        case xnn_datatype_qint32:
+          status = xnn_define_quantized_tensor_value(
+              subgraph.get(), datatype,
+              quantization_params->zero_point->data[0],
+              quantization_params->scale->data[0], dims.size(), dims.data(),
+              data, static_cast<uint32_t>(t), flags, &xnnpack_tensors[t]);
+          break;
+        case xnn_datatype_qcint8:
+        case xnn_datatype_qcint32:
+          status = xnn_define_channelwise_quantized_tensor_value(
+              subgraph.get(), datatype, quantization_params->scale->data,
+              dims.size(), quantization_params->quantized_dimension,
+              dims.data(), data, static_cast<uint32_t>(t), flags,
+              &xnnpack_tensors[t]);
+          break;
+        default:
+          status = xnn_define_tensor_value(
+              subgraph.get(), datatype, dims.size(), dims.data(), data,
+              static_cast<uint32_t>(t), flags, &xnnpack_tensors[t]);
+          break;
+      }
       if (status != xnn_status_success) {
         TF_LITE_KERNEL_LOG(context,
                            "failed to create XNNPACK Value for tensor %d", t);
@@ -267,8 +339,9 @@ class Subgraph {
         return nullptr;
       }
 
-      if (VisitNode(subgraph.get(), context, registration, node, node_index,
-                    quasi_static_tensors, xnnpack_tensors) != kTfLiteOk) {
+      if (VisitNode(subgraph.get(), *delegate, context, registration, node,
+                    node_index, quasi_static_tensors,
+                    xnnpack_tensors) != kTfLiteOk) {
         return nullptr;
       }
     }
@@ -640,6 +713,177 @@ class Subgraph {
                            node_index);
   }
 
+  static const TfLiteAffineQuantization* GetAffineQuantization(
+      const TfLiteTensor& tensor) {
+    if (tensor.quantization.type != kTfLiteAffineQuantization) {
+      return nullptr;
+    }
+    const auto* quantization_params =
+        static_cast<const TfLiteAffineQuantization*>(
+            tensor.quantization.params);
+    if (quantization_params == nullptr ||
+        quantization_params->scale == nullptr ||
+        quantization_params->zero_point == nullptr ||
+        quantization_params->scale->size !=
+            quantization_params->zero_point->size) {
+      return nullptr;
+    }
+    return quantization_params;
+  }
+
+  // Checks quantization parameters of a signed 8-bit or 32-bit tensor.
+  // Per-tensor parameters always pass; per-channel parameters pass only if
+  // they are quantized along expected_quantized_dimension (-1 rejects them)
+  // and have zero zero points.
+  static TfLiteStatus CheckTensorQuantization(
+      TfLiteContext* context, const TfLiteTensor& tensor,
+      int expected_quantized_dimension, int tensor_index, int node_index) {
+    const TfLiteAffineQuantization* quantization_params =
+        GetAffineQuantization(tensor);
+    if (quantization_params == nullptr) {
+      TF_LITE_MAYBE_KERNEL_LOG(
+          context, "unsupported quantization type %d in tensor #%d in node #%d",
+          tensor.quantization.type, tensor_index, node_index);
+      return kTfLiteError;
+    }
+
+    const int num_scales = quantization_params->scale->size;
+    if (num_scales == 1) {
+      const int32_t zero_point = quantization_params->zero_point->data[0];
+      if (tensor.type == kTfLiteInt8
+              ? (zero_point < std::numeric_limits<int8_t>::min() ||
+                 zero_point > std::numeric_limits<int8_t>::max())
+              : zero_point != 0) {
+        TF_LITE_MAYBE_KERNEL_LOG(context,
+                                 "unsupported zero-point value %d in tensor "
+                                 "#%d in node #%d",
+                                 zero_point, tensor_index, node_index);
+        return kTfLiteError;
+      }
+    } else {
+      const int quantized_dimension = quantization_params->quantized_dimension;
+      if (expected_quantized_dimension < 0 ||
+          quantized_dimension != expected_quantized_dimension ||
+          quantized_dimension >= tensor.dims->size ||
+          tensor.dims->data[quantized_dimension] != num_scales) {
+        TF_LITE_MAYBE_KERNEL_LOG(
+            context,
+            "unsupported per-channel quantization with %d scales along "
+            "dimension %d in tensor #%d in node #%d",
+            num_scales, quantized_dimension, tensor_index, node_index);
+        return kTfLiteError;
+      }
+      for (int c = 0; c < num_scales; c++) {
+        if (quantization_params->zero_point->data[c] != 0) {
+          TF_LITE_MAYBE_KERNEL_LOG(
+              context,
+              "unsupported zero-point value %d in channel %d of tensor #%d "
+              "in node #%d",
+              quantization_params->zero_point->data[c], c, tensor_index,
+              node_index);
+          return kTfLiteError;
+        }
+      }
+    }
+
+    for (int c = 0; c < num_scales; c++) {
+      const float scale = quantization_params->scale->data[c];
+      if (!std::isnormal(scale) || scale <= 0.0f) {
+        TF_LITE_MAYBE_KERNEL_LOG(
+            context, "unsupported scale value (%f) in tensor #%d in node #%d",
+            scale, tensor_index, node_index);
+        return kTfLiteError;
+      }
+    }
+    return kTfLiteOk;
+  }
+
+  static TfLiteStatus CheckTensorFloat32OrQInt8Type(const Delegate& delegate,
+                                                    TfLiteContext* context,
+                                                    const TfLiteTensor& tensor,
+                                                    int tensor_index,
+                                                    int node_index) {
+    return CheckTensorFloat32OrQCInt8Type(
+        delegate, context, tensor, /*expected_quantized_dimension=*/-1,
+        tensor_index, node_index);
+  }
+
+  static TfLiteStatus CheckTensorFloat32OrQCInt8Type(
+      const Delegate& delegate, TfLiteContext* context,
+      const TfLiteTensor& tensor, int expected_quantized_dimension,
+      int tensor_index, int node_index) {
+    if (tensor.type == kTfLiteInt8 &&
+        delegate.support_signed_8bit_quantization()) {
+      return CheckTensorQuantization(context, tensor,
+                                     expected_quantized_dimension,
+                                     tensor_index, node_index);
+    }
+    return CheckTensorFloatType(context, tensor, tensor_index, node_index);
+  }
+
+  // Bias tensors of quantized operators are 32-bit integers quantized with
+  // zero zero-point, either per-tensor or per-channel along dimension 0.
+  static TfLiteStatus CheckTensorFloat32OrQCInt32Type(
+      const Delegate& delegate, TfLiteContext* context,
+      const TfLiteTensor& tensor, int tensor_index, int node_index) {
+    if (tensor.type == kTfLiteInt32 &&
+        delegate.support_signed_8bit_quantization()) {
+      return CheckTensorQuantization(context, tensor,
+                                     /*expected_quantized_dimension=*/0,
+                                     tensor_index, node_index);
+    }
+    return CheckTensorFloatType(context, tensor, tensor_index, node_index);
+  }
+
+  // XNNPACK has no hybrid operators: the tensors of a node must be either all
+  // floating-point, or all quantized with INT32 bias.
+  static TfLiteType ExpectedBiasType(const TfLiteTensor& input_tensor) {
+    return input_tensor.type == kTfLiteInt8 ? kTfLiteInt32 : kTfLiteFloat32;
+  }
+
+  // Checks that the bias of a quantized convolution or fully connected
+  // operator is quantized the same way as its filter (per-tensor or
+  // per-channel), and that the requantization scales are within the range
+  // supported by XNNPACK.
+  static TfLiteStatus CheckConvolutionQuantization(
+      TfLiteContext* context, const TfLiteTensor& input_tensor,
+      const TfLiteTensor& filter_tensor, const TfLiteTensor& bias_tensor,
+      const TfLiteTensor& output_tensor, int node_index) {
+    if (input_tensor.type != kTfLiteInt8) {
+      return kTfLiteOk;
+    }
+    const TfLiteFloatArray* filter_scales =
+        GetAffineQuantization(filter_tensor)->scale;
+    const TfLiteFloatArray* bias_scales =
+        GetAffineQuantization(bias_tensor)->scale;
+    if (filter_scales->size != bias_scales->size) {
+      TF_LITE_MAYBE_KERNEL_LOG(
+          context,
+          "mismatching number of quantization scales in filter (%d) and "
+          "bias (%d) tensors in node #%d",
+          filter_scales->size, bias_scales->size, node_index);
+      return kTfLiteError;
+    }
+    const float input_scale = GetTensorScale(input_tensor);
+    const float output_scale = GetTensorScale(output_tensor);
+    for (int c = 0; c < filter_scales->size; c++) {
+      const float requantization_scale =
+          input_scale * filter_scales->data[c] / output_scale;
+      if (requantization_scale < 0x1.0p-32f ||
+          requantization_scale >= 256.0f) {
+        TF_LITE_MAYBE_KERNEL_LOG(
+            context, "unsupported requantization scale %f in node #%d",
+            requantization_scale, node_index);
+        return kTfLiteError;
+      }
+    }
+    return kTfLiteOk;
+  }
+
+  static float GetTensorScale(const TfLiteTensor& tensor) {
+    return GetAffineQuantization(tensor)->scale->data[0];
+  }
+
   static TfLiteStatus CheckTensorShape(TfLiteContext* context,
                                        const TfLiteTensor& tensor,
                                        int min_num_dims, int max_num_dims,
@@ -810,7 +1054,7 @@ class Subgraph {
   }
 
   static TfLiteStatus VisitNode(
-      xnn_subgraph_t subgraph, TfLiteContext* context,
+      xnn_subgraph_t subgraph, const Delegate& delegate, TfLiteContext* context,
       TfLiteRegistration* registration, TfLiteNode* node, int node_index,
       const std::unordered_set<int>& quasi_static_tensors,
       const std::vector<uint32_t>& xnnpack_tensors) {
@@ -828,8 +1072,9 @@ class Subgraph {
         const TfLiteAddParams* add_params =
             static_cast<const TfLiteAddParams*>(node->builtin_data);
 
-        return VisitAddNode(subgraph, logging_context, node_index, node,
-                            context->tensors, add_params, xnnpack_tensors);
+        return VisitAddNode(subgraph, delegate, logging_context, node_index,
+                            node, context->tensors, add_params,
+                            xnnpack_tensors);
       }
       case kTfLiteBuiltinAveragePool2d: {
         const TfLitePoolParams* pool_params =
@@ -846,17 +1091,18 @@ class Subgraph {
         const TfLiteConvParams* conv_params =
             static_cast<const TfLiteConvParams*>(node->builtin_data);
 
-        return VisitConv2DNode(subgraph, logging_context, node_index, node,
-                               context->tensors, conv_params,
+        return VisitConv2DNode(subgraph, delegate, logging_context, node_index,
+                               node, context->tensors, conv_params,
                                quasi_static_tensors, xnnpack_tensors);
       }
       case kTfLiteBuiltinDepthwiseConv2d: {
         const TfLiteDepthwiseConvParams* dwconv_params =
             static_cast<const TfLiteDepthwiseConvParams*>(node->builtin_data);
 
-        return VisitDepthwiseConv2DNode(subgraph, logging_context, node_index,
-                                        node, context->tensors, dwconv_params,
-                                        quasi_static_tensors, xnnpack_tensors);
+        return VisitDepthwiseConv2DNode(
+            subgraph, delegate, logging_context, node_index, node,
+            context->tensors, dwconv_params, quasi_static_tensors,
+            xnnpack_tensors);
       }
       case kTfLiteBuiltinDepthToSpace: {
         const TfLiteDepthToSpaceParams* depth_to_space_params =
@@ -889,9 +1135,10 @@ class Subgraph {
         const TfLiteFullyConnectedParams* fc_params =
             static_cast<const TfLiteFullyConnectedParams*>(node->builtin_data);
 
-        return VisitFullyConnectedNode(subgraph, logging_context, node_index,
-                                       node, context->tensors, fc_params,
-                                       quasi_static_tensors, xnnpack_tensors);
+        return VisitFullyConnectedNode(
+            subgraph, delegate, logging_context, node_index, node,
+            context->tensors, fc_params, quasi_static_tensors,
+            xnnpack_tensors);
       }
       case kTfLiteBuiltinFloor:
         return VisitFloorNode(subgraph, logging_context, node_index, node,
@@ -935,8 +1182,9 @@ class Subgraph {
         const TfLiteMulParams* mul_params =
             static_cast<const TfLiteMulParams*>(node->builtin_data);
 
-        return VisitMulNode(subgraph, logging_context, node_index, node,
-                            context->tensors, mul_params, xnnpack_tensors);
+        return VisitMulNode(subgraph, delegate, logging_context, node_index,
+                            node, context->tensors, mul_params,
+                            xnnpack_tensors);
       }
       case kTfLiteBuiltinNeg:
         return VisitNegNode(subgraph, logging_context, node_index, node,
@@ -1071,30 +1319,55 @@ class Subgraph {
   }
 
   static TfLiteStatus VisitAddNode(
-      xnn_subgraph_t subgraph, TfLiteContext* logging_context, int node_index,
-      TfLiteNode* node, const TfLiteTensor* tensors,
-      const TfLiteAddParams* add_params,
+      xnn_subgraph_t subgraph, const Delegate& delegate,
+      TfLiteContext* logging_context, int node_index, TfLiteNode* node,
+      const TfLiteTensor* tensors, const TfLiteAddParams* add_params,
       const std::vector<uint32_t>& xnnpack_tensors) {
     TF_LITE_ENSURE_STATUS(
         CheckNumInputsAndOutputs(logging_context, node, 2, 1, node_index));
 
     const TfLiteTensor& input1_tensor = tensors[node->inputs->data[0]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, input1_tensor, node->inputs->data[0], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorFloat32OrQInt8Type(
+        delegate, logging_context, input1_tensor, node->inputs->data[0],
+        node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
         logging_context, input1_tensor, node->inputs->data[0], node_index));
 
     const TfLiteTensor& input2_tensor = tensors[node->inputs->data[1]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, input2_tensor, node->inputs->data[1], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorType(logging_context, input2_tensor,
+                                          input1_tensor.type,
+                                          node->inputs->data[1], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorFloat32OrQInt8Type(
+        delegate, logging_context, input2_tensor, node->inputs->data[1],
+        node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
         logging_context, input2_tensor, node->inputs->data[1], node_index));
 
     const TfLiteTensor& output_tensor = tensors[node->outputs->data[0]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, output_tensor, node->outputs->data[0], node_index));
-    TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
-        logging_context, output_tensor, node->outputs->data[0], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorType(logging_context, output_tensor,
+                                          input1_tensor.type,
+                                          node->outputs->data[0], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorFloat32OrQInt8Type(
+        delegate, logging_context, output_tensor, node->outputs->data[0],
+        node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
+        logging_context, output_tensor, node->outputs->data[0], node_index));
+
+    if (input1_tensor.type == kTfLiteInt8) {
+      const float output_scale = GetTensorScale(output_tensor);
+      const float input1_output_scale =
+          GetTensorScale(input1_tensor) / output_scale;
+      const float input2_output_scale =
+          GetTensorScale(input2_tensor) / output_scale;
+      if (input1_output_scale < 0x1.0p-10f || input1_output_scale >= 256.0f ||
+          input2_output_scale < 0x1.0p-10f || input2_output_scale >= 256.0f) {
+        TF_LITE_MAYBE_KERNEL_LOG(
+            logging_context,
+            "unsupported input-to-output scale ratios (%f, %f) in ADD node #%d",
+            input1_output_scale, input2_output_scale, node_index);
+        return kTfLiteError;
+      }
+    }
 
     float output_min = -std::numeric_limits<float>::infinity();
     float output_max = +std::numeric_limits<float>::infinity();
@@ -1220,9 +1493,9 @@ class Subgraph {
   }
 
   static TfLiteStatus VisitConv2DNode(
-      xnn_subgraph_t subgraph, TfLiteContext* logging_context, int node_index,
-      TfLiteNode* node, const TfLiteTensor* tensors,
-      const TfLiteConvParams* conv_params,
+      xnn_subgraph_t subgraph, const Delegate& delegate,
+      TfLiteContext* logging_context, int node_index, TfLiteNode* node,
+      const TfLiteTensor* tensors, const TfLiteConvParams* conv_params,
       const std::unordered_set<int>& quasi_static_tensors,
       const std::vector<uint32_t>& xnnpack_tensors) {
     TF_LITE_ENSURE_STATUS(
@@ -1232,16 +1505,22 @@ class Subgraph {
         CheckNumInputsAndOutputs(logging_context, node, 3, 1, node_index));
 
     const TfLiteTensor& input_tensor = tensors[node->inputs->data[0]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, input_tensor, node->inputs->data[0], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorFloat32OrQInt8Type(
+        delegate, logging_context, input_tensor, node->inputs->data[0],
+        node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, input_tensor, 4,
                                            node->inputs->data[0]));
     TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
         logging_context, input_tensor, node->inputs->data[0], node_index));
 
     const TfLiteTensor& filter_tensor = tensors[node->inputs->data[1]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, filter_tensor, node->inputs->data[1], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorType(logging_context, filter_tensor,
+                                          input_tensor.type,
+                                          node->inputs->data[1], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorFloat32OrQCInt8Type(
+        delegate, logging_context, filter_tensor,
+        /*expected_quantized_dimension=*/0, node->inputs->data[1],
+        node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, filter_tensor, 4,
                                            node->inputs->data[1]));
     if (quasi_static_tensors.count(node->inputs->data[1]) == 0) {
@@ -1257,8 +1536,12 @@ class Subgraph {
       return kTfLiteError;
     }
     const TfLiteTensor& bias_tensor = tensors[bias_tensor_id];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, bias_tensor, node->inputs->data[2], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorType(
+        logging_context, bias_tensor, ExpectedBiasType(input_tensor),
+        node->inputs->data[2], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorFloat32OrQCInt32Type(
+        delegate, logging_context, bias_tensor, node->inputs->data[2],
+        node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, bias_tensor, 1,
                                            node->inputs->data[2]));
     if (quasi_static_tensors.count(node->inputs->data[2]) == 0) {
@@ -1267,8 +1550,12 @@ class Subgraph {
     }
 
     const TfLiteTensor& output_tensor = tensors[node->outputs->data[0]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, output_tensor, node->outputs->data[0], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorType(logging_context, output_tensor,
+                                          input_tensor.type,
+                                          node->outputs->data[0], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorFloat32OrQInt8Type(
+        delegate, logging_context, output_tensor, node->outputs->data[0],
+        node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, output_tensor, 4,
                                            node->outputs->data[0]));
     TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
@@ -1283,6 +1570,10 @@ class Subgraph {
     TF_LITE_ENSURE_STATUS(CalculatePadding(
         logging_context, conv_params->padding, &flags, node_index));
 
+    TF_LITE_ENSURE_STATUS(CheckConvolutionQuantization(
+        logging_context, input_tensor, filter_tensor, bias_tensor,
+        output_tensor, node_index));
+
     float output_min = -std::numeric_limits<float>::infinity();
     float output_max = +std::numeric_limits<float>::infinity();
     TF_LITE_ENSURE_STATUS(ConvertActivationToOutputRange(
@@ -1318,8 +1609,9 @@ class Subgraph {
   }
 
   static TfLiteStatus VisitDepthwiseConv2DNode(
-      xnn_subgraph_t subgraph, TfLiteContext* logging_context, int node_index,
-      TfLiteNode* node, const TfLiteTensor* tensors,
+      xnn_subgraph_t subgraph, const Delegate& delegate,
+      TfLiteContext* logging_context, int node_index, TfLiteNode* node,
+      const TfLiteTensor* tensors,
       const TfLiteDepthwiseConvParams* dwconv_params,
       const std::unordered_set<int>& quasi_static_tensors,
       const std::vector<uint32_t>& xnnpack_tensors) {
@@ -1327,16 +1619,22 @@ class Subgraph {
         CheckNumInputsAndOutputs(logging_context, node, 3, 1, node_index));
 
     const TfLiteTensor& input_tensor = tensors[node->inputs->data[0]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, input_tensor, node->inputs->data[0], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorFloat32OrQInt8Type(
+        delegate, logging_context, input_tensor, node->inputs->data[0],
+        node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, input_tensor, 4,
                                            node->inputs->data[0]));
     TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
         logging_context, input_tensor, node->inputs->data[0], node_index));
 
     const TfLiteTensor& filter_tensor = tensors[node->inputs->data[1]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, filter_tensor, node->inputs->data[1], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorType(logging_context, filter_tensor,
+                                          input_tensor.type,
+                                          node->inputs->data[1], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorFloat32OrQCInt8Type(
+        delegate, logging_context, filter_tensor,
+        /*expected_quantized_dimension=*/3, node->inputs->data[1],
+        node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, filter_tensor, 4,
                                            node->inputs->data[1]));
     if (quasi_static_tensors.count(node->inputs->data[1]) == 0) {
@@ -1352,8 +1650,12 @@ class Subgraph {
       return kTfLiteError;
     }
     const TfLiteTensor& bias_tensor = tensors[bias_tensor_id];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, bias_tensor, node->inputs->data[2], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorType(
+        logging_context, bias_tensor, ExpectedBiasType(input_tensor),
+        node->inputs->data[2], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorFloat32OrQCInt32Type(
+        delegate, logging_context, bias_tensor, node->inputs->data[2],
+        node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, bias_tensor, 1,
                                            node->inputs->data[2]));
     if (quasi_static_tensors.count(node->inputs->data[2]) == 0) {
@@ -1362,8 +1664,12 @@ class Subgraph {
     }
 
     const TfLiteTensor& output_tensor = tensors[node->outputs->data[0]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, output_tensor, node->outputs->data[0], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorType(logging_context, output_tensor,
+                                          input_tensor.type,
+                                          node->outputs->data[0], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorFloat32OrQInt8Type(
+        delegate, logging_context, output_tensor, node->outputs->data[0],
+        node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, output_tensor, 4,
                                            node->outputs->data[0]));
     TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
@@ -1380,6 +1686,10 @@ class Subgraph {
     TF_LITE_ENSURE_STATUS(CalculatePadding(
         logging_context, dwconv_params->padding, &flags, node_index));
 
+    TF_LITE_ENSURE_STATUS(CheckConvolutionQuantization(
+        logging_context, input_tensor, filter_tensor, bias_tensor,
+        output_tensor, node_index));
+
     float output_min = -std::numeric_limits<float>::infinity();
     float output_max = +std::numeric_limits<float>::infinity();
     TF_LITE_ENSURE_STATUS(ConvertActivationToOutputRange(
@@ -1550,9 +1860,9 @@ class Subgraph {
   }
 
   static TfLiteStatus VisitFullyConnectedNode(
-      xnn_subgraph_t subgraph, TfLiteContext* logging_context, int node_index,
-      TfLiteNode* node, const TfLiteTensor* tensors,
-      const TfLiteFullyConnectedParams* fc_params,
+      xnn_subgraph_t subgraph, const Delegate& delegate,
+      TfLiteContext* logging_context, int node_index, TfLiteNode* node,
+      const TfLiteTensor* tensors, const TfLiteFullyConnectedParams* fc_params,
       const std::unordered_set<int>& quasi_static_tensors,
       const std::vector<uint32_t>& xnnpack_tensors) {
     TF_LITE_ENSURE_STATUS(
@@ -1562,14 +1872,19 @@ class Subgraph {
         CheckNumInputsAndOutputs(logging_context, node, 3, 1, node_index));
 
     const TfLiteTensor& input_tensor = tensors[node->inputs->data[0]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, input_tensor, node->inputs->data[0], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorFloat32OrQInt8Type(
+        delegate, logging_context, input_tensor, node->inputs->data[0],
+        node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
         logging_context, input_tensor, node->inputs->data[0], node_index));
 
     const TfLiteTensor& filter_tensor = tensors[node->inputs->data[1]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, filter_tensor, node->inputs->data[1], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorType(logging_context, filter_tensor,
+                                          input_tensor.type,
+                                          node->inputs->data[1], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorFloat32OrQInt8Type(
+        delegate, logging_context, filter_tensor, node->inputs->data[1],
+        node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, filter_tensor, 2,
                                            node->inputs->data[1]));
     if (quasi_static_tensors.count(node->inputs->data[1]) == 0) {
@@ -1585,8 +1900,12 @@ class Subgraph {
       return kTfLiteError;
     }
     const TfLiteTensor& bias_tensor = tensors[bias_tensor_id];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, bias_tensor, node->inputs->data[2], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorType(
+        logging_context, bias_tensor, ExpectedBiasType(input_tensor),
+        node->inputs->data[2], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorFloat32OrQCInt32Type(
+        delegate, logging_context, bias_tensor, node->inputs->data[2],
+        node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, bias_tensor, 1,
                                            node->inputs->data[2]));
     if (quasi_static_tensors.count(node->inputs->data[2]) == 0) {
@@ -1595,8 +1914,12 @@ class Subgraph {
     }
 
     const TfLiteTensor& output_tensor = tensors[node->outputs->data[0]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, output_tensor, node->outputs->data[0], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorType(logging_context, output_tensor,
+                                          input_tensor.type,
+                                          node->outputs->data[0], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorFloat32OrQInt8Type(
+        delegate, logging_context, output_tensor, node->outputs->data[0],
+        node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
         logging_context, output_tensor, node->outputs->data[0], node_index));
 
@@ -1673,6 +1996,10 @@ class Subgraph {
       return kTfLiteError;
     }
 
+    TF_LITE_ENSURE_STATUS(CheckConvolutionQuantization(
+        logging_context, input_tensor, filter_tensor, bias_tensor,
+        output_tensor, node_index));
+
     float output_min = -std::numeric_limits<float>::infinity();
     float output_max = +std::numeric_limits<float>::infinity();
     TF_LITE_ENSURE_STATUS(ConvertActivationToOutputRange(
@@ -2279,31 +2606,53 @@ class Subgraph {
   }
 
   static TfLiteStatus VisitMulNode(
-      xnn_subgraph_t subgraph, TfLiteContext* logging_context, int node_index,
-      TfLiteNode* node, const TfLiteTensor* tensors,
-      const TfLiteMulParams* mul_params,
+      xnn_subgraph_t subgraph, const Delegate& delegate,
+      TfLiteContext* logging_context, int node_index, TfLiteNode* node,
+      const TfLiteTensor* tensors, const TfLiteMulParams* mul_params,
       const std::vector<uint32_t>& xnnpack_tensors) {
     TF_LITE_ENSURE_STATUS(
         CheckNumInputsAndOutputs(logging_context, node, 2, 1, node_index));
 
     const TfLiteTensor& input1_tensor = tensors[node->inputs->data[0]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, input1_tensor, node->inputs->data[0], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorFloat32OrQInt8Type(
+        delegate, logging_context, input1_tensor, node->inputs->data[0],
+        node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
         logging_context, input1_tensor, node->inputs->data[0], node_index));
 
     const TfLiteTensor& input2_tensor = tensors[node->inputs->data[1]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, input2_tensor, node->inputs->data[1], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorType(logging_context, input2_tensor,
+                                          input1_tensor.type,
+                                          node->inputs->data[1], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorFloat32OrQInt8Type(
+        delegate, logging_context, input2_tensor, node->inputs->data[1],
+        node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
         logging_context, input2_tensor, node->inputs->data[1], node_index));
 
     const TfLiteTensor& output_tensor = tensors[node->outputs->data[0]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, output_tensor, node->outputs->data[0], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorType(logging_context, output_tensor,
+                                          input1_tensor.type,
+                                          node->outputs->data[0], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorFloat32OrQInt8Type(
+        delegate, logging_context, output_tensor, node->outputs->data[0],
+        node_index));
     TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
         logging_context, output_tensor, node->outputs->data[0], node_index));
 
+    if (input1_tensor.type == kTfLiteInt8) {
+      const float product_output_scale = GetTensorScale(input1_tensor) *
+                                         GetTensorScale(input2_tensor) /
+                                         GetTensorScale(output_tensor);
+      if (product_output_scale < 0x1.0p-16f || product_output_scale >= 256.0f) {
+        TF_LITE_MAYBE_KERNEL_LOG(
+            logging_context,
+            "unsupported product-to-output scale ratio %f in MUL node #%d",
+            product_output_scale, node_index);
+        return kTfLiteError;
+      }
+    }
+
     float output_min = -std::numeric_limits<float>::infinity();
     float output_max = +std::numeric_limits<float>::infinity();
     if (mul_params != nullptr) {
@@ -3003,12 +3352,19 @@ TfLiteIntArray* Delegate::PrepareOpsToDelegate(TfLiteContext* context) {
       if (input_tensor.allocation_type == kTfLiteMmapRo &&
           input_tensor.sparsity != nullptr &&
           (input_tensor.type == kTfLiteFloat16 ||
-           input_tensor.type == kTfLiteFloat32) &&
+           input_tensor.type == kTfLiteFloat32 ||
+           (input_tensor.type == kTfLiteInt8 &&
+            support_signed_8bit_quantization())) &&
           output_tensor.type == input_tensor.type) {
         static_unpack_nodes_.insert(node_index);
         quasi_static_tensors_producers[node->outputs->data[0]] = node_index;
         quasi_static_tensors.insert(node->outputs->data[0]);
-        static_sparse_weights_.insert(node->outputs->data[0]);
+        // XNNPACK implements sparse inference only for floating-point
+        // operators: signed 8-bit weights are densified and then consumed by
+        // the dense quantized operators.
+        if (input_tensor.type != kTfLiteInt8) {
+          static_sparse_weights_.insert(node->outputs->data[0]);
+        }
 
         // Skip this node for now. If output of the node is consumed only by
         // delegated nodes, it will be added to nodes_to_delegate in the end.
@@ -3016,8 +3372,8 @@ TfLiteIntArray* Delegate::PrepareOpsToDelegate(TfLiteContext* context) {
       }
     }
 
-    if (Subgraph::VisitNode(/*subgraph=*/nullptr, context, registration, node,
-                            node_index, quasi_static_tensors,
+    if (Subgraph::VisitNode(/*subgraph=*/nullptr, *this, context, registration,
+                            node, node_index, quasi_static_tensors,
                             std::vector<uint32_t>()) != kTfLiteOk) {
       // If a non-delegated node consumes output of a node that unpacks static
       // data, that node shouldn't be delegated.
@@ -3112,6 +3468,9 @@ TfLiteIntArray* Delegate::PrepareOpsToDelegate(TfLiteContext* context) {
       case kTfLiteFloat16:
         tensor_elements /= sizeof(uint16_t);
         break;
+      case kTfLiteInt8:
+        tensor_elements /= sizeof(int8_t);
+        break;
       default: {
         TF_LITE_KERNEL_LOG(context,
                            "unexpected datatype (%s) in tensor %d in node %d",
@@ -3199,6 +3558,18 @@ TfLiteIntArray* Delegate::PrepareOpsToDelegate(TfLiteContext* context) {
                 dense_size, unpacked_fp16_data, context);
             break;
           }
+          case kTfLiteInt8: {
+            const size_t dense_size =
+                context->tensors[t].bytes / sizeof(int8_t);
+            int8_t* unpacked_int8_data =
+                reinterpret_cast<int8_t*>(unpacked_data);
+            tflite::optimize::sparsity::FormatConverter<int8_t> converter(
+                vector_shape, *input_tensor.sparsity);
+            converter.SparseToDense(
+                static_cast<const int8_t*>(input_tensor.data.data),
+                dense_size, unpacked_int8_data, context);
+            break;
+          }
           default: {
             TF_LITE_KERNEL_LOG(
                 context, "unexpected tensor %d data type (%s) in node %d",
@@ -3309,6 +3680,9 @@ TfLiteStatus DelegatePrepare(TfLiteContext* context, TfLiteDelegate* delegate) {
 
 TfLiteXNNPackDelegateOptions TfLiteXNNPackDelegateOptionsDefault() {
   TfLiteXNNPackDelegateOptions options = {0};
+#ifdef XNNPACK_DELEGATE_ENABLE_QS8
+  options.flags |= TFLITE_XNNPACK_DELEGATE_FLAG_QS8;
+#endif
   return options;
 }
 
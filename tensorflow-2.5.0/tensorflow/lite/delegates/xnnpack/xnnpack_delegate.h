@@ -22,10 +22,17 @@ limitations under the License.
 extern "C" {
 #endif  // __cplusplus
 
+// Enable XNNPACK acceleration for signed quantized 8-bit inference.
+// This includes operators with channel-wise quantized weights.
+#define TFLITE_XNNPACK_DELEGATE_FLAG_QS8 0x00000001
+
 typedef struct {
   // Number of threads to use in the thread pool.
   // 0 or negative value means no thread pool used.
   int32_t num_threads;
+  // Bitfield with any combination of the following binary options:
+  // - TFLITE_XNNPACK_DELEGATE_FLAG_QS8
+  uint32_t flags;
 } TfLiteXNNPackDelegateOptions;
 
 // Returns a structure with the default XNNPack delegate options.
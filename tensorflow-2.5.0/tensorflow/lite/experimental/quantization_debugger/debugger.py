@@ -22,6 +22,7 @@ from typing import (Any, Callable, Dict, IO, Iterable, List, Mapping, Optional,
 import numpy as np
 import tensorflow as tf
 
+from tensorflow.lite.python.optimize import calibrator as _calibrator
 from tensorflow.python.util import tf_export
 
 # pylint: disable=g-import-not-at-top
@@ -123,6 +124,9 @@ class QuantizationDebugger:
     """
     self._data_gen = debug_dataset
     self._debug_options = debug_options or QuantizationDebugOptions()
+    self._float_model_path = float_model_path
+    self._float_model_content = float_model_content
+    self._float_interpreter = None
 
     input_data = next(iter(self._data_gen()))
     self._quant_interpreter = tf.lite.Interpreter(quant_debug_model_path,
@@ -159,6 +163,121 @@ class QuantizationDebugger:
     if self._debug_options.model_debug_metrics:
       self.model_statistics = self._collect_model_statistics()
 
+  def layer_sensitivity_ranking(
+      self,
+      metric_name: str = 'mean_square_error') -> List[Tuple[str, float]]:
+    """Ranks the quantized layers by their error, from largest to smallest.
+
+    The layers at the front of the ranking are the most sensitive to
+    quantization, and are the first candidates to keep in higher precision.
+    `mixed_precision_search` uses this ranking to choose the float layers.
+    `run` must have been called before.
+
+    Args:
+      metric_name: name of the layer debug metric to rank the layers by.
+
+    Returns:
+      a list of (layer_name, metric) tuples, in decreasing order of metric.
+
+    Raises:
+      ValueError: when the debugger has not been run, or `metric_name` is not a
+      layer debug metric.
+    """
+    if self.layer_statistics is None:
+      raise ValueError('Call run() before ranking the layers.')
+    if metric_name not in self._layer_debug_metrics:
+      raise ValueError('Unknown layer debug metric: {}'.format(metric_name))
+    ranking = [(name, metrics[metric_name])
+               for name, metrics in self.layer_statistics.items()]
+    return sorted(ranking, key=lambda item: item[1], reverse=True)
+
+  def mixed_precision_search(
+      self,
+      metric_fn: Callable[[Sequence[np.ndarray], Sequence[np.ndarray]], float],
+      max_error: float,
+      max_float_layers: Optional[int] = None,
+      ranking_metric: str = 'mean_square_error') -> Tuple[bytes, List[str]]:
+    """Chooses the layers to keep in float and quantizes the others to int8.
+
+    The search is greedy: it starts with every layer quantized, and keeps the
+    layers in float one at a time, in the order of
+    `layer_sensitivity_ranking`, until the model error is at most `max_error`
+    or `max_float_layers` layers are in float. All the candidates are quantized
+    from the same calibration of the float model on the debug dataset.
+
+    The search only chooses between int8 and float: the quantizer uses one
+    activation type for the whole model, so int16 activations can't be mixed
+    with int8 ones. It doesn't measure latency either; `max_float_layers`
+    bounds how much of the model stays in float instead.
+    `run` must have been called before, and the debugger must have been given
+    the float model.
+
+    Args:
+      metric_fn: a function which accepts the outputs of the float model and of
+        a quantized candidate, and returns their error as a scalar. It is
+        averaged over the debug dataset.
+      max_error: the largest acceptable model error.
+      max_float_layers: the largest number of layers to keep in float, or None
+        to allow all of them.
+      ranking_metric: name of the layer debug metric to rank the layers by.
+
+    Returns:
+      a tuple of the quantized model content and the list of output tensor
+      names of the layers kept in float, from the most sensitive one.
+
+    Raises:
+      ValueError: when the debugger has not been run, or has no float model.
+    """
+    if self._float_model_content is None and self._float_model_path is None:
+      raise ValueError('The search needs the float model.')
+    ranking = [
+        self._get_operand_name_and_index(name)[0]
+        for name, _ in self.layer_sensitivity_ranking(ranking_metric)
+    ]
+    if max_float_layers is None or max_float_layers > len(ranking):
+      max_float_layers = len(ranking)
+
+    float_model_content = self._float_model_content
+    if float_model_content is None:
+      with open(self._float_model_path, 'rb') as f:
+        float_model_content = f.read()
+    quantizer = _calibrator.Calibrator(float_model_content)
+    quantizer.calibrate(self._data_gen)
+
+    num_float_layers = 0
+    while True:
+      quant_model = quantizer.quantize_ops(tf.float32, tf.float32,
+                                           ranking[num_float_layers:])
+      if (num_float_layers == max_float_layers or
+          self._model_error(quant_model, metric_fn) <= max_error):
+        return quant_model, ranking[:num_float_layers]
+      num_float_layers += 1
+
+  def _model_error(
+      self, quant_model_content: bytes,
+      metric_fn: Callable[[Sequence[np.ndarray], Sequence[np.ndarray]], float]
+  ) -> float:
+    """Returns the mean of `metric_fn` over the debug dataset."""
+    if self._float_interpreter is None:
+      self._float_interpreter = tf.lite.Interpreter(self._float_model_path,
+                                                    self._float_model_content)
+    quant_interpreter = tf.lite.Interpreter(
+        model_content=quant_model_content)
+    errors = []
+    initialize = True
+    for tensor_data in self._data_gen():
+      self._set_input_tensors(quant_interpreter, tensor_data, initialize)
+      self._set_input_tensors(self._float_interpreter, tensor_data, initialize)
+      initialize = False
+
+      quant_interpreter.invoke()
+      self._float_interpreter.invoke()
+      errors.append(
+          metric_fn(
+              self._get_output_tensors(self._float_interpreter),
+              self._get_output_tensors(quant_interpreter)))
+    return np.mean(errors)
+
   def _collect_layer_statistics(self) -> Dict[str, Dict[str, float]]:
     """Collects layer statistics by applying layer debug metrics.
 
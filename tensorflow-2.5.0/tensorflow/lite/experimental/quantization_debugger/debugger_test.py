@@ -185,6 +185,61 @@ class QuantizationDebuggerTest(test_util.TensorFlowTestCase,
     for key, value in expected_metrics.items():
       self.assertAlmostEqual(value, actual_metrics[key], places=5)
 
+  @test_util.run_v2_only
+  def test_quantization_debugger_layer_sensitivity_ranking(self):
+    quant_debugger = debugger.QuantizationDebugger(
+        quant_debug_model_content=QuantizationDebuggerTest.debug_model_float,
+        debug_dataset=_calibration_gen)
+    with self.assertRaisesRegex(ValueError, 'Call run()'):
+      quant_debugger.layer_sensitivity_ranking()
+    quant_debugger.run()
+
+    ranking = quant_debugger.layer_sensitivity_ranking('max_abs_error')
+    self.assertLen(ranking, 1)
+    name, metric = ranking[0]
+    self.assertIn(name, quant_debugger.layer_statistics)
+    self.assertAlmostEqual(0.10039272, metric, places=5)
+    with self.assertRaisesRegex(ValueError, 'Unknown layer debug metric'):
+      quant_debugger.layer_sensitivity_ranking('l1_norm')
+
+  @test_util.run_v2_only
+  def test_quantization_debugger_mixed_precision_search(self):
+    quant_debugger = debugger.QuantizationDebugger(
+        quant_debug_model_content=QuantizationDebuggerTest.debug_model_float,
+        float_model_content=QuantizationDebuggerTest.float_model,
+        debug_dataset=_calibration_gen)
+    quant_debugger.run()
+    layer_name = quant_debugger._get_operand_name_and_index(  # pylint: disable=protected-access
+        quant_debugger.layer_sensitivity_ranking()[0][0])[0]
+    max_abs_error = lambda x, y: np.max(np.abs(x[0] - y[0]))
+
+    # The quantized model is accurate enough.
+    quant_model, float_layers = quant_debugger.mixed_precision_search(
+        max_abs_error, max_error=1.0)
+    self.assertEmpty(float_layers)
+    self.assertIsNotNone(quant_model)
+
+    # No error is small enough, so the only layer is kept in float.
+    quant_model, float_layers = quant_debugger.mixed_precision_search(
+        max_abs_error, max_error=-1.0)
+    self.assertEqual([layer_name], float_layers)
+
+    # The budget of float layers stops the search.
+    _, float_layers = quant_debugger.mixed_precision_search(
+        max_abs_error, max_error=-1.0, max_float_layers=0)
+    self.assertEmpty(float_layers)
+
+  @test_util.run_v2_only
+  def test_quantization_debugger_search_without_float_model_raises_ValueError(
+      self):
+    quant_debugger = debugger.QuantizationDebugger(
+        quant_debug_model_content=QuantizationDebuggerTest.debug_model_float,
+        debug_dataset=_calibration_gen)
+    quant_debugger.run()
+    with self.assertRaisesRegex(ValueError, 'needs the float model'):
+      quant_debugger.mixed_precision_search(
+          lambda x, y: 0.0, max_error=0.0)
+
   @test_util.run_v2_only
   def test_quantization_debugger_wrong_input_raises_ValueError(self):
 
@@ -0,0 +1,87 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_INTER_OP_THREAD_POOL_H_
+#define TENSORFLOW_LITE_INTER_OP_THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "tensorflow/lite/external_cpu_backend_context.h"
+
+namespace tflite {
+
+// A thread pool executing independent nodes of a graph concurrently.
+//
+// Tasks run on the thread calling Run() and on num_threads() - 1 worker
+// threads. Since a CPU backend context can't be used by several threads at
+// once, each worker thread comes with its own one, which kernels running on
+// that thread are to use instead of the interpreter's.
+class InterOpThreadPool {
+ public:
+  // Creates a pool of 'num_threads' threads, including the calling thread.
+  explicit InterOpThreadPool(int num_threads);
+  ~InterOpThreadPool();
+  InterOpThreadPool(const InterOpThreadPool&) = delete;
+  InterOpThreadPool& operator=(const InterOpThreadPool&) = delete;
+
+  int num_threads() const { return workers_.size() + 1; }
+
+  // Calls 'task(i, thread)' for each i in [0, num_tasks) and returns once all
+  // calls returned. 'thread' identifies the thread running the task, 0 being
+  // the calling thread. Must not be called concurrently or from a task.
+  void Run(int num_tasks, const std::function<void(int, int)>& task);
+
+  // Returns the CPU backend context of worker 'thread', in
+  // [1, num_threads()).
+  ExternalCpuBackendContext* cpu_backend_context(int thread) {
+    return cpu_backend_contexts_[thread - 1].get();
+  }
+
+ private:
+  // Runs tasks of the current Run() call until none are left.
+  void RunTasks(int thread);
+
+  void WorkerLoop(int thread);
+
+  std::vector<std::thread> workers_;
+  std::vector<std::unique_ptr<ExternalCpuBackendContext>>
+      cpu_backend_contexts_;
+
+  std::mutex mutex_;
+  // Signals workers that a Run() call started, or that they should exit.
+  std::condition_variable work_cv_;
+  // Signals Run() that all workers are done with its tasks.
+  std::condition_variable done_cv_;
+  // Incremented by each Run() call.
+  int64_t generation_ = 0;
+  int busy_workers_ = 0;
+  bool exit_ = false;
+
+  // State of the current Run() call.
+  const std::function<void(int, int)>* task_ = nullptr;
+  int num_tasks_ = 0;
+  std::atomic<int> next_task_{0};
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_INTER_OP_THREAD_POOL_H_
@@ -19,6 +19,7 @@ limitations under the License.
 #include <stdlib.h>
 
 #include <cstdint>
+#include <cstring>
 #include <functional>
 #include <memory>
 #include <utility>
@@ -248,6 +249,7 @@ void Interpreter::AddSubgraphs(int subgraphs_to_add,
   for (int i = 0; i < subgraphs_to_add; ++i) {
     Subgraph* subgraph = new Subgraph(error_reporter_, external_contexts_,
                                       &subgraphs_, &resources_);
+    subgraph->SetInterOpThreadPool(inter_op_thread_pool_.get());
     subgraphs_.emplace_back(subgraph);
   }
 }
@@ -295,6 +297,160 @@ TfLiteStatus Interpreter::Invoke() {
   return kTfLiteOk;
 }
 
+TfLiteStatus Interpreter::BatchInvoke(
+    const std::vector<std::vector<const void*>>& request_inputs,
+    const std::vector<std::vector<void*>>& request_outputs,
+    bool rows_are_independent) {
+  TfLiteContext* context = primary_subgraph().context();
+  const int num_requests = request_inputs.size();
+  TF_LITE_ENSURE(context, request_outputs.size() == request_inputs.size());
+  for (int r = 0; r < num_requests; ++r) {
+    TF_LITE_ENSURE(context, request_inputs[r].size() == inputs().size());
+    TF_LITE_ENSURE(context, request_outputs[r].size() == outputs().size());
+  }
+  for (int tensor_index : inputs()) {
+    TF_LITE_ENSURE(context,
+                   tensor(tensor_index)->allocation_type != kTfLiteDynamic);
+  }
+  for (int tensor_index : outputs()) {
+    TF_LITE_ENSURE(context,
+                   tensor(tensor_index)->allocation_type != kTfLiteDynamic);
+  }
+  if (num_requests == 0) {
+    return kTfLiteOk;
+  }
+
+  // The sizes of the tensors of a single request.
+  std::vector<size_t> input_bytes;
+  std::vector<std::vector<int>> input_dims;
+  for (int tensor_index : inputs()) {
+    const TfLiteTensor* input = tensor(tensor_index);
+    input_bytes.push_back(input->bytes);
+    input_dims.emplace_back(input->dims->data,
+                            input->dims->data + input->dims->size);
+  }
+  std::vector<size_t> output_bytes;
+  for (int tensor_index : outputs()) {
+    output_bytes.push_back(tensor(tensor_index)->bytes);
+  }
+
+  ScopedRuntimeInstrumentationProfile scoped_runtime_event(installed_profiler_,
+                                                           "batch_invoke");
+  if (num_requests == 1 || !rows_are_independent ||
+      !BatchInputs(num_requests)) {
+    for (int r = 0; r < num_requests; ++r) {
+      for (size_t i = 0; i < inputs().size(); ++i) {
+        TfLiteTensor* input = tensor(inputs()[i]);
+        if (input->bytes == 0) continue;
+        TF_LITE_ENSURE(context, input->data.raw != nullptr);
+        std::memcpy(input->data.raw, request_inputs[r][i], input->bytes);
+      }
+      TF_LITE_ENSURE_STATUS_WITH_SCOPED_INSTRUMENTATION(
+          scoped_runtime_event, primary_subgraph().Invoke());
+      for (size_t i = 0; i < outputs().size(); ++i) {
+        TF_LITE_ENSURE_STATUS_WITH_SCOPED_INSTRUMENTATION(
+            scoped_runtime_event,
+            primary_subgraph().EnsureTensorDataIsReadable(outputs()[i]));
+        const TfLiteTensor* output = tensor(outputs()[i]);
+        TF_LITE_ENSURE(context, output->allocation_type != kTfLiteDynamic);
+        if (output->bytes == 0) continue;
+        std::memcpy(request_outputs[r][i], output->data.raw, output->bytes);
+      }
+    }
+    return kTfLiteOk;
+  }
+
+  // Batched along the first dimension, request `r` is the `r`-th contiguous
+  // slice of each tensor, so it's copied in and out directly.
+  TfLiteStatus status = kTfLiteOk;
+  for (size_t i = 0; i < inputs().size() && status == kTfLiteOk; ++i) {
+    char* data = tensor(inputs()[i])->data.raw;
+    if (input_bytes[i] == 0) continue;
+    if (data == nullptr) {
+      status = kTfLiteError;
+      break;
+    }
+    for (int r = 0; r < num_requests; ++r) {
+      std::memcpy(data + r * input_bytes[i], request_inputs[r][i],
+                  input_bytes[i]);
+    }
+  }
+  if (status == kTfLiteOk) {
+    status = primary_subgraph().Invoke();
+  }
+  for (size_t i = 0; i < outputs().size() && status == kTfLiteOk; ++i) {
+    status = primary_subgraph().EnsureTensorDataIsReadable(outputs()[i]);
+    const TfLiteTensor* output = tensor(outputs()[i]);
+    if (status != kTfLiteOk || output_bytes[i] == 0) continue;
+    if (output->allocation_type == kTfLiteDynamic ||
+        output->bytes != num_requests * output_bytes[i]) {
+      status = kTfLiteError;
+      break;
+    }
+    for (int r = 0; r < num_requests; ++r) {
+      std::memcpy(request_outputs[r][i],
+                  output->data.raw + r * output_bytes[i], output_bytes[i]);
+    }
+  }
+
+  for (size_t i = 0; i < inputs().size(); ++i) {
+    TF_LITE_ENSURE_STATUS(ResizeInputTensor(inputs()[i], input_dims[i]));
+  }
+  TF_LITE_ENSURE_STATUS(AllocateTensors());
+  if (status != kTfLiteOk) {
+    scoped_runtime_event.set_runtime_status(/*delegate_status=*/0,
+                                            static_cast<int64_t>(status));
+  }
+  return status;
+}
+
+bool Interpreter::BatchInputs(int num_requests) {
+  if (!variables().empty()) {
+    // Requests would share the state of the variable tensors.
+    return false;
+  }
+  std::vector<std::vector<int>> input_dims;
+  for (int tensor_index : inputs()) {
+    const TfLiteIntArray* dims = tensor(tensor_index)->dims;
+    if (dims->size == 0) {
+      return false;
+    }
+    input_dims.emplace_back(dims->data, dims->data + dims->size);
+  }
+  std::vector<std::vector<int>> output_dims;
+  for (int tensor_index : outputs()) {
+    const TfLiteIntArray* dims = tensor(tensor_index)->dims;
+    if (dims->size == 0) {
+      return false;
+    }
+    output_dims.emplace_back(dims->data, dims->data + dims->size);
+  }
+
+  bool batched = true;
+  for (size_t i = 0; i < inputs().size() && batched; ++i) {
+    std::vector<int> dims = input_dims[i];
+    dims[0] *= num_requests;
+    batched = ResizeInputTensor(inputs()[i], dims) == kTfLiteOk;
+  }
+  batched = batched && AllocateTensors() == kTfLiteOk;
+  for (size_t i = 0; i < outputs().size() && batched; ++i) {
+    const TfLiteTensor* output = tensor(outputs()[i]);
+    std::vector<int> dims = output_dims[i];
+    dims[0] *= num_requests;
+    batched = output->allocation_type != kTfLiteDynamic &&
+              TfLiteIntArrayEqualsArray(output->dims, dims.size(), dims.data());
+  }
+  if (batched) {
+    return true;
+  }
+
+  for (size_t i = 0; i < inputs().size(); ++i) {
+    ResizeInputTensor(inputs()[i], input_dims[i]);
+  }
+  AllocateTensors();
+  return false;
+}
+
 TfLiteStatus Interpreter::AddTensors(int tensors_to_add,
                                      int* first_new_tensor_index) {
   return primary_subgraph().AddTensors(tensors_to_add, first_new_tensor_index);
@@ -367,6 +523,29 @@ TfLiteStatus Interpreter::SetNumThreads(int num_threads) {
   return kTfLiteOk;
 }
 
+TfLiteStatus Interpreter::SetNumInterOpThreads(int num_threads) {
+  if (num_threads < 1) {
+    context_->ReportError(context_, "num_threads should be >= 1.");
+    return kTfLiteError;
+  }
+
+  std::unique_ptr<InterOpThreadPool> thread_pool;
+  if (num_threads > 1) {
+    thread_pool.reset(new InterOpThreadPool(num_threads));
+  }
+  for (auto& subgraph : subgraphs_) {
+    if (subgraph->SetInterOpThreadPool(thread_pool.get()) != kTfLiteOk) {
+      for (auto& other_subgraph : subgraphs_) {
+        other_subgraph->SetInterOpThreadPool(inter_op_thread_pool_.get());
+      }
+      return kTfLiteError;
+    }
+  }
+  // Replaced only once no subgraph refers to the previous pool anymore.
+  inter_op_thread_pool_ = std::move(thread_pool);
+  return kTfLiteOk;
+}
+
 void Interpreter::SetAllowFp16PrecisionForFp32(bool allow) {
   for (auto& subgraph : subgraphs_) {
     subgraph->context()->allow_fp32_relax_to_fp16 = allow;
@@ -38,6 +38,7 @@ limitations under the License.
 #include "tensorflow/lite/core/subgraph.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
 #include "tensorflow/lite/external_cpu_backend_context.h"
+#include "tensorflow/lite/inter_op_thread_pool.h"
 #include "tensorflow/lite/memory_planner.h"
 #include "tensorflow/lite/portable_type_to_tflitetype.h"
 #include "tensorflow/lite/stderr_reporter.h"
@@ -439,6 +440,31 @@ class Interpreter {
   /// Returns status of success or failure.
   TfLiteStatus Invoke();
 
+  /// Runs independent requests through the graph. Request `i` reads input `j`
+  /// from `request_inputs[i][j]` and writes output `j` to
+  /// `request_outputs[i][j]`, each holding `input_tensor(j)->bytes` resp.
+  /// `output_tensor(j)->bytes` bytes.
+  ///
+  /// By default the requests are run one after the other, sharing the
+  /// weights and the arena plan. If `rows_are_independent` is true, the caller
+  /// asserts that every row along the first dimension of the outputs depends
+  /// only on the same row of the inputs, as for a model that runs each example
+  /// of a batch on its own. Then, when the graph has no variable tensors and
+  /// resizing the inputs to hold all requests scales the outputs accordingly,
+  /// the requests are concatenated and run with a single invocation, so that
+  /// kernels see the whole batch. Shapes alone can't tell whether a graph
+  /// mixes rows (e.g. a reduction over the batch followed by a broadcast), so
+  /// this must not be set for such graphs. Either way, the tensors have their
+  /// original shapes again when this returns.
+  ///
+  /// NOTE: The interpreter must be ready to Invoke(), and inputs and outputs
+  /// must not be dynamic tensors.
+  /// WARNING: This is an experimental API and subject to change.
+  TfLiteStatus BatchInvoke(
+      const std::vector<std::vector<const void*>>& request_inputs,
+      const std::vector<std::vector<void*>>& request_outputs,
+      bool rows_are_independent = false);
+
   /// Set the number of threads available to the interpreter.
   ///
   /// NOTE: num_threads should be >= -1.
@@ -446,6 +472,23 @@ class Interpreter {
   /// available to itself.
   TfLiteStatus SetNumThreads(int num_threads);
 
+  /// Set the number of threads, including the one calling Invoke(), on which
+  /// independent nodes of the graph are executed concurrently, e.g. the
+  /// branches of a multi-tower model. Kernels running on other threads than
+  /// the calling one are single threaded. Defaults to 1, executing nodes one
+  /// at a time.
+  ///
+  /// Nodes are reordered so that independent ones are adjacent in the
+  /// execution plan, which may make the interpreter use more memory. See
+  /// Subgraph::SetInterOpThreadPool() for the nodes that are never executed
+  /// concurrently. Custom ops must support being invoked concurrently with
+  /// other nodes.
+  ///
+  /// NOTE: num_threads should be >= 1. If tensors were allocated,
+  /// AllocateTensors() must be called again.
+  /// WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetNumInterOpThreads(int num_threads);
+
   /// Allow float16 precision for FP32 calculation when possible.
   /// Default: not allow.
   ///
@@ -678,6 +721,11 @@ class Interpreter {
   friend class tflite::delegates::InterpreterUtils;
   friend class tflite::delegates::test_utils::TestDelegate;
 
+  // Resizes the inputs to hold `num_requests` times their batch, and returns
+  // true if that scales the batch of all outputs the same way. Returns false,
+  // with the original shapes restored, if the requests can't be batched.
+  bool BatchInputs(int num_requests);
+
   /// Set the value of an external context.
   static void SetExternalContext(struct TfLiteContext* context,
                                  TfLiteExternalContextType type,
@@ -761,6 +809,10 @@ class Interpreter {
   // nullptr if necessary.
   std::unique_ptr<ExternalCpuBackendContext> own_external_cpu_backend_context_;
 
+  // Thread pool on which subgraphs execute independent nodes concurrently, if
+  // any. Declared before `subgraphs_` to outlive them.
+  std::unique_ptr<InterOpThreadPool> inter_op_thread_pool_;
+
   // Subgraphs
   std::vector<std::unique_ptr<Subgraph>> subgraphs_;
 
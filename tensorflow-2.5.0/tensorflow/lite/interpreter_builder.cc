@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/lite/core/subgraph.h"
 #include "tensorflow/lite/interpreter.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
+#include "tensorflow/lite/memory_planner.h"
 #include "tensorflow/lite/model_builder.h"
 #include "tensorflow/lite/profiling/platform_profiler.h"
 #include "tensorflow/lite/schema/schema_generated.h"
@@ -141,6 +142,58 @@ std::map<std::string, uint32_t> GetMapFromTensorMap(
   return result;
 }
 
+// Returns, for each subgraph of the model, whether it can be run from the
+// primary subgraph through control flow ops.
+std::vector<bool> FindReachableSubgraphs(
+    const flatbuffers::Vector<flatbuffers::Offset<SubGraph>>* subgraphs) {
+  std::vector<bool> reachable(subgraphs->size(), false);
+  std::vector<int> pending = {0};
+  reachable[0] = true;
+  auto visit = [&](int subgraph_index) {
+    if (subgraph_index >= 0 &&
+        static_cast<size_t>(subgraph_index) < reachable.size() &&
+        !reachable[subgraph_index]) {
+      reachable[subgraph_index] = true;
+      pending.push_back(subgraph_index);
+    }
+  };
+  while (!pending.empty()) {
+    const SubGraph* subgraph = (*subgraphs)[pending.back()];
+    pending.pop_back();
+    if (subgraph == nullptr || subgraph->operators() == nullptr) continue;
+    for (const Operator* op : *subgraph->operators()) {
+      if (op == nullptr) continue;
+      switch (op->builtin_options_type()) {
+        case BuiltinOptions_IfOptions:
+          if (const auto* options = op->builtin_options_as_IfOptions()) {
+            visit(options->then_subgraph_index());
+            visit(options->else_subgraph_index());
+          }
+          break;
+        case BuiltinOptions_WhileOptions:
+          if (const auto* options = op->builtin_options_as_WhileOptions()) {
+            visit(options->cond_subgraph_index());
+            visit(options->body_subgraph_index());
+          }
+          break;
+        case BuiltinOptions_CallOnceOptions:
+          if (const auto* options = op->builtin_options_as_CallOnceOptions()) {
+            visit(options->init_subgraph_index());
+          }
+          break;
+        case BuiltinOptions_CallOptions:
+          if (const auto* options = op->builtin_options_as_CallOptions()) {
+            visit(options->subgraph());
+          }
+          break;
+        default:
+          break;
+      }
+    }
+  }
+  return reachable;
+}
+
 }  // namespace
 
 const char* kEmptyTensorName = "";
@@ -531,6 +584,51 @@ TfLiteStatus InterpreterBuilder::ParseSignatureDefs(
   return kTfLiteOk;
 }
 
+TfLiteStatus InterpreterBuilder::ParseOfflinePlannedOffsets(
+    const flatbuffers::Vector<flatbuffers::Offset<Metadata>>* metadata,
+    const flatbuffers::Vector<flatbuffers::Offset<Buffer>>* buffers,
+    Interpreter* interpreter) {
+  if (metadata == nullptr) {
+    return kTfLiteOk;
+  }
+  // See kOfflineMemoryAllocationMetadata for the encoding.
+  constexpr int kHeaderSize = 3;
+  for (const auto fb_metadata : *metadata) {
+    if (fb_metadata == nullptr || fb_metadata->name() == nullptr ||
+        fb_metadata->name()->str() != kOfflineMemoryAllocationMetadata) {
+      continue;
+    }
+    const Buffer* buffer = fb_metadata->buffer() < buffers->size()
+                               ? (*buffers)[fb_metadata->buffer()]
+                               : nullptr;
+    if (buffer == nullptr || buffer->data() == nullptr ||
+        buffer->data()->size() < kHeaderSize * sizeof(int32_t) ||
+        buffer->data()->size() % sizeof(int32_t) != 0) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "Invalid buffer for %s metadata.",
+                           kOfflineMemoryAllocationMetadata);
+      return kTfLiteError;
+    }
+    std::vector<int32_t> values(buffer->data()->size() / sizeof(int32_t));
+    memcpy(values.data(), buffer->data()->data(), buffer->data()->size());
+    const int32_t version = values[0];
+    const int32_t subgraph_index = values[1];
+    const int32_t num_offsets = values[2];
+    if (version != 0 || subgraph_index < 0 ||
+        subgraph_index >= static_cast<int32_t>(interpreter->subgraphs_size()) ||
+        num_offsets != static_cast<int32_t>(values.size()) - kHeaderSize) {
+      TF_LITE_REPORT_ERROR(error_reporter_, "Invalid %s metadata.",
+                           kOfflineMemoryAllocationMetadata);
+      return kTfLiteError;
+    }
+    TF_LITE_ENSURE_STATUS(
+        interpreter->subgraph(subgraph_index)
+            ->SetOfflinePlannedOffsets(std::vector<int32_t>(
+                values.begin() + kHeaderSize, values.end())));
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus InterpreterBuilder::ParseTensors(
     const flatbuffers::Vector<flatbuffers::Offset<Buffer>>* buffers,
     const flatbuffers::Vector<flatbuffers::Offset<Tensor>>* tensors,
@@ -732,8 +830,16 @@ TfLiteStatus InterpreterBuilder::operator()(
 
   (*interpreter)->SetProfiler(tflite::profiling::MaybeCreatePlatformProfiler());
 
+  std::vector<bool> build_subgraph(subgraphs->size(), true);
+  if (skip_unreachable_subgraphs_) {
+    build_subgraph = FindReachableSubgraphs(subgraphs);
+  }
+
   for (int subgraph_index = 0; subgraph_index < subgraphs->size();
        ++subgraph_index) {
+    // Subgraphs that are not built are left empty, which keeps the indices of
+    // the others unchanged.
+    if (!build_subgraph[subgraph_index]) continue;
     const tflite::SubGraph* subgraph = (*subgraphs)[subgraph_index];
     tflite::Subgraph* modified_subgraph =
         (*interpreter)->subgraph(subgraph_index);
@@ -779,6 +885,11 @@ TfLiteStatus InterpreterBuilder::operator()(
     return cleanup_and_error();
   }
 
+  if (ParseOfflinePlannedOffsets(model_->metadata(), buffers,
+                                 interpreter->get()) != kTfLiteOk) {
+    return cleanup_and_error();
+  }
+
   if (num_fp32_tensors_ > 0) {
     (*interpreter)->lazy_delegate_providers_ =
         op_resolver_.GetDelegates(num_threads);
@@ -805,4 +916,9 @@ InterpreterBuilder& InterpreterBuilder::PreserveAllTensorsExperimental() {
   return *this;
 }
 
+InterpreterBuilder& InterpreterBuilder::SkipUnreachableSubgraphsExperimental() {
+  skip_unreachable_subgraphs_ = true;
+  return *this;
+}
+
 }  // namespace tflite
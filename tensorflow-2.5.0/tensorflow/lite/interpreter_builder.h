@@ -77,6 +77,15 @@ class InterpreterBuilder {
   /// intermediates are undefined due to memory planning and reuse.
   InterpreterBuilder& PreserveAllTensorsExperimental();
 
+  /// Only parses the subgraphs that can be run from the primary subgraph
+  /// through control flow ops (IF, WHILE, CALL, CALL_ONCE). The remaining
+  /// subgraphs are added to the interpreter empty, so none of their tensors,
+  /// buffers or nodes are touched and delegates have nothing to prepare in
+  /// them. Useful for models that carry subgraphs the application never runs,
+  /// e.g. validation subgraphs.
+  /// WARNING: This is an experimental API and subject to change.
+  InterpreterBuilder& SkipUnreachableSubgraphsExperimental();
+
   /// Any delegates added with AddDelegate will be applied to the Interpreter
   /// generated by operator(), in the order that they were added.  (The delegate
   /// parameter passed to AddDelegate should be non-null, otherwise an error
@@ -105,6 +114,10 @@ class InterpreterBuilder {
       const flatbuffers::Vector<flatbuffers::Offset<SignatureDef>>*
           signature_def_list,
       Interpreter* interpreter);
+  TfLiteStatus ParseOfflinePlannedOffsets(
+      const flatbuffers::Vector<flatbuffers::Offset<Metadata>>* metadata,
+      const flatbuffers::Vector<flatbuffers::Offset<Buffer>>* buffers,
+      Interpreter* interpreter);
 
   const ::tflite::Model* model_;
   const OpResolver& op_resolver_;
@@ -119,6 +132,7 @@ class InterpreterBuilder {
   bool has_flex_op_ = false;
   int num_fp32_tensors_ = 0;
   bool preserve_all_tensors_ = false;
+  bool skip_unreachable_subgraphs_ = false;
 };
 
 }  // namespace tflite
@@ -20,10 +20,13 @@ limitations under the License.
 #include <stdlib.h>
 #include <string.h>
 
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <map>
 #include <memory>
 #include <new>
 #include <string>
+#include <thread>  // NOLINT
 #include <utility>
 #include <vector>
 
@@ -735,6 +738,163 @@ TEST(BasicInterpreter, ReleaseNonPersistentMemory) {
   ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
 }
 
+int num_batch_invoke_kernel_runs = 0;
+
+// Sums the rows of its 2D input into a single row, which is the identity for
+// inputs with a single row. If `keep_rows` is true, the output instead has as
+// many rows as the input and each of them holds the sum.
+TfLiteRegistration GetSumRowsOpRegistration(bool keep_rows) {
+  TfLiteRegistration reg = {nullptr, nullptr, nullptr, nullptr};
+  if (keep_rows) {
+    reg.prepare = [](TfLiteContext* context, TfLiteNode* node) {
+      const TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+      TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+      return context->ResizeTensor(context, output,
+                                   TfLiteIntArrayCopy(input->dims));
+    };
+  } else {
+    reg.prepare = [](TfLiteContext* context, TfLiteNode* node) {
+      const TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+      TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+      TfLiteIntArray* dims = TfLiteIntArrayCopy(input->dims);
+      dims->data[0] = 1;
+      return context->ResizeTensor(context, output, dims);
+    };
+  }
+  reg.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+    ++num_batch_invoke_kernel_runs;
+    const TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+    TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+    const int rows = input->dims->data[0];
+    const int cols = input->dims->data[1];
+    const int output_rows = output->dims->data[0];
+    for (int c = 0; c < cols; ++c) {
+      float sum = 0;
+      for (int r = 0; r < rows; ++r) sum += input->data.f[r * cols + c];
+      for (int r = 0; r < output_rows; ++r) output->data.f[r * cols + c] = sum;
+    }
+    return kTfLiteOk;
+  };
+  return reg;
+}
+
+void BuildSumRowsGraph(Interpreter* interpreter, TfLiteRegistration* reg) {
+  ASSERT_EQ(interpreter->AddTensors(2), kTfLiteOk);
+  ASSERT_EQ(interpreter->SetInputs({0}), kTfLiteOk);
+  ASSERT_EQ(interpreter->SetOutputs({1}), kTfLiteOk);
+  TfLiteQuantizationParams quantized;
+  ASSERT_EQ(interpreter->SetTensorParametersReadWrite(0, kTfLiteFloat32, "in",
+                                                      {1, 2}, quantized),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter->SetTensorParametersReadWrite(1, kTfLiteFloat32, "out",
+                                                      {1, 2}, quantized),
+            kTfLiteOk);
+  ASSERT_EQ(
+      interpreter->AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr, reg),
+      kTfLiteOk);
+  ASSERT_EQ(interpreter->AllocateTensors(), kTfLiteOk);
+}
+
+// Doubles every element of its input, so each row of the output depends only
+// on the same row of the input.
+TfLiteRegistration GetDoubleOpRegistration() {
+  TfLiteRegistration reg = {nullptr, nullptr, nullptr, nullptr};
+  reg.prepare = [](TfLiteContext* context, TfLiteNode* node) {
+    const TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+    TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+    return context->ResizeTensor(context, output,
+                                 TfLiteIntArrayCopy(input->dims));
+  };
+  reg.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+    ++num_batch_invoke_kernel_runs;
+    const TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+    TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+    for (int i = 0; i < NumElements(input); ++i) {
+      output->data.f[i] = 2 * input->data.f[i];
+    }
+    return kTfLiteOk;
+  };
+  return reg;
+}
+
+TEST(BasicInterpreter, BatchInvokeRunsRequestsOneByOneByDefault) {
+  // The output scales with the batch, but its rows mix the rows of the input.
+  Interpreter interpreter;
+  TfLiteRegistration reg = GetSumRowsOpRegistration(/*keep_rows=*/true);
+  BuildSumRowsGraph(&interpreter, &reg);
+
+  const float inputs[3][2] = {{1, 2}, {3, 4}, {5, 6}};
+  float outputs[3][2] = {};
+  num_batch_invoke_kernel_runs = 0;
+  ASSERT_EQ(interpreter.BatchInvoke({{inputs[0]}, {inputs[1]}, {inputs[2]}},
+                                    {{outputs[0]}, {outputs[1]}, {outputs[2]}}),
+            kTfLiteOk);
+  // Without the caller's opt-in, every request runs on its own.
+  EXPECT_EQ(num_batch_invoke_kernel_runs, 3);
+  EXPECT_THAT(outputs[0], testing::ElementsAre(1, 2));
+  EXPECT_THAT(outputs[1], testing::ElementsAre(3, 4));
+  EXPECT_THAT(outputs[2], testing::ElementsAre(5, 6));
+}
+
+TEST(BasicInterpreter, BatchInvokeConcatenatesIndependentRows) {
+  const float inputs[3][2] = {{1, 2}, {3, 4}, {5, 6}};
+  float outputs[3][2] = {};
+
+  // The output doesn't scale with the batch, so the requests run one by one
+  // even though the caller opted in.
+  Interpreter unbatchable_interpreter;
+  TfLiteRegistration unbatchable_reg =
+      GetSumRowsOpRegistration(/*keep_rows=*/false);
+  BuildSumRowsGraph(&unbatchable_interpreter, &unbatchable_reg);
+  num_batch_invoke_kernel_runs = 0;
+  ASSERT_EQ(unbatchable_interpreter.BatchInvoke(
+                {{inputs[0]}, {inputs[1]}, {inputs[2]}},
+                {{outputs[0]}, {outputs[1]}, {outputs[2]}},
+                /*rows_are_independent=*/true),
+            kTfLiteOk);
+  EXPECT_EQ(num_batch_invoke_kernel_runs, 3);
+  EXPECT_THAT(outputs[0], testing::ElementsAre(1, 2));
+  EXPECT_THAT(outputs[1], testing::ElementsAre(3, 4));
+  EXPECT_THAT(outputs[2], testing::ElementsAre(5, 6));
+
+  Interpreter interpreter;
+  TfLiteRegistration reg = GetDoubleOpRegistration();
+  BuildSumRowsGraph(&interpreter, &reg);
+  num_batch_invoke_kernel_runs = 0;
+  ASSERT_EQ(interpreter.BatchInvoke({{inputs[0]}, {inputs[1]}, {inputs[2]}},
+                                    {{outputs[0]}, {outputs[1]}, {outputs[2]}},
+                                    /*rows_are_independent=*/true),
+            kTfLiteOk);
+  // All requests are run at once, and each gets the rows it fed.
+  EXPECT_EQ(num_batch_invoke_kernel_runs, 1);
+  EXPECT_THAT(outputs[0], testing::ElementsAre(2, 4));
+  EXPECT_THAT(outputs[1], testing::ElementsAre(6, 8));
+  EXPECT_THAT(outputs[2], testing::ElementsAre(10, 12));
+
+  // The original shapes are restored.
+  const TfLiteTensor* input = interpreter.input_tensor(0);
+  ASSERT_EQ(input->dims->size, 2);
+  EXPECT_EQ(input->dims->data[0], 1);
+  EXPECT_EQ(interpreter.output_tensor(0)->bytes, 2 * sizeof(float));
+  ASSERT_EQ(interpreter.BatchInvoke({{inputs[1]}}, {{outputs[1]}},
+                                    /*rows_are_independent=*/true),
+            kTfLiteOk);
+  EXPECT_THAT(outputs[1], testing::ElementsAre(6, 8));
+}
+
+TEST(BasicInterpreter, BatchInvokeInvalidArguments) {
+  Interpreter interpreter;
+  TfLiteRegistration reg = GetSumRowsOpRegistration(/*keep_rows=*/true);
+  BuildSumRowsGraph(&interpreter, &reg);
+
+  const float inputs[2] = {};
+  float outputs[2];
+  EXPECT_EQ(interpreter.BatchInvoke({}, {}), kTfLiteOk);
+  EXPECT_NE(interpreter.BatchInvoke({{inputs}}, {}), kTfLiteOk);
+  EXPECT_NE(interpreter.BatchInvoke({{}}, {{outputs}}), kTfLiteOk);
+  EXPECT_NE(interpreter.BatchInvoke({{inputs}}, {{}}), kTfLiteOk);
+}
+
 // Forcefully divides tensor allocation in three steps: one before invocation
 // and two more at invocation time. This happens because we use string tensors
 // and their sizes can't be determined until invocation time.
@@ -1303,6 +1463,161 @@ TEST_F(TestExecutionPlan, NullExecutionPlan) {
   ASSERT_EQ(run_order_, std::vector<int>());
 }
 
+class InterOpParallelismTest : public ::testing::Test {
+ protected:
+  // Shared by the nodes that wait for each other.
+  struct Rendezvous {
+    std::atomic<int> arrived{0};
+    int expected = 0;
+  };
+
+  // Build a kernel registration for an op that copies its one input to an
+  // output once all nodes of `rendezvous_` have been invoked, failing if they
+  // aren't within a few seconds.
+  TfLiteRegistration RendezvousOpRegistration() {
+    TfLiteRegistration reg = {nullptr, nullptr, nullptr, nullptr};
+    reg.prepare = [](TfLiteContext* context, TfLiteNode* node) {
+      const TfLiteTensor* input;
+      TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, 0, &input));
+      TfLiteTensor* output;
+      TF_LITE_ENSURE_OK(context, GetOutputSafe(context, node, 0, &output));
+      return context->ResizeTensor(context, output,
+                                   TfLiteIntArrayCopy(input->dims));
+    };
+    reg.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+      Rendezvous* rendezvous = *static_cast<Rendezvous**>(node->builtin_data);
+      ++rendezvous->arrived;
+      const auto deadline =
+          std::chrono::steady_clock::now() + std::chrono::seconds(10);
+      while (rendezvous->arrived < rendezvous->expected) {
+        if (std::chrono::steady_clock::now() > deadline) return kTfLiteError;
+        std::this_thread::yield();
+      }
+      const TfLiteTensor* input;
+      TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, 0, &input));
+      TfLiteTensor* output;
+      TF_LITE_ENSURE_OK(context, GetOutputSafe(context, node, 0, &output));
+      for (int i = 0; i < NumElements(input); ++i) {
+        output->data.f[i] = input->data.f[i];
+      }
+      return kTfLiteOk;
+    };
+    return reg;
+  }
+
+  // Build a kernel registration for an op that adds its two inputs.
+  TfLiteRegistration AddOpRegistration() {
+    TfLiteRegistration reg = {nullptr, nullptr, nullptr, nullptr};
+    reg.prepare = [](TfLiteContext* context, TfLiteNode* node) {
+      const TfLiteTensor* input;
+      TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, 0, &input));
+      TfLiteTensor* output;
+      TF_LITE_ENSURE_OK(context, GetOutputSafe(context, node, 0, &output));
+      return context->ResizeTensor(context, output,
+                                   TfLiteIntArrayCopy(input->dims));
+    };
+    reg.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+      const TfLiteTensor* a;
+      TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, 0, &a));
+      const TfLiteTensor* b;
+      TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, 1, &b));
+      TfLiteTensor* output;
+      TF_LITE_ENSURE_OK(context, GetOutputSafe(context, node, 0, &output));
+      for (int i = 0; i < NumElements(a); ++i) {
+        output->data.f[i] = a->data.f[i] + b->data.f[i];
+      }
+      return kTfLiteOk;
+    };
+    return reg;
+  }
+
+  void MakeRendezvousNode(int input, int output) {
+    TfLiteRegistration op = RendezvousOpRegistration();
+    // Ownership of the builtin data is taken by the interpreter, which frees
+    // it with free().
+    Rendezvous** builtin_data =
+        static_cast<Rendezvous**>(malloc(sizeof(Rendezvous*)));
+    *builtin_data = &rendezvous_;
+    ++rendezvous_.expected;
+    ASSERT_EQ(interpreter_.AddNodeWithParameters({input}, {output}, nullptr, 0,
+                                                 builtin_data, &op),
+              kTfLiteOk);
+  }
+
+  void MakeAddNode(int input1, int input2, int output) {
+    TfLiteRegistration op = AddOpRegistration();
+    ASSERT_EQ(interpreter_.AddNodeWithParameters(
+                  {input1, input2}, {output}, nullptr, 0, nullptr, &op),
+              kTfLiteOk);
+  }
+
+  // Adds `num_tensors` float tensors of 3 elements, the first two being the
+  // inputs and the last one the output.
+  void AddTensors(int num_tensors) {
+    ASSERT_EQ(interpreter_.AddTensors(num_tensors), kTfLiteOk);
+    interpreter_.SetInputs({0, 1});
+    interpreter_.SetOutputs({num_tensors - 1});
+    TfLiteQuantizationParams quantized;
+    for (int tensor_index = 0; tensor_index < num_tensors; tensor_index++) {
+      ASSERT_EQ(interpreter_.SetTensorParametersReadWrite(
+                    tensor_index, kTfLiteFloat32, "", {3}, quantized),
+                kTfLiteOk);
+    }
+  }
+
+  Interpreter interpreter_;
+  Rendezvous rendezvous_;
+};
+
+TEST_F(InterOpParallelismTest, IndependentNodesRunConcurrently) {
+  // tensor[2] = copy(tensor[0]); tensor[3] = copy(tensor[1]), with the copies
+  // waiting for each other; tensor[4] = tensor[2] + tensor[3].
+  AddTensors(5);
+  MakeRendezvousNode(0, 2);
+  MakeRendezvousNode(1, 3);
+  MakeAddNode(2, 3, 4);
+  ASSERT_EQ(interpreter_.SetNumInterOpThreads(2), kTfLiteOk);
+  ASSERT_EQ(interpreter_.AllocateTensors(), kTfLiteOk);
+
+  for (int i = 0; i < 3; ++i) {
+    interpreter_.typed_tensor<float>(0)[i] = i;
+    interpreter_.typed_tensor<float>(1)[i] = 10 * i;
+  }
+  for (int run = 0; run < 2; ++run) {
+    rendezvous_.arrived = 0;
+    ASSERT_EQ(interpreter_.Invoke(), kTfLiteOk);
+    for (int i = 0; i < 3; ++i) {
+      EXPECT_EQ(interpreter_.typed_tensor<float>(4)[i], 11 * i);
+    }
+  }
+}
+
+TEST_F(InterOpParallelismTest, IndependentNodesAreMadeAdjacent) {
+  // tensor[2] = tensor[0] + tensor[0]; tensor[3] = tensor[2] + tensor[2];
+  // tensor[4] = tensor[1] + tensor[1]; tensor[5] = tensor[3] + tensor[4].
+  AddTensors(6);
+  MakeAddNode(0, 0, 2);
+  MakeAddNode(2, 2, 3);
+  MakeAddNode(1, 1, 4);
+  MakeAddNode(3, 4, 5);
+  ASSERT_EQ(interpreter_.SetNumInterOpThreads(2), kTfLiteOk);
+  ASSERT_EQ(interpreter_.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(interpreter_.execution_plan(), std::vector<int>({0, 2, 1, 3}));
+
+  for (int i = 0; i < 3; ++i) {
+    interpreter_.typed_tensor<float>(0)[i] = i;
+    interpreter_.typed_tensor<float>(1)[i] = 10 * i;
+  }
+  ASSERT_EQ(interpreter_.Invoke(), kTfLiteOk);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(interpreter_.typed_tensor<float>(5)[i], 24 * i);
+  }
+}
+
+TEST_F(InterOpParallelismTest, InvalidNumThreads) {
+  EXPECT_EQ(interpreter_.SetNumInterOpThreads(0), kTfLiteError);
+}
+
 TEST(TestDelegateOwnership, ProperlyDisposed) {
   struct TfLiteInterpreterOwnedDelegate : public TfLiteDelegate {
     TfLiteInterpreterOwnedDelegate(bool* destroyed, bool* prepared)
@@ -15,10 +15,14 @@ limitations under the License.
 #include "tensorflow/lite/kernels/dequantize.h"
 
 #include <stddef.h>
+#include <string.h>
+
+#include <memory>
 
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/kernels/internal/optimized/neon_check.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/kernels/shared_constant_cache.h"
 
 namespace tflite {
 namespace ops {
@@ -34,11 +38,32 @@ struct OpContext {
   TfLiteTensor* output;
 };
 
+// Identifies dequantized weights in the SharedConstantCache. The input type
+// is or'ed into the low bits, since the same data dequantizes differently as
+// e.g. int8 and uint8.
+constexpr int kSharedConstantCacheKind = 1 << 8;
+
 struct OpData {
   // This boolean value is only used when the input tensor is constant.
   bool float_dequantized_weights_initialized;
+  // The dequantized weights when the input tensor is constant. They are shared
+  // by all interpreters dequantizing the same weights.
+  std::shared_ptr<const SharedConstantCache::Entry> shared_weights;
 };
 
+SharedConstantCache::Key SharedWeightsKey(const TfLiteTensor* input) {
+  uint32_t scale_bits;
+  memcpy(&scale_bits, &input->params.scale, sizeof(scale_bits));
+  // The scale and zero point are packed without overlap, so that weights
+  // with different quantization parameters never share an entry.
+  const uint64_t params_hash =
+      (static_cast<uint64_t>(scale_bits) << 32) |
+      static_cast<uint32_t>(input->params.zero_point);
+  return {input->data.raw, input->bytes,
+          kSharedConstantCacheKind | static_cast<int>(input->type),
+          params_hash};
+}
+
 void* Init(TfLiteContext* context, const char* buffer, size_t length) {
   auto* op_data = new OpData();
   op_data->float_dequantized_weights_initialized = false;
@@ -65,10 +90,12 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   }
 
   op_context.output->type = kTfLiteFloat32;
-  // If the input tensor is constant, we can persist the dequantized value in
-  // the output tensor. Otherwise we run dequantize upon each eval.
+  // If the input tensor is constant, the dequantized value is computed once and
+  // shared with other interpreters through the SharedConstantCache, so the
+  // output isn't allocated by the arena. Otherwise we run dequantize upon each
+  // eval.
   if (IsConstantTensor(op_context.input)) {
-    op_context.output->allocation_type = kTfLiteArenaRwPersistent;
+    op_context.output->allocation_type = kTfLiteCustom;
   }
   return context->ResizeTensor(context, op_context.output,
                                TfLiteIntArrayCopy(op_context.input->dims));
@@ -83,15 +110,26 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
     return kTfLiteOk;
   }
 
-  auto status = DequantizeImpl<kernel_type>(context, node, op_context.input,
-                                            op_context.output);
-  if (status != kTfLiteOk) {
-    return status;
+  if (!IsConstantTensor(op_context.input)) {
+    return DequantizeImpl<kernel_type>(context, node, op_context.input,
+                                       op_context.output);
   }
 
-  if (IsConstantTensor(op_context.input)) {
-    op_data->float_dequantized_weights_initialized = true;
+  TfLiteTensor* output = op_context.output;
+  op_data->shared_weights = SharedConstantCache::Get()->GetOrCreate(
+      SharedWeightsKey(op_context.input), output->bytes,
+      [&](SharedConstantCache::Entry* entry) {
+        output->data.raw = static_cast<char*>(entry->data());
+        return DequantizeImpl<kernel_type>(context, node, op_context.input,
+                                           output);
+      });
+  if (op_data->shared_weights == nullptr) {
+    output->data.raw = nullptr;
+    return kTfLiteError;
   }
+  // The shared weights are read-only, like any other constant.
+  output->data.raw = static_cast<char*>(op_data->shared_weights->data());
+  op_data->float_dequantized_weights_initialized = true;
   return kTfLiteOk;
 }
 
@@ -0,0 +1,80 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/kernels/shared_constant_cache.h"
+
+#include <iterator>
+#include <memory>
+
+#include "tensorflow/lite/util.h"
+
+namespace tflite {
+
+SharedConstantCache::Entry::Entry(size_t bytes)
+    : storage_(new char[bytes + kDefaultTensorAlignment]), bytes_(bytes) {
+  void* data = storage_.get();
+  size_t space = bytes + kDefaultTensorAlignment;
+  data_ = std::align(kDefaultTensorAlignment, bytes, data, space);
+}
+
+SharedConstantCache* SharedConstantCache::Get() {
+  static SharedConstantCache* cache = new SharedConstantCache();
+  return cache;
+}
+
+std::shared_ptr<const SharedConstantCache::Entry>
+SharedConstantCache::GetOrCreate(
+    const Key& key, size_t bytes,
+    const std::function<TfLiteStatus(Entry*)>& fill) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+      if (std::shared_ptr<const Entry> entry = it->second.lock()) {
+        return entry;
+      }
+      entries_.erase(it);
+    }
+  }
+
+  // Fill the entry without holding the lock, as that may take a while. If
+  // another thread creates the same entry meanwhile, the first one wins.
+  auto entry = std::make_shared<Entry>(bytes);
+  if (fill(entry.get()) != kTfLiteOk) {
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::weak_ptr<const Entry>& slot = entries_[key];
+  if (std::shared_ptr<const Entry> existing = slot.lock()) {
+    return existing;
+  }
+  slot = entry;
+  // Expired entries are otherwise only dropped when looked up again.
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    it = it->second.expired() ? entries_.erase(it) : std::next(it);
+  }
+  return entry;
+}
+
+size_t SharedConstantCache::size() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t live_entries = 0;
+  for (const auto& key_and_entry : entries_) {
+    if (!key_and_entry.second.expired()) ++live_entries;
+  }
+  return live_entries;
+}
+
+}  // namespace tflite
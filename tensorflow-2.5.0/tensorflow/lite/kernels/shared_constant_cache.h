@@ -0,0 +1,95 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_KERNELS_SHARED_CONSTANT_CACHE_H_
+#define TENSORFLOW_LITE_KERNELS_SHARED_CONSTANT_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <tuple>
+
+#include "tensorflow/lite/c/common.h"
+
+namespace tflite {
+
+// A process-wide cache of data derived from constant tensors, e.g. dequantized
+// or repacked weights, so that all interpreters running a model share a
+// single copy of it instead of one each.
+//
+// Entries are keyed by the address of the constant data they are derived
+// from, which interpreters built from the same FlatBufferModel share, and by
+// what the kernel derived from it. The model outlives its interpreters, so
+// the address can't be reused for other data while an entry is alive.
+// Entries are reference counted and freed when their last user releases them.
+class SharedConstantCache {
+ public:
+  struct Key {
+    // Constant data the entry is derived from.
+    const void* source;
+    size_t source_bytes;
+    // Identifies the kind of data derived from `source`, like the kernel
+    // deriving it.
+    int kind;
+    // Anything else the derived data depends on, e.g. quantization parameters.
+    uint64_t params_hash;
+
+    bool operator<(const Key& other) const {
+      return std::tie(source, source_bytes, kind, params_hash) <
+             std::tie(other.source, other.source_bytes, other.kind,
+                      other.params_hash);
+    }
+  };
+
+  // Derived data of `bytes` bytes, aligned like arena allocated tensors.
+  class Entry {
+   public:
+    explicit Entry(size_t bytes);
+    Entry(const Entry&) = delete;
+    Entry& operator=(const Entry&) = delete;
+
+    void* data() const { return data_; }
+    size_t bytes() const { return bytes_; }
+
+   private:
+    std::unique_ptr<char[]> storage_;
+    void* data_;
+    size_t bytes_;
+  };
+
+  // Returns the process-wide instance.
+  static SharedConstantCache* Get();
+
+  // Returns the entry for `key`, creating it if needed by calling `fill` on a
+  // new entry of `bytes` bytes. The entry must not be written to once
+  // returned. Returns nullptr if `fill` fails.
+  std::shared_ptr<const Entry> GetOrCreate(
+      const Key& key, size_t bytes,
+      const std::function<TfLiteStatus(Entry*)>& fill);
+
+  // Returns the number of live entries.
+  size_t size();
+
+ private:
+  std::mutex mutex_;
+  std::map<Key, std::weak_ptr<const Entry>> entries_;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_SHARED_CONSTANT_CACHE_H_
@@ -0,0 +1,112 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/kernels/shared_constant_cache.h"
+
+#include <stdint.h>
+
+#include <memory>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/util.h"
+
+namespace tflite {
+namespace {
+
+TfLiteStatus FillWith(SharedConstantCache::Entry* entry, float value,
+                      int* calls) {
+  ++*calls;
+  float* data = static_cast<float*>(entry->data());
+  for (int i = 0; i < entry->bytes() / sizeof(float); ++i) data[i] = value;
+  return kTfLiteOk;
+}
+
+TEST(SharedConstantCacheTest, SharesEntriesWithTheSameKey) {
+  SharedConstantCache cache;
+  const int8_t weights[16] = {};
+  const SharedConstantCache::Key key = {weights, sizeof(weights), 1, 0};
+  int calls = 0;
+  auto fill = [&](SharedConstantCache::Entry* entry) {
+    return FillWith(entry, 1.0f, &calls);
+  };
+
+  auto first = cache.GetOrCreate(key, 16 * sizeof(float), fill);
+  auto second = cache.GetOrCreate(key, 16 * sizeof(float), fill);
+  ASSERT_NE(first, nullptr);
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(calls, 1);
+  EXPECT_EQ(cache.size(), 1);
+  EXPECT_EQ(first->bytes(), 16 * sizeof(float));
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(first->data()) %
+                kDefaultTensorAlignment,
+            0);
+  EXPECT_EQ(static_cast<const float*>(first->data())[15], 1.0f);
+}
+
+TEST(SharedConstantCacheTest, SeparatesEntriesWithDifferentKeys) {
+  SharedConstantCache cache;
+  const int8_t weights[16] = {};
+  int calls = 0;
+  auto fill = [&](SharedConstantCache::Entry* entry) {
+    return FillWith(entry, 1.0f, &calls);
+  };
+
+  auto base = cache.GetOrCreate({weights, sizeof(weights), 1, 0}, 64, fill);
+  auto other_kind =
+      cache.GetOrCreate({weights, sizeof(weights), 2, 0}, 64, fill);
+  auto other_params =
+      cache.GetOrCreate({weights, sizeof(weights), 1, 3}, 64, fill);
+  auto other_source =
+      cache.GetOrCreate({weights + 8, 8, 1, 0}, 64, fill);
+  EXPECT_NE(base, other_kind);
+  EXPECT_NE(base, other_params);
+  EXPECT_NE(base, other_source);
+  EXPECT_EQ(calls, 4);
+  EXPECT_EQ(cache.size(), 4);
+}
+
+TEST(SharedConstantCacheTest, ReleasesEntriesWithoutUsers) {
+  SharedConstantCache cache;
+  const int8_t weights[16] = {};
+  const SharedConstantCache::Key key = {weights, sizeof(weights), 1, 0};
+  int calls = 0;
+  auto fill = [&](SharedConstantCache::Entry* entry) {
+    return FillWith(entry, 1.0f, &calls);
+  };
+
+  cache.GetOrCreate(key, 64, fill).reset();
+  EXPECT_EQ(cache.size(), 0);
+  auto entry = cache.GetOrCreate(key, 64, fill);
+  EXPECT_NE(entry, nullptr);
+  EXPECT_EQ(calls, 2);
+  EXPECT_EQ(cache.size(), 1);
+}
+
+TEST(SharedConstantCacheTest, DoesNotKeepEntriesThatFailedToFill) {
+  SharedConstantCache cache;
+  const int8_t weights[16] = {};
+  const SharedConstantCache::Key key = {weights, sizeof(weights), 1, 0};
+
+  EXPECT_EQ(cache.GetOrCreate(key, 64,
+                              [](SharedConstantCache::Entry*) {
+                                return kTfLiteError;
+                              }),
+            nullptr);
+  EXPECT_EQ(cache.size(), 0);
+}
+
+}  // namespace
+}  // namespace tflite
@@ -15,10 +15,29 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_MEMORY_PLANNER_H_
 #define TENSORFLOW_LITE_MEMORY_PLANNER_H_
 
+#include <cstdint>
+#include <vector>
+
 #include "tensorflow/lite/c/common.h"
 
 namespace tflite {
 
+// Offline planned offset of a tensor whose memory is to be planned at runtime.
+constexpr int32_t kOnlinePlannedOffset = -1;
+
+// Name of the model metadata holding offline planned tensor offsets. Its buffer
+// uses the same encoding as TFLite Micro, a list of 32-bit integers:
+//
+//   [0]      Format version, 0.
+//   [1]      Index of the subgraph the offsets apply to.
+//   [2]      Number of offsets that follow, n, the number of tensors in the
+//            subgraph.
+//   [3+i]    Offset in the non-persistent arena of tensor i, or
+//            kOnlinePlannedOffset.
+//
+// A model may hold one such metadata entry per subgraph.
+constexpr char kOfflineMemoryAllocationMetadata[] = "OfflineMemoryAllocation";
+
 // A MemoryPlanner is responsible for planning and executing a number of
 // memory-related operations that are necessary in TF Lite.
 class MemoryPlanner {
@@ -59,6 +78,25 @@ class MemoryPlanner {
 
   // Returns true if the non-persistent memory is available.
   virtual bool HasNonPersistentMemory() = 0;
+
+  // Sets offsets, indexed by tensor, at which tensors are placed instead of
+  // planning them at runtime. Takes effect for the following
+  // ExecuteAllocations() calls. Offsets that don't fit the tensor sizes at that
+  // point are dropped, falling back to planning at runtime.
+  virtual TfLiteStatus SetOfflinePlannedOffsets(
+      std::vector<int32_t> offsets) = 0;
+
+  // Returns the offsets, indexed by tensor, that tensors on the non-persistent
+  // arena have been placed at, in a form accepted by
+  // SetOfflinePlannedOffsets(). Other tensors get kOnlinePlannedOffset.
+  virtual TfLiteStatus GetPlannedOffsets(std::vector<int32_t>* offsets) = 0;
+
+  // Declares that the nodes of each stage may be executed concurrently, a
+  // stage i being the nodes in [stage_starts[i], stage_starts[i + 1]), so
+  // tensors used by nodes of the same stage must not share memory. An empty
+  // vector executes nodes one at a time. Takes effect for the following
+  // PlanAllocations() call.
+  virtual TfLiteStatus SetExecutionStages(std::vector<int> stage_starts) = 0;
 };
 
 }  // namespace tflite
@@ -0,0 +1,91 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Cortex-M implementation of the timer functions, based on the cycle counter
+// of the Data Watchpoint and Trace (DWT) unit. Ticks are CPU cycles, which
+// makes this suitable for cycle-accurate profiling with MicroProfiler.
+//
+// The DWT cycle counter only exists on ARMv7-M and ARMv8-M Mainline cores
+// (Cortex-M3 and up, except Cortex-M23). On other cores, and on cores where
+// the counter isn't implemented, no time is reported, the same as the
+// reference implementation.
+//
+// ticks_per_second() returns TF_LITE_MCU_CORE_CLOCK_HZ, which the application
+// should define to the core clock frequency to get durations in ms.
+
+#include "tensorflow/lite/micro/micro_time.h"
+
+#ifndef TF_LITE_MCU_CORE_CLOCK_HZ
+#define TF_LITE_MCU_CORE_CLOCK_HZ 0
+#endif
+
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || \
+    defined(__ARM_ARCH_8M_MAIN__) || defined(__ARM_ARCH_8_1M_MAIN__)
+#define TF_LITE_MICRO_HAS_DWT_CYCCNT
+#endif
+
+namespace tflite {
+namespace {
+
+#if defined(TF_LITE_MICRO_HAS_DWT_CYCCNT)
+// Debug Exception and Monitor Control Register and its trace enable bit.
+volatile uint32_t* const kDemcr = reinterpret_cast<uint32_t*>(0xE000EDFC);
+constexpr uint32_t kDemcrTrcEna = 1u << 24;
+// DWT control register, its cycle counter enable bit and the bit telling that
+// the cycle counter isn't implemented.
+volatile uint32_t* const kDwtCtrl = reinterpret_cast<uint32_t*>(0xE0001000);
+constexpr uint32_t kDwtCtrlCycCntEna = 1u;
+constexpr uint32_t kDwtCtrlNoCycCnt = 1u << 25;
+// DWT cycle counter register.
+volatile uint32_t* const kDwtCycCnt = reinterpret_cast<uint32_t*>(0xE0001004);
+// Lock access register of the DWT, which needs to be unlocked on Cortex-M7.
+volatile uint32_t* const kDwtLar = reinterpret_cast<uint32_t*>(0xE0001FB0);
+constexpr uint32_t kDwtLarUnlock = 0xC5ACCE55;
+
+// Enables the cycle counter and returns whether it's available.
+bool InitCycleCounter() {
+  *kDemcr |= kDemcrTrcEna;
+  if ((*kDwtCtrl & kDwtCtrlNoCycCnt) != 0) {
+    return false;
+  }
+  *kDwtLar = kDwtLarUnlock;
+  *kDwtCycCnt = 0;
+  *kDwtCtrl |= kDwtCtrlCycCntEna;
+  return true;
+}
+#endif  // defined(TF_LITE_MICRO_HAS_DWT_CYCCNT)
+
+}  // namespace
+
+int32_t ticks_per_second() { return TF_LITE_MCU_CORE_CLOCK_HZ; }
+
+int32_t GetCurrentTimeTicks() {
+#if defined(TF_LITE_MICRO_HAS_DWT_CYCCNT)
+  static bool is_initialized = false;
+  static bool has_cycle_counter = false;
+  if (!is_initialized) {
+    has_cycle_counter = InitCycleCounter();
+    is_initialized = true;
+  }
+  if (has_cycle_counter) {
+    // The counter wraps around, but differences of ticks stay correct for
+    // durations up to 2^31 cycles.
+    return static_cast<int32_t>(*kDwtCycCnt);
+  }
+#endif
+  return 0;
+}
+
+}  // namespace tflite
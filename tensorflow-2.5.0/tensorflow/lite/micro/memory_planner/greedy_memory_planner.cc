@@ -207,6 +207,11 @@ void GreedyMemoryPlanner::CalculateOffsetsIfNeeded() {
     int candidate_offset = 0;
     // Loop through the offset-ordered list of buffers, looking for gaps.
     if (wanted_requirements->offline_offset == kOnlinePlannedBuffer) {
+      // The smallest gap that the buffer fits into is used, so that short-lived
+      // buffers like scratch buffers fill the holes left by dead tensors
+      // without fragmenting the larger holes that later buffers could use.
+      int best_offset = -1;
+      int best_gap = 0;
       ListEntry* prior_entry = nullptr;
       while (true) {
         // Find out what the next active buffer is.
@@ -224,19 +229,24 @@ void GreedyMemoryPlanner::CalculateOffsetsIfNeeded() {
         }
         if (next_entry == nullptr) {
           // We're at the end of the list, so we can always append the buffer
-          // here.
+          // here unless a gap was found.
           break;
         }
         // Find out how much space there is between us and the next buffer.
         const int gap = next_entry->offset - candidate_offset;
-        if (gap >= wanted_size) {
-          // This entry has a big enough gap between it and the next, so
-          // use it!
-          break;
+        if (gap >= wanted_size && (best_offset == -1 || gap < best_gap)) {
+          best_offset = candidate_offset;
+          best_gap = gap;
+          if (gap == wanted_size) {
+            // Nothing fits better than an exact match.
+            break;
+          }
         }
-        // The gap wasn't big enough, so move on to another candidate.
         prior_entry = next_entry;
       }
+      if (best_offset != -1) {
+        candidate_offset = best_offset;
+      }
     } else {
       // Offline planned offset are to be considered constant
       candidate_offset = wanted_requirements->offline_offset;
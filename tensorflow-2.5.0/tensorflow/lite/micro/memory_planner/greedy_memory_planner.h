@@ -35,8 +35,10 @@ constexpr int kOnlinePlannedBuffer = -1;
 //  - The largest buffer is placed at offset zero.
 //  - The rest of the buffers are looped through in descending size order.
 //  - The other buffers that need to be in memory at the same time are found.
-//  - The first gap between simultaneously active buffers that the current
-//    buffer fits into will be used.
+//  - The smallest gap between simultaneously active buffers that the current
+//    buffer fits into will be used. Short-lived buffers, like the scratch
+//    buffers of an operator, thereby reuse the memory of dead tensors without
+//    fragmenting larger gaps.
 //  - If no large-enough gap is found, the current buffer is placed after the
 //    last buffer that's simultaneously active.
 //  - This continues until all buffers are placed, and the offsets stored.
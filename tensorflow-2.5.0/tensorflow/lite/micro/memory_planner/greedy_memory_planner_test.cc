@@ -258,6 +258,50 @@ TF_LITE_MICRO_TEST(TestOverlapCase) {
                           planner.GetMaximumMemorySize());
 }
 
+TF_LITE_MICRO_TEST(TestSmallestGapIsUsed) {
+  tflite::MicroErrorReporter micro_error_reporter;
+
+  tflite::GreedyMemoryPlanner planner(g_scratch_buffer, kScratchBufferSize);
+  // At time 1, buffers 0, 2 and 4 leave a 31 byte gap at offset 60 and a 22
+  // byte gap at offset 121.
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          planner.AddBuffer(&micro_error_reporter, 60, 0, 1));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          planner.AddBuffer(&micro_error_reporter, 31, 0, 0));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          planner.AddBuffer(&micro_error_reporter, 30, 0, 1));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          planner.AddBuffer(&micro_error_reporter, 22, 0, 0));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          planner.AddBuffer(&micro_error_reporter, 21, 0, 1));
+  // Short-lived buffers, like the scratch buffers of an operator. The first
+  // one fits into the smaller gap, leaving room for the other two in the
+  // larger one.
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          planner.AddBuffer(&micro_error_reporter, 20, 1, 1));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          planner.AddBuffer(&micro_error_reporter, 16, 1, 1));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          planner.AddBuffer(&micro_error_reporter, 15, 1, 1));
+
+  int offset = -1;
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, planner.GetOffsetForBuffer(&micro_error_reporter, 5, &offset));
+  TF_LITE_MICRO_EXPECT_EQ(121, offset);
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, planner.GetOffsetForBuffer(&micro_error_reporter, 6, &offset));
+  TF_LITE_MICRO_EXPECT_EQ(60, offset);
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, planner.GetOffsetForBuffer(&micro_error_reporter, 7, &offset));
+  TF_LITE_MICRO_EXPECT_EQ(76, offset);
+
+  TF_LITE_MICRO_EXPECT_EQ(false,
+                          planner.DoAnyBuffersOverlap(&micro_error_reporter));
+
+  TF_LITE_MICRO_EXPECT_EQ(static_cast<size_t>(164),
+                          planner.GetMaximumMemorySize());
+}
+
 TF_LITE_MICRO_TEST(TestSmallScratch) {
   tflite::MicroErrorReporter micro_error_reporter;
 
@@ -1005,6 +1005,10 @@ TfLiteStatus MicroAllocator::PopulateTfLiteTensorFromFlatbuffer(
       model->buffers(), error_reporter_, tensor);
 }
 
+size_t MicroAllocator::scratch_buffer_request_count() const {
+  return scratch_buffer_request_count_;
+}
+
 ErrorReporter* MicroAllocator::error_reporter() const {
   return error_reporter_;
 }
@@ -226,12 +226,6 @@ class MicroAllocator {
       const Model* model, const SubGraph* subgraph, TfLiteTensor* tensor,
       int tensor_index, bool allocate_temp);
 
-  ErrorReporter* error_reporter() const;
-
-  // Returns the first subgraph from the model.
-  const SubGraph* GetSubGraphFromModel(const Model* model);
-
- private:
   // Commits a memory plan for all non-persistent buffer allocations in the
   // 'head' section of the memory arena. The eval_tensors pointer is the list of
   // pre-allocated TfLiteEvalTensor structs that will point to the buffers that
@@ -244,6 +238,20 @@ class MicroAllocator {
       TfLiteEvalTensor* eval_tensors,
       ScratchBufferHandle* scratch_buffer_handles);
 
+  // Returns the pointer for the array of ScratchBufferRequest allocations in
+  // the head section.
+  internal::ScratchBufferRequest* GetScratchBufferRequests();
+
+  // Returns the number of ScratchBufferRequest instances stored in the head
+  // section while a model is allocating.
+  size_t scratch_buffer_request_count() const;
+
+  ErrorReporter* error_reporter() const;
+
+  // Returns the first subgraph from the model.
+  const SubGraph* GetSubGraphFromModel(const Model* model);
+
+ private:
   // Allocates an array of ScratchBufferHandle structs in the tail section for a
   // given number of handles.
   virtual TfLiteStatus AllocateScratchBufferHandles(
@@ -254,10 +262,6 @@ class MicroAllocator {
   // preparing.
   TfLiteStatus InitScratchBufferData();
 
-  // Returns the pointer for the array of ScratchBufferRequest allocations in
-  // the head section.
-  internal::ScratchBufferRequest* GetScratchBufferRequests();
-
   // A simple memory allocator that always allocate from the arena tail or head.
   SimpleMemoryAllocator* memory_allocator_;
 
@@ -14,13 +14,25 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/lite/micro/micro_profiler.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
 
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 #include "tensorflow/lite/micro/micro_error_reporter.h"
 #include "tensorflow/lite/micro/micro_time.h"
 
 namespace tflite {
+namespace {
+
+uint8_t* WriteLittleEndian(uint64_t value, int num_bytes, uint8_t* buffer) {
+  for (int i = 0; i < num_bytes; ++i) {
+    *buffer++ = static_cast<uint8_t>(value >> (8 * i));
+  }
+  return buffer;
+}
+
+}  // namespace
 
 uint32_t MicroProfiler::BeginEvent(const char* tag) {
   if (num_events_ == kMaxEvents) {
@@ -36,6 +48,29 @@ uint32_t MicroProfiler::BeginEvent(const char* tag) {
 void MicroProfiler::EndEvent(uint32_t event_handle) {
   TFLITE_DCHECK(event_handle < kMaxEvents);
   end_ticks_[event_handle] = GetCurrentTimeTicks();
+  AddToTagStats(tags_[event_handle],
+                end_ticks_[event_handle] - start_ticks_[event_handle]);
+}
+
+void MicroProfiler::AddToTagStats(const char* tag, uint32_t ticks) {
+  for (int i = 0; i < num_tags_; ++i) {
+    TagStats& stats = tag_stats_[i];
+    if (stats.tag == tag || strcmp(stats.tag, tag) == 0) {
+      ++stats.count;
+      stats.total_ticks += ticks;
+      if (ticks < stats.min_ticks) stats.min_ticks = ticks;
+      if (ticks > stats.max_ticks) stats.max_ticks = ticks;
+      return;
+    }
+  }
+  if (num_tags_ < kMaxTags) {
+    tag_stats_[num_tags_++] = {tag, 1, ticks, ticks, ticks};
+  }
+}
+
+const MicroProfiler::TagStats& MicroProfiler::GetTagStats(int index) const {
+  TFLITE_DCHECK(index >= 0 && index < num_tags_);
+  return tag_stats_[index];
 }
 
 int32_t MicroProfiler::GetTotalTicks() const {
@@ -55,4 +90,51 @@ void MicroProfiler::Log() const {
 #endif
 }
 
+void MicroProfiler::LogTagStats() const {
+#if !defined(TF_LITE_STRIP_ERROR_STRINGS)
+  for (int i = 0; i < num_tags_; ++i) {
+    const TagStats& stats = tag_stats_[i];
+    MicroPrintf("%s: %d events, %d ticks on average, min %d, max %d.",
+                stats.tag, static_cast<int>(stats.count),
+                static_cast<int>(stats.total_ticks / stats.count),
+                static_cast<int>(stats.min_ticks),
+                static_cast<int>(stats.max_ticks));
+  }
+#endif
+}
+
+size_t MicroProfiler::SerializeTagStats(uint8_t* buffer,
+                                        size_t buffer_size) const {
+  constexpr size_t kHeaderBytes = 4 + 1 + 4 + 2;
+  constexpr size_t kStatsBytes = 4 + 8 + 4 + 4;
+  size_t required_bytes = kHeaderBytes;
+  for (int i = 0; i < num_tags_; ++i) {
+    required_bytes += 1 + std::min<size_t>(strlen(tag_stats_[i].tag), 255) +
+                      kStatsBytes;
+  }
+  if (buffer_size < required_bytes) {
+    return 0;
+  }
+
+  uint8_t* current = buffer;
+  memcpy(current, "TFMP", 4);
+  current += 4;
+  *current++ = 1;
+  current = WriteLittleEndian(ticks_per_second(), 4, current);
+  current = WriteLittleEndian(num_tags_, 2, current);
+  for (int i = 0; i < num_tags_; ++i) {
+    const TagStats& stats = tag_stats_[i];
+    const size_t tag_length = std::min<size_t>(strlen(stats.tag), 255);
+    *current++ = static_cast<uint8_t>(tag_length);
+    memcpy(current, stats.tag, tag_length);
+    current += tag_length;
+    current = WriteLittleEndian(stats.count, 4, current);
+    current = WriteLittleEndian(stats.total_ticks, 8, current);
+    current = WriteLittleEndian(stats.min_ticks, 4, current);
+    current = WriteLittleEndian(stats.max_ticks, 4, current);
+  }
+  TFLITE_DCHECK(static_cast<size_t>(current - buffer) == required_bytes);
+  return required_bytes;
+}
+
 }  // namespace tflite
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_MICRO_MICRO_PROFILER_H_
 #define TENSORFLOW_LITE_MICRO_MICRO_PROFILER_H_
 
+#include <cstddef>
 #include <cstdint>
 
 #include "tensorflow/lite/micro/compatibility.h"
@@ -26,8 +27,22 @@ namespace tflite {
 // performance. Bottleck operators can be identified along with slow code
 // sections. This can be used in conjunction with running the relevant micro
 // benchmark to evaluate end-to-end performance.
+//
+// Besides the most recent events, the profiler accumulates the ticks of all
+// events per tag, e.g. per operator type across many invocations of a model.
+// On targets where GetCurrentTimeTicks() reads a cycle counter (see
+// cortex_m_generic/micro_time.cc), these are cycle counts.
 class MicroProfiler {
  public:
+  // Ticks of all events with the same tag since the last ClearTagStats().
+  struct TagStats {
+    const char* tag;
+    uint32_t count;
+    uint64_t total_ticks;
+    uint32_t min_ticks;
+    uint32_t max_ticks;
+  };
+
   MicroProfiler() = default;
   virtual ~MicroProfiler() = default;
 
@@ -56,7 +71,32 @@ class MicroProfiler {
   // Prints the profiling information of each of the events.
   void Log() const;
 
+  // Returns the number of distinct tags of the events ended so far.
+  int GetNumTags() const { return num_tags_; }
+
+  // Returns the accumulated ticks of the index-th distinct tag.
+  const TagStats& GetTagStats(int index) const;
+
+  // Clears the accumulated ticks of all tags.
+  void ClearTagStats() { num_tags_ = 0; }
+
+  // Prints the accumulated ticks of each tag.
+  void LogTagStats() const;
+
+  // Writes the accumulated ticks of each tag to `buffer` in a compact binary
+  // format, for decoding on the host with
+  // tensorflow/lite/micro/tools/decode_profile.py. All values are little
+  // endian:
+  //   "TFMP", uint8 version (1), uint32 ticks per second, uint16 tag count,
+  //   and per tag: uint8 tag length, tag bytes (truncated to 255), uint32
+  //   count, uint64 total ticks, uint32 min ticks, uint32 max ticks.
+  // Returns the number of bytes written, or 0 if `buffer_size` is too small.
+  size_t SerializeTagStats(uint8_t* buffer, size_t buffer_size) const;
+
  private:
+  // Adds an event of `ticks` duration to the stats of `tag`.
+  void AddToTagStats(const char* tag, uint32_t ticks);
+
   // Maximum number of events that this class can keep track of. If we call
   // AddEvent more than kMaxEvents number of times, then the oldest event's
   // profiling information will be overwritten.
@@ -67,6 +107,13 @@ class MicroProfiler {
   int32_t end_ticks_[kMaxEvents];
   int num_events_ = 0;
 
+  // Maximum number of distinct tags that have their ticks accumulated. Events
+  // with further tags are only kept as events.
+  static constexpr int kMaxTags = 64;
+
+  TagStats tag_stats_[kMaxTags];
+  int num_tags_ = 0;
+
   TF_LITE_REMOVE_VIRTUAL_DELETE;
 };
 
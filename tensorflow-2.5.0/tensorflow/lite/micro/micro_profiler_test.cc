@@ -0,0 +1,77 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/micro_profiler.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include "tensorflow/lite/micro/testing/micro_test.h"
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(TestAccumulatesTagStats) {
+  tflite::MicroProfiler profiler;
+  const char conv_tag[] = "CONV_2D";
+  // A distinct copy of the tag, as the tags of different operators of the same
+  // type need not share a pointer.
+  char conv_tag_copy[sizeof(conv_tag)];
+  strcpy(conv_tag_copy, conv_tag);
+
+  profiler.EndEvent(profiler.BeginEvent(conv_tag));
+  profiler.EndEvent(profiler.BeginEvent("ADD"));
+  profiler.EndEvent(profiler.BeginEvent(conv_tag_copy));
+
+  TF_LITE_MICRO_EXPECT_EQ(2, profiler.GetNumTags());
+  TF_LITE_MICRO_EXPECT_EQ(0, strcmp("CONV_2D", profiler.GetTagStats(0).tag));
+  TF_LITE_MICRO_EXPECT_EQ(2u, profiler.GetTagStats(0).count);
+  TF_LITE_MICRO_EXPECT_EQ(0, strcmp("ADD", profiler.GetTagStats(1).tag));
+  TF_LITE_MICRO_EXPECT_EQ(1u, profiler.GetTagStats(1).count);
+  TF_LITE_MICRO_EXPECT_LE(profiler.GetTagStats(0).min_ticks,
+                          profiler.GetTagStats(0).max_ticks);
+
+  // Clearing the events keeps the accumulated stats.
+  profiler.ClearEvents();
+  TF_LITE_MICRO_EXPECT_EQ(2, profiler.GetNumTags());
+  profiler.ClearTagStats();
+  TF_LITE_MICRO_EXPECT_EQ(0, profiler.GetNumTags());
+}
+
+TF_LITE_MICRO_TEST(TestSerializesTagStats) {
+  tflite::MicroProfiler profiler;
+  profiler.EndEvent(profiler.BeginEvent("ADD"));
+  profiler.EndEvent(profiler.BeginEvent("ADD"));
+
+  // Header, then the tag length, the tag and its stats.
+  constexpr size_t kExpectedBytes = 11 + 1 + 3 + 20;
+  uint8_t buffer[64];
+  TF_LITE_MICRO_EXPECT_EQ(
+      0u, profiler.SerializeTagStats(buffer, kExpectedBytes - 1));
+  TF_LITE_MICRO_EXPECT_EQ(kExpectedBytes,
+                          profiler.SerializeTagStats(buffer, sizeof(buffer)));
+
+  TF_LITE_MICRO_EXPECT_EQ(0, memcmp("TFMP", buffer, 4));
+  TF_LITE_MICRO_EXPECT_EQ(1, buffer[4]);
+  // One tag, little endian:
+  TF_LITE_MICRO_EXPECT_EQ(1, buffer[9]);
+  TF_LITE_MICRO_EXPECT_EQ(0, buffer[10]);
+  TF_LITE_MICRO_EXPECT_EQ(3, buffer[11]);
+  TF_LITE_MICRO_EXPECT_EQ(0, memcmp("ADD", buffer + 12, 3));
+  // Count of two events:
+  TF_LITE_MICRO_EXPECT_EQ(2, buffer[15]);
+  TF_LITE_MICRO_EXPECT_EQ(0, buffer[16]);
+}
+
+TF_LITE_MICRO_TESTS_END
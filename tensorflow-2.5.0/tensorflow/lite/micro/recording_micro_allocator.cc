@@ -62,6 +62,8 @@ RecordedAllocation RecordingMicroAllocator::GetRecordedAllocation(
       return recorded_node_and_registration_array_data_;
     case RecordedAllocationType::kOpData:
       return recorded_op_data_;
+    case RecordedAllocationType::kScratchBufferData:
+      return recorded_scratch_buffer_data_;
   }
   TF_LITE_REPORT_ERROR(error_reporter(), "Invalid allocation type supplied: %d",
                        allocation_type);
@@ -73,6 +75,20 @@ RecordingMicroAllocator::GetSimpleMemoryAllocator() const {
   return recording_memory_allocator_;
 }
 
+size_t RecordingMicroAllocator::GetScratchBufferBytes(int node_index) const {
+  size_t bytes = 0;
+  for (int i = 0; i < recorded_scratch_buffer_request_count_; ++i) {
+    if (recorded_scratch_buffer_requests_[i].node_idx == node_index) {
+      bytes += recorded_scratch_buffer_requests_[i].bytes;
+    }
+  }
+  return bytes;
+}
+
+size_t RecordingMicroAllocator::GetArenaHighWaterMarkBytes() const {
+  return recording_memory_allocator_->GetMaxUsedBytes();
+}
+
 void RecordingMicroAllocator::PrintAllocations() const {
   TF_LITE_REPORT_ERROR(
       error_reporter(),
@@ -86,6 +102,10 @@ void RecordingMicroAllocator::PrintAllocations() const {
       error_reporter(),
       "[RecordingMicroAllocator] Arena allocation tail %d bytes",
       recording_memory_allocator_->GetTailUsedBytes());
+  TF_LITE_REPORT_ERROR(
+      error_reporter(),
+      "[RecordingMicroAllocator] Arena high-water mark %d bytes",
+      GetArenaHighWaterMarkBytes());
   PrintRecordedAllocation(RecordedAllocationType::kTfLiteEvalTensorData,
                           "TfLiteEvalTensor data", "allocations");
   PrintRecordedAllocation(RecordedAllocationType::kPersistentTfLiteTensorData,
@@ -103,6 +123,8 @@ void RecordingMicroAllocator::PrintAllocations() const {
                           "NodeAndRegistration structs");
   PrintRecordedAllocation(RecordedAllocationType::kOpData,
                           "Operator runtime data", "OpData structs");
+  PrintRecordedAllocation(RecordedAllocationType::kScratchBufferData,
+                          "Scratch buffer data", "scratch buffers");
 }
 
 void* RecordingMicroAllocator::AllocatePersistentBuffer(size_t bytes) {
@@ -194,9 +216,34 @@ TfLiteStatus RecordingMicroAllocator::AllocateVariables(
 
   RecordAllocationUsage(allocations,
                         recorded_tflite_tensor_variable_buffer_data_);
+  // This is the last allocation of FinishModelAllocation(), so from here on
+  // the high-water mark reflects the arena usage while invoking the model
+  // rather than the temporary buffers of the memory planner.
+  recording_memory_allocator_->ResetMaxUsedBytes();
   return status;
 }
 
+TfLiteStatus RecordingMicroAllocator::CommitStaticMemoryPlan(
+    const Model* model, const SubGraph* subgraph,
+    TfLiteEvalTensor* eval_tensors,
+    ScratchBufferHandle* scratch_buffer_handles) {
+  // The requests live in the head section, which the memory plan reuses, so
+  // they are recorded before the plan is committed.
+  const internal::ScratchBufferRequest* requests = GetScratchBufferRequests();
+  for (size_t i = 0; i < scratch_buffer_request_count(); ++i) {
+    recorded_scratch_buffer_data_.requested_bytes += requests[i].bytes;
+    recorded_scratch_buffer_data_.used_bytes += requests[i].bytes;
+    recorded_scratch_buffer_data_.count++;
+    if (recorded_scratch_buffer_request_count_ <
+        kMaxRecordedScratchBufferRequests) {
+      recorded_scratch_buffer_requests_
+          [recorded_scratch_buffer_request_count_++] = requests[i];
+    }
+  }
+  return MicroAllocator::CommitStaticMemoryPlan(model, subgraph, eval_tensors,
+                                                scratch_buffer_handles);
+}
+
 TfLiteTensor* RecordingMicroAllocator::AllocatePersistentTfLiteTensorInternal(
     const Model* model, TfLiteEvalTensor* eval_tensors, int tensor_index) {
   RecordedAllocation allocations = SnapshotAllocationUsage();
@@ -24,7 +24,6 @@ namespace tflite {
 
 // List of buckets currently recorded by this class. Each type keeps a list of
 // allocated information during model initialization.
-// TODO(b/169834511): Add tracking for scratch buffer allocations.
 enum class RecordedAllocationType {
   kTfLiteEvalTensorData,
   kPersistentTfLiteTensorData,
@@ -33,6 +32,9 @@ enum class RecordedAllocationType {
   kTfLiteTensorVariableBufferData,
   kNodeAndRegistrationArray,
   kOpData,
+  // Scratch buffers share the head section according to the memory plan, so
+  // their used bytes are the requested bytes rather than arena usage.
+  kScratchBufferData,
 };
 
 // Container for holding information about allocation recordings by a given
@@ -64,6 +66,15 @@ class RecordingMicroAllocator : public MicroAllocator {
 
   const RecordingSimpleMemoryAllocator* GetSimpleMemoryAllocator() const;
 
+  // Returns the bytes of scratch buffers requested by the node with the given
+  // index. Only the first kMaxRecordedScratchBufferRequests requests of all
+  // nodes are recorded.
+  size_t GetScratchBufferBytes(int node_index) const;
+
+  // Returns the high-water mark of the arena since the model finished
+  // allocating, including the temporary allocations made while invoking it.
+  size_t GetArenaHighWaterMarkBytes() const;
+
   // Logs out through the ErrorReporter all allocation recordings by type
   // defined in RecordedAllocationType.
   void PrintAllocations() const;
@@ -81,6 +92,10 @@ class RecordingMicroAllocator : public MicroAllocator {
       const Model* model, TfLiteEvalTensor** eval_tensors) override;
   TfLiteStatus AllocateVariables(const SubGraph* subgraph,
                                  TfLiteEvalTensor* eval_tensors) override;
+  TfLiteStatus CommitStaticMemoryPlan(
+      const Model* model, const SubGraph* subgraph,
+      TfLiteEvalTensor* eval_tensors,
+      ScratchBufferHandle* scratch_buffer_handles) override;
   // TODO(b/162311891): Once all kernels have been updated to the new API drop
   // this method. It is only used to record TfLiteTensor persistent allocations.
   TfLiteTensor* AllocatePersistentTfLiteTensorInternal(
@@ -107,7 +122,11 @@ class RecordingMicroAllocator : public MicroAllocator {
   void RecordAllocationUsage(const RecordedAllocation& snapshotted_allocation,
                              RecordedAllocation& recorded_allocation);
 
-  const RecordingSimpleMemoryAllocator* recording_memory_allocator_;
+  // Maximum number of scratch buffer requests recorded for
+  // GetScratchBufferBytes().
+  static constexpr int kMaxRecordedScratchBufferRequests = 32;
+
+  RecordingSimpleMemoryAllocator* recording_memory_allocator_;
 
   RecordedAllocation recorded_tflite_eval_tensor_data_ = {};
   RecordedAllocation recorded_persistent_tflite_tensor_data_ = {};
@@ -116,6 +135,10 @@ class RecordingMicroAllocator : public MicroAllocator {
   RecordedAllocation recorded_tflite_tensor_variable_buffer_data_ = {};
   RecordedAllocation recorded_node_and_registration_array_data_ = {};
   RecordedAllocation recorded_op_data_ = {};
+  RecordedAllocation recorded_scratch_buffer_data_ = {};
+  internal::ScratchBufferRequest
+      recorded_scratch_buffer_requests_[kMaxRecordedScratchBufferRequests];
+  int recorded_scratch_buffer_request_count_ = 0;
 
   TF_LITE_REMOVE_VIRTUAL_DELETE
 };
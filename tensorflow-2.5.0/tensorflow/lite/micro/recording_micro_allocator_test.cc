@@ -277,6 +277,65 @@ TF_LITE_MICRO_TEST(TestRecordsPersistentBufferData) {
                           static_cast<size_t>(150));
 }
 
+TF_LITE_MICRO_TEST(TestRecordsScratchBufferDataAndHighWaterMark) {
+  TfLiteEvalTensor* eval_tensors = nullptr;
+  tflite::ScratchBufferHandle* scratch_buffer_handles = nullptr;
+  tflite::AllOpsResolver all_ops_resolver;
+  tflite::NodeAndRegistration* node_and_registration;
+  const tflite::Model* model = tflite::GetModel(kTestConvModelData);
+  uint8_t arena[kTestConvArenaSize];
+
+  tflite::RecordingMicroAllocator* micro_allocator =
+      tflite::RecordingMicroAllocator::Create(arena, kTestConvArenaSize,
+                                              tflite::GetMicroErrorReporter());
+  TF_LITE_MICRO_EXPECT_NE(micro_allocator, nullptr);
+  if (micro_allocator == nullptr) return 1;
+
+  TfLiteStatus status;
+  status = micro_allocator->StartModelAllocation(
+      model, all_ops_resolver, &node_and_registration, &eval_tensors);
+  TF_LITE_MICRO_EXPECT_EQ(status, kTfLiteOk);
+  if (status != kTfLiteOk) return 1;
+
+  // Request a scratch buffer on behalf of the first node:
+  int buffer_index = -1;
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          micro_allocator->RequestScratchBufferInArena(
+                              /*bytes=*/64, &buffer_index));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          micro_allocator->FinishPrepareNodeAllocations(
+                              /*node_id=*/0));
+
+  status = micro_allocator->FinishModelAllocation(model, eval_tensors,
+                                                  &scratch_buffer_handles);
+  TF_LITE_MICRO_EXPECT_EQ(status, kTfLiteOk);
+  if (status != kTfLiteOk) return 1;
+
+  tflite::RecordedAllocation recorded_allocation =
+      micro_allocator->GetRecordedAllocation(
+          tflite::RecordedAllocationType::kScratchBufferData);
+  TF_LITE_MICRO_EXPECT_EQ(recorded_allocation.count, static_cast<size_t>(1));
+  TF_LITE_MICRO_EXPECT_EQ(recorded_allocation.requested_bytes,
+                          static_cast<size_t>(64));
+  TF_LITE_MICRO_EXPECT_EQ(micro_allocator->GetScratchBufferBytes(0),
+                          static_cast<size_t>(64));
+  TF_LITE_MICRO_EXPECT_EQ(micro_allocator->GetScratchBufferBytes(1),
+                          static_cast<size_t>(0));
+
+  // The high-water mark starts at the usage of the allocated model and keeps
+  // the largest temp allocation made afterwards:
+  const size_t used_bytes = micro_allocator->used_bytes();
+  TF_LITE_MICRO_EXPECT_EQ(micro_allocator->GetArenaHighWaterMarkBytes(),
+                          used_bytes);
+  TF_LITE_MICRO_EXPECT_NE(
+      micro_allocator->AllocateTempTfLiteTensor(model, eval_tensors,
+                                                /*tensor_index=*/0),
+      nullptr);
+  micro_allocator->ResetTempAllocations();
+  TF_LITE_MICRO_EXPECT_GT(micro_allocator->GetArenaHighWaterMarkBytes(),
+                          used_bytes);
+}
+
 // TODO(b/158124094): Find a way to audit OpData allocations on
 // cross-architectures.
 
@@ -27,7 +27,8 @@ RecordingSimpleMemoryAllocator::RecordingSimpleMemoryAllocator(
       requested_head_bytes_(0),
       requested_tail_bytes_(0),
       used_bytes_(0),
-      alloc_count_(0) {}
+      alloc_count_(0),
+      max_used_bytes_(0) {}
 
 RecordingSimpleMemoryAllocator::~RecordingSimpleMemoryAllocator() {}
 
@@ -57,6 +58,14 @@ size_t RecordingSimpleMemoryAllocator::GetAllocatedCount() const {
   return alloc_count_;
 }
 
+size_t RecordingSimpleMemoryAllocator::GetMaxUsedBytes() const {
+  return max_used_bytes_;
+}
+
+void RecordingSimpleMemoryAllocator::ResetMaxUsedBytes() {
+  max_used_bytes_ = SimpleMemoryAllocator::GetUsedBytes();
+}
+
 TfLiteStatus RecordingSimpleMemoryAllocator::SetHeadBufferSize(
     size_t size, size_t alignment) {
   const uint8_t* previous_head = head();
@@ -65,6 +74,7 @@ TfLiteStatus RecordingSimpleMemoryAllocator::SetHeadBufferSize(
   if (status == kTfLiteOk) {
     used_bytes_ += head() - previous_head;
     requested_head_bytes_ = size;
+    UpdateMaxUsedBytes();
   }
   return status;
 }
@@ -77,8 +87,25 @@ uint8_t* RecordingSimpleMemoryAllocator::AllocateFromTail(size_t size,
     used_bytes_ += previous_tail - tail();
     requested_tail_bytes_ += size;
     alloc_count_++;
+    UpdateMaxUsedBytes();
+  }
+  return result;
+}
+
+uint8_t* RecordingSimpleMemoryAllocator::AllocateTemp(size_t size,
+                                                      size_t alignment) {
+  uint8_t* result = SimpleMemoryAllocator::AllocateTemp(size, alignment);
+  if (result != nullptr) {
+    UpdateMaxUsedBytes();
   }
   return result;
 }
 
+void RecordingSimpleMemoryAllocator::UpdateMaxUsedBytes() {
+  const size_t used_bytes = SimpleMemoryAllocator::GetUsedBytes();
+  if (used_bytes > max_used_bytes_) {
+    max_used_bytes_ = used_bytes;
+  }
+}
+
 }  // namespace tflite
@@ -47,14 +47,27 @@ class RecordingSimpleMemoryAllocator : public SimpleMemoryAllocator {
   // Returns the number of alloc calls from the head or tail.
   size_t GetAllocatedCount() const;
 
+  // Returns the largest number of bytes in use at any point since the last
+  // call to ResetMaxUsedBytes(), including temporary allocations. This is the
+  // high-water mark of the arena.
+  size_t GetMaxUsedBytes() const;
+
+  // Restarts tracking of the high-water mark from the current usage.
+  void ResetMaxUsedBytes();
+
   TfLiteStatus SetHeadBufferSize(size_t size, size_t alignment) override;
   uint8_t* AllocateFromTail(size_t size, size_t alignment) override;
+  uint8_t* AllocateTemp(size_t size, size_t alignment) override;
 
  private:
+  // Raises the high-water mark to the current usage if that is higher.
+  void UpdateMaxUsedBytes();
+
   size_t requested_head_bytes_;
   size_t requested_tail_bytes_;
   size_t used_bytes_;
   size_t alloc_count_;
+  size_t max_used_bytes_;
 
   TF_LITE_REMOVE_VIRTUAL_DELETE
 };
@@ -135,4 +135,32 @@ TF_LITE_MICRO_TEST(TestDoesNotRecordFailedTailAllocations) {
                           static_cast<size_t>(0));
 }
 
+TF_LITE_MICRO_TEST(TestRecordsMaxUsedBytesIncludingTempAllocations) {
+  constexpr size_t arena_size = 1024;
+  uint8_t arena[arena_size];
+  tflite::RecordingSimpleMemoryAllocator allocator(
+      tflite::GetMicroErrorReporter(), arena, arena_size);
+
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, allocator.SetHeadBufferSize(/*size=*/100, /*alignment=*/1));
+  TF_LITE_MICRO_EXPECT_NE(
+      allocator.AllocateFromTail(/*size=*/10, /*alignment=*/1), nullptr);
+  TF_LITE_MICRO_EXPECT_EQ(allocator.GetMaxUsedBytes(),
+                          static_cast<size_t>(110));
+
+  TF_LITE_MICRO_EXPECT_NE(allocator.AllocateTemp(/*size=*/50, /*alignment=*/1),
+                          nullptr);
+  TF_LITE_MICRO_EXPECT_EQ(allocator.GetMaxUsedBytes(),
+                          static_cast<size_t>(160));
+
+  // Releasing the temp allocation keeps the high-water mark:
+  allocator.ResetTempAllocations();
+  TF_LITE_MICRO_EXPECT_EQ(allocator.GetMaxUsedBytes(),
+                          static_cast<size_t>(160));
+
+  allocator.ResetMaxUsedBytes();
+  TF_LITE_MICRO_EXPECT_EQ(allocator.GetMaxUsedBytes(),
+                          static_cast<size_t>(110));
+}
+
 TF_LITE_MICRO_TESTS_END
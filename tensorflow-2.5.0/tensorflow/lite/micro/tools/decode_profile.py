@@ -0,0 +1,80 @@
+# Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Decodes the per-tag stats written by MicroProfiler::SerializeTagStats().
+
+The serialized stats are usually dumped from the target's memory, e.g. with a
+debugger, or sent over the serial port. This script prints them as a table
+sorted by total ticks, converting ticks to microseconds when the target reports
+its clock frequency:
+
+  python3 decode_profile.py profile.bin
+"""
+
+import argparse
+import struct
+
+_MAGIC = b"TFMP"
+_VERSION = 1
+
+
+def decode(data):
+  """Returns ticks per second and a list of (tag, count, total, min, max)."""
+  if data[:4] != _MAGIC:
+    raise ValueError("Not a MicroProfiler dump: bad magic.")
+  version, ticks_per_second, num_tags = struct.unpack_from("<BIH", data, 4)
+  if version != _VERSION:
+    raise ValueError("Unsupported MicroProfiler dump version %d." % version)
+  offset = 4 + struct.calcsize("<BIH")
+  stats = []
+  for _ in range(num_tags):
+    tag_length = data[offset]
+    offset += 1
+    tag = data[offset:offset + tag_length].decode("utf-8", "replace")
+    offset += tag_length
+    count, total, min_ticks, max_ticks = struct.unpack_from(
+        "<IQII", data, offset)
+    offset += struct.calcsize("<IQII")
+    stats.append((tag, count, total, min_ticks, max_ticks))
+  return ticks_per_second, stats
+
+
+def main():
+  parser = argparse.ArgumentParser(description=__doc__)
+  parser.add_argument("dump", help="File with the serialized MicroProfiler "
+                      "stats.")
+  args = parser.parse_args()
+
+  with open(args.dump, "rb") as dump:
+    ticks_per_second, stats = decode(dump.read())
+
+  unit = "us" if ticks_per_second else "ticks"
+
+  def to_unit(ticks):
+    if ticks_per_second:
+      return ticks * 1e6 / ticks_per_second
+    return ticks
+
+  grand_total = sum(s[2] for s in stats) or 1
+  print("%-32s %8s %12s %12s %12s %7s" %
+        ("tag", "count", "avg " + unit, "min " + unit, "max " + unit, "%"))
+  for tag, count, total, min_ticks, max_ticks in sorted(
+      stats, key=lambda s: s[2], reverse=True):
+    print("%-32s %8d %12.1f %12.1f %12.1f %6.1f%%" %
+          (tag, count, to_unit(total / count), to_unit(min_ticks),
+           to_unit(max_ticks), 100.0 * total / grand_total))
+
+
+if __name__ == "__main__":
+  main()
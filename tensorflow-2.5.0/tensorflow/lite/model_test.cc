@@ -662,6 +662,84 @@ TEST(BasicFlatBufferModel, TestHandleModelWithWhileOpContainsForwardingInput) {
   ASSERT_EQ(interpreter->Invoke(), kTfLiteOk);
 }
 
+TEST(BasicFlatBufferModel, TestSkipUnreachableSubgraphs) {
+  // Two subgraphs with one ADD op each. Nothing runs the second one.
+  flatbuffers::FlatBufferBuilder builder;
+  const int32_t shape[1] = {3};
+  const int32_t inputs[2] = {0, 1};
+  const int32_t outputs[1] = {2};
+  flatbuffers::Offset<OperatorCode> op_code =
+      CreateOperatorCode(builder, BuiltinOperator_ADD);
+  flatbuffers::Offset<SubGraph> subgraphs[2];
+  for (auto& subgraph : subgraphs) {
+    flatbuffers::Offset<Tensor> tensors[3] = {
+        CreateTensor(builder, builder.CreateVector<int32_t>(shape, 1),
+                     TensorType_FLOAT32),
+        CreateTensor(builder, builder.CreateVector<int32_t>(shape, 1),
+                     TensorType_FLOAT32),
+        CreateTensor(builder, builder.CreateVector<int32_t>(shape, 1),
+                     TensorType_FLOAT32),
+    };
+    flatbuffers::Offset<Operator> op = CreateOperator(
+        builder, /*opcode_index=*/0, builder.CreateVector<int32_t>(inputs, 2),
+        builder.CreateVector<int32_t>(outputs, 1));
+    subgraph = CreateSubGraph(builder, builder.CreateVector(tensors, 3),
+                              builder.CreateVector<int32_t>(inputs, 2),
+                              builder.CreateVector<int32_t>(outputs, 1),
+                              builder.CreateVector(&op, 1));
+  }
+  flatbuffers::Offset<Buffer> buffers[1] = {
+      CreateBuffer(builder, builder.CreateVector({})),
+  };
+  flatbuffers::Offset<Model> model_buffer = CreateModel(
+      builder, TFLITE_SCHEMA_VERSION, builder.CreateVector(&op_code, 1),
+      builder.CreateVector(subgraphs, 2), builder.CreateString("test_model"),
+      builder.CreateVector(buffers, 1));
+  builder.Finish(model_buffer);
+  const Model* model = GetModel(builder.GetBufferPointer());
+
+  TrivialResolver resolver(&dummy_reg);
+  std::unique_ptr<Interpreter> interpreter;
+  ASSERT_EQ(InterpreterBuilder(model, resolver)
+                .SkipUnreachableSubgraphsExperimental()(&interpreter),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter->subgraphs_size(), 2);
+  EXPECT_EQ(interpreter->subgraph(0)->tensors_size(), 3);
+  EXPECT_EQ(interpreter->subgraph(0)->nodes_size(), 1);
+  EXPECT_EQ(interpreter->subgraph(1)->tensors_size(), 0);
+  EXPECT_EQ(interpreter->subgraph(1)->nodes_size(), 0);
+  EXPECT_EQ(interpreter->AllocateTensors(), kTfLiteOk);
+
+  // Without the option every subgraph is built.
+  ASSERT_EQ(InterpreterBuilder(model, resolver)(&interpreter), kTfLiteOk);
+  EXPECT_EQ(interpreter->subgraph(1)->tensors_size(), 3);
+  EXPECT_EQ(interpreter->subgraph(1)->nodes_size(), 1);
+}
+
+// Subgraphs run by control flow ops are reachable and still get built.
+TEST(BasicFlatBufferModel, TestSkipUnreachableSubgraphsKeepsWhileBody) {
+  std::unique_ptr<tflite::FlatBufferModel> model =
+      FlatBufferModel::BuildFromFile(
+          "tensorflow/lite/testdata/while_op_with_forwarding_input.bin");
+  ASSERT_NE(model, nullptr);
+
+  tflite::ops::builtin::BuiltinOpResolver resolver;
+  InterpreterBuilder builder(*model, resolver);
+  builder.SkipUnreachableSubgraphsExperimental();
+  std::unique_ptr<Interpreter> interpreter;
+  ASSERT_EQ(builder(&interpreter), kTfLiteOk);
+  ASSERT_EQ(interpreter->subgraphs_size(), 3);
+  EXPECT_GT(interpreter->subgraph(1)->nodes_size(), 0);
+  EXPECT_GT(interpreter->subgraph(2)->nodes_size(), 0);
+  ASSERT_EQ(interpreter->AllocateTensors(), kTfLiteOk);
+
+  interpreter->typed_tensor<int32_t>(0)[0] = 20;
+  DynamicBuffer buf;
+  buf.AddString("a", 1);
+  buf.WriteToTensor(interpreter->tensor(1), /*new_shape=*/nullptr);
+  ASSERT_EQ(interpreter->Invoke(), kTfLiteOk);
+}
+
 // TODO(aselle): Add tests for serialization of builtin op data types.
 // These tests will occur with the evaluation tests of individual operators,
 // not here.
@@ -0,0 +1,192 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/profiling/op_latency_stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <sstream>
+
+#include "flatbuffers/flexbuffers.h"  // from @flatbuffers
+#include "flatbuffers/idl.h"  // from @flatbuffers
+
+namespace tflite {
+namespace profiling {
+namespace {
+
+// Returns the nearest-rank percentile of sorted samples.
+int64_t Percentile(const std::vector<int64_t>& sorted, int percent) {
+  size_t rank = (sorted.size() * percent + 99) / 100;
+  return sorted[std::max<size_t>(rank, 1) - 1];
+}
+
+void AppendJsonString(const std::string& value, std::ostringstream* stream) {
+  (*stream) << '"';
+  for (char c : value) {
+    if (c == '"' || c == '\\') {
+      (*stream) << '\\' << c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char escaped[7];
+      snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+      (*stream) << escaped;
+    } else {
+      (*stream) << c;
+    }
+  }
+  (*stream) << '"';
+}
+
+}  // namespace
+
+void OpLatencyRecorder::AddSample(const std::string& name,
+                                  const std::string& type,
+                                  int64_t latency_us) {
+  auto it = samples_.find(name);
+  if (it == samples_.end()) {
+    names_.push_back(name);
+    it = samples_.emplace(name, Samples{type, {}}).first;
+  }
+  it->second.latencies_us.push_back(latency_us);
+}
+
+std::vector<OpLatencyStats> OpLatencyRecorder::GetStats() const {
+  std::vector<OpLatencyStats> stats;
+  for (const auto& name : names_) {
+    const Samples& samples = samples_.at(name);
+    std::vector<int64_t> sorted = samples.latencies_us;
+    std::sort(sorted.begin(), sorted.end());
+
+    OpLatencyStats op;
+    op.name = name;
+    op.type = samples.type;
+    op.count = sorted.size();
+    double sum = 0;
+    for (int64_t latency : sorted) sum += latency;
+    op.mean_us = sum / op.count;
+    if (op.count > 1) {
+      double squared_diffs = 0;
+      for (int64_t latency : sorted) {
+        squared_diffs += (latency - op.mean_us) * (latency - op.mean_us);
+      }
+      op.std_dev_us = std::sqrt(squared_diffs / (op.count - 1));
+    }
+    op.p50_us = Percentile(sorted, 50);
+    op.p90_us = Percentile(sorted, 90);
+    op.p99_us = Percentile(sorted, 99);
+    stats.push_back(op);
+  }
+  return stats;
+}
+
+std::string OpLatencyStatsToJson(const std::vector<OpLatencyStats>& stats) {
+  std::ostringstream stream;
+  stream.precision(std::numeric_limits<double>::max_digits10);
+  stream << "{\"ops\": [";
+  for (size_t i = 0; i < stats.size(); ++i) {
+    const OpLatencyStats& op = stats[i];
+    stream << (i == 0 ? "\n" : ",\n") << "  {\"name\": ";
+    AppendJsonString(op.name, &stream);
+    stream << ", \"type\": ";
+    AppendJsonString(op.type, &stream);
+    stream << ", \"count\": " << op.count << ", \"mean_us\": " << op.mean_us
+           << ", \"std_dev_us\": " << op.std_dev_us
+           << ", \"p50_us\": " << op.p50_us << ", \"p90_us\": " << op.p90_us
+           << ", \"p99_us\": " << op.p99_us << "}";
+  }
+  stream << "\n]}\n";
+  return stream.str();
+}
+
+bool OpLatencyStatsFromJson(const std::string& json,
+                            std::vector<OpLatencyStats>* stats,
+                            std::string* error) {
+  flatbuffers::Parser parser;
+  flexbuffers::Builder builder;
+  if (!parser.ParseFlexBuffer(json.c_str(), nullptr, &builder)) {
+    *error = parser.error_;
+    return false;
+  }
+  const flexbuffers::Reference root = flexbuffers::GetRoot(builder.GetBuffer());
+  if (!root.IsMap() || !root.AsMap()["ops"].IsVector()) {
+    *error = "expected an object with an \"ops\" array";
+    return false;
+  }
+  const flexbuffers::Vector ops = root.AsMap()["ops"].AsVector();
+  stats->clear();
+  for (size_t i = 0; i < ops.size(); ++i) {
+    if (!ops[i].IsMap()) {
+      *error = "expected an object for op " + std::to_string(i);
+      return false;
+    }
+    const flexbuffers::Map op = ops[i].AsMap();
+    if (!op["name"].IsString() || !op["count"].IsNumeric() ||
+        !op["mean_us"].IsNumeric()) {
+      *error = "missing name, count or mean_us for op " + std::to_string(i);
+      return false;
+    }
+    OpLatencyStats op_stats;
+    op_stats.name = op["name"].AsString().str();
+    op_stats.type = op["type"].AsString().str();
+    op_stats.count = op["count"].AsInt64();
+    op_stats.mean_us = op["mean_us"].AsDouble();
+    op_stats.std_dev_us = op["std_dev_us"].AsDouble();
+    op_stats.p50_us = op["p50_us"].AsInt64();
+    op_stats.p90_us = op["p90_us"].AsInt64();
+    op_stats.p99_us = op["p99_us"].AsInt64();
+    stats->push_back(op_stats);
+  }
+  return true;
+}
+
+std::vector<OpLatencyRegression> FindOpLatencyRegressions(
+    const std::vector<OpLatencyStats>& baseline,
+    const std::vector<OpLatencyStats>& current,
+    const OpLatencyRegressionOptions& options) {
+  std::map<std::string, const OpLatencyStats*> baseline_by_name;
+  for (const auto& op : baseline) {
+    baseline_by_name[op.name] = &op;
+  }
+
+  std::vector<OpLatencyRegression> regressions;
+  for (const auto& op : current) {
+    auto it = baseline_by_name.find(op.name);
+    if (it == baseline_by_name.end() || op.count == 0 ||
+        it->second->count == 0) {
+      continue;
+    }
+    const OpLatencyStats& base = *it->second;
+    const double increase = op.mean_us - base.mean_us;
+    if (increase <= options.min_relative_increase * base.mean_us) {
+      continue;
+    }
+    const double standard_error =
+        std::sqrt(base.std_dev_us * base.std_dev_us / base.count +
+                  op.std_dev_us * op.std_dev_us / op.count);
+    const double t_statistic = standard_error > 0
+                                   ? increase / standard_error
+                                   : std::numeric_limits<double>::infinity();
+    if (t_statistic < options.min_t_statistic) {
+      continue;
+    }
+    regressions.push_back(
+        {op.name, op.type, base.mean_us, op.mean_us, t_statistic});
+  }
+  return regressions;
+}
+
+}  // namespace profiling
+}  // namespace tflite
@@ -0,0 +1,102 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_PROFILING_OP_LATENCY_STATS_H_
+#define TENSORFLOW_LITE_PROFILING_OP_LATENCY_STATS_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace tflite {
+namespace profiling {
+
+// Latency distribution of a single operator over all profiled invocations.
+struct OpLatencyStats {
+  // Unique name of the operator, e.g. the name of its output and its node
+  // index.
+  std::string name;
+  // Operator type, e.g. "CONV_2D".
+  std::string type;
+  int64_t count = 0;
+  double mean_us = 0;
+  double std_dev_us = 0;
+  int64_t p50_us = 0;
+  int64_t p90_us = 0;
+  int64_t p99_us = 0;
+};
+
+// Collects the latency of every invocation of each operator, so that their
+// percentiles can be computed.
+class OpLatencyRecorder {
+ public:
+  void AddSample(const std::string& name, const std::string& type,
+                 int64_t latency_us);
+
+  // Returns the stats of all operators, in the order they were first seen.
+  std::vector<OpLatencyStats> GetStats() const;
+
+  bool empty() const { return samples_.empty(); }
+
+ private:
+  struct Samples {
+    std::string type;
+    std::vector<int64_t> latencies_us;
+  };
+  std::vector<std::string> names_;
+  std::map<std::string, Samples> samples_;
+};
+
+// Serializes the stats as a JSON object of the form
+// {"ops": [{"name": ..., "type": ..., "count": ..., "mean_us": ..., ...}]}.
+std::string OpLatencyStatsToJson(const std::vector<OpLatencyStats>& stats);
+
+// Parses stats serialized by OpLatencyStatsToJson(). Returns false and sets
+// `error` if `json` is malformed.
+bool OpLatencyStatsFromJson(const std::string& json,
+                            std::vector<OpLatencyStats>* stats,
+                            std::string* error);
+
+// An operator that got significantly slower than in a baseline.
+struct OpLatencyRegression {
+  std::string name;
+  std::string type;
+  double baseline_mean_us;
+  double mean_us;
+  // Welch's t-statistic of the difference of the means.
+  double t_statistic;
+};
+
+struct OpLatencyRegressionOptions {
+  // Minimum increase of the mean latency, relative to the baseline.
+  double min_relative_increase = 0.1;
+  // Minimum Welch's t-statistic for the increase to be significant. 3 is
+  // roughly a 99.9% one-sided confidence for the sample counts of benchmarks.
+  double min_t_statistic = 3.0;
+};
+
+// Returns the operators of `current` whose mean latency increased by more than
+// the thresholds of `options` compared to the operator with the same name in
+// `baseline`. Operators that only appear in one of them are ignored.
+std::vector<OpLatencyRegression> FindOpLatencyRegressions(
+    const std::vector<OpLatencyStats>& baseline,
+    const std::vector<OpLatencyStats>& current,
+    const OpLatencyRegressionOptions& options = OpLatencyRegressionOptions());
+
+}  // namespace profiling
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_PROFILING_OP_LATENCY_STATS_H_
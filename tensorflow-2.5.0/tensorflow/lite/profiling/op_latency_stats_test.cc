@@ -0,0 +1,121 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/profiling/op_latency_stats.h"
+
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace profiling {
+
+namespace {
+
+TEST(OpLatencyStatsTest, Percentiles) {
+  OpLatencyRecorder recorder;
+  EXPECT_TRUE(recorder.empty());
+  for (int i = 100; i >= 1; --i) {
+    recorder.AddSample("conv:0", "CONV_2D", i);
+  }
+  recorder.AddSample("add:1", "ADD", 7);
+
+  std::vector<OpLatencyStats> stats = recorder.GetStats();
+  ASSERT_EQ(stats.size(), 2);
+  EXPECT_EQ(stats[0].name, "conv:0");
+  EXPECT_EQ(stats[0].type, "CONV_2D");
+  EXPECT_EQ(stats[0].count, 100);
+  EXPECT_DOUBLE_EQ(stats[0].mean_us, 50.5);
+  EXPECT_NEAR(stats[0].std_dev_us, 29.01, 0.01);
+  EXPECT_EQ(stats[0].p50_us, 50);
+  EXPECT_EQ(stats[0].p90_us, 90);
+  EXPECT_EQ(stats[0].p99_us, 99);
+
+  EXPECT_EQ(stats[1].name, "add:1");
+  EXPECT_EQ(stats[1].count, 1);
+  EXPECT_EQ(stats[1].std_dev_us, 0);
+  EXPECT_EQ(stats[1].p50_us, 7);
+  EXPECT_EQ(stats[1].p99_us, 7);
+}
+
+TEST(OpLatencyStatsTest, JsonRoundTrip) {
+  OpLatencyRecorder recorder;
+  recorder.AddSample("out \"1\":0", "CONV_2D", 10);
+  recorder.AddSample("out \"1\":0", "CONV_2D", 13);
+  recorder.AddSample("Delegate/XNNPACK:1", "DelegateOpInvoke", 4);
+  const std::vector<OpLatencyStats> stats = recorder.GetStats();
+
+  std::vector<OpLatencyStats> parsed;
+  std::string error;
+  ASSERT_TRUE(
+      OpLatencyStatsFromJson(OpLatencyStatsToJson(stats), &parsed, &error))
+      << error;
+  ASSERT_EQ(parsed.size(), stats.size());
+  for (size_t i = 0; i < stats.size(); ++i) {
+    EXPECT_EQ(parsed[i].name, stats[i].name);
+    EXPECT_EQ(parsed[i].type, stats[i].type);
+    EXPECT_EQ(parsed[i].count, stats[i].count);
+    EXPECT_DOUBLE_EQ(parsed[i].mean_us, stats[i].mean_us);
+    EXPECT_DOUBLE_EQ(parsed[i].std_dev_us, stats[i].std_dev_us);
+    EXPECT_EQ(parsed[i].p50_us, stats[i].p50_us);
+    EXPECT_EQ(parsed[i].p90_us, stats[i].p90_us);
+    EXPECT_EQ(parsed[i].p99_us, stats[i].p99_us);
+  }
+
+  EXPECT_FALSE(OpLatencyStatsFromJson("{\"ops\": [", &parsed, &error));
+  EXPECT_FALSE(OpLatencyStatsFromJson("[]", &parsed, &error));
+  EXPECT_FALSE(
+      OpLatencyStatsFromJson("{\"ops\": [{\"count\": 1}]}", &parsed, &error));
+}
+
+TEST(OpLatencyStatsTest, FindRegressions) {
+  std::vector<OpLatencyStats> baseline(3);
+  baseline[0].name = "conv:0";
+  baseline[1].name = "add:1";
+  baseline[2].name = "removed:2";
+  for (auto& op : baseline) {
+    op.count = 100;
+    op.mean_us = 100;
+    op.std_dev_us = 10;
+  }
+
+  std::vector<OpLatencyStats> current = baseline;
+  // Significant and larger than the threshold.
+  current[0].mean_us = 120;
+  // Larger than the threshold, but too noisy to be significant.
+  current[1].mean_us = 120;
+  current[1].std_dev_us = 100;
+  current[2].name = "added:3";
+  current[2].mean_us = 1000;
+
+  std::vector<OpLatencyRegression> regressions =
+      FindOpLatencyRegressions(baseline, current);
+  ASSERT_EQ(regressions.size(), 1);
+  EXPECT_EQ(regressions[0].name, "conv:0");
+  EXPECT_DOUBLE_EQ(regressions[0].baseline_mean_us, 100);
+  EXPECT_DOUBLE_EQ(regressions[0].mean_us, 120);
+  EXPECT_NEAR(regressions[0].t_statistic, 14.14, 0.01);
+
+  // Significant, but smaller than the threshold.
+  OpLatencyRegressionOptions options;
+  options.min_relative_increase = 0.5;
+  EXPECT_TRUE(FindOpLatencyRegressions(baseline, current, options).empty());
+}
+
+}  // namespace
+}  // namespace profiling
+}  // namespace tflite
@@ -156,6 +156,11 @@ void ProfileSummarizer::ProcessProfiles(
       stats_calculator->AddNodeStats(node_name_in_stats, type_in_stats,
                                      node_num, start_us, node_exec_time,
                                      0 /*memory */);
+      op_latency_recorder_.AddSample(
+          subgraph_index == 0 ? node_name_in_stats
+                              : "Subgraph " + std::to_string(subgraph_index) +
+                                    "/" + node_name_in_stats,
+          type_in_stats, node_exec_time);
     } else if (event->event_type ==
                Profiler::EventType::DELEGATE_OPERATOR_INVOKE_EVENT) {
       const std::string node_name(event->tag);
@@ -167,6 +172,8 @@ void ProfileSummarizer::ProcessProfiles(
       delegate_stats_calculator_->AddNodeStats(
           node_name_in_stats, "DelegateOpInvoke", node_num, start_us,
           node_exec_time, 0 /*memory */);
+      op_latency_recorder_.AddSample(node_name_in_stats, "DelegateOpInvoke",
+                                     node_exec_time);
     } else {
       // TODO(b/139812778) consider use a different stats_calculator to record
       // non-op-invoke events so that these could be separated from
@@ -22,6 +22,7 @@ limitations under the License.
 
 #include "tensorflow/core/util/stats_calculator.h"
 #include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/profiling/op_latency_stats.h"
 #include "tensorflow/lite/profiling/profile_buffer.h"
 #include "tensorflow/lite/profiling/profile_summary_formatter.h"
 
@@ -52,6 +53,12 @@ class ProfileSummarizer {
                                                *delegate_stats_calculator_);
   }
 
+  // Returns the latency distribution of each operator, including the ones run
+  // by delegates, over all processed profiles.
+  std::vector<OpLatencyStats> GetOpLatencyStats() const {
+    return op_latency_recorder_.GetStats();
+  }
+
   tensorflow::StatsCalculator* GetStatsCalculator(uint32_t subgraph_index);
 
   bool HasProfiles() {
@@ -69,6 +76,10 @@ class ProfileSummarizer {
 
   std::unique_ptr<tensorflow::StatsCalculator> delegate_stats_calculator_;
 
+  // Keeps the latency of every operator invocation for percentiles, which the
+  // stats calculators don't track.
+  OpLatencyRecorder op_latency_recorder_;
+
   // Summary formatter for customized output formats.
   std::shared_ptr<ProfileSummaryFormatter> summary_formatter_;
 };
@@ -127,6 +127,29 @@ TEST(ProfileSummarizerTest, Interpreter) {
   ASSERT_TRUE(output.find("Invoke") == std::string::npos) << output;  // NOLINT
 }
 
+TEST(ProfileSummarizerTest, OpLatencyStats) {
+  BufferedProfiler profiler(1024);
+  SimpleOpModel m;
+  m.Init(RegisterSimpleOp);
+  auto interpreter = m.GetInterpreter();
+  interpreter->SetProfiler(&profiler);
+  ProfileSummarizer summarizer;
+  EXPECT_TRUE(summarizer.GetOpLatencyStats().empty());
+  for (int run = 0; run < 3; ++run) {
+    profiler.Reset();
+    profiler.StartProfiling();
+    m.SetInputs(1, 2);
+    m.Invoke();
+    profiler.StopProfiling();
+    summarizer.ProcessProfiles(profiler.GetProfileEvents(), *interpreter);
+  }
+  auto stats = summarizer.GetOpLatencyStats();
+  ASSERT_EQ(stats.size(), 1);
+  EXPECT_EQ(stats[0].type, "SimpleOpEval");
+  EXPECT_EQ(stats[0].count, 3);
+  EXPECT_LE(stats[0].p50_us, stats[0].p99_us);
+}
+
 TEST(ProfileSummarizerTest, InterpreterPlusProfilingDetails) {
   BufferedProfiler profiler(1024);
   SimpleOpModel m;
@@ -17,6 +17,8 @@ limitations under the License.
 #include <memory>
 #include <sstream>
 #include <string>
+#include <unordered_set>
+#include <vector>
 
 #include "absl/memory/memory.h"
 #include "absl/strings/str_format.h"
@@ -393,7 +395,15 @@ PyObject* CalibrationWrapper::QuantizeModel(int input_py_type,
                                             int output_py_type,
                                             bool allow_float,
                                             const char* operator_output_name) {
-  string op_name = std::string(operator_output_name);
+  return QuantizeModel(input_py_type, output_py_type, allow_float,
+                       std::vector<std::string>{operator_output_name});
+}
+
+PyObject* CalibrationWrapper::QuantizeModel(
+    int input_py_type, int output_py_type, bool allow_float,
+    const std::vector<std::string>& operator_output_names) {
+  const std::unordered_set<string> op_names(operator_output_names.begin(),
+                                            operator_output_names.end());
 
   TfLiteType input_type = python_utils::TfLiteTypeFromPyType(input_py_type);
   TfLiteType output_type = python_utils::TfLiteTypeFromPyType(output_py_type);
@@ -407,7 +417,7 @@ PyObject* CalibrationWrapper::QuantizeModel(int input_py_type,
   flatbuffers::FlatBufferBuilder builder;
   auto status = tflite::optimize::QuantizeModel(
       &builder, tflite_model.get(), TfLiteTypeToSchemaType(input_type),
-      TfLiteTypeToSchemaType(output_type), allow_float, {op_name},
+      TfLiteTypeToSchemaType(output_type), allow_float, op_names,
       TensorType_INT8, error_reporter_.get());
   if (status != kTfLiteOk) {
     error_reporter_->exception();
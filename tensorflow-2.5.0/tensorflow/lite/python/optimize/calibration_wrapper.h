@@ -71,10 +71,15 @@ class CalibrationWrapper {
 
   // Allows quantizing only the operator that produces the tensor with name
   // operator_output_name. (This can be used to help debug.).
-  // TODO(suharshs): Allow providing multiple names.
   PyObject* QuantizeModel(int input_py_type, int output_py_type,
                           bool allow_float, const char* operator_output_name);
 
+  // Allows quantizing only the operators that produce the tensors with names
+  // in operator_output_names, leaving the others in float.
+  PyObject* QuantizeModel(
+      int input_py_type, int output_py_type, bool allow_float,
+      const std::vector<std::string>& operator_output_names);
+
   // Writes the in-memory calibration results to the model flatbuffer. The
   // produced model is as same as the original input model, but the min/max
   // in the quantization field.
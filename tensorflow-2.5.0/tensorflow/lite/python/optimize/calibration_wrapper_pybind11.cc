@@ -79,6 +79,14 @@ PYBIND11_MODULE(_pywrap_tensorflow_lite_calibration_wrapper, m) {
                  self.QuantizeModel(input_py_type, output_py_type, allow_float,
                                     operator_output_name));
            })
+      .def("QuantizeModel",
+           [](CalibrationWrapper& self, int input_py_type, int output_py_type,
+              bool allow_float,
+              const std::vector<std::string>& operator_output_names) {
+             return tensorflow::PyoOrThrow(
+                 self.QuantizeModel(input_py_type, output_py_type, allow_float,
+                                    operator_output_names));
+           })
       .def("Calibrate", [](CalibrationWrapper& self) {
         return tensorflow::PyoOrThrow(self.Calibrate());
       });
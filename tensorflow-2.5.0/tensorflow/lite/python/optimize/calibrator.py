@@ -172,3 +172,23 @@ class Calibrator(object):
         self._calibrator.Prepare([list(s.shape) for s in sample])
       self._calibrator.FeedTensor(sample)
     return self._calibrator.Calibrate()
+
+  def quantize_ops(self, input_type, output_type, op_output_names):
+    """Quantizes only some ops of a model calibrated with `calibrate`.
+
+    The ops that do not produce one of the named tensors stay in float, so the
+    same calibration can be quantized with different sets of float ops.
+
+    Returns:
+      A quantized model.
+
+    Args:
+      input_type: A tf.dtype representing the desired real-value input type.
+      output_type: A tf.dtype representing the desired real-value output type.
+      op_output_names: A list of strings, the output tensor names of the ops to
+        quantize.
+    """
+    return self._calibrator.QuantizeModel(
+        np.dtype(input_type.as_numpy_dtype()).num,
+        np.dtype(output_type.as_numpy_dtype()).num, True,
+        list(op_output_names))
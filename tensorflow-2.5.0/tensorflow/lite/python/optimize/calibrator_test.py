@@ -93,6 +93,24 @@ class CalibratorTest(test_util.TensorFlowTestCase, parameterized.TestCase):
         input_gen, dtypes.float32, dtypes.float32, True, 'conv2d_8/BiasAdd')
     self.assertIsNotNone(quantized_model)
 
+  def test_calibration_with_quantization_of_some_ops(self):
+    model_path = resource_loader.get_path_to_datafile(
+        'test_data/mobilenet_like_model.bin')
+    float_model = open(model_path, 'rb').read()
+    quantizer = _calibrator.Calibrator(float_model)
+
+    # Input generator for the model.
+    def input_gen():
+      for _ in range(10):
+        yield [np.ones(shape=(1, 5, 5, 3), dtype=np.float32)]
+
+    quantizer.calibrate(input_gen)
+    # The same calibration can be quantized several times.
+    for op_output_names in (['conv2d_8/BiasAdd'], []):
+      quantized_model = quantizer.quantize_ops(dtypes.float32, dtypes.float32,
+                                               op_output_names)
+      self.assertIsNotNone(quantized_model)
+
   def test_calibration_with_string_input(self):
     model_path = resource_loader.get_path_to_datafile(
         'test_data/string_input_flex_model.bin')
@@ -91,6 +91,32 @@ TfLiteStatus SimpleMemoryArena::Allocate(
   return kTfLiteOk;
 }
 
+TfLiteStatus SimpleMemoryArena::AllocateAt(
+    TfLiteContext* context, size_t offset, size_t size, int32_t tensor,
+    int32_t first_node, int32_t last_node,
+    ArenaAllocWithUsageInterval* new_alloc) {
+  new_alloc->tensor = tensor;
+  new_alloc->first_node = first_node;
+  new_alloc->last_node = last_node;
+  new_alloc->size = size;
+  if (size == 0) {
+    new_alloc->offset = 0;
+    return kTfLiteOk;
+  }
+  // Guard against offsets so large that the end of the allocation overflows.
+  TF_LITE_ENSURE(context, offset + size > offset);
+
+  high_water_mark_ = std::max(high_water_mark_, offset + size);
+  new_alloc->offset = offset;
+
+  auto insertion_it = ordered_allocs_.begin();
+  while (insertion_it != ordered_allocs_.end() && *insertion_it < *new_alloc) {
+    ++insertion_it;
+  }
+  ordered_allocs_.insert(insertion_it, *new_alloc);
+  return kTfLiteOk;
+}
+
 TfLiteStatus SimpleMemoryArena::Deallocate(
     TfLiteContext* context, const ArenaAllocWithUsageInterval& alloc) {
   if (alloc.size == 0) {
@@ -121,7 +147,8 @@ TfLiteStatus SimpleMemoryArena::Commit(TfLiteContext* context) {
     // If the arena had been previously allocated, copy over the old memory.
     // Since Alloc pointers are offset based, they will remain valid in the new
     // memory block.
-    if (high_water_mark_ > 0 && underlying_buffer_size_ > 0) {
+    if (!data_is_discarded_ && high_water_mark_ > 0 &&
+        underlying_buffer_size_ > 0) {
       size_t copy_amount = std::min(
           underlying_buffer_.get() + underlying_buffer_size_ -
               underlying_buffer_aligned_ptr_,
@@ -135,6 +162,7 @@ TfLiteStatus SimpleMemoryArena::Commit(TfLiteContext* context) {
     underlying_buffer_aligned_ptr_ = new_underlying_buffer_aligned_ptr;
   }
   committed_ = true;
+  data_is_discarded_ = false;
   return underlying_buffer_ != nullptr ? kTfLiteOk : kTfLiteError;
 }
 
@@ -160,6 +188,11 @@ TfLiteStatus SimpleMemoryArena::ClearPlan() {
   return kTfLiteOk;
 }
 
+TfLiteStatus SimpleMemoryArena::ClearPlanAndDiscardData() {
+  data_is_discarded_ = true;
+  return ClearPlan();
+}
+
 TfLiteStatus SimpleMemoryArena::ReleaseBuffer() {
   committed_ = false;
   underlying_buffer_size_ = 0;
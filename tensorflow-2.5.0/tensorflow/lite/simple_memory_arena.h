@@ -63,6 +63,7 @@ class SimpleMemoryArena {
  public:
   explicit SimpleMemoryArena(size_t arena_alignment)
       : committed_(false),
+        data_is_discarded_(false),
         arena_alignment_(arena_alignment),
         high_water_mark_(0),
         underlying_buffer_size_(0),
@@ -75,6 +76,13 @@ class SimpleMemoryArena {
                         int32_t tensor, int32_t first_node, int32_t last_node,
                         ArenaAllocWithUsageInterval* new_alloc);
 
+  // Schedule memory allocation for a tensor at a given offset. Unlike
+  // Allocate(), this doesn't check whether the memory overlaps that of tensors
+  // with an overlapping usage interval; that is up to the caller.
+  TfLiteStatus AllocateAt(TfLiteContext* context, size_t offset, size_t size,
+                          int32_t tensor, int32_t first_node, int32_t last_node,
+                          ArenaAllocWithUsageInterval* new_alloc);
+
   TfLiteStatus Deallocate(TfLiteContext* context,
                           const ArenaAllocWithUsageInterval& alloc);
 
@@ -96,6 +104,11 @@ class SimpleMemoryArena {
   // again.
   TfLiteStatus ClearPlan();
 
+  // Like ClearPlan(), but also declares the contents of the underlying buffer
+  // dead, so that the next Commit() doesn't copy them over if it has to grow
+  // the buffer.
+  TfLiteStatus ClearPlanAndDiscardData();
+
   // This releases the underlying buffer but does not clear the allocation plan.
   // Since all associated pointers are invalidated, the arena cannot be used
   // again until Commit() is called & tensor allocations are resolved.
@@ -109,6 +122,7 @@ class SimpleMemoryArena {
 
  private:
   bool committed_;
+  bool data_is_discarded_;
   size_t arena_alignment_;
   size_t high_water_mark_;
   std::unique_ptr<char[]> underlying_buffer_;
@@ -286,6 +286,12 @@ BenchmarkParams BenchmarkTfLiteModel::DefaultParams() {
                           BenchmarkParam::Create<int32_t>(1024));
   default_params.AddParam("profiling_output_csv_file",
                           BenchmarkParam::Create<std::string>(""));
+  default_params.AddParam("profiling_output_json_file",
+                          BenchmarkParam::Create<std::string>(""));
+  default_params.AddParam("profiling_baseline_json_file",
+                          BenchmarkParam::Create<std::string>(""));
+  default_params.AddParam("op_latency_regression_threshold",
+                          BenchmarkParam::Create<float>(0.1f));
 
   default_params.AddParam("print_preinvoke_state",
                           BenchmarkParam::Create<bool>(false));
@@ -352,6 +358,17 @@ std::vector<Flag> BenchmarkTfLiteModel::GetFlags() {
           "profiling_output_csv_file", &params_,
           "File path to export profile data as CSV, if not set "
           "prints to stdout."),
+      CreateFlag<std::string>(
+          "profiling_output_json_file", &params_,
+          "File path to export per-operator latency percentiles as JSON."),
+      CreateFlag<std::string>(
+          "profiling_baseline_json_file", &params_,
+          "JSON file exported by profiling_output_json_file to report "
+          "per-operator latency regressions against."),
+      CreateFlag<float>(
+          "op_latency_regression_threshold", &params_,
+          "Minimum relative increase of the mean latency of an operator for "
+          "a significant difference to be reported as a regression."),
       CreateFlag<bool>(
           "print_preinvoke_state", &params_,
           "print out the interpreter internals just before calling Invoke. The "
@@ -395,6 +412,12 @@ void BenchmarkTfLiteModel::LogParams() {
                       "Max profiling buffer entries", verbose);
   LOG_BENCHMARK_PARAM(std::string, "profiling_output_csv_file",
                       "CSV File to export profiling data to", verbose);
+  LOG_BENCHMARK_PARAM(std::string, "profiling_output_json_file",
+                      "JSON File to export op latencies to", verbose);
+  LOG_BENCHMARK_PARAM(std::string, "profiling_baseline_json_file",
+                      "JSON File with baseline op latencies", verbose);
+  LOG_BENCHMARK_PARAM(float, "op_latency_regression_threshold",
+                      "Op latency regression threshold", verbose);
   LOG_BENCHMARK_PARAM(bool, "print_preinvoke_state",
                       "Print pre-invoke interpreter state", verbose);
   LOG_BENCHMARK_PARAM(bool, "print_postinvoke_state",
@@ -813,7 +836,10 @@ BenchmarkTfLiteModel::MayCreateProfilingListener() const {
       interpreter_.get(), params_.Get<int32_t>("max_profiling_buffer_entries"),
       params_.Get<std::string>("profiling_output_csv_file"),
       CreateProfileSummaryFormatter(
-          !params_.Get<std::string>("profiling_output_csv_file").empty())));
+          !params_.Get<std::string>("profiling_output_csv_file").empty()),
+      params_.Get<std::string>("profiling_output_json_file"),
+      params_.Get<std::string>("profiling_baseline_json_file"),
+      params_.Get<float>("op_latency_regression_threshold")));
 }
 
 TfLiteStatus BenchmarkTfLiteModel::RunImpl() { return interpreter_->Invoke(); }
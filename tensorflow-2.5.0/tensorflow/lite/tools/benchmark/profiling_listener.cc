@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/lite/tools/benchmark/profiling_listener.h"
 
 #include <fstream>
+#include <sstream>
 
 #include "tensorflow/lite/tools/logging.h"
 
@@ -25,10 +26,15 @@ namespace benchmark {
 ProfilingListener::ProfilingListener(
     Interpreter* interpreter, uint32_t max_num_entries,
     const std::string& csv_file_path,
-    std::shared_ptr<profiling::ProfileSummaryFormatter> summarizer_formatter)
+    std::shared_ptr<profiling::ProfileSummaryFormatter> summarizer_formatter,
+    const std::string& json_file_path,
+    const std::string& baseline_json_file_path, float regression_threshold)
     : run_summarizer_(summarizer_formatter),
       init_summarizer_(summarizer_formatter),
       csv_file_path_(csv_file_path),
+      json_file_path_(json_file_path),
+      baseline_json_file_path_(baseline_json_file_path),
+      regression_threshold_(regression_threshold),
       interpreter_(interpreter),
       profiler_(max_num_entries) {
   TFLITE_TOOLS_CHECK(interpreter);
@@ -80,6 +86,52 @@ void ProfilingListener::OnBenchmarkEnd(const BenchmarkResults& results) {
                 run_summarizer_.GetOutputString(),
                 output_stream == nullptr ? &TFLITE_LOG(INFO) : output_stream);
   }
+
+  if (json_file_path_.empty() && baseline_json_file_path_.empty()) return;
+  const std::vector<profiling::OpLatencyStats> op_latencies =
+      run_summarizer_.GetOpLatencyStats();
+  if (!json_file_path_.empty()) {
+    std::ofstream json_file(json_file_path_);
+    json_file << profiling::OpLatencyStatsToJson(op_latencies);
+    if (!json_file.good()) {
+      TFLITE_LOG(ERROR) << "Failed to write operator latencies to "
+                        << json_file_path_;
+    }
+  }
+  if (!baseline_json_file_path_.empty()) {
+    ReportRegressions(op_latencies);
+  }
+}
+
+void ProfilingListener::ReportRegressions(
+    const std::vector<profiling::OpLatencyStats>& op_latencies) {
+  std::ifstream baseline_file(baseline_json_file_path_);
+  std::stringstream baseline_json;
+  baseline_json << baseline_file.rdbuf();
+  std::vector<profiling::OpLatencyStats> baseline;
+  std::string error;
+  if (!baseline_file.good() ||
+      !profiling::OpLatencyStatsFromJson(baseline_json.str(), &baseline,
+                                         &error)) {
+    TFLITE_LOG(ERROR) << "Failed to read baseline operator latencies from "
+                      << baseline_json_file_path_ << ": " << error;
+    return;
+  }
+
+  profiling::OpLatencyRegressionOptions options;
+  options.min_relative_increase = regression_threshold_;
+  const std::vector<profiling::OpLatencyRegression> regressions =
+      profiling::FindOpLatencyRegressions(baseline, op_latencies, options);
+  TFLITE_LOG(INFO) << regressions.size()
+                   << " operator latency regressions against "
+                   << baseline_json_file_path_;
+  for (const auto& regression : regressions) {
+    TFLITE_LOG(WARN) << "Regression in " << regression.name << " ("
+                     << regression.type
+                     << "): " << regression.baseline_mean_us << " us -> "
+                     << regression.mean_us
+                     << " us, t = " << regression.t_statistic;
+  }
 }
 
 void ProfilingListener::WriteOutput(const std::string& header,
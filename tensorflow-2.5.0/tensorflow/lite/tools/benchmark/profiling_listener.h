@@ -17,8 +17,11 @@ limitations under the License.
 #define TENSORFLOW_LITE_TOOLS_BENCHMARK_PROFILING_LISTENER_H_
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "tensorflow/lite/profiling/buffered_profiler.h"
+#include "tensorflow/lite/profiling/op_latency_stats.h"
 #include "tensorflow/lite/profiling/profile_summarizer.h"
 #include "tensorflow/lite/profiling/profile_summary_formatter.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_model.h"
@@ -33,7 +36,10 @@ class ProfilingListener : public BenchmarkListener {
       Interpreter* interpreter, uint32_t max_num_entries,
       const std::string& csv_file_path = "",
       std::shared_ptr<profiling::ProfileSummaryFormatter> summarizer_formatter =
-          std::make_shared<profiling::ProfileSummaryDefaultFormatter>());
+          std::make_shared<profiling::ProfileSummaryDefaultFormatter>(),
+      const std::string& json_file_path = "",
+      const std::string& baseline_json_file_path = "",
+      float regression_threshold = 0.1f);
 
   void OnBenchmarkStart(const BenchmarkParams& params) override;
 
@@ -47,10 +53,18 @@ class ProfilingListener : public BenchmarkListener {
   profiling::ProfileSummarizer run_summarizer_;
   profiling::ProfileSummarizer init_summarizer_;
   std::string csv_file_path_;
+  // File to export the per-operator latency distributions to as JSON.
+  std::string json_file_path_;
+  // JSON file exported by an earlier run to compare the latencies against.
+  std::string baseline_json_file_path_;
+  // Minimum relative increase of an operator's mean latency to report it.
+  float regression_threshold_;
 
  private:
   void WriteOutput(const std::string& header, const string& data,
                    std::ostream* stream);
+  void ReportRegressions(
+      const std::vector<profiling::OpLatencyStats>& op_latencies);
   Interpreter* interpreter_;
   profiling::BufferedProfiler profiler_;
 };
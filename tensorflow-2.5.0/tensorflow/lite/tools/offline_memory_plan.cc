@@ -0,0 +1,75 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/tools/offline_memory_plan.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/lite/memory_planner.h"
+
+namespace tflite {
+
+TfLiteStatus AddOfflineMemoryPlan(Interpreter* interpreter, ModelT* model) {
+  if (interpreter->subgraphs_size() != model->subgraphs.size()) {
+    return kTfLiteError;
+  }
+
+  // Drop existing plans. Their buffers are only emptied, since buffers are
+  // referred to by index.
+  std::vector<std::unique_ptr<MetadataT>> metadata;
+  for (auto& entry : model->metadata) {
+    if (entry->name != kOfflineMemoryAllocationMetadata) {
+      metadata.push_back(std::move(entry));
+    } else if (entry->buffer < model->buffers.size()) {
+      model->buffers[entry->buffer]->data.clear();
+    }
+  }
+  model->metadata = std::move(metadata);
+
+  for (int i = 0; i < model->subgraphs.size(); ++i) {
+    std::vector<int32_t> offsets;
+    TF_LITE_ENSURE_STATUS(
+        interpreter->subgraph(i)->GetPlannedOffsets(&offsets));
+    // Tensors added at runtime, e.g., op temporaries, are not in the model and
+    // are left to be planned at runtime.
+    const size_t num_tensors = model->subgraphs[i]->tensors.size();
+    if (offsets.size() < num_tensors) {
+      return kTfLiteError;
+    }
+    offsets.resize(num_tensors);
+
+    // See kOfflineMemoryAllocationMetadata for the encoding.
+    std::vector<int32_t> values = {/*version=*/0, /*subgraph_index=*/i,
+                                   static_cast<int32_t>(num_tensors)};
+    values.insert(values.end(), offsets.begin(), offsets.end());
+    auto buffer = absl::make_unique<BufferT>();
+    buffer->data.resize(values.size() * sizeof(int32_t));
+    std::memcpy(buffer->data.data(), values.data(), buffer->data.size());
+
+    auto entry = absl::make_unique<MetadataT>();
+    entry->name = kOfflineMemoryAllocationMetadata;
+    entry->buffer = model->buffers.size();
+    model->buffers.push_back(std::move(buffer));
+    model->metadata.push_back(std::move(entry));
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace tflite
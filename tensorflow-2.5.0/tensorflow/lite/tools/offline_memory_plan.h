@@ -0,0 +1,38 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_TOOLS_OFFLINE_MEMORY_PLAN_H_
+#define TENSORFLOW_LITE_TOOLS_OFFLINE_MEMORY_PLAN_H_
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+
+// Stores the tensor offsets the memory planner chose for each subgraph of
+// `interpreter` in `model`, as kOfflineMemoryAllocationMetadata metadata, so
+// that interpreters built from the resulting model place their tensors at
+// these offsets instead of planning memory in AllocateTensors(). Offline
+// memory plans already in `model` are replaced.
+//
+// `interpreter` must have been built from `model`, with the delegates and
+// input shapes the plan is meant for, and AllocateTensors() must have been
+// called on it.
+TfLiteStatus AddOfflineMemoryPlan(Interpreter* interpreter, ModelT* model);
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_OFFLINE_MEMORY_PLAN_H_
@@ -0,0 +1,67 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+
+#include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/interpreter_builder.h"
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/model_builder.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/tools/offline_memory_plan.h"
+
+// Writes a copy of a model with the memory plan for its default input shapes
+// stored in its metadata, so that interpreters built from it skip planning.
+//
+// Note: This is a private API, subject to change.
+int main(int argc, char** argv) {
+  if (argc != 3) {
+    printf(
+        "Wrong number of arguments. Example: offline_memory_plan_main "
+        "${input} ${output}");
+    return 1;
+  }
+
+  auto fb_model = tflite::FlatBufferModel::BuildFromFile(argv[1]);
+  if (!fb_model) {
+    printf("Failed to load model from %s", argv[1]);
+    return 1;
+  }
+  tflite::ops::builtin::BuiltinOpResolver resolver;
+  std::unique_ptr<tflite::Interpreter> interpreter;
+  if (tflite::InterpreterBuilder(*fb_model, resolver)(&interpreter) !=
+          kTfLiteOk ||
+      interpreter->AllocateTensors() != kTfLiteOk) {
+    printf("Failed to allocate tensors for %s", argv[1]);
+    return 1;
+  }
+
+  std::unique_ptr<tflite::ModelT> model(fb_model->GetModel()->UnPack());
+  if (tflite::AddOfflineMemoryPlan(interpreter.get(), model.get()) !=
+      kTfLiteOk) {
+    printf("Failed to add the memory plan to %s", argv[1]);
+    return 1;
+  }
+  flatbuffers::FlatBufferBuilder builder;
+  tflite::FinishModelBuffer(builder, tflite::Model::Pack(builder, model.get()));
+
+  std::ofstream output(argv[2], std::ios::binary);
+  output.write(reinterpret_cast<const char*>(builder.GetBufferPointer()),
+               builder.GetSize());
+  return output.good() ? 0 : 1;
+}
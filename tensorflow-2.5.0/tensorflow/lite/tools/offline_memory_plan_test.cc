@@ -0,0 +1,80 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/tools/offline_memory_plan.h"
+
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/interpreter_builder.h"
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/memory_planner.h"
+#include "tensorflow/lite/model_builder.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/testing/util.h"
+
+namespace tflite {
+namespace {
+
+std::unique_ptr<Interpreter> BuildInterpreter(const FlatBufferModel& model) {
+  ops::builtin::BuiltinOpResolver resolver;
+  std::unique_ptr<Interpreter> interpreter;
+  EXPECT_EQ(InterpreterBuilder(model, resolver)(&interpreter), kTfLiteOk);
+  EXPECT_EQ(interpreter->AllocateTensors(), kTfLiteOk);
+  return interpreter;
+}
+
+TEST(OfflineMemoryPlanTest, PlanIsReused) {
+  auto fb_model = FlatBufferModel::BuildFromFile(
+      "tensorflow/lite/testdata/multi_add.bin");
+  ASSERT_TRUE(fb_model);
+  std::unique_ptr<Interpreter> interpreter = BuildInterpreter(*fb_model);
+  std::vector<int32_t> expected_offsets;
+  ASSERT_EQ(interpreter->subgraph(0)->GetPlannedOffsets(&expected_offsets),
+            kTfLiteOk);
+
+  std::unique_ptr<ModelT> model(fb_model->GetModel()->UnPack());
+  ASSERT_EQ(AddOfflineMemoryPlan(interpreter.get(), model.get()), kTfLiteOk);
+  // Adding a plan again replaces the previous one.
+  ASSERT_EQ(AddOfflineMemoryPlan(interpreter.get(), model.get()), kTfLiteOk);
+  ASSERT_EQ(model->metadata.size(), 1);
+  EXPECT_EQ(model->metadata[0]->name, kOfflineMemoryAllocationMetadata);
+
+  flatbuffers::FlatBufferBuilder builder;
+  FinishModelBuffer(builder, Model::Pack(builder, model.get()));
+  auto planned_model = FlatBufferModel::BuildFromBuffer(
+      reinterpret_cast<const char*>(builder.GetBufferPointer()),
+      builder.GetSize());
+  ASSERT_TRUE(planned_model);
+  std::unique_ptr<Interpreter> planned_interpreter =
+      BuildInterpreter(*planned_model);
+  std::vector<int32_t> offsets;
+  ASSERT_EQ(planned_interpreter->subgraph(0)->GetPlannedOffsets(&offsets),
+            kTfLiteOk);
+  EXPECT_EQ(offsets, expected_offsets);
+  EXPECT_EQ(planned_interpreter->Invoke(), kTfLiteOk);
+}
+
+}  // namespace
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  ::tflite::LogToStderr();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -61,6 +61,7 @@ See [Importing Data](https://tensorflow.org/guide/datasets) for an overview.
 @@get_next_as_optional
 @@get_single_element
 @@get_structure
+@@global_shuffle
 @@group_by_reducer
 @@group_by_window
 @@ignore_errors
@@ -137,6 +138,7 @@ from tensorflow.python.data.experimental.ops.readers import make_csv_dataset
 from tensorflow.python.data.experimental.ops.readers import SqlDataset
 from tensorflow.python.data.experimental.ops.resampling import rejection_resample
 from tensorflow.python.data.experimental.ops.scan_ops import scan
+from tensorflow.python.data.experimental.ops.shuffle_ops import global_shuffle
 from tensorflow.python.data.experimental.ops.shuffle_ops import shuffle_and_repeat
 from tensorflow.python.data.experimental.ops.snapshot import snapshot
 from tensorflow.python.data.experimental.ops.stats_aggregator import StatsAggregator
@@ -606,6 +606,29 @@ class OptimizeDatasetTest(test_base.DatasetTestBase, parameterized.TestCase):
       self.assertEqual(algorithm,
                        optimization_options._AutotuneAlgorithm.HILL_CLIMB)
 
+  @combinations.generate(
+      combinations.times(
+          test_base.default_test_combinations(),
+          combinations.combine(autotune_buffers=[True, False, None]),
+          combinations.combine(enforce_ram_budget=[True, False, None])))
+  def testAutotuneEnforceRamBudgetSettings(self, autotune_buffers,
+                                           enforce_ram_budget):
+    options = dataset_ops.Options()
+    if autotune_buffers is not None:
+      options.experimental_optimization.autotune_buffers = autotune_buffers
+    if enforce_ram_budget is not None:
+      options.experimental_optimization.autotune_enforce_ram_budget = (
+          enforce_ram_budget)
+
+    algorithm = options._autotune_settings()[1]
+
+    if enforce_ram_budget is True:  # pylint: disable=g-bool-id-comparison
+      self.assertEqual(algorithm,
+                       optimization_options._AutotuneAlgorithm.MEMORY_AWARE)
+    else:
+      self.assertNotEqual(algorithm,
+                          optimization_options._AutotuneAlgorithm.MEMORY_AWARE)
+
   @combinations.generate(
       combinations.times(
           test_base.default_test_combinations(),
@@ -21,11 +21,15 @@ from tensorflow.python.data.util import structure
 from tensorflow.python.ops import gen_experimental_dataset_ops as ged_ops
 
 
-def compress(element):
+def compress(element, codec="SNAPPY", level=-1):
   """Compress a dataset element.
 
   Args:
     element: A nested structure of types supported by Tensorflow.
+    codec: (Optional.) The codec to compress with. One of "SNAPPY", "ZLIB" or
+      "NONE".
+    level: (Optional.) The zlib compression level, from 0 to 9. -1 selects the
+      zlib default. Ignored by the other codecs.
 
   Returns:
     A variant tensor representing the compressed element. This variant can be
@@ -33,7 +37,7 @@ def compress(element):
   """
   element_spec = structure.type_spec_from_value(element)
   tensor_list = structure.to_tensor_list(element_spec, element)
-  return ged_ops.compress_element(tensor_list)
+  return ged_ops.compress_element(tensor_list, codec=codec, level=level)
 
 
 def uncompress(element, output_spec):
@@ -34,6 +34,7 @@ from tensorflow.python.ops import gen_experimental_dataset_ops
 from tensorflow.python.util.tf_export import tf_export
 
 COMPRESSION_AUTO = "AUTO"
+COMPRESSION_ZLIB = "ZLIB"
 COMPRESSION_NONE = None
 
 
@@ -274,13 +275,14 @@ def _distribute(processing_mode,
       data with the tf.data service.
     compression: How to compress the dataset's elements before transferring them
       over the network. "AUTO" leaves the decision of how to compress up to the
-      tf.data service runtime. `None` indicates not to compress.
+      tf.data service runtime. "ZLIB" trades CPU time for a smaller transfer
+      size. `None` indicates not to compress.
 
   Returns:
     Dataset: A `Dataset` of the elements produced by the data service.
   """
   ProcessingMode.validate(processing_mode)
-  valid_compressions = [COMPRESSION_AUTO, COMPRESSION_NONE]
+  valid_compressions = [COMPRESSION_AUTO, COMPRESSION_ZLIB, COMPRESSION_NONE]
   if compression not in valid_compressions:
     raise ValueError(
         "Invalid compression argument: {}. Must be one of {}".format(
@@ -517,7 +519,8 @@ def distribute(processing_mode,
       data with the tf.data service, e.g. "grpc".
     compression: How to compress the dataset's elements before transferring them
       over the network. "AUTO" leaves the decision of how to compress up to the
-      tf.data service runtime. `None` indicates not to compress.
+      tf.data service runtime. "ZLIB" trades CPU time for a smaller transfer
+      size. `None` indicates not to compress.
 
   Returns:
     Dataset: A `Dataset` of the elements produced by the data service.
@@ -547,12 +550,13 @@ def _register_dataset(service, dataset, compression):
     dataset: A `tf.data.Dataset` to register with the tf.data service.
     compression: How to compress the dataset's elements before transferring them
       over the network. "AUTO" leaves the decision of how to compress up to the
-      tf.data service runtime. `None` indicates not to compress.
+      tf.data service runtime. "ZLIB" trades CPU time for a smaller transfer
+      size. `None` indicates not to compress.
 
   Returns:
     A scalar int64 tensor of the registered dataset's id.
   """
-  valid_compressions = [COMPRESSION_AUTO, COMPRESSION_NONE]
+  valid_compressions = [COMPRESSION_AUTO, COMPRESSION_ZLIB, COMPRESSION_NONE]
   if compression not in valid_compressions:
     raise ValueError(
         "Invalid compression argument: {}. Must be one of {}".format(
@@ -562,9 +566,10 @@ def _register_dataset(service, dataset, compression):
   if external_state_policy is None:
     external_state_policy = ExternalStatePolicy.WARN
 
-  if compression == COMPRESSION_AUTO:
+  if compression != COMPRESSION_NONE:
+    codec = "ZLIB" if compression == COMPRESSION_ZLIB else "SNAPPY"
     dataset = dataset.map(
-        lambda *x: compression_ops.compress(x),
+        lambda *x: compression_ops.compress(x, codec=codec),
         num_parallel_calls=dataset_ops.AUTOTUNE)
   dataset = dataset.prefetch(dataset_ops.AUTOTUNE)
   # Apply options so that the dataset executed in the tf.data service will
@@ -685,7 +690,7 @@ def _from_dataset_id(processing_mode,
     A `tf.data.Dataset` which reads from the tf.data service.
   """
   ProcessingMode.validate(processing_mode)
-  valid_compressions = [COMPRESSION_AUTO, COMPRESSION_NONE]
+  valid_compressions = [COMPRESSION_AUTO, COMPRESSION_ZLIB, COMPRESSION_NONE]
   if compression not in valid_compressions:
     raise ValueError(
         "Invalid compression argument: {}. Must be one of {}".format(
@@ -703,7 +708,7 @@ def _from_dataset_id(processing_mode,
   # If we compress, the data service side dataset will produce scalar variants.
   data_service_element_spec = (
       tensor_spec.TensorSpec(shape=(), dtype=dtypes.variant)
-      if compression == COMPRESSION_AUTO else element_spec)
+      if compression != COMPRESSION_NONE else element_spec)
 
   dataset = _DataServiceDataset(
       dataset_id=dataset_id,
@@ -717,7 +722,9 @@ def _from_dataset_id(processing_mode,
       num_consumers=num_consumers,
       max_outstanding_requests=max_outstanding_requests,
       task_refresh_interval_hint_ms=task_refresh_interval_hint_ms)
-  if compression == COMPRESSION_AUTO:
+  # Each compressed element records its codec, so uncompressing does not depend
+  # on which codec was chosen at registration.
+  if compression != COMPRESSION_NONE:
     dataset = dataset.map(
         lambda x: compression_ops.uncompress(x, output_spec=element_spec),
         num_parallel_calls=dataset_ops.AUTOTUNE)
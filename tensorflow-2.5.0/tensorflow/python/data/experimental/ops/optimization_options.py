@@ -31,6 +31,7 @@ class _AutotuneAlgorithm(enum.Enum):
   """Controls what algorithm is used in the autotune implementation."""
   HILL_CLIMB = 0
   GRADIENT_DESCENT = 1
+  MEMORY_AWARE = 2
 
 
 @tf_export("data.experimental.MapVectorizationOptions")
@@ -132,6 +133,15 @@ class OptimizationOptions(options.OptionsBase):
       "are allowed but may result in CPU contention. If None, defaults to the "
       "number of schedulable CPU cores.")
 
+  autotune_enforce_ram_budget = options.create_option(
+      name="autotune_enforce_ram_budget",
+      ty=bool,
+      docstring=
+      "When autotuning is enabled (through `autotune`), determines whether "
+      "`autotune_ram_budget` is a hard constraint on the memory used by "
+      "buffers. If True, autotuning shrinks buffers before it reduces "
+      "parallelism to stay within the budget. If None, defaults to False.")
+
   autotune_ram_budget = options.create_option(
       name="autotune_ram_budget",
       ty=int,
@@ -245,6 +255,10 @@ class OptimizationOptions(options.OptionsBase):
     algorithm = (
         _AutotuneAlgorithm.GRADIENT_DESCENT
         if self._autotune_buffers() else _AutotuneAlgorithm.HILL_CLIMB)
+    # If the RAM budget is enforced, we use the MEMORY_AWARE algorithm, which
+    # never chooses parameters whose buffers would exceed the budget.
+    if self.autotune_enforce_ram_budget:
+      algorithm = _AutotuneAlgorithm.MEMORY_AWARE
     cpu_budget = 0  # Indicates that all CPU cores should be used by default.
     ram_budget = 0  # Indicates that default value of RAM budget should be used.
 
@@ -355,6 +369,8 @@ class OptimizationOptions(options.OptionsBase):
       pb.autotune_buffers = self.autotune_buffers
     if self.autotune_cpu_budget is not None:
       pb.autotune_cpu_budget = self.autotune_cpu_budget
+    if self.autotune_enforce_ram_budget is not None:
+      pb.autotune_enforce_ram_budget = self.autotune_enforce_ram_budget
     if self.autotune_ram_budget is not None:
       pb.autotune_ram_budget = self.autotune_ram_budget
     if self.filter_fusion is not None:
@@ -392,6 +408,8 @@ class OptimizationOptions(options.OptionsBase):
       self.autotune_buffers = pb.autotune_buffers
     if pb.WhichOneof("optional_autotune_cpu_budget") is not None:
       self.autotune_cpu_budget = pb.autotune_cpu_budget
+    if pb.WhichOneof("optional_autotune_enforce_ram_budget") is not None:
+      self.autotune_enforce_ram_budget = pb.autotune_enforce_ram_budget
     if pb.WhichOneof("optional_autotune_ram_budget") is not None:
       self.autotune_ram_budget = pb.autotune_ram_budget
     if pb.WhichOneof("optional_filter_fusion") is not None:
@@ -23,6 +23,7 @@ from tensorflow.python.framework import constant_op
 from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import ops
 from tensorflow.python.ops import gen_dataset_ops
+from tensorflow.python.ops import gen_experimental_dataset_ops
 from tensorflow.python.util import deprecation
 from tensorflow.python.util.tf_export import tf_export
 
@@ -107,3 +108,56 @@ def shuffle_and_repeat(buffer_size, count=None, seed=None):
     return _ShuffleAndRepeatDataset(dataset, buffer_size, count, seed)
 
   return _apply_fn
+
+
+class _GlobalShuffleDataset(dataset_ops.UnaryUnchangedStructureDataset):
+  """A `Dataset` that shuffles all elements of its input by index."""
+
+  def __init__(self, input_dataset, seed=None, reshuffle_each_iteration=True):
+    self._input_dataset = input_dataset
+    self._seed, self._seed2 = random_seed.get_seed(seed)
+    self._reshuffle_each_iteration = reshuffle_each_iteration
+    variant_tensor = gen_experimental_dataset_ops.global_shuffle_dataset(
+        self._input_dataset._variant_tensor,  # pylint: disable=protected-access
+        seed=self._seed,
+        seed2=self._seed2,
+        reshuffle_each_iteration=self._reshuffle_each_iteration,
+        **self._flat_structure)
+    super(_GlobalShuffleDataset, self).__init__(input_dataset, variant_tensor)
+
+
+@tf_export("data.experimental.global_shuffle")
+def global_shuffle(seed=None, reshuffle_each_iteration=True):
+  """Uniformly shuffles all elements of a dataset without a shuffle buffer.
+
+  >>> d = tf.data.Dataset.range(5)
+  >>> d = d.apply(tf.data.experimental.global_shuffle(seed=42))
+  >>> sorted([elem.numpy() for elem in d])
+  [0, 1, 2, 3, 4]
+
+  Unlike `tf.data.Dataset.shuffle`, which samples from a buffer of upcoming
+  elements, this transformation draws every position of the output from the
+  whole input, using constant memory. To do so it reads the input by index, so
+  the input must have a known, finite cardinality and support random access.
+  `tf.data.Dataset.range`, `tf.data.Dataset.from_tensor_slices` and in-memory
+  `tf.data.Dataset.cache` (which is filled on the first iteration) do; most
+  other transformations, including `map`, do not, so apply `cache()` after them
+  if needed.
+
+  Args:
+    seed: (Optional.) A `tf.int64` scalar `tf.Tensor`, representing the random
+      seed that will be used to create the permutation. See
+      `tf.random.set_seed` for behavior.
+    reshuffle_each_iteration: (Optional.) A boolean, which if true indicates
+      that the dataset should be pseudorandomly reshuffled each time it is
+      iterated over. (Defaults to `True`.)
+
+  Returns:
+    A `Dataset` transformation function, which can be passed to
+    `tf.data.Dataset.apply`.
+  """
+
+  def _apply_fn(dataset):  # pylint: disable=missing-docstring
+    return _GlobalShuffleDataset(dataset, seed, reshuffle_each_iteration)
+
+  return _apply_fn
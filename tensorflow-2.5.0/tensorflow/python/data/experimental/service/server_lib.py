@@ -221,7 +221,7 @@ class DispatchServer(object):
 class WorkerConfig(
     collections.namedtuple("WorkerConfig", [
         "dispatcher_address", "worker_address", "port", "protocol",
-        "heartbeat_interval_ms", "dispatcher_timeout_ms"
+        "heartbeat_interval_ms", "dispatcher_timeout_ms", "locality"
     ])):
   """Configuration class for tf.data service dispatchers.
 
@@ -241,6 +241,10 @@ class WorkerConfig(
       from finished jobs.
     dispatcher_timeout_ms: How long, in milliseconds, to retry requests to the
       dispatcher before giving up and reporting an error. Defaults to 1 hour.
+    locality: (Optional.) Topology labels of the worker, from the least to the
+      most specific level and separated by "/", e.g. "zone-a/rack-3/host-7".
+      Clients whose `TF_DATA_SERVICE_CLIENT_LOCALITY` environment variable is
+      set prefer reading from the workers sharing the most levels with them.
   """
 
   def __new__(cls,
@@ -249,7 +253,8 @@ class WorkerConfig(
               port=0,
               protocol=None,
               heartbeat_interval_ms=None,
-              dispatcher_timeout_ms=None):
+              dispatcher_timeout_ms=None,
+              locality=None):
     if worker_address is None:
       worker_address = "localhost:%port%"
     if protocol is None:
@@ -258,11 +263,13 @@ class WorkerConfig(
       heartbeat_interval_ms = 30 * 1000  # 30 seconds
     if dispatcher_timeout_ms is None:
       dispatcher_timeout_ms = 60 * 60 * 1000  # 1 hour
+    if locality is None:
+      locality = ""
 
     return super(WorkerConfig,
                  cls).__new__(cls, dispatcher_address, worker_address, port,
                               protocol, heartbeat_interval_ms,
-                              dispatcher_timeout_ms)
+                              dispatcher_timeout_ms, locality)
 
 
 @tf_export("data.experimental.service.WorkerServer", v1=[])
@@ -315,7 +322,8 @@ class WorkerServer(object):
           protocol=config.protocol,
           heartbeat_interval_ms=config.heartbeat_interval_ms,
           dispatcher_timeout_ms=config.dispatcher_timeout_ms,
-          data_transfer_protocol=None)
+          data_transfer_protocol=None,
+          locality=config.locality)
     self._server = _pywrap_server_lib.TF_DATA_NewWorkerServer(
         config_proto.SerializeToString())
     if start:
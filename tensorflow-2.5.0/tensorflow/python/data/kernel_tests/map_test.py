@@ -1384,6 +1384,91 @@ class MapTest(test_base.DatasetTestBase, parameterized.TestCase):
     dataset = apply_map(dataset, map_function)
     self.assertDatasetProduces(dataset, expected_output=[21])
 
+  @combinations.generate(test_base.default_test_combinations())
+  def testDeterministicHeadOfLineStallsKeepOrder(self):
+    # Every tenth element is slow, so later elements complete first and are
+    # held in the widened reorder buffer.
+    def sleep(x):
+      if x % 10 == 0:
+        time.sleep(0.05)
+      return x
+
+    dataset = dataset_ops.Dataset.range(100).map(
+        lambda x: script_ops.py_func(sleep, [x], x.dtype),
+        num_parallel_calls=4,
+        deterministic=True)
+    self.assertDatasetProduces(dataset, expected_output=list(range(100)))
+
+  @combinations.generate(test_base.eager_only_combinations())
+  def testDeterministicReorderBufferGrowthIsBounded(self):
+    num_parallel_calls = 4
+    num_elements = 100
+    slow_elements = {1: threading.Event(), 2: threading.Event(),
+                     3: threading.Event()}
+    lock = threading.Lock()
+    started = []
+    finished = []
+
+    def map_py_fn(x):
+      with lock:
+        started.append(x)
+      if x in slow_elements:
+        slow_elements[x].wait()
+      with lock:
+        finished.append(x)
+      return x
+
+    def wait_for_calls(num_started):
+      # Waits until `num_started` calls have started and all calls but the
+      # blocked ones have finished.
+      deadline = time.time() + 30
+      while time.time() < deadline:
+        with lock:
+          num_blocked = len(
+              [x for x in started if x in slow_elements and
+               not slow_elements[x].is_set()])
+          if (len(started) >= num_started and
+              len(finished) == len(started) - num_blocked):
+            break
+        time.sleep(0.01)
+      # Give the runner thread a chance to overshoot the bound.
+      time.sleep(0.2)
+      with lock:
+        return len(started)
+
+    dataset = dataset_ops.Dataset.range(num_elements).map(
+        lambda x: script_ops.py_func(map_py_fn, [x], x.dtype),
+        num_parallel_calls=num_parallel_calls,
+        deterministic=True)
+    options = dataset_ops.Options()
+    options.experimental_optimization.apply_default_optimizations = False
+    options.experimental_optimization.autotune = False
+    options.experimental_threading.private_threadpool_size = 16
+    dataset = dataset.with_options(options)
+    iterator = iter(dataset)
+
+    results = [self.evaluate(next(iterator))]
+    # Elements 1 to 3 are blocked, element 4 is done, and the buffer holds
+    # `num_parallel_calls` results.
+    self.assertEqual(wait_for_calls(5), 5)
+    for slow_element, max_buffered in [(1, 2 * num_parallel_calls),
+                                       (2, 4 * num_parallel_calls),
+                                       (3, 4 * num_parallel_calls)]:
+      # The consumer stalls on `slow_element` while later results are ready,
+      # which doubles the reorder buffer up to 4x `num_parallel_calls`.
+      consumer = self.checkedThread(
+          target=lambda: results.append(self.evaluate(next(iterator))))
+      consumer.start()
+      self.assertEqual(
+          wait_for_calls(slow_element + 1 + max_buffered),
+          slow_element + 1 + max_buffered)
+      slow_elements[slow_element].set()
+      consumer.join()
+
+    for element in iterator:
+      results.append(self.evaluate(element))
+    self.assertEqual(list(range(num_elements)), results)
+
   @combinations.generate(test_base.eager_only_combinations())
   def testCheckpointLargeBuffer(self):
     # Tensor of size 512M
@@ -160,6 +160,7 @@ class OptionsTest(test_base.DatasetTestBase, parameterized.TestCase):
     options.experimental_optimization.autotune = True
     options.experimental_optimization.autotune_buffers = True
     options.experimental_optimization.autotune_cpu_budget = 10
+    options.experimental_optimization.autotune_enforce_ram_budget = True
     options.experimental_optimization.autotune_ram_budget = 20
     options.experimental_optimization.filter_fusion = True
     options.experimental_optimization.filter_with_random_uniform_fusion = True
@@ -18,6 +18,7 @@ from __future__ import division
 from __future__ import print_function
 
 from tensorflow.compiler.tests import xla_test
+from tensorflow.core.framework import attr_value_pb2
 from tensorflow.python.eager import backprop
 from tensorflow.python.eager import context
 from tensorflow.python.eager import def_function
@@ -598,6 +599,44 @@ class DefFunctionTest(xla_test.XLATestCase):
           v.device) if on_gpu else 0
       self.assertEqual(initial_usage, final_usage)
 
+  def testUpdateVariableWithLockFreeReads(self):
+    with ops.Graph().as_default(), self.session() as sess, ops.device(
+        'device:{}:0'.format(self.device)):
+      handle = resource_variable_ops.var_handle_op(
+          dtype=dtypes.float32, shape=[4])
+      assign = resource_variable_ops.assign_variable_op(
+          handle, array_ops.zeros([4]))
+      assign._set_attr('_lock_free_reads', attr_value_pb2.AttrValue(b=True))
+      read = resource_variable_ops.read_variable_op(
+          handle, dtype=dtypes.float32)
+
+      @def_function.function(jit_compile=True)
+      def update_var(delta):
+        resource_variable_ops.assign_add_variable_op(handle, delta)
+        return delta
+
+      update = update_var(array_ops.ones([4]))
+      sess.run(assign)
+
+      num_updates = 100
+      def reader():
+        last = 0.
+        for _ in range(num_updates):
+          value = sess.run(read)
+          # Every XLA update must be visible as a whole, and in order.
+          self.assertAllEqual([value[0]] * 4, value)
+          self.assertGreaterEqual(value[0], last)
+          last = value[0]
+
+      threads = [self.checkedThread(target=reader) for _ in range(4)]
+      for t in threads:
+        t.start()
+      for i in range(num_updates):
+        sess.run(update)
+        self.assertAllEqual([i + 1.] * 4, sess.run(read))
+      for t in threads:
+        t.join()
+
   @test_util.disable_mlir_bridge('TODO(b/162381930): MLIR bridge renames '
                                  ' functions')
   def testUpdateVariableInClass(self):
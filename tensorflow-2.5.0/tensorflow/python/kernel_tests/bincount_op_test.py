@@ -96,6 +96,27 @@ class BincountTest(test_util.TensorFlowTestCase):
             self.evaluate(bincount_ops.bincount(arr, weights)),
             np.bincount(arr, weights))
 
+  def test_random_with_weights_many_bins(self):
+    # Too many bins for per-thread partial bins.
+    num_samples = 100000
+    num_bins = 5000000
+    with self.session(), ops.device("/CPU:0"):
+      np.random.seed(42)
+      arr = np.random.randint(0, num_bins, num_samples)
+      arr[:1000] = 7  # A bin with many updates.
+      weights = np.random.random(num_samples)
+      self.assertAllClose(
+          self.evaluate(
+              bincount_ops.bincount(arr, weights, minlength=num_bins)),
+          np.bincount(arr, weights, minlength=num_bins))
+      np_out = np.zeros(num_bins)
+      np_out[arr] = 1
+      self.assertAllEqual(
+          np_out,
+          self.evaluate(
+              gen_math_ops.dense_bincount(
+                  input=arr, weights=[], size=num_bins, binary_output=True)))
+
   def test_random_without_weights(self):
     num_samples = 10000
     with self.session():
@@ -519,6 +540,16 @@ class RaggedBincountOpTest(test_util.TensorFlowTestCase,
             gen_math_ops.ragged_bincount(
                 splits=x.row_splits, values=x.values, weights=[], size=6)))
 
+  def test_ragged_bincount_invalid_splits(self):
+    with self.assertRaisesRegex(errors.InvalidArgumentError,
+                                "Splits must be non-decreasing"):
+      self.evaluate(
+          gen_math_ops.ragged_bincount(
+              splits=[0, 3, 2, 4],
+              values=[1, 2, 3, 4],
+              weights=[],
+              size=6))
+
   @parameterized.parameters([{
       "dtype": np.int32,
   }, {
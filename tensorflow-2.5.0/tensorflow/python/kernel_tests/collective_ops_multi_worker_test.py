@@ -155,6 +155,31 @@ class CollectiveOpTest(test.TestCase):
     with self.assertRaises(errors.InvalidArgumentError):
       mpr.join()
 
+  def testAllReduceCompression(self):
+
+    def worker_fn():
+      cluster_resolver = cluster_resolver_lib.TFConfigClusterResolver()
+      enable_collective_ops(cluster_resolver)
+      with ops.device("/device:CPU:0"):
+        value = constant_op.constant([1. / 3, 2. / 3, 1e4 / 3, -1e-3 / 3])
+        value *= cluster_resolver.task_id + 1
+        return collective_ops.all_reduce_v2(
+            value,
+            group_size=2,
+            group_key=100,
+            instance_key=100,
+            communication_hint="ring",
+            compression="fp16").numpy()
+
+    cluster_spec = multi_worker_test_base.create_cluster_spec(num_workers=2)
+    mpr = multi_process_runner.MultiProcessRunner(worker_fn, cluster_spec)
+    mpr.start()
+    results = mpr.join().return_value
+    self.assertLen(results, 2)
+    self.assertAllClose(results[0], [1., 2., 1e4, -1e-3], rtol=1e-2)
+    # The values sent at reduced precision must not make the workers diverge.
+    self.assertAllEqual(results[0], results[1])
+
 
 two_worker_pool_runner = multi_process_runner.MultiProcessPoolRunner(
     multi_worker_test_base.create_cluster_spec(num_workers=2),
@@ -384,6 +384,39 @@ class CollectiveOpsTest(test.TestCase, parameterized.TestCase):
     run_and_assert(group_size=3, group_key=2)
 
 
+class BatchReduceV2Test(test.TestCase):
+
+  def setUp(self):
+    _setup_context()
+    super().setUp()
+
+  def testBatchReduce(self):
+
+    @def_function.function
+    def run_batch_reduce():
+      group_size = 2
+      group_key = 100
+      instance_key = 100
+      results = []
+      for i in range(group_size):
+        with ops.device('/device:CPU:%d' % i):
+          tensors = [
+              constant_op.constant([1., 2.]) * (i + 1),
+              constant_op.constant([[3.], [4.], [5.]]) * (i + 1),
+              constant_op.constant(6.) * (i + 1),
+          ]
+          results.append(
+              _collective_ops.batch_all_reduce_v2(tensors, group_size,
+                                                  group_key, instance_key))
+      return results
+
+    for results in run_batch_reduce():
+      self.assertLen(results, 3)
+      self.assertAllClose(results[0], [3., 6.])
+      self.assertAllClose(results[1], [[9.], [12.], [15.]])
+      self.assertAllClose(results[2], 18.)
+
+
 @combinations.generate(collective_op_combinations)
 class AbortCollectiveOpsTest(test.TestCase, parameterized.TestCase):
 
@@ -564,6 +564,21 @@ class ListOpsTest(test_util.TensorFlowTestCase, parameterized.TestCase):
     self.assertAllEqual(e, 1.0)
     self.assertAllEqual(list_ops.tensor_list_length(l), 0)
 
+  def testStackFromTensorAfterSetItem(self):
+    # Rows of 16 floats are aligned, so the list elements alias `t` and the
+    # first stack returns it without copying; modifying the list must not
+    # change `t` and must fall back to concatenating the elements.
+    t = array_ops.reshape(math_ops.range(64, dtype=dtypes.float32), [4, 16])
+    l = list_ops.tensor_list_from_tensor(t, element_shape=[16])
+    self.assertAllEqual(
+        list_ops.tensor_list_stack(l, element_dtype=dtypes.float32), t)
+    l = list_ops.tensor_list_set_item(l, 1, array_ops.zeros([16]))
+    expected = self.evaluate(t)
+    self.assertAllEqual(
+        list_ops.tensor_list_stack(l, element_dtype=dtypes.float32),
+        np.concatenate([expected[:1], np.zeros([1, 16]), expected[2:]]))
+    self.assertAllEqual(t, expected)
+
   @test_util.run_gpu_only
   def testFromTensorGPU(self):
     with context.device("gpu:0"):
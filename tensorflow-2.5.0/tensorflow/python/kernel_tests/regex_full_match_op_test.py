@@ -95,5 +95,29 @@ class RegexFullMatchOpTest(test.TestCase):
       self.assertTrue(op_vec.name.startswith("RegexFullMatch"), op.name)
 
 
+class RegexMatchSetTest(test.TestCase):
+
+  def testRegexMatchSet(self):
+    values = [["abaaba", "abcdabcde"], ["acdcba", "ebcda"]]
+    patterns = ["a.*a", "[a-e]+", "abc"]
+    matched = gen_string_ops.regex_match_set(values, patterns)
+    expected = [[[True, True, False], [False, True, False]],
+                [[True, True, False], [False, True, False]]]
+    self.assertAllEqual(expected, self.evaluate(matched))
+    for j, pattern in enumerate(patterns):
+      self.assertAllEqual(
+          self.evaluate(gen_string_ops.regex_full_match(values, pattern)),
+          self.evaluate(matched)[..., j])
+
+  def testNoPatterns(self):
+    matched = gen_string_ops.regex_match_set(
+        ["abc", "1"], constant_op.constant([], dtypes.string))
+    self.assertAllEqual([2, 0], self.evaluate(matched).shape)
+
+  def testInvalidPattern(self):
+    with self.assertRaisesOpError("Invalid pattern"):
+      self.evaluate(gen_string_ops.regex_match_set(["abc"], ["a", "A["]))
+
+
 if __name__ == "__main__":
   test.main()
@@ -123,5 +123,44 @@ class RegexReplaceTest(test.TestCase, parameterized.TestCase):
       op = string_ops.regex_replace(input_vector, pattern, replace)
       self.assertTrue(op.name.startswith("StaticRegexReplace"))
 
+
+class RegexReplaceSetTest(test.TestCase):
+
+  def testMatchesChainedRegexReplace(self):
+    values = [["aabbcc", "abcabc", "xyz"], ["", "cab", "ba"]]
+    patterns = ["a+", "b", "c$", "zz"]
+    rewrites = ["A", "<\\0>", "C", "!"]
+    for replace_global in [True, False]:
+      input_tensor = constant_op.constant(values, dtypes.string)
+      expected = input_tensor
+      for pattern, rewrite in zip(patterns, rewrites):
+        expected = gen_string_ops.regex_replace(expected, pattern, rewrite,
+                                                replace_global)
+      replaced = gen_string_ops.regex_replace_set(input_tensor, patterns,
+                                                  rewrites, replace_global)
+      self.assertAllEqual(self.evaluate(expected), self.evaluate(replaced))
+
+  def testLaterPatternsSeeEarlierRewrites(self):
+    replaced = gen_string_ops.regex_replace_set(["ab", "b"], ["a", "Xb"],
+                                                ["X", "Y"])
+    self.assertAllEqual([b"Y", b"b"], self.evaluate(replaced))
+
+  def testNoPatterns(self):
+    replaced = gen_string_ops.regex_replace_set(
+        ["ab", "b"], constant_op.constant([], dtypes.string),
+        constant_op.constant([], dtypes.string))
+    self.assertAllEqual([b"ab", b"b"], self.evaluate(replaced))
+
+  def testInvalidPattern(self):
+    with self.assertRaisesOpError("Invalid pattern"):
+      self.evaluate(
+          gen_string_ops.regex_replace_set(["abc"], ["a", "A["], ["b", "c"]))
+
+  @test_util.run_deprecated_v1
+  def testMismatchedRewrites(self):
+    with self.assertRaises(ValueError):
+      gen_string_ops.regex_replace_set(["abc"], ["a", "b"], ["c"])
+
+
 if __name__ == "__main__":
   test.main()
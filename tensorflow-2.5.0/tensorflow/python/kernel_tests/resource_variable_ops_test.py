@@ -26,6 +26,7 @@ import re
 from absl.testing import parameterized
 import numpy as np
 
+from tensorflow.core.framework import attr_value_pb2
 from tensorflow.core.framework import tensor_pb2
 from tensorflow.python.eager import backprop
 from tensorflow.python.eager import context
@@ -42,6 +43,7 @@ from tensorflow.python.framework import test_util
 from tensorflow.python.ops import array_ops
 from tensorflow.python.ops import control_flow_ops
 from tensorflow.python.ops import custom_gradient
+from tensorflow.python.ops import gen_training_ops
 from tensorflow.python.ops import gradients_impl
 from tensorflow.python.ops import init_ops
 from tensorflow.python.ops import list_ops
@@ -292,6 +294,28 @@ class ResourceVariableOpsTest(test_util.TensorFlowTestCase,
         resource_variable_ops.read_variable_op(handle, dtype=dtypes.int32))
     self.assertEqual(read, 2)
 
+  @test_util.run_deprecated_v1
+  def testLockFreeReads(self):
+    handle = resource_variable_ops.var_handle_op(
+        dtype=dtypes.int32, shape=[2, 1])
+    assign = resource_variable_ops.assign_variable_op(
+        handle, constant_op.constant([[1], [2]], dtype=dtypes.int32))
+    assign._set_attr("_lock_free_reads", attr_value_pb2.AttrValue(b=True))
+    read = resource_variable_ops.read_variable_op(handle, dtype=dtypes.int32)
+    with self.cached_session():
+      self.evaluate(assign)
+      self.assertAllEqual([[1], [2]], self.evaluate(read))
+      self.evaluate(resource_variable_ops.assign_add_variable_op(
+          handle, constant_op.constant([[1], [1]], dtype=dtypes.int32)))
+      self.assertAllEqual([[2], [3]], self.evaluate(read))
+      self.assertAllEqual(
+          [[3]],
+          self.evaluate(resource_variable_ops.resource_gather(
+              handle, [1], dtype=dtypes.int32)))
+      with self.assertRaisesOpError("lock-free reads"):
+        self.evaluate(resource_variable_ops.resource_scatter_add(
+            handle, [0], constant_op.constant([[1]], dtype=dtypes.int32)))
+
   @test_util.run_in_graph_and_eager_modes
   def testScatterAdd(self):
     handle = resource_variable_ops.var_handle_op(
@@ -932,6 +956,35 @@ class ResourceVariableOpsTest(test_util.TensorFlowTestCase,
     value = self.evaluate(value_op)
     self.assertAllEqual([0, 27, 63], value)
 
+  @test_util.run_in_graph_and_eager_modes
+  def testSparseSegmentCombine(self):
+    v = resource_variable_ops.ResourceVariable(
+        [[1.0, 2.0], [3.0, 4.0], [5.0, 6.0]], name="var0")
+    self.evaluate(variables.global_variables_initializer())
+    indices = [0, 2, 1, 2]
+    segment_ids = [0, 0, 2, 2]
+    for combiner, expected in [
+        ("sum", [[6.0, 8.0], [0.0, 0.0], [8.0, 10.0]]),
+        ("mean", [[3.0, 4.0], [0.0, 0.0], [4.0, 5.0]]),
+        ("sqrtn", np.array([[6.0, 8.0], [0.0, 0.0], [8.0, 10.0]]) /
+         np.sqrt(2.0))]:
+      value = resource_variable_ops.resource_sparse_segment_combine(
+          v.handle, indices, segment_ids, num_segments=3,
+          dtype=dtypes.float32, combiner=combiner)
+      self.assertAllClose(expected, self.evaluate(value))
+
+  @test_util.run_in_graph_and_eager_modes
+  def testSparseSegmentApplyGradientDescent(self):
+    v = resource_variable_ops.ResourceVariable(
+        [[1.0, 2.0], [3.0, 4.0], [5.0, 6.0]], name="var0")
+    self.evaluate(variables.global_variables_initializer())
+    self.evaluate(
+        gen_training_ops.resource_sparse_segment_apply_gradient_descent(
+            v.handle, alpha=1.0, grad=[[2.0, 2.0], [4.0, 4.0]],
+            indices=[0, 2, 1], segment_ids=[0, 0, 1], combiner="mean"))
+    self.assertAllClose([[0.0, 1.0], [-1.0, 0.0], [4.0, 5.0]],
+                        self.evaluate(v.value()))
+
   @test_util.run_deprecated_v1
   def testToFromProto(self):
     with self.cached_session():
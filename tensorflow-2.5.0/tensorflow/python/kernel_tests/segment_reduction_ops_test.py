@@ -28,6 +28,7 @@ from tensorflow.python.framework import dtypes as dtypes_lib
 from tensorflow.python.framework import errors_impl
 from tensorflow.python.framework import ops
 from tensorflow.python.framework import test_util
+from tensorflow.python.ops import gen_math_ops
 from tensorflow.python.ops import gradient_checker
 from tensorflow.python.ops import gradient_checker_v2
 from tensorflow.python.ops import math_ops
@@ -609,6 +610,27 @@ class SparseSegmentReductionOpTest(SparseSegmentReductionHelper):
         tf_ans = self.evaluate(s)
         self.assertAllClose(np_ans, tf_ans)
 
+  def testManySegments(self):
+    # Enough work for the segments to be reduced by several threads, with
+    # holes between the segment ids.
+    np.random.seed(0)
+    np_x = np.random.rand(1000, 64).astype(np.float32)
+    segment_sizes = np.random.randint(1, 50, size=500)
+    segment_ids = np.repeat(3 * np.arange(500), segment_sizes)
+    indices = np.random.randint(0, 1000, size=len(segment_ids))
+    np_sum = np.zeros([3 * 499 + 1, 64], dtype=np.float32)
+    np.add.at(np_sum, segment_ids, np_x[indices])
+    counts = np.zeros([3 * 499 + 1, 1], dtype=np.float32)
+    counts[3 * np.arange(500), 0] = segment_sizes
+    np_mean = np_sum / np.maximum(counts, 1)
+    np_sqrt_n = np_sum / np.sqrt(np.maximum(counts, 1))
+    with self.session(use_gpu=False):
+      for np_ans, tf_op in [(np_sum, math_ops.sparse_segment_sum),
+                            (np_mean, math_ops.sparse_segment_mean),
+                            (np_sqrt_n, math_ops.sparse_segment_sqrt_n)]:
+        s = tf_op(data=np_x, indices=indices, segment_ids=segment_ids)
+        self.assertAllClose(np_ans, self.evaluate(s), rtol=1e-5, atol=1e-5)
+
   def testWithEmptySegments(self):
     tf_x = constant_op.constant([], shape=[0, 4], dtype=dtypes_lib.float32)
     ops_list = [
@@ -947,6 +969,69 @@ class SparseSegmentReductionOpTest(SparseSegmentReductionHelper):
           self.evaluate(s)
 
 
+class SparseSegmentWeightedCombineTest(test.TestCase):
+
+  def _reference(self, data, indices, weights, segment_ids, combiner):
+    output = np.zeros((segment_ids[-1] + 1,) + data.shape[1:], data.dtype)
+    divisors = np.zeros(segment_ids[-1] + 1, data.dtype)
+    for i, w, s in zip(indices, weights, segment_ids):
+      output[s] += w * data[i]
+      divisors[s] += w if combiner == "mean" else w * w
+    for s in set(segment_ids):
+      if combiner == "mean":
+        output[s] /= divisors[s]
+      elif combiner == "sqrtn":
+        output[s] /= np.sqrt(divisors[s])
+    return output
+
+  def testValues(self):
+    data = np.arange(24, dtype=np.float32).reshape([6, 2, 2])
+    indices = [4, 0, 4, 2, 5]
+    weights = [2.0, 0.5, 1.0, 3.0, 0.25]
+    segment_ids = [0, 0, 2, 2, 3]
+    for combiner in ["sum", "mean", "sqrtn"]:
+      with self.session(use_gpu=False):
+        output = gen_math_ops.sparse_segment_weighted_combine(
+            data, indices, weights, segment_ids, combiner=combiner)
+        self.assertAllClose(
+            self._reference(data, indices, weights, segment_ids, combiner),
+            self.evaluate(output))
+
+  @test_util.run_deprecated_v1
+  def testGradient(self):
+    np_data = np.random.rand(5, 3)
+    np_weights = np.array([0.5, 2.0, 1.5, 1.0])
+    indices = [3, 0, 3, 1]
+    segment_ids = [0, 0, 1, 3]
+    for combiner in ["sum", "mean", "sqrtn"]:
+      with self.session(use_gpu=False):
+        data = constant_op.constant(np_data)
+        weights = constant_op.constant(np_weights)
+        output = gen_math_ops.sparse_segment_weighted_combine(
+            data, indices, weights, segment_ids, combiner=combiner)
+        jacob_t, jacob_n = gradient_checker.compute_gradient(
+            [data, weights], [[5, 3], [4]],
+            output, [4, 3],
+            x_init_value=[np_data, np_weights])
+        self.assertAllClose(jacob_t, jacob_n)
+
+  def testSegmentIdsNotSorted(self):
+    with self.session(use_gpu=False):
+      with self.assertRaisesOpError("segment ids are not increasing"):
+        self.evaluate(
+            gen_math_ops.sparse_segment_weighted_combine(
+                np.ones([3, 2], np.float32), [0, 1, 2], [1.0, 1.0, 1.0],
+                [1, 0, 1]))
+
+  def testIndicesOutOfRange(self):
+    with self.session(use_gpu=False):
+      with self.assertRaisesOpError(r"indices\[1\] == 3 out of range"):
+        self.evaluate(
+            gen_math_ops.sparse_segment_weighted_combine(
+                np.ones([3, 2], np.float32), [0, 3, 2], [1.0, 1.0, 1.0],
+                [0, 0, 1]))
+
+
 class SegmentReductionOpBenchmark(test.Benchmark):
   outer_dim_options = [2**x for x in range(9, 14, 2)]
   ratio_options = [2**x for x in range(1, 6, 2)]
@@ -167,6 +167,27 @@ class TopKTest(test.TestCase):
       values = -np.sort(-inputs, axis=1)[:, :k]
       self._validateTopK(inputs, k, values, indices)
 
+  def testLongRowTopK(self):
+    # Rows this long with few rows take the multithreaded radix select.
+    n = 100000
+    k = 1000
+    for dtype in [np.float32, np.float64, np.int32, np.int64]:
+      inputs = np.random.permutation(np.arange(n)).astype(dtype).reshape(1, n)
+      indices = np.argsort(-inputs, axis=1)[:, :k]
+      values = -np.sort(-inputs, axis=1)[:, :k]
+      self._validateTopK(inputs, k, values, indices)
+      self._validateTopK(inputs, k, values, indices, sorted=False)
+
+  def testLongRowStableSort(self):
+    n = 100000
+    k = 20000
+    # Lots of repeated values, including both signed zeros.
+    inputs = np.random.randint(-3, 3, size=[2, n]).astype(np.float32)
+    inputs[:, 7] = -0.0
+    indices = np.argsort(-inputs, axis=1, kind="mergesort")[:, :k]
+    values = -np.sort(-inputs, axis=1)[:, :k]
+    self._validateTopK(inputs, k, values, indices)
+
   def testTopAll(self):
     inputs = [[0.1, 0.3, 0.2, 0.4], [0.1, 0.3, 0.3, 0.2]]
     self._validateTopK(inputs, 4, [[0.4, 0.3, 0.2, 0.1], [0.3, 0.3, 0.2, 0.1]],
@@ -285,6 +285,17 @@ class TransposeTest(test.TestCase):
         self.assertAllEqual(np_ans, tf_ans)
         self.assertShapeEqual(np_ans, y)
 
+  def testLargeSizeAllPermutationsCPU(self):
+    # Large enough for the blocked transpose to use full tiles and have
+    # partial tiles at the edges.
+    for dtype in [np.int8, np.float16, np.float32, np.float64, np.complex128]:
+      x = np.arange(0, 5 * 19 * 37 * 70).reshape([5, 19, 37, 70]).astype(dtype)
+      for p in itertools.permutations(range(4)):
+        np_ans = self._np_transpose(x, p)
+        with self.cached_session(use_gpu=False):
+          tf_ans = self.evaluate(array_ops.transpose(x, p))
+        self.assertAllEqual(np_ans, tf_ans)
+
   def testRandomizedSmallDimLargeSizeGPU(self):
     # If no GPU available, skip the test
     if not test.is_gpu_available(cuda_only=True):
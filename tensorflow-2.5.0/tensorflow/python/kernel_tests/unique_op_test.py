@@ -170,6 +170,32 @@ class UniqueTest(test.TestCase):
     self.assertAllEqual(tf_y, true_y)
     self.assertAllEqual(tf_idx, true_idx)
 
+  def testLargeOrderedByAppearance(self):
+    # Large enough to be uniquified in parallel.
+    x = np.random.randint(0, high=50000, size=200000)
+    true_y, first, true_idx = np.unique(
+        x, return_index=True, return_inverse=True)
+    order = np.argsort(first)
+    rank = np.empty_like(order)
+    rank[order] = np.arange(len(order))
+    for out_idx in [dtypes.int32, dtypes.int64]:
+      y, idx = array_ops.unique(x, out_idx=out_idx)
+      tf_y, tf_idx = self.evaluate([y, idx])
+      self.assertAllEqual(tf_y, true_y[order])
+      self.assertAllEqual(tf_idx, rank[true_idx])
+
+  def testLargeAxisOrderedByAppearance(self):
+    x = np.random.randint(0, high=4, size=(3, 50000))
+    true_y, first, true_idx = np.unique(
+        x, axis=1, return_index=True, return_inverse=True)
+    order = np.argsort(first)
+    rank = np.empty_like(order)
+    rank[order] = np.arange(len(order))
+    y, idx = gen_array_ops.unique_v2(x, axis=np.array([1], np.int32))
+    tf_y, tf_idx = self.evaluate([y, idx])
+    self.assertAllEqual(tf_y, true_y[:, order])
+    self.assertAllEqual(tf_idx, rank[true_idx])
+
 
 class UniqueWithCountsTest(test.TestCase):
 
@@ -315,6 +341,16 @@ class UniqueWithCountsTest(test.TestCase):
     self.assertAllEqual(tf_idx, true_idx)
     self.assertAllEqual(tf_count, true_count)
 
+  def testLargeString(self):
+    x = [str(i).encode('ascii') for i in np.random.randint(10000, size=100000)]
+    y, idx, count = array_ops.unique_with_counts(x)
+    tf_y, tf_idx, tf_count = self.evaluate([y, idx, count])
+
+    _, first = np.unique(x, return_index=True)
+    self.assertAllEqual(tf_y, [x[i] for i in np.sort(first)])
+    self.assertAllEqual([tf_y[i] for i in tf_idx], x)
+    self.assertAllEqual(tf_count, np.bincount(tf_idx))
+
 
 if __name__ == '__main__':
   test.main()
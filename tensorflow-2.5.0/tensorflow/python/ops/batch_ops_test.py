@@ -25,6 +25,7 @@ import numpy as np
 from tensorflow.core.protobuf import config_pb2
 from tensorflow.python.eager import context
 from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import errors
 from tensorflow.python.framework import function
 from tensorflow.python.framework import ops
 from tensorflow.python.framework import test_util
@@ -562,5 +563,31 @@ class BatchOpsTest(test.TestCase):
       self.assertEqual(len(thread_results), 0)
 
 
+  def testSequenceStateCache(self):
+    """Tests storing, reading and releasing per-sequence state."""
+    cache = gen_batch_ops.sequence_state_cache(
+        dtype=dtypes.float32, state_shape=[2], capacity=2,
+        shared_name="sequence_state_cache")
+    self.evaluate(gen_batch_ops.sequence_state_cache_scatter(
+        cache, [7, 3], [[1., 2.], [3., 4.]]))
+    # Unknown sequences start from zeros.
+    self.assertAllEqual(
+        [[3., 4.], [0., 0.], [1., 2.]],
+        self.evaluate(gen_batch_ops.sequence_state_cache_gather(
+            cache, [3, 5, 7], dtype=dtypes.float32)))
+    self.evaluate(gen_batch_ops.sequence_state_cache_scatter(
+        cache, [3], [[5., 6.]]))
+    with self.assertRaisesRegex(errors.ResourceExhaustedError, "is full"):
+      self.evaluate(gen_batch_ops.sequence_state_cache_scatter(
+          cache, [5], [[0., 0.]]))
+    self.evaluate(gen_batch_ops.sequence_state_cache_release(cache, [7]))
+    self.evaluate(gen_batch_ops.sequence_state_cache_scatter(
+        cache, [5], [[7., 8.]]))
+    self.assertAllEqual(
+        [[0., 0.], [5., 6.], [7., 8.]],
+        self.evaluate(gen_batch_ops.sequence_state_cache_gather(
+            cache, [7, 3, 5], dtype=dtypes.float32)))
+
+
 if __name__ == "__main__":
   test.main()
@@ -45,8 +45,10 @@ def all_reduce(t,
       independent subdivision should begin.  Use [0] if no subdivision should
       be done.
     communication_hint: preferred collective communication.  The implementation
-      may fall back to another mechanism.  Options include `auto`, `ring`, and
-      `nccl`.
+      may fall back to another mechanism.  Options include `auto`, `ring`,
+      `nccl`, and `hierarchical`, which reduces within each task before
+      reducing across tasks for CPU groups with the same number of devices on
+      each task.
     timeout: a float. If set to a non zero, set a completion timeout to detect
       staleness.  If the timer goes off, a DeadlineExceededError is raised.  The
       timeout value in seconds. This feature is experimental.
@@ -79,7 +81,8 @@ def all_reduce_v2(t,
                   final_op='Id',
                   communication_hint='auto',
                   timeout=0,
-                  ordering_token=None):
+                  ordering_token=None,
+                  compression='none'):
   """Reduces tensors collectively, across devices.
 
   Args:
@@ -102,6 +105,9 @@ def all_reduce_v2(t,
     ordering_token: an optional resource tensor to pass to the op as inputs.
       They aren't used by the kernel but allow AutoControlDependency to order
       the collectives with control dependencies.
+    compression: the format in which float32 values are sent between tasks.
+      Can be 'none', 'fp16' or 'bf16'.  The compressed formats trade precision
+      for bandwidth.  Only honored by the ring implementation on CPU.
 
   Returns:
     An Op implementing the distributed reduction.
@@ -117,7 +123,65 @@ def all_reduce_v2(t,
       final_op=final_op,
       communication_hint=communication_hint.lower(),
       timeout_seconds=timeout,
-      ordering_token=ordering_token or [])
+      ordering_token=ordering_token or [],
+      compression=compression)
+
+
+def batch_all_reduce_v2(tensors,
+                        group_size,
+                        group_key,
+                        instance_key,
+                        merge_op='Add',
+                        final_op='Id',
+                        communication_hint='auto',
+                        timeout=0,
+                        ordering_token=None,
+                        compression='none'):
+  """Reduces a list of tensors collectively with a single collective.
+
+  This is equivalent to calling `all_reduce_v2` on each of `tensors`, but the
+  tensors are packed into one buffer and reduced together, which is cheaper
+  for many small tensors. Only supported on CPU.
+
+  Args:
+    tensors: a non-empty list of tensors of the same dtype to be reduced.
+    group_size: an int32 tensor. The total number of tensors to be collectively
+      reduced.  Each must reside on a different device.  Should be a positive
+      integer.
+    group_key: an int32 tensor identifying the group of devices.
+    instance_key: an int32 tensor identifying the participating group of Ops.
+    merge_op: string naming the binary Op to be applied to compute each partial
+      reduction.
+    final_op: string naming the unary Op to be applied to each fully reduced
+      value.  Can be 'Id' for no operation.
+    communication_hint: preferred collective communication.  The implementation
+      may fall back to another mechanism.  Options include `auto` and `ring`.
+    timeout: a float. If set to a non zero, set a completion timeout to detect
+      staleness.  If the timer goes off, a DeadlineExceededError is raised.  The
+      timeout value in seconds. This feature is experimental.
+    ordering_token: an optional resource tensor to pass to the op as inputs.
+      They aren't used by the kernel but allow AutoControlDependency to order
+      the collectives with control dependencies.
+    compression: the format in which float32 values are sent between tasks.
+      Can be 'none', 'fp16' or 'bf16'.  The compressed formats trade precision
+      for bandwidth.  Only honored by the ring implementation on CPU.
+
+  Returns:
+    A list of the reduced tensors, in the order of `tensors`.
+  """
+  if ordering_token is not None:
+    ordering_token = [ordering_token]
+  return gen_collective_ops.collective_batch_reduce_v2(
+      tensors,
+      group_size=group_size,
+      group_key=group_key,
+      instance_key=instance_key,
+      merge_op=merge_op,
+      final_op=final_op,
+      communication_hint=communication_hint.lower(),
+      timeout_seconds=timeout,
+      ordering_token=ordering_token or [],
+      compression=compression)
 
 
 def all_gather(t,
@@ -21,6 +21,7 @@ from six.moves import xrange  # pylint: disable=redefined-builtin
 
 from tensorflow.python.compat import compat
 from tensorflow.python.framework import constant_op
+from tensorflow.python.framework import device as pydev
 from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import ops
 from tensorflow.python.framework import sparse_tensor
@@ -30,6 +31,7 @@ from tensorflow.python.ops import clip_ops
 # Imports gradient definitions.
 from tensorflow.python.ops import data_flow_grad  # pylint: disable=unused-import
 from tensorflow.python.ops import data_flow_ops
+from tensorflow.python.ops import gen_math_ops
 from tensorflow.python.ops import math_ops
 from tensorflow.python.ops import resource_variable_ops
 from tensorflow.python.ops import sparse_ops
@@ -507,6 +509,18 @@ def embedding_lookup_sparse(params,
                       params + [sp_ids]) as name:
     segment_ids = sp_ids.indices[:, 0]
 
+    if _can_fuse_lookup_and_combine(params, max_norm):
+      # Accumulate the looked-up rows straight into the combined output rather
+      # than gathering a [nnz, dim] intermediate first.
+      data = ops.convert_to_tensor(params[0])
+      if ignore_weights:
+        weights = array_ops.ones_like(sp_ids.values, dtype=data.dtype)
+      else:
+        weights = math_ops.cast(sp_weights.values, data.dtype)
+      return gen_math_ops.sparse_segment_weighted_combine(
+          data, sp_ids.values, weights, segment_ids, combiner=combiner,
+          name=name)
+
     ids = sp_ids.values
     ids, idx = array_ops.unique(ids)
 
@@ -579,6 +593,22 @@ def embedding_lookup_sparse(params,
     return embeddings
 
 
+def _can_fuse_lookup_and_combine(params, max_norm):
+  """Returns whether `SparseSegmentWeightedCombine` can serve the lookup.
+
+  The fused kernel reads a single, unpartitioned table and only exists for
+  CPU, so it is used only when `params` is known to live there.
+  """
+  if len(params) != 1 or max_norm is not None:
+    return False
+  if params[0].dtype.base_dtype not in (dtypes.float32, dtypes.float64):
+    return False
+  device = params[0].device
+  if not device:
+    return False
+  return pydev.DeviceSpec.from_string(device).device_type == "CPU"
+
+
 @tf_export("nn.embedding_lookup_sparse", v1=[])
 @dispatch.add_dispatch_support
 def embedding_lookup_sparse_v2(params,
@@ -4262,6 +4262,62 @@ class JpegTest(test_util.TensorFlowTestCase):
           result = image_ops.decode_and_crop_jpeg(jpeg0, crop_window)
           self.evaluate(result)
 
+  def testDecodeJpegBatch(self):
+    with self.cached_session():
+      base = "tensorflow/core/lib/jpeg/testdata"
+      jpeg0 = io_ops.read_file(os.path.join(base, "jpeg_merge_test1.jpg"))
+      image0 = image_ops.decode_jpeg(jpeg0)
+      jpeg1 = image_ops.encode_jpeg(image0[:100, :60])
+      contents = array_ops.stack([jpeg0, jpeg1])
+      no_crop = array_ops.zeros([0, 4], dtypes.int32)
+
+      # Full size, padded to the largest image.
+      images, sizes = gen_image_ops.decode_jpeg_batch(contents, no_crop)
+      expected0, expected1, images, sizes = self.evaluate(
+          [image0, image_ops.decode_jpeg(jpeg1), images, sizes])
+      self.assertAllEqual([[256, 128], [100, 60]], sizes)
+      self.assertAllEqual([2, 256, 128, 3], images.shape)
+      self.assertAllEqual(expected0, images[0])
+      self.assertAllEqual(expected1, images[1, :100, :60])
+      self.assertAllEqual(np.zeros([156, 128, 3]), images[1, 100:])
+      self.assertAllEqual(np.zeros([100, 68, 3]), images[1, :100, 60:])
+
+      # Downscaled during decoding to cover the target size.
+      images, sizes = gen_image_ops.decode_jpeg_batch(
+          contents, no_crop, target_height=64, target_width=30)
+      expected0 = image_ops.decode_jpeg(jpeg0, ratio=4)
+      expected1 = image_ops.decode_jpeg(jpeg1, ratio=1)
+      expected0, expected1, images, sizes = self.evaluate(
+          [expected0, expected1, images, sizes])
+      self.assertAllEqual([[64, 32], [100, 60]], sizes)
+      self.assertAllEqual(expected0, images[0, :64, :32])
+      self.assertAllEqual(expected1, images[1])
+
+      # Crop windows are given in pixels of the full image.
+      crop_windows = [[10, 20, 100, 60], [6, 5, 15, 10]]
+      images, sizes = gen_image_ops.decode_jpeg_batch(
+          contents, crop_windows, target_height=50, target_width=30)
+      expected0 = gen_image_ops.decode_and_crop_jpeg(
+          jpeg0, [5, 10, 50, 30], ratio=2)
+      expected1 = image_ops.decode_and_crop_jpeg(jpeg1, crop_windows[1])
+      expected0, expected1, images, sizes = self.evaluate(
+          [expected0, expected1, images, sizes])
+      self.assertAllEqual([[50, 30], [15, 10]], sizes)
+      self.assertAllEqual(expected0, images[0])
+      self.assertAllEqual(expected1, images[1, :15, :10])
+
+      with self.assertRaisesRegex(errors.InvalidArgumentError,
+                                  "Crop window .* of image 1 is outside"):
+        self.evaluate(
+            gen_image_ops.decode_jpeg_batch(contents,
+                                            [[0, 0, 10, 10], [0, 0, 101, 10]]))
+      with self.assertRaisesRegex(errors.InvalidArgumentError,
+                                  "Image 1 is not a valid JPEG image"):
+        self.evaluate(
+            gen_image_ops.decode_jpeg_batch(
+                array_ops.stack([jpeg0, constant_op.constant("not a jpeg")]),
+                no_crop))
+
   def testSynthetic(self):
     with self.cached_session():
       # Encode it, then decode it, then encode it
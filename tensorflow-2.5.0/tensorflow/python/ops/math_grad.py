@@ -388,6 +388,22 @@ def _SparseSegmentSqrtNWithNumSegmentsGrad(op, grad):
                                               dim0), None, None, None)
 
 
+@ops.RegisterGradient("SparseSegmentWeightedCombine")
+def _SparseSegmentWeightedCombineGrad(op, grad):
+  """Gradient for SparseSegmentWeightedCombine."""
+  indices, values, weights_grad = (
+      gen_math_ops.sparse_segment_weighted_combine_grad(
+          grad,
+          op.inputs[0],
+          op.inputs[1],
+          op.inputs[2],
+          op.inputs[3],
+          combiner=op.get_attr("combiner")))
+  params_grad = ops.IndexedSlices(values, indices,
+                                  array_ops.shape(op.inputs[0]))
+  return (params_grad, None, weights_grad, None)
+
+
 def _SegmentMinOrMaxGrad(op, grad):
   """ Gradient for SegmentMin and SegmentMax. """
   zeros = array_ops.zeros_like(op.inputs[0], dtype=op.inputs[0].dtype)
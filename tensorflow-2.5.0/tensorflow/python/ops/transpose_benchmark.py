@@ -18,6 +18,7 @@ from __future__ import absolute_import
 from __future__ import division
 from __future__ import print_function
 
+import itertools
 import time
 
 import numpy as np
@@ -153,6 +154,18 @@ class TransposeBenchmark(test.Benchmark):
       for ishape, perm in zip(small_dim_small_shapes, small_dim_perms):
         self._run_graph("gpu", ishape, perm, num_iters, datatype)
 
+  def benchmark_transpose_cpu_rank4(self):
+    print("transpose cpu rank 4 benchmark:")
+
+    datatypes = [np.float64, np.float32, np.float16, np.int8]
+    shapes = [[8, 56, 56, 64], [8, 64, 56, 56], [2, 3, 224, 224]]
+
+    num_iters = 20
+    for datatype in datatypes:
+      for ishape in shapes:
+        for perm in itertools.permutations(range(4)):
+          self._run_graph("cpu", ishape, list(perm), num_iters, datatype)
+
 
 if __name__ == "__main__":
   test.main()
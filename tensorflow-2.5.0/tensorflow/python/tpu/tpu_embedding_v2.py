@@ -40,6 +40,7 @@ from tensorflow.python.framework import ops
 from tensorflow.python.framework import sparse_tensor
 from tensorflow.python.ops import array_ops
 from tensorflow.python.ops import embedding_ops
+from tensorflow.python.ops import gen_array_ops
 from tensorflow.python.ops import math_ops
 from tensorflow.python.ops import sparse_ops
 from tensorflow.python.ops import variable_scope
@@ -245,7 +246,8 @@ class TPUEmbedding(tracking.AutoTrackable):
       self,
       feature_config: Union[tpu_embedding_v2_utils.FeatureConfig, Iterable],  # pylint:disable=g-bare-generic
       optimizer: Optional[tpu_embedding_v2_utils._Optimizer],  # pylint:disable=protected-access
-      pipeline_execution_with_tensor_core: bool = False):
+      pipeline_execution_with_tensor_core: bool = False,
+      deduplicate_ids: bool = False):
     """Creates the TPUEmbedding mid level API object.
 
     ```python
@@ -270,6 +272,12 @@ class TPUEmbedding(tracking.AutoTrackable):
       pipeline_execution_with_tensor_core: If True, the TPU embedding
         computations will overlap with the TensorCore computations (and hence
         will be one step old). Set to True for improved performance.
+      deduplicate_ids: If True, repeated ids within a sample of a SparseTensor
+        input are merged on the host before being enqueued, with their weights
+        summed. This only applies to non-sequence features whose table uses the
+        "sum" or "mean" combiner, where the merge does not change the result,
+        and reduces the amount of data sent to the TPU for inputs with many
+        repeated ids.
 
     Raises:
       ValueError: If optimizer is not one of tf.tpu.experimental.embedding.(SGD,
@@ -280,6 +288,7 @@ class TPUEmbedding(tracking.AutoTrackable):
                                                   tpu_strategy.TPUStrategyV2))
     self._pipeline_execution_with_tensor_core = (
         pipeline_execution_with_tensor_core)
+    self._deduplicate_ids = deduplicate_ids
 
     self._feature_config = feature_config
 
@@ -905,19 +914,73 @@ class TPUEmbedding(tracking.AutoTrackable):
     weights.append(float_zeros)
 
   def _add_data_for_sparse_tensor(self, tensor, weight, indices, values,
-                                  weights, int_zeros, float_zeros, path):
-    indices.append(math_ops.cast(tensor.indices, dtypes.int32))
-    values.append(math_ops.cast(tensor.values, dtypes.int32))
+                                  weights, int_zeros, float_zeros, path,
+                                  feature):
     # If we have weights they must be a SparseTensor.
     if weight is not None:
       if not isinstance(weight, sparse_tensor.SparseTensor):
         raise ValueError("Weight for {} is type {} which does not match "
                          "type input which is SparseTensor.".format(
                              path, type(weight)))
+    if (self._deduplicate_ids and feature.max_sequence_length == 0 and
+        feature.table.combiner in ("sum", "mean")):
+      sample_indices, ids, id_weights = self._deduplicate_sparse_ids(
+          tensor, weight)
+      indices.append(sample_indices)
+      values.append(ids)
+      weights.append(id_weights)
+      return
+    indices.append(math_ops.cast(tensor.indices, dtypes.int32))
+    values.append(math_ops.cast(tensor.values, dtypes.int32))
+    if weight is not None:
       weights.append(math_ops.cast(weight.values, dtypes.float32))
     else:
       weights.append(float_zeros)
 
+  def _deduplicate_sparse_ids(self, tensor, weight):
+    """Merges repeated (sample, id) pairs of a SparseTensor input.
+
+    For the "sum" and "mean" combiners an id looked up n times in a sample with
+    weights w_1...w_n contributes the same as a single lookup with weight
+    w_1 + ... + w_n, both to the activations and to the gradients, so the
+    duplicates can be dropped before the data is enqueued.
+
+    Pairs are compared on the raw sample index and id, so ids outside the
+    vocabulary are never merged with other ids and are still reported by the
+    enqueue.
+
+    Args:
+      tensor: The SparseTensor input.
+      weight: The SparseTensor weights for the input, or None.
+
+    Returns:
+      A tuple of the int32 sample indices, the int32 ids and the float32
+      weights to enqueue, with one entry per distinct (sample, id) pair in the
+      order the pairs first occur in the input.
+    """
+    ids = math_ops.cast(tensor.values, dtypes.int64)
+    pairs = array_ops.stack(
+        [math_ops.cast(tensor.indices[:, 0], dtypes.int64), ids], axis=1)
+    unique_pairs, segment_ids = gen_array_ops.unique_v2(
+        pairs, axis=[0], out_idx=dtypes.int32)
+    num_unique = array_ops.shape(unique_pairs, out_type=dtypes.int32)[0]
+    # Keep the index of the first occurrence of each pair.
+    first_positions = math_ops.unsorted_segment_min(
+        math_ops.range(array_ops.size(ids, out_type=dtypes.int32)),
+        segment_ids, num_unique)
+    unique_indices = array_ops.gather(
+        math_ops.cast(tensor.indices, dtypes.int32), first_positions)
+    unique_ids = math_ops.cast(unique_pairs[:, 1], dtypes.int32)
+    # Without weights every lookup counts as 1, so the merged weight of a pair
+    # is the number of times it occurs.
+    if weight is not None:
+      lookup_weights = math_ops.cast(weight.values, dtypes.float32)
+    else:
+      lookup_weights = array_ops.ones_like(ids, dtype=dtypes.float32)
+    unique_weights = math_ops.unsorted_segment_sum(
+        lookup_weights, segment_ids, num_unique)
+    return unique_indices, unique_ids, unique_weights
+
   def _add_data_for_ragged_tensor(self, tensor, weight, indices, values,
                                   weights, int_zeros, float_zeros, path):
     indices.append(math_ops.cast(tensor.row_splits, dtypes.int32))
@@ -1005,7 +1068,7 @@ class TPUEmbedding(tracking.AutoTrackable):
                                   int_zeros, float_zeros, path)
       elif isinstance(inp, sparse_tensor.SparseTensor):
         self._add_data_for_sparse_tensor(inp, weight, indices, values, weights,
-                                         int_zeros, float_zeros, path)
+                                         int_zeros, float_zeros, path, feature)
       elif isinstance(inp, ragged_tensor.RaggedTensor):
         self._add_data_for_ragged_tensor(inp, weight, indices, values, weights,
                                          int_zeros, float_zeros, path)
@@ -352,6 +352,50 @@ class CPUEmbeddingTest(test.TestCase):
         list(mid_level._variables[self.table_video.name].keys()),
         ['parameters'])
 
+  def test_deduplicate_sparse_ids(self):
+    mid_level = tpu_embedding_v2.TPUEmbedding(
+        feature_config=self.feature_config,
+        optimizer=None,
+        deduplicate_ids=True)
+    # row 0: 3, 3
+    # row 1: 1, 3, 1
+    # row 2: 3
+    features = sparse_tensor.SparseTensor(
+        indices=[[0, 0], [0, 1], [1, 0], [1, 1], [1, 2], [2, 0]],
+        values=[3, 3, 1, 3, 1, 3],
+        dense_shape=[3, 3])
+    weights = sparse_tensor.SparseTensor(
+        indices=features.indices,
+        values=[1.0, 2.0, 0.5, 1.0, 0.25, 4.0],
+        dense_shape=features.dense_shape)
+
+    indices, ids, merged_weights = mid_level._deduplicate_sparse_ids(
+        features, weights)
+    self.assertAllEqual(indices, [[0, 0], [1, 0], [1, 1], [2, 0]])
+    self.assertAllEqual(ids, [3, 1, 3, 3])
+    self.assertAllClose(merged_weights, [3.0, 0.75, 1.0, 4.0])
+
+    _, _, counts = mid_level._deduplicate_sparse_ids(features, None)
+    self.assertAllClose(counts, [2.0, 2.0, 1.0, 1.0])
+
+  def test_deduplicate_sparse_ids_keeps_out_of_range_ids_apart(self):
+    mid_level = tpu_embedding_v2.TPUEmbedding(
+        feature_config=self.feature_config,
+        optimizer=None,
+        deduplicate_ids=True)
+    vocabulary_size = self.table_video.vocabulary_size
+    # Combining the sample index and the id as sample * vocabulary_size + id
+    # would map both pairs to the same key.
+    features = sparse_tensor.SparseTensor(
+        indices=[[0, 0], [1, 0]],
+        values=[vocabulary_size + 1, 1],
+        dense_shape=[2, 1])
+
+    indices, ids, counts = mid_level._deduplicate_sparse_ids(features, None)
+    self.assertAllEqual(indices, [[0, 0], [1, 0]])
+    self.assertAllEqual(ids, [vocabulary_size + 1, 1])
+    self.assertAllClose(counts, [1.0, 1.0])
+
 
 if __name__ == '__main__':
   v2_compat.enable_v2_behavior()
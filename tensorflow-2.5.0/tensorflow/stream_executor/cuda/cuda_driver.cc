@@ -1125,6 +1125,77 @@ GpuDriver::CreateMemoryHandle(GpuContext* context, uint64 bytes) {
   return false;
 }
 
+#if CUDA_VERSION >= 10020
+/* static */ port::Status GpuDriver::StreamBeginCapture(GpuContext* context,
+                                                        CUstream stream) {
+  ScopedActivateContext activated{context};
+  CHECK(stream != nullptr);
+  RETURN_IF_CUDA_RES_ERROR(
+      cuStreamBeginCapture(stream, CU_STREAM_CAPTURE_MODE_THREAD_LOCAL),
+      "Failed to begin capturing CUDA stream");
+  return port::Status::OK();
+}
+
+/* static */ port::Status GpuDriver::StreamEndCapture(GpuContext* context,
+                                                      CUstream stream,
+                                                      CUgraph* graph) {
+  ScopedActivateContext activated{context};
+  CHECK(stream != nullptr);
+  RETURN_IF_CUDA_RES_ERROR(cuStreamEndCapture(stream, graph),
+                           "Failed to end capturing CUDA stream");
+  return port::Status::OK();
+}
+
+/* static */ port::Status GpuDriver::GraphInstantiate(GpuContext* context,
+                                                      CUgraphExec* exec,
+                                                      CUgraph graph) {
+  ScopedActivateContext activated{context};
+  RETURN_IF_CUDA_RES_ERROR(
+      cuGraphInstantiate(exec, graph, /*phErrorNode=*/nullptr,
+                         /*logBuffer=*/nullptr, /*bufferSize=*/0),
+      "Failed to instantiate CUDA graph");
+  return port::Status::OK();
+}
+
+/* static */ port::Status GpuDriver::GraphExecUpdate(GpuContext* context,
+                                                     CUgraphExec exec,
+                                                     CUgraph graph) {
+  ScopedActivateContext activated{context};
+  CUgraphNode error_node = nullptr;
+  CUgraphExecUpdateResult result = CU_GRAPH_EXEC_UPDATE_SUCCESS;
+  RETURN_IF_CUDA_RES_ERROR(cuGraphExecUpdate(exec, graph, &error_node, &result),
+                           "Failed to update CUDA graph, update result ",
+                           static_cast<int>(result));
+  return port::Status::OK();
+}
+
+/* static */ port::Status GpuDriver::GraphLaunch(GpuContext* context,
+                                                 CUgraphExec exec,
+                                                 CUstream stream) {
+  ScopedActivateContext activated{context};
+  RETURN_IF_CUDA_RES_ERROR(cuGraphLaunch(exec, stream),
+                           "Failed to launch CUDA graph");
+  return port::Status::OK();
+}
+
+/* static */ void GpuDriver::DestroyGraph(GpuContext* context, CUgraph graph) {
+  ScopedActivateContext activated{context};
+  CUresult res = cuGraphDestroy(graph);
+  if (res != CUDA_SUCCESS) {
+    LOG(ERROR) << "Failed to destroy CUDA graph: " << ToString(res);
+  }
+}
+
+/* static */ void GpuDriver::DestroyGraphExec(GpuContext* context,
+                                              CUgraphExec exec) {
+  ScopedActivateContext activated{context};
+  CUresult res = cuGraphExecDestroy(exec);
+  if (res != CUDA_SUCCESS) {
+    LOG(ERROR) << "Failed to destroy CUDA graph exec: " << ToString(res);
+  }
+}
+#endif  // CUDA_VERSION >= 10020
+
 /* static */ port::Status GpuDriver::SynchronousMemcpyD2H(GpuContext* context,
                                                           void* host_dst,
                                                           CUdeviceptr gpu_src,
@@ -404,6 +404,53 @@ class GpuDriver {
   // the stream immediately after this returns).
   static bool IsStreamIdle(GpuContext* context, GpuStreamHandle stream);
 
+  // Stream capture and graph updates are usable as of CUDA 10.2
+#if CUDA_VERSION >= 10020
+
+  // Starts capturing the work enqueued onto stream into a graph, instead of
+  // running it, via cuStreamBeginCapture. Operations that are not allowed
+  // during capture, e.g. synchronous allocations or copies, fail the capture
+  // if they are issued from the calling thread.
+  // https://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__STREAM.html
+  static port::Status StreamBeginCapture(GpuContext* context,
+                                         GpuStreamHandle stream);
+
+  // Ends the capture started by StreamBeginCapture and returns the captured
+  // graph via cuStreamEndCapture. Fails if the capture was invalidated.
+  // https://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__STREAM.html
+  static port::Status StreamEndCapture(GpuContext* context,
+                                       GpuStreamHandle stream,
+                                       GpuGraphHandle* graph);
+
+  // Creates an executable graph from graph via cuGraphInstantiate.
+  // https://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__GRAPH.html
+  static port::Status GraphInstantiate(GpuContext* context,
+                                       GpuGraphExecHandle* exec,
+                                       GpuGraphHandle graph);
+
+  // Updates the parameters, e.g. the buffer addresses, of the nodes of exec
+  // to those of graph via cuGraphExecUpdate. Fails if the graphs differ in
+  // their topology, in which case exec must be instantiated again.
+  // https://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__GRAPH.html
+  static port::Status GraphExecUpdate(GpuContext* context,
+                                      GpuGraphExecHandle exec,
+                                      GpuGraphHandle graph);
+
+  // Launches exec onto stream via cuGraphLaunch.
+  // https://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__GRAPH.html
+  static port::Status GraphLaunch(GpuContext* context, GpuGraphExecHandle exec,
+                                  GpuStreamHandle stream);
+
+  // Destroys graph via cuGraphDestroy.
+  // https://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__GRAPH.html
+  static void DestroyGraph(GpuContext* context, GpuGraphHandle graph);
+
+  // Destroys exec via cuGraphExecDestroy once its pending launches are done.
+  // https://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__GRAPH.html
+  static void DestroyGraphExec(GpuContext* context, GpuGraphExecHandle exec);
+
+#endif  // CUDA_VERSION >= 10020
+
   // Returns whether code in the from context can access memory in the to
   // context via cuDeviceCanAccessPeer.
   // http://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__PEER__ACCESS.html#group__CUDA__PEER__ACCESS_1g496bdaae1f632ebfb695b99d2c40f19e